@@ -43,9 +43,11 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/SmallVectorMemoryBuffer.h"
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Timer.h"
@@ -1193,8 +1195,17 @@ public:
       return Error::success();
     }
 
-    // Extracted objects data for archive mode.
-    SmallVector<NewArchiveMember, 8u> ArMembers;
+    // The bundles are extracted from the children in parallel, each child
+    // collects its own, in their order in the child. They are put to the
+    // output in the order of the children afterwards, so that it does not
+    // depend on the scheduling of the threads.
+    struct ChildBundles {
+      Archive::Child C;
+      // Names of the temporary files with the bundles in file list mode, or
+      // names and contents of the bundles in the other modes.
+      SmallVector<std::pair<std::string, SmallVector<char, 0>>, 1> Bundles;
+    };
+    SmallVector<ChildBundles, 0> Children;
 
     // Read all children.
     Error Err = Error::success();
@@ -1205,100 +1216,37 @@ public:
         LLVM_DEBUG(outs() << "Skip Child. Index: " << ChildIndex << "\n");
         continue;
       }
+      Children.push_back({C, {}});
+    }
+    if (Err)
+      return Err;
 
-      std::unique_ptr<FileHandler> FH{nullptr};
-      std::unique_ptr<MemoryBuffer> Buf{nullptr};
-      StringRef Ext("o");
-      if (BundlerConfig.FilesType == "aocr" ||
-          BundlerConfig.FilesType == "aocx")
-        Ext = BundlerConfig.FilesType;
-
-      auto BinOrErr = C.getAsBinary();
-      if (!BinOrErr) {
-        // Not a recognized binary file.  Specifically not an object file
-        if (auto Err = isNotObjectErrorInvalidFileType(BinOrErr.takeError()))
-          return Err;
+    if (Error ExtractErr =
+            parallelForEachError(Children, [&](ChildBundles &Child) {
+              return extractBundles(Child.C, Child.Bundles);
+            }))
+      return ExtractErr;
 
-        if (BundlerConfig.FilesType == "aoo") {
-          // Handle bundled BC Files
-          Ext = "bc";
-          FH = std::make_unique<BinaryFileHandler>(BundlerConfig);
-          auto MR = C.getMemoryBufferRef();
-          assert(MR);
-          Buf = MemoryBuffer::getMemBuffer(*MR, false);
-        } else
-          continue;
-      } else {
-        auto &Bin = BinOrErr.get();
-        if (!Bin->isObject())
-          continue;
-        auto Obj = std::unique_ptr<ObjectFile>(cast<ObjectFile>(Bin.release()));
-        Buf = MemoryBuffer::getMemBuffer(Obj->getMemoryBufferRef(), false);
-        FH = std::make_unique<ObjectFileHandler>(std::move(Obj), BundlerConfig);
-      }
-
-      if (Error Err = FH->ReadHeader(*Buf))
-        return Err;
-      Expected<std::optional<StringRef>> NameOrErr = FH->ReadBundleStart(*Buf);
-      if (!NameOrErr)
-        return NameOrErr.takeError();
-      while (*NameOrErr) {
-        auto TT = **NameOrErr;
-        if (TT == CurrBundle->first()) {
-          // This is the bundle we are looking for.
-          if (Mode == OutputType::FileList) {
-            // Create temporary file where the device part will be extracted to.
-            SmallString<128u> ChildFileName;
-
-            auto EC = sys::fs::createTemporaryFile(TempFileNameBase, Ext,
-                                                   ChildFileName);
-            if (EC)
-              return createFileError(ChildFileName, EC);
-
-            raw_fd_ostream ChildOS(ChildFileName, EC);
-            if (EC)
-              return createFileError(ChildFileName, EC);
-
-            if (Error Err = FH->ReadBundle(ChildOS, *Buf))
-              return Err;
-
-            if (ChildOS.has_error())
-              return createFileError(ChildFileName, ChildOS.error());
-
-            // Add temporary file name with the device part to the output file
-            // list.
-            OS << ChildFileName << "\n";
-          } else if (Mode == OutputType::Object) {
-            // Extract the bundle to the output file in single file mode.
-            if (Error Err = FH->ReadBundle(OS, *Buf))
-              return Err;
-          } else if (Mode == OutputType::Archive) {
-            auto ChildNameOrErr = C.getName();
-            if (!ChildNameOrErr)
-              return ChildNameOrErr.takeError();
+    // Extracted objects data for archive mode.
+    SmallVector<NewArchiveMember, 8u> ArMembers;
 
-            // Extract the bundle to a buffer.
-            SmallVector<char> Data;
-            raw_svector_ostream ChildOS{Data};
-            if (Error Err = FH->ReadBundle(ChildOS, *Buf))
-              return Err;
-
-            // Add new archive member.
-            NewArchiveMember &Member = ArMembers.emplace_back();
-            std::string Name = (TT + "." + *ChildNameOrErr).str();
-            Member.Buf = MemoryBuffer::getMemBufferCopy(ChildOS.str(), Name);
-            Member.MemberName = Member.Buf->getBufferIdentifier();
-          }
-          if (Error Err = FH->ReadBundleEnd(*Buf))
-            return Err;
+    for (ChildBundles &Child : Children) {
+      for (auto &[Name, Data] : Child.Bundles) {
+        if (Mode == OutputType::FileList) {
+          // Add temporary file name with the device part to the output file
+          // list.
+          OS << Name << "\n";
+        } else if (Mode == OutputType::Object) {
+          OS.write(Data.data(), Data.size());
+        } else if (Mode == OutputType::Archive) {
+          // Add new archive member, which takes the extracted data.
+          NewArchiveMember &Member = ArMembers.emplace_back();
+          Member.Buf = std::make_unique<SmallVectorMemoryBuffer>(
+              std::move(Data), Name, /*RequiresNullTerminator=*/false);
+          Member.MemberName = Member.Buf->getBufferIdentifier();
         }
-        NameOrErr = FH->ReadBundleStart(*Buf);
-        if (!NameOrErr)
-          return NameOrErr.takeError();
       }
     }
-    if (Err)
-      return Err;
 
     if (Mode == OutputType::Archive) {
       // Determine archive kind for the offload target.
@@ -1318,6 +1266,93 @@ public:
     return Error::success();
   }
 
+  /// Extracts the current bundle from the archive child C to Bundles, see
+  /// ReadBundle. Called for several children at once.
+  Error extractBundles(
+      const Archive::Child &C,
+      SmallVectorImpl<std::pair<std::string, SmallVector<char, 0>>> &Bundles)
+      const {
+    std::unique_ptr<FileHandler> FH{nullptr};
+    std::unique_ptr<MemoryBuffer> Buf{nullptr};
+    StringRef Ext("o");
+    if (BundlerConfig.FilesType == "aocr" || BundlerConfig.FilesType == "aocx")
+      Ext = BundlerConfig.FilesType;
+
+    auto BinOrErr = C.getAsBinary();
+    if (!BinOrErr) {
+      // Not a recognized binary file.  Specifically not an object file
+      if (auto Err = isNotObjectErrorInvalidFileType(BinOrErr.takeError()))
+        return Err;
+
+      if (BundlerConfig.FilesType != "aoo")
+        return Error::success();
+      // Handle bundled BC Files
+      Ext = "bc";
+      FH = std::make_unique<BinaryFileHandler>(BundlerConfig);
+      auto MR = C.getMemoryBufferRef();
+      assert(MR);
+      Buf = MemoryBuffer::getMemBuffer(*MR, false);
+    } else {
+      auto &Bin = BinOrErr.get();
+      if (!Bin->isObject())
+        return Error::success();
+      auto Obj = std::unique_ptr<ObjectFile>(cast<ObjectFile>(Bin.release()));
+      Buf = MemoryBuffer::getMemBuffer(Obj->getMemoryBufferRef(), false);
+      FH = std::make_unique<ObjectFileHandler>(std::move(Obj), BundlerConfig);
+    }
+
+    if (Error Err = FH->ReadHeader(*Buf))
+      return Err;
+    Expected<std::optional<StringRef>> NameOrErr = FH->ReadBundleStart(*Buf);
+    if (!NameOrErr)
+      return NameOrErr.takeError();
+    while (*NameOrErr) {
+      auto TT = **NameOrErr;
+      if (TT == CurrBundle->first()) {
+        // This is the bundle we are looking for.
+        auto &[Name, Data] = Bundles.emplace_back();
+        if (Mode == OutputType::FileList) {
+          // Create temporary file where the device part will be extracted to.
+          SmallString<128u> ChildFileName;
+
+          auto EC = sys::fs::createTemporaryFile(TempFileNameBase, Ext,
+                                                 ChildFileName);
+          if (EC)
+            return createFileError(ChildFileName, EC);
+
+          raw_fd_ostream ChildOS(ChildFileName, EC);
+          if (EC)
+            return createFileError(ChildFileName, EC);
+
+          if (Error Err = FH->ReadBundle(ChildOS, *Buf))
+            return Err;
+
+          if (ChildOS.has_error())
+            return createFileError(ChildFileName, ChildOS.error());
+          Name = std::string(ChildFileName);
+        } else {
+          // Extract the bundle to a buffer.
+          raw_svector_ostream ChildOS{Data};
+          if (Error Err = FH->ReadBundle(ChildOS, *Buf))
+            return Err;
+
+          if (Mode == OutputType::Archive) {
+            auto ChildNameOrErr = C.getName();
+            if (!ChildNameOrErr)
+              return ChildNameOrErr.takeError();
+            Name = (TT + "." + *ChildNameOrErr).str();
+          }
+        }
+        if (Error Err = FH->ReadBundleEnd(*Buf))
+          return Err;
+      }
+      NameOrErr = FH->ReadBundleStart(*Buf);
+      if (!NameOrErr)
+        return NameOrErr.takeError();
+    }
+    return Error::success();
+  }
+
   Error WriteHeader(raw_ostream &OS,
                     ArrayRef<std::unique_ptr<MemoryBuffer>> Inputs) override {
     llvm_unreachable("unsupported for the ArchiveFileHandler");
@@ -1903,9 +1938,13 @@ Error OffloadBundler::BundleFiles() {
 
 // Unbundle the files. Return true if an error was found.
 Error OffloadBundler::UnbundleFiles() {
-  // Open Input file.
+  // Open Input file. Archives are not copied to a null terminated buffer, so
+  // that they are always mapped.
   ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
-      MemoryBuffer::getFileOrSTDIN(BundlerConfig.InputFileNames.front());
+      MemoryBuffer::getFileOrSTDIN(
+          BundlerConfig.InputFileNames.front(), /*IsText=*/false,
+          /*RequiresNullTerminator=*/!FilesTypeIsArchive(
+              BundlerConfig.FilesType));
   if (std::error_code EC = CodeOrErr.getError())
     return createFileError(BundlerConfig.InputFileNames.front(), EC);
 
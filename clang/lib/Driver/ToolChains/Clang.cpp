@@ -9848,6 +9848,44 @@ void OffloadBundler::ConstructJobMultipleOutputs(
     C.addCommand(std::move(Cmd));
 }
 
+// Makes a device tool record a time trace when -ftime-trace is given. The
+// outputs of the device tools are temporary files, so the trace is written to
+// the directory of the traces of the compilation, and is named after the tool
+// and its output.
+// \returns the name of the trace file, or nullptr if no trace is recorded.
+static const char *addDeviceTimeTraceArgs(Compilation &C, const Tool &T,
+                                          StringRef OutputFile,
+                                          ArgStringList &CmdArgs) {
+  const ArgList &Args = C.getArgs();
+  Arg *A =
+      Args.getLastArg(options::OPT_ftime_trace, options::OPT_ftime_trace_EQ);
+  if (!A)
+    return nullptr;
+  SmallString<128> Path;
+  if (A->getOption().matches(options::OPT_ftime_trace_EQ)) {
+    Path = A->getValue();
+    if (!llvm::sys::fs::is_directory(Path))
+      llvm::sys::path::remove_filename(Path);
+  } else if (Arg *DumpDir = Args.getLastArgNoClaim(options::OPT_dumpdir)) {
+    // dumpdir is a prefix of the trace file name, which may not end with a
+    // path separator.
+    Path = DumpDir->getValue();
+  } else if (Arg *FinalOutput = Args.getLastArg(options::OPT_o)) {
+    Path = llvm::sys::path::parent_path(FinalOutput->getValue());
+  }
+  if (!Path.empty() && !llvm::sys::path::is_separator(Path.back()) &&
+      llvm::sys::fs::is_directory(Path))
+    Path += llvm::sys::path::get_separator();
+  Path += (Twine(T.getShortName()) + "-" +
+           llvm::sys::path::filename(OutputFile) + ".json")
+              .str();
+
+  const char *TraceFile = Args.MakeArgString(Path);
+  CmdArgs.push_back("-time-trace");
+  CmdArgs.push_back(Args.MakeArgString(Twine("-time-trace-file=") + TraceFile));
+  return TraceFile;
+}
+
 // Begin OffloadWrapper
 
 static void addRunTimeWrapperOpts(Compilation &C,
@@ -9945,6 +9983,14 @@ void OffloadWrapper::ConstructJob(Compilation &C, const JobAction &JA,
     addRunTimeWrapperOpts(C, OffloadingKind, TCArgs, WrapperArgs,
                           getToolChain(), JA);
 
+    if (TCArgs.hasFlag(options::OPT_offload_compress,
+                       options::OPT_no_offload_compress, false)) {
+      WrapperArgs.push_back(C.getArgs().MakeArgString("-offload-compress"));
+      if (Arg *A = TCArgs.getLastArg(options::OPT_offload_compression_level_EQ))
+        WrapperArgs.push_back(C.getArgs().MakeArgString(
+            Twine("-offload-compression-level=") + A->getValue()));
+    }
+
     // When wrapping an FPGA device binary, we need to be sure to apply the
     // appropriate triple that corresponds (fpga_aocr-intel-<os>)
     // to the target triple setting.
@@ -10014,6 +10060,7 @@ void OffloadWrapper::ConstructJob(Compilation &C, const JobAction &JA,
       // wrapper actual input files are passed via the batch job file table:
       WrapperArgs.push_back(C.getArgs().MakeArgString("-batch"));
     WrapperArgs.push_back(C.getArgs().MakeArgString(I.getFilename()));
+    addDeviceTimeTraceArgs(C, *this, OutOpt.substr(3), WrapperArgs);
 
     auto Cmd = std::make_unique<Command>(
         JA, *this, ResponseFileSupport::None(),
@@ -10285,6 +10332,8 @@ void SPIRVTranslator::ConstructJob(Compilation &C, const JobAction &JA,
 
   TranslatorArgs.push_back("-o");
   TranslatorArgs.push_back(Output.getFilename());
+  const char *TraceFile =
+      addDeviceTimeTraceArgs(C, *this, Output.getFilename(), TranslatorArgs);
   if (JA.isDeviceOffloading(Action::OFK_SYCL)) {
     const toolchains::SYCLToolChain &TC =
         static_cast<const toolchains::SYCLToolChain &>(getToolChain());
@@ -10396,6 +10445,10 @@ void SPIRVTranslator::ConstructJob(Compilation &C, const JobAction &JA,
         TCArgs.MakeArgString("--out-file-list=" + OutputFileName));
     ForeachArgs.push_back(
         TCArgs.MakeArgString("--out-replace=" + OutputFileName));
+    // Each translation writes its own time trace, named after its index.
+    if (TraceFile)
+      ForeachArgs.push_back(
+          TCArgs.MakeArgString(Twine("--out-increment=") + TraceFile));
     // If fsycl-dump-device-code is passed, put the output files from llvm-spirv
     // into the path provided in fsycl-dump-device-code.
     if (C.getDriver().isDumpDeviceCodeEnabled()) {
@@ -10586,6 +10639,7 @@ void SYCLPostLink::ConstructJob(Compilation &C, const JobAction &JA,
   assert(Inputs.size() == 1 && Inputs.front().isFilename() &&
          "single input file expected");
   addArgs(CmdArgs, TCArgs, {Inputs.front().getFilename()});
+  addDeviceTimeTraceArgs(C, *this, Output.getFilename(), CmdArgs);
   std::string OutputFileName(Output.getFilename());
 
   // All the inputs are encoded as commands.
@@ -10683,6 +10737,7 @@ void FileTableTform::ConstructJob(Compilation &C, const JobAction &JA,
     assert(Input.isFilename() && "table tform input must be a file");
     addArgs(CmdArgs, TCArgs, {Input.getFilename()});
   }
+  addDeviceTimeTraceArgs(C, *this, Output.getFilename(), CmdArgs);
   // 4) finally construct and add a command to the compilation
   C.addCommand(std::make_unique<Command>(
       JA, *this, ResponseFileSupport::None(),
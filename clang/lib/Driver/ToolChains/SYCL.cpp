@@ -1091,6 +1091,7 @@ void SYCL::x86_64::BackendCompiler::ConstructJob(
 //  -fcf-protection, -fsanitize, -fprofile-generate, -fprofile-instr-generate
 //  -ftest-coverage, -fcoverage-mapping, -fcreate-profile, -fprofile-arcs
 //  -fcs-profile-generate -forder-file-instrumentation
+// The profiles given with -fprofile-instr-use are applied to the device code.
 static std::vector<OptSpecifier> getUnsupportedOpts(void) {
   std::vector<OptSpecifier> UnsupportedOpts = {
       options::OPT_fsanitize_EQ,
@@ -1108,14 +1109,23 @@ static std::vector<OptSpecifier> getUnsupportedOpts(void) {
       options::OPT_fno_profile_arcs,
       options::OPT_fno_profile_instr_generate,
       options::OPT_fcreate_profile,
-      options::OPT_fprofile_instr_use,
-      options::OPT_fprofile_instr_use_EQ,
       options::OPT_forder_file_instrumentation,
       options::OPT_fcs_profile_generate,
       options::OPT_fcs_profile_generate_EQ};
   return UnsupportedOpts;
 }
 
+// The device code compiled for the host can be instrumented by the frontend,
+// as it is linked with the profile runtime of the host. The profiles collected
+// with the native CPU target can then be used for the device compilations of
+// the other targets with -fprofile-instr-use, since the frontend keys them by
+// function name and structure.
+static bool isNativeCPUProfileOpt(const Option &Opt) {
+  return Opt.matches(options::OPT_fprofile_instr_generate) ||
+         Opt.matches(options::OPT_fprofile_instr_generate_EQ) ||
+         Opt.matches(options::OPT_fno_profile_instr_generate);
+}
+
 SYCLToolChain::SYCLToolChain(const Driver &D, const llvm::Triple &Triple,
                              const ToolChain &HostTC, const ArgList &Args)
     : ToolChain(D, Triple, Args), HostTC(HostTC),
@@ -1127,6 +1137,8 @@ SYCLToolChain::SYCLToolChain(const Driver &D, const llvm::Triple &Triple,
   // Diagnose unsupported options only once.
   for (OptSpecifier Opt : getUnsupportedOpts()) {
     if (const Arg *A = Args.getLastArg(Opt)) {
+      if (IsSYCLNativeCPU && isNativeCPUProfileOpt(A->getOption()))
+        continue;
       // All sanitizer options are not currently supported, except
       // AddressSanitizer
       if (A->getOption().getID() == options::OPT_fsanitize_EQ &&
@@ -1167,6 +1179,8 @@ SYCLToolChain::TranslateArgs(const llvm::opt::DerivedArgList &Args,
     bool Unsupported = false;
     for (OptSpecifier UnsupportedOpt : getUnsupportedOpts()) {
       if (Opt.matches(UnsupportedOpt)) {
+        if (IsSYCLNativeCPU && isNativeCPUProfileOpt(Opt))
+          continue;
         if (Opt.getID() == options::OPT_fsanitize_EQ &&
             A->getValues().size() == 1) {
           std::string SanitizeVal = A->getValue();
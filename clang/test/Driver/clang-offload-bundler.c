@@ -420,6 +420,11 @@
 // CHECK-AR-TGT2-LIST: openmp-x86_64-pc-linux-gnu.{{.+}}.bundle3.o
 // CHECK-AR-TGT2-LIST: openmp-x86_64-pc-linux-gnu.{{.+}}.bundle4.o
 
+// Check that the members extracted in parallel keep the order of the archive.
+// RUN: clang-offload-bundler -threads=1 -type=a -targets=host-%itanium_abi_triple,openmp-powerpc64le-ibm-linux-gnu,openmp-x86_64-pc-linux-gnu -output=%t.host.serial.a -output=%t.tgt1.serial.a -output=%t.tgt2.serial.a -input=%t.a -unbundle
+// RUN: cmp %t.tgt1.a %t.tgt1.serial.a
+// RUN: cmp %t.tgt2.a %t.tgt2.serial.a
+
 //
 // Check error due to missing bundles
 //
@@ -89,8 +89,10 @@
 // CHECK-HELP:     =sycl                 -   SYCL
 // CHECK-HELP:   --link-opts=<string>    - link options passed to the offload runtime
 // CHECK-HELP:   -o <filename>           - Output filename
+// CHECK-HELP:   --offload-compress      - Compress SYCL device images with zstd, SYCL offload only
 // CHECK-HELP:   --properties=<filename> - File listing device binary image properties, SYCL offload only
 // CHECK-HELP:   --target=<string>       - offload target triple
+// CHECK-HELP:   --use-incbin            - Include the device image files in the output with assembler .incbin directives
 // CHECK-HELP:   -v                      - verbose output
 
 // -------
@@ -216,6 +218,23 @@
 // RUN: clang-offload-bundler --type=o -input=%t.wrapper.o --targets=sycl-spir64-unknown-linux -output=%t1.out --unbundle
 // RUN: diff %t1.out %t1.tgt
 
+// -------
+// Check that -use-incbin includes the device image file when the wrapper
+// object is compiled, and that the image can still be extracted.
+//
+// RUN: clang-offload-wrapper -use-incbin -o %t.incbin.bc -host=x86_64-pc-linux-gnu -kind=sycl -target=spir64-unknown-linux %t1.tgt
+// RUN: llvm-dis %t.incbin.bc -o - | FileCheck %s --check-prefix CHECK-INCBIN
+// CHECK-INCBIN: module asm "\09.section \22__CLANG_OFFLOAD_BUNDLE__sycl-spir64-unknown-linux\22,\22a\22,%progbits"
+// CHECK-INCBIN-NEXT: module asm "_sycl_offloading_0_data_begin:"
+// CHECK-INCBIN-NEXT: module asm "\09.incbin \22{{.+}}.tgt\22"
+// CHECK-INCBIN-NEXT: module asm "_sycl_offloading_0_data_end:"
+// CHECK-INCBIN: @"\01_sycl_offloading_0_data_begin" = external hidden constant i8
+// CHECK-INCBIN: @"\01_sycl_offloading_0_data_end" = external hidden constant i8
+// CHECK-INCBIN-NOT: c"Content of device file1
+// RUN: %clang -target x86_64-pc-linux-gnu -c %t.incbin.bc -o %t.incbin.o
+// RUN: clang-offload-bundler --type=o -input=%t.incbin.o --targets=sycl-spir64-unknown-linux -output=%t1.incbin.out --unbundle
+// RUN: diff %t1.incbin.out %t1.tgt
+
 // Check that clang-offload-wrapper adds LLVMOMPOFFLOAD notes
 // into the ELF offload images:
 // RUN: yaml2obj %S/Inputs/empty-elf-template.yaml -o %t.64le -DBITS=64 -DENCODING=LSB
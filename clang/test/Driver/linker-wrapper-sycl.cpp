@@ -11,3 +11,9 @@
 // CHK-CMDS-NEXT: offload-wrapper: input: [[LLVMSPIRVOUT:.*]].table, output: [[WRAPPEROUT:.*]].bc
 // CHK-CMDS-NEXT: "{{.*}}llc" -filetype=obj -o [[LLCOUT:.*]].o [[WRAPPEROUT]].bc
 // CHK-CMDS-NEXT: "{{.*}}/ld" -- HOST_LINKER_FLAGS -dynamic-linker HOST_DYN_LIB -o a.out [[LLCOUT]].o HOST_LIB_PATH HOST_STAT_LIB {{.*}}test-sycl.o
+
+/// Check that the linked device code is inlined across the translation units
+// RUN: clang-linker-wrapper -sycl-device-library-location=%S/Inputs -sycl-device-libraries=libsycl-crt.o -sycl-cross-tu-inline-threshold=50 "--host-triple=x86_64-unknown-linux-gnu" "--triple=spir64" "--linker-path=/usr/bin/ld" "--" "-o" "a.out" %S/Inputs/test-sycl.o --dry-run 2>&1 | FileCheck -check-prefix=CHK-INLINE %s
+// CHK-INLINE: "{{.*}}llvm-link" -only-needed {{.*}} -o [[LLVMLINKOUT:.*]].bc --suppress-warnings
+// CHK-INLINE-NEXT: "{{.*}}opt" -passes=inliner-wrapper,function(sroa,early-cse,instcombine,simplifycfg) -inline-threshold=50 [[LLVMLINKOUT]].bc -o [[OPTOUT:.*]].bc
+// CHK-INLINE-NEXT: "{{.*}}sycl-post-link" {{.*}}-o [[SYCLPOSTLINKOUT:.*]].table [[OPTOUT]].bc
@@ -0,0 +1,17 @@
+/// Check the profile guided optimization of SYCL device code.
+
+/// The profiles are applied to the device compilation.
+// RUN: %clangxx -fsycl -fsycl-targets=spir64 -fprofile-instr-use=%t.profdata \
+// RUN:   -### %s 2>&1 | FileCheck %s -check-prefix=PROFILE_USE
+// PROFILE_USE-NOT: ignoring '-fprofile-instr-use
+// PROFILE_USE: clang{{.*}} "-fsycl-is-device"{{.*}} "-fprofile-instrument-use-path={{.*}}.profdata"
+// PROFILE_USE: clang{{.*}} "-fsycl-is-host"{{.*}} "-fprofile-instrument-use-path={{.*}}.profdata"
+
+/// The device code compiled for the host can be instrumented, so that its
+/// profiles can be collected.
+// RUN: %clangxx -fsycl -fsycl-targets=native_cpu -fprofile-instr-generate \
+// RUN:   -fsycl-libspirv-path=%S/Inputs/SYCL/libspirv.bc -### %s 2>&1 \
+// RUN:   | FileCheck %s -check-prefix=NATIVE_CPU_GENERATE
+// NATIVE_CPU_GENERATE-NOT: ignoring '-fprofile-instr-generate
+// NATIVE_CPU_GENERATE: clang{{.*}} "-fsycl-is-device"{{.*}} "-fprofile-instrument=clang"
+// NATIVE_CPU_GENERATE: clang{{.*}} "-fsycl-is-host"{{.*}} "-fprofile-instrument=clang"
@@ -0,0 +1,12 @@
+/// Check that device image compression options are passed to
+/// clang-offload-wrapper for SYCL offloading.
+
+// RUN: %clangxx -fsycl --offload-compress --offload-compression-level=3 -### %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=CHECK-COMPRESS
+// CHECK-COMPRESS: clang-offload-wrapper{{.*}} "-offload-compress" "-offload-compression-level=3"
+
+// RUN: %clangxx -fsycl --offload-compress --no-offload-compress -### %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=CHECK-NO-COMPRESS
+// RUN: %clangxx -fsycl -### %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=CHECK-NO-COMPRESS
+// CHECK-NO-COMPRESS-NOT: "-offload-compress"
@@ -0,0 +1,16 @@
+// Verify that -ftime-trace makes the SYCL device tools record their own time
+// traces, in the directory of the traces of the compilation.
+
+// RUN: mkdir -p %t.dir
+// RUN: %clang -### -fsycl -fno-sycl-instrument-device-code -fno-sycl-device-lib=all \
+// RUN:   --target=x86_64-unknown-linux-gnu -ftime-trace=%t.dir %s 2>&1 \
+// RUN:   | FileCheck %s -DDIR=%t.dir
+// CHECK: sycl-post-link{{.*}} "-time-trace" "-time-trace-file=[[DIR]]{{/|\\\\}}sycl-post-link-{{.*}}.json"
+// CHECK: file-table-tform{{.*}} "-time-trace" "-time-trace-file=[[DIR]]{{/|\\\\}}file-table-tform-{{.*}}.json"
+// CHECK: llvm-foreach{{.*}} "--out-increment=[[DIR]]{{/|\\\\}}llvm-spirv-{{.*}}.json"{{.*}} "--" "{{.*}}llvm-spirv{{.*}}" "-time-trace" "-time-trace-file=[[DIR]]{{/|\\\\}}llvm-spirv-{{.*}}.json"
+// CHECK: clang-offload-wrapper{{.*}} "-time-trace" "-time-trace-file=[[DIR]]{{/|\\\\}}clang-offload-wrapper-{{.*}}.json"
+
+// RUN: %clang -### -fsycl -fno-sycl-instrument-device-code -fno-sycl-device-lib=all \
+// RUN:   --target=x86_64-unknown-linux-gnu %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=NO-TRACE
+// NO-TRACE-NOT: "-time-trace"
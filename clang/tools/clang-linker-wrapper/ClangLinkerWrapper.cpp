@@ -15,6 +15,7 @@
 //===---------------------------------------------------------------------===//
 
 #include "clang/Basic/Version.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/BinaryFormat/Magic.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/CodeGen/CommandFlags.h"
@@ -37,6 +38,8 @@
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Option/Option.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/Caching.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/FileOutputBuffer.h"
@@ -47,6 +50,7 @@
 #include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/SHA1.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/SimpleTable.h"
 #include "llvm/Support/SourceMgr.h"
@@ -57,6 +61,7 @@
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/TargetParser/Host.h"
 #include <atomic>
+#include <deque>
 #include <optional>
 
 using namespace llvm;
@@ -691,23 +696,136 @@ static Expected<StringRef> runLLVMToSPIRVTranslation(StringRef InputTable,
                            /* KeepEmpty = */ false);
   CmdArgs.push_back("-o");
 
+  // With -sycl-cache-dir, the translations are cached under the hash of the
+  // split module and of the options, and the modules which did not change
+  // since the previous link are not translated again.
+  std::optional<FileCache> Cache;
+  SmallVector<std::unique_ptr<MemoryBuffer>> CachedFiles(InputFiles.size());
+  SmallVector<AddStreamFn> CacheStreams(InputFiles.size());
+  StringRef CacheDir = Args.getLastArgValue(OPT_sycl_cache_dir_EQ);
+  if (!CacheDir.empty() && !DryRun) {
+    auto CacheOrErr = localCache(
+        "SYCLCache", "sycl-cache", CacheDir,
+        [&](unsigned Task, const Twine &, std::unique_ptr<MemoryBuffer> MB) {
+          CachedFiles[Task] = std::move(MB);
+        });
+    if (!CacheOrErr)
+      return CacheOrErr.takeError();
+    Cache = std::move(*CacheOrErr);
+  }
+  const std::string Version = getClangFullVersion();
+  auto CacheKey = [&](StringRef File) -> Expected<std::string> {
+    auto BufferOrErr = MemoryBuffer::getFile(File);
+    if (!BufferOrErr)
+      return createFileError(File, BufferOrErr.getError());
+    SHA1 Hasher;
+    for (StringRef Part : {StringRef(Version), StringRef(*LLVMToSPIRVPath),
+                           LLVMToSPIRVOptions}) {
+      Hasher.update(Part);
+      Hasher.update(ArrayRef<uint8_t>{0});
+    }
+    Hasher.update((*BufferOrErr)->getBuffer());
+    return toHex(Hasher.result());
+  };
+  auto AddToCache = [&](unsigned I) -> Error {
+    StringRef Output = LiveSYCLTable.Entries[I].IRFile;
+    auto BufferOrErr = MemoryBuffer::getFile(Output);
+    if (!BufferOrErr)
+      return createFileError(Output, BufferOrErr.getError());
+    auto StreamOrErr = CacheStreams[I](I, InputFiles[I]);
+    if (!StreamOrErr)
+      return StreamOrErr.takeError();
+    *(*StreamOrErr)->OS << (*BufferOrErr)->getBuffer();
+    return Error::success();
+  };
+
+  // The split modules are translated independently, so up to --wrapper-jobs
+  // translations run at the same time.
+  const unsigned MaxJobs =
+      std::max(1u, parallel::strategy.compute_thread_count());
+  // The translations running, with the index of their module
+  std::deque<std::pair<sys::ProcessInfo, unsigned>> Running;
+  auto Failure = [&](const Twine &Reason) {
+    return createStringError(inconvertibleErrorCode(),
+                             "'" + sys::path::filename(*LLVMToSPIRVPath) +
+                                 "'" + " failed" + Reason);
+  };
+  auto WaitForOldest = [&]() -> Error {
+    auto [Process, I] = Running.front();
+    sys::ProcessInfo PI = sys::Wait(Process, std::nullopt);
+    Running.pop_front();
+    if (PI.ReturnCode != 0)
+      return Failure("");
+    if (CacheStreams[I])
+      return AddToCache(I);
+    return Error::success();
+  };
+  auto WaitForAll = [&](Error Err) -> Error {
+    while (!Running.empty())
+      Err = joinErrors(std::move(Err), WaitForOldest());
+    return Err;
+  };
+
   for (unsigned I = 0; I < InputFiles.size(); ++I) {
     const auto &File = InputFiles[I];
-    // Create a new file to write the translated file to.
-    auto TempFileOrErr =
-        createOutputFile(sys::path::filename(ExecutableName), "spv");
+    // Create a new file to write the translated file to. The index keeps the
+    // names of the modules apart with -save-temps.
+    auto TempFileOrErr = createOutputFile(
+        sys::path::filename(ExecutableName) + "." + Twine(I), "spv");
     if (!TempFileOrErr)
-      return TempFileOrErr.takeError();
+      return WaitForAll(TempFileOrErr.takeError());
+    // Replace bc file in SYCL table with spv file
+    LiveSYCLTable.Entries[I].IRFile = *TempFileOrErr;
+
+    if (Cache) {
+      auto KeyOrErr = CacheKey(File);
+      if (!KeyOrErr)
+        return WaitForAll(KeyOrErr.takeError());
+      auto StreamOrErr = (*Cache)(I, *KeyOrErr, File);
+      if (!StreamOrErr)
+        return WaitForAll(StreamOrErr.takeError());
+      CacheStreams[I] = std::move(*StreamOrErr);
+      if (!CacheStreams[I]) {
+        // The cached translation is copied, so that the cache may be pruned.
+        std::error_code EC;
+        raw_fd_ostream OS(*TempFileOrErr, EC, sys::fs::OF_None);
+        if (EC)
+          return WaitForAll(createFileError(*TempFileOrErr, EC));
+        OS << CachedFiles[I]->getBuffer();
+        CachedFiles[I].reset();
+        continue;
+      }
+    }
 
     CmdArgs.push_back(*TempFileOrErr);
     CmdArgs.push_back(File);
-    if (Error Err = executeCommands(*LLVMToSPIRVPath, CmdArgs))
-      return std::move(Err);
-    // Replace bc file in SYCL table with spv file
-    LiveSYCLTable.Entries[I].IRFile = *TempFileOrErr;
+    if (Verbose || DryRun)
+      printCommands(CmdArgs);
+    if (!DryRun) {
+      if (Running.size() >= MaxJobs)
+        if (Error Err = WaitForOldest())
+          return WaitForAll(std::move(Err));
+      std::string ErrMsg;
+      bool ExecutionFailed = false;
+      sys::ProcessInfo PI =
+          sys::ExecuteNoWait(*LLVMToSPIRVPath, CmdArgs, std::nullopt, {}, 0,
+                             &ErrMsg, &ExecutionFailed);
+      if (ExecutionFailed)
+        return WaitForAll(Failure(": " + ErrMsg));
+      Running.emplace_back(PI, I);
+    }
     // Pop back last two items
     CmdArgs.pop_back_n(2);
   }
+  if (Error Err = WaitForAll(Error::success()))
+    return std::move(Err);
+  if (Cache) {
+    auto PolicyOrErr = parseCachePruningPolicy(
+        Args.getLastArgValue(OPT_sycl_cache_policy_EQ));
+    if (!PolicyOrErr)
+      return PolicyOrErr.takeError();
+    pruneCache(CacheDir, *PolicyOrErr);
+  }
   auto Output = LiveSYCLTable.writeSYCLTableToFile();
   if (!Output)
     return Output.takeError();
@@ -958,6 +1076,40 @@ linkDeviceLibFiles(SmallVectorImpl<StringRef> &InputFiles,
   return *OutFileOrErr;
 }
 
+// Inline the small functions of the linked device code, such as the accessor
+// and math helpers, across the translation units they were compiled in, and
+// simplify the code they were inlined into. The split modules are generated
+// from the result, so that each one gets the inlined code of its kernels.
+static Expected<StringRef> runCrossTUInlining(StringRef InputFile,
+                                              StringRef Threshold) {
+  llvm::TimeTraceScope TimeScope("CrossTUInlining");
+
+  Expected<std::string> OptPath =
+      findProgram("opt", {getMainExecutable("opt")});
+  if (!OptPath)
+    return OptPath.takeError();
+
+  // Create a new file to write the optimized device file to.
+  auto OutFileOrErr = createOutputFile(
+      sys::path::filename(ExecutableName) + ".inlined", "bc");
+  if (!OutFileOrErr)
+    return OutFileOrErr.takeError();
+
+  BumpPtrAllocator Alloc;
+  StringSaver Saver(Alloc);
+  SmallVector<StringRef, 8> CmdArgs;
+  CmdArgs.push_back(*OptPath);
+  CmdArgs.push_back("-passes=inliner-wrapper,"
+                    "function(sroa,early-cse,instcombine,simplifycfg)");
+  CmdArgs.push_back(Saver.save("-inline-threshold=" + Threshold));
+  CmdArgs.push_back(InputFile);
+  CmdArgs.push_back("-o");
+  CmdArgs.push_back(*OutFileOrErr);
+  if (Error Err = executeCommands(*OptPath, CmdArgs))
+    return std::move(Err);
+  return *OutFileOrErr;
+}
+
 static Expected<StringRef> linkDevice(ArrayRef<StringRef> InputFiles,
                                       const ArgList &Args) {
   SmallVector<StringRef, 16> InputFilesVec;
@@ -987,6 +1139,12 @@ static Expected<StringRef> linkDevice(ArrayRef<StringRef> InputFiles,
   if (!DeviceLinkedFile)
     reportError(DeviceLinkedFile.takeError());
 
+  if (Arg *A = Args.getLastArg(OPT_sycl_cross_tu_inline_threshold_EQ)) {
+    auto InlinedFile = runCrossTUInlining(*DeviceLinkedFile, A->getValue());
+    if (!InlinedFile)
+      reportError(InlinedFile.takeError());
+    return *InlinedFile;
+  }
   return *DeviceLinkedFile;
 }
 
@@ -37,6 +37,7 @@
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
@@ -185,6 +186,11 @@ int main(int argc, const char **argv) {
   cl::opt<int> CompressionLevel(
       "compression-level", cl::desc("Specify the compression level (integer)"),
       cl::value_desc("n"), cl::Optional, cl::cat(ClangOffloadBundlerCategory));
+  cl::opt<unsigned> NumThreads(
+      "threads",
+      cl::desc("Number of threads extracting the bundles of the members of "
+               "archives when unbundling, 0 uses all the hardware threads.\n"),
+      cl::value_desc("n"), cl::init(0), cl::cat(ClangOffloadBundlerCategory));
 
   // Process commandline options and report errors
   sys::PrintStackTraceOnErrorSignal(argv[0]);
@@ -203,6 +209,8 @@ int main(int argc, const char **argv) {
     return 0;
   }
 
+  parallel::strategy = hardware_concurrency(NumThreads);
+
   // These calls are needed so that we can read bitcode correctly.
   InitializeAllTargetInfos();
   InitializeAllTargetMCs();
@@ -17,6 +17,7 @@
 #include "SymPropReader.h"
 #include "clang/Basic/Version.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/BinaryFormat/ELF.h"
@@ -40,6 +41,7 @@
 #include "llvm/SYCLLowerIR/SYCLUtils.h"
 #include "llvm/SYCLLowerIR/UtilsSYCLNativeCPU.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/Error.h"
@@ -52,12 +54,14 @@
 #include "llvm/Support/PropertySetIO.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/SimpleTable.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/VCSRevision.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/TargetParser/Host.h"
 #include "llvm/Transforms/Utils/ModuleUtils.h"
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -146,8 +150,12 @@ enum BinaryImageFormat {
   none,   // image kind is not determined
   native, // image kind is native
   // portable image kinds go next
-  spirv, // SPIR-V
-  llvmbc // LLVM bitcode
+  spirv,  // SPIR-V
+  llvmbc, // LLVM bitcode
+  // Not settable from the command line: the image has been compressed with
+  // zstd by the tool and its original format is determined after
+  // decompression by the runtime.
+  compressed_none
 };
 
 /// Sets offload kind.
@@ -265,6 +273,8 @@ static StringRef formatToString(BinaryImageFormat Fmt) {
     return "llvmbc";
   case BinaryImageFormat::native:
     return "native";
+  case BinaryImageFormat::compressed_none:
+    return "compressed_none";
   }
   llvm_unreachable("bad format");
 
@@ -277,10 +287,65 @@ static cl::opt<bool> SaveTemps(
              "This option forces print-out of the temporary files' names."),
     cl::Hidden);
 
+static cl::opt<bool> OffloadCompressDevImgs(
+    "offload-compress",
+    cl::desc("Compress SYCL device images with zstd, SYCL offload only"),
+    cl::init(false), cl::cat(ClangOffloadWrapperCategory));
+
+static cl::opt<int> OffloadCompressLevel(
+    "offload-compression-level", cl::init(10), cl::Hidden,
+    cl::desc("zstd compression level used for -offload-compress"),
+    cl::cat(ClangOffloadWrapperCategory));
+
+static cl::opt<unsigned> OffloadCompressThreshold(
+    "offload-compression-threshold", cl::init(512), cl::Hidden,
+    cl::desc("Minimal size in bytes of a device image to be compressed"),
+    cl::cat(ClangOffloadWrapperCategory));
+
+static cl::opt<bool> UseIncbin(
+    "use-incbin",
+    cl::desc("Include the device image files in the output with assembler "
+             ".incbin directives instead of copying their contents into the "
+             "module. The files must exist until the output is compiled"),
+    cl::init(false), cl::cat(ClangOffloadWrapperCategory));
+
 static cl::opt<bool> AddOpenMPOffloadNotes(
     "add-omp-offload-notes",
     cl::desc("Add LLVMOMPOFFLOAD ELF notes to ELF device images."), cl::Hidden);
 
+static cl::opt<bool> TimeTrace("time-trace", cl::desc("Record time trace"),
+                               cl::cat(ClangOffloadWrapperCategory));
+
+static cl::opt<unsigned> TimeTraceGranularity(
+    "time-trace-granularity",
+    cl::desc(
+        "Minimum time granularity (in microseconds) traced by time profiler"),
+    cl::init(500), cl::Hidden, cl::cat(ClangOffloadWrapperCategory));
+
+static cl::opt<std::string>
+    TimeTraceFile("time-trace-file",
+                  cl::desc("Specify time trace file destination"),
+                  cl::value_desc("filename"),
+                  cl::cat(ClangOffloadWrapperCategory));
+
+struct TimeTracerRAII {
+  TimeTracerRAII(StringRef ProgramName) {
+    if (TimeTrace)
+      timeTraceProfilerInitialize(TimeTraceGranularity, ProgramName);
+  }
+  ~TimeTracerRAII() {
+    if (TimeTrace) {
+      if (auto E = timeTraceProfilerWrite(TimeTraceFile, Output)) {
+        handleAllErrors(std::move(E), [&](const StringError &SE) {
+          errs() << SE.getMessage() << "\n";
+        });
+        return;
+      }
+      timeTraceProfilerCleanup();
+    }
+  }
+};
+
 namespace {
 
 /// Implements binary image information collecting and wrapping it in a host
@@ -742,6 +807,61 @@ private:
                                       TargetTriple);
   }
 
+  // Adds the contents of the image file to the module through module level
+  // inline assembly, which includes the file with .incbin between two labels
+  // when the module is compiled. Returns a pair of pointers to the labels,
+  // which point to the beginning and end of the image data.
+  Expected<std::pair<Constant *, Constant *>>
+  addIncbinImageToModule(StringRef File, const Twine &Name, OffloadKind Kind,
+                         StringRef TargetTriple) {
+    Triple T(M.getTargetTriple());
+    if (!T.isOSBinFormatELF() && !T.isOSBinFormatCOFF())
+      return createStringError(std::make_error_code(errc::not_supported),
+                               "'-" + UseIncbin.ArgStr +
+                                   "' is only supported for ELF and COFF "
+                                   "targets");
+    SmallString<128> Path(File);
+    if (std::error_code EC = sys::fs::make_absolute(Path))
+      return createFileError(File, EC);
+
+    std::string Label = Name.str();
+    std::replace(Label.begin(), Label.end(), '.', '_');
+    std::string Section =
+        TargetTriple.empty()
+            ? (T.isOSBinFormatELF() ? ".rodata" : ".rdata")
+            : ("__CLANG_OFFLOAD_BUNDLE__" + offloadKindToString(Kind) + "-" +
+               TargetTriple)
+                  .str();
+
+    std::string Asm;
+    raw_string_ostream OS(Asm);
+    OS << "\t.section \"" << Section << "\","
+       << (T.isOSBinFormatELF() ? "\"a\",%progbits" : "\"dr\"") << "\n"
+       << Label << "_begin:\n"
+       << "\t.incbin \"";
+    for (char Ch : Path) {
+      if (Ch == '"' || Ch == '\\')
+        OS << '\\';
+      OS << Ch;
+    }
+    OS << "\"\n" << Label << "_end:\n";
+    M.appendModuleInlineAsm(OS.str());
+
+    // The \1 prefix keeps the names of the labels from being mangled.
+    auto AddLabel = [&](const std::string &LabelName) {
+      auto *Var = new GlobalVariable(M, Type::getInt8Ty(C), /*isConstant*/ true,
+                                     GlobalValue::ExternalLinkage, nullptr,
+                                     "\1" + LabelName);
+      Var->setVisibility(GlobalValue::HiddenVisibility);
+      Var->setDSOLocal(true);
+      if (Verbose)
+        errs() << "  image included: " << LabelName << "\n";
+      return Var;
+    };
+    return std::make_pair(AddLabel(Label + "_begin"),
+                          AddLabel(Label + "_end"));
+  }
+
   // Creates a global variable of const char* type and creates an
   // initializer that initializes it with given string (with added null
   // terminator). Returns a link-time constant pointer (constant expr) to that
@@ -933,6 +1053,27 @@ private:
 public:
     MemoryBuffer *addELFNotes(MemoryBuffer *Buf, StringRef OriginalFileName);
 
+  /// Returns a buffer with the zstd-compressed contents of \p Buf. The
+  /// returned buffer is owned by the wrapper.
+  MemoryBuffer *compressDeviceImage(MemoryBuffer *Buf,
+                                    StringRef OriginalFileName) {
+    SmallVector<uint8_t, 0> Compressed;
+    llvm::compression::zstd::compress(
+        ArrayRef<uint8_t>(
+            reinterpret_cast<const uint8_t *>(Buf->getBufferStart()),
+            Buf->getBufferSize()),
+        Compressed, OffloadCompressLevel);
+    if (Verbose)
+      errs() << "  compressed image " << OriginalFileName << ": "
+             << Buf->getBufferSize() << " -> " << Compressed.size()
+             << " bytes\n";
+    AutoGcBufs.emplace_back(MemoryBuffer::getMemBufferCopy(
+        StringRef(reinterpret_cast<const char *>(Compressed.data()),
+                  Compressed.size()),
+        OriginalFileName));
+    return AutoGcBufs.back().get();
+  }
+
 private:
   /// Creates binary descriptor for the given device images. Binary descriptor
   /// is an object that is passed to the offloading runtime at program startup
@@ -1032,7 +1173,7 @@ private:
       auto *Fver =
           ConstantInt::get(Type::getInt16Ty(C), DeviceImageStructVersion);
       auto *Fknd = ConstantInt::get(Type::getInt8Ty(C), Kind);
-      auto *Ffmt = ConstantInt::get(Type::getInt8Ty(C), Img.Fmt);
+      BinaryImageFormat Fmt = Img.Fmt;
       auto *Ftgt = addStringToModule(
           Img.Tgt, Twine(OffloadKindTag) + Twine("target.") + Twine(ImgId));
       auto *Foptcompile = addStringToModule(
@@ -1071,17 +1212,40 @@ private:
       if (!BinOrErr)
         return BinOrErr.takeError();
       MemoryBuffer *Bin = *BinOrErr;
+      MemoryBuffer *LoadedBin = Bin;
       if (Img.File != "-" && Kind == OffloadKind::OpenMP &&
           AddOpenMPOffloadNotes) {
         // Adding ELF notes for STDIN is not supported yet.
         Bin = addELFNotes(Bin, Img.File);
       }
+      if (Kind == OffloadKind::SYCL && OffloadCompressDevImgs &&
+          Img.Tgt != "native_cpu" &&
+          Bin->getBufferSize() >= OffloadCompressThreshold) {
+        if (!llvm::compression::zstd::isAvailable()) {
+          WithColor::warning(errs(), ToolName)
+              << "'-offload-compress' is ignored, as the tool is built "
+                 "without zstd support\n";
+        } else {
+          Bin = compressDeviceImage(Bin, Img.File);
+          Fmt = BinaryImageFormat::compressed_none;
+        }
+      }
+      auto *Ffmt = ConstantInt::get(Type::getInt8Ty(C), Fmt);
       std::pair<Constant *, Constant *> Fbin;
       if (Img.Tgt == "native_cpu") {
         auto FBinOrErr = addDeclarationsForNativeCPU(Img.EntriesFile);
         if (!FBinOrErr)
           return FBinOrErr.takeError();
         Fbin = *FBinOrErr;
+      } else if (UseIncbin && Img.File != "-" && Bin == LoadedBin) {
+        // The images read from stdin, compressed or with added notes only
+        // exist in memory, they are still copied into the module.
+        auto FBinOrErr = addIncbinImageToModule(
+            Img.File, Twine(OffloadKindTag) + Twine(ImgId) + Twine(".data"),
+            Kind, Img.Tgt);
+        if (!FBinOrErr)
+          return FBinOrErr.takeError();
+        Fbin = *FBinOrErr;
       } else {
         Fbin = addDeviceImageToModule(
             ArrayRef<char>(Bin->getBufferStart(), Bin->getBufferSize()),
@@ -1735,6 +1899,7 @@ int main(int argc, const char **argv) {
     cl::PrintHelpMessage();
     return 0;
   }
+  TimeTracerRAII TimeTracer(argv[0]);
   auto reportError = [argv](Error E) {
     logAllUnhandledErrors(std::move(E), WithColor::error(errs(), argv[0]));
   };
@@ -1872,7 +2037,10 @@ int main(int argc, const char **argv) {
   }
 
   // Create a wrapper for device binaries.
-  Expected<const Module *> ModOrErr = Wr.wrap();
+  Expected<const Module *> ModOrErr = [&] {
+    TimeTraceScope Scope("Wrap device images");
+    return Wr.wrap();
+  }();
   if (!ModOrErr) {
     reportError(ModOrErr.takeError());
     return 1;
@@ -1883,7 +2051,10 @@ int main(int argc, const char **argv) {
 #endif
 
   // And write its bitcode to the file.
-  WriteBitcodeToFile(**ModOrErr, Out.os());
+  {
+    TimeTraceScope Scope("Write bitcode");
+    WriteBitcodeToFile(**ModOrErr, Out.os());
+  }
   if (Out.os().has_error()) {
     reportError(createFileError(Output, Out.os().error()));
     return 1;
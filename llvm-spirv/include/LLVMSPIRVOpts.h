@@ -46,6 +46,8 @@
 #include <cstdint>
 #include <map>
 #include <optional>
+#include <set>
+#include <string>
 #include <unordered_map>
 
 namespace llvm {
@@ -235,6 +237,13 @@ public:
   }
   BuiltinFormat getBuiltinFormat() const noexcept { return SPIRVBuiltinFormat; }
 
+  void setEntryPointsToTranslate(std::set<std::string> Names) {
+    EntryPointsToTranslate = std::move(Names);
+  }
+  const std::set<std::string> &getEntryPointsToTranslate() const noexcept {
+    return EntryPointsToTranslate;
+  }
+
 private:
   // Common translation options
   VersionNumber MaxVersion = VersionNumber::MaximumVersion;
@@ -281,6 +290,10 @@ private:
   bool PreserveAuxData = false;
 
   BuiltinFormat SPIRVBuiltinFormat = BuiltinFormat::Function;
+
+  // Names of the functions to translate from SPIR-V, with the functions they
+  // use. All the functions are translated when it is empty.
+  std::set<std::string> EntryPointsToTranslate;
 };
 
 } // namespace SPIRV
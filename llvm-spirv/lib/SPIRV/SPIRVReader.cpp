@@ -3035,10 +3035,16 @@ Function *SPIRVToLLVM::transFunction(SPIRVFunction *BF) {
   }
 
   transLLVMLoopMetadata(F);
+  DbgTran->attachSubprogram(BF->getId(), F);
 
   return F;
 }
 
+bool SPIRVToLLVM::isTranslatedEagerly(SPIRVFunction *BF) const {
+  const std::set<std::string> &EntryPoints = BM->getEntryPointsToTranslate();
+  return EntryPoints.empty() || EntryPoints.count(BF->getName());
+}
+
 Value *SPIRVToLLVM::transAsmINTEL(SPIRVAsmINTEL *BA) {
   assert(BA);
   bool HasSideEffect = BA->hasDecorate(DecorationSideEffectsINTEL);
@@ -3392,10 +3398,19 @@ bool SPIRVToLLVM::translate() {
     DbgTran->transDebugInst(EI);
   }
 
+  // The functions which are not translated eagerly are translated when their
+  // uses are, so only the functions reachable from the entry points to
+  // translate end up in the module.
   for (unsigned I = 0, E = BM->getNumFunctions(); I != E; ++I) {
-    transFunction(BM->getFunction(I));
-    transUserSemantic(BM->getFunction(I));
+    if (isTranslatedEagerly(BM->getFunction(I))) {
+      transFunction(BM->getFunction(I));
+      transUserSemantic(BM->getFunction(I));
+    }
   }
+  for (unsigned I = 0, E = BM->getNumFunctions(); I != E; ++I)
+    if (!isTranslatedEagerly(BM->getFunction(I)) &&
+        FuncMap.count(BM->getFunction(I)))
+      transUserSemantic(BM->getFunction(I));
 
   transGlobalAnnotations();
 
@@ -4127,6 +4142,8 @@ bool SPIRVToLLVM::transMetadata() {
   for (unsigned I = 0, E = BM->getNumFunctions(); I != E; ++I) {
     SPIRVFunction *BF = BM->getFunction(I);
     Function *F = static_cast<Function *>(getTranslatedValue(BF));
+    if (!F && !isTranslatedEagerly(BF))
+      continue;
     assert(F && "Invalid translated function");
 
     transOCLMetadata(BF);
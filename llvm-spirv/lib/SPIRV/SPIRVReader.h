@@ -104,6 +104,10 @@ public:
   std::vector<Value *> transValue(const std::vector<SPIRVValue *> &,
                                   Function *F, BasicBlock *);
   Function *transFunction(SPIRVFunction *F);
+  /// Tells if F is translated before it is used, that is when no entry
+  /// points to translate are given or when F is one of them. The other
+  /// functions are only translated when they are used.
+  bool isTranslatedEagerly(SPIRVFunction *F) const;
   Value *transBlockInvoke(SPIRVValue *Invoke, BasicBlock *BB);
   Instruction *transWGSizeQueryBI(SPIRVInstruction *BI, BasicBlock *BB);
   Instruction *transSGSizeQueryBI(SPIRVInstruction *BI, BasicBlock *BB);
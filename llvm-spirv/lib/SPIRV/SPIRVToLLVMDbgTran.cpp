@@ -1005,13 +1005,21 @@ void SPIRVToLLVMDbgTran::transFunctionBody(DISubprogram *DIS, SPIRVId FuncId) {
   SPIRVEntry *E = BM->getEntry(FuncId);
   if (E->getOpCode() == OpFunction) {
     SPIRVFunction *BF = static_cast<SPIRVFunction *>(E);
+    // The other functions get their subprogram if they are used.
+    if (!SPIRVReader->isTranslatedEagerly(BF))
+      return;
     llvm::Function *F = SPIRVReader->transFunction(BF);
     assert(F && "Translation of function failed!");
-    if (!F->hasMetadata("dbg"))
-      F->setMetadata("dbg", DIS);
+    attachSubprogram(FuncId, F);
   }
 }
 
+void SPIRVToLLVMDbgTran::attachSubprogram(SPIRVId FuncId, Function *F) {
+  auto It = FuncMap.find(FuncId);
+  if (It != FuncMap.end() && !F->hasMetadata("dbg"))
+    F->setMetadata("dbg", It->second);
+}
+
 DINode *
 SPIRVToLLVMDbgTran::transFunctionDefinition(const SPIRVExtInst *DebugInst) {
   using namespace SPIRVDebug::Operand::FunctionDefinition;
@@ -87,6 +87,9 @@ public:
   Instruction *transDebugIntrinsic(const SPIRVExtInst *DebugInst,
                                    BasicBlock *BB);
   void finalize();
+  /// Attaches its subprogram to F, translated from BF after the debug info of
+  /// BF.
+  void attachSubprogram(SPIRVId FuncId, Function *F);
 
 private:
   DIFile *getFile(const SPIRVId SourceId);
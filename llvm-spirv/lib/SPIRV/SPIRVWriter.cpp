@@ -84,9 +84,11 @@
 #include "llvm/IR/TypedPointerType.h"
 #include "llvm/Pass.h"
 #include "llvm/Passes/PassBuilder.h"
+#include "llvm/Passes/StandardInstrumentations.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/TargetParser/Triple.h"
 #include "llvm/Transforms/Utils/LoopSimplify.h"
 #include "llvm/Transforms/Utils/Mem2Reg.h"
@@ -5649,6 +5651,7 @@ static auto stablePreDominatorTraversal(Function &F, const DominatorTree &DT) {
 }
 
 void LLVMToSPIRVBase::transFunction(Function *I) {
+  llvm::TimeTraceScope TimeScope("TranslateFunction", I->getName());
   SPIRVFunction *BF = transFunctionDecl(I);
   // Creating all basic blocks before creating any instruction. SPIR-V requires
   // that blocks appear after their dominators, so stablePreDominatorTraversal
@@ -5701,8 +5704,11 @@ bool LLVMToSPIRVBase::translate() {
     return false;
   if (!transAddressingMode())
     return false;
-  if (!transGlobalVariables())
-    return false;
+  {
+    llvm::TimeTraceScope TimeScope("TranslateGlobalVariables");
+    if (!transGlobalVariables())
+      return false;
+  }
 
   for (auto &F : *M) {
     auto *FT = F.getFunctionType();
@@ -5730,6 +5736,7 @@ bool LLVMToSPIRVBase::translate() {
   for (auto *I : Defs)
     transFunction(I);
 
+  llvm::TimeTraceScope TimeScope("TranslateMetadata");
   if (!transMetadata())
     return false;
   if (!transExecutionMode())
@@ -6757,7 +6764,12 @@ bool runSpirvWriterPasses(Module *M, std::ostream *OS, std::string &ErrMsg,
   FunctionAnalysisManager FAM;
   ModuleAnalysisManager MAM;
 
-  PassBuilder PB;
+  // The standard instrumentations trace the time of each pass when the time
+  // profiler is enabled.
+  PassInstrumentationCallbacks PIC;
+  StandardInstrumentations SI(M->getContext(), /*DebugLogging=*/false);
+  SI.registerCallbacks(PIC);
+  PassBuilder PB(nullptr, PipelineTuningOptions(), std::nullopt, &PIC);
   PB.registerModuleAnalyses(MAM);
   PB.registerCGSCCAnalyses(CGAM);
   PB.registerFunctionAnalyses(FAM);
@@ -6770,8 +6782,10 @@ bool runSpirvWriterPasses(Module *M, std::ostream *OS, std::string &ErrMsg,
   if (BM->getError(ErrMsg) != SPIRVEC_Success)
     return false;
 
-  if (WriteSpirv)
+  if (WriteSpirv) {
+    llvm::TimeTraceScope TimeScope("WriteSPIRV");
     *OS << *BM;
+  }
 
   return true;
 }
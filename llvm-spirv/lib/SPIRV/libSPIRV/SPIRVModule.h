@@ -557,6 +557,10 @@ public:
     return TranslationOpts.getBuiltinFormat();
   }
 
+  const std::set<std::string> &getEntryPointsToTranslate() const noexcept {
+    return TranslationOpts.getEntryPointsToTranslate();
+  }
+
   SPIRVExtInstSetKind getDebugInfoEIS() const {
     switch (TranslationOpts.getDebugInfoEIS()) {
     case DebugInfoEIS::SPIRV_Debug:
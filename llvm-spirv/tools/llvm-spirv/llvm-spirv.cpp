@@ -58,6 +58,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/ToolOutputFile.h"
 
 #ifdef LLVM_SPIRV_HAVE_SPIRV_TOOLS
@@ -130,6 +131,13 @@ static cl::list<std::string> SPIRVAllowUnknownIntrinsics(
              "(default) would naturally allow all unknown intrinsics"),
     cl::value_desc("intrinsic_prefix_1,intrinsic_prefix_2"), cl::ValueOptional);
 
+static cl::list<std::string> SPIRVEntryPoints(
+    "spirv-entry-points", cl::CommaSeparated,
+    cl::desc("Only translate the listed functions from SPIR-V, with the "
+             "functions they use.\nAll the functions are translated when it "
+             "is not given"),
+    cl::value_desc("function_name_1,function_name_2"), cl::ValueRequired);
+
 static cl::opt<bool> SPIRVGenKernelArgNameMD(
     "spirv-gen-kernel-arg-name-md", cl::init(false),
     cl::desc("Enable generating OpenCL kernel argument name "
@@ -267,6 +275,19 @@ static cl::opt<bool> SPIRVReplaceLLVMFmulAddWithOpenCLMad(
              "instruction from OpenCL extended instruction set (deprecated)"),
     cl::init(true));
 
+static cl::opt<bool> TimeTrace("time-trace", cl::desc("Record time trace"));
+
+static cl::opt<unsigned> TimeTraceGranularity(
+    "time-trace-granularity",
+    cl::desc(
+        "Minimum time granularity (in microseconds) traced by time profiler"),
+    cl::init(500), cl::Hidden);
+
+static cl::opt<std::string>
+    TimeTraceFile("time-trace-file",
+                  cl::desc("Specify time trace file destination"),
+                  cl::value_desc("filename"));
+
 static cl::opt<SPIRV::BuiltinFormat> SPIRVBuiltinFormat(
     "spirv-builtin-format",
     cl::desc("Set LLVM-IR representation of SPIR-V builtin variables:"),
@@ -286,6 +307,24 @@ static std::string removeExt(const std::string &FileName) {
 
 static ExitOnError ExitOnErr;
 
+struct TimeTracerRAII {
+  TimeTracerRAII(StringRef ProgramName) {
+    if (TimeTrace)
+      timeTraceProfilerInitialize(TimeTraceGranularity, ProgramName);
+  }
+  ~TimeTracerRAII() {
+    if (TimeTrace) {
+      if (auto E = timeTraceProfilerWrite(TimeTraceFile, OutputFile)) {
+        handleAllErrors(std::move(E), [&](const StringError &SE) {
+          errs() << SE.getMessage() << "\n";
+        });
+        return;
+      }
+      timeTraceProfilerCleanup();
+    }
+  }
+};
+
 #ifdef LLVM_SPIRV_HAVE_SPIRV_TOOLS
 /// Stream buffer that captures written data into a vector and allows reading
 /// the data back as an array of uint32_t's.
@@ -313,12 +352,15 @@ private:
 static int convertLLVMToSPIRV(const SPIRV::TranslatorOpts &Opts) {
   LLVMContext Context;
 
-  std::unique_ptr<MemoryBuffer> MB =
-      ExitOnErr(errorOrToExpected(MemoryBuffer::getFileOrSTDIN(InputFile)));
-  std::unique_ptr<Module> M =
-      ExitOnErr(getOwningLazyBitcodeModule(std::move(MB), Context,
-                                           /*ShouldLazyLoadMetadata=*/true));
-  ExitOnErr(M->materializeAll());
+  std::unique_ptr<Module> M;
+  {
+    TimeTraceScope TimeScope("ReadBitcode");
+    std::unique_ptr<MemoryBuffer> MB =
+        ExitOnErr(errorOrToExpected(MemoryBuffer::getFileOrSTDIN(InputFile)));
+    M = ExitOnErr(getOwningLazyBitcodeModule(std::move(MB), Context,
+                                             /*ShouldLazyLoadMetadata=*/true));
+    ExitOnErr(M->materializeAll());
+  }
 
   if (OutputFile.empty()) {
     if (InputFile == "-")
@@ -705,6 +747,7 @@ int main(int Ac, char **Av) {
   PrettyStackTraceProgram X(Ac, Av);
 
   cl::ParseCommandLineOptions(Ac, Av, "LLVM/SPIR-V translator");
+  TimeTracerRAII TimeTracer(Av[0]);
 
   if (InputFile != "-" && isFileEmpty(InputFile)) {
     errs() << "Can't translate, file is empty\n";
@@ -794,6 +837,17 @@ int main(int Ac, char **Av) {
     }
   }
 
+  if (SPIRVEntryPoints.getNumOccurrences() != 0) {
+    if (!IsReverse) {
+      errs() << "Note: --spirv-entry-points option ignored as it only "
+                "affects translation from SPIR-V to LLVM IR";
+    } else {
+      Opts.setEntryPointsToTranslate(
+          std::set<std::string>(SPIRVEntryPoints.begin(),
+                                SPIRVEntryPoints.end()));
+    }
+  }
+
   if (SPIRVAllowExtraDIExpressions.getNumOccurrences() != 0) {
     Opts.setAllowExtraDIExpressionsEnabled(SPIRVAllowExtraDIExpressions);
   }
@@ -55,6 +55,15 @@ public:
 FunctionPass *createESIMDLowerLoadStorePass();
 void initializeESIMDLowerLoadStorePass(PassRegistry &);
 
+// Merges the adjacent vector loads, and the adjacent vector stores, of the
+// ESIMD functions into wider ones, so that the block accesses of unrolled
+// loops are done by fewer block messages.
+class ESIMDMergeBlockAccessesPass
+    : public PassInfoMixin<ESIMDMergeBlockAccessesPass> {
+public:
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &);
+};
+
 // - Converts simd* function parameters and return values passed by pointer to
 // pass-by-value
 //   (where possible)
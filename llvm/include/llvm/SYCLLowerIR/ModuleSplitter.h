@@ -32,6 +32,7 @@ namespace module_split {
 enum IRSplitMode {
   SPLIT_PER_TU,     // one module per translation unit
   SPLIT_PER_KERNEL, // one module per kernel
+  SPLIT_BY_SIZE,    // modules of a target size, grouping kernels sharing code
   SPLIT_AUTO,       // automatically select split mode
   SPLIT_NONE        // no splitting
 };
@@ -46,6 +47,7 @@ enum class SyclEsimdSplitStatus { SYCL_ONLY, ESIMD_ONLY, SYCL_AND_ESIMD };
 enum EntryPointsGroupScope {
   Scope_PerKernel, // one entry per kernel
   Scope_PerModule, // one entry per module
+  Scope_BySize,    // entries grouped by size and by the code they share
   Scope_Global     // single entry in the map for all kernels
 };
 
@@ -199,6 +201,17 @@ public:
 #endif // NDEBUG
 };
 
+// Parameters of the SPLIT_BY_SIZE mode.
+struct SizeSplitOptions {
+  // Number of LLVM IR instructions a split module is filled up to. Entry
+  // points bigger than that get a module of their own.
+  unsigned TargetSize = 20000;
+  // Sets of kernel names which are known to run together, e.g. from a
+  // profile of the application. Kernels of a set are grouped together first,
+  // then the ones sharing the most code.
+  std::vector<std::vector<std::string>> KernelsRunTogether;
+};
+
 // Module split support interface.
 // It gets a module (in a form of module descriptor, to get additional info) and
 // a collection of entry points groups. Each group specifies subset entry points
@@ -253,7 +266,8 @@ SmallVector<ModuleDesc, 2> splitByESIMD(ModuleDesc &&MD,
 
 std::unique_ptr<ModuleSplitterBase>
 getDeviceCodeSplitter(ModuleDesc &&MD, IRSplitMode Mode, bool IROutputOnly,
-                      bool EmitOnlyKernelsAsEntryPoints);
+                      bool EmitOnlyKernelsAsEntryPoints,
+                      const SizeSplitOptions &SizeOptions = {});
 
 #ifndef NDEBUG
 void dumpEntryPoints(const EntryPointSet &C, const char *msg = "", int Tab = 0);
@@ -0,0 +1,28 @@
+//===----- SYCLMergeFunctions.h - Merge identical SYCL device functions ---===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Pass merges the identical device functions of a linked SYCL device module,
+// and makes the identical kernels call the same implementation function.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SYCL_MERGE_FUNCTIONS_H
+#define LLVM_SYCL_MERGE_FUNCTIONS_H
+
+#include "llvm/IR/PassManager.h"
+
+namespace llvm {
+
+class SYCLMergeFunctionsPass : public PassInfoMixin<SYCLMergeFunctionsPass> {
+public:
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &);
+};
+
+} // namespace llvm
+
+#endif // LLVM_SYCL_MERGE_FUNCTIONS_H
@@ -0,0 +1,218 @@
+//=-- ESIMDMergeBlockAccesses.cpp - merge adjacent ESIMD block accesses ---=//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//=------------------------------------------------------------------------=//
+// The block loads and stores of ESIMD are lowered to vector loads and stores,
+// which the GPU backend maps to block messages one to one. An unrolled loop
+// loading or storing consecutive blocks therefore sends as many narrow
+// messages. This pass merges the vector loads, and the vector stores, of a
+// basic block which access adjacent memory into a single wider one, as long
+// as no other memory access is in between and the merged access does not
+// exceed the size of a block message:
+//
+//   %a = load <8 x float>, ptr %p, align 64
+//   %q = getelementptr inbounds i8, ptr %p, i64 32
+//   %b = load <8 x float>, ptr %q, align 32
+// ->
+//   %ab = load <16 x float>, ptr %p, align 64
+//   %a = shufflevector <16 x float> %ab, <16 x float> poison, <0, ..., 7>
+//   %b = shufflevector <16 x float> %ab, <16 x float> poison, <8, ..., 15>
+//=------------------------------------------------------------------------=//
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/SYCLLowerIR/ESIMD/ESIMDUtils.h"
+#include "llvm/SYCLLowerIR/ESIMD/LowerESIMD.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <optional>
+
+using namespace llvm;
+using namespace llvm::esimd;
+
+#define DEBUG_TYPE "esimd-merge-block-accesses"
+
+STATISTIC(NumMergedLoads, "Number of ESIMD vector loads merged");
+STATISTIC(NumMergedStores, "Number of ESIMD vector stores merged");
+
+static cl::opt<unsigned> MaxMergedBytes(
+    "esimd-merge-block-max-bytes", cl::Hidden, cl::init(256),
+    cl::desc("Maximum size in bytes of the vector loads and stores made by "
+             "merging adjacent ESIMD block accesses"));
+
+namespace {
+// A vector load or store, with the base and the constant offset of its
+// address.
+struct BlockAccess {
+  Instruction *I;
+  Value *Base;
+  int64_t Offset;
+  uint64_t Size;
+};
+
+FixedVectorType *getAccessType(Instruction *I) {
+  Type *Ty = I->getType();
+  if (auto *SI = dyn_cast<StoreInst>(I))
+    Ty = SI->getValueOperand()->getType();
+  auto *VecTy = dyn_cast<FixedVectorType>(Ty);
+  // The elements must be byte sized for the vector not to have padding bits.
+  if (!VecTy || VecTy->getScalarSizeInBits() % 8 != 0)
+    return nullptr;
+  return VecTy;
+}
+
+bool getBlockAccess(Instruction *I, const DataLayout &DL, BlockAccess &Acc) {
+  Value *Ptr = getLoadStorePointerOperand(I);
+  FixedVectorType *VecTy = getAccessType(I);
+  if (!Ptr || !VecTy)
+    return false;
+  if (auto *LI = dyn_cast<LoadInst>(I); LI && !LI->isSimple())
+    return false;
+  if (auto *SI = dyn_cast<StoreInst>(I); SI && !SI->isSimple())
+    return false;
+  APInt Offset(DL.getIndexTypeSizeInBits(Ptr->getType()), 0);
+  Acc.I = I;
+  Acc.Base = Ptr->stripAndAccumulateConstantOffsets(
+      DL, Offset, /*AllowNonInbounds=*/true);
+  Acc.Offset = Offset.getSExtValue();
+  Acc.Size = DL.getTypeStoreSize(VecTy).getFixedValue();
+  return true;
+}
+
+// Returns true if the access Hi directly follows the access Lo in memory,
+// and both can be done by a single vector access.
+bool canMerge(const BlockAccess &Lo, const BlockAccess &Hi) {
+  if (Lo.Base != Hi.Base || Lo.Offset + (int64_t)Lo.Size != Hi.Offset)
+    return false;
+  FixedVectorType *LoTy = getAccessType(Lo.I);
+  FixedVectorType *HiTy = getAccessType(Hi.I);
+  if (LoTy->getElementType() != HiTy->getElementType() ||
+      getLoadStorePointerOperand(Lo.I)->getType() !=
+          getLoadStorePointerOperand(Hi.I)->getType())
+    return false;
+  // The stores join the stored values with a single shuffle of two vectors of
+  // the same type.
+  if (isa<StoreInst>(Lo.I) && LoTy != HiTy)
+    return false;
+  // Merged accesses which are not a power of 2 would be split again by the
+  // backend.
+  unsigned NumElts = LoTy->getNumElements() + HiTy->getNumElements();
+  return isPowerOf2_32(NumElts) && Lo.Size + Hi.Size <= MaxMergedBytes;
+}
+
+SmallVector<int, 32> getSequentialMask(unsigned Start, unsigned NumElts) {
+  SmallVector<int, 32> Mask;
+  for (unsigned I = 0; I < NumElts; ++I)
+    Mask.push_back(Start + I);
+  return Mask;
+}
+
+// Replaces the load Lo and the load Hi which follows it in the basic block by
+// a single load at the position of Lo.
+Instruction *mergeLoads(LoadInst *Lo, LoadInst *Hi) {
+  auto *LoTy = cast<FixedVectorType>(Lo->getType());
+  auto *HiTy = cast<FixedVectorType>(Hi->getType());
+  auto *WideTy = FixedVectorType::get(
+      LoTy->getElementType(), LoTy->getNumElements() + HiTy->getNumElements());
+  IRBuilder<> Builder(Lo);
+  LoadInst *Wide = Builder.CreateAlignedLoad(
+      WideTy, Lo->getPointerOperand(), Lo->getAlign(), Lo->getName());
+  Wide->setDebugLoc(Lo->getDebugLoc());
+  Value *LoPart = Builder.CreateShuffleVector(
+      Wide, getSequentialMask(0, LoTy->getNumElements()));
+  Value *HiPart = Builder.CreateShuffleVector(
+      Wide, getSequentialMask(LoTy->getNumElements(), HiTy->getNumElements()));
+  Lo->replaceAllUsesWith(LoPart);
+  Hi->replaceAllUsesWith(HiPart);
+  Lo->eraseFromParent();
+  Hi->eraseFromParent();
+  ++NumMergedLoads;
+  return Wide;
+}
+
+// Replaces the store First and the store Second which follows it in the basic
+// block by a single store at the position of Second.
+Instruction *mergeStores(StoreInst *First, StoreInst *Second, bool FirstIsLo) {
+  StoreInst *Lo = FirstIsLo ? First : Second;
+  StoreInst *Hi = FirstIsLo ? Second : First;
+  auto *Ty = cast<FixedVectorType>(Lo->getValueOperand()->getType());
+  IRBuilder<> Builder(Second);
+  Value *Joined = Builder.CreateShuffleVector(
+      Lo->getValueOperand(), Hi->getValueOperand(),
+      getSequentialMask(0, 2 * Ty->getNumElements()));
+  StoreInst *Wide = Builder.CreateAlignedStore(Joined, Lo->getPointerOperand(),
+                                               Lo->getAlign());
+  Wide->setDebugLoc(Second->getDebugLoc());
+  First->eraseFromParent();
+  Second->eraseFromParent();
+  ++NumMergedStores;
+  return Wide;
+}
+
+bool mergeBlockAccesses(BasicBlock &BB, const DataLayout &DL) {
+  bool Modified = false;
+  // The loads since the last instruction which may write to memory, and the
+  // store which is the last instruction accessing memory.
+  SmallVector<BlockAccess, 8> Loads;
+  std::optional<BlockAccess> Store;
+  for (Instruction &I : make_early_inc_range(BB)) {
+    BlockAccess Acc;
+    if (isa<LoadInst>(I) && getBlockAccess(&I, DL, Acc)) {
+      Store.reset();
+      auto Lo = find_if(Loads,
+                        [&](const BlockAccess &L) { return canMerge(L, Acc); });
+      if (Lo == Loads.end()) {
+        Loads.push_back(Acc);
+        continue;
+      }
+      Lo->I = mergeLoads(cast<LoadInst>(Lo->I), cast<LoadInst>(&I));
+      Lo->Size += Acc.Size;
+      Modified = true;
+      continue;
+    }
+    if (isa<StoreInst>(I) && getBlockAccess(&I, DL, Acc)) {
+      Loads.clear();
+      if (!Store || (!canMerge(*Store, Acc) && !canMerge(Acc, *Store))) {
+        Store = Acc;
+        continue;
+      }
+      bool PrevIsLo = canMerge(*Store, Acc);
+      BlockAccess Merged = PrevIsLo ? *Store : Acc;
+      Merged.I = mergeStores(cast<StoreInst>(Store->I), cast<StoreInst>(&I),
+                             PrevIsLo);
+      Merged.Size = Store->Size + Acc.Size;
+      Store = Merged;
+      Modified = true;
+      continue;
+    }
+    if (I.mayWriteToMemory())
+      Loads.clear();
+    if (I.mayReadOrWriteMemory())
+      Store.reset();
+  }
+  return Modified;
+}
+} // namespace
+
+PreservedAnalyses
+ESIMDMergeBlockAccessesPass::run(Function &F, FunctionAnalysisManager &) {
+  if (!isESIMD(F))
+    return PreservedAnalyses::all();
+  const DataLayout &DL = F.getParent()->getDataLayout();
+  bool Modified = false;
+  for (BasicBlock &BB : F)
+    Modified |= mergeBlockAccesses(BB, DL);
+  if (!Modified)
+    return PreservedAnalyses::all();
+  PreservedAnalyses PA;
+  PA.preserveSet<CFGAnalyses>();
+  return PA;
+}
@@ -38,6 +38,10 @@
 // any of its successors. This order provides correct nesting of scopes and
 // ignores back-branches.
 //
+// The functions allocating SLM which are called with different SLM frame sizes
+// are first cloned for each of them (see specializeSLMFrames), so that the SLM
+// offsets computed below don't depend on the largest frame of all the callers.
+//
 // Then the pass uses the call graph to
 // 1) For each <scope, kernel> pair, determine a maximum possible amount of SLM
 // allocated by __esimd_slm_alloc calls along any path from the scope to the
@@ -67,7 +71,10 @@
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 
+#include <map>
 #include <set>
 #include <unordered_map>
 
@@ -75,6 +82,12 @@
 
 namespace llvm {
 
+static cl::opt<unsigned> MaxSLMFrameClones(
+    "esimd-max-slm-frame-clones", cl::Hidden, cl::init(64),
+    cl::desc("Maximum number of the functions cloned per SLM frame size at "
+             "their call sites, so that the kernels reserve the SLM they use "
+             "rather than the largest frame of any caller"));
+
 namespace {
 
 #ifndef NDEBUG
@@ -282,6 +295,8 @@ private:
   };
 
   std::unordered_map<const Function *, FuncNodeSPtr> Func2Node;
+  // Maps a call to the node of the innermost scope or function it is made in.
+  std::unordered_map<const CallBase *, const Node *> Call2Node;
   SmallPtrSet<const Function *, 4> Kernels;
   std::set<ScopeNodeSPtr, ScopeNodeSPtrLess> Scopes;
 
@@ -415,6 +430,7 @@ public:
               E1.first->second = std::make_shared<FuncNode>(F1);
             }
             E1.first->second->addPred(CurScopePath.back());
+            Call2Node[CB] = CurScopePath.back().get();
           }
         }
         // Add unvisited successors to the work list.
@@ -457,6 +473,13 @@ public:
     return I->second;
   }
 
+  // Returns the node the call CB is made in, or nullptr if the call was not
+  // met, e.g. because it is in an unreachable basic block.
+  const Node *getCallerNode(const CallBase *CB) const {
+    auto I = Call2Node.find(CB);
+    return I == Call2Node.end() ? nullptr : I->second;
+  }
+
   size_t getNumSLMScopes() const { return Scopes.size(); }
 
 #ifndef NDEBUG
@@ -543,6 +566,78 @@ TraversalResult findMaxSLMUsageAlongAllPaths(const ScopedCallGraph::Node *Cur,
   return Res;
 }
 
+// The SLM offset of a scope is the largest SLM frame possible at its start, so
+// a function allocating SLM (directly or in its callees) places its scopes
+// after the largest frame of all its call sites, and every kernel calling it
+// reserves SLM up to there. This clones such functions for each SLM frame
+// size at their call sites, so that the scopes of the calls made with a
+// smaller frame share the SLM left free by it. The calls with the largest
+// frame keep calling the original function. As the callees of a clone are in
+// turn called with new frame sizes, the call graph is rebuilt and the
+// cloning repeated until no function is called with different frame sizes.
+// Returns the number of the clones made.
+unsigned specializeSLMFrames(Module &M) {
+  unsigned NumClones = 0;
+  for (bool Changed = true; Changed && NumClones < MaxSLMFrameClones;) {
+    Changed = false;
+    ScopedCallGraph SCG(M);
+    if (SCG.getNumSLMScopes() == 0)
+      break;
+    // Collect the nodes from which an __esimd_slm_alloc is reached.
+    SmallPtrSet<const ScopedCallGraph::Node *, 16> SLMUsers;
+    SmallVector<const ScopedCallGraph::Node *, 16> Wl;
+    for (const auto &Scope : SCG.getScopes())
+      if (isSlmAllocCall(Scope->getStart()))
+        Wl.push_back(Scope.get());
+    while (!Wl.empty()) {
+      const ScopedCallGraph::Node *N = Wl.pop_back_val();
+      if (!SLMUsers.insert(N).second)
+        continue;
+      for (const auto &Pred : N->preds())
+        Wl.push_back(Pred.get());
+    }
+    SmallVector<Function *, 16> Candidates;
+    for (Function &F : M)
+      if (!F.isDeclaration() && !esimd::isESIMDKernel(F) &&
+          SLMUsers.contains(SCG.getNode(&F).get()))
+        Candidates.push_back(&F);
+
+    Node2TraversalResultMap Results;
+    for (Function *F : Candidates) {
+      // Group the direct calls of F by the SLM frame size at the call site.
+      std::map<int, SmallVector<CallBase *, 4>> Frame2Calls;
+      for (User *U : F->users()) {
+        auto *CB = dyn_cast<CallBase>(U);
+        if (!CB || CB->getCalledFunction() != F)
+          continue;
+        const ScopedCallGraph::Node *Caller = SCG.getCallerNode(CB);
+        if (!Caller)
+          continue;
+        int Frame = findMaxSLMUsageAlongAllPaths(Caller, Results).first;
+        // Calls which are not reachable from any kernel are left alone.
+        if (Frame >= 0)
+          Frame2Calls[Frame].push_back(CB);
+      }
+      if (Frame2Calls.size() < 2)
+        continue;
+      Frame2Calls.erase(std::prev(Frame2Calls.end()));
+      for (auto &[Frame, Calls] : Frame2Calls) {
+        if (NumClones >= MaxSLMFrameClones)
+          break;
+        ValueToValueMapTy VMap;
+        Function *Clone = CloneFunction(F, VMap);
+        Clone->setName(F->getName() + ".slm" + Twine(Frame));
+        Clone->setLinkage(GlobalValue::InternalLinkage);
+        for (CallBase *CB : Calls)
+          CB->setCalledFunction(Clone);
+        ++NumClones;
+        Changed = true;
+      }
+    }
+  }
+  return NumClones;
+}
+
 size_t lowerSLMReservationCalls(Module &M) {
   // Create a detailed "scoped" call graph. Scope start/end is marked with
   // x = __esimd_slm_alloc / __esimd_slm_free(x)
@@ -559,6 +654,7 @@ size_t lowerSLMReservationCalls(Module &M) {
   // especially with -O0. So, some extra work is needed for -O0 to enable
   // usage of slm_allocator().
 
+  specializeSLMFrames(M);
   ScopedCallGraph SCG(M);
 #ifndef NDEBUG
   if (DebugLevel > 0) {
@@ -12,6 +12,9 @@
 //   the argument with found "target" function.
 // - Marks target functions with VCStackCall attribute as required by the Intel
 //   GPU backend.
+// - Inlines the found target function into the helper cloned for the call, so
+//   that the argument conversions of the helper and the callee are optimized
+//   together, for the types of this call only.
 // TODO:
 // - move VCStackCall markup to Intel GPU-specific part (BE) or design a new
 //   target-neutral attribute for markup.
@@ -31,6 +34,7 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
 
@@ -39,6 +43,11 @@
 using namespace llvm;
 using namespace llvm::sycl::utils;
 
+static cl::opt<bool> InlineInvokeSimdTargets(
+    "lower-invoke-simd-inline-targets", cl::Hidden, cl::init(true),
+    cl::desc("Inline the known targets of invoke_simd calls into the helpers "
+             "cloned for the calls"));
+
 namespace {
 
 constexpr char REQD_SUB_GROUP_SIZE_MD[] = "intel_reqd_sub_group_size";
@@ -246,6 +255,19 @@ void fixFunctionName(Function *F) {
   assert(Name.find('.') == std::string::npos);
 }
 
+// Inlines the call to the invoke_simd target in the helper cloned for an
+// invoke_simd call. The helper and the target then form a single ESIMD function
+// whose parameters are the SPMD arguments of this call, the unpacking of the
+// arguments by the helper and their uses by the target are optimized together.
+// \returns true if the call was inlined.
+bool inlineSimdTarget(CallInst *Call, Function *SimdF) {
+  if (!InlineInvokeSimdTargets || SimdF->isDeclaration() ||
+      !esimd::isESIMD(*SimdF) || SimdF->hasFnAttribute(Attribute::NoInline))
+    return false;
+  InlineFunctionInfo IFI;
+  return InlineFunction(*Call, IFI).isSuccess();
+}
+
 void markFunctionAsESIMD(Function *F) {
   LLVMContext &C = F->getContext();
 
@@ -315,9 +337,6 @@ bool processInvokeSimdCall(CallInst *InvokeSimd,
     // Call target is not known - don't do anything.
     return false;
   }
-  if (!SimdF->hasFnAttribute(INVOKE_SIMD_DIRECT_TARGET_ATTR)) {
-    SimdF->addFnAttr(INVOKE_SIMD_DIRECT_TARGET_ATTR);
-  }
 
   // The invoke_simd target is known at compile-time - optimize.
   // 1. find the call to f within the cloned helper - it is its first parameter
@@ -356,6 +375,11 @@ bool processInvokeSimdCall(CallInst *InvokeSimd,
     CallInst *TheTformedCall = cast<CallInst>(VMap[TheCall]);
     TheTformedCall->setCalledFunction(SimdF);
     fixFunctionName(NewHelper);
+    // The target is still called if it could not be inlined.
+    if (!inlineSimdTarget(TheTformedCall, SimdF) &&
+        !SimdF->hasFnAttribute(INVOKE_SIMD_DIRECT_TARGET_ATTR)) {
+      SimdF->addFnAttr(INVOKE_SIMD_DIRECT_TARGET_ATTR);
+    }
   }
 
   // 3. Clone and transform __builtin_invoke_simd call:
@@ -354,7 +354,9 @@ using InstrRange = std::pair<Instruction *, Instruction *>;
 //   ...
 //   B
 //   ... USE2(%I1_new) ...
-static void tformRange(const InstrRange &R, const Triple &TT) {
+//
+// Returns LeaderBB.
+static BasicBlock *tformRange(const InstrRange &R, const Triple &TT) {
   // Instructions seen between the first and the last
   SmallPtrSet<Instruction *, 16> Seen;
   Instruction *FirstSE = R.first;
@@ -382,6 +384,7 @@ static void tformRange(const InstrRange &R, const Triple &TT) {
   // 3) Insert work group barrier so that workers further read valid data
   //    (before the materialization reads inserted at step 2)
   spirv::genWGBarrier(BBb->front(), TT);
+  return LeaderBB;
 }
 
 namespace {
@@ -493,10 +496,69 @@ static void materializeLocalsInWIScopeBlocksImpl(
 }
 
 // Checks if there is a need to materialize value of given local in given work
-// item-scope basic block.
-static bool localMustBeMaterialized(const AllocaInst *L, const BasicBlock &BB) {
-  // TODO this is overly conservative - see speculations below.
-  return true;
+// item-scope basic block. This is the case if the local is read in the block
+// through its address or a pointer derived from it, or if any of them escapes,
+// in which case the reads can't be tracked. The reads executed by all WIs
+// outside of the WI scope blocks, which see the value materialized by the
+// preceding WI scope blocks, keep the local materialized in all of them.
+static bool
+localMustBeMaterialized(const AllocaInst *L, const BasicBlock &BB,
+                        const SmallPtrSetImpl<BasicBlock *> &WIScopeBBs,
+                        const SmallPtrSetImpl<BasicBlock *> &LeaderBBs) {
+  auto IsRead = [&](const Instruction *I) {
+    const BasicBlock *ReadBB = I->getParent();
+    return ReadBB == &BB ||
+           (!WIScopeBBs.count(ReadBB) && !LeaderBBs.count(ReadBB));
+  };
+  SmallVector<const Value *, 8> Ptrs{L};
+  SmallPtrSet<const Value *, 8> Visited{L};
+
+  while (!Ptrs.empty()) {
+    const Value *Ptr = Ptrs.pop_back_val();
+
+    for (const User *U : Ptr->users()) {
+      const auto *I = dyn_cast<Instruction>(U);
+
+      if (!I)
+        return true;
+      if (isa<GetElementPtrInst>(I) || isa<BitCastInst>(I) ||
+          isa<AddrSpaceCastInst>(I)) {
+        if (Visited.insert(I).second)
+          Ptrs.push_back(I);
+        continue;
+      }
+      if (I->isLifetimeStartOrEnd() || I->isDebugOrPseudoInst())
+        continue;
+      if (isa<LoadInst>(I)) {
+        if (IsRead(I))
+          return true;
+        continue;
+      }
+      if (const auto *SI = dyn_cast<StoreInst>(I)) {
+        // storing the address itself makes the local escape
+        if (SI->getValueOperand() == Ptr)
+          return true;
+        continue;
+      }
+      // parallel_for_work_item reads its arguments, such as the PFWI lambda
+      // object, and does not keep their addresses
+      if (isPFWICall(I)) {
+        if (IsRead(I))
+          return true;
+        continue;
+      }
+      if (const auto *MI = dyn_cast<MemIntrinsic>(I)) {
+        const auto *MTI = dyn_cast<MemTransferInst>(MI);
+        // a copy from the local is a read
+        if (MTI && MTI->getRawSource() == Ptr && IsRead(I))
+          return true;
+        continue;
+      }
+      // calls, PHIs, selects, comparisons etc. - assume the local escapes
+      return true;
+    }
+  }
+  return false;
 }
 
 // This function handles locals of kind 3 (see comments at the top of file).
@@ -535,13 +597,12 @@ static bool localMustBeMaterialized(const AllocaInst *L, const BasicBlock &BB) {
 // basic_block10: // WI scope
 //   use2(p1);
 //
-// TODO. This implementation is quite ineffective. Currently it materializes
-// all locals in all WI scope basic blocks.
-// Will be improved incrementally:
-// - For each alloca: determine all derived (via GEPs) pointers and make sure
-//   they don't escape. Then check if there are reads in current WI scope BB
-//   through either of those. If none of them escape and there are no reads then
-//   materialization of this alloca in this BB is not needed.
+// A local is materialized only in the WI scope blocks which read it, unless its
+// address or a pointer derived from it escapes (see localMustBeMaterialized).
+// The blocks where no local is materialized get neither the leader guard nor
+// the barrier.
+//
+// TODO. Further improvements:
 // - Materialization is not needed if there is dominating BB with materialized
 //   value, and there are no WG scope writes to this alloca on any path from
 //   that BB to current.
@@ -552,6 +613,7 @@ static bool localMustBeMaterialized(const AllocaInst *L, const BasicBlock &BB) {
 //
 void materializeLocalsInWIScopeBlocks(SmallPtrSetImpl<AllocaInst *> &Locals,
                                       SmallPtrSetImpl<BasicBlock *> &WIScopeBBs,
+                                      SmallPtrSetImpl<BasicBlock *> &LeaderBBs,
                                       const Triple &TT) {
   // maps local variable to its "shadow" workgroup-shared global:
   DenseMap<AllocaInst *, GlobalVariable *> Local2Shadow;
@@ -565,7 +627,7 @@ void materializeLocalsInWIScopeBlocks(SmallPtrSetImpl<AllocaInst *> &Locals,
   // Fill the local-to-shadow and basic block-to-locals maps:
   for (auto L : Locals) {
     for (auto *BB : WIScopeBBs) {
-      if (!localMustBeMaterialized(L, *BB))
+      if (!localMustBeMaterialized(L, *BB, WIScopeBBs, LeaderBBs))
         continue;
       if (Local2Shadow.find(L) == Local2Shadow.end()) {
         // lazily create a "shadow" for current local:
@@ -829,9 +891,12 @@ PreservedAnalyses SYCLLowerWGScopePass::run(Function &F,
   }
 #endif // NDEBUG
 
-  // Perform the transformation
+  // Perform the transformation, the blocks executed by the leader only are
+  // collected to tell which of the reads of the locals are executed by all WIs
+  SmallPtrSet<BasicBlock *, 16> LeaderBBs;
+
   for (auto &R : Ranges)
-    tformRange(R, TT);
+    LeaderBBs.insert(tformRange(R, TT));
 
   // There can be allocas not corresponding to any variable declared in user
   // code but generated by the compiler - e.g. for non-trivially typed
@@ -847,7 +912,7 @@ PreservedAnalyses SYCLLowerWGScopePass::run(Function &F,
     WIScopeBBs.insert(I->getParent());
 
   // Now materialize the locals:
-  materializeLocalsInWIScopeBlocks(Allocas, WIScopeBBs, TT);
+  materializeLocalsInWIScopeBlocks(Allocas, WIScopeBBs, LeaderBBs, TT);
 
   // Fixup captured addresses of private_memory instances in current WI
   for (auto *PFWICall : PFWICalls)
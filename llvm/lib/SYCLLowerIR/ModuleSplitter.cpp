@@ -30,6 +30,8 @@
 
 #include <algorithm>
 #include <map>
+#include <optional>
+#include <tuple>
 #include <utility>
 #include <variant>
 
@@ -53,6 +55,9 @@ EntryPointsGroupScope selectDeviceCodeGroupScope(const Module &M,
   case SPLIT_PER_KERNEL:
     return Scope_PerKernel;
 
+  case SPLIT_BY_SIZE:
+    return Scope_BySize;
+
   case SPLIT_AUTO: {
     if (AutoSplitIsGlobalScope)
       return Scope_Global;
@@ -945,11 +950,116 @@ std::string FunctionsCategorizer::computeCategoryFor(Function *F) const {
 
   return (std::string)Result;
 }
+
+// Splits a set of entry points into groups whose call graphs have about
+// Options.TargetSize instructions in total. A group is started with the first
+// entry point left, and filled with the entry points running together with it
+// first, then with those sharing the most instructions with the group, and
+// then with any other which still fits.
+std::vector<EntryPointSet>
+groupEntryPointsBySize(const EntryPointSet &EntryPoints,
+                       const DependencyGraph &CG,
+                       const DenseMap<const Function *, SmallVector<unsigned>>
+                           &RunTogetherSets,
+                       unsigned TargetSize) {
+  const unsigned N = EntryPoints.size();
+  // Functions reachable from each entry point, and the entry points reaching
+  // each function.
+  std::vector<SmallVector<const Function *>> Reach(N);
+  std::vector<uint64_t> ReachSize(N, 0);
+  DenseMap<const Function *, SmallVector<unsigned>> Users;
+  DenseMap<unsigned, SmallVector<unsigned>> SetMembers;
+  for (unsigned I = 0; I < N; ++I) {
+    SetVector<const GlobalValue *> Visited;
+    Visited.insert(EntryPoints[I]);
+    for (size_t Idx = 0; Idx < Visited.size(); ++Idx)
+      for (const GlobalValue *Dep : CG.dependencies(Visited[Idx]))
+        if (!isa<Function>(Dep) || !cast<Function>(Dep)->isDeclaration())
+          Visited.insert(Dep);
+    for (const GlobalValue *GV : Visited)
+      if (const auto *F = dyn_cast<Function>(GV)) {
+        Reach[I].push_back(F);
+        ReachSize[I] += F->getInstructionCount();
+        Users[F].push_back(I);
+      }
+    auto It = RunTogetherSets.find(EntryPoints[I]);
+    if (It != RunTogetherSets.end())
+      for (unsigned Set : It->second)
+        SetMembers[Set].push_back(I);
+  }
+
+  std::vector<EntryPointSet> Groups;
+  std::vector<bool> Assigned(N, false);
+  unsigned FirstLeft = 0;
+  while (true) {
+    while (FirstLeft < N && Assigned[FirstLeft])
+      ++FirstLeft;
+    if (FirstLeft == N)
+      break;
+
+    EntryPointSet &Group = Groups.emplace_back();
+    SmallPtrSet<const Function *, 32> InGroup;
+    uint64_t Size = 0;
+    // Instructions of the entry points left already in the group, and the
+    // number of sets of the group they run together in.
+    DenseMap<unsigned, uint64_t> Shared;
+    DenseMap<unsigned, unsigned> RunTogether;
+    auto Add = [&](unsigned I) {
+      Assigned[I] = true;
+      Group.insert(EntryPoints[I]);
+      for (const Function *F : Reach[I]) {
+        if (!InGroup.insert(F).second)
+          continue;
+        Size += F->getInstructionCount();
+        for (unsigned U : Users[F])
+          if (!Assigned[U])
+            Shared[U] += F->getInstructionCount();
+      }
+      auto It = RunTogetherSets.find(EntryPoints[I]);
+      if (It != RunTogetherSets.end())
+        for (unsigned Set : It->second)
+          for (unsigned U : SetMembers[Set])
+            if (!Assigned[U])
+              ++RunTogether[U];
+    };
+    auto Fits = [&](unsigned I) {
+      auto It = Shared.find(I);
+      uint64_t Added = ReachSize[I] - (It == Shared.end() ? 0 : It->second);
+      return Size + Added <= TargetSize;
+    };
+
+    Add(FirstLeft);
+    while (true) {
+      std::optional<unsigned> Best;
+      auto Better = [&](unsigned I) {
+        if (!Best)
+          return true;
+        unsigned R = RunTogether.lookup(I), BestR = RunTogether.lookup(*Best);
+        uint64_t S = Shared.lookup(I), BestS = Shared.lookup(*Best);
+        return std::tie(R, S, *Best) > std::tie(BestR, BestS, I);
+      };
+      for (const auto &[I, S] : Shared)
+        if (!Assigned[I] && Fits(I) && Better(I))
+          Best = I;
+      for (const auto &[I, R] : RunTogether)
+        if (!Assigned[I] && Fits(I) && Better(I))
+          Best = I;
+      for (unsigned I = FirstLeft; !Best && I < N; ++I)
+        if (!Assigned[I] && Fits(I))
+          Best = I;
+      if (!Best)
+        break;
+      Add(*Best);
+    }
+  }
+  return Groups;
+}
 } // namespace
 
 std::unique_ptr<ModuleSplitterBase>
 getDeviceCodeSplitter(ModuleDesc &&MD, IRSplitMode Mode, bool IROutputOnly,
-                      bool EmitOnlyKernelsAsEntryPoints) {
+                      bool EmitOnlyKernelsAsEntryPoints,
+                      const SizeSplitOptions &SizeOptions) {
   FunctionsCategorizer Categorizer;
 
   EntryPointsGroupScope Scope =
@@ -968,12 +1078,15 @@ getDeviceCodeSplitter(ModuleDesc &&MD, IRSplitMode Mode, bool IROutputOnly,
         [](Function *F) -> std::string { return F->getName().str(); });
     break;
   case Scope_PerModule:
+  case Scope_BySize:
     // The most complex case, because we should account for many other features
     // like aspects used in a kernel, large-grf mode, reqd-work-group-size, etc.
 
-    // This is core of per-source device code split
-    Categorizer.registerSimpleStringAttributeRule(
-        sycl::utils::ATTR_SYCL_MODULE_ID);
+    // This is core of per-source device code split. The split by size groups
+    // the kernels of all the sources, which are split further by size below.
+    if (Scope == Scope_PerModule)
+      Categorizer.registerSimpleStringAttributeRule(
+          sycl::utils::ATTR_SYCL_MODULE_ID);
 
     // Optional features
     // Note: Add more rules at the end of the list to avoid chaning orders of
@@ -1004,6 +1117,24 @@ getDeviceCodeSplitter(ModuleDesc &&MD, IRSplitMode Mode, bool IROutputOnly,
     EntryPointsMap[std::move(Key)].insert(&F);
   }
 
+  if (Scope == Scope_BySize) {
+    DependencyGraph CG(MD.getModule());
+    DenseMap<const Function *, SmallVector<unsigned>> RunTogetherSets;
+    for (unsigned Set = 0; Set < SizeOptions.KernelsRunTogether.size(); ++Set)
+      for (const std::string &Name : SizeOptions.KernelsRunTogether[Set])
+        if (const Function *F = MD.getModule().getFunction(Name))
+          RunTogetherSets[F].push_back(Set);
+
+    std::map<std::string, EntryPointSet> SizedEntryPointsMap;
+    for (auto &[Key, EntryPoints] : EntryPointsMap) {
+      std::vector<EntryPointSet> Sized = groupEntryPointsBySize(
+          EntryPoints, CG, RunTogetherSets, SizeOptions.TargetSize);
+      for (size_t I = 0; I < Sized.size(); ++I)
+        SizedEntryPointsMap[Key + std::to_string(I)] = std::move(Sized[I]);
+    }
+    EntryPointsMap = std::move(SizedEntryPointsMap);
+  }
+
   EntryPointGroupVec Groups;
 
   if (EntryPointsMap.empty()) {
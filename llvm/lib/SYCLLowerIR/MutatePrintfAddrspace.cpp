@@ -16,6 +16,7 @@
 
 #include "llvm/SYCLLowerIR/MutatePrintfAddrspace.h"
 
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Instructions.h"
@@ -50,10 +51,13 @@ static constexpr unsigned ConstantAddrspaceID = 2;
 // 1 function to replace. However, unique declarations are emitted for each
 // of the non-variadic (variadic template) calls.
 using FunctionVecTy = SmallVector<Function *, 8>;
+// Constant addrspace format strings of the module, by their contents.
+using CASLiteralMapTy = StringMap<GlobalVariable *>;
 
 Function *getCASPrintfFunction(Module &M, PointerType *CASLiteralType);
 size_t setFuncCallsOntoCASPrintf(Function *F, Function *CASPrintfFunc,
-                                 FunctionVecTy &FunctionsToDrop);
+                                 FunctionVecTy &FunctionsToDrop,
+                                 CASLiteralMapTy &CASLiterals);
 } // namespace
 
 char SYCLMutatePrintfAddrspaceLegacyPass::ID = 0;
@@ -74,6 +78,7 @@ SYCLMutatePrintfAddrspacePass::run(Module &M, ModuleAnalysisManager &MAM) {
   Function *CASPrintfFunc = getCASPrintfFunction(M, CASLiteralType);
 
   FunctionVecTy FunctionsToDrop;
+  CASLiteralMapTy CASLiterals;
   bool ModuleChanged = false;
   for (Function &F : M) {
     if (!F.isDeclaration())
@@ -83,8 +88,8 @@ SYCLMutatePrintfAddrspacePass::run(Module &M, ModuleAnalysisManager &MAM) {
     if (F.getArg(0)->getType() == CASLiteralType)
       // No need to replace the literal type and its printf users
       continue;
-    ModuleChanged |=
-        setFuncCallsOntoCASPrintf(&F, CASPrintfFunc, FunctionsToDrop);
+    ModuleChanged |= setFuncCallsOntoCASPrintf(&F, CASPrintfFunc,
+                                               FunctionsToDrop, CASLiterals);
   }
   for (Function *F : FunctionsToDrop)
     F->eraseFromParent();
@@ -113,8 +118,11 @@ Function *getCASPrintfFunction(Module &M, PointerType *CASLiteralType) {
 }
 
 /// Generate the constant addrspace version of the generic addrspace-residing
-/// global string. If one exists already, get it from the module.
-Constant *getCASLiteral(GlobalVariable *GenericASLiteral) {
+/// global string. If one exists already, get it from the module. The format
+/// strings with the same contents share a single constant addrspace copy, so
+/// that the device image holds each of them once.
+Constant *getCASLiteral(GlobalVariable *GenericASLiteral,
+                        CASLiteralMapTy &CASLiterals) {
   Module *M = GenericASLiteral->getParent();
   // Appending the stable suffix ensures that only one CAS copy is made for each
   // string. In case of the matching name, llvm::Module APIs will ensure that
@@ -128,11 +136,15 @@ Constant *getCASLiteral(GlobalVariable *GenericASLiteral) {
   bool HasString = getConstantStringInfo(GenericASLiteral, LiteralValue);
   if (!HasString)
     llvm_unreachable("Unexpected string literal in getCASLiteral()");
+  GlobalVariable *&CASLiteral = CASLiterals[LiteralValue];
+  if (CASLiteral)
+    return CASLiteral;
   IRBuilder<> Builder(M->getContext());
   GlobalVariable *Res = Builder.CreateGlobalString(LiteralValue, CASLiteralName,
                                                    ConstantAddrspaceID, M);
   Res->setLinkage(GlobalValue::LinkageTypes::InternalLinkage);
   Res->setUnnamedAddr(GlobalValue::UnnamedAddr::None);
+  CASLiteral = Res;
   return Res;
 }
 
@@ -186,7 +198,8 @@ void emitError(Function *PrintfInstance, CallInst *PrintfCall,
 /// to CASPrintfFunc and generating/retracting constant addrspace format
 /// strings to use as operands of the mutated calls.
 size_t setFuncCallsOntoCASPrintf(Function *F, Function *CASPrintfFunc,
-                                 FunctionVecTy &FunctionsToDrop) {
+                                 FunctionVecTy &FunctionsToDrop,
+                                 CASLiteralMapTy &CASLiterals) {
   size_t MutatedCallsCount = 0;
   SmallVector<std::pair<CallInst *, Constant *>, 16> CallsToMutate;
   FunctionVecTy WrapperFunctionsToDrop;
@@ -202,7 +215,7 @@ size_t setFuncCallsOntoCASPrintf(Function *F, Function *CASPrintfFunc,
     // argument.
     Value *Stripped = stripToMemorySource(CI->getArgOperand(0));
     if (auto *Literal = dyn_cast<GlobalVariable>(Stripped))
-      CallsToMutate.emplace_back(CI, getCASLiteral(Literal));
+      CallsToMutate.emplace_back(CI, getCASLiteral(Literal, CASLiterals));
     else if (auto *Arg = dyn_cast<Argument>(Stripped)) {
       // The global literal is passed to __spirv_ocl_printf via a wrapper
       // function argument. We'll update the wrapper calls to use the builtin
@@ -225,7 +238,8 @@ size_t setFuncCallsOntoCASPrintf(Function *F, Function *CASPrintfFunc,
           emitError(WrapperFunc, WrapperCI, BadWrapperErrorMsg);
           return 0;
         }
-        CallsToMutate.emplace_back(WrapperCI, getCASLiteral(Literal));
+        CallsToMutate.emplace_back(WrapperCI,
+                                   getCASLiteral(Literal, CASLiterals));
       }
       // We're certain that the wrapper won't have any uses, since we've just
       // marked all its calls for replacement with __spirv_ocl_printf.
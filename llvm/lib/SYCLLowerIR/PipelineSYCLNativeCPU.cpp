@@ -22,9 +22,15 @@
 #include "compiler/utils/prepare_barriers_pass.h"
 #include "compiler/utils/sub_group_analysis.h"
 #include "compiler/utils/work_item_loops_pass.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/Transforms/IPO/AlwaysInliner.h"
 #include "vecz/pass.h"
 #include "vecz/vecz_target_info.h"
+
+#include <algorithm>
 #endif
 
 using namespace llvm;
@@ -43,12 +49,85 @@ static cl::opt<bool> IsDebug(
 
 static cl::opt<unsigned> NativeCPUVeczWidth(
     "sycl-native-cpu-vecz-width", cl::init(8),
-    cl::desc("Vector width for SYCL Native CPU vectorizer, defaults to 8"));
+    cl::desc("Vector width for SYCL Native CPU vectorizer. When not set, it "
+             "is chosen for each kernel from the vector registers of its "
+             "target and its most used element type, and is at least 8"));
 
 static cl::opt<bool>
     SYCLNativeCPUNoVecz("sycl-native-cpu-no-vecz", cl::init(false),
                         cl::desc("Disable vectorizer for SYCL Native CPU"));
 
+#ifdef NATIVECPU_USE_OCK
+/// Returns the size in bits of the vector registers enabled by the target
+/// features of F, or 0 if none is known.
+static unsigned getVectorRegisterBits(const Function &F) {
+  bool SSE2 = false, AVX = false, AVX512 = false, Neon = false;
+  SmallVector<StringRef, 32> Features;
+  F.getFnAttribute("target-features").getValueAsString().split(Features, ',');
+  for (StringRef Feature : Features) {
+    if (Feature.size() < 2)
+      continue;
+    const bool Enabled = Feature[0] == '+';
+    StringRef Name = Feature.drop_front();
+    if (Name == "sse2")
+      SSE2 = Enabled;
+    else if (Name == "avx")
+      AVX = Enabled;
+    else if (Name == "avx512f")
+      AVX512 = Enabled;
+    else if (Name == "neon")
+      Neon = Enabled;
+  }
+  if (AVX512)
+    return 512;
+  if (AVX)
+    return 256;
+  if (SSE2 || Neon)
+    return 128;
+  return 0;
+}
+
+/// Returns the size in bits of the scalar type most used by the loads,
+/// stores and arithmetic of F, 32 if there is none.
+static unsigned getDominantElementBits(const Function &F) {
+  SmallDenseMap<unsigned, unsigned, 8> Counts;
+  auto Count = [&](Type *Ty) {
+    Ty = Ty->getScalarType();
+    if (Ty->isIntegerTy() || Ty->isFloatingPointTy())
+      if (unsigned Bits = Ty->getPrimitiveSizeInBits().getFixedValue())
+        ++Counts[Bits];
+  };
+  for (const Instruction &I : instructions(F)) {
+    if (const auto *Store = dyn_cast<StoreInst>(&I))
+      Count(Store->getValueOperand()->getType());
+    else if (isa<LoadInst>(I) || isa<BinaryOperator>(I))
+      Count(I.getType());
+  }
+  unsigned Bits = 32, Max = 0;
+  for (const auto &[Size, N] : Counts)
+    if (N > Max || (N == Max && Size < Bits)) {
+      Bits = Size;
+      Max = N;
+    }
+  return Bits;
+}
+
+/// Returns the vectorization width of the kernel F: the one given on the
+/// command line, or the number of elements of its dominant type fitting in a
+/// vector register of its target. The width is not chosen below the former
+/// default of 8, as the work-item loops benefit from the unrolling on the
+/// narrower targets, nor above 16.
+static unsigned getVeczWidth(const Function &F) {
+  if (NativeCPUVeczWidth.getNumOccurrences())
+    return NativeCPUVeczWidth;
+  const unsigned RegisterBits = getVectorRegisterBits(F);
+  if (RegisterBits == 0)
+    return NativeCPUVeczWidth;
+  const unsigned Width = RegisterBits / getDominantElementBits(F);
+  return std::clamp(Width, unsigned(NativeCPUVeczWidth), 16u);
+}
+#endif
+
 void llvm::sycl::utils::addSYCLNativeCPUBackendPasses(
     llvm::ModulePassManager &MPM, ModuleAnalysisManager &MAM,
     OptimizationLevel OptLevel) {
@@ -64,7 +143,7 @@ void llvm::sycl::utils::addSYCLNativeCPUBackendPasses(
       if (F.getCallingConv() != llvm::CallingConv::SPIR_KERNEL) {
         return false;
       }
-      compiler::utils::VectorizationFactor VF(NativeCPUVeczWidth, false);
+      compiler::utils::VectorizationFactor VF(getVeczWidth(F), false);
       vecz::VeczPassOptions VPO;
       VPO.factor = std::move(VF);
       Opts.emplace_back(std::move(VPO));
@@ -31,6 +31,7 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Value.h"
 #include "llvm/Pass.h"
+#include "llvm/SYCLLowerIR/ESIMD/ESIMDUtils.h"
 #include "llvm/SYCLLowerIR/UtilsSYCLNativeCPU.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -335,6 +336,19 @@ PreservedAnalyses PrepareSYCLNativeCPUPass::run(Module &M,
       OldKernels.push_back(&F);
   }
 
+  // The ESIMD intrinsics are only lowered for the GPU backend, they would be
+  // left as undefined symbols of the host code.
+  bool HasESIMDKernel = false;
+  for (Function *F : OldKernels) {
+    if (esimd::isESIMDKernel(*F)) {
+      M.getContext().emitError("ESIMD kernel " + F->getName() +
+                               " is not supported by SYCL Native CPU");
+      HasESIMDKernel = true;
+    }
+  }
+  if (HasESIMDKernel)
+    return PreservedAnalyses::all();
+
   // Materialize builtins
   // First we add a pointer to the Native CPU state as arg to all the
   // kernels.
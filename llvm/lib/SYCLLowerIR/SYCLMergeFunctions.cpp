@@ -0,0 +1,168 @@
+//===---- SYCLMergeFunctions.cpp - Merge identical SYCL device functions --===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===---------------------------------------------------------------------===//
+//
+// Template heavy code has many identical device functions and kernels, e.g.
+// the same lambda body instantiated for several tag types. The pass:
+//  - replaces the uses of the identical non-kernel functions which can be
+//    discarded with one of them;
+//  - moves the body of a group of identical kernels to a new function, which
+//    all of them call. The kernels keep their names and metadata, so the
+//    runtime still finds them. They cannot be aliases, which SPIR-V does not
+//    have.
+// The ESIMD functions are not merged, as they are split from the SYCL ones.
+//===---------------------------------------------------------------------===//
+
+#include "llvm/SYCLLowerIR/SYCLMergeFunctions.h"
+
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/StructuralHash.h"
+#include "llvm/SYCLLowerIR/ESIMD/ESIMDUtils.h"
+#include "llvm/SYCLLowerIR/SYCLUtils.h"
+#include "llvm/Transforms/Utils/FunctionComparator.h"
+
+#include <optional>
+
+#define DEBUG_TYPE "sycl-merge-functions"
+
+using namespace llvm;
+
+using FunctionGroup = SmallVector<Function *, 2>;
+
+// Groups the identical functions of Candidates, the first function of a group
+// comes first in Candidates. The groups of one function are dropped.
+static SmallVector<FunctionGroup, 0>
+groupIdenticalFunctions(ArrayRef<Function *> Candidates) {
+  GlobalNumberState GlobalNumbers;
+  MapVector<IRHash, SmallVector<FunctionGroup, 1>> Buckets;
+  for (Function *F : Candidates) {
+    SmallVector<FunctionGroup, 1> &Bucket = Buckets[StructuralHash(*F)];
+    auto It = find_if(Bucket, [&](const FunctionGroup &Group) {
+      return FunctionComparator(Group.front(), F, &GlobalNumbers).compare() ==
+             0;
+    });
+    if (It != Bucket.end())
+      It->push_back(F);
+    else
+      Bucket.push_back({F});
+  }
+
+  SmallVector<FunctionGroup, 0> Groups;
+  for (auto &Bucket : Buckets)
+    for (FunctionGroup &Group : Bucket.second)
+      if (Group.size() > 1)
+        Groups.push_back(std::move(Group));
+  return Groups;
+}
+
+static bool isMergeableFunction(const Function &F) {
+  if (F.isDeclaration() || esimd::isESIMD(F))
+    return false;
+  if (F.getCallingConv() == CallingConv::SPIR_KERNEL)
+    return F.getReturnType()->isVoidTy() && !F.isVarArg();
+  // The entry points and the functions which may be called indirectly or
+  // compared by address are kept.
+  return !F.hasFnAttribute(sycl::utils::ATTR_SYCL_MODULE_ID) &&
+         !F.hasFnAttribute("referenced-indirectly") &&
+         F.isDiscardableIfUnused() && !F.isInterposable() &&
+         (F.hasGlobalUnnamedAddr() || !F.hasAddressTaken());
+}
+
+static bool mergeHelpers(Module &M) {
+  bool Changed = false;
+  // Merging callees can make their callers identical.
+  while (true) {
+    SmallVector<Function *, 0> Candidates;
+    for (Function &F : M)
+      if (F.getCallingConv() != CallingConv::SPIR_KERNEL &&
+          isMergeableFunction(F))
+        Candidates.push_back(&F);
+
+    SmallVector<FunctionGroup, 0> Groups = groupIdenticalFunctions(Candidates);
+    if (Groups.empty())
+      return Changed;
+    for (FunctionGroup &Group : Groups) {
+      for (Function *F : drop_begin(Group)) {
+        F->replaceAllUsesWith(Group.front());
+        F->eraseFromParent();
+      }
+    }
+    Changed = true;
+  }
+}
+
+static void makeKernelCall(Function *Kernel, Function *Impl) {
+  // The body is the one of Impl, its debug info is dropped with it.
+  for (BasicBlock &BB : *Kernel)
+    BB.dropAllReferences();
+  while (!Kernel->empty())
+    Kernel->begin()->eraseFromParent();
+  Kernel->setSubprogram(nullptr);
+
+  BasicBlock *Entry = BasicBlock::Create(Kernel->getContext(), "", Kernel);
+  SmallVector<Value *, 8> Args;
+  for (Argument &Arg : Kernel->args())
+    Args.push_back(&Arg);
+  CallInst *Call = CallInst::Create(Impl, Args, "", Entry);
+  Call->setCallingConv(Impl->getCallingConv());
+  ReturnInst::Create(Kernel->getContext(), Entry);
+}
+
+static bool mergeKernels(Module &M) {
+  // The kernels of different translation units only differ by their module
+  // ID, which is put back once they are compared.
+  SmallVector<Function *, 0> Candidates;
+  SmallVector<std::optional<Attribute>, 0> ModuleIDs;
+  for (Function &F : M) {
+    if (F.getCallingConv() != CallingConv::SPIR_KERNEL ||
+        !isMergeableFunction(F))
+      continue;
+    Candidates.push_back(&F);
+    ModuleIDs.push_back(std::nullopt);
+    if (F.hasFnAttribute(sycl::utils::ATTR_SYCL_MODULE_ID)) {
+      ModuleIDs.back() = F.getFnAttribute(sycl::utils::ATTR_SYCL_MODULE_ID);
+      F.removeFnAttr(sycl::utils::ATTR_SYCL_MODULE_ID);
+    }
+  }
+
+  SmallVector<FunctionGroup, 0> Groups = groupIdenticalFunctions(Candidates);
+  for (FunctionGroup &Group : Groups) {
+    Function *First = Group.front();
+    Function *Impl = Function::Create(
+        First->getFunctionType(), GlobalValue::InternalLinkage,
+        First->getAddressSpace(), First->getName() + ".impl", &M);
+    Impl->copyAttributesFrom(First);
+    Impl->setCallingConv(CallingConv::SPIR_FUNC);
+    Impl->setVisibility(GlobalValue::DefaultVisibility);
+    Impl->setDSOLocal(true);
+
+    Impl->splice(Impl->end(), First);
+    for (auto [Arg, ImplArg] : zip(First->args(), Impl->args())) {
+      Arg.replaceAllUsesWith(&ImplArg);
+      ImplArg.takeName(&Arg);
+    }
+    Impl->setSubprogram(First->getSubprogram());
+
+    for (Function *Kernel : Group)
+      makeKernelCall(Kernel, Impl);
+  }
+
+  for (auto [F, ModuleID] : zip(Candidates, ModuleIDs))
+    if (ModuleID)
+      F->addFnAttr(*ModuleID);
+  return !Groups.empty();
+}
+
+PreservedAnalyses SYCLMergeFunctionsPass::run(Module &M,
+                                              ModuleAnalysisManager &) {
+  bool Changed = mergeHelpers(M);
+  Changed |= mergeKernels(M);
+  return Changed ? PreservedAnalyses::none() : PreservedAnalyses::all();
+}
@@ -18,6 +18,7 @@
 #include "llvm/Transforms/Instrumentation/AddressSanitizer.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
@@ -26,6 +27,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Analysis/GlobalsModRef.h"
+#include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/StackSafetyAnalysis.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
@@ -43,6 +45,7 @@
 #include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/DebugLoc.h"
 #include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/EHPersonalities.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/GlobalAlias.h"
@@ -393,6 +396,13 @@ static cl::opt<bool> ClOptStack(
     "asan-opt-stack", cl::desc("Don't instrument scalar stack variables"),
     cl::Hidden, cl::init(false));
 
+static cl::opt<bool> ClOptLoopInvariant(
+    "asan-opt-loop-invariant",
+    cl::desc("Check the loop invariant addresses accessed by every iteration "
+             "of a loop once before the loop, in device code. The errors are "
+             "reported at the loop entry"),
+    cl::Hidden, cl::init(false));
+
 static cl::opt<bool> ClDynamicAllocaStack(
     "asan-stack-dynamic-alloca",
     cl::desc("Use dynamic alloca to represent stack variables"), cl::Hidden,
@@ -458,6 +468,8 @@ STATISTIC(NumOptimizedAccessesToGlobalVar,
           "Number of optimized accesses to global vars");
 STATISTIC(NumOptimizedAccessesToStackVar,
           "Number of optimized accesses to stack vars");
+STATISTIC(NumHoistedLoopInvariantAccesses,
+          "Number of accesses checked before their loop");
 
 namespace {
 
@@ -759,7 +771,8 @@ struct AddressSanitizer {
 
   void instrumentMop(ObjectSizeOffsetVisitor &ObjSizeVis,
                      InterestingMemoryOperand &O, bool UseCalls,
-                     const DataLayout &DL, RuntimeCallInserter &RTCI);
+                     const DataLayout &DL, RuntimeCallInserter &RTCI,
+                     Instruction *InsertBefore = nullptr);
   void instrumentPointerComparisonOrSubtraction(Instruction *I,
                                                 RuntimeCallInserter &RTCI);
   void instrumentAddress(Instruction *OrigIns, Instruction *InsertBefore,
@@ -795,7 +808,9 @@ struct AddressSanitizer {
   void instrumentMemIntrinsic(MemIntrinsic *MI, RuntimeCallInserter &RTCI);
   Value *memToShadow(Value *Shadow, IRBuilder<> &IRB);
   bool suppressInstrumentationSiteForDebug(int &Instrumented);
-  bool instrumentFunction(Function &F, const TargetLibraryInfo *TLI);
+  bool instrumentFunction(Function &F, const TargetLibraryInfo *TLI,
+                          const LoopInfo *LI = nullptr,
+                          const DominatorTree *DT = nullptr);
   bool maybeInsertAsanInitAtFunctionEntry(Function &F);
   bool maybeInsertDynamicShadowAtFunctionEntry(Function &F);
   void markEscapedLocalAllocas(Function &F);
@@ -1272,7 +1287,14 @@ PreservedAnalyses AddressSanitizerPass::run(Module &M,
         Options.MaxInlinePoisoningSize, Options.CompileKernel, Options.Recover,
         Options.UseAfterScope, Options.UseAfterReturn);
     const TargetLibraryInfo &TLI = FAM.getResult<TargetLibraryAnalysis>(F);
-    Modified |= FunctionSanitizer.instrumentFunction(F, &TLI);
+    const LoopInfo *LI = nullptr;
+    const DominatorTree *DT = nullptr;
+    if (ClOpt && ClOptLoopInvariant && Triple(M.getTargetTriple()).isSPIR() &&
+        !F.isDeclaration()) {
+      LI = &FAM.getResult<LoopAnalysis>(F);
+      DT = &FAM.getResult<DominatorTreeAnalysis>(F);
+    }
+    Modified |= FunctionSanitizer.instrumentFunction(F, &TLI, LI, DT);
   }
   Modified |= ModuleSanitizer.instrumentModule(M);
   if (!Modified)
@@ -1817,8 +1839,11 @@ void AddressSanitizer::instrumentMaskedLoadOrStore(
 void AddressSanitizer::instrumentMop(ObjectSizeOffsetVisitor &ObjSizeVis,
                                      InterestingMemoryOperand &O, bool UseCalls,
                                      const DataLayout &DL,
-                                     RuntimeCallInserter &RTCI) {
+                                     RuntimeCallInserter &RTCI,
+                                     Instruction *InsertBefore) {
   Value *Addr = O.getPtr();
+  if (!InsertBefore)
+    InsertBefore = O.getInsn();
 
   // Optimization experiments.
   // The experiments can be used to evaluate potential optimizations that remove
@@ -1865,12 +1890,45 @@ void AddressSanitizer::instrumentMop(ObjectSizeOffsetVisitor &ObjSizeVis,
                                 Granularity, O.OpType, O.IsWrite, nullptr,
                                 UseCalls, Exp, RTCI);
   } else {
-    doInstrumentAddress(this, O.getInsn(), O.getInsn(), Addr, O.Alignment,
+    doInstrumentAddress(this, O.getInsn(), InsertBefore, Addr, O.Alignment,
                         Granularity, O.TypeStoreSize, O.IsWrite, nullptr,
                         UseCalls, Exp, RTCI);
   }
 }
 
+// Returns the instruction before which the check of the access O can be done
+// instead, i.e. the terminator of the preheader of the outermost loop whose
+// iterations all do the access with the same address, or null. The shadow of
+// device memory does not change while a kernel runs, except for the private
+// memory, whose accesses are not hoisted.
+static Instruction *getHoistedCheckPoint(const InterestingMemoryOperand &O,
+                                         const LoopInfo &LI,
+                                         const DominatorTree &DT) {
+  if (O.MaybeMask || O.TypeStoreSize.isScalable())
+    return nullptr;
+  Value *Addr = O.getPtr();
+  if (isa<AllocaInst>(getUnderlyingObject(Addr)))
+    return nullptr;
+
+  BasicBlock *BB = O.getInsn()->getParent();
+  Instruction *InsertBefore = nullptr;
+  for (Loop *L = LI.getLoopFor(BB); L; L = L->getParentLoop()) {
+    BasicBlock *Preheader = L->getLoopPreheader();
+    if (!Preheader || !L->isLoopInvariant(Addr))
+      break;
+    // The access must be done by the first iteration once the loop is
+    // entered, so that the check does not report an access never done
+    SmallVector<BasicBlock *, 4> ExitingBlocks;
+    L->getExitingBlocks(ExitingBlocks);
+    if (!all_of(ExitingBlocks, [&](BasicBlock *Exiting) {
+          return DT.dominates(BB, Exiting);
+        }))
+      break;
+    InsertBefore = Preheader->getTerminator();
+  }
+  return InsertBefore;
+}
+
 Instruction *AddressSanitizer::generateCrashCode(Instruction *InsertBefore,
                                                  Value *Addr, bool IsWrite,
                                                  size_t AccessSizeIndex,
@@ -3131,7 +3189,9 @@ bool AddressSanitizer::suppressInstrumentationSiteForDebug(int &Instrumented) {
 }
 
 bool AddressSanitizer::instrumentFunction(Function &F,
-                                          const TargetLibraryInfo *TLI) {
+                                          const TargetLibraryInfo *TLI,
+                                          const LoopInfo *LI,
+                                          const DominatorTree *DT) {
   if (F.empty())
     return false;
   if (F.getLinkage() == GlobalValue::AvailableExternallyLinkage) return false;
@@ -3248,12 +3308,38 @@ bool AddressSanitizer::instrumentFunction(Function &F,
   ObjSizeOpts.RoundToAlign = true;
   ObjectSizeOffsetVisitor ObjSizeVis(DL, TLI, F.getContext(), ObjSizeOpts);
 
+  // The instructions before which the operands are checked, null for the
+  // operand's own instruction. The same access hoisted out of a loop by
+  // several instructions is checked once.
+  SmallVector<Instruction *, 16> CheckPoints;
+  if (LI && DT) {
+    DenseSet<std::tuple<Instruction *, Value *, uint64_t, bool>> HoistedChecks;
+    SmallVector<InterestingMemoryOperand, 16> Operands;
+    for (auto &Operand : OperandsToInstrument) {
+      Instruction *InsertBefore = getHoistedCheckPoint(Operand, *LI, *DT);
+      if (InsertBefore) {
+        NumHoistedLoopInvariantAccesses++;
+        if (!HoistedChecks
+                 .insert({InsertBefore, Operand.getPtr(),
+                          Operand.TypeStoreSize.getFixedValue(),
+                          Operand.IsWrite})
+                 .second)
+          continue;
+      }
+      Operands.push_back(Operand);
+      CheckPoints.push_back(InsertBefore);
+    }
+    OperandsToInstrument = std::move(Operands);
+  }
+  CheckPoints.resize(OperandsToInstrument.size(), nullptr);
+
   // Instrument.
   int NumInstrumented = 0;
-  for (auto &Operand : OperandsToInstrument) {
+  for (auto [Operand, InsertBefore] :
+       zip_equal(OperandsToInstrument, CheckPoints)) {
     if (!suppressInstrumentationSiteForDebug(NumInstrumented))
       instrumentMop(ObjSizeVis, Operand, UseCalls,
-                    F.getParent()->getDataLayout(), RTCI);
+                    F.getParent()->getDataLayout(), RTCI, InsertBefore);
     FunctionModified = true;
   }
   if (TargetTriple.isSPIR()) {
@@ -54,6 +54,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/SimpleTable.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/WithColor.h"
 
 #include <algorithm>
@@ -116,6 +117,37 @@ static cl::opt<bool> DropTitles{"drop_titles", cl::Optional,
                                 cl::desc("drop column titles"),
                                 cl::cat(FileTableTformCat)};
 
+static cl::opt<bool> TimeTrace{"time-trace", cl::desc("Record time trace"),
+                               cl::cat(FileTableTformCat)};
+
+static cl::opt<unsigned> TimeTraceGranularity{
+    "time-trace-granularity",
+    cl::desc(
+        "Minimum time granularity (in microseconds) traced by time profiler"),
+    cl::init(500), cl::Hidden, cl::cat(FileTableTformCat)};
+
+static cl::opt<std::string> TimeTraceFile{
+    "time-trace-file", cl::desc("Specify time trace file destination"),
+    cl::value_desc("filename"), cl::cat(FileTableTformCat)};
+
+struct TimeTracerRAII {
+  TimeTracerRAII(StringRef ProgramName) {
+    if (TimeTrace)
+      timeTraceProfilerInitialize(TimeTraceGranularity, ProgramName);
+  }
+  ~TimeTracerRAII() {
+    if (TimeTrace) {
+      if (auto E = timeTraceProfilerWrite(TimeTraceFile, Output)) {
+        handleAllErrors(std::move(E), [&](const StringError &SE) {
+          errs() << SE.getMessage() << "\n";
+        });
+        return;
+      }
+      timeTraceProfilerCleanup();
+    }
+  }
+};
+
 Error makeToolError(Twine Msg) {
   return make_error<StringError>("*** " + llvm::Twine(ToolName) +
                                      " ERROR: " + Msg,
@@ -392,6 +424,7 @@ int main(int argc, char **argv) {
       "- rename a column\n"
       "- extract column(s)\n"
       "- ouput a copy of a file in a cell\n");
+  TimeTracerRAII TimeTracer(ToolName);
 
   std::map<int, TformCmd::UPtrTy> Cmds;
 
@@ -454,6 +487,7 @@ int main(int argc, char **argv) {
 
   for (auto &P : Cmds) {
     TformCmd::UPtrTy &Cmd = P.second;
+    TimeTraceScope Scope("Transform", Cmd->Kind);
     Error Res = Cmd->execute(*Table->get());
     CHECK_AND_EXIT(std::move(Res));
   }
@@ -19,11 +19,14 @@
 #include "SpecConstants.h"
 #include "Support.h"
 
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/ProfileSummaryInfo.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/Bitcode/BitcodeWriterPass.h"
 #include "llvm/GenXIntrinsics/GenXSPIRVWriterAdaptor.h"
 #include "llvm/IR/Dominators.h"
@@ -40,18 +43,25 @@
 #include "llvm/SYCLLowerIR/HostPipes.h"
 #include "llvm/SYCLLowerIR/LowerInvokeSimd.h"
 #include "llvm/SYCLLowerIR/ModuleSplitter.h"
+#include "llvm/SYCLLowerIR/SYCLMergeFunctions.h"
 #include "llvm/SYCLLowerIR/SYCLUtils.h"
 #include "llvm/SYCLLowerIR/SanitizeDeviceGlobal.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PropertySetIO.h"
 #include "llvm/Support/SimpleTable.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/SystemUtils.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Transforms/IPO/AlwaysInliner.h"
+#include "llvm/Transforms/IPO/Internalize.h"
 #include "llvm/Transforms/IPO/StripDeadPrototypes.h"
 #include "llvm/Transforms/InstCombine/InstCombine.h"
 #include "llvm/Transforms/Scalar.h"
@@ -61,6 +71,7 @@
 #include "llvm/Transforms/Utils/GlobalStatus.h"
 
 #include <algorithm>
+#include <deque>
 #include <map>
 #include <memory>
 #include <queue>
@@ -168,10 +179,26 @@ cl::opt<module_split::IRSplitMode> SplitMode(
                           "1 output module per source (translation unit)"),
                clEnumValN(module_split::SPLIT_PER_KERNEL, "kernel",
                           "1 output module per kernel"),
+               clEnumValN(module_split::SPLIT_BY_SIZE, "size",
+                          "Output modules of about -split-size instructions, "
+                          "grouping kernels which share code"),
                clEnumValN(module_split::SPLIT_AUTO, "auto",
                           "Choose split mode automatically")),
     cl::cat(PostLinkCat));
 
+cl::opt<unsigned> SplitSize{
+    "split-size",
+    cl::desc("Number of LLVM IR instructions the output modules are filled "
+             "up to with -split=size"),
+    cl::value_desc("N"), cl::init(module_split::SizeSplitOptions{}.TargetSize),
+    cl::cat(PostLinkCat)};
+
+cl::opt<std::string> SplitProfile{
+    "split-profile",
+    cl::desc("File listing the kernels which run together, one set of "
+             "names separated by spaces per line, for -split=size"),
+    cl::value_desc("filename"), cl::cat(PostLinkCat)};
+
 cl::opt<bool> DoSymGen{"symbols", cl::desc("generate exported symbol files"),
                        cl::cat(PostLinkCat)};
 
@@ -221,6 +248,68 @@ cl::opt<bool> GenerateDeviceImageWithDefaultSpecConsts{
              "replaced with default values from specialization id(s)."),
     cl::cat(PostLinkCat)};
 
+cl::opt<unsigned> NumThreads{
+    "j",
+    cl::desc("Number of threads processing the split modules concurrently, "
+             "0 means one per hardware thread (default = 1)"),
+    cl::value_desc("N"), cl::init(1), cl::cat(PostLinkCat)};
+
+cl::opt<std::string> FallbackDeviceLibDir{
+    "fallback-device-lib-dir",
+    cl::desc("Link the fallback device library functions used by each device "
+             "image from the libsycl-fallback-*.bc libraries of this "
+             "directory, instead of leaving the whole libraries to be linked "
+             "by the runtime"),
+    cl::value_desc("dir"), cl::cat(PostLinkCat)};
+
+cl::opt<bool> MergeFunctions{
+    "merge-functions",
+    cl::desc("Merge the identical device functions, and make the identical "
+             "kernels call one implementation, before splitting"),
+    cl::cat(PostLinkCat)};
+
+cl::opt<bool> TimeTrace{"time-trace", cl::desc("Record time trace"),
+                        cl::cat(PostLinkCat)};
+
+cl::opt<unsigned> TimeTraceGranularity{
+    "time-trace-granularity",
+    cl::desc(
+        "Minimum time granularity (in microseconds) traced by time profiler"),
+    cl::init(500), cl::Hidden, cl::cat(PostLinkCat)};
+
+cl::opt<std::string> TimeTraceFile{
+    "time-trace-file", cl::desc("Specify time trace file destination"),
+    cl::value_desc("filename"), cl::cat(PostLinkCat)};
+
+struct TimeTracerRAII {
+  TimeTracerRAII(StringRef ProgramName) {
+    if (TimeTrace)
+      timeTraceProfilerInitialize(TimeTraceGranularity, ProgramName);
+  }
+  ~TimeTracerRAII() {
+    if (TimeTrace) {
+      if (auto E = timeTraceProfilerWrite(TimeTraceFile, OutputFilename)) {
+        handleAllErrors(std::move(E), [&](const StringError &SE) {
+          errs() << SE.getMessage() << "\n";
+        });
+        return;
+      }
+      timeTraceProfilerCleanup();
+    }
+  }
+};
+
+// Records the time trace of a task run by a thread of a pool.
+template <typename TaskT> auto traceTask(TaskT Task) {
+  return [Task = std::move(Task)]() mutable {
+    if (TimeTrace)
+      timeTraceProfilerInitialize(TimeTraceGranularity, "sycl-post-link");
+    Task();
+    if (TimeTrace)
+      timeTraceProfilerFinishThread();
+  };
+}
+
 struct GlobalBinImageProps {
   bool EmitKernelParamInfo;
   bool EmitProgramMetadata;
@@ -562,6 +651,16 @@ std::string saveModuleProperties(module_split::ModuleDesc &MD,
     PropSet.add(PropSetRegTy::SYCL_MISC_PROP, "specConstsReplacedWithDefault",
                 1);
 
+  if (SplitMode == module_split::SPLIT_BY_SIZE) {
+    // The weight the image was split for, which tells the runtime how costly
+    // building it is.
+    uint32_t InstructionCount = 0;
+    for (const Function &F : M.functions())
+      InstructionCount += F.getInstructionCount();
+    PropSet.add(PropSetRegTy::SYCL_MISC_PROP, "instructionCount",
+                InstructionCount);
+  }
+
   std::error_code EC;
   std::string SCFile = makeResultFileName(".prop", I, Suff);
   raw_fd_ostream SCOut(SCFile, EC);
@@ -638,6 +737,9 @@ bool lowerEsimdConstructs(module_split::ModuleDesc &MD) {
     MainFPM.addPass(EarlyCSEPass(true));
     MainFPM.addPass(InstCombinePass{});
     MainFPM.addPass(DCEPass{});
+    // Merge the block accesses once the addresses were simplified, the
+    // shuffles it makes are cleaned up by the passes below.
+    MainFPM.addPass(ESIMDMergeBlockAccessesPass{});
     // TODO: maybe remove some passes below that don't affect code quality
     MainFPM.addPass(SROAPass(SROAOptions::ModifyCFG));
     MainFPM.addPass(EarlyCSEPass(true));
@@ -758,6 +860,64 @@ processSpecConstantsWithDefaultValues(const module_split::ModuleDesc &MD) {
   return std::move(NewModuleDesc);
 }
 
+// Links the definitions of the fallback device library functions used by MD
+// from the libraries of -fallback-device-lib-dir, so that these libraries are
+// no longer in the DeviceLibReqMask of MD. The libraries which are not found
+// are left to the runtime, as are the assert one, whose state is read by the
+// runtime, and the bfloat16 one, which has a native version picked by the
+// runtime.
+// @return true if MD was modified.
+bool linkFallbackDeviceLibs(module_split::ModuleDesc &MD) {
+  static const std::pair<DeviceLibExt, const char *> Libs[] = {
+      {DeviceLibExt::cl_intel_devicelib_math, "cmath"},
+      {DeviceLibExt::cl_intel_devicelib_math_fp64, "cmath-fp64"},
+      {DeviceLibExt::cl_intel_devicelib_complex, "complex"},
+      {DeviceLibExt::cl_intel_devicelib_complex_fp64, "complex-fp64"},
+      {DeviceLibExt::cl_intel_devicelib_cstring, "cstring"},
+      {DeviceLibExt::cl_intel_devicelib_imf, "imf"},
+      {DeviceLibExt::cl_intel_devicelib_imf_fp64, "imf-fp64"},
+      {DeviceLibExt::cl_intel_devicelib_imf_bf16, "imf-bf16"}};
+
+  if (FallbackDeviceLibDir.empty() || MD.isESIMD())
+    return false;
+  Module &M = MD.getModule();
+  uint32_t TriedMask = 0;
+  bool Modified = false;
+  // A library may use the functions of another one, which is then linked too.
+  for (bool Linked = true; Linked;) {
+    Linked = false;
+    uint32_t ReqMask = getSYCLDeviceLibReqMask(M) & ~TriedMask;
+    for (const auto &[Ext, Name] : Libs) {
+      uint32_t Bit = 0x1 << static_cast<uint32_t>(Ext);
+      if (!(ReqMask & Bit))
+        continue;
+      TriedMask |= Bit;
+      SmallString<128> Path(FallbackDeviceLibDir);
+      sys::path::append(Path, Twine("libsycl-fallback-") + Name + ".bc");
+      if (!sys::fs::exists(Path))
+        continue;
+      SMDiagnostic Err;
+      std::unique_ptr<Module> Lib = parseIRFile(Path, Err, M.getContext());
+      if (!Lib) {
+        Err.print("sycl-post-link", errs());
+        error("cannot read the device library " + Path);
+      }
+      // Only the functions used by the image are linked, and they are not
+      // exported from it.
+      if (Linker::linkModules(
+              M, std::move(Lib), Linker::LinkOnlyNeeded,
+              [](Module &M, const StringSet<> &GVS) {
+                internalizeModule(M, [&GVS](const GlobalValue &GV) {
+                  return !GV.hasName() || !GVS.count(GV.getName());
+                });
+              }))
+        error("cannot link the device library " + Path);
+      Linked = Modified = true;
+    }
+  }
+  return Modified;
+}
+
 constexpr int MAX_COLUMNS_IN_FILE_TABLE = 3;
 
 void addTableRow(util::SimpleTable &Table,
@@ -937,6 +1097,168 @@ handleESIMD(module_split::ModuleDesc &&MDesc, bool &Modified,
   return Result;
 }
 
+// Processes the ESIMD code and the specialization constants of a split module,
+// which gives its modules to save, and their copies with the default values
+// of the specialization constants.
+void processSplit(
+    module_split::ModuleDesc &&MDesc, bool &Modified, bool &SplitOccurred,
+    SmallVector<module_split::ModuleDesc, 2> &MMs,
+    SmallVector<module_split::ModuleDesc, 2> &MMsWithDefaultSpecConsts) {
+  TimeTraceScope Scope("Process split", MDesc.Name);
+  MDesc.fixupLinkageOfDirectInvokeSimdTargets();
+
+  MMs = handleESIMD(std::move(MDesc), Modified, SplitOccurred);
+  assert(MMs.size() && "at least one module is expected after ESIMD split");
+
+  for (size_t I = 0; I != MMs.size(); ++I) {
+    Modified |= linkFallbackDeviceLibs(MMs[I]);
+    if (GenerateDeviceImageWithDefaultSpecConsts) {
+      std::optional<module_split::ModuleDesc> NewMD =
+          processSpecConstantsWithDefaultValues(MMs[I]);
+      if (NewMD)
+        MMsWithDefaultSpecConsts.push_back(std::move(*NewMD));
+    }
+
+    Modified |= processSpecConstants(MMs[I]);
+  }
+}
+
+// Saves the modules of a processed split with the given ID, and their copies
+// with the default values of the specialization constants with the next one.
+// @return the number of IDs used.
+int saveSplit(
+    SmallVector<module_split::ModuleDesc, 2> &MMs,
+    SmallVector<module_split::ModuleDesc, 2> &MMsWithDefaultSpecConsts, int ID,
+    StringRef OutIRFileName, std::vector<IrPropSymFilenameTriple> &Rows) {
+  TimeTraceScope Scope("Save split");
+  for (module_split::ModuleDesc &IrMD : MMs)
+    Rows.push_back(saveModule(IrMD, ID, OutIRFileName));
+
+  if (MMsWithDefaultSpecConsts.empty())
+    return 1;
+  for (module_split::ModuleDesc &IrMD : MMsWithDefaultSpecConsts)
+    Rows.push_back(saveModule(IrMD, ID + 1, OutIRFileName));
+  return 2;
+}
+
+// A split module processed and saved by the thread pool in its own
+// LLVMContext, as the contexts are not thread safe.
+struct SplitJob {
+  // The split module as bitcode, until it is read in the context
+  SmallVector<char, 0> Bitcode;
+  std::string Name;
+  module_split::EntryPointGroup EntryPoints;
+  std::vector<std::string> EntryPointNames;
+  module_split::ModuleDesc::Properties Props;
+
+  std::unique_ptr<LLVMContext> Context;
+  SmallVector<module_split::ModuleDesc, 2> MMs;
+  SmallVector<module_split::ModuleDesc, 2> MMsWithDefaultSpecConsts;
+  std::vector<IrPropSymFilenameTriple> Rows;
+  std::shared_future<void> Processed;
+
+  explicit SplitJob(module_split::ModuleDesc &MDesc)
+      : Name(MDesc.Name),
+        EntryPoints(MDesc.getEntryPointGroup().GroupId, {},
+                    MDesc.getEntryPointGroup().Props),
+        Props(MDesc.Props) {
+    raw_svector_ostream OS(Bitcode);
+    WriteBitcodeToFile(MDesc.getModule(), OS);
+    MDesc.saveEntryPointNames(EntryPointNames);
+  }
+
+  void process() {
+    Context = std::make_unique<LLVMContext>();
+    Expected<std::unique_ptr<Module>> ME = parseBitcodeFile(
+        MemoryBufferRef(StringRef(Bitcode.data(), Bitcode.size()), Name),
+        *Context);
+    CHECK_AND_EXIT(ME.takeError());
+    Bitcode = {};
+
+    module_split::ModuleDesc MDesc{std::move(*ME), std::move(EntryPoints),
+                                   Props};
+    MDesc.Name = Name;
+    MDesc.rebuildEntryPoints(EntryPointNames);
+    EntryPointNames = {};
+    // The outputs are saved whether this split was modified or not, as the
+    // input was split.
+    bool Modified = false;
+    bool SplitOccurred = true;
+    processSplit(std::move(MDesc), Modified, SplitOccurred, MMs,
+                 MMsWithDefaultSpecConsts);
+  }
+
+  void save(int ID) {
+    saveSplit(MMs, MMsWithDefaultSpecConsts, ID, "", Rows);
+    MMs.clear();
+    MMsWithDefaultSpecConsts.clear();
+    Context.reset();
+  }
+};
+
+// Processes and saves the splits of the splitter with -j threads. The splits
+// are still made one at a time, and only a few of them are kept in memory.
+// The IDs of the output files depend on the splits before, they are given in
+// the order of the splits when those are processed, so that the outputs are
+// the same as when they are processed one by one.
+void processSplitsConcurrently(module_split::ModuleSplitterBase &Splitter,
+                               util::SimpleTable &Table) {
+  DefaultThreadPool Pool(hardware_concurrency(NumThreads));
+  const size_t MaxInFlight = 2 * Pool.getMaxConcurrency();
+  std::vector<std::unique_ptr<SplitJob>> Jobs;
+  // Jobs being processed, in the order of the splits
+  std::deque<SplitJob *> InFlight;
+  int ID = 0;
+
+  auto SaveOldest = [&]() {
+    SplitJob *Job = InFlight.front();
+    InFlight.pop_front();
+    Job->Processed.wait();
+    int JobID = ID;
+    ID += Job->MMsWithDefaultSpecConsts.empty() ? 1 : 2;
+    Pool.async(traceTask([Job, JobID] { Job->save(JobID); }));
+  };
+
+  while (Splitter.hasMoreSplits()) {
+    if (InFlight.size() >= MaxInFlight)
+      SaveOldest();
+    module_split::ModuleDesc MDesc = Splitter.nextSplit();
+    DUMP_ENTRY_POINTS(MDesc.entries(), MDesc.Name.c_str(), 1);
+
+    SplitJob *Job = Jobs.emplace_back(std::make_unique<SplitJob>(MDesc)).get();
+    Job->Processed = Pool.async(traceTask([Job] { Job->process(); }));
+    InFlight.push_back(Job);
+  }
+  while (!InFlight.empty())
+    SaveOldest();
+  Pool.wait();
+
+  for (const std::unique_ptr<SplitJob> &Job : Jobs)
+    for (const IrPropSymFilenameTriple &T : Job->Rows)
+      addTableRow(Table, T);
+}
+
+module_split::SizeSplitOptions getSizeSplitOptions() {
+  module_split::SizeSplitOptions Options;
+  Options.TargetSize = SplitSize;
+  if (SplitProfile.empty())
+    return Options;
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer =
+      MemoryBuffer::getFile(SplitProfile);
+  checkError(Buffer.getError(),
+             "error opening the file '" + SplitProfile + "'");
+  for (line_iterator Line(**Buffer, /*SkipBlanks=*/true, '#');
+       !Line.is_at_eof(); ++Line) {
+    SmallVector<StringRef, 8> Names;
+    SplitString(*Line, Names);
+    std::vector<std::string> &Set = Options.KernelsRunTogether.emplace_back();
+    for (StringRef Name : Names)
+      Set.push_back(Name.str());
+  }
+  return Options;
+}
+
 std::unique_ptr<util::SimpleTable>
 processInputModule(std::unique_ptr<Module> M) {
   // Construct the resulting table which will accumulate all the outputs.
@@ -950,6 +1272,7 @@ processInputModule(std::unique_ptr<Module> M) {
       util::SimpleTable::create(ColumnTitles);
   CHECK_AND_EXIT(TableE.takeError());
   std::unique_ptr<util::SimpleTable> Table = std::move(TableE.get());
+  TimeTraceScope Scope("Process input module");
 
   // Used in output filenames generation.
   int ID = 0;
@@ -994,6 +1317,10 @@ processInputModule(std::unique_ptr<Module> M) {
   }
   Modified |= InvokeSimdMet;
 
+  // Merge before splitting, so that the splits get the merged functions.
+  if (MergeFunctions)
+    Modified |= runModulePass<SYCLMergeFunctionsPass>(*M);
+
   DUMP_ENTRY_POINTS(*M, EmitOnlyKernelsAsEntryPoints, "Input");
 
   // -ir-output-only assumes single module output thus no code splitting.
@@ -1007,7 +1334,7 @@ processInputModule(std::unique_ptr<Module> M) {
   std::unique_ptr<module_split::ModuleSplitterBase> Splitter =
       module_split::getDeviceCodeSplitter(
           module_split::ModuleDesc{std::move(M)}, SplitMode, IROutputOnly,
-          EmitOnlyKernelsAsEntryPoints);
+          EmitOnlyKernelsAsEntryPoints, getSizeSplitOptions());
   bool SplitOccurred = Splitter->remainingSplits() > 1;
   Modified |= SplitOccurred;
 
@@ -1021,27 +1348,18 @@ processInputModule(std::unique_ptr<Module> M) {
   // It is important that we *DO NOT* preserve all the splits in memory at the
   // same time, because it leads to a huge RAM consumption by the tool on bigger
   // inputs.
+  if (NumThreads != 1 && SplitOccurred && !IROutputOnly) {
+    processSplitsConcurrently(*Splitter, *Table);
+    return Table;
+  }
   while (Splitter->hasMoreSplits()) {
     module_split::ModuleDesc MDesc = Splitter->nextSplit();
     DUMP_ENTRY_POINTS(MDesc.entries(), MDesc.Name.c_str(), 1);
 
-    MDesc.fixupLinkageOfDirectInvokeSimdTargets();
-
-    SmallVector<module_split::ModuleDesc, 2> MMs =
-        handleESIMD(std::move(MDesc), Modified, SplitOccurred);
-    assert(MMs.size() && "at least one module is expected after ESIMD split");
-
+    SmallVector<module_split::ModuleDesc, 2> MMs;
     SmallVector<module_split::ModuleDesc, 2> MMsWithDefaultSpecConsts;
-    for (size_t I = 0; I != MMs.size(); ++I) {
-      if (GenerateDeviceImageWithDefaultSpecConsts) {
-        std::optional<module_split::ModuleDesc> NewMD =
-            processSpecConstantsWithDefaultValues(MMs[I]);
-        if (NewMD)
-          MMsWithDefaultSpecConsts.push_back(std::move(*NewMD));
-      }
-
-      Modified |= processSpecConstants(MMs[I]);
-    }
+    processSplit(std::move(MDesc), Modified, SplitOccurred, MMs,
+                 MMsWithDefaultSpecConsts);
 
     if (IROutputOnly) {
       if (SplitOccurred) {
@@ -1062,22 +1380,10 @@ processInputModule(std::unique_ptr<Module> M) {
       errs() << "sycl-post-link NOTE: no modifications to the input LLVM IR "
                 "have been made\n";
     }
-    for (module_split::ModuleDesc &IrMD : MMs) {
-      IrPropSymFilenameTriple T = saveModule(IrMD, ID, OutIRFileName);
+    std::vector<IrPropSymFilenameTriple> Rows;
+    ID += saveSplit(MMs, MMsWithDefaultSpecConsts, ID, OutIRFileName, Rows);
+    for (const IrPropSymFilenameTriple &T : Rows)
       addTableRow(*Table, T);
-    }
-
-    ++ID;
-
-    if (!MMsWithDefaultSpecConsts.empty()) {
-      for (size_t i = 0; i != MMsWithDefaultSpecConsts.size(); ++i) {
-        module_split::ModuleDesc &IrMD = MMsWithDefaultSpecConsts[i];
-        IrPropSymFilenameTriple T = saveModule(IrMD, ID, OutIRFileName);
-        addTableRow(*Table, T);
-      }
-
-      ++ID;
-    }
   }
   return Table;
 }
@@ -1107,6 +1413,9 @@ int main(int argc, char **argv) {
       "  one module per kernel will be emitted.\n"
       "  '-split=auto' mode automatically selects the best way of splitting\n"
       "  kernels into modules based on some heuristic.\n"
+      "  '-split=size' mode groups kernels sharing the most code into\n"
+      "  modules of about '-split-size' instructions, starting with the\n"
+      "  kernels which run together according to '-split-profile'.\n"
       "  The '-split' option is compatible with '-split-esimd'. In this case,\n"
       "  first input module will be split according to the '-split' option\n"
       "  processing algorithm, not distinguishing between SYCL and ESIMD\n"
@@ -1117,6 +1426,11 @@ int main(int argc, char **argv) {
       "- Specialization constant intrinsic transformer. Replaces symbolic\n"
       "  ID-based intrinsics to integer ID-based ones to make them friendly\n"
       "  for the SPIRV translator\n"
+      "- Fallback device library linker. With '-fallback-device-lib-dir',\n"
+      "  only the fallback device library functions used by each module are\n"
+      "  linked into it, instead of the whole libraries at runtime.\n"
+      "- Function merging. With '-merge-functions', the identical device\n"
+      "  functions are merged and the identical kernels share one body.\n"
       "When the tool splits input module into regular SYCL and ESIMD kernels,\n"
       "it performs a set of specific lowering and transformation passes on\n"
       "ESIMD module, which is enabled by the '-lower-esimd' option. Regular\n"
@@ -1192,8 +1506,14 @@ int main(int argc, char **argv) {
     return 1;
   }
 
+  TimeTracerRAII TimeTracer(argv[0]);
+
   SMDiagnostic Err;
-  std::unique_ptr<Module> M = parseIRFile(InputFilename, Err, Context);
+  std::unique_ptr<Module> M;
+  {
+    TimeTraceScope Scope("Parse input module");
+    M = parseIRFile(InputFilename, Err, Context);
+  }
   // It is OK to use raw pointer here as we control that it does not outlive M
   // or objects it is moved to
   Module *MPtr = M.get();
@@ -0,0 +1,42 @@
+// -*- C++ -*-
+// -*-===----------------------------------------------------------------------===//
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_INTERNAL_SYCL_PARALLEL_FOR_H
+#define _PSTL_INTERNAL_SYCL_PARALLEL_FOR_H
+
+#include <cstddef>
+
+#include "util.h"
+
+namespace __pstl
+{
+namespace __sycl_backend
+{
+
+//------------------------------------------------------------------------
+// Notation:
+// Evaluation of brick f[i,j) for each subrange [i,j) of [first, last)
+//------------------------------------------------------------------------
+
+template <class _ExecutionPolicy, class _Index, class _Fp>
+void
+__parallel_for(__pstl::__internal::__sycl_backend_tag, _ExecutionPolicy&& __exec, _Index __first, _Index __last,
+               _Fp __f)
+{
+    sycl::queue __queue = __sycl_backend::__get_queue(std::forward<_ExecutionPolicy>(__exec));
+    // Each work-item evaluates the brick on a subrange of one element, so that
+    // the work-items of a sub-group access consecutive elements.
+    __sycl_backend::__parallel_for_index(__queue, static_cast<std::size_t>(__last - __first),
+                                         [=](std::size_t __i) { __f(__first + __i, __first + (__i + 1)); });
+}
+
+} // namespace __sycl_backend
+} // namespace __pstl
+#endif // _PSTL_INTERNAL_SYCL_PARALLEL_FOR_H
@@ -0,0 +1,34 @@
+// -*- C++ -*-
+// -*-===----------------------------------------------------------------------===//
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_INTERNAL_SYCL_PARALLEL_FOR_EACH_H
+#define _PSTL_INTERNAL_SYCL_PARALLEL_FOR_EACH_H
+
+#include <cstddef>
+
+#include "util.h"
+
+namespace __pstl
+{
+namespace __sycl_backend
+{
+
+template <class _ExecutionPolicy, class _RandomAccessIterator, class _Fp>
+void
+__parallel_for_each(_ExecutionPolicy&& __exec, _RandomAccessIterator __first, _RandomAccessIterator __last, _Fp __f)
+{
+    sycl::queue __queue = __sycl_backend::__get_queue(std::forward<_ExecutionPolicy>(__exec));
+    __sycl_backend::__parallel_for_index(__queue, static_cast<std::size_t>(__last - __first),
+                                         [=](std::size_t __i) { __f(__first[__i]); });
+}
+
+} // namespace __sycl_backend
+} // namespace __pstl
+#endif // _PSTL_INTERNAL_SYCL_PARALLEL_FOR_EACH_H
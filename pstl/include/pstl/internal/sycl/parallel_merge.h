@@ -0,0 +1,70 @@
+// -*- C++ -*-
+// -*-===----------------------------------------------------------------------===//
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_INTERNAL_SYCL_PARALLEL_MERGE_H
+#define _PSTL_INTERNAL_SYCL_PARALLEL_MERGE_H
+
+#include <cstddef>
+
+#include "util.h"
+
+namespace __pstl
+{
+namespace __sycl_backend
+{
+
+// Copies the element __i of the concatenation of the sorted ranges [__xs,
+// __xs + __size_x) and [__ys, __ys + __size_y) to its position in their stable
+// merge at __zs. Its position is its index in its range plus the number of
+// elements of the other range which go before it, found by binary search.
+template <typename _RandomAccessIterator1, typename _RandomAccessIterator2, typename _RandomAccessIterator3,
+          typename _Compare>
+void
+__merge_one(std::size_t __i, _RandomAccessIterator1 __xs, std::size_t __size_x, _RandomAccessIterator2 __ys,
+            std::size_t __size_y, _RandomAccessIterator3 __zs, _Compare __comp)
+{
+    if (__i < __size_x)
+    {
+        auto&& __x = __xs[__i];
+        std::size_t __rank = __sycl_backend::__partition_point(__ys, __size_y,
+                                                               [&](const auto& __y) { return __comp(__y, __x); });
+        __zs[__i + __rank] = __x;
+    }
+    else
+    {
+        __i -= __size_x;
+        auto&& __y = __ys[__i];
+        std::size_t __rank = __sycl_backend::__partition_point(__xs, __size_x,
+                                                               [&](const auto& __x) { return !__comp(__y, __x); });
+        __zs[__i + __rank] = __y;
+    }
+}
+
+template <class _ExecutionPolicy, typename _RandomAccessIterator1, typename _RandomAccessIterator2,
+          typename _RandomAccessIterator3, typename _Compare, typename _LeafMerge>
+void
+__parallel_merge(__pstl::__internal::__sycl_backend_tag, _ExecutionPolicy&& __exec, _RandomAccessIterator1 __xs,
+                 _RandomAccessIterator1 __xe, _RandomAccessIterator2 __ys, _RandomAccessIterator2 __ye,
+                 _RandomAccessIterator3 __zs, _Compare __comp, _LeafMerge /* __leaf_merge */)
+{
+    sycl::queue __queue = __sycl_backend::__get_queue(std::forward<_ExecutionPolicy>(__exec));
+    const std::size_t __size_x = __xe - __xs;
+    const std::size_t __size_y = __ye - __ys;
+
+    // Each work-item places one element, so the merge does not depend on the
+    // leaf merge brick, which runs on the host.
+    __sycl_backend::__parallel_for_index(
+        __queue, __size_x + __size_y,
+        [=](std::size_t __i) { __sycl_backend::__merge_one(__i, __xs, __size_x, __ys, __size_y, __zs, __comp); });
+}
+
+} // namespace __sycl_backend
+} // namespace __pstl
+#endif // _PSTL_INTERNAL_SYCL_PARALLEL_MERGE_H
@@ -0,0 +1,64 @@
+// -*- C++ -*-
+// -*-===----------------------------------------------------------------------===//
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_INTERNAL_SYCL_PARALLEL_REDUCE_H
+#define _PSTL_INTERNAL_SYCL_PARALLEL_REDUCE_H
+
+#include <cstddef>
+
+#include "util.h"
+
+namespace __pstl
+{
+namespace __sycl_backend
+{
+
+//------------------------------------------------------------------------
+// Notation:
+//      r(i,j,init) returns reduction of init with reduction over [i,j)
+//      c(x,y) combines values x and y that were the result of r
+//------------------------------------------------------------------------
+
+template <class _ExecutionPolicy, class _RandomAccessIterator, class _Value, typename _RealBody, typename _Reduction>
+_Value
+__parallel_reduce(__pstl::__internal::__sycl_backend_tag, _ExecutionPolicy&& __exec, _RandomAccessIterator __first,
+                  _RandomAccessIterator __last, _Value __identity, _RealBody __real_body, _Reduction __reduction)
+{
+    const std::size_t __n = __last - __first;
+    _Value __res = __identity;
+    if (__n == 0)
+        return __res;
+
+    sycl::queue __queue = __sycl_backend::__get_queue(std::forward<_ExecutionPolicy>(__exec));
+    {
+        // The reduction combines the partial results with the initial value
+        // of the buffer, which is the identity.
+        sycl::buffer<_Value, 1> __res_buf(&__res, sycl::range<1>(1));
+        __queue
+            .submit(
+                [&](sycl::handler& __cgh)
+                {
+                    auto __redu = sycl::reduction(__res_buf, __cgh, __identity, __reduction);
+                    __cgh.parallel_for(sycl::range<1>(__n), __redu,
+                                       [=](sycl::item<1> __item, auto& __reducer)
+                                       {
+                                           auto __i = __item.get_id(0);
+                                           __reducer.combine(
+                                               __real_body(__first + __i, __first + (__i + 1), __identity));
+                                       });
+                })
+            .wait_and_throw();
+    }
+    return __res;
+}
+
+} // namespace __sycl_backend
+} // namespace __pstl
+#endif // _PSTL_INTERNAL_SYCL_PARALLEL_REDUCE_H
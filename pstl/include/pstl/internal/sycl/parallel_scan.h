@@ -0,0 +1,135 @@
+// -*- C++ -*-
+// -*-===----------------------------------------------------------------------===//
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_INTERNAL_SYCL_PARALLEL_SCAN_H
+#define _PSTL_INTERNAL_SYCL_PARALLEL_SCAN_H
+
+#include <algorithm>
+#include <cstddef>
+
+#include "util.h"
+
+namespace __pstl
+{
+namespace __sycl_backend
+{
+
+// Replaces each of the __m partial sums of __r by the combination of
+// __initial with the partial sums before it, and returns the combination of
+// __initial with all of them. The partial sums are combined by tiles in
+// parallel, and the sums of the tiles are scanned recursively.
+template <typename _Tp, typename _Cp>
+_Tp
+__scan_partials(sycl::queue& __queue, _Tp* __r, std::size_t __m, _Tp __initial, _Cp __combine)
+{
+    const std::size_t __tilesize = __default_tile_size;
+    if (__m <= __tilesize)
+    {
+        __buffer<_Tp> __total(__queue, 1);
+        _Tp* __t = __total.get();
+        __queue
+            .single_task(
+                [=]()
+                {
+                    _Tp __sum = __initial;
+                    for (std::size_t __k = 0; __k < __m; ++__k)
+                    {
+                        _Tp __v = __r[__k];
+                        __r[__k] = __sum;
+                        __sum = __combine(__sum, __v);
+                    }
+                    *__t = __sum;
+                })
+            .wait_and_throw();
+        _Tp __sum = __initial;
+        __queue.copy(__t, &__sum, 1).wait_and_throw();
+        return __sum;
+    }
+
+    const std::size_t __ntiles = __sycl_backend::__tile_count(__m, __tilesize);
+    __buffer<_Tp> __buf(__queue, __ntiles);
+    _Tp* __tiles = __buf.get();
+    __sycl_backend::__parallel_for_index(__queue, __ntiles,
+                                         [=](std::size_t __j)
+                                         {
+                                             std::size_t __k = __j * __tilesize;
+                                             std::size_t __end = std::min(__k + __tilesize, __m);
+                                             _Tp __sum = __r[__k];
+                                             for (++__k; __k < __end; ++__k)
+                                                 __sum = __combine(__sum, __r[__k]);
+                                             __tiles[__j] = __sum;
+                                         });
+
+    _Tp __total = __sycl_backend::__scan_partials(__queue, __tiles, __ntiles, __initial, __combine);
+
+    __sycl_backend::__parallel_for_index(__queue, __ntiles,
+                                         [=](std::size_t __j)
+                                         {
+                                             std::size_t __end = std::min((__j + 1) * __tilesize, __m);
+                                             _Tp __sum = __tiles[__j];
+                                             for (std::size_t __k = __j * __tilesize; __k < __end; ++__k)
+                                             {
+                                                 _Tp __v = __r[__k];
+                                                 __r[__k] = __sum;
+                                                 __sum = __combine(__sum, __v);
+                                             }
+                                         });
+    return __total;
+}
+
+//------------------------------------------------------------------------
+// Notation:
+//      r(i,len) returns the reduction of the tile [i,i+len)
+//      c(x,y) combines values x and y that were the result of r
+//      s(i,len,init) scans the tile [i,i+len) with the initial value init
+//      a(sum) is called with the combination of init with the reduction of
+//      the whole range
+//------------------------------------------------------------------------
+
+template <class _ExecutionPolicy, typename _Index, typename _Tp, typename _Rp, typename _Cp, typename _Sp, typename _Ap>
+void
+__parallel_strict_scan(__pstl::__internal::__sycl_backend_tag, _ExecutionPolicy&& __exec, _Index __n, _Tp __initial,
+                       _Rp __reduce, _Cp __combine, _Sp __scan, _Ap __apex)
+{
+    if (__n == 0)
+    {
+        __apex(__initial);
+        return;
+    }
+
+    sycl::queue __queue = __sycl_backend::__get_queue(std::forward<_ExecutionPolicy>(__exec));
+    const std::size_t __size = __n;
+    const std::size_t __tilesize = __default_tile_size;
+    const std::size_t __m = __sycl_backend::__tile_count(__size, __tilesize);
+    __buffer<_Tp> __buf(__queue, __m);
+    _Tp* __r = __buf.get();
+
+    __sycl_backend::__parallel_for_index(__queue, __m,
+                                         [=](std::size_t __k)
+                                         {
+                                             std::size_t __i = __k * __tilesize;
+                                             std::size_t __len = std::min(__tilesize, __size - __i);
+                                             __r[__k] = __reduce(_Index(__i), _Index(__len));
+                                         });
+
+    __apex(__sycl_backend::__scan_partials(__queue, __r, __m, __initial, __combine));
+
+    __sycl_backend::__parallel_for_index(__queue, __m,
+                                         [=](std::size_t __k)
+                                         {
+                                             std::size_t __i = __k * __tilesize;
+                                             std::size_t __len = std::min(__tilesize, __size - __i);
+                                             __scan(_Index(__i), _Index(__len), __r[__k]);
+                                         });
+}
+
+} // namespace __sycl_backend
+} // namespace __pstl
+#endif // _PSTL_INTERNAL_SYCL_PARALLEL_SCAN_H
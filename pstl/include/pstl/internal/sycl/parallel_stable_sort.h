@@ -0,0 +1,87 @@
+// -*- C++ -*-
+// -*-===----------------------------------------------------------------------===//
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_INTERNAL_SYCL_PARALLEL_STABLE_SORT_H
+#define _PSTL_INTERNAL_SYCL_PARALLEL_STABLE_SORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+#include "util.h"
+#include "parallel_merge.h"
+
+namespace __pstl
+{
+namespace __sycl_backend
+{
+
+namespace __sort_details
+{
+
+// Merges the consecutive sorted runs of __width elements of [__src, __src +
+// __n) pairwise into __dst.
+template <typename _RandomAccessIterator, typename _OutputIterator, typename _Compare>
+void
+__merge_pass(sycl::queue& __queue, _RandomAccessIterator __src, _OutputIterator __dst, std::size_t __n,
+             std::size_t __width, _Compare __comp)
+{
+    __sycl_backend::__parallel_for_index(__queue, __n,
+                                         [=](std::size_t __i)
+                                         {
+                                             std::size_t __start = __i / (2 * __width) * (2 * __width);
+                                             std::size_t __mid = std::min(__start + __width, __n);
+                                             std::size_t __end = std::min(__start + 2 * __width, __n);
+                                             __sycl_backend::__merge_one(__i - __start, __src + __start,
+                                                                         __mid - __start, __src + __mid, __end - __mid,
+                                                                         __dst + __start, __comp);
+                                         });
+}
+
+} // namespace __sort_details
+
+template <class _ExecutionPolicy, typename _RandomAccessIterator, typename _Compare, typename _LeafSort>
+void
+__parallel_stable_sort(__pstl::__internal::__sycl_backend_tag, _ExecutionPolicy&& __exec, _RandomAccessIterator __xs,
+                       _RandomAccessIterator __xe, _Compare __comp, _LeafSort /* __leaf_sort */,
+                       std::size_t /* __nsort */ = 0)
+{
+    using _ValueType = typename std::iterator_traits<_RandomAccessIterator>::value_type;
+
+    const std::size_t __count = static_cast<std::size_t>(__xe - __xs);
+    if (__count <= 1)
+        return;
+
+    // The leaf sort brick runs on the host, so the whole range is sorted by a
+    // bottom-up merge sort on the device, which also satisfies a partial sort
+    // of the first __nsort elements.
+    sycl::queue __queue = __sycl_backend::__get_queue(std::forward<_ExecutionPolicy>(__exec));
+    __buffer<_ValueType> __buf(__queue, __count);
+    _ValueType* __tmp = __buf.get();
+
+    bool __in_buffer = false;
+    for (std::size_t __width = 1; __width < __count; __width *= 2)
+    {
+        if (__in_buffer)
+            __sort_details::__merge_pass(__queue, __tmp, __xs, __count, __width, __comp);
+        else
+            __sort_details::__merge_pass(__queue, __xs, __tmp, __count, __width, __comp);
+        __in_buffer = !__in_buffer;
+    }
+
+    // Move the values from the buffer back in the original source range.
+    if (__in_buffer)
+        __sycl_backend::__parallel_for_index(__queue, __count,
+                                             [=](std::size_t __i) { __xs[__i] = std::move(__tmp[__i]); });
+}
+
+} // namespace __sycl_backend
+} // namespace __pstl
+#endif // _PSTL_INTERNAL_SYCL_PARALLEL_STABLE_SORT_H
@@ -0,0 +1,66 @@
+// -*- C++ -*-
+// -*-===----------------------------------------------------------------------===//
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_INTERNAL_SYCL_PARALLEL_TRANSFORM_REDUCE_H
+#define _PSTL_INTERNAL_SYCL_PARALLEL_TRANSFORM_REDUCE_H
+
+#include <cstddef>
+
+#include "util.h"
+
+namespace __pstl
+{
+namespace __sycl_backend
+{
+
+//------------------------------------------------------------------------
+// parallel_transform_reduce
+//
+// Notation:
+//      r(i,j,init) returns reduction of init with reduction over [i,j)
+//      u(i) returns f(i,i+1,identity) for a hypothetical left identity element
+//      of r c(x,y) combines values x and y that were the result of r or u
+//------------------------------------------------------------------------
+
+template <class _ExecutionPolicy, class _RandomAccessIterator, class _UnaryOp, class _Value, class _Combiner,
+          class _Reduction>
+_Value
+__parallel_transform_reduce(__pstl::__internal::__sycl_backend_tag, _ExecutionPolicy&& __exec,
+                            _RandomAccessIterator __first, _RandomAccessIterator __last, _UnaryOp __unary_op,
+                            _Value __init, _Combiner __combiner, _Reduction /* __reduction */)
+{
+    const std::size_t __n = __last - __first;
+    _Value __result = __init;
+    if (__n == 0)
+        return __result;
+
+    sycl::queue __queue = __sycl_backend::__get_queue(std::forward<_ExecutionPolicy>(__exec));
+    {
+        // There is no identity, so the reduction is identity-less and
+        // combines the transformed elements with the initial value of the
+        // buffer, which is __init.
+        sycl::buffer<_Value, 1> __result_buf(&__result, sycl::range<1>(1));
+        __queue
+            .submit(
+                [&](sycl::handler& __cgh)
+                {
+                    auto __redu = sycl::reduction(__result_buf, __cgh, __combiner);
+                    __cgh.parallel_for(sycl::range<1>(__n), __redu,
+                                       [=](sycl::item<1> __item, auto& __reducer)
+                                       { __reducer.combine(__unary_op(__first + __item.get_id(0))); });
+                })
+            .wait_and_throw();
+    }
+    return __result;
+}
+
+} // namespace __sycl_backend
+} // namespace __pstl
+#endif // _PSTL_INTERNAL_SYCL_PARALLEL_TRANSFORM_REDUCE_H
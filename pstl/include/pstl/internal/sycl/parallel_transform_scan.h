@@ -0,0 +1,70 @@
+// -*- C++ -*-
+// -*-===----------------------------------------------------------------------===//
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_INTERNAL_SYCL_PARALLEL_TRANSFORM_SCAN_H
+#define _PSTL_INTERNAL_SYCL_PARALLEL_TRANSFORM_SCAN_H
+
+#include <algorithm>
+#include <cstddef>
+
+#include "util.h"
+#include "parallel_scan.h"
+
+namespace __pstl
+{
+namespace __sycl_backend
+{
+
+//------------------------------------------------------------------------
+// Notation:
+//      r(i,j) returns the reduction of the transformed elements of [i,j)
+//      c(x,y) combines values x and y that were the result of r
+//      s(i,j,init) scans [i,j) with the initial value init and returns the
+//      combination of init with the reduction of [i,j)
+//------------------------------------------------------------------------
+
+template <class _ExecutionPolicy, class _Index, class _Up, class _Tp, class _Cp, class _Rp, class _Sp>
+_Tp
+__parallel_transform_scan(__pstl::__internal::__sycl_backend_tag, _ExecutionPolicy&& __exec, _Index __n,
+                          _Up /* __u */, _Tp __init, _Cp __combine, _Rp __brick_reduce, _Sp __scan)
+{
+    if (__n == 0)
+        return __init;
+
+    sycl::queue __queue = __sycl_backend::__get_queue(std::forward<_ExecutionPolicy>(__exec));
+    const std::size_t __size = __n;
+    const std::size_t __tilesize = __default_tile_size;
+    const std::size_t __m = __sycl_backend::__tile_count(__size, __tilesize);
+    __buffer<_Tp> __buf(__queue, __m);
+    _Tp* __r = __buf.get();
+
+    __sycl_backend::__parallel_for_index(__queue, __m,
+                                         [=](std::size_t __k)
+                                         {
+                                             std::size_t __i = __k * __tilesize;
+                                             std::size_t __j = std::min(__i + __tilesize, __size);
+                                             __r[__k] = __brick_reduce(_Index(__i), _Index(__j));
+                                         });
+
+    _Tp __total = __sycl_backend::__scan_partials(__queue, __r, __m, __init, __combine);
+
+    __sycl_backend::__parallel_for_index(__queue, __m,
+                                         [=](std::size_t __k)
+                                         {
+                                             std::size_t __i = __k * __tilesize;
+                                             std::size_t __j = std::min(__i + __tilesize, __size);
+                                             __scan(_Index(__i), _Index(__j), __r[__k]);
+                                         });
+    return __total;
+}
+
+} // namespace __sycl_backend
+} // namespace __pstl
+#endif // _PSTL_INTERNAL_SYCL_PARALLEL_TRANSFORM_SCAN_H
@@ -0,0 +1,146 @@
+// -*- C++ -*-
+// -*-===----------------------------------------------------------------------===//
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _PSTL_INTERNAL_SYCL_UTIL_H
+#define _PSTL_INTERNAL_SYCL_UTIL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include <sycl/sycl.hpp>
+
+namespace __pstl
+{
+namespace __internal
+{
+struct __sycl_backend_tag
+{
+};
+} // namespace __internal
+
+namespace __sycl_backend
+{
+
+//------------------------------------------------------------------------
+// Execution policy running the algorithms on the device of a SYCL queue.
+// The iterators passed to the algorithms must be random access iterators
+// to USM memory accessible from that device, e.g. USM pointers. The values
+// and the functors are copied to the device, so they must be device
+// copyable.
+//------------------------------------------------------------------------
+
+class sycl_policy
+{
+    sycl::queue __queue_;
+
+  public:
+    explicit sycl_policy(sycl::queue __queue) : __queue_(std::move(__queue)) {}
+
+    sycl::queue
+    queue() const
+    {
+        return __queue_;
+    }
+};
+
+template <class _ExecutionPolicy>
+sycl::queue
+__get_queue(_ExecutionPolicy&& __exec)
+{
+    return std::forward<_ExecutionPolicy>(__exec).queue();
+}
+
+//------------------------------------------------------------------------
+// use to cancel execution
+//------------------------------------------------------------------------
+inline void
+__cancel_execution()
+{
+    // Kernels which have been submitted cannot be canceled.
+}
+
+//------------------------------------------------------------------------
+// raw buffer in the memory of the device
+//------------------------------------------------------------------------
+
+template <typename _Tp>
+class __buffer
+{
+    sycl::queue __queue_;
+    _Tp* __ptr_;
+    __buffer(const __buffer&) = delete;
+    void
+    operator=(const __buffer&) = delete;
+
+  public:
+    __buffer(sycl::queue __queue, std::size_t __n)
+        : __queue_(std::move(__queue)), __ptr_(sycl::malloc_device<_Tp>(__n, __queue_))
+    {
+    }
+
+    operator bool() const { return __ptr_ != nullptr; }
+
+    _Tp*
+    get() const
+    {
+        return __ptr_;
+    }
+    ~__buffer() { sycl::free(__ptr_, __queue_); }
+};
+
+// Number of elements processed sequentially by a work-item in the tiled
+// algorithms.
+inline constexpr std::size_t __default_tile_size = 256;
+
+inline std::size_t
+__tile_count(std::size_t __n, std::size_t __tile_size = __default_tile_size)
+{
+    return (__n + __tile_size - 1) / __tile_size;
+}
+
+// Runs __f(__i) for each __i in [0, __n) on the device of the queue and waits
+// for the completion.
+template <class _Fp>
+void
+__parallel_for_index(sycl::queue& __queue, std::size_t __n, _Fp __f)
+{
+    if (__n == 0)
+        return;
+    __queue.parallel_for(sycl::range<1>(__n), [=](sycl::item<1> __item) { __f(__item.get_id(0)); }).wait_and_throw();
+}
+
+// Returns the number of leading elements of the partitioned range [__first,
+// __first + __n) which satisfy __pred.
+template <typename _RandomAccessIterator, typename _Pred>
+std::size_t
+__partition_point(_RandomAccessIterator __first, std::size_t __n, _Pred __pred)
+{
+    std::size_t __begin = 0;
+    while (__n > 0)
+    {
+        std::size_t __half = __n / 2;
+        if (__pred(__first[__begin + __half]))
+        {
+            __begin += __half + 1;
+            __n -= __half + 1;
+        }
+        else
+        {
+            __n = __half;
+        }
+    }
+    return __begin;
+}
+
+} // namespace __sycl_backend
+} // namespace __pstl
+
+#endif // _PSTL_INTERNAL_SYCL_UTIL_H
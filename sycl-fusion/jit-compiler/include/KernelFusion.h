@@ -61,6 +61,22 @@ public:
               View<ParameterInternalization> Internalization,
               View<jit_compiler::JITConstant> JITConstants);
 
+  /// Fold the values of the emulated specialization constants of the kernel
+  /// described by KernelInfo, which reads them from a buffer passed as its
+  /// last argument, into a copy of the kernel named MaterializedKernelName,
+  /// and translate it to the target configured with JITTargetInfo.
+  /// SpecConstBlob holds the values, laid out as in the buffer.
+  static FusionResult
+  materializeSpecConstants(const SYCLKernelInfo &KernelInfo,
+                           const char *MaterializedKernelName,
+                           View<unsigned char> SpecConstBlob);
+
+  /// Extract the kernel described by KernelInfo and the functions it calls
+  /// from its module, and translate them to the target configured with
+  /// JITTargetInfo, so that the kernel can be compiled without the other
+  /// kernels of the module.
+  static FusionResult extractKernel(const SYCLKernelInfo &KernelInfo);
+
   /// Clear all previously set options.
   static void resetConfiguration();
 
@@ -191,6 +191,76 @@ FusionResult KernelFusion::fuseKernels(
   return FusionResult{FusedKernelInfo};
 }
 
+FusionResult KernelFusion::materializeSpecConstants(
+    const SYCLKernelInfo &KernelInfo, const char *MaterializedKernelName,
+    View<unsigned char> SpecConstBlob) {
+  TargetInfo TargetInfo = ConfigHelper::get<option::JITTargetInfo>();
+  BinaryFormat TargetFormat = TargetInfo.getFormat();
+  if (!isTargetFormatSupported(TargetFormat)) {
+    return FusionResult(
+        "Materialization target format not supported by this build");
+  }
+
+  auto &JITCtx = JITContext::getInstance();
+  std::vector<SYCLKernelInfo> Kernels{KernelInfo};
+  llvm::Expected<std::unique_ptr<llvm::Module>> ModOrError =
+      translation::KernelTranslator::loadKernels(*JITCtx.getLLVMContext(),
+                                                 Kernels);
+  if (auto Error = ModOrError.takeError()) {
+    return errorToFusionResult(std::move(Error), "Loading of kernel failed");
+  }
+  std::unique_ptr<llvm::Module> Mod = std::move(*ModOrError);
+
+  if (auto Error = fusion::FusionPipeline::runMaterializerPasses(
+          *Mod, KernelInfo.Name.c_str(), MaterializedKernelName,
+          SpecConstBlob.to<llvm::ArrayRef>())) {
+    return errorToFusionResult(
+        std::move(Error), "Materialization of specialization constants failed");
+  }
+
+  SYCLKernelInfo &MaterializedInfo = Kernels.front();
+  MaterializedInfo.Name = DynString{MaterializedKernelName};
+  if (auto Error = translation::KernelTranslator::translateKernel(
+          MaterializedInfo, *Mod, JITCtx, TargetFormat)) {
+    return errorToFusionResult(std::move(Error),
+                               "Translation to output format failed");
+  }
+
+  return FusionResult{MaterializedInfo};
+}
+
+FusionResult KernelFusion::extractKernel(const SYCLKernelInfo &KernelInfo) {
+  TargetInfo TargetInfo = ConfigHelper::get<option::JITTargetInfo>();
+  BinaryFormat TargetFormat = TargetInfo.getFormat();
+  if (!isTargetFormatSupported(TargetFormat)) {
+    return FusionResult("Extraction target format not supported by this build");
+  }
+
+  auto &JITCtx = JITContext::getInstance();
+  std::vector<SYCLKernelInfo> Kernels{KernelInfo};
+  llvm::Expected<std::unique_ptr<llvm::Module>> ModOrError =
+      translation::KernelTranslator::loadKernels(*JITCtx.getLLVMContext(),
+                                                 Kernels);
+  if (auto Error = ModOrError.takeError()) {
+    return errorToFusionResult(std::move(Error), "Loading of kernel failed");
+  }
+  std::unique_ptr<llvm::Module> Mod = std::move(*ModOrError);
+
+  if (auto Error = fusion::FusionPipeline::runExtractionPasses(
+          *Mod, KernelInfo.Name.c_str())) {
+    return errorToFusionResult(std::move(Error), "Extraction of kernel failed");
+  }
+
+  SYCLKernelInfo &ExtractedInfo = Kernels.front();
+  if (auto Error = translation::KernelTranslator::translateKernel(
+          ExtractedInfo, *Mod, JITCtx, TargetFormat)) {
+    return errorToFusionResult(std::move(Error),
+                               "Translation to output format failed");
+  }
+
+  return FusionResult{ExtractedInfo};
+}
+
 void KernelFusion::resetConfiguration() { ConfigHelper::reset(); }
 
 void KernelFusion::set(OptionPtrBase *Option) {
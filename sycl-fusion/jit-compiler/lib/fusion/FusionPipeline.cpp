@@ -13,10 +13,14 @@
 #include "internalization/Internalization.h"
 #include "kernel-fusion/SYCLKernelFusion.h"
 #include "kernel-info/SYCLKernelInfo.h"
+#include "memforward/MemForwarding.h"
+#include "specconst/SYCLSpecConstMaterializer.h"
 #include "syclcp/SYCLCP.h"
 
 #include "llvm/IR/PassManager.h"
 #include "llvm/Transforms/IPO/AlwaysInliner.h"
+#include "llvm/Transforms/IPO/GlobalDCE.h"
+#include "llvm/Transforms/IPO/Internalize.h"
 #include "llvm/Transforms/Scalar/IndVarSimplify.h"
 #include "llvm/Transforms/Scalar/InferAddressSpaces.h"
 #include "llvm/Transforms/Scalar/LoopUnrollPass.h"
@@ -125,6 +129,14 @@ FusionPipeline::runFusionPasses(Module &Mod, SYCLModuleInfo &InputInfo,
     FPM.addPass(SimplifyCFGPass{});
     FPM.addPass(ADCEPass{});
     FPM.addPass(EarlyCSEPass{/*UseMemorySSA*/ true});
+    // Forward values and remove dead stores across the bounds of the input
+    // kernels, which the passes above cannot do for the memory that is not
+    // internalized, as the barriers between the kernels may write any memory.
+    // This relies on EarlyCSE having unified the address computations.
+    FPM.addPass(SYCLMemForwarding{});
+    FPM.addPass(InstCombinePass{});
+    FPM.addPass(EarlyCSEPass{/*UseMemorySSA*/ true});
+    FPM.addPass(ADCEPass{});
     MPM.addPass(createModuleToFunctionPassAdaptor(std::move(FPM)));
   }
   MPM.run(Mod, MAM);
@@ -141,3 +153,93 @@ FusionPipeline::runFusionPasses(Module &Mod, SYCLModuleInfo &InputInfo,
 
   return std::make_unique<SYCLModuleInfo>(std::move(*NewModInfo.ModuleInfo));
 }
+
+Error FusionPipeline::runMaterializerPasses(
+    Module &Mod, StringRef KernelName, StringRef MaterializedName,
+    ArrayRef<unsigned char> SpecConstBlob) {
+  auto *Kernel = Mod.getFunction(KernelName);
+  if (!Kernel || Kernel->isDeclaration()) {
+    return createStringError(inconvertibleErrorCode(),
+                             "Kernel function not found in module");
+  }
+  Kernel->setName(MaterializedName);
+  if (Kernel->getName() != MaterializedName) {
+    return createStringError(inconvertibleErrorCode(),
+                             "Name of materialized kernel already in use");
+  }
+
+  bool DebugEnabled = ConfigHelper::get<option::JITEnableVerbose>();
+  if (DebugEnabled) {
+    jit_compiler::PassDebug = true;
+  }
+
+  PassBuilder PB;
+  LoopAnalysisManager LAM;
+  FunctionAnalysisManager FAM;
+  CGSCCAnalysisManager CGAM;
+  ModuleAnalysisManager MAM;
+  PB.registerModuleAnalyses(MAM);
+  PB.registerCGSCCAnalyses(CGAM);
+  PB.registerFunctionAnalyses(FAM);
+  PB.registerLoopAnalyses(LAM);
+  PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+  ModulePassManager MPM;
+  MPM.addPass(SYCLSpecConstMaterializer{MaterializedName, SpecConstBlob});
+  {
+    FunctionPassManager FPM;
+    // Fold the loads of the constants, then the branches and loop bounds
+    // depending on them, e.g., to fully unroll loops over tile sizes.
+    FPM.addPass(InstCombinePass{});
+    FPM.addPass(SCCPPass{});
+    FPM.addPass(SimplifyCFGPass{});
+    FPM.addPass(createFunctionToLoopPassAdaptor(IndVarSimplifyPass{}));
+    LoopUnrollOptions UnrollOptions;
+    FPM.addPass(LoopUnrollPass{UnrollOptions});
+    FPM.addPass(SROAPass{SROAOptions::ModifyCFG});
+    FPM.addPass(InstCombinePass{});
+    FPM.addPass(SimplifyCFGPass{});
+    FPM.addPass(EarlyCSEPass{/*UseMemorySSA*/ true});
+    FPM.addPass(ADCEPass{});
+    MPM.addPass(createModuleToFunctionPassAdaptor(std::move(FPM)));
+  }
+  MPM.run(Mod, MAM);
+
+  if (DebugEnabled) {
+    jit_compiler::PassDebug = false;
+  }
+
+  assert(!verifyModule(Mod, &errs()) && "Invalid LLVM IR generated");
+  return Error::success();
+}
+
+Error FusionPipeline::runExtractionPasses(Module &Mod, StringRef KernelName) {
+  auto *Kernel = Mod.getFunction(KernelName);
+  if (!Kernel || Kernel->isDeclaration()) {
+    return createStringError(inconvertibleErrorCode(),
+                             "Kernel function not found in module");
+  }
+
+  PassBuilder PB;
+  LoopAnalysisManager LAM;
+  FunctionAnalysisManager FAM;
+  CGSCCAnalysisManager CGAM;
+  ModuleAnalysisManager MAM;
+  PB.registerModuleAnalyses(MAM);
+  PB.registerCGSCCAnalyses(CGAM);
+  PB.registerFunctionAnalyses(FAM);
+  PB.registerLoopAnalyses(LAM);
+  PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+  ModulePassManager MPM;
+  // Only the kernel stays visible outside of the module, so that the other
+  // kernels and everything only they use can be removed.
+  MPM.addPass(InternalizePass{[KernelName](const GlobalValue &GV) {
+    return GV.getName() == KernelName;
+  }});
+  MPM.addPass(GlobalDCEPass{});
+  MPM.run(Mod, MAM);
+
+  assert(!verifyModule(Mod, &errs()) && "Invalid LLVM IR generated");
+  return Error::success();
+}
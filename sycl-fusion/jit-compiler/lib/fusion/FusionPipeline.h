@@ -12,6 +12,7 @@
 #include "Kernel.h"
 #include "ModuleInfo.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/Error.h"
 
 namespace jit_compiler {
 namespace fusion {
@@ -27,6 +28,21 @@ public:
   static std::unique_ptr<SYCLModuleInfo>
   runFusionPasses(llvm::Module &Mod, SYCLModuleInfo &InputInfo,
                   BarrierFlags BarriersFlags);
+
+  ///
+  /// Run the passes folding the values of the emulated specialization
+  /// constants SpecConstBlob into the kernel KernelName of the given module,
+  /// which is renamed to MaterializedName.
+  static llvm::Error
+  runMaterializerPasses(llvm::Module &Mod, llvm::StringRef KernelName,
+                        llvm::StringRef MaterializedName,
+                        llvm::ArrayRef<unsigned char> SpecConstBlob);
+
+  ///
+  /// Run the passes removing everything but the kernel KernelName and the
+  /// functions and globals it uses from the given module.
+  static llvm::Error runExtractionPasses(llvm::Module &Mod,
+                                         llvm::StringRef KernelName);
 };
 } // namespace fusion
 } // namespace jit_compiler
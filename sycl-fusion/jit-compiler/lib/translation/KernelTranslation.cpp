@@ -98,7 +98,15 @@ KernelTranslator::loadKernels(llvm::LLVMContext &LLVMCtx,
         break;
       }
       case BinaryFormat::SPIRV: {
-        auto ModOrError = loadSPIRVKernel(LLVMCtx, Kernel);
+        // Only the kernels stored in this module are translated from it.
+        std::set<std::string> EntryPoints;
+        for (const auto &Other : Kernels) {
+          if (BinaryBlob{Other.BinaryInfo.BinaryStart,
+                         Other.BinaryInfo.BinarySize} == BinBlob) {
+            EntryPoints.insert(Other.Name.c_str());
+          }
+        }
+        auto ModOrError = loadSPIRVKernel(LLVMCtx, Kernel, EntryPoints);
         if (auto Err = ModOrError.takeError()) {
           return std::move(Err);
         }
@@ -164,8 +172,9 @@ KernelTranslator::loadLLVMKernel(llvm::LLVMContext &LLVMCtx,
 
 llvm::Expected<std::unique_ptr<llvm::Module>>
 KernelTranslator::loadSPIRVKernel(llvm::LLVMContext &LLVMCtx,
-                                  SYCLKernelInfo &Kernel) {
-  return SPIRVLLVMTranslator::loadSPIRVKernel(LLVMCtx, Kernel);
+                                  SYCLKernelInfo &Kernel,
+                                  const std::set<std::string> &EntryPoints) {
+  return SPIRVLLVMTranslator::loadSPIRVKernel(LLVMCtx, Kernel, EntryPoints);
 }
 
 llvm::Error KernelTranslator::translateKernel(SYCLKernelInfo &Kernel,
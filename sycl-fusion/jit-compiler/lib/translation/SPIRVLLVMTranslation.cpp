@@ -54,7 +54,8 @@ SPIRV::TranslatorOpts &SPIRVLLVMTranslator::translatorOpts() {
 
 Expected<std::unique_ptr<llvm::Module>>
 SPIRVLLVMTranslator::loadSPIRVKernel(llvm::LLVMContext &LLVMCtx,
-                                     SYCLKernelInfo &Kernel) {
+                                     SYCLKernelInfo &Kernel,
+                                     const std::set<std::string> &EntryPoints) {
   std::unique_ptr<Module> Result{nullptr};
 
   SYCLKernelBinaryInfo &BinInfo = Kernel.BinaryInfo;
@@ -70,8 +71,11 @@ SPIRVLLVMTranslator::loadSPIRVKernel(llvm::LLVMContext &LLVMCtx,
   // Create a raw pointer. readSpirv accepts a reference to a pointer,
   // so it will reset the pointer to point to an actual LLVM module.
   Module *LLVMMod;
-  auto Success =
-      llvm::readSpirv(LLVMCtx, translatorOpts(), SPIRStream, LLVMMod, ErrMsg);
+  // The other kernels of the module are not fused, translating them would
+  // only add to the JIT compilation time.
+  SPIRV::TranslatorOpts Opts = translatorOpts();
+  Opts.setEntryPointsToTranslate(EntryPoints);
+  auto Success = llvm::readSpirv(LLVMCtx, Opts, SPIRStream, LLVMMod, ErrMsg);
   if (!Success) {
     return createStringError(
         inconvertibleErrorCode(),
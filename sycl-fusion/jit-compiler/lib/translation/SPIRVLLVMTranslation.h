@@ -15,6 +15,7 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include <llvm/Support/Error.h>
+#include <set>
 #include <vector>
 
 namespace jit_compiler {
@@ -23,9 +24,12 @@ namespace translation {
 class SPIRVLLVMTranslator {
 public:
   ///
-  /// Load a list of SPIR-V kernels into a single LLVM module.
+  /// Load a list of SPIR-V kernels into a single LLVM module. Only the
+  /// functions named in EntryPoints and the functions they use are
+  /// translated from the SPIR-V module of Kernel.
   static llvm::Expected<std::unique_ptr<llvm::Module>>
-  loadSPIRVKernel(llvm::LLVMContext &LLVMCtx, SYCLKernelInfo &Kernel);
+  loadSPIRVKernel(llvm::LLVMContext &LLVMCtx, SYCLKernelInfo &Kernel,
+                  const std::set<std::string> &EntryPoints);
 
   ///
   /// Translate the LLVM IR module Mod to SPIR-V, store it in the JITContext and
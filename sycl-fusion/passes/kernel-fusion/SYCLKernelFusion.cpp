@@ -33,6 +33,7 @@ using namespace llvm;
 
 constexpr StringLiteral SYCLKernelFusion::NDRangeMDKey;
 constexpr StringLiteral SYCLKernelFusion::NDRangesMDKey;
+constexpr StringLiteral SYCLKernelFusion::FusionBarrierMDKey;
 
 struct InputKernel {
   StringRef Name;
@@ -266,7 +267,15 @@ static Expected<CallInst *> createFusionCall(
 
   // Insert barrier if needed
   if (!IsLast && !jit_compiler::isNoBarrierFlag(BarriersFlags)) {
+    auto *BB = Builder.GetInsertBlock();
+    const auto NumInsts = BB->size();
     TargetInfo.createBarrierCall(Builder, BarriersFlags);
+    // Tag the instructions making up the barrier, which may be several, e.g.,
+    // a fence and a barrier intrinsic.
+    auto *Tag = MDNode::get(BB->getContext(), {});
+    for (auto &I : make_range(std::next(BB->begin(), NumInsts), BB->end())) {
+      I.setMetadata(SYCLKernelFusion::FusionBarrierMDKey, Tag);
+    }
   }
 
   // Set insert point for future insertions
@@ -34,6 +34,10 @@ class SYCLKernelFusion : public llvm::PassInfoMixin<SYCLKernelFusion> {
 public:
   constexpr static llvm::StringLiteral NDRangeMDKey{"sycl.kernel.nd-range"};
   constexpr static llvm::StringLiteral NDRangesMDKey{"sycl.kernel.nd-ranges"};
+  /// Attached to the instructions of the barriers inserted between the input
+  /// kernels, so that later passes can tell them from the user's barriers.
+  constexpr static llvm::StringLiteral FusionBarrierMDKey{
+      "sycl.kernel.fusion.barrier"};
 
   constexpr SYCLKernelFusion() = default;
   constexpr explicit SYCLKernelFusion(jit_compiler::BarrierFlags BarriersFlags)
@@ -0,0 +1,201 @@
+//==-------------------------- MemForwarding.cpp ---------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "MemForwarding.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/MemoryLocation.h"
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+
+#include "debug/PassDebug.h"
+#include "kernel-fusion/SYCLKernelFusion.h"
+
+#define DEBUG_TYPE "sycl-fusion"
+
+using namespace llvm;
+
+///
+/// Upper bound of the pairs of accesses checked in a function, to keep the
+/// compilation time in check for large kernels.
+static constexpr unsigned MaxPairs = 4096;
+
+///
+/// Returns true if Pred holds for all the instructions which may execute
+/// after From and before To on a path from From to To. From and To may be
+/// visited themselves if they are part of a cycle on such a path.
+template <typename PredTy>
+static bool allBetween(Instruction *From, Instruction *To, PredTy Pred) {
+  auto *FromBB = From->getParent();
+  auto *ToBB = To->getParent();
+
+  // The blocks on the paths are reachable from FromBB and reach ToBB.
+  SmallPtrSet<BasicBlock *, 16> Reached;
+  SmallVector<BasicBlock *> Worklist{succ_begin(FromBB), succ_end(FromBB)};
+  while (!Worklist.empty()) {
+    auto *BB = Worklist.pop_back_val();
+    if (Reached.insert(BB).second) {
+      append_range(Worklist, successors(BB));
+    }
+  }
+  SmallPtrSet<BasicBlock *, 16> Region;
+  Worklist.assign(pred_begin(ToBB), pred_end(ToBB));
+  while (!Worklist.empty()) {
+    auto *BB = Worklist.pop_back_val();
+    if (Reached.contains(BB) && Region.insert(BB).second) {
+      append_range(Worklist, predecessors(BB));
+    }
+  }
+
+  for (auto *BB : Region) {
+    if (!all_of(*BB, Pred)) {
+      return false;
+    }
+  }
+  auto Between = [&](BasicBlock::iterator Begin, BasicBlock::iterator End) {
+    return std::all_of(Begin, End, Pred);
+  };
+  if (FromBB == ToBB) {
+    return Region.contains(FromBB) ||
+           Between(std::next(From->getIterator()), To->getIterator());
+  }
+  return (Region.contains(FromBB) ||
+          Between(std::next(From->getIterator()), FromBB->end())) &&
+         (Region.contains(ToBB) || Between(ToBB->begin(), To->getIterator()));
+}
+
+///
+/// Returns true if no instruction between From and To accesses Loc as given
+/// by Access, apart from the barriers of fusion, of which at most one may be
+/// crossed.
+static bool isUnaccessedBetween(Instruction *From, Instruction *To,
+                                const MemoryLocation &Loc, ModRefInfo Access,
+                                AAResults &AA) {
+  unsigned NumBarriers = 0;
+  return allBetween(From, To, [&](Instruction &I) {
+    if (I.getMetadata(SYCLKernelFusion::FusionBarrierMDKey)) {
+      // A barrier may consist of a fence and a call, count the latter only.
+      return !isa<CallBase>(I) || ++NumBarriers <= 1;
+    }
+    // The barriers of the input kernels order the accesses of different
+    // work-items, which cannot be reordered across them.
+    if (auto *CB = dyn_cast<CallBase>(&I); CB && CB->isConvergent()) {
+      return false;
+    }
+    return !isModOrRefSet(AA.getModRefInfo(&I, Loc) & Access);
+  });
+}
+
+///
+/// Returns true if S stores a value of the type accessed by I.
+static bool isForwardable(StoreInst *S, Instruction *I) {
+  return S->isSimple() &&
+         S->getValueOperand()->getType() == getLoadStoreType(I);
+}
+
+///
+/// Replaces the loads of a value stored before by the stored value.
+static bool forwardStores(Function &F, AAResults &AA, DominatorTree &DT) {
+  SmallVector<StoreInst *> Stores;
+  SmallVector<LoadInst *> Loads;
+  for (auto &I : instructions(F)) {
+    if (auto *S = dyn_cast<StoreInst>(&I)) {
+      Stores.push_back(S);
+    } else if (auto *L = dyn_cast<LoadInst>(&I); L && L->isSimple()) {
+      Loads.push_back(L);
+    }
+  }
+
+  bool Changed = false;
+  unsigned NumPairs = 0;
+  for (auto *L : Loads) {
+    const auto Loc = MemoryLocation::get(L);
+    for (auto *S : Stores) {
+      if (!isForwardable(S, L) || !DT.dominates(S, L) ||
+          AA.alias(MemoryLocation::get(S), Loc) != AliasResult::MustAlias) {
+        continue;
+      }
+      if (++NumPairs > MaxPairs) {
+        return Changed;
+      }
+      if (isUnaccessedBetween(S, L, Loc, ModRefInfo::Mod, AA)) {
+        FUSION_DEBUG(llvm::dbgs() << "Forwarding " << *S << " to " << *L
+                                  << "\n");
+        L->replaceAllUsesWith(S->getValueOperand());
+        L->eraseFromParent();
+        Changed = true;
+        break;
+      }
+    }
+  }
+  return Changed;
+}
+
+///
+/// Removes the stores which are always overwritten before being read.
+static bool eliminateDeadStores(Function &F, AAResults &AA,
+                                PostDominatorTree &PDT) {
+  SmallVector<StoreInst *> Stores;
+  for (auto &I : instructions(F)) {
+    if (auto *S = dyn_cast<StoreInst>(&I)) {
+      Stores.push_back(S);
+    }
+  }
+
+  SmallPtrSet<StoreInst *, 8> Dead;
+  unsigned NumPairs = 0;
+  for (auto *S1 : Stores) {
+    if (!S1->isSimple()) {
+      continue;
+    }
+    const auto Loc = MemoryLocation::get(S1);
+    for (auto *S2 : Stores) {
+      if (S2 == S1 || Dead.contains(S2) || !isForwardable(S2, S1) ||
+          !PDT.dominates(S2, S1) ||
+          AA.alias(MemoryLocation::get(S2), Loc) != AliasResult::MustAlias) {
+        continue;
+      }
+      if (++NumPairs > MaxPairs) {
+        break;
+      }
+      if (isUnaccessedBetween(S1, S2, Loc, ModRefInfo::Ref, AA)) {
+        FUSION_DEBUG(llvm::dbgs() << "Removing " << *S1
+                                  << " overwritten by " << *S2 << "\n");
+        Dead.insert(S1);
+        break;
+      }
+    }
+  }
+  for (auto *S : Dead) {
+    S->eraseFromParent();
+  }
+  return !Dead.empty();
+}
+
+PreservedAnalyses SYCLMemForwarding::run(Function &F,
+                                         FunctionAnalysisManager &AM) {
+  auto &AA = AM.getResult<AAManager>(F);
+  auto &DT = AM.getResult<DominatorTreeAnalysis>(F);
+  auto &PDT = AM.getResult<PostDominatorTreeAnalysis>(F);
+
+  // Forward first, as removing loads may make stores dead.
+  bool Changed = forwardStores(F, AA, DT);
+  Changed |= eliminateDeadStores(F, AA, PDT);
+  if (!Changed) {
+    return PreservedAnalyses::all();
+  }
+  PreservedAnalyses PA;
+  PA.preserveSet<CFGAnalyses>();
+  return PA;
+}
@@ -0,0 +1,34 @@
+//==--- MemForwarding.h - Store forwarding across the fused kernels' bounds ==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SYCL_FUSION_PASSES_MEMFORWARDING_H
+#define SYCL_FUSION_PASSES_MEMFORWARDING_H
+
+#include <llvm/IR/PassManager.h>
+
+namespace llvm {
+///
+/// Forwards stored values to the loads of the same location and removes the
+/// stores which are overwritten before being read, including across the
+/// barriers inserted between the input kernels by the SYCLKernelFusion pass.
+/// The general purpose passes cannot do so, as a barrier may write any memory.
+///
+/// Each input kernel is free of data races, so no other work-item accesses a
+/// location between the accesses of one work-item to it in the kernels on
+/// both sides of a single fusion barrier. The accesses may be reordered with
+/// respect to the memory of other work-items, but only a single barrier is
+/// crossed: between two barriers, a kernel could have accessed the location
+/// in another work-item. Barriers called by the input kernels are never
+/// crossed.
+class SYCLMemForwarding : public PassInfoMixin<SYCLMemForwarding> {
+public:
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
+};
+} // namespace llvm
+
+#endif // SYCL_FUSION_PASSES_MEMFORWARDING_H
@@ -0,0 +1,57 @@
+//==---------------------- SYCLSpecConstMaterializer.cpp -------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "SYCLSpecConstMaterializer.h"
+
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Module.h"
+
+#include "debug/PassDebug.h"
+
+#define DEBUG_TYPE "sycl-fusion"
+
+using namespace llvm;
+
+///
+/// Address space of the global holding the values, which is the global one
+/// on all the targets of the JIT compiler.
+constexpr static unsigned GlobalAddressSpace = 1;
+
+PreservedAnalyses SYCLSpecConstMaterializer::run(Module &M,
+                                                 ModuleAnalysisManager &) {
+  auto *F = M.getFunction(KernelName);
+  if (!F || F->isDeclaration() || F->arg_empty() || SpecConstBlob.empty()) {
+    FUSION_DEBUG(llvm::dbgs() << "No specialization constants to materialize "
+                              << "in " << KernelName << "\n");
+    return PreservedAnalyses::all();
+  }
+  auto *BufferArg = F->getArg(F->arg_size() - 1);
+  auto *ArgTy = dyn_cast<PointerType>(BufferArg->getType());
+  if (!ArgTy || BufferArg->use_empty()) {
+    FUSION_DEBUG(llvm::dbgs() << "Kernel " << KernelName
+                              << " does not read specialization constants\n");
+    return PreservedAnalyses::all();
+  }
+
+  auto *Values = ConstantDataArray::get(M.getContext(), SpecConstBlob);
+  auto *GV = new GlobalVariable(
+      M, Values->getType(), /*isConstant*/ true, GlobalValue::InternalLinkage,
+      Values, KernelName + ".spec_consts", nullptr,
+      GlobalValue::NotThreadLocal, GlobalAddressSpace);
+  // At least as aligned as the device buffer holding the values otherwise.
+  GV->setAlignment(Align{128});
+  GV->setUnnamedAddr(GlobalValue::UnnamedAddr::Global);
+
+  Constant *Replacement = GV;
+  if (ArgTy->getAddressSpace() != GlobalAddressSpace) {
+    Replacement = ConstantExpr::getAddrSpaceCast(GV, ArgTy);
+  }
+  BufferArg->replaceAllUsesWith(Replacement);
+  return PreservedAnalyses::none();
+}
@@ -0,0 +1,39 @@
+//==- SYCLSpecConstMaterializer.h - Fold emulated specialization constants -==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SYCL_FUSION_PASSES_SYCLSPECCONSTMATERIALIZER_H
+#define SYCL_FUSION_PASSES_SYCLSPECCONSTMATERIALIZER_H
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/IR/PassManager.h>
+
+namespace llvm {
+///
+/// Pass to materialize emulated specialization constants. With emulation,
+/// sycl-post-link lowers the reads of specialization constants to loads from
+/// a buffer, passed as the last argument of the kernel. This pass replaces
+/// the argument of the given kernel by a constant global holding the values
+/// of the constants, so that the loads can be folded by the following
+/// optimizations.
+class SYCLSpecConstMaterializer
+    : public PassInfoMixin<SYCLSpecConstMaterializer> {
+public:
+  SYCLSpecConstMaterializer(StringRef KernelName,
+                            ArrayRef<unsigned char> SpecConstBlob)
+      : KernelName{KernelName}, SpecConstBlob{SpecConstBlob} {}
+
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
+
+private:
+  StringRef KernelName;
+  ArrayRef<unsigned char> SpecConstBlob;
+};
+} // namespace llvm
+
+#endif // SYCL_FUSION_PASSES_SYCLSPECCONSTMATERIALIZER_H
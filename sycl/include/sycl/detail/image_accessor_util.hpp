@@ -924,7 +924,7 @@ DataT getColor(const int4 PixelCoord, const addressing_mode SmplAddrMode,
 // Computes and returns color value with Linear Filter Mode.
 // Steps:
 // 1. Computes the 8 coordinates using all combinations of i0/i1,j0/j1,k0/k1.
-// 2. Calls getColor() on each Coordinate.(Ci*j*k*)
+// 2. Calls getColor() on each distinct Coordinate.(Ci*j*k*)
 // 3. Computes the return Color Value using a,b,c and the Color values.
 template <typename DataT>
 DataT ReadPixelDataLinearFiltMode(const int8 CoordValues, const float4 abc,
@@ -944,22 +944,24 @@ DataT ReadPixelDataLinearFiltMode(const int8 CoordValues, const float4 abc,
     return Res.template convert<float>();
   };
 
-  // Get Color Values at each Coordinate.
+  // Get Color Values at each Coordinate. The two coordinates of a dimension
+  // are often the same, e.g. for the height and depth of a 1D image or at a
+  // clamped edge, then the colors already read are reused.
   float4 Ci0j0k0 = getColorInFloat(int4{i0, j0, k0, 0});
 
-  float4 Ci1j0k0 = getColorInFloat(int4{i1, j0, k0, 0});
+  float4 Ci1j0k0 = i1 == i0 ? Ci0j0k0 : getColorInFloat(int4{i1, j0, k0, 0});
 
-  float4 Ci0j1k0 = getColorInFloat(int4{i0, j1, k0, 0});
+  float4 Ci0j1k0 = j1 == j0 ? Ci0j0k0 : getColorInFloat(int4{i0, j1, k0, 0});
 
-  float4 Ci1j1k0 = getColorInFloat(int4{i1, j1, k0, 0});
+  float4 Ci1j1k0 = j1 == j0 ? Ci1j0k0 : getColorInFloat(int4{i1, j1, k0, 0});
 
-  float4 Ci0j0k1 = getColorInFloat(int4{i0, j0, k1, 0});
+  float4 Ci0j0k1 = k1 == k0 ? Ci0j0k0 : getColorInFloat(int4{i0, j0, k1, 0});
 
-  float4 Ci1j0k1 = getColorInFloat(int4{i1, j0, k1, 0});
+  float4 Ci1j0k1 = k1 == k0 ? Ci1j0k0 : getColorInFloat(int4{i1, j0, k1, 0});
 
-  float4 Ci0j1k1 = getColorInFloat(int4{i0, j1, k1, 0});
+  float4 Ci0j1k1 = k1 == k0 ? Ci0j1k0 : getColorInFloat(int4{i0, j1, k1, 0});
 
-  float4 Ci1j1k1 = getColorInFloat(int4{i1, j1, k1, 0});
+  float4 Ci1j1k1 = k1 == k0 ? Ci1j1k0 : getColorInFloat(int4{i1, j1, k1, 0});
 
   float a = abc.x();
   float b = abc.y();
@@ -151,6 +151,16 @@ template <class KernelNameType> struct KernelInfo {
 };
 #endif //__SYCL_UNNAMED_LAMBDA__
 
+// Returns the 64-bit FNV-1a hash of a kernel name, which identifies the kernel
+// in the runtime caches. It is computed at compile time for the kernels named
+// by the integration header, so that submitting them hashes no string.
+constexpr unsigned long long getKernelNameHash(const char *Name) {
+  unsigned long long Hash = 0xcbf29ce484222325ULL;
+  for (; *Name; ++Name)
+    Hash = (Hash ^ static_cast<unsigned char>(*Name)) * 0x100000001b3ULL;
+  return Hash;
+}
+
 } // namespace detail
 } // namespace _V1
 } // namespace sycl
@@ -157,9 +157,10 @@
 // 15.46 Add piextGetGlobalVariablePointer
 // 15.47 Added PI_ERROR_FEATURE_UNSUPPORTED.
 // 15.48 Add CommandBuffer update definitions
+// 15.49 Added piextKernelSetArgs and pi_kernel_arg.
 
 #define _PI_H_VERSION_MAJOR 15
-#define _PI_H_VERSION_MINOR 48
+#define _PI_H_VERSION_MINOR 49
 
 #define _PI_STRING_HELPER(a) #a
 #define _PI_CONCAT(a, b) _PI_STRING_HELPER(a.b)
@@ -925,6 +926,10 @@ static constexpr pi_device_binary_type PI_DEVICE_BINARY_TYPE_NATIVE = 1;
 static constexpr pi_device_binary_type PI_DEVICE_BINARY_TYPE_SPIRV = 2;
 // LLVM bitcode
 static constexpr pi_device_binary_type PI_DEVICE_BINARY_TYPE_LLVMIR_BITCODE = 3;
+// compressed with zstd by the offload wrapper, the format of the decompressed
+// data is not determined
+static constexpr pi_device_binary_type PI_DEVICE_BINARY_TYPE_COMPRESSED_NONE =
+    4;
 
 // Device binary descriptor version supported by this library.
 static const uint16_t PI_DEVICE_BINARY_VERSION = 1;
@@ -1917,6 +1922,35 @@ __SYCL_EXPORT pi_result piextKernelSetArgSampler(pi_kernel kernel,
                                                  pi_uint32 arg_index,
                                                  const pi_sampler *arg_value);
 
+typedef enum {
+  /// Set as with piKernelSetArg, a null value being local memory
+  PI_KERNEL_ARG_KIND_VALUE = 0,
+  /// Set as with piextKernelSetArgPointer
+  PI_KERNEL_ARG_KIND_POINTER = 1,
+  /// Set as with piextKernelSetArgMemObj, value is a const pi_mem *
+  PI_KERNEL_ARG_KIND_MEM_OBJ = 2,
+  /// Set as with piextKernelSetArgSampler, value is a const pi_sampler *
+  PI_KERNEL_ARG_KIND_SAMPLER = 3
+} _pi_kernel_arg_kind;
+using pi_kernel_arg_kind = _pi_kernel_arg_kind;
+
+typedef struct {
+  pi_kernel_arg_kind kind;
+  pi_uint32 index;
+  size_t size;
+  const void *value;
+  /// Properties of a PI_KERNEL_ARG_KIND_MEM_OBJ argument, may be null
+  const pi_mem_obj_property *mem_obj_properties;
+} _pi_kernel_arg;
+using pi_kernel_arg = _pi_kernel_arg;
+
+// Extension to set several arguments of a kernel in one call, in the order of
+// the array. The call fails at the first argument which cannot be set, the
+// arguments before it remain set.
+__SYCL_EXPORT pi_result piextKernelSetArgs(pi_kernel kernel,
+                                           pi_uint32 num_args,
+                                           const pi_kernel_arg *args);
+
 ///
 // USM
 ///
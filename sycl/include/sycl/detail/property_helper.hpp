@@ -48,8 +48,14 @@ enum DataLessPropKind {
   GraphAssumeBufferOutlivesGraph = 23,
   GraphDependOnAllLeaves = 24,
   GraphUpdatable = 25,
+  GraphEnableFusion = 26,
+  GraphEnableMultiDevice = 27,
+  ContextUSMPooling = 28,
+  QueueSplitLargeCopies = 29,
+  BufferZeroCopy = 30,
+  BufferAsyncRelease = 31,
   // Indicates the last known dataless property.
-  LastKnownDataLessPropKind = 25,
+  LastKnownDataLessPropKind = 31,
   // Exceeding 32 may cause ABI breaking change on some of OSes.
   DataLessPropKindSize = 32
 };
@@ -64,7 +70,11 @@ enum PropWithDataKind {
   AccPropBufferLocation = 5,
   QueueComputeIndex = 6,
   GraphNodeDependencies = 7,
-  PropWithDataKindSize = 8
+  MemoryPoolReleaseThreshold = 8,
+  QueueSubmissionBatchSize = 9,
+  QueueAutoFusion = 10,
+  QueueAutoGraph = 11,
+  PropWithDataKindSize = 12
 };
 
 // Base class for dataless properties, needed to check that the type of an
@@ -23,6 +23,7 @@ inline namespace _V1 {
 
 // Forward declaration
 namespace detail {
+class context_impl;
 class queue_impl;
 }
 
@@ -45,6 +46,7 @@ public:
   iterator end() const;
 
 private:
+  friend class detail::context_impl;
   friend class detail::queue_impl;
   void PushBack(const_reference Value);
   void PushBack(value_type &&Value);
@@ -13,6 +13,7 @@
 #include <sycl/properties/property_traits.hpp> // for is_property, is_prope...
 #include <sycl/queue.hpp>                      // for queue
 
+#include <cstddef>     // for size_t
 #include <type_traits> // for true_type
 
 namespace sycl {
@@ -31,6 +32,22 @@ class force_fusion : public detail::DataLessProperty<detail::FusionForce> {};
 
 namespace queue {
 class enable_fusion : public detail::DataLessProperty<detail::FusionEnable> {};
+
+// Fuses the kernels submitted to the queue without start_fusion and
+// complete_fusion calls. The kernels are collected in a fusion, which is
+// completed once it has max_kernels kernels, by queue::wait and before any
+// other command submitted to the queue. A synchronization with one of the
+// collected kernels, e.g. through its event or a host accessor, runs them
+// unfused.
+class auto_fusion : public detail::PropertyWithData<
+                        detail::PropWithDataKind::QueueAutoFusion> {
+public:
+  auto_fusion(size_t max_kernels = 8) : max_kernels(max_kernels) {}
+  size_t get_max_kernels() const { return max_kernels; }
+
+private:
+  size_t max_kernels;
+};
 } // namespace queue
 
 } // namespace ext::codeplay::experimental::property
@@ -67,6 +84,10 @@ template <>
 struct is_property<ext::codeplay::experimental::property::queue::enable_fusion>
     : std::true_type {};
 
+template <>
+struct is_property<ext::codeplay::experimental::property::queue::auto_fusion>
+    : std::true_type {};
+
 // Buffer property trait specializations
 template <typename T, int Dimensions, typename AllocatorT>
 struct is_property_of<ext::codeplay::experimental::property::promote_private,
@@ -101,5 +122,9 @@ struct is_property_of<
     ext::codeplay::experimental::property::queue::enable_fusion, queue>
     : std::true_type {};
 
+template <>
+struct is_property_of<ext::codeplay::experimental::property::queue::auto_fusion,
+                      queue> : std::true_type {};
+
 } // namespace _V1
 } // namespace sycl
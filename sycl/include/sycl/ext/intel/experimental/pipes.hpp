@@ -18,6 +18,7 @@
 #include <sycl/info/info_desc.hpp>                         // for event_com...
 #include <sycl/memory_enums.hpp>                           // for memory_order
 #include <sycl/queue.hpp>                                  // for queue
+#include <sycl/sycl_span.hpp>                              // for span
 
 #ifdef __SYCL_DEVICE_ONLY__
 #include <sycl/ext/intel/experimental/fpga_utils.hpp>
@@ -132,6 +133,68 @@ public:
                   sycl::info::event_command_status::complete;
   }
 
+  // Reads Data.size() elements through a single host pipe transfer. Success
+  // is false if they could not all be read, in which case the contents of
+  // Data are unspecified.
+  static void read(queue &Q, span<_dataT> Data, bool &Success,
+                   memory_order Order = memory_order::seq_cst) {
+    // Order is currently unused.
+    std::ignore = Order;
+
+    Success = false;
+    const device Dev = Q.get_device();
+    bool IsPipeSupported =
+        Dev.has_extension("cl_intel_program_scope_host_pipe");
+    if (!IsPipeSupported)
+      return;
+    if (Data.empty()) {
+      Success = true;
+      return;
+    }
+    void *DataPtr = Data.data();
+    size_t Size = Data.size_bytes();
+    const void *HostPipePtr = &m_Storage;
+    const std::string PipeName = pipe_base::get_pipe_name(HostPipePtr);
+
+    event E = Q.submit([=](handler &CGH) {
+      CGH.ext_intel_read_host_pipe(PipeName, DataPtr, Size /* non-blocking */);
+    });
+    Success = wait_non_blocking(E) &&
+              E.get_info<sycl::info::event::command_execution_status>() ==
+                  sycl::info::event_command_status::complete;
+  }
+
+  // Writes Data.size() elements through a single host pipe transfer. Success
+  // is false if they could not all be written.
+  static void write(queue &Q, span<const _dataT> Data, bool &Success,
+                    memory_order Order = memory_order::seq_cst) {
+    // Order is currently unused.
+    std::ignore = Order;
+
+    Success = false;
+    const device Dev = Q.get_device();
+    bool IsPipeSupported =
+        Dev.has_extension("cl_intel_program_scope_host_pipe");
+    if (!IsPipeSupported)
+      return;
+    if (Data.empty()) {
+      Success = true;
+      return;
+    }
+    void *DataPtr = const_cast<_dataT *>(Data.data());
+    size_t Size = Data.size_bytes();
+    const void *HostPipePtr = &m_Storage;
+    const std::string PipeName = pipe_base::get_pipe_name(HostPipePtr);
+
+    event E = Q.submit([=](handler &CGH) {
+      CGH.ext_intel_write_host_pipe(PipeName, DataPtr,
+                                    Size /* non-blocking */);
+    });
+    Success = wait_non_blocking(E) &&
+              E.get_info<sycl::info::event::command_execution_status>() ==
+                  sycl::info::event_command_status::complete;
+  }
+
   // Reading from pipe is lowered to SPIR-V instruction OpReadPipe via SPIR-V
   // friendly LLVM IR.
   template <typename _functionPropertiesT>
@@ -277,6 +340,49 @@ public:
     E.wait();
   }
 
+  // Reads Data.size() elements through a single host pipe transfer.
+  static void read(queue &Q, span<_dataT> Data,
+                   memory_order Order = memory_order::seq_cst) {
+    // Order is currently unused.
+    std::ignore = Order;
+
+    const device Dev = Q.get_device();
+    bool IsPipeSupported =
+        Dev.has_extension("cl_intel_program_scope_host_pipe");
+    if (!IsPipeSupported || Data.empty())
+      return;
+    void *DataPtr = Data.data();
+    size_t Size = Data.size_bytes();
+    const void *HostPipePtr = &m_Storage;
+    const std::string PipeName = pipe_base::get_pipe_name(HostPipePtr);
+    event E = Q.submit([=](handler &CGH) {
+      CGH.ext_intel_read_host_pipe(PipeName, DataPtr, Size, true /*blocking*/);
+    });
+    E.wait();
+  }
+
+  // Writes Data.size() elements through a single host pipe transfer.
+  static void write(queue &Q, span<const _dataT> Data,
+                    memory_order Order = memory_order::seq_cst) {
+    // Order is currently unused.
+    std::ignore = Order;
+
+    const device Dev = Q.get_device();
+    bool IsPipeSupported =
+        Dev.has_extension("cl_intel_program_scope_host_pipe");
+    if (!IsPipeSupported || Data.empty())
+      return;
+    void *DataPtr = const_cast<_dataT *>(Data.data());
+    size_t Size = Data.size_bytes();
+    const void *HostPipePtr = &m_Storage;
+    const std::string PipeName = pipe_base::get_pipe_name(HostPipePtr);
+    event E = Q.submit([=](handler &CGH) {
+      CGH.ext_intel_write_host_pipe(PipeName, DataPtr, Size,
+                                    true /*blocking */);
+    });
+    E.wait();
+  }
+
   // Reading from pipe is lowered to SPIR-V instruction OpReadPipe via SPIR-V
   // friendly LLVM IR.
   template <typename _functionPropertiesT>
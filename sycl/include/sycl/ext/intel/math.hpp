@@ -61,22 +61,38 @@ namespace sycl {
 inline namespace _V1 {
 namespace ext::intel::math {
 
+// On the host, the float and double functions below which are computed by a
+// builtin in the host implementation of the device library are computed
+// inline, so that the host loops calling them can be vectorized.
+
 static_assert(sizeof(sycl::half) == sizeof(_iml_half_internal),
               "sycl::half is not compatible with _iml_half_internal.");
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, float>, float> saturate(Tp x) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_saturatef(x);
+#else
+  return __builtin_fminf(__builtin_fmaxf(x, .0f), 1.f);
+#endif
 }
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, float>, float> copysign(Tp x, Tp y) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_copysignf(x, y);
+#else
+  return __builtin_copysignf(x, y);
+#endif
 }
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, double>, double> copysign(Tp x, Tp y) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_copysign(x, y);
+#else
+  return __builtin_copysign(x, y);
+#endif
 }
 
 template <typename Tp>
@@ -89,12 +105,20 @@ std::enable_if_t<std::is_same_v<Tp, sycl::half>, sycl::half> copysign(Tp x,
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, float>, float> ceil(Tp x) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_ceilf(x);
+#else
+  return __builtin_ceilf(x);
+#endif
 }
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, double>, double> ceil(Tp x) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_ceil(x);
+#else
+  return __builtin_ceil(x);
+#endif
 }
 
 template <typename Tp>
@@ -110,12 +134,20 @@ std::enable_if_t<std::is_same_v<Tp, sycl::half2>, sycl::half2> ceil(Tp x) {
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, float>, float> floor(Tp x) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_floorf(x);
+#else
+  return __builtin_floorf(x);
+#endif
 }
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, double>, double> floor(Tp x) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_floor(x);
+#else
+  return __builtin_floor(x);
+#endif
 }
 
 template <typename Tp>
@@ -131,12 +163,20 @@ std::enable_if_t<std::is_same_v<Tp, sycl::half2>, sycl::half2> floor(Tp x) {
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, float>, float> inv(Tp x) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_invf(x);
+#else
+  return 1.0f / x;
+#endif
 }
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, double>, double> inv(Tp x) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_inv(x);
+#else
+  return 1.0 / x;
+#endif
 }
 
 template <typename Tp>
@@ -152,12 +192,20 @@ std::enable_if_t<std::is_same_v<Tp, sycl::half2>, sycl::half2> inv(Tp x) {
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, float>, float> rint(Tp x) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_rintf(x);
+#else
+  return __builtin_rintf(x);
+#endif
 }
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, double>, double> rint(Tp x) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_rint(x);
+#else
+  return __builtin_rint(x);
+#endif
 }
 
 template <typename Tp>
@@ -173,12 +221,20 @@ std::enable_if_t<std::is_same_v<Tp, sycl::half2>, sycl::half2> rint(Tp x) {
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, float>, float> sqrt(Tp x) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_sqrtf(x);
+#else
+  return __builtin_sqrtf(x);
+#endif
 }
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, double>, double> sqrt(Tp x) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_sqrt(x);
+#else
+  return __builtin_sqrt(x);
+#endif
 }
 
 template <typename Tp>
@@ -194,12 +250,20 @@ std::enable_if_t<std::is_same_v<Tp, sycl::half2>, sycl::half2> sqrt(Tp x) {
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, float>, float> rsqrt(Tp x) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_rsqrtf(x);
+#else
+  return 1.f / __builtin_sqrtf(x);
+#endif
 }
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, double>, double> rsqrt(Tp x) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_rsqrt(x);
+#else
+  return 1.0 / __builtin_sqrt(x);
+#endif
 }
 
 template <typename Tp>
@@ -215,12 +279,20 @@ std::enable_if_t<std::is_same_v<Tp, sycl::half2>, sycl::half2> rsqrt(Tp x) {
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, float>, float> trunc(Tp x) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_truncf(x);
+#else
+  return __builtin_truncf(x);
+#endif
 }
 
 template <typename Tp>
 std::enable_if_t<std::is_same_v<Tp, double>, double> trunc(Tp x) {
+#ifdef __SYCL_DEVICE_ONLY__
   return __imf_trunc(x);
+#else
+  return __builtin_trunc(x);
+#endif
 }
 
 template <typename Tp>
@@ -53,6 +53,22 @@ template <typename... Ts>
 using contains_alignment =
     detail::ContainsProperty<alignment_key, std::tuple<Ts...>>;
 
+#ifdef __SYCL_DEVICE_ONLY__
+// Makes the alignment property, if any, of the pointer known to the optimizer,
+// so that the accesses through it are widened on all the targets.
+template <typename... Props, typename T> T *assumeAligned(T *Ptr) {
+  if constexpr (contains_alignment<Props...>::value) {
+    using PropsT = properties_t<Props...>;
+    constexpr size_t Alignment =
+        PropsT::template get_property<alignment_key>().value;
+    return static_cast<T *>(__builtin_assume_aligned(
+        const_cast<std::remove_cv_t<T> *>(Ptr), Alignment));
+  } else {
+    return Ptr;
+  }
+}
+#endif
+
 // properties filter
 template <typename property_list, template <class...> typename filter>
 using PropertiesFilter =
@@ -74,18 +90,6 @@ struct annotationHelper<I, detail::properties_t<P...>> {
         ptr, detail::PropertyMetaInfo<P>::name...,
         detail::PropertyMetaInfo<P>::value...);
   }
-
-  static I load(I *ptr) {
-    return *__builtin_intel_sycl_ptr_annotation(
-        ptr, detail::PropertyMetaInfo<P>::name...,
-        detail::PropertyMetaInfo<P>::value...);
-  }
-
-  template <class O> static I store(I *ptr, O &&Obj) {
-    return *__builtin_intel_sycl_ptr_annotation(
-               ptr, detail::PropertyMetaInfo<P>::name...,
-               detail::PropertyMetaInfo<P>::value...) = std::forward<O>(Obj);
-  }
 };
 
 template <typename T, typename... Props>
@@ -106,8 +110,9 @@ public:
   // implicit conversion with annotaion
   operator T() const {
 #ifdef __SYCL_DEVICE_ONLY__
-    return annotationHelper<T, detail::annotation_filter<Props...>>::load(
-        m_Ptr);
+    return *detail::assumeAligned<Props...>(
+        annotationHelper<T, detail::annotation_filter<Props...>>::annotate(
+            m_Ptr));
 #else
     return *m_Ptr;
 #endif
@@ -117,8 +122,9 @@ public:
   template <class O, typename = std::enable_if_t<!detail::is_ann_ref_v<O>>>
   T operator=(O &&Obj) const {
 #ifdef __SYCL_DEVICE_ONLY__
-    return annotationHelper<T, detail::annotation_filter<Props...>>::store(
-        m_Ptr, Obj);
+    return *detail::assumeAligned<Props...>(
+               annotationHelper<T, detail::annotation_filter<Props...>>::
+                   annotate(m_Ptr)) = std::forward<O>(Obj);
 #else
     return *m_Ptr = std::forward<O>(Obj);
 #endif
@@ -382,8 +388,9 @@ public:
 
   T *get() const noexcept {
 #ifdef __SYCL_DEVICE_ONLY__
-    return annotationHelper<T, detail::annotation_filter<Props...>>::annotate(
-        m_Ptr);
+    return detail::assumeAligned<Props...>(
+        annotationHelper<T, detail::annotation_filter<Props...>>::annotate(
+            m_Ptr));
 #else
     return m_Ptr;
 #endif
@@ -0,0 +1,142 @@
+//==-------- async_alloc.hpp --- SYCL stream-ordered USM allocations -------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sycl/context.hpp>
+#include <sycl/detail/export.hpp>
+#include <sycl/detail/property_helper.hpp>
+#include <sycl/device.hpp>
+#include <sycl/properties/property_traits.hpp>
+#include <sycl/property_list.hpp>
+#include <sycl/queue.hpp>
+#include <sycl/usm/usm_enums.hpp>
+
+#include <cstddef>
+#include <memory>
+
+namespace sycl {
+inline namespace _V1 {
+namespace ext::oneapi::experimental {
+
+namespace detail {
+class memory_pool_impl;
+} // namespace detail
+
+namespace property::memory_pool {
+/// Property passed to the memory_pool constructor to set the amount of memory
+/// kept by the pool for reuse. Freed memory exceeding it is returned to the
+/// backend once the commands using it have completed. By default, all the
+/// freed memory is kept until the pool is destroyed.
+class release_threshold : public ::sycl::detail::PropertyWithData<
+                              ::sycl::detail::MemoryPoolReleaseThreshold> {
+public:
+  release_threshold(size_t Threshold) : MThreshold(Threshold) {}
+  size_t get_threshold() const { return MThreshold; }
+
+private:
+  size_t MThreshold;
+};
+} // namespace property::memory_pool
+
+/// Pool of USM allocations of a device, from which async_malloc_from_pool()
+/// allocates. Memory freed with async_free() is reused by the following
+/// allocations without synchronizing with the device.
+class __SYCL_EXPORT memory_pool {
+public:
+  /// Constructor.
+  /// @param SyclContext Context of the allocations.
+  /// @param SyclDevice Device of the allocations.
+  /// @param Kind Kind of the allocations, device or shared.
+  /// @param PropList Optional list of properties to pass.
+  memory_pool(const context &SyclContext, const device &SyclDevice,
+              usm::alloc Kind, const property_list &PropList = {});
+
+  /// Constructor.
+  /// @param SyclQueue Queue to use for the device and context of the pool.
+  /// @param Kind Kind of the allocations.
+  /// @param PropList Optional list of properties to pass.
+  memory_pool(const queue &SyclQueue, usm::alloc Kind,
+              const property_list &PropList = {});
+
+  context get_context() const;
+  device get_device() const;
+  usm::alloc get_alloc_kind() const;
+
+  /// @return Amount of freed memory kept by the pool for reuse.
+  size_t get_release_threshold() const;
+  void set_release_threshold(size_t Threshold);
+
+  /// @return Size of the memory allocated from the backend by the pool.
+  size_t get_reserved_size_current() const;
+  /// @return Size of the memory currently allocated from the pool.
+  size_t get_used_size_current() const;
+
+  bool operator==(const memory_pool &Rhs) const { return impl == Rhs.impl; }
+  bool operator!=(const memory_pool &Rhs) const { return !(*this == Rhs); }
+
+private:
+  memory_pool(std::shared_ptr<detail::memory_pool_impl> Impl) : impl(Impl) {}
+
+  template <class Obj>
+  friend decltype(Obj::impl)
+  sycl::detail::getSyclObjImpl(const Obj &SyclObject);
+  template <class T>
+  friend T sycl::detail::createSyclObjFromImpl(decltype(T::impl) ImplObj);
+
+  std::shared_ptr<detail::memory_pool_impl> impl;
+};
+
+/// Allocates USM memory from the default pool of the device and context of
+/// the queue. The memory can be used by the commands submitted to the queue
+/// after the call.
+/// @param SyclQueue Queue the allocation is ordered on.
+/// @param Kind Kind of the allocation.
+/// @param Size Number of bytes to allocate.
+/// @return Pointer to the allocated memory.
+__SYCL_EXPORT void *async_malloc(const queue &SyclQueue, usm::alloc Kind,
+                                 size_t Size);
+
+/// Allocates device USM memory from the default pool of the device and
+/// context of the queue.
+inline void *async_malloc(const queue &SyclQueue, size_t Size) {
+  return async_malloc(SyclQueue, usm::alloc::device, Size);
+}
+
+/// Allocates USM memory from a pool. The memory can be used by the commands
+/// submitted to the queue after the call.
+/// @param SyclQueue Queue the allocation is ordered on, which must have the
+/// context and device of the pool.
+/// @param Size Number of bytes to allocate.
+/// @param Pool Pool to allocate from.
+/// @return Pointer to the allocated memory.
+__SYCL_EXPORT void *async_malloc_from_pool(const queue &SyclQueue, size_t Size,
+                                           const memory_pool &Pool);
+
+/// Frees memory allocated by async_malloc() or async_malloc_from_pool() once
+/// the commands submitted to the queue before the call have completed. The
+/// memory is reused right away by the allocations ordered on the same
+/// in-order queue.
+/// @param SyclQueue Queue the deallocation is ordered on.
+/// @param Ptr Memory to free.
+__SYCL_EXPORT void async_free(const queue &SyclQueue, void *Ptr);
+
+} // namespace ext::oneapi::experimental
+
+template <>
+struct is_property<
+    ext::oneapi::experimental::property::memory_pool::release_threshold>
+    : std::true_type {};
+
+template <>
+struct is_property_of<
+    ext::oneapi::experimental::property::memory_pool::release_threshold,
+    ext::oneapi::experimental::memory_pool> : std::true_type {};
+
+} // namespace _V1
+} // namespace sycl
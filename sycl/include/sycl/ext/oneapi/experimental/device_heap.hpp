@@ -0,0 +1,212 @@
+//==-------- device_heap.hpp --- SYCL device-side dynamic memory allocation ==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sycl/atomic_ref.hpp>       // for atomic_ref
+#include <sycl/detail/export.hpp>    // for __SYCL_EXPORT
+#include <sycl/functional.hpp>       // for plus
+#include <sycl/group_algorithm.hpp>  // for exclusive_scan_over_group
+#include <sycl/memory_enums.hpp>     // for memory_order, memory_scope
+#include <sycl/sub_group.hpp>        // for sub_group
+
+#include <stddef.h> // for size_t
+#include <stdint.h> // for uint32_t, uint64_t
+
+namespace sycl {
+inline namespace _V1 {
+class context;
+class device;
+namespace ext::oneapi::experimental {
+
+/// Allocator of memory from the work-items of kernels, for outputs whose size
+/// is only known on the device:
+///
+///   device_heap Heap = get_device_heap(Q.get_context(), Q.get_device());
+///   Q.parallel_for(nd_range<1>{N, 64}, [=](nd_item<1> It) {
+///     size_t Count = countOutputs(It);
+///     float *Out = static_cast<float *>(
+///         Heap.malloc(It.get_sub_group(), Count * sizeof(float)));
+///     ...
+///     Heap.free(Out);
+///   });
+///
+/// The memory is allocated from an arena of USM in blocks of a power of two
+/// bytes, from alignment to max_alloc_size bytes. A freed block is kept in a
+/// lock-free list of the blocks of its size, which the next allocations of the
+/// same size pop from; the other blocks are taken at the end of the used part
+/// of the arena. A zeroed arena is an empty heap. The device must support
+/// 64-bit atomics.
+class device_heap {
+  static constexpr size_t NumSizeClasses = 23;
+
+  // Blocks are addressed by their offset in the arena in units of alignment,
+  // plus one so that zero is no block. A free list head holds the offset of
+  // its first block with, in the high bits, the number of times it changed.
+  struct heap_state {
+    uint64_t MUsed;
+    uint64_t MFreeLists[NumSizeClasses];
+  };
+  struct block_header {
+    uint32_t MSizeClass;
+    uint32_t MNext;
+    uint64_t MPadding;
+  };
+
+  template <typename T>
+  using atomic_t =
+      atomic_ref<T, memory_order::relaxed, memory_scope::device,
+                 access::address_space::global_space>;
+
+public:
+  /// Alignment of the allocated memory, and size of the smallest blocks.
+  static constexpr size_t alignment = 16;
+  static constexpr size_t max_alloc_size = alignment << (NumSizeClasses - 1);
+
+  device_heap() = default;
+
+  /// Manages the memory of the Size bytes at Arena, which must be accessible
+  /// by the device and zeroed before the heap is first used.
+  device_heap(void *Arena, size_t Size)
+      : MArena(static_cast<char *>(Arena)),
+        MCapacity(Size > DataOffset ? Size - DataOffset : 0) {}
+
+  /// \return memory of at least Size bytes, or nullptr if Size is zero or
+  /// larger than max_alloc_size, or if the heap is exhausted.
+  void *malloc(size_t Size) const {
+    if (Size == 0 || Size > max_alloc_size)
+      return nullptr;
+    uint32_t SizeClass = getSizeClass(Size);
+    if (void *Ptr = popFreeBlock(SizeClass))
+      return Ptr;
+    uint64_t Offset = takeUnused(getBlockSize(SizeClass));
+    return Offset == NoBlock ? nullptr : makeBlock(Offset, SizeClass);
+  }
+
+  /// Allocates the memory of all the work-items of a sub-group with a single
+  /// atomic operation on the heap, the blocks are not taken from the free
+  /// lists unless the heap is exhausted. Must be called by all the work-items
+  /// of the sub-group.
+  ///
+  /// \return memory of at least Size bytes, or nullptr if Size is zero or
+  /// larger than max_alloc_size, or if the heap is exhausted.
+  void *malloc(sycl::sub_group SG, size_t Size) const {
+    bool Valid = Size != 0 && Size <= max_alloc_size;
+    uint32_t SizeClass = Valid ? getSizeClass(Size) : 0;
+    uint64_t BlockSize = Valid ? getBlockSize(SizeClass) : 0;
+    uint64_t BlockOffset =
+        exclusive_scan_over_group(SG, BlockSize, sycl::plus<uint64_t>());
+    uint64_t Total = group_broadcast(SG, BlockOffset + BlockSize,
+                                     SG.get_local_linear_range() - 1);
+    uint64_t Offset = NoBlock;
+    if (SG.leader() && Total != 0)
+      Offset = takeUnused(Total);
+    Offset = group_broadcast(SG, Offset);
+    if (!Valid)
+      return nullptr;
+    if (Offset == NoBlock)
+      return malloc(Size);
+    return makeBlock(Offset + BlockOffset, SizeClass);
+  }
+
+  /// Frees memory allocated from this heap, Ptr can be null.
+  void free(void *Ptr) const {
+    if (!Ptr)
+      return;
+    block_header *Header = static_cast<block_header *>(Ptr) - 1;
+    uint32_t Index = static_cast<uint32_t>(
+        (reinterpret_cast<char *>(Header) - MArena - DataOffset) / alignment +
+        1);
+    atomic_t<uint64_t> Head{getState()->MFreeLists[Header->MSizeClass]};
+    uint64_t Old = Head.load();
+    do {
+      atomic_t<uint32_t>{Header->MNext}.store(static_cast<uint32_t>(Old));
+    } while (!Head.compare_exchange_weak(Old, nextHead(Old, Index),
+                                         memory_order::release,
+                                         memory_order::relaxed));
+  }
+
+  /// \return the number of bytes of the arena which can be allocated.
+  size_t capacity() const { return MCapacity; }
+
+private:
+  static constexpr size_t DataOffset =
+      (sizeof(heap_state) + alignment - 1) / alignment * alignment;
+  static constexpr uint64_t NoBlock = ~uint64_t{0};
+
+  static uint32_t getSizeClass(size_t Size) {
+    uint32_t SizeClass = 0;
+    while ((alignment << SizeClass) < Size)
+      ++SizeClass;
+    return SizeClass;
+  }
+
+  // The header of a block is before its memory.
+  static uint64_t getBlockSize(uint32_t SizeClass) {
+    return sizeof(block_header) + (alignment << SizeClass);
+  }
+
+  static uint64_t nextHead(uint64_t Old, uint32_t Index) {
+    return ((Old >> 32) + 1) << 32 | Index;
+  }
+
+  heap_state *getState() const {
+    return reinterpret_cast<heap_state *>(MArena);
+  }
+
+  void *makeBlock(uint64_t Offset, uint32_t SizeClass) const {
+    block_header *Header =
+        reinterpret_cast<block_header *>(MArena + DataOffset + Offset);
+    Header->MSizeClass = SizeClass;
+    return Header + 1;
+  }
+
+  // \return the offset of Size unused bytes, or NoBlock.
+  uint64_t takeUnused(uint64_t Size) const {
+    atomic_t<uint64_t> Used{getState()->MUsed};
+    uint64_t Offset = Used.fetch_add(Size);
+    if (Offset + Size <= MCapacity)
+      return Offset;
+    // The allocations made until it is given back fail as well, so the bytes
+    // left can still be taken by smaller blocks afterwards.
+    Used.fetch_sub(Size);
+    return NoBlock;
+  }
+
+  void *popFreeBlock(uint32_t SizeClass) const {
+    atomic_t<uint64_t> Head{getState()->MFreeLists[SizeClass]};
+    uint64_t Old = Head.load(memory_order::acquire);
+    while (true) {
+      uint32_t Index = static_cast<uint32_t>(Old);
+      if (Index == 0)
+        return nullptr;
+      // The block may be popped by another work-item before the exchange,
+      // which then fails as the head has changed since it was loaded.
+      block_header *Header = reinterpret_cast<block_header *>(
+          MArena + DataOffset + (Index - 1) * uint64_t{alignment});
+      uint32_t Next = atomic_t<uint32_t>{Header->MNext}.load();
+      if (Head.compare_exchange_weak(Old, nextHead(Old, Next),
+                                     memory_order::acquire,
+                                     memory_order::acquire))
+        return Header + 1;
+    }
+  }
+
+  char *MArena = nullptr;
+  size_t MCapacity = 0;
+};
+
+/// \return the heap of an arena reserved by the runtime for a device of a
+/// context, which is freed with the context. The size of the arena is set by
+/// the SYCL_DEVICE_HEAP_SIZE environment variable.
+__SYCL_EXPORT device_heap get_device_heap(const context &SyclContext,
+                                          const device &SyclDevice);
+
+} // namespace ext::oneapi::experimental
+} // namespace _V1
+} // namespace sycl
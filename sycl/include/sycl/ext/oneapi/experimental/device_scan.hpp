@@ -0,0 +1,332 @@
+//==-------- device_scan.hpp --- SYCL device-wide scan algorithms ----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sycl/access/access.hpp>
+#include <sycl/accessor.hpp>
+#include <sycl/atomic_ref.hpp>
+#include <sycl/event.hpp>
+#include <sycl/exception.hpp>
+#include <sycl/functional.hpp>
+#include <sycl/group_algorithm.hpp>
+#include <sycl/group_barrier.hpp>
+#include <sycl/handler.hpp>
+#include <sycl/info/info_desc.hpp>
+#include <sycl/known_identity.hpp>
+#include <sycl/memory_enums.hpp>
+#include <sycl/nd_item.hpp>
+#include <sycl/nd_range.hpp>
+#include <sycl/queue.hpp>
+#include <sycl/range.hpp>
+#include <sycl/usm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace sycl {
+inline namespace _V1 {
+namespace ext::oneapi::experimental {
+
+namespace detail {
+template <typename T, typename BinaryOperation, bool IsInclusive>
+class device_scan_kernel;
+
+/// Number of consecutive elements scanned by each work-item.
+constexpr size_t DeviceScanItemsPerWorkItem = 8;
+
+inline size_t getDeviceScanWorkGroupSize(const queue &Q) {
+  return std::min<size_t>(
+      256, Q.get_device().get_info<sycl::info::device::max_work_group_size>());
+}
+
+// Statuses published by each tile of a device-wide scan for the tiles after
+// it.
+constexpr uint32_t DeviceScanTileInvalid = 0;
+constexpr uint32_t DeviceScanTileAggregate = 1;
+constexpr uint32_t DeviceScanTilePrefix = 2;
+
+/// Layout of the scratch memory of a device-wide scan: the counter of the
+/// tiles started, the status of each tile, then the aggregate and the
+/// inclusive prefix of each tile. The counter and the statuses are zeroed
+/// before each scan.
+template <typename T> struct device_scan_scratch {
+  static size_t getStatusSize(size_t NumTiles) {
+    return (NumTiles + 1) * sizeof(uint32_t);
+  }
+  static size_t getValuesOffset(size_t NumTiles) {
+    return (getStatusSize(NumTiles) + alignof(T) - 1) / alignof(T) *
+           alignof(T);
+  }
+  static size_t getSize(size_t NumTiles) {
+    return getValuesOffset(NumTiles) + 2 * NumTiles * sizeof(T);
+  }
+
+  device_scan_scratch(void *Scratch, size_t NumTiles)
+      : MCounter(static_cast<uint32_t *>(Scratch)), MStatus(MCounter + 1),
+        MAggregates(reinterpret_cast<T *>(static_cast<char *>(Scratch) +
+                                          getValuesOffset(NumTiles))),
+        MPrefixes(MAggregates + NumTiles) {}
+
+  uint32_t *MCounter;
+  uint32_t *MStatus;
+  T *MAggregates;
+  T *MPrefixes;
+};
+
+template <typename T, typename BinaryOperation>
+void checkDeviceScanArgs(const queue &Q, size_t Count) {
+  static_assert(sycl::has_known_identity_v<BinaryOperation, T>,
+                "Device-wide scans require a binary operation with a known "
+                "identity.");
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Device-wide scans require a trivially copyable type.");
+  size_t TileSize = getDeviceScanWorkGroupSize(Q) * DeviceScanItemsPerWorkItem;
+  if ((Count + TileSize - 1) / TileSize >
+      std::numeric_limits<uint32_t>::max())
+    throw sycl::exception(make_error_code(errc::invalid),
+                          "Too many elements for a device-wide scan");
+}
+
+/// Scans the elements of each tile in a work-group, then gets the prefix of
+/// the tile with a decoupled look-back: the tile publishes its aggregate
+/// right away, and its first sub-group combines the statuses of the tiles
+/// before it, a sub-group of tiles at a time, until it finds one which has
+/// published its inclusive prefix. So each element is read and written once
+/// by a single kernel.
+///
+/// The tiles are numbered in the order their work-groups start, so the tiles
+/// a tile waits for have started before it.
+template <bool IsInclusive, typename T, typename BinaryOperation>
+event deviceScan(queue Q, const T *First, size_t Count, T *Result, T Init,
+                 BinaryOperation Op, void *Scratch,
+                 const std::vector<event> &DepEvents) {
+  checkDeviceScanArgs<T, BinaryOperation>(Q, Count);
+  if (Count == 0)
+    return Q.ext_oneapi_submit_barrier(DepEvents);
+
+  using scratch = device_scan_scratch<T>;
+  size_t WGSize = getDeviceScanWorkGroupSize(Q);
+  size_t TileSize = WGSize * DeviceScanItemsPerWorkItem;
+  size_t NumTiles = (Count + TileSize - 1) / TileSize;
+  scratch Tiles{Scratch, NumTiles};
+
+  event Reset = Q.submit([&](handler &CGH) {
+    CGH.depends_on(DepEvents);
+    CGH.memset(Scratch, 0, scratch::getStatusSize(NumTiles));
+  });
+  return Q.submit([&](handler &CGH) {
+    CGH.depends_on(Reset);
+    local_accessor<T, 1> Tile{range<1>{TileSize}, CGH};
+    CGH.parallel_for<device_scan_kernel<T, BinaryOperation, IsInclusive>>(
+        nd_range<1>{NumTiles * WGSize, WGSize}, [=](nd_item<1> It) {
+          using status_ref =
+              atomic_ref<uint32_t, memory_order::relaxed, memory_scope::device,
+                         access::address_space::global_space>;
+          constexpr T Identity = sycl::known_identity_v<BinaryOperation, T>;
+          auto G = It.get_group();
+          auto SG = It.get_sub_group();
+          size_t LId = It.get_local_linear_id();
+
+          uint32_t TileId = 0;
+          if (LId == 0)
+            TileId = status_ref{*Tiles.MCounter}.fetch_add(1);
+          TileId = group_broadcast(G, TileId, 0);
+
+          // Load the tile coalesced, then scan the consecutive elements of
+          // each work-item from local memory.
+          size_t TileBase = TileId * TileSize;
+          for (size_t K = 0; K < DeviceScanItemsPerWorkItem; ++K) {
+            size_t I = K * WGSize + LId;
+            Tile[I] = TileBase + I < Count ? First[TileBase + I] : Identity;
+          }
+          group_barrier(G);
+
+          size_t ItemsBase = LId * DeviceScanItemsPerWorkItem;
+          T ThreadAggregate = Identity;
+          for (size_t K = 0; K < DeviceScanItemsPerWorkItem; ++K)
+            ThreadAggregate = Op(ThreadAggregate, Tile[ItemsBase + K]);
+          T ThreadPrefix = exclusive_scan_over_group(G, ThreadAggregate, Op);
+          T TileAggregate = group_broadcast(
+              G, Op(ThreadPrefix, ThreadAggregate), WGSize - 1);
+
+          T TilePrefix = Identity;
+          if (TileId == 0) {
+            if (LId == 0) {
+              Tiles.MPrefixes[0] = TileAggregate;
+              status_ref{Tiles.MStatus[0]}.store(DeviceScanTilePrefix,
+                                                 memory_order::release);
+            }
+          } else if (SG.get_group_linear_id() == 0) {
+            if (LId == 0) {
+              Tiles.MAggregates[TileId] = TileAggregate;
+              status_ref{Tiles.MStatus[TileId]}.store(DeviceScanTileAggregate,
+                                                      memory_order::release);
+            }
+
+            // Each lane looks at one of the tiles before, the nearest one in
+            // lane 0. The binary operations with a known identity are
+            // commutative, so the lanes can be combined in any order.
+            uint32_t SGSize = SG.get_local_linear_range();
+            uint32_t Lane = SG.get_local_linear_id();
+            for (int64_t Window = int64_t(TileId) - 1;; Window -= SGSize) {
+              int64_t Pred = Window - Lane;
+              uint32_t Status = DeviceScanTilePrefix;
+              do {
+                if (Pred >= 0)
+                  Status = status_ref{Tiles.MStatus[Pred]}.load(
+                      memory_order::acquire);
+              } while (any_of_group(SG, Status == DeviceScanTileInvalid));
+
+              T Value = Identity;
+              if (Pred >= 0)
+                Value = Status == DeviceScanTilePrefix ? Tiles.MPrefixes[Pred]
+                                                   : Tiles.MAggregates[Pred];
+              uint32_t StopLane = reduce_over_group(
+                  SG, Status == DeviceScanTilePrefix ? Lane : SGSize,
+                  sycl::minimum<uint32_t>());
+              TilePrefix = Op(
+                  reduce_over_group(SG, Lane <= StopLane ? Value : Identity,
+                                    Op),
+                  TilePrefix);
+              if (StopLane < SGSize)
+                break;
+            }
+
+            if (LId == 0) {
+              Tiles.MPrefixes[TileId] = Op(TilePrefix, TileAggregate);
+              status_ref{Tiles.MStatus[TileId]}.store(DeviceScanTilePrefix,
+                                                      memory_order::release);
+            }
+          }
+          TilePrefix = group_broadcast(G, TilePrefix, 0);
+
+          T Running = Op(TilePrefix, ThreadPrefix);
+          if constexpr (!IsInclusive)
+            Running = Op(Init, Running);
+          for (size_t K = 0; K < DeviceScanItemsPerWorkItem; ++K) {
+            T Value = Tile[ItemsBase + K];
+            if constexpr (IsInclusive) {
+              Running = Op(Running, Value);
+              Tile[ItemsBase + K] = Running;
+            } else {
+              Tile[ItemsBase + K] = Running;
+              Running = Op(Running, Value);
+            }
+          }
+          group_barrier(G);
+
+          for (size_t K = 0; K < DeviceScanItemsPerWorkItem; ++K) {
+            size_t I = K * WGSize + LId;
+            if (TileBase + I < Count)
+              Result[TileBase + I] = Tile[I];
+          }
+        });
+  });
+}
+
+/// Allocates the scratch memory of a scan and frees it once the scan has
+/// completed.
+template <typename T, typename ScanFuncT>
+event withDeviceScanScratch(queue Q, size_t Count, ScanFuncT ScanFunc);
+} // namespace detail
+
+/// \return the size in bytes of the scratch memory used by a device-wide scan
+/// of \p Count elements of type T on \p Q. The memory can be reused by the
+/// scans of up to \p Count elements on the same device which do not run at
+/// the same time.
+template <typename T>
+size_t get_scan_scratch_size(const queue &Q, size_t Count) {
+  size_t TileSize = detail::getDeviceScanWorkGroupSize(Q) *
+                    detail::DeviceScanItemsPerWorkItem;
+  return detail::device_scan_scratch<T>::getSize((Count + TileSize - 1) /
+                                                 TileSize);
+}
+
+/// Writes the inclusive scan of the \p Count elements from \p First with \p Op
+/// to \p Result, which may be the same as \p First. \p Op must be a SYCL
+/// function object with a known identity for T.
+///
+/// \param Scratch is device or shared memory of at least
+/// get_scan_scratch_size<T>(Q, Count) bytes, which is not used by other
+/// commands until the scan completes.
+/// \return an event of the completion of the scan.
+template <typename T, typename BinaryOperation>
+event inclusive_scan(queue Q, const T *First, size_t Count, T *Result,
+                     BinaryOperation Op, void *Scratch,
+                     const std::vector<event> &DepEvents = {}) {
+  return detail::deviceScan</*IsInclusive=*/true>(
+      Q, First, Count, Result, sycl::known_identity_v<BinaryOperation, T>, Op,
+      Scratch, DepEvents);
+}
+
+/// Writes the exclusive scan of the \p Count elements from \p First with \p Op,
+/// starting from \p Init, to \p Result, which may be the same as \p First.
+/// \p Op must be a SYCL function object with a known identity for T.
+///
+/// \param Scratch is device or shared memory of at least
+/// get_scan_scratch_size<T>(Q, Count) bytes, which is not used by other
+/// commands until the scan completes.
+/// \return an event of the completion of the scan.
+template <typename T, typename BinaryOperation>
+event exclusive_scan(queue Q, const T *First, size_t Count, T *Result,
+                     std::remove_cv_t<T> Init, BinaryOperation Op,
+                     void *Scratch, const std::vector<event> &DepEvents = {}) {
+  return detail::deviceScan</*IsInclusive=*/false>(
+      Q, First, Count, Result, Init, Op, Scratch, DepEvents);
+}
+
+/// Same as above, with scratch memory allocated for the scan.
+template <typename T, typename BinaryOperation>
+event inclusive_scan(queue Q, const T *First, size_t Count, T *Result,
+                     BinaryOperation Op,
+                     const std::vector<event> &DepEvents = {}) {
+  return detail::withDeviceScanScratch<T>(Q, Count, [&](void *Scratch) {
+    return inclusive_scan(Q, First, Count, Result, Op, Scratch, DepEvents);
+  });
+}
+
+/// Same as above, with scratch memory allocated for the scan.
+template <typename T, typename BinaryOperation>
+event exclusive_scan(queue Q, const T *First, size_t Count, T *Result,
+                     std::remove_cv_t<T> Init, BinaryOperation Op,
+                     const std::vector<event> &DepEvents = {}) {
+  return detail::withDeviceScanScratch<T>(Q, Count, [&](void *Scratch) {
+    return exclusive_scan(Q, First, Count, Result, Init, Op, Scratch,
+                          DepEvents);
+  });
+}
+
+namespace detail {
+template <typename T, typename ScanFuncT>
+event withDeviceScanScratch(queue Q, size_t Count, ScanFuncT ScanFunc) {
+  void *Scratch = malloc_device(get_scan_scratch_size<T>(Q, Count), Q);
+  if (!Scratch)
+    throw sycl::exception(make_error_code(errc::memory_allocation),
+                          "Failed to allocate the scratch memory of a scan");
+  event Scan;
+  try {
+    Scan = ScanFunc(Scratch);
+  } catch (...) {
+    sycl::free(Scratch, Q);
+    throw;
+  }
+  return Q.submit([&](handler &CGH) {
+    CGH.depends_on(Scan);
+    CGH.host_task([=, Ctx = Q.get_context()]() { sycl::free(Scratch, Ctx); });
+  });
+}
+} // namespace detail
+
+} // namespace ext::oneapi::experimental
+} // namespace _V1
+} // namespace sycl
@@ -0,0 +1,480 @@
+//==-------- device_sort.hpp --- SYCL device-wide radix sort ---------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#if (!defined(_HAS_STD_BYTE) || _HAS_STD_BYTE != 0)
+
+#include <sycl/access/access.hpp>
+#include <sycl/accessor.hpp>
+#include <sycl/atomic_ref.hpp>
+#include <sycl/event.hpp>
+#include <sycl/exception.hpp>
+#include <sycl/ext/oneapi/experimental/group_helpers_sorters.hpp>
+#include <sycl/group_algorithm.hpp>
+#include <sycl/group_barrier.hpp>
+#include <sycl/handler.hpp>
+#include <sycl/info/info_desc.hpp>
+#include <sycl/memory_enums.hpp>
+#include <sycl/nd_item.hpp>
+#include <sycl/nd_range.hpp>
+#include <sycl/queue.hpp>
+#include <sycl/range.hpp>
+#include <sycl/sycl_span.hpp>
+
+#ifdef __SYCL_DEVICE_ONLY__
+#include <sycl/detail/group_sort_impl.hpp>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace sycl {
+inline namespace _V1 {
+namespace ext::oneapi::experimental {
+
+namespace detail {
+template <typename KeyT, typename ValueT, bool IsAscending>
+class device_sort_histogram_kernel;
+template <typename KeyT, typename ValueT, bool IsAscending>
+class device_sort_scan_kernel;
+template <typename KeyT, typename ValueT, bool IsAscending>
+class device_sort_onesweep_kernel;
+
+/// Value type of the sorts of keys only.
+struct device_sort_no_value {};
+
+template <typename ValueT>
+constexpr bool IsDeviceSortByKey =
+    !std::is_same_v<ValueT, device_sort_no_value>;
+
+/// Each pass of a device-wide sort orders the keys by a digit of this many
+/// bits, starting from the least significant one.
+constexpr uint32_t DeviceSortDigitBits = 8;
+constexpr uint32_t DeviceSortNumDigits = 1u << DeviceSortDigitBits;
+
+// The look-back statuses pack a flag telling what a tile has published for a
+// digit with the count of the digit, so that both are read at once.
+constexpr uint32_t DeviceSortTileAggregate = 1u << 30;
+constexpr uint32_t DeviceSortTilePrefix = 2u << 30;
+constexpr uint32_t DeviceSortCountMask = DeviceSortTileAggregate - 1;
+
+struct device_sort_config {
+  size_t MWGSize;
+  size_t MTileSize;
+};
+
+/// \return the size of the scratch memory the group sorter needs to sort a
+/// tile of TileSize elements with WGSize work-items.
+template <typename KeyT, typename ValueT>
+constexpr size_t getDeviceSortTileScratchSize(size_t WGSize, size_t TileSize) {
+  size_t Size = (1u << 4) * WGSize * sizeof(uint32_t) +
+                TileSize * sizeof(KeyT) + alignof(uint32_t);
+  if constexpr (IsDeviceSortByKey<ValueT>)
+    Size += TileSize * sizeof(ValueT);
+  return Size;
+}
+
+template <typename KeyT, typename ValueT>
+constexpr size_t getDeviceSortLocalMemSize(size_t WGSize, size_t TileSize) {
+  size_t Size = TileSize * sizeof(KeyT) +
+                getDeviceSortTileScratchSize<KeyT, ValueT>(WGSize, TileSize) +
+                2 * DeviceSortNumDigits * sizeof(uint32_t);
+  if constexpr (IsDeviceSortByKey<ValueT>)
+    Size += TileSize * sizeof(ValueT);
+  return Size;
+}
+
+/// Picks the largest tiles for which the local memory of the device is
+/// enough.
+template <typename KeyT, typename ValueT>
+device_sort_config getDeviceSortConfig(const queue &Q) {
+  device Dev = Q.get_device();
+  size_t WGSize = std::min<size_t>(
+      256, Dev.get_info<sycl::info::device::max_work_group_size>());
+  size_t LocalMemSize = Dev.get_info<sycl::info::device::local_mem_size>();
+  size_t TileSize = WGSize * 8;
+  while (TileSize > WGSize && getDeviceSortLocalMemSize<KeyT, ValueT>(
+                                  WGSize, TileSize) > LocalMemSize)
+    TileSize /= 2;
+  return {WGSize, TileSize};
+}
+
+inline size_t alignDeviceSortOffset(size_t Offset, size_t Alignment) {
+  return (Offset + Alignment - 1) / Alignment * Alignment;
+}
+
+/// Layout of the scratch memory of a device-wide sort: the buffers in which
+/// the passes alternate with the input, the histograms of the digits of each
+/// pass, then the counter of the tiles started and the look-back statuses of
+/// each tile and digit, which are zeroed before each pass.
+template <typename KeyT, typename ValueT> struct device_sort_scratch {
+  static constexpr uint32_t NumPasses = sizeof(KeyT);
+
+  static size_t getValuesOffset(size_t Count) {
+    return alignDeviceSortOffset(Count * sizeof(KeyT), alignof(ValueT));
+  }
+  static size_t getHistogramsOffset(size_t Count) {
+    size_t Offset = Count * sizeof(KeyT);
+    if constexpr (IsDeviceSortByKey<ValueT>)
+      Offset = getValuesOffset(Count) + Count * sizeof(ValueT);
+    return alignDeviceSortOffset(Offset, alignof(uint32_t));
+  }
+  /// \return the size of the counter and the statuses.
+  static size_t getPassStateSize(size_t NumTiles) {
+    return (1 + NumTiles * DeviceSortNumDigits) * sizeof(uint32_t);
+  }
+  static size_t getSize(size_t Count, size_t NumTiles) {
+    return getHistogramsOffset(Count) +
+           NumPasses * DeviceSortNumDigits * sizeof(uint32_t) +
+           getPassStateSize(NumTiles);
+  }
+
+  device_sort_scratch(void *Scratch, size_t Count) {
+    char *Base = static_cast<char *>(Scratch);
+    MKeys = reinterpret_cast<KeyT *>(Base);
+    if constexpr (IsDeviceSortByKey<ValueT>)
+      MValues = reinterpret_cast<ValueT *>(Base + getValuesOffset(Count));
+    MHistograms =
+        reinterpret_cast<uint32_t *>(Base + getHistogramsOffset(Count));
+    MCounter = MHistograms + NumPasses * DeviceSortNumDigits;
+    MStatuses = MCounter + 1;
+  }
+
+  KeyT *MKeys = nullptr;
+  ValueT *MValues = nullptr;
+  uint32_t *MHistograms = nullptr;
+  uint32_t *MCounter = nullptr;
+  uint32_t *MStatuses = nullptr;
+};
+
+template <bool IsAscending, typename KeyT>
+uint32_t getDeviceSortDigit(KeyT Key, uint32_t Pass) {
+#ifdef __SYCL_DEVICE_ONLY__
+  return sycl::detail::getBucketValue<DeviceSortDigitBits, IsAscending>(
+      sycl::detail::convertToOrdered(Key), Pass);
+#else
+  (void)Key;
+  (void)Pass;
+  throw sycl::exception(make_error_code(errc::runtime),
+                        "Device-wide sorts are not supported on host.");
+#endif
+}
+
+/// Sorts a tile of keys, and values, in local memory by a digit with the
+/// group radix sorter.
+template <bool IsAscending, bool IsByKey, typename GroupT, typename KeyT,
+          typename ValueT>
+void sortDeviceSortTile(GroupT G, KeyT *Keys, ValueT *Values, size_t Count,
+                        std::byte *Scratch, uint32_t Pass) {
+#ifdef __SYCL_DEVICE_ONLY__
+  sycl::detail::privateDynamicSort<IsByKey, IsAscending>(
+      G, Keys, Values, Count, Scratch, Pass * DeviceSortDigitBits,
+      (Pass + 1) * DeviceSortDigitBits);
+#else
+  (void)G;
+  (void)Keys;
+  (void)Values;
+  (void)Count;
+  (void)Scratch;
+  (void)Pass;
+  throw sycl::exception(make_error_code(errc::runtime),
+                        "Device-wide sorts are not supported on host.");
+#endif
+}
+
+/// Sorts the keys, and the values if ValueT is not device_sort_no_value,
+/// with one pass per byte of the keys. Each pass is a single kernel in which
+/// the work-groups take the tiles of the input in order. A work-group sorts
+/// its tile by the digit of the pass with the group radix sorter, publishes
+/// the count of each digit in the tile, and combines the counts published by
+/// the tiles before it until it finds one which has published the prefix of
+/// the digit, as in the decoupled look-back of a scan. The prefixes and the
+/// histogram of the digits over all the keys, computed once for all passes,
+/// give the position of each key in the output of the pass.
+template <bool IsAscending, typename KeyT, typename ValueT>
+event deviceSort(queue Q, KeyT *Keys, ValueT *Values, size_t Count,
+                 void *Scratch, const std::vector<event> &DepEvents) {
+  static_assert(std::is_arithmetic_v<KeyT> ||
+                    std::is_same_v<KeyT, sycl::half> ||
+                    std::is_same_v<KeyT, sycl::ext::oneapi::bfloat16>,
+                "Device-wide sorts require arithmetic keys.");
+  if (Count > DeviceSortCountMask)
+    throw sycl::exception(make_error_code(errc::invalid),
+                          "Too many elements for a device-wide sort");
+  if (Count <= 1)
+    return Q.ext_oneapi_submit_barrier(DepEvents);
+
+  using scratch = device_sort_scratch<KeyT, ValueT>;
+  constexpr uint32_t NumPasses = scratch::NumPasses;
+  constexpr bool IsByKey = IsDeviceSortByKey<ValueT>;
+  device_sort_config Config = getDeviceSortConfig<KeyT, ValueT>(Q);
+  size_t WGSize = Config.MWGSize;
+  size_t TileSize = Config.MTileSize;
+  size_t NumTiles = (Count + TileSize - 1) / TileSize;
+  scratch S{Scratch, Count};
+
+  event Prev = Q.submit([&](handler &CGH) {
+    CGH.depends_on(DepEvents);
+    CGH.memset(S.MHistograms, 0,
+               NumPasses * DeviceSortNumDigits * sizeof(uint32_t));
+  });
+
+  // The histograms of all the passes are computed from the input.
+  size_t NumHistogramGroups = std::min<size_t>(
+      NumTiles,
+      4 * Q.get_device().get_info<sycl::info::device::max_compute_units>());
+  Prev = Q.submit([&](handler &CGH) {
+    CGH.depends_on(Prev);
+    local_accessor<uint32_t, 1> LocalHistograms{
+        range<1>{NumPasses * DeviceSortNumDigits}, CGH};
+    CGH.parallel_for<device_sort_histogram_kernel<KeyT, ValueT, IsAscending>>(
+        nd_range<1>{NumHistogramGroups * WGSize, WGSize}, [=](nd_item<1> It) {
+          size_t LId = It.get_local_linear_id();
+          for (size_t I = LId; I < NumPasses * DeviceSortNumDigits;
+               I += WGSize)
+            LocalHistograms[I] = 0;
+          group_barrier(It.get_group());
+
+          for (size_t I = It.get_global_linear_id(); I < Count;
+               I += It.get_global_range(0))
+            for (uint32_t Pass = 0; Pass < NumPasses; ++Pass)
+              atomic_ref<uint32_t, memory_order::relaxed,
+                         memory_scope::work_group,
+                         access::address_space::local_space>{
+                  LocalHistograms[Pass * DeviceSortNumDigits +
+                                  getDeviceSortDigit<IsAscending>(Keys[I],
+                                                                  Pass)]}
+                  .fetch_add(1);
+          group_barrier(It.get_group());
+
+          for (size_t I = LId; I < NumPasses * DeviceSortNumDigits;
+               I += WGSize)
+            if (LocalHistograms[I])
+              atomic_ref<uint32_t, memory_order::relaxed, memory_scope::device,
+                         access::address_space::global_space>{
+                  S.MHistograms[I]}
+                  .fetch_add(LocalHistograms[I]);
+        });
+  });
+
+  // Turns the histograms into the start of each digit in the output.
+  Prev = Q.submit([&](handler &CGH) {
+    CGH.depends_on(Prev);
+    CGH.parallel_for<device_sort_scan_kernel<KeyT, ValueT, IsAscending>>(
+        range<1>{NumPasses}, [=](item<1> Pass) {
+          uint32_t *Histogram = S.MHistograms + Pass[0] * DeviceSortNumDigits;
+          uint32_t Start = 0;
+          for (uint32_t D = 0; D < DeviceSortNumDigits; ++D) {
+            uint32_t DigitCount = Histogram[D];
+            Histogram[D] = Start;
+            Start += DigitCount;
+          }
+        });
+  });
+
+  KeyT *KeysIn = Keys;
+  KeyT *KeysOut = S.MKeys;
+  ValueT *ValuesIn = Values;
+  ValueT *ValuesOut = S.MValues;
+  size_t SorterScratchSize =
+      getDeviceSortTileScratchSize<KeyT, ValueT>(WGSize, TileSize);
+  for (uint32_t Pass = 0; Pass < NumPasses; ++Pass) {
+    Prev = Q.submit([&](handler &CGH) {
+      CGH.depends_on(Prev);
+      CGH.memset(S.MCounter, 0, scratch::getPassStateSize(NumTiles));
+    });
+    Prev = Q.submit([&](handler &CGH) {
+      CGH.depends_on(Prev);
+      local_accessor<KeyT, 1> TileKeys{range<1>{TileSize}, CGH};
+      local_accessor<ValueT, 1> TileValues{range<1>{IsByKey ? TileSize : 1},
+                                           CGH};
+      local_accessor<std::byte, 1> SorterScratch{range<1>{SorterScratchSize},
+                                                 CGH};
+      local_accessor<uint32_t, 1> DigitCounts{range<1>{DeviceSortNumDigits},
+                                              CGH};
+      local_accessor<uint32_t, 1> DigitStarts{range<1>{DeviceSortNumDigits},
+                                              CGH};
+      CGH.parallel_for<device_sort_onesweep_kernel<KeyT, ValueT, IsAscending>>(
+          nd_range<1>{NumTiles * WGSize, WGSize}, [=](nd_item<1> It) {
+            using status_ref =
+                atomic_ref<uint32_t, memory_order::relaxed,
+                           memory_scope::device,
+                           access::address_space::global_space>;
+            auto G = It.get_group();
+            size_t LId = It.get_local_linear_id();
+
+            uint32_t TileId = 0;
+            if (LId == 0)
+              TileId = status_ref{*S.MCounter}.fetch_add(1);
+            TileId = group_broadcast(G, TileId, 0);
+            size_t TileBase = TileId * TileSize;
+            size_t TileCount = std::min(TileSize, Count - TileBase);
+
+            for (size_t I = LId; I < TileCount; I += WGSize) {
+              TileKeys[I] = KeysIn[TileBase + I];
+              if constexpr (IsByKey)
+                TileValues[I] = ValuesIn[TileBase + I];
+            }
+            for (uint32_t D = LId; D < DeviceSortNumDigits; D += WGSize)
+              DigitCounts[D] = 0;
+            group_barrier(G);
+
+            KeyT *TileKeysPtr =
+                TileKeys.template get_multi_ptr<access::decorated::no>().get();
+            ValueT *TileValuesPtr =
+                TileValues.template get_multi_ptr<access::decorated::no>()
+                    .get();
+            sortDeviceSortTile<IsAscending, IsByKey>(
+                G, TileKeysPtr, TileValuesPtr, TileCount,
+                SorterScratch.template get_multi_ptr<access::decorated::no>()
+                    .get(),
+                Pass);
+
+            for (size_t I = LId; I < TileCount; I += WGSize)
+              atomic_ref<uint32_t, memory_order::relaxed,
+                         memory_scope::work_group,
+                         access::address_space::local_space>{
+                  DigitCounts[getDeviceSortDigit<IsAscending>(TileKeys[I],
+                                                              Pass)]}
+                  .fetch_add(1);
+            group_barrier(G);
+            uint32_t *DigitCountsPtr =
+                DigitCounts.template get_multi_ptr<access::decorated::no>()
+                    .get();
+            joint_exclusive_scan(
+                G, DigitCountsPtr, DigitCountsPtr + DeviceSortNumDigits,
+                DigitStarts.template get_multi_ptr<access::decorated::no>()
+                    .get(),
+                sycl::plus<uint32_t>());
+            group_barrier(G);
+
+            // Each work-item looks back for its digits, then replaces their
+            // counts by the offset of the keys of the tile in the output.
+            const uint32_t *DigitOutputStarts =
+                S.MHistograms + Pass * DeviceSortNumDigits;
+            for (uint32_t D = LId; D < DeviceSortNumDigits; D += WGSize) {
+              uint32_t DigitCount = DigitCounts[D];
+              uint32_t Prefix = 0;
+              status_ref Own{S.MStatuses[TileId * DeviceSortNumDigits + D]};
+              if (TileId != 0) {
+                Own.store(DeviceSortTileAggregate | DigitCount);
+                for (int64_t Pred = int64_t(TileId) - 1;; --Pred) {
+                  status_ref PredStatus{
+                      S.MStatuses[Pred * DeviceSortNumDigits + D]};
+                  uint32_t Status;
+                  do
+                    Status = PredStatus.load();
+                  while (!(Status & ~DeviceSortCountMask));
+                  Prefix += Status & DeviceSortCountMask;
+                  if (Status & DeviceSortTilePrefix)
+                    break;
+                }
+              }
+              Own.store(DeviceSortTilePrefix | (Prefix + DigitCount));
+              DigitCounts[D] = DigitOutputStarts[D] + Prefix - DigitStarts[D];
+            }
+            group_barrier(G);
+
+            for (size_t I = LId; I < TileCount; I += WGSize) {
+              KeyT Key = TileKeys[I];
+              size_t Out =
+                  DigitCounts[getDeviceSortDigit<IsAscending>(Key, Pass)] + I;
+              KeysOut[Out] = Key;
+              if constexpr (IsByKey)
+                ValuesOut[Out] = TileValues[I];
+            }
+          });
+    });
+    std::swap(KeysIn, KeysOut);
+    std::swap(ValuesIn, ValuesOut);
+  }
+
+  // With an odd number of passes, the result is in the scratch memory.
+  if constexpr (NumPasses % 2 != 0) {
+    Prev = Q.submit([&](handler &CGH) {
+      CGH.depends_on(Prev);
+      CGH.memcpy(Keys, S.MKeys, Count * sizeof(KeyT));
+    });
+    if constexpr (IsByKey)
+      Prev = Q.submit([&](handler &CGH) {
+        CGH.depends_on(Prev);
+        CGH.memcpy(Values, S.MValues, Count * sizeof(ValueT));
+      });
+  }
+  return Prev;
+}
+
+template <typename KeyT, typename ValueT>
+size_t getDeviceSortScratchSize(const queue &Q, size_t Count) {
+  size_t TileSize = getDeviceSortConfig<KeyT, ValueT>(Q).MTileSize;
+  return device_sort_scratch<KeyT, ValueT>::getSize(
+      Count, (Count + TileSize - 1) / TileSize);
+}
+} // namespace detail
+
+/// \return the size in bytes of the scratch memory used by sort of \p Count
+/// keys of type KeyT on \p Q. The memory can be reused by the sorts of up to
+/// \p Count keys on the same device which do not run at the same time.
+template <typename KeyT>
+size_t get_sort_scratch_size(const queue &Q, size_t Count) {
+  return detail::getDeviceSortScratchSize<KeyT, detail::device_sort_no_value>(
+      Q, Count);
+}
+
+/// \return the size in bytes of the scratch memory used by sort_by_key of
+/// \p Count keys of type KeyT and values of type ValueT on \p Q.
+template <typename KeyT, typename ValueT>
+size_t get_sort_by_key_scratch_size(const queue &Q, size_t Count) {
+  return detail::getDeviceSortScratchSize<KeyT, ValueT>(Q, Count);
+}
+
+/// Sorts the keys of USM memory \p Keys in place with a device-wide radix
+/// sort. The sort is stable, and orders the floating-point keys by their bit
+/// patterns like the group sorters do.
+///
+/// \param Scratch is device or shared memory of at least
+/// get_sort_scratch_size<KeyT>(Q, Keys.size()) bytes, which is not used by
+/// other commands until the sort completes.
+/// \return an event of the completion of the sort.
+template <sorting_order Order = sorting_order::ascending, typename KeyT,
+          size_t Extent>
+event sort(queue Q, sycl::span<KeyT, Extent> Keys, void *Scratch,
+           const std::vector<event> &DepEvents = {}) {
+  return detail::deviceSort<Order == sorting_order::ascending>(
+      Q, Keys.data(), static_cast<detail::device_sort_no_value *>(nullptr),
+      Keys.size(), Scratch, DepEvents);
+}
+
+/// Sorts the USM memory \p Keys in place, and reorders \p Values, which has
+/// as many elements, in the same way.
+///
+/// \param Scratch is device or shared memory of at least
+/// get_sort_by_key_scratch_size<KeyT, ValueT>(Q, Keys.size()) bytes, which is
+/// not used by other commands until the sort completes.
+/// \return an event of the completion of the sort.
+template <sorting_order Order = sorting_order::ascending, typename KeyT,
+          size_t KeysExtent, typename ValueT, size_t ValuesExtent>
+event sort_by_key(queue Q, sycl::span<KeyT, KeysExtent> Keys,
+                  sycl::span<ValueT, ValuesExtent> Values, void *Scratch,
+                  const std::vector<event> &DepEvents = {}) {
+  if (Keys.size() != Values.size())
+    throw sycl::exception(make_error_code(errc::invalid),
+                          "sort_by_key requires as many keys as values");
+  return detail::deviceSort<Order == sorting_order::ascending>(
+      Q, Keys.data(), Values.data(), Keys.size(), Scratch, DepEvents);
+}
+
+} // namespace ext::oneapi::experimental
+} // namespace _V1
+} // namespace sycl
+
+#endif
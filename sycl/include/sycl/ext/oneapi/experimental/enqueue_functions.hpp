@@ -0,0 +1,85 @@
+//==------ enqueue_functions.hpp --- SYCL event-less enqueue functions -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sycl/detail/common.hpp>
+#include <sycl/handler.hpp>
+#include <sycl/nd_range.hpp>
+#include <sycl/queue.hpp>
+#include <sycl/range.hpp>
+
+#include <cstddef>
+#include <utility>
+
+namespace sycl {
+inline namespace _V1 {
+namespace ext::oneapi::experimental {
+
+// The functions below submit commands without returning an event for them,
+// so that the runtime doesn't need to create and track one. Use
+// queue::wait() or a barrier to synchronize with them.
+
+template <typename CommandGroupFunc>
+void submit(queue Q, CommandGroupFunc &&CGF,
+            const sycl::detail::code_location &CodeLoc =
+                sycl::detail::code_location::current()) {
+  Q.ext_oneapi_submit_without_event(std::forward<CommandGroupFunc>(CGF),
+                                    CodeLoc);
+}
+
+template <typename KernelName = sycl::detail::auto_name, typename KernelType>
+void single_task(queue Q, const KernelType &KernelObj,
+                 const sycl::detail::code_location &CodeLoc =
+                     sycl::detail::code_location::current()) {
+  submit(
+      std::move(Q),
+      [&](handler &CGH) { CGH.single_task<KernelName>(KernelObj); }, CodeLoc);
+}
+
+template <typename KernelName = sycl::detail::auto_name, int Dimensions,
+          typename KernelType>
+void parallel_for(queue Q, range<Dimensions> Range, const KernelType &KernelObj,
+                  const sycl::detail::code_location &CodeLoc =
+                      sycl::detail::code_location::current()) {
+  submit(
+      std::move(Q),
+      [&](handler &CGH) { CGH.parallel_for<KernelName>(Range, KernelObj); },
+      CodeLoc);
+}
+
+template <typename KernelName = sycl::detail::auto_name, int Dimensions,
+          typename KernelType>
+void nd_launch(queue Q, nd_range<Dimensions> Range, const KernelType &KernelObj,
+               const sycl::detail::code_location &CodeLoc =
+                   sycl::detail::code_location::current()) {
+  submit(
+      std::move(Q),
+      [&](handler &CGH) { CGH.parallel_for<KernelName>(Range, KernelObj); },
+      CodeLoc);
+}
+
+inline void memcpy(queue Q, void *Dest, const void *Src, size_t NumBytes,
+                   const sycl::detail::code_location &CodeLoc =
+                       sycl::detail::code_location::current()) {
+  submit(
+      std::move(Q), [&](handler &CGH) { CGH.memcpy(Dest, Src, NumBytes); },
+      CodeLoc);
+}
+
+inline void memset(queue Q, void *Ptr, int Value, size_t NumBytes,
+                   const sycl::detail::code_location &CodeLoc =
+                       sycl::detail::code_location::current()) {
+  submit(
+      std::move(Q), [&](handler &CGH) { CGH.memset(Ptr, Value, NumBytes); },
+      CodeLoc);
+}
+
+} // namespace ext::oneapi::experimental
+} // namespace _V1
+} // namespace sycl
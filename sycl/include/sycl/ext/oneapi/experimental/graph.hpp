@@ -18,6 +18,7 @@
 #include <sycl/properties/property_traits.hpp> // for is_property, is_property_of
 #include <sycl/property_list.hpp>              // for property_list
 
+#include <cstddef>     // for byte
 #include <functional>  // for function
 #include <memory>      // for shared_ptr
 #include <type_traits> // for true_type
@@ -41,6 +42,7 @@ enum class graph_state {
 
 // Forward declare Graph class
 template <graph_state State> class command_graph;
+template <typename ValueT> class dynamic_parameter;
 
 namespace detail {
 // List of sycl features and extensions which are not supported by graphs. Used
@@ -98,7 +100,11 @@ enum class node_type {
   prefetch = 6,
   memadvise = 7,
   ext_oneapi_barrier = 8,
-  host_task = 9
+  host_task = 9,
+  ext_oneapi_malloc_device = 10,
+  ext_oneapi_free = 11,
+  ext_oneapi_if = 12,
+  ext_oneapi_while = 13
 };
 
 /// Class representing a node in the graph, returned by command_graph::add().
@@ -160,6 +166,17 @@ public:
   assume_buffer_outlives_graph() = default;
 };
 
+/// Property passed to command_graph constructor to allow recording queues on
+/// any device of the graph context. Nodes are executed on the device of the
+/// queue they were recorded from, and finalize creates a command-buffer per
+/// device.
+///
+class enable_multi_device : public ::sycl::detail::DataLessProperty<
+                                ::sycl::detail::GraphEnableMultiDevice> {
+public:
+  enable_multi_device() = default;
+};
+
 /// Property passed to command_graph<graph_state::modifiable>::finalize() to
 /// mark the resulting executable command_graph as able to be updated.
 class updatable
@@ -167,6 +184,16 @@ class updatable
 public:
   updatable() = default;
 };
+
+/// Property passed to command_graph<graph_state::modifiable>::finalize() to
+/// fuse chains of kernel nodes of the resulting executable command_graph into
+/// single kernels. Only has an effect if kernel fusion is supported by the
+/// implementation, and cannot be combined with property::graph::updatable.
+class enable_fusion : public ::sycl::detail::DataLessProperty<
+                          ::sycl::detail::GraphEnableFusion> {
+public:
+  enable_fusion() = default;
+};
 } // namespace graph
 
 namespace node {
@@ -196,6 +223,29 @@ public:
 };
 
 } // namespace node
+
+namespace queue {
+
+/// Property passed to the constructor of an in-order queue to replay the
+/// kernels it runs between two waits as a command_graph once the same
+/// sequence of kernels has been submitted min_repeats times in a row. The
+/// kernels of the following sequences are recorded and run, at the wait, by an
+/// executable graph which is updated with the arguments of each sequence. A
+/// submission which is not a kernel or has accessors or dependencies, or a
+/// sequence which differs from the previous one, stops the recording. The
+/// events of the recorded kernels can only be waited on. Has no effect if the
+/// device does not support graphs.
+class auto_graph : public ::sycl::detail::PropertyWithData<
+                       ::sycl::detail::PropWithDataKind::QueueAutoGraph> {
+public:
+  auto_graph(size_t min_repeats = 2) : MMinRepeats(min_repeats) {}
+  size_t get_min_repeats() const { return MMinRepeats; }
+
+private:
+  size_t MMinRepeats;
+};
+
+} // namespace queue
 } // namespace property
 
 template <graph_state State> class command_graph;
@@ -256,6 +306,81 @@ public:
     return Node;
   }
 
+  /// Add a node allocating device memory owned by the graph. The memory is
+  /// allocated once for all the executions of the graph, and shared with
+  /// allocations of the graph whose lifetimes don't overlap with it.
+  /// @param[out] Ptr Set to the allocated memory, which can be used by the
+  /// nodes depending on the returned node until it is freed by add_free().
+  /// @param NumBytes Number of bytes to allocate.
+  /// @param PropList Property list used to pass [0..n] predecessor nodes.
+  /// @return Constructed node which has been added to the graph.
+  node add_malloc_device(void *&Ptr, size_t NumBytes,
+                         const property_list &PropList = {}) {
+    if (PropList.has_property<property::node::depends_on>()) {
+      auto Deps = PropList.get_property<property::node::depends_on>();
+      node Node = addMallocDeviceImpl(Ptr, NumBytes, Deps.get_dependencies());
+      if (PropList.has_property<property::node::depends_on_all_leaves>()) {
+        addGraphLeafDependencies(Node);
+      }
+      return Node;
+    }
+    node Node = addMallocDeviceImpl(Ptr, NumBytes, {});
+    if (PropList.has_property<property::node::depends_on_all_leaves>()) {
+      addGraphLeafDependencies(Node);
+    }
+    return Node;
+  }
+
+  /// Add a node freeing memory allocated by add_malloc_device(). Nodes which
+  /// use the memory must be predecessors of the returned node.
+  /// @param Ptr Memory to free.
+  /// @param PropList Property list used to pass [0..n] predecessor nodes.
+  /// @return Constructed node which has been added to the graph.
+  node add_free(void *Ptr, const property_list &PropList = {}) {
+    if (PropList.has_property<property::node::depends_on>()) {
+      auto Deps = PropList.get_property<property::node::depends_on>();
+      node Node = addFreeImpl(Ptr, Deps.get_dependencies());
+      if (PropList.has_property<property::node::depends_on_all_leaves>()) {
+        addGraphLeafDependencies(Node);
+      }
+      return Node;
+    }
+    node Node = addFreeImpl(Ptr, {});
+    if (PropList.has_property<property::node::depends_on_all_leaves>()) {
+      addGraphLeafDependencies(Node);
+    }
+    return Node;
+  }
+
+  /// Add a node executing a graph once if a condition is non-zero when the
+  /// node executes.
+  /// @param Condition USM allocation of the context of the graph holding the
+  /// condition, which can be written by the predecessors of the node.
+  /// @param Body Graph to execute, finalized for the device of this graph.
+  /// @param PropList Property list used to pass [0..n] predecessor nodes.
+  /// @return Constructed node which has been added to the graph.
+  node add_if(const int *Condition,
+              const command_graph<graph_state::executable> &Body,
+              const property_list &PropList = {}) {
+    return addConditional(node_type::ext_oneapi_if, Condition, Body,
+                          PropList);
+  }
+
+  /// Add a node executing a graph repeatedly for as long as a condition is
+  /// non-zero. The condition is checked before each execution of the graph,
+  /// so it is usually written by the nodes of \p Body.
+  /// @param Condition USM allocation of the context of the graph holding the
+  /// condition.
+  /// @param Body Graph to execute, finalized for the device of this graph.
+  /// @param PropList Property list used to pass [0..n] predecessor nodes.
+  /// @return Constructed node which has been added to the graph.
+  node add_while(const int *Condition,
+                 const command_graph<graph_state::executable> &Body,
+                 const property_list &PropList = {}) {
+    return addConditional(node_type::ext_oneapi_while, Condition, Body,
+                          PropList);
+  }
+
   /// Add a dependency between two nodes.
   /// @param Src Node which will be a dependency of \p Dest.
   /// @param Dest Node which will be dependent on \p Src.
@@ -315,6 +440,28 @@ public:
   /// Get a list of all root nodes (nodes without dependencies) in this graph.
   std::vector<node> get_root_nodes() const;
 
+  /// Serializes the nodes and edges of the graph into a binary format which
+  /// can be loaded by deserialize(), e.g. in a later run of the application.
+  /// Only empty nodes and kernel nodes, whose arguments are standard layout
+  /// values or USM pointers, are supported. Kernels are stored by name and
+  /// must be available in the application loading the graph.
+  /// @param Pointers USM pointers used as kernel arguments. A kernel argument
+  /// equal to Pointers[I] is stored as a placeholder for the I-th dynamic
+  /// parameter passed to deserialize().
+  /// @return The serialized graph.
+  std::vector<std::byte>
+  serialize(const std::vector<void *> &Pointers = {}) const;
+
+  /// Adds the nodes and edges of a graph serialized by serialize() to this
+  /// graph. The nodes are added in an order consistent with their edges, so
+  /// no cycle checks are performed.
+  /// @param Data The serialized graph.
+  /// @param Pointers Dynamic parameters of this graph replacing the
+  /// placeholders of the USM pointers passed to serialize(), in the same order.
+  /// The kernel nodes are registered with them.
+  void deserialize(const std::vector<std::byte> &Data,
+                   const std::vector<dynamic_parameter<void *>> &Pointers = {});
+
 protected:
   /// Constructor used internally by the runtime.
   /// @param Impl Detail implementation class to construct object with.
@@ -333,6 +480,50 @@ protected:
   /// @return Node added to the graph.
   node addImpl(const std::vector<node> &Dep);
 
+  /// Template-less implementation of add_malloc_device().
+  /// @param[out] Ptr Set to the allocated memory.
+  /// @param NumBytes Number of bytes to allocate.
+  /// @param Dep List of predecessor nodes.
+  /// @return Node added to the graph.
+  node addMallocDeviceImpl(void *&Ptr, size_t NumBytes,
+                           const std::vector<node> &Dep);
+
+  /// Template-less implementation of add_free().
+  /// @param Ptr Memory to free.
+  /// @param Dep List of predecessor nodes.
+  /// @return Node added to the graph.
+  node addFreeImpl(void *Ptr, const std::vector<node> &Dep);
+
+  /// Implementation of add_if() and add_while().
+  node addConditional(node_type Type, const int *Condition,
+                      const command_graph<graph_state::executable> &Body,
+                      const property_list &PropList) {
+    if (PropList.has_property<property::node::depends_on>()) {
+      auto Deps = PropList.get_property<property::node::depends_on>();
+      node Node =
+          addConditionalImpl(Type, Condition, Body, Deps.get_dependencies());
+      if (PropList.has_property<property::node::depends_on_all_leaves>()) {
+        addGraphLeafDependencies(Node);
+      }
+      return Node;
+    }
+    node Node = addConditionalImpl(Type, Condition, Body, {});
+    if (PropList.has_property<property::node::depends_on_all_leaves>()) {
+      addGraphLeafDependencies(Node);
+    }
+    return Node;
+  }
+
+  /// Template-less implementation of add_if() and add_while().
+  /// @param Type Type of the node, ext_oneapi_if or ext_oneapi_while.
+  /// @param Condition USM allocation holding the condition.
+  /// @param Body Graph executed by the node.
+  /// @param Dep List of predecessor nodes.
+  /// @return Node added to the graph.
+  node addConditionalImpl(node_type Type, const int *Condition,
+                          const command_graph<graph_state::executable> &Body,
+                          const std::vector<node> &Dep);
+
   /// Adds all graph leaves as dependencies
   /// @param Node Destination node to which the leaves of the graph will be
   /// added as dependencies.
@@ -493,6 +684,10 @@ template <>
 struct is_property<ext::oneapi::experimental::property::node::depends_on>
     : std::true_type {};
 
+template <>
+struct is_property<ext::oneapi::experimental::property::queue::auto_graph>
+    : std::true_type {};
+
 template <>
 struct is_property_of<
     ext::oneapi::experimental::property::graph::no_cycle_check,
@@ -504,5 +699,9 @@ template <>
 struct is_property_of<ext::oneapi::experimental::property::node::depends_on,
                       ext::oneapi::experimental::node> : std::true_type {};
 
+template <>
+struct is_property_of<ext::oneapi::experimental::property::queue::auto_graph,
+                      queue> : std::true_type {};
+
 } // namespace _V1
 } // namespace sycl
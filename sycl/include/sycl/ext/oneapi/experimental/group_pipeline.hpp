@@ -0,0 +1,126 @@
+//==------- group_pipeline.hpp --- SYCL group memory pipeline extension ----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <CL/__spirv/spirv_ops.hpp>            // for __spirv_GroupWaitEvents
+#include <CL/__spirv/spirv_types.hpp>          // for Scope, __ocl_event_t
+#include <sycl/detail/generic_type_traits.hpp> // for convertToOpenCLType
+#include <sycl/detail/type_traits.hpp>         // for is_bool
+#include <sycl/exception.hpp>                  // for make_error_code, errc
+#include <sycl/group.hpp>                      // for group
+#include <sycl/group_barrier.hpp>              // for group_barrier
+#include <sycl/pointers.hpp>                   // for decorated_local_ptr
+
+#include <stddef.h>    // for size_t
+#include <type_traits> // for is_same_v
+
+namespace sycl {
+inline namespace _V1 {
+namespace ext::oneapi::experimental {
+
+/// Software pipeline of the copies of a work-group from global to local
+/// memory. The local buffer is split into \p Stages slots of the same size,
+/// which are filled by asynchronous group copies in a ring, so that the copies
+/// of the next slots overlap with the computation on the current one:
+///
+///   group_pipeline<decltype(G), float, 2> Pipe{G, LocalBuf, TileSize};
+///   Pipe.producer_commit(Src, TileSize);
+///   for (size_t I = 0; I < NumTiles; ++I) {
+///     if (I + 1 < NumTiles)
+///       Pipe.producer_commit(Src + (I + 1) * TileSize, TileSize);
+///     compute(Pipe.consumer_wait());
+///     Pipe.consumer_release();
+///   }
+///
+/// All the work-items of the group must call the member functions in the same
+/// order. At most \p Stages slots can be committed and not released, the
+/// producer must not commit to a slot until it is released.
+///
+/// The copies are lowered to the group async copies of the backend.
+template <typename Group, typename T, size_t Stages> class group_pipeline {
+  static_assert(std::is_same_v<Group, group<Group::dimensions>>,
+                "group_pipeline only supports work-groups");
+  static_assert(Stages > 0, "A pipeline must have at least one stage");
+  static_assert(!sycl::detail::is_bool<T>::value,
+                "group_pipeline does not support bool elements");
+
+public:
+  /// \param Buffer is the local memory of the slots, of Stages * SlotSize
+  /// elements.
+  group_pipeline(Group G, decorated_local_ptr<T> Buffer, size_t SlotSize)
+      : MGroup(G), MBuffer(Buffer), MSlotSize(SlotSize) {}
+
+  /// Starts copying NumElements, at most the slot size, from Src with a
+  /// stride of SrcStride into the next slot.
+  void producer_commit(decorated_global_ptr<const T> Src, size_t NumElements,
+                       size_t SrcStride = 1) {
+#ifdef __SYCL_DEVICE_ONLY__
+    decorated_local_ptr<T> Dest = getSlot(MHead);
+    MEvents[MHead % Stages] = __SYCL_OpGroupAsyncCopyGlobalToLocal(
+        __spv::Scope::Workgroup, sycl::detail::convertToOpenCLType(Dest),
+        sycl::detail::convertToOpenCLType(Src), NumElements, SrcStride, 0);
+    ++MHead;
+#else
+    (void)Src;
+    (void)NumElements;
+    (void)SrcStride;
+    throwOnHost();
+#endif
+  }
+
+  /// Waits for the copy into the oldest committed slot, which is then visible
+  /// to all the work-items of the group.
+  ///
+  /// \return the oldest committed slot.
+  decorated_local_ptr<T> consumer_wait() {
+#ifdef __SYCL_DEVICE_ONLY__
+    __spirv_GroupWaitEvents(__spv::Scope::Workgroup, 1,
+                            &MEvents[MTail % Stages]);
+    group_barrier(MGroup);
+    return getSlot(MTail);
+#else
+    throwOnHost();
+    return MBuffer;
+#endif
+  }
+
+  /// Releases the oldest committed slot once all the work-items of the group
+  /// are done with it, so that it can be committed again.
+  void consumer_release() {
+    group_barrier(MGroup);
+    ++MTail;
+  }
+
+  /// \return the number of committed slots that are not released.
+  size_t size() const { return MHead - MTail; }
+
+private:
+  decorated_local_ptr<T> getSlot(size_t Idx) const {
+    return MBuffer + (Idx % Stages) * MSlotSize;
+  }
+
+#ifndef __SYCL_DEVICE_ONLY__
+  [[noreturn]] static void throwOnHost() {
+    throw sycl::exception(make_error_code(errc::feature_not_supported),
+                          "Group pipelines are not supported on host device");
+  }
+#endif
+
+  Group MGroup;
+  decorated_local_ptr<T> MBuffer;
+  size_t MSlotSize;
+  __ocl_event_t MEvents[Stages] = {};
+  // Number of committed and released slots.
+  size_t MHead = 0;
+  size_t MTail = 0;
+};
+
+} // namespace ext::oneapi::experimental
+} // namespace _V1
+} // namespace sycl
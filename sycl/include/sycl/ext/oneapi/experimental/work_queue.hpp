@@ -0,0 +1,153 @@
+//==-------- work_queue.hpp --- SYCL host to device work queue extension ---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sycl/atomic_ref.hpp>   // for atomic_ref
+#include <sycl/memory_enums.hpp> // for memory_order, memory_scope
+
+#include <stddef.h>    // for size_t
+#include <type_traits> // for is_trivially_copyable_v
+
+namespace sycl {
+inline namespace _V1 {
+namespace ext::oneapi::experimental {
+
+/// Bounded multi-producer multi-consumer queue of \p Capacity elements, which
+/// can be used at the same time by the host and by the work-items of running
+/// kernels. It lets a persistent kernel poll for the tasks pushed by the host
+/// instead of launching a kernel per task:
+///
+///   auto *WQ = new (malloc_shared<work_queue<Task, 1024>>(1, Q))
+///       work_queue<Task, 1024>();
+///   size_t NumGroups = Kernel.ext_oneapi_get_info<
+///       info::kernel_queue_specific::max_num_work_group_sync>(Q);
+///   Q.parallel_for(nd_range<1>{NumGroups * WGSize, WGSize}, [=](auto It) {
+///     Task T;
+///     while (WQ->wait_pop(T))
+///       process(T);
+///   });
+///   for (const Task &T : Tasks)
+///     while (!WQ->try_push(T))
+///       ;
+///   WQ->close();
+///
+/// The queue must be in memory accessible by the host and the device, such as
+/// shared or host USM, and the device must support system scope atomics on
+/// it. The polling work-groups only make progress if they all run at the same
+/// time, so a persistent kernel must not launch more work-groups than
+/// max_num_work_group_sync.
+template <typename T, size_t Capacity> class work_queue {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "The capacity of a work_queue must be a power of two");
+  static_assert(Capacity <= (size_t{1} << 30),
+                "The capacity of a work_queue is too large");
+  static_assert(std::is_trivially_copyable_v<T>,
+                "The elements of a work_queue must be trivially copyable");
+
+  using index_t = unsigned int;
+  using atomic_index_t =
+      atomic_ref<index_t, memory_order::relaxed, memory_scope::system,
+                 access::address_space::generic_space>;
+
+public:
+  work_queue() {
+    for (index_t I = 0; I < Capacity; ++I)
+      MSlots[I].MSequence = I;
+  }
+  work_queue(const work_queue &) = delete;
+  work_queue &operator=(const work_queue &) = delete;
+
+  /// Pushes Data at the back of the queue.
+  ///
+  /// \return false if the queue is full.
+  bool try_push(const T &Data) {
+    atomic_index_t Tail{MTail};
+    index_t Pos = Tail.load();
+    while (true) {
+      slot &Slot = MSlots[Pos % Capacity];
+      index_t Seq = atomic_index_t{Slot.MSequence}.load(memory_order::acquire);
+      int Diff = static_cast<int>(Seq - Pos);
+      if (Diff == 0) {
+        if (Tail.compare_exchange_weak(Pos, Pos + 1))
+          break;
+      } else if (Diff < 0) {
+        return false;
+      } else {
+        Pos = Tail.load();
+      }
+    }
+    slot &Slot = MSlots[Pos % Capacity];
+    Slot.MData = Data;
+    atomic_index_t{Slot.MSequence}.store(Pos + 1, memory_order::release);
+    return true;
+  }
+
+  /// Pops the element at the front of the queue into Data.
+  ///
+  /// \return false if the queue is empty.
+  bool try_pop(T &Data) {
+    atomic_index_t Head{MHead};
+    index_t Pos = Head.load();
+    while (true) {
+      slot &Slot = MSlots[Pos % Capacity];
+      index_t Seq = atomic_index_t{Slot.MSequence}.load(memory_order::acquire);
+      int Diff = static_cast<int>(Seq - (Pos + 1));
+      if (Diff == 0) {
+        if (Head.compare_exchange_weak(Pos, Pos + 1))
+          break;
+      } else if (Diff < 0) {
+        return false;
+      } else {
+        Pos = Head.load();
+      }
+    }
+    slot &Slot = MSlots[Pos % Capacity];
+    Data = Slot.MData;
+    // The slot is free for the push of the next round.
+    atomic_index_t{Slot.MSequence}.store(Pos + Capacity, memory_order::release);
+    return true;
+  }
+
+  /// Waits for an element and pops it into Data.
+  ///
+  /// \return false if the queue is closed and empty.
+  bool wait_pop(T &Data) {
+    while (!try_pop(Data)) {
+      // The elements pushed before the queue was closed are visible once it
+      // is seen closed.
+      if (is_closed())
+        return try_pop(Data);
+    }
+    return true;
+  }
+
+  /// Closes the queue, no element can be pushed after this call.
+  void close() { atomic_index_t{MClosed}.store(1, memory_order::release); }
+
+  bool is_closed() {
+    return atomic_index_t{MClosed}.load(memory_order::acquire) != 0;
+  }
+
+private:
+  struct slot {
+    // Position of the element which can be pushed into the slot, or plus one
+    // of the element which can be popped from it.
+    index_t MSequence;
+    T MData;
+  };
+
+  index_t MHead = 0;
+  index_t MTail = 0;
+  index_t MClosed = 0;
+  slot MSlots[Capacity];
+};
+
+} // namespace ext::oneapi::experimental
+} // namespace _V1
+} // namespace sycl
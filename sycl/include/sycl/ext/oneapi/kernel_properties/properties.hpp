@@ -61,6 +61,13 @@ struct device_has_key : detail::compile_time_property_key<detail::PropKind::Devi
                                  std::integral_constant<aspect, Aspects>...>;
 };
 
+// Asserts that the range of a parallel_for(range) kernel does not need to be
+// rounded, so that the range rounded kernel is not generated for it.
+struct no_range_rounding_key
+    : detail::compile_time_property_key<detail::PropKind::NoRangeRounding> {
+  using value_t = property_value<no_range_rounding_key>;
+};
+
 template <size_t Dim0, size_t... Dims>
 struct property_value<work_group_size_key, std::integral_constant<size_t, Dim0>,
                       std::integral_constant<size_t, Dims>...> {
@@ -126,6 +133,8 @@ inline constexpr sub_group_size_key::value_t<Size> sub_group_size;
 template <aspect... Aspects>
 inline constexpr device_has_key::value_t<Aspects...> device_has;
 
+inline constexpr no_range_rounding_key::value_t no_range_rounding;
+
 namespace detail {
 template <size_t Dim0, size_t... Dims>
 struct PropertyMetaInfo<work_group_size_key::value_t<Dim0, Dims...>> {
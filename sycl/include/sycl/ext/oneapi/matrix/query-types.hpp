@@ -11,6 +11,10 @@
 #include <sycl/ext/oneapi/bfloat16.hpp>                    // for bfloat16
 #include <sycl/ext/oneapi/matrix/matrix-unified-utils.hpp> // for tf32
 
+#include <cstdint>  // for int8_t
+#include <optional> // for optional
+#include <vector>   // for vector
+
 namespace sycl {
 inline namespace _V1 {
 namespace ext::oneapi::experimental::matrix {
@@ -46,6 +50,86 @@ struct combination {
 
 } // namespace ext::oneapi::experimental::matrix
 
+namespace detail {
+// Type to matrix type conversion used by select_combination
+template <typename T>
+constexpr std::optional<ext::oneapi::experimental::matrix::matrix_type>
+convertTypeToMatrixType() {
+  using ext::oneapi::experimental::matrix::matrix_type;
+  using ext::oneapi::experimental::matrix::precision::tf32;
+  if constexpr (std::is_same_v<T, sycl::ext::oneapi::bfloat16>)
+    return matrix_type::bf16;
+  else if constexpr (std::is_same_v<T, sycl::half>)
+    return matrix_type::fp16;
+  else if constexpr (std::is_same_v<T, tf32>)
+    return matrix_type::tf32;
+  else if constexpr (std::is_same_v<T, float>)
+    return matrix_type::fp32;
+  else if constexpr (std::is_same_v<T, double>)
+    return matrix_type::fp64;
+  else if constexpr (std::is_same_v<T, int8_t>)
+    return matrix_type::sint8;
+  else if constexpr (std::is_same_v<T, int16_t>)
+    return matrix_type::sint16;
+  else if constexpr (std::is_same_v<T, int32_t>)
+    return matrix_type::sint32;
+  else if constexpr (std::is_same_v<T, int64_t>)
+    return matrix_type::sint64;
+  else if constexpr (std::is_same_v<T, uint8_t>)
+    return matrix_type::uint8;
+  else if constexpr (std::is_same_v<T, uint16_t>)
+    return matrix_type::uint16;
+  else if constexpr (std::is_same_v<T, uint32_t>)
+    return matrix_type::uint32;
+  else if constexpr (std::is_same_v<T, uint64_t>)
+    return matrix_type::uint64;
+  else
+    return std::nullopt;
+}
+} // namespace detail
+
+namespace ext::oneapi::experimental::matrix {
+
+// Selects among combinations, e.g. those returned by the matrix_combinations
+// query of a device, the largest shape supported for the given types, so that
+// the kernels do not need to hardcode the shape of each device:
+//   auto C = select_combination<bfloat16, bfloat16, float>(
+//       Dev.get_info<info::device::matrix_combinations>());
+// The sizes of the combinations which only give maximum sizes are their
+// maximum sizes. The largest shape is the one computing the most products by
+// joint_matrix_mad, and then the one with the largest K.
+// Returns the combination with msize, nsize and ksize set, or std::nullopt if
+// none has the types.
+template <typename Ta, typename Tb, typename Tc, typename Td = Tc>
+std::optional<combination>
+select_combination(const std::vector<combination> &combinations) {
+  constexpr auto atype = sycl::detail::convertTypeToMatrixType<Ta>();
+  constexpr auto btype = sycl::detail::convertTypeToMatrixType<Tb>();
+  constexpr auto ctype = sycl::detail::convertTypeToMatrixType<Tc>();
+  constexpr auto dtype = sycl::detail::convertTypeToMatrixType<Td>();
+  static_assert(atype && btype && ctype && dtype,
+                "Invalid types for joint_matrix");
+
+  std::optional<combination> best;
+  for (combination c : combinations) {
+    if (c.atype != *atype || c.btype != *btype || c.ctype != *ctype ||
+        c.dtype != *dtype)
+      continue;
+    c.msize = c.msize ? c.msize : c.max_msize;
+    c.nsize = c.nsize ? c.nsize : c.max_nsize;
+    c.ksize = c.ksize ? c.ksize : c.max_ksize;
+    size_t products = c.msize * c.nsize * c.ksize;
+    size_t best_products =
+        best ? best->msize * best->nsize * best->ksize : 0;
+    if (products > best_products ||
+        (best && products == best_products && c.ksize > best->ksize))
+      best = c;
+  }
+  return best;
+}
+
+} // namespace ext::oneapi::experimental::matrix
+
 // Type to matrix type string conversion used in compile-time
 namespace detail {
 template <typename T> constexpr const char *convertTypeToMatrixTypeString() {
@@ -202,6 +202,72 @@ Function for_each(Group g, Ptr first, Ptr last, Function f) {
                         "Group algorithms are not supported on host.");
 #endif
 }
+
+// ---- sub-group algorithms for multi-component types
+//   The components of complex numbers and vectors are reduced and scanned over
+//   a sub-group together: each step exchanges all of them in one shuffle and
+//   combines them, instead of running a collective sequence per component.
+#ifdef __SYCL_DEVICE_ONLY__
+template <typename T, class BinaryOperation>
+T combine_components(const T &x, const T &y, BinaryOperation binary_op) {
+  if constexpr (is_vec<T>::value) {
+    typename get_scalar_binary_op<BinaryOperation>::type scalar_binary_op{};
+    T result;
+    for (int s = 0; s < x.size(); ++s)
+      result[s] = scalar_binary_op(x[s], y[s]);
+    return result;
+  } else {
+    return binary_op(x, y);
+  }
+}
+
+template <typename T, class BinaryOperation>
+T identity_for_components() {
+  if constexpr (is_vec<T>::value) {
+    using scalar_op = typename get_scalar_binary_op<BinaryOperation>::type;
+    return T(identity_for_ga_op<vector_element_t<T>, scalar_op>());
+  } else {
+    return identity_for_ga_op<T, BinaryOperation>();
+  }
+}
+
+template <typename T, class BinaryOperation>
+T sub_group_shuffle_reduce(sub_group g, T x, BinaryOperation binary_op) {
+  const uint32_t size = g.get_local_linear_range();
+  const uint32_t local_id = g.get_local_linear_id();
+  // After the step with offset d, each work-item holds the reduction of the
+  // values of the work-items [local_id, local_id + 2 * d).
+  for (uint32_t d = 1; d < size; d *= 2) {
+    T y = spirv::ShuffleDown(g, x, d);
+    if (local_id + d < size)
+      x = combine_components(x, y, binary_op);
+  }
+  return spirv::Shuffle(g, x, id<1>(0));
+}
+
+template <typename T, class BinaryOperation>
+T sub_group_shuffle_inclusive_scan(sub_group g, T x,
+                                   BinaryOperation binary_op) {
+  const uint32_t size = g.get_local_linear_range();
+  const uint32_t local_id = g.get_local_linear_id();
+  for (uint32_t d = 1; d < size; d *= 2) {
+    T y = spirv::ShuffleUp(g, x, d);
+    if (local_id >= d)
+      x = combine_components(y, x, binary_op);
+  }
+  return x;
+}
+
+template <typename T, class BinaryOperation>
+T sub_group_shuffle_exclusive_scan(sub_group g, T x,
+                                   BinaryOperation binary_op) {
+  T y = spirv::ShuffleUp(g, sub_group_shuffle_inclusive_scan(g, x, binary_op),
+                         1);
+  if (g.get_local_linear_id() == 0)
+    return identity_for_components<T, BinaryOperation>();
+  return y;
+}
+#endif // __SYCL_DEVICE_ONLY__
 } // namespace detail
 
 // ---- reduce_over_group
@@ -248,8 +314,10 @@ std::enable_if_t<(is_group_v<std::decay_t<Group>> &&
                   detail::is_native_op<T, sycl::plus<T>>::value &&
                   detail::is_plus<T, BinaryOperation>::value),
                  T>
-reduce_over_group(Group g, T x, BinaryOperation) {
+reduce_over_group(Group g, T x, BinaryOperation binary_op) {
 #ifdef __SYCL_DEVICE_ONLY__
+  if constexpr (std::is_same_v<std::decay_t<Group>, sub_group>)
+    return detail::sub_group_shuffle_reduce(g, x, binary_op);
   T result;
   result.real(reduce_over_group(g, x.real(), sycl::plus<>()));
   result.imag(reduce_over_group(g, x.imag(), sycl::plus<>()));
@@ -271,6 +339,10 @@ reduce_over_group(Group g, T x, BinaryOperation binary_op) {
   static_assert(
       std::is_same_v<decltype(binary_op(x, x)), T>,
       "Result type of binary_op must match reduction accumulation type.");
+#ifdef __SYCL_DEVICE_ONLY__
+  if constexpr (std::is_same_v<std::decay_t<Group>, sub_group>)
+    return detail::sub_group_shuffle_reduce(g, x, binary_op);
+#endif
   T result;
   typename detail::get_scalar_binary_op<BinaryOperation>::type
       scalar_binary_op{};
@@ -733,8 +805,10 @@ std::enable_if_t<(is_group_v<std::decay_t<Group>> &&
                   detail::is_native_op<T, sycl::plus<T>>::value &&
                   detail::is_plus<T, BinaryOperation>::value),
                  T>
-exclusive_scan_over_group(Group g, T x, BinaryOperation) {
+exclusive_scan_over_group(Group g, T x, BinaryOperation binary_op) {
 #ifdef __SYCL_DEVICE_ONLY__
+  if constexpr (std::is_same_v<std::decay_t<Group>, sub_group>)
+    return detail::sub_group_shuffle_exclusive_scan(g, x, binary_op);
   T result;
   result.real(exclusive_scan_over_group(g, x.real(), sycl::plus<>()));
   result.imag(exclusive_scan_over_group(g, x.imag(), sycl::plus<>()));
@@ -755,6 +829,10 @@ std::enable_if_t<(is_group_v<std::decay_t<Group>> &&
 exclusive_scan_over_group(Group g, T x, BinaryOperation binary_op) {
   static_assert(std::is_same_v<decltype(binary_op(x, x)), T>,
                 "Result type of binary_op must match scan accumulation type.");
+#ifdef __SYCL_DEVICE_ONLY__
+  if constexpr (std::is_same_v<std::decay_t<Group>, sub_group>)
+    return detail::sub_group_shuffle_exclusive_scan(g, x, binary_op);
+#endif
   T result;
   typename detail::get_scalar_binary_op<BinaryOperation>::type
       scalar_binary_op{};
@@ -904,6 +982,10 @@ std::enable_if_t<(is_group_v<std::decay_t<Group>> &&
 inclusive_scan_over_group(Group g, T x, BinaryOperation binary_op) {
   static_assert(std::is_same_v<decltype(binary_op(x, x)), T>,
                 "Result type of binary_op must match scan accumulation type.");
+#ifdef __SYCL_DEVICE_ONLY__
+  if constexpr (std::is_same_v<std::decay_t<Group>, sub_group>)
+    return detail::sub_group_shuffle_inclusive_scan(g, x, binary_op);
+#endif
   T result;
   typename detail::get_scalar_binary_op<BinaryOperation>::type
       scalar_binary_op{};
@@ -947,8 +1029,10 @@ std::enable_if_t<(is_group_v<std::decay_t<Group>> &&
                   detail::is_native_op<T, sycl::plus<T>>::value &&
                   detail::is_plus<T, BinaryOperation>::value),
                  T>
-inclusive_scan_over_group(Group g, T x, BinaryOperation) {
+inclusive_scan_over_group(Group g, T x, BinaryOperation binary_op) {
 #ifdef __SYCL_DEVICE_ONLY__
+  if constexpr (std::is_same_v<std::decay_t<Group>, sub_group>)
+    return detail::sub_group_shuffle_inclusive_scan(g, x, binary_op);
   T result;
   result.real(inclusive_scan_over_group(g, x.real(), sycl::plus<>()));
   result.imag(inclusive_scan_over_group(g, x.imag(), sycl::plus<>()));
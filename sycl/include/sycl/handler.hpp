@@ -921,6 +921,9 @@ private:
                                    KI::getNumParams(), &KI::getParamDesc(0),
                                    KI::isESIMD());
       MKernelName = KI::getName();
+      constexpr uint64_t KernelNameHash =
+          detail::getKernelNameHash(KI::getName());
+      setKernelNameHash(KernelNameHash);
     } else {
       // In case w/o the integration header it is necessary to process
       // accessors from the list(which are associated with this handler) as
@@ -1187,7 +1190,9 @@ private:
 
     // Check if rounding parameters have been set through environment:
     // SYCL_PARALLEL_FOR_RANGE_ROUNDING_PARAMS=MinRound:PreferredRound:MinRange
-    this->GetRangeRoundingSettings(MinFactorX, GoodFactor, MinRangeX);
+    // Otherwise they are chosen from the geometry of the device.
+    this->GetRangeRoundingSettings(UserRange[0], MinFactorX, GoodFactor,
+                                   MinRangeX);
 
     // In SYCL, each dimension of a global range size is specified by
     // a size_t, which can be up to 64 bits.  All backends should be
@@ -1338,47 +1343,62 @@ private:
 
     verifyUsedKernelBundle(detail::KernelInfo<NameT>::getName());
 
+    // The kernels with the no_range_rounding property only have the kernel
+    // over the user range, the range rounded one is not generated for them.
+    constexpr bool NoRangeRounding =
+        detail::GetMergedKernelProperties<KernelType, PropertiesT>::type::
+            template has_property<
+                ext::oneapi::experimental::no_range_rounding_key>();
+
     // Range rounding can be disabled by the user.
     // Range rounding is not done on the host device.
     // Range rounding is supported only for newer SYCL standards.
 #if !defined(__SYCL_DISABLE_PARALLEL_FOR_RANGE_ROUNDING__) &&                  \
     !defined(DPCPP_HOST_DEVICE_OPENMP) &&                                      \
     !defined(DPCPP_HOST_DEVICE_PERF_NATIVE) && SYCL_LANGUAGE_VERSION >= 202001
-    auto [RoundedRange, HasRoundedRange] = getRoundedRange(UserRange);
-    if (HasRoundedRange) {
-      using NameWT = typename detail::get_kernel_wrapper_name_t<NameT>::name;
-      auto Wrapper =
-          getRangeRoundedKernelLambda<NameWT, TransformedArgType, Dims>(
-              KernelFunc, UserRange);
-
-      using KName = std::conditional_t<std::is_same<KernelType, NameT>::value,
-                                       decltype(Wrapper), NameWT>;
-
-      kernel_parallel_for_wrapper<KName, TransformedArgType, decltype(Wrapper),
-                                  PropertiesT>(Wrapper);
+    if constexpr (!NoRangeRounding) {
+      auto [RoundedRange, HasRoundedRange] = getRoundedRange(UserRange);
+      if (HasRoundedRange) {
+        using NameWT = typename detail::get_kernel_wrapper_name_t<NameT>::name;
+        auto Wrapper =
+            getRangeRoundedKernelLambda<NameWT, TransformedArgType, Dims>(
+                KernelFunc, UserRange);
+
+        using KName =
+            std::conditional_t<std::is_same<KernelType, NameT>::value,
+                               decltype(Wrapper), NameWT>;
+
+        kernel_parallel_for_wrapper<KName, TransformedArgType,
+                                    decltype(Wrapper), PropertiesT>(Wrapper);
 #ifndef __SYCL_DEVICE_ONLY__
-      // We are executing over the rounded range, but there are still
-      // items/ids that are are constructed in ther range rounded
-      // kernel use items/ids in the user range, which means that
-      // __SYCL_ASSUME_INT can still be violated. So check the bounds
-      // of the user range, instead of the rounded range.
-      detail::checkValueRange<Dims>(UserRange);
-      MNDRDesc.set(RoundedRange);
-      StoreLambda<KName, decltype(Wrapper), Dims, TransformedArgType>(
-          std::move(Wrapper));
-      setType(detail::CG::Kernel);
-      setNDRangeUsed(false);
+        // We are executing over the rounded range, but there are still
+        // items/ids that are are constructed in ther range rounded
+        // kernel use items/ids in the user range, which means that
+        // __SYCL_ASSUME_INT can still be violated. So check the bounds
+        // of the user range, instead of the rounded range.
+        detail::checkValueRange<Dims>(UserRange);
+        MNDRDesc.set(RoundedRange);
+        StoreLambda<KName, decltype(Wrapper), Dims, TransformedArgType>(
+            std::move(Wrapper));
+        setType(detail::CG::Kernel);
+        setNDRangeUsed(false);
 #endif
-    } else
+        return;
+      }
+    }
 #endif // !__SYCL_DISABLE_PARALLEL_FOR_RANGE_ROUNDING__ &&
        // !DPCPP_HOST_DEVICE_OPENMP && !DPCPP_HOST_DEVICE_PERF_NATIVE &&
        // SYCL_LANGUAGE_VERSION >= 202001
-    {
-      (void)UserRange;
-      (void)Props;
-#ifndef __SYCL_FORCE_PARALLEL_FOR_RANGE_ROUNDING__
-      // If parallel_for range rounding is forced then only range rounded
-      // kernel is generated
+    (void)UserRange;
+    (void)Props;
+#ifdef __SYCL_FORCE_PARALLEL_FOR_RANGE_ROUNDING__
+    // If parallel_for range rounding is forced then only range rounded
+    // kernel is generated
+    constexpr bool HasUserRangeKernel = NoRangeRounding;
+#else
+    constexpr bool HasUserRangeKernel = true;
+#endif // __SYCL_FORCE_PARALLEL_FOR_RANGE_ROUNDING__
+    if constexpr (HasUserRangeKernel) {
       kernel_parallel_for_wrapper<NameT, TransformedArgType, KernelType,
                                   PropertiesT>(KernelFunc);
 #ifndef __SYCL_DEVICE_ONLY__
@@ -1390,9 +1410,8 @@ private:
       setType(detail::CG::Kernel);
       setNDRangeUsed(false);
 #endif
-#else
+    } else {
       (void)KernelFunc;
-#endif // __SYCL_FORCE_PARALLEL_FOR_RANGE_ROUNDING__
     }
   }
 
@@ -3432,6 +3451,9 @@ private:
   void GetRangeRoundingSettings(size_t &MinFactor, size_t &GoodFactor,
                                 size_t &MinRange);
 
+  void GetRangeRoundingSettings(size_t RangeX, size_t &MinFactor,
+                                size_t &GoodFactor, size_t &MinRange);
+
   template <typename WrapperT, typename TransformedArgType, int Dims,
             typename KernelType,
             std::enable_if_t<detail::KernelLambdaHasKernelHandlerArgT<
@@ -3632,6 +3654,8 @@ private:
   void setKernelCacheConfig(sycl::detail::pi::PiKernelCacheConfig);
   // Set value of the kernel is cooperative flag
   void setKernelIsCooperative(bool);
+  // Set the hash of the kernel name computed at compile time
+  void setKernelNameHash(uint64_t);
 
   template <
       ext::oneapi::experimental::detail::UnsupportedGraphFeatures FeatureT>
@@ -29,6 +29,7 @@
 #include <cstddef>     // for std::byte
 #include <cstring>     // for size_t, memcpy
 #include <functional>  // for function
+#include <future>      // for future
 #include <iterator>    // for distance
 #include <memory>      // for shared_ptr, operator==, hash
 #include <string>      // for string
@@ -789,6 +790,11 @@ namespace detail {
 __SYCL_EXPORT std::shared_ptr<detail::kernel_bundle_impl>
 build_impl(const kernel_bundle<bundle_state::input> &InputBundle,
            const std::vector<device> &Devs, const property_list &PropList);
+
+__SYCL_EXPORT std::future<kernel_bundle<bundle_state::executable>>
+build_async_impl(const kernel_bundle<bundle_state::input> &InputBundle,
+                 const std::vector<device> &Devs,
+                 const property_list &PropList);
 }
 
 /// \returns a new kernel_bundle which contains device images that are
@@ -814,6 +820,23 @@ build(const kernel_bundle<bundle_state::input> &InputBundle,
 
 namespace ext::oneapi::experimental {
 
+/// \returns a future of the kernel_bundle returned by build for the same
+/// arguments. The device images are built in the background, and the future
+/// holds the exception thrown by the build if any.
+inline std::future<kernel_bundle<bundle_state::executable>>
+build_async(const kernel_bundle<bundle_state::input> &InputBundle,
+            const std::vector<device> &Devs,
+            const property_list &PropList = {}) {
+  return sycl::detail::build_async_impl(
+      InputBundle, sycl::detail::removeDuplicateDevices(Devs), PropList);
+}
+
+inline std::future<kernel_bundle<bundle_state::executable>>
+build_async(const kernel_bundle<bundle_state::input> &InputBundle,
+            const property_list &PropList = {}) {
+  return build_async(InputBundle, InputBundle.get_devices(), PropList);
+}
+
 /////////////////////////
 // PropertyT syclex::build_options
 /////////////////////////
@@ -75,6 +75,20 @@ class use_pinned_host_memory : public sycl::detail::DataLessProperty<
                                    sycl::detail::BufferUsePinnedHostMemory> {};
 } // namespace ext::oneapi::property::buffer
 
+namespace ext::oneapi::experimental::property::buffer {
+/// Requests that the host memory of the buffer is also used by devices sharing
+/// memory with the host, so that host accessors map it without copying it.
+class zero_copy
+    : public sycl::detail::DataLessProperty<sycl::detail::BufferZeroCopy> {};
+
+/// Makes the destruction of the buffer return without waiting for the
+/// commands using it. The write back of its data to the host is enqueued by
+/// the destruction and completes later, so the host memory must remain valid
+/// until the commands are done.
+class async_release : public sycl::detail::DataLessProperty<
+                          sycl::detail::BufferAsyncRelease> {};
+} // namespace ext::oneapi::experimental::property::buffer
+
 // Forward declaration
 template <typename T, int Dimensions, typename AllocatorT, typename Enable>
 class buffer;
@@ -104,6 +118,14 @@ template <typename T, int Dimensions, typename AllocatorT>
 struct is_property_of<ext::oneapi::property::buffer::use_pinned_host_memory,
                       buffer<T, Dimensions, AllocatorT, void>>
     : std::true_type {};
+template <typename T, int Dimensions, typename AllocatorT>
+struct is_property_of<ext::oneapi::experimental::property::buffer::zero_copy,
+                      buffer<T, Dimensions, AllocatorT, void>>
+    : std::true_type {};
+template <typename T, int Dimensions, typename AllocatorT>
+struct is_property_of<
+    ext::oneapi::experimental::property::buffer::async_release,
+    buffer<T, Dimensions, AllocatorT, void>> : std::true_type {};
 
 } // namespace _V1
 } // namespace sycl
@@ -33,6 +33,14 @@ class use_primary_context
 // clang-format on
 } // namespace property::context
 
+namespace ext::oneapi::experimental::property::context {
+/// Makes the context sub-allocate its small device and shared USM allocations
+/// from larger backend allocations, which are kept until the context is
+/// destroyed.
+class usm_pooling : public ::sycl::detail::DataLessProperty<
+                        ::sycl::detail::ContextUSMPooling> {};
+} // namespace ext::oneapi::experimental::property::context
+
 // Forward declaration
 class context;
 
@@ -45,5 +53,10 @@ template <>
 struct is_property_of<ext::oneapi::cuda::property::context::use_primary_context,
                       context> : std::true_type {};
 
+template <>
+struct is_property_of<
+    ext::oneapi::experimental::property::context::usm_pooling, context>
+    : std::true_type {};
+
 } // namespace _V1
 } // namespace sycl
@@ -12,6 +12,7 @@
 #include <sycl/detail/property_helper.hpp>     // for DataLessPropKind
 #include <sycl/properties/property_traits.hpp> // for is_property_of
 
+#include <cstddef>     // for size_t
 #include <type_traits> // for true_type
 
 namespace sycl {
@@ -44,6 +45,19 @@ public:
 private:
   int idx;
 };
+
+// Submits the commands of the queue to batched command lists, which are
+// flushed to the device after every size commands, at the latest.
+class submission_batch_size
+    : public sycl::detail::PropertyWithData<
+          sycl::detail::PropWithDataKind::QueueSubmissionBatchSize> {
+public:
+  submission_batch_size(size_t size) : size(size) {}
+  size_t get_batch_size() const { return size; }
+
+private:
+  size_t size;
+};
 } // namespace ext::intel::property::queue
 
 // Queue property trait specializations.
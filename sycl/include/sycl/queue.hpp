@@ -404,6 +404,58 @@ public:
 #endif // __SYCL_USE_FALLBACK_ASSERT
   }
 
+  /// Submits several command group function objects to the queue at once.
+  ///
+  /// The command groups are processed in order, as if they were submitted one
+  /// by one, but they are flushed to the backend together, which reduces the
+  /// host overhead of submitting many small command groups.
+  ///
+  /// \param CGFs are function objects containing command groups.
+  /// \param CodeLoc is the code location of the submit call (default argument)
+  /// \return a SYCL event object for each of the command groups.
+  std::vector<event> ext_oneapi_submit_batch(
+      const std::vector<std::function<void(handler &)>> &CGFs,
+      const detail::code_location &CodeLoc = detail::code_location::current()) {
+    detail::tls_code_loc_t TlsCodeLocCapture(CodeLoc);
+#if __SYCL_USE_FALLBACK_ASSERT
+    auto PostProcess = [this, &CodeLoc](bool IsKernel, bool KernelUsesAssert,
+                                        event &E) {
+      if (IsKernel && !device_has(aspect::ext_oneapi_native_assert) &&
+          KernelUsesAssert && !device_has(aspect::accelerator)) {
+        submitAssertCapture(*this, E, /* SecondaryQueue = */ nullptr, CodeLoc);
+      }
+    };
+
+    return submit_batch_impl(CGFs, CodeLoc, &PostProcess);
+#else
+    return submit_batch_impl(CGFs, CodeLoc, nullptr);
+#endif // __SYCL_USE_FALLBACK_ASSERT
+  }
+
+  /// Submits a command group function object to the queue without creating
+  /// an event for it.
+  ///
+  /// The command group can't be waited on or depended on individually, use
+  /// wait() or a barrier instead. Kernels submitted this way to an in-order
+  /// queue are passed to the backend without an output event whenever
+  /// possible.
+  ///
+  /// \param CGF is a function object containing command group.
+  /// \param CodeLoc is the code location of the submit call (default argument)
+  template <typename T>
+  std::enable_if_t<std::is_invocable_r_v<void, T, handler &>>
+  ext_oneapi_submit_without_event(
+      T CGF,
+      const detail::code_location &CodeLoc = detail::code_location::current()) {
+    detail::tls_code_loc_t TlsCodeLocCapture(CodeLoc);
+#if __SYCL_USE_FALLBACK_ASSERT
+    // Fallback assert needs the event of the kernel to report the failure.
+    submit(CGF, CodeLoc);
+#else
+    submit_without_event_impl(CGF, CodeLoc);
+#endif // __SYCL_USE_FALLBACK_ASSERT
+  }
+
   /// Prevents any commands submitted afterward to this queue from executing
   /// until all commands previously submitted to this queue have entered the
   /// complete state.
@@ -2765,6 +2817,21 @@ private:
                                     const detail::code_location &CodeLoc,
                                     const SubmitPostProcessF &PostProcess);
 
+  /// A template-free version of ext_oneapi_submit_batch.
+  /// \param CGFs command group functions
+  /// \param CodeLoc code location
+  /// \param PostProcess optional post processing of each submitted command
+  std::vector<event>
+  submit_batch_impl(const std::vector<std::function<void(handler &)>> &CGFs,
+                    const detail::code_location &CodeLoc,
+                    const SubmitPostProcessF *PostProcess);
+
+  /// A template-free version of ext_oneapi_submit_without_event.
+  /// \param CGH command group function/handler
+  /// \param CodeLoc code location
+  void submit_without_event_impl(std::function<void(handler &)> CGH,
+                                 const detail::code_location &CodeLoc);
+
   /// parallel_for_impl with a kernel represented as a lambda + range that
   /// specifies global size only.
   ///
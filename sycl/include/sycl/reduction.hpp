@@ -55,6 +55,7 @@
 #include <string>      // for operator+
 #include <tuple>       // for _Swallow_...
 #include <type_traits> // for enable_if_t
+#include <typeinfo>    // for typeid
 #include <utility>     // for index_seq...
 #include <variant>     // for tuple
 
@@ -2160,6 +2161,13 @@ struct IsScalarReduction {
   };
 };
 
+template <typename ReduTupleT> struct AreAllScalarReductions;
+template <typename... Reductions>
+struct AreAllScalarReductions<std::tuple<Reductions...>> {
+  static constexpr bool value =
+      (IsScalarReduction::Func<Reductions>::value && ...);
+};
+
 struct IsArrayReduction {
   template <typename Reduction> struct Func {
     static constexpr bool value =
@@ -2378,6 +2386,134 @@ void reduCGFuncMulti(handler &CGH, KernelType KernelFunc,
          createReduOutAccs<false>(NWorkGroups, CGH, ReduTuple, ReduIndices));
 }
 
+/// Reduces the partial sums of all work-groups in the last work-group to
+/// finish and writes the final results. All scalar reductions are reduced
+/// together with one loop of log2(N) steps.
+template <typename... Reductions, int Dims, typename... LocalAccT,
+          typename... InAccT, typename... OutAccT, typename... Ts,
+          typename... BOPsT, size_t... Is>
+void reduFusedLastWGImpl(
+    nd_item<Dims> NDIt, size_t NWorkGroups,
+    ReduTupleT<LocalAccT...> LocalAccsTuple, ReduTupleT<InAccT...> InAccsTuple,
+    ReduTupleT<OutAccT...> OutAccsTuple, ReduTupleT<Ts...> IdentitiesTuple,
+    ReduTupleT<BOPsT...> BOPsTuple,
+    std::array<bool, sizeof...(Reductions)> InitToIdentityProps,
+    std::index_sequence<Is...> ReduIndices) {
+  size_t WGSize = NDIt.get_local_range().size();
+  size_t LID = NDIt.get_local_linear_id();
+
+  // We apply tree-reduction on reducer elements so we adjust the operations
+  // to combine these.
+  auto AdjustedBOPsTuple = makeAdjustedBOPs<Reductions...>(BOPsTuple);
+
+  // There may be more partial sums than work-items, so first combine them
+  // into the local memory.
+  size_t WorkSize = sycl::min(WGSize, NWorkGroups);
+  if (LID < WorkSize) {
+    ((std::get<Is>(LocalAccsTuple)[LID] = std::get<Is>(InAccsTuple)[LID]),
+     ...);
+    for (size_t I = LID + WGSize; I < NWorkGroups; I += WGSize)
+      (std::get<Is>(AdjustedBOPsTuple)(std::get<Is>(LocalAccsTuple)[LID],
+                                       std::get<Is>(InAccsTuple)[I]),
+       ...);
+  }
+
+  doTreeReductionOnTuple(WorkSize, LID, LocalAccsTuple, AdjustedBOPsTuple,
+                         ReduIndices);
+
+  if (LID == 0)
+    writeReduSumsToOutAccs</*IsOneWG=*/true, Reductions...>(
+        0, OutAccsTuple, LocalAccsTuple, AdjustedBOPsTuple, IdentitiesTuple,
+        InitToIdentityProps, ReduIndices);
+}
+
+/// Fused variant of reduCGFuncMulti for the case when all reductions are
+/// scalar. The partial sums of the work-groups are reduced by the last
+/// work-group to finish, so no auxiliary kernels are needed.
+template <typename KernelName, typename KernelType, int Dims,
+          typename PropertiesT, typename... Reductions, size_t... Is>
+void reduCGFuncMultiFused(handler &CGH, KernelType KernelFunc,
+                          const nd_range<Dims> &Range, PropertiesT Properties,
+                          std::tuple<Reductions...> &ReduTuple,
+                          std::index_sequence<Is...> ReduIndices) {
+  size_t WGSize = Range.get_local_range().size();
+  size_t NWorkGroups = Range.get_group_range().size();
+
+  // Each reduction keeps its values for the work-group in its own array, so
+  // the tree-reduction below reads consecutive elements of each of them.
+  auto LocalAccsTuple = makeReduTupleT(
+      local_accessor<typename Reductions::reducer_element_type, 1>{WGSize,
+                                                                   CGH}...);
+  auto PartialSumsTuple = makeReduTupleT(
+      accessor{std::get<Is>(ReduTuple)
+                   .template getTempBuffer<
+                       typename Reductions::reducer_element_type>(NWorkGroups,
+                                                                  CGH),
+               CGH, sycl::read_write, sycl::no_init}...);
+  auto OutAccsTuple =
+      makeReduTupleT(std::get<Is>(ReduTuple).getUserRedVarAccess(CGH)...);
+  auto IdentitiesTuple =
+      makeReduTupleT(std::get<Is>(ReduTuple).getIdentityContainer()...);
+  auto BOPsTuple =
+      makeReduTupleT(std::get<Is>(ReduTuple).getBinaryOperation()...);
+  std::array InitToIdentityProps{
+      std::get<Is>(ReduTuple).initializeToIdentity()...};
+
+  auto Rest = [&](auto NWorkGroupsFinished) {
+    local_accessor<int, 1> DoReducePartialSumsInLastWG{1, CGH};
+
+    using Name = __sycl_reduction_kernel<reduction::MainKrn, KernelName,
+                                         reduction::strategy::multi,
+                                         decltype(NWorkGroupsFinished)>;
+
+    CGH.parallel_for<Name>(Range, Properties, [=](nd_item<Dims> NDIt) {
+      // Pass all reductions to user's lambda in the same order as supplied
+      // Each reducer initializes its own storage
+      auto ReducerTokensTuple =
+          std::tuple{typename Reductions::reducer_token_type{
+              std::get<Is>(IdentitiesTuple), std::get<Is>(BOPsTuple)}...};
+      auto ReducersTuple = std::tuple<typename Reductions::reducer_type...>{
+          std::get<Is>(ReducerTokensTuple)...};
+      std::apply([&](auto &...Reducers) { KernelFunc(NDIt, Reducers...); },
+                 ReducersTuple);
+
+      // Combine the values of the work-group and write its partial sums.
+      reduCGFuncImplScalar</*IsOneWG=*/false, Reductions...>(
+          NDIt, LocalAccsTuple, PartialSumsTuple, ReducersTuple,
+          IdentitiesTuple, BOPsTuple, InitToIdentityProps, ReduIndices);
+
+      // Signal this work-group has finished after all values are reduced. We
+      // had an implicit work-group barrier in the tree-reduction and all the
+      // work since has been done in (LID == 0) work-item, so no extra sync is
+      // needed.
+      if (NDIt.get_local_linear_id() == 0) {
+        auto NFinished =
+            sycl::atomic_ref<int, memory_order::acq_rel, memory_scope::device,
+                             access::address_space::global_space>(
+                NWorkGroupsFinished[0]);
+        DoReducePartialSumsInLastWG[0] =
+            ++NFinished == static_cast<int>(NWorkGroups);
+      }
+
+      workGroupBarrier();
+      if (DoReducePartialSumsInLastWG[0])
+        reduFusedLastWGImpl<Reductions...>(
+            NDIt, NWorkGroups, LocalAccsTuple, PartialSumsTuple, OutAccsTuple,
+            IdentitiesTuple, BOPsTuple, InitToIdentityProps, ReduIndices);
+    });
+  };
+
+  // Integrated/discrete GPUs have different faster path for the counter of
+  // finished work-groups, see group_reduce_and_last_wg_detection.
+  auto &FirstRedu = std::get<0>(ReduTuple);
+  auto Device = getDeviceFromHandler(CGH);
+  if (Device.get_info<info::device::host_unified_memory>() ||
+      !Device.has(aspect::usm_device_allocations))
+    Rest(FirstRedu.getReadWriteAccessorToInitializedGroupsCounter(CGH));
+  else
+    Rest(FirstRedu.getGroupsCounterAccDiscrete(CGH));
+}
+
 // TODO: Is this still needed?
 template <typename... Reductions, size_t... Is>
 void associateReduAccsWithHandler(handler &CGH,
@@ -2617,11 +2753,22 @@ template <> struct NDRangeReduction<reduction::strategy::multi> {
                             " than " +
                                 std::to_string(MaxWGSize));
 
+    size_t NWorkItems = NDRange.get_group_range().size();
+
+    // If all reductions are scalar, the last work-group to finish reduces the
+    // partial sums of all of them, so no auxiliary kernels are needed.
+    if constexpr (AreAllScalarReductions<decltype(ReduTuple)>::value) {
+      if (NWorkItems > 1) {
+        reduCGFuncMultiFused<KernelName>(CGH, KernelFunc, NDRange, Properties,
+                                         ReduTuple, ReduIndices);
+        return;
+      }
+    }
+
     reduCGFuncMulti<KernelName>(CGH, KernelFunc, NDRange, Properties, ReduTuple,
                                 ReduIndices);
     reduction::finalizeHandler(CGH);
 
-    size_t NWorkItems = NDRange.get_group_range().size();
     while (NWorkItems > 1) {
       reduction::withAuxHandler(CGH, [&](handler &AuxHandler) {
         NWorkItems = reduAuxCGFunc<KernelName, decltype(KernelFunc)>(
@@ -2706,6 +2853,100 @@ void reduction_parallel_for(handler &CGH, nd_range<Dims> NDRange,
 __SYCL_EXPORT uint32_t
 reduGetMaxNumConcurrentWorkGroups(std::shared_ptr<queue_impl> Queue);
 
+/// \return the reduction::strategy to use for a launch of the reduction
+/// identified by \p Key over \p NWorkItems work-items, among the strategies
+/// set in the bit mask \p Candidates, or reduction::strategy::auto_select if
+/// the launch is not autotuned.
+__SYCL_EXPORT int reduGetAutotunedStrategy(std::shared_ptr<queue_impl> &Queue,
+                                           const char *Key, size_t NWorkItems,
+                                           uint32_t Candidates);
+
+#ifdef SYCL_REDUCTION_AUTOTUNE
+/// Runs a reduction over a sycl::range with the strategy chosen by timing the
+/// strategies applicable to it on its first launches.
+///
+/// \return false if the launch is not autotuned, in which case the strategy
+/// must be selected statically.
+template <typename KernelName, typename PropertiesT, typename Reduction,
+          typename KernelType>
+bool reduRunAutotuned(handler &CGH, std::shared_ptr<queue_impl> &Queue,
+                      nd_range<1> NDRange, PropertiesT &Properties,
+                      Reduction &Redu, KernelType &KernelFunc,
+                      size_t NWorkItems) {
+  using Strat = reduction::strategy;
+  constexpr auto Bit = [](Strat S) { return 1u << static_cast<int>(S); };
+  if (Queue == nullptr)
+    return false;
+
+  uint32_t Candidates = Bit(Strat::range_basic) | Bit(Strat::basic);
+  if constexpr (Reduction::has_fast_reduce) {
+    Candidates |= Bit(Strat::group_reduce_and_multiple_kernels);
+    // Identityless reductions cannot use group reductions.
+    if constexpr (Reduction::has_identity)
+      Candidates |= Bit(Strat::group_reduce_and_last_wg_detection);
+  }
+  // The strategies using atomics on the partial results implicitly require
+  // aspect::atomic64 if the result type of the reduction is 64-bit.
+  if constexpr (Reduction::has_fast_atomics ||
+                Reduction::has_float64_atomics) {
+    if (sizeof(typename Reduction::result_type) != 8 ||
+        getDeviceFromHandler(CGH).has(aspect::atomic64)) {
+      if constexpr (Reduction::has_fast_atomics)
+        Candidates |= Bit(Strat::local_atomic_and_atomic_cross_wg) |
+                      Bit(Strat::local_mem_tree_and_atomic_cross_wg);
+      if constexpr (Reduction::has_fast_reduce)
+        Candidates |= Bit(Strat::group_reduce_and_atomic_cross_wg);
+    }
+  }
+
+  // The kernel function wraps the one of the user, so its type identifies
+  // both the kernel and the reduction.
+  int Strategy = reduGetAutotunedStrategy(Queue, typeid(KernelType).name(),
+                                          NWorkItems, Candidates);
+  auto Delegate = [&](auto Impl) {
+    Impl.template run<KernelName>(CGH, Queue, NDRange, Properties, Redu,
+                                  KernelFunc);
+    return true;
+  };
+  switch (static_cast<Strat>(Strategy)) {
+  case Strat::group_reduce_and_last_wg_detection:
+    if constexpr (Reduction::has_fast_reduce && Reduction::has_identity)
+      return Delegate(
+          NDRangeReduction<Strat::group_reduce_and_last_wg_detection>{});
+    break;
+  case Strat::local_atomic_and_atomic_cross_wg:
+    if constexpr (Reduction::has_fast_atomics)
+      return Delegate(
+          NDRangeReduction<Strat::local_atomic_and_atomic_cross_wg>{});
+    break;
+  case Strat::range_basic:
+    return Delegate(NDRangeReduction<Strat::range_basic>{});
+  case Strat::group_reduce_and_atomic_cross_wg:
+    if constexpr ((Reduction::has_fast_atomics ||
+                   Reduction::has_float64_atomics) &&
+                  Reduction::has_fast_reduce)
+      return Delegate(
+          NDRangeReduction<Strat::group_reduce_and_atomic_cross_wg>{});
+    break;
+  case Strat::local_mem_tree_and_atomic_cross_wg:
+    if constexpr (Reduction::has_fast_atomics)
+      return Delegate(
+          NDRangeReduction<Strat::local_mem_tree_and_atomic_cross_wg>{});
+    break;
+  case Strat::group_reduce_and_multiple_kernels:
+    if constexpr (Reduction::has_fast_reduce)
+      return Delegate(
+          NDRangeReduction<Strat::group_reduce_and_multiple_kernels>{});
+    break;
+  case Strat::basic:
+    return Delegate(NDRangeReduction<Strat::basic>{});
+  default:
+    break;
+  }
+  return false;
+}
+#endif
+
 template <typename KernelName, reduction::strategy Strategy, int Dims,
           typename PropertiesT, typename... RestT>
 void reduction_parallel_for(handler &CGH, range<Dims> Range,
@@ -2723,8 +2964,13 @@ void reduction_parallel_for(handler &CGH, range<Dims> Range,
     // Can't use outlined NumArgs due to a bug in gcc 8.4.
     if constexpr (sizeof...(RestT) == 2) {
       using Reduction = std::tuple_element_t<0, decltype(ReduTuple)>;
+#ifdef SYCL_REDUCTION_AUTOTUNE
+      // Autotuning may pick a tree-reduction strategy for any reduction.
+      constexpr bool IsTreeReduction = true;
+#else
       constexpr bool IsTreeReduction =
           !Reduction::has_fast_reduce && !Reduction::has_fast_atomics;
+#endif
       return IsTreeReduction ? sizeof(typename Reduction::result_type) : 0;
     } else {
       return reduGetMemPerWorkItem(ReduTuple, ReduIndices);
@@ -2792,6 +3038,13 @@ void reduction_parallel_for(handler &CGH, range<Dims> Range,
     using Reduction = std::tuple_element_t<0, decltype(ReduTuple)>;
     auto &Redu = std::get<0>(ReduTuple);
 
+#ifdef SYCL_REDUCTION_AUTOTUNE
+    if constexpr (Strategy == reduction::strategy::auto_select)
+      if (reduRunAutotuned<KernelName>(CGH, CGH.MQueue, NDRange, Properties,
+                                       Redu, UpdatedKernelFunc, NWorkItems))
+        return;
+#endif
+
     constexpr auto StrategyToUse = [&]() {
       if constexpr (Strategy != reduction::strategy::auto_select)
         return Strategy;
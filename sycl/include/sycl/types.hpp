@@ -170,6 +170,37 @@ class SwizzleOp;
 
 template <typename T, int N, typename V = void> struct VecStorage;
 
+#if !defined(__SYCL_DEVICE_ONLY__) && (defined(__GNUC__) || defined(__clang__))
+// On host, the element-wise operations of sycl::vec are run on GNU vector
+// types, so that they are lowered to SIMD instructions instead of loops. The
+// storage of sycl::vec stays std::array, so that its layout and the ABI of the
+// functions taking it do not depend on the host compiler.
+#define __SYCL_USE_HOST_VECTOR_OPS__
+
+template <typename T, int N, typename = void> struct HostVector {
+  static constexpr bool value = false;
+};
+
+template <typename T, int N>
+struct HostVector<
+    T, N,
+    std::enable_if_t<(N > 1) &&
+                     ((std::is_integral_v<T> && !std::is_same_v<T, bool>) ||
+                      std::is_same_v<T, float> || std::is_same_v<T, double>)>> {
+  static constexpr bool value = true;
+  // GCC ignores the attribute on dependent types in alias declarations.
+  typedef T type __attribute__((vector_size(sizeof(T) * (N == 3 ? 4 : N))));
+};
+
+// Integer division and shifts are left element-wise: the padding element of
+// 3-element vectors may be a zero divisor, and the shifts of small integers
+// are done on promoted values.
+constexpr bool isHostVectorBinOp(std::string_view Op, bool IsFloat) {
+  return Op == "+" || Op == "-" || Op == "*" || Op == "&" || Op == "|" ||
+         Op == "^" || (Op == "/" && IsFloat);
+}
+#endif // !__SYCL_DEVICE_ONLY__ && (__GNUC__ || __clang__)
+
 // Element type for relational operator return value.
 template <typename DataT>
 using rel_t = typename std::conditional_t<
@@ -317,6 +348,16 @@ template <typename Type, int NumElements> class vec {
   static constexpr bool IsUsingArrayOnHost = true; // host always std::array.
 #endif
 
+#ifdef __SYCL_USE_HOST_VECTOR_OPS__
+  static constexpr bool UseHostVector =
+      detail::HostVector<DataT, NumElements>::value;
+  template <typename T = DataT>
+  using HostVectorT = typename detail::HostVector<T, NumElements>::type;
+#else
+  static constexpr bool UseHostVector = false;
+  template <typename T = DataT> using HostVectorT = DataType;
+#endif
+
   static constexpr int getNumElements() { return NumElements; }
 
   // SizeChecker is needed for vec(const argTN &... args) ctor to validate args.
@@ -745,6 +786,22 @@ public:
       Result.m_Data = detail::convertImpl<T, R, roundingMode, NumElements,
                                           OpenCLVecT, OpenCLVecR>(m_Data);
     } else
+#elif defined(__SYCL_USE_HOST_VECTOR_OPS__) &&                                 \
+    __has_builtin(__builtin_convertvector)
+    // The element-wise conversions are static_cast, except for the ones from
+    // floating point to integer types, which round to nearest by default.
+    constexpr bool canUseHostVectorConvert =
+        UseHostVector && vec<convertT, NumElements>::UseHostVector &&
+        std::is_same_v<T, DataT> && std::is_same_v<R, convertT> &&
+        !((detail::is_float_to_sint<T, R>::value ||
+           detail::is_float_to_uint<T, R>::value) &&
+          roundingMode != rounding_mode::rtz);
+    if constexpr (canUseHostVectorConvert) {
+      using HostVectorR =
+          typename vec<convertT, NumElements>::template HostVectorT<>;
+      Result.m_Data = bit_cast<decltype(Result.m_Data)>(__builtin_convertvector(
+          bit_cast<HostVectorT<>>(m_Data), HostVectorR));
+    } else
 #endif // defined(__SYCL_DEVICE_ONLY__)
     {
       // Otherwise, we fallback to per-element conversion:
@@ -950,6 +1007,12 @@ public:
     vec Ret{};                                                                 \
     if constexpr (NativeVec)                                                   \
       Ret.m_Data = Lhs.m_Data BINOP Rhs.m_Data;                                \
+    else if constexpr (UseHostVector &&                                        \
+                       detail::isHostVectorBinOp(                              \
+                           #BINOP, detail::is_floating_point<DataT>::value))   \
+      Ret.m_Data = bit_cast<DataType>(bit_cast<HostVectorT<>>(Lhs.m_Data)      \
+                                          BINOP bit_cast<HostVectorT<>>(       \
+                                              Rhs.m_Data));                    \
     else                                                                       \
       for (size_t I = 0; I < NumElements; ++I)                                 \
         Ret.setValue(I, (DataT)(vec_data<DataT>::get(Lhs.getValue(             \
@@ -1042,6 +1105,13 @@ public:
   friend vec<rel_t, NumElements> operator RELLOGOP(const vec & Lhs,            \
                                                    const vec & Rhs) {          \
     vec<rel_t, NumElements> Ret{};                                             \
+    /* The comparisons of GNU vectors yield 0/-1 integer vectors. */           \
+    if constexpr (UseHostVector && std::string_view(#RELLOGOP) != "||" &&      \
+                  std::string_view(#RELLOGOP) != "&&") {                       \
+      return bit_cast<vec<rel_t, NumElements>>(                                \
+          bit_cast<HostVectorT<>>(Lhs.m_Data)                                  \
+              RELLOGOP bit_cast<HostVectorT<>>(Rhs.m_Data));                   \
+    }                                                                          \
     for (size_t I = 0; I < NumElements; ++I) {                                 \
       /* We cannot use SetValue here as the operator is not a friend of*/      \
       /* Ret on Windows. */                                                    \
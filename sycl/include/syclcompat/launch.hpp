@@ -24,6 +24,7 @@
 
 #include <sycl/accessor.hpp>
 #include <sycl/event.hpp>
+#include <sycl/ext/oneapi/experimental/enqueue_functions.hpp>
 #include <sycl/nd_range.hpp>
 #include <sycl/queue.hpp>
 #include <sycl/range.hpp>
@@ -87,6 +88,40 @@ sycl::event launch(const sycl::nd_range<3> &range, size_t mem_size,
   });
 }
 
+template <auto F, typename... Args>
+std::enable_if_t<std::is_invocable_v<decltype(F), Args...>>
+launch_without_event(const sycl::nd_range<3> &range, sycl::queue q,
+                     Args... args) {
+  static_assert(detail::getArgumentCount(F) == sizeof...(args),
+                "Wrong number of arguments to SYCL kernel");
+  static_assert(
+      std::is_same<std::invoke_result_t<decltype(F), Args...>, void>::value,
+      "SYCL kernels should return void");
+
+  sycl::ext::oneapi::experimental::nd_launch(
+      q, range, [=](sycl::nd_item<3>) { [[clang::always_inline]] F(args...); });
+}
+
+template <auto F, typename... Args>
+void launch_without_event(const sycl::nd_range<3> &range, size_t mem_size,
+                          sycl::queue q, Args... args) {
+  static_assert(detail::getArgumentCount(F) == sizeof...(args) + 1,
+                "Wrong number of arguments to SYCL kernel");
+
+  using F_t = decltype(F);
+  using f_return_t = typename std::invoke_result_t<F_t, Args..., char *>;
+  static_assert(std::is_same<f_return_t, void>::value,
+                "SYCL kernels should return void");
+
+  sycl::ext::oneapi::experimental::submit(q, [&](sycl::handler &cgh) {
+    auto local_acc = sycl::local_accessor<char, 1>(mem_size, cgh);
+    cgh.parallel_for(range, [=](sycl::nd_item<3>) {
+      auto local_mem = local_acc.get_pointer();
+      [[clang::always_inline]] F(args..., local_mem);
+    });
+  });
+}
+
 } // namespace detail
 
 template <int Dim>
@@ -220,4 +255,82 @@ sycl::event launch(const dim3 &grid, const dim3 &threads, size_t mem_size,
   return launch<F>(grid, threads, mem_size, get_default_queue(), args...);
 }
 
+/// Launches a kernel with the templated F param and arguments on a
+/// device specified by the given nd_range and SYCL queue, without creating
+/// an event for it. The runtime doesn't need to create and track an event
+/// for each launch, which makes this the cheapest way to launch a kernel
+/// many times. Use queue::wait() or a barrier to synchronize with it.
+/// @tparam F SYCL kernel to be executed, expects signature F(Args... args).
+/// @tparam Dim nd_range dimension number.
+/// @tparam Args Types of the arguments to be passed to the kernel.
+/// @param range Nd_range specifying the work group and global sizes for the
+/// kernel.
+/// @param q The SYCL queue on which to execute the kernel.
+/// @param args The arguments to be passed to the kernel.
+template <auto F, int Dim, typename... Args>
+std::enable_if_t<std::is_invocable_v<decltype(F), Args...>>
+launch_without_event(const sycl::nd_range<Dim> &range, sycl::queue q,
+                     Args... args) {
+  detail::launch_without_event<F>(detail::transform_nd_range<Dim>(range), q,
+                                  args...);
+}
+
+/// Launches a kernel with the templated F param and arguments on a
+/// device with a user-specified grid and block dimensions using a
+/// user-defined SYCL queue, without creating an event for it.
+/// @tparam F SYCL kernel to be executed, expects signature F(Args... args).
+/// @tparam Args Types of the arguments to be passed to the kernel.
+/// @param grid Grid dimensions represented with an (x, y, z) iteration space.
+/// @param threads Block dimensions represented with an (x, y, z) iteration
+/// space.
+/// @param q The SYCL queue on which to execute the kernel.
+/// @param args The arguments to be passed to the kernel.
+template <auto F, typename... Args>
+std::enable_if_t<std::is_invocable_v<decltype(F), Args...>>
+launch_without_event(const dim3 &grid, const dim3 &threads, sycl::queue q,
+                     Args... args) {
+  launch_without_event<F>(sycl::nd_range<3>{grid * threads, threads}, q,
+                          args...);
+}
+
+/// Launches a kernel with the templated F param and arguments on a
+/// device specified by the given nd_range and SYCL queue, without creating
+/// an event for it.
+/// @tparam F SYCL kernel to be executed, expects signature F(T* local_mem,
+/// Args... args).
+/// @tparam Dim nd_range dimension number.
+/// @tparam Args Types of the arguments to be passed to the kernel.
+/// @param range Nd_range specifying the work group and global sizes for the
+/// kernel.
+/// @param mem_size The size, in number of bytes, of the local
+/// memory to be allocated for kernel.
+/// @param q The SYCL queue on which to execute the kernel.
+/// @param args The arguments to be passed to the kernel.
+template <auto F, int Dim, typename... Args>
+void launch_without_event(const sycl::nd_range<Dim> &range, size_t mem_size,
+                          sycl::queue q, Args... args) {
+  detail::launch_without_event<F>(detail::transform_nd_range<Dim>(range),
+                                  mem_size, q, args...);
+}
+
+/// Launches a kernel with the templated F param and arguments on a
+/// device with a user-specified grid and block dimensions using a
+/// user-defined SYCL queue, without creating an event for it.
+/// @tparam F SYCL kernel to be executed, expects signature F(T* local_mem,
+/// Args... args).
+/// @tparam Args Types of the arguments to be passed to the kernel.
+/// @param grid Grid dimensions represented with an (x, y, z) iteration space.
+/// @param threads Block dimensions represented with an (x, y, z) iteration
+/// space.
+/// @param mem_size The size, in number of bytes, of the local
+/// memory to be allocated for kernel.
+/// @param q The SYCL queue on which to execute the kernel.
+/// @param args The arguments to be passed to the kernel.
+template <auto F, typename... Args>
+void launch_without_event(const dim3 &grid, const dim3 &threads,
+                          size_t mem_size, sycl::queue q, Args... args) {
+  launch_without_event<F>(sycl::nd_range<3>{grid * threads, threads}, mem_size,
+                          q, args...);
+}
+
 } // namespace syclcompat
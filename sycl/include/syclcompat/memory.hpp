@@ -43,6 +43,7 @@
 
 #include <sycl/builtins.hpp>
 #include <sycl/ext/intel/experimental/usm_properties.hpp>
+#include <sycl/ext/oneapi/memcpy2d.hpp>
 #include <sycl/ext/oneapi/group_local_memory.hpp>
 #include <sycl/usm.hpp>
 
@@ -264,12 +265,6 @@ static sycl::event memcpy(sycl::queue q, void *to_ptr, const void *from_ptr,
   return q.memcpy(to_ptr, from_ptr, size, dep_events);
 }
 
-// Get actual copy range and make sure it will not exceed range.
-static inline size_t get_copy_range(sycl::range<3> size, size_t slice,
-                                    size_t pitch) {
-  return slice * (size.get(2) - 1) + pitch * (size.get(1) - 1) + size.get(0);
-}
-
 static inline size_t get_offset(sycl::id<3> id, size_t slice, size_t pitch) {
   return slice * id.get(2) + pitch * id.get(1) + id.get(0);
 }
@@ -281,28 +276,6 @@ memcpy(sycl::queue q, void *to_ptr, const void *from_ptr,
        sycl::range<3> to_range, sycl::range<3> from_range, sycl::id<3> to_id,
        sycl::id<3> from_id, sycl::range<3> size,
        const std::vector<sycl::event> &dep_events = {}) {
-  // RAII for host pointer
-  class host_buffer {
-    void *_buf;
-    size_t _size;
-    sycl::queue _q;
-    const std::vector<sycl::event> &_deps; // free operation depends
-
-  public:
-    host_buffer(size_t size, sycl::queue q,
-                const std::vector<sycl::event> &deps)
-        : _buf(std::malloc(size)), _size(size), _q(q), _deps(deps) {}
-    void *get_ptr() const { return _buf; }
-    size_t get_size() const { return _size; }
-    ~host_buffer() {
-      if (_buf) {
-        _q.submit([&](sycl::handler &cgh) {
-          cgh.depends_on(_deps);
-          cgh.host_task([buf = _buf] { std::free(buf); });
-        });
-      }
-    }
-  };
   std::vector<sycl::event> event_list;
 
   size_t to_slice = to_range.get(1) * to_range.get(0);
@@ -340,42 +313,20 @@ memcpy(sycl::queue q, void *to_ptr, const void *from_ptr,
       from_surface += from_slice;
     }
     break;
-  case host_to_device: {
-    host_buffer buf(get_copy_range(size, to_slice, to_range.get(0)), q,
-                    event_list);
-    std::vector<sycl::event> host_events;
-    if (to_slice == size_slice) {
-      // Copy host data to a temp host buffer with the shape of target.
-      host_events =
-          memcpy(q, buf.get_ptr(), from_surface, to_range, from_range,
-                 sycl::id<3>(0, 0, 0), sycl::id<3>(0, 0, 0), size, dep_events);
-    } else {
-      // Copy host data to a temp host buffer with the shape of target.
-      host_events =
-          memcpy(q, buf.get_ptr(), from_surface, to_range, from_range,
-                 sycl::id<3>(0, 0, 0), sycl::id<3>(0, 0, 0), size,
-                 // If has padding data, not sure whether it is useless. So fill
-                 // temp buffer with it.
-                 std::vector<sycl::event>{memcpy(q, buf.get_ptr(), to_surface,
-                                                 buf.get_size(), dep_events)});
+  case host_to_device:
+  case device_to_host:
+    // Copy each slice with a 2D copy, which the backend does natively or with
+    // a single command, and without staging through a temp host buffer.
+    for (size_t z = 0; z < size.get(2); ++z) {
+      event_list.push_back(q.submit([&](sycl::handler &cgh) {
+        cgh.depends_on(dep_events);
+        cgh.ext_oneapi_memcpy2d(to_surface, to_range.get(0), from_surface,
+                                from_range.get(0), size.get(0), size.get(1));
+      }));
+      to_surface += to_slice;
+      from_surface += from_slice;
     }
-    // Copy from temp host buffer to device with only one submit.
-    event_list.push_back(
-        memcpy(q, to_surface, buf.get_ptr(), buf.get_size(), host_events));
     break;
-  }
-  case device_to_host: {
-    host_buffer buf(get_copy_range(size, from_slice, from_range.get(0)), q,
-                    event_list);
-    // Copy from host temp buffer to host target with reshaping.
-    event_list =
-        memcpy(q, to_surface, buf.get_ptr(), to_range, from_range,
-               sycl::id<3>(0, 0, 0), sycl::id<3>(0, 0, 0), size,
-               // Copy from device to temp host buffer with only one submit.
-               std::vector<sycl::event>{memcpy(q, buf.get_ptr(), from_surface,
-                                               buf.get_size(), dep_events)});
-    break;
-  }
   case device_to_device:
     event_list.push_back(q.submit([&](sycl::handler &cgh) {
       cgh.depends_on(dep_events);
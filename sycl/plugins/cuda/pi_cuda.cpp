@@ -363,6 +363,11 @@ pi_result piextKernelSetArgSampler(pi_kernel Kernel, pi_uint32 ArgIndex,
   return pi2ur::piextKernelSetArgSampler(Kernel, ArgIndex, ArgValue);
 }
 
+pi_result piextKernelSetArgs(pi_kernel Kernel, pi_uint32 NumArgs,
+                             const pi_kernel_arg *Args) {
+  return pi2ur::piextKernelSetArgs(Kernel, NumArgs, Args);
+}
+
 pi_result piKernelGetInfo(pi_kernel Kernel, pi_kernel_info ParamName,
                           size_t ParamValueSize, void *ParamValue,
                           size_t *ParamValueSizeRet) {
@@ -1065,6 +1070,11 @@ pi_result piextProgramSetSpecializationConstant(pi_program Prog,
 }
 
 // Command buffer extension
+// The command-buffers are built as CUDA graphs by the CUDA adapter of Unified
+// Runtime, which instantiates them when they are finalized and updates the
+// kernel nodes of the executable graph in place for
+// piextCommandBufferUpdateKernelLaunch. The adapter is fetched with UR, see
+// CMakeLists.txt.
 pi_result piextCommandBufferCreate(pi_context Context, pi_device Device,
                                    const pi_ext_command_buffer_desc *Desc,
                                    pi_ext_command_buffer *RetCommandBuffer) {
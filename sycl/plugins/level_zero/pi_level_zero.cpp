@@ -375,6 +375,11 @@ pi_result piextKernelSetArgSampler(pi_kernel Kernel, pi_uint32 ArgIndex,
   return pi2ur::piextKernelSetArgSampler(Kernel, ArgIndex, ArgValue);
 }
 
+pi_result piextKernelSetArgs(pi_kernel Kernel, pi_uint32 NumArgs,
+                             const pi_kernel_arg *Args) {
+  return pi2ur::piextKernelSetArgs(Kernel, NumArgs, Args);
+}
+
 pi_result piKernelGetInfo(pi_kernel Kernel, pi_kernel_info ParamName,
                           size_t ParamValueSize, void *ParamValue,
                           size_t *ParamValueSizeRet) {
@@ -370,6 +370,11 @@ pi_result piextKernelSetArgSampler(pi_kernel Kernel, pi_uint32 ArgIndex,
   return pi2ur::piextKernelSetArgSampler(Kernel, ArgIndex, ArgValue);
 }
 
+pi_result piextKernelSetArgs(pi_kernel Kernel, pi_uint32 NumArgs,
+                             const pi_kernel_arg *Args) {
+  return pi2ur::piextKernelSetArgs(Kernel, NumArgs, Args);
+}
+
 pi_result piKernelGetInfo(pi_kernel Kernel, pi_kernel_info ParamName,
                           size_t ParamValueSize, void *ParamValue,
                           size_t *ParamValueSizeRet) {
@@ -542,6 +547,9 @@ pi_result piKernelRelease(pi_kernel Kernel) {
   return pi2ur::piKernelRelease(Kernel);
 }
 
+// The work-groups are run by the Native CPU adapter of Unified Runtime, whose
+// sources are fetched with UR and built into this plugin, see CMakeLists.txt.
+// Its thread pool and the scheduling of the work-groups live there.
 pi_result
 piEnqueueKernelLaunch(pi_queue Queue, pi_kernel Kernel, pi_uint32 WorkDim,
                       const size_t *GlobalWorkOffset,
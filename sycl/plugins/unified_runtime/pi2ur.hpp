@@ -4452,6 +4452,37 @@ inline pi_result piextKernelSetArgSampler(pi_kernel Kernel, pi_uint32 ArgIndex,
   return PI_SUCCESS;
 }
 
+inline pi_result piextKernelSetArgs(pi_kernel Kernel, pi_uint32 NumArgs,
+                                    const pi_kernel_arg *Args) {
+  PI_ASSERT(Kernel, PI_ERROR_INVALID_KERNEL);
+  PI_ASSERT(NumArgs == 0 || Args, PI_ERROR_INVALID_VALUE);
+
+  for (pi_uint32 I = 0; I < NumArgs; ++I) {
+    const pi_kernel_arg &Arg = Args[I];
+    pi_result Result = PI_ERROR_INVALID_VALUE;
+    switch (Arg.kind) {
+    case PI_KERNEL_ARG_KIND_VALUE:
+      Result = piKernelSetArg(Kernel, Arg.index, Arg.size, Arg.value);
+      break;
+    case PI_KERNEL_ARG_KIND_POINTER:
+      Result = piextKernelSetArgPointer(Kernel, Arg.index, Arg.size, Arg.value);
+      break;
+    case PI_KERNEL_ARG_KIND_MEM_OBJ:
+      Result = piextKernelSetArgMemObj(Kernel, Arg.index,
+                                       Arg.mem_obj_properties,
+                                       static_cast<const pi_mem *>(Arg.value));
+      break;
+    case PI_KERNEL_ARG_KIND_SAMPLER:
+      Result = piextKernelSetArgSampler(
+          Kernel, Arg.index, static_cast<const pi_sampler *>(Arg.value));
+      break;
+    }
+    if (Result != PI_SUCCESS)
+      return Result;
+  }
+  return PI_SUCCESS;
+}
+
 inline pi_result piSamplerRetain(pi_sampler Sampler) {
   PI_ASSERT(Sampler, PI_ERROR_INVALID_SAMPLER);
 
@@ -11,6 +11,7 @@
 // #include "ur/adapters/level_zero/ur_level_zero_common.hpp"
 #include <pi2ur.hpp>
 #include <pi_unified_runtime.hpp>
+#include <ur_ddi.h>
 
 // Stub function to where all not yet supported PI API are bound
 static void DieUnsupported() {
@@ -419,6 +420,11 @@ __SYCL_EXPORT pi_result piextKernelSetArgSampler(pi_kernel Kernel,
   return pi2ur::piextKernelSetArgSampler(Kernel, ArgIndex, ArgValue);
 }
 
+__SYCL_EXPORT pi_result piextKernelSetArgs(pi_kernel Kernel, pi_uint32 NumArgs,
+                                           const pi_kernel_arg *Args) {
+  return pi2ur::piextKernelSetArgs(Kernel, NumArgs, Args);
+}
+
 __SYCL_EXPORT pi_result piKernelGetSubGroupInfo(
     pi_kernel Kernel, pi_device Device, pi_kernel_sub_group_info ParamName,
     size_t InputValueSize, const void *InputValue, size_t ParamValueSize,
@@ -1349,6 +1355,259 @@ __SYCL_EXPORT pi_result piextSignalExternalSemaphore(
       Queue, SemHandle, NumEventsInWaitList, EventWaitList, Event);
 }
 
+// Entry points of Unified Runtime called on the hot paths of the SYCL
+// runtime. They are bound once from the dispatch tables of the loader, which
+// are those of the adapter itself when it is the only one and no layer is
+// enabled. The PI functions below call them directly, skipping the exported
+// loader functions, and only convert the result when it is an error.
+static struct {
+  ur_enqueue_dditable_t Enqueue{};
+  ur_kernel_dditable_t Kernel{};
+  ur_event_dditable_t Event{};
+  ur_queue_dditable_t Queue{};
+  ur_usm_dditable_t USM{};
+} HotDdi;
+
+static bool bindHotDdi() {
+  return urGetEnqueueProcAddrTable(UR_API_VERSION_CURRENT, &HotDdi.Enqueue) ==
+             UR_RESULT_SUCCESS &&
+         urGetKernelProcAddrTable(UR_API_VERSION_CURRENT, &HotDdi.Kernel) ==
+             UR_RESULT_SUCCESS &&
+         urGetEventProcAddrTable(UR_API_VERSION_CURRENT, &HotDdi.Event) ==
+             UR_RESULT_SUCCESS &&
+         urGetQueueProcAddrTable(UR_API_VERSION_CURRENT, &HotDdi.Queue) ==
+             UR_RESULT_SUCCESS &&
+         urGetUSMProcAddrTable(UR_API_VERSION_CURRENT, &HotDdi.USM) ==
+             UR_RESULT_SUCCESS &&
+         HotDdi.Enqueue.pfnKernelLaunch && HotDdi.Enqueue.pfnEventsWait &&
+         HotDdi.Enqueue.pfnEventsWaitWithBarrier &&
+         HotDdi.Enqueue.pfnMemBufferRead && HotDdi.Enqueue.pfnMemBufferWrite &&
+         HotDdi.Enqueue.pfnMemBufferCopy && HotDdi.Enqueue.pfnUSMFill &&
+         HotDdi.Enqueue.pfnUSMMemcpy && HotDdi.Kernel.pfnSetArgValue &&
+         HotDdi.Kernel.pfnSetArgLocal && HotDdi.Kernel.pfnSetArgPointer &&
+         HotDdi.Kernel.pfnRetain && HotDdi.Kernel.pfnRelease &&
+         HotDdi.Event.pfnWait && HotDdi.Event.pfnRetain &&
+         HotDdi.Event.pfnRelease && HotDdi.Queue.pfnFinish &&
+         HotDdi.Queue.pfnFlush && HotDdi.USM.pfnFree;
+}
+
+static inline pi_result hotResult(ur_result_t Result) {
+  return Result == UR_RESULT_SUCCESS ? PI_SUCCESS : ur2piResult(Result);
+}
+
+// The checks of the arguments are those of pi2ur.
+static pi_result
+hotEnqueueKernelLaunch(pi_queue Queue, pi_kernel Kernel, pi_uint32 WorkDim,
+                       const size_t *GlobalWorkOffset,
+                       const size_t *GlobalWorkSize,
+                       const size_t *LocalWorkSize,
+                       pi_uint32 NumEventsInWaitList,
+                       const pi_event *EventsWaitList, pi_event *OutEvent) {
+  PI_ASSERT(Kernel, PI_ERROR_INVALID_KERNEL);
+  PI_ASSERT(Queue, PI_ERROR_INVALID_QUEUE);
+  PI_ASSERT((WorkDim > 0) && (WorkDim < 4), PI_ERROR_INVALID_WORK_DIMENSION);
+  return hotResult(HotDdi.Enqueue.pfnKernelLaunch(
+      reinterpret_cast<ur_queue_handle_t>(Queue),
+      reinterpret_cast<ur_kernel_handle_t>(Kernel), WorkDim, GlobalWorkOffset,
+      GlobalWorkSize, LocalWorkSize, NumEventsInWaitList,
+      reinterpret_cast<const ur_event_handle_t *>(EventsWaitList),
+      reinterpret_cast<ur_event_handle_t *>(OutEvent)));
+}
+
+static pi_result hotKernelSetArg(pi_kernel Kernel, pi_uint32 ArgIndex,
+                                 size_t ArgSize, const void *ArgValue) {
+  PI_ASSERT(Kernel, PI_ERROR_INVALID_KERNEL);
+  ur_kernel_handle_t UrKernel = reinterpret_cast<ur_kernel_handle_t>(Kernel);
+  if (ArgValue)
+    return hotResult(HotDdi.Kernel.pfnSetArgValue(UrKernel, ArgIndex, ArgSize,
+                                                  nullptr, ArgValue));
+  return hotResult(
+      HotDdi.Kernel.pfnSetArgLocal(UrKernel, ArgIndex, ArgSize, nullptr));
+}
+
+static pi_result hotKernelSetArgPointer(pi_kernel Kernel, pi_uint32 ArgIndex,
+                                        size_t, const void *ArgValue) {
+  return hotResult(HotDdi.Kernel.pfnSetArgPointer(
+      reinterpret_cast<ur_kernel_handle_t>(Kernel), ArgIndex, nullptr,
+      ArgValue));
+}
+
+static pi_result hotKernelSetArgs(pi_kernel Kernel, pi_uint32 NumArgs,
+                                  const pi_kernel_arg *Args) {
+  PI_ASSERT(Kernel, PI_ERROR_INVALID_KERNEL);
+  PI_ASSERT(NumArgs == 0 || Args, PI_ERROR_INVALID_VALUE);
+  for (pi_uint32 I = 0; I < NumArgs; ++I) {
+    const pi_kernel_arg &Arg = Args[I];
+    pi_result Result = PI_ERROR_INVALID_VALUE;
+    switch (Arg.kind) {
+    case PI_KERNEL_ARG_KIND_VALUE:
+      Result = hotKernelSetArg(Kernel, Arg.index, Arg.size, Arg.value);
+      break;
+    case PI_KERNEL_ARG_KIND_POINTER:
+      Result = hotKernelSetArgPointer(Kernel, Arg.index, Arg.size, Arg.value);
+      break;
+    default:
+      // The memory objects and samplers take the pi2ur path.
+      Result = pi2ur::piextKernelSetArgs(Kernel, 1, &Arg);
+      break;
+    }
+    if (Result != PI_SUCCESS)
+      return Result;
+  }
+  return PI_SUCCESS;
+}
+
+static pi_result hotKernelRetain(pi_kernel Kernel) {
+  PI_ASSERT(Kernel, PI_ERROR_INVALID_KERNEL);
+  return hotResult(
+      HotDdi.Kernel.pfnRetain(reinterpret_cast<ur_kernel_handle_t>(Kernel)));
+}
+
+static pi_result hotKernelRelease(pi_kernel Kernel) {
+  PI_ASSERT(Kernel, PI_ERROR_INVALID_KERNEL);
+  return hotResult(
+      HotDdi.Kernel.pfnRelease(reinterpret_cast<ur_kernel_handle_t>(Kernel)));
+}
+
+static pi_result hotEventsWait(pi_uint32 NumEvents,
+                               const pi_event *EventsWaitList) {
+  if (NumEvents && !EventsWaitList)
+    return PI_ERROR_INVALID_EVENT;
+  return hotResult(HotDdi.Event.pfnWait(
+      NumEvents, reinterpret_cast<const ur_event_handle_t *>(EventsWaitList)));
+}
+
+static pi_result hotEventRetain(pi_event Event) {
+  PI_ASSERT(Event, PI_ERROR_INVALID_EVENT);
+  return hotResult(
+      HotDdi.Event.pfnRetain(reinterpret_cast<ur_event_handle_t>(Event)));
+}
+
+static pi_result hotEventRelease(pi_event Event) {
+  PI_ASSERT(Event, PI_ERROR_INVALID_EVENT);
+  return hotResult(
+      HotDdi.Event.pfnRelease(reinterpret_cast<ur_event_handle_t>(Event)));
+}
+
+static pi_result hotQueueFinish(pi_queue Queue) {
+  PI_ASSERT(Queue, PI_ERROR_INVALID_QUEUE);
+  return hotResult(
+      HotDdi.Queue.pfnFinish(reinterpret_cast<ur_queue_handle_t>(Queue)));
+}
+
+static pi_result hotQueueFlush(pi_queue Queue) {
+  PI_ASSERT(Queue, PI_ERROR_INVALID_QUEUE);
+  return hotResult(
+      HotDdi.Queue.pfnFlush(reinterpret_cast<ur_queue_handle_t>(Queue)));
+}
+
+static pi_result hotEnqueueEventsWait(pi_queue Queue,
+                                      pi_uint32 NumEventsInWaitList,
+                                      const pi_event *EventsWaitList,
+                                      pi_event *OutEvent) {
+  PI_ASSERT(Queue, PI_ERROR_INVALID_QUEUE);
+  if (EventsWaitList) {
+    PI_ASSERT(NumEventsInWaitList > 0, PI_ERROR_INVALID_VALUE);
+  }
+  return hotResult(HotDdi.Enqueue.pfnEventsWait(
+      reinterpret_cast<ur_queue_handle_t>(Queue), NumEventsInWaitList,
+      reinterpret_cast<const ur_event_handle_t *>(EventsWaitList),
+      reinterpret_cast<ur_event_handle_t *>(OutEvent)));
+}
+
+static pi_result hotEnqueueEventsWaitWithBarrier(pi_queue Queue,
+                                                 pi_uint32 NumEventsInWaitList,
+                                                 const pi_event *EventsWaitList,
+                                                 pi_event *OutEvent) {
+  PI_ASSERT(Queue, PI_ERROR_INVALID_QUEUE);
+  return hotResult(HotDdi.Enqueue.pfnEventsWaitWithBarrier(
+      reinterpret_cast<ur_queue_handle_t>(Queue), NumEventsInWaitList,
+      reinterpret_cast<const ur_event_handle_t *>(EventsWaitList),
+      reinterpret_cast<ur_event_handle_t *>(OutEvent)));
+}
+
+static pi_result hotEnqueueMemBufferRead(pi_queue Queue, pi_mem Src,
+                                         pi_bool BlockingRead, size_t Offset,
+                                         size_t Size, void *Dst,
+                                         pi_uint32 NumEventsInWaitList,
+                                         const pi_event *EventsWaitList,
+                                         pi_event *OutEvent) {
+  PI_ASSERT(Src, PI_ERROR_INVALID_MEM_OBJECT);
+  PI_ASSERT(Queue, PI_ERROR_INVALID_QUEUE);
+  return hotResult(HotDdi.Enqueue.pfnMemBufferRead(
+      reinterpret_cast<ur_queue_handle_t>(Queue),
+      reinterpret_cast<ur_mem_handle_t>(Src), BlockingRead, Offset, Size, Dst,
+      NumEventsInWaitList,
+      reinterpret_cast<const ur_event_handle_t *>(EventsWaitList),
+      reinterpret_cast<ur_event_handle_t *>(OutEvent)));
+}
+
+static pi_result hotEnqueueMemBufferWrite(pi_queue Queue, pi_mem Buffer,
+                                          pi_bool BlockingWrite, size_t Offset,
+                                          size_t Size, const void *Ptr,
+                                          pi_uint32 NumEventsInWaitList,
+                                          const pi_event *EventsWaitList,
+                                          pi_event *OutEvent) {
+  PI_ASSERT(Buffer, PI_ERROR_INVALID_MEM_OBJECT);
+  PI_ASSERT(Queue, PI_ERROR_INVALID_QUEUE);
+  return hotResult(HotDdi.Enqueue.pfnMemBufferWrite(
+      reinterpret_cast<ur_queue_handle_t>(Queue),
+      reinterpret_cast<ur_mem_handle_t>(Buffer), BlockingWrite, Offset, Size,
+      const_cast<void *>(Ptr), NumEventsInWaitList,
+      reinterpret_cast<const ur_event_handle_t *>(EventsWaitList),
+      reinterpret_cast<ur_event_handle_t *>(OutEvent)));
+}
+
+static pi_result hotEnqueueMemBufferCopy(pi_queue Queue, pi_mem SrcMem,
+                                         pi_mem DstMem, size_t SrcOffset,
+                                         size_t DstOffset, size_t Size,
+                                         pi_uint32 NumEventsInWaitList,
+                                         const pi_event *EventsWaitList,
+                                         pi_event *OutEvent) {
+  PI_ASSERT(SrcMem && DstMem, PI_ERROR_INVALID_MEM_OBJECT);
+  PI_ASSERT(Queue, PI_ERROR_INVALID_QUEUE);
+  return hotResult(HotDdi.Enqueue.pfnMemBufferCopy(
+      reinterpret_cast<ur_queue_handle_t>(Queue),
+      reinterpret_cast<ur_mem_handle_t>(SrcMem),
+      reinterpret_cast<ur_mem_handle_t>(DstMem), SrcOffset, DstOffset, Size,
+      NumEventsInWaitList,
+      reinterpret_cast<const ur_event_handle_t *>(EventsWaitList),
+      reinterpret_cast<ur_event_handle_t *>(OutEvent)));
+}
+
+static pi_result hotUSMEnqueueMemset(pi_queue Queue, void *Ptr, pi_int32 Value,
+                                     size_t Count,
+                                     pi_uint32 NumEventsInWaitList,
+                                     const pi_event *EventsWaitList,
+                                     pi_event *OutEvent) {
+  PI_ASSERT(Queue, PI_ERROR_INVALID_QUEUE);
+  if (!Ptr)
+    return PI_ERROR_INVALID_VALUE;
+  return hotResult(HotDdi.Enqueue.pfnUSMFill(
+      reinterpret_cast<ur_queue_handle_t>(Queue), Ptr, 1, &Value, Count,
+      NumEventsInWaitList,
+      reinterpret_cast<const ur_event_handle_t *>(EventsWaitList),
+      reinterpret_cast<ur_event_handle_t *>(OutEvent)));
+}
+
+static pi_result hotUSMEnqueueMemcpy(pi_queue Queue, pi_bool Blocking,
+                                     void *DstPtr, const void *SrcPtr,
+                                     size_t Size,
+                                     pi_uint32 NumEventsInWaitList,
+                                     const pi_event *EventsWaitList,
+                                     pi_event *OutEvent) {
+  return hotResult(HotDdi.Enqueue.pfnUSMMemcpy(
+      reinterpret_cast<ur_queue_handle_t>(Queue), Blocking, DstPtr, SrcPtr,
+      Size, NumEventsInWaitList,
+      reinterpret_cast<const ur_event_handle_t *>(EventsWaitList),
+      reinterpret_cast<ur_event_handle_t *>(OutEvent)));
+}
+
+static pi_result hotUSMFree(pi_context Context, void *Ptr) {
+  return hotResult(
+      HotDdi.USM.pfnFree(reinterpret_cast<ur_context_handle_t>(Context), Ptr));
+}
+
 // This interface is not in Unified Runtime currently
 __SYCL_EXPORT pi_result piPluginInit(pi_plugin *PluginInit) {
   PI_ASSERT(PluginInit, PI_ERROR_INVALID_VALUE);
@@ -1449,6 +1708,7 @@ __SYCL_EXPORT pi_result piPluginInit(pi_plugin *PluginInit) {
   _PI_API(piProgramRelease)
   _PI_API(piextKernelSetArgPointer)
   _PI_API(piextKernelSetArgSampler)
+  _PI_API(piextKernelSetArgs)
   _PI_API(piKernelGetSubGroupInfo)
   _PI_API(piProgramCreateWithBinary)
   _PI_API(piProgramGetInfo)
@@ -1525,6 +1785,33 @@ __SYCL_EXPORT pi_result piPluginInit(pi_plugin *PluginInit) {
 
   _PI_API(piextPluginGetOpaqueData)
   _PI_API(piTearDown)
+#undef _PI_API
+
+  // The hot entry points call the dispatch tables when they could be bound.
+  if (bindHotDdi()) {
+#define _PI_HOT_API(api, hot) (PluginInit->PiFunctionTable).api = &hot;
+    _PI_HOT_API(piEnqueueKernelLaunch, hotEnqueueKernelLaunch)
+    _PI_HOT_API(piKernelSetArg, hotKernelSetArg)
+    _PI_HOT_API(piextKernelSetArgPointer, hotKernelSetArgPointer)
+    _PI_HOT_API(piextKernelSetArgs, hotKernelSetArgs)
+    _PI_HOT_API(piKernelRetain, hotKernelRetain)
+    _PI_HOT_API(piKernelRelease, hotKernelRelease)
+    _PI_HOT_API(piEventsWait, hotEventsWait)
+    _PI_HOT_API(piEventRetain, hotEventRetain)
+    _PI_HOT_API(piEventRelease, hotEventRelease)
+    _PI_HOT_API(piQueueFinish, hotQueueFinish)
+    _PI_HOT_API(piQueueFlush, hotQueueFlush)
+    _PI_HOT_API(piEnqueueEventsWait, hotEnqueueEventsWait)
+    _PI_HOT_API(piEnqueueEventsWaitWithBarrier,
+                hotEnqueueEventsWaitWithBarrier)
+    _PI_HOT_API(piEnqueueMemBufferRead, hotEnqueueMemBufferRead)
+    _PI_HOT_API(piEnqueueMemBufferWrite, hotEnqueueMemBufferWrite)
+    _PI_HOT_API(piEnqueueMemBufferCopy, hotEnqueueMemBufferCopy)
+    _PI_HOT_API(piextUSMEnqueueMemset, hotUSMEnqueueMemset)
+    _PI_HOT_API(piextUSMEnqueueMemcpy, hotUSMEnqueueMemcpy)
+    _PI_HOT_API(piextUSMFree, hotUSMFree)
+#undef _PI_HOT_API
+  }
 
   return PI_SUCCESS;
 }
@@ -9,7 +9,7 @@
 
 // This version should be incremented for any change made to this file or its
 // corresponding .cpp file.
-#define _PI_UNIFIED_RUNTIME_PLUGIN_VERSION 1
+#define _PI_UNIFIED_RUNTIME_PLUGIN_VERSION 3
 
 #define _PI_UNIFIED_RUNTIME_PLUGIN_VERSION_STRING                              \
   _PI_PLUGIN_VERSION_STRING(_PI_UNIFIED_RUNTIME_PLUGIN_VERSION)
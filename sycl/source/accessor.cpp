@@ -6,6 +6,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <detail/object_pool.hpp>
 #include <detail/queue_impl.hpp>
 #include <detail/sycl_mem_obj_t.hpp>
 #include <sycl/accessor.hpp>
@@ -29,10 +30,10 @@ AccessorBaseHost::AccessorBaseHost(id<3> Offset, range<3> AccessRange,
                                    int Dims, int ElemSize, int OffsetInBytes,
                                    bool IsSubBuffer,
                                    const property_list &PropertyList) {
-  impl = std::shared_ptr<AccessorImplHost>(
-      new AccessorImplHost(Offset, AccessRange, MemoryRange, AccessMode,
-                           (detail::SYCLMemObjI *)SYCLMemObject, Dims, ElemSize,
-                           false, OffsetInBytes, IsSubBuffer, PropertyList));
+  impl = makeSharedPooled<AccessorImplHost>(
+      Offset, AccessRange, MemoryRange, AccessMode,
+      (detail::SYCLMemObjI *)SYCLMemObject, Dims, ElemSize, false,
+      OffsetInBytes, IsSubBuffer, PropertyList);
 }
 
 // TODO: the following function to be removed during next ABI break window
@@ -42,10 +43,10 @@ AccessorBaseHost::AccessorBaseHost(id<3> Offset, range<3> AccessRange,
                                    int Dims, int ElemSize, bool IsPlaceH,
                                    int OffsetInBytes, bool IsSubBuffer,
                                    const property_list &PropertyList) {
-  impl = std::shared_ptr<AccessorImplHost>(
-      new AccessorImplHost(Offset, AccessRange, MemoryRange, AccessMode,
-                           (detail::SYCLMemObjI *)SYCLMemObject, Dims, ElemSize,
-                           IsPlaceH, OffsetInBytes, IsSubBuffer, PropertyList));
+  impl = makeSharedPooled<AccessorImplHost>(
+      Offset, AccessRange, MemoryRange, AccessMode,
+      (detail::SYCLMemObjI *)SYCLMemObject, Dims, ElemSize, IsPlaceH,
+      OffsetInBytes, IsSubBuffer, PropertyList);
 }
 
 AccessorBaseHost::AccessorBaseHost(id<3> Offset, range<3> AccessRange,
@@ -54,10 +55,10 @@ AccessorBaseHost::AccessorBaseHost(id<3> Offset, range<3> AccessRange,
                                    int Dims, int ElemSize, size_t OffsetInBytes,
                                    bool IsSubBuffer,
                                    const property_list &PropertyList) {
-  impl = std::shared_ptr<AccessorImplHost>(
-      new AccessorImplHost(Offset, AccessRange, MemoryRange, AccessMode,
-                           (detail::SYCLMemObjI *)SYCLMemObject, Dims, ElemSize,
-                           false, OffsetInBytes, IsSubBuffer, PropertyList));
+  impl = makeSharedPooled<AccessorImplHost>(
+      Offset, AccessRange, MemoryRange, AccessMode,
+      (detail::SYCLMemObjI *)SYCLMemObject, Dims, ElemSize, false,
+      OffsetInBytes, IsSubBuffer, PropertyList);
 }
 
 AccessorBaseHost::AccessorBaseHost(id<3> Offset, range<3> AccessRange,
@@ -66,10 +67,10 @@ AccessorBaseHost::AccessorBaseHost(id<3> Offset, range<3> AccessRange,
                                    int Dims, int ElemSize, bool IsPlaceH,
                                    size_t OffsetInBytes, bool IsSubBuffer,
                                    const property_list &PropertyList) {
-  impl = std::shared_ptr<AccessorImplHost>(
-      new AccessorImplHost(Offset, AccessRange, MemoryRange, AccessMode,
-                           (detail::SYCLMemObjI *)SYCLMemObject, Dims, ElemSize,
-                           IsPlaceH, OffsetInBytes, IsSubBuffer, PropertyList));
+  impl = makeSharedPooled<AccessorImplHost>(
+      Offset, AccessRange, MemoryRange, AccessMode,
+      (detail::SYCLMemObjI *)SYCLMemObject, Dims, ElemSize, IsPlaceH,
+      OffsetInBytes, IsSubBuffer, PropertyList);
 }
 
 id<3> &AccessorBaseHost::getOffset() { return impl->MOffset; }
@@ -107,8 +108,8 @@ bool AccessorBaseHost::isMemoryObjectUsedByGraph() const {
 LocalAccessorBaseHost::LocalAccessorBaseHost(
     sycl::range<3> Size, int Dims, int ElemSize,
     const property_list &PropertyList) {
-  impl = std::shared_ptr<LocalAccessorImplHost>(
-      new LocalAccessorImplHost(Size, Dims, ElemSize, PropertyList));
+  impl = makeSharedPooled<LocalAccessorImplHost>(Size, Dims, ElemSize,
+                                                 PropertyList);
 }
 sycl::range<3> &LocalAccessorBaseHost::getSize() { return impl->MSize; }
 const sycl::range<3> &LocalAccessorBaseHost::getSize() const {
@@ -140,6 +141,11 @@ UnsampledImageAccessorBaseHost::UnsampledImageAccessorBaseHost(
     sycl::range<3> Size, access_mode AccessMode, void *SYCLMemObject, int Dims,
     int ElemSize, id<3> Pitch, image_channel_type ChannelType,
     image_channel_order ChannelOrder, const property_list &PropertyList) {
+  // The previous contents of the image are not needed by a write accessor with
+  // the no_init property.
+  if (AccessMode == access_mode::write &&
+      PropertyList.has_property<property::no_init>())
+    AccessMode = access_mode::discard_write;
   impl = std::make_shared<UnsampledImageAccessorImplHost>(
       Size, AccessMode, (detail::SYCLMemObjI *)SYCLMemObject, Dims, ElemSize,
       Pitch, ChannelType, ChannelOrder, PropertyList);
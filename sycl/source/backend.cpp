@@ -100,8 +100,9 @@ __SYCL_EXPORT context make_context(pi_native_handle NativeHandle,
   Plugin->call<PiApiKind::piextContextCreateWithNativeHandle>(
       NativeHandle, 0, nullptr, false, &PiContext);
   // Construct the SYCL context from PI context.
-  return detail::createSyclObjFromImpl<context>(
-      std::make_shared<context_impl>(PiContext, Handler, Plugin));
+  auto ContextImpl = std::make_shared<context_impl>(PiContext, Handler, Plugin);
+  context_impl::preloadDeviceImages(ContextImpl);
+  return detail::createSyclObjFromImpl<context>(ContextImpl);
 }
 
 __SYCL_EXPORT queue make_queue(pi_native_handle NativeHandle,
@@ -55,9 +55,11 @@ __SYCL_EXPORT context make_context(const std::vector<device> &DeviceList,
       NativeHandle, DeviceHandles.size(), DeviceHandles.data(), !KeepOwnership,
       &PiContext);
   // Construct the SYCL context from PI context.
-  return detail::createSyclObjFromImpl<context>(
+  auto ContextImpl =
       std::make_shared<context_impl>(PiContext, detail::defaultAsyncHandler,
-                                     Plugin, DeviceList, !KeepOwnership));
+                                     Plugin, DeviceList, !KeepOwnership);
+  context_impl::preloadDeviceImages(ContextImpl);
+  return detail::createSyclObjFromImpl<context>(ContextImpl);
 }
 
 //----------------------------------------------------------------------------
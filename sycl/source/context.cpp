@@ -81,12 +81,14 @@ context::context(const std::vector<device> &DeviceList,
       impl = std::make_shared<detail::context_impl>(DeviceList, AsyncHandler,
                                                     PropList);
   }
+  detail::context_impl::preloadDeviceImages(impl);
 }
 context::context(cl_context ClContext, async_handler AsyncHandler) {
   const auto &Plugin = sycl::detail::pi::getPlugin<backend::opencl>();
   impl = std::make_shared<detail::context_impl>(
       detail::pi::cast<sycl::detail::pi::PiContext>(ClContext), AsyncHandler,
       Plugin);
+  detail::context_impl::preloadDeviceImages(impl);
 }
 
 template <typename Param>
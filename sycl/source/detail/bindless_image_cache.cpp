@@ -0,0 +1,83 @@
+//==------- bindless_image_cache.cpp - Bindless image handles cache --------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/bindless_image_cache.hpp>
+#include <detail/context_impl.hpp>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+
+pi_image_handle bindless_image_cache::acquireImage(
+    const image_key &Key, const std::function<pi_image_handle()> &Create) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  auto It = MImages.find(Key);
+  if (It != MImages.end()) {
+    ++It->second.MRefCount;
+    return It->second.MHandle;
+  }
+  pi_image_handle Handle = Create();
+  It = MImages.emplace(Key, image_entry{Handle, 1}).first;
+  MHandles[{std::get<0>(Key), Handle}] = It;
+  return Handle;
+}
+
+bool bindless_image_cache::releaseImage(sycl::detail::pi::PiDevice Device,
+                                        pi_image_handle Handle) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  auto It = MHandles.find({Device, Handle});
+  if (It == MHandles.end())
+    return true;
+  if (--It->second->second.MRefCount > 0)
+    return false;
+  MImages.erase(It->second);
+  MHandles.erase(It);
+  return true;
+}
+
+void bindless_image_cache::forgetMemory(const void *Memory) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  for (auto It = MHandles.begin(); It != MHandles.end();) {
+    if (std::get<1>(It->second->first) != Memory) {
+      ++It;
+      continue;
+    }
+    MImages.erase(It->second);
+    It = MHandles.erase(It);
+  }
+}
+
+sycl::detail::pi::PiSampler bindless_image_cache::getSampler(
+    const sampler_key &Key,
+    const std::function<sycl::detail::pi::PiSampler()> &Create) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  sycl::detail::pi::PiSampler &Sampler = MSamplers[Key];
+  if (!Sampler) {
+    try {
+      Sampler = Create();
+    } catch (...) {
+      MSamplers.erase(Key);
+      throw;
+    }
+  }
+  return Sampler;
+}
+
+void bindless_image_cache::clear() {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  for (auto &Sampler : MSamplers)
+    MContext->getPlugin()->call_nocheck<PiApiKind::piSamplerRelease>(
+        Sampler.second);
+  MSamplers.clear();
+  MImages.clear();
+  MHandles.clear();
+}
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
@@ -0,0 +1,91 @@
+//==------- bindless_image_cache.hpp - Bindless image handles cache --------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sycl/detail/pi.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+class context_impl;
+
+/// Bindless image handles and samplers of a context. The handles created for
+/// the same image, i.e. the same memory viewed with the same descriptor and
+/// sampler, are shared by the create_image calls and destroyed when the last
+/// of them is destroyed. The samplers are shared by all the sampled images
+/// with the same sampling parameters and released with the context.
+class bindless_image_cache {
+public:
+  /// The device and the memory of an image, and the parameters of its
+  /// descriptor, format and sampler.
+  using image_key = std::tuple<sycl::detail::pi::PiDevice, const void *,
+                               std::vector<uint64_t>>;
+  /// The parameters of a sampler.
+  using sampler_key = std::vector<uint64_t>;
+
+  bindless_image_cache() = default;
+  bindless_image_cache(const bindless_image_cache &) = delete;
+  bindless_image_cache &operator=(const bindless_image_cache &) = delete;
+
+  void setContextPtr(const context_impl *Context) { MContext = Context; }
+
+  /// Gets the handle of an image and takes a reference to it.
+  ///
+  /// \param Create creates the handle if the image has none.
+  pi_image_handle acquireImage(const image_key &Key,
+                               const std::function<pi_image_handle()> &Create);
+
+  /// Drops a reference to the handle of an image of Device.
+  ///
+  /// \return true if the handle must be destroyed, i.e. this was its last
+  /// reference or the handle is not in the cache.
+  bool releaseImage(sycl::detail::pi::PiDevice Device, pi_image_handle Handle);
+
+  /// Removes the handles of the images of Memory, which is freed, from the
+  /// cache. They are still destroyed by releaseImage.
+  void forgetMemory(const void *Memory);
+
+  /// Gets the sampler with the parameters Key.
+  ///
+  /// \param Create creates the sampler if there is none, owned by the cache.
+  sycl::detail::pi::PiSampler
+  getSampler(const sampler_key &Key,
+             const std::function<sycl::detail::pi::PiSampler()> &Create);
+
+  /// Releases the samplers. Must be called before the native context is
+  /// released.
+  void clear();
+
+private:
+  struct image_entry {
+    pi_image_handle MHandle;
+    size_t MRefCount;
+  };
+  using image_map = std::map<image_key, image_entry>;
+
+  const context_impl *MContext = nullptr;
+  image_map MImages;
+  /// Images by device and handle
+  std::map<std::pair<sycl::detail::pi::PiDevice, pi_image_handle>,
+           image_map::iterator>
+      MHandles;
+  std::map<sampler_key, sycl::detail::pi::PiSampler> MSamplers;
+  std::mutex MMutex;
+};
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
@@ -6,6 +6,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <sycl/bit_cast.hpp>
 #include <sycl/detail/common.hpp>
 #include <sycl/detail/pi.hpp>
 #include <sycl/ext/oneapi/bindless_images.hpp>
@@ -16,7 +17,9 @@
 #include <detail/plugin_printers.hpp>
 #include <detail/queue_impl.hpp>
 
+#include <iterator>
 #include <memory>
+#include <vector>
 
 namespace sycl {
 inline namespace _V1 {
@@ -54,6 +57,20 @@ void populate_pi_structs(const image_descriptor &desc, pi_image_desc &piDesc,
       sycl::detail::convertChannelOrder(desc.channel_order);
 }
 
+// Parameters of an image in the keys of the bindless image cache.
+std::vector<uint64_t> getImageParams(const pi_image_desc &piDesc,
+                                     const pi_image_format &piFormat) {
+  return {piDesc.image_type,
+          piDesc.image_width,
+          piDesc.image_height,
+          piDesc.image_depth,
+          piDesc.image_array_size,
+          piDesc.image_row_pitch,
+          piDesc.num_mip_levels,
+          piFormat.image_channel_order,
+          piFormat.image_channel_data_type};
+}
+
 detail::image_mem_impl::image_mem_impl(const image_descriptor &desc,
                                        const device &syclDevice,
                                        const context &syclContext)
@@ -118,6 +135,9 @@ __SYCL_EXPORT void destroy_image_handle(unsampled_image_handle &imageHandle,
   const sycl::detail::PluginPtr &Plugin = CtxImpl->getPlugin();
   pi_image_handle piImageHandle = imageHandle.raw_handle;
 
+  // The handle may be shared by several create_image calls.
+  if (!CtxImpl->getBindlessImageCache().releaseImage(Device, piImageHandle))
+    return;
   Plugin->call<sycl::errc::runtime,
                sycl::detail::PiApiKind::piextMemUnsampledImageHandleDestroy>(
       C, Device, piImageHandle);
@@ -141,6 +161,9 @@ __SYCL_EXPORT void destroy_image_handle(sampled_image_handle &imageHandle,
   const sycl::detail::PluginPtr &Plugin = CtxImpl->getPlugin();
   pi_image_handle piImageHandle = imageHandle.raw_handle;
 
+  // The handle may be shared by several create_image calls.
+  if (!CtxImpl->getBindlessImageCache().releaseImage(Device, piImageHandle))
+    return;
   Plugin->call<sycl::errc::runtime,
                sycl::detail::PiApiKind::piextMemSampledImageHandleDestroy>(
       C, Device, piImageHandle);
@@ -261,6 +284,7 @@ __SYCL_EXPORT void free_image_mem(image_mem_handle memHandle,
   const sycl::detail::PluginPtr &Plugin = CtxImpl->getPlugin();
 
   if (memHandle.raw_handle != nullptr) {
+    CtxImpl->getBindlessImageCache().forgetMemory(memHandle.raw_handle);
     if (imageType == image_type::mipmap) {
       Plugin->call<sycl::errc::memory_allocation,
                    sycl::detail::PiApiKind::piextMemMipmapFree>(
@@ -356,13 +380,19 @@ create_image(image_mem_handle memHandle, const image_descriptor &desc,
   pi_image_format piFormat;
   populate_pi_structs(desc, piDesc, piFormat);
 
-  // Call impl.
-  pi_image_handle piImageHandle;
-  pi_mem piImage;
-  Plugin->call<sycl::errc::runtime,
-               sycl::detail::PiApiKind::piextMemUnsampledImageCreate>(
-      C, Device, memHandle.raw_handle, &piFormat, &piDesc, &piImage,
-      &piImageHandle);
+  // Call impl, unless the image already has a handle.
+  pi_image_handle piImageHandle =
+      CtxImpl->getBindlessImageCache().acquireImage(
+          {Device, memHandle.raw_handle, getImageParams(piDesc, piFormat)},
+          [&] {
+            pi_image_handle Handle;
+            pi_mem piImage;
+            Plugin->call<sycl::errc::runtime,
+                         sycl::detail::PiApiKind::piextMemUnsampledImageCreate>(
+                C, Device, memHandle.raw_handle, &piFormat, &piDesc, &piImage,
+                &Handle);
+            return Handle;
+          });
 
   return unsampled_image_handle{piImageHandle};
 }
@@ -433,23 +463,43 @@ create_image(void *devPtr, size_t pitch, const bindless_image_sampler &sampler,
       static_cast<pi_sampler_properties>(sampler.mipmap_filtering),
       0};
 
-  pi_sampler piSampler = {};
-  Plugin->call<sycl::errc::runtime,
-               sycl::detail::PiApiKind::piextBindlessImageSamplerCreate>(
-      C, sProps, sampler.min_mipmap_level_clamp, sampler.max_mipmap_level_clamp,
-      sampler.max_anisotropy, &piSampler);
+  // The samplers are shared by the images, and released with the context.
+  std::vector<uint64_t> samplerParams(std::begin(sProps), std::end(sProps));
+  samplerParams.push_back(
+      sycl::bit_cast<uint32_t>(sampler.min_mipmap_level_clamp));
+  samplerParams.push_back(
+      sycl::bit_cast<uint32_t>(sampler.max_mipmap_level_clamp));
+  samplerParams.push_back(sycl::bit_cast<uint32_t>(sampler.max_anisotropy));
+  sycl::detail::bindless_image_cache &Cache =
+      CtxImpl->getBindlessImageCache();
+  pi_sampler piSampler = Cache.getSampler(samplerParams, [&] {
+    pi_sampler Sampler = {};
+    Plugin->call<sycl::errc::runtime,
+                 sycl::detail::PiApiKind::piextBindlessImageSamplerCreate>(
+        C, sProps, sampler.min_mipmap_level_clamp,
+        sampler.max_mipmap_level_clamp, sampler.max_anisotropy, &Sampler);
+    return Sampler;
+  });
 
   pi_image_desc piDesc;
   pi_image_format piFormat;
   populate_pi_structs(desc, piDesc, piFormat, pitch);
 
-  // Call impl.
-  pi_mem piImage;
-  pi_image_handle piImageHandle;
-  Plugin->call<sycl::errc::runtime,
-               sycl::detail::PiApiKind::piextMemSampledImageCreate>(
-      C, Device, devPtr, &piFormat, &piDesc, piSampler, &piImage,
-      &piImageHandle);
+  // Call impl, unless the image already has a handle. The sampler parameters
+  // follow the image ones in the key, which is then longer than the keys of
+  // the unsampled images.
+  std::vector<uint64_t> params = getImageParams(piDesc, piFormat);
+  params.insert(params.end(), samplerParams.begin(), samplerParams.end());
+  pi_image_handle piImageHandle =
+      Cache.acquireImage({Device, devPtr, std::move(params)}, [&] {
+        pi_mem piImage;
+        pi_image_handle Handle;
+        Plugin->call<sycl::errc::runtime,
+                     sycl::detail::PiApiKind::piextMemSampledImageCreate>(
+            C, Device, devPtr, &piFormat, &piDesc, piSampler, &piImage,
+            &Handle);
+        return Handle;
+      });
 
   return sampled_image_handle{piImageHandle};
 }
@@ -51,6 +51,15 @@ public:
       throw sycl::invalid_object_error(
           "The use_host_ptr property requires host pointer to be provided",
           PI_ERROR_INVALID_OPERATION);
+
+    if (BaseT::isZeroCopy()) {
+      if (Props.has_property<
+              sycl::ext::oneapi::property::buffer::use_pinned_host_memory>())
+        throw sycl::invalid_object_error(
+            "The zero_copy property cannot be used with use_pinned_host_memory",
+            PI_ERROR_INVALID_OPERATION);
+      BaseT::handleZeroCopyHostMem();
+    }
   }
 
   buffer_impl(void *HostData, size_t SizeInBytes, size_t RequiredAlign,
@@ -64,7 +73,7 @@ public:
           "The use_pinned_host_memory cannot be used with host pointer",
           PI_ERROR_INVALID_OPERATION);
 
-    BaseT::handleHostData(HostData, RequiredAlign);
+    BaseT::handleHostData(HostData, getHostDataAlignment(RequiredAlign));
   }
 
   buffer_impl(const void *HostData, size_t SizeInBytes, size_t RequiredAlign,
@@ -78,7 +87,7 @@ public:
           "The use_pinned_host_memory cannot be used with host pointer",
           PI_ERROR_INVALID_OPERATION);
 
-    BaseT::handleHostData(HostData, RequiredAlign);
+    BaseT::handleHostData(HostData, getHostDataAlignment(RequiredAlign));
   }
 
   buffer_impl(const std::shared_ptr<const void> &HostData,
@@ -94,7 +103,7 @@ public:
           PI_ERROR_INVALID_OPERATION);
 
     BaseT::handleHostData(std::const_pointer_cast<void>(HostData),
-                          RequiredAlign, IsConstPtr);
+                          getHostDataAlignment(RequiredAlign), IsConstPtr);
   }
 
   buffer_impl(const std::function<void(void *)> &CopyFromInput,
@@ -109,7 +118,8 @@ public:
           "The use_pinned_host_memory cannot be used with host pointer",
           PI_ERROR_INVALID_OPERATION);
 
-    BaseT::handleHostData(CopyFromInput, RequiredAlign, IsConstPtr);
+    BaseT::handleHostData(CopyFromInput, getHostDataAlignment(RequiredAlign),
+                          IsConstPtr);
   }
 
   template <typename T>
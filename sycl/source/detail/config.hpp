@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstdlib>
 #include <mutex>
 #include <string>
@@ -198,11 +199,12 @@ template <> class SYCLConfig<SYCL_PARALLEL_FOR_RANGE_ROUNDING_PARAMS> {
 
 private:
 public:
-  static void GetSettings(size_t &MinFactor, size_t &GoodFactor,
+  /// \return true if the parameters have been set by the user.
+  static bool GetSettings(size_t &MinFactor, size_t &GoodFactor,
                           size_t &MinRange) {
     static const char *RoundParams = BaseT::getRawValue();
     if (RoundParams == nullptr)
-      return;
+      return false;
 
     static bool ProcessedFactors = false;
     static size_t MF;
@@ -228,6 +230,7 @@ public:
     MinFactor = MF;
     GoodFactor = GF;
     MinRange = MR;
+    return true;
   }
 };
 
@@ -441,6 +444,45 @@ private:
   }
 };
 
+/// On-disk layout of the persistent device code cache.
+enum class PersistentCacheLayout {
+  /// A directory per cache item with a file per binary and per key source.
+  Directory,
+  /// A single index file plus an append-only blob store.
+  Indexed
+};
+
+template <> class SYCLConfig<SYCL_CACHE_LAYOUT> {
+  using BaseT = SYCLConfigBase<SYCL_CACHE_LAYOUT>;
+
+public:
+  static PersistentCacheLayout get() { return getCachedValue(); }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static PersistentCacheLayout parseValue() {
+    const char *ValStr = BaseT::getRawValue();
+    if (!ValStr || !strcmp(ValStr, "directory"))
+      return PersistentCacheLayout::Directory;
+    if (!strcmp(ValStr, "indexed"))
+      return PersistentCacheLayout::Indexed;
+    throw invalid_parameter_error(
+        "Invalid value for SYCL_CACHE_LAYOUT environment variable: value "
+        "should be either \"directory\" or \"indexed\"",
+        PI_ERROR_INVALID_VALUE);
+  }
+
+  static PersistentCacheLayout getCachedValue(bool ResetCache = false) {
+    static PersistentCacheLayout Val = parseValue();
+    if (ResetCache)
+      Val = parseValue();
+    return Val;
+  }
+};
+
 template <> class SYCLConfig<SYCL_REDUCTION_PREFERRED_WORKGROUP_SIZE> {
   using BaseT = SYCLConfigBase<SYCL_REDUCTION_PREFERRED_WORKGROUP_SIZE>;
 
@@ -616,6 +658,797 @@ private:
   }
 };
 
+template <> class SYCLConfig<SYCL_IN_ORDER_QUEUE_FAST_PATH> {
+  using BaseT = SYCLConfigBase<SYCL_IN_ORDER_QUEUE_FAST_PATH>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+// If enabled, all the device images compatible with the devices of a newly
+// created context are built concurrently by the host task thread pool. The
+// build errors are reported to the async handler of the context.
+template <> class SYCLConfig<SYCL_PRELOAD_KERNELS> {
+  using BaseT = SYCLConfigBase<SYCL_PRELOAD_KERNELS>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+// Limit in bytes of the device code kept in the in-memory program cache. Zero
+// means that the cache is not limited.
+template <> class SYCLConfig<SYCL_CACHE_IN_MEM_MAX_SIZE> {
+  using BaseT = SYCLConfigBase<SYCL_CACHE_IN_MEM_MAX_SIZE>;
+
+public:
+  static size_t get() { return getCachedValue(); }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static size_t parseValue() {
+    const char *ValStr = BaseT::getRawValue();
+    if (!ValStr)
+      return 0;
+    try {
+      return std::stoull(ValStr);
+    } catch (...) {
+      throw invalid_parameter_error(
+          "Invalid value for SYCL_CACHE_IN_MEM_MAX_SIZE environment "
+          "variable: value should be a number",
+          PI_ERROR_INVALID_VALUE);
+    }
+  }
+
+  static size_t getCachedValue(bool ResetCache = false) {
+    static size_t Val = parseValue();
+    if (ResetCache)
+      Val = parseValue();
+    return Val;
+  }
+};
+
+// Number of cross-queue dependencies on the commands of a queue that are
+// coalesced into a single flush of the queue. Values up to one mean that the
+// queue is flushed for every dependency.
+template <> class SYCLConfig<SYCL_CROSS_QUEUE_FLUSH_BATCH_SIZE> {
+  using BaseT = SYCLConfigBase<SYCL_CROSS_QUEUE_FLUSH_BATCH_SIZE>;
+
+public:
+  static size_t get() { return getCachedValue(); }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static size_t parseValue() {
+    const char *ValStr = BaseT::getRawValue();
+    if (!ValStr)
+      return 1;
+    try {
+      return std::stoull(ValStr);
+    } catch (...) {
+      throw invalid_parameter_error(
+          "Invalid value for SYCL_CROSS_QUEUE_FLUSH_BATCH_SIZE environment "
+          "variable: value should be a number",
+          PI_ERROR_INVALID_VALUE);
+    }
+  }
+
+  static size_t getCachedValue(bool ResetCache = false) {
+    static size_t Val = parseValue();
+    if (ResetCache)
+      Val = parseValue();
+    return Val;
+  }
+};
+
+// Maximum time in microseconds a flush for cross-queue dependencies can be
+// deferred by SYCL_CROSS_QUEUE_FLUSH_BATCH_SIZE. Zero means that the time is
+// not limited.
+template <> class SYCLConfig<SYCL_CROSS_QUEUE_FLUSH_WINDOW_US> {
+  using BaseT = SYCLConfigBase<SYCL_CROSS_QUEUE_FLUSH_WINDOW_US>;
+
+public:
+  static std::chrono::microseconds get() {
+    return std::chrono::microseconds(getCachedValue());
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static size_t parseValue() {
+    const char *ValStr = BaseT::getRawValue();
+    if (!ValStr)
+      return 0;
+    try {
+      return std::stoull(ValStr);
+    } catch (...) {
+      throw invalid_parameter_error(
+          "Invalid value for SYCL_CROSS_QUEUE_FLUSH_WINDOW_US environment "
+          "variable: value should be a number",
+          PI_ERROR_INVALID_VALUE);
+    }
+  }
+
+  static size_t getCachedValue(bool ResetCache = false) {
+    static size_t Val = parseValue();
+    if (ResetCache)
+      Val = parseValue();
+    return Val;
+  }
+};
+
+// If enabled, the commands that are ready for cleanup are released in batches
+// by a background thread instead of the thread that made them ready.
+template <> class SYCLConfig<SYCL_BACKGROUND_COMMAND_CLEANUP> {
+  using BaseT = SYCLConfigBase<SYCL_BACKGROUND_COMMAND_CLEANUP>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+// If enabled, host tasks that only depend on enqueued device events and don't
+// access memory objects are run on the thread pool without being added to the
+// execution graph. Commands that depend on such host tasks wait for them when
+// they are enqueued.
+template <> class SYCLConfig<SYCL_HOST_TASK_SCHEDULER_BYPASS> {
+  using BaseT = SYCLConfigBase<SYCL_HOST_TASK_SCHEDULER_BYPASS>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+// If enabled, the runtime collects histograms of its host-side overheads, e.g.
+// submission latency, and reports them to stderr and to the XPTI metrics
+// stream at exit.
+template <> class SYCLConfig<SYCL_METRICS_DUMP> {
+  using BaseT = SYCLConfigBase<SYCL_METRICS_DUMP>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+// If enabled, the small device and shared USM allocations of all the contexts
+// are sub-allocated from larger backend allocations, as with the usm_pooling
+// context property.
+template <> class SYCLConfig<SYCL_USM_POOLING> {
+  using BaseT = SYCLConfigBase<SYCL_USM_POOLING>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+// Copies between pageable host memory and buffers larger than a staging
+// buffer are staged through pinned host buffers, unless disabled by setting
+// this to 0.
+template <> class SYCLConfig<SYCL_HOST_STAGING_BUFFERS> {
+  using BaseT = SYCLConfigBase<SYCL_HOST_STAGING_BUFFERS>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = true;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+// Size in bytes from which the copies are split into chunks enqueued to
+// several native queues, for all the queues. Zero or unset means that only the
+// copies of the queues with the split_large_copies property are split, from
+// the default threshold.
+template <> class SYCLConfig<SYCL_COPY_SPLIT_THRESHOLD> {
+  using BaseT = SYCLConfigBase<SYCL_COPY_SPLIT_THRESHOLD>;
+
+public:
+  static size_t get() { return getCachedValue(); }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static size_t parseValue() {
+    const char *ValStr = BaseT::getRawValue();
+    if (!ValStr)
+      return 0;
+    try {
+      return std::stoull(ValStr);
+    } catch (...) {
+      throw invalid_parameter_error(
+          "Invalid value for SYCL_COPY_SPLIT_THRESHOLD environment variable: "
+          "value should be a number",
+          PI_ERROR_INVALID_VALUE);
+    }
+  }
+
+  static size_t getCachedValue(bool ResetCache = false) {
+    static size_t Val = parseValue();
+    if (ResetCache)
+      Val = parseValue();
+    return Val;
+  }
+};
+
+// Size in bytes up to which the USM copies and memsets that only access host
+// memory are done by the host thread submitting them, when they would not have
+// to wait for other commands. Zero or unset disables this.
+template <> class SYCLConfig<SYCL_HOST_MEMOP_THRESHOLD> {
+  using BaseT = SYCLConfigBase<SYCL_HOST_MEMOP_THRESHOLD>;
+
+public:
+  static size_t get() { return getCachedValue(); }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static size_t parseValue() {
+    const char *ValStr = BaseT::getRawValue();
+    if (!ValStr)
+      return 0;
+    try {
+      return std::stoull(ValStr);
+    } catch (...) {
+      throw invalid_parameter_error(
+          "Invalid value for SYCL_HOST_MEMOP_THRESHOLD environment variable: "
+          "value should be a number",
+          PI_ERROR_INVALID_VALUE);
+    }
+  }
+
+  static size_t getCachedValue(bool ResetCache = false) {
+    static size_t Val = parseValue();
+    if (ResetCache)
+      Val = parseValue();
+    return Val;
+  }
+};
+
+// Setting this to 1 prefetches the shared USM allocations passed as arguments
+// to kernels to the device running them, before the launch.
+template <> class SYCLConfig<SYCL_USM_AUTO_PREFETCH> {
+  using BaseT = SYCLConfigBase<SYCL_USM_AUTO_PREFETCH>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+// Setting this to 1 times a few work-group sizes on the first launches of
+// each kernel over a sycl::range and uses the fastest one for the following
+// launches. Only the launches on queues with profiling enabled are timed.
+template <> class SYCLConfig<SYCL_WG_AUTOTUNE> {
+  using BaseT = SYCLConfigBase<SYCL_WG_AUTOTUNE>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+template <> class SYCLConfig<SYCL_ENABLE_ASYNC_FUSION> {
+  using BaseT = SYCLConfigBase<SYCL_ENABLE_ASYNC_FUSION>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+template <> class SYCLConfig<SYCL_JIT_SPEC_CONSTANTS> {
+  using BaseT = SYCLConfigBase<SYCL_JIT_SPEC_CONSTANTS>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+template <> class SYCLConfig<SYCL_JIT_LAZY_KERNELS> {
+  using BaseT = SYCLConfigBase<SYCL_JIT_LAZY_KERNELS>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+template <> class SYCLConfig<SYCL_SHARE_PROGRAM_BUILDS> {
+  using BaseT = SYCLConfigBase<SYCL_SHARE_PROGRAM_BUILDS>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+// Maximum number of idle copies of the cached kernels kept per context. The
+// copies are made for the launches of a kernel which is in use by another
+// thread, 0 disables them.
+template <> class SYCLConfig<SYCL_CACHE_KERNEL_CLONES> {
+  using BaseT = SYCLConfigBase<SYCL_CACHE_KERNEL_CLONES>;
+
+public:
+  static size_t get() { return getCachedValue(); }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static size_t parseValue() {
+    const char *ValStr = BaseT::getRawValue();
+    if (!ValStr)
+      return 64;
+    try {
+      return std::stoull(ValStr);
+    } catch (...) {
+      throw invalid_parameter_error(
+          "Invalid value for SYCL_CACHE_KERNEL_CLONES environment "
+          "variable: value should be a number",
+          PI_ERROR_INVALID_VALUE);
+    }
+  }
+
+  static size_t getCachedValue(bool ResetCache = false) {
+    static size_t Val = parseValue();
+    if (ResetCache)
+      Val = parseValue();
+    return Val;
+  }
+};
+
+// The arguments set on the cached kernels are remembered, so that the next
+// launches only set the changed ones, unless disabled by setting this to 0.
+template <> class SYCLConfig<SYCL_CACHE_KERNEL_ARGS> {
+  using BaseT = SYCLConfigBase<SYCL_CACHE_KERNEL_ARGS>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = true;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+// The contexts created for the same devices share their backend context if
+// this is set to 1.
+template <> class SYCLConfig<SYCL_SHARE_BACKEND_CONTEXTS> {
+  using BaseT = SYCLConfigBase<SYCL_SHARE_BACKEND_CONTEXTS>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+// The range kernels submitted to a queue on a composite device are split
+// across its component devices if this is set to 1.
+template <> class SYCLConfig<SYCL_COMPOSITE_IMPLICIT_SCALING> {
+  using BaseT = SYCLConfigBase<SYCL_COMPOSITE_IMPLICIT_SCALING>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+// Enqueues the memory moves the scheduler inserts for buffers to a separate
+// native queue of the device, so that they overlap with the kernels.
+template <> class SYCLConfig<SYCL_BUFFER_COPY_QUEUE> {
+  using BaseT = SYCLConfigBase<SYCL_BUFFER_COPY_QUEUE>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
+// Size in bytes of the arena the runtime reserves for the device heap of a
+// device in a context.
+template <> class SYCLConfig<SYCL_DEVICE_HEAP_SIZE> {
+  using BaseT = SYCLConfigBase<SYCL_DEVICE_HEAP_SIZE>;
+
+public:
+  static size_t get() { return getCachedValue(); }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static size_t parseValue() {
+    const char *ValStr = BaseT::getRawValue();
+    if (!ValStr)
+      return size_t{64} << 20;
+    try {
+      return std::stoull(ValStr);
+    } catch (...) {
+      throw invalid_parameter_error(
+          "Invalid value for SYCL_DEVICE_HEAP_SIZE environment "
+          "variable: value should be a number",
+          PI_ERROR_INVALID_VALUE);
+    }
+  }
+
+  static size_t getCachedValue(bool ResetCache = false) {
+    static size_t Val = parseValue();
+    if (ResetCache)
+      Val = parseValue();
+    return Val;
+  }
+};
+
+// The commands of different queues unblocked together, e.g. by the completion
+// of a host task, are enqueued in parallel by the host task thread pool if
+// set to 1.
+template <> class SYCLConfig<SYCL_PARALLEL_UNBLOCKED_ENQUEUE> {
+  using BaseT = SYCLConfigBase<SYCL_PARALLEL_UNBLOCKED_ENQUEUE>;
+
+public:
+  static bool get() {
+    constexpr bool DefaultValue = false;
+
+    const char *ValStr = getCachedValue();
+
+    if (!ValStr)
+      return DefaultValue;
+
+    return ValStr[0] == '1';
+  }
+
+  static void reset() { (void)getCachedValue(/*ResetCache=*/true); }
+
+  static const char *getName() { return BaseT::MConfigName; }
+
+private:
+  static const char *getCachedValue(bool ResetCache = false) {
+    static const char *ValStr = BaseT::getRawValue();
+    if (ResetCache)
+      ValStr = BaseT::getRawValue();
+    return ValStr;
+  }
+};
+
 #undef INVALID_CONFIG_EXCEPTION
 
 } // namespace detail
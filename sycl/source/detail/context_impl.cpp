@@ -7,27 +7,39 @@
 // ===--------------------------------------------------------------------=== //
 
 #include <detail/context_impl.hpp>
+#include <detail/config.hpp>
 #include <detail/context_info.hpp>
 #include <detail/event_info.hpp>
+#include <detail/mem_alloc_helper.hpp>
 #include <detail/platform_impl.hpp>
 #include <detail/queue_impl.hpp>
+#include <detail/usm/memory_pool_impl.hpp>
+#include <detail/usm/usm_impl.hpp>
 #include <sycl/detail/common.hpp>
 #include <sycl/detail/cuda_definitions.hpp>
 #include <sycl/detail/pi.hpp>
 #include <sycl/device.hpp>
 #include <sycl/exception.hpp>
 #include <sycl/exception_list.hpp>
+#include <sycl/ext/oneapi/experimental/device_heap.hpp>
 #include <sycl/info/info_desc.hpp>
 #include <sycl/platform.hpp>
 #include <sycl/properties/context_properties.hpp>
 #include <sycl/property_list.hpp>
 
 #include <algorithm>
+#include <limits>
 
 namespace sycl {
 inline namespace _V1 {
 namespace detail {
 
+static bool isUSMPoolingEnabled(const property_list &PropList) {
+  return SYCLConfig<SYCL_USM_POOLING>::get() ||
+         PropList.has_property<
+             ext::oneapi::experimental::property::context::usm_pooling>();
+}
+
 context_impl::context_impl(const device &Device, async_handler AsyncHandler,
                            const property_list &PropList)
     : MOwnedByRuntime(true), MAsyncHandler(AsyncHandler), MDevices(1, Device),
@@ -37,6 +49,12 @@ context_impl::context_impl(const device &Device, async_handler AsyncHandler,
       MHostContext(detail::getSyclObjImpl(Device)->is_host()),
       MSupportBufferLocationByDevices(NotChecked) {
   MKernelProgramCache.setContextPtr(this);
+  MHostStagingPool.setContextPtr(this);
+  MBindlessImageCache.setContextPtr(this);
+  MUSMSlabAllocator.setContextPtr(
+      this, !MHostContext && isUSMPoolingEnabled(MPropList));
+  MUSMPrefetchAdvisor.setContextPtr(
+      this, !MHostContext && SYCLConfig<SYCL_USM_AUTO_PREFETCH>::get());
 }
 
 context_impl::context_impl(const std::vector<sycl::device> Devices,
@@ -63,23 +81,45 @@ context_impl::context_impl(const std::vector<sycl::device> Devices,
     DeviceIds.push_back(getSyclObjImpl(D)->getHandleRef());
   }
 
-  if (getBackend() == backend::ext_oneapi_cuda) {
-    const bool UseCUDAPrimaryContext = MPropList.has_property<
-        ext::oneapi::cuda::property::context::use_primary_context>();
-    const pi_context_properties Props[] = {
-        static_cast<pi_context_properties>(
-            __SYCL_PI_CONTEXT_PROPERTIES_CUDA_PRIMARY),
-        static_cast<pi_context_properties>(UseCUDAPrimaryContext), 0};
-
-    getPlugin()->call<PiApiKind::piContextCreate>(
-        Props, DeviceIds.size(), DeviceIds.data(), nullptr, nullptr, &MContext);
-  } else {
-    getPlugin()->call<PiApiKind::piContextCreate>(nullptr, DeviceIds.size(),
-                                                  DeviceIds.data(), nullptr,
-                                                  nullptr, &MContext);
-  }
+  const bool UseCUDAPrimaryContext =
+      getBackend() == backend::ext_oneapi_cuda &&
+      MPropList.has_property<
+          ext::oneapi::cuda::property::context::use_primary_context>();
+  auto CreateContext = [&]() {
+    sycl::detail::pi::PiContext Context = nullptr;
+    if (getBackend() == backend::ext_oneapi_cuda) {
+      const pi_context_properties Props[] = {
+          static_cast<pi_context_properties>(
+              __SYCL_PI_CONTEXT_PROPERTIES_CUDA_PRIMARY),
+          static_cast<pi_context_properties>(UseCUDAPrimaryContext), 0};
+
+      getPlugin()->call<PiApiKind::piContextCreate>(
+          Props, DeviceIds.size(), DeviceIds.data(), nullptr, nullptr,
+          &Context);
+    } else {
+      getPlugin()->call<PiApiKind::piContextCreate>(nullptr, DeviceIds.size(),
+                                                    DeviceIds.data(), nullptr,
+                                                    nullptr, &Context);
+    }
+    return Context;
+  };
+  // The contexts for the same devices may share their backend context. The
+  // SYCL-level state, e.g. the async handler, the properties, the caches and
+  // the device_global allocations, stays per context.
+  MSharesBackendContext = SYCLConfig<SYCL_SHARE_BACKEND_CONTEXTS>::get();
+  if (MSharesBackendContext)
+    MContext = MPlatform->acquireSharedContext(
+        DeviceIds, static_cast<pi_context_properties>(UseCUDAPrimaryContext),
+        CreateContext);
+  else
+    MContext = CreateContext();
 
   MKernelProgramCache.setContextPtr(this);
+  MHostStagingPool.setContextPtr(this);
+  MBindlessImageCache.setContextPtr(this);
+  MUSMSlabAllocator.setContextPtr(this, isUSMPoolingEnabled(MPropList));
+  MUSMPrefetchAdvisor.setContextPtr(this,
+                                    SYCLConfig<SYCL_USM_AUTO_PREFETCH>::get());
 }
 
 context_impl::context_impl(sycl::detail::pi::PiContext PiContext,
@@ -129,6 +169,11 @@ context_impl::context_impl(sycl::detail::pi::PiContext PiContext,
     getPlugin()->call<PiApiKind::piContextRetain>(MContext);
   }
   MKernelProgramCache.setContextPtr(this);
+  MHostStagingPool.setContextPtr(this);
+  MBindlessImageCache.setContextPtr(this);
+  MUSMSlabAllocator.setContextPtr(this, isUSMPoolingEnabled(MPropList));
+  MUSMPrefetchAdvisor.setContextPtr(this,
+                                    SYCLConfig<SYCL_USM_AUTO_PREFETCH>::get());
 }
 
 cl_context context_impl::get() const {
@@ -145,6 +190,11 @@ cl_context context_impl::get() const {
 bool context_impl::is_host() const { return MHostContext; }
 
 context_impl::~context_impl() {
+  // Free the memory of the default pools while the context is valid.
+  MAsyncAllocPools.clear();
+  MDefaultMemoryPools.clear();
+  for (auto &Arena : MDeviceHeapArenas)
+    usm::freeInternal(Arena.second.first, this);
   // Free all events associated with the initialization of device globals.
   for (auto &DeviceGlobalInitializer : MDeviceGlobalInitializers)
     DeviceGlobalInitializer.second.ClearEvents(getPlugin());
@@ -160,15 +210,125 @@ context_impl::~context_impl() {
     getPlugin()->call<PiApiKind::piProgramRelease>(LibProg.second);
   }
   if (!MHostContext) {
+    for (auto &SpecConstsBuffer : MSpecConstsBuffers)
+      memReleaseHelper(getPlugin(), SpecConstsBuffer.second);
+    MUSMSlabAllocator.release();
+    MHostStagingPool.clear();
+    MBindlessImageCache.clear();
     // TODO catch an exception and put it to list of asynchronous exceptions
-    getPlugin()->call_nocheck<PiApiKind::piContextRelease>(MContext);
+    if (MSharesBackendContext)
+      MPlatform->releaseSharedContext(MContext);
+    else
+      getPlugin()->call_nocheck<PiApiKind::piContextRelease>(MContext);
   }
 }
 
+context_impl::MemoryPoolImplPtr
+context_impl::getDefaultMemoryPool(const DeviceImplPtr &Device,
+                                   sycl::usm::alloc Kind) {
+  std::lock_guard<std::mutex> Lock(MMemoryPoolsMutex);
+  MemoryPoolImplPtr &Pool = MDefaultMemoryPools[{Device.get(), Kind}];
+  if (!Pool)
+    Pool = std::make_shared<
+        ext::oneapi::experimental::detail::memory_pool_impl>(
+        *this, Device, Kind, std::numeric_limits<size_t>::max(),
+        /*ContextOwner=*/nullptr);
+  return Pool;
+}
+
+std::pair<void *, size_t> context_impl::getDeviceHeapArena(
+    const DeviceImplPtr &Device,
+    const std::function<void(void *, size_t)> &Zero) {
+  std::lock_guard<std::mutex> Lock(MDeviceHeapArenasMutex);
+  auto It = MDeviceHeapArenas.find(Device.get());
+  if (It != MDeviceHeapArenas.end())
+    return It->second;
+  const size_t Size = SYCLConfig<SYCL_DEVICE_HEAP_SIZE>::get();
+  void *Arena = usm::alignedAllocInternal(
+      ext::oneapi::experimental::device_heap::alignment, Size, this,
+      Device.get(), sycl::usm::alloc::device);
+  if (!Arena)
+    throw sycl::exception(make_error_code(errc::memory_allocation),
+                          "Cannot allocate the arena of the device heap.");
+  try {
+    Zero(Arena, Size);
+  } catch (...) {
+    usm::freeInternal(Arena, this);
+    throw;
+  }
+  return MDeviceHeapArenas[Device.get()] = {Arena, Size};
+}
+
+void context_impl::addAsyncAllocation(const void *Ptr,
+                                      const MemoryPoolImplPtr &Pool) {
+  std::lock_guard<std::mutex> Lock(MMemoryPoolsMutex);
+  MAsyncAllocPools[Ptr] = Pool;
+}
+
+context_impl::MemoryPoolImplPtr
+context_impl::takeAsyncAllocation(const void *Ptr) {
+  std::lock_guard<std::mutex> Lock(MMemoryPoolsMutex);
+  auto It = MAsyncAllocPools.find(Ptr);
+  if (It == MAsyncAllocPools.end())
+    return nullptr;
+  MemoryPoolImplPtr Pool = It->second.lock();
+  MAsyncAllocPools.erase(It);
+  return Pool;
+}
+
+RTDeviceBinaryImage *context_impl::selectBinImage(
+    std::vector<RTDeviceBinaryImage *> Images,
+    sycl::detail::pi::PiDevice Device,
+    const std::function<RTDeviceBinaryImage *(
+        const std::vector<RTDeviceBinaryImage *> &)> &Select) {
+  std::lock_guard<std::mutex> Lock(MSelectedBinImagesMutex);
+  auto It =
+      MSelectedBinImages.try_emplace({std::move(Images), Device}, nullptr)
+          .first;
+  if (!It->second)
+    It->second = Select(It->first.first);
+  return It->second;
+}
+
+sycl::detail::pi::PiMem
+context_impl::getSpecConstsBuffer(const std::vector<unsigned char> &Blob) {
+  std::lock_guard<std::mutex> Lock(MSpecConstsBuffersMutex);
+  auto It = MSpecConstsBuffers.try_emplace(Blob, nullptr).first;
+  if (!It->second) {
+    try {
+      memBufferCreateHelper(
+          getPlugin(), MContext,
+          PI_MEM_FLAGS_ACCESS_RW | PI_MEM_FLAGS_HOST_PTR_COPY, Blob.size(),
+          const_cast<unsigned char *>(It->first.data()), &It->second, nullptr);
+    } catch (...) {
+      MSpecConstsBuffers.erase(It);
+      throw;
+    }
+  }
+  return It->second;
+}
+
 const async_handler &context_impl::get_async_handler() const {
   return MAsyncHandler;
 }
 
+void context_impl::reportAsyncException(
+    const std::exception_ptr &ExceptionPtr) const {
+  if (!MAsyncHandler)
+    return;
+  exception_list Exceptions;
+  Exceptions.PushBack(ExceptionPtr);
+  MAsyncHandler(std::move(Exceptions));
+}
+
+void context_impl::preloadDeviceImages(
+    const std::shared_ptr<context_impl> &Self) {
+  if (Self->is_host() || !SYCLConfig<SYCL_PRELOAD_KERNELS>::get())
+    return;
+  ProgramManager::getInstance().preloadDeviceImages(
+      createSyclObjFromImpl<context>(Self), Self->getDevices());
+}
+
 template <>
 uint32_t context_impl::get_info<info::context::reference_count>() const {
   if (is_host())
@@ -426,13 +586,19 @@ std::vector<sycl::detail::pi::PiEvent> context_impl::initializeDeviceGlobals(
     // list.
     InitEventsRef.reserve(DeviceGlobalEntries.size());
 
+    // Get or allocate the USM memory associated with the device globals. The
+    // device globals allocated here share an allocation and are initialized
+    // together.
+    std::vector<DeviceGlobalUSMMem *> DeviceGlobalUSMs =
+        DeviceGlobalMapEntry::getOrAllocateDeviceGlobalUSM(DeviceGlobalEntries,
+                                                           QueueImpl);
+
     // Device global map entry pointers will not die before the end of the
     // program and the pointers will stay the same, so we do not need
     // m_DeviceGlobalsMutex here.
-    for (DeviceGlobalMapEntry *DeviceGlobalEntry : DeviceGlobalEntries) {
-      // Get or allocate the USM memory associated with the device global.
-      DeviceGlobalUSMMem &DeviceGlobalUSM =
-          DeviceGlobalEntry->getOrAllocateDeviceGlobalUSM(QueueImpl);
+    for (size_t I = 0; I < DeviceGlobalEntries.size(); ++I) {
+      DeviceGlobalMapEntry *DeviceGlobalEntry = DeviceGlobalEntries[I];
+      DeviceGlobalUSMMem &DeviceGlobalUSM = *DeviceGlobalUSMs[I];
 
       // If the device global still has a initialization event it should be
       // added to the initialization events list. Since initialization events
@@ -7,26 +7,37 @@
 //===----------------------------------------------------------------------===//
 
 #pragma once
+#include <detail/bindless_image_cache.hpp>
 #include <detail/device_impl.hpp>
+#include <detail/host_staging_pool.hpp>
 #include <detail/kernel_program_cache.hpp>
 #include <detail/platform_impl.hpp>
 #include <detail/program_manager/program_manager.hpp>
+#include <detail/usm/usm_allocation_tracker.hpp>
+#include <detail/usm/usm_prefetch_advisor.hpp>
+#include <detail/usm/usm_slab_allocator.hpp>
 #include <sycl/detail/common.hpp>
 #include <sycl/detail/os_util.hpp>
 #include <sycl/detail/pi.hpp>
 #include <sycl/exception_list.hpp>
 #include <sycl/info/info_desc.hpp>
 #include <sycl/property_list.hpp>
+#include <sycl/usm/usm_enums.hpp>
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <optional>
 #include <set>
+#include <unordered_map>
 
 namespace sycl {
 inline namespace _V1 {
 // Forward declaration
 class device;
+namespace ext::oneapi::experimental::detail {
+class memory_pool_impl;
+} // namespace ext::oneapi::experimental::detail
 namespace detail {
 using PlatformImplPtr = std::shared_ptr<detail::platform_impl>;
 class context_impl {
@@ -107,6 +118,18 @@ public:
   /// \return an instance of SYCL async_handler.
   const async_handler &get_async_handler() const;
 
+  /// Passes an asynchronous exception which is not tied to a queue to the
+  /// async handler.
+  ///
+  /// \param ExceptionPtr is a pointer to exception to be passed.
+  void reportAsyncException(const std::exception_ptr &ExceptionPtr) const;
+
+  /// Starts building the device images compatible with the devices of the
+  /// context in the background if SYCL_PRELOAD_KERNELS is set.
+  ///
+  /// \param Self is the context to preload the images for.
+  static void preloadDeviceImages(const std::shared_ptr<context_impl> &Self);
+
   /// \return the Plugin associated with the platform of this context.
   const PluginPtr &getPlugin() const { return MPlatform->getPlugin(); }
 
@@ -171,6 +194,29 @@ public:
 
   KernelProgramCache &getKernelProgramCache() const;
 
+  /// Gets the allocator pooling the small USM allocations of the context.
+  usm_slab_allocator &getUSMSlabAllocator() const {
+    return MUSMSlabAllocator;
+  }
+
+  /// Gets the live USM allocations made through the SYCL API.
+  usm_allocation_tracker &getUSMAllocationTracker() const {
+    return MUSMAllocationTracker;
+  }
+
+  /// Gets the prefetcher of the USM allocations passed to kernels.
+  usm_prefetch_advisor &getUSMPrefetchAdvisor() const {
+    return MUSMPrefetchAdvisor;
+  }
+
+  /// Gets the pinned host buffers staging the copies of buffers.
+  host_staging_pool &getHostStagingPool() const { return MHostStagingPool; }
+
+  /// Gets the shared bindless image handles and samplers.
+  bindless_image_cache &getBindlessImageCache() const {
+    return MBindlessImageCache;
+  }
+
   /// Returns true if and only if context contains the given device.
   bool hasDevice(std::shared_ptr<detail::device_impl> Device) const;
 
@@ -254,6 +300,50 @@ public:
 
   bool isOwnedByRuntime() { return MOwnedByRuntime; };
 
+  using MemoryPoolImplPtr =
+      std::shared_ptr<ext::oneapi::experimental::detail::memory_pool_impl>;
+
+  /// Gets the pool used by async_malloc() for the allocations of a kind on a
+  /// device, creating it on first use.
+  MemoryPoolImplPtr getDefaultMemoryPool(const DeviceImplPtr &Device,
+                                         sycl::usm::alloc Kind);
+
+  /// Gets the arena of the device heap of a device, allocating it of
+  /// SYCL_DEVICE_HEAP_SIZE bytes on first use.
+  /// \param Zero zeroes a new arena of a size.
+  std::pair<void *, size_t>
+  getDeviceHeapArena(const DeviceImplPtr &Device,
+                     const std::function<void(void *, size_t)> &Zero);
+
+  /// Records the pool an asynchronous allocation was made from.
+  void addAsyncAllocation(const void *Ptr, const MemoryPoolImplPtr &Pool);
+
+  /// Removes an asynchronous allocation from the records.
+  /// \return the pool it was made from, or null if the allocation is not
+  /// known or its pool has been destroyed.
+  MemoryPoolImplPtr takeAsyncAllocation(const void *Ptr);
+
+  /// Gets the image selected by the native runtime for a device of the
+  /// context among the images of a kernel. The kernels of a binary with
+  /// several targets mostly have the same images, so that the selection is
+  /// only made once for all of them.
+  ///
+  /// \param Images are the images of the kernel, sorted by address.
+  /// \param Select selects the image the first time.
+  RTDeviceBinaryImage *selectBinImage(
+      std::vector<RTDeviceBinaryImage *> Images,
+      sycl::detail::pi::PiDevice Device,
+      const std::function<RTDeviceBinaryImage *(
+          const std::vector<RTDeviceBinaryImage *> &)> &Select);
+
+  /// Gets the buffer passing the values of emulated specialization constants
+  /// to the kernels. The device images with the same values share a buffer,
+  /// which is owned by the context.
+  ///
+  /// \param Blob is the values of the specialization constants.
+  sycl::detail::pi::PiMem
+  getSpecConstsBuffer(const std::vector<unsigned char> &Blob);
+
   enum PropertySupport { NotSupported = 0, Supported = 1, NotChecked = 2 };
 
 private:
@@ -264,9 +354,17 @@ private:
   PlatformImplPtr MPlatform;
   property_list MPropList;
   bool MHostContext;
+  // True if the backend context is shared with the other contexts created for
+  // the same devices.
+  bool MSharesBackendContext = false;
   CachedLibProgramsT MCachedLibPrograms;
   std::mutex MCachedLibProgramsMutex;
   mutable KernelProgramCache MKernelProgramCache;
+  mutable usm_slab_allocator MUSMSlabAllocator;
+  mutable usm_prefetch_advisor MUSMPrefetchAdvisor;
+  mutable usm_allocation_tracker MUSMAllocationTracker;
+  mutable host_staging_pool MHostStagingPool;
+  mutable bindless_image_cache MBindlessImageCache;
   mutable PropertySupport MSupportBufferLocationByDevices;
 
   std::set<const void *> MAssociatedDeviceGlobals;
@@ -318,6 +416,31 @@ private:
            std::unique_ptr<std::byte[]>>
       MDeviceGlobalUnregisteredData;
   std::mutex MDeviceGlobalUnregisteredDataMutex;
+
+  // Pools are not kept alive by their allocations. The ones created by the
+  // user own the context, which would otherwise never be released if the
+  // memory is not freed.
+  std::map<std::pair<const device_impl *, sycl::usm::alloc>, MemoryPoolImplPtr>
+      MDefaultMemoryPools;
+  std::unordered_map<
+      const void *,
+      std::weak_ptr<ext::oneapi::experimental::detail::memory_pool_impl>>
+      MAsyncAllocPools;
+  std::mutex MMemoryPoolsMutex;
+
+  // Arenas of the device heaps, freed with the context.
+  std::map<const device_impl *, std::pair<void *, size_t>> MDeviceHeapArenas;
+  std::mutex MDeviceHeapArenasMutex;
+
+  std::map<std::pair<std::vector<RTDeviceBinaryImage *>,
+                     sycl::detail::pi::PiDevice>,
+           RTDeviceBinaryImage *>
+      MSelectedBinImages;
+  std::mutex MSelectedBinImagesMutex;
+
+  std::map<std::vector<unsigned char>, sycl::detail::pi::PiMem>
+      MSpecConstsBuffers;
+  std::mutex MSpecConstsBuffersMutex;
 };
 
 template <typename T, typename Capabilities>
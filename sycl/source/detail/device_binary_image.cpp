@@ -8,6 +8,11 @@
 
 #include <detail/device_binary_image.hpp>
 #include <sycl/detail/pi.hpp>
+#include <sycl/exception.hpp>
+
+#ifdef SYCL_RT_ZSTD_AVAILABLE
+#include <zstd.h>
+#endif
 
 #include <algorithm>
 #include <cstring>
@@ -214,6 +219,48 @@ DynRTDeviceBinaryImage::~DynRTDeviceBinaryImage() {
   Bin = nullptr;
 }
 
+CompressedRTDeviceBinaryImage::CompressedRTDeviceBinaryImage(
+    pi_device_binary CompressedBin)
+    : RTDeviceBinaryImage(),
+      MBinCopy(std::make_unique<pi_device_binary_struct>(*CompressedBin)) {
+  init(MBinCopy.get());
+}
+
+void CompressedRTDeviceBinaryImage::decompress() {
+  std::call_once(MDecompressFlag, [this]() {
+#ifdef SYCL_RT_ZSTD_AVAILABLE
+    const size_t CompressedSize = getSize();
+    const unsigned long long DataSize =
+        ZSTD_getFrameContentSize(Bin->BinaryStart, CompressedSize);
+    if (DataSize == ZSTD_CONTENTSIZE_ERROR ||
+        DataSize == ZSTD_CONTENTSIZE_UNKNOWN)
+      throw sycl::exception(make_error_code(errc::runtime),
+                            "Malformed compressed device image");
+
+    std::unique_ptr<char[]> Data(new char[DataSize]);
+    const size_t Res = ZSTD_decompress(Data.get(), DataSize, Bin->BinaryStart,
+                                       CompressedSize);
+    if (ZSTD_isError(Res) || Res != DataSize)
+      throw sycl::exception(make_error_code(errc::runtime),
+                            std::string("Failed to decompress device image: ") +
+                                ZSTD_getErrorName(Res));
+
+    MDecompressedData = std::move(Data);
+    // The format recorded in the descriptor is left as is, since other threads
+    // may be inspecting it while selecting images.
+    MBinCopy->BinaryStart =
+        reinterpret_cast<const unsigned char *>(MDecompressedData.get());
+    MBinCopy->BinaryEnd = MBinCopy->BinaryStart + DataSize;
+    Format.store(pi::getBinaryImageFormat(MBinCopy->BinaryStart, DataSize),
+                 std::memory_order_release);
+#else
+    throw sycl::exception(make_error_code(errc::feature_not_supported),
+                          "Compressed device images are not supported, as the "
+                          "SYCL runtime is built without zstd");
+#endif
+  });
+}
+
 } // namespace detail
 } // namespace _V1
 } // namespace sycl
@@ -14,6 +14,7 @@
 #include <atomic>
 #include <cstring>
 #include <memory>
+#include <mutex>
 
 namespace sycl {
 inline namespace _V1 {
@@ -171,7 +172,9 @@ public:
   /// Returns the format of the binary image
   pi::PiDeviceBinaryType getFormat() const {
     assert(Bin && "binary image data not set");
-    return Format;
+    // Pairs with the store of the decompressed image format, so that the
+    // decompressed data is visible once its format is.
+    return Format.load(std::memory_order_acquire);
   }
 
   /// Returns a single property from SYCL_MISC_PROP category.
@@ -229,7 +232,9 @@ protected:
 
   pi_device_binary Bin;
 
-  pi::PiDeviceBinaryType Format = PI_DEVICE_BINARY_TYPE_NONE;
+  // Atomic, as it is changed once a compressed image is decompressed while
+  // other threads may be selecting images.
+  std::atomic<pi::PiDeviceBinaryType> Format = PI_DEVICE_BINARY_TYPE_NONE;
   RTDeviceBinaryImage::PropertyRange SpecConstIDMap;
   RTDeviceBinaryImage::PropertyRange SpecConstDefaultValuesMap;
   RTDeviceBinaryImage::PropertyRange DeviceLibReqMask;
@@ -262,6 +267,31 @@ protected:
   std::unique_ptr<char[]> Data;
 };
 
+// Device binary image compressed by the offload wrapper. The properties are
+// available right away, while the binary data is only decompressed on first
+// use, so that images which are never used do not occupy memory.
+class CompressedRTDeviceBinaryImage : public RTDeviceBinaryImage {
+public:
+  CompressedRTDeviceBinaryImage(pi_device_binary CompressedBin);
+
+  /// Decompresses the binary data unless it is already done. Until then the
+  /// image format is PI_DEVICE_BINARY_TYPE_COMPRESSED_NONE and the binary
+  /// data is the compressed one. Thread-safe.
+  void decompress();
+
+  void print() const override {
+    RTDeviceBinaryImage::print();
+    std::cerr << "    COMPRESSED\n";
+  }
+
+protected:
+  // Copy of the descriptor from the fat binary, which points to the
+  // decompressed data once it is available.
+  std::unique_ptr<pi_device_binary_struct> MBinCopy;
+  std::unique_ptr<char[]> MDecompressedData;
+  std::once_flag MDecompressFlag;
+};
+
 } // namespace detail
 } // namespace _V1
 } // namespace sycl
@@ -13,10 +13,26 @@
 #include <detail/queue_impl.hpp>
 #include <detail/usm/usm_impl.hpp>
 
+#include <algorithm>
+#include <cstring>
+
 namespace sycl {
 inline namespace _V1 {
 namespace detail {
 
+struct DeviceGlobalUSMBlock {
+  DeviceGlobalUSMBlock(void *Ptr, const context_impl *CtxImpl,
+                       std::vector<unsigned char> InitData)
+      : MPtr(Ptr), MCtxImpl(CtxImpl), MInitData(std::move(InitData)) {}
+  ~DeviceGlobalUSMBlock() { detail::usm::freeInternal(MPtr, MCtxImpl); }
+
+  void *MPtr;
+  const context_impl *MCtxImpl;
+  // The initial values of the device_globals, the source of the
+  // initialization copy.
+  std::vector<unsigned char> MInitData;
+};
+
 DeviceGlobalUSMMem::~DeviceGlobalUSMMem() {
   // removeAssociatedResources is expected to have cleaned up both the pointer
   // and the event. When asserts are enabled the values are set, so we check
@@ -89,6 +105,99 @@ DeviceGlobalUSMMem &DeviceGlobalMapEntry::getOrAllocateDeviceGlobalUSM(
   return NewAlloc;
 }
 
+std::vector<DeviceGlobalUSMMem *>
+DeviceGlobalMapEntry::getOrAllocateDeviceGlobalUSM(
+    const std::vector<DeviceGlobalMapEntry *> &Entries,
+    const std::shared_ptr<queue_impl> &QueueImpl) {
+  const std::shared_ptr<context_impl> &CtxImpl = QueueImpl->getContextImplPtr();
+  const std::shared_ptr<device_impl> &DevImpl = QueueImpl->getDeviceImplPtr();
+  const auto Key = std::make_pair(DevImpl.get(), CtxImpl.get());
+
+  std::vector<DeviceGlobalUSMMem *> USMMems(Entries.size(), nullptr);
+  std::vector<size_t> Unallocated;
+  for (size_t I = 0; I < Entries.size(); ++I) {
+    std::lock_guard<std::mutex> Lock(Entries[I]->MDeviceToUSMPtrMapMutex);
+    auto DGUSMPtr = Entries[I]->MDeviceToUSMPtrMap.find(Key);
+    if (DGUSMPtr != Entries[I]->MDeviceToUSMPtrMap.end())
+      USMMems[I] = &DGUSMPtr->second;
+    else
+      Unallocated.push_back(I);
+  }
+
+  if (Unallocated.size() < 2) {
+    for (size_t I : Unallocated)
+      USMMems[I] = &Entries[I]->getOrAllocateDeviceGlobalUSM(QueueImpl);
+    return USMMems;
+  }
+
+  // The alignment of a type divides its size, so the lowest set bit of the
+  // size is a valid alignment for the device_global. Laying the
+  // device_globals out by decreasing alignment needs no padding, and their
+  // offsets are as aligned as the allocation, which has the same default
+  // alignment as the allocation of a single device_global.
+  auto GetAlignment = [&](size_t I) {
+    std::uint32_t Size = Entries[I]->MDeviceGlobalTSize;
+    return Size & (~Size + 1);
+  };
+  std::stable_sort(Unallocated.begin(), Unallocated.end(),
+                   [&](size_t LHS, size_t RHS) {
+                     return GetAlignment(LHS) > GetAlignment(RHS);
+                   });
+  std::vector<size_t> Offsets;
+  Offsets.reserve(Unallocated.size());
+  size_t BlockSize = 0;
+  for (size_t I : Unallocated) {
+    Offsets.push_back(BlockSize);
+    BlockSize += Entries[I]->MDeviceGlobalTSize;
+  }
+
+  // Gather the initial values, which are right after the usm_ptr member of
+  // the device_globals, to initialize them all by a single copy.
+  std::vector<unsigned char> InitData(BlockSize);
+  for (size_t J = 0; J < Unallocated.size(); ++J) {
+    const DeviceGlobalMapEntry *Entry = Entries[Unallocated[J]];
+    std::memcpy(InitData.data() + Offsets[J],
+                reinterpret_cast<const void *>(
+                    reinterpret_cast<uintptr_t>(Entry->MDeviceGlobalPtr) +
+                    sizeof(Entry->MDeviceGlobalPtr)),
+                Entry->MDeviceGlobalTSize);
+  }
+
+  void *BlockPtr = detail::usm::alignedAllocInternal(
+      0, BlockSize, CtxImpl.get(), DevImpl.get(), sycl::usm::alloc::device);
+  auto Block = std::make_shared<DeviceGlobalUSMBlock>(BlockPtr, CtxImpl.get(),
+                                                      std::move(InitData));
+  sycl::detail::pi::PiEvent InitEvent;
+  MemoryManager::copy_usm(Block->MInitData.data(), QueueImpl, BlockSize,
+                          BlockPtr, std::vector<sycl::detail::pi::PiEvent>{},
+                          &InitEvent);
+
+  const PluginPtr &Plugin = CtxImpl->getPlugin();
+  for (size_t J = 0; J < Unallocated.size(); ++J) {
+    DeviceGlobalMapEntry *Entry = Entries[Unallocated[J]];
+    std::lock_guard<std::mutex> Lock(Entry->MDeviceToUSMPtrMapMutex);
+    // The device_global may have been allocated by another thread in the
+    // meantime, in which case its part of the block is left unused.
+    auto NewAllocIt = Entry->MDeviceToUSMPtrMap.emplace(
+        std::piecewise_construct, std::forward_as_tuple(Key),
+        std::forward_as_tuple(static_cast<unsigned char *>(BlockPtr) +
+                                  Offsets[J],
+                              Block));
+    DeviceGlobalUSMMem &USMMem = NewAllocIt.first->second;
+    USMMems[Unallocated[J]] = &USMMem;
+    if (!NewAllocIt.second)
+      continue;
+    {
+      std::lock_guard<std::mutex> EventLock(USMMem.MInitEventMutex);
+      Plugin->call<PiApiKind::piEventRetain>(InitEvent);
+      USMMem.MInitEvent = InitEvent;
+    }
+    CtxImpl->addAssociatedDeviceGlobal(Entry->MDeviceGlobalPtr);
+  }
+  Plugin->call<PiApiKind::piEventRelease>(InitEvent);
+  return USMMems;
+}
+
 void DeviceGlobalMapEntry::removeAssociatedResources(
     const context_impl *CtxImpl) {
   std::lock_guard<std::mutex> Lock{MDeviceToUSMPtrMapMutex};
@@ -97,7 +206,11 @@ void DeviceGlobalMapEntry::removeAssociatedResources(
         MDeviceToUSMPtrMap.find({getSyclObjImpl(Device).get(), CtxImpl});
     if (USMPtrIt != MDeviceToUSMPtrMap.end()) {
       DeviceGlobalUSMMem &USMMem = USMPtrIt->second;
-      detail::usm::freeInternal(USMMem.MPtr, CtxImpl);
+      // A shared allocation is freed with the last of its device_globals.
+      if (USMMem.MBlock)
+        USMMem.MBlock.reset();
+      else
+        detail::usm::freeInternal(USMMem.MPtr, CtxImpl);
       if (USMMem.MInitEvent.has_value())
         CtxImpl->getPlugin()->call<PiApiKind::piEventRelease>(
             *USMMem.MInitEvent);
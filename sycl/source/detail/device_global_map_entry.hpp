@@ -15,6 +15,7 @@
 #include <optional>
 #include <set>
 #include <unordered_set>
+#include <vector>
 
 #include <detail/pi_utils.hpp>
 #include <sycl/detail/defines_elementary.hpp>
@@ -30,9 +31,13 @@ class platform_impl;
 class queue_impl;
 class event_impl;
 using EventImplPtr = std::shared_ptr<sycl::detail::event_impl>;
+// USM allocation shared by the device_globals allocated together.
+struct DeviceGlobalUSMBlock;
 
 struct DeviceGlobalUSMMem {
   DeviceGlobalUSMMem(void *Ptr) : MPtr(Ptr) {}
+  DeviceGlobalUSMMem(void *Ptr, std::shared_ptr<DeviceGlobalUSMBlock> Block)
+      : MPtr(Ptr), MBlock(std::move(Block)) {}
   ~DeviceGlobalUSMMem();
 
   void *const &getPtr() const noexcept { return MPtr; }
@@ -43,6 +48,8 @@ struct DeviceGlobalUSMMem {
 
 private:
   void *MPtr;
+  // The allocation MPtr is in if it is shared with other device_globals.
+  std::shared_ptr<DeviceGlobalUSMBlock> MBlock;
   std::mutex MInitEventMutex;
   std::optional<sycl::detail::pi::PiEvent> MInitEvent;
 
@@ -112,6 +119,13 @@ struct DeviceGlobalMapEntry {
   DeviceGlobalUSMMem &
   getOrAllocateDeviceGlobalUSM(const std::shared_ptr<queue_impl> &QueueImpl);
 
+  // Gets or allocates USM memory for several device_globals. The device_globals
+  // without memory yet are allocated in a single USM allocation and
+  // initialized by a single copy.
+  static std::vector<DeviceGlobalUSMMem *> getOrAllocateDeviceGlobalUSM(
+      const std::vector<DeviceGlobalMapEntry *> &Entries,
+      const std::shared_ptr<queue_impl> &QueueImpl);
+
   // Removes resources for device_globals associated with the context.
   void removeAssociatedResources(const context_impl *CtxImpl);
 
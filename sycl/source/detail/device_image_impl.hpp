@@ -261,19 +261,12 @@ public:
 
   sycl::detail::pi::PiMem &get_spec_const_buffer_ref() noexcept {
     std::lock_guard<std::mutex> Lock{MSpecConstAccessMtx};
-    if (nullptr == MSpecConstsBuffer && !MSpecConstsBlob.empty()) {
-      const PluginPtr &Plugin = getSyclObjImpl(MContext)->getPlugin();
-      // Uses PI_MEM_FLAGS_HOST_PTR_COPY instead of PI_MEM_FLAGS_HOST_PTR_USE
-      // since post-enqueue cleanup might trigger destruction of
-      // device_image_impl and, as a result, destruction of MSpecConstsBlob
-      // while MSpecConstsBuffer is still in use.
-      // TODO consider changing the lifetime of device_image_impl instead
-      memBufferCreateHelper(Plugin,
-                            detail::getSyclObjImpl(MContext)->getHandleRef(),
-                            PI_MEM_FLAGS_ACCESS_RW | PI_MEM_FLAGS_HOST_PTR_COPY,
-                            MSpecConstsBlob.size(), MSpecConstsBlob.data(),
-                            &MSpecConstsBuffer, nullptr);
-    }
+    if (nullptr == MSpecConstsBuffer && !MSpecConstsBlob.empty())
+      // The buffer is owned by the context and shared with the other device
+      // images with the same values, so that it outlives post-enqueue
+      // cleanup of this device image.
+      MSpecConstsBuffer =
+          getSyclObjImpl(MContext)->getSpecConstsBuffer(MSpecConstsBlob);
     return MSpecConstsBuffer;
   }
 
@@ -305,11 +298,6 @@ public:
       const PluginPtr &Plugin = getSyclObjImpl(MContext)->getPlugin();
       Plugin->call<PiApiKind::piProgramRelease>(MProgram);
     }
-    if (MSpecConstsBuffer) {
-      std::lock_guard<std::mutex> Lock{MSpecConstAccessMtx};
-      const PluginPtr &Plugin = getSyclObjImpl(MContext)->getPlugin();
-      memReleaseHelper(Plugin, MSpecConstsBuffer);
-    }
   }
 
 private:
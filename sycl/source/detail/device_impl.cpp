@@ -12,6 +12,8 @@
 #include <sycl/device.hpp>
 
 #include <algorithm>
+#include <cstring>
+#include <type_traits>
 
 namespace sycl {
 inline namespace _V1 {
@@ -120,9 +122,40 @@ typename Param::return_type device_impl::get_info() const {
   if (is_host()) {
     return get_device_info_host<Param>();
   }
+  using ReturnT = typename Param::return_type;
+  // The free memory is the only numeric descriptor which changes over time.
+  if constexpr (std::is_arithmetic_v<ReturnT> &&
+                sizeof(ReturnT) <= sizeof(uint64_t) &&
+                !std::is_same_v<Param, ext::intel::info::device::free_memory>)
+    return getCachedNumericInfo<Param>();
   return get_device_info<Param>(
       MPlatform->getOrMakeDeviceImpl(MDevice, MPlatform));
 }
+
+// Only the address of the variable is used, as a key unique to Param.
+template <typename Param> static constexpr char InfoCacheKey = 0;
+
+template <typename Param>
+typename Param::return_type device_impl::getCachedNumericInfo() const {
+  using ReturnT = typename Param::return_type;
+  const void *Key = &InfoCacheKey<Param>;
+  ReturnT Value{};
+  {
+    std::shared_lock<std::shared_mutex> Lock(MNumericInfoMutex);
+    auto It = MNumericInfo.find(Key);
+    if (It != MNumericInfo.end()) {
+      std::memcpy(&Value, &It->second, sizeof(ReturnT));
+      return Value;
+    }
+  }
+  Value = get_device_info<Param>(
+      MPlatform->getOrMakeDeviceImpl(MDevice, MPlatform));
+  uint64_t Stored = 0;
+  std::memcpy(&Stored, &Value, sizeof(ReturnT));
+  std::unique_lock<std::shared_mutex> Lock(MNumericInfoMutex);
+  MNumericInfo.emplace(Key, Stored);
+  return Value;
+}
 // Explicitly instantiate all device info traits
 #define __SYCL_PARAM_TRAITS_SPEC(DescType, Desc, ReturnT, PiCode)              \
   template ReturnT device_impl::get_info<info::device::Desc>() const;
@@ -183,9 +216,11 @@ bool device_impl::has_extension(const std::string &ExtensionName) const {
   if (MIsHostDevice)
     // TODO: implement extension management for host device;
     return false;
-  std::string AllExtensionNames =
-      get_device_info_string(PiInfoCode<info::device::extensions>::value);
-  return (AllExtensionNames.find(ExtensionName) != std::string::npos);
+  std::call_once(MExtensionsFlag, [this]() {
+    MExtensions =
+        get_device_info_string(PiInfoCode<info::device::extensions>::value);
+  });
+  return (MExtensions.find(ExtensionName) != std::string::npos);
 }
 
 bool device_impl::is_partition_supported(info::partition_property Prop) const {
@@ -350,6 +385,18 @@ pi_native_handle device_impl::getNative() const {
 }
 
 bool device_impl::has(aspect Aspect) const {
+  size_t Index = static_cast<size_t>(Aspect);
+  if (Index >= MaxCachedAspect)
+    return hasImpl(Aspect);
+  uint8_t Cached = MAspects[Index].load(std::memory_order_relaxed);
+  if (Cached)
+    return Cached == 2;
+  bool Supported = hasImpl(Aspect);
+  MAspects[Index].store(Supported ? 2 : 1, std::memory_order_relaxed);
+  return Supported;
+}
+
+bool device_impl::hasImpl(aspect Aspect) const {
   size_t return_size = 0;
 
   switch (Aspect) {
@@ -699,6 +746,27 @@ ext::oneapi::experimental::architecture device_impl::getDeviceArch() const {
   return MDeviceArch;
 }
 
+const device_impl::range_rounding_geometry &
+device_impl::getRangeRoundingGeometry() const {
+  std::call_once(MRangeRoundingGeometryFlag, [this]() {
+    MRangeRoundingGeometry.MMaxWorkGroupSize =
+        get_info<info::device::max_work_group_size>();
+    MRangeRoundingGeometry.MComputeUnits =
+        get_info<info::device::max_compute_units>();
+    // Not all backends report the sub-group sizes.
+    try {
+      std::vector<size_t> SubGroupSizes =
+          get_info<info::device::sub_group_sizes>();
+      if (!SubGroupSizes.empty())
+        MRangeRoundingGeometry.MMaxSubGroupSize =
+            *std::max_element(SubGroupSizes.begin(), SubGroupSizes.end());
+    } catch (const sycl::exception &) {
+    }
+  });
+
+  return MRangeRoundingGeometry;
+}
+
 // On the first call this function queries for device timestamp
 // along with host synchronized timestamp and stores it in member variable
 // MDeviceHostBaseTime. Subsequent calls to this function would just retrieve
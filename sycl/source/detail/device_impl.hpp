@@ -15,8 +15,12 @@
 #include <sycl/ext/oneapi/experimental/device_architecture.hpp>
 #include <sycl/kernel_bundle.hpp>
 
+#include <array>
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 #include <utility>
 
 namespace sycl {
@@ -281,7 +285,26 @@ public:
   /// Get device architecture
   ext::oneapi::experimental::architecture getDeviceArch() const;
 
+  /// The properties of the device that range rounding depends on.
+  struct range_rounding_geometry {
+    size_t MMaxWorkGroupSize = 0;
+    /// The widest sub-group size, or 0 if it is unknown.
+    size_t MMaxSubGroupSize = 0;
+    size_t MComputeUnits = 0;
+  };
+
+  /// Get the geometry of the device used to round ranges. It is queried
+  /// once and then cached.
+  const range_rounding_geometry &getRangeRoundingGeometry() const;
+
 private:
+  bool hasImpl(aspect Aspect) const;
+
+  /// Returns the cached value of a numeric descriptor, or queries and caches
+  /// it.
+  template <typename Param>
+  typename Param::return_type getCachedNumericInfo() const;
+
   explicit device_impl(pi_native_handle InteropDevice,
                        sycl::detail::pi::PiDevice Device,
                        PlatformImplPtr Platform, const PluginPtr &Plugin);
@@ -295,6 +318,19 @@ private:
   mutable std::once_flag MDeviceNameFlag;
   mutable ext::oneapi::experimental::architecture MDeviceArch{};
   mutable std::once_flag MDeviceArchFlag;
+  mutable range_rounding_geometry MRangeRoundingGeometry;
+  mutable std::once_flag MRangeRoundingGeometryFlag;
+  /// The device info which can't change during the lifetime of the device is
+  /// queried once: the aspects, the extensions and the numeric descriptors.
+  /// The aspects are stored as 0 when unknown, 1 when unsupported and 2 when
+  /// supported.
+  static constexpr size_t MaxCachedAspect = 64;
+  mutable std::array<std::atomic<uint8_t>, MaxCachedAspect> MAspects{};
+  mutable std::string MExtensions;
+  mutable std::once_flag MExtensionsFlag;
+  /// Numeric descriptors by the address of their InfoCacheKey
+  mutable std::unordered_map<const void *, uint64_t> MNumericInfo;
+  mutable std::shared_mutex MNumericInfoMutex;
   std::pair<uint64_t, uint64_t> MDeviceHostBaseTime{0, 0};
 }; // class device_impl
 
@@ -59,7 +59,12 @@ event_impl::~event_impl() {
 }
 
 void event_impl::waitInternal(bool *Success) {
-  if (!MHostEvent && MEvent) {
+  if (!MHostEvent && MEvent && MIsNativeEventComplete) {
+    // The native event is known to be complete, no need to call the plugin.
+    if (Success != nullptr)
+      *Success = true;
+  } else if (!MHostEvent && MEvent) {
+    queue_impl::flushDeferredCrossQueueDeps();
     // Wait for the native event
     sycl::detail::pi::PiResult Err =
         getPlugin()->call_nocheck<PiApiKind::piEventsWait>(1, &MEvent);
@@ -72,6 +77,8 @@ void event_impl::waitInternal(bool *Success) {
       *Success = false;
     else {
       getPlugin()->checkPiResult(Err);
+      if (Err == PI_SUCCESS)
+        MIsNativeEventComplete = true;
       if (Success != nullptr)
         *Success = true;
     }
@@ -91,6 +98,45 @@ void event_impl::waitInternal(bool *Success) {
     Event->wait(Event);
 }
 
+void event_impl::waitNativeEvents(const std::vector<EventImplPtr> &Events) {
+  struct NativeEventsGroup {
+    context_impl *Context;
+    std::vector<event_impl *> Events;
+    std::vector<sycl::detail::pi::PiEvent> PiEvents;
+  };
+  std::vector<NativeEventsGroup> Groups;
+  size_t NumPiEvents = 0;
+  for (const EventImplPtr &Event : Events) {
+    if (Event->MHostEvent || !Event->MEvent || Event->MIsNativeEventComplete ||
+        !Event->MGraph.expired())
+      continue;
+    context_impl *Context = Event->getContextImpl().get();
+    auto It = std::find_if(Groups.begin(), Groups.end(), [&](const auto &G) {
+      return G.Context == Context;
+    });
+    if (It == Groups.end())
+      It = Groups.insert(Groups.end(), NativeEventsGroup{Context, {}, {}});
+    It->Events.push_back(Event.get());
+    It->PiEvents.push_back(Event->MEvent);
+    ++NumPiEvents;
+  }
+  // A single native event is waited for by its event as well.
+  if (NumPiEvents < 2)
+    return;
+
+  queue_impl::flushDeferredCrossQueueDeps();
+  for (NativeEventsGroup &Group : Groups) {
+    sycl::detail::pi::PiResult Err =
+        Group.Context->getPlugin()->call_nocheck<PiApiKind::piEventsWait>(
+            Group.PiEvents.size(), Group.PiEvents.data());
+    // The errors are reported by the wait of each event.
+    if (Err != PI_SUCCESS)
+      continue;
+    for (event_impl *Event : Group.Events)
+      Event->MIsNativeEventComplete = true;
+  }
+}
+
 void event_impl::setComplete() {
   if (MHostEvent || !MEvent) {
     {
@@ -248,6 +294,13 @@ void event_impl::wait(std::shared_ptr<sycl::detail::event_impl> Self,
     throw sycl::exception(make_error_code(errc::invalid),
                           "wait method cannot be used for a discarded event.");
 
+  if (QueueImplPtr Queue = getAutoGraphQueue()) {
+    // The recorded kernel may not have been run yet.
+    Queue->syncAutoGraph(Queue);
+    Queue->wait();
+    return;
+  }
+
   if (MGraph.lock()) {
     throw sycl::exception(make_error_code(errc::invalid),
                           "wait method cannot be used for an event associated "
@@ -258,7 +311,7 @@ void event_impl::wait(std::shared_ptr<sycl::detail::event_impl> Self,
   void *TelemetryEvent = nullptr;
   uint64_t IId = 0;
   std::string Name;
-  int32_t StreamID = xptiRegisterStream(SYCL_STREAM_NAME);
+  int32_t StreamID = getSYCLStreamID();
   TelemetryEvent = instrumentationProlog(Name, StreamID, IId);
 #endif
 
@@ -268,6 +321,10 @@ void event_impl::wait(std::shared_ptr<sycl::detail::event_impl> Self,
     waitInternal(Success);
   else if (MCommand)
     detail::Scheduler::getInstance().waitForEvent(Self, Success);
+  else if (MHostEvent)
+    // Host tasks run without the scheduler have neither a PI event nor a
+    // command, their host event is completed by the thread pool.
+    waitInternal(Success);
 
 #ifdef XPTI_ENABLE_INSTRUMENTATION
   instrumentationEpilog(TelemetryEvent, Name, StreamID, IId);
@@ -408,11 +465,21 @@ event_impl::get_info<info::event::command_execution_status>() {
 
   if (!MHostEvent) {
     // Command is enqueued and PiEvent is ready
-    if (MEvent)
-      return get_event_info<info::event::command_execution_status>(
-          this->getHandleRef(), this->getPlugin());
+    if (MEvent) {
+      // Once the native event has completed its status can no longer change,
+      // so the plugin doesn't need to be queried again.
+      if (MIsNativeEventComplete)
+        return info::event_command_status::complete;
+      queue_impl::flushDeferredCrossQueueDeps();
+      info::event_command_status Status =
+          get_event_info<info::event::command_execution_status>(
+              this->getHandleRef(), this->getPlugin());
+      if (Status == info::event_command_status::complete)
+        MIsNativeEventComplete = true;
+      return Status;
+    }
     // Command is blocked and not enqueued, PiEvent is not assigned yet
-    else if (MCommand)
+    if (MCommand)
       return sycl::info::event_command_status::submitted;
   }
 
@@ -535,9 +602,10 @@ void event_impl::flushIfNeeded(const QueueImplPtr &UserQueue) {
   getPlugin()->call<PiApiKind::piEventGetInfo>(
       MEvent, PI_EVENT_INFO_COMMAND_EXECUTION_STATUS, sizeof(pi_int32), &Status,
       nullptr);
-  if (Status == PI_EVENT_QUEUED) {
-    getPlugin()->call<PiApiKind::piQueueFlush>(Queue->getHandleRef());
-  }
+  // The flush may be coalesced with the ones for the following dependencies,
+  // in which case the event is checked again for the next dependent command.
+  if (Status == PI_EVENT_QUEUED && !Queue->flushForCrossQueueDep(Queue))
+    return;
   MIsFlushed = true;
 }
 
@@ -125,6 +125,12 @@ public:
   ///        it's pointing to is then set according to the outcome.
   void waitInternal(bool *Success = nullptr);
 
+  /// Waits for the native events of the enqueued commands of Events, with one
+  /// plugin call per context rather than one per event. The events still have
+  /// to be waited for afterwards, which then only does the remaining work,
+  /// such as waiting for the commands which are not enqueued yet.
+  static void waitNativeEvents(const std::vector<EventImplPtr> &Events);
+
   /// Marks this event as completed.
   void setComplete();
 
@@ -262,6 +268,12 @@ public:
 
   QueueImplPtr getSubmittedQueue() const { return MSubmittedQueue.lock(); };
 
+  /// Marks the event as the one of a kernel recorded by an auto_graph queue,
+  /// which runs it when the event is waited on.
+  void setAutoGraphQueue(const QueueImplPtr &Queue) { MAutoGraphQueue = Queue; }
+
+  QueueImplPtr getAutoGraphQueue() const { return MAutoGraphQueue.lock(); }
+
   /// Checks if an event is in a fully intialized state. Default-constructed
   /// events will return true only after having initialized its native event,
   /// while other events will assume that they are fully initialized at
@@ -358,6 +370,7 @@ protected:
 
   std::weak_ptr<queue_impl> MWorkerQueue;
   std::weak_ptr<queue_impl> MSubmittedQueue;
+  std::weak_ptr<queue_impl> MAutoGraphQueue;
 
   /// Dependency events prepared for waiting by backend.
   std::vector<EventImplPtr> MPreparedDepsEvents;
@@ -369,6 +382,10 @@ protected:
   /// the queue to the device.
   std::atomic<bool> MIsFlushed = false;
 
+  /// Indicates that the native event is known to be complete, so that its
+  /// status doesn't need to be queried from the plugin anymore.
+  std::atomic<bool> MIsNativeEventComplete = false;
+
   // State of host event. Employed only for host events and event with no
   // backend's representation (e.g. alloca). Used values are listed in
   // HostEventState enum.
@@ -13,6 +13,8 @@
 
 #include <detail/config.hpp>
 #include <detail/global_handler.hpp>
+#include <detail/metrics.hpp>
+#include <detail/persistent_device_code_cache.hpp>
 #include <detail/platform_impl.hpp>
 #include <detail/plugin.hpp>
 #include <detail/program_manager/program_manager.hpp>
@@ -219,6 +221,29 @@ ThreadPool &GlobalHandler::getHostTaskThreadPool() {
   return TP;
 }
 
+PersistentDeviceCodeCacheWriter &GlobalHandler::getPersistentCacheWriter() {
+  return getOrCreate(MPersistentCacheWriter);
+}
+
+void GlobalHandler::flushPersistentCacheWriter() {
+  PersistentDeviceCodeCacheWriter *Writer = nullptr;
+  {
+    const LockGuard Lock{MPersistentCacheWriter.Lock};
+    Writer = MPersistentCacheWriter.Inst.get();
+  }
+  if (Writer)
+    Writer->flush();
+}
+
+std::vector<std::weak_ptr<queue_impl>> &
+GlobalHandler::getQueuesWithDeferredFlushes() {
+  return getOrCreate(MQueuesWithDeferredFlushes);
+}
+
+std::mutex &GlobalHandler::getQueuesWithDeferredFlushesMutex() {
+  return getOrCreate(MQueuesWithDeferredFlushesMutex);
+}
+
 void GlobalHandler::releaseDefaultContexts() {
   // Release shared-pointers to SYCL objects.
   // Note that on Windows the destruction of the default context
@@ -281,6 +306,8 @@ void GlobalHandler::drainThreadPool() {
 // accidentally retain device handles. etc
 void shutdown() {
   GlobalHandler *&Handler = GlobalHandler::getInstancePtr();
+  if (isMetricsEnabled())
+    dumpMetrics();
   Handler->unloadPlugins();
 }
 #else
@@ -297,6 +324,19 @@ void shutdown() {
   if (Handler->MHostTaskThreadPool.Inst)
     Handler->MHostTaskThreadPool.Inst->finishAndWait();
 
+  if (isMetricsEnabled())
+    dumpMetrics();
+
+  // Preloading uses contexts and populates the persistent cache, so it must be
+  // done before the cache writer is stopped.
+  if (Handler->MProgramManager.Inst)
+    Handler->MProgramManager.Inst->waitForPreloadedDeviceImages();
+
+  // Complete the pending persistent cache writes while the device images and
+  // the plugins are still alive.
+  if (Handler->MPersistentCacheWriter.Inst)
+    Handler->MPersistentCacheWriter.Inst->finishAndWait();
+
   // If default contexts are requested after the first default contexts have
   // been released there may be a new default context. These must be released
   // prior to closing the plugins.
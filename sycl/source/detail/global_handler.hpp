@@ -19,6 +19,7 @@ inline namespace _V1 {
 namespace detail {
 class platform_impl;
 class context_impl;
+class queue_impl;
 class Scheduler;
 class ProgramManager;
 class Sync;
@@ -26,6 +27,7 @@ class plugin;
 class ods_target_list;
 class XPTIRegistry;
 class ThreadPool;
+class PersistentDeviceCodeCacheWriter;
 
 using PlatformImplPtr = std::shared_ptr<platform_impl>;
 using ContextImplPtr = std::shared_ptr<context_impl>;
@@ -72,6 +74,12 @@ public:
   ods_target_list &getOneapiDeviceSelectorTargets(const std::string &InitValue);
   XPTIRegistry &getXPTIRegistry();
   ThreadPool &getHostTaskThreadPool();
+  PersistentDeviceCodeCacheWriter &getPersistentCacheWriter();
+  /// Completes the pending persistent cache writes, if any, which read the
+  /// device images they are made for.
+  void flushPersistentCacheWriter();
+  std::vector<std::weak_ptr<queue_impl>> &getQueuesWithDeferredFlushes();
+  std::mutex &getQueuesWithDeferredFlushesMutex();
 
   static void registerDefaultContextReleaseHandler();
 
@@ -123,6 +131,12 @@ private:
   InstWithLock<XPTIRegistry> MXPTIRegistry;
   // Thread pool for host task and event callbacks execution
   InstWithLock<ThreadPool> MHostTaskThreadPool;
+  // Background writer of the persistent device code cache items
+  InstWithLock<PersistentDeviceCodeCacheWriter> MPersistentCacheWriter;
+  // Queues that have to be flushed before waiting for a device event
+  InstWithLock<std::vector<std::weak_ptr<queue_impl>>>
+      MQueuesWithDeferredFlushes;
+  InstWithLock<std::mutex> MQueuesWithDeferredFlushesMutex;
 };
 } // namespace detail
 } // namespace _V1
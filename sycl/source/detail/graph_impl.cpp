@@ -14,7 +14,14 @@
 #include <detail/scheduler/commands.hpp>
 #include <detail/sycl_mem_obj_t.hpp>
 #include <sycl/feature_test.hpp>
+#if SYCL_EXT_CODEPLAY_KERNEL_FUSION
+#include <detail/jit_compiler.hpp>
+#endif
 #include <sycl/queue.hpp>
+#include <sycl/usm.hpp>
+
+#include <map>
+#include <numeric>
 
 namespace sycl {
 inline namespace _V1 {
@@ -60,88 +67,6 @@ bool visitNodeDepthFirst(
   return false;
 }
 
-/// Recursively add nodes to execution stack.
-/// @param NodeImpl Node to schedule.
-/// @param Schedule Execution ordering to add node to.
-/// @param PartitionBounded If set to true, the topological sort is stopped at
-/// partition borders. Hence, nodes belonging to a partition different from the
-/// NodeImpl partition are not processed.
-void sortTopological(std::shared_ptr<node_impl> NodeImpl,
-                     std::list<std::shared_ptr<node_impl>> &Schedule,
-                     bool PartitionBounded = false) {
-  for (auto &Succ : NodeImpl->MSuccessors) {
-    auto NextNode = Succ.lock();
-    if (PartitionBounded &&
-        (NextNode->MPartitionNum != NodeImpl->MPartitionNum)) {
-      continue;
-    }
-    // Check if we've already scheduled this node
-    if (std::find(Schedule.begin(), Schedule.end(), NextNode) ==
-        Schedule.end()) {
-      sortTopological(NextNode, Schedule, PartitionBounded);
-    }
-  }
-
-  Schedule.push_front(NodeImpl);
-}
-
-/// Propagates the partition number `PartitionNum` to predecessors.
-/// Propagation stops when a host task is encountered or when no predecessors
-/// remain or when we encounter a node that has already been processed and has a
-/// partition number lower that the one propagated here. Indeed,
-/// partition numbers reflect the execution order. Hence, the partition number
-/// of a node can be decreased but not increased. Moreover, as predecessors of a
-/// node are either in the same partition or a partition with a smaller number,
-/// we do not need to continue propagating the partition number if we encounter
-/// a node with a smaller partition number.
-/// @param Node Node to assign to the partition.
-/// @param PartitionNum Number to propagate.
-void propagatePartitionUp(std::shared_ptr<node_impl> Node, int PartitionNum) {
-  if (((Node->MPartitionNum != -1) && (Node->MPartitionNum <= PartitionNum)) ||
-      (Node->MCGType == sycl::detail::CG::CGTYPE::CodeplayHostTask)) {
-    return;
-  }
-  Node->MPartitionNum = PartitionNum;
-  for (auto &Predecessor : Node->MPredecessors) {
-    propagatePartitionUp(Predecessor.lock(), PartitionNum);
-  }
-}
-
-/// Propagates the partition number `PartitionNum` to successors.
-/// Propagation stops when an host task is encountered or when no successors
-/// remain.
-/// @param Node Node to assign to the partition.
-/// @param PartitionNum Number to propagate.
-/// @param HostTaskList List of host tasks that have already been processed and
-/// are encountered as successors to the node Node.
-void propagatePartitionDown(
-    std::shared_ptr<node_impl> Node, int PartitionNum,
-    std::list<std::shared_ptr<node_impl>> &HostTaskList) {
-  if (Node->MCGType == sycl::detail::CG::CGTYPE::CodeplayHostTask) {
-    if (Node->MPartitionNum != -1) {
-      HostTaskList.push_front(Node);
-    }
-    return;
-  }
-  Node->MPartitionNum = PartitionNum;
-  for (auto &Successor : Node->MSuccessors) {
-    propagatePartitionDown(Successor.lock(), PartitionNum, HostTaskList);
-  }
-}
-
-/// Tests if the node is a root of its partition (i.e. no predecessors that
-/// belong to the same partition)
-/// @param Node node to test
-/// @return True is `Node` is a root of its partition
-bool isPartitionRoot(std::shared_ptr<node_impl> Node) {
-  for (auto &Predecessor : Node->MPredecessors) {
-    if (Predecessor.lock()->MPartitionNum == Node->MPartitionNum) {
-      return false;
-    }
-  }
-  return true;
-}
-
 /// Takes a vector of weak_ptrs to node_impls and returns a vector of node
 /// objects created from those impls, in the same order.
 std::vector<node> createNodesFromImpls(
@@ -170,105 +95,291 @@ std::vector<node> createNodesFromImpls(
   return Nodes;
 }
 
-} // anonymous namespace
+/// Identifies data written by graph_impl::serialize().
+constexpr char SerializedGraphMagic[8] = {'S', 'Y', 'C', 'L',
+                                          'G', 'R', 'P', 'H'};
+/// Incremented whenever the serialized format changes.
+constexpr uint32_t SerializedGraphVersion = 1;
+
+/// How the value of a serialized kernel argument is stored.
+enum class serialized_arg_value : uint8_t {
+  /// No value, e.g. for local accessors.
+  None = 0,
+  /// The bytes of the value follow.
+  Bytes = 1,
+  /// The index of the pointer placeholder follows.
+  Pointer = 2
+};
+
+/// Appends trivially copyable values to a serialized graph.
+class graph_writer {
+public:
+  template <typename T> void write(const T &Value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    writeBytes(&Value, sizeof(T));
+  }
+
+  void writeBytes(const void *Data, size_t Size) {
+    const auto *Bytes = static_cast<const std::byte *>(Data);
+    MData.insert(MData.end(), Bytes, Bytes + Size);
+  }
+
+  void writeString(const std::string &String) {
+    write<uint64_t>(String.size());
+    writeBytes(String.data(), String.size());
+  }
+
+  std::vector<std::byte> MData;
+};
+
+/// Reads the values appended by graph_writer, throwing if the data ends early.
+class graph_reader {
+public:
+  graph_reader(const std::vector<std::byte> &Data) : MData(Data) {}
+
+  template <typename T> T read() {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T Value;
+    std::memcpy(&Value, readBytes(sizeof(T)), sizeof(T));
+    return Value;
+  }
 
-void partition::schedule() {
-  if (MSchedule.empty()) {
-    for (auto &Node : MRoots) {
-      sortTopological(Node.lock(), MSchedule, true);
+  const std::byte *readBytes(size_t Size) {
+    if (MData.size() - MPos < Size) {
+      throw sycl::exception(sycl::make_error_code(errc::invalid),
+                            "Serialized graph data is truncated");
     }
+    const std::byte *Bytes = MData.data() + MPos;
+    MPos += Size;
+    return Bytes;
+  }
+
+  std::string readString() {
+    const auto Size = read<uint64_t>();
+    const auto *Bytes = reinterpret_cast<const char *>(readBytes(Size));
+    return std::string(Bytes, Size);
+  }
+
+private:
+  const std::vector<std::byte> &MData;
+  size_t MPos = 0;
+};
+
+void writeRange(graph_writer &Writer, const sycl::range<3> &Range) {
+  for (int I = 0; I < 3; ++I)
+    Writer.write<uint64_t>(Range[I]);
+}
+
+void writeRange(graph_writer &Writer, const sycl::id<3> &Id) {
+  for (int I = 0; I < 3; ++I)
+    Writer.write<uint64_t>(Id[I]);
+}
+
+template <typename T> void readRange(graph_reader &Reader, T &Range) {
+  for (int I = 0; I < 3; ++I)
+    Range[I] = Reader.read<uint64_t>();
+}
+
+} // anonymous namespace
+
+node_adjacency::node_adjacency(
+    const std::vector<std::shared_ptr<node_impl>> &Nodes) {
+  MIndices.reserve(Nodes.size());
+  for (size_t I = 0; I < Nodes.size(); I++) {
+    MIndices[Nodes[I].get()] = I;
   }
+
+  auto BuildRows = [&](std::vector<std::weak_ptr<node_impl>> node_impl::*Edges,
+                       std::vector<size_t> &Offsets,
+                       std::vector<size_t> &Indices) {
+    Offsets.reserve(Nodes.size() + 1);
+    Offsets.push_back(0);
+    for (auto &Node : Nodes) {
+      for (auto &Edge : (*Node).*Edges) {
+        Indices.push_back(MIndices.at(Edge.lock().get()));
+      }
+      Offsets.push_back(Indices.size());
+    }
+  };
+  BuildRows(&node_impl::MSuccessors, MSuccessorOffsets, MSuccessorIndices);
+  BuildRows(&node_impl::MPredecessors, MPredecessorOffsets,
+            MPredecessorIndices);
 }
 
 void exec_graph_impl::makePartitions() {
-  int CurrentPartition = -1;
-  std::list<std::shared_ptr<node_impl>> HostTaskList;
-  // find all the host-tasks in the graph
-  for (auto &Node : MNodeStorage) {
-    if (Node->MCGType == sycl::detail::CG::CodeplayHostTask) {
-      HostTaskList.push_back(Node);
+  // Annotate nodes
+  // The first step in graph partitioning is to annotate all nodes of the graph
+  // with a level. Since host-tasks are currently the only tasks that require
+  // runtime dependency handling, the level of a node is the largest number of
+  // host-tasks found on a path from a root of the graph to the node, the node
+  // itself excluded. Hence, a host-task of level `n` only depends on nodes of
+  // level `n` or lower and all its successors have a level higher than `n`.
+  // An edge between two nodes which are not host-tasks and execute on
+  // different devices (see property::graph::enable_multi_device) is counted
+  // like a host-task, so the nodes of a level which are connected always
+  // execute on the same device.
+  // Partitions are then created in execution order, for each level `n`:
+  //  - The nodes of level `n` which are not host-tasks constitute one or more
+  //    partitions, each of them on a single device.
+  //  - Each host-task of level `n` constitutes a partition.
+  // Levels are computed in a single topological pass over the graph, so the
+  // partitioning is linear in the size of the graph. All the traversals use
+  // the index-based adjacency of the nodes.
+  MAdjacency = node_adjacency(MNodeStorage);
+  const size_t NumNodes = MNodeStorage.size();
+  auto IsHostTask = [&](size_t Index) {
+    return MNodeStorage[Index]->MCGType ==
+           sycl::detail::CG::CGTYPE::CodeplayHostTask;
+  };
+  const sycl::device GraphDevice = MGraphImpl->getDevice();
+  auto GetDevice = [&](size_t Index) -> const sycl::device & {
+    const std::optional<sycl::device> &Device = MNodeStorage[Index]->MDevice;
+    return Device ? *Device : GraphDevice;
+  };
+
+  using IndexList = std::vector<size_t>;
+  struct Level {
+    IndexList MNodes;
+    IndexList MHostTasks;
+  };
+  std::vector<Level> Levels;
+
+  // Position of each node in a topological order, used to schedule the nodes
+  // of the partitions.
+  std::vector<size_t> TopologicalRanks(NumNodes);
+  std::vector<size_t> NodeLevels(NumNodes, 0);
+  std::vector<size_t> PendingPredecessors(NumNodes);
+  IndexList ReadyNodes;
+  for (size_t I = 0; I < NumNodes; I++) {
+    PendingPredecessors[I] = MAdjacency.predecessors(I).size();
+    if (PendingPredecessors[I] == 0) {
+      ReadyNodes.push_back(I);
     }
   }
 
-  // Annotate nodes
-  // The first step in graph partitioning is to annotate all nodes of the graph
-  // with a temporary partition or group number. This step allows us to group
-  // the graph nodes into sets of nodes with kind of meta-dependencies that must
-  // be enforced by the runtime. For example, Group 2 depends on Groups 0 and 1,
-  // which means that we should not try to run Group 2 before Groups 0 and 1
-  // have finished executing. Since host-tasks are currently the only tasks that
-  // require runtime dependency handling, groups of nodes are created from
-  // host-task nodes. We therefore loop over all the host-task nodes, and for
-  // each node:
-  //  - Its predecessors are assigned to group number `n-1`
-  //  - The node itself constitutes a group, group number `n`
-  //  - Its successors are assigned to group number `n+1`
-  // Since running multiple partitions slows down the whole graph execution, we
-  // then try to reduce the number of partitions by merging them when possible.
-  // Typically, the grouping algorithm can create two successive partitions
-  // of target nodes in the following case:
-  // A host-task `A` is added to the graph. Later, another host task `B` is
-  // added to the graph. Consequently, the node `A` is stored before the node
-  // `B` in the node storage vector. Now, if `A` is placed as a successor of `B`
-  // (using make_edge function to make node `A` dependent on node `B`.) In this
-  // case, the host-task node `A` must be reprocessed after the node `B` and the
-  // group that includes the predecessor of `B` can be merged with the group of
-  // the predecessors of the node `A`.
-  while (HostTaskList.size() > 0) {
-    auto Node = HostTaskList.front();
-    HostTaskList.pop_front();
-    CurrentPartition++;
-    for (auto &Predecessor : Node->MPredecessors) {
-      propagatePartitionUp(Predecessor.lock(), CurrentPartition);
-    }
-    CurrentPartition++;
-    Node->MPartitionNum = CurrentPartition;
-    CurrentPartition++;
-    auto TmpSize = HostTaskList.size();
-    for (auto &Successor : Node->MSuccessors) {
-      propagatePartitionDown(Successor.lock(), CurrentPartition, HostTaskList);
-    }
-    if (HostTaskList.size() > TmpSize) {
-      // At least one HostTask has been re-numbered so group merge opportunities
-      for (const auto &HT : HostTaskList) {
-        auto HTPartitionNum = HT->MPartitionNum;
-        if (HTPartitionNum != -1) {
-          // can merge predecessors of node `Node` with predecessors of node
-          // `HT` (HTPartitionNum-1) since HT must be reprocessed
-          for (const auto &NodeImpl : MNodeStorage) {
-            if (NodeImpl->MPartitionNum == Node->MPartitionNum - 1) {
-              NodeImpl->MPartitionNum = HTPartitionNum - 1;
-            }
-          }
-        } else {
-          break;
-        }
+  size_t NextRank = 0;
+  while (!ReadyNodes.empty()) {
+    const size_t Index = ReadyNodes.back();
+    ReadyNodes.pop_back();
+    TopologicalRanks[Index] = NextRank++;
+
+    const size_t NodeLevel = NodeLevels[Index];
+    if (NodeLevel >= Levels.size()) {
+      Levels.resize(NodeLevel + 1);
+    }
+    if (IsHostTask(Index)) {
+      Levels[NodeLevel].MHostTasks.push_back(Index);
+    } else {
+      Levels[NodeLevel].MNodes.push_back(Index);
+    }
+
+    for (size_t SuccessorIndex : MAdjacency.successors(Index)) {
+      const bool IsDeviceChange = !IsHostTask(Index) &&
+                                  !IsHostTask(SuccessorIndex) &&
+                                  GetDevice(Index) != GetDevice(SuccessorIndex);
+      const size_t SuccessorLevel =
+          IsHostTask(Index) || IsDeviceChange ? NodeLevel + 1 : NodeLevel;
+      NodeLevels[SuccessorIndex] =
+          std::max(NodeLevels[SuccessorIndex], SuccessorLevel);
+      if (--PendingPredecessors[SuccessorIndex] == 0) {
+        ReadyNodes.push_back(SuccessorIndex);
       }
     }
   }
 
   // Create partitions
-  int PartitionFinalNum = 0;
-  for (int i = -1; i <= CurrentPartition; i++) {
-    const std::shared_ptr<partition> &Partition = std::make_shared<partition>();
-    for (auto &Node : MNodeStorage) {
-      if (Node->MPartitionNum == i) {
-        MPartitionNodes[Node] = PartitionFinalNum;
-        if (isPartitionRoot(Node)) {
-          Partition->MRoots.insert(Node);
+  MNodePartitions.assign(NumNodes, -1);
+  auto AddPartition = [&](IndexList Nodes) {
+    if (Nodes.empty()) {
+      return;
+    }
+    const int PartitionNum = static_cast<int>(MPartitions.size());
+    for (size_t Index : Nodes) {
+      MNodePartitions[Index] = PartitionNum;
+    }
+    const std::shared_ptr<partition> &Partition =
+        std::make_shared<partition>(GetDevice(Nodes.front()));
+    std::sort(Nodes.begin(), Nodes.end(), [&](size_t A, size_t B) {
+      return TopologicalRanks[A] < TopologicalRanks[B];
+    });
+    for (size_t Index : Nodes) {
+      const bool IsRoot = std::none_of(
+          MAdjacency.predecessors(Index).begin(),
+          MAdjacency.predecessors(Index).end(), [&](size_t Predecessor) {
+            return MNodePartitions[Predecessor] == PartitionNum;
+          });
+      if (IsRoot) {
+        Partition->MRoots.insert(MNodeStorage[Index]);
+      }
+      Partition->MSchedule.push_back(MNodeStorage[Index]);
+    }
+    MPartitions.push_back(Partition);
+  };
+  // The nodes of a level which are not connected to each other and depend on
+  // different partitions or execute on different devices are kept in separate
+  // partitions, so that independent regions of the graph (e.g. pipelines
+  // separated by different host-tasks) do not wait for each other. Connected
+  // nodes are found with a union-find over the edges between the nodes of the
+  // level.
+  std::vector<size_t> ComponentParents(NumNodes);
+  std::iota(ComponentParents.begin(), ComponentParents.end(), 0);
+  auto FindComponent = [&](size_t Index) {
+    while (ComponentParents[Index] != Index) {
+      ComponentParents[Index] = ComponentParents[ComponentParents[Index]];
+      Index = ComponentParents[Index];
+    }
+    return Index;
+  };
+
+  for (size_t LevelNum = 0; LevelNum < Levels.size(); LevelNum++) {
+    const Level &L = Levels[LevelNum];
+    for (size_t Index : L.MNodes) {
+      for (size_t SuccessorIndex : MAdjacency.successors(Index)) {
+        if (NodeLevels[SuccessorIndex] == LevelNum &&
+            !IsHostTask(SuccessorIndex)) {
+          ComponentParents[FindComponent(SuccessorIndex)] =
+              FindComponent(Index);
         }
       }
     }
-    if (Partition->MRoots.size() > 0) {
-      Partition->schedule();
-      MPartitions.push_back(Partition);
-      PartitionFinalNum++;
+
+    // Predecessors outside of the level already belong to a partition.
+    std::unordered_map<size_t, std::set<int>> ComponentDeps;
+    for (size_t Index : L.MNodes) {
+      std::set<int> &Deps = ComponentDeps[FindComponent(Index)];
+      for (size_t Predecessor : MAdjacency.predecessors(Index)) {
+        const int PartitionNum = MNodePartitions[Predecessor];
+        if (PartitionNum != -1) {
+          Deps.insert(PartitionNum);
+        }
+      }
+    }
+
+    std::map<std::pair<sycl::detail::device_impl *, std::set<int>>, size_t>
+        GroupIndices;
+    std::vector<IndexList> Groups;
+    for (size_t Index : L.MNodes) {
+      const std::set<int> &Deps = ComponentDeps[FindComponent(Index)];
+      auto [It, Inserted] = GroupIndices.try_emplace(
+          {sycl::detail::getSyclObjImpl(GetDevice(Index)).get(), Deps},
+          Groups.size());
+      if (Inserted) {
+        Groups.emplace_back();
+      }
+      Groups[It->second].push_back(Index);
+    }
+
+    for (auto &Group : Groups) {
+      AddPartition(std::move(Group));
+    }
+    for (size_t HostTask : L.MHostTasks) {
+      AddPartition({HostTask});
     }
   }
 
   // Add an empty partition if there is no partition, i.e. empty graph
   if (MPartitions.size() == 0) {
-    MPartitions.push_back(std::make_shared<partition>());
+    MPartitions.push_back(std::make_shared<partition>(GraphDevice));
   }
 
   // Make global schedule list
@@ -277,22 +388,21 @@ void exec_graph_impl::makePartitions() {
                      Partition->MSchedule.end());
   }
 
-  // Compute partition dependencies
-  for (const auto &Partition : MPartitions) {
-    for (auto const &Root : Partition->MRoots) {
-      auto RootNode = Root.lock();
-      for (const auto &Dep : RootNode->MPredecessors) {
-        auto NodeDep = Dep.lock();
-        Partition->MPredecessors.push_back(
-            MPartitions[MPartitionNodes[NodeDep]]);
+  // Compute partition dependencies. Nodes which are not roots can also depend
+  // on other partitions, e.g. on the partition of a host-task or of another
+  // device which their partition does not otherwise depend on.
+  std::vector<std::set<int>> PartitionDeps(MPartitions.size());
+  for (size_t Index = 0; Index < NumNodes; Index++) {
+    const int PartitionNum = MNodePartitions[Index];
+    for (size_t Predecessor : MAdjacency.predecessors(Index)) {
+      const int DepPartitionNum = MNodePartitions[Predecessor];
+      if (DepPartitionNum != PartitionNum &&
+          PartitionDeps[PartitionNum].insert(DepPartitionNum).second) {
+        MPartitions[PartitionNum]->MPredecessors.push_back(
+            MPartitions[DepPartitionNum]);
       }
     }
   }
-
-  // Reset node groups (if node have to be re-processed - e.g. subgraph)
-  for (auto &Node : MNodeStorage) {
-    Node->MPartitionNum = -1;
-  }
 }
 
 graph_impl::~graph_impl() {
@@ -300,6 +410,9 @@ graph_impl::~graph_impl() {
   for (auto &MemObj : MMemObjs) {
     MemObj->markNoLongerBeingUsedInGraph();
   }
+  for (auto &Allocation : MDeviceAllocations) {
+    sycl::free(Allocation.MPtr, MContext);
+  }
 }
 
 std::shared_ptr<node_impl> graph_impl::addNodesToExits(
@@ -409,6 +522,348 @@ graph_impl::add(const std::shared_ptr<graph_impl> &Impl,
   return NodeImpl;
 }
 
+std::shared_ptr<node_impl> graph_impl::addMallocDevice(
+    const std::shared_ptr<graph_impl> &Impl, void *&Ptr, size_t NumBytes,
+    const std::vector<std::shared_ptr<node_impl>> &Dep) {
+  if (NumBytes == 0) {
+    throw sycl::exception(make_error_code(errc::invalid),
+                          "Graph allocation nodes cannot allocate 0 bytes.");
+  }
+
+  // The memory of an allocation can be reused if it has been freed by a node
+  // which is a predecessor of the new node, since the nodes using the new
+  // allocation then always execute after the ones using the previous one.
+  // Out of these, the smallest allocation large enough is picked.
+  device_allocation *Allocation = nullptr;
+  const bool HasFreedAllocations =
+      std::any_of(MDeviceAllocations.begin(), MDeviceAllocations.end(),
+                  [&](const device_allocation &A) {
+                    return !A.MInUse && A.MSize >= NumBytes;
+                  });
+  if (HasFreedAllocations) {
+    std::unordered_set<node_impl *> Predecessors;
+    std::vector<node_impl *> Stack;
+    auto Visit = [&](node_impl *Node) {
+      if (Predecessors.insert(Node).second) {
+        Stack.push_back(Node);
+      }
+    };
+    for (auto &D : Dep) {
+      Visit(D.get());
+    }
+    for (auto &D : MExtraDependencies) {
+      Visit(D.get());
+    }
+    while (!Stack.empty()) {
+      node_impl *Node = Stack.back();
+      Stack.pop_back();
+      for (auto &Predecessor : Node->MPredecessors) {
+        Visit(Predecessor.lock().get());
+      }
+    }
+
+    for (auto &A : MDeviceAllocations) {
+      if (!A.MInUse && A.MSize >= NumBytes &&
+          Predecessors.count(A.MFreeNode.get()) &&
+          (!Allocation || A.MSize < Allocation->MSize)) {
+        Allocation = &A;
+      }
+    }
+  }
+
+  if (!Allocation) {
+    void *NewPtr = sycl::malloc_device(NumBytes, MDevice, MContext);
+    if (!NewPtr) {
+      throw sycl::exception(make_error_code(errc::memory_allocation),
+                            "Failed to allocate device memory for a graph "
+                            "allocation node.");
+    }
+    MDeviceAllocations.push_back({NewPtr, NumBytes, false, nullptr});
+    Allocation = &MDeviceAllocations.back();
+  }
+
+  std::shared_ptr<node_impl> NodeImpl = add(Impl, Dep);
+  NodeImpl->MNodeType = node_type::ext_oneapi_malloc_device;
+  Allocation->MInUse = true;
+  Allocation->MFreeNode.reset();
+  Ptr = Allocation->MPtr;
+  return NodeImpl;
+}
+
+std::shared_ptr<node_impl>
+graph_impl::addFree(const std::shared_ptr<graph_impl> &Impl, void *Ptr,
+                    const std::vector<std::shared_ptr<node_impl>> &Dep) {
+  auto Allocation =
+      std::find_if(MDeviceAllocations.begin(), MDeviceAllocations.end(),
+                   [&](const device_allocation &A) {
+                     return A.MInUse && A.MPtr == Ptr;
+                   });
+  if (Allocation == MDeviceAllocations.end()) {
+    throw sycl::exception(make_error_code(errc::invalid),
+                          "Pointer passed to add_free() was not allocated by "
+                          "an allocation node of this graph or has already "
+                          "been freed.");
+  }
+
+  std::shared_ptr<node_impl> NodeImpl = add(Impl, Dep);
+  NodeImpl->MNodeType = node_type::ext_oneapi_free;
+  Allocation->MInUse = false;
+  Allocation->MFreeNode = NodeImpl;
+  return NodeImpl;
+}
+
+std::shared_ptr<node_impl> graph_impl::addConditional(
+    const std::shared_ptr<graph_impl> &Impl, node_type Type,
+    const int *Condition, const command_graph<graph_state::executable> &Body,
+    const std::vector<std::shared_ptr<node_impl>> &Dep) {
+  if (!Condition ||
+      sycl::get_pointer_type(Condition, MContext) == usm::alloc::unknown) {
+    throw sycl::exception(make_error_code(errc::invalid),
+                          "The condition of a conditional node must be a USM "
+                          "allocation of the graph context.");
+  }
+  auto BodyImpl = sycl::detail::getSyclObjImpl(Body);
+  if (BodyImpl->getContext() != MContext ||
+      BodyImpl->getGraphImpl()->getDevice() != MDevice) {
+    throw sycl::exception(make_error_code(errc::invalid),
+                          "The graph executed by a conditional node must be "
+                          "finalized for the context and device of the "
+                          "graph.");
+  }
+
+  // Command-buffers of the backends don't have conditional commands, so the
+  // condition is read by a host-task which executes the body graph on its own
+  // queue.
+  sycl::queue Queue{
+      MContext, MDevice,
+      sycl::property_list{
+          sycl::property::queue::in_order{},
+          sycl::ext::intel::property::queue::no_immediate_command_list{}}};
+  const bool IsLoop = Type == node_type::ext_oneapi_while;
+  auto Execute = [=]() mutable {
+    int Value = 0;
+    do {
+      Queue.memcpy(&Value, Condition, sizeof(Value)).wait();
+      if (Value == 0) {
+        break;
+      }
+      Queue.ext_oneapi_graph(Body).wait();
+    } while (IsLoop);
+  };
+
+  std::shared_ptr<node_impl> NodeImpl = add(
+      Impl, [&](handler &CGH) { CGH.host_task(Execute); }, {}, Dep);
+  NodeImpl->MNodeType = Type;
+  return NodeImpl;
+}
+
+std::vector<std::byte>
+graph_impl::serialize(const std::vector<void *> &Pointers) const {
+  // Order the nodes so that predecessors are written before their successors.
+  std::vector<node_impl *> Order;
+  std::unordered_map<node_impl *, size_t> NumPendingPreds;
+  std::unordered_map<node_impl *, uint64_t> Indices;
+  Order.reserve(MNodeStorage.size());
+  for (auto &Node : MNodeStorage) {
+    NumPendingPreds[Node.get()] = Node->MPredecessors.size();
+    if (Node->MPredecessors.empty())
+      Order.push_back(Node.get());
+  }
+  for (size_t I = 0; I < Order.size(); ++I) {
+    Indices[Order[I]] = I;
+    for (auto &Succ : Order[I]->MSuccessors) {
+      node_impl *SuccNode = Succ.lock().get();
+      if (--NumPendingPreds[SuccNode] == 0)
+        Order.push_back(SuccNode);
+    }
+  }
+
+  graph_writer Writer;
+  Writer.writeBytes(SerializedGraphMagic, sizeof(SerializedGraphMagic));
+  Writer.write(SerializedGraphVersion);
+  Writer.write<uint64_t>(Order.size());
+  for (node_impl *Node : Order) {
+    if (Node->MNodeType != node_type::empty &&
+        Node->MNodeType != node_type::kernel) {
+      throw sycl::exception(sycl::make_error_code(errc::feature_not_supported),
+                            "Only empty and kernel nodes can be serialized");
+    }
+    Writer.write(static_cast<uint32_t>(Node->MNodeType));
+    Writer.write<uint64_t>(Node->MPredecessors.size());
+    for (auto &Pred : Node->MPredecessors)
+      Writer.write(Indices.at(Pred.lock().get()));
+    if (Node->MNodeType == node_type::empty)
+      continue;
+
+    auto *KernelCG =
+        static_cast<sycl::detail::CGExecKernel *>(Node->MCommandGroup.get());
+    if (KernelCG->MSyclKernel || KernelCG->MKernelBundle ||
+        !KernelCG->MStreams.empty() ||
+        !KernelCG->MAuxiliaryResources.empty()) {
+      throw sycl::exception(sycl::make_error_code(errc::feature_not_supported),
+                            "Kernel nodes using kernel objects, kernel "
+                            "bundles, streams or reductions cannot be "
+                            "serialized");
+    }
+    Writer.writeString(KernelCG->MKernelName);
+    const sycl::detail::NDRDescT &NDRDesc = KernelCG->MNDRDesc;
+    Writer.write<uint32_t>(NDRDesc.Dims);
+    writeRange(Writer, NDRDesc.GlobalSize);
+    writeRange(Writer, NDRDesc.LocalSize);
+    writeRange(Writer, NDRDesc.GlobalOffset);
+    writeRange(Writer, NDRDesc.NumWorkGroups);
+    Writer.write<uint8_t>(Node->MNDRangeUsed);
+    Writer.write<uint32_t>(KernelCG->MKernelCacheConfig);
+    Writer.write<uint8_t>(KernelCG->MKernelIsCooperative);
+
+    Writer.write<uint64_t>(KernelCG->MArgs.size());
+    for (const sycl::detail::ArgDesc &Arg : KernelCG->MArgs) {
+      using sycl::detail::kernel_param_kind_t;
+      if (Arg.MType != kernel_param_kind_t::kind_std_layout &&
+          Arg.MType != kernel_param_kind_t::kind_pointer) {
+        throw sycl::exception(
+            sycl::make_error_code(errc::feature_not_supported),
+            "Only standard layout and USM pointer kernel arguments can be "
+            "serialized");
+      }
+      Writer.write(static_cast<uint32_t>(Arg.MType));
+      Writer.write<int32_t>(Arg.MSize);
+      Writer.write<int32_t>(Arg.MIndex);
+      if (!Arg.MPtr) {
+        Writer.write(serialized_arg_value::None);
+        continue;
+      }
+      void *Pointer = Arg.MType == kernel_param_kind_t::kind_pointer
+                          ? *static_cast<void **>(Arg.MPtr)
+                          : nullptr;
+      if (!Pointer) {
+        Writer.write(serialized_arg_value::Bytes);
+        Writer.writeBytes(Arg.MPtr, Arg.MSize);
+        continue;
+      }
+      auto PointerIt = std::find(Pointers.begin(), Pointers.end(), Pointer);
+      if (PointerIt == Pointers.end()) {
+        throw sycl::exception(sycl::make_error_code(errc::invalid),
+                              "Pointer kernel argument was not passed to "
+                              "serialize()");
+      }
+      Writer.write(serialized_arg_value::Pointer);
+      Writer.write<uint64_t>(PointerIt - Pointers.begin());
+    }
+  }
+  return std::move(Writer.MData);
+}
+
+void graph_impl::deserialize(
+    const std::shared_ptr<graph_impl> &Impl,
+    const std::vector<std::byte> &Data,
+    const std::vector<std::shared_ptr<dynamic_parameter_impl>> &Pointers) {
+  graph_reader Reader{Data};
+  if (std::memcmp(Reader.readBytes(sizeof(SerializedGraphMagic)),
+                  SerializedGraphMagic, sizeof(SerializedGraphMagic)) != 0 ||
+      Reader.read<uint32_t>() != SerializedGraphVersion) {
+    throw sycl::exception(sycl::make_error_code(errc::invalid),
+                          "Data was not serialized by a compatible version of "
+                          "command_graph::serialize()");
+  }
+
+  const auto NumNodes = Reader.read<uint64_t>();
+  std::vector<std::shared_ptr<node_impl>> Nodes;
+  for (uint64_t I = 0; I < NumNodes; ++I) {
+    const auto NodeType = static_cast<node_type>(Reader.read<uint32_t>());
+    std::vector<std::shared_ptr<node_impl>> Deps;
+    const auto NumDeps = Reader.read<uint64_t>();
+    for (uint64_t D = 0; D < NumDeps; ++D) {
+      const auto Index = Reader.read<uint64_t>();
+      if (Index >= Nodes.size()) {
+        throw sycl::exception(sycl::make_error_code(errc::invalid),
+                              "Serialized graph has an invalid edge");
+      }
+      Deps.push_back(Nodes[Index]);
+    }
+
+    if (NodeType == node_type::empty) {
+      Nodes.push_back(add(Impl, Deps));
+      continue;
+    }
+    if (NodeType != node_type::kernel) {
+      throw sycl::exception(sycl::make_error_code(errc::invalid),
+                            "Serialized graph has an invalid node type");
+    }
+
+    std::string KernelName = Reader.readString();
+    sycl::detail::NDRDescT NDRDesc;
+    NDRDesc.Dims = Reader.read<uint32_t>();
+    readRange(Reader, NDRDesc.GlobalSize);
+    readRange(Reader, NDRDesc.LocalSize);
+    readRange(Reader, NDRDesc.GlobalOffset);
+    readRange(Reader, NDRDesc.NumWorkGroups);
+    const bool NDRangeUsed = Reader.read<uint8_t>();
+    const auto KernelCacheConfig =
+        static_cast<sycl::detail::pi::PiKernelCacheConfig>(
+            Reader.read<uint32_t>());
+    const bool KernelIsCooperative = Reader.read<uint8_t>();
+
+    sycl::detail::CG::StorageInitHelper CGData;
+    std::vector<sycl::detail::ArgDesc> Args;
+    std::vector<std::pair<dynamic_parameter_impl *, int>> DynamicParams;
+    const auto NumArgs = Reader.read<uint64_t>();
+    for (uint64_t A = 0; A < NumArgs; ++A) {
+      using sycl::detail::kernel_param_kind_t;
+      const auto Type =
+          static_cast<kernel_param_kind_t>(Reader.read<uint32_t>());
+      const auto Size = Reader.read<int32_t>();
+      const auto Index = Reader.read<int32_t>();
+      const auto Value = Reader.read<serialized_arg_value>();
+      if (Size < 0 || (Type != kernel_param_kind_t::kind_pointer &&
+                       Type != kernel_param_kind_t::kind_std_layout)) {
+        throw sycl::exception(sycl::make_error_code(errc::invalid),
+                              "Serialized graph has an invalid kernel "
+                              "argument");
+      }
+
+      void *Ptr = nullptr;
+      if (Value == serialized_arg_value::Bytes) {
+        const auto *Bytes =
+            reinterpret_cast<const char *>(Reader.readBytes(Size));
+        Ptr = CGData.MArgsStorage.emplace_back(Bytes, Bytes + Size).data();
+      } else if (Value == serialized_arg_value::Pointer) {
+        const auto Placeholder = Reader.read<uint64_t>();
+        if (Placeholder >= Pointers.size() ||
+            Size != static_cast<int32_t>(sizeof(void *))) {
+          throw sycl::exception(sycl::make_error_code(errc::invalid),
+                                "No dynamic parameter was passed for a "
+                                "pointer kernel argument");
+        }
+        auto &Param = Pointers[Placeholder];
+        const auto *ParamValue =
+            static_cast<const char *>(Param->getValue());
+        Ptr = CGData.MArgsStorage
+                  .emplace_back(ParamValue, ParamValue + sizeof(void *))
+                  .data();
+        DynamicParams.emplace_back(Param.get(), Index);
+      }
+      Args.emplace_back(Type, Ptr, Size, Index);
+    }
+
+    std::unique_ptr<sycl::detail::CG> CommandGroup =
+        std::make_unique<sycl::detail::CGExecKernel>(
+            std::move(NDRDesc), nullptr, nullptr, nullptr, std::move(CGData),
+            std::move(Args), std::move(KernelName),
+            std::vector<std::shared_ptr<sycl::detail::stream_impl>>{},
+            std::vector<std::shared_ptr<const void>>{},
+            sycl::detail::CG::Kernel, KernelCacheConfig, KernelIsCooperative);
+    auto NodeImpl = add(node_type::kernel, std::move(CommandGroup), Deps);
+    NodeImpl->MNDRangeUsed = NDRangeUsed;
+    // Add an event associated with this explicit node for mixed usage
+    addEventForNode(Impl, std::make_shared<sycl::detail::event_impl>(),
+                    NodeImpl);
+    for (auto &[DynamicParam, ArgIndex] : DynamicParams)
+      DynamicParam->registerNode(NodeImpl, ArgIndex);
+    Nodes.push_back(NodeImpl);
+  }
+}
+
 std::shared_ptr<node_impl>
 graph_impl::add(const std::shared_ptr<graph_impl> &Impl,
                 const std::vector<sycl::detail::EventImplPtr> Events) {
@@ -623,16 +1078,16 @@ std::vector<sycl::detail::EventImplPtr> graph_impl::getExitNodesEvents() {
 // Check if nodes are empty and if so loop back through predecessors until we
 // find the real dependency.
 void exec_graph_impl::findRealDeps(
-    std::vector<sycl::detail::pi::PiExtSyncPoint> &Deps,
-    std::shared_ptr<node_impl> CurrentNode, int ReferencePartitionNum) {
+    std::vector<sycl::detail::pi::PiExtSyncPoint> &Deps, size_t CurrentIndex,
+    int ReferencePartitionNum) {
+  const std::shared_ptr<node_impl> &CurrentNode = MNodeStorage[CurrentIndex];
   if (CurrentNode->isEmpty()) {
-    for (auto &N : CurrentNode->MPredecessors) {
-      auto NodeImpl = N.lock();
-      findRealDeps(Deps, NodeImpl, ReferencePartitionNum);
+    for (size_t Predecessor : MAdjacency.predecessors(CurrentIndex)) {
+      findRealDeps(Deps, Predecessor, ReferencePartitionNum);
     }
   } else {
     // Verify if CurrentNode belong the the same partition
-    if (MPartitionNodes[CurrentNode] == ReferencePartitionNum) {
+    if (MNodePartitions[CurrentIndex] == ReferencePartitionNum) {
       // Verify that the sync point has actually been set for this node.
       auto SyncPoint = MPiSyncPoints.find(CurrentNode);
       assert(SyncPoint != MPiSyncPoints.end() &&
@@ -651,8 +1106,9 @@ sycl::detail::pi::PiExtSyncPoint exec_graph_impl::enqueueNodeDirect(
     sycl::detail::pi::PiExtCommandBuffer CommandBuffer,
     std::shared_ptr<node_impl> Node) {
   std::vector<sycl::detail::pi::PiExtSyncPoint> Deps;
-  for (auto &N : Node->MPredecessors) {
-    findRealDeps(Deps, N.lock(), MPartitionNodes[Node]);
+  const size_t NodeIndex = MAdjacency.getIndex(Node.get());
+  for (size_t Predecessor : MAdjacency.predecessors(NodeIndex)) {
+    findRealDeps(Deps, Predecessor, MNodePartitions[NodeIndex]);
   }
   sycl::detail::pi::PiExtSyncPoint NewSyncPoint;
   sycl::detail::pi::PiExtCommandBufferCommand NewCommand;
@@ -682,8 +1138,9 @@ sycl::detail::pi::PiExtSyncPoint exec_graph_impl::enqueueNode(
       sycl::property_list{});
 
   std::vector<sycl::detail::pi::PiExtSyncPoint> Deps;
-  for (auto &N : Node->MPredecessors) {
-    findRealDeps(Deps, N.lock(), MPartitionNodes[Node]);
+  const size_t NodeIndex = MAdjacency.getIndex(Node.get());
+  for (size_t Predecessor : MAdjacency.predecessors(NodeIndex)) {
+    findRealDeps(Deps, Predecessor, MNodePartitions[NodeIndex]);
   }
 
   sycl::detail::EventImplPtr Event =
@@ -771,8 +1228,16 @@ exec_graph_impl::exec_graph_impl(sycl::context Context,
                             "Device does not support Command Graph update");
     }
   }
+  if (MIsUpdatable && PropList.has_property<property::graph::enable_fusion>())
+    throw sycl::exception(sycl::make_error_code(errc::invalid),
+                          "property::graph::enable_fusion cannot be used "
+                          "together with property::graph::updatable");
+
   // Copy nodes from GraphImpl and merge any subgraph nodes into this graph.
   duplicateNodes();
+
+  if (PropList.has_property<property::graph::enable_fusion>())
+    fuseKernelChains(PropList);
 }
 
 exec_graph_impl::~exec_graph_impl() {
@@ -807,6 +1272,21 @@ exec_graph_impl::~exec_graph_impl() {
   }
 }
 
+const std::shared_ptr<sycl::detail::queue_impl> &
+exec_graph_impl::getDeviceQueue(const sycl::device &Device) {
+  auto [It, Inserted] = MDeviceQueues.try_emplace(Device);
+  if (Inserted) {
+    // Command-buffers cannot be submitted to queues using immediate
+    // command-lists.
+    It->second = std::make_shared<sycl::detail::queue_impl>(
+        sycl::detail::getSyclObjImpl(Device),
+        sycl::detail::getSyclObjImpl(MContext), sycl::async_handler{},
+        sycl::property_list{
+            sycl::ext::intel::property::queue::no_immediate_command_list{}});
+  }
+  return It->second;
+}
+
 sycl::event
 exec_graph_impl::enqueue(const std::shared_ptr<sycl::detail::queue_impl> &Queue,
                          sycl::detail::CG::StorageInitHelper CGData) {
@@ -816,12 +1296,13 @@ exec_graph_impl::enqueue(const std::shared_ptr<sycl::detail::queue_impl> &Queue,
   std::unordered_map<std::shared_ptr<partition>, sycl::detail::EventImplPtr>
       PartitionsExecutionEvents;
 
-  auto CreateNewEvent([&]() {
-    auto NewEvent = std::make_shared<sycl::detail::event_impl>(Queue);
-    NewEvent->setContextImpl(Queue->getContextImplPtr());
-    NewEvent->setStateIncomplete();
-    return NewEvent;
-  });
+  auto CreateNewEvent(
+      [&](const std::shared_ptr<sycl::detail::queue_impl> &EventQueue) {
+        auto NewEvent = std::make_shared<sycl::detail::event_impl>(EventQueue);
+        NewEvent->setContextImpl(EventQueue->getContextImplPtr());
+        NewEvent->setStateIncomplete();
+        return NewEvent;
+      });
 
   sycl::detail::EventImplPtr NewEvent;
   std::vector<sycl::detail::EventImplPtr> BackupCGDataMEvents;
@@ -840,8 +1321,15 @@ exec_graph_impl::enqueue(const std::shared_ptr<sycl::detail::queue_impl> &Queue,
       CGData.MEvents.push_back(PartitionsExecutionEvents[DepPartition]);
     }
 
+    // Partitions of nodes recorded from queues on other devices than the
+    // graph device are executed on queues of the graph on these devices.
+    const std::shared_ptr<sycl::detail::queue_impl> &PartitionQueue =
+        CurrentPartition->isHostTask() ||
+                CurrentPartition->MDevice == MGraphImpl->getDevice()
+            ? Queue
+            : getDeviceQueue(CurrentPartition->MDevice);
     auto CommandBuffer =
-        CurrentPartition->MPiCommandBuffers[Queue->get_device()];
+        CurrentPartition->MPiCommandBuffers[PartitionQueue->get_device()];
 
     if (CommandBuffer) {
       // if previous submissions are incompleted, we automatically
@@ -865,7 +1353,7 @@ exec_graph_impl::enqueue(const std::shared_ptr<sycl::detail::queue_impl> &Queue,
            It != MExecutionEvents.end();) {
         auto Event = *It;
         if (!Event->isCompleted()) {
-          if (Queue->get_device().get_backend() ==
+          if (PartitionQueue->get_device().get_backend() ==
               sycl::backend::ext_oneapi_level_zero) {
             Event->wait(Event);
           } else {
@@ -884,7 +1372,7 @@ exec_graph_impl::enqueue(const std::shared_ptr<sycl::detail::queue_impl> &Queue,
         }
       }
 
-      NewEvent = CreateNewEvent();
+      NewEvent = CreateNewEvent(PartitionQueue);
       sycl::detail::pi::PiEvent *OutEvent = &NewEvent->getHandleRef();
       // Merge requirements from the nodes into requirements (if any) from the
       // handler.
@@ -893,16 +1381,42 @@ exec_graph_impl::enqueue(const std::shared_ptr<sycl::detail::queue_impl> &Queue,
       CGData.MAccStorage.insert(CGData.MAccStorage.end(), MAccessors.begin(),
                                 MAccessors.end());
 
-      // If we have no requirements or dependent events for the command buffer,
-      // enqueue it directly
-      if (CGData.MRequirements.empty() && CGData.MEvents.empty()) {
+      // If we have no requirements for the command buffer and its dependent
+      // events are native events of the queue context, enqueue it directly
+      // with them as wait list.
+      const sycl::detail::ContextImplPtr &Context =
+          PartitionQueue->getContextImplPtr();
+      auto IsNativeDep = [&](const sycl::detail::EventImplPtr &Event) {
+        if (Event->is_host())
+          return Event->isCompleted();
+        return Event->getHandleRef() != nullptr &&
+               Event->getContextImpl() == Context;
+      };
+      if (CGData.MRequirements.empty() &&
+          std::all_of(CGData.MEvents.begin(), CGData.MEvents.end(),
+                      IsNativeDep)) {
+        std::vector<sycl::detail::pi::PiEvent> RawEvents;
+        for (const auto &Event : CGData.MEvents) {
+          // Completed host events and the events of an in-order queue do not
+          // need to be waited on.
+          if (Event->is_host() ||
+              (PartitionQueue->isInOrder() &&
+               Event->getWorkerQueue() == PartitionQueue))
+            continue;
+          RawEvents.push_back(Event->getHandleRef());
+        }
         if (NewEvent != nullptr)
           NewEvent->setHostEnqueueTime();
+        // Keep the dependencies reported by get_wait_list() the same as if
+        // the command buffer had been enqueued by the scheduler.
+        NewEvent->getPreparedDepsEvents() = CGData.MEvents;
         pi_result Res =
-            Queue->getPlugin()
+            PartitionQueue->getPlugin()
                 ->call_nocheck<
                     sycl::detail::PiApiKind::piextEnqueueCommandBuffer>(
-                    CommandBuffer, Queue->getHandleRef(), 0, nullptr, OutEvent);
+                    CommandBuffer, PartitionQueue->getHandleRef(),
+                    RawEvents.size(),
+                    RawEvents.empty() ? nullptr : RawEvents.data(), OutEvent);
         if (Res == pi_result::PI_ERROR_INVALID_QUEUE_PROPERTIES) {
           throw sycl::exception(
               make_error_code(errc::invalid),
@@ -921,25 +1435,26 @@ exec_graph_impl::enqueue(const std::shared_ptr<sycl::detail::queue_impl> &Queue,
                 CommandBuffer, nullptr, std::move(CGData));
 
         NewEvent = sycl::detail::Scheduler::getInstance().addCG(
-            std::move(CommandGroup), Queue);
+            std::move(CommandGroup), PartitionQueue);
       }
       NewEvent->setEventFromSubmittedExecCommandBuffer(true);
     } else if ((CurrentPartition->MSchedule.size() > 0) &&
                (CurrentPartition->MSchedule.front()->MCGType ==
                 sycl::detail::CG::CGTYPE::CodeplayHostTask)) {
       auto NodeImpl = CurrentPartition->MSchedule.front();
-      // Schedule host task
-      NodeImpl->MCommandGroup->getEvents().insert(
-          NodeImpl->MCommandGroup->getEvents().end(), CGData.MEvents.begin(),
-          CGData.MEvents.end());
+      // Schedule host task. The dependencies are only added to the copy of
+      // the command-group so that they do not accumulate over executions.
+      std::unique_ptr<sycl::detail::CG> CommandGroup = NodeImpl->getCGCopy();
+      CommandGroup->getEvents().insert(CommandGroup->getEvents().end(),
+                                       CGData.MEvents.begin(),
+                                       CGData.MEvents.end());
       // HostTask CG stores the Queue on which the task was submitted.
       // In case of graph, this queue may differ from the actual execution
       // queue. We therefore overload this Queue before submitting the task.
-      static_cast<sycl::detail::CGHostTask &>(*NodeImpl->MCommandGroup.get())
-          .MQueue = Queue;
+      static_cast<sycl::detail::CGHostTask &>(*CommandGroup).MQueue = Queue;
 
       NewEvent = sycl::detail::Scheduler::getInstance().addCG(
-          NodeImpl->getCGCopy(), Queue);
+          std::move(CommandGroup), Queue);
     } else {
       std::vector<std::shared_ptr<sycl::detail::event_impl>> ScheduledEvents;
       for (auto &NodeImpl : CurrentPartition->MSchedule) {
@@ -956,14 +1471,15 @@ exec_graph_impl::enqueue(const std::shared_ptr<sycl::detail::queue_impl> &Queue,
           sycl::detail::CGExecKernel *CG =
               static_cast<sycl::detail::CGExecKernel *>(
                   NodeImpl->MCommandGroup.get());
-          auto OutEvent = CreateNewEvent();
+          auto OutEvent = CreateNewEvent(PartitionQueue);
           pi_int32 Res = sycl::detail::enqueueImpKernel(
-              Queue, CG->MNDRDesc, CG->MArgs, CG->MKernelBundle,
+              PartitionQueue, CG->MNDRDesc, CG->MArgs, CG->MKernelBundle,
               CG->MSyclKernel, CG->MKernelName, RawEvents, OutEvent,
               // TODO: Pass accessor mem allocations
               nullptr,
               // TODO: Extract from handler
-              PI_EXT_KERNEL_EXEC_INFO_CACHE_DEFAULT, CG->MKernelIsCooperative);
+              PI_EXT_KERNEL_EXEC_INFO_CACHE_DEFAULT, CG->MKernelIsCooperative,
+              CG->MKernelNameHash);
           if (Res != pi_result::PI_SUCCESS) {
             throw sycl::exception(
                 sycl::make_error_code(sycl::errc::kernel),
@@ -975,13 +1491,13 @@ exec_graph_impl::enqueue(const std::shared_ptr<sycl::detail::queue_impl> &Queue,
           // dependencies are propagated in findRealDeps
           sycl::detail::EventImplPtr EventImpl =
               sycl::detail::Scheduler::getInstance().addCG(
-                  NodeImpl->getCGCopy(), Queue);
+                  NodeImpl->getCGCopy(), PartitionQueue);
 
           ScheduledEvents.push_back(EventImpl);
         }
       }
       // Create an event which has all kernel events as dependencies
-      NewEvent = std::make_shared<sycl::detail::event_impl>(Queue);
+      NewEvent = std::make_shared<sycl::detail::event_impl>(PartitionQueue);
       NewEvent->setStateIncomplete();
       NewEvent->getPreparedDepsEvents() = ScheduledEvents;
     }
@@ -1155,6 +1671,147 @@ void exec_graph_impl::duplicateNodes() {
   MNodeStorage.insert(MNodeStorage.begin(), NewNodes.begin(), NewNodes.end());
 }
 
+void exec_graph_impl::fuseKernelChains(const property_list &PropList) {
+#if SYCL_EXT_CODEPLAY_KERNEL_FUSION
+  using sycl::detail::CGExecKernel;
+  auto GetKernelCG =
+      [](const std::shared_ptr<node_impl> &Node) -> CGExecKernel * {
+    // Kernels are only fused for the graph device.
+    if (Node->MCGType != sycl::detail::CG::Kernel || Node->MDevice)
+      return nullptr;
+    auto *KernelCG = static_cast<CGExecKernel *>(Node->MCommandGroup.get());
+    if (KernelCG->MKernelIsCooperative || !KernelCG->MStreams.empty())
+      return nullptr;
+    return KernelCG;
+  };
+  auto HasSameRange = [](const sycl::detail::NDRDescT &A,
+                         const sycl::detail::NDRDescT &B) {
+    return A.Dims == B.Dims && A.GlobalSize == B.GlobalSize &&
+           A.LocalSize == B.LocalSize && A.GlobalOffset == B.GlobalOffset &&
+           A.NumWorkGroups == B.NumWorkGroups;
+  };
+  // Kernels with different ranges are fused by the JIT compiler guarding and
+  // remapping the work-items of the fused range, which it can only do for the
+  // ranges without a local size or an offset.
+  auto CanRemap = [](const sycl::detail::NDRDescT &NDRDesc) {
+    return NDRDesc.LocalSize == sycl::range<3>{0, 0, 0} &&
+           NDRDesc.GlobalOffset == sycl::id<3>{0, 0, 0} &&
+           NDRDesc.GlobalSize[0] != 0;
+  };
+  auto CanFuseRanges = [&](const sycl::detail::NDRDescT &A,
+                           const sycl::detail::NDRDescT &B) {
+    return HasSameRange(A, B) || (CanRemap(A) && CanRemap(B));
+  };
+  // The fused kernel runs each of the kernels over the largest of their
+  // ranges, with the work-items outside of the kernel's own range idling.
+  // Fusion is only worth it while at most half of the work-items do so, e.g.
+  // a reduction to a single value fuses with its broadcast, but two such
+  // reductions followed by a broadcast do not.
+  auto IsWorthFusing = [](const std::vector<CGExecKernel *> &KernelCGs) {
+    size_t NumActive = 0;
+    size_t MaxSize = 0;
+    for (auto *KernelCG : KernelCGs) {
+      size_t Size = KernelCG->MNDRDesc.GlobalSize.size();
+      NumActive += Size;
+      MaxSize = std::max(MaxSize, Size);
+    }
+    return 2 * NumActive >= MaxSize * KernelCGs.size();
+  };
+  // Returns the successor of the node if the two can be in the same chain.
+  auto GetNextInChain = [&](const std::shared_ptr<node_impl> &Node)
+      -> std::shared_ptr<node_impl> {
+    if (Node->MSuccessors.size() != 1)
+      return nullptr;
+    auto Next = Node->MSuccessors.front().lock();
+    if (Next->MPredecessors.size() != 1)
+      return nullptr;
+    auto *KernelCG = GetKernelCG(Node);
+    auto *NextKernelCG = GetKernelCG(Next);
+    if (!KernelCG || !NextKernelCG ||
+        !CanFuseRanges(KernelCG->MNDRDesc, NextKernelCG->MNDRDesc))
+      return nullptr;
+    return Next;
+  };
+
+  std::vector<std::vector<std::shared_ptr<node_impl>>> Chains;
+  for (auto &Node : MNodeStorage) {
+    // Chains are collected starting from their first node, and split where
+    // adding the next kernel would make fusion not worth it.
+    if (Node->MPredecessors.size() == 1 &&
+        GetNextInChain(Node->MPredecessors.front().lock()) == Node)
+      continue;
+    std::vector<std::shared_ptr<node_impl>> Chain{Node};
+    std::vector<CGExecKernel *> ChainCGs{GetKernelCG(Node)};
+    while (auto Next = GetNextInChain(Chain.back())) {
+      ChainCGs.push_back(GetKernelCG(Next));
+      if (!IsWorthFusing(ChainCGs)) {
+        if (Chain.size() > 1)
+          Chains.push_back(std::move(Chain));
+        Chain = {};
+        ChainCGs = {ChainCGs.back()};
+      }
+      Chain.push_back(Next);
+    }
+    if (Chain.size() > 1)
+      Chains.push_back(std::move(Chain));
+  }
+  if (Chains.empty())
+    return;
+
+  auto Queue = std::make_shared<sycl::detail::queue_impl>(
+      sycl::detail::getSyclObjImpl(MGraphImpl->getDevice()),
+      sycl::detail::getSyclObjImpl(MContext), sycl::async_handler{},
+      sycl::property_list{});
+  for (auto &Chain : Chains) {
+    std::vector<CGExecKernel *> KernelCGs;
+    for (auto &Node : Chain)
+      KernelCGs.push_back(GetKernelCG(Node));
+    auto FusedCG = sycl::detail::jit_compiler::get_instance().fuseKernels(
+        Queue, KernelCGs, PropList);
+    if (!FusedCG)
+      continue;
+
+    auto First = Chain.front();
+    auto Last = Chain.back();
+    auto FusedNode =
+        std::make_shared<node_impl>(node_type::kernel, std::move(FusedCG));
+    FusedNode->MNDRangeUsed = First->MNDRangeUsed;
+    for (auto &PredWeak : First->MPredecessors) {
+      auto Pred = PredWeak.lock();
+      auto &Successors = Pred->MSuccessors;
+      Successors.erase(std::remove_if(Successors.begin(), Successors.end(),
+                                      [&First](auto WeakNode) {
+                                        return WeakNode.lock() == First;
+                                      }),
+                       Successors.end());
+      Pred->registerSuccessor(FusedNode, Pred);
+    }
+    for (auto &SuccWeak : Last->MSuccessors) {
+      auto Succ = SuccWeak.lock();
+      auto &Predecessors = Succ->MPredecessors;
+      Predecessors.erase(std::remove_if(Predecessors.begin(),
+                                        Predecessors.end(),
+                                        [&Last](auto WeakNode) {
+                                          return WeakNode.lock() == Last;
+                                        }),
+                         Predecessors.end());
+      FusedNode->registerSuccessor(Succ, FusedNode);
+    }
+
+    auto FirstIt = std::find(MNodeStorage.begin(), MNodeStorage.end(), First);
+    *FirstIt = FusedNode;
+    for (auto &Node : Chain) {
+      if (Node != First)
+        MNodeStorage.erase(
+            std::find(MNodeStorage.begin(), MNodeStorage.end(), Node));
+      MFusedNodes.push_back(Node);
+    }
+  }
+#else  // SYCL_EXT_CODEPLAY_KERNEL_FUSION
+  (void)PropList;
+#endif // SYCL_EXT_CODEPLAY_KERNEL_FUSION
+}
+
 void exec_graph_impl::update(std::shared_ptr<node_impl> Node) {
   this->update(std::vector<std::shared_ptr<node_impl>>{Node});
 }
@@ -1175,6 +1832,8 @@ void exec_graph_impl::update(
   // At worst we may have as many requirements as there are for the entire graph
   // for updating.
   UpdateRequirements.reserve(MRequirements.size());
+  std::vector<std::shared_ptr<node_impl>> UpdatedNodes;
+  UpdatedNodes.reserve(Nodes.size());
   for (auto &Node : Nodes) {
     // Check if node(s) derived from this modifiable node exists in this graph
     if (MIDCache.count(Node->getID()) == 0) {
@@ -1186,6 +1845,14 @@ void exec_graph_impl::update(
       throw sycl::exception(errc::invalid, "Cannot update non-kernel nodes");
     }
 
+    // Skip the nodes which didn't change since they were last used to update
+    // this graph, so that only the commands which need it are updated.
+    auto ExecNode = MIDCache.find(Node->MID);
+    if (ExecNode->second->MUpdateVersion == Node->MUpdateVersion) {
+      continue;
+    }
+    UpdatedNodes.push_back(Node);
+
     if (Node->MCommandGroup->getRequirements().size() == 0) {
       continue;
     }
@@ -1196,6 +1863,10 @@ void exec_graph_impl::update(
                               Node->MCommandGroup->getRequirements().end());
   }
 
+  if (UpdatedNodes.empty()) {
+    return;
+  }
+
   // Clean up any execution events which have finished so we don't pass them to
   // the scheduler.
   for (auto It = MExecutionEvents.begin(); It != MExecutionEvents.end();) {
@@ -1217,9 +1888,9 @@ void exec_graph_impl::update(
         sycl::async_handler{}, sycl::property_list{});
     // Don't need to care about the return event here because it is synchronous
     sycl::detail::Scheduler::getInstance().addCommandGraphUpdate(
-        this, Nodes, AllocaQueue, UpdateRequirements, MExecutionEvents);
+        this, UpdatedNodes, AllocaQueue, UpdateRequirements, MExecutionEvents);
   } else {
-    for (auto &Node : Nodes) {
+    for (auto &Node : UpdatedNodes) {
       updateImpl(Node);
     }
   }
@@ -1233,24 +1904,91 @@ void exec_graph_impl::update(
   }
 }
 
-void exec_graph_impl::updateImpl(std::shared_ptr<node_impl> Node) {
-  auto ContextImpl = sycl::detail::getSyclObjImpl(MContext);
-  const sycl::detail::PluginPtr &Plugin = ContextImpl->getPlugin();
-  auto DeviceImpl = sycl::detail::getSyclObjImpl(MGraphImpl->getDevice());
+void exec_graph_impl::update(const std::shared_ptr<graph_impl> &GraphImpl) {
+  const std::vector<std::shared_ptr<node_impl>> &Nodes =
+      MGraphImpl->MNodeStorage;
+  const std::vector<std::shared_ptr<node_impl>> &OtherNodes =
+      GraphImpl->MNodeStorage;
+  if (Nodes.size() != OtherNodes.size()) {
+    throw sycl::exception(sycl::make_error_code(errc::invalid),
+                          "Graph passed to update() has a different number "
+                          "of nodes than the graph being updated.");
+  }
 
-  // Gather arg information from Node
-  auto &ExecCG =
-      *(static_cast<sycl::detail::CGExecKernel *>(Node->MCommandGroup.get()));
-  // Copy args because we may modify them
-  std::vector<sycl::detail::ArgDesc> NodeArgs = ExecCG.getArguments();
-  // Copy NDR desc since we need to modify it
-  auto NDRDesc = ExecCG.MNDRDesc;
+  std::unordered_map<const node_impl *, size_t> Indices, OtherIndices;
+  for (size_t I = 0; I < Nodes.size(); ++I) {
+    Indices[Nodes[I].get()] = I;
+    OtherIndices[OtherNodes[I].get()] = I;
+  }
+  auto GetPredecessors = [](const node_impl &Node, const auto &NodeIndices) {
+    std::vector<size_t> Predecessors;
+    for (const std::weak_ptr<node_impl> &Pred : Node.MPredecessors) {
+      Predecessors.push_back(NodeIndices.at(Pred.lock().get()));
+    }
+    std::sort(Predecessors.begin(), Predecessors.end());
+    return Predecessors;
+  };
+
+  std::vector<std::shared_ptr<node_impl>> UpdateNodes;
+  for (size_t I = 0; I < Nodes.size(); ++I) {
+    const std::shared_ptr<node_impl> &Node = Nodes[I];
+    const std::shared_ptr<node_impl> &OtherNode = OtherNodes[I];
+    if (Node->MNodeType != OtherNode->MNodeType ||
+        GetPredecessors(*Node, Indices) !=
+            GetPredecessors(*OtherNode, OtherIndices)) {
+      throw sycl::exception(sycl::make_error_code(errc::invalid),
+                            "Graph passed to update() has a different "
+                            "topology than the graph being updated.");
+    }
+    if (Node->MCGType != sycl::detail::CG::Kernel) {
+      // Only kernel nodes can be updated, the other ones must be the same.
+      if (GraphImpl != MGraphImpl && Node->MNodeType != node_type::empty) {
+        throw sycl::exception(errc::invalid, "Cannot update non-kernel nodes");
+      }
+      continue;
+    }
+    if (GraphImpl == MGraphImpl) {
+      UpdateNodes.push_back(Node);
+      continue;
+    }
+    auto &KernelCG =
+        static_cast<sycl::detail::CGExecKernel &>(*Node->MCommandGroup);
+    auto &OtherKernelCG =
+        static_cast<sycl::detail::CGExecKernel &>(*OtherNode->MCommandGroup);
+    if (KernelCG.getKernelName() != OtherKernelCG.getKernelName() ||
+        KernelCG.MNDRDesc.Dims != OtherKernelCG.MNDRDesc.Dims) {
+      throw sycl::exception(sycl::make_error_code(errc::invalid),
+                            "Graph passed to update() has a node with another "
+                            "kernel than the graph being updated.");
+    }
+    // The nodes of the other graph are not in the ID cache, a copy of them
+    // takes the ID of the node they update. The node this graph was finalized
+    // from is left as is.
+    auto UpdateNode = std::make_shared<node_impl>(*OtherNode);
+    UpdateNode->MID = Node->MID;
+    UpdateNode->MUpdateVersion =
+        MIDCache.find(Node->MID)->second->MUpdateVersion + 1;
+    UpdateNodes.push_back(std::move(UpdateNode));
+  }
+  update(UpdateNodes);
+}
+
+const exec_graph_impl::kernel_update_info &
+exec_graph_impl::getKernelUpdateInfo(
+    const std::shared_ptr<node_impl> &ExecNode) {
+  auto [It, Inserted] = MKernelUpdateInfo.try_emplace(ExecNode);
+  kernel_update_info &Info = It->second;
+  if (!Inserted) {
+    return Info;
+  }
 
-  pi_kernel PiKernel = nullptr;
+  auto ContextImpl = sycl::detail::getSyclObjImpl(MContext);
+  auto DeviceImpl = sycl::detail::getSyclObjImpl(
+      ExecNode->MDevice.value_or(MGraphImpl->getDevice()));
+  auto &ExecCG = *(
+      static_cast<sycl::detail::CGExecKernel *>(ExecNode->MCommandGroup.get()));
   auto Kernel = ExecCG.MSyclKernel;
   auto KernelBundleImplPtr = ExecCG.MKernelBundle;
-  std::shared_ptr<sycl::detail::kernel_impl> SyclKernelImpl = nullptr;
-  const sycl::detail::KernelArgMask *EliminatedArgMask = nullptr;
 
   // Use kernel_bundle if available unless it is interop.
   // Interop bundles can't be used in the first branch, because the kernels
@@ -1263,24 +2001,55 @@ void exec_graph_impl::updateImpl(std::shared_ptr<node_impl> Node) {
         sycl::detail::ProgramManager::getInstance().getSYCLKernelID(KernelName);
     kernel SyclKernel =
         KernelBundleImplPtr->get_kernel(KernelID, KernelBundleImplPtr);
-    SyclKernelImpl = sycl::detail::getSyclObjImpl(SyclKernel);
-    PiKernel = SyclKernelImpl->getHandleRef();
-    EliminatedArgMask = SyclKernelImpl->getKernelArgMask();
+    Info.MKernelImpl = sycl::detail::getSyclObjImpl(SyclKernel);
+    Info.MPiKernel = Info.MKernelImpl->getHandleRef();
+    Info.MEliminatedArgMask = Info.MKernelImpl->getKernelArgMask();
   } else if (Kernel != nullptr) {
-    PiKernel = Kernel->getHandleRef();
-    EliminatedArgMask = Kernel->getKernelArgMask();
+    Info.MPiKernel = Kernel->getHandleRef();
+    Info.MEliminatedArgMask = Kernel->getKernelArgMask();
   } else {
-    std::tie(PiKernel, std::ignore, EliminatedArgMask, std::ignore) =
+    std::tie(Info.MPiKernel, std::ignore, Info.MEliminatedArgMask,
+             std::ignore) =
         sycl::detail::ProgramManager::getInstance().getOrCreateKernel(
-            ContextImpl, DeviceImpl, ExecCG.MKernelName);
+            ContextImpl, DeviceImpl, ExecCG.MKernelName, {},
+            ExecCG.MKernelNameHash);
   }
 
+  ContextImpl->getPlugin()->call<sycl::detail::PiApiKind::piKernelGetGroupInfo>(
+      Info.MPiKernel, DeviceImpl->getHandleRef(),
+      PI_KERNEL_GROUP_INFO_COMPILE_WORK_GROUP_SIZE,
+      sizeof(Info.MRequiredWGSize), Info.MRequiredWGSize,
+      /* param_value_size_ret = */ nullptr);
+  return Info;
+}
+
+void exec_graph_impl::updateImpl(std::shared_ptr<node_impl> Node) {
+  auto ContextImpl = sycl::detail::getSyclObjImpl(MContext);
+  const sycl::detail::PluginPtr &Plugin = ContextImpl->getPlugin();
+
+  // Query the ID cache to find the equivalent exec node for the node passed to
+  // this function.
+  // TODO: Handle subgraphs or any other cases where multiple nodes may be
+  // associated with a single key, once those node types are supported for
+  // update.
+  auto ExecNode = MIDCache.find(Node->MID);
+  assert(ExecNode != MIDCache.end() && "Node ID was not found in ID cache");
+  const kernel_update_info &KernelInfo = getKernelUpdateInfo(ExecNode->second);
+
+  // Gather arg information from Node
+  auto &ExecCG =
+      *(static_cast<sycl::detail::CGExecKernel *>(Node->MCommandGroup.get()));
+  // Copy args because we may modify them
+  std::vector<sycl::detail::ArgDesc> NodeArgs = ExecCG.getArguments();
+  // Copy NDR desc since we need to modify it
+  auto NDRDesc = ExecCG.MNDRDesc;
+
   // Remove eliminated args
   std::vector<sycl::detail::ArgDesc> MaskedArgs;
   MaskedArgs.reserve(NodeArgs.size());
 
   sycl::detail::applyFuncOnFilteredArgs(
-      EliminatedArgMask, NodeArgs,
+      KernelInfo.MEliminatedArgMask, NodeArgs,
       [&MaskedArgs](sycl::detail::ArgDesc &Arg, int NextTrueIndex) {
         MaskedArgs.emplace_back(Arg.MType, Arg.MPtr, Arg.MSize, NextTrueIndex);
       });
@@ -1288,18 +2057,14 @@ void exec_graph_impl::updateImpl(std::shared_ptr<node_impl> Node) {
   // Reverse kernel dims
   sycl::detail::ReverseRangeDimensionsForKernel(NDRDesc);
 
-  size_t RequiredWGSize[3] = {0, 0, 0};
+  size_t RequiredWGSize[3] = {KernelInfo.MRequiredWGSize[0],
+                               KernelInfo.MRequiredWGSize[1],
+                               KernelInfo.MRequiredWGSize[2]};
   size_t *LocalSize = nullptr;
 
   if (NDRDesc.LocalSize[0] != 0)
     LocalSize = &NDRDesc.LocalSize[0];
   else {
-    Plugin->call<sycl::detail::PiApiKind::piKernelGetGroupInfo>(
-        PiKernel, DeviceImpl->getHandleRef(),
-        PI_KERNEL_GROUP_INFO_COMPILE_WORK_GROUP_SIZE, sizeof(RequiredWGSize),
-        RequiredWGSize,
-        /* param_value_size_ret = */ nullptr);
-
     const bool EnforcedLocalSize =
         (RequiredWGSize[0] != 0 || RequiredWGSize[1] != 0 ||
          RequiredWGSize[2] != 0);
@@ -1376,14 +2141,6 @@ void exec_graph_impl::updateImpl(std::shared_ptr<node_impl> Node) {
   UpdateDesc.local_work_size = LocalSize;
   UpdateDesc.num_work_dim = NDRDesc.Dims;
 
-  // Query the ID cache to find the equivalent exec node for the node passed to
-  // this function.
-  // TODO: Handle subgraphs or any other cases where multiple nodes may be
-  // associated with a single key, once those node types are supported for
-  // update.
-  auto ExecNode = MIDCache.find(Node->MID);
-  assert(ExecNode != MIDCache.end() && "Node ID was not found in ID cache");
-
   // Update ExecNode with new values from Node, in case we ever need to
   // rebuild the command buffers
   ExecNode->second->updateFromOtherNode(Node);
@@ -1422,6 +2179,54 @@ node modifiable_command_graph::addImpl(const std::vector<node> &Deps) {
   return sycl::detail::createSyclObjFromImpl<node>(NodeImpl);
 }
 
+node modifiable_command_graph::addMallocDeviceImpl(
+    void *&Ptr, size_t NumBytes, const std::vector<node> &Deps) {
+  impl->throwIfGraphRecordingQueue(
+      "Explicit API \"add_malloc_device()\" function");
+  std::vector<std::shared_ptr<detail::node_impl>> DepImpls;
+  for (auto &D : Deps) {
+    DepImpls.push_back(sycl::detail::getSyclObjImpl(D));
+  }
+
+  graph_impl::WriteLock Lock(impl->MMutex);
+  std::shared_ptr<detail::node_impl> NodeImpl =
+      impl->addMallocDevice(impl, Ptr, NumBytes, DepImpls);
+  return sycl::detail::createSyclObjFromImpl<node>(NodeImpl);
+}
+
+node modifiable_command_graph::addFreeImpl(void *Ptr,
+                                           const std::vector<node> &Deps) {
+  impl->throwIfGraphRecordingQueue("Explicit API \"add_free()\" function");
+  std::vector<std::shared_ptr<detail::node_impl>> DepImpls;
+  for (auto &D : Deps) {
+    DepImpls.push_back(sycl::detail::getSyclObjImpl(D));
+  }
+
+  graph_impl::WriteLock Lock(impl->MMutex);
+  std::shared_ptr<detail::node_impl> NodeImpl =
+      impl->addFree(impl, Ptr, DepImpls);
+  return sycl::detail::createSyclObjFromImpl<node>(NodeImpl);
+}
+
+node modifiable_command_graph::addConditionalImpl(
+    node_type Type, const int *Condition,
+    const command_graph<graph_state::executable> &Body,
+    const std::vector<node> &Deps) {
+  impl->throwIfGraphRecordingQueue(
+      Type == node_type::ext_oneapi_if
+          ? "Explicit API \"add_if()\" function"
+          : "Explicit API \"add_while()\" function");
+  std::vector<std::shared_ptr<detail::node_impl>> DepImpls;
+  for (auto &D : Deps) {
+    DepImpls.push_back(sycl::detail::getSyclObjImpl(D));
+  }
+
+  graph_impl::WriteLock Lock(impl->MMutex);
+  std::shared_ptr<detail::node_impl> NodeImpl =
+      impl->addConditional(impl, Type, Condition, Body, DepImpls);
+  return sycl::detail::createSyclObjFromImpl<node>(NodeImpl);
+}
+
 node modifiable_command_graph::addImpl(std::function<void(handler &)> CGF,
                                        const std::vector<node> &Deps) {
   impl->throwIfGraphRecordingQueue("Explicit API \"Add()\" function");
@@ -1476,7 +2281,8 @@ bool modifiable_command_graph::begin_recording(queue &RecordingQueue) {
                           "begin_recording called for a queue whose context "
                           "differs from the graph context.");
   }
-  if (QueueImpl->get_device() != impl->getDevice()) {
+  if (QueueImpl->get_device() != impl->getDevice() &&
+      !impl->allowsMultiDevice()) {
     throw sycl::exception(sycl::make_error_code(errc::invalid),
                           "begin_recording called for a queue whose device "
                           "differs from the graph device.");
@@ -1488,17 +2294,6 @@ bool modifiable_command_graph::begin_recording(queue &RecordingQueue) {
                           "can NOT be recorded.");
   }
 
-  if (QueueImpl->get_context() != impl->getContext()) {
-    throw sycl::exception(sycl::make_error_code(errc::invalid),
-                          "begin_recording called for a queue whose context "
-                          "differs from the graph context.");
-  }
-  if (QueueImpl->get_device() != impl->getDevice()) {
-    throw sycl::exception(sycl::make_error_code(errc::invalid),
-                          "begin_recording called for a queue whose device "
-                          "differs from the graph device.");
-  }
-
   if (QueueImpl->getCommandGraph() == nullptr) {
     QueueImpl->setCommandGraph(impl);
     graph_impl::WriteLock Lock(impl->MMutex);
@@ -1567,6 +2362,32 @@ void modifiable_command_graph::print_graph(std::string path,
   }
 }
 
+std::vector<std::byte>
+modifiable_command_graph::serialize(const std::vector<void *> &Pointers) const {
+  graph_impl::ReadLock Lock(impl->MMutex);
+  return impl->serialize(Pointers);
+}
+
+void modifiable_command_graph::deserialize(
+    const std::vector<std::byte> &Data,
+    const std::vector<dynamic_parameter<void *>> &Pointers) {
+  impl->throwIfGraphRecordingQueue("Explicit API \"deserialize()\" function");
+  std::vector<std::shared_ptr<dynamic_parameter_impl>> PointerImpls;
+  for (auto &Pointer : Pointers) {
+    auto PointerImpl = sycl::detail::getSyclObjImpl(Pointer);
+    if (PointerImpl->MGraph != impl) {
+      throw sycl::exception(
+          make_error_code(errc::invalid),
+          "Cannot use a Dynamic Parameter with a node associated with a graph "
+          "other than the one it was created with.");
+    }
+    PointerImpls.push_back(PointerImpl);
+  }
+
+  graph_impl::WriteLock Lock(impl->MMutex);
+  impl->deserialize(impl, Data, PointerImpls);
+}
+
 std::vector<node> modifiable_command_graph::get_nodes() const {
   return createNodesFromImpls(impl->MNodeStorage);
 }
@@ -1586,21 +2407,32 @@ executable_command_graph::executable_command_graph(
 }
 
 void executable_command_graph::finalizeImpl() {
+  using Clock = std::chrono::steady_clock;
+  const auto PartitioningStart = Clock::now();
   impl->makePartitions();
 
-  auto Device = impl->getGraphImpl()->getDevice();
+  const auto CommandBuffersStart = Clock::now();
   for (auto Partition : impl->getPartitions()) {
     if (!Partition->isHostTask()) {
-      impl->createCommandBuffers(Device, Partition);
+      impl->createCommandBuffers(Partition->MDevice, Partition);
     }
   }
+
+  // Keep the timings in the modifiable graph (locked by finalize) so that they
+  // can be reported by print_graph.
+  finalize_timings Timings;
+  Timings.MNumNodes = impl->getSchedule().size();
+  Timings.MNumPartitions = impl->getPartitions().size();
+  Timings.MPartitioning = CommandBuffersStart - PartitioningStart;
+  Timings.MCommandBuffers = Clock::now() - CommandBuffersStart;
+  impl->getGraphImpl()->setFinalizeTimings(Timings);
 }
 
 void executable_command_graph::update(
     const command_graph<graph_state::modifiable> &Graph) {
-  (void)Graph;
-  throw sycl::exception(sycl::make_error_code(errc::invalid),
-                        "Method not yet implemented");
+  std::shared_ptr<graph_impl> GraphImpl = sycl::detail::getSyclObjImpl(Graph);
+  graph_impl::ReadLock Lock(GraphImpl->MMutex);
+  impl->update(GraphImpl);
 }
 
 void executable_command_graph::update(const node &Node) {
@@ -15,16 +15,20 @@
 
 #include <detail/accessor_impl.hpp>
 #include <detail/event_impl.hpp>
+#include <detail/kernel_arg_mask.hpp>
 #include <detail/kernel_impl.hpp>
 #include <detail/sycl_mem_obj_t.hpp>
 
+#include <chrono>
 #include <cstring>
 #include <deque>
 #include <fstream>
 #include <functional>
 #include <list>
+#include <optional>
 #include <set>
 #include <shared_mutex>
+#include <unordered_set>
 
 namespace sycl {
 inline namespace _V1 {
@@ -99,14 +103,18 @@ public:
   /// Used for tracking visited status during cycle checks.
   bool MVisited = false;
 
-  /// Partition number needed to assign a Node to a a partition.
-  /// Note : This number is only used during the partitionning process and
-  /// cannot be used to find out the partion of a node outside of this process.
-  int MPartitionNum = -1;
-
   /// Track whether an ND-Range was used for kernel nodes
   bool MNDRangeUsed = false;
 
+  /// Incremented whenever the arguments or the execution range of the node
+  /// are updated. Nodes of executable graphs keep the version they were last
+  /// updated from, so that update() can skip the ones which are up to date.
+  uint64_t MUpdateVersion = 0;
+
+  /// Device the node executes on if it was recorded from a queue on another
+  /// device than the graph device.
+  std::optional<sycl::device> MDevice;
+
   /// Add successor to the node.
   /// @param Node Node to add as a successor.
   /// @param Prev Predecessor to \p node being added as successor.
@@ -160,7 +168,8 @@ public:
   node_impl(node_impl &Other)
       : MSuccessors(Other.MSuccessors), MPredecessors(Other.MPredecessors),
         MCGType(Other.MCGType), MNodeType(Other.MNodeType),
-        MCommandGroup(Other.getCGCopy()), MSubGraphImpl(Other.MSubGraphImpl) {}
+        MCommandGroup(Other.getCGCopy()), MSubGraphImpl(Other.MSubGraphImpl),
+        MUpdateVersion(Other.MUpdateVersion), MDevice(Other.MDevice) {}
 
   /// Copy-assignment operator. This will perform a deep-copy of the
   /// command group object associated with this node.
@@ -172,6 +181,8 @@ public:
       MNodeType = Other.MNodeType;
       MCommandGroup = Other.getCGCopy();
       MSubGraphImpl = Other.MSubGraphImpl;
+      MUpdateVersion = Other.MUpdateVersion;
+      MDevice = Other.MDevice;
     }
     return *this;
   }
@@ -378,8 +389,7 @@ public:
     }
 
     for (std::weak_ptr<node_impl> Succ : MSuccessors) {
-      if (MPartitionNum == Succ.lock()->MPartitionNum)
-        Succ.lock()->printDotRecursive(Stream, Visited, Verbose);
+      Succ.lock()->printDotRecursive(Stream, Visited, Verbose);
     }
   }
 
@@ -432,6 +442,7 @@ public:
         }
       }
       Arg.MPtr = NewAccImpl.get();
+      MUpdateVersion++;
       break;
     }
   }
@@ -448,6 +459,7 @@ public:
       // MPtr may be a pointer into arg storage so we memcpy the contents of
       // NewValue rather than assign it directly
       std::memcpy(Arg.MPtr, NewValue, Size);
+      MUpdateVersion++;
       break;
     }
   }
@@ -477,6 +489,7 @@ public:
     }
 
     NDRDesc.set(ExecutionRange);
+    MUpdateVersion++;
   }
 
   template <int Dimensions> void updateRange(range<Dimensions> ExecutionRange) {
@@ -503,6 +516,7 @@ public:
     }
 
     NDRDesc.set(ExecutionRange);
+    MUpdateVersion++;
   }
 
   void updateFromOtherNode(const std::shared_ptr<node_impl> &Other) {
@@ -515,6 +529,7 @@ public:
     ExecCG->MNDRDesc = OtherExecCG->MNDRDesc;
     ExecCG->getAccStorage() = OtherExecCG->getAccStorage();
     ExecCG->getRequirements() = OtherExecCG->getRequirements();
+    MUpdateVersion = Other->MUpdateVersion;
 
     auto &OldArgStorage = OtherExecCG->getArgsStorage();
     auto &NewArgStorage = ExecCG->getArgsStorage();
@@ -767,8 +782,12 @@ private:
 class partition {
 public:
   /// Constructor.
-  partition() : MSchedule(), MPiCommandBuffers() {}
+  /// @param Device Device the nodes of the partition execute on.
+  partition(const sycl::device &Device)
+      : MDevice(Device), MSchedule(), MPiCommandBuffers() {}
 
+  /// Device the nodes of the partition execute on.
+  sycl::device MDevice;
   /// List of root nodes.
   std::set<std::weak_ptr<node_impl>, std::owner_less<std::weak_ptr<node_impl>>>
       MRoots;
@@ -785,9 +804,75 @@ public:
     return (MRoots.size() && ((*MRoots.begin()).lock()->MCGType ==
                               sycl::detail::CG::CGTYPE::CodeplayHostTask));
   }
+};
+
+/// Edges of a set of nodes in compressed sparse row form, with the nodes
+/// identified by their position in the set. Executable graphs build it once
+/// their nodes are final, so that traversing the graph doesn't lock the
+/// pointers of each edge.
+class node_adjacency {
+public:
+  /// Indices of the successors or of the predecessors of a node.
+  class index_range {
+  public:
+    index_range(const size_t *Begin, const size_t *End)
+        : MBegin(Begin), MEnd(End) {}
+
+    const size_t *begin() const { return MBegin; }
+    const size_t *end() const { return MEnd; }
+    size_t size() const { return MEnd - MBegin; }
+
+  private:
+    const size_t *MBegin;
+    const size_t *MEnd;
+  };
+
+  node_adjacency() = default;
+
+  /// Constructor.
+  /// @param Nodes Nodes to build the adjacency of. All the successors and
+  /// predecessors of the nodes must be part of \p Nodes.
+  node_adjacency(const std::vector<std::shared_ptr<node_impl>> &Nodes);
+
+  /// @return Index of a node of the set.
+  size_t getIndex(node_impl *Node) const { return MIndices.at(Node); }
+
+  /// @return Indices of the successors of the node at \p Index.
+  index_range successors(size_t Index) const {
+    return getRow(MSuccessorOffsets, MSuccessorIndices, Index);
+  }
+
+  /// @return Indices of the predecessors of the node at \p Index.
+  index_range predecessors(size_t Index) const {
+    return getRow(MPredecessorOffsets, MPredecessorIndices, Index);
+  }
+
+private:
+  static index_range getRow(const std::vector<size_t> &Offsets,
+                            const std::vector<size_t> &Indices, size_t Index) {
+    return {Indices.data() + Offsets[Index],
+            Indices.data() + Offsets[Index + 1]};
+  }
 
-  /// Add nodes to MSchedule.
-  void schedule();
+  std::unordered_map<node_impl *, size_t> MIndices;
+  /// The edges of the node at index I are the elements
+  /// [Offsets[I], Offsets[I + 1]) of the index vectors.
+  std::vector<size_t> MSuccessorOffsets;
+  std::vector<size_t> MSuccessorIndices;
+  std::vector<size_t> MPredecessorOffsets;
+  std::vector<size_t> MPredecessorIndices;
+};
+
+/// Durations of the phases of a graph finalization.
+struct finalize_timings {
+  /// Number of nodes in the executable graph.
+  size_t MNumNodes = 0;
+  /// Number of partitions in the executable graph.
+  size_t MNumPartitions = 0;
+  /// Time spent partitioning and scheduling the nodes.
+  std::chrono::steady_clock::duration MPartitioning{};
+  /// Time spent creating the command-buffers of the partitions.
+  std::chrono::steady_clock::duration MCommandBuffers{};
 };
 
 /// Implementation details of command_graph<modifiable>.
@@ -814,6 +899,9 @@ public:
             .has_property<property::graph::assume_buffer_outlives_graph>()) {
       MAllowBuffers = true;
     }
+    if (PropList.has_property<property::graph::enable_multi_device>()) {
+      MAllowMultiDevice = true;
+    }
 
     if (!SyclDevice.has(aspect::ext_oneapi_limited_graph) &&
         !SyclDevice.has(aspect::ext_oneapi_graph)) {
@@ -861,6 +949,57 @@ public:
   add(const std::shared_ptr<graph_impl> &Impl,
       const std::vector<std::shared_ptr<node_impl>> &Dep = {});
 
+  /// Create a node allocating device memory owned by the graph. The memory of
+  /// a previous allocation is reused if it has been freed by a predecessor of
+  /// the new node, so that allocations with disjoint lifetimes alias.
+  /// @param Impl Graph implementation pointer.
+  /// @param[out] Ptr Set to the allocated memory.
+  /// @param NumBytes Number of bytes to allocate.
+  /// @param Dep List of predecessor nodes.
+  /// @return Created node in the graph.
+  std::shared_ptr<node_impl>
+  addMallocDevice(const std::shared_ptr<graph_impl> &Impl, void *&Ptr,
+                  size_t NumBytes,
+                  const std::vector<std::shared_ptr<node_impl>> &Dep = {});
+
+  /// Create a node freeing memory allocated by an allocation node.
+  /// @param Impl Graph implementation pointer.
+  /// @param Ptr Memory to free.
+  /// @param Dep List of predecessor nodes.
+  /// @return Created node in the graph.
+  std::shared_ptr<node_impl>
+  addFree(const std::shared_ptr<graph_impl> &Impl, void *Ptr,
+          const std::vector<std::shared_ptr<node_impl>> &Dep = {});
+
+  /// Create a node executing a graph if, or for as long as, a condition is
+  /// non-zero.
+  /// @param Impl Graph implementation pointer.
+  /// @param Type Type of the node, ext_oneapi_if or ext_oneapi_while.
+  /// @param Condition USM allocation holding the condition.
+  /// @param Body Graph executed by the node.
+  /// @param Dep List of predecessor nodes.
+  /// @return Created node in the graph.
+  std::shared_ptr<node_impl>
+  addConditional(const std::shared_ptr<graph_impl> &Impl, node_type Type,
+                 const int *Condition,
+                 const command_graph<graph_state::executable> &Body,
+                 const std::vector<std::shared_ptr<node_impl>> &Dep = {});
+
+  /// Serializes the nodes of the graph in topological order.
+  /// @param Pointers USM pointers which may be kernel arguments, stored as
+  /// placeholders.
+  /// @return The serialized graph.
+  std::vector<std::byte> serialize(const std::vector<void *> &Pointers) const;
+
+  /// Adds the nodes of a serialized graph to this graph.
+  /// @param Impl Graph implementation pointer.
+  /// @param Data The serialized graph.
+  /// @param Pointers Dynamic parameters replacing the pointer placeholders.
+  void deserialize(
+      const std::shared_ptr<graph_impl> &Impl,
+      const std::vector<std::byte> &Data,
+      const std::vector<std::shared_ptr<dynamic_parameter_impl>> &Pointers);
+
   /// Create an empty node in the graph.
   /// @param Impl Graph implementation pointer.
   /// @param Events List of events associated to this node.
@@ -948,6 +1087,12 @@ public:
   /// @return Device associated with graph.
   sycl::device getDevice() const { return MDevice; }
 
+  /// Query whether queues on other devices than the graph device can be
+  /// recorded to this graph.
+  /// @return True if the graph was created with the enable_multi_device
+  /// property.
+  bool allowsMultiDevice() const { return MAllowMultiDevice; }
+
   /// List of root nodes.
   std::set<std::weak_ptr<node_impl>, std::owner_less<std::weak_ptr<node_impl>>>
       MRoots;
@@ -994,11 +1139,36 @@ public:
     for (std::weak_ptr<node_impl> Node : MRoots)
       Node.lock()->printDotRecursive(Stream, VisitedNodes, Verbose);
 
+    if (Verbose && MLastFinalizeTimings) {
+      using std::chrono::duration_cast;
+      using std::chrono::microseconds;
+      Stream << "// Last finalize: " << MLastFinalizeTimings->MNumNodes
+             << " nodes, " << MLastFinalizeTimings->MNumPartitions
+             << " partitions" << std::endl;
+      Stream << "//   partitioning: "
+             << duration_cast<microseconds>(
+                    MLastFinalizeTimings->MPartitioning)
+                    .count()
+             << " us" << std::endl;
+      Stream << "//   command-buffers: "
+             << duration_cast<microseconds>(
+                    MLastFinalizeTimings->MCommandBuffers)
+                    .count()
+             << " us" << std::endl;
+    }
+
     Stream << "}" << std::endl;
 
     Stream.close();
   }
 
+  /// Stores the durations of the last finalization of this graph, reported
+  /// by printGraphAsDot in verbose mode.
+  /// @param Timings Durations of the finalization phases.
+  void setFinalizeTimings(const finalize_timings &Timings) {
+    MLastFinalizeTimings = Timings;
+  }
+
   /// Make an edge between two nodes in the graph. Performs some mandatory
   /// error checks as well as an optional check for cycles introduced by making
   /// this edge.
@@ -1226,11 +1396,30 @@ private:
   /// presence of the assume_buffer_outlives_graph property.
   bool MAllowBuffers = false;
 
+  /// Controls whether queues on any device of the graph context can record to
+  /// the graph. Set by the presence of the enable_multi_device property.
+  bool MAllowMultiDevice = false;
+
   /// List of nodes that must be added as extra dependencies to new nodes when
   /// added to this graph.
   /// This list is mainly used by barrier nodes which must be considered
   /// as predecessors for all nodes subsequently added to the graph.
   std::list<std::shared_ptr<node_impl>> MExtraDependencies;
+
+  /// Durations of the last finalization of this graph.
+  std::optional<finalize_timings> MLastFinalizeTimings;
+
+  /// Device memory backing the allocation nodes of the graph.
+  struct device_allocation {
+    void *MPtr;
+    size_t MSize;
+    /// True if an allocation node using the memory hasn't been freed yet.
+    bool MInUse;
+    /// Free node of the last allocation which used the memory.
+    std::shared_ptr<node_impl> MFreeNode;
+  };
+  /// Memory of the allocation nodes, freed with the graph.
+  std::vector<device_allocation> MDeviceAllocations;
 };
 
 /// Class representing the implementation of command_graph<executable>.
@@ -1323,9 +1512,33 @@ public:
   void update(std::shared_ptr<node_impl> Node);
   void update(const std::vector<std::shared_ptr<node_impl>> Nodes);
 
+  /// Updates the kernel nodes of this graph with the arguments and ranges of
+  /// the nodes of another graph with the same topology, the nodes of both
+  /// graphs being matched in the order they were added.
+  /// @param GraphImpl Graph to use the nodes of.
+  void update(const std::shared_ptr<graph_impl> &GraphImpl);
+
   void updateImpl(std::shared_ptr<node_impl> NodeImpl);
 
 private:
+  /// Information about the kernel of a node needed to update its command,
+  /// which doesn't change when the node is updated.
+  struct kernel_update_info {
+    pi_kernel MPiKernel = nullptr;
+    const sycl::detail::KernelArgMask *MEliminatedArgMask = nullptr;
+    /// Work-group size the kernel was compiled with, zeroes if there is none.
+    size_t MRequiredWGSize[3] = {0, 0, 0};
+    /// Keeps the kernel obtained from a kernel bundle alive.
+    std::shared_ptr<sycl::detail::kernel_impl> MKernelImpl;
+  };
+
+  /// Gets the kernel information of a node, looking it up on the first update
+  /// of the node only.
+  /// @param ExecNode Kernel node of this graph.
+  /// @return Kernel information of the node.
+  const kernel_update_info &
+  getKernelUpdateInfo(const std::shared_ptr<node_impl> &ExecNode);
+
   /// Create a command-group for the node and add it to command-buffer by going
   /// through the scheduler.
   /// @param Ctx Context to use.
@@ -1350,21 +1563,35 @@ private:
                     sycl::detail::pi::PiExtCommandBuffer CommandBuffer,
                     std::shared_ptr<node_impl> Node);
 
+  /// Gets the queue used to execute the partitions of a device which is not
+  /// the graph device, creating it on first use.
+  /// @param Device Device of the partitions.
+  /// @return Queue on \p Device in the context of the graph.
+  const std::shared_ptr<sycl::detail::queue_impl> &
+  getDeviceQueue(const sycl::device &Device);
+
   /// Iterates back through predecessors to find the real dependency.
   /// @param[out] Deps Found dependencies.
-  /// @param[in] CurrentNode Node to find dependencies for.
+  /// @param[in] CurrentIndex Index of the node to find dependencies for.
   /// @param[in] ReferencePartitionNum Number of the partition containing the
   /// SyncPoint for CurrentNode, otherwise we need to
   /// synchronize on the host with the completion of previous partitions.
   void findRealDeps(std::vector<sycl::detail::pi::PiExtSyncPoint> &Deps,
-                    std::shared_ptr<node_impl> CurrentNode,
-                    int ReferencePartitionNum);
+                    size_t CurrentIndex, int ReferencePartitionNum);
 
   /// Duplicate nodes from the modifiable graph associated with this executable
   /// graph and store them locally. Any subgraph nodes in the modifiable graph
   /// will be expanded and merged into this new set of nodes.
   void duplicateNodes();
 
+  /// Replaces each chain of kernel nodes, in which every node is the only
+  /// successor of the previous one and the only predecessor of the next one,
+  /// by a node running a kernel fused by the JIT compiler. Chains which cannot
+  /// be fused are kept as they are.
+  /// @param PropList Properties passed to finalize, which are forwarded to the
+  /// JIT compiler.
+  void fuseKernelChains(const property_list &PropList);
+
   /// Prints the contents of the graph to a text file in DOT format.
   /// @param FilePath Path to the output file.
   /// @param Verbose If true, print additional information about the nodes such
@@ -1405,9 +1632,11 @@ private:
   std::unordered_map<std::shared_ptr<node_impl>,
                      sycl::detail::pi::PiExtSyncPoint>
       MPiSyncPoints;
-  /// Map of nodes in the exec graph to the partition number to which they
-  /// belong.
-  std::unordered_map<std::shared_ptr<node_impl>, int> MPartitionNodes;
+  /// Edges of the nodes of the exec graph, indexed like MNodeStorage.
+  node_adjacency MAdjacency;
+  /// Partition number of each node of the exec graph, indexed like
+  /// MNodeStorage.
+  std::vector<int> MNodePartitions;
   /// Context associated with this executable graph.
   sycl::context MContext;
   /// List of requirements for enqueueing this command graph, accumulated from
@@ -1428,10 +1657,20 @@ private:
       MCommandMap;
   /// True if this graph can be updated (set with property::updatable)
   bool MIsUpdatable;
+  /// Queues executing the partitions of the devices other than the graph
+  /// device.
+  std::unordered_map<sycl::device, std::shared_ptr<sycl::detail::queue_impl>>
+      MDeviceQueues;
+  /// Nodes replaced by fused kernels. The arguments of the fused kernels point
+  /// into the storage of their command groups, so they are kept alive.
+  std::vector<std::shared_ptr<node_impl>> MFusedNodes;
 
   // Stores a cache of node ids from modifiable graph nodes to the companion
   // node(s) in this graph. Used for quick access when updating this graph.
   std::multimap<node_impl::id_type, std::shared_ptr<node_impl>> MIDCache;
+  /// Kernel information of the nodes which have been updated.
+  std::unordered_map<std::shared_ptr<node_impl>, kernel_update_info>
+      MKernelUpdateInfo;
 };
 
 class dynamic_parameter_impl {
@@ -111,6 +111,13 @@ public:
 
   bool MKernelIsCooperative = false;
 
+  // Hash of the kernel name computed at compile time, 0 if it is unknown.
+  uint64_t MKernelNameHash = 0;
+
+  // False if the command is submitted without an event, which lets the
+  // scheduler bypass enqueue it without an output PI event.
+  bool MEventNeeded = true;
+
   // Extra information for bindless image copy
   sycl::detail::pi::PiMemImageDesc MImageDesc;
   sycl::detail::pi::PiMemImageFormat MImageFormat;
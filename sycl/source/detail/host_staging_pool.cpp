@@ -0,0 +1,76 @@
+//==------- host_staging_pool.cpp - Pinned host staging buffers ------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/context_impl.hpp>
+#include <detail/host_staging_pool.hpp>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+
+void *host_staging_pool::acquire() {
+  staging_buffer Buffer{nullptr, nullptr};
+  {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    if (!MFreeBuffers.empty()) {
+      Buffer = MFreeBuffers.back();
+      MFreeBuffers.pop_back();
+    }
+  }
+
+  const PluginPtr &Plugin = MContext->getPlugin();
+  if (Buffer.MPtr) {
+    if (Buffer.MEvent) {
+      Plugin->call<PiApiKind::piEventsWait>(1, &Buffer.MEvent);
+      Plugin->call<PiApiKind::piEventRelease>(Buffer.MEvent);
+    }
+    return Buffer.MPtr;
+  }
+
+  pi_usm_mem_properties Props[] = {0};
+  pi_result Error = Plugin->call_nocheck<PiApiKind::piextUSMHostAlloc>(
+      &Buffer.MPtr, MContext->getHandleRef(), Props, BufferSize,
+      /*Alignment=*/0);
+  return Error == PI_SUCCESS ? Buffer.MPtr : nullptr;
+}
+
+void host_staging_pool::release(void *Buffer,
+                                sycl::detail::pi::PiEvent Event) {
+  {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    if (MFreeBuffers.size() < MaxFreeBuffers) {
+      MFreeBuffers.push_back({Buffer, Event});
+      return;
+    }
+  }
+
+  const PluginPtr &Plugin = MContext->getPlugin();
+  if (Event) {
+    Plugin->call<PiApiKind::piEventsWait>(1, &Event);
+    Plugin->call<PiApiKind::piEventRelease>(Event);
+  }
+  Plugin->call<PiApiKind::piextUSMFree>(MContext->getHandleRef(), Buffer);
+}
+
+void host_staging_pool::clear() {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  const PluginPtr &Plugin = MContext->getPlugin();
+  for (staging_buffer &Buffer : MFreeBuffers) {
+    if (Buffer.MEvent) {
+      Plugin->call_nocheck<PiApiKind::piEventsWait>(1, &Buffer.MEvent);
+      Plugin->call_nocheck<PiApiKind::piEventRelease>(Buffer.MEvent);
+    }
+    Plugin->call_nocheck<PiApiKind::piextUSMFree>(MContext->getHandleRef(),
+                                                  Buffer.MPtr);
+  }
+  MFreeBuffers.clear();
+}
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
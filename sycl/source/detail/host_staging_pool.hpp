@@ -0,0 +1,70 @@
+//==------- host_staging_pool.hpp - Pinned host staging buffers ------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sycl/detail/pi.hpp>
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+class context_impl;
+
+/// Pinned host buffers of a context through which the copies between pageable
+/// host memory and device buffers are staged, so that the backend can use DMA
+/// transfers for them.
+class host_staging_pool {
+public:
+  /// Size of each staging buffer, and so of the chunks of a staged copy.
+  static constexpr size_t BufferSize = 4 * 1024 * 1024;
+
+  host_staging_pool() = default;
+  host_staging_pool(const host_staging_pool &) = delete;
+  host_staging_pool &operator=(const host_staging_pool &) = delete;
+
+  void setContextPtr(const context_impl *Context) { MContext = Context; }
+
+  /// Gets a staging buffer of BufferSize bytes, waiting for the last command
+  /// using it if needed.
+  ///
+  /// \return the buffer, or nullptr if the backend failed to allocate it.
+  void *acquire();
+
+  /// Returns a staging buffer to the pool.
+  ///
+  /// \param Buffer is a buffer returned by acquire().
+  /// \param Event is the event of the last command using the buffer, owned by
+  /// the pool from then on, or nullptr.
+  void release(void *Buffer, sycl::detail::pi::PiEvent Event);
+
+  /// Frees all the staging buffers. Must be called before the native context
+  /// is released.
+  void clear();
+
+private:
+  struct staging_buffer {
+    void *MPtr;
+    sycl::detail::pi::PiEvent MEvent;
+  };
+
+  /// At most this many free buffers are kept, i.e. enough for two copies
+  /// running at the same time.
+  static constexpr size_t MaxFreeBuffers = 4;
+
+  const context_impl *MContext = nullptr;
+  std::vector<staging_buffer> MFreeBuffers;
+  std::mutex MMutex;
+};
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
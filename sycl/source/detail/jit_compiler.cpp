@@ -9,11 +9,14 @@
 #if SYCL_EXT_CODEPLAY_KERNEL_FUSION
 #include <KernelFusion.h>
 #include <detail/device_image_impl.hpp>
+#include <detail/global_handler.hpp>
 #include <detail/jit_compiler.hpp>
 #include <detail/kernel_bundle_impl.hpp>
 #include <detail/kernel_impl.hpp>
+#include <detail/persistent_device_code_cache.hpp>
 #include <detail/queue_impl.hpp>
 #include <detail/sycl_mem_obj_t.hpp>
+#include <detail/thread_pool.hpp>
 #include <sycl/detail/pi.hpp>
 #include <sycl/ext/codeplay/experimental/fusion_properties.hpp>
 #include <sycl/kernel_bundle.hpp>
@@ -35,8 +38,8 @@ translateBinaryImageFormat(pi::PiDeviceBinaryType Type) {
   }
 }
 
-::jit_compiler::BinaryFormat getTargetFormat(QueueImplPtr &Queue) {
-  auto Backend = Queue->getDeviceImplPtr()->getBackend();
+::jit_compiler::BinaryFormat getTargetFormat(const DeviceImplPtr &Device) {
+  auto Backend = Device->getBackend();
   switch (Backend) {
   case backend::ext_oneapi_level_zero:
   case backend::opencl:
@@ -52,49 +55,58 @@ translateBinaryImageFormat(pi::PiDeviceBinaryType Type) {
   }
 }
 
-::jit_compiler::TargetInfo getTargetInfo(QueueImplPtr &Queue) {
-  ::jit_compiler::BinaryFormat Format = getTargetFormat(Queue);
+::jit_compiler::TargetInfo getTargetInfo(const DeviceImplPtr &Device) {
+  ::jit_compiler::BinaryFormat Format = getTargetFormat(Device);
   return ::jit_compiler::TargetInfo::get(
-      Format, static_cast<::jit_compiler::DeviceArchitecture>(
-                  Queue->getDeviceImplPtr()->getDeviceArch()));
+      Format,
+      static_cast<::jit_compiler::DeviceArchitecture>(Device->getDeviceArch()));
 }
 
-std::pair<const RTDeviceBinaryImage *, sycl::detail::pi::PiProgram>
-retrieveKernelBinary(QueueImplPtr &Queue, CGExecKernel *KernelCG) {
-  auto KernelName = KernelCG->getKernelName();
+::jit_compiler::TargetInfo getTargetInfo(QueueImplPtr &Queue) {
+  return getTargetInfo(Queue->getDeviceImplPtr());
+}
 
+// The CUDA and HIP kernels are taken from the LLVM bitcode images embedded
+// next to their native images.
+const RTDeviceBinaryImage *retrieveIRImage(QueueImplPtr &Queue,
+                                           const std::string &KernelName) {
   bool isNvidia =
       Queue->getDeviceImplPtr()->getBackend() == backend::ext_oneapi_cuda;
-  bool isHIP =
-      Queue->getDeviceImplPtr()->getBackend() == backend::ext_oneapi_hip;
-  if (isNvidia || isHIP) {
-    auto KernelID = ProgramManager::getInstance().getSYCLKernelID(KernelName);
-    std::vector<kernel_id> KernelIds{KernelID};
-    auto DeviceImages =
-        ProgramManager::getInstance().getRawDeviceImages(KernelIds);
-    auto DeviceImage = std::find_if(
-        DeviceImages.begin(), DeviceImages.end(),
-        [isNvidia](RTDeviceBinaryImage *DI) {
-          const std::string &TargetSpec = isNvidia ? std::string("llvm_nvptx64")
-                                                   : std::string("llvm_amdgcn");
-          return DI->getFormat() == PI_DEVICE_BINARY_TYPE_LLVMIR_BITCODE &&
-                 DI->getRawData().DeviceTargetSpec == TargetSpec;
-        });
-    if (DeviceImage == DeviceImages.end()) {
-      return {nullptr, nullptr};
-    }
-    auto ContextImpl = Queue->getContextImplPtr();
-    auto Context = detail::createSyclObjFromImpl<context>(ContextImpl);
-    auto DeviceImpl = Queue->getDeviceImplPtr();
-    auto Device = detail::createSyclObjFromImpl<device>(DeviceImpl);
-    sycl::detail::pi::PiProgram Program =
-        detail::ProgramManager::getInstance().createPIProgram(**DeviceImage,
-                                                              Context, Device);
-    return {*DeviceImage, Program};
+  auto KernelID = ProgramManager::getInstance().getSYCLKernelID(KernelName);
+  std::vector<kernel_id> KernelIds{KernelID};
+  auto DeviceImages =
+      ProgramManager::getInstance().getRawDeviceImages(KernelIds);
+  auto DeviceImage = std::find_if(
+      DeviceImages.begin(), DeviceImages.end(),
+      [isNvidia](RTDeviceBinaryImage *DI) {
+        const std::string &TargetSpec = isNvidia ? std::string("llvm_nvptx64")
+                                                 : std::string("llvm_amdgcn");
+        return DI->getFormat() == PI_DEVICE_BINARY_TYPE_LLVMIR_BITCODE &&
+               DI->getRawData().DeviceTargetSpec == TargetSpec;
+      });
+  if (DeviceImage == DeviceImages.end()) {
+    return nullptr;
   }
+  return *DeviceImage;
+}
+
+bool isCUDAOrHIP(QueueImplPtr &Queue) {
+  auto Backend = Queue->getDeviceImplPtr()->getBackend();
+  return Backend == backend::ext_oneapi_cuda ||
+         Backend == backend::ext_oneapi_hip;
+}
+
+// Only the device image of the kernel is needed for fusion, so no program is
+// created from it. The CUDA and HIP input kernels are taken as LLVM bitcode,
+// which the JIT compiler lowers to PTX or AMDGCN without going through
+// SPIR-V.
+const RTDeviceBinaryImage *retrieveKernelBinary(QueueImplPtr &Queue,
+                                                CGExecKernel *KernelCG) {
+  auto KernelName = KernelCG->getKernelName();
+
+  if (isCUDAOrHIP(Queue))
+    return retrieveIRImage(Queue, KernelName);
 
-  const RTDeviceBinaryImage *DeviceImage = nullptr;
-  sycl::detail::pi::PiProgram Program = nullptr;
   if (KernelCG->getKernelBundle() != nullptr) {
     // Retrieve the device image from the kernel bundle.
     auto KernelBundle = KernelCG->getKernelBundle();
@@ -104,22 +116,17 @@ retrieveKernelBinary(QueueImplPtr &Queue, CGExecKernel *KernelCG) {
     auto SyclKernel = detail::getSyclObjImpl(
         KernelBundle->get_kernel(KernelID, KernelBundle));
 
-    DeviceImage = SyclKernel->getDeviceImage()->get_bin_image_ref();
-    Program = SyclKernel->getDeviceImage()->get_program_ref();
-  } else if (KernelCG->MSyclKernel != nullptr) {
-    DeviceImage = KernelCG->MSyclKernel->getDeviceImage()->get_bin_image_ref();
-    Program = KernelCG->MSyclKernel->getDeviceImage()->get_program_ref();
-  } else {
-    auto ContextImpl = Queue->getContextImplPtr();
-    auto Context = detail::createSyclObjFromImpl<context>(ContextImpl);
-    auto DeviceImpl = Queue->getDeviceImplPtr();
-    auto Device = detail::createSyclObjFromImpl<device>(DeviceImpl);
-    DeviceImage = &detail::ProgramManager::getInstance().getDeviceImage(
-        KernelName, Context, Device);
-    Program = detail::ProgramManager::getInstance().createPIProgram(
-        *DeviceImage, Context, Device);
+    return SyclKernel->getDeviceImage()->get_bin_image_ref();
+  }
+  if (KernelCG->MSyclKernel != nullptr) {
+    return KernelCG->MSyclKernel->getDeviceImage()->get_bin_image_ref();
   }
-  return {DeviceImage, Program};
+  auto ContextImpl = Queue->getContextImplPtr();
+  auto Context = detail::createSyclObjFromImpl<context>(ContextImpl);
+  auto DeviceImpl = Queue->getDeviceImplPtr();
+  auto Device = detail::createSyclObjFromImpl<device>(DeviceImpl);
+  return &detail::ProgramManager::getInstance().getDeviceImage(
+      KernelName, Context, Device);
 }
 
 static ::jit_compiler::ParameterKind
@@ -641,10 +648,374 @@ updatePromotedArgs(const ::jit_compiler::SYCLKernelInfo &FusedKernelInfo,
   }
 }
 
+namespace {
+/// Writes the inputs of a fusion and the fused kernels stored in the
+/// persistent device code cache. The values are written field by field, so
+/// that padding does not end up in the key sources.
+class FusionCacheWriter {
+public:
+  template <typename T> void write(const T &Value) {
+    static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+    MData.append(reinterpret_cast<const char *>(&Value), sizeof(T));
+  }
+  void write(const ::jit_compiler::Indices &Values) {
+    for (size_t Value : Values)
+      write(Value);
+  }
+  void write(const ::jit_compiler::NDRange &NDR) {
+    write(NDR.getDimensions());
+    write(NDR.getGlobalSize());
+    write(NDR.getLocalSize());
+    write(NDR.getOffset());
+  }
+  void write(const ::jit_compiler::Parameter &Param) {
+    write(Param.KernelIdx);
+    write(Param.ParamIdx);
+  }
+  void writeBytes(const void *Data, size_t Size) {
+    write(Size);
+    MData.append(static_cast<const char *>(Data), Size);
+  }
+  void writeString(const char *Str) { writeBytes(Str, std::strlen(Str)); }
+
+  std::string &data() { return MData; }
+
+private:
+  std::string MData;
+};
+
+/// Reads the data written by FusionCacheWriter. The reads fail, rather than
+/// read past the end, on truncated data.
+class FusionCacheReader {
+public:
+  explicit FusionCacheReader(const std::vector<char> &Data) : MData{Data} {}
+
+  template <typename T> bool read(T &Value) {
+    static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+    if (MData.size() - MPos < sizeof(T))
+      return false;
+    std::memcpy(&Value, MData.data() + MPos, sizeof(T));
+    MPos += sizeof(T);
+    return true;
+  }
+  bool read(::jit_compiler::Indices &Values) {
+    for (size_t &Value : Values)
+      if (!read(Value))
+        return false;
+    return true;
+  }
+  bool read(::jit_compiler::NDRange &NDR) {
+    int Dims = 0;
+    ::jit_compiler::Indices GlobalSize, LocalSize, Offset;
+    if (!read(Dims) || !read(GlobalSize) || !read(LocalSize) || !read(Offset))
+      return false;
+    NDR = ::jit_compiler::NDRange{Dims, GlobalSize, LocalSize, Offset};
+    return true;
+  }
+  /// Returns the bytes in place, or nullptr if the data is truncated.
+  const char *readBytes(size_t &Size) {
+    if (!read(Size) || MData.size() - MPos < Size)
+      return nullptr;
+    const char *Bytes = MData.data() + MPos;
+    MPos += Size;
+    return Bytes;
+  }
+
+  bool atEnd() const { return MPos == MData.size(); }
+
+private:
+  const std::vector<char> &MData;
+  size_t MPos = 0;
+};
+
+/// Version of the layout of the fused kernels in the persistent cache, which
+/// is part of their keys.
+constexpr uint32_t FusionCacheVersion = 1;
+
+/// Returns the full values of the inputs of a fusion, which identify the fused
+/// kernel in the persistent device code cache. The input kernels are given by
+/// their device images rather than by their names, so that the kernels of a
+/// rebuilt application are fused again.
+std::string getFusionKeySources(
+    const ::jit_compiler::TargetInfo &TargetInfo,
+    const std::vector<::jit_compiler::SYCLKernelInfo> &InputKernelInfo,
+    const std::vector<::jit_compiler::ParameterIdentity> &ParamIdentities,
+    ::jit_compiler::BarrierFlags BarrierFlags,
+    const std::vector<::jit_compiler::ParameterInternalization>
+        &InternalizeParams,
+    const std::vector<::jit_compiler::JITConstant> &JITConstants) {
+  FusionCacheWriter Key;
+  Key.write(FusionCacheVersion);
+  Key.write(TargetInfo.getFormat());
+  Key.write(TargetInfo.getArch());
+  Key.write(InputKernelInfo.size());
+  for (const ::jit_compiler::SYCLKernelInfo &Kernel : InputKernelInfo) {
+    Key.writeString(Kernel.Name.c_str());
+    Key.write(Kernel.Args.Kinds.size());
+    for (::jit_compiler::ParameterKind Kind : Kernel.Args.Kinds)
+      Key.write(Kind);
+    for (::jit_compiler::ArgUsageUT Usage : Kernel.Args.UsageMask)
+      Key.write(Usage);
+    Key.write(Kernel.NDR);
+    Key.write(Kernel.BinaryInfo.Format);
+    Key.writeBytes(Kernel.BinaryInfo.BinaryStart, Kernel.BinaryInfo.BinarySize);
+  }
+  Key.write(ParamIdentities.size());
+  for (const ::jit_compiler::ParameterIdentity &Identity : ParamIdentities) {
+    Key.write(Identity.LHS);
+    Key.write(Identity.RHS);
+  }
+  Key.write(BarrierFlags);
+  Key.write(InternalizeParams.size());
+  for (const ::jit_compiler::ParameterInternalization &Intern :
+       InternalizeParams) {
+    Key.write(Intern.Param);
+    Key.write(Intern.Intern);
+    Key.write(Intern.LocalSize);
+    Key.write(Intern.ElemSize);
+  }
+  Key.write(JITConstants.size());
+  for (const ::jit_compiler::JITConstant &Constant : JITConstants) {
+    Key.write(Constant.Param);
+    Key.writeBytes(Constant.Value.begin(), Constant.Value.size());
+  }
+  return std::move(Key.data());
+}
+
+std::vector<char>
+serializeFusedKernel(const ::jit_compiler::SYCLKernelInfo &KernelInfo) {
+  FusionCacheWriter Data;
+  Data.writeString(KernelInfo.Name.c_str());
+  Data.write(KernelInfo.Args.Kinds.size());
+  for (::jit_compiler::ParameterKind Kind : KernelInfo.Args.Kinds)
+    Data.write(Kind);
+  for (::jit_compiler::ArgUsageUT Usage : KernelInfo.Args.UsageMask)
+    Data.write(Usage);
+  Data.write(KernelInfo.Attributes.size());
+  for (const ::jit_compiler::SYCLKernelAttribute &Attr :
+       KernelInfo.Attributes) {
+    Data.write(Attr.Kind);
+    Data.write(Attr.Values);
+  }
+  Data.write(KernelInfo.NDR);
+  Data.write(KernelInfo.BinaryInfo.Format);
+  Data.write(KernelInfo.BinaryInfo.AddressBits);
+  Data.writeBytes(KernelInfo.BinaryInfo.BinaryStart,
+                  KernelInfo.BinaryInfo.BinarySize);
+  return {Data.data().begin(), Data.data().end()};
+}
+
+/// Reads a fused kernel written by serializeFusedKernel(). The binary of the
+/// kernel stays in Data.
+bool deserializeFusedKernel(const std::vector<char> &Data,
+                            ::jit_compiler::SYCLKernelInfo &KernelInfo) {
+  FusionCacheReader Reader{Data};
+  size_t NameSize = 0;
+  const char *Name = Reader.readBytes(NameSize);
+  size_t NumArgs = 0;
+  if (!Name || !Reader.read(NumArgs) || NumArgs > Data.size())
+    return false;
+  KernelInfo.Name =
+      ::jit_compiler::DynString{std::string{Name, NameSize}.c_str()};
+  KernelInfo.Args = ::jit_compiler::SYCLArgumentDescriptor{NumArgs};
+  for (::jit_compiler::ParameterKind &Kind : KernelInfo.Args.Kinds)
+    if (!Reader.read(Kind))
+      return false;
+  for (::jit_compiler::ArgUsageUT &Usage : KernelInfo.Args.UsageMask)
+    if (!Reader.read(Usage))
+      return false;
+  size_t NumAttrs = 0;
+  if (!Reader.read(NumAttrs) || NumAttrs > Data.size())
+    return false;
+  KernelInfo.Attributes = ::jit_compiler::SYCLAttributeList{NumAttrs};
+  for (::jit_compiler::SYCLKernelAttribute &Attr : KernelInfo.Attributes)
+    if (!Reader.read(Attr.Kind) || !Reader.read(Attr.Values))
+      return false;
+  ::jit_compiler::SYCLKernelBinaryInfo &BinInfo = KernelInfo.BinaryInfo;
+  size_t BinarySize = 0;
+  const char *Binary = nullptr;
+  if (!Reader.read(KernelInfo.NDR) || !Reader.read(BinInfo.Format) ||
+      !Reader.read(BinInfo.AddressBits) ||
+      !(Binary = Reader.readBytes(BinarySize)) || !Reader.atEnd())
+    return false;
+  BinInfo.BinaryStart = reinterpret_cast<::jit_compiler::BinaryAddress>(Binary);
+  BinInfo.BinarySize = BinarySize;
+  return true;
+}
+
+/// The configuration of the JIT compiler is global, so its invocations are
+/// serialized.
+std::mutex &getJITMutex() {
+  static std::mutex JITMutex;
+  return JITMutex;
+}
+
+/// Runs the JIT compiler for a fusion.
+::jit_compiler::FusionResult
+runFusion(const ::jit_compiler::TargetInfo &TargetInfo,
+          const std::vector<::jit_compiler::SYCLKernelInfo> &InputKernelInfo,
+          const std::string &FusedKernelName,
+          const std::vector<::jit_compiler::ParameterIdentity> &ParamIdentities,
+          ::jit_compiler::BarrierFlags BarrierFlags,
+          const std::vector<::jit_compiler::ParameterInternalization>
+              &InternalizeParams,
+          const std::vector<::jit_compiler::JITConstant> &JITConstants,
+          bool EnableCaching) {
+  std::lock_guard<std::mutex> Lock{getJITMutex()};
+
+  ::jit_compiler::KernelFusion::resetConfiguration();
+  bool DebugEnabled =
+      detail::SYCLConfig<detail::SYCL_RT_WARNING_LEVEL>::get() > 0;
+  ::jit_compiler::KernelFusion::set<::jit_compiler::option::JITEnableVerbose>(
+      DebugEnabled);
+  ::jit_compiler::KernelFusion::set<::jit_compiler::option::JITEnableCaching>(
+      EnableCaching);
+  ::jit_compiler::KernelFusion::set<::jit_compiler::option::JITTargetInfo>(
+      TargetInfo);
+
+  using ::jit_compiler::View;
+  return ::jit_compiler::KernelFusion::fuseKernels(
+      View{InputKernelInfo}, FusedKernelName.c_str(), View(ParamIdentities),
+      BarrierFlags, View(InternalizeParams), View(JITConstants));
+}
+
+/// Runs the JIT compiler to materialize specialization constants.
+::jit_compiler::FusionResult
+runMaterialization(const ::jit_compiler::TargetInfo &TargetInfo,
+                   const ::jit_compiler::SYCLKernelInfo &KernelInfo,
+                   const std::string &MaterializedName,
+                   const std::vector<unsigned char> &SpecConstBlob) {
+  std::lock_guard<std::mutex> Lock{getJITMutex()};
+
+  ::jit_compiler::KernelFusion::resetConfiguration();
+  bool DebugEnabled =
+      detail::SYCLConfig<detail::SYCL_RT_WARNING_LEVEL>::get() > 0;
+  ::jit_compiler::KernelFusion::set<::jit_compiler::option::JITEnableVerbose>(
+      DebugEnabled);
+  ::jit_compiler::KernelFusion::set<::jit_compiler::option::JITTargetInfo>(
+      TargetInfo);
+
+  using ::jit_compiler::View;
+  return ::jit_compiler::KernelFusion::materializeSpecConstants(
+      KernelInfo, MaterializedName.c_str(), View{SpecConstBlob});
+}
+
+/// Runs the JIT compiler to extract a kernel from its module.
+::jit_compiler::FusionResult
+runExtraction(const ::jit_compiler::TargetInfo &TargetInfo,
+              const ::jit_compiler::SYCLKernelInfo &KernelInfo) {
+  std::lock_guard<std::mutex> Lock{getJITMutex()};
+
+  ::jit_compiler::KernelFusion::resetConfiguration();
+  bool DebugEnabled =
+      detail::SYCLConfig<detail::SYCL_RT_WARNING_LEVEL>::get() > 0;
+  ::jit_compiler::KernelFusion::set<::jit_compiler::option::JITEnableVerbose>(
+      DebugEnabled);
+  ::jit_compiler::KernelFusion::set<::jit_compiler::option::JITTargetInfo>(
+      TargetInfo);
+
+  return ::jit_compiler::KernelFusion::extractKernel(KernelInfo);
+}
+} // namespace
+
+bool jit_compiler::getStoredFusedKernel(
+    QueueImplPtr &Queue, const std::string &FusedKernelName,
+    const std::string &KeySources, ::jit_compiler::SYCLKernelInfo &KernelInfo,
+    bool &IsRegistered) {
+  std::lock_guard<std::mutex> Lock{MFusionMutex};
+  auto It = MStoredFusedKernels.find(FusedKernelName);
+  IsRegistered = It != MStoredFusedKernels.end();
+  if (IsRegistered)
+    return deserializeFusedKernel(It->second, KernelInfo);
+
+  std::vector<char> Data;
+  auto Background = MBackgroundFusions.find(FusedKernelName);
+  if (Background != MBackgroundFusions.end() && Background->second &&
+      !Background->second->empty()) {
+    Data = std::move(*Background->second);
+    MBackgroundFusions.erase(Background);
+  } else if (detail::SYCLConfig<detail::SYCL_ENABLE_FUSION_CACHING>::get()) {
+    Data = PersistentDeviceCodeCache::getFusedKernelFromDisc(
+        Queue->get_device(), KeySources);
+  }
+  if (Data.empty())
+    return false;
+  if (!deserializeFusedKernel(Data, KernelInfo) ||
+      !(KernelInfo.Name == FusedKernelName.c_str())) {
+    PersistentDeviceCodeCache::trace("invalid cached fused kernel " +
+                                     FusedKernelName);
+    return false;
+  }
+  // Moving the data keeps the binary in place.
+  MStoredFusedKernels.emplace(FusedKernelName, std::move(Data));
+  return true;
+}
+
+bool jit_compiler::startBackgroundFusion(
+    QueueImplPtr &Queue, const std::string &FusedKernelName,
+    std::string KeySources, ::jit_compiler::TargetInfo TargetInfo,
+    std::vector<::jit_compiler::SYCLKernelInfo> InputKernelInfo,
+    std::vector<::jit_compiler::ParameterIdentity> ParamIdentities,
+    ::jit_compiler::BarrierFlags BarrierFlags,
+    std::vector<::jit_compiler::ParameterInternalization> InternalizeParams,
+    std::vector<::jit_compiler::JITConstant> JITConstants) {
+  {
+    std::lock_guard<std::mutex> Lock{MFusionMutex};
+    auto [It, Inserted] = MBackgroundFusions.try_emplace(FusedKernelName);
+    if (!Inserted)
+      return !It->second;
+  }
+
+  bool PersistFusion =
+      detail::SYCLConfig<detail::SYCL_ENABLE_FUSION_CACHING>::get() &&
+      detail::SYCLConfig<detail::SYCL_CACHE_PERSISTENT>::get();
+  GlobalHandler::instance().getHostTaskThreadPool().submit(
+      [this, Device = Queue->get_device(), FusedKernelName,
+       KeySources = std::move(KeySources), TargetInfo,
+       InputKernelInfo = std::move(InputKernelInfo),
+       ParamIdentities = std::move(ParamIdentities), BarrierFlags,
+       InternalizeParams = std::move(InternalizeParams),
+       JITConstants = std::move(JITConstants), PersistFusion]() {
+        // The JIT compiler does not cache the kernel, as its result is kept
+        // here until it is picked up by the next identical fusion.
+        auto FusionResult =
+            runFusion(TargetInfo, InputKernelInfo, FusedKernelName,
+                      ParamIdentities, BarrierFlags, InternalizeParams,
+                      JITConstants, /*EnableCaching=*/false);
+        std::vector<char> Data;
+        if (!FusionResult.failed()) {
+          Data = serializeFusedKernel(FusionResult.getKernelInfo());
+          if (PersistFusion)
+            PersistentDeviceCodeCache::putFusedKernelToDisc(Device, KeySources,
+                                                            Data);
+        } else {
+          printPerformanceWarning(
+              std::string{"Background kernel fusion failed with message:\n"} +
+              FusionResult.getErrorMessage());
+        }
+        std::lock_guard<std::mutex> Lock{MFusionMutex};
+        MBackgroundFusions[FusedKernelName] = std::move(Data);
+      });
+  return true;
+}
+
 std::unique_ptr<detail::CG>
 jit_compiler::fuseKernels(QueueImplPtr Queue,
                           std::vector<ExecCGCommand *> &InputKernels,
-                          const property_list &PropList) {
+                          const property_list &PropList, bool Async) {
+  std::vector<CGExecKernel *> KernelCGs;
+  KernelCGs.reserve(InputKernels.size());
+  for (auto *KernelCmd : InputKernels) {
+    assert(KernelCmd->isFusable());
+    KernelCGs.push_back(static_cast<CGExecKernel *>(&KernelCmd->getCG()));
+  }
+  return fuseKernels(std::move(Queue), KernelCGs, PropList, Async);
+}
+
+std::unique_ptr<detail::CG>
+jit_compiler::fuseKernels(QueueImplPtr Queue,
+                          std::vector<CGExecKernel *> &InputKernels,
+                          const property_list &PropList, bool Async) {
   if (InputKernels.empty()) {
     printPerformanceWarning("Fusion list is empty");
     return nullptr;
@@ -669,12 +1040,7 @@ jit_compiler::fuseKernels(QueueImplPtr Queue,
   PromotionMap PromotedAccs;
   // TODO: Collect information about streams and figure out how
   // to fuse them.
-  for (auto &RawCmd : InputKernels) {
-    auto *KernelCmd = static_cast<ExecCGCommand *>(RawCmd);
-    auto &CG = KernelCmd->getCG();
-    assert(KernelCmd->isFusable());
-    auto *KernelCG = static_cast<CGExecKernel *>(&CG);
-
+  for (auto *KernelCG : InputKernels) {
     auto KernelName = KernelCG->MKernelName;
     if (KernelName.empty()) {
       printPerformanceWarning(
@@ -682,18 +1048,19 @@ jit_compiler::fuseKernels(QueueImplPtr Queue,
       return nullptr;
     }
 
-    auto [DeviceImage, Program] = retrieveKernelBinary(Queue, KernelCG);
+    const RTDeviceBinaryImage *DeviceImage =
+        retrieveKernelBinary(Queue, KernelCG);
 
-    if (!DeviceImage || !Program) {
+    if (!DeviceImage) {
       printPerformanceWarning("No suitable IR available for fusion");
       return nullptr;
     }
     const KernelArgMask *EliminatedArgs = nullptr;
-    if (Program && (KernelCG->MSyclKernel == nullptr ||
-                    !KernelCG->MSyclKernel->isCreatedFromSource())) {
+    if (KernelCG->MSyclKernel == nullptr ||
+        !KernelCG->MSyclKernel->isCreatedFromSource()) {
       EliminatedArgs =
           detail::ProgramManager::getInstance().getEliminatedKernelArgMask(
-              Program, KernelName);
+              *DeviceImage, KernelName);
     }
 
     // Collect information about the arguments of this kernel.
@@ -851,25 +1218,59 @@ jit_compiler::fuseKernels(QueueImplPtr Queue,
           ? ::jit_compiler::getNoBarrierFlag()
           : ::jit_compiler::getLocalAndGlobalBarrierFlag();
 
-  static size_t FusedKernelNameIndex = 0;
-  auto FusedKernelName = "fused_" + std::to_string(FusedKernelNameIndex++);
-  ::jit_compiler::KernelFusion::resetConfiguration();
-  bool DebugEnabled =
-      detail::SYCLConfig<detail::SYCL_RT_WARNING_LEVEL>::get() > 0;
-  ::jit_compiler::KernelFusion::set<::jit_compiler::option::JITEnableVerbose>(
-      DebugEnabled);
-  ::jit_compiler::KernelFusion::set<::jit_compiler::option::JITEnableCaching>(
-      detail::SYCLConfig<detail::SYCL_ENABLE_FUSION_CACHING>::get());
-
   ::jit_compiler::TargetInfo TargetInfo = getTargetInfo(Queue);
   ::jit_compiler::BinaryFormat TargetFormat = TargetInfo.getFormat();
-  ::jit_compiler::KernelFusion::set<::jit_compiler::option::JITTargetInfo>(
-      std::move(TargetInfo));
 
-  using ::jit_compiler::View;
-  auto FusionResult = ::jit_compiler::KernelFusion::fuseKernels(
-      View{InputKernelInfo}, FusedKernelName.c_str(), View(ParamIdentities),
-      BarrierFlags, View(InternalizeParams), View(JITConstants));
+  // With both the fusion cache and the persistent device code cache enabled,
+  // the fused kernels are also stored on disk, so that the following runs of
+  // the application do not JIT compile them again. Their names are stored with
+  // their binaries, so they are derived from the inputs of the fusion rather
+  // than from the number of fusions of the run. The same holds for the fused
+  // kernels compiled in the background, which are picked up by the next
+  // identical fusion.
+  bool PersistFusion =
+      detail::SYCLConfig<detail::SYCL_ENABLE_FUSION_CACHING>::get() &&
+      detail::SYCLConfig<detail::SYCL_CACHE_PERSISTENT>::get();
+  std::string KeySources;
+  std::string FusedKernelName;
+  if (PersistFusion || Async) {
+    KeySources =
+        getFusionKeySources(TargetInfo, InputKernelInfo, ParamIdentities,
+                            BarrierFlags, InternalizeParams, JITConstants);
+    FusedKernelName =
+        "fused_p" + std::to_string(std::hash<std::string>{}(KeySources));
+  } else {
+    static size_t FusedKernelNameIndex = 0;
+    FusedKernelName = "fused_" + std::to_string(FusedKernelNameIndex++);
+  }
+  ::jit_compiler::SYCLKernelInfo StoredKernelInfo;
+  bool IsRegistered = false;
+  bool IsStored = (PersistFusion || Async) &&
+                  getStoredFusedKernel(Queue, FusedKernelName, KeySources,
+                                       StoredKernelInfo, IsRegistered);
+
+  // Until the fused kernel compiled in the background is ready, the kernels
+  // run unfused.
+  if (Async && !IsStored) {
+    if (startBackgroundFusion(Queue, FusedKernelName, std::move(KeySources),
+                              TargetInfo, std::move(InputKernelInfo),
+                              std::move(ParamIdentities), BarrierFlags,
+                              std::move(InternalizeParams),
+                              std::move(JITConstants)))
+      printPerformanceWarning(
+          "Fused kernel is not ready yet, running the kernels unfused");
+    return nullptr;
+  }
+
+  bool DebugEnabled =
+      detail::SYCLConfig<detail::SYCL_RT_WARNING_LEVEL>::get() > 0;
+  auto FusionResult =
+      IsStored ? ::jit_compiler::FusionResult{StoredKernelInfo, IsRegistered}
+               : runFusion(TargetInfo, InputKernelInfo, FusedKernelName,
+                           ParamIdentities, BarrierFlags, InternalizeParams,
+                           JITConstants,
+                           detail::SYCLConfig<
+                               detail::SYCL_ENABLE_FUSION_CACHING>::get());
 
   if (FusionResult.failed()) {
     if (DebugEnabled) {
@@ -909,6 +1310,10 @@ jit_compiler::fuseKernels(QueueImplPtr Queue,
   if (!FusionResult.cached()) {
     auto PIDeviceBinaries = createPIDeviceBinary(FusedKernelInfo, TargetFormat);
     detail::ProgramManager::getInstance().addImages(PIDeviceBinaries);
+    if (PersistFusion && !IsStored)
+      PersistentDeviceCodeCache::putFusedKernelToDisc(
+          Queue->get_device(), KeySources,
+          serializeFusedKernel(FusedKernelInfo));
   } else {
     if (DebugEnabled) {
       std::cerr << "INFO: Re-using existing device binary for fused kernel\n";
@@ -934,6 +1339,137 @@ jit_compiler::fuseKernels(QueueImplPtr Queue,
   return FusedCG;
 }
 
+std::string jit_compiler::materializeSpecConstants(
+    QueueImplPtr Queue, const RTDeviceBinaryImage *BundleImage,
+    const std::string &KernelName, const std::vector<ArgDesc> &Args,
+    const KernelArgMask *EliminatedArgMask,
+    const std::vector<unsigned char> &SpecConstBlob) {
+  // The kernels reading emulated specialization constants take the buffer
+  // holding them as their last argument.
+  auto LastArg = std::max_element(
+      Args.begin(), Args.end(),
+      [](const ArgDesc &A, const ArgDesc &B) { return A.MIndex < B.MIndex; });
+  if (SpecConstBlob.empty() || LastArg == Args.end() ||
+      LastArg->MType !=
+          kernel_param_kind_t::kind_specialization_constants_buffer)
+    return {};
+  auto IsEliminated = [EliminatedArgMask](size_t Index) {
+    return EliminatedArgMask && Index < EliminatedArgMask->size() &&
+           (*EliminatedArgMask)[Index];
+  };
+  size_t NumArgs = LastArg->MIndex + 1;
+  if (IsEliminated(NumArgs - 1))
+    return {};
+
+  const RTDeviceBinaryImage *Image =
+      isCUDAOrHIP(Queue) ? retrieveIRImage(Queue, KernelName) : BundleImage;
+  if (!Image || !BundleImage ||
+      (Image->getFormat() != PI_DEVICE_BINARY_TYPE_SPIRV &&
+       Image->getFormat() != PI_DEVICE_BINARY_TYPE_LLVMIR_BITCODE))
+    return {};
+  // The device globals of the materialized kernel would not be the ones of
+  // the other kernels.
+  if (Image->getDeviceGlobals().size() ||
+      BundleImage->getDeviceGlobals().size())
+    return {};
+
+  ::jit_compiler::TargetInfo TargetInfo;
+  try {
+    TargetInfo = getTargetInfo(Queue);
+  } catch (const sycl::exception &) {
+    return {};
+  }
+
+  std::lock_guard<std::mutex> Lock{MMaterializeMutex};
+  auto [It, Inserted] = MMaterializedKernels.try_emplace(
+      std::make_tuple(TargetInfo.getArch(), KernelName, SpecConstBlob));
+  // A kernel which cannot be materialized keeps an empty name, so that it is
+  // not compiled again.
+  if (!Inserted)
+    return It->second;
+
+  ::jit_compiler::SYCLArgumentDescriptor ArgDescriptor{NumArgs};
+  for (const ArgDesc &Arg : Args)
+    ArgDescriptor.Kinds[Arg.MIndex] = translateArgType(Arg.MType);
+  for (size_t I = 0; I < NumArgs; ++I)
+    ArgDescriptor.UsageMask[I] = !IsEliminated(I);
+
+  const pi_device_binary_struct &RawImage = Image->getRawData();
+  ::jit_compiler::SYCLKernelBinaryInfo BinInfo{
+      translateBinaryImageFormat(Image->getFormat()), 0, RawImage.BinaryStart,
+      static_cast<size_t>(RawImage.BinaryEnd - RawImage.BinaryStart)};
+  ::jit_compiler::SYCLKernelInfo KernelInfo{KernelName.c_str(), ArgDescriptor,
+                                            ::jit_compiler::NDRange{},
+                                            BinInfo};
+
+  std::string MaterializedName = KernelName + "__spec_consts" +
+                                 std::to_string(MMaterializedKernels.size());
+  auto Result = runMaterialization(TargetInfo, KernelInfo, MaterializedName,
+                                   SpecConstBlob);
+  if (Result.failed()) {
+    if (detail::SYCLConfig<detail::SYCL_RT_WARNING_LEVEL>::get() > 0)
+      std::cerr << "ERROR: JIT compilation for specialization constant "
+                   "materialization failed with message:\n"
+                << Result.getErrorMessage() << "\n";
+    return {};
+  }
+
+  detail::ProgramManager::getInstance().addImages(
+      createPIDeviceBinary(Result.getKernelInfo(), TargetInfo.getFormat()));
+  It->second = MaterializedName;
+  return MaterializedName;
+}
+
+const RTDeviceBinaryImage *
+jit_compiler::extractKernel(const DeviceImplPtr &Device,
+                            const RTDeviceBinaryImage &Img,
+                            const std::string &KernelName) {
+  // Only SPIR-V images holding several kernels and nothing shared with the
+  // other images, or set when building the whole image, are split.
+  const pi_device_binary_struct &RawImage = Img.getRawData();
+  if (Img.getFormat() != PI_DEVICE_BINARY_TYPE_SPIRV ||
+      RawImage.EntriesEnd - RawImage.EntriesBegin < 2 ||
+      Img.getSpecConstants().size() || Img.getDeviceGlobals().size() ||
+      Img.getHostPipes().size() || Img.getExportedSymbols().size())
+    return nullptr;
+
+  ::jit_compiler::TargetInfo TargetInfo;
+  try {
+    TargetInfo = getTargetInfo(Device);
+  } catch (const sycl::exception &) {
+    return nullptr;
+  }
+  if (TargetInfo.getFormat() != ::jit_compiler::BinaryFormat::SPIRV)
+    return nullptr;
+
+  std::lock_guard<std::mutex> Lock{MExtractMutex};
+  auto [It, Inserted] =
+      MExtractedKernels.try_emplace(std::make_pair(&Img, KernelName));
+  // A kernel which cannot be extracted keeps a null image, so that it is not
+  // extracted again.
+  if (!Inserted)
+    return It->second.get();
+
+  ::jit_compiler::SYCLKernelInfo KernelInfo{KernelName.c_str(), 0};
+  KernelInfo.BinaryInfo = ::jit_compiler::SYCLKernelBinaryInfo{
+      ::jit_compiler::BinaryFormat::SPIRV, 0, RawImage.BinaryStart,
+      static_cast<size_t>(RawImage.BinaryEnd - RawImage.BinaryStart)};
+
+  auto Result = runExtraction(TargetInfo, KernelInfo);
+  if (Result.failed()) {
+    if (detail::SYCLConfig<detail::SYCL_RT_WARNING_LEVEL>::get() > 0)
+      std::cerr << "ERROR: JIT compilation for kernel extraction failed with "
+                   "message:\n"
+                << Result.getErrorMessage() << "\n";
+    return nullptr;
+  }
+
+  pi_device_binaries Binaries =
+      createPIDeviceBinary(Result.getKernelInfo(), TargetInfo.getFormat());
+  It->second = std::make_unique<RTDeviceBinaryImage>(Binaries->DeviceBinaries);
+  return It->second.get();
+}
+
 pi_device_binaries jit_compiler::createPIDeviceBinary(
     const ::jit_compiler::SYCLKernelInfo &FusedKernelInfo,
     ::jit_compiler::BinaryFormat Format) {
@@ -8,17 +8,31 @@
 
 #pragma once
 
+#include <detail/device_binary_image.hpp>
 #include <detail/jit_device_binaries.hpp>
 #include <detail/scheduler/commands.hpp>
 #include <detail/scheduler/scheduler.hpp>
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace jit_compiler {
 enum class BinaryFormat : uint32_t;
+enum class BarrierFlags : uint32_t;
 class JITContext;
+class TargetInfo;
 struct SYCLKernelInfo;
 struct SYCLKernelAttribute;
+struct ParameterIdentity;
+struct ParameterInternalization;
+struct JITConstant;
 template <typename T> class DynArray;
 using ArgUsageMask = DynArray<uint8_t>;
 } // namespace jit_compiler
@@ -33,9 +47,40 @@ namespace detail {
 class jit_compiler {
 
 public:
+  /// If Async is set and the fused kernel is not ready yet, it is compiled in
+  /// the background for the next identical fusion, and nullptr is returned
+  /// so that the kernels run unfused.
   std::unique_ptr<detail::CG>
   fuseKernels(QueueImplPtr Queue, std::vector<ExecCGCommand *> &InputKernels,
-              const property_list &);
+              const property_list &, bool Async = false);
+
+  /// Fuses the kernels of the command groups, which are not owned by a
+  /// command, e.g. the ones stored in the nodes of a command graph.
+  std::unique_ptr<detail::CG>
+  fuseKernels(QueueImplPtr Queue, std::vector<CGExecKernel *> &InputKernels,
+              const property_list &, bool Async = false);
+
+  /// Returns the name of a copy of the kernel in which the values of its
+  /// emulated specialization constants in SpecConstBlob are folded in by the
+  /// JIT compiler, registered with the program manager, or an empty string if
+  /// the kernel does not read emulated specialization constants or cannot be
+  /// materialized. The copies are compiled once per device architecture and
+  /// set of values.
+  std::string
+  materializeSpecConstants(QueueImplPtr Queue,
+                           const RTDeviceBinaryImage *BundleImage,
+                           const std::string &KernelName,
+                           const std::vector<ArgDesc> &Args,
+                           const KernelArgMask *EliminatedArgMask,
+                           const std::vector<unsigned char> &SpecConstBlob);
+
+  /// Returns an image holding only the kernel and the functions it calls,
+  /// extracted by the JIT compiler from Img, so that it is built without the
+  /// other kernels of the image, or nullptr if it cannot be extracted. The
+  /// images are extracted once per kernel and are owned by the JIT compiler.
+  const RTDeviceBinaryImage *extractKernel(const DeviceImplPtr &Device,
+                                           const RTDeviceBinaryImage &Img,
+                                           const std::string &KernelName);
 
   static jit_compiler &get_instance() {
     static jit_compiler instance{};
@@ -60,8 +105,51 @@ private:
   std::vector<uint8_t> encodeReqdWorkGroupSize(
       const ::jit_compiler::SYCLKernelAttribute &Attr) const;
 
+  /// Reads the fused kernel of the fusion identified by KeySources from the
+  /// persistent device code cache, unless it has already been read by this
+  /// run, in which case IsRegistered is set.
+  bool getStoredFusedKernel(QueueImplPtr &Queue,
+                            const std::string &FusedKernelName,
+                            const std::string &KeySources,
+                            ::jit_compiler::SYCLKernelInfo &KernelInfo,
+                            bool &IsRegistered);
+
+  /// Compiles the fused kernel in the background, unless it is already being
+  /// compiled. Returns false if its compilation has failed.
+  bool startBackgroundFusion(
+      QueueImplPtr &Queue, const std::string &FusedKernelName,
+      std::string KeySources, ::jit_compiler::TargetInfo TargetInfo,
+      std::vector<::jit_compiler::SYCLKernelInfo> InputKernelInfo,
+      std::vector<::jit_compiler::ParameterIdentity> ParamIdentities,
+      ::jit_compiler::BarrierFlags BarrierFlags,
+      std::vector<::jit_compiler::ParameterInternalization> InternalizeParams,
+      std::vector<::jit_compiler::JITConstant> JITConstants);
+
   // Manages the lifetime of the PI structs for device binaries.
   std::vector<DeviceBinariesCollection> JITDeviceBinaries;
+
+  // Fused kernels read from the persistent device code cache, by name. Their
+  // binaries are referenced by the device binaries of the program manager.
+  std::unordered_map<std::string, std::vector<char>> MStoredFusedKernels;
+  // Fused kernels compiled in the background, by name, which are moved to
+  // MStoredFusedKernels once picked up. Nothing is stored while the kernel is
+  // being compiled, and empty data if its compilation has failed.
+  std::unordered_map<std::string, std::optional<std::vector<char>>>
+      MBackgroundFusions;
+  std::mutex MFusionMutex;
+
+  // Names of the materialized kernels, by device architecture, kernel name
+  // and values of the specialization constants.
+  std::map<std::tuple<unsigned, std::string, std::vector<unsigned char>>,
+           std::string>
+      MMaterializedKernels;
+  std::mutex MMaterializeMutex;
+
+  // Images of the kernels extracted from the images holding several kernels.
+  std::map<std::pair<const RTDeviceBinaryImage *, std::string>,
+           std::unique_ptr<RTDeviceBinaryImage>>
+      MExtractedKernels;
+  std::mutex MExtractMutex;
 };
 
 } // namespace detail
@@ -25,6 +25,8 @@
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace sycl {
@@ -515,10 +517,8 @@ public:
     // Used to track if any of the candidate images has specialization values
     // set.
     bool SpecConstsSet = false;
-    for (auto &DeviceImage : MDeviceImages) {
-      if (!DeviceImage.has_kernel(KernelID))
-        continue;
-
+    for (size_t ImageIdx : getImagesWithKernel(KernelID)) {
+      const device_image_plain &DeviceImage = MDeviceImages[ImageIdx];
       const auto DeviceImageImpl = detail::getSyclObjImpl(DeviceImage);
       SpecConstsSet |= DeviceImageImpl->is_any_specialization_constant_set();
 
@@ -571,18 +571,16 @@ public:
   }
 
   bool has_kernel(const kernel_id &KernelID) const noexcept {
-    return std::any_of(MDeviceImages.begin(), MDeviceImages.end(),
-                       [&KernelID](const device_image_plain &DeviceImage) {
-                         return DeviceImage.has_kernel(KernelID);
-                       });
+    return !getImagesWithKernel(KernelID).empty();
   }
 
   bool has_kernel(const kernel_id &KernelID, const device &Dev) const noexcept {
-    return std::any_of(
-        MDeviceImages.begin(), MDeviceImages.end(),
-        [&KernelID, &Dev](const device_image_plain &DeviceImage) {
-          return DeviceImage.has_kernel(KernelID, Dev);
-        });
+    const std::vector<size_t> &Images = getImagesWithKernel(KernelID);
+    return std::any_of(Images.begin(), Images.end(),
+                       [this, &KernelID, &Dev](size_t ImageIdx) {
+                         return MDeviceImages[ImageIdx].has_kernel(KernelID,
+                                                                   Dev);
+                       });
   }
 
   bool contains_specialization_constants() const noexcept {
@@ -695,12 +693,32 @@ public:
             SpecConst.first.c_str(), SpecConst.second.data());
 
     // Add the images to the collection
+    std::lock_guard<std::mutex> Lock(MImagesByKernelMutex);
     MDeviceImages.insert(MDeviceImages.end(), NewDevImgs.begin(),
                          NewDevImgs.end());
+    MImagesByKernel.reset();
     return true;
   }
 
 private:
+  /// \return the indices in MDeviceImages of the images containing KernelID.
+  /// The index of the images by kernel is built on first use, so that the
+  /// submissions with the bundle do not search all of its images.
+  const std::vector<size_t> &
+  getImagesWithKernel(const kernel_id &KernelID) const {
+    static const std::vector<size_t> NoImages;
+    std::lock_guard<std::mutex> Lock(MImagesByKernelMutex);
+    if (!MImagesByKernel) {
+      MImagesByKernel = std::make_unique<ImagesByKernelT>();
+      for (size_t I = 0; I < MDeviceImages.size(); ++I)
+        for (const kernel_id &ID :
+             getSyclObjImpl(MDeviceImages[I])->get_kernel_ids())
+          (*MImagesByKernel)[ID].push_back(I);
+    }
+    auto It = MImagesByKernel->find(KernelID);
+    return It == MImagesByKernel->end() ? NoImages : It->second;
+  }
+
   context MContext;
   std::vector<device> MDevices;
   std::vector<device_image_plain> MDeviceImages;
@@ -709,6 +727,10 @@ private:
   SpecConstMapT MSpecConstValues;
   bool MIsInterop = false;
   bundle_state MState;
+  using ImagesByKernelT = std::unordered_map<kernel_id, std::vector<size_t>>;
+  /// Indices of the images by kernel, see getImagesWithKernel.
+  mutable std::unique_ptr<ImagesByKernelT> MImagesByKernel;
+  mutable std::mutex MImagesByKernelMutex;
   // ext_oneapi_kernel_compiler : Source, Languauge, KernelNames
   const syclex::source_language Language = syclex::source_language::opencl;
   const std::variant<std::string, std::vector<std::byte>> Source;
@@ -14,8 +14,13 @@
 
 #include "../online_compiler/ocloc_api.h"
 
-#include <cstring> // strlen
-#include <numeric> // for std::accumulate
+#include <cstring>       // strlen
+#include <future>        // std::shared_future
+#include <map>           // std::map
+#include <mutex>         // std::mutex
+#include <numeric>       // for std::accumulate
+#include <optional>      // std::optional
+#include <unordered_map> // std::unordered_map
 
 namespace sycl {
 inline namespace _V1 {
@@ -97,6 +102,9 @@ using voidPtr = void *;
 
 void SetupLibrary(voidPtr &oclocInvokeHandle, voidPtr &oclocFreeOutputHandle,
                   std::error_code the_errc) {
+  // The compilations and queries may be issued from several threads.
+  static std::mutex SetupMutex;
+  std::lock_guard<std::mutex> Lock{SetupMutex};
   if (!oclocInvokeHandle) {
     if (OclocLibrary == nullptr)
       loadOclocLibrary();
@@ -129,13 +137,11 @@ std::string IPVersionsToString(const std::vector<uint32_t> IPVersionVec) {
   return ss.str();
 }
 
-spirv_vec_t OpenCLC_to_SPIRV(const std::string &Source,
-                             const std::vector<uint32_t> &IPVersionVec,
-                             const std::vector<std::string> &UserArgs,
-                             std::string *LogPtr) {
-  std::vector<std::string> CMUserArgs = UserArgs;
-  CMUserArgs.push_back("-cmc");
-
+// A single invocation of ocloc compiles the source for all the devices.
+static spirv_vec_t InvokeOclocCompile(const std::string &Source,
+                                      const std::string &IPVersionsStr,
+                                      const std::string &CombinedUserArgs,
+                                      std::string &CompileLog) {
   // handles into ocloc shared lib
   static void *oclocInvokeHandle = nullptr;
   static void *oclocFreeOutputHandle = nullptr;
@@ -143,13 +149,6 @@ spirv_vec_t OpenCLC_to_SPIRV(const std::string &Source,
 
   SetupLibrary(oclocInvokeHandle, oclocFreeOutputHandle, build_errc);
 
-  // assemble ocloc args
-  std::string CombinedUserArgs =
-      std::accumulate(UserArgs.begin(), UserArgs.end(), std::string(""),
-                      [](const std::string &acc, const std::string &s) {
-                        return acc + s + " ";
-                      });
-
   std::vector<const char *> Args = {"ocloc", "-q", "-spv_only", "-options",
                                     CombinedUserArgs.c_str()};
 
@@ -167,7 +166,6 @@ spirv_vec_t OpenCLC_to_SPIRV(const std::string &Source,
   Args.push_back(SourceName);
 
   // device
-  std::string IPVersionsStr = IPVersionsToString(IPVersionVec);
   if (!IPVersionsStr.empty()) {
     Args.push_back("-device");
     Args.push_back(IPVersionsStr.c_str());
@@ -183,7 +181,6 @@ spirv_vec_t OpenCLC_to_SPIRV(const std::string &Source,
 
   // gather the results ( the SpirV and the Log)
   spirv_vec_t SpirV;
-  std::string CompileLog;
   for (uint32_t i = 0; i < NumOutputs; i++) {
     size_t NameLen = strlen(OutputNames[i]);
     if (NameLen >= 4 && strstr(OutputNames[i], ".spv") != nullptr &&
@@ -194,8 +191,6 @@ spirv_vec_t OpenCLC_to_SPIRV(const std::string &Source,
       if (OutputLengths[i] > 0) {
         const char *LogText = reinterpret_cast<const char *>(Outputs[i]);
         CompileLog.append(LogText, OutputLengths[i]);
-        if (LogPtr != nullptr)
-          LogPtr->append(LogText, OutputLengths[i]);
       }
     }
   }
@@ -220,6 +215,64 @@ spirv_vec_t OpenCLC_to_SPIRV(const std::string &Source,
   return SpirV;
 }
 
+spirv_vec_t OpenCLC_to_SPIRV(const std::string &Source,
+                             const std::vector<uint32_t> &IPVersionVec,
+                             const std::vector<std::string> &UserArgs,
+                             std::string *LogPtr) {
+  // assemble ocloc args
+  std::string CombinedUserArgs =
+      std::accumulate(UserArgs.begin(), UserArgs.end(), std::string(""),
+                      [](const std::string &acc, const std::string &s) {
+                        return acc + s + " ";
+                      });
+  std::string IPVersionsStr = IPVersionsToString(IPVersionVec);
+
+  // The SPIR-V and the log of the compilations, by source, devices and
+  // options. The threads asking for a compilation which is in progress wait
+  // for it instead of compiling the source again.
+  using result_t = std::pair<spirv_vec_t, std::string>;
+  static std::unordered_map<std::string, std::shared_future<result_t>>
+      Compilations;
+  static std::mutex CompilationsMutex;
+
+  std::string Key = IPVersionsStr + '\n' + CombinedUserArgs + '\n' + Source;
+  std::promise<result_t> Promise;
+  std::shared_future<result_t> Result;
+  bool IsCompiling = false;
+  {
+    std::lock_guard<std::mutex> Lock{CompilationsMutex};
+    auto [It, Inserted] = Compilations.try_emplace(Key);
+    if (Inserted)
+      It->second = Promise.get_future().share();
+    Result = It->second;
+    IsCompiling = Inserted;
+  }
+
+  if (IsCompiling) {
+    std::string CompileLog;
+    try {
+      spirv_vec_t SpirV = InvokeOclocCompile(Source, IPVersionsStr,
+                                             CombinedUserArgs, CompileLog);
+      Promise.set_value(result_t{std::move(SpirV), std::move(CompileLog)});
+    } catch (...) {
+      // Failed compilations are not cached, but their waiters get the error.
+      {
+        std::lock_guard<std::mutex> Lock{CompilationsMutex};
+        Compilations.erase(Key);
+      }
+      if (LogPtr != nullptr)
+        LogPtr->append(CompileLog);
+      Promise.set_exception(std::current_exception());
+      throw;
+    }
+  }
+
+  const result_t &Compiled = Result.get();
+  if (LogPtr != nullptr)
+    LogPtr->append(Compiled.second);
+  return Compiled.first;
+}
+
 std::string InvokeOclocQuery(uint32_t IPVersion, const char *identifier) {
 
   std::string QueryLog = "";
@@ -278,52 +331,64 @@ std::string InvokeOclocQuery(uint32_t IPVersion, const char *identifier) {
   return QueryLog;
 }
 
-bool OpenCLC_Feature_Available(const std::string &Feature, uint32_t IPVersion) {
-  static std::string FeatureLog = "";
-  if (FeatureLog.empty()) {
-    try {
-      FeatureLog = InvokeOclocQuery(IPVersion, "CL_DEVICE_OPENCL_C_FEATURES");
-    } catch (sycl::exception &) {
-      return false;
-    }
+// Returns the result of the query for the IP version, or nothing if ocloc
+// fails to answer it. The results are computed once per IP version.
+static std::optional<std::string> CachedOclocQuery(uint32_t IPVersion,
+                                                   const char *identifier) {
+  static std::map<std::pair<uint32_t, std::string>, std::optional<std::string>>
+      Queries;
+  static std::mutex QueriesMutex;
+
+  std::pair<uint32_t, std::string> Key{IPVersion, identifier};
+  {
+    std::lock_guard<std::mutex> Lock{QueriesMutex};
+    auto It = Queries.find(Key);
+    if (It != Queries.end())
+      return It->second;
   }
 
+  std::optional<std::string> Result;
+  try {
+    Result = InvokeOclocQuery(IPVersion, identifier);
+  } catch (sycl::exception &) {
+  }
+  std::lock_guard<std::mutex> Lock{QueriesMutex};
+  return Queries.try_emplace(std::move(Key), std::move(Result)).first->second;
+}
+
+bool OpenCLC_Feature_Available(const std::string &Feature, uint32_t IPVersion) {
+  std::optional<std::string> FeatureLog =
+      CachedOclocQuery(IPVersion, "CL_DEVICE_OPENCL_C_FEATURES");
+  if (!FeatureLog)
+    return false;
+
   // Allright, we have FeatureLog, so let's find that feature!
-  return (FeatureLog.find(Feature) != std::string::npos);
+  return (FeatureLog->find(Feature) != std::string::npos);
 }
 
 bool OpenCLC_Supports_Version(
     const ext::oneapi::experimental::cl_version &Version, uint32_t IPVersion) {
-  static std::string VersionLog = "";
-  if (VersionLog.empty()) {
-    try {
-      VersionLog =
-          InvokeOclocQuery(IPVersion, "CL_DEVICE_OPENCL_C_ALL_VERSIONS");
-    } catch (sycl::exception &) {
-      return false;
-    }
-  }
+  std::optional<std::string> VersionLog =
+      CachedOclocQuery(IPVersion, "CL_DEVICE_OPENCL_C_ALL_VERSIONS");
+  if (!VersionLog)
+    return false;
 
   // Have VersionLog, will search.
   // "OpenCL C":1.0.0 "OpenCL C":1.1.0 "OpenCL C":1.2.0 "OpenCL C":3.0.0
   std::stringstream ss;
   ss << Version.major << "." << Version.minor << "." << Version.patch;
-  return VersionLog.find(ss.str());
+  return VersionLog->find(ss.str()) != std::string::npos;
 }
 
 bool OpenCLC_Supports_Extension(
     const std::string &Name, ext::oneapi::experimental::cl_version *VersionPtr,
     uint32_t IPVersion) {
   std::error_code rt_errc = make_error_code(errc::runtime);
-  static std::string ExtensionByVersionLog = "";
-  if (ExtensionByVersionLog.empty()) {
-    try {
-      ExtensionByVersionLog =
-          InvokeOclocQuery(IPVersion, "CL_DEVICE_EXTENSIONS_WITH_VERSION");
-    } catch (sycl::exception &) {
-      return false;
-    }
-  }
+  std::optional<std::string> CachedLog =
+      CachedOclocQuery(IPVersion, "CL_DEVICE_EXTENSIONS_WITH_VERSION");
+  if (!CachedLog)
+    return false;
+  const std::string &ExtensionByVersionLog = *CachedLog;
 
   // ExtensionByVersionLog is ready. Time to find Name, and update VersionPtr.
   // cl_khr_byte_addressable_store:1.0.0 cl_khr_device_uuid:1.0.0 ...
@@ -364,18 +429,19 @@ bool OpenCLC_Supports_Extension(
 }
 
 std::string OpenCLC_Profile(uint32_t IPVersion) {
-  try {
-    std::string result = InvokeOclocQuery(IPVersion, "CL_DEVICE_PROFILE");
-    // NOTE: result has \n\n amended. Clean it up.
-    // TODO: remove this once the ocloc query is fixed.
-    while (result.back() == '\n') {
-      result.pop_back();
-    }
-
-    return result;
-  } catch (sycl::exception &) {
+  std::optional<std::string> CachedResult =
+      CachedOclocQuery(IPVersion, "CL_DEVICE_PROFILE");
+  if (!CachedResult)
     return "";
+
+  std::string result = *CachedResult;
+  // NOTE: result has \n\n amended. Clean it up.
+  // TODO: remove this once the ocloc query is fixed.
+  while (!result.empty() && result.back() == '\n') {
+    result.pop_back();
   }
+
+  return result;
 }
 
 } // namespace detail
@@ -63,11 +63,11 @@ kernel_impl::kernel_impl(sycl::detail::pi::PiKernel Kernel,
                          DeviceImageImplPtr DeviceImageImpl,
                          KernelBundleImplPtr KernelBundleImpl,
                          const KernelArgMask *ArgMask, PiProgram ProgramPI,
-                         std::mutex *CacheMutex)
+                         std::shared_ptr<CachedKernelMutex> CacheMutex)
     : MKernel(Kernel), MContext(std::move(ContextImpl)), MProgram(ProgramPI),
       MCreatedFromSource(false), MDeviceImageImpl(std::move(DeviceImageImpl)),
       MKernelBundleImpl(std::move(KernelBundleImpl)),
-      MKernelArgMaskPtr{ArgMask}, MCacheMutex{CacheMutex} {
+      MKernelArgMaskPtr{ArgMask}, MCacheMutex{std::move(CacheMutex)} {
   MIsInterop = MKernelBundleImpl->isInterop();
 }
 
@@ -76,7 +76,7 @@ public:
               DeviceImageImplPtr DeviceImageImpl,
               KernelBundleImplPtr KernelBundleImpl,
               const KernelArgMask *ArgMask, PiProgram ProgramPI,
-              std::mutex *CacheMutex);
+              std::shared_ptr<CachedKernelMutex> CacheMutex);
 
   /// Constructs a SYCL kernel for host device
   ///
@@ -195,7 +195,9 @@ public:
   }
 
   const KernelArgMask *getKernelArgMask() const { return MKernelArgMaskPtr; }
-  std::mutex *getCacheMutex() const { return MCacheMutex; }
+  const std::shared_ptr<CachedKernelMutex> &getCacheMutex() const {
+    return MCacheMutex;
+  }
 
 private:
   sycl::detail::pi::PiKernel MKernel;
@@ -207,7 +209,7 @@ private:
   bool MIsInterop = false;
   std::mutex MNoncacheableEnqueueMutex;
   const KernelArgMask *MKernelArgMaskPtr;
-  std::mutex *MCacheMutex = nullptr;
+  std::shared_ptr<CachedKernelMutex> MCacheMutex;
 
   bool isBuiltInKernel(const device &Device) const;
   void checkIfValidForNumArgsInfoQuery() const;
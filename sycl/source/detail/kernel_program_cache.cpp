@@ -6,16 +6,286 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <detail/config.hpp>
 #include <detail/context_impl.hpp>
 #include <detail/kernel_program_cache.hpp>
 #include <detail/plugin.hpp>
 
+#include <cstring>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
 namespace sycl {
 inline namespace _V1 {
 namespace detail {
+KernelProgramCache::~KernelProgramCache() {
+  releaseIdleKernelClones(/*Program=*/nullptr);
+}
+
+void KernelArgState::filter(std::vector<pi_kernel_arg> &Args) {
+  size_t NumChanged = 0;
+  for (const pi_kernel_arg &Arg : Args) {
+    if (Arg.index >= MArgs.size())
+      MArgs.resize(Arg.index + 1);
+    ArgT &Last = MArgs[Arg.index];
+    if (Arg.kind == PI_KERNEL_ARG_KIND_MEM_OBJ) {
+      Last.IsSet = false;
+      Args[NumChanged++] = Arg;
+      continue;
+    }
+    const bool HasValue = Arg.value != nullptr;
+    if (Last.IsSet && Last.Kind == Arg.kind && Last.HasValue == HasValue &&
+        Last.Size == Arg.size &&
+        (!HasValue || !std::memcmp(Last.Value.data(), Arg.value, Arg.size)))
+      continue;
+    Last.IsSet = true;
+    Last.Kind = Arg.kind;
+    Last.HasValue = HasValue;
+    Last.Size = Arg.size;
+    if (HasValue) {
+      const char *Value = static_cast<const char *>(Arg.value);
+      Last.Value.assign(Value, Value + Arg.size);
+    }
+    Args[NumChanged++] = Arg;
+  }
+  Args.resize(NumChanged);
+}
+
+KernelArgState *CachedKernelMutex::getLastArgs() {
+  if (!SYCLConfig<SYCL_CACHE_KERNEL_ARGS>::get())
+    return nullptr;
+  return &LastArgs;
+}
+
 const PluginPtr &KernelProgramCache::getPlugin() {
   return MParentContext->getPlugin();
 }
+
+KernelProgramCache::StringIdT
+KernelProgramCache::getStringId(const std::string &Str) {
+  static std::shared_mutex IdsMutex;
+  static std::unordered_map<std::string, StringIdT> Ids;
+  {
+    std::shared_lock<std::shared_mutex> Lock(IdsMutex);
+    auto It = Ids.find(Str);
+    if (It != Ids.end())
+      return It->second;
+  }
+  std::unique_lock<std::shared_mutex> Lock(IdsMutex);
+  return Ids.try_emplace(Str, Ids.size()).first->second;
+}
+
+KernelProgramCache::KernelFastCacheValT
+KernelProgramCache::tryToGetKernelFast(const KernelFastCacheKeyT &CacheKey,
+                                       const std::string &KernelName) {
+  KernelFastCacheT::Shard &Shard = MKernelFastCache.getShard(CacheKey);
+  // The fast cache is read-mostly, so lookups only take a shared lock.
+  std::shared_lock<std::shared_mutex> Lock(Shard.Mutex);
+  auto It = Shard.Map.find(CacheKey);
+  if (It == Shard.Map.end() || It->second.KernelName != KernelName) {
+    MKernelMisses.fetch_add(1, std::memory_order_relaxed);
+    return std::make_tuple(nullptr, nullptr, nullptr, nullptr);
+  }
+  MKernelHits.fetch_add(1, std::memory_order_relaxed);
+  // Pulling a copy of a kernel and program from the cache, so we need to
+  // retain those resources. This is done under the lock, as eviction removes
+  // the entry before releasing the handles.
+  const PluginPtr &Plugin = getPlugin();
+  Plugin->call<PiApiKind::piKernelRetain>(std::get<0>(It->second.Val));
+  Plugin->call<PiApiKind::piProgramRetain>(std::get<3>(It->second.Val));
+  return It->second.Val;
+}
+
+KernelProgramCache::KernelClone
+KernelProgramCache::acquireKernelClone(
+    const std::shared_ptr<std::mutex> &KernelMutex,
+    sycl::detail::pi::PiProgram Program, const std::string &KernelName) {
+  KernelClone Clone;
+  if (SYCLConfig<SYCL_CACHE_KERNEL_CLONES>::get() == 0)
+    return Clone;
+  {
+    std::lock_guard<std::mutex> Lock(MKernelClones.Mutex);
+    auto It = MKernelClones.Idle.find(KernelMutex.get());
+    if (It != MKernelClones.Idle.end()) {
+      Clone = *It->second;
+      MKernelClones.LRUList.erase(It->second);
+      MKernelClones.Idle.erase(It);
+      return Clone;
+    }
+    if (!MKernelClones.Plugin)
+      MKernelClones.Plugin = getPlugin();
+    Clone.Generation = MKernelClones.Generation;
+  }
+
+  // The copy is set up as the cached kernels are by the ProgramManager.
+  const PluginPtr &Plugin = getPlugin();
+  if (Plugin->call_nocheck<PiApiKind::piKernelCreate>(
+          Program, KernelName.c_str(), &Clone.Kernel) != PI_SUCCESS) {
+    Clone.Kernel = nullptr;
+    return Clone;
+  }
+  if (MParentContext->getPlatformImpl()->supports_usm() &&
+      Plugin->call_nocheck<PiApiKind::piKernelSetExecInfo>(
+          Clone.Kernel, PI_USM_INDIRECT_ACCESS, sizeof(pi_bool), &PI_TRUE) !=
+          PI_SUCCESS) {
+    Plugin->call_nocheck<PiApiKind::piKernelRelease>(Clone.Kernel);
+    Clone.Kernel = nullptr;
+    return Clone;
+  }
+  Clone.Origin = KernelMutex;
+  Clone.Program = Program;
+  if (SYCLConfig<SYCL_CACHE_KERNEL_ARGS>::get())
+    Clone.LastArgs = std::make_shared<KernelArgState>();
+  return Clone;
+}
+
+void KernelProgramCache::releaseKernelClone(const KernelClone &Clone) {
+  const size_t MaxClones = SYCLConfig<SYCL_CACHE_KERNEL_CLONES>::get();
+  std::vector<sycl::detail::pi::PiKernel> Released;
+  {
+    std::lock_guard<std::mutex> Lock(MKernelClones.Mutex);
+    if (Clone.Generation != MKernelClones.Generation || MaxClones == 0) {
+      Released.push_back(Clone.Kernel);
+    } else {
+      KernelClonePool::LRUListT &LRU = MKernelClones.LRUList;
+      LRU.push_front(Clone);
+      MKernelClones.Idle.emplace(Clone.Origin.get(), LRU.begin());
+      while (LRU.size() > MaxClones) {
+        auto Range = MKernelClones.Idle.equal_range(LRU.back().Origin.get());
+        for (auto It = Range.first; It != Range.second; ++It) {
+          if (It->second == std::prev(LRU.end())) {
+            MKernelClones.Idle.erase(It);
+            break;
+          }
+        }
+        Released.push_back(LRU.back().Kernel);
+        LRU.pop_back();
+      }
+    }
+  }
+  for (sycl::detail::pi::PiKernel Kernel : Released)
+    MKernelClones.Plugin->call_nocheck<PiApiKind::piKernelRelease>(Kernel);
+}
+
+void KernelProgramCache::releaseIdleKernelClones(
+    sycl::detail::pi::PiProgram Program) {
+  std::vector<sycl::detail::pi::PiKernel> Released;
+  {
+    std::lock_guard<std::mutex> Lock(MKernelClones.Mutex);
+    KernelClonePool::LRUListT &LRU = MKernelClones.LRUList;
+    for (auto It = LRU.begin(); It != LRU.end();) {
+      if (Program && It->Program != Program) {
+        ++It;
+        continue;
+      }
+      auto Range = MKernelClones.Idle.equal_range(It->Origin.get());
+      for (auto IdleIt = Range.first; IdleIt != Range.second; ++IdleIt) {
+        if (IdleIt->second == It) {
+          MKernelClones.Idle.erase(IdleIt);
+          break;
+        }
+      }
+      Released.push_back(It->Kernel);
+      It = LRU.erase(It);
+    }
+    if (!Program)
+      ++MKernelClones.Generation;
+  }
+  for (sycl::detail::pi::PiKernel Kernel : Released)
+    MKernelClones.Plugin->call_nocheck<PiApiKind::piKernelRelease>(Kernel);
+}
+
+void KernelProgramCache::registerProgramFetch(const ProgramCacheKeyT &CacheKey,
+                                              size_t ProgramSize,
+                                              bool IsEvictable) {
+  const size_t MaxSize = SYCLConfig<SYCL_CACHE_IN_MEM_MAX_SIZE>::get();
+  if (MaxSize == 0 || !IsEvictable)
+    return;
+
+  // Evicted programs are released once the cache locks are not held anymore.
+  std::vector<ProgramBuildResultPtr> Evicted;
+  {
+    auto LockedCache = acquireCachedPrograms();
+    ProgramCache &ProgCache = LockedCache.get();
+    ProgramCache::LRUListT &LRU = ProgCache.LRUList;
+
+    auto EntryIt = ProgCache.LRUEntries.find(CacheKey);
+    if (EntryIt != ProgCache.LRUEntries.end()) {
+      LRU.splice(LRU.begin(), LRU, EntryIt->second.first);
+    } else {
+      // The program may have been evicted by another thread in the meantime.
+      if (ProgCache.Cache.find(CacheKey) == ProgCache.Cache.end())
+        return;
+      LRU.push_front(CacheKey);
+      ProgCache.LRUEntries.emplace(CacheKey,
+                                   std::make_pair(LRU.begin(), ProgramSize));
+      ProgCache.LRUSize += ProgramSize;
+    }
+
+    // The program which has just been fetched is never evicted.
+    while (ProgCache.LRUSize > MaxSize && LRU.size() > 1) {
+      ProgramCacheKeyT VictimKey = std::move(LRU.back());
+      LRU.pop_back();
+      auto VictimEntryIt = ProgCache.LRUEntries.find(VictimKey);
+      ProgCache.LRUSize -= VictimEntryIt->second.second;
+      ProgCache.LRUEntries.erase(VictimEntryIt);
+
+      auto CacheIt = ProgCache.Cache.find(VictimKey);
+      if (CacheIt == ProgCache.Cache.end())
+        continue;
+      Evicted.push_back(std::move(CacheIt->second));
+      ProgCache.Cache.erase(CacheIt);
+
+      auto KeyRange = ProgCache.KeyMap.equal_range(
+          std::make_pair(VictimKey.first.second, VictimKey.second));
+      for (auto KeyIt = KeyRange.first; KeyIt != KeyRange.second; ++KeyIt) {
+        if (KeyIt->second == VictimKey) {
+          ProgCache.KeyMap.erase(KeyIt);
+          break;
+        }
+      }
+      MProgramEvictions.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  for (const ProgramBuildResultPtr &Program : Evicted)
+    evictKernelsOfProgram(Program->Val);
+}
+
+void KernelProgramCache::evictKernelsOfProgram(
+    sycl::detail::pi::PiProgram Program) {
+  releaseIdleKernelClones(Program);
+
+  // Remove the fast cache entries first, so that nobody can retain the kernel
+  // handles which are about to be released.
+  for (KernelFastCacheT::Shard &Shard : MKernelFastCache.Shards) {
+    std::unique_lock<std::shared_mutex> Lock(Shard.Mutex);
+    for (auto It = Shard.Map.begin(); It != Shard.Map.end();) {
+      if (std::get<3>(It->second.Val) == Program)
+        It = Shard.Map.erase(It);
+      else
+        ++It;
+    }
+  }
+
+  auto LockedKernels = acquireKernelsPerProgramCache();
+  KernelCacheT &KernelCache = LockedKernels.get();
+  auto It = KernelCache.find(Program);
+  if (It == KernelCache.end())
+    return;
+  // The build results are released once their mutexes are not used anymore
+  // by the threads which got the kernels before the eviction.
+  const PluginPtr &Plugin = getPlugin();
+  for (auto &NameAndKernel : It->second) {
+    KernelBuildResultPtr &Kernel = NameAndKernel.second;
+    if (Kernel->State.load() == BuildState::BS_Done && Kernel->Val.first) {
+      Plugin->call<PiApiKind::piKernelRelease>(Kernel->Val.first);
+      Kernel->Val.first = nullptr;
+    }
+  }
+  KernelCache.erase(It);
+}
 } // namespace detail
 } // namespace _V1
 } // namespace sycl
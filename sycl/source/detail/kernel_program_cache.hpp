@@ -10,16 +10,23 @@
 
 #include <detail/kernel_arg_mask.hpp>
 #include <detail/platform_impl.hpp>
+#include <detail/wg_size_autotuner.hpp>
 #include <sycl/detail/common.hpp>
 #include <sycl/detail/locked.hpp>
 #include <sycl/detail/os_util.hpp>
 #include <sycl/detail/pi.hpp>
 #include <sycl/detail/util.hpp>
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
+#include <list>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <string>
 #include <type_traits>
+#include <vector>
 
 #include <boost/unordered/unordered_flat_map.hpp>
 #include <boost/unordered_map.hpp>
@@ -31,6 +38,43 @@ namespace sycl {
 inline namespace _V1 {
 namespace detail {
 class context_impl;
+
+/// Arguments last set on a kernel, so that a launch only sets the arguments
+/// which have changed since the previous one. Must be used under the lock of
+/// the kernel.
+class KernelArgState {
+public:
+  /// Removes from Args the arguments which are already set, and records the
+  /// others as set. The memory objects are always kept, as some plugins only
+  /// resolve them for the next launch.
+  void filter(std::vector<pi_kernel_arg> &Args);
+
+  /// Forgets all the arguments, e.g. after they failed to be set.
+  void clear() { MArgs.clear(); }
+
+private:
+  struct ArgT {
+    bool IsSet = false;
+    pi_kernel_arg_kind Kind = PI_KERNEL_ARG_KIND_VALUE;
+    // Local memory arguments have a size but no value.
+    bool HasValue = false;
+    size_t Size = 0;
+    std::vector<char> Value;
+  };
+  std::vector<ArgT> MArgs;
+};
+
+/// Mutex of a cached kernel, which also holds the arguments last set on the
+/// kernel, so that a launch finds them without any lookup.
+struct CachedKernelMutex : std::mutex {
+  /// Returns the arguments last set on the kernel, or nullptr if
+  /// SYCL_CACHE_KERNEL_ARGS disables their tracking. Must be used under the
+  /// lock.
+  KernelArgState *getLastArgs();
+
+  KernelArgState LastArgs;
+};
+
 class KernelProgramCache {
 public:
   /// Denotes build error data. The data is filled in from sycl::exception
@@ -49,7 +93,7 @@ public:
   /// The pointer is not null if and only if the entity is usable.
   /// State of the entity is provided by the user of cache instance.
   /// Currently there is only a single user - ProgramManager class.
-  template <typename T> struct BuildResult {
+  template <typename T, typename MutexT = std::mutex> struct BuildResult {
     T Val;
     std::atomic<BuildState> State{BuildState::BS_Initial};
     BuildError Error{"", 0};
@@ -66,7 +110,7 @@ public:
     /// wake-up or another thread will wake it up.
     std::condition_variable MBuildCV;
     /// A mutex to be employed along with MBuildCV.
-    std::mutex MBuildResultMutex;
+    MutexT MBuildResultMutex;
 
     BuildState
     waitUntilTransition(BuildState From = BuildState::BS_InProgress) {
@@ -116,6 +160,16 @@ public:
     ::boost::unordered_map<ProgramCacheKeyT, ProgramBuildResultPtr> Cache;
     ::boost::unordered_multimap<CommonProgramKeyT, ProgramCacheKeyT> KeyMap;
 
+    using LRUListT = std::list<ProgramCacheKeyT>;
+    /// Programs which may be evicted, the most recently used one first.
+    /// Only used if SYCL_CACHE_IN_MEM_MAX_SIZE is set.
+    LRUListT LRUList;
+    ::boost::unordered_map<ProgramCacheKeyT,
+                           std::pair<LRUListT::iterator, size_t /*Size*/>>
+        LRUEntries;
+    /// Total size of the programs in LRUList.
+    size_t LRUSize = 0;
+
     size_t size() const noexcept { return Cache.size(); }
   };
 
@@ -123,7 +177,8 @@ public:
 
   using KernelArgMaskPairT =
       std::pair<sycl::detail::pi::PiKernel, const KernelArgMask *>;
-  struct KernelBuildResult : public BuildResult<KernelArgMaskPairT> {
+  struct KernelBuildResult
+      : public BuildResult<KernelArgMaskPairT, CachedKernelMutex> {
     PluginPtr Plugin;
     KernelBuildResult(const PluginPtr &Plugin) : Plugin(Plugin) {
       Val.first = nullptr;
@@ -143,21 +198,91 @@ public:
   using KernelCacheT =
       ::boost::unordered_map<sycl::detail::pi::PiProgram, KernelByNameT>;
 
+  /// Identifier of a string interned with getStringId().
+  using StringIdT = size_t;
+
+  /// The build options are represented by their interned identifier and the
+  /// kernel name by its getKernelNameHash(), so that a lookup hashes integers
+  /// only. As kernel names may collide on their hash, the name is kept in the
+  /// entry and compared on a hit.
   using KernelFastCacheKeyT =
-      std::tuple<SerializedObj, sycl::detail::pi::PiDevice, std::string,
-                 std::string>;
+      std::tuple<sycl::detail::pi::PiDevice, StringIdT /*BuildOptions*/,
+                 uint64_t /*KernelNameHash*/>;
+  /// The mutex of a cached kernel shares the ownership of its build result,
+  /// which is released once the program is evicted and the mutex is not used
+  /// anymore.
   using KernelFastCacheValT =
-      std::tuple<sycl::detail::pi::PiKernel, std::mutex *,
+      std::tuple<sycl::detail::pi::PiKernel, std::shared_ptr<CachedKernelMutex>,
                  const KernelArgMask *, sycl::detail::pi::PiProgram>;
+  struct KernelFastCacheEntryT {
+    KernelFastCacheValT Val;
+    std::string KernelName;
+  };
   // This container is used as a fast path for retrieving cached kernels.
   // unordered_flat_map is used here to reduce lookup overhead.
   // The slow path is used only once for each newly created kernel, so the
   // higher overhead of insertion that comes with unordered_flat_map is more
   // of an issue there. For that reason, those use regular unordered maps.
-  using KernelFastCacheT =
-      ::boost::unordered_flat_map<KernelFastCacheKeyT, KernelFastCacheValT>;
+  using KernelFastCacheMapT =
+      ::boost::unordered_flat_map<KernelFastCacheKeyT, KernelFastCacheEntryT>;
+
+  /// The fast cache is split into shards by the key hash, each of them having
+  /// its own lock, so that threads looking up different kernels do not contend.
+  struct KernelFastCacheT {
+    static constexpr size_t NumShards = 8;
 
-  ~KernelProgramCache() = default;
+    struct alignas(64) Shard {
+      std::shared_mutex Mutex;
+      KernelFastCacheMapT Map;
+    };
+
+    Shard &getShard(const KernelFastCacheKeyT &Key) {
+      return Shards[::boost::hash<KernelFastCacheKeyT>{}(Key) % NumShards];
+    }
+
+    size_t size() {
+      size_t Size = 0;
+      for (Shard &S : Shards) {
+        std::shared_lock<std::shared_mutex> Lock(S.Mutex);
+        Size += S.Map.size();
+      }
+      return Size;
+    }
+
+    void clear() {
+      for (Shard &S : Shards) {
+        std::unique_lock<std::shared_mutex> Lock(S.Mutex);
+        S.Map.clear();
+      }
+    }
+
+    std::array<Shard, NumShards> Shards;
+  };
+
+  /// Cache usage statistics.
+  struct CacheStats {
+    size_t ProgramHits = 0;
+    size_t ProgramMisses = 0;
+    size_t ProgramEvictions = 0;
+    size_t KernelFastCacheHits = 0;
+    size_t KernelFastCacheMisses = 0;
+  };
+
+  /// Copy of a cached kernel, made for a launch while the cached kernel is in
+  /// use by another thread.
+  struct KernelClone {
+    sycl::detail::pi::PiKernel Kernel = nullptr;
+    /// Mutex of the cached kernel, which identifies it. It is held so that
+    /// its address is not reused while the copy exists.
+    std::shared_ptr<std::mutex> Origin;
+    sycl::detail::pi::PiProgram Program = nullptr;
+    size_t Generation = 0;
+    /// Arguments last set on the copy, null if SYCL_CACHE_KERNEL_ARGS disables
+    /// their tracking.
+    std::shared_ptr<KernelArgState> LastArgs;
+  };
+
+  ~KernelProgramCache();
 
   void setContextPtr(const ContextPtr &AContext) { MParentContext = AContext; }
 
@@ -180,6 +305,9 @@ public:
       CommonProgramKeyT CommonKey =
           std::make_pair(CacheKey.first.second, CacheKey.second);
       ProgCache.KeyMap.emplace(CommonKey, CacheKey);
+      MProgramMisses.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      MProgramHits.fetch_add(1, std::memory_order_relaxed);
     }
     return std::make_pair(It->second, DidInsert);
   }
@@ -195,22 +323,64 @@ public:
     return std::make_pair(It->second, DidInsert);
   }
 
-  template <typename KeyT>
-  KernelFastCacheValT tryToGetKernelFast(KeyT &&CacheKey) {
-    std::unique_lock<std::mutex> Lock(MKernelFastCacheMutex);
-    auto It = MKernelFastCache.find(CacheKey);
-    if (It != MKernelFastCache.end()) {
-      return It->second;
-    }
-    return std::make_tuple(nullptr, nullptr, nullptr, nullptr);
+  /// Returns an identifier uniquely representing the string for the lifetime
+  /// of the process. Strings which have already been seen are looked up under
+  /// a shared lock only.
+  static StringIdT getStringId(const std::string &Str);
+
+  /// Looks up the kernel named KernelName in the fast cache. If the kernel is
+  /// found, its kernel and program handles are retained on behalf of the
+  /// caller, so that they stay valid even if the program gets evicted right
+  /// after the lookup.
+  KernelFastCacheValT tryToGetKernelFast(const KernelFastCacheKeyT &CacheKey,
+                                         const std::string &KernelName);
+
+  template <typename ValT>
+  void saveKernel(const KernelFastCacheKeyT &CacheKey,
+                  const std::string &KernelName, ValT &&CacheVal) {
+    KernelFastCacheT::Shard &Shard = MKernelFastCache.getShard(CacheKey);
+    std::unique_lock<std::shared_mutex> Lock(Shard.Mutex);
+    // if no insertion took place, thus some other thread has already inserted
+    // smth in the cache, or another kernel has a colliding name hash, in which
+    // case this one is always looked up through the slow path
+    Shard.Map.emplace(CacheKey,
+                      KernelFastCacheEntryT{std::forward<ValT>(CacheVal),
+                                            KernelName});
   }
 
-  template <typename KeyT, typename ValT>
-  void saveKernel(KeyT &&CacheKey, ValT &&CacheVal) {
-    std::unique_lock<std::mutex> Lock(MKernelFastCacheMutex);
-    // if no insertion took place, thus some other thread has already inserted
-    // smth in the cache
-    MKernelFastCache.emplace(CacheKey, CacheVal);
+  /// Takes an idle copy of the cached kernel guarded by KernelMutex, or
+  /// creates one from Program. The kernel of the returned clone is null if
+  /// copies are disabled or cannot be created, in which case the cached kernel
+  /// must be used under its mutex.
+  KernelClone
+  acquireKernelClone(const std::shared_ptr<std::mutex> &KernelMutex,
+                     sycl::detail::pi::PiProgram Program,
+                     const std::string &KernelName);
+
+  /// Gives back a copy taken with acquireKernelClone. The least recently used
+  /// idle copies are released beyond SYCL_CACHE_KERNEL_CLONES.
+  void releaseKernelClone(const KernelClone &Clone);
+
+  /// Marks the built program as the most recently used one and evicts the
+  /// least recently used programs, along with their kernels, while the total
+  /// size of the cached programs exceeds SYCL_CACHE_IN_MEM_MAX_SIZE.
+  ///
+  /// \param CacheKey is the key the program is cached with.
+  /// \param ProgramSize is the size of the device image the program is built
+  ///        from.
+  /// \param IsEvictable is false if the program holds state which must not be
+  ///        lost, e.g. device globals. Such programs are never evicted.
+  void registerProgramFetch(const ProgramCacheKeyT &CacheKey,
+                            size_t ProgramSize, bool IsEvictable);
+
+  CacheStats getStats() const {
+    CacheStats Stats;
+    Stats.ProgramHits = MProgramHits.load(std::memory_order_relaxed);
+    Stats.ProgramMisses = MProgramMisses.load(std::memory_order_relaxed);
+    Stats.ProgramEvictions = MProgramEvictions.load(std::memory_order_relaxed);
+    Stats.KernelFastCacheHits = MKernelHits.load(std::memory_order_relaxed);
+    Stats.KernelFastCacheMisses = MKernelMisses.load(std::memory_order_relaxed);
+    return Stats;
   }
 
   /// Clears cache state.
@@ -219,12 +389,15 @@ public:
   void reset() {
     std::lock_guard<std::mutex> L1(MProgramCacheMutex);
     std::lock_guard<std::mutex> L2(MKernelsPerProgramCacheMutex);
-    std::lock_guard<std::mutex> L3(MKernelFastCacheMutex);
+    MKernelFastCache.clear();
+    releaseIdleKernelClones(/*Program=*/nullptr);
     MCachedPrograms = ProgramCache{};
     MKernelsPerProgramCache = KernelCacheT{};
-    MKernelFastCache = KernelFastCacheT{};
+    MWGSizeAutotuner.reset();
   }
 
+  wg_size_autotuner &getWGSizeAutotuner() { return MWGSizeAutotuner; }
+
   /// Try to fetch entity (kernel or program) from cache. If there is no such
   /// entity try to build it. Throw any exception build process may throw.
   /// This method eliminates unwanted builds by employing atomic variable with
@@ -313,10 +486,39 @@ private:
   KernelCacheT MKernelsPerProgramCache;
   ContextPtr MParentContext;
 
-  std::mutex MKernelFastCacheMutex;
   KernelFastCacheT MKernelFastCache;
   friend class ::MockKernelProgramCache;
 
+  std::atomic<size_t> MProgramHits{0};
+  std::atomic<size_t> MProgramMisses{0};
+  std::atomic<size_t> MProgramEvictions{0};
+  std::atomic<size_t> MKernelHits{0};
+  std::atomic<size_t> MKernelMisses{0};
+
+  /// Local sizes chosen for the launches over a sycl::range in the context.
+  wg_size_autotuner MWGSizeAutotuner;
+
+  /// Idle copies of the cached kernels. They are kept with the plugin, as the
+  /// parent context may be gone when the cache is destroyed.
+  struct KernelClonePool {
+    std::mutex Mutex;
+    PluginPtr Plugin;
+    using LRUListT = std::list<KernelClone>;
+    /// The most recently used copy first.
+    LRUListT LRUList;
+    ::boost::unordered_multimap<std::mutex *, LRUListT::iterator> Idle;
+    /// Incremented when the cache is reset, the copies of the previous
+    /// generations are released when given back.
+    size_t Generation = 0;
+  } MKernelClones;
+
+  /// Releases the idle copies of the kernels of Program, or all of them if
+  /// Program is null, which also starts a new generation.
+  void releaseIdleKernelClones(sycl::detail::pi::PiProgram Program);
+
+  /// Removes the kernels of the evicted program from the kernel caches.
+  void evictKernelsOfProgram(sycl::detail::pi::PiProgram Program);
+
   const PluginPtr &getPlugin();
 };
 } // namespace detail
@@ -8,7 +8,9 @@
 
 #include <detail/context_impl.hpp>
 #include <detail/device_image_impl.hpp>
+#include <detail/config.hpp>
 #include <detail/event_impl.hpp>
+#include <detail/host_staging_pool.hpp>
 #include <detail/mem_alloc_helper.hpp>
 #include <detail/memory_manager.hpp>
 #include <detail/pi_utils.hpp>
@@ -19,6 +21,7 @@
 #include <sycl/usm/usm_pointer_info.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstring>
 #include <vector>
@@ -119,6 +122,7 @@ static void waitForEvents(const std::vector<EventImplPtr> &Events) {
   // Assuming all events will be on the same device or
   // devices associated with the same Backend.
   if (!Events.empty()) {
+    queue_impl::flushDeferredCrossQueueDeps();
     const PluginPtr &Plugin = Events[0]->getPlugin();
     std::vector<sycl::detail::pi::PiEvent> PiEvents(Events.size());
     std::transform(Events.begin(), Events.end(), PiEvents.begin(),
@@ -493,6 +497,198 @@ void prepTermPositions(TermPositions &pos, int Dimensions,
   }
 }
 
+// Checks whether a copy between host memory and a buffer should be staged
+// through pinned host buffers. This is the case for copies spanning several
+// staging buffers, from pageable memory, to devices not sharing the host
+// memory, whose dependencies have completed so that staging, which is done on
+// the host, does not wait for other commands.
+static bool
+useHostStaging(const QueueImplPtr &Queue, const void *HostPtr, size_t Size,
+               const std::vector<sycl::detail::pi::PiEvent> &DepEvents) {
+  if (Size <= host_staging_pool::BufferSize ||
+      !SYCLConfig<SYCL_HOST_STAGING_BUFFERS>::get())
+    return false;
+  const DeviceImplPtr &Device = Queue->getDeviceImplPtr();
+  if (Device->get_info<info::device::host_unified_memory>() ||
+      !Device->has(aspect::usm_host_allocations))
+    return false;
+
+  if (Queue->getContextImplPtr()->getUSMAllocationTracker().find(HostPtr))
+    return false;
+  const PluginPtr &Plugin = Queue->getPlugin();
+  pi_usm_type PtrType = PI_MEM_TYPE_UNKNOWN;
+  if (Plugin->call_nocheck<PiApiKind::piextUSMGetMemAllocInfo>(
+          Queue->getContextImplPtr()->getHandleRef(), HostPtr,
+          PI_MEM_ALLOC_TYPE, sizeof(PtrType), &PtrType, nullptr) !=
+          PI_SUCCESS ||
+      PtrType != PI_MEM_TYPE_UNKNOWN)
+    return false;
+
+  return std::all_of(
+      DepEvents.begin(), DepEvents.end(),
+      [&](sycl::detail::pi::PiEvent Event) {
+        pi_int32 Status = PI_EVENT_QUEUED;
+        Plugin->call<PiApiKind::piEventGetInfo>(
+            Event, PI_EVENT_INFO_COMMAND_EXECUTION_STATUS, sizeof(Status),
+            &Status, nullptr);
+        return Status == PI_EVENT_COMPLETE;
+      });
+}
+
+// Writes host memory to a buffer in chunks copied to two staging buffers in
+// turn, so that copying a chunk on the host overlaps with the transfer of the
+// previous one.
+// \return false if the staging buffers could not be allocated.
+static bool copyH2DStaged(const QueueImplPtr &TgtQueue,
+                          sycl::detail::pi::PiMem DstMem, size_t DstOffset,
+                          const char *SrcMem, size_t Size,
+                          sycl::detail::pi::PiEvent &OutEvent) {
+  host_staging_pool &Pool =
+      TgtQueue->getContextImplPtr()->getHostStagingPool();
+  std::array<void *, 2> Buffers{Pool.acquire(), Pool.acquire()};
+  std::array<sycl::detail::pi::PiEvent, 2> Events{nullptr, nullptr};
+  if (!Buffers[0] || !Buffers[1]) {
+    for (void *Buffer : Buffers)
+      if (Buffer)
+        Pool.release(Buffer, nullptr);
+    return false;
+  }
+
+  const sycl::detail::pi::PiQueue Queue = TgtQueue->getHandleRef();
+  const PluginPtr &Plugin = TgtQueue->getPlugin();
+  for (size_t Offset = 0, I = 0; Offset < Size;
+       Offset += host_staging_pool::BufferSize, I ^= 1) {
+    const size_t ChunkSize =
+        std::min(host_staging_pool::BufferSize, Size - Offset);
+    if (Events[I]) {
+      Plugin->call<PiApiKind::piEventsWait>(1, &Events[I]);
+      Plugin->call<PiApiKind::piEventRelease>(Events[I]);
+    }
+    std::memcpy(Buffers[I], SrcMem + Offset, ChunkSize);
+    Plugin->call<PiApiKind::piEnqueueMemBufferWrite>(
+        Queue, DstMem, /*blocking_write=*/PI_FALSE, DstOffset + Offset,
+        ChunkSize, Buffers[I], 0, nullptr, &Events[I]);
+  }
+
+  // The chunks may be written in any order by out-of-order queues.
+  Plugin->call<PiApiKind::piEnqueueEventsWait>(Queue, Events.size(),
+                                               Events.data(), &OutEvent);
+  // The buffers are reused once the last transfers from them have completed.
+  for (size_t I = 0; I < Buffers.size(); ++I)
+    Pool.release(Buffers[I], Events[I]);
+  return true;
+}
+
+// Reads a buffer to host memory in chunks transferred to two staging buffers
+// in turn, so that the transfer of a chunk overlaps with copying the previous
+// one on the host.
+// \return false if the staging buffers could not be allocated.
+static bool
+copyD2HStaged(const QueueImplPtr &SrcQueue, sycl::detail::pi::PiMem SrcMem,
+              size_t SrcOffset, char *DstMem, size_t Size,
+              const std::vector<sycl::detail::pi::PiEvent> &DepEvents,
+              sycl::detail::pi::PiEvent &OutEvent) {
+  host_staging_pool &Pool =
+      SrcQueue->getContextImplPtr()->getHostStagingPool();
+  std::array<void *, 2> Buffers{Pool.acquire(), Pool.acquire()};
+  if (!Buffers[0] || !Buffers[1]) {
+    for (void *Buffer : Buffers)
+      if (Buffer)
+        Pool.release(Buffer, nullptr);
+    return false;
+  }
+
+  const sycl::detail::pi::PiQueue Queue = SrcQueue->getHandleRef();
+  const PluginPtr &Plugin = SrcQueue->getPlugin();
+  std::array<sycl::detail::pi::PiEvent, 2> Events{nullptr, nullptr};
+  std::array<size_t, 2> ChunkOffsets{0, 0};
+  sycl::detail::pi::PiEvent LastEvent = nullptr;
+  auto Drain = [&](size_t I) {
+    Plugin->call<PiApiKind::piEventsWait>(1, &Events[I]);
+    const size_t ChunkSize =
+        std::min(host_staging_pool::BufferSize, Size - ChunkOffsets[I]);
+    std::memcpy(DstMem + ChunkOffsets[I], Buffers[I], ChunkSize);
+    if (LastEvent)
+      Plugin->call<PiApiKind::piEventRelease>(LastEvent);
+    LastEvent = Events[I];
+    Events[I] = nullptr;
+  };
+
+  for (size_t Offset = 0, I = 0; Offset < Size;
+       Offset += host_staging_pool::BufferSize, I ^= 1) {
+    const size_t ChunkSize =
+        std::min(host_staging_pool::BufferSize, Size - Offset);
+    ChunkOffsets[I] = Offset;
+    Plugin->call<PiApiKind::piEnqueueMemBufferRead>(
+        Queue, SrcMem, /*blocking_read=*/PI_FALSE, SrcOffset + Offset,
+        ChunkSize, Buffers[I], DepEvents.size(), DepEvents.data(), &Events[I]);
+    if (Events[I ^ 1])
+      Drain(I ^ 1);
+  }
+  for (size_t I = 0; I < Events.size(); ++I)
+    if (Events[I])
+      Drain(I);
+
+  // The data is only in the destination once the chunks have been copied on
+  // the host, which is done by now.
+  Plugin->call<PiApiKind::piEnqueueEventsWait>(Queue, 1, &LastEvent,
+                                               &OutEvent);
+  Plugin->call<PiApiKind::piEventRelease>(LastEvent);
+  for (void *Buffer : Buffers)
+    Pool.release(Buffer, nullptr);
+  return true;
+}
+
+// Splits a copy of Len bytes into chunks enqueued to the copy sub-queues of
+// Queue, so that the backend can transfer them on different copy engines at
+// the same time. EnqueueChunk(Queue, Offset, Size, NumEvents, Events, Event)
+// enqueues the copy of a chunk.
+// \return false if the copy is not split, in which case it must be enqueued
+// as a whole.
+template <typename EnqueueChunkT>
+static bool
+enqueueSplitCopy(const QueueImplPtr &Queue, size_t Len,
+                 const std::vector<sycl::detail::pi::PiEvent> &DepEvents,
+                 sycl::detail::pi::PiEvent *OutEvent,
+                 EnqueueChunkT EnqueueChunk) {
+  const size_t Threshold = Queue->getCopySplitThreshold();
+  if (!Threshold || Len < Threshold)
+    return false;
+
+  const PluginPtr &Plugin = Queue->getPlugin();
+  const std::vector<sycl::detail::pi::PiQueue> &SubQueues =
+      Queue->getCopySubQueues();
+  // The chunks start once the dependencies of the copy, and the previous
+  // commands for in-order queues, have completed.
+  sycl::detail::pi::PiEvent StartEvent = nullptr;
+  if (Queue->isInOrder() || !DepEvents.empty())
+    Plugin->call<PiApiKind::piEnqueueEventsWait>(
+        Queue->getHandleRef(), DepEvents.size(), DepEvents.data(),
+        &StartEvent);
+
+  constexpr size_t ChunkAlignment = 4096;
+  const size_t ChunkSize =
+      ((Len + SubQueues.size() - 1) / SubQueues.size() + ChunkAlignment - 1) /
+      ChunkAlignment * ChunkAlignment;
+  std::vector<sycl::detail::pi::PiEvent> ChunkEvents;
+  for (size_t Offset = 0, I = 0; Offset < Len; Offset += ChunkSize, ++I) {
+    sycl::detail::pi::PiEvent &ChunkEvent = ChunkEvents.emplace_back();
+    EnqueueChunk(SubQueues[I], Offset, std::min(ChunkSize, Len - Offset),
+                 StartEvent ? 1 : 0, StartEvent ? &StartEvent : nullptr,
+                 &ChunkEvent);
+  }
+
+  // Later commands of the queue depend on the copy through this event.
+  Plugin->call<PiApiKind::piEnqueueEventsWait>(
+      Queue->getHandleRef(), ChunkEvents.size(), ChunkEvents.data(),
+      OutEvent);
+  if (StartEvent)
+    Plugin->call<PiApiKind::piEventRelease>(StartEvent);
+  for (sycl::detail::pi::PiEvent ChunkEvent : ChunkEvents)
+    Plugin->call<PiApiKind::piEventRelease>(ChunkEvent);
+  return true;
+}
+
 void copyH2D(SYCLMemObjI *SYCLMemObj, char *SrcMem, QueueImplPtr,
              unsigned int DimSrc, sycl::range<3> SrcSize,
              sycl::range<3> SrcAccessRange, sycl::id<3> SrcOffset,
@@ -524,6 +720,23 @@ void copyH2D(SYCLMemObjI *SYCLMemObj, char *SrcMem, QueueImplPtr,
     if (1 == DimDst && 1 == DimSrc) {
       if (OutEventImpl != nullptr)
         OutEventImpl->setHostEnqueueTime();
+      if (useHostStaging(TgtQueue, SrcMem + SrcXOffBytes,
+                         DstAccessRangeWidthBytes, DepEvents) &&
+          copyH2DStaged(TgtQueue, DstMem, DstXOffBytes, SrcMem + SrcXOffBytes,
+                        DstAccessRangeWidthBytes, OutEvent))
+        return;
+      if (enqueueSplitCopy(
+              TgtQueue, DstAccessRangeWidthBytes, DepEvents, &OutEvent,
+              [&](sycl::detail::pi::PiQueue SubQueue, size_t Offset,
+                  size_t Size, pi_uint32 NumEvents,
+                  const sycl::detail::pi::PiEvent *Events,
+                  sycl::detail::pi::PiEvent *Event) {
+                Plugin->call<PiApiKind::piEnqueueMemBufferWrite>(
+                    SubQueue, DstMem, /*blocking_write=*/PI_FALSE,
+                    DstXOffBytes + Offset, Size,
+                    SrcMem + SrcXOffBytes + Offset, NumEvents, Events, Event);
+              }))
+        return;
       Plugin->call<PiApiKind::piEnqueueMemBufferWrite>(
           Queue, DstMem,
           /*blocking_write=*/PI_FALSE, DstXOffBytes, DstAccessRangeWidthBytes,
@@ -608,6 +821,23 @@ void copyD2H(SYCLMemObjI *SYCLMemObj, sycl::detail::pi::PiMem SrcMem,
     if (1 == DimDst && 1 == DimSrc) {
       if (OutEventImpl != nullptr)
         OutEventImpl->setHostEnqueueTime();
+      if (useHostStaging(SrcQueue, DstMem + DstXOffBytes,
+                         SrcAccessRangeWidthBytes, DepEvents) &&
+          copyD2HStaged(SrcQueue, SrcMem, SrcXOffBytes, DstMem + DstXOffBytes,
+                        SrcAccessRangeWidthBytes, DepEvents, OutEvent))
+        return;
+      if (enqueueSplitCopy(
+              SrcQueue, SrcAccessRangeWidthBytes, DepEvents, &OutEvent,
+              [&](sycl::detail::pi::PiQueue SubQueue, size_t Offset,
+                  size_t Size, pi_uint32 NumEvents,
+                  const sycl::detail::pi::PiEvent *Events,
+                  sycl::detail::pi::PiEvent *Event) {
+                Plugin->call<PiApiKind::piEnqueueMemBufferRead>(
+                    SubQueue, SrcMem, /*blocking_read=*/PI_FALSE,
+                    SrcXOffBytes + Offset, Size,
+                    DstMem + DstXOffBytes + Offset, NumEvents, Events, Event);
+              }))
+        return;
       Plugin->call<PiApiKind::piEnqueueMemBufferRead>(
           Queue, SrcMem,
           /*blocking_read=*/PI_FALSE, SrcXOffBytes, SrcAccessRangeWidthBytes,
@@ -683,6 +913,17 @@ void copyD2D(SYCLMemObjI *SYCLMemObj, sycl::detail::pi::PiMem SrcMem,
     if (1 == DimDst && 1 == DimSrc) {
       if (OutEventImpl != nullptr)
         OutEventImpl->setHostEnqueueTime();
+      if (enqueueSplitCopy(
+              SrcQueue, SrcAccessRangeWidthBytes, DepEvents, &OutEvent,
+              [&](sycl::detail::pi::PiQueue SubQueue, size_t Offset,
+                  size_t Size, pi_uint32 NumEvents,
+                  const sycl::detail::pi::PiEvent *Events,
+                  sycl::detail::pi::PiEvent *Event) {
+                Plugin->call<PiApiKind::piEnqueueMemBufferCopy>(
+                    SubQueue, SrcMem, DstMem, SrcXOffBytes + Offset,
+                    DstXOffBytes + Offset, Size, NumEvents, Events, Event);
+              }))
+        return;
       Plugin->call<PiApiKind::piEnqueueMemBufferCopy>(
           Queue, SrcMem, DstMem, SrcXOffBytes, DstXOffBytes,
           SrcAccessRangeWidthBytes, DepEvents.size(), DepEvents.data(),
@@ -792,12 +1033,20 @@ void MemoryManager::copy(SYCLMemObjI *SYCLMemObj, void *SrcMem,
               SrcElemSize, (char *)DstMem, std::move(TgtQueue), DimDst, DstSize,
               DstAccessRange, DstOffset, DstElemSize, std::move(DepEvents),
               OutEvent, OutEventImpl);
-    else
+    else {
+      // A copy between devices of different contexts is only made if the
+      // target device can access the memory of the source one, so it is
+      // enqueued to the target queue.
+      QueueImplPtr CopyQueue =
+          SrcQueue->getContextImplPtr() == TgtQueue->getContextImplPtr()
+              ? std::move(SrcQueue)
+              : TgtQueue;
       copyD2D(SYCLMemObj, pi::cast<sycl::detail::pi::PiMem>(SrcMem),
-              std::move(SrcQueue), DimSrc, SrcSize, SrcAccessRange, SrcOffset,
+              std::move(CopyQueue), DimSrc, SrcSize, SrcAccessRange, SrcOffset,
               SrcElemSize, pi::cast<sycl::detail::pi::PiMem>(DstMem),
               std::move(TgtQueue), DimDst, DstSize, DstAccessRange, DstOffset,
               DstElemSize, std::move(DepEvents), OutEvent, OutEventImpl);
+    }
   }
 }
 
@@ -965,6 +1214,18 @@ void MemoryManager::copy_usm(const void *SrcMem, QueueImplPtr SrcQueue,
   const PluginPtr &Plugin = SrcQueue->getPlugin();
   if (OutEventImpl != nullptr)
     OutEventImpl->setHostEnqueueTime();
+  if (enqueueSplitCopy(SrcQueue, Len, DepEvents, OutEvent,
+                       [&](sycl::detail::pi::PiQueue SubQueue, size_t Offset,
+                           size_t Size, pi_uint32 NumEvents,
+                           const sycl::detail::pi::PiEvent *Events,
+                           sycl::detail::pi::PiEvent *Event) {
+                         Plugin->call<PiApiKind::piextUSMEnqueueMemcpy>(
+                             SubQueue, /* blocking */ PI_FALSE,
+                             static_cast<char *>(DstMem) + Offset,
+                             static_cast<const char *>(SrcMem) + Offset, Size,
+                             NumEvents, Events, Event);
+                       }))
+    return;
   Plugin->call<PiApiKind::piextUSMEnqueueMemcpy>(
       SrcQueue->getHandleRef(),
       /* blocking */ PI_FALSE, DstMem, SrcMem, Len, DepEvents.size(),
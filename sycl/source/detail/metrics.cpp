@@ -0,0 +1,269 @@
+//==---------- metrics.cpp - Runtime host overhead metrics -----------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/global_handler.hpp>
+#include <detail/metrics.hpp>
+#include <detail/xpti_registry.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+uint8_t GMetricsStreamID;
+xpti::trace_event_data_t *GMetricsEvent;
+#endif
+
+namespace {
+// Bucket 0 holds zero durations, bucket I the ones in [2^(I-1), 2^I) ns.
+constexpr size_t NumBuckets = 65;
+
+struct Histogram {
+  std::atomic<uint64_t> MBuckets[NumBuckets];
+  std::atomic<uint64_t> MCount;
+  std::atomic<uint64_t> MTotalNs;
+  std::atomic<uint64_t> MMaxNs;
+};
+
+// Histograms of a thread. The blocks are linked into a list that is only ever
+// prepended to, and the block of an exited thread is reused by the next new
+// one, so they are never freed. They are reachable until the program exits.
+struct ThreadMetrics {
+  Histogram MHistograms[NumMetricKinds];
+  std::atomic<bool> MOwned;
+  ThreadMetrics *MNext;
+};
+
+std::atomic<ThreadMetrics *> ThreadMetricsHead{nullptr};
+
+struct ThreadMetricsOwner {
+  ThreadMetrics *MMetrics = nullptr;
+
+  ~ThreadMetricsOwner() {
+    if (MMetrics)
+      MMetrics->MOwned.store(false, std::memory_order_release);
+  }
+};
+thread_local ThreadMetricsOwner Owner;
+
+ThreadMetrics &getThreadMetrics() {
+  if (Owner.MMetrics)
+    return *Owner.MMetrics;
+
+  for (ThreadMetrics *M = ThreadMetricsHead.load(std::memory_order_acquire); M;
+       M = M->MNext) {
+    bool Owned = false;
+    if (M->MOwned.compare_exchange_strong(Owned, true,
+                                          std::memory_order_acquire)) {
+      Owner.MMetrics = M;
+      return *M;
+    }
+  }
+
+  // Value-initialization zeroes the histograms.
+  ThreadMetrics *M = new ThreadMetrics();
+  M->MOwned.store(true, std::memory_order_relaxed);
+  M->MNext = ThreadMetricsHead.load(std::memory_order_relaxed);
+  while (!ThreadMetricsHead.compare_exchange_weak(M->MNext, M,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed))
+    ;
+  Owner.MMetrics = M;
+  return *M;
+}
+
+size_t getBucket(uint64_t DurationNs) {
+  size_t Bucket = 0;
+  while (DurationNs) {
+    DurationNs >>= 1;
+    ++Bucket;
+  }
+  return Bucket;
+}
+
+uint64_t getBucketUpperBound(size_t Bucket) {
+  if (Bucket == 0)
+    return 0;
+  return Bucket >= 64 ? UINT64_MAX : (uint64_t{1} << Bucket) - 1;
+}
+
+// Only the owning thread writes to its histograms, so the updates don't need
+// to be atomic read-modify-write operations.
+void add(std::atomic<uint64_t> &Value, uint64_t Delta) {
+  Value.store(Value.load(std::memory_order_relaxed) + Delta,
+              std::memory_order_relaxed);
+}
+} // namespace
+
+const char *getMetricName(MetricKind Kind) {
+  switch (Kind) {
+  case MetricKind::SubmitLatency:
+    return "submit_latency";
+  case MetricKind::GraphBuild:
+    return "graph_build";
+  case MetricKind::KernelCacheLookup:
+    return "kernel_cache_lookup";
+  case MetricKind::PluginEnqueue:
+    return "plugin_enqueue";
+  case MetricKind::ProgramBuild:
+    return "program_build";
+  case MetricKind::HostTask:
+    return "host_task";
+  }
+  return "unknown";
+}
+
+namespace {
+MetricsSnapshot getMetricsSnapshot() {
+  MetricsSnapshot Snapshot;
+  for (size_t I = 0; I < NumMetricKinds; ++I)
+    Snapshot.MSummaries[I] = getMetricSummary(static_cast<MetricKind>(I));
+  Snapshot.MHostTaskPoolSize = SYCLConfig<SYCL_QUEUE_THREAD_POOL_SIZE>::get();
+  return Snapshot;
+}
+
+void publishMetrics([[maybe_unused]] const MetricsSnapshot &Snapshot) {
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+  constexpr uint16_t NotificationTraceType =
+      static_cast<uint16_t>(xpti::trace_point_type_t::signal);
+  if (!xptiCheckTraceEnabled(GMetricsStreamID, NotificationTraceType))
+    return;
+  xptiNotifySubscribers(GMetricsStreamID, NotificationTraceType, nullptr,
+                        GMetricsEvent, 0, &Snapshot);
+#endif
+}
+
+std::atomic<int64_t> NextPublishNs{0};
+
+/// Publishes a snapshot if none was in the last second.
+void publishMetricsIfDue() {
+  int64_t Now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count();
+  int64_t Next = NextPublishNs.load(std::memory_order_relaxed);
+  if (Now < Next ||
+      !NextPublishNs.compare_exchange_strong(Next, Now + 1000000000,
+                                             std::memory_order_relaxed))
+    return;
+  publishMetrics(getMetricsSnapshot());
+}
+} // namespace
+
+bool hasMetricsSubscribers() {
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+  static const bool Subscribed = [] {
+    GlobalHandler::instance().getXPTIRegistry().initializeFrameworkOnce();
+    return xptiCheckTraceEnabled(GMetricsStreamID);
+  }();
+  return Subscribed;
+#else
+  return false;
+#endif
+}
+
+void recordMetric(MetricKind Kind, uint64_t DurationNs) {
+  Histogram &H = getThreadMetrics().MHistograms[static_cast<size_t>(Kind)];
+  add(H.MBuckets[getBucket(DurationNs)], 1);
+  add(H.MCount, 1);
+  add(H.MTotalNs, DurationNs);
+  if (H.MMaxNs.load(std::memory_order_relaxed) < DurationNs)
+    H.MMaxNs.store(DurationNs, std::memory_order_relaxed);
+
+  // The clock is read on every 16th record of an operation by a thread only.
+  if (H.MCount.load(std::memory_order_relaxed) % 16 == 0 &&
+      hasMetricsSubscribers())
+    publishMetricsIfDue();
+}
+
+MetricSummary getMetricSummary(MetricKind Kind) {
+  MetricSummary Summary;
+  uint64_t Buckets[NumBuckets] = {};
+  for (ThreadMetrics *M = ThreadMetricsHead.load(std::memory_order_acquire); M;
+       M = M->MNext) {
+    const Histogram &H = M->MHistograms[static_cast<size_t>(Kind)];
+    for (size_t I = 0; I < NumBuckets; ++I)
+      Buckets[I] += H.MBuckets[I].load(std::memory_order_relaxed);
+    Summary.MCount += H.MCount.load(std::memory_order_relaxed);
+    Summary.MTotalNs += H.MTotalNs.load(std::memory_order_relaxed);
+    Summary.MMaxNs =
+        std::max(Summary.MMaxNs, H.MMaxNs.load(std::memory_order_relaxed));
+  }
+
+  auto GetPercentile = [&](uint64_t Percent) {
+    const uint64_t Rank = (Summary.MCount * Percent + 99) / 100;
+    uint64_t Seen = 0;
+    for (size_t I = 0; I < NumBuckets; ++I) {
+      Seen += Buckets[I];
+      if (Seen >= Rank && Seen != 0)
+        return std::min(getBucketUpperBound(I), Summary.MMaxNs);
+    }
+    return Summary.MMaxNs;
+  };
+  Summary.MP50Ns = GetPercentile(50);
+  Summary.MP99Ns = GetPercentile(99);
+  return Summary;
+}
+
+void resetMetrics() {
+  for (ThreadMetrics *M = ThreadMetricsHead.load(std::memory_order_acquire); M;
+       M = M->MNext)
+    for (Histogram &H : M->MHistograms) {
+      for (std::atomic<uint64_t> &Bucket : H.MBuckets)
+        Bucket.store(0, std::memory_order_relaxed);
+      H.MCount.store(0, std::memory_order_relaxed);
+      H.MTotalNs.store(0, std::memory_order_relaxed);
+      H.MMaxNs.store(0, std::memory_order_relaxed);
+    }
+}
+
+void dumpMetrics() {
+  const MetricsSnapshot Snapshot = getMetricsSnapshot();
+  const MetricSummary *Summaries = Snapshot.MSummaries;
+
+  if (SYCLConfig<SYCL_METRICS_DUMP>::get()) {
+    std::cerr << "SYCL metrics:\n";
+    for (size_t I = 0; I < NumMetricKinds; ++I) {
+      const MetricSummary &S = Summaries[I];
+      std::cerr << "  " << getMetricName(static_cast<MetricKind>(I))
+                << ": count=" << S.MCount
+                << " mean_ns=" << (S.MCount ? S.MTotalNs / S.MCount : 0)
+                << " p50_ns<=" << S.MP50Ns << " p99_ns<=" << S.MP99Ns
+                << " max_ns=" << S.MMaxNs << "\n";
+    }
+  }
+
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+  GlobalHandler::instance().getXPTIRegistry().initializeFrameworkOnce();
+  publishMetrics(Snapshot);
+  constexpr uint16_t NotificationTraceType =
+      static_cast<uint16_t>(xpti::trace_point_type_t::metadata);
+  if (!xptiCheckTraceEnabled(GMetricsStreamID, NotificationTraceType))
+    return;
+  for (size_t I = 0; I < NumMetricKinds; ++I) {
+    const MetricSummary &S = Summaries[I];
+    const std::string Name = getMetricName(static_cast<MetricKind>(I));
+    xpti::addMetadata(GMetricsEvent, Name + "_count", S.MCount);
+    xpti::addMetadata(GMetricsEvent, Name + "_total_ns", S.MTotalNs);
+    xpti::addMetadata(GMetricsEvent, Name + "_p50_ns", S.MP50Ns);
+    xpti::addMetadata(GMetricsEvent, Name + "_p99_ns", S.MP99Ns);
+    xpti::addMetadata(GMetricsEvent, Name + "_max_ns", S.MMaxNs);
+  }
+  xptiNotifySubscribers(GMetricsStreamID, NotificationTraceType, nullptr,
+                        GMetricsEvent, 0, nullptr);
+#endif
+}
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
@@ -0,0 +1,114 @@
+//==---------- metrics.hpp - Runtime host overhead metrics -----------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <detail/config.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+
+/// Host-side operations whose durations are collected if SYCL_METRICS_DUMP is
+/// enabled or if a tool subscribes to the XPTI metrics stream.
+enum class MetricKind : uint8_t {
+  /// Submission of a command group to a queue.
+  SubmitLatency,
+  /// Insertion of a command group into the execution graph.
+  GraphBuild,
+  /// Lookup of a kernel in the kernel cache, including its build on a miss.
+  KernelCacheLookup,
+  /// Kernel enqueue call into the plugin.
+  PluginEnqueue,
+  /// Build of a program missing from the in-memory cache, including its
+  /// compilation from the persistent cache or from SPIR-V.
+  ProgramBuild,
+  /// Execution of a host task by the thread pool.
+  HostTask
+};
+inline constexpr size_t NumMetricKinds = 6;
+
+/// \return the name used to report the metric.
+const char *getMetricName(MetricKind Kind);
+
+/// \return true if a tool listens to the XPTI metrics stream. The streams are
+/// initialized on the first call.
+bool hasMetricsSubscribers();
+
+inline bool isMetricsEnabled() {
+  return SYCLConfig<SYCL_METRICS_DUMP>::get() || hasMetricsSubscribers();
+}
+
+/// Records a duration of the operation into the histogram of the calling
+/// thread. Histograms have a bucket per power of two nanoseconds and are only
+/// written by their thread, so recording doesn't take any lock.
+void recordMetric(MetricKind Kind, uint64_t DurationNs);
+
+struct MetricSummary {
+  uint64_t MCount = 0;
+  uint64_t MTotalNs = 0;
+  uint64_t MMaxNs = 0;
+  /// Upper bounds of the buckets containing the percentiles.
+  uint64_t MP50Ns = 0;
+  uint64_t MP99Ns = 0;
+};
+
+/// \return the summary of the durations recorded by all the threads.
+MetricSummary getMetricSummary(MetricKind Kind);
+
+/// Clears the durations recorded by all the threads.
+void resetMetrics();
+
+/// The user data of the signal notifications of the XPTI metrics stream,
+/// which are sent about once a second while the metrics are being recorded,
+/// and at shutdown. The durations are totals since the start of the program.
+struct MetricsSnapshot {
+  MetricSummary MSummaries[NumMetricKinds];
+  uint32_t MHostTaskPoolSize = 0;
+};
+
+/// Prints the summaries to stderr if SYCL_METRICS_DUMP is enabled, and sends
+/// them to the subscribers of the XPTI metrics stream, as metadata of the
+/// "SYCL Metrics" event and as a last snapshot. Called at shutdown if the
+/// metrics are enabled.
+void dumpMetrics();
+
+/// Records the lifetime of the object as a duration of the operation.
+class ScopedMetricTimer {
+public:
+  explicit ScopedMetricTimer(MetricKind Kind)
+      : MKind(Kind), MEnabled(isMetricsEnabled()) {
+    if (MEnabled)
+      MStart = std::chrono::steady_clock::now();
+  }
+
+  ~ScopedMetricTimer() {
+    if (!MEnabled)
+      return;
+    auto Duration = std::chrono::steady_clock::now() - MStart;
+    recordMetric(MKind,
+                 std::chrono::duration_cast<std::chrono::nanoseconds>(Duration)
+                     .count());
+  }
+
+  ScopedMetricTimer(const ScopedMetricTimer &) = delete;
+  ScopedMetricTimer &operator=(const ScopedMetricTimer &) = delete;
+
+private:
+  MetricKind MKind;
+  bool MEnabled;
+  std::chrono::steady_clock::time_point MStart;
+};
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
@@ -0,0 +1,120 @@
+//==---------- object_pool.cpp - Pooled allocation of runtime objects -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/object_pool.hpp>
+
+#include <atomic>
+#include <new>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+
+namespace {
+constexpr size_t SizeClassStep = alignof(std::max_align_t);
+constexpr size_t MaxPooledSize = 1024;
+constexpr size_t NumSizeClasses = MaxPooledSize / SizeClassStep;
+// Limits the memory retained by a thread that frees more objects than it
+// allocates, e.g. the one cleaning up the graph.
+constexpr size_t MaxBlocksPerClass = 256;
+
+std::atomic<uint64_t> PoolHits{0};
+std::atomic<uint64_t> PoolMisses{0};
+
+struct FreeBlock {
+  FreeBlock *MNext;
+};
+
+struct ThreadCache {
+  FreeBlock *MHeads[NumSizeClasses] = {};
+  size_t MSizes[NumSizeClasses] = {};
+
+  ~ThreadCache();
+};
+
+// Objects can be released after the thread-local cache of the thread has been
+// destroyed, e.g. during the shutdown of the runtime. Such allocations go
+// straight to the heap.
+thread_local bool CacheAlive = false;
+thread_local ThreadCache Cache;
+
+ThreadCache::~ThreadCache() {
+  CacheAlive = false;
+  for (FreeBlock *&Head : MHeads)
+    while (Head) {
+      FreeBlock *Next = Head->MNext;
+      ::operator delete(Head);
+      Head = Next;
+    }
+}
+
+ThreadCache *getCache() {
+  static thread_local bool Initialized = false;
+  if (!Initialized) {
+    Initialized = true;
+    // Touch the cache to register its destructor.
+    (void)Cache.MHeads[0];
+    CacheAlive = true;
+  }
+  return CacheAlive ? &Cache : nullptr;
+}
+
+size_t getSizeClass(size_t Size) {
+  return (Size + SizeClassStep - 1) / SizeClassStep - 1;
+}
+} // namespace
+
+void *allocatePooled(size_t Size) {
+  if (Size == 0 || Size > MaxPooledSize)
+    return ::operator new(Size);
+
+  const size_t Class = getSizeClass(Size);
+  if (ThreadCache *C = getCache()) {
+    if (FreeBlock *Block = C->MHeads[Class]) {
+      C->MHeads[Class] = Block->MNext;
+      --C->MSizes[Class];
+      PoolHits.fetch_add(1, std::memory_order_relaxed);
+      return Block;
+    }
+  }
+  PoolMisses.fetch_add(1, std::memory_order_relaxed);
+  // Allocate the whole size class so that the block can be reused for any
+  // object of the class.
+  return ::operator new((Class + 1) * SizeClassStep);
+}
+
+void deallocatePooled(void *Ptr, size_t Size) noexcept {
+  if (!Ptr)
+    return;
+  if (Size == 0 || Size > MaxPooledSize) {
+    ::operator delete(Ptr);
+    return;
+  }
+
+  const size_t Class = getSizeClass(Size);
+  ThreadCache *C = getCache();
+  if (!C || C->MSizes[Class] >= MaxBlocksPerClass) {
+    ::operator delete(Ptr);
+    return;
+  }
+  FreeBlock *Block = static_cast<FreeBlock *>(Ptr);
+  Block->MNext = C->MHeads[Class];
+  C->MHeads[Class] = Block;
+  ++C->MSizes[Class];
+}
+
+ObjectPoolStats getObjectPoolStats() {
+  ObjectPoolStats Stats;
+  Stats.MHits = PoolHits.load(std::memory_order_relaxed);
+  Stats.MMisses = PoolMisses.load(std::memory_order_relaxed);
+  return Stats;
+}
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
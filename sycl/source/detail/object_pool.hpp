@@ -0,0 +1,76 @@
+//==---------- object_pool.hpp - Pooled allocation of runtime objects -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sycl/detail/defines.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+
+/// Allocates a block of at least Size bytes aligned as std::max_align_t.
+///
+/// Blocks of up to MaxPooledSize bytes are taken from a per-thread free list
+/// of the corresponding size class, falling back to the global heap when the
+/// list is empty. Used for the objects created for every submission, e.g.
+/// events and commands.
+void *allocatePooled(size_t Size);
+
+/// Returns a block obtained from allocatePooled(Size) to the free list of the
+/// calling thread.
+void deallocatePooled(void *Ptr, size_t Size) noexcept;
+
+struct ObjectPoolStats {
+  uint64_t MHits = 0;
+  uint64_t MMisses = 0;
+};
+
+/// \return the number of pooled allocations served from and missing the free
+/// lists since the start of the program, summed over all the threads.
+ObjectPoolStats getObjectPoolStats();
+
+/// Standard allocator backed by allocatePooled, to be used with
+/// std::allocate_shared, which places the control block and the object into a
+/// single pooled block.
+template <typename T> class PoolAllocator {
+public:
+  using value_type = T;
+
+  PoolAllocator() noexcept = default;
+  template <typename U> PoolAllocator(const PoolAllocator<U> &) noexcept {}
+
+  T *allocate(size_t N) {
+    return static_cast<T *>(allocatePooled(N * sizeof(T)));
+  }
+  void deallocate(T *Ptr, size_t N) noexcept {
+    deallocatePooled(Ptr, N * sizeof(T));
+  }
+
+  template <typename U> bool operator==(const PoolAllocator<U> &) const {
+    return true;
+  }
+  template <typename U> bool operator!=(const PoolAllocator<U> &) const {
+    return false;
+  }
+};
+
+/// Creates a shared object in a pooled block.
+template <typename T, typename... ArgsT>
+std::shared_ptr<T> makeSharedPooled(ArgsT &&...Args) {
+  return std::allocate_shared<T>(PoolAllocator<T>{},
+                                 std::forward<ArgsT>(Args)...);
+}
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
@@ -7,22 +7,41 @@
 //===----------------------------------------------------------------------===//
 
 #include <detail/device_impl.hpp>
+#include <detail/global_handler.hpp>
 #include <detail/persistent_device_code_cache.hpp>
 #include <detail/plugin.hpp>
 #include <detail/program_manager/program_manager.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cctype>
 #include <cerrno>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <mutex>
 #include <optional>
+#include <sstream>
+#include <unordered_map>
 
 #if defined(__SYCL_RT_OS_POSIX_SUPPORT)
+#include <netdb.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/time.h>
 #include <unistd.h>
 #else
 #include <direct.h>
 #include <io.h>
 #endif
 
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
 namespace sycl {
 inline namespace _V1 {
 namespace detail {
@@ -96,35 +115,51 @@ void PersistentDeviceCodeCache::putItemToDisc(
   if (!isImageCached(Img))
     return;
 
+  std::vector<std::vector<char>> Result;
+  try {
+    Result = getProgramBinaryData(Device, NativePrg);
+  } catch (std::exception &e) {
+    PersistentDeviceCodeCache::trace(
+        std::string("exception encountered making persistent cache: ") +
+        e.what());
+    return;
+  }
+  putBinaryDataToDisc(Device, Img, SpecConsts, BuildOptionsString, Result);
+  if (getRemoteBackend())
+    putRemoteItem(
+        getIndexedSourceItem(Device, Img, SpecConsts, BuildOptionsString),
+        Result);
+}
+
+void PersistentDeviceCodeCache::putBinaryDataToDisc(
+    const device &Device, const RTDeviceBinaryImage &Img,
+    const SerializedObj &SpecConsts, const std::string &BuildOptionsString,
+    const std::vector<std::vector<char>> &Data) {
+  if (SYCLConfig<SYCL_CACHE_LAYOUT>::get() == PersistentCacheLayout::Indexed) {
+    std::string RootDir = getRootDir();
+    if (RootDir.empty()) {
+      trace("Disable persistent cache due to unconfigured cache root.");
+      return;
+    }
+    try {
+      putIndexedItem(
+          RootDir,
+          getIndexedSourceItem(Device, Img, SpecConsts, BuildOptionsString),
+          Data);
+    } catch (std::exception &e) {
+      PersistentDeviceCodeCache::trace(
+          std::string("exception encountered making persistent cache: ") +
+          e.what());
+    }
+    return;
+  }
+
   std::string DirName =
       getCacheItemPath(Device, Img, SpecConsts, BuildOptionsString);
 
   if (DirName.empty())
     return;
 
-  auto Plugin = detail::getSyclObjImpl(Device)->getPlugin();
-
-  unsigned int DeviceNum = 0;
-
-  Plugin->call<PiApiKind::piProgramGetInfo>(
-      NativePrg, PI_PROGRAM_INFO_NUM_DEVICES, sizeof(DeviceNum), &DeviceNum,
-      nullptr);
-
-  std::vector<size_t> BinarySizes(DeviceNum);
-  Plugin->call<PiApiKind::piProgramGetInfo>(
-      NativePrg, PI_PROGRAM_INFO_BINARY_SIZES,
-      sizeof(size_t) * BinarySizes.size(), BinarySizes.data(), nullptr);
-
-  std::vector<std::vector<char>> Result;
-  std::vector<char *> Pointers;
-  for (size_t I = 0; I < BinarySizes.size(); ++I) {
-    Result.emplace_back(BinarySizes[I]);
-    Pointers.push_back(Result[I].data());
-  }
-
-  Plugin->call<PiApiKind::piProgramGetInfo>(NativePrg, PI_PROGRAM_INFO_BINARIES,
-                                            sizeof(char *) * Pointers.size(),
-                                            Pointers.data(), nullptr);
   size_t i = 0;
   std::string FileName;
   do {
@@ -137,7 +172,7 @@ void PersistentDeviceCodeCache::putItemToDisc(
     LockCacheItem Lock{FileName};
     if (Lock.isOwned()) {
       std::string FullFileName = FileName + ".bin";
-      writeBinaryDataToFile(FullFileName, Result);
+      writeBinaryDataToFile(FullFileName, Data);
       trace("device binary has been cached: " + FullFileName);
       writeSourceItem(FileName + ".src", Device, Img, SpecConsts,
                       BuildOptionsString);
@@ -155,6 +190,27 @@ void PersistentDeviceCodeCache::putItemToDisc(
   }
 }
 
+void PersistentDeviceCodeCache::putItemToDiscAsync(
+    const device &Device, const RTDeviceBinaryImage &Img,
+    const SerializedObj &SpecConsts, const std::string &BuildOptionsString,
+    const sycl::detail::pi::PiProgram &NativePrg) {
+  if (!isImageCached(Img))
+    return;
+
+#ifdef _WIN32
+  // The writer thread cannot be reliably joined on Windows shutdown.
+  putItemToDisc(Device, Img, SpecConsts, BuildOptionsString, NativePrg);
+#else
+  const PluginPtr &Plugin = detail::getSyclObjImpl(Device)->getPlugin();
+  Plugin->call<PiApiKind::piProgramRetain>(NativePrg);
+  GlobalHandler::instance().getPersistentCacheWriter().push(
+      [Device, &Img, SpecConsts, BuildOptionsString, NativePrg, Plugin]() {
+        putItemToDisc(Device, Img, SpecConsts, BuildOptionsString, NativePrg);
+        Plugin->call_nocheck<PiApiKind::piProgramRelease>(NativePrg);
+      });
+#endif
+}
+
 /* Program binaries built for one or more devices are read from persistent
  * cache and returned in form of vector of programs. Each binary program is
  * stored in vector of chars.
@@ -166,6 +222,29 @@ std::vector<std::vector<char>> PersistentDeviceCodeCache::getItemFromDisc(
   if (!isImageCached(Img))
     return {};
 
+  std::vector<std::vector<char>> Res =
+      getBinaryDataFromDisc(Device, Img, SpecConsts, BuildOptionsString);
+  if (!Res.empty() || !getRemoteBackend())
+    return Res;
+
+  Res = getRemoteItem(
+      getIndexedSourceItem(Device, Img, SpecConsts, BuildOptionsString));
+  if (!Res.empty())
+    putBinaryDataToDisc(Device, Img, SpecConsts, BuildOptionsString, Res);
+  return Res;
+}
+
+std::vector<std::vector<char>> PersistentDeviceCodeCache::getBinaryDataFromDisc(
+    const device &Device, const RTDeviceBinaryImage &Img,
+    const SerializedObj &SpecConsts, const std::string &BuildOptionsString) {
+  if (SYCLConfig<SYCL_CACHE_LAYOUT>::get() == PersistentCacheLayout::Indexed) {
+    std::string RootDir = getRootDir();
+    if (RootDir.empty())
+      return {};
+    return getIndexedItem(RootDir, getIndexedSourceItem(Device, Img, SpecConsts,
+                                                        BuildOptionsString));
+  }
+
   std::string Path =
       getCacheItemPath(Device, Img, SpecConsts, BuildOptionsString);
 
@@ -212,15 +291,7 @@ std::string PersistentDeviceCodeCache::getDeviceIDString(const device &Device) {
 void PersistentDeviceCodeCache::writeBinaryDataToFile(
     const std::string &FileName, const std::vector<std::vector<char>> &Data) {
   std::ofstream FileStream{FileName, std::ios::binary};
-
-  size_t Size = Data.size();
-  FileStream.write((char *)&Size, sizeof(Size));
-
-  for (size_t i = 0; i < Data.size(); ++i) {
-    Size = Data[i].size();
-    FileStream.write((char *)&Size, sizeof(Size));
-    FileStream.write(Data[i].data(), Size);
-  }
+  writeBinaryData(FileStream, Data);
   FileStream.close();
   if (FileStream.fail())
     trace("Failed to write binary file " + FileName);
@@ -232,28 +303,80 @@ void PersistentDeviceCodeCache::writeBinaryDataToFile(
 std::vector<std::vector<char>>
 PersistentDeviceCodeCache::readBinaryDataFromFile(const std::string &FileName) {
   std::ifstream FileStream{FileName, std::ios::binary};
+  std::vector<std::vector<char>> Res = readBinaryData(FileStream);
+  FileStream.close();
+
+  if (FileStream.fail()) {
+    trace("Failed to read binary file from " + FileName);
+    return {};
+  }
+
+  return Res;
+}
+
+void PersistentDeviceCodeCache::writeBinaryData(
+    std::ostream &Stream, const std::vector<std::vector<char>> &Data) {
+  size_t Size = Data.size();
+  Stream.write((char *)&Size, sizeof(Size));
+
+  for (size_t i = 0; i < Data.size(); ++i) {
+    Size = Data[i].size();
+    Stream.write((char *)&Size, sizeof(Size));
+    Stream.write(Data[i].data(), Size);
+  }
+}
+
+std::vector<std::vector<char>>
+PersistentDeviceCodeCache::readBinaryData(std::istream &Stream) {
   size_t ImgNum = 0, ImgSize = 0;
-  FileStream.read((char *)&ImgNum, sizeof(ImgNum));
+  Stream.read((char *)&ImgNum, sizeof(ImgNum));
 
-  std::vector<std::vector<char>> Res(ImgNum);
-  for (size_t i = 0; i < ImgNum; ++i) {
-    FileStream.read((char *)&ImgSize, sizeof(ImgSize));
+  std::vector<std::vector<char>> Res;
+  for (size_t i = 0; i < ImgNum && Stream; ++i) {
+    Stream.read((char *)&ImgSize, sizeof(ImgSize));
+    if (!Stream)
+      break;
 
     std::vector<char> ImgData(ImgSize);
-    FileStream.read(ImgData.data(), ImgSize);
+    Stream.read(ImgData.data(), ImgSize);
 
-    Res[i] = std::move(ImgData);
+    Res.push_back(std::move(ImgData));
   }
-  FileStream.close();
 
-  if (FileStream.fail()) {
-    trace("Failed to read binary file from " + FileName);
+  if (Stream.fail())
     return {};
-  }
 
   return Res;
 }
 
+std::vector<std::vector<char>> PersistentDeviceCodeCache::getProgramBinaryData(
+    const device &Device, const sycl::detail::pi::PiProgram &NativePrg) {
+  auto Plugin = detail::getSyclObjImpl(Device)->getPlugin();
+
+  unsigned int DeviceNum = 0;
+
+  Plugin->call<PiApiKind::piProgramGetInfo>(
+      NativePrg, PI_PROGRAM_INFO_NUM_DEVICES, sizeof(DeviceNum), &DeviceNum,
+      nullptr);
+
+  std::vector<size_t> BinarySizes(DeviceNum);
+  Plugin->call<PiApiKind::piProgramGetInfo>(
+      NativePrg, PI_PROGRAM_INFO_BINARY_SIZES,
+      sizeof(size_t) * BinarySizes.size(), BinarySizes.data(), nullptr);
+
+  std::vector<std::vector<char>> Result;
+  std::vector<char *> Pointers;
+  for (size_t I = 0; I < BinarySizes.size(); ++I) {
+    Result.emplace_back(BinarySizes[I]);
+    Pointers.push_back(Result[I].data());
+  }
+
+  Plugin->call<PiApiKind::piProgramGetInfo>(NativePrg, PI_PROGRAM_INFO_BINARIES,
+                                            sizeof(char *) * Pointers.size(),
+                                            Pointers.data(), nullptr);
+  return Result;
+}
+
 /* Writing cache item key sources to be used for reliable identification
  * Format: Four pairs of [size, value] for device, build options, specialization
  * constant values, device code SPIR-V image.
@@ -263,28 +386,98 @@ void PersistentDeviceCodeCache::writeSourceItem(
     const RTDeviceBinaryImage &Img, const SerializedObj &SpecConsts,
     const std::string &BuildOptionsString) {
   std::ofstream FileStream{FileName, std::ios::binary};
+  std::string SourceItem =
+      getSourceItem(Device, Img, SpecConsts, BuildOptionsString);
+  FileStream.write(SourceItem.data(), SourceItem.size());
+  FileStream.close();
+
+  if (FileStream.fail()) {
+    trace("Failed to write source file to " + FileName);
+  }
+}
+
+std::string PersistentDeviceCodeCache::getSourceItem(
+    const device &Device, const RTDeviceBinaryImage &Img,
+    const SerializedObj &SpecConsts, const std::string &BuildOptionsString) {
+  std::string Res;
+  auto Append = [&Res](const char *Data, size_t Size) {
+    Res.append((const char *)&Size, sizeof(Size));
+    if (Size)
+      Res.append(Data, Size);
+  };
 
   std::string DeviceString{getDeviceIDString(Device)};
-  size_t Size = DeviceString.size();
-  FileStream.write((char *)&Size, sizeof(Size));
-  FileStream.write(DeviceString.data(), Size);
+  Append(DeviceString.data(), DeviceString.size());
+  Append(BuildOptionsString.data(), BuildOptionsString.size());
+  Append((const char *)SpecConsts.data(), SpecConsts.size());
+  Append((const char *)Img.getRawData().BinaryStart, Img.getSize());
+  return Res;
+}
 
-  Size = BuildOptionsString.size();
-  FileStream.write((char *)&Size, sizeof(Size));
-  FileStream.write(BuildOptionsString.data(), Size);
+namespace {
+using IndexHashT = std::array<uint64_t, 2>;
 
-  Size = SpecConsts.size();
-  FileStream.write((char *)&Size, sizeof(Size));
-  FileStream.write((const char *)SpecConsts.data(), Size);
+/* 128-bit hash of the cache item key sources. The full key sources are
+ * compared on lookup, so the hash is only used to locate the item.
+ */
+IndexHashT getIndexHash(const char *Data, size_t Size) {
+  // FNV-1a and a multiply-rotate hash with unrelated constants.
+  uint64_t H1 = 0xcbf29ce484222325ULL;
+  uint64_t H2 = 0x9e3779b97f4a7c15ULL ^ Size;
+  for (size_t I = 0; I < Size; ++I) {
+    unsigned char C = Data[I];
+    H1 = (H1 ^ C) * 0x100000001b3ULL;
+    H2 = (H2 ^ C) * 0xff51afd7ed558ccdULL;
+    H2 = (H2 << 31) | (H2 >> 33);
+  }
+  // Zero hash is never produced so that it is not confused with an empty
+  // slot written by a crashed writer.
+  return {H1 | 1, H2};
+}
 
-  Size = Img.getSize();
-  FileStream.write((char *)&Size, sizeof(Size));
-  FileStream.write((const char *)Img.getRawData().BinaryStart, Size);
-  FileStream.close();
+IndexHashT getIndexHash(const std::string &SourceItem) {
+  return getIndexHash(SourceItem.data(), SourceItem.size());
+}
 
-  if (FileStream.fail()) {
-    trace("Failed to write source file to " + FileName);
+/* Hash of the binary of an image, which is computed only once per image as
+ * the images are much larger than the other key sources. The hashes are kept
+ * for the lifetime of the process, the image IDs are never reused.
+ */
+IndexHashT getImageHash(const RTDeviceBinaryImage &Img) {
+  static std::mutex *Mutex = new std::mutex;
+  static auto *Hashes = new std::unordered_map<std::uintptr_t, IndexHashT>;
+  const std::uintptr_t ImageID = Img.getImageID();
+  {
+    std::lock_guard<std::mutex> Lock{*Mutex};
+    auto It = Hashes->find(ImageID);
+    if (It != Hashes->end())
+      return It->second;
   }
+  IndexHashT Hash =
+      getIndexHash((const char *)Img.getRawData().BinaryStart, Img.getSize());
+  std::lock_guard<std::mutex> Lock{*Mutex};
+  Hashes->emplace(ImageID, Hash);
+  return Hash;
+}
+} // namespace
+
+std::string PersistentDeviceCodeCache::getIndexedSourceItem(
+    const device &Device, const RTDeviceBinaryImage &Img,
+    const SerializedObj &SpecConsts, const std::string &BuildOptionsString) {
+  std::string Res;
+  auto Append = [&Res](const char *Data, size_t Size) {
+    Res.append((const char *)&Size, sizeof(Size));
+    if (Size)
+      Res.append(Data, Size);
+  };
+
+  std::string DeviceString{getDeviceIDString(Device)};
+  Append(DeviceString.data(), DeviceString.size());
+  Append(BuildOptionsString.data(), BuildOptionsString.size());
+  Append((const char *)SpecConsts.data(), SpecConsts.size());
+  IndexHashT ImageHash = getImageHash(Img);
+  Append((const char *)ImageHash.data(), sizeof(ImageHash));
+  return Res;
 }
 
 /* Check that cache item key sources are equal to the current program.
@@ -362,6 +555,604 @@ std::string PersistentDeviceCodeCache::getCacheItemPath(
          std::to_string(StringHasher(BuildOptionsString));
 }
 
+namespace {
+/* Layout of the index file used by the indexed cache layout.
+ */
+constexpr char IndexMagic[8] = {'S', 'Y', 'C', 'L', 'I', 'D', 'X', '2'};
+constexpr uint64_t IndexNumSlots = 4096;
+constexpr uint64_t IndexMaxProbes = 32;
+
+struct IndexHeader {
+  char Magic[8];
+  uint64_t Generation;
+  uint64_t NumSlots;
+};
+
+struct IndexSlot {
+  uint64_t Hash[2];
+  uint64_t Offset;
+  // Zero for empty slots.
+  uint64_t Size;
+};
+
+std::string getIndexPath(const std::string &RootDir) {
+  return RootDir + "/index.bin";
+}
+
+std::string getBlobPath(const std::string &RootDir, uint64_t Generation) {
+  return RootDir + "/data." + std::to_string(Generation) + ".bin";
+}
+
+/* Read-only view of a whole file, memory-mapped where supported.
+ */
+class MappedFile {
+public:
+  MappedFile(const std::string &Path) {
+#if defined(__SYCL_RT_OS_POSIX_SUPPORT)
+    int Fd = open(Path.c_str(), O_RDONLY);
+    if (Fd == -1)
+      return;
+    struct stat Stat;
+    if (fstat(Fd, &Stat) == 0 && Stat.st_size > 0) {
+      void *Addr = mmap(nullptr, Stat.st_size, PROT_READ, MAP_SHARED, Fd, 0);
+      if (Addr != MAP_FAILED) {
+        MData = static_cast<const char *>(Addr);
+        MSize = Stat.st_size;
+      }
+    }
+    close(Fd);
+#else
+    std::ifstream FileStream{Path, std::ios::binary};
+    MBuffer.assign(std::istreambuf_iterator<char>(FileStream),
+                   std::istreambuf_iterator<char>());
+    MData = MBuffer.data();
+    MSize = MBuffer.size();
+#endif
+  }
+
+  ~MappedFile() {
+#if defined(__SYCL_RT_OS_POSIX_SUPPORT)
+    if (MData)
+      munmap(const_cast<char *>(MData), MSize);
+#endif
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *data() const { return MData; }
+  size_t size() const { return MSize; }
+
+private:
+  const char *MData = nullptr;
+  size_t MSize = 0;
+#if !defined(__SYCL_RT_OS_POSIX_SUPPORT)
+  std::vector<char> MBuffer;
+#endif
+};
+
+/* Returns the slots of the index if it is valid.
+ */
+const char *getIndexSlots(const MappedFile &Index, IndexHeader &Header) {
+  if (!Index.data() || Index.size() < sizeof(IndexHeader))
+    return nullptr;
+  std::memcpy(&Header, Index.data(), sizeof(IndexHeader));
+  if (std::memcmp(Header.Magic, IndexMagic, sizeof(IndexMagic)) ||
+      Header.NumSlots == 0 ||
+      Index.size() < sizeof(IndexHeader) + Header.NumSlots * sizeof(IndexSlot))
+    return nullptr;
+  return Index.data() + sizeof(IndexHeader);
+}
+
+/* Atomically replaces the file at Path with the one at TmpPath.
+ */
+bool replaceFile(const std::string &TmpPath, const std::string &Path) {
+#ifdef _WIN32
+  // rename does not replace existing files on Windows.
+  return MoveFileExA(TmpPath.c_str(), Path.c_str(),
+                     MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  return std::rename(TmpPath.c_str(), Path.c_str()) == 0;
+#endif
+}
+
+/* Writes an index of the given generation holding the slots and atomically
+ * replaces the existing one with it.
+ */
+bool writeIndex(const std::string &RootDir, uint64_t Generation,
+                const std::vector<IndexSlot> &Slots) {
+  std::string IndexPath = getIndexPath(RootDir);
+  std::string TmpPath = IndexPath + ".tmp";
+  {
+    std::ofstream FileStream{TmpPath, std::ios::binary | std::ios::trunc};
+    IndexHeader Header{};
+    std::memcpy(Header.Magic, IndexMagic, sizeof(IndexMagic));
+    Header.Generation = Generation;
+    Header.NumSlots = Slots.size();
+    FileStream.write((const char *)&Header, sizeof(Header));
+    FileStream.write((const char *)Slots.data(),
+                     Slots.size() * sizeof(IndexSlot));
+    FileStream.close();
+    if (FileStream.fail())
+      return false;
+  }
+  return replaceFile(TmpPath, IndexPath);
+}
+
+/* Copies the most recently added items which fit in MaxSize to the blob
+ * store of the next generation, and replaces the index with one holding only
+ * them. Readers which have mapped the old index may still fail to open the
+ * old blob store, which is treated as a cache miss.
+ */
+bool compactIndex(const std::string &RootDir, const IndexHeader &Header,
+                  const std::vector<IndexSlot> &Slots, uint64_t MaxSize) {
+  // The items are appended to the blob store, so the newest ones come last.
+  std::vector<const IndexSlot *> Items;
+  for (const IndexSlot &Slot : Slots)
+    if (Slot.Hash[0] != 0)
+      Items.push_back(&Slot);
+  std::sort(Items.begin(), Items.end(),
+            [](const IndexSlot *LHS, const IndexSlot *RHS) {
+              return LHS->Offset > RHS->Offset;
+            });
+  uint64_t KeptSize = 0;
+  size_t NumKept = 0;
+  while (NumKept < Items.size() && KeptSize + Items[NumKept]->Size <= MaxSize)
+    KeptSize += Items[NumKept++]->Size;
+  Items.resize(NumKept);
+
+  std::string OldBlobPath = getBlobPath(RootDir, Header.Generation);
+  std::vector<IndexSlot> NewSlots(Header.NumSlots, IndexSlot{});
+  {
+    MappedFile OldBlob{OldBlobPath};
+    std::ofstream NewBlob{getBlobPath(RootDir, Header.Generation + 1),
+                          std::ios::binary | std::ios::trunc};
+    uint64_t Offset = 0;
+    // The kept items are copied in the order they were added.
+    for (auto It = Items.rbegin(); It != Items.rend(); ++It) {
+      const IndexSlot &Item = **It;
+      if (Item.Offset + Item.Size > OldBlob.size())
+        continue;
+      for (uint64_t Probe = 0; Probe < IndexMaxProbes; ++Probe) {
+        uint64_t Idx = (Item.Hash[0] + Probe) % Header.NumSlots;
+        if (NewSlots[Idx].Hash[0] != 0)
+          continue;
+        NewBlob.write(OldBlob.data() + Item.Offset, Item.Size);
+        NewSlots[Idx] = Item;
+        NewSlots[Idx].Offset = Offset;
+        Offset += Item.Size;
+        break;
+      }
+    }
+    NewBlob.close();
+    if (NewBlob.fail())
+      return false;
+  }
+  if (!writeIndex(RootDir, Header.Generation + 1, NewSlots))
+    return false;
+  std::remove(OldBlobPath.c_str());
+  return true;
+}
+} // namespace
+
+std::vector<std::vector<char>>
+PersistentDeviceCodeCache::getIndexedItem(const std::string &RootDir,
+                                          const std::string &SourceItem) {
+  MappedFile Index{getIndexPath(RootDir)};
+  IndexHeader Header;
+  const char *Slots = getIndexSlots(Index, Header);
+  if (!Slots)
+    return {};
+
+  IndexHashT Hash = getIndexHash(SourceItem);
+  IndexSlot Slot;
+  bool Found = false;
+  for (uint64_t Probe = 0; Probe < IndexMaxProbes; ++Probe) {
+    uint64_t Idx = (Hash[0] + Probe) % Header.NumSlots;
+    std::memcpy(&Slot, Slots + Idx * sizeof(IndexSlot), sizeof(IndexSlot));
+    if (Slot.Hash[0] == 0)
+      break;
+    if (Slot.Hash[0] == Hash[0] && Slot.Hash[1] == Hash[1]) {
+      Found = true;
+      break;
+    }
+  }
+  if (!Found)
+    return {};
+
+  std::string BlobPath = getBlobPath(RootDir, Header.Generation);
+  std::ifstream FileStream{BlobPath, std::ios::binary};
+  std::string Item(Slot.Size, '\0');
+  FileStream.seekg(Slot.Offset);
+  FileStream.read(&Item[0], Slot.Size);
+  if (FileStream.fail()) {
+    trace("Failed to read cache item from " + BlobPath);
+    return {};
+  }
+
+  // Resolve hash collisions by comparing the full key sources.
+  if (Item.size() < sizeof(size_t) + SourceItem.size())
+    return {};
+  size_t SourceSize = 0;
+  std::memcpy(&SourceSize, Item.data(), sizeof(SourceSize));
+  if (SourceSize != SourceItem.size() ||
+      Item.compare(sizeof(SourceSize), SourceSize, SourceItem))
+    return {};
+
+  std::istringstream ItemStream{Item.substr(sizeof(SourceSize) + SourceSize)};
+  std::vector<std::vector<char>> Res = readBinaryData(ItemStream);
+  if (!Res.empty())
+    trace("using cached device binary: " + BlobPath + "@" +
+          std::to_string(Slot.Offset));
+  return Res;
+}
+
+void PersistentDeviceCodeCache::putIndexedItem(
+    const std::string &RootDir, const std::string &SourceItem,
+    const std::vector<std::vector<char>> &Data) {
+  OSUtil::makeDir(RootDir.c_str());
+  LockCacheItem Lock{RootDir + "/index"};
+  if (!Lock.isOwned()) {
+    PersistentDeviceCodeCache::trace("cache lock not owned " + RootDir);
+    return;
+  }
+
+  std::string IndexPath = getIndexPath(RootDir);
+  IndexHeader Header;
+  std::vector<IndexSlot> Slots;
+  auto ReadIndex = [&]() {
+    MappedFile Index{IndexPath};
+    const char *SlotsData = getIndexSlots(Index, Header);
+    if (!SlotsData)
+      return false;
+    Slots.resize(Header.NumSlots);
+    std::memcpy(Slots.data(), SlotsData, Header.NumSlots * sizeof(IndexSlot));
+    return true;
+  };
+  if (!ReadIndex() &&
+      !(writeIndex(RootDir, 0, std::vector<IndexSlot>(IndexNumSlots)) &&
+        ReadIndex())) {
+    trace("Failed to create cache index " + IndexPath);
+    return;
+  }
+
+  std::ostringstream ItemStream;
+  size_t SourceSize = SourceItem.size();
+  ItemStream.write((const char *)&SourceSize, sizeof(SourceSize));
+  ItemStream.write(SourceItem.data(), SourceSize);
+  writeBinaryData(ItemStream, Data);
+  std::string Item = ItemStream.str();
+
+  IndexHashT Hash = getIndexHash(SourceItem);
+  // Finds the slot for the item, which is either a free one or, if all the
+  // probed slots are taken, the one of the oldest item among them.
+  auto FindSlot = [&](uint64_t &FreeIdx) {
+    FreeIdx = Header.NumSlots;
+    for (uint64_t Probe = 0; Probe < IndexMaxProbes; ++Probe) {
+      uint64_t Idx = (Hash[0] + Probe) % Header.NumSlots;
+      if (Slots[Idx].Hash[0] == 0) {
+        FreeIdx = Idx;
+        return true;
+      }
+      // The item is already cached.
+      if (Slots[Idx].Hash[0] == Hash[0] && Slots[Idx].Hash[1] == Hash[1])
+        return false;
+      if (FreeIdx == Header.NumSlots ||
+          Slots[Idx].Offset < Slots[FreeIdx].Offset)
+        FreeIdx = Idx;
+    }
+    return true;
+  };
+
+  uint64_t FreeIdx = 0;
+  if (!FindSlot(FreeIdx))
+    return;
+
+  std::string BlobPath = getBlobPath(RootDir, Header.Generation);
+  uint64_t BlobSize = 0;
+  {
+    std::ifstream BlobStream{BlobPath, std::ios::binary | std::ios::ate};
+    if (BlobStream)
+      BlobSize = BlobStream.tellg();
+  }
+
+  static const unsigned long MaxCacheSize =
+      getNumParam<SYCL_CACHE_MAX_SIZE>(0);
+  if (MaxCacheSize && Item.size() > MaxCacheSize)
+    return;
+  if (MaxCacheSize && BlobSize + Item.size() > MaxCacheSize) {
+    // Evict the oldest items so that the new one fits.
+    if (!compactIndex(RootDir, Header, Slots, MaxCacheSize - Item.size()) ||
+        !ReadIndex()) {
+      trace("Failed to evict cache items in " + RootDir);
+      return;
+    }
+    trace("evicted cache items in " + RootDir);
+    BlobPath = getBlobPath(RootDir, Header.Generation);
+    BlobSize = 0;
+    for (const IndexSlot &Slot : Slots)
+      BlobSize = std::max(BlobSize, Slot.Offset + Slot.Size);
+    FindSlot(FreeIdx);
+  }
+  // The item of a slot which is taken is evicted by overwriting the slot,
+  // whose hash is cleared first. A reader which found the slot before sees
+  // different key sources, which is treated as a cache miss.
+  bool Evict = Slots[FreeIdx].Hash[0] != 0;
+  if (Evict)
+    trace("evicted cache item in " + RootDir + " at slot " +
+          std::to_string(FreeIdx));
+
+  {
+    std::ofstream BlobStream{BlobPath, std::ios::binary | std::ios::app};
+    BlobStream.write(Item.data(), Item.size());
+    BlobStream.close();
+    if (BlobStream.fail()) {
+      trace("Failed to write cache item to " + BlobPath);
+      return;
+    }
+  }
+
+  // Publish the item: the location is written before the hash, so readers
+  // never find a slot pointing to an incomplete item.
+  IndexSlot Slot{{Hash[0], Hash[1]}, BlobSize, Item.size()};
+  std::fstream IndexStream{IndexPath,
+                           std::ios::binary | std::ios::in | std::ios::out};
+  std::streamoff SlotPos = sizeof(IndexHeader) + FreeIdx * sizeof(IndexSlot);
+  if (Evict) {
+    const uint64_t NoHash[2] = {0, 0};
+    IndexStream.seekp(SlotPos);
+    IndexStream.write((const char *)NoHash, sizeof(NoHash));
+    IndexStream.flush();
+  }
+  IndexStream.seekp(SlotPos + offsetof(IndexSlot, Offset));
+  IndexStream.write((const char *)&Slot.Offset,
+                    sizeof(Slot.Offset) + sizeof(Slot.Size));
+  IndexStream.flush();
+  IndexStream.seekp(SlotPos);
+  IndexStream.write((const char *)Slot.Hash, sizeof(Slot.Hash));
+  IndexStream.close();
+  if (IndexStream.fail())
+    trace("Failed to update cache index " + IndexPath);
+  else
+    trace("device binary has been cached: " + BlobPath + "@" +
+          std::to_string(BlobSize));
+}
+
+namespace {
+/* Returns the key of the item in the remote store, which holds the version
+ * of the item format.
+ */
+std::string getRemoteKey(const std::string &SourceItem) {
+  IndexHashT Hash = getIndexHash(SourceItem);
+  char Key[40];
+  std::snprintf(Key, sizeof(Key), "sycl2-%016llx%016llx",
+                static_cast<unsigned long long>(Hash[0]),
+                static_cast<unsigned long long>(Hash[1]));
+  return Key;
+}
+
+std::mutex RemoteBackendMutex;
+std::shared_ptr<PersistentCacheBackend> RemoteBackend;
+bool RemoteBackendInitialized = false;
+} // namespace
+
+std::shared_ptr<PersistentCacheBackend>
+PersistentDeviceCodeCache::getRemoteBackend() {
+  std::lock_guard<std::mutex> Lock{RemoteBackendMutex};
+  if (!RemoteBackendInitialized) {
+    RemoteBackendInitialized = true;
+    if (const char *URL = SYCLConfig<SYCL_CACHE_REMOTE_URL>::get()) {
+      RemoteBackend = HTTPCacheBackend::create(URL);
+      trace(std::string(RemoteBackend ? "using remote cache "
+                                      : "unsupported remote cache URL ") +
+            URL);
+    }
+  }
+  return RemoteBackend;
+}
+
+void PersistentDeviceCodeCache::setRemoteBackend(
+    std::shared_ptr<PersistentCacheBackend> Backend) {
+  std::lock_guard<std::mutex> Lock{RemoteBackendMutex};
+  RemoteBackendInitialized = true;
+  RemoteBackend = std::move(Backend);
+}
+
+std::vector<std::vector<char>>
+PersistentDeviceCodeCache::getRemoteItem(const std::string &SourceItem) {
+  std::shared_ptr<PersistentCacheBackend> Backend = getRemoteBackend();
+  std::string Key = getRemoteKey(SourceItem);
+  std::string Item;
+  try {
+    if (!Backend || !Backend->get(Key, Item))
+      return {};
+  } catch (std::exception &e) {
+    trace(std::string("exception encountered reading remote cache: ") +
+          e.what());
+    return {};
+  }
+
+  // Resolve hash collisions by comparing the full key sources.
+  size_t SourceSize = 0;
+  if (Item.size() < sizeof(SourceSize) + SourceItem.size())
+    return {};
+  std::memcpy(&SourceSize, Item.data(), sizeof(SourceSize));
+  if (SourceSize != SourceItem.size() ||
+      Item.compare(sizeof(SourceSize), SourceSize, SourceItem))
+    return {};
+
+  std::istringstream ItemStream{Item.substr(sizeof(SourceSize) + SourceSize)};
+  std::vector<std::vector<char>> Res;
+  try {
+    Res = readBinaryData(ItemStream);
+  } catch (...) {
+    return {};
+  }
+  if (!Res.empty())
+    trace("using remote cached device binary: " + Key);
+  return Res;
+}
+
+void PersistentDeviceCodeCache::putRemoteItem(
+    const std::string &SourceItem, const std::vector<std::vector<char>> &Data) {
+  std::shared_ptr<PersistentCacheBackend> Backend = getRemoteBackend();
+  if (!Backend)
+    return;
+
+  std::ostringstream ItemStream;
+  size_t SourceSize = SourceItem.size();
+  ItemStream.write((const char *)&SourceSize, sizeof(SourceSize));
+  ItemStream.write(SourceItem.data(), SourceSize);
+  writeBinaryData(ItemStream, Data);
+  std::string Key = getRemoteKey(SourceItem);
+  try {
+    Backend->put(Key, ItemStream.str());
+    trace("device binary has been sent to remote cache: " + Key);
+  } catch (std::exception &e) {
+    trace(std::string("exception encountered writing remote cache: ") +
+          e.what());
+  }
+}
+
+std::unique_ptr<HTTPCacheBackend>
+HTTPCacheBackend::create(const std::string &URL) {
+#if defined(__SYCL_RT_OS_POSIX_SUPPORT)
+  const std::string Scheme = "http://";
+  if (URL.compare(0, Scheme.size(), Scheme))
+    return nullptr;
+  size_t PathPos = URL.find('/', Scheme.size());
+  std::string Authority = URL.substr(Scheme.size(), PathPos - Scheme.size());
+  std::string Path = PathPos == std::string::npos ? "" : URL.substr(PathPos);
+  while (!Path.empty() && Path.back() == '/')
+    Path.pop_back();
+
+  size_t PortPos = Authority.rfind(':');
+  std::string Host = Authority.substr(0, PortPos);
+  std::string Port =
+      PortPos == std::string::npos ? "80" : Authority.substr(PortPos + 1);
+  if (Host.empty() || Port.empty() ||
+      Port.find_first_not_of("0123456789") != std::string::npos)
+    return nullptr;
+  return std::unique_ptr<HTTPCacheBackend>(new HTTPCacheBackend(
+      std::move(Host), std::move(Port), std::move(Path)));
+#else
+  (void)URL;
+  return nullptr;
+#endif
+}
+
+bool HTTPCacheBackend::get(const std::string &Key, std::string &Data) {
+  std::string Request = "GET " + MPath + "/" + Key + " HTTP/1.0\r\n";
+  return request(Request, {}, Data) == 200;
+}
+
+void HTTPCacheBackend::put(const std::string &Key, const std::string &Data) {
+  std::string Request = "PUT " + MPath + "/" + Key + " HTTP/1.0\r\n" +
+                        "Content-Type: application/octet-stream\r\n" +
+                        "Content-Length: " + std::to_string(Data.size()) +
+                        "\r\n";
+  std::string ResponseBody;
+  int Status = request(Request, Data, ResponseBody);
+  if (Status < 200 || Status >= 300)
+    PersistentDeviceCodeCache::trace("remote cache rejected " + Key +
+                                     " with status " + std::to_string(Status));
+}
+
+int HTTPCacheBackend::request(const std::string &Request,
+                              const std::string &Body,
+                              std::string &ResponseBody) {
+#if defined(__SYCL_RT_OS_POSIX_SUPPORT)
+  // The store is expected to be on the local network, a slow one is treated
+  // as a miss rather than stalling the builds.
+  constexpr int TimeoutSeconds = 10;
+
+  addrinfo Hints{};
+  Hints.ai_family = AF_UNSPEC;
+  Hints.ai_socktype = SOCK_STREAM;
+  addrinfo *Addresses = nullptr;
+  if (getaddrinfo(MHost.c_str(), MPort.c_str(), &Hints, &Addresses) != 0)
+    return 0;
+  int Fd = -1;
+  for (addrinfo *Address = Addresses; Address; Address = Address->ai_next) {
+    Fd = socket(Address->ai_family, Address->ai_socktype,
+                Address->ai_protocol);
+    if (Fd == -1)
+      continue;
+    timeval Timeout{TimeoutSeconds, 0};
+    setsockopt(Fd, SOL_SOCKET, SO_RCVTIMEO, &Timeout, sizeof(Timeout));
+    setsockopt(Fd, SOL_SOCKET, SO_SNDTIMEO, &Timeout, sizeof(Timeout));
+    if (connect(Fd, Address->ai_addr, Address->ai_addrlen) == 0)
+      break;
+    close(Fd);
+    Fd = -1;
+  }
+  freeaddrinfo(Addresses);
+  if (Fd == -1) {
+    PersistentDeviceCodeCache::trace("Failed to connect to remote cache " +
+                                     MHost + ":" + MPort);
+    return 0;
+  }
+
+#ifdef MSG_NOSIGNAL
+  constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+  constexpr int SendFlags = 0;
+#endif
+  // HTTP/1.0 requests are answered without chunked encoding, and the end of
+  // the response is the end of the connection.
+  std::string Message =
+      Request + "Host: " + MHost + "\r\nConnection: close\r\n\r\n" + Body;
+  for (size_t Sent = 0; Sent < Message.size();) {
+    ssize_t Res =
+        send(Fd, Message.data() + Sent, Message.size() - Sent, SendFlags);
+    if (Res <= 0) {
+      close(Fd);
+      return 0;
+    }
+    Sent += Res;
+  }
+
+  std::string Response;
+  char Buffer[16384];
+  ssize_t Res;
+  while ((Res = recv(Fd, Buffer, sizeof(Buffer), 0)) > 0)
+    Response.append(Buffer, Res);
+  close(Fd);
+  if (Res < 0)
+    return 0;
+
+  // Status line: HTTP/1.x <status> <reason>
+  size_t HeadersEnd = Response.find("\r\n\r\n");
+  if (HeadersEnd == std::string::npos || Response.compare(0, 5, "HTTP/"))
+    return 0;
+  size_t StatusPos = Response.find(' ');
+  if (StatusPos == std::string::npos || StatusPos > HeadersEnd)
+    return 0;
+  int Status = std::atoi(Response.c_str() + StatusPos + 1);
+
+  ResponseBody = Response.substr(HeadersEnd + 4);
+  std::string Headers = Response.substr(0, HeadersEnd);
+  std::transform(Headers.begin(), Headers.end(), Headers.begin(),
+                 [](unsigned char C) { return std::tolower(C); });
+  size_t LengthPos = Headers.find("\r\ncontent-length:");
+  if (LengthPos != std::string::npos) {
+    size_t Length = std::strtoull(
+        Headers.c_str() + LengthPos + sizeof("\r\ncontent-length:") - 1,
+        nullptr, 10);
+    // A truncated response is a failure.
+    if (ResponseBody.size() < Length)
+      return 0;
+    ResponseBody.resize(Length);
+  }
+  return Status;
+#else
+  (void)Request;
+  (void)Body;
+  (void)ResponseBody;
+  return 0;
+#endif
+}
+
 /* Returns true if persistent cache is enabled.
  */
 bool PersistentDeviceCodeCache::isEnabled() {
@@ -380,6 +1171,221 @@ std::string PersistentDeviceCodeCache::getRootDir() {
   return SYCLConfig<SYCL_CACHE_DIR>::get();
 }
 
+std::string
+PersistentDeviceCodeCache::getDeviceDataPath(const device &Device,
+                                             const std::string &DataName) {
+  std::string RootDir = getRootDir();
+  if (!isEnabled() || RootDir.empty())
+    return {};
+
+  std::string Dir = RootDir + "/" + DataName;
+  OSUtil::makeDir(Dir.c_str());
+  std::hash<std::string> StringHasher{};
+  return Dir + "/" + std::to_string(StringHasher(getDeviceIDString(Device)));
+}
+
+namespace {
+/* Returns the directory storing the items of the kind with the key sources.
+ */
+std::string getKeyedItemPath(const std::string &RootDir, const char *Kind,
+                             const std::string &DeviceString,
+                             const std::string &KeySources) {
+  std::hash<std::string> StringHasher{};
+  return RootDir + "/" + Kind + "/" +
+         std::to_string(StringHasher(DeviceString)) + "/" +
+         std::to_string(StringHasher(KeySources));
+}
+
+std::string getKeyedItemSourceItem(const std::string &DeviceString,
+                                   const std::string &KeySources) {
+  std::string Res;
+  for (const std::string *Str : {&DeviceString, &KeySources}) {
+    size_t Size = Str->size();
+    Res.append((const char *)&Size, sizeof(Size));
+    Res.append(*Str);
+  }
+  return Res;
+}
+
+bool isKeyedItemSrcEqual(const std::string &FileName,
+                         const std::string &SourceItem) {
+  std::ifstream FileStream{FileName, std::ios::binary};
+  std::string Res(SourceItem.size(), '\0');
+  FileStream.read(&Res[0], Res.size());
+  return FileStream.good() && FileStream.peek() == EOF && Res == SourceItem;
+}
+} // namespace
+
+std::vector<char> PersistentDeviceCodeCache::getKeyedItemFromDisc(
+    const char *Kind, const char *Description, const device &Device,
+    const std::string &KeySources) {
+  std::string RootDir = getRootDir();
+  if (!isEnabled() || RootDir.empty())
+    return {};
+
+  std::string DeviceString{getDeviceIDString(Device)};
+  std::string Path = getKeyedItemPath(RootDir, Kind, DeviceString, KeySources);
+  if (!OSUtil::isPathPresent(Path))
+    return {};
+
+  std::string SourceItem = getKeyedItemSourceItem(DeviceString, KeySources);
+  int i = 0;
+  std::string FileName{Path + "/" + std::to_string(i)};
+  while (OSUtil::isPathPresent(FileName + ".bin") ||
+         OSUtil::isPathPresent(FileName + ".src")) {
+    if (!LockCacheItem::isLocked(FileName) &&
+        isKeyedItemSrcEqual(FileName + ".src", SourceItem)) {
+      try {
+        std::string FullFileName = FileName + ".bin";
+        std::vector<std::vector<char>> Res =
+            readBinaryDataFromFile(FullFileName);
+        if (Res.size() == 1) {
+          trace(std::string("using cached ") + Description + ": " +
+                FullFileName);
+          return std::move(Res[0]);
+        }
+      } catch (...) {
+        // If read was unsuccessfull try the next item
+      }
+    }
+    FileName = Path + "/" + std::to_string(++i);
+  }
+  return {};
+}
+
+void PersistentDeviceCodeCache::putKeyedItemToDisc(
+    const char *Kind, const char *Description, const device &Device,
+    const std::string &KeySources, const std::vector<char> &Data) {
+  std::string RootDir = getRootDir();
+  if (!isEnabled() || RootDir.empty())
+    return;
+
+  std::string DeviceString{getDeviceIDString(Device)};
+  std::string DirName =
+      getKeyedItemPath(RootDir, Kind, DeviceString, KeySources);
+  size_t i = 0;
+  std::string FileName;
+  do {
+    FileName = DirName + "/" + std::to_string(i++);
+  } while (OSUtil::isPathPresent(FileName + ".bin") ||
+           OSUtil::isPathPresent(FileName + ".lock"));
+
+  try {
+    OSUtil::makeDir(DirName.c_str());
+    LockCacheItem Lock{FileName};
+    if (Lock.isOwned()) {
+      std::string FullFileName = FileName + ".bin";
+      writeBinaryDataToFile(FullFileName, {Data});
+      trace(std::string(Description) + " has been cached: " + FullFileName);
+      std::string SourceItem =
+          getKeyedItemSourceItem(DeviceString, KeySources);
+      std::ofstream FileStream{FileName + ".src", std::ios::binary};
+      FileStream.write(SourceItem.data(), SourceItem.size());
+      FileStream.close();
+      if (FileStream.fail())
+        trace("Failed to write source file to " + FileName + ".src");
+    } else {
+      PersistentDeviceCodeCache::trace("cache lock not owned " + FileName);
+    }
+  } catch (std::exception &e) {
+    PersistentDeviceCodeCache::trace(
+        std::string("exception encountered making persistent cache: ") +
+        e.what());
+  } catch (...) {
+    PersistentDeviceCodeCache::trace(
+        std::string("error outputting persistent cache: ") +
+        std::strerror(errno));
+  }
+}
+
+std::vector<char> PersistentDeviceCodeCache::getFusedKernelFromDisc(
+    const device &Device, const std::string &KeySources) {
+  return getKeyedItemFromDisc("fusion", "fused kernel", Device, KeySources);
+}
+
+void PersistentDeviceCodeCache::putFusedKernelToDisc(
+    const device &Device, const std::string &KeySources,
+    const std::vector<char> &Data) {
+  putKeyedItemToDisc("fusion", "fused kernel", Device, KeySources, Data);
+}
+
+std::vector<char> PersistentDeviceCodeCache::getDeviceLibFromDisc(
+    const device &Device, const std::string &KeySources) {
+  return getKeyedItemFromDisc("devicelib", "device library", Device,
+                              KeySources);
+}
+
+void PersistentDeviceCodeCache::putDeviceLibToDisc(
+    const device &Device, const std::string &KeySources,
+    const sycl::detail::pi::PiProgram &NativePrg) {
+  if (!isEnabled() || getRootDir().empty())
+    return;
+
+  std::vector<std::vector<char>> Objects =
+      getProgramBinaryData(Device, NativePrg);
+  if (Objects.size() == 1 && !Objects[0].empty())
+    putKeyedItemToDisc("devicelib", "device library", Device, KeySources,
+                       Objects[0]);
+}
+
+PersistentDeviceCodeCacheWriter::PersistentDeviceCodeCacheWriter()
+    : MThread([this]() { run(); }) {}
+
+void PersistentDeviceCodeCacheWriter::push(std::function<void()> Write) {
+  {
+    std::unique_lock<std::mutex> Lock(MMutex);
+    MSpaceAvailable.wait(Lock, [this]() {
+      return MStop || MWrites.size() < MaxPendingWrites;
+    });
+    if (!MStop) {
+      MWrites.push_back(std::move(Write));
+      ++MWritesInFlight;
+      MWritesAvailable.notify_one();
+      return;
+    }
+  }
+  // The writer has been stopped already.
+  Write();
+}
+
+void PersistentDeviceCodeCacheWriter::flush() {
+  std::unique_lock<std::mutex> Lock(MMutex);
+  MSpaceAvailable.wait(Lock, [this]() { return MWritesInFlight == 0; });
+}
+
+void PersistentDeviceCodeCacheWriter::finishAndWait() {
+  {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    MStop = true;
+  }
+  MWritesAvailable.notify_all();
+  if (MThread.joinable())
+    MThread.join();
+}
+
+void PersistentDeviceCodeCacheWriter::run() {
+  std::unique_lock<std::mutex> Lock(MMutex);
+  while (true) {
+    MWritesAvailable.wait(Lock, [this]() { return MStop || !MWrites.empty(); });
+    // Pending writes are completed even if the writer is being stopped.
+    if (MWrites.empty())
+      return;
+
+    std::function<void()> Write = std::move(MWrites.front());
+    MWrites.pop_front();
+    Lock.unlock();
+    try {
+      Write();
+    } catch (...) {
+      PersistentDeviceCodeCache::trace("failed to write cache item");
+    }
+    Write = nullptr;
+    Lock.lock();
+    --MWritesInFlight;
+    MSpaceAvailable.notify_all();
+  }
+}
+
 } // namespace detail
 } // namespace _V1
 } // namespace sycl
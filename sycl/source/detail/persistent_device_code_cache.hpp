@@ -10,7 +10,13 @@
 
 #include <detail/config.hpp>
 #include <detail/device_binary_image.hpp>
+#include <condition_variable>
+#include <deque>
 #include <fcntl.h>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <sycl/detail/os_util.hpp>
 #include <sycl/detail/pi.hpp>
@@ -56,6 +62,52 @@ public:
 };
 /* End of temporary solution*/
 
+/* Store of the persistent cache items outside of the cache directory, which
+ * can be shared by the nodes of a cluster. The items are opaque to the store
+ * and named by keys made of the hash of their key sources. All failures are
+ * ignored and treated as cache misses.
+ */
+class PersistentCacheBackend {
+public:
+  virtual ~PersistentCacheBackend() = default;
+
+  /* Returns true and sets Data if an item is stored under Key. */
+  virtual bool get(const std::string &Key, std::string &Data) = 0;
+
+  virtual void put(const std::string &Key, const std::string &Data) = 0;
+};
+
+/* Content-addressed store served over HTTP at the URL
+ * http://<host>[:<port>][/<path>]. The item of Key is read by a GET of
+ * <URL>/<Key> and written by a PUT to the same location, as done by the
+ * HTTP backends of sccache and most artifact stores. Only supported on
+ * POSIX systems.
+ */
+class HTTPCacheBackend : public PersistentCacheBackend {
+public:
+  /* Returns nullptr if the URL is not supported. */
+  static std::unique_ptr<HTTPCacheBackend> create(const std::string &URL);
+
+  bool get(const std::string &Key, std::string &Data) override;
+  void put(const std::string &Key, const std::string &Data) override;
+
+private:
+  HTTPCacheBackend(std::string Host, std::string Port, std::string Path)
+      : MHost(std::move(Host)), MPort(std::move(Port)),
+        MPath(std::move(Path)) {}
+
+  /* Sends Request and Body, and returns the status code of the response, or
+   * 0 on failure. The body of the response is stored to ResponseBody.
+   */
+  int request(const std::string &Request, const std::string &Body,
+              std::string &ResponseBody);
+
+  const std::string MHost;
+  const std::string MPort;
+  // Has no trailing slash.
+  const std::string MPath;
+};
+
 class PersistentDeviceCodeCache {
   /* The device code images are stored on file system using structure below:
    * <cache_root>/
@@ -92,6 +144,36 @@ class PersistentDeviceCodeCache {
    * and:
    *  - on cache write operation cache item is not created;
    *  - on cache read operation it is treated as cache miss.
+   *
+   * If SYCL_CACHE_LAYOUT is set to "indexed", the cache items are stored in
+   * two files instead:
+   * <cache_root>/
+   *     index.bin
+   *     index.lock
+   *     data.<generation>.bin
+   *   index.bin             - header (magic, generation, number of slots)
+   *                           followed by an open addressing hash table. Each
+   *                           slot holds the 128-bit hash of the item key
+   *                           sources, and the offset and size of the item
+   *                           in the blob store;
+   *   index.lock            - lock file taken by writers;
+   *   data.<generation>.bin - append-only blob store. Each item consists of
+   *                           the key sources (compared on lookup to
+   *                           resolve hash collisions, with the image
+   *                           replaced by its hash, which is computed once
+   *                           per image) and the built device code (same as
+   *                           in <n>.bin).
+   * A lookup maps the index and probes it, so it does not depend on the
+   * number of cached items. When all the probed slots are taken, the oldest
+   * item among them is evicted by overwriting its slot. When the blob store
+   * would exceed SYCL_CACHE_MAX_SIZE, the most recent items which fit are
+   * copied to a blob store with the next generation, and a new index holding
+   * them is renamed over the old one.
+   *
+   * If SYCL_CACHE_REMOTE_URL is set, the device code images are also stored
+   * in the HTTP store at this URL, using the same item format as the indexed
+   * layout. The images missing from the local cache are looked up in the
+   * store and copied to the local cache when found there.
    */
 private:
   /* Write built binary to persistent cache
@@ -99,12 +181,15 @@ private:
    */
   static void writeBinaryDataToFile(const std::string &FileName,
                                     const std::vector<std::vector<char>> &Data);
+  static void writeBinaryData(std::ostream &Stream,
+                              const std::vector<std::vector<char>> &Data);
 
   /* Read built binary to persistent cache
    * Format: numImages, 1stImageSize, Image[, NthImageSize, NthImage...]
    */
   static std::vector<std::vector<char>>
   readBinaryDataFromFile(const std::string &FileName);
+  static std::vector<std::vector<char>> readBinaryData(std::istream &Stream);
 
   /* Writing cache item key sources to be used for reliable identification
    * Format: Four pairs of [size, value] for device, build options,
@@ -115,6 +200,47 @@ private:
                               const SerializedObj &SpecConsts,
                               const std::string &BuildOptionsString);
 
+  /* Returns cache item key sources in the format written by writeSourceItem
+   */
+  static std::string getSourceItem(const device &Device,
+                                   const RTDeviceBinaryImage &Img,
+                                   const SerializedObj &SpecConsts,
+                                   const std::string &BuildOptionsString);
+
+  /* Returns cache item key sources of the indexed layout and the remote store,
+   * in which the image is represented by the hash of its binary
+   */
+  static std::string
+  getIndexedSourceItem(const device &Device, const RTDeviceBinaryImage &Img,
+                       const SerializedObj &SpecConsts,
+                       const std::string &BuildOptionsString);
+
+  /* Reads and writes cache items using the indexed layout, see above.
+   */
+  static std::vector<std::vector<char>>
+  getIndexedItem(const std::string &RootDir, const std::string &SourceItem);
+  static void putIndexedItem(const std::string &RootDir,
+                             const std::string &SourceItem,
+                             const std::vector<std::vector<char>> &Data);
+
+  /* Reads and writes the built device code in the local cache */
+  static std::vector<std::vector<char>>
+  getBinaryDataFromDisc(const device &Device, const RTDeviceBinaryImage &Img,
+                        const SerializedObj &SpecConsts,
+                        const std::string &BuildOptionsString);
+  static void putBinaryDataToDisc(const device &Device,
+                                  const RTDeviceBinaryImage &Img,
+                                  const SerializedObj &SpecConsts,
+                                  const std::string &BuildOptionsString,
+                                  const std::vector<std::vector<char>> &Data);
+
+  /* Reads and writes cache items in the remote store, if any.
+   */
+  static std::vector<std::vector<char>>
+  getRemoteItem(const std::string &SourceItem);
+  static void putRemoteItem(const std::string &SourceItem,
+                            const std::vector<std::vector<char>> &Data);
+
   /* Check that cache item key sources are equal to the current program
    */
   static bool isCacheItemSrcEqual(const std::string &FileName,
@@ -123,6 +249,19 @@ private:
                                   const SerializedObj &SpecConsts,
                                   const std::string &BuildOptionsString);
 
+  /* Reads and writes the opaque items stored in
+   * <cache_root>/<Kind>/<device_hash>/<key_hash>/, Description naming them in
+   * the traces.
+   */
+  static std::vector<char> getKeyedItemFromDisc(const char *Kind,
+                                                const char *Description,
+                                                const device &Device,
+                                                const std::string &KeySources);
+  static void putKeyedItemToDisc(const char *Kind, const char *Description,
+                                 const device &Device,
+                                 const std::string &KeySources,
+                                 const std::vector<char> &Data);
+
   /* Check if on-disk cache enabled.
    */
   static bool isEnabled();
@@ -160,6 +299,11 @@ private:
       1024 * 1024 * 1024;
 
 public:
+  /* Returns built device code of the program for all its devices */
+  static std::vector<std::vector<char>>
+  getProgramBinaryData(const device &Device,
+                       const sycl::detail::pi::PiProgram &NativePrg);
+
   /* Get directory name for storing current cache item
    */
   static std::string getCacheItemPath(const device &Device,
@@ -184,6 +328,56 @@ public:
                             const std::string &BuildOptionsString,
                             const sycl::detail::pi::PiProgram &NativePrg);
 
+  /* Same as putItemToDisc, but the item is written by the background writer
+   * thread, so that the build does not wait for the disk I/O. The program is
+   * retained until it is written, the image is read until then, so the writes
+   * are flushed before the images of a library are unregistered.
+   */
+  static void putItemToDiscAsync(const device &Device,
+                                 const RTDeviceBinaryImage &Img,
+                                 const SerializedObj &SpecConsts,
+                                 const std::string &BuildOptionsString,
+                                 const sycl::detail::pi::PiProgram &NativePrg);
+
+  /* Returns the path of the file storing the runtime data of kind DataName
+   * for the device next to the cache, creating its directory if needed, or an
+   * empty string if the cache is disabled.
+   */
+  static std::string getDeviceDataPath(const device &Device,
+                                       const std::string &DataName);
+
+  /* Fused kernels produced by the kernel fusion JIT compiler are stored in
+   * <cache_root>/fusion/<device_hash>/<key_hash>/ using the same item files
+   * and locks as the device code images. KeySources holds the full values of
+   * the fusion inputs and is compared on lookup to resolve hash collisions.
+   * The data is opaque to the cache.
+   */
+  static std::vector<char>
+  getFusedKernelFromDisc(const device &Device, const std::string &KeySources);
+  static void putFusedKernelToDisc(const device &Device,
+                                   const std::string &KeySources,
+                                   const std::vector<char> &Data);
+
+  /* Device libraries compiled to native objects are stored in the same way in
+   * <cache_root>/devicelib/<device_hash>/<key_hash>/, KeySources identifying
+   * the library. The object of the compiled program NativePrg for Device is
+   * stored.
+   */
+  static std::vector<char>
+  getDeviceLibFromDisc(const device &Device, const std::string &KeySources);
+  static void putDeviceLibToDisc(const device &Device,
+                                 const std::string &KeySources,
+                                 const sycl::detail::pi::PiProgram &NativePrg);
+
+  /* Returns the remote store of the cache items, created from
+   * SYCL_CACHE_REMOTE_URL on first use, or nullptr if there is none.
+   */
+  static std::shared_ptr<PersistentCacheBackend> getRemoteBackend();
+
+  /* Replaces the remote store, nullptr disables it. */
+  static void
+  setRemoteBackend(std::shared_ptr<PersistentCacheBackend> Backend);
+
   /* Sends message to std:cerr stream when SYCL_CACHE_TRACE environemnt is set*/
   static void trace(const std::string &msg) {
     static const char *TraceEnabled = SYCLConfig<SYCL_CACHE_TRACE>::get();
@@ -191,6 +385,44 @@ public:
       std::cerr << "*** Code caching: " << msg << std::endl;
   }
 };
+
+/* Runs persistent cache writes on a background thread. The number of pending
+ * writes is bounded: submitting threads block while the queue is full. The
+ * pending writes are completed by finishAndWait(), which is called on the
+ * runtime shutdown; writes submitted after it are done synchronously.
+ */
+class PersistentDeviceCodeCacheWriter {
+public:
+  PersistentDeviceCodeCacheWriter();
+  ~PersistentDeviceCodeCacheWriter() { finishAndWait(); }
+
+  PersistentDeviceCodeCacheWriter(const PersistentDeviceCodeCacheWriter &) =
+      delete;
+  PersistentDeviceCodeCacheWriter &
+  operator=(const PersistentDeviceCodeCacheWriter &) = delete;
+
+  void push(std::function<void()> Write);
+
+  /* Blocks until all the pending writes are complete. */
+  void flush();
+
+  /* Completes the pending writes and stops the writer thread. */
+  void finishAndWait();
+
+private:
+  void run();
+
+  static constexpr size_t MaxPendingWrites = 64;
+
+  std::mutex MMutex;
+  std::condition_variable MWritesAvailable;
+  std::condition_variable MSpaceAvailable;
+  std::deque<std::function<void()>> MWrites;
+  // Number of writes either queued or running.
+  size_t MWritesInFlight = 0;
+  bool MStop = false;
+  std::thread MThread;
+};
 } // namespace detail
 } // namespace _V1
 } // namespace sycl
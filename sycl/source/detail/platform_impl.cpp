@@ -18,7 +18,10 @@
 #include <sycl/device.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cstring>
+#include <future>
 #include <mutex>
 #include <string>
 #include <unordered_set>
@@ -169,12 +172,29 @@ std::vector<platform> platform_impl::get_platforms() {
     }
   }
 
-  // Then check backend-specific plugins
-  for (auto &Plugin : Plugins) {
-    if (Plugin->hasBackend(backend::all)) {
-      continue; // skip UR on this pass
-    }
-    const auto &PluginPlatforms = getPluginPlatforms(Plugin);
+  // Then check backend-specific plugins. The first enumeration initializes
+  // the backend drivers, the plugins don't share any state so it is done
+  // concurrently for all of them. The results are collected in the order of
+  // the plugins to keep the order of the platforms stable.
+  static std::atomic_flag Enumerated = ATOMIC_FLAG_INIT;
+  const bool EnumerateConcurrently = !Enumerated.test_and_set();
+  std::vector<PluginPtr *> BackendPlugins;
+  for (auto &Plugin : Plugins)
+    if (!Plugin->hasBackend(backend::all)) // skip UR on this pass
+      BackendPlugins.push_back(&Plugin);
+  std::vector<std::future<std::vector<platform>>> Enumerations;
+  for (size_t I = 1; EnumerateConcurrently && I < BackendPlugins.size(); ++I)
+    Enumerations.push_back(std::async(
+        std::launch::async,
+        [&getPluginPlatforms, Plugin = BackendPlugins[I]]() {
+          return getPluginPlatforms(*Plugin);
+        }));
+
+  for (size_t I = 0; I < BackendPlugins.size(); ++I) {
+    PluginPtr &Plugin = *BackendPlugins[I];
+    const auto &PluginPlatforms = I == 0 || !EnumerateConcurrently
+                                      ? getPluginPlatforms(Plugin)
+                                      : Enumerations[I - 1].get();
     for (const auto &P : PluginPlatforms) {
       // Only add those not already covered by UR
       if (BackendsUR.find(getSyclObjImpl(P)->getBackend()) ==
@@ -219,6 +239,9 @@ std::vector<int> platform_impl::filterDeviceFilter(
 
   constexpr bool is_ods_target = std::is_same_v<FilterT, ods_target>;
 
+  // The platforms of different plugins are filtered concurrently, so the
+  // shared list is not reordered in place.
+  std::vector<FilterT> Filters = FilterList->get();
   if constexpr (is_ods_target) {
 
     // Since we are working with ods_target filters ,which can be negative,
@@ -227,7 +250,7 @@ std::vector<int> platform_impl::filterDeviceFilter(
     // blacklisted devices by the time we get to the positive filters
     // so that if a positive filter matches a blacklisted device we do
     // not add it to the list of available devices.
-    std::sort(FilterList->get().begin(), FilterList->get().end(),
+    std::sort(Filters.begin(), Filters.end(),
               [](const ods_target &filter1, const ods_target &filter2) {
                 return filter1.IsNegativeTarget && !filter2.IsNegativeTarget;
               });
@@ -263,7 +286,7 @@ std::vector<int> platform_impl::filterDeviceFilter(
     // Sycl device type for GPU, CPU, and ACC.
     info::device_type DeviceType = pi::cast<info::device_type>(PiDevType);
 
-    for (const FilterT &Filter : FilterList->get()) {
+    for (const FilterT &Filter : Filters) {
       backend FilterBackend = Filter.Backend.value_or(backend::all);
       // First, match the backend entry.
       if (FilterBackend != Backend && FilterBackend != backend::all)
@@ -328,6 +351,36 @@ std::shared_ptr<device_impl> platform_impl::getOrMakeDeviceImpl(
   return Result;
 }
 
+sycl::detail::pi::PiContext platform_impl::acquireSharedContext(
+    const std::vector<sycl::detail::pi::PiDevice> &DeviceIds,
+    pi_context_properties Props,
+    const std::function<sycl::detail::pi::PiContext()> &Create) {
+  const std::lock_guard<std::mutex> Guard(MSharedContextsMutex);
+  auto It = MSharedContexts.find({DeviceIds, Props});
+  if (It != MSharedContexts.end()) {
+    ++It->second.MRefCount;
+    return It->second.MContext;
+  }
+  sycl::detail::pi::PiContext Context = Create();
+  MSharedContexts.emplace(std::make_pair(DeviceIds, Props),
+                          SharedContext{Context, 1});
+  return Context;
+}
+
+void platform_impl::releaseSharedContext(sycl::detail::pi::PiContext Context) {
+  const std::lock_guard<std::mutex> Guard(MSharedContextsMutex);
+  auto It = std::find_if(MSharedContexts.begin(), MSharedContexts.end(),
+                         [Context](const auto &Entry) {
+                           return Entry.second.MContext == Context;
+                         });
+  assert(It != MSharedContexts.end() && "Context is not shared");
+  if (--It->second.MRefCount > 0)
+    return;
+  MSharedContexts.erase(It);
+  // TODO catch an exception and put it to list of asynchronous exceptions
+  getPlugin()->call_nocheck<PiApiKind::piContextRelease>(Context);
+}
+
 static bool supportsAffinityDomain(const device &dev,
                                    info::partition_property partitionProp,
                                    info::partition_affinity_domain domain) {
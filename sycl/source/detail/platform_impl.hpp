@@ -17,6 +17,11 @@
 #include <sycl/detail/pi.hpp>
 #include <sycl/info/info_desc.hpp>
 
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
 namespace sycl {
 inline namespace _V1 {
 
@@ -153,6 +158,9 @@ public:
     assert(!MHostPlatform && "Plugin is not available for Host");
     MPlugin = PluginPtr;
     MBackend = Backend;
+    // The devices cache the info queried through the previous plugin.
+    std::lock_guard<std::mutex> Guard(MDeviceMapMutex);
+    MDeviceCache.clear();
   }
 
   /// Gets the native handle of the SYCL platform.
@@ -224,6 +232,19 @@ public:
   getPlatformFromPiDevice(sycl::detail::pi::PiDevice PiDevice,
                           const PluginPtr &Plugin);
 
+  /// Gets the backend context shared by the contexts created for the same
+  /// devices and properties, and takes a reference to it.
+  ///
+  /// \param Create creates the backend context if there is none.
+  sycl::detail::pi::PiContext acquireSharedContext(
+      const std::vector<sycl::detail::pi::PiDevice> &DeviceIds,
+      pi_context_properties Props,
+      const std::function<sycl::detail::pi::PiContext()> &Create);
+
+  /// Drops a reference to a backend context acquired with
+  /// acquireSharedContext, and releases it with its last reference.
+  void releaseSharedContext(sycl::detail::pi::PiContext Context);
+
   // when getting sub-devices for ONEAPI_DEVICE_SELECTOR we may temporarily
   // ensure every device is a root one.
   bool MAlwaysRootDevice = false;
@@ -245,6 +266,16 @@ private:
   PluginPtr MPlugin;
   std::vector<std::weak_ptr<device_impl>> MDeviceCache;
   std::mutex MDeviceMapMutex;
+
+  struct SharedContext {
+    sycl::detail::pi::PiContext MContext;
+    size_t MRefCount;
+  };
+  std::map<std::pair<std::vector<sycl::detail::pi::PiDevice>,
+                     pi_context_properties>,
+           SharedContext>
+      MSharedContexts;
+  std::mutex MSharedContextsMutex;
 };
 
 } // namespace detail
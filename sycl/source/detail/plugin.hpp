@@ -21,6 +21,13 @@
 #include "xpti/xpti_trace_framework.h"
 #endif
 
+// Keeps the handling of the failed PI calls out of the call sites.
+#ifdef _MSC_VER
+#define __SYCL_PI_ERROR_PATH __declspec(noinline)
+#else
+#define __SYCL_PI_ERROR_PATH __attribute__((noinline, cold))
+#endif
+
 namespace sycl {
 inline namespace _V1 {
 namespace detail {
@@ -116,37 +123,15 @@ public:
   /// \throw Exception if pi_result is not a PI_SUCCESS.
   template <typename Exception = sycl::runtime_error>
   void checkPiResult(sycl::detail::pi::PiResult pi_result) const {
-    char *message = nullptr;
-    if (pi_result == PI_ERROR_PLUGIN_SPECIFIC_ERROR) {
-      pi_result = call_nocheck<PiApiKind::piPluginGetLastError>(&message);
-
-      // If the warning level is greater then 2 emit the message
-      if (detail::SYCLConfig<detail::SYCL_RT_WARNING_LEVEL>::get() >= 2)
-        std::clog << message << std::endl;
-
-      // If it is a warning do not throw code
-      if (pi_result == PI_SUCCESS)
-        return;
-    }
-    __SYCL_CHECK_OCL_CODE_THROW(pi_result, Exception, message);
+    if (pi_result != PI_SUCCESS)
+      handlePiError<Exception>(pi_result);
   }
 
   /// \throw SYCL 2020 exception(errc) if pi_result is not PI_SUCCESS
   template <sycl::errc errc>
   void checkPiResult(sycl::detail::pi::PiResult pi_result) const {
-    if (pi_result == PI_ERROR_PLUGIN_SPECIFIC_ERROR) {
-      char *message = nullptr;
-      pi_result = call_nocheck<PiApiKind::piPluginGetLastError>(&message);
-
-      // If the warning level is greater then 2 emit the message
-      if (detail::SYCLConfig<detail::SYCL_RT_WARNING_LEVEL>::get() >= 2)
-        std::clog << message << std::endl;
-
-      // If it is a warning do not throw code
-      if (pi_result == PI_SUCCESS)
-        return;
-    }
-    __SYCL_CHECK_CODE_THROW_VIA_ERRC(pi_result, errc);
+    if (pi_result != PI_SUCCESS)
+      handlePiError<errc>(pi_result);
   }
 
   void reportPiError(sycl::detail::pi::PiResult pi_result,
@@ -327,6 +312,44 @@ public:
   bool pluginReleased = false;
 
 private:
+  // Handles the failed PI calls out of line, so that checking a successful
+  // call is a single comparison at the call sites.
+  template <typename Exception>
+  __SYCL_PI_ERROR_PATH void
+  handlePiError(sycl::detail::pi::PiResult pi_result) const {
+    char *message = nullptr;
+    if (pi_result == PI_ERROR_PLUGIN_SPECIFIC_ERROR) {
+      pi_result = call_nocheck<PiApiKind::piPluginGetLastError>(&message);
+
+      // If the warning level is greater then 2 emit the message
+      if (detail::SYCLConfig<detail::SYCL_RT_WARNING_LEVEL>::get() >= 2)
+        std::clog << message << std::endl;
+
+      // If it is a warning do not throw code
+      if (pi_result == PI_SUCCESS)
+        return;
+    }
+    __SYCL_CHECK_OCL_CODE_THROW(pi_result, Exception, message);
+  }
+
+  template <sycl::errc errc>
+  __SYCL_PI_ERROR_PATH void
+  handlePiError(sycl::detail::pi::PiResult pi_result) const {
+    if (pi_result == PI_ERROR_PLUGIN_SPECIFIC_ERROR) {
+      char *message = nullptr;
+      pi_result = call_nocheck<PiApiKind::piPluginGetLastError>(&message);
+
+      // If the warning level is greater then 2 emit the message
+      if (detail::SYCLConfig<detail::SYCL_RT_WARNING_LEVEL>::get() >= 2)
+        std::clog << message << std::endl;
+
+      // If it is a warning do not throw code
+      if (pi_result == PI_SUCCESS)
+        return;
+    }
+    __SYCL_CHECK_CODE_THROW_VIA_ERRC(pi_result, errc);
+  }
+
   std::shared_ptr<sycl::detail::pi::PiPlugin> MPlugin;
   backend MBackend;
   void *MLibraryHandle; // the handle returned from dlopen
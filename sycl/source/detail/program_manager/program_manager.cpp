@@ -12,12 +12,14 @@
 #include <detail/device_impl.hpp>
 #include <detail/event_impl.hpp>
 #include <detail/global_handler.hpp>
+#include <detail/metrics.hpp>
 #include <detail/persistent_device_code_cache.hpp>
 #include <detail/platform_impl.hpp>
 #include <detail/program_impl.hpp>
 #include <detail/program_manager/program_manager.hpp>
 #include <detail/queue_impl.hpp>
 #include <detail/spec_constant_impl.hpp>
+#include <detail/thread_pool.hpp>
 #include <sycl/aspects.hpp>
 #include <sycl/backend_types.hpp>
 #include <sycl/context.hpp>
@@ -28,17 +30,25 @@
 #include <sycl/detail/util.hpp>
 #include <sycl/device.hpp>
 #include <sycl/exception.hpp>
+#include <sycl/feature_test.hpp>
+#if SYCL_EXT_CODEPLAY_KERNEL_FUSION
+#include <detail/jit_compiler.hpp>
+#endif
 
 #include <sycl/ext/oneapi/matrix/query-types.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <iterator>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <variant>
@@ -164,6 +174,8 @@ static const char *getFormatStr(sycl::detail::pi::PiDeviceBinaryType Format) {
     return "SPIR-V";
   case PI_DEVICE_BINARY_TYPE_LLVMIR_BITCODE:
     return "LLVM IR";
+  case PI_DEVICE_BINARY_TYPE_COMPRESSED_NONE:
+    return "compressed";
   }
   assert(false && "Unknown device image format");
   return "unknown";
@@ -426,9 +438,11 @@ static void appendCompileOptionsFromImage(std::string &CompileOpts,
   }
 }
 
+// The options are read through SYCLConfig each time rather than kept in
+// statics, so that they follow its resets as the kernel cache keys do.
 static void
 appendCompileEnvironmentVariablesThatAppend(std::string &CompileOpts) {
-  static const char *AppendCompileOptsEnv =
+  const char *AppendCompileOptsEnv =
       SYCLConfig<SYCL_PROGRAM_APPEND_COMPILE_OPTIONS>::get();
   if (AppendCompileOptsEnv) {
     if (!CompileOpts.empty())
@@ -437,7 +451,7 @@ appendCompileEnvironmentVariablesThatAppend(std::string &CompileOpts) {
   }
 }
 static void appendLinkEnvironmentVariablesThatAppend(std::string &LinkOpts) {
-  static const char *AppendLinkOptsEnv =
+  const char *AppendLinkOptsEnv =
       SYCLConfig<SYCL_PROGRAM_APPEND_LINK_OPTIONS>::get();
   if (AppendLinkOptsEnv) {
     if (!LinkOpts.empty())
@@ -456,19 +470,14 @@ static void applyOptionsFromImage(std::string &CompileOpts,
 }
 
 static void applyCompileOptionsFromEnvironment(std::string &CompileOpts) {
-  // Environment variables are not changed during program lifecycle so it
-  // is reasonable to use static here to read them only once.
-  static const char *CompileOptsEnv =
-      SYCLConfig<SYCL_PROGRAM_COMPILE_OPTIONS>::get();
+  const char *CompileOptsEnv = SYCLConfig<SYCL_PROGRAM_COMPILE_OPTIONS>::get();
   if (CompileOptsEnv) {
     CompileOpts = CompileOptsEnv;
   }
 }
 
 static void applyLinkOptionsFromEnvironment(std::string &LinkOpts) {
-  // Environment variables are not changed during program lifecycle so it
-  // is reasonable to use static here to read them only once.
-  static const char *LinkOptsEnv = SYCLConfig<SYCL_PROGRAM_LINK_OPTIONS>::get();
+  const char *LinkOptsEnv = SYCLConfig<SYCL_PROGRAM_LINK_OPTIONS>::get();
   if (LinkOptsEnv) {
     LinkOpts = LinkOptsEnv;
   }
@@ -481,16 +490,63 @@ static void applyOptionsFromEnvironment(std::string &CompileOpts,
   applyLinkOptionsFromEnvironment(LinkOpts);
 }
 
+// Returns the interned identifier of the build options coming from the
+// environment, which are the only ones of the kernels in the fast cache. It is
+// cached per thread along with the option values it was computed from, so that
+// a lookup neither builds the options nor takes the lock of getStringId()
+// unless SYCLConfig has been reset to other values.
+static KernelProgramCache::StringIdT getEnvironmentBuildOptionsId() {
+  const char *Values[] = {
+      SYCLConfig<SYCL_PROGRAM_COMPILE_OPTIONS>::get(),
+      SYCLConfig<SYCL_PROGRAM_LINK_OPTIONS>::get(),
+      SYCLConfig<SYCL_PROGRAM_APPEND_COMPILE_OPTIONS>::get(),
+      SYCLConfig<SYCL_PROGRAM_APPEND_LINK_OPTIONS>::get()};
+  constexpr size_t NumValues = std::size(Values);
+  struct CachedIdT {
+    bool IsValid = false;
+    std::optional<std::string> Values[NumValues];
+    KernelProgramCache::StringIdT Id = 0;
+  };
+  thread_local CachedIdT Cached;
+
+  auto Matches = [&] {
+    for (size_t I = 0; I < NumValues; ++I)
+      if (Values[I] ? Cached.Values[I] != Values[I]
+                    : Cached.Values[I].has_value())
+        return false;
+    return true;
+  };
+  if (Cached.IsValid && Matches())
+    return Cached.Id;
+
+  std::string CompileOpts, LinkOpts;
+  applyOptionsFromEnvironment(CompileOpts, LinkOpts);
+  // Should always come last!
+  appendCompileEnvironmentVariablesThatAppend(CompileOpts);
+  appendLinkEnvironmentVariablesThatAppend(LinkOpts);
+  for (size_t I = 0; I < NumValues; ++I)
+    Cached.Values[I] = Values[I] ? std::optional<std::string>{Values[I]}
+                                 : std::nullopt;
+  Cached.Id = KernelProgramCache::getStringId(CompileOpts + LinkOpts);
+  Cached.IsValid = true;
+  return Cached.Id;
+}
+
 std::pair<sycl::detail::pi::PiProgram, bool>
 ProgramManager::getOrCreatePIProgram(const RTDeviceBinaryImage &Img,
                                      const context &Context,
                                      const device &Device,
                                      const std::string &CompileAndLinkOptions,
-                                     SerializedObj SpecConsts) {
+                                     SerializedObj SpecConsts,
+                                     const std::vector<char> *SharedBinary) {
   sycl::detail::pi::PiProgram NativePrg;
 
-  auto BinProg = PersistentDeviceCodeCache::getItemFromDisc(
-      Device, Img, SpecConsts, CompileAndLinkOptions);
+  std::vector<std::vector<char>> BinProg;
+  if (SharedBinary)
+    BinProg.push_back(*SharedBinary);
+  else
+    BinProg = PersistentDeviceCodeCache::getItemFromDisc(
+        Device, Img, SpecConsts, CompileAndLinkOptions);
   if (BinProg.size()) {
     // Get program metadata from properties
     auto ProgMetadata = Img.getProgramMetadata();
@@ -518,12 +574,19 @@ static void emitBuiltProgramInfo(const pi_program &Prog,
   }
 }
 
+/// Returns true if a program built from the image can be evicted from the
+/// in-memory cache, i.e. it does not hold state, which would be lost.
+static bool isEvictable(const RTDeviceBinaryImage &Img) {
+  return Img.getDeviceGlobals().size() == 0 && Img.getHostPipes().size() == 0;
+}
+
 // When caching is enabled, the returned PiProgram will already have
 // its ref count incremented.
 sycl::detail::pi::PiProgram ProgramManager::getBuiltPIProgram(
     const ContextImplPtr &ContextImpl, const DeviceImplPtr &DeviceImpl,
     const std::string &KernelName, const NDRDescT &NDRDesc,
     bool JITCompilationIsRequired) {
+  registerDeferredImages();
   KernelProgramCache &Cache = ContextImpl->getKernelProgramCache();
 
   std::string CompileOpts;
@@ -561,15 +624,31 @@ sycl::detail::pi::PiProgram ProgramManager::getBuiltPIProgram(
   if (auto exception = checkDevSupportDeviceRequirements(Device, Img, NDRDesc))
     throw *exception;
 
-  auto BuildF = [this, &Img, &Context, &ContextImpl, &Device, &CompileOpts,
-                 &LinkOpts, SpecConsts] {
+  // The image which is built. It only holds the requested kernel if the JIT
+  // compiler extracts it from an image holding several kernels, the other
+  // kernels being built when they are requested. The properties are still
+  // taken from the original image.
+  const RTDeviceBinaryImage *BuildImg = &Img;
+#if SYCL_EXT_CODEPLAY_KERNEL_FUSION
+  if (SYCLConfig<SYCL_JIT_LAZY_KERNELS>::get())
+    if (const RTDeviceBinaryImage *KernelImg =
+            jit_compiler::get_instance().extractKernel(Dev, Img, KernelName))
+      BuildImg = KernelImg;
+#endif // SYCL_EXT_CODEPLAY_KERNEL_FUSION
+
+  auto BuildF = [this, &Img, BuildImg, &Context, &ContextImpl, &Device,
+                 &CompileOpts, &LinkOpts, SpecConsts] {
+    ScopedMetricTimer BuildTimer{MetricKind::ProgramBuild};
     const PluginPtr &Plugin = ContextImpl->getPlugin();
     applyOptionsFromImage(CompileOpts, LinkOpts, Img, {Device}, Plugin);
     // Should always come last!
     appendCompileEnvironmentVariablesThatAppend(CompileOpts);
     appendLinkEnvironmentVariablesThatAppend(LinkOpts);
-    auto [NativePrg, DeviceCodeWasInCache] = getOrCreatePIProgram(
-        Img, Context, Device, CompileOpts + LinkOpts, SpecConsts);
+    SharedBuildCache::Build SharedBuild = m_SharedBuilds.acquire(
+        Device, *BuildImg, SpecConsts, CompileOpts + LinkOpts);
+    auto [NativePrg, DeviceCodeWasInCache] =
+        getOrCreatePIProgram(*BuildImg, Context, Device, CompileOpts + LinkOpts,
+                             SpecConsts, SharedBuild.getBinary());
 
     if (!DeviceCodeWasInCache) {
       if (Img.supportsSpecConstants())
@@ -603,15 +682,17 @@ sycl::detail::pi::PiProgram ProgramManager::getBuiltPIProgram(
     }
 
     ContextImpl->addDeviceGlobalInitializer(BuiltProgram.get(), {Device}, &Img);
+    SharedBuild.complete(Device, BuiltProgram.get());
 
     // Save program to persistent cache if it is not there
     if (!DeviceCodeWasInCache)
-      PersistentDeviceCodeCache::putItemToDisc(
-          Device, Img, SpecConsts, CompileOpts + LinkOpts, BuiltProgram.get());
+      PersistentDeviceCodeCache::putItemToDiscAsync(
+          Device, *BuildImg, SpecConsts, CompileOpts + LinkOpts,
+          BuiltProgram.get());
     return BuiltProgram.release();
   };
 
-  uint32_t ImgId = Img.getImageID();
+  uint32_t ImgId = BuildImg->getImageID();
   const sycl::detail::pi::PiDevice PiDevice = Dev->getHandleRef();
   auto CacheKey =
       std::make_pair(std::make_pair(std::move(SpecConsts), ImgId), PiDevice);
@@ -633,17 +714,21 @@ sycl::detail::pi::PiProgram ProgramManager::getBuiltPIProgram(
   // caller. In that case, we need to increase the ref count of the
   // program.
   ContextImpl->getPlugin()->call<PiApiKind::piProgramRetain>(BuildResult->Val);
+  Cache.registerProgramFetch(CacheKey, BuildImg->getSize(), isEvictable(Img));
   return BuildResult->Val;
 }
 
 // When caching is enabled, the returned PiProgram and PiKernel will
 // already have their ref count incremented.
-std::tuple<sycl::detail::pi::PiKernel, std::mutex *, const KernelArgMask *,
-           sycl::detail::pi::PiProgram>
+std::tuple<sycl::detail::pi::PiKernel, std::shared_ptr<CachedKernelMutex>,
+           const KernelArgMask *, sycl::detail::pi::PiProgram>
 ProgramManager::getOrCreateKernel(const ContextImplPtr &ContextImpl,
                                   const DeviceImplPtr &DeviceImpl,
                                   const std::string &KernelName,
-                                  const NDRDescT &NDRDesc) {
+                                  const NDRDescT &NDRDesc,
+                                  uint64_t KernelNameHash) {
+  ScopedMetricTimer LookupTimer{MetricKind::KernelCacheLookup};
+  registerDeferredImages();
   if (DbgProgMgr > 0) {
     std::cerr << ">>> ProgramManager::getOrCreateKernel(" << ContextImpl.get()
               << ", " << DeviceImpl.get() << ", " << KernelName << ")\n";
@@ -653,29 +738,20 @@ ProgramManager::getOrCreateKernel(const ContextImplPtr &ContextImpl,
 
   KernelProgramCache &Cache = ContextImpl->getKernelProgramCache();
 
-  std::string CompileOpts, LinkOpts;
-  SerializedObj SpecConsts;
-  applyOptionsFromEnvironment(CompileOpts, LinkOpts);
-  // Should always come last!
-  appendCompileEnvironmentVariablesThatAppend(CompileOpts);
-  appendLinkEnvironmentVariablesThatAppend(LinkOpts);
-  const sycl::detail::pi::PiDevice PiDevice = DeviceImpl->getHandleRef();
-
-  auto key = std::make_tuple(std::move(SpecConsts), PiDevice,
-                             CompileOpts + LinkOpts, KernelName);
-  if (SYCLConfig<SYCL_CACHE_IN_MEM>::get()) {
-    auto ret_tuple = Cache.tryToGetKernelFast(key);
-    constexpr size_t Kernel = 0;  // see KernelFastCacheValT tuple
-    constexpr size_t Program = 3; // see KernelFastCacheValT tuple
-    if (std::get<Kernel>(ret_tuple)) {
-      // Pulling a copy of a kernel and program from the cache,
-      // so we need to retain those resources.
-      ContextImpl->getPlugin()->call<PiApiKind::piKernelRetain>(
-          std::get<Kernel>(ret_tuple));
-      ContextImpl->getPlugin()->call<PiApiKind::piProgramRetain>(
-          std::get<Program>(ret_tuple));
+  const bool CacheInMem = SYCLConfig<SYCL_CACHE_IN_MEM>::get();
+  KernelProgramCache::KernelFastCacheKeyT key;
+  if (CacheInMem) {
+    key = std::make_tuple(DeviceImpl->getHandleRef(),
+                          getEnvironmentBuildOptionsId(),
+                          KernelNameHash
+                              ? KernelNameHash
+                              : getKernelNameHash(KernelName.c_str()));
+
+    // The kernel and the program found in the cache are already retained.
+    auto ret_tuple = Cache.tryToGetKernelFast(key, KernelName);
+    constexpr size_t Kernel = 0; // see KernelFastCacheValT tuple
+    if (std::get<Kernel>(ret_tuple))
       return ret_tuple;
-    }
   }
 
   sycl::detail::pi::PiProgram Program =
@@ -706,7 +782,7 @@ ProgramManager::getOrCreateKernel(const ContextImplPtr &ContextImpl,
     return Cache.getOrInsertKernel(Program, KernelName);
   };
 
-  if (!SYCLConfig<SYCL_CACHE_IN_MEM>::get()) {
+  if (!CacheInMem) {
     // The built kernel cannot be shared between multiple
     // threads when caching is disabled, so we can return
     // nullptr for the mutex.
@@ -719,16 +795,18 @@ ProgramManager::getOrCreateKernel(const ContextImplPtr &ContextImpl,
   // getOrBuild is not supposed to return nullptr
   assert(BuildResult != nullptr && "Invalid build result");
   const KernelArgMaskPairT &KernelArgMaskPair = BuildResult->Val;
-  auto ret_val = std::make_tuple(KernelArgMaskPair.first,
-                                 &(BuildResult->MBuildResultMutex),
-                                 KernelArgMaskPair.second, Program);
+  auto ret_val = std::make_tuple(
+      KernelArgMaskPair.first,
+      std::shared_ptr<CachedKernelMutex>(BuildResult,
+                                         &BuildResult->MBuildResultMutex),
+      KernelArgMaskPair.second, Program);
   // If caching is enabled, one copy of the kernel handle will be
   // stored in the cache, and one handle is returned to the
   // caller. In that case, we need to increase the ref count of the
   // kernel.
   ContextImpl->getPlugin()->call<PiApiKind::piKernelRetain>(
       KernelArgMaskPair.first);
-  Cache.saveKernel(key, ret_val);
+  Cache.saveKernel(key, KernelName, ret_val);
   return ret_val;
 }
 
@@ -791,8 +869,7 @@ ProgramManager::getProgramBuildLog(const sycl::detail::pi::PiProgram &Program,
 // TODO device libraries may use scpecialization constants, manifest files, etc.
 // To support that they need to be delivered in a different container - so that
 // pi_device_binary_struct can be created for each of them.
-static bool loadDeviceLib(const ContextImplPtr Context, const char *Name,
-                          sycl::detail::pi::PiProgram &Prog) {
+static bool readDeviceLib(const char *Name, std::vector<char> &FileContent) {
   std::string LibSyclDir = OSUtil::getCurrentDSODir();
   std::ifstream File(LibSyclDir + OSUtil::DirSep + Name,
                      std::ifstream::in | std::ifstream::binary);
@@ -803,13 +880,10 @@ static bool loadDeviceLib(const ContextImplPtr Context, const char *Name,
   File.seekg(0, std::ios::end);
   size_t FileSize = File.tellg();
   File.seekg(0, std::ios::beg);
-  std::vector<char> FileContent(FileSize);
+  FileContent.resize(FileSize);
   File.read(&FileContent[0], FileSize);
   File.close();
-
-  Prog =
-      createSpirvProgram(Context, (unsigned char *)&FileContent[0], FileSize);
-  return Prog != nullptr;
+  return true;
 }
 
 // For each extension, a pair of library names. The first uses native support,
@@ -892,7 +966,41 @@ loadDeviceLibFallback(const ContextImplPtr Context, DeviceLibExt Extension,
   if (Cached)
     return LibProg;
 
-  if (!loadDeviceLib(Context, LibFileName, LibProg)) {
+  std::vector<char> LibContent;
+  if (!readDeviceLib(LibFileName, LibContent)) {
+    CachedLibPrograms.erase(LibProgIt);
+    throw compile_program_error(std::string("Failed to load ") + LibFileName,
+                                PI_ERROR_INVALID_VALUE);
+  }
+
+  // OpenCL compiles the library into a native object, which is kept in the
+  // persistent cache and linked as is by the next programs. The other backends
+  // only compile the libraries when they are linked with the programs.
+  const bool UseNativeObject = Context->getBackend() == backend::opencl;
+  device Dev = createSyclObjFromImpl<device>(
+      Context->getPlatformImpl()->getDeviceImpl(Device));
+  std::string CacheKey;
+  if (UseNativeObject) {
+    std::hash<std::string_view> Hasher;
+    CacheKey = std::string(LibFileName) + ":" +
+               std::to_string(LibContent.size()) + ":" +
+               std::to_string(Hasher(
+                   std::string_view(LibContent.data(), LibContent.size())));
+    std::vector<char> NativeObject =
+        PersistentDeviceCodeCache::getDeviceLibFromDisc(Dev, CacheKey);
+    if (!NativeObject.empty()) {
+      LibProg = createBinaryProgram(
+          Context, Dev,
+          reinterpret_cast<const unsigned char *>(NativeObject.data()),
+          NativeObject.size(), {});
+      return LibProg;
+    }
+  }
+
+  LibProg = createSpirvProgram(
+      Context, reinterpret_cast<unsigned char *>(LibContent.data()),
+      LibContent.size());
+  if (!LibProg) {
     CachedLibPrograms.erase(LibProgIt);
     throw compile_program_error(std::string("Failed to load ") + LibFileName,
                                 PI_ERROR_INVALID_VALUE);
@@ -915,6 +1023,9 @@ loadDeviceLibFallback(const ContextImplPtr Context, DeviceLibExt Extension,
         ProgramManager::getProgramBuildLog(LibProg, Context), Error);
   }
 
+  if (UseNativeObject)
+    PersistentDeviceCodeCache::putDeviceLibToDisc(Dev, CacheKey, LibProg);
+
   return LibProg;
 }
 
@@ -973,6 +1084,12 @@ void CheckJITCompilationForImage(const RTDeviceBinaryImage *const &Image,
   }
 }
 
+// Compressed images are only decompressed once they are selected for use.
+static void decompressIfNeeded(RTDeviceBinaryImage *Img) {
+  if (Img->getRawData().Format == PI_DEVICE_BINARY_TYPE_COMPRESSED_NONE)
+    static_cast<CompressedRTDeviceBinaryImage *>(Img)->decompress();
+}
+
 template <typename StorageKey>
 RTDeviceBinaryImage *getBinImageFromMultiMap(
     const std::unordered_multimap<StorageKey, RTDeviceBinaryImage *> &ImagesSet,
@@ -981,27 +1098,34 @@ RTDeviceBinaryImage *getBinImageFromMultiMap(
   if (ItBegin == ItEnd)
     return nullptr;
 
-  std::vector<pi_device_binary> RawImgs(std::distance(ItBegin, ItEnd));
-  auto It = ItBegin;
-  for (unsigned I = 0; It != ItEnd; ++It, ++I)
-    RawImgs[I] = const_cast<pi_device_binary>(&It->second->getRawData());
-
-  pi_uint32 ImgInd = 0;
-  // Ask the native runtime under the given context to choose the device image
-  // it prefers.
-  getSyclObjImpl(Context)
-      ->getPlugin()
-      ->call<PiApiKind::piextDeviceSelectBinary>(
-          getSyclObjImpl(Device)->getHandleRef(), RawImgs.data(),
-          (pi_uint32)RawImgs.size(), &ImgInd);
-  std::advance(ItBegin, ImgInd);
-  return ItBegin->second;
+  std::vector<RTDeviceBinaryImage *> Imgs;
+  for (auto It = ItBegin; It != ItEnd; ++It)
+    Imgs.push_back(It->second);
+  std::sort(Imgs.begin(), Imgs.end());
+  const ContextImplPtr &CtxImpl = getSyclObjImpl(Context);
+  sycl::detail::pi::PiDevice PiDevice = getSyclObjImpl(Device)->getHandleRef();
+  return CtxImpl->selectBinImage(
+      std::move(Imgs), PiDevice,
+      [&](const std::vector<RTDeviceBinaryImage *> &SortedImgs) {
+        std::vector<pi_device_binary> RawImgs(SortedImgs.size());
+        for (size_t I = 0; I < SortedImgs.size(); ++I)
+          RawImgs[I] =
+              const_cast<pi_device_binary>(&SortedImgs[I]->getRawData());
+
+        pi_uint32 ImgInd = 0;
+        // Ask the native runtime under the given context to choose the
+        // device image it prefers.
+        CtxImpl->getPlugin()->call<PiApiKind::piextDeviceSelectBinary>(
+            PiDevice, RawImgs.data(), (pi_uint32)RawImgs.size(), &ImgInd);
+        return SortedImgs[ImgInd];
+      });
 }
 
 RTDeviceBinaryImage &
 ProgramManager::getDeviceImage(const std::string &KernelName,
                                const context &Context, const device &Device,
                                bool JITCompilationIsRequired) {
+  registerDeferredImages();
   if (DbgProgMgr > 0) {
     std::cerr << ">>> ProgramManager::getDeviceImage(\"" << KernelName << "\", "
               << getRawSyclObjImpl(Context) << ", " << getRawSyclObjImpl(Device)
@@ -1034,6 +1158,7 @@ ProgramManager::getDeviceImage(const std::string &KernelName,
   }
   if (Img) {
     CheckJITCompilationForImage(Img, JITCompilationIsRequired);
+    decompressIfNeeded(Img);
 
     if (DbgProgMgr > 0) {
       std::cerr << "selected device image: " << &Img->getRawData() << "\n";
@@ -1079,6 +1204,7 @@ RTDeviceBinaryImage &ProgramManager::getDeviceImage(
   std::advance(ImageIterator, ImgInd);
 
   CheckJITCompilationForImage(*ImageIterator, JITCompilationIsRequired);
+  decompressIfNeeded(*ImageIterator);
 
   if (DbgProgMgr > 0) {
     std::cerr << "selected device image: " << &(*ImageIterator)->getRawData()
@@ -1251,11 +1377,42 @@ void ProgramManager::cacheKernelUsesAssertInfo(RTDeviceBinaryImage &Img) {
       m_KernelUsesAssert.insert(Prop->Name);
 }
 
-bool ProgramManager::kernelUsesAssert(const std::string &KernelName) const {
+bool ProgramManager::kernelUsesAssert(const std::string &KernelName) {
+  registerDeferredImages();
   return m_KernelUsesAssert.find(KernelName) != m_KernelUsesAssert.end();
 }
 
 void ProgramManager::addImages(pi_device_binaries DeviceBinary) {
+  // Keep the order in which the binaries were added.
+  registerDeferredImages();
+  registerImages(DeviceBinary);
+}
+
+void ProgramManager::addDeferredImages(pi_device_binaries DeviceBinary) {
+  std::lock_guard<std::mutex> Guard(m_DeferredImagesMutex);
+  m_DeferredImages.push_back(DeviceBinary);
+  m_HasDeferredImages.store(true, std::memory_order_release);
+}
+
+void ProgramManager::removeDeferredImages(pi_device_binaries DeviceBinary) {
+  std::lock_guard<std::mutex> Guard(m_DeferredImagesMutex);
+  m_DeferredImages.erase(std::remove(m_DeferredImages.begin(),
+                                     m_DeferredImages.end(), DeviceBinary),
+                         m_DeferredImages.end());
+}
+
+void ProgramManager::registerDeferredImages() {
+  if (!m_HasDeferredImages.load(std::memory_order_acquire))
+    return;
+  // The other threads querying the images wait for their registration.
+  std::lock_guard<std::mutex> Guard(m_DeferredImagesMutex);
+  for (pi_device_binaries DeviceBinary : m_DeferredImages)
+    registerImages(DeviceBinary);
+  m_DeferredImages.clear();
+  m_HasDeferredImages.store(false, std::memory_order_release);
+}
+
+void ProgramManager::registerImages(pi_device_binaries DeviceBinary) {
   const bool DumpImages = std::getenv("SYCL_DUMP_IMAGES") && !m_UseSpvFile;
   for (int I = 0; I < DeviceBinary->NumDeviceBinaries; I++) {
     pi_device_binary RawImg = &(DeviceBinary->DeviceBinaries[I]);
@@ -1265,7 +1422,11 @@ void ProgramManager::addImages(pi_device_binaries DeviceBinary) {
     if (EntriesB == EntriesE)
       continue;
 
-    auto Img = std::make_unique<RTDeviceBinaryImage>(RawImg);
+    std::unique_ptr<RTDeviceBinaryImage> Img;
+    if (RawImg->Format == PI_DEVICE_BINARY_TYPE_COMPRESSED_NONE)
+      Img = std::make_unique<CompressedRTDeviceBinaryImage>(RawImg);
+    else
+      Img = std::make_unique<RTDeviceBinaryImage>(RawImg);
     static uint32_t SequenceID = 0;
 
     // Fill the kernel argument mask map
@@ -1296,38 +1457,50 @@ void ProgramManager::addImages(pi_device_binaries DeviceBinary) {
       dumpImage(*Img, NeedsSequenceID ? ++SequenceID : 0);
     }
 
-    m_BinImg2KernelIDs[Img.get()].reset(new std::vector<kernel_id>);
+    std::shared_ptr<std::vector<kernel_id>> &ImgKernelIDs =
+        m_BinImg2KernelIDs[Img.get()];
+    ImgKernelIDs.reset(new std::vector<kernel_id>);
+
+    // Binaries may have many thousands of kernels, make room for all of them
+    // at once.
+    size_t NumEntries = std::distance(EntriesB, EntriesE);
+    ImgKernelIDs->reserve(NumEntries);
+    m_KernelName2KernelIDs.reserve(m_KernelName2KernelIDs.size() + NumEntries);
+    m_KernelIDs2BinImage.reserve(m_KernelIDs2BinImage.size() + NumEntries);
 
+    std::string Name;
     for (_pi_offload_entry EntriesIt = EntriesB; EntriesIt != EntriesE;
          ++EntriesIt) {
+      // The name is copied once for all the lookups of the entry.
+      Name.assign(EntriesIt->name);
 
       // Skip creating unique kernel ID if it is a service kernel.
       // SYCL service kernels are identified by having
       // __sycl_service_kernel__ in the mangled name, primarily as part of
       // the namespace of the name type.
-      if (std::strstr(EntriesIt->name, "__sycl_service_kernel__")) {
-        m_ServiceKernels.insert(std::make_pair(EntriesIt->name, Img.get()));
+      if (Name.find("__sycl_service_kernel__") != std::string::npos) {
+        m_ServiceKernels.insert(std::make_pair(Name, Img.get()));
         continue;
       }
 
       // Skip creating unique kernel ID if it is an exported device
       // function. Exported device functions appear in the offload entries
       // among kernels, but are identifiable by being listed in properties.
-      if (m_ExportedSymbols.find(EntriesIt->name) != m_ExportedSymbols.end())
+      if (m_ExportedSymbols.find(Name) != m_ExportedSymbols.end())
         continue;
 
       // ... and create a unique kernel ID for the entry
-      auto It = m_KernelName2KernelIDs.find(EntriesIt->name);
+      auto It = m_KernelName2KernelIDs.find(Name);
       if (It == m_KernelName2KernelIDs.end()) {
         std::shared_ptr<detail::kernel_id_impl> KernelIDImpl =
-            std::make_shared<detail::kernel_id_impl>(EntriesIt->name);
+            std::make_shared<detail::kernel_id_impl>(Name);
         sycl::kernel_id KernelID =
             detail::createSyclObjFromImpl<sycl::kernel_id>(KernelIDImpl);
 
-        It = m_KernelName2KernelIDs.emplace_hint(It, EntriesIt->name, KernelID);
+        It = m_KernelName2KernelIDs.emplace_hint(It, Name, KernelID);
       }
       m_KernelIDs2BinImage.insert(std::make_pair(It->second, Img.get()));
-      m_BinImg2KernelIDs[Img.get()]->push_back(It->second);
+      ImgKernelIDs->push_back(It->second);
     }
 
     cacheKernelUsesAssertInfo(*Img);
@@ -1340,8 +1513,8 @@ void ProgramManager::addImages(pi_device_binaries DeviceBinary) {
     }
 
     // Sort kernel ids for faster search
-    std::sort(m_BinImg2KernelIDs[Img.get()]->begin(),
-              m_BinImg2KernelIDs[Img.get()]->end(), LessByHash<kernel_id>{});
+    std::sort(ImgKernelIDs->begin(), ImgKernelIDs->end(),
+              LessByHash<kernel_id>{});
 
     // ... and initialize associated device_global information
     {
@@ -1502,6 +1675,7 @@ uint32_t ProgramManager::getDeviceLibReqMask(const RTDeviceBinaryImage &Img) {
 const KernelArgMask *
 ProgramManager::getEliminatedKernelArgMask(pi::PiProgram NativePrg,
                                            const std::string &KernelName) {
+  registerDeferredImages();
   // Bail out if there are no eliminated kernel arg masks in our images
   if (m_EliminatedKernelArgMasks.empty())
     return nullptr;
@@ -1509,15 +1683,8 @@ ProgramManager::getEliminatedKernelArgMask(pi::PiProgram NativePrg,
   {
     std::lock_guard<std::mutex> Lock(MNativeProgramsMutex);
     auto ImgIt = NativePrograms.find(NativePrg);
-    if (ImgIt != NativePrograms.end()) {
-      auto MapIt = m_EliminatedKernelArgMasks.find(ImgIt->second);
-      if (MapIt != m_EliminatedKernelArgMasks.end()) {
-        auto ArgMaskMapIt = MapIt->second.find(KernelName);
-        if (ArgMaskMapIt != MapIt->second.end())
-          return &MapIt->second[KernelName];
-      }
-      return nullptr;
-    }
+    if (ImgIt != NativePrograms.end())
+      return getEliminatedKernelArgMask(*ImgIt->second, KernelName);
   }
 
   // If the program was not cached iterate over all available images looking for
@@ -1532,6 +1699,18 @@ ProgramManager::getEliminatedKernelArgMask(pi::PiProgram NativePrg,
   return nullptr;
 }
 
+const KernelArgMask *
+ProgramManager::getEliminatedKernelArgMask(const RTDeviceBinaryImage &Img,
+                                           const std::string &KernelName) {
+  auto MapIt = m_EliminatedKernelArgMasks.find(&Img);
+  if (MapIt == m_EliminatedKernelArgMasks.end())
+    return nullptr;
+  auto ArgMaskMapIt = MapIt->second.find(KernelName);
+  if (ArgMaskMapIt == MapIt->second.end())
+    return nullptr;
+  return &ArgMaskMapIt->second;
+}
+
 static bundle_state getBinImageState(const RTDeviceBinaryImage *BinImage) {
   auto IsAOTBinary = [](const char *Format) {
     return (
@@ -1574,6 +1753,7 @@ static bool compatibleWithDevice(RTDeviceBinaryImage *BinImage,
 }
 
 kernel_id ProgramManager::getSYCLKernelID(const std::string &KernelName) {
+  registerDeferredImages();
   std::lock_guard<std::mutex> KernelIDsGuard(m_KernelIDsMutex);
 
   auto KernelID = m_KernelName2KernelIDs.find(KernelName);
@@ -1585,6 +1765,7 @@ kernel_id ProgramManager::getSYCLKernelID(const std::string &KernelName) {
 }
 
 bool ProgramManager::hasCompatibleImage(const device &Dev) {
+  registerDeferredImages();
   std::lock_guard<std::mutex> Guard(m_KernelIDsMutex);
 
   return std::any_of(
@@ -1595,6 +1776,7 @@ bool ProgramManager::hasCompatibleImage(const device &Dev) {
 }
 
 std::vector<kernel_id> ProgramManager::getAllSYCLKernelIDs() {
+  registerDeferredImages();
   std::lock_guard<std::mutex> KernelIDsGuard(m_KernelIDsMutex);
 
   std::vector<sycl::kernel_id> AllKernelIDs;
@@ -1639,6 +1821,7 @@ void ProgramManager::addOrInitDeviceGlobalEntry(const void *DeviceGlobalPtr,
 
 std::set<RTDeviceBinaryImage *>
 ProgramManager::getRawDeviceImages(const std::vector<kernel_id> &KernelIDs) {
+  registerDeferredImages();
   std::set<RTDeviceBinaryImage *> BinImages;
   std::lock_guard<std::mutex> KernelIDsGuard(m_KernelIDsMutex);
   for (const kernel_id &KID : KernelIDs) {
@@ -1651,6 +1834,7 @@ ProgramManager::getRawDeviceImages(const std::vector<kernel_id> &KernelIDs) {
 
 DeviceGlobalMapEntry *
 ProgramManager::getDeviceGlobalEntry(const void *DeviceGlobalPtr) {
+  registerDeferredImages();
   std::lock_guard<std::mutex> DeviceGlobalsGuard(m_DeviceGlobalsMutex);
   auto Entry = m_Ptr2DeviceGlobal.find(DeviceGlobalPtr);
   assert(Entry != m_Ptr2DeviceGlobal.end() && "Device global entry not found");
@@ -1660,6 +1844,7 @@ ProgramManager::getDeviceGlobalEntry(const void *DeviceGlobalPtr) {
 std::vector<DeviceGlobalMapEntry *> ProgramManager::getDeviceGlobalEntries(
     const std::vector<std::string> &UniqueIds,
     bool ExcludeDeviceImageScopeDecorated) {
+  registerDeferredImages();
   std::vector<DeviceGlobalMapEntry *> FoundEntries;
   FoundEntries.reserve(UniqueIds.size());
 
@@ -1693,6 +1878,7 @@ void ProgramManager::addOrInitHostPipeEntry(const void *HostPipePtr,
 
 HostPipeMapEntry *
 ProgramManager::getHostPipeEntry(const std::string &UniqueId) {
+  registerDeferredImages();
   std::lock_guard<std::mutex> HostPipesGuard(m_HostPipesMutex);
   auto Entry = m_HostPipes.find(UniqueId);
   assert(Entry != m_HostPipes.end() && "Host pipe entry not found");
@@ -1700,6 +1886,7 @@ ProgramManager::getHostPipeEntry(const std::string &UniqueId) {
 }
 
 HostPipeMapEntry *ProgramManager::getHostPipeEntry(const void *HostPipePtr) {
+  registerDeferredImages();
   std::lock_guard<std::mutex> HostPipesGuard(m_HostPipesMutex);
   auto Entry = m_Ptr2HostPipe.find(HostPipePtr);
   assert(Entry != m_Ptr2HostPipe.end() && "Host pipe entry not found");
@@ -1730,6 +1917,7 @@ std::vector<device_image_plain>
 ProgramManager::getSYCLDeviceImagesWithCompatibleState(
     const context &Ctx, const std::vector<device> &Devs,
     bundle_state TargetState, const std::vector<kernel_id> &KernelIDs) {
+  registerDeferredImages();
 
   // Collect unique raw device images taking into account kernel ids passed
   // TODO: Can we avoid repacking?
@@ -1860,6 +2048,7 @@ ProgramManager::getSYCLDeviceImagesWithCompatibleState(
     if (ImgInfoPair.second.RequirementCounter == 0)
       continue;
 
+    decompressIfNeeded(ImgInfoPair.first);
     DeviceImageImplPtr Impl = std::make_shared<detail::device_image_impl>(
         ImgInfoPair.first, Ctx, Devs, ImgInfoPair.second.State,
         ImgInfoPair.second.KernelIDs, /*PIProgram=*/nullptr);
@@ -1870,64 +2059,164 @@ ProgramManager::getSYCLDeviceImagesWithCompatibleState(
   return SYCLDeviceImages;
 }
 
-void ProgramManager::bringSYCLDeviceImagesToState(
-    std::vector<device_image_plain> &DeviceImages, bundle_state TargetState) {
-
-  for (device_image_plain &DevImage : DeviceImages) {
-    const bundle_state DevImageState = getSyclObjImpl(DevImage)->get_state();
-
-    // At this time, there is no circumstance where a device image should ever
-    // be in the source state. That not good.
-    assert(DevImageState != bundle_state::ext_oneapi_source);
-
-    switch (TargetState) {
+void ProgramManager::bringSYCLDeviceImageToState(
+    device_image_plain &DevImage, bundle_state TargetState) {
+  const bundle_state DevImageState = getSyclObjImpl(DevImage)->get_state();
+
+  // At this time, there is no circumstance where a device image should ever
+  // be in the source state. That not good.
+  assert(DevImageState != bundle_state::ext_oneapi_source);
+
+  switch (TargetState) {
+  case bundle_state::ext_oneapi_source:
+    // This case added for switch statement completion. We should not be here.
+    assert(DevImageState == bundle_state::ext_oneapi_source);
+    break;
+  case bundle_state::input:
+    // Do nothing since there is no state which can be upgraded to the input.
+    assert(DevImageState == bundle_state::input);
+    break;
+  case bundle_state::object:
+    if (DevImageState == bundle_state::input) {
+      DevImage = compile(DevImage, getSyclObjImpl(DevImage)->get_devices(),
+                         /*PropList=*/{});
+      break;
+    }
+    // Device image is expected to be object state then.
+    assert(DevImageState == bundle_state::object);
+    break;
+  case bundle_state::executable: {
+    switch (DevImageState) {
     case bundle_state::ext_oneapi_source:
-      // This case added for switch statement completion. We should not be here.
-      assert(DevImageState == bundle_state::ext_oneapi_source);
+      // This case added for switch statement completion.
+      // We should not be here.
+      assert(DevImageState != bundle_state::ext_oneapi_source);
       break;
     case bundle_state::input:
-      // Do nothing since there is no state which can be upgraded to the input.
-      assert(DevImageState == bundle_state::input);
+      DevImage = build(DevImage, getSyclObjImpl(DevImage)->get_devices(),
+                       /*PropList=*/{});
       break;
-    case bundle_state::object:
-      if (DevImageState == bundle_state::input) {
-        DevImage = compile(DevImage, getSyclObjImpl(DevImage)->get_devices(),
-                           /*PropList=*/{});
-        break;
-      }
-      // Device image is expected to be object state then.
-      assert(DevImageState == bundle_state::object);
+    case bundle_state::object: {
+      std::vector<device_image_plain> LinkedDevImages =
+          link({DevImage}, getSyclObjImpl(DevImage)->get_devices(),
+               /*PropList=*/{});
+      // Since only one device image is passed here one output device image is
+      // expected
+      assert(LinkedDevImages.size() == 1 && "Expected one linked image here");
+      DevImage = LinkedDevImages[0];
       break;
-    case bundle_state::executable: {
-      switch (DevImageState) {
-      case bundle_state::ext_oneapi_source:
-        // This case added for switch statement completion.
-        // We should not be here.
-        assert(DevImageState != bundle_state::ext_oneapi_source);
-        break;
-      case bundle_state::input:
-        DevImage = build(DevImage, getSyclObjImpl(DevImage)->get_devices(),
-                         /*PropList=*/{});
-        break;
-      case bundle_state::object: {
-        std::vector<device_image_plain> LinkedDevImages =
-            link({DevImage}, getSyclObjImpl(DevImage)->get_devices(),
-                 /*PropList=*/{});
-        // Since only one device image is passed here one output device image is
-        // expected
-        assert(LinkedDevImages.size() == 1 && "Expected one linked image here");
-        DevImage = LinkedDevImages[0];
-        break;
-      }
-      case bundle_state::executable:
-        DevImage = build(DevImage, getSyclObjImpl(DevImage)->get_devices(),
-                         /*PropList=*/{});
-        break;
-      }
+    }
+    case bundle_state::executable:
+      DevImage = build(DevImage, getSyclObjImpl(DevImage)->get_devices(),
+                       /*PropList=*/{});
       break;
     }
+    break;
+  }
+  }
+}
+
+void ProgramManager::bringSYCLDeviceImagesToState(
+    std::vector<device_image_plain> &DeviceImages, bundle_state TargetState) {
+  for (device_image_plain &DevImage : DeviceImages)
+    bringSYCLDeviceImageToState(DevImage, TargetState);
+}
+
+std::shared_future<void>
+ProgramManager::preloadDeviceImages(const context &Ctx,
+                                    const std::vector<device> &Devs) {
+  // The device images are independent from each other, so each of them is
+  // built by its own job of the thread pool, which is shared by the contexts.
+  // The first error is reported once all of them are done.
+  struct PreloadT {
+    ContextImplPtr Ctx;
+    std::vector<device> Devs;
+    std::vector<device_image_plain> DeviceImages;
+    std::atomic<size_t> NumPending{0};
+    std::mutex FirstErrorMutex;
+    std::exception_ptr FirstError;
+    std::promise<void> Done;
+  };
+  auto Preload = std::make_shared<PreloadT>();
+  Preload->Ctx = getSyclObjImpl(Ctx);
+  Preload->Devs = Devs;
+  std::shared_future<void> Done = Preload->Done.get_future().share();
+  addBackgroundBuild(Done);
+
+  // The SYCL objects are released before the preloading is done, as the jobs
+  // may release their state after the runtime is gone.
+  auto Finish = [](PreloadT &Preload) {
+    if (Preload.FirstError)
+      Preload.Ctx->reportAsyncException(Preload.FirstError);
+    Preload.DeviceImages.clear();
+    Preload.Devs.clear();
+    Preload.Ctx.reset();
+    Preload.Done.set_value();
+  };
+  auto BuildImage = [this, Finish](const std::shared_ptr<PreloadT> &Preload,
+                                   size_t Idx) {
+    try {
+      bringSYCLDeviceImageToState(Preload->DeviceImages[Idx],
+                                  bundle_state::executable);
+    } catch (...) {
+      std::lock_guard<std::mutex> Lock(Preload->FirstErrorMutex);
+      if (!Preload->FirstError)
+        Preload->FirstError = std::current_exception();
     }
+    if (--Preload->NumPending == 0)
+      Finish(*Preload);
+  };
+
+  ThreadPool &Pool = GlobalHandler::instance().getHostTaskThreadPool();
+  Pool.submit([this, &Pool, Preload, Finish, BuildImage]() {
+    try {
+      Preload->DeviceImages = getSYCLDeviceImagesWithCompatibleState(
+          createSyclObjFromImpl<context>(Preload->Ctx), Preload->Devs,
+          bundle_state::executable);
+    } catch (...) {
+      Preload->FirstError = std::current_exception();
+    }
+    const size_t NumImages = Preload->DeviceImages.size();
+    if (NumImages == 0) {
+      Finish(*Preload);
+      return;
+    }
+    Preload->NumPending = NumImages;
+    for (size_t Idx = 0; Idx < NumImages; ++Idx)
+      Pool.submit([Preload, BuildImage, Idx]() { BuildImage(Preload, Idx); });
+  });
+  return Done;
+}
+
+std::shared_future<void>
+ProgramManager::startBackgroundBuild(std::function<void()> Build) {
+  std::shared_future<void> Done =
+      std::async(std::launch::async, std::move(Build)).share();
+  addBackgroundBuild(Done);
+  return Done;
+}
+
+void ProgramManager::addBackgroundBuild(const std::shared_future<void> &Done) {
+  std::lock_guard<std::mutex> Lock(m_PreloadsMutex);
+  // Forget about the preloading which is already done.
+  m_Preloads.erase(
+      std::remove_if(m_Preloads.begin(), m_Preloads.end(),
+                     [](const std::shared_future<void> &Preload) {
+                       return Preload.wait_for(std::chrono::seconds(0)) ==
+                              std::future_status::ready;
+                     }),
+      m_Preloads.end());
+  m_Preloads.push_back(Done);
+}
+
+void ProgramManager::waitForPreloadedDeviceImages() {
+  std::vector<std::shared_future<void>> Preloads;
+  {
+    std::lock_guard<std::mutex> Lock(m_PreloadsMutex);
+    Preloads.swap(m_Preloads);
   }
+  for (const std::shared_future<void> &Preload : Preloads)
+    Preload.wait();
 }
 
 std::vector<device_image_plain>
@@ -2232,10 +2521,17 @@ device_image_plain ProgramManager::build(const device_image_plain &DeviceImage,
           "supported",
           PI_ERROR_INVALID_OPERATION);
 
+    // Builds for a single device can be shared with the other contexts.
+    SharedBuildCache::Build SharedBuild;
+    if (Devs.size() == 1)
+      SharedBuild = m_SharedBuilds.acquire(Devs[0], Img, SpecConsts,
+                                           CompileOpts + LinkOpts);
+
     // Device is not used when creating program from SPIRV, so passing only one
     // device is OK.
-    auto [NativePrg, DeviceCodeWasInCache] = getOrCreatePIProgram(
-        Img, Context, Devs[0], CompileOpts + LinkOpts, SpecConsts);
+    auto [NativePrg, DeviceCodeWasInCache] =
+        getOrCreatePIProgram(Img, Context, Devs[0], CompileOpts + LinkOpts,
+                             SpecConsts, SharedBuild.getBinary());
 
     if (!DeviceCodeWasInCache &&
         InputImpl->get_bin_image_ref()->supportsSpecConstants())
@@ -2266,10 +2562,11 @@ device_image_plain ProgramManager::build(const device_image_plain &DeviceImage,
     }
 
     ContextImpl->addDeviceGlobalInitializer(BuiltProgram.get(), Devs, &Img);
+    SharedBuild.complete(Devs[0], BuiltProgram.get());
 
     // Save program to persistent cache if it is not there
     if (!DeviceCodeWasInCache)
-      PersistentDeviceCodeCache::putItemToDisc(
+      PersistentDeviceCodeCache::putItemToDiscAsync(
           Devs[0], Img, SpecConsts, CompileOpts + LinkOpts, BuiltProgram.get());
 
     return BuiltProgram.release();
@@ -2305,6 +2602,7 @@ device_image_plain ProgramManager::build(const device_image_plain &DeviceImage,
   assert(BuildResult != nullptr && "Invalid build result");
 
   sycl::detail::pi::PiProgram ResProgram = BuildResult->Val;
+  Cache.registerProgramFetch(CacheKey, Img.getSize(), isEvictable(Img));
 
   // Cache supports key with once device only, but here we have multiple
   // devices a program is built for, so add the program to the cache for all
@@ -2344,11 +2642,13 @@ device_image_plain ProgramManager::build(const device_image_plain &DeviceImage,
 
 // When caching is enabled, the returned PiKernel will already have
 // its ref count incremented.
-std::tuple<sycl::detail::pi::PiKernel, std::mutex *, const KernelArgMask *>
+std::tuple<sycl::detail::pi::PiKernel, std::shared_ptr<CachedKernelMutex>,
+           const KernelArgMask *>
 ProgramManager::getOrCreateKernel(const context &Context,
                                   const std::string &KernelName,
                                   const property_list &PropList,
                                   sycl::detail::pi::PiProgram Program) {
+  registerDeferredImages();
 
   (void)PropList;
 
@@ -2397,9 +2697,11 @@ ProgramManager::getOrCreateKernel(const context &Context,
   // caller. In that case, we need to increase the ref count of the
   // kernel.
   Ctx->getPlugin()->call<PiApiKind::piKernelRetain>(BuildResult->Val.first);
-  return std::make_tuple(BuildResult->Val.first,
-                         &(BuildResult->MBuildResultMutex),
-                         BuildResult->Val.second);
+  return std::make_tuple(
+      BuildResult->Val.first,
+      std::shared_ptr<CachedKernelMutex>(BuildResult,
+                                         &BuildResult->MBuildResultMutex),
+      BuildResult->Val.second);
 }
 
 bool doesDevSupportDeviceRequirements(const device &Dev,
@@ -2878,11 +3180,14 @@ checkDevSupportDeviceRequirements(const device &Dev,
 } // namespace sycl
 
 extern "C" void __sycl_register_lib(pi_device_binaries desc) {
-  sycl::detail::ProgramManager::getInstance().addImages(desc);
+  sycl::detail::ProgramManager::getInstance().addDeferredImages(desc);
 }
 
 // Executed as a part of current module's (.exe, .dll) static initialization
 extern "C" void __sycl_unregister_lib(pi_device_binaries desc) {
-  (void)desc;
-  // TODO implement the function
+  // The pending persistent cache writes read the device images, which are
+  // unloaded along with the library.
+  sycl::detail::GlobalHandler::instance().flushPersistentCacheWriter();
+  // TODO unregister the images which were registered
+  sycl::detail::ProgramManager::getInstance().removeDeferredImages(desc);
 }
@@ -11,6 +11,7 @@
 #include <detail/device_global_map_entry.hpp>
 #include <detail/host_pipe_map_entry.hpp>
 #include <detail/kernel_arg_mask.hpp>
+#include <detail/shared_build_cache.hpp>
 #include <detail/spec_constant_impl.hpp>
 #include <sycl/detail/cg_types.hpp>
 #include <sycl/detail/common.hpp>
@@ -23,7 +24,10 @@
 #include <sycl/device.hpp>
 #include <sycl/kernel_bundle.hpp>
 
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <set>
@@ -67,6 +71,7 @@ using DeviceImplPtr = std::shared_ptr<device_impl>;
 class program_impl;
 class queue_impl;
 class event_impl;
+struct CachedKernelMutex;
 // DeviceLibExt is shared between sycl runtime and sycl-post-link tool.
 // If any update is made here, need to sync with DeviceLibExt definition
 // in llvm/tools/sycl-post-link/sycl-post-link.cpp
@@ -119,14 +124,18 @@ public:
   ///        image. This parameter is used  as a partial key in the cache and
   ///        has no effect if no cached device code binary is found in the
   ///        persistent cache.
+  /// \param SharedBinary The device code binary built by another context, if
+  ///        any, which is used instead of the persistent cache.
   /// \return A pair consisting of the PI program created with the corresponding
   ///         device code binary and a boolean that is true if the device code
-  ///         binary was found in the persistent cache and false otherwise.
+  ///         binary was found in the persistent cache or shared by another
+  ///         context and false otherwise.
   std::pair<sycl::detail::pi::PiProgram, bool>
   getOrCreatePIProgram(const RTDeviceBinaryImage &Img, const context &Context,
                        const device &Device,
                        const std::string &CompileAndLinkOptions,
-                       SerializedObj SpecConsts);
+                       SerializedObj SpecConsts,
+                       const std::vector<char> *SharedBinary = nullptr);
   /// Builds or retrieves from cache a program defining the kernel with given
   /// name.
   /// \param M identifies the OS module the kernel comes from (multiple OS
@@ -148,18 +157,28 @@ public:
                     const property_list &PropList,
                     bool JITCompilationIsRequired = false);
 
-  std::tuple<sycl::detail::pi::PiKernel, std::mutex *, const KernelArgMask *,
-             sycl::detail::pi::PiProgram>
+  /// \param KernelNameHash is the hash of KernelName computed at compile time,
+  /// or 0 if it is unknown, in which case it is computed here.
+  std::tuple<sycl::detail::pi::PiKernel, std::shared_ptr<CachedKernelMutex>,
+             const KernelArgMask *, sycl::detail::pi::PiProgram>
   getOrCreateKernel(const ContextImplPtr &ContextImpl,
                     const DeviceImplPtr &DeviceImpl,
                     const std::string &KernelName,
-                    const NDRDescT &NDRDesc = {});
+                    const NDRDescT &NDRDesc = {}, uint64_t KernelNameHash = 0);
 
   sycl::detail::pi::PiProgram
   getPiProgramFromPiKernel(sycl::detail::pi::PiKernel Kernel,
                            const ContextImplPtr Context);
 
+  /// Registers the images of a binary, which must be done before they are
+  /// used.
   void addImages(pi_device_binaries DeviceImages);
+  /// Records the images of a library loaded by the application. They are only
+  /// registered once the program manager is first queried, so that loading
+  /// libraries whose kernels never run does not parse their images.
+  void addDeferredImages(pi_device_binaries DeviceImages);
+  /// Forgets the images of a library unloaded before they were registered.
+  void removeDeferredImages(pi_device_binaries DeviceImages);
   void debugPrintBinaryImages() const;
   static std::string
   getProgramBuildLog(const sycl::detail::pi::PiProgram &Program,
@@ -189,6 +208,14 @@ public:
   getEliminatedKernelArgMask(pi::PiProgram NativePrg,
                              const std::string &KernelName);
 
+  /// Returns the mask for eliminated kernel arguments for the requested kernel
+  /// within the device image, without the need for a program built from it.
+  /// \param Img the device image containing the kernel.
+  /// \param KernelName the name of the kernel.
+  const KernelArgMask *
+  getEliminatedKernelArgMask(const RTDeviceBinaryImage &Img,
+                             const std::string &KernelName);
+
   // The function returns the unique SYCL kernel identifier associated with a
   // kernel name.
   kernel_id getSYCLKernelID(const std::string &KernelName);
@@ -240,11 +267,27 @@ public:
       const context &Ctx, const std::vector<device> &Devs,
       bundle_state TargetState, const std::vector<kernel_id> &KernelIDs = {});
 
-  // Brind images in the passed vector to the required state. Does it inplace
+  // Brind images in the passed vector to the required state. Does it inplace.
   void
   bringSYCLDeviceImagesToState(std::vector<device_image_plain> &DeviceImages,
                                bundle_state TargetState);
 
+  // Builds all the device images compatible with at least one of the devices
+  // from Devs concurrently by the host task thread pool, which populates the
+  // in-memory and persistent program caches. The returned future becomes
+  // ready once all the images are built. The first build error is reported to
+  // the async handler of the context.
+  std::shared_future<void> preloadDeviceImages(const context &Ctx,
+                                               const std::vector<device> &Devs);
+
+  // Runs Build concurrently in the background. The runtime waits for it
+  // before its release, like for the preloading.
+  std::shared_future<void> startBackgroundBuild(std::function<void()> Build);
+
+  // Blocks until all the preloading started by preloadDeviceImages and the
+  // builds started by startBackgroundBuild are done.
+  void waitForPreloadedDeviceImages();
+
   // The function returns a vector of SYCL device images in required state,
   // which are compatible with at least one of the device from Devs.
   std::vector<device_image_plain>
@@ -285,7 +328,8 @@ public:
                            const std::vector<device> &Devs,
                            const property_list &PropList);
 
-  std::tuple<sycl::detail::pi::PiKernel, std::mutex *, const KernelArgMask *>
+  std::tuple<sycl::detail::pi::PiKernel, std::shared_ptr<CachedKernelMutex>,
+             const KernelArgMask *>
   getOrCreateKernel(const context &Context, const std::string &KernelName,
                     const property_list &PropList,
                     sycl::detail::pi::PiProgram Program);
@@ -293,9 +337,12 @@ public:
   ProgramManager();
   ~ProgramManager() = default;
 
-  bool kernelUsesAssert(const std::string &KernelName) const;
+  bool kernelUsesAssert(const std::string &KernelName);
 
-  bool kernelUsesAsan() const { return m_AsanFoundInImage; }
+  bool kernelUsesAsan() {
+    registerDeferredImages();
+    return m_AsanFoundInImage;
+  }
 
   std::set<RTDeviceBinaryImage *>
   getRawDeviceImages(const std::vector<kernel_id> &KernelIDs);
@@ -304,6 +351,19 @@ private:
   ProgramManager(ProgramManager const &) = delete;
   ProgramManager &operator=(ProgramManager const &) = delete;
 
+  /// Registers the images of a binary.
+  void registerImages(pi_device_binaries DeviceImages);
+  /// Registers the deferred images. Must be called by the queries of the
+  /// registered images before taking any other lock.
+  void registerDeferredImages();
+
+  void bringSYCLDeviceImageToState(device_image_plain &DeviceImage,
+                                   bundle_state TargetState);
+
+  /// Records a background build, which is waited for by
+  /// waitForPreloadedDeviceImages.
+  void addBackgroundBuild(const std::shared_future<void> &Done);
+
   using ProgramPtr =
       std::unique_ptr<remove_pointer_t<sycl::detail::pi::PiProgram>,
                       decltype(&::piProgramRelease)>;
@@ -408,6 +468,15 @@ private:
   // True iff there is a device image compiled with AddressSanitizer
   bool m_AsanFoundInImage;
 
+  /// Binaries added by addDeferredImages and not registered yet.
+  /// Access must be guarded by the m_DeferredImagesMutex mutex.
+  std::vector<pi_device_binaries> m_DeferredImages;
+  /// True iff m_DeferredImages may not be empty, so that the queries do not
+  /// take the mutex once all the images are registered.
+  std::atomic<bool> m_HasDeferredImages{false};
+  /// Held while the deferred images are registered, before the other mutexes.
+  std::mutex m_DeferredImagesMutex;
+
   // Maps between device_global identifiers and associated information.
   std::unordered_map<std::string, std::unique_ptr<DeviceGlobalMapEntry>>
       m_DeviceGlobals;
@@ -423,6 +492,15 @@ private:
 
   /// Protects m_HostPipes and m_Ptr2HostPipe.
   std::mutex m_HostPipesMutex;
+
+  /// Native binaries of the programs shared between the contexts.
+  SharedBuildCache m_SharedBuilds;
+
+  // Preloading and builds started by preloadDeviceImages and
+  // startBackgroundBuild.
+  std::vector<std::shared_future<void>> m_Preloads;
+  /// Protects m_Preloads.
+  std::mutex m_PreloadsMutex;
 };
 } // namespace detail
 } // namespace _V1
@@ -8,12 +8,16 @@
 
 #include <detail/event_impl.hpp>
 #include <detail/memory_manager.hpp>
+#include <detail/object_pool.hpp>
+#include <detail/program_manager/program_manager.hpp>
 #include <detail/queue_impl.hpp>
 #include <sycl/context.hpp>
 #include <sycl/detail/common.hpp>
 #include <sycl/detail/pi.hpp>
 #include <sycl/device.hpp>
+#include <sycl/usm.hpp>
 
+#include <algorithm>
 #include <cstring>
 #include <utility>
 
@@ -28,6 +32,16 @@ inline namespace _V1 {
 namespace detail {
 std::atomic<unsigned long long> queue_impl::MNextAvailableQueueID = 0;
 
+// Number of queues in GlobalHandler::getQueuesWithDeferredFlushes(), used to
+// skip locking the list when it is empty.
+static std::atomic<size_t> NumQueuesWithDeferredFlushes = 0;
+
+// Size from which the copies of the queues with the split_large_copies
+// property are split, unless SYCL_COPY_SPLIT_THRESHOLD is set.
+static constexpr size_t DefaultCopySplitThreshold = 64 * 1024 * 1024;
+// Number of native queues the chunks of the split copies are spread across.
+static constexpr size_t NumCopySubQueues = 4;
+
 static std::vector<sycl::detail::pi::PiEvent>
 getPIEvents(const std::vector<sycl::event> &DepEvents) {
   std::vector<sycl::detail::pi::PiEvent> RetPiEvents;
@@ -95,7 +109,7 @@ queue_impl::get_backend_info<info::device::backend_version>() const {
 
 static event prepareSYCLEventAssociatedWithQueue(
     const std::shared_ptr<detail::queue_impl> &QueueImpl) {
-  auto EventImpl = std::make_shared<detail::event_impl>(QueueImpl);
+  auto EventImpl = makeSharedPooled<detail::event_impl>(QueueImpl);
   EventImpl->setContextImpl(detail::getSyclObjImpl(QueueImpl->get_context()));
   EventImpl->setStateIncomplete();
   return detail::createSyclObjFromImpl<event>(EventImpl);
@@ -158,10 +172,16 @@ event queue_impl::memset(const std::shared_ptr<detail::queue_impl> &Self,
   PrepareNotify.scopedNotify((uint16_t)xpti::trace_point_type_t::task_begin);
 #endif
 
-  return submitMemOpHelper(
-      Self, DepEvents, [&](handler &CGH) { CGH.memset(Ptr, Value, Count); },
-      [](const auto &...Args) { MemoryManager::fill_usm(Args...); }, Ptr, Self,
-      Count, Value);
+  auto HandlerFunc = [&](handler &CGH) { CGH.memset(Ptr, Value, Count); };
+  auto MemMngrFunc = [](const auto &...Args) {
+    MemoryManager::fill_usm(Args...);
+  };
+  if (isHostMemOp(Count, {Ptr}))
+    return submitMemOpHelper(
+        Self, DepEvents, HandlerFunc, MemMngrFunc,
+        [&]() { std::memset(Ptr, Value, Count); }, Ptr, Self, Count, Value);
+  return submitMemOpHelper(Self, DepEvents, HandlerFunc, MemMngrFunc, nullptr,
+                           Ptr, Self, Count, Value);
 }
 
 void report(const code_location &CodeLoc) {
@@ -210,10 +230,96 @@ event queue_impl::memcpy(const std::shared_ptr<detail::queue_impl> &Self,
     throw runtime_error("NULL pointer argument in memory copy operation.",
                         PI_ERROR_INVALID_VALUE);
   }
-  return submitMemOpHelper(
-      Self, DepEvents, [&](handler &CGH) { CGH.memcpy(Dest, Src, Count); },
-      [](const auto &...Args) { MemoryManager::copy_usm(Args...); }, Src, Self,
-      Count, Dest);
+  auto HandlerFunc = [&](handler &CGH) { CGH.memcpy(Dest, Src, Count); };
+  auto MemMngrFunc = [](const auto &...Args) {
+    MemoryManager::copy_usm(Args...);
+  };
+  if (isHostMemOp(Count, {Dest, Src}))
+    return submitMemOpHelper(
+        Self, DepEvents, HandlerFunc, MemMngrFunc,
+        [&]() { std::memcpy(Dest, Src, Count); }, Src, Self, Count, Dest);
+  return submitMemOpHelper(Self, DepEvents, HandlerFunc, MemMngrFunc, nullptr,
+                           Src, Self, Count, Dest);
+}
+
+bool queue_impl::isHostMemOp(size_t Count,
+                             std::initializer_list<const void *> Ptrs) const {
+  if (Count == 0 || Count > SYCLConfig<SYCL_HOST_MEMOP_THRESHOLD>::get() ||
+      MHostQueue)
+    return false;
+  context Ctx = createSyclObjFromImpl<context>(MContext);
+  return std::all_of(Ptrs.begin(), Ptrs.end(), [&](const void *Ptr) {
+    usm::alloc Kind = sycl::get_pointer_type(Ptr, Ctx);
+    return Kind == usm::alloc::host || Kind == usm::alloc::unknown;
+  });
+}
+
+bool queue_impl::canRunMemOpOnHost(const std::vector<event> &DepEvents) const {
+  // The operations enqueued without an event or with a discarded one cannot
+  // be checked, and a host operation has no profiling information.
+  if (MDiscardEvents || MIsProfilingEnabled || MHasEventlessSubmission)
+    return false;
+  return std::all_of(DepEvents.begin(), DepEvents.end(),
+                     [](const event &Event) {
+                       return getSyclObjImpl(Event)->isCompleted();
+                     });
+}
+
+size_t queue_impl::getCopySplitThreshold() const {
+  if (MHostQueue || MEmulateOOO)
+    return 0;
+  if (size_t Threshold = SYCLConfig<SYCL_COPY_SPLIT_THRESHOLD>::get())
+    return Threshold;
+  return has_property<
+             ext::oneapi::experimental::property::queue::split_large_copies>()
+             ? DefaultCopySplitThreshold
+             : 0;
+}
+
+const std::vector<sycl::detail::pi::PiQueue> &
+queue_impl::getCopySubQueues() {
+  std::lock_guard<std::mutex> Lock(MCopySubQueuesMutex);
+  if (MCopySubQueues.empty()) {
+    for (size_t I = 0; I < NumCopySubQueues; ++I)
+      MCopySubQueues.push_back(createQueue(QueueOrder::Ordered));
+  }
+  return MCopySubQueues;
+}
+
+const std::shared_ptr<queue_impl> &queue_impl::getBufferCopyQueue() {
+  std::call_once(MBufferCopyQueueFlag, [this]() {
+    // The copies of profiled queues are kept on them, so that the profiling
+    // info of their events is the one of the copy.
+    if (MHostQueue || MIsProfilingEnabled ||
+        !SYCLConfig<SYCL_BUFFER_COPY_QUEUE>::get())
+      return;
+    MBufferCopyQueue = std::make_shared<queue_impl>(
+        MDevice, MContext, MAsyncHandler,
+        property_list{property::queue::in_order()});
+  });
+  return MBufferCopyQueue;
+}
+
+const std::vector<std::shared_ptr<queue_impl>> &
+queue_impl::getComponentQueues() {
+  std::call_once(MComponentQueuesFlag, [this]() {
+    if (MHostQueue || !SYCLConfig<SYCL_COMPOSITE_IMPLICIT_SCALING>::get() ||
+        !MDevice->has(aspect::ext_oneapi_is_composite))
+      return;
+    std::vector<std::shared_ptr<queue_impl>> Queues;
+    for (const device &Component :
+         MDevice->get_info<
+             ext::oneapi::experimental::info::device::component_devices>()) {
+      DeviceImplPtr ComponentImpl = getSyclObjImpl(Component);
+      // The kernels are built for the devices of the context only.
+      if (!MContext->hasDevice(ComponentImpl))
+        return;
+      Queues.push_back(std::make_shared<queue_impl>(ComponentImpl, MContext,
+                                                    MAsyncHandler, MPropList));
+    }
+    MComponentQueues = std::move(Queues);
+  });
+  return MComponentQueues;
 }
 
 event queue_impl::mem_advise(const std::shared_ptr<detail::queue_impl> &Self,
@@ -223,14 +329,49 @@ event queue_impl::mem_advise(const std::shared_ptr<detail::queue_impl> &Self,
   return submitMemOpHelper(
       Self, DepEvents,
       [&](handler &CGH) { CGH.mem_advise(Ptr, Length, Advice); },
-      [](const auto &...Args) { MemoryManager::advise_usm(Args...); }, Ptr,
-      Self, Length, Advice);
+      [](const auto &...Args) { MemoryManager::advise_usm(Args...); }, nullptr,
+      Ptr, Self, Length, Advice);
+}
+
+void *queue_impl::getDeviceGlobalUSMPtr(const std::shared_ptr<queue_impl> &Self,
+                                        const void *DeviceGlobalPtr,
+                                        bool IsDeviceImageScope) {
+  // The copies recorded to a graph keep their device_global command type.
+  if (IsDeviceImageScope || MHostQueue || !MGraph.expired())
+    return nullptr;
+  {
+    std::lock_guard<std::mutex> Lock(MDeviceGlobalUSMPtrsMutex);
+    auto It = MDeviceGlobalUSMPtrs.find(DeviceGlobalPtr);
+    if (It != MDeviceGlobalUSMPtrs.end())
+      return It->second;
+  }
+
+  DeviceGlobalMapEntry *DGEntry =
+      ProgramManager::getInstance().getDeviceGlobalEntry(DeviceGlobalPtr);
+  if (!DGEntry || DGEntry->MIsDeviceImageScopeDecorated)
+    return nullptr;
+  DeviceGlobalUSMMem &USMMem = DGEntry->getOrAllocateDeviceGlobalUSM(Self);
+  // Until then, the copies wait for the initialization of the memory.
+  if (OwnedPiEvent InitEvent = USMMem.getInitEvent(getPlugin()))
+    return nullptr;
+
+  std::lock_guard<std::mutex> Lock(MDeviceGlobalUSMPtrsMutex);
+  MDeviceGlobalUSMPtrs.emplace(DeviceGlobalPtr, USMMem.getPtr());
+  return USMMem.getPtr();
 }
 
 event queue_impl::memcpyToDeviceGlobal(
     const std::shared_ptr<detail::queue_impl> &Self, void *DeviceGlobalPtr,
     const void *Src, bool IsDeviceImageScope, size_t NumBytes, size_t Offset,
     const std::vector<event> &DepEvents) {
+  if (void *USMPtr =
+          getDeviceGlobalUSMPtr(Self, DeviceGlobalPtr, IsDeviceImageScope)) {
+    void *Dest = static_cast<char *>(USMPtr) + Offset;
+    return submitMemOpHelper(
+        Self, DepEvents, [&](handler &CGH) { CGH.memcpy(Dest, Src, NumBytes); },
+        [](const auto &...Args) { MemoryManager::copy_usm(Args...); },
+        nullptr, Src, Self, NumBytes, Dest);
+  }
   return submitMemOpHelper(
       Self, DepEvents,
       [&](handler &CGH) {
@@ -240,13 +381,22 @@ event queue_impl::memcpyToDeviceGlobal(
       [](const auto &...Args) {
         MemoryManager::copy_to_device_global(Args...);
       },
-      DeviceGlobalPtr, IsDeviceImageScope, Self, NumBytes, Offset, Src);
+      nullptr, DeviceGlobalPtr, IsDeviceImageScope, Self, NumBytes, Offset,
+      Src);
 }
 
 event queue_impl::memcpyFromDeviceGlobal(
     const std::shared_ptr<detail::queue_impl> &Self, void *Dest,
     const void *DeviceGlobalPtr, bool IsDeviceImageScope, size_t NumBytes,
     size_t Offset, const std::vector<event> &DepEvents) {
+  if (void *USMPtr =
+          getDeviceGlobalUSMPtr(Self, DeviceGlobalPtr, IsDeviceImageScope)) {
+    const void *Src = static_cast<const char *>(USMPtr) + Offset;
+    return submitMemOpHelper(
+        Self, DepEvents, [&](handler &CGH) { CGH.memcpy(Dest, Src, NumBytes); },
+        [](const auto &...Args) { MemoryManager::copy_usm(Args...); },
+        nullptr, Src, Self, NumBytes, Dest);
+  }
   return submitMemOpHelper(
       Self, DepEvents,
       [&](handler &CGH) {
@@ -256,7 +406,8 @@ event queue_impl::memcpyFromDeviceGlobal(
       [](const auto &...Args) {
         MemoryManager::copy_from_device_global(Args...);
       },
-      DeviceGlobalPtr, IsDeviceImageScope, Self, NumBytes, Offset, Dest);
+      nullptr, DeviceGlobalPtr, IsDeviceImageScope, Self, NumBytes, Offset,
+      Dest);
 }
 
 event queue_impl::getLastEvent() {
@@ -265,11 +416,124 @@ event queue_impl::getLastEvent() {
     return createDiscardedEvent();
   if (!MGraph.expired() && MGraphLastEventPtr)
     return detail::createSyclObjFromImpl<event>(MGraphLastEventPtr);
+  if (MHasEventlessSubmission) {
+    MLastEventPtr = insertMarkerEvent();
+    MHasEventlessSubmission = false;
+  }
   if (!MLastEventPtr)
     MLastEventPtr = std::make_shared<event_impl>(std::nullopt);
   return detail::createSyclObjFromImpl<event>(MLastEventPtr);
 }
 
+EventImplPtr queue_impl::insertMarkerEvent() {
+  auto Marker = std::make_shared<event_impl>(std::nullopt);
+  Marker->setContextImpl(MContext);
+  Marker->setStateIncomplete();
+  getPlugin()->call<PiApiKind::piEnqueueEventsWaitWithBarrier>(
+      getHandleRef(), 0, nullptr, &Marker->getHandleRef());
+  return Marker;
+}
+
+void queue_impl::syncEventlessSubmissions() {
+  std::lock_guard<std::mutex> Lock{MMutex};
+  if (!MHasEventlessSubmission)
+    return;
+  MLastEventPtr = insertMarkerEvent();
+  MHasEventlessSubmission = false;
+}
+
+bool queue_impl::flushForCrossQueueDep(
+    const std::shared_ptr<queue_impl> &Self) {
+  const size_t BatchSize =
+      SYCLConfig<SYCL_CROSS_QUEUE_FLUSH_BATCH_SIZE>::get();
+  if (BatchSize <= 1) {
+    flushCrossQueueDeps("immediate");
+    return true;
+  }
+
+  const auto Now = std::chrono::steady_clock::now();
+  const char *Reason = nullptr;
+  bool AddEntry = false;
+  {
+    std::lock_guard<std::mutex> Lock(MCrossQueueFlushMutex);
+    if (MDeferredCrossQueueFlushes++ == 0)
+      MFirstDeferredCrossQueueFlush = Now;
+    const std::chrono::microseconds Window =
+        SYCLConfig<SYCL_CROSS_QUEUE_FLUSH_WINDOW_US>::get();
+    if (MDeferredCrossQueueFlushes >= BatchSize)
+      Reason = "batch_full";
+    else if (Window.count() != 0 &&
+             Now - MFirstDeferredCrossQueueFlush >= Window)
+      Reason = "time_window";
+
+    if (Reason) {
+      MDeferredCrossQueueFlushes = 0;
+    } else if (!MHasDeferredCrossQueueFlushEntry) {
+      MHasDeferredCrossQueueFlushEntry = true;
+      AddEntry = true;
+    }
+  }
+
+  if (Reason) {
+    flushCrossQueueDeps(Reason);
+    return true;
+  }
+  if (AddEntry) {
+    GlobalHandler &Handler = GlobalHandler::instance();
+    std::lock_guard<std::mutex> Lock(
+        Handler.getQueuesWithDeferredFlushesMutex());
+    Handler.getQueuesWithDeferredFlushes().push_back(Self);
+    NumQueuesWithDeferredFlushes++;
+  }
+  return false;
+}
+
+void queue_impl::flushDeferredCrossQueueDeps() {
+  if (NumQueuesWithDeferredFlushes.load() == 0)
+    return;
+
+  std::vector<std::weak_ptr<queue_impl>> Queues;
+  {
+    GlobalHandler &Handler = GlobalHandler::instance();
+    std::lock_guard<std::mutex> Lock(
+        Handler.getQueuesWithDeferredFlushesMutex());
+    Queues.swap(Handler.getQueuesWithDeferredFlushes());
+    NumQueuesWithDeferredFlushes -= Queues.size();
+  }
+
+  for (const std::weak_ptr<queue_impl> &QueueWeakPtr : Queues) {
+    // Released queues have been implicitly flushed by piQueueRelease.
+    std::shared_ptr<queue_impl> Queue = QueueWeakPtr.lock();
+    if (!Queue)
+      continue;
+    {
+      std::lock_guard<std::mutex> Lock(Queue->MCrossQueueFlushMutex);
+      Queue->MHasDeferredCrossQueueFlushEntry = false;
+      if (Queue->MDeferredCrossQueueFlushes == 0)
+        continue;
+      Queue->MDeferredCrossQueueFlushes = 0;
+    }
+    Queue->flushCrossQueueDeps("wait");
+  }
+}
+
+void queue_impl::flushCrossQueueDeps(const char *Reason) {
+  getPlugin()->call<PiApiKind::piQueueFlush>(getHandleRef());
+  MSubmissionsSinceFlush.store(0, std::memory_order_relaxed);
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+  constexpr uint16_t NotificationTraceType = xpti::trace_diagnostics;
+  if (MTraceEvent && xptiCheckTraceEnabled(MStreamID, NotificationTraceType)) {
+    std::string Message = std::string("cross_queue_flush:") + Reason;
+    xptiNotifySubscribers(MStreamID, NotificationTraceType, nullptr,
+                          static_cast<xpti::trace_event_data_t *>(MTraceEvent),
+                          MInstanceID,
+                          static_cast<const void *>(Message.c_str()));
+  }
+#else
+  (void)Reason;
+#endif
+}
+
 void queue_impl::addEvent(const event &Event) {
   EventImplPtr EImpl = getSyclObjImpl(Event);
   assert(EImpl && "Event implementation is missing");
@@ -280,6 +544,14 @@ void queue_impl::addEvent(const event &Event) {
     // unable to call piQueueFinish during wait.
     if (is_host() || MEmulateOOO)
       addSharedEvent(Event);
+    // Incomplete host events without a command belong to host tasks run
+    // without the scheduler. They are owned by the thread pool job until they
+    // complete and aren't covered by piQueueFinish.
+    else if (EImpl->is_host() && !EImpl->isCompleted()) {
+      std::weak_ptr<event_impl> EventWeakPtr{EImpl};
+      std::lock_guard<std::mutex> Lock{MMutex};
+      MEventsWeak.push_back(std::move(EventWeakPtr));
+    }
   }
   // As long as the queue supports piQueueFinish we only need to store events
   // for unenqueued commands and host tasks.
@@ -322,35 +594,37 @@ void queue_impl::addSharedEvent(const event &Event) {
   MEventsShared.push_back(Event);
 }
 
+bool isEventSafeForSchedulerBypass(const EventImplPtr &SyclEventImplPtr,
+                                   const ContextImplPtr &Context) {
+  // Events that don't have an initialized context are throwaway events that
+  // don't represent actual dependencies. Calling getContextImpl() would set
+  // their context, which we wish to avoid as it is expensive.
+  // NOP events also don't represent actual dependencies.
+  if ((!SyclEventImplPtr->isContextInitialized() &&
+       !SyclEventImplPtr->is_host()) ||
+      SyclEventImplPtr->isNOP()) {
+    return true;
+  }
+  if (SyclEventImplPtr->is_host()) {
+    return SyclEventImplPtr->isCompleted();
+  }
+  // Cross-context dependencies can't be passed to the backend directly.
+  if (SyclEventImplPtr->getContextImpl() != Context)
+    return false;
+
+  // A nullptr here means that the commmand does not produce a PI event or it
+  // hasn't been enqueued yet.
+  return SyclEventImplPtr->getHandleRef() != nullptr;
+}
+
 static bool
 areEventsSafeForSchedulerBypass(const std::vector<sycl::event> &DepEvents,
                                 ContextImplPtr Context) {
-  auto CheckEvent = [&Context](const sycl::event &Event) {
-    const EventImplPtr &SyclEventImplPtr = detail::getSyclObjImpl(Event);
-    // Events that don't have an initialized context are throwaway events that
-    // don't represent actual dependencies. Calling getContextImpl() would set
-    // their context, which we wish to avoid as it is expensive.
-    // NOP events also don't represent actual dependencies.
-    if ((!SyclEventImplPtr->isContextInitialized() &&
-         !SyclEventImplPtr->is_host()) ||
-        SyclEventImplPtr->isNOP()) {
-      return true;
-    }
-    if (SyclEventImplPtr->is_host()) {
-      return SyclEventImplPtr->isCompleted();
-    }
-    // Cross-context dependencies can't be passed to the backend directly.
-    if (SyclEventImplPtr->getContextImpl() != Context)
-      return false;
-
-    // A nullptr here means that the commmand does not produce a PI event or it
-    // hasn't been enqueued yet.
-    return SyclEventImplPtr->getHandleRef() != nullptr;
-  };
-
-  return std::all_of(
-      DepEvents.begin(), DepEvents.end(),
-      [&CheckEvent](const sycl::event &Event) { return CheckEvent(Event); });
+  return std::all_of(DepEvents.begin(), DepEvents.end(),
+                     [&Context](const sycl::event &Event) {
+                       return isEventSafeForSchedulerBypass(
+                           detail::getSyclObjImpl(Event), Context);
+                     });
 }
 
 template <typename HandlerFuncT>
@@ -365,12 +639,18 @@ event queue_impl::submitWithHandler(const std::shared_ptr<queue_impl> &Self,
       Self, {});
 }
 
-template <typename HandlerFuncT, typename MemOpFuncT, typename... MemOpArgTs>
+template <typename HandlerFuncT, typename MemOpFuncT, typename HostMemOpFuncT,
+          typename... MemOpArgTs>
 event queue_impl::submitMemOpHelper(const std::shared_ptr<queue_impl> &Self,
                                     const std::vector<event> &DepEvents,
                                     HandlerFuncT HandlerFunc,
                                     MemOpFuncT MemOpFunc,
+                                    HostMemOpFuncT HostMemOpFunc,
                                     MemOpArgTs... MemOpArgs) {
+  // The operation must not overtake the kernels collected for fusion.
+  completeAutoFusion(Self);
+  interruptAutoGraph(Self);
+
   // We need to submit command and update the last event under same lock if we
   // have in-order queue.
   {
@@ -384,9 +664,19 @@ event queue_impl::submitMemOpHelper(const std::shared_ptr<queue_impl> &Self,
     // handler rather than by-passing the scheduler.
     if (MGraph.expired() &&
         areEventsSafeForSchedulerBypass(ExpandedDepEvents, MContext)) {
+      // A small operation on host memory with nothing to wait for is done
+      // right away, its previous commands in the queue order are complete.
+      if constexpr (!std::is_same_v<HostMemOpFuncT, std::nullptr_t>) {
+        if (canRunMemOpOnHost(ExpandedDepEvents)) {
+          HostMemOpFunc();
+          return event();
+        }
+      }
+
       if (MSupportsDiscardingPiEvents) {
         MemOpFunc(MemOpArgs..., getPIEvents(ExpandedDepEvents),
                   /*PiEvent*/ nullptr, /*EventImplPtr*/ nullptr);
+        countSubmission();
         return createDiscardedEvent();
       }
 
@@ -397,11 +687,14 @@ event queue_impl::submitMemOpHelper(const std::shared_ptr<queue_impl> &Self,
 
       if (MContext->is_host())
         return MDiscardEvents ? createDiscardedEvent() : event();
+      countSubmission();
 
       if (isInOrder()) {
         auto &EventToStoreIn =
             MGraph.expired() ? MLastEventPtr : MGraphLastEventPtr;
         EventToStoreIn = EventImpl;
+        if (MGraph.expired())
+          MInOrderSubmitted.fetch_add(1, std::memory_order_release);
       }
       // Track only if we won't be able to handle it with piQueueFinish.
       if (MEmulateOOO)
@@ -412,6 +705,29 @@ event queue_impl::submitMemOpHelper(const std::shared_ptr<queue_impl> &Self,
   return submitWithHandler(Self, DepEvents, HandlerFunc);
 }
 
+std::vector<event>
+queue_impl::submitBatch(const std::vector<std::function<void(handler &)>> &CGFs,
+                        const std::shared_ptr<queue_impl> &Self,
+                        const detail::code_location &Loc,
+                        const SubmitPostProcessF *PostProcess) {
+  std::vector<event> Events;
+  Events.reserve(CGFs.size());
+
+  Scheduler &Sched = Scheduler::getInstance();
+  Sched.beginBatch();
+  try {
+    for (const std::function<void(handler &)> &CGF : CGFs)
+      Events.push_back(submit(CGF, Self, Loc, PostProcess));
+  } catch (...) {
+    // Enqueue what has been submitted so far, the commands are in the graph
+    // already.
+    Sched.flushBatch();
+    throw;
+  }
+  Sched.flushBatch();
+  return Events;
+}
+
 void *queue_impl::instrumentationProlog(const detail::code_location &CodeLoc,
                                         std::string &Name, int32_t StreamID,
                                         uint64_t &IId) {
@@ -506,7 +822,7 @@ void queue_impl::wait(const detail::code_location &CodeLoc) {
   void *TelemetryEvent = nullptr;
   uint64_t IId;
   std::string Name;
-  int32_t StreamID = xptiRegisterStream(SYCL_STREAM_NAME);
+  int32_t StreamID = getSYCLStreamID();
   TelemetryEvent = instrumentationProlog(CodeLoc, Name, StreamID, IId);
 #endif
 
@@ -516,19 +832,34 @@ void queue_impl::wait(const detail::code_location &CodeLoc) {
                           "recording to a command graph.");
   }
 
+  // Every command submitted to an in-order queue is tracked by the submission
+  // counter unless events are discarded, so nothing needs to be waited for if
+  // all of them are known to be complete. The counters are read under the
+  // lock along with the events, so that every event taken is counted.
+  const bool TracksSubmissions = isInOrder() && !MDiscardEvents && !is_host();
+  uint64_t Submitted = 0;
+  bool AllCompleted = false;
+
   std::vector<std::weak_ptr<event_impl>> WeakEvents;
   std::vector<event> SharedEvents;
   {
     std::lock_guard<std::mutex> Lock(MMutex);
     WeakEvents.swap(MEventsWeak);
     SharedEvents.swap(MEventsShared);
+    Submitted = MInOrderSubmitted.load(std::memory_order_relaxed);
+    AllCompleted =
+        TracksSubmissions &&
+        MInOrderCompleted.load(std::memory_order_acquire) == Submitted;
   }
   // If the queue is either a host one or does not support OOO (and we use
   // multiple in-order queues as a result of that), wait for each event
   // directly. Otherwise, only wait for unenqueued or host task events, starting
   // from the latest submitted task in order to minimize total amount of calls,
-  // then handle the rest with piQueueFinish.
+  // then handle the rest with piQueueFinish. In-order queues are ordered, so
+  // the tracked events are complete as well if all the submissions are.
   const bool SupportsPiFinish = !is_host() && !MEmulateOOO;
+  if (AllCompleted)
+    WeakEvents.clear();
   for (auto EventImplWeakPtrIt = WeakEvents.rbegin();
        EventImplWeakPtrIt != WeakEvents.rend(); ++EventImplWeakPtrIt) {
     if (std::shared_ptr<event_impl> EventImplSharedPtr =
@@ -540,7 +871,11 @@ void queue_impl::wait(const detail::code_location &CodeLoc) {
       }
     }
   }
-  if (SupportsPiFinish) {
+  if (AllCompleted) {
+    // Nothing to wait for.
+  } else if (SupportsPiFinish) {
+    // The commands of this queue may depend on the ones of other queues.
+    flushDeferredCrossQueueDeps();
     const PluginPtr &Plugin = getPlugin();
     Plugin->call<detail::PiApiKind::piQueueFinish>(getHandleRef());
     assert(SharedEvents.empty() && "Queues that support calling piQueueFinish "
@@ -549,6 +884,8 @@ void queue_impl::wait(const detail::code_location &CodeLoc) {
     for (event &Event : SharedEvents)
       Event.wait();
   }
+  if (TracksSubmissions)
+    markInOrderCompleted(Submitted);
 
   std::vector<EventImplPtr> StreamsServiceEvents;
   {
@@ -578,6 +915,189 @@ pi_native_handle queue_impl::getNative(int32_t &NativeHandleDesc) const {
   return Handle;
 }
 
+void queue_impl::startAutoFusion(const std::shared_ptr<queue_impl> &Self,
+                                 bool IsKernel) {
+  if (!IsKernel || !MGraph.expired()) {
+    completeAutoFusion(Self);
+    return;
+  }
+  std::lock_guard<std::mutex> Lock(MAutoFusionMutex);
+  // The previous fusion may have been cancelled by a synchronization.
+  if (!is_in_fusion_mode()) {
+    detail::Scheduler::getInstance().startFusion(Self);
+    MAutoFusedKernels = 0;
+  }
+}
+
+void queue_impl::countAutoFusedKernel(const std::shared_ptr<queue_impl> &Self) {
+  {
+    std::lock_guard<std::mutex> Lock(MAutoFusionMutex);
+    if (!is_in_fusion_mode() || ++MAutoFusedKernels < MAutoFusionMaxKernels)
+      return;
+  }
+  completeAutoFusion(Self);
+}
+
+void queue_impl::completeAutoFusion(const std::shared_ptr<queue_impl> &Self) {
+  if (MAutoFusionMaxKernels == 0)
+    return;
+  std::lock_guard<std::mutex> Lock(MAutoFusionMutex);
+  if (!is_in_fusion_mode())
+    return;
+  // A single kernel is not worth the JIT compilation.
+  if (MAutoFusedKernels > 1)
+    detail::Scheduler::getInstance().completeFusion(Self, {});
+  else
+    detail::Scheduler::getInstance().cancelFusion(Self);
+  MAutoFusedKernels = 0;
+}
+
+// Set while an auto_graph queue submits its executable graph, which must not
+// break the current sequence of kernels.
+static thread_local bool InAutoGraphReplay = false;
+
+bool queue_impl::startAutoGraphSubmission(
+    const std::shared_ptr<queue_impl> &Self, handler &Handler,
+    bool NeedsPostProcess) {
+  if (InAutoGraphReplay)
+    return false;
+  // The kernels of the queue are in order, a dependency on a recorded one is
+  // satisfied by the order of the queue once the recording is run.
+  std::vector<EventImplPtr> &Events = Handler.CGData.MEvents;
+  Events.erase(std::remove_if(Events.begin(), Events.end(),
+                              [&](const EventImplPtr &Event) {
+                                return Event->getAutoGraphQueue() == Self;
+                              }),
+               Events.end());
+  if (Handler.getType() != CG::Kernel || NeedsPostProcess || !Events.empty() ||
+      !Handler.CGData.MRequirements.empty() ||
+      !Handler.MStreamStorage.empty() ||
+      (Handler.MKernel && Handler.MKernel->isInterop())) {
+    interruptAutoGraph(Self);
+    return false;
+  }
+
+  // Kernels with the same fingerprint only differ by the values of their
+  // arguments, which the executable graph is updated with.
+  const NDRDescT &NDRDesc = Handler.MNDRDesc;
+  std::string Fingerprint = Handler.MKernelName.c_str();
+  auto Append = [&](const auto &Value) {
+    Fingerprint.append(reinterpret_cast<const char *>(&Value), sizeof(Value));
+  };
+  Fingerprint.push_back('\0');
+  Append(NDRDesc.Dims);
+  for (int I = 0; I < 3; ++I) {
+    Append(NDRDesc.GlobalSize[I]);
+    Append(NDRDesc.LocalSize[I]);
+    Append(NDRDesc.GlobalOffset[I]);
+    Append(NDRDesc.NumWorkGroups[I]);
+  }
+  for (const ArgDesc &Arg : Handler.MArgs) {
+    Append(Arg.MType);
+    Append(Arg.MSize);
+    Append(Arg.MIndex);
+  }
+
+  std::lock_guard<std::mutex> Lock(MAutoGraphMutex);
+  if (!MAutoGraphSequenceValid)
+    return false;
+  const size_t Pos = MAutoGraphSequence.size();
+  MAutoGraphSequence.push_back(std::move(Fingerprint));
+  const bool Repeats = MAutoGraphRepeats >= MAutoGraphMinRepeats &&
+                       Pos < MAutoGraphPattern.size() &&
+                       MAutoGraphPattern[Pos] == MAutoGraphSequence.back();
+  if (MAutoGraphRecording && !Repeats)
+    stopAutoGraphRecording(Self, /*Complete=*/false);
+  if (!MAutoGraphRecording && Repeats && Pos == 0) {
+    MAutoGraphRecording =
+        std::make_shared<ext::oneapi::experimental::detail::graph_impl>(
+            createSyclObjFromImpl<context>(MContext),
+            createSyclObjFromImpl<device>(MDevice));
+    setCommandGraph(MAutoGraphRecording);
+    ext::oneapi::experimental::detail::graph_impl::WriteLock GraphLock(
+        MAutoGraphRecording->MMutex);
+    MAutoGraphRecording->addQueue(Self);
+  }
+  return MAutoGraphRecording != nullptr;
+}
+
+void queue_impl::stopAutoGraphRecording(const std::shared_ptr<queue_impl> &Self,
+                                        bool Complete) {
+  using ext::oneapi::experimental::command_graph;
+  using ext::oneapi::experimental::graph_state;
+  using GraphImplT = ext::oneapi::experimental::detail::graph_impl;
+  std::shared_ptr<GraphImplT> GraphImpl = std::move(MAutoGraphRecording);
+  setCommandGraph(nullptr);
+  {
+    GraphImplT::WriteLock GraphLock(GraphImpl->MMutex);
+    GraphImpl->removeQueue(Self);
+  }
+
+  auto Graph =
+      createSyclObjFromImpl<command_graph<graph_state::modifiable>>(GraphImpl);
+  std::optional<command_graph<graph_state::executable>> PartialExec;
+  if (!Complete) {
+    // The sequence no longer repeats the previous one.
+    PartialExec.emplace(Graph.finalize());
+    MAutoGraphRepeats = 0;
+    MAutoGraphExec.reset();
+  } else if (MAutoGraphExec) {
+    try {
+      MAutoGraphExec->update(Graph);
+    } catch (const sycl::exception &) {
+      MAutoGraphExec.emplace(Graph.finalize(
+          {ext::oneapi::experimental::property::graph::updatable{}}));
+    }
+  } else {
+    MAutoGraphExec.emplace(Graph.finalize(
+        {ext::oneapi::experimental::property::graph::updatable{}}));
+  }
+
+  command_graph<graph_state::executable> &Exec =
+      PartialExec ? *PartialExec : *MAutoGraphExec;
+  InAutoGraphReplay = true;
+  try {
+    submit([&](handler &CGH) { CGH.ext_oneapi_graph(Exec); }, Self, {});
+  } catch (...) {
+    InAutoGraphReplay = false;
+    throw;
+  }
+  InAutoGraphReplay = false;
+}
+
+void queue_impl::syncAutoGraph(const std::shared_ptr<queue_impl> &Self) {
+  if (MAutoGraphMinRepeats == 0 || InAutoGraphReplay)
+    return;
+  std::lock_guard<std::mutex> Lock(MAutoGraphMutex);
+  const bool Repeated =
+      MAutoGraphSequenceValid && MAutoGraphSequence == MAutoGraphPattern;
+  if (MAutoGraphRecording)
+    stopAutoGraphRecording(Self, Repeated);
+  if (Repeated) {
+    ++MAutoGraphRepeats;
+  } else if (!MAutoGraphSequenceValid) {
+    MAutoGraphPattern.clear();
+    MAutoGraphRepeats = 0;
+    MAutoGraphExec.reset();
+  } else if (!MAutoGraphSequence.empty()) {
+    MAutoGraphPattern = std::move(MAutoGraphSequence);
+    MAutoGraphRepeats = 1;
+    MAutoGraphExec.reset();
+  }
+  MAutoGraphSequence.clear();
+  MAutoGraphSequenceValid = true;
+}
+
+void queue_impl::interruptAutoGraph(const std::shared_ptr<queue_impl> &Self) {
+  if (MAutoGraphMinRepeats == 0 || InAutoGraphReplay)
+    return;
+  std::lock_guard<std::mutex> Lock(MAutoGraphMutex);
+  if (MAutoGraphRecording)
+    stopAutoGraphRecording(Self, /*Complete=*/false);
+  MAutoGraphSequence.clear();
+  MAutoGraphSequenceValid = false;
+}
+
 void queue_impl::cleanup_fusion_cmd() {
   // Clean up only if a scheduler instance exits.
   if (detail::Scheduler::isInstanceAlive())
@@ -588,14 +1108,35 @@ bool queue_impl::ext_oneapi_empty() const {
   // If we have in-order queue where events are not discarded then just check
   // the status of the last event.
   if (isInOrder() && !MDiscardEvents) {
-    std::lock_guard<std::mutex> Lock(MMutex);
-    return !MLastEventPtr ||
-           MLastEventPtr->get_info<info::event::command_execution_status>() ==
-               info::event_command_status::complete;
+    // Nothing has been submitted since the queue was last seen empty.
+    if (MInOrderCompleted.load(std::memory_order_acquire) ==
+        MInOrderSubmitted.load(std::memory_order_acquire))
+      return true;
+
+    EventImplPtr LastEvent;
+    uint64_t Submitted = 0;
+    bool HasEventlessSubmission = false;
+    {
+      std::lock_guard<std::mutex> Lock(MMutex);
+      LastEvent = MLastEventPtr;
+      Submitted = MInOrderSubmitted.load(std::memory_order_relaxed);
+      HasEventlessSubmission = MHasEventlessSubmission;
+    }
+    if (LastEvent &&
+        LastEvent->get_info<info::event::command_execution_status>() !=
+            info::event_command_status::complete)
+      return false;
+    // Commands enqueued without an event can only be checked by querying the
+    // backend queue.
+    if (!HasEventlessSubmission) {
+      markInOrderCompleted(Submitted);
+      return true;
+    }
   }
 
   // Check the status of the backend queue if this is not a host queue.
   if (!is_host()) {
+    flushDeferredCrossQueueDeps();
     pi_bool IsReady = false;
     getPlugin()->call<PiApiKind::piQueueGetInfo>(
         MQueues[0], PI_EXT_ONEAPI_QUEUE_INFO_EMPTY, sizeof(pi_bool), &IsReady,
@@ -14,8 +14,11 @@
 #include <detail/device_info.hpp>
 #include <detail/event_impl.hpp>
 #include <detail/global_handler.hpp>
+#include <detail/handler_impl.hpp>
 #include <detail/kernel_impl.hpp>
+#include <detail/metrics.hpp>
 #include <detail/plugin.hpp>
+#include <detail/reduction_autotuner.hpp>
 #include <detail/scheduler/scheduler.hpp>
 #include <detail/thread_pool.hpp>
 #include <sycl/context.hpp>
@@ -34,7 +37,14 @@
 
 #include "detail/graph_impl.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #ifdef XPTI_ENABLE_INSTRUMENTATION
 #include "xpti/xpti_trace_framework.hpp"
@@ -67,6 +77,14 @@ constexpr CUDAContextT DefaultContextType = CUDAContextT::custom;
 
 enum QueueOrder { Ordered, OOO };
 
+/// Checks if a command may be enqueued to the backend directly, bypassing the
+/// scheduler, while depending on the event passed.
+///
+/// \param Event is the dependency to check.
+/// \param Context is the context the command is submitted to.
+bool isEventSafeForSchedulerBypass(const EventImplPtr &Event,
+                                   const ContextImplPtr &Context);
+
 class queue_impl {
 public:
   // \return a default context for the platform if it includes the device
@@ -145,8 +163,45 @@ public:
             "Queue compute index must be a non-negative number less than "
             "device's number of available compute queue indices.");
     }
+    if (has_property<ext::intel::property::queue::submission_batch_size>()) {
+      MSubmissionBatchSize =
+          get_property<ext::intel::property::queue::submission_batch_size>()
+              .get_batch_size();
+      if (MSubmissionBatchSize == 0)
+        throw sycl::exception(make_error_code(errc::invalid),
+                              "Queue submission batch size must be a positive "
+                              "number.");
+    }
+    if (has_property<
+            ext::codeplay::experimental::property::queue::auto_fusion>()) {
+      MAutoFusionMaxKernels =
+          get_property<
+              ext::codeplay::experimental::property::queue::auto_fusion>()
+              .get_max_kernels();
+      if (MAutoFusionMaxKernels == 0)
+        throw sycl::exception(make_error_code(errc::invalid),
+                              "Queue auto fusion must fuse a positive number "
+                              "of kernels.");
+    }
     if (has_property<
-            ext::codeplay::experimental::property::queue::enable_fusion>() &&
+            ext::oneapi::experimental::property::queue::auto_graph>()) {
+      size_t MinRepeats =
+          get_property<ext::oneapi::experimental::property::queue::auto_graph>()
+              .get_min_repeats();
+      if (MinRepeats == 0)
+        throw sycl::exception(make_error_code(errc::invalid),
+                              "Queue auto graph must wait for a positive "
+                              "number of repeats.");
+      if (!MIsInorder)
+        throw sycl::exception(make_error_code(errc::invalid),
+                              "Queue auto graph requires an in-order queue.");
+      // The kernels are run as they are if graphs cannot be updated.
+      if (MDevice->has(aspect::ext_oneapi_graph))
+        MAutoGraphMinRepeats = MinRepeats;
+    }
+    if ((has_property<
+             ext::codeplay::experimental::property::queue::enable_fusion>() ||
+         MAutoFusionMaxKernels != 0) &&
         !MDevice->get_info<
             ext::codeplay::experimental::info::device::supports_fusion>()) {
       throw sycl::exception(
@@ -216,6 +271,20 @@ public:
 
   event getLastEvent();
 
+  /// Flushes the queue because a command submitted to another queue depends
+  /// on one of its commands, unless the flush can be coalesced with the
+  /// following ones according to SYCL_CROSS_QUEUE_FLUSH_BATCH_SIZE and
+  /// SYCL_CROSS_QUEUE_FLUSH_WINDOW_US.
+  ///
+  /// \param Self is a shared_ptr to this queue.
+  /// \return true if the queue has been flushed.
+  bool flushForCrossQueueDep(const std::shared_ptr<queue_impl> &Self);
+
+  /// Flushes all the queues whose flush for cross-queue dependencies has been
+  /// deferred. Must be called before waiting for or polling a device event, as
+  /// the event may depend on a command that hasn't been flushed yet.
+  static void flushDeferredCrossQueueDeps();
+
 private:
   void queue_impl_interop(sycl::detail::pi::PiQueue PiQueue) {
     if (has_property<ext::oneapi::property::queue::discard_events>() &&
@@ -339,6 +408,8 @@ public:
     if (!MHostQueue) {
       cleanup_fusion_cmd();
       getPlugin()->call<PiApiKind::piQueueRelease>(MQueues[0]);
+      for (sycl::detail::pi::PiQueue SubQueue : MCopySubQueues)
+        getPlugin()->call<PiApiKind::piQueueRelease>(SubQueue);
     }
   }
 
@@ -434,6 +505,39 @@ public:
     return discard_or_return(ResEvent);
   }
 
+  /// Submits a command group function object to the queue without returning
+  /// an event for it.
+  ///
+  /// Kernels submitted this way to an in-order queue are enqueued to the
+  /// backend without an output event when they can bypass the scheduler, and
+  /// no SYCL event is created for them.
+  ///
+  /// \param CGF is a function object containing command group.
+  /// \param Self is a shared_ptr to this queue.
+  /// \param Loc is the code location of the submit call (default argument)
+  void submit_without_event(const std::function<void(handler &)> &CGF,
+                            const std::shared_ptr<queue_impl> &Self,
+                            const detail::code_location &Loc) {
+    submit_impl(CGF, Self, Self, nullptr, Loc, nullptr,
+                /*CallerNeedsEvent=*/false);
+  }
+
+  /// Submits several command group function objects to the queue as a batch.
+  ///
+  /// The command groups are added to the scheduler graph one by one, but they
+  /// are enqueued to the backend together once all of them are built.
+  ///
+  /// \param CGFs are function objects containing the command groups.
+  /// \param Self is a shared_ptr to this queue.
+  /// \param Loc is the code location of the submit call.
+  /// \param PostProcess is an optional callback invoked for each command group.
+  /// \return events for the command groups, in the order of submission.
+  std::vector<event>
+  submitBatch(const std::vector<std::function<void(handler &)>> &CGFs,
+              const std::shared_ptr<queue_impl> &Self,
+              const detail::code_location &Loc,
+              const SubmitPostProcessF *PostProcess = nullptr);
+
   /// Performs a blocking wait for the completion of all enqueued tasks in the
   /// queue.
   ///
@@ -538,6 +642,16 @@ public:
       SubmissionSeen = true;
       CreationFlags |= PI_EXT_QUEUE_FLAG_SUBMISSION_IMMEDIATE;
     }
+    // A batch size asks for batched submission.
+    if (PropList.has_property<
+            ext::intel::property::queue::submission_batch_size>()) {
+      if (CreationFlags & PI_EXT_QUEUE_FLAG_SUBMISSION_IMMEDIATE) {
+        throw sycl::exception(
+            make_error_code(errc::invalid),
+            "Queue cannot be constructed with different submission modes.");
+      }
+      CreationFlags |= PI_EXT_QUEUE_FLAG_SUBMISSION_NO_IMMEDIATE;
+    }
     return CreationFlags;
   }
 
@@ -607,6 +721,26 @@ public:
     return *PIQ;
   }
 
+  /// \return the size from which the copies submitted to the queue are split
+  /// across several native queues, or 0 if they are not split.
+  size_t getCopySplitThreshold() const;
+
+  /// \return the native in-order queues the chunks of the split copies are
+  /// enqueued to, so that the backend can run them on different copy engines.
+  /// They are created on first use and are not retained.
+  const std::vector<sycl::detail::pi::PiQueue> &getCopySubQueues();
+
+  /// \return the in-order queue the memory moves of buffers between this
+  /// queue and the host or another queue of its context are enqueued to, or
+  /// nullptr if SYCL_BUFFER_COPY_QUEUE is not set. It is created on first use.
+  const std::shared_ptr<queue_impl> &getBufferCopyQueue();
+
+  /// \return the queues on the component devices of the composite device of
+  /// the queue, which the range kernels submitted to it are split across, or
+  /// none if SYCL_COMPOSITE_IMPLICIT_SCALING is not set or the components are
+  /// not in the context. They are created on first use.
+  const std::vector<std::shared_ptr<queue_impl>> &getComponentQueues();
+
   /// \return a raw PI queue handle. The returned handle is not retained. It
   /// is caller responsibility to make sure queue is still alive.
   sycl::detail::pi::PiQueue &getHandleRef() {
@@ -701,6 +835,18 @@ public:
             this));
   }
 
+  /// Completes the fusion of the kernels collected by an auto_fusion queue,
+  /// if any.
+  void completeAutoFusion(const std::shared_ptr<queue_impl> &Self);
+
+  /// Ends the current sequence of kernels of an auto_graph queue, the kernels
+  /// recorded in it are run; called before the queue is waited on.
+  void syncAutoGraph(const std::shared_ptr<queue_impl> &Self);
+
+  /// Ends the recording of an auto_graph queue before a command which cannot
+  /// be recorded, this command breaks the current sequence of kernels.
+  void interruptAutoGraph(const std::shared_ptr<queue_impl> &Self);
+
   event memcpyToDeviceGlobal(const std::shared_ptr<queue_impl> &Self,
                              void *DeviceGlobalPtr, const void *Src,
                              bool IsDeviceImageScope, size_t NumBytes,
@@ -728,6 +874,11 @@ public:
 
   unsigned long long getQueueID() { return MQueueID; }
 
+  /// \return the scheduling priority of the queue, 1 for priority_high, -1 for
+  /// priority_low and 0 otherwise. The scheduler releases blocked commands and
+  /// host tasks of higher priority queues first.
+  int getSchedulingPriority() const { return MSchedulingPriority; }
+
   void setExternalEvent(const event &Event) {
     std::lock_guard<std::mutex> Lock(MInOrderExternalEventMtx);
     MInOrderExternalEvent = Event;
@@ -752,7 +903,8 @@ protected:
 
   // template is needed for proper unit testing
   template <typename HandlerType = handler>
-  void finalizeHandler(HandlerType &Handler, event &EventRet) {
+  void finalizeHandler(HandlerType &Handler, event &EventRet,
+                       bool CallerNeedsEvent = true) {
     if (MIsInorder) {
       // Accessing and changing of an event isn't atomic operation.
       // Hence, here is the lock for thread-safety.
@@ -766,7 +918,12 @@ protected:
       //    Command.
       auto &EventToBuildDeps =
           MGraph.expired() ? MLastEventPtr : MGraphLastEventPtr;
-      if (EventToBuildDeps)
+      // Commands that don't need an event are ordered after the previous one
+      // by the backend queue if the latter has been enqueued already, which
+      // keeps them eligible for the scheduler bypass.
+      if (EventToBuildDeps &&
+          (CallerNeedsEvent ||
+           !isEventSafeForSchedulerBypass(EventToBuildDeps, MContext)))
         Handler.depends_on(
             createSyclObjFromImpl<sycl::event>(EventToBuildDeps));
 
@@ -778,7 +935,18 @@ protected:
         Handler.depends_on(*ExternalEvent);
 
       EventRet = Handler.finalize();
-      EventToBuildDeps = getSyclObjImpl(EventRet);
+      const EventImplPtr &EventImpl = getSyclObjImpl(EventRet);
+      if (!CallerNeedsEvent && !EventImpl->isContextInitialized()) {
+        // The command was enqueued without an event, the last event stays as
+        // is and a marker is enqueued if an event is needed later on.
+        MHasEventlessSubmission = true;
+      } else {
+        EventToBuildDeps = EventImpl;
+        if (MGraph.expired())
+          MHasEventlessSubmission = false;
+      }
+      if (MGraph.expired())
+        MInOrderSubmitted.fetch_add(1, std::memory_order_release);
     } else
       EventRet = Handler.finalize();
   }
@@ -793,13 +961,16 @@ protected:
   /// \param SecondaryQueue is a pointer to the secondary queue. This may be the
   ///        same as Self.
   /// \param Loc is the code location of the submit call (default argument)
+  /// \param CallerNeedsEvent is false if the returned event is not used.
   /// \return a SYCL event representing submitted command group.
   event submit_impl(const std::function<void(handler &)> &CGF,
                     const std::shared_ptr<queue_impl> &Self,
                     const std::shared_ptr<queue_impl> &PrimaryQueue,
                     const std::shared_ptr<queue_impl> &SecondaryQueue,
                     const detail::code_location &Loc,
-                    const SubmitPostProcessF *PostProcess) {
+                    const SubmitPostProcessF *PostProcess,
+                    bool CallerNeedsEvent = true) {
+    ScopedMetricTimer SubmitTimer{MetricKind::SubmitLatency};
     // Flag used to detect nested calls to submit and report an error.
     thread_local static bool PreventSubmit = false;
 
@@ -817,6 +988,7 @@ protected:
       CGF(Handler);
     } catch (...) {
       PreventSubmit = false;
+      reduction_autotuner::cancelSample();
       throw;
     }
     PreventSubmit = false;
@@ -825,8 +997,24 @@ protected:
     // Host and interop tasks, however, are not submitted to low-level runtimes
     // and require separate dependency management.
     const CG::CGTYPE Type = Handler.getType();
-    event Event = detail::createSyclObjFromImpl<event>(
-        std::make_shared<detail::event_impl>());
+    const bool AutoGraphRecorded =
+        MAutoGraphMinRepeats != 0 &&
+        startAutoGraphSubmission(Self, Handler, PostProcess != nullptr);
+    if (MAutoFusionMaxKernels != 0)
+      startAutoFusion(Self, Type == CG::Kernel);
+    // The event is always set by finalizeHandler, so don't allocate one here.
+    event Event = detail::createSyclObjFromImpl<event>(EventImplPtr{});
+
+    // Only in-order queues can drop the event of a command, as the backend
+    // queue orders it with respect to the following ones. Host tasks are
+    // handled by the runtime and need an event of the previous command.
+    const bool EventNeeded = CallerNeedsEvent || !MIsInorder ||
+                             MEmulateOOO || MHostQueue || !MGraph.expired() ||
+                             Type == CG::CodeplayHostTask;
+    if (!EventNeeded)
+      Handler.MImpl->MEventNeeded = false;
+    else if (Type == CG::CodeplayHostTask && MIsInorder)
+      syncEventlessSubmissions();
 
     if (PostProcess) {
       bool IsKernel = Type == CG::Kernel;
@@ -837,13 +1025,24 @@ protected:
         KernelUsesAssert = !(Handler.MKernel && Handler.MKernel->isInterop()) &&
                            ProgramManager::getInstance().kernelUsesAssert(
                                Handler.MKernelName.c_str());
-      finalizeHandler(Handler, Event);
+      finalizeHandler(Handler, Event, EventNeeded);
 
       (*PostProcess)(IsKernel, KernelUsesAssert, Event);
     } else
-      finalizeHandler(Handler, Event);
+      finalizeHandler(Handler, Event, EventNeeded);
+
+    if (MAutoFusionMaxKernels != 0 && Type == CG::Kernel)
+      countAutoFusedKernel(Self);
+    if (AutoGraphRecorded)
+      getSyclObjImpl(Event)->setAutoGraphQueue(Self);
+
+    // Autotuned reductions time their launch until it completes.
+    reduction_autotuner::finishSample(EventNeeded ? &Event : nullptr);
 
-    addEvent(Event);
+    // Commands enqueued without an event are covered by piQueueFinish.
+    if (EventNeeded || getSyclObjImpl(Event)->isContextInitialized())
+      addEvent(Event);
+    countSubmission();
     return Event;
   }
 
@@ -866,17 +1065,42 @@ protected:
   ///        handler.
   /// \param MemMngrFunc is a function that forwards its arguments to the
   ///        appropriate memory manager function.
+  /// \param HostMemOpFunc is a function that does the operation on the host,
+  ///        called instead of the memory manager if the operation has nothing
+  ///        to wait for, or nullptr if the operation must be enqueued.
   /// \param MemMngrArgs are all the arguments that need to be passed to memory
   ///        manager except the last three: dependencies, PI event and
   ///        EventImplPtr are filled out by this helper.
   /// \return an event representing the submitted operation.
   template <typename HandlerFuncT, typename MemMngrFuncT,
-            typename... MemMngrArgTs>
+            typename HostMemOpFuncT, typename... MemMngrArgTs>
   event submitMemOpHelper(const std::shared_ptr<queue_impl> &Self,
                           const std::vector<event> &DepEvents,
                           HandlerFuncT HandlerFunc, MemMngrFuncT MemMngrFunc,
+                          HostMemOpFuncT HostMemOpFunc,
                           MemMngrArgTs... MemOpArgs);
 
+  /// \return true if a memory operation of Count bytes accessing Ptrs can be
+  /// done on the host according to SYCL_HOST_MEMOP_THRESHOLD, i.e. none of
+  /// the pointers is a device or shared USM allocation.
+  bool isHostMemOp(size_t Count,
+                   std::initializer_list<const void *> Ptrs) const;
+
+  /// \return the USM memory of the device_global at DeviceGlobalPtr on the
+  /// device and context of the queue, so that it is copied to and from as
+  /// plain USM, or nullptr if the device_global is device image scoped or its
+  /// memory is not initialized yet. The memory is looked up once per queue,
+  /// and is freed with the context.
+  void *getDeviceGlobalUSMPtr(const std::shared_ptr<queue_impl> &Self,
+                              const void *DeviceGlobalPtr,
+                              bool IsDeviceImageScope);
+
+  /// \return true if a memory operation with the dependencies DepEvents,
+  /// extended with the last event of an in-order queue, would not wait for
+  /// anything, so that it can be done on the host right away. For in-order
+  /// queues, must be called under MMutex.
+  bool canRunMemOpOnHost(const std::vector<event> &DepEvents) const;
+
   // When instrumentation is enabled emits trace event for wait begin and
   // returns the telemetry event generated for the wait
   void *instrumentationProlog(const detail::code_location &CodeLoc,
@@ -898,6 +1122,17 @@ protected:
   /// \param Event is the event to be stored
   void addEvent(const event &Event);
 
+  /// Enqueues a barrier without dependencies to the in-order backend queue to
+  /// get an event for the commands submitted before it. Must be called with
+  /// MMutex locked.
+  ///
+  /// \return an event that completes with the previously enqueued commands.
+  EventImplPtr insertMarkerEvent();
+
+  /// Makes the last event of an in-order queue cover the commands submitted
+  /// to it without an event.
+  void syncEventlessSubmissions();
+
   /// Protects all the fields that can be changed by class' methods.
   mutable std::mutex MMutex;
 
@@ -914,12 +1149,35 @@ protected:
   exception_list MExceptions;
   const async_handler MAsyncHandler;
   const property_list MPropList;
+  /// Scheduling priority requested with the priority queue properties, see
+  /// getSchedulingPriority.
+  const int MSchedulingPriority =
+      MPropList.has_property<ext::oneapi::property::queue::priority_high>() ? 1
+      : MPropList.has_property<ext::oneapi::property::queue::priority_low>()
+          ? -1
+          : 0;
 
   /// List of queues created for FPGA device from a single SYCL queue.
   std::vector<sycl::detail::pi::PiQueue> MQueues;
   /// Iterator through MQueues.
   size_t MNextQueueIdx = 0;
 
+  /// Native queues the split copies are enqueued to, see getCopySubQueues.
+  std::vector<sycl::detail::pi::PiQueue> MCopySubQueues;
+  std::mutex MCopySubQueuesMutex;
+
+  /// See getDeviceGlobalUSMPtr.
+  std::unordered_map<const void *, void *> MDeviceGlobalUSMPtrs;
+  std::mutex MDeviceGlobalUSMPtrsMutex;
+
+  /// See getBufferCopyQueue.
+  std::shared_ptr<queue_impl> MBufferCopyQueue;
+  std::once_flag MBufferCopyQueueFlag;
+
+  /// Queues the range kernels are split across, see getComponentQueues.
+  std::vector<std::shared_ptr<queue_impl>> MComponentQueues;
+  std::once_flag MComponentQueuesFlag;
+
   const bool MHostQueue = false;
   /// Indicates that a native out-of-order queue could not be created and we
   /// need to emulate it with multiple native in-order queues.
@@ -932,9 +1190,103 @@ protected:
   // Track deps within graph commands separately.
   // Protected by common queue object mutex MMutex.
   EventImplPtr MGraphLastEventPtr;
+  // Set if commands were enqueued to the in-order queue without an event after
+  // MLastEventPtr. Protected by MMutex.
+  bool MHasEventlessSubmission = false;
+
+  // Number of commands submitted to an in-order queue outside of graph
+  // recording, the last of which is MLastEventPtr, and the number of them
+  // known to be complete. ext_oneapi_empty() and wait() return right away if
+  // the two are equal. MInOrderSubmitted is only modified under MMutex.
+  std::atomic<uint64_t> MInOrderSubmitted{0};
+  mutable std::atomic<uint64_t> MInOrderCompleted{0};
+
+  void markInOrderCompleted(uint64_t Submitted) const {
+    uint64_t Completed = MInOrderCompleted.load(std::memory_order_relaxed);
+    while (Completed < Submitted &&
+           !MInOrderCompleted.compare_exchange_weak(
+               Completed, Submitted, std::memory_order_release,
+               std::memory_order_relaxed))
+      ;
+  }
 
   const bool MIsInorder;
 
+  /// Flushes the backend queue and reports the reason to XPTI subscribers.
+  void flushCrossQueueDeps(const char *Reason);
+
+  /// Counts a command enqueued to the backend queue, and flushes the queue
+  /// when it has reached the submission_batch_size of the queue.
+  void countSubmission() {
+    if (MSubmissionBatchSize != 0 && !MHostQueue &&
+        MSubmissionsSinceFlush.fetch_add(1, std::memory_order_relaxed) + 1 >=
+            MSubmissionBatchSize) {
+      MSubmissionsSinceFlush.store(0, std::memory_order_relaxed);
+      getPlugin()->call<PiApiKind::piQueueFlush>(getHandleRef());
+    }
+  }
+
+  // Value of the submission_batch_size property, 0 if it is not set, and
+  // number of commands submitted since the backend queue was last flushed.
+  size_t MSubmissionBatchSize = 0;
+  std::atomic<size_t> MSubmissionsSinceFlush{0};
+
+  /// Prepares the submission of a command to an auto_fusion queue. A kernel is
+  /// added to the current fusion, which is started if needed, the fusion is
+  /// completed before any other command.
+  void startAutoFusion(const std::shared_ptr<queue_impl> &Self, bool IsKernel);
+
+  /// Counts a kernel added to the current fusion, and completes the fusion
+  /// when it has reached the max_kernels of the auto_fusion property.
+  void countAutoFusedKernel(const std::shared_ptr<queue_impl> &Self);
+
+  // Value of the auto_fusion property, 0 if it is not set, and number of
+  // kernels in the current fusion. Protected by MAutoFusionMutex.
+  size_t MAutoFusionMaxKernels = 0;
+  size_t MAutoFusedKernels = 0;
+  std::mutex MAutoFusionMutex;
+
+  /// Prepares the submission of a command to an auto_graph queue. A kernel
+  /// which can be recorded is added to the current sequence, and recorded if
+  /// this sequence repeats the previous one, any other command interrupts the
+  /// recording.
+  /// \param NeedsPostProcess is true if the kernel uses asserts.
+  /// \return true if the command is recorded.
+  bool startAutoGraphSubmission(const std::shared_ptr<queue_impl> &Self,
+                                handler &Handler, bool NeedsPostProcess);
+
+  /// Stops the recording of an auto_graph queue and runs the recorded kernels.
+  /// A complete sequence is run by the executable graph of the queue, which is
+  /// created or updated from the recorded one.
+  void stopAutoGraphRecording(const std::shared_ptr<queue_impl> &Self,
+                              bool Complete);
+
+  // Value of the auto_graph property, 0 if it is not set or the device does
+  // not support graphs. The kernels of a sequence are identified by their
+  // fingerprint, the last complete sequence has been submitted
+  // MAutoGraphRepeats times in a row. A sequence which has a command that
+  // cannot be recorded is invalid. Protected by MAutoGraphMutex.
+  size_t MAutoGraphMinRepeats = 0;
+  std::vector<std::string> MAutoGraphPattern;
+  size_t MAutoGraphRepeats = 0;
+  std::vector<std::string> MAutoGraphSequence;
+  bool MAutoGraphSequenceValid = true;
+  std::shared_ptr<ext::oneapi::experimental::detail::graph_impl>
+      MAutoGraphRecording;
+  std::optional<ext::oneapi::experimental::command_graph<
+      ext::oneapi::experimental::graph_state::executable>>
+      MAutoGraphExec;
+  std::mutex MAutoGraphMutex;
+
+  // Number of cross-queue dependencies on the commands of this queue that
+  // haven't been flushed yet, the time the first one was deferred and whether
+  // the queue is in the list of queues with deferred flushes. Protected by
+  // MCrossQueueFlushMutex, which is never held together with another lock.
+  std::mutex MCrossQueueFlushMutex;
+  size_t MDeferredCrossQueueFlushes = 0;
+  std::chrono::steady_clock::time_point MFirstDeferredCrossQueueFlush;
+  bool MHasDeferredCrossQueueFlushEntry = false;
+
   std::vector<EventImplPtr> MStreamsServiceEvents;
   std::mutex MStreamsServiceEventsMutex;
 
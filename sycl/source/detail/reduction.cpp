@@ -8,6 +8,7 @@
 
 #include <detail/config.hpp>
 #include <detail/queue_impl.hpp>
+#include <detail/reduction_autotuner.hpp>
 #include <sycl/reduction.hpp>
 
 namespace sycl {
@@ -165,6 +166,19 @@ __SYCL_EXPORT size_t reduGetPreferredWGSize(std::shared_ptr<queue_impl> &Queue,
   return reduGetMaxWGSize(Queue, LocalMemBytesPerWorkItem);
 }
 
+__SYCL_EXPORT int reduGetAutotunedStrategy(std::shared_ptr<queue_impl> &Queue,
+                                           const char *Key, size_t NWorkItems,
+                                           uint32_t Candidates) {
+  // Graphs extension explicit API uses a handler with no queue attached, and
+  // the launches recorded to a graph do not run when submitted, so they cannot
+  // be timed.
+  if (Queue == nullptr || Queue->is_host() || Queue->getCommandGraph())
+    return static_cast<int>(reduction::strategy::auto_select);
+  return reduction_autotuner::getInstance().selectStrategy(*Queue, Key,
+                                                           NWorkItems,
+                                                           Candidates);
+}
+
 } // namespace detail
 } // namespace _V1
 } // namespace sycl
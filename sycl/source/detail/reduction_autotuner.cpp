@@ -0,0 +1,164 @@
+//==------- reduction_autotuner.cpp - Autotuning of reduction strategies ---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/event_impl.hpp>
+#include <detail/persistent_device_code_cache.hpp>
+#include <detail/queue_impl.hpp>
+#include <detail/reduction_autotuner.hpp>
+#include <sycl/detail/reduction_forward.hpp>
+
+#include <fstream>
+#include <optional>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+
+namespace {
+/// The launch being timed on this thread.
+struct pending_sample {
+  /// The device is identified by its implementation object, which lives as
+  /// long as its platform.
+  const device_impl *MDevice;
+  std::string MKey;
+  int MStrategy;
+  std::chrono::steady_clock::time_point MStart;
+};
+
+thread_local std::optional<pending_sample> PendingSample;
+
+/// Launches whose work-item counts have the same bit width share a tuning.
+std::string getTuningKey(const char *Key, size_t NWorkItems) {
+  size_t Bucket = 0;
+  for (; NWorkItems; NWorkItems >>= 1)
+    ++Bucket;
+  return std::to_string(Bucket) + " " + Key;
+}
+} // namespace
+
+reduction_autotuner &reduction_autotuner::getInstance() {
+  static reduction_autotuner Instance;
+  return Instance;
+}
+
+reduction_autotuner::device_tunings &
+reduction_autotuner::getDeviceTunings(const device &Device) {
+  auto [It, Inserted] = MDevices.try_emplace(getSyclObjImpl(Device).get());
+  device_tunings &Tunings = It->second;
+  if (!Inserted)
+    return Tunings;
+
+  Tunings.MPath = PersistentDeviceCodeCache::getDeviceDataPath(
+      Device, "reduction_autotune");
+  if (Tunings.MPath.empty())
+    return Tunings;
+
+  // Each line holds a chosen strategy followed by the key of its tuning. A
+  // later line for the same key overrides an earlier one.
+  std::ifstream File{Tunings.MPath};
+  int Strategy;
+  std::string Key;
+  while (File >> Strategy && File.get() == ' ' && std::getline(File, Key))
+    if (Strategy > 0 && Strategy < 32)
+      Tunings.MTunings[Key].MStrategy = Strategy;
+  return Tunings;
+}
+
+int reduction_autotuner::selectStrategy(const queue_impl &Queue,
+                                        const char *Key, size_t NWorkItems,
+                                        uint32_t Candidates) {
+  device Device = Queue.get_device();
+  std::string TuningKey = getTuningKey(Key, NWorkItems);
+  std::lock_guard<std::mutex> Lock(MMutex);
+  device_tunings &Tunings = getDeviceTunings(Device);
+  tuning &Tuning = Tunings.MTunings[TuningKey];
+  // A strategy stored by a run with other candidates may not be usable.
+  if (Tuning.MStrategy >= 0 && (Candidates >> Tuning.MStrategy & 1))
+    return Tuning.MStrategy;
+  Tuning.MStrategy = -1;
+  Tuning.MCandidateMask = Candidates;
+
+  // Time the candidate with the fewest samples so far.
+  int Strategy = -1;
+  size_t MinSamples = SamplesPerCandidate;
+  for (int S = 0; S < 32; ++S) {
+    if (!(Candidates >> S & 1))
+      continue;
+    size_t NumSamples = Tuning.MCandidates[S].MNumSamples;
+    if (NumSamples < MinSamples) {
+      Strategy = S;
+      MinSamples = NumSamples;
+    }
+  }
+  if (Strategy < 0) {
+    tryChooseStrategy(Tunings, TuningKey, Tuning);
+    return Tuning.MStrategy >= 0
+               ? Tuning.MStrategy
+               : static_cast<int>(reduction::strategy::auto_select);
+  }
+
+  PendingSample = pending_sample{getSyclObjImpl(Device).get(),
+                                 std::move(TuningKey), Strategy,
+                                 std::chrono::steady_clock::now()};
+  return Strategy;
+}
+
+void reduction_autotuner::finishSample(event *Event) {
+  if (!PendingSample)
+    return;
+  pending_sample Sample = std::move(*PendingSample);
+  PendingSample.reset();
+  if (!Event)
+    return;
+
+  Event->wait();
+  getInstance().recordSample(Sample.MDevice, Sample.MKey, Sample.MStrategy,
+                             std::chrono::steady_clock::now() -
+                                 Sample.MStart);
+}
+
+void reduction_autotuner::cancelSample() { PendingSample.reset(); }
+
+void reduction_autotuner::recordSample(
+    const device_impl *Device, const std::string &Key, int Strategy,
+    std::chrono::steady_clock::duration Time) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  device_tunings &Tunings = MDevices[Device];
+  tuning &Tuning = Tunings.MTunings[Key];
+  candidate &Candidate = Tuning.MCandidates[Strategy];
+  ++Candidate.MNumSamples;
+  Candidate.MBestTime = std::min(Candidate.MBestTime, Time);
+  tryChooseStrategy(Tunings, Key, Tuning);
+}
+
+void reduction_autotuner::tryChooseStrategy(device_tunings &Tunings,
+                                            const std::string &Key,
+                                            tuning &Tuning) {
+  if (Tuning.MStrategy >= 0)
+    return;
+  int Best = -1;
+  for (int S = 0; S < 32; ++S) {
+    if (!(Tuning.MCandidateMask >> S & 1))
+      continue;
+    const candidate &Candidate = Tuning.MCandidates[S];
+    if (Candidate.MNumSamples < SamplesPerCandidate)
+      return;
+    if (Best < 0 || Candidate.MBestTime < Tuning.MCandidates[Best].MBestTime)
+      Best = S;
+  }
+  if (Best < 0)
+    return;
+
+  Tuning.MStrategy = Best;
+  if (!Tunings.MPath.empty())
+    std::ofstream(Tunings.MPath, std::ios::app) << Best << ' ' << Key << '\n';
+}
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
@@ -0,0 +1,96 @@
+//==------- reduction_autotuner.hpp - Autotuning of reduction strategies ---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sycl/device.hpp>
+#include <sycl/event.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+class device_impl;
+class queue_impl;
+
+/// Picks the strategy of the reductions over a sycl::range by timing each of
+/// the applicable strategies on the first launches of a reduction and keeping
+/// the fastest one. The launches are told apart by reduction and by order of
+/// magnitude of their range. When the persistent device code cache is
+/// enabled, the chosen strategies are stored next to it, so that the
+/// following runs of the application do not explore them again.
+class reduction_autotuner {
+public:
+  /// Number of launches timed with each candidate strategy. The fastest of
+  /// them is kept, so that the launch building the kernel is not held against
+  /// the strategy.
+  static constexpr size_t SamplesPerCandidate = 2;
+
+  static reduction_autotuner &getInstance();
+
+  /// \param Key identifies the reduction and its kernel.
+  /// \param NWorkItems is the size of the range of the launch.
+  /// \param Candidates is a bit mask of the reduction::strategy values which
+  /// can be used for the launch.
+  /// \return the strategy to use for the launch. If the candidates are still
+  /// being explored, the launch is timed until finishSample() is called.
+  int selectStrategy(const queue_impl &Queue, const char *Key,
+                     size_t NWorkItems, uint32_t Candidates);
+
+  /// Ends the timing of the launch started by selectStrategy() on this
+  /// thread, if any, by waiting for it to complete.
+  ///
+  /// \param Event is the event of the launch, or nullptr if the launch has no
+  /// event, in which case its timing is dropped.
+  static void finishSample(event *Event);
+
+  /// Drops the timing started on this thread, e.g. if the submission of the
+  /// launch failed.
+  static void cancelSample();
+
+private:
+  struct candidate {
+    size_t MNumSamples = 0;
+    std::chrono::steady_clock::duration MBestTime =
+        std::chrono::steady_clock::duration::max();
+  };
+
+  struct tuning {
+    /// The chosen strategy, or -1 while the candidates are explored.
+    int MStrategy = -1;
+    uint32_t MCandidateMask = 0;
+    std::map<int, candidate> MCandidates;
+  };
+
+  struct device_tunings {
+    /// File storing the strategies chosen for the device, or an empty string
+    /// if they are not persisted.
+    std::string MPath;
+    std::map<std::string, tuning> MTunings;
+  };
+
+  device_tunings &getDeviceTunings(const device &Device);
+  void recordSample(const device_impl *Device, const std::string &Key,
+                    int Strategy, std::chrono::steady_clock::duration Time);
+  /// Chooses the fastest candidate of Tuning if they have all been timed.
+  void tryChooseStrategy(device_tunings &Tunings, const std::string &Key,
+                         tuning &Tuning);
+
+  std::map<const device_impl *, device_tunings> MDevices;
+  std::mutex MMutex;
+};
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
@@ -15,6 +15,7 @@
 #include <detail/kernel_impl.hpp>
 #include <detail/kernel_info.hpp>
 #include <detail/memory_manager.hpp>
+#include <detail/metrics.hpp>
 #include <detail/program_impl.hpp>
 #include <detail/program_manager/program_manager.hpp>
 #include <detail/queue_impl.hpp>
@@ -27,8 +28,13 @@
 #include <sycl/backend_types.hpp>
 #include <sycl/detail/cg_types.hpp>
 #include <sycl/detail/kernel_desc.hpp>
+#include <sycl/feature_test.hpp>
 #include <sycl/sampler.hpp>
+#if SYCL_EXT_CODEPLAY_KERNEL_FUSION
+#include <detail/jit_compiler.hpp>
+#endif
 
+#include <algorithm>
 #include <cassert>
 #include <optional>
 #include <string>
@@ -115,12 +121,13 @@ void applyFuncOnFilteredArgs(
       Func(Arg, Arg.MIndex);
     }
   } else {
-    // TODO this is not necessary as long as we can guarantee that the
-    // arguments are already sorted (e. g. handle the sorting in handler
-    // if necessary due to set_arg(...) usage).
-    std::sort(Args.begin(), Args.end(), [](const ArgDesc &A, const ArgDesc &B) {
+    // The arguments are only out of order if some of them are set on the
+    // user side, e.g. with set_arg(...).
+    auto ByIndex = [](const ArgDesc &A, const ArgDesc &B) {
       return A.MIndex < B.MIndex;
-    });
+    };
+    if (!std::is_sorted(Args.begin(), Args.end(), ByIndex))
+      std::sort(Args.begin(), Args.end(), ByIndex);
     int LastIndex = -1;
     size_t NextTrueIndex = 0;
 
@@ -334,6 +341,7 @@ class DispatchHostTask {
     // 'sleep' until all of dependency events are complete. We need a bit more
     // sophisticated waiting mechanism to allow to utilize this thread for any
     // other available job and resume once all required events are ready.
+    queue_impl::flushDeferredCrossQueueDeps();
     for (auto &PluginWithEvents : RequiredEventsPerPlugin) {
       std::vector<sycl::detail::pi::PiEvent> RawEvents =
           MThisCmd->getPiEvents(PluginWithEvents.second);
@@ -395,6 +403,7 @@ public:
     }
 
     try {
+      ScopedMetricTimer HostTaskTimer{MetricKind::HostTask};
       // we're ready to call the user-defined lambda now
       if (HostTask.MHostTask->isInteropTask()) {
         interop_handle IH{MReqToMem, HostTask.MQueue,
@@ -478,6 +487,7 @@ void Command::waitForEvents(QueueImplPtr Queue,
         RequiredEventsPerContext[Context.get()].push_back(Event);
       }
 
+      queue_impl::flushDeferredCrossQueueDeps();
       for (auto &CtxWithEvents : RequiredEventsPerContext) {
         std::vector<sycl::detail::pi::PiEvent> RawEvents =
             getPiEvents(CtxWithEvents.second);
@@ -512,7 +522,7 @@ Command::Command(
     sycl::detail::pi::PiExtCommandBuffer CommandBuffer,
     const std::vector<sycl::detail::pi::PiExtSyncPoint> &SyncPoints)
     : MQueue(std::move(Queue)),
-      MEvent(std::make_shared<detail::event_impl>(MQueue)),
+      MEvent(makeSharedPooled<detail::event_impl>(MQueue)),
       MPreparedDepsEvents(MEvent->getPreparedDepsEvents()),
       MPreparedHostDepsEvents(MEvent->getPreparedHostDepsEvents()), MType(Type),
       MCommandBuffer(CommandBuffer), MSyncPointDeps(SyncPoints) {
@@ -528,7 +538,7 @@ Command::Command(
   if (!xptiTraceEnabled())
     return;
   // Obtain the stream ID so all commands can emit traces to that stream
-  MStreamID = xptiRegisterStream(SYCL_STREAM_NAME);
+  MStreamID = getSYCLStreamID();
 #endif
 }
 
@@ -717,10 +727,17 @@ Command *Command::processDepEvent(EventImplPtr DepEvent, const DepDesc &Dep,
   if (auto *DepCmd = static_cast<Command *>(DepEvent->getCommand()))
     PiEventExpected &= DepCmd->producesPiEvent();
 
+  // The event of a command is a dependency for each requirement shared with
+  // it, it is only waited for once.
+  auto IsPrepared = [&DepEvent](const std::vector<EventImplPtr> &Events) {
+    return std::find(Events.begin(), Events.end(), DepEvent) != Events.end();
+  };
+
   if (!PiEventExpected) {
     // call to waitInternal() is in waitForPreparedHostEvents() as it's called
     // from enqueue process functions
-    MPreparedHostDepsEvents.push_back(DepEvent);
+    if (!IsPrepared(MPreparedHostDepsEvents))
+      MPreparedHostDepsEvents.push_back(DepEvent);
     return nullptr;
   }
 
@@ -731,7 +748,7 @@ Command *Command::processDepEvent(EventImplPtr DepEvent, const DepDesc &Dep,
   if (DepEventContext != WorkerContext && !WorkerContext->is_host()) {
     Scheduler::GraphBuilder &GB = Scheduler::getInstance().MGraphBuilder;
     ConnectionCmd = GB.connectDepEvent(this, DepEvent, Dep, ToCleanUp);
-  } else
+  } else if (!IsPrepared(MPreparedDepsEvents))
     MPreparedDepsEvents.push_back(std::move(DepEvent));
 
   return ConnectionCmd;
@@ -1464,8 +1481,14 @@ MemCpyCommand::MemCpyCommand(Requirement SrcReq,
       MSrcQueue(SrcQueue), MSrcReq(std::move(SrcReq)),
       MSrcAllocaCmd(SrcAllocaCmd), MDstReq(std::move(DstReq)),
       MDstAllocaCmd(DstAllocaCmd) {
+  // Copies between devices of different contexts are enqueued to the
+  // destination queue, see MemoryManager::copy.
   if (!MSrcQueue->is_host()) {
-    MEvent->setContextImpl(MSrcQueue->getContextImplPtr());
+    MEvent->setContextImpl(
+        !MQueue->is_host() &&
+                MQueue->getContextImplPtr() != MSrcQueue->getContextImplPtr()
+            ? MQueue->getContextImplPtr()
+            : MSrcQueue->getContextImplPtr());
   }
 
   MWorkerQueue = MQueue->is_host() ? MSrcQueue : MQueue;
@@ -1540,8 +1563,45 @@ pi_int32 MemCpyCommand::enqueueImp() {
 
   sycl::detail::pi::PiEvent &Event = MEvent->getHandleRef();
 
+  const QueueImplPtr &WorkerQueue = getWorkerQueue();
+  // The copies between the host and a device, or between two queues of a
+  // context, can be enqueued to the copy queue of the worker queue, so that
+  // they overlap with the kernels enqueued to it before. A marker on the
+  // worker queue orders the commands enqueued to it after the copy.
+  const bool SameContext =
+      MSrcQueue->is_host() || MQueue->is_host() ||
+      MSrcQueue->getContextImplPtr() == MQueue->getContextImplPtr();
+  const QueueImplPtr &CopyQueue = SameContext && !WorkerQueue->is_host()
+                                      ? WorkerQueue->getBufferCopyQueue()
+                                      : nullptr;
+  if (CopyQueue) {
+    // Unlike getPiEvents, the events of the worker queue are kept, since the
+    // copy queue is not ordered with it.
+    std::vector<sycl::detail::pi::PiEvent> RawEvents;
+    for (const EventImplPtr &EventImpl : EventImpls)
+      if (EventImpl->getHandleRef() != nullptr)
+        RawEvents.push_back(EventImpl->getHandleRef());
+    flushCrossQueueDeps(EventImpls, CopyQueue);
+
+    sycl::detail::pi::PiEvent CopyEvent = nullptr;
+    MemoryManager::copy(
+        MSrcAllocaCmd->getSYCLMemObj(), MSrcAllocaCmd->getMemAllocation(),
+        MSrcQueue->is_host() ? MSrcQueue : CopyQueue, MSrcReq.MDims,
+        MSrcReq.MMemoryRange, MSrcReq.MAccessRange, MSrcReq.MOffset,
+        MSrcReq.MElemSize, MDstAllocaCmd->getMemAllocation(),
+        MQueue->is_host() ? MQueue : CopyQueue, MDstReq.MDims,
+        MDstReq.MMemoryRange, MDstReq.MAccessRange, MDstReq.MOffset,
+        MDstReq.MElemSize, std::move(RawEvents), CopyEvent, MEvent);
+
+    const PluginPtr &Plugin = WorkerQueue->getPlugin();
+    Plugin->call<PiApiKind::piEnqueueEventsWait>(WorkerQueue->getHandleRef(),
+                                                 1, &CopyEvent, &Event);
+    Plugin->call<PiApiKind::piEventRelease>(CopyEvent);
+    return PI_SUCCESS;
+  }
+
   auto RawEvents = getPiEvents(EventImpls);
-  flushCrossQueueDeps(EventImpls, getWorkerQueue());
+  flushCrossQueueDeps(EventImpls, WorkerQueue);
 
   MemoryManager::copy(
       MSrcAllocaCmd->getSYCLMemObj(), MSrcAllocaCmd->getMemAllocation(),
@@ -1641,7 +1701,8 @@ MemCpyCommandHost::MemCpyCommandHost(Requirement SrcReq,
                                      QueueImplPtr DstQueue)
     : Command(CommandType::COPY_MEMORY, std::move(DstQueue)),
       MSrcQueue(SrcQueue), MSrcReq(std::move(SrcReq)),
-      MSrcAllocaCmd(SrcAllocaCmd), MDstReq(std::move(DstReq)), MDstPtr(DstPtr) {
+      MSrcAllocaCmd(SrcAllocaCmd), MDstReq(std::move(DstReq)),
+      MDstPtr(DstPtr ? DstPtr : &MDstReq.MData) {
   if (!MSrcQueue->is_host()) {
     MEvent->setContextImpl(MSrcQueue->getContextImplPtr());
   }
@@ -1971,7 +2032,7 @@ void instrumentationAddExtraKernelMetadata(
   };
   sycl::detail::pi::PiProgram Program = nullptr;
   sycl::detail::pi::PiKernel Kernel = nullptr;
-  std::mutex *KernelMutex = nullptr;
+  std::shared_ptr<std::mutex> KernelMutex;
   const KernelArgMask *EliminatedArgMask = nullptr;
 
   std::shared_ptr<kernel_impl> SyclKernelImpl;
@@ -2090,7 +2151,7 @@ void instrumentationFillCommonData(const std::string &KernelName,
 #ifdef XPTI_ENABLE_INSTRUMENTATION
 std::pair<xpti_td *, uint64_t> emitKernelInstrumentationData(
     int32_t StreamID, const std::shared_ptr<detail::kernel_impl> &SyclKernel,
-    const detail::code_location &CodeLoc, const std::string &SyclKernelName,
+    const detail::code_location &CodeLoc, const char *SyclKernelName,
     const QueueImplPtr &Queue, const NDRDescT &NDRDesc,
     const std::shared_ptr<detail::kernel_bundle_impl> &KernelBundleImplPtr,
     std::vector<ArgDesc> &CGArgs) {
@@ -2278,8 +2339,73 @@ pi_mem_obj_access AccessModeToPi(access::mode AccessorMode) {
   }
 }
 
+KernelArgBatch::KernelArgBatch(const PluginPtr &Plugin,
+                               sycl::detail::pi::PiKernel Kernel,
+                               size_t MaxArgs)
+    : MPlugin(Plugin), MKernel(Kernel) {
+  MArgs.reserve(MaxArgs);
+  MMems.reserve(MaxArgs);
+  MMemProperties.reserve(MaxArgs);
+  MSamplers.reserve(MaxArgs);
+}
+
+void KernelArgBatch::addValue(pi_uint32 Index, size_t Size,
+                              const void *Value) {
+  MArgs.push_back({PI_KERNEL_ARG_KIND_VALUE, Index, Size, Value, nullptr});
+}
+
+void KernelArgBatch::addPointer(pi_uint32 Index, size_t Size,
+                                const void *Value) {
+  MArgs.push_back({PI_KERNEL_ARG_KIND_POINTER, Index, Size, Value, nullptr});
+}
+
+void KernelArgBatch::addMemObj(pi_uint32 Index,
+                               const sycl::detail::pi::PiMem *Mem,
+                               pi_mem_access_flag Access) {
+  assert(MMems.size() < MMems.capacity() && "More arguments than reserved");
+  const sycl::detail::pi::PiMem *Value = nullptr;
+  if (Mem)
+    Value = &MMems.emplace_back(*Mem);
+  pi_mem_obj_property &Properties = MMemProperties.emplace_back();
+  Properties.mem_access = Access;
+  Properties.type = PI_KERNEL_ARG_MEM_OBJ_ACCESS;
+  MArgs.push_back({PI_KERNEL_ARG_KIND_MEM_OBJ, Index,
+                   sizeof(sycl::detail::pi::PiMem), Value, &Properties});
+}
+
+void KernelArgBatch::addMemValue(pi_uint32 Index,
+                                 sycl::detail::pi::PiMem Mem) {
+  assert(MMems.size() < MMems.capacity() && "More arguments than reserved");
+  addValue(Index, sizeof(sycl::detail::pi::PiMem), &MMems.emplace_back(Mem));
+}
+
+void KernelArgBatch::addSampler(pi_uint32 Index,
+                                sycl::detail::pi::PiSampler Sampler) {
+  assert(MSamplers.size() < MSamplers.capacity() &&
+         "More arguments than reserved");
+  MArgs.push_back({PI_KERNEL_ARG_KIND_SAMPLER, Index,
+                   sizeof(sycl::detail::pi::PiSampler),
+                   &MSamplers.emplace_back(Sampler), nullptr});
+}
+
+void KernelArgBatch::set(KernelArgState *LastArgs) {
+  if (LastArgs)
+    LastArgs->filter(MArgs);
+  if (MArgs.empty())
+    return;
+  try {
+    MPlugin->call<PiApiKind::piextKernelSetArgs>(MKernel, MArgs.size(),
+                                                 MArgs.data());
+  } catch (...) {
+    // Some of the arguments may not be set.
+    if (LastArgs)
+      LastArgs->clear();
+    throw;
+  }
+}
+
 void SetArgBasedOnType(
-    const PluginPtr &Plugin, sycl::detail::pi::PiKernel Kernel,
+    KernelArgBatch &Batch,
     const std::shared_ptr<device_image_impl> &DeviceImageImpl,
     const std::function<void *(Requirement *Req)> &getMemAllocationFunc,
     const sycl::context &Context, bool IsHost, detail::ArgDesc &Arg,
@@ -2306,33 +2432,26 @@ void SetArgBasedOnType(
       if (!MemArg)
         MemArg = sycl::detail::pi::PiMem();
 
-      Plugin->call<PiApiKind::piKernelSetArg>(
-          Kernel, NextTrueIndex, sizeof(sycl::detail::pi::PiMem), &MemArg);
+      Batch.addMemValue(NextTrueIndex, MemArg);
     } else {
-      pi_mem_obj_property MemObjData{};
-      MemObjData.mem_access = AccessModeToPi(Req->MAccessMode);
-      MemObjData.type = PI_KERNEL_ARG_MEM_OBJ_ACCESS;
-      Plugin->call<PiApiKind::piextKernelSetArgMemObj>(Kernel, NextTrueIndex,
-                                                       &MemObjData, &MemArg);
+      Batch.addMemObj(NextTrueIndex, &MemArg,
+                      AccessModeToPi(Req->MAccessMode));
     }
     break;
   }
   case kernel_param_kind_t::kind_std_layout: {
-    Plugin->call<PiApiKind::piKernelSetArg>(Kernel, NextTrueIndex, Arg.MSize,
-                                            Arg.MPtr);
+    Batch.addValue(NextTrueIndex, Arg.MSize, Arg.MPtr);
     break;
   }
   case kernel_param_kind_t::kind_sampler: {
     sampler *SamplerPtr = (sampler *)Arg.MPtr;
     sycl::detail::pi::PiSampler Sampler =
         detail::getSyclObjImpl(*SamplerPtr)->getOrCreateSampler(Context);
-    Plugin->call<PiApiKind::piextKernelSetArgSampler>(Kernel, NextTrueIndex,
-                                                      &Sampler);
+    Batch.addSampler(NextTrueIndex, Sampler);
     break;
   }
   case kernel_param_kind_t::kind_pointer: {
-    Plugin->call<PiApiKind::piextKernelSetArgPointer>(Kernel, NextTrueIndex,
-                                                      Arg.MSize, Arg.MPtr);
+    Batch.addPointer(NextTrueIndex, Arg.MSize, Arg.MPtr);
     break;
   }
   case kernel_param_kind_t::kind_specialization_constants_buffer: {
@@ -2350,11 +2469,13 @@ void SetArgBasedOnType(
     sycl::detail::pi::PiMem *SpecConstsBufferArg =
         SpecConstsBuffer ? &SpecConstsBuffer : nullptr;
 
+    // Set on its own, so that the PI trace shows whether the selected image
+    // has a specialization constants buffer.
     pi_mem_obj_property MemObjData{};
     MemObjData.mem_access = PI_ACCESS_READ_ONLY;
     MemObjData.type = PI_KERNEL_ARG_MEM_OBJ_ACCESS;
-    Plugin->call<PiApiKind::piextKernelSetArgMemObj>(
-        Kernel, NextTrueIndex, &MemObjData, SpecConstsBufferArg);
+    Batch.getPlugin()->call<PiApiKind::piextKernelSetArgMemObj>(
+        Batch.getKernel(), NextTrueIndex, &MemObjData, SpecConstsBufferArg);
     break;
   }
   case kernel_param_kind_t::kind_invalid:
@@ -2368,22 +2489,24 @@ void SetArgBasedOnType(
 static pi_result SetKernelParamsAndLaunch(
     const QueueImplPtr &Queue, std::vector<ArgDesc> &Args,
     const std::shared_ptr<device_image_impl> &DeviceImageImpl,
-    sycl::detail::pi::PiKernel Kernel, NDRDescT &NDRDesc,
-    std::vector<sycl::detail::pi::PiEvent> &RawEvents,
+    sycl::detail::pi::PiKernel Kernel, const std::string &KernelName,
+    NDRDescT &NDRDesc, std::vector<sycl::detail::pi::PiEvent> &RawEvents,
     const detail::EventImplPtr &OutEventImpl,
     const KernelArgMask *EliminatedArgMask,
     const std::function<void *(Requirement *Req)> &getMemAllocationFunc,
-    bool IsCooperative) {
+    bool IsCooperative, KernelArgState *LastArgs) {
   const PluginPtr &Plugin = Queue->getPlugin();
 
-  auto setFunc = [&Plugin, Kernel, &DeviceImageImpl, &getMemAllocationFunc,
+  KernelArgBatch Batch(Plugin, Kernel, Args.size());
+  auto setFunc = [&Batch, &DeviceImageImpl, &getMemAllocationFunc,
                   &Queue](detail::ArgDesc &Arg, size_t NextTrueIndex) {
-    SetArgBasedOnType(Plugin, Kernel, DeviceImageImpl, getMemAllocationFunc,
+    SetArgBasedOnType(Batch, DeviceImageImpl, getMemAllocationFunc,
                       Queue->get_context(), Queue->is_host(), Arg,
                       NextTrueIndex);
   };
 
   applyFuncOnFilteredArgs(EliminatedArgMask, Args, setFunc);
+  Batch.set(LastArgs);
 
   adjustNDRangePerKernel(NDRDesc, Kernel, *(Queue->getDeviceImplPtr()));
 
@@ -2409,8 +2532,27 @@ static pi_result SetKernelParamsAndLaunch(
     if (EnforcedLocalSize)
       LocalSize = RequiredWGSize;
   }
+
+  size_t TunedLocalSize[3] = {0, 0, 0};
+  std::optional<wg_size_autotuner::sample> TuningSample;
+  wg_size_autotuner *Autotuner = nullptr;
+  if (!LocalSize && !IsCooperative && SYCLConfig<SYCL_WG_AUTOTUNE>::get()) {
+    // The launches are timed from the profiling information of their events.
+    const bool CanSample = OutEventImpl && Queue->MIsProfilingEnabled &&
+                           !Queue->isProfilingFallback();
+    Autotuner = &Queue->getContextImplPtr()
+                     ->getKernelProgramCache()
+                     .getWGSizeAutotuner();
+    if (Autotuner->selectLocalSize(Queue->getDeviceImplPtr(), Plugin, Kernel,
+                                   KernelName, NDRDesc.Dims,
+                                   &NDRDesc.GlobalSize[0], CanSample,
+                                   TunedLocalSize, TuningSample))
+      LocalSize = TunedLocalSize;
+  }
+
   if (OutEventImpl != nullptr)
     OutEventImpl->setHostEnqueueTime();
+  ScopedMetricTimer EnqueueTimer{MetricKind::PluginEnqueue};
   pi_result Error =
       [&](auto... Args) {
         if (IsCooperative) {
@@ -2423,6 +2565,13 @@ static pi_result SetKernelParamsAndLaunch(
         &NDRDesc.GlobalSize[0], LocalSize, RawEvents.size(),
         RawEvents.empty() ? nullptr : &RawEvents[0],
         OutEventImpl ? &OutEventImpl->getHandleRef() : nullptr);
+  if (TuningSample) {
+    if (Error == PI_SUCCESS && OutEventImpl->getHandleRef())
+      Autotuner->startSample(std::move(*TuningSample), Plugin,
+                             OutEventImpl->getHandleRef());
+    else
+      Autotuner->cancelSample(*TuningSample);
+  }
   return Error;
 }
 
@@ -2465,6 +2614,7 @@ pi_int32 enqueueImpCommandBufferKernel(
   pi_program PiProgram = nullptr;
   std::shared_ptr<kernel_impl> SyclKernelImpl = nullptr;
   std::shared_ptr<device_image_impl> DeviceImageImpl = nullptr;
+  std::shared_ptr<CachedKernelMutex> KernelMutex;
 
   auto Kernel = CommandGroup.MSyclKernel;
   auto KernelBundleImplPtr = CommandGroup.MKernelBundle;
@@ -2486,26 +2636,39 @@ pi_int32 enqueueImpCommandBufferKernel(
     DeviceImageImpl = SyclKernelImpl->getDeviceImage();
     PiProgram = DeviceImageImpl->get_program_ref();
     EliminatedArgMask = SyclKernelImpl->getKernelArgMask();
+    KernelMutex = SyclKernelImpl->getCacheMutex();
   } else if (Kernel != nullptr) {
     PiKernel = Kernel->getHandleRef();
     PiProgram = Kernel->getProgramRef();
     EliminatedArgMask = Kernel->getKernelArgMask();
+    KernelMutex = Kernel->getCacheMutex();
   } else {
-    std::tie(PiKernel, std::ignore, EliminatedArgMask, PiProgram) =
+    std::tie(PiKernel, KernelMutex, EliminatedArgMask, PiProgram) =
         sycl::detail::ProgramManager::getInstance().getOrCreateKernel(
-            ContextImpl, DeviceImpl, CommandGroup.MKernelName);
+            ContextImpl, DeviceImpl, CommandGroup.MKernelName, {},
+            CommandGroup.MKernelNameHash);
+  }
+
+  // The arguments are set without tracking them, so the ones remembered for
+  // the launches of a cached kernel are forgotten first. The lock is held
+  // until the kernel is appended, which uses the arguments set on it.
+  std::unique_lock<std::mutex> KernelLock;
+  if (KernelMutex) {
+    KernelLock = std::unique_lock<std::mutex>(*KernelMutex);
+    KernelMutex->LastArgs.clear();
   }
 
-  auto SetFunc = [&Plugin, &PiKernel, &DeviceImageImpl, &Ctx,
-                  &getMemAllocationFunc](sycl::detail::ArgDesc &Arg,
-                                         size_t NextTrueIndex) {
-    sycl::detail::SetArgBasedOnType(Plugin, PiKernel, DeviceImageImpl,
+  // Copy args for modification
+  auto Args = CommandGroup.MArgs;
+  sycl::detail::KernelArgBatch Batch(Plugin, PiKernel, Args.size());
+  auto SetFunc = [&Batch, &DeviceImageImpl, &Ctx, &getMemAllocationFunc](
+                     sycl::detail::ArgDesc &Arg, size_t NextTrueIndex) {
+    sycl::detail::SetArgBasedOnType(Batch, DeviceImageImpl,
                                     getMemAllocationFunc, Ctx, false, Arg,
                                     NextTrueIndex);
   };
-  // Copy args for modification
-  auto Args = CommandGroup.MArgs;
   sycl::detail::applyFuncOnFilteredArgs(EliminatedArgMask, Args, SetFunc);
+  Batch.set();
 
   // Remember this information before the range dimensions are reversed
   const bool HasLocalSize = (CommandGroup.MNDRDesc.LocalSize[0] != 0);
@@ -2540,6 +2703,8 @@ pi_int32 enqueueImpCommandBufferKernel(
       &NDRDesc.GlobalSize[0], LocalSize, SyncPoints.size(),
       SyncPoints.size() ? SyncPoints.data() : nullptr, OutSyncPoint,
       OutCommand);
+  if (KernelLock)
+    KernelLock.unlock();
 
   if (!SyclKernelImpl && !Kernel) {
     Plugin->call<PiApiKind::piKernelRelease>(PiKernel);
@@ -2555,6 +2720,101 @@ pi_int32 enqueueImpCommandBufferKernel(
   return Res;
 }
 
+/// Enqueues a range kernel to the component devices of the composite device of
+/// Queue, each of them running a slice of the first dimension of the range.
+/// The event of the launch waits for the slices.
+static pi_int32 enqueueImpKernelOnComponents(
+    const QueueImplPtr &Queue, const std::vector<QueueImplPtr> &ComponentQueues,
+    NDRDescT &NDRDesc, std::vector<ArgDesc> &Args,
+    const std::string &KernelName,
+    std::vector<sycl::detail::pi::PiEvent> &RawEvents,
+    const detail::EventImplPtr &OutEventImpl,
+    const std::function<void *(Requirement *Req)> &getMemAllocationFunc,
+    sycl::detail::pi::PiKernelCacheConfig KernelCacheConfig) {
+  auto ContextImpl = Queue->getContextImplPtr();
+  const PluginPtr &Plugin = Queue->getPlugin();
+  // The slices are made of whole required work-groups, if any.
+  size_t Granularity = 1;
+  size_t NumGroups = 0;
+  size_t SliceBegin = 0;
+  std::vector<EventImplPtr> SliceEvents;
+  for (size_t I = 0; I < ComponentQueues.size(); ++I) {
+    const QueueImplPtr &ComponentQueue = ComponentQueues[I];
+    sycl::detail::pi::PiKernel Kernel = nullptr;
+    std::shared_ptr<CachedKernelMutex> KernelMutex;
+    sycl::detail::pi::PiProgram Program = nullptr;
+    const KernelArgMask *EliminatedArgMask = nullptr;
+    std::tie(Kernel, KernelMutex, EliminatedArgMask, Program) =
+        detail::ProgramManager::getInstance().getOrCreateKernel(
+            ContextImpl, ComponentQueue->getDeviceImplPtr(), KernelName,
+            NDRDesc);
+
+    if (I == 0) {
+      size_t RequiredWGSize[3] = {0, 0, 0};
+      Plugin->call<PiApiKind::piKernelGetGroupInfo>(
+          Kernel, ComponentQueue->getDeviceImplPtr()->getHandleRef(),
+          PI_KERNEL_GROUP_INFO_COMPILE_WORK_GROUP_SIZE, sizeof(RequiredWGSize),
+          RequiredWGSize, /* param_value_size_ret = */ nullptr);
+      // The dimensions of the kernel are reversed.
+      if (RequiredWGSize[NDRDesc.Dims - 1] != 0)
+        Granularity = RequiredWGSize[NDRDesc.Dims - 1];
+      NumGroups = NDRDesc.GlobalSize[0] / Granularity;
+    }
+    const size_t SliceGroups = NumGroups / ComponentQueues.size() +
+                               (I < NumGroups % ComponentQueues.size());
+
+    pi_result Error = PI_SUCCESS;
+    NDRDescT SliceDesc = NDRDesc;
+    if (SliceGroups != 0) {
+      SliceDesc.GlobalOffset[0] += SliceBegin;
+      SliceDesc.GlobalSize[0] = SliceGroups * Granularity;
+      SliceBegin += SliceDesc.GlobalSize[0];
+
+      std::vector<sycl::detail::pi::PiEvent> WaitList = RawEvents;
+      std::vector<sycl::detail::pi::PiEvent> DeviceGlobalInitEvents =
+          ContextImpl->initializeDeviceGlobals(Program, ComponentQueue);
+      WaitList.insert(WaitList.end(), DeviceGlobalInitEvents.begin(),
+                      DeviceGlobalInitEvents.end());
+
+      auto SliceEvent = std::make_shared<event_impl>(ComponentQueue);
+      std::unique_lock<std::mutex> Lock;
+      if (KernelMutex)
+        Lock = std::unique_lock<std::mutex>(*KernelMutex);
+      if (KernelCacheConfig == PI_EXT_KERNEL_EXEC_INFO_CACHE_LARGE_SLM ||
+          KernelCacheConfig == PI_EXT_KERNEL_EXEC_INFO_CACHE_LARGE_DATA)
+        Plugin->call<PiApiKind::piKernelSetExecInfo>(
+            Kernel, PI_EXT_KERNEL_EXEC_INFO_CACHE_CONFIG,
+            sizeof(sycl::detail::pi::PiKernelCacheConfig), &KernelCacheConfig);
+      KernelArgState *LastArgs =
+          KernelMutex ? KernelMutex->getLastArgs() : nullptr;
+      Error = SetKernelParamsAndLaunch(
+          ComponentQueue, Args, /*DeviceImageImpl=*/nullptr, Kernel,
+          KernelName, SliceDesc, WaitList, SliceEvent, EliminatedArgMask,
+          getMemAllocationFunc, /*IsCooperative=*/false, LastArgs);
+      if (Error == PI_SUCCESS)
+        SliceEvents.push_back(std::move(SliceEvent));
+    }
+
+    Plugin->call<PiApiKind::piKernelRelease>(Kernel);
+    Plugin->call<PiApiKind::piProgramRelease>(Program);
+    if (PI_SUCCESS != Error)
+      detail::enqueue_kernel_launch::handleErrorOrWarning(
+          Error, *ComponentQueue->getDeviceImplPtr(), Kernel, SliceDesc);
+  }
+
+  std::vector<sycl::detail::pi::PiEvent> SliceRawEvents;
+  for (const EventImplPtr &SliceEvent : SliceEvents)
+    SliceRawEvents.push_back(SliceEvent->getHandleRef());
+  if (OutEventImpl != nullptr)
+    OutEventImpl->setHostEnqueueTime();
+  // Also keeps the kernel in order with the other commands of an in-order
+  // queue.
+  Plugin->call<PiApiKind::piEnqueueEventsWait>(
+      Queue->getHandleRef(), SliceRawEvents.size(), SliceRawEvents.data(),
+      OutEventImpl ? &OutEventImpl->getHandleRef() : nullptr);
+  return PI_SUCCESS;
+}
+
 pi_int32 enqueueImpKernel(
     const QueueImplPtr &Queue, NDRDescT &NDRDesc, std::vector<ArgDesc> &Args,
     const std::shared_ptr<detail::kernel_bundle_impl> &KernelBundleImplPtr,
@@ -2564,18 +2824,35 @@ pi_int32 enqueueImpKernel(
     const detail::EventImplPtr &OutEventImpl,
     const std::function<void *(Requirement *Req)> &getMemAllocationFunc,
     sycl::detail::pi::PiKernelCacheConfig KernelCacheConfig,
-    const bool KernelIsCooperative) {
+    const bool KernelIsCooperative, uint64_t KernelNameHash) {
+
+  // Split the range kernels across the components of a composite device.
+  if (!KernelBundleImplPtr && !MSyclKernel && !KernelIsCooperative &&
+      NDRDesc.LocalSize[0] == 0 && NDRDesc.NumWorkGroups[0] == 0) {
+    const std::vector<QueueImplPtr> &ComponentQueues =
+        Queue->getComponentQueues();
+    if (ComponentQueues.size() > 1)
+      return enqueueImpKernelOnComponents(
+          Queue, ComponentQueues, NDRDesc, Args, KernelName, RawEvents,
+          OutEventImpl, getMemAllocationFunc, KernelCacheConfig);
+  }
 
   // Run OpenCL kernel
   auto ContextImpl = Queue->getContextImplPtr();
   auto DeviceImpl = Queue->getDeviceImplPtr();
   sycl::detail::pi::PiKernel Kernel = nullptr;
-  std::mutex *KernelMutex = nullptr;
+  std::shared_ptr<CachedKernelMutex> KernelMutex;
+  // Mutex of a kernel object which does not share a cached kernel.
+  std::mutex *NoncacheableMutex = nullptr;
   sycl::detail::pi::PiProgram Program = nullptr;
   const KernelArgMask *EliminatedArgMask;
 
   std::shared_ptr<kernel_impl> SyclKernelImpl;
   std::shared_ptr<device_image_impl> DeviceImageImpl;
+  // Whether the kernel is a copy with its specialization constants folded in,
+  // owned by this launch.
+  bool IsMaterialized = false;
+  std::string MaterializedName;
 
   // Use kernel_bundle if available unless it is interop.
   // Interop bundles can't be used in the first branch, because the kernels
@@ -2597,24 +2874,45 @@ pi_int32 enqueueImpKernel(
 
     EliminatedArgMask = SyclKernelImpl->getKernelArgMask();
     KernelMutex = SyclKernelImpl->getCacheMutex();
+
+#if SYCL_EXT_CODEPLAY_KERNEL_FUSION
+    // Launch a copy of the kernel in which the values of the emulated
+    // specialization constants are folded in. The buffer holding them is
+    // still passed, but no longer read.
+    if (SYCLConfig<SYCL_JIT_SPEC_CONSTANTS>::get()) {
+      MaterializedName =
+          detail::jit_compiler::get_instance().materializeSpecConstants(
+              Queue, DeviceImageImpl->get_bin_image_ref(), KernelName, Args,
+              EliminatedArgMask, DeviceImageImpl->get_spec_const_blob_ref());
+      if (!MaterializedName.empty()) {
+        std::tie(Kernel, KernelMutex, EliminatedArgMask, Program) =
+            detail::ProgramManager::getInstance().getOrCreateKernel(
+                ContextImpl, DeviceImpl, MaterializedName, NDRDesc);
+        IsMaterialized = true;
+      }
+    }
+#endif // SYCL_EXT_CODEPLAY_KERNEL_FUSION
   } else if (nullptr != MSyclKernel) {
     assert(MSyclKernel->get_info<info::kernel::context>() ==
            Queue->get_context());
     Kernel = MSyclKernel->getHandleRef();
     Program = MSyclKernel->getProgramRef();
 
-    // Non-cacheable kernels use mutexes from kernel_impls.
+    // Non-cacheable kernels use mutexes from kernel_impls, the kernels of
+    // kernel bundles share the cached kernel and its mutex.
     // TODO this can still result in a race condition if multiple SYCL
     // kernels are created with the same native handle. To address this,
     // we need to either store and use a pi_native_handle -> mutex map or
     // reuse and return existing SYCL kernels from make_native to avoid
     // their duplication in such cases.
-    KernelMutex = &MSyclKernel->getNoncacheableEnqueueMutex();
+    KernelMutex = MSyclKernel->getCacheMutex();
+    if (!KernelMutex)
+      NoncacheableMutex = &MSyclKernel->getNoncacheableEnqueueMutex();
     EliminatedArgMask = MSyclKernel->getKernelArgMask();
   } else {
     std::tie(Kernel, KernelMutex, EliminatedArgMask, Program) =
         detail::ProgramManager::getInstance().getOrCreateKernel(
-            ContextImpl, DeviceImpl, KernelName, NDRDesc);
+            ContextImpl, DeviceImpl, KernelName, NDRDesc, KernelNameHash);
   }
 
   // We may need more events for the launch, so we make another reference.
@@ -2635,13 +2933,65 @@ pi_int32 enqueueImpKernel(
     EventsWaitList = EventsWithDeviceGlobalInits;
   }
 
+  // Prefetch the shared USM arguments of the kernel to its device first.
+  std::vector<sycl::detail::pi::PiEvent> PrefetchEvents =
+      ContextImpl->getUSMPrefetchAdvisor().prefetchKernelArgs(
+          Queue, Args, EliminatedArgMask, EventsWaitList);
+  std::vector<sycl::detail::pi::PiEvent> EventsWithPrefetches;
+  if (!PrefetchEvents.empty()) {
+    EventsWithPrefetches.reserve(EventsWaitList.size() +
+                                 PrefetchEvents.size());
+    EventsWithPrefetches.insert(EventsWithPrefetches.end(),
+                                EventsWaitList.begin(), EventsWaitList.end());
+    EventsWithPrefetches.insert(EventsWithPrefetches.end(),
+                                PrefetchEvents.begin(), PrefetchEvents.end());
+  }
+  std::vector<sycl::detail::pi::PiEvent> &LaunchWaitList =
+      PrefetchEvents.empty() ? EventsWaitList : EventsWithPrefetches;
+
   pi_result Error = PI_SUCCESS;
   {
     // When KernelMutex is null, this means that in-memory caching is
     // disabled, which means that kernel object is not shared, so no locking
-    // is necessary.
+    // is necessary. A cached kernel which is in use by another thread is
+    // launched through a copy of it rather than waiting for the other launch.
     using LockT = std::unique_lock<std::mutex>;
-    auto Lock = KernelMutex ? LockT(*KernelMutex) : LockT();
+    LockT Lock;
+    KernelProgramCache &Cache = ContextImpl->getKernelProgramCache();
+    KernelProgramCache::KernelClone Clone;
+    // The copy is given back on every path, as a failed launch throws.
+    struct CloneReleaser {
+      KernelProgramCache &Cache;
+      const KernelProgramCache::KernelClone &Clone;
+      ~CloneReleaser() {
+        if (Clone.Kernel)
+          Cache.releaseKernelClone(Clone);
+      }
+    } ReleaseClone{Cache, Clone};
+    if (KernelMutex) {
+      Lock = LockT(*KernelMutex, std::try_to_lock);
+      if (!Lock.owns_lock() && !MSyclKernel)
+        Clone = Cache.acquireKernelClone(KernelMutex, Program,
+                                         IsMaterialized ? MaterializedName
+                                                        : KernelName);
+      if (!Clone.Kernel && !Lock.owns_lock())
+        Lock.lock();
+    } else if (NoncacheableMutex) {
+      Lock = LockT(*NoncacheableMutex);
+    }
+    sycl::detail::pi::PiKernel LaunchKernel =
+        Clone.Kernel ? Clone.Kernel : Kernel;
+    // Only the arguments of the kernels owned by the cache are remembered, as
+    // the other ones may be set by the application. A kernel object may still
+    // share a cached kernel, the arguments remembered for which are then
+    // forgotten under its lock.
+    KernelArgState *LastArgs = nullptr;
+    if (Clone.Kernel)
+      LastArgs = Clone.LastArgs.get();
+    else if (KernelMutex && !MSyclKernel)
+      LastArgs = KernelMutex->getLastArgs();
+    else if (KernelMutex)
+      KernelMutex->LastArgs.clear();
 
     // Set SLM/Cache configuration for the kernel if non-default value is
     // provided.
@@ -2649,21 +2999,23 @@ pi_int32 enqueueImpKernel(
         KernelCacheConfig == PI_EXT_KERNEL_EXEC_INFO_CACHE_LARGE_DATA) {
       const PluginPtr &Plugin = Queue->getPlugin();
       Plugin->call<PiApiKind::piKernelSetExecInfo>(
-          Kernel, PI_EXT_KERNEL_EXEC_INFO_CACHE_CONFIG,
+          LaunchKernel, PI_EXT_KERNEL_EXEC_INFO_CACHE_CONFIG,
           sizeof(sycl::detail::pi::PiKernelCacheConfig), &KernelCacheConfig);
     }
 
-    Error = SetKernelParamsAndLaunch(Queue, Args, DeviceImageImpl, Kernel,
-                                     NDRDesc, EventsWaitList, OutEventImpl,
-                                     EliminatedArgMask, getMemAllocationFunc,
-                                     KernelIsCooperative);
+    Error = SetKernelParamsAndLaunch(
+        Queue, Args, DeviceImageImpl, LaunchKernel, KernelName, NDRDesc,
+        LaunchWaitList, OutEventImpl, EliminatedArgMask, getMemAllocationFunc,
+        KernelIsCooperative, LastArgs);
 
     const PluginPtr &Plugin = Queue->getPlugin();
-    if (!SyclKernelImpl && !MSyclKernel) {
+    if ((!SyclKernelImpl && !MSyclKernel) || IsMaterialized) {
       Plugin->call<PiApiKind::piKernelRelease>(Kernel);
       Plugin->call<PiApiKind::piProgramRelease>(Program);
     }
   }
+  for (sycl::detail::pi::PiEvent Event : PrefetchEvents)
+    Queue->getPlugin()->call<PiApiKind::piEventRelease>(Event);
   if (PI_SUCCESS != Error) {
     // If we have got non-success error code, let's analyze it to emit nice
     // exception explaining what was wrong
@@ -2739,6 +3091,7 @@ pi_int32 ExecCGCommand::enqueueImpCommandBuffer() {
   flushCrossQueueDeps(EventImpls, getWorkerQueue());
   std::vector<sycl::detail::pi::PiEvent> RawEvents = getPiEvents(EventImpls);
   if (!RawEvents.empty()) {
+    queue_impl::flushDeferredCrossQueueDeps();
     const PluginPtr &Plugin = MQueue->getPlugin();
     Plugin->call<PiApiKind::piEventsWait>(RawEvents.size(), &RawEvents[0]);
   }
@@ -2985,6 +3338,7 @@ pi_int32 ExecCGCommand::enqueueImpQueue() {
           Req->MData = AllocaCmd->getMemAllocation();
         }
       if (!RawEvents.empty()) {
+        queue_impl::flushDeferredCrossQueueDeps();
         // Assuming that the events are for devices to the same Plugin.
         const PluginPtr &Plugin = EventImpls[0]->getPlugin();
         Plugin->call<PiApiKind::piEventsWait>(RawEvents.size(), &RawEvents[0]);
@@ -3031,7 +3385,8 @@ pi_int32 ExecCGCommand::enqueueImpQueue() {
     return enqueueImpKernel(
         MQueue, NDRDesc, Args, ExecKernel->getKernelBundle(), SyclKernel,
         KernelName, RawEvents, EventImpl, getMemAllocationFunc,
-        ExecKernel->MKernelCacheConfig, ExecKernel->MKernelIsCooperative);
+        ExecKernel->MKernelCacheConfig, ExecKernel->MKernelIsCooperative,
+        ExecKernel->MKernelNameHash);
   }
   case CG::CGTYPE::CopyUSM: {
     CGCopyUSM *Copy = (CGCopyUSM *)MCommandGroup.get();
@@ -3146,8 +3501,12 @@ pi_int32 ExecCGCommand::enqueueImpQueue() {
     // submitted to report exception origin properly.
     copySubmissionCodeLocation();
 
+    // Pin the host tasks of a queue to a single worker for cache locality.
+    // Host tasks of high priority queues overtake the queued ones.
     MQueue->getThreadPool().submit<DispatchHostTask>(
-        DispatchHostTask(this, std::move(ReqToMem)));
+        DispatchHostTask(this, std::move(ReqToMem)),
+        HostTask->MQueue->getQueueID(),
+        /*Urgent*/ HostTask->MQueue->getSchedulingPriority() > 0);
 
     MShouldCompleteEventIfPossible = false;
 
@@ -19,6 +19,7 @@
 
 #include <detail/accessor_impl.hpp>
 #include <detail/event_impl.hpp>
+#include <detail/object_pool.hpp>
 #include <detail/program_manager/program_manager.hpp>
 #include <sycl/access/access.hpp>
 #include <sycl/detail/cg.hpp>
@@ -126,6 +127,13 @@ public:
           sycl::detail::pi::PiExtCommandBuffer CommandBuffer = nullptr,
           const std::vector<sycl::detail::pi::PiExtSyncPoint> &SyncPoints = {});
 
+  // Commands are created and destroyed for every submission, take them from
+  // the per-thread pools.
+  static void *operator new(size_t Size) { return allocatePooled(Size); }
+  static void operator delete(void *Ptr, size_t Size) noexcept {
+    deallocatePooled(Ptr, Size);
+  }
+
   /// \param NewDep dependency to be added
   /// \param ToCleanUp container for commands that can be cleaned up.
   /// \return an optional connection cmd to enqueue
@@ -604,6 +612,8 @@ private:
 /// memory object.
 class MemCpyCommandHost : public Command {
 public:
+  /// \param DstPtr points to the destination of the copy, or is nullptr to
+  /// copy to the data of DstReq.
   MemCpyCommandHost(Requirement SrcReq, AllocaCommandBase *SrcAllocaCmd,
                     Requirement DstReq, void **DstPtr, QueueImplPtr SrcQueue,
                     QueueImplPtr DstQueue);
@@ -638,7 +648,7 @@ pi_int32 enqueueImpKernel(
     const detail::EventImplPtr &Event,
     const std::function<void *(Requirement *Req)> &getMemAllocationFunc,
     sycl::detail::pi::PiKernelCacheConfig KernelCacheConfig,
-    bool KernelIsCooperative);
+    bool KernelIsCooperative, uint64_t KernelNameHash = 0);
 
 class KernelFusionCommand;
 
@@ -693,10 +703,12 @@ private:
 // For XPTI instrumentation only.
 // Method used to emit data in cases when we do not create node in graph.
 // Very close to ExecCGCommand::emitInstrumentationData content.
+// The kernel name is a C string so that the submissions build no std::string
+// when nobody listens to the stream.
 #ifdef XPTI_ENABLE_INSTRUMENTATION
 std::pair<xpti_td *, uint64_t> emitKernelInstrumentationData(
     int32_t StreamID, const std::shared_ptr<detail::kernel_impl> &SyclKernel,
-    const detail::code_location &CodeLoc, const std::string &SyclKernelName,
+    const detail::code_location &CodeLoc, const char *SyclKernelName,
     const QueueImplPtr &Queue, const NDRDescT &NDRDesc,
     const std::shared_ptr<detail::kernel_bundle_impl> &KernelBundleImplPtr,
     std::vector<ArgDesc> &CGArgs);
@@ -791,11 +803,47 @@ pi_int32 enqueueImpCommandBufferKernel(
     sycl::detail::pi::PiExtCommandBufferCommand *OutCommand,
     const std::function<void *(Requirement *Req)> &getMemAllocationFunc);
 
-// Sets arguments for a given kernel and device based on the argument type.
-// Refactored from SetKernelParamsAndLaunch to allow it to be used in the graphs
-// extension.
+class KernelArgState;
+
+// Collects the arguments of a kernel so that they are all set with a single
+// piextKernelSetArgs call.
+class KernelArgBatch {
+public:
+  KernelArgBatch(const PluginPtr &Plugin, sycl::detail::pi::PiKernel Kernel,
+                 size_t MaxArgs);
+
+  void addValue(pi_uint32 Index, size_t Size, const void *Value);
+  void addPointer(pi_uint32 Index, size_t Size, const void *Value);
+  // Mem is null for a null memory object argument.
+  void addMemObj(pi_uint32 Index, const sycl::detail::pi::PiMem *Mem,
+                 pi_mem_access_flag Access);
+  // Sets the memory object handle as a plain value.
+  void addMemValue(pi_uint32 Index, sycl::detail::pi::PiMem Mem);
+  void addSampler(pi_uint32 Index, sycl::detail::pi::PiSampler Sampler);
+
+  // Only sets the arguments which are not already set according to LastArgs,
+  // if not null, and records them in it.
+  void set(KernelArgState *LastArgs = nullptr);
+
+  const PluginPtr &getPlugin() const { return MPlugin; }
+  sycl::detail::pi::PiKernel getKernel() const { return MKernel; }
+
+private:
+  const PluginPtr &MPlugin;
+  sycl::detail::pi::PiKernel MKernel;
+  std::vector<pi_kernel_arg> MArgs;
+  // Copies of the handles the arguments point to. They are reserved for all
+  // the arguments so that they are never reallocated.
+  std::vector<sycl::detail::pi::PiMem> MMems;
+  std::vector<pi_mem_obj_property> MMemProperties;
+  std::vector<sycl::detail::pi::PiSampler> MSamplers;
+};
+
+// Adds the argument for a given kernel and device to Batch based on the
+// argument type. Refactored from SetKernelParamsAndLaunch to allow it to be
+// used in the graphs extension.
 void SetArgBasedOnType(
-    const detail::plugin &Plugin, sycl::detail::pi::PiKernel Kernel,
+    KernelArgBatch &Batch,
     const std::shared_ptr<device_image_impl> &DeviceImageImpl,
     const std::function<void *(Requirement *Req)> &getMemAllocationFunc,
     const sycl::context &Context, bool IsHost, detail::ArgDesc &Arg,
@@ -26,6 +26,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <queue>
@@ -36,17 +37,93 @@ namespace sycl {
 inline namespace _V1 {
 namespace detail {
 
+/// Gets the bytes [Begin, End) of the memory object, which a requirement
+/// accesses a part of.
+///
+/// The accessed elements, which are not contiguous for a ranged accessor of
+/// several dimensions, are between the first and the last ones in the memory
+/// range of the accessed buffer, which starts at MOffsetInBytes for a
+/// sub-buffer.
+static std::pair<size_t, size_t> getAccessedBytes(const Requirement *Req) {
+  if (Req->MAccessRange.size() == 0)
+    return {Req->MOffsetInBytes, Req->MOffsetInBytes};
+  auto Linearize = [Req](size_t I0, size_t I1, size_t I2) {
+    return (I0 * Req->MMemoryRange[1] + I1) * Req->MMemoryRange[2] + I2;
+  };
+  const id<3> &Offset = Req->MOffset;
+  const range<3> &Range = Req->MAccessRange;
+  size_t First = Linearize(Offset[0], Offset[1], Offset[2]);
+  size_t Last = Linearize(Offset[0] + Range[0] - 1, Offset[1] + Range[1] - 1,
+                          Offset[2] + Range[2] - 1);
+  return {Req->MOffsetInBytes + First * Req->MElemSize,
+          Req->MOffsetInBytes + (Last + 1) * Req->MElemSize};
+}
+
+/// The maximum number of disjoint modified byte ranges of a memory object,
+/// past which the closest ones are merged.
+static constexpr size_t MaxModifiedRanges = 16;
+
+/// Adds the bytes [Begin, End) to the sorted and disjoint modified bytes of a
+/// memory object, merging the ranges which they overlap or touch.
+static void addModifiedBytes(std::vector<std::pair<size_t, size_t>> &Ranges,
+                             size_t Begin, size_t End) {
+  auto First = std::lower_bound(
+      Ranges.begin(), Ranges.end(), Begin,
+      [](const std::pair<size_t, size_t> &Range, size_t Begin) {
+        return Range.second < Begin;
+      });
+  auto Last = First;
+  for (; Last != Ranges.end() && Last->first <= End; ++Last) {
+    Begin = std::min(Begin, Last->first);
+    End = std::max(End, Last->second);
+  }
+  Ranges.insert(Ranges.erase(First, Last), {Begin, End});
+  if (Ranges.size() <= MaxModifiedRanges)
+    return;
+  // Merging the two ranges with the smallest gap between them adds the fewest
+  // unmodified bytes to the copy back.
+  auto Closest = Ranges.begin();
+  for (auto It = Ranges.begin(); It + 1 != Ranges.end(); ++It)
+    if ((It + 1)->first - It->second < (Closest + 1)->first - Closest->second)
+      Closest = It;
+  Closest->second = (Closest + 1)->second;
+  Ranges.erase(Closest + 1);
+}
+
 /// Checks whether two requirements overlap or not.
 ///
 /// This information can be used to prove that executing two kernels that
-/// work on different parts of the memory object in parallel is legal.
+/// work on different parts of the memory object, e.g. disjoint sub-buffers or
+/// ranged accessors, in parallel is legal.
 // TODO merge with LeavesCollection's version of doOverlap (see
 // leaves_collection.cpp).
 static bool doOverlap(const Requirement *LHS, const Requirement *RHS) {
-  return (LHS->MOffsetInBytes + LHS->MAccessRange.size() * LHS->MElemSize >=
-          RHS->MOffsetInBytes) ||
-         (RHS->MOffsetInBytes + RHS->MAccessRange.size() * RHS->MElemSize >=
-          LHS->MOffsetInBytes);
+  auto [LHSBegin, LHSEnd] = getAccessedBytes(LHS);
+  auto [RHSBegin, RHSEnd] = getAccessedBytes(RHS);
+  // Requirements which access no bytes are not expected, so they
+  // conservatively overlap anything.
+  if (LHSBegin == LHSEnd || RHSBegin == RHSEnd)
+    return true;
+  if (LHSBegin >= RHSEnd || RHSBegin >= LHSEnd)
+    return false;
+  // The ranged accessors of the same buffer access boxes of its memory range,
+  // which are disjoint if they are disjoint in one dimension, even though the
+  // bytes between their first and last elements interleave.
+  if (LHS->MOffsetInBytes == RHS->MOffsetInBytes &&
+      LHS->MMemoryRange == RHS->MMemoryRange &&
+      LHS->MElemSize == RHS->MElemSize) {
+    for (int I = 0; I < 3; ++I)
+      if (LHS->MOffset[I] + LHS->MAccessRange[I] <= RHS->MOffset[I] ||
+          RHS->MOffset[I] + RHS->MAccessRange[I] <= LHS->MOffset[I])
+        return false;
+  }
+  return true;
+}
+
+/// Gets the key of the allocations of the sub-buffer a requirement is for.
+static MemObjRecord::SubBufKeyT getSubBufKey(const Requirement *Req) {
+  return {Req->MOffsetInBytes, Req->MAccessRange[0], Req->MAccessRange[1],
+          Req->MAccessRange[2]};
 }
 
 static bool sameCtx(const ContextImplPtr &LHS, const ContextImplPtr &RHS) {
@@ -78,6 +155,12 @@ static bool isAccessModeAllowed(access::mode Required, access::mode Current) {
   return false;
 }
 
+/// Checks if the previous contents of the memory are not needed for the access.
+static bool isDiscardAccessMode(access::mode Mode) {
+  return Mode == access::mode::discard_write ||
+         Mode == access::mode::discard_read_write;
+}
+
 /// Combines two access modes into a single one that allows both.
 static access::mode combineAccessModes(access::mode A, access::mode B) {
   if (A == B)
@@ -200,8 +283,10 @@ MemObjRecord *Scheduler::GraphBuilder::getOrInsertMemObjRecord(
   SYCLMemObjI *MemObject = Req->MSYCLMemObj;
   MemObjRecord *Record = getMemObjRecord(MemObject);
 
-  if (nullptr != Record)
+  if (nullptr != Record) {
+    foldInOrderFastPath(Record, ToEnqueue);
     return Record;
+  }
 
   const size_t LeafLimit = 8;
   LeavesCollection::AllocateDependencyF AllocateDependency =
@@ -398,8 +483,8 @@ Command *Scheduler::GraphBuilder::insertMemoryMove(
     Record->MHostAccess = MapMode;
   } else {
 
-    if ((Req->MAccessMode == access::mode::discard_write) ||
-        (Req->MAccessMode == access::mode::discard_read_write)) {
+    if (isDiscardAccessMode(Req->MAccessMode)) {
+      ++MMemoryMoveCounters.MCopiesSkipped;
       Record->MCurContext = Queue->getContextImplPtr();
       return nullptr;
     } else {
@@ -409,6 +494,10 @@ Command *Scheduler::GraphBuilder::insertMemoryMove(
           new MemCpyCommand(*AllocaCmdSrc->getRequirement(), AllocaCmdSrc,
                             *AllocaCmdDst->getRequirement(), AllocaCmdDst,
                             AllocaCmdSrc->getQueue(), AllocaCmdDst->getQueue());
+      ++MMemoryMoveCounters.MCopiesInserted;
+      if (Req->MSYCLMemObj->isZeroCopy())
+        reportZeroCopyFallback("the data is copied between allocations "
+                               "that do not share memory");
     }
   }
   std::vector<Command *> ToCleanUp;
@@ -475,13 +564,17 @@ Command *Scheduler::GraphBuilder::remapMemoryObject(
 // pointed by Req.
 Command *
 Scheduler::GraphBuilder::addCopyBack(Requirement *Req,
-                                     std::vector<Command *> &ToEnqueue) {
+                                     std::vector<Command *> &ToEnqueue,
+                                     bool OnlyModifiedBytes) {
   QueueImplPtr HostQueue = Scheduler::getInstance().getDefaultHostQueue();
   SYCLMemObjI *MemObj = Req->MSYCLMemObj;
   MemObjRecord *Record = getMemObjRecord(MemObj);
   if (Record && MPrintOptionsArray[BeforeAddCopyBack])
     printGraphAsDot("before_addCopyBack");
 
+  if (Record)
+    foldInOrderFastPath(Record, ToEnqueue);
+
   // Do nothing if there were no or only read operations with the memory object.
   if (nullptr == Record || !Record->MMemModified)
     return nullptr;
@@ -491,21 +584,66 @@ Scheduler::GraphBuilder::addCopyBack(Requirement *Req,
   AllocaCommandBase *SrcAllocaCmd =
       findAllocaForReq(Record, Req, Record->MCurContext);
 
-  auto MemCpyCmdUniquePtr = std::make_unique<MemCpyCommandHost>(
-      *SrcAllocaCmd->getRequirement(), SrcAllocaCmd, *Req, &Req->MData,
-      SrcAllocaCmd->getQueue(), std::move(HostQueue));
-
-  if (!MemCpyCmdUniquePtr)
-    throw runtime_error("Out of host memory", PI_ERROR_OUT_OF_HOST_MEMORY);
-
-  MemCpyCommandHost *MemCpyCmd = MemCpyCmdUniquePtr.release();
+  // The bytes of a buffer which were not modified are the same in the memory
+  // it was initialized from, so only the ranges of the modified ones are
+  // copied there, in bytes of the whole buffer.
+  std::vector<std::pair<size_t, size_t>> CopiedBytes;
+  const size_t Size = MemObj->getSizeInBytes();
+  bool CopyAll = !OnlyModifiedBytes ||
+                 MemObj->getType() != SYCLMemObjI::MemObjType::Buffer;
+  if (!CopyAll) {
+    for (auto [Begin, End] : Record->MModifiedBytes)
+      if (Begin < Size)
+        CopiedBytes.emplace_back(Begin, std::min(End, Size));
+    if (CopiedBytes.empty())
+      return nullptr;
+    CopyAll = CopiedBytes.size() == 1 && CopiedBytes[0].first == 0 &&
+              CopiedBytes[0].second == Size;
+  }
+  auto SetBytes = [Size](Requirement &BytesReq, size_t Begin, size_t End) {
+    BytesReq.MDims = 1;
+    BytesReq.MElemSize = 1;
+    BytesReq.MOffset = id<3>{Begin, 0, 0};
+    BytesReq.MAccessRange = range<3>{End - Begin, 1, 1};
+    BytesReq.MMemoryRange = range<3>{Size, 1, 1};
+  };
 
+  // The requirement of a copy back does not outlive the call when it is not
+  // waited for, so the commands copy to the data of their own requirement.
+  // Each copy of a range depends on the previous one, so that the last one
+  // completes after all of them.
   std::vector<Command *> ToCleanUp;
-  for (Command *Dep : Deps) {
-    Command *ConnCmd = MemCpyCmd->addDep(
-        DepDesc{Dep, MemCpyCmd->getRequirement(), SrcAllocaCmd}, ToCleanUp);
-    if (ConnCmd)
-      ToEnqueue.push_back(ConnCmd);
+  MemCpyCommandHost *MemCpyCmd = nullptr;
+  for (size_t I = 0; I < (CopyAll ? 1 : CopiedBytes.size()); ++I) {
+    Requirement SrcReq = *SrcAllocaCmd->getRequirement();
+    Requirement DstReq = *Req;
+    if (!CopyAll) {
+      SetBytes(SrcReq, CopiedBytes[I].first, CopiedBytes[I].second);
+      SetBytes(DstReq, CopiedBytes[I].first, CopiedBytes[I].second);
+    }
+    auto MemCpyCmdUniquePtr = std::make_unique<MemCpyCommandHost>(
+        std::move(SrcReq), SrcAllocaCmd, std::move(DstReq),
+        /*DstPtr=*/nullptr, SrcAllocaCmd->getQueue(), HostQueue);
+
+    if (!MemCpyCmdUniquePtr)
+      throw runtime_error("Out of host memory", PI_ERROR_OUT_OF_HOST_MEMORY);
+
+    MemCpyCommandHost *PrevCmd = MemCpyCmd;
+    MemCpyCmd = MemCpyCmdUniquePtr.release();
+    if (PrevCmd) {
+      Command *ConnCmd = MemCpyCmd->addDep(
+          DepDesc{PrevCmd, MemCpyCmd->getRequirement(), SrcAllocaCmd},
+          ToCleanUp);
+      if (ConnCmd)
+        ToEnqueue.push_back(ConnCmd);
+      continue;
+    }
+    for (Command *Dep : Deps) {
+      Command *ConnCmd = MemCpyCmd->addDep(
+          DepDesc{Dep, MemCpyCmd->getRequirement(), SrcAllocaCmd}, ToCleanUp);
+      if (ConnCmd)
+        ToEnqueue.push_back(ConnCmd);
+    }
   }
 
   updateLeaves(Deps, Record, Req->MAccessMode, ToCleanUp);
@@ -594,13 +732,13 @@ Scheduler::GraphBuilder::findDepsForReq(MemObjRecord *Record,
   std::vector<Command *> Visited;
   const bool ReadOnlyReq = Req->MAccessMode == access::mode::read;
 
-  std::vector<Command *> ToAnalyze{Record->MWriteLeaves.toVector()};
-
-  if (!ReadOnlyReq) {
-    std::vector<Command *> V{Record->MReadLeaves.toVector()};
-
-    ToAnalyze.insert(ToAnalyze.begin(), V.begin(), V.end());
-  }
+  // Read-only requirements don't depend on read leaves. The leaves are
+  // analyzed from the back, so the read ones go first to keep the order.
+  std::vector<Command *> ToAnalyze;
+  if (!ReadOnlyReq)
+    ToAnalyze = Record->MReadLeaves.toVector();
+  for (Command *Cmd : Record->MWriteLeaves)
+    ToAnalyze.push_back(Cmd);
 
   while (!ToAnalyze.empty()) {
     Command *DepCmd = ToAnalyze.back();
@@ -633,7 +771,7 @@ Scheduler::GraphBuilder::findDepsForReq(MemObjRecord *Record,
         break;
       }
 
-      if (markNodeAsVisited(Dep.MDepCommand, Visited))
+      if (Dep.MDepCommand && markNodeAsVisited(Dep.MDepCommand, Visited))
         NewAnalyze.push_back(Dep.MDepCommand);
     }
     ToAnalyze.insert(ToAnalyze.end(), NewAnalyze.begin(), NewAnalyze.end());
@@ -672,6 +810,14 @@ AllocaCommandBase *Scheduler::GraphBuilder::findAllocaForReq(
     }
     return Res;
   };
+  if (IsSuitableSubReq(Req)) {
+    auto [Begin, End] =
+        Record->MSubBufAllocaCommands.equal_range(getSubBufKey(Req));
+    for (auto It = Begin; It != End; ++It)
+      if (IsSuitableAlloca(It->second))
+        return It->second;
+    return nullptr;
+  }
   const auto It = std::find_if(Record->MAllocaCommands.begin(),
                                Record->MAllocaCommands.end(), IsSuitableAlloca);
   return (Record->MAllocaCommands.end() != It) ? *It : nullptr;
@@ -691,6 +837,23 @@ static bool checkHostUnifiedMemory(const ContextImplPtr &Ctx) {
   return true;
 }
 
+bool Scheduler::GraphBuilder::isPeerMemoryMoveSupported(
+    MemObjRecord *Record, const Requirement *Req, const QueueImplPtr &Queue) {
+  // Images can only be copied within a context.
+  if (Req->MSYCLMemObj->getType() != SYCLMemObjI::MemObjType::Buffer)
+    return false;
+  const AllocaCommandBase *AllocaCmdSrc =
+      findAllocaForReq(Record, Req, Record->MCurContext);
+  if (!AllocaCmdSrc || AllocaCmdSrc->getQueue()->is_host())
+    return false;
+  const QueueImplPtr &SrcQueue = AllocaCmdSrc->getQueue();
+  if (SrcQueue->getPlugin() != Queue->getPlugin())
+    return false;
+  // The copy is enqueued to the queue, so its device reads the peer memory.
+  return Queue->get_device().ext_oneapi_can_access_peer(
+      SrcQueue->get_device(), ext::oneapi::peer_access::access_supported);
+}
+
 // The function searches for the alloca command matching context and
 // requirement. If none exists, new allocation command is created.
 // Note, creation of new allocation command can lead to the current context
@@ -725,25 +888,32 @@ AllocaCommandBase *Scheduler::GraphBuilder::getOrCreateAllocaForReq(
                                 0 /*ReMOffsetInBytes*/, false /*MIsSubBuffer*/);
       // Can reuse user data for the first allocation. Do so if host unified
       // memory is supported regardless of the access mode (the pointer will be
-      // reused). For devices without host unified memory the initialization
-      // will be performed as a write operation.
-      // TODO the case where the first alloca is made with a discard mode and
-      // the user pointer is read-only is still not handled: it leads to
-      // unnecessary copy on devices with unified host memory support.
+      // reused), unless the user pointer is read-only and the data is
+      // discarded, in which case it would only be copied for nothing. For
+      // devices without host unified memory the initialization will be
+      // performed as a write operation.
       const bool HostUnifiedMemory =
           checkHostUnifiedMemory(Queue->getContextImplPtr());
       SYCLMemObjI *MemObj = Req->MSYCLMemObj;
-      const bool InitFromUserData = Record->MAllocaCommands.empty() &&
-                                    (HostUnifiedMemory || MemObj->isInterop());
+      const bool DiscardReadOnlyUserData =
+          isDiscardAccessMode(Req->MAccessMode) &&
+          MemObj->isHostPointerReadOnly() && !Queue->is_host();
+      const bool InitFromUserData =
+          Record->MAllocaCommands.empty() &&
+          ((HostUnifiedMemory && !DiscardReadOnlyUserData) ||
+           MemObj->isInterop());
       AllocaCommandBase *LinkedAllocaCmd = nullptr;
 
       // For the first allocation on a device without host unified memory we
       // might need to also create a host alloca right away in order to perform
       // the initial memory write.
       if (Record->MAllocaCommands.empty()) {
-        if (!HostUnifiedMemory &&
-            Req->MAccessMode != access::mode::discard_write &&
-            Req->MAccessMode != access::mode::discard_read_write) {
+        if (!HostUnifiedMemory && isDiscardAccessMode(Req->MAccessMode)) {
+          // The user data is not needed, so neither is the host allocation
+          // it would be copied from.
+          if (MemObj->hasUserDataPtr())
+            ++MMemoryMoveCounters.MHostAllocasSkipped;
+        } else if (!HostUnifiedMemory) {
           // There's no need to make a host allocation if the buffer is not
           // initialized with user data.
           if (MemObj->hasUserDataPtr()) {
@@ -841,6 +1011,9 @@ AllocaCommandBase *Scheduler::GraphBuilder::getOrCreateAllocaForReq(
     }
 
     Record->MAllocaCommands.push_back(AllocaCmd);
+    if (AllocaCmd->getType() == Command::CommandType::ALLOCA_SUB_BUF)
+      Record->MSubBufAllocaCommands.emplace(
+          getSubBufKey(AllocaCmd->getRequirement()), AllocaCmd);
     Record->MWriteLeaves.push_back(AllocaCmd, ToEnqueue);
     ++(AllocaCmd->MLeafCounter);
     for (Command *Cmd : ToCleanUp)
@@ -851,7 +1024,7 @@ AllocaCommandBase *Scheduler::GraphBuilder::getOrCreateAllocaForReq(
 
 // The function sets MemModified flag in record if requirement has write access.
 void Scheduler::GraphBuilder::markModifiedIfWrite(MemObjRecord *Record,
-                                                  Requirement *Req) {
+                                                  const Requirement *Req) {
   switch (Req->MAccessMode) {
   case access::mode::write:
   case access::mode::read_write:
@@ -861,8 +1034,16 @@ void Scheduler::GraphBuilder::markModifiedIfWrite(MemObjRecord *Record,
     Record->MMemModified = true;
     break;
   case access::mode::read:
-    break;
+    return;
   }
+  auto [Begin, End] = getAccessedBytes(Req);
+  // The bytes of a requirement which accesses none are not known, so it
+  // conservatively modifies all of them.
+  if (Begin == End) {
+    Begin = 0;
+    End = std::numeric_limits<size_t>::max();
+  }
+  addModifiedBytes(Record->MModifiedBytes, Begin, End);
 }
 
 EmptyCommand *Scheduler::GraphBuilder::addEmptyCmd(
@@ -1030,10 +1211,82 @@ Scheduler::GraphBuildResult Scheduler::GraphBuilder::addCG(
   createGraphForCommand(NewCmd.get(), NewCmd->getCG(),
                         isInteropHostTask(NewCmd.get()), Reqs, Events, Queue,
                         ToEnqueue);
+  updateInOrderOwnership(Reqs, Queue, CommandBuffer);
   auto Event = NewCmd->getEvent();
   return {NewCmd.release(), Event, true};
 }
 
+void Scheduler::GraphBuilder::foldInOrderFastPath(
+    MemObjRecord *Record, std::vector<Command *> &ToEnqueue) {
+  if (!Record->MInOrderOwner)
+    return;
+
+  QueueImplPtr Owner = std::move(Record->MInOrderOwner);
+  AllocaCommandBase *OwnerAlloca = Record->MInOrderOwnerAlloca;
+  EventImplPtr LastEvent = std::move(Record->MInOrderLastEvent);
+  const bool Written = Record->MInOrderWritten;
+  Record->MInOrderOwner = nullptr;
+  Record->MInOrderOwnerAlloca = nullptr;
+  Record->MInOrderLastEvent = nullptr;
+  Record->MInOrderWritten = false;
+
+  if (!LastEvent)
+    return;
+
+  // The commands submitted through the fast path are not present in the graph.
+  // Represent them with a barrier on the owner queue waiting for the latest of
+  // them, so that it becomes a leaf of the record. The owner queue is in-order,
+  // hence the barrier also covers the earlier fast path submissions.
+  auto BarrierReq =
+      std::make_shared<AccessorImplHost>(*OwnerAlloca->getRequirement());
+  BarrierReq->MAccessMode =
+      Written ? access::mode::read_write : access::mode::read;
+  std::vector<Requirement *> BarrierReqs{BarrierReq.get()};
+  std::unique_ptr<CG> Barrier{new CGBarrier(
+      {std::move(LastEvent)},
+      CG::StorageInitHelper({}, {std::move(BarrierReq)}, {},
+                            std::move(BarrierReqs), {}),
+      CG::BarrierWaitlist)};
+  GraphBuildResult Result = addCG(std::move(Barrier), Owner, ToEnqueue);
+  ToEnqueue.push_back(Result.NewCmd);
+
+  // Adding the barrier may have granted the ownership back, the caller is
+  // about to modify the leaves though.
+  Record->MInOrderOwner = nullptr;
+  Record->MInOrderOwnerAlloca = nullptr;
+}
+
+void Scheduler::GraphBuilder::updateInOrderOwnership(
+    const std::vector<Requirement *> &Reqs, const QueueImplPtr &Queue,
+    sycl::detail::pi::PiExtCommandBuffer CommandBuffer) {
+  const bool CanOwn =
+      !CommandBuffer && !Queue->is_host() && Queue->isInOrder();
+  auto AreLeavesOnQueue = [&Queue](MemObjRecord *Record) {
+    for (Command *Cmd : Record->MReadLeaves)
+      if (Cmd->getQueue() != Queue)
+        return false;
+    for (Command *Cmd : Record->MWriteLeaves)
+      if (Cmd->getQueue() != Queue)
+        return false;
+    return true;
+  };
+
+  for (Requirement *Req : Reqs) {
+    MemObjRecord *Record = getMemObjRecord(Req->MSYCLMemObj);
+    AllocaCommandBase *AllocaCmd = nullptr;
+    if (CanOwn && !Req->MIsSubBuffer &&
+        sameCtx(Queue->getContextImplPtr(), Record->MCurContext) &&
+        AreLeavesOnQueue(Record)) {
+      AllocaCmd = findAllocaForReq(Record, Req, Record->MCurContext);
+      if (AllocaCmd && (AllocaCmd->getType() != Command::ALLOCA ||
+                        AllocaCmd->MIsConst))
+        AllocaCmd = nullptr;
+    }
+    Record->MInOrderOwner = AllocaCmd ? Queue : nullptr;
+    Record->MInOrderOwnerAlloca = AllocaCmd;
+  }
+}
+
 void Scheduler::GraphBuilder::createGraphForCommand(
     Command *NewCmd, CG &CG, bool isInteropTask,
     std::vector<Requirement *> &Reqs,
@@ -1096,9 +1349,13 @@ void Scheduler::GraphBuilder::createGraphForCommand(
           MemMoveTargetQueue = HT.MQueue;
         }
       } else if (!Queue->is_host() && !Record->MCurContext->is_host())
-        NeedMemMoveToHost = true;
+        NeedMemMoveToHost = !isPeerMemoryMoveSupported(Record, Req, Queue);
 
-      if (NeedMemMoveToHost)
+      // Discarded data does not need to go through the host, which also saves
+      // the host allocation.
+      if (NeedMemMoveToHost && isDiscardAccessMode(Req->MAccessMode))
+        ++MMemoryMoveCounters.MCopiesSkipped;
+      else if (NeedMemMoveToHost)
         insertMemoryMove(Record, Req,
                          Scheduler::getInstance().getDefaultHostQueue(),
                          ToEnqueue);
@@ -1574,14 +1831,17 @@ Scheduler::GraphBuilder::completeFusion(QueueImplPtr Queue,
     return LastEvent;
   }
 
-  // Call the JIT compiler to generate a new fused kernel.
+  // Call the JIT compiler to generate a new fused kernel. In the asynchronous
+  // mode, the fused kernel is compiled in the background on the first fusion
+  // of the kernels, which then run unfused.
   auto FusedCG = detail::jit_compiler::get_instance().fuseKernels(
-      Queue, CmdList, PropList);
+      Queue, CmdList, PropList,
+      detail::SYCLConfig<detail::SYCL_ENABLE_ASYNC_FUSION>::get());
 
   if (!FusedCG) {
     // If the JIT compiler returns a nullptr, JIT compilation of the fused
-    // kernel failed. In that case, simply cancel the fusion and run each kernel
-    // on its own.
+    // kernel failed or is not complete yet. In that case, simply cancel the
+    // fusion and run each kernel on its own.
     auto LastEvent = PlaceholderCmd->getEvent();
     this->cancelFusion(Queue, ToEnqueue);
     return LastEvent;
@@ -1717,9 +1977,13 @@ Command *Scheduler::GraphBuilder::addCommandGraphUpdate(
       auto MemMoveTargetQueue = Queue;
 
       if (!Queue->is_host() && !Record->MCurContext->is_host())
-        NeedMemMoveToHost = true;
+        NeedMemMoveToHost = !isPeerMemoryMoveSupported(Record, Req, Queue);
 
-      if (NeedMemMoveToHost)
+      // Discarded data does not need to go through the host, which also saves
+      // the host allocation.
+      if (NeedMemMoveToHost && isDiscardAccessMode(Req->MAccessMode))
+        ++MMemoryMoveCounters.MCopiesSkipped;
+      else if (NeedMemMoveToHost)
         insertMemoryMove(Record, Req,
                          Scheduler::getInstance().getDefaultHostQueue(),
                          ToEnqueue);
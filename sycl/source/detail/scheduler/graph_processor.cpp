@@ -11,6 +11,7 @@
 #include <detail/scheduler/scheduler.hpp>
 
 #include <memory>
+#include <unordered_set>
 #include <vector>
 
 namespace sycl {
@@ -75,76 +76,121 @@ bool Scheduler::GraphProcessor::enqueueCommand(
     BlockingT Blocking) {
   if (!Cmd)
     return true;
-  if (Cmd->isSuccessfullyEnqueued())
-    return handleBlockingCmd(Cmd, EnqueueResult, RootCommand, Blocking);
-
-  if (KernelFusionCommand *FusionCmd = isPartOfActiveFusion(Cmd)) {
-    // The fusion is still in-flight, but some other event/command depending
-    // on one of the kernels in the fusion list has triggered it to be
-    // enqueued. To avoid circular dependencies and deadlocks, we will need to
-    // cancel fusion here and enqueue the kernels in the fusion list right
-    // away.
-    printFusionWarning("Aborting fusion because synchronization with one of "
-                       "the kernels in the fusion list was requested");
-    // We need to unlock the read lock, as cancelFusion in the scheduler will
-    // acquire a write lock to alter the graph.
-    GraphReadLock.unlock();
-    // Cancel fusion will take care of enqueueing all the kernels.
-    Scheduler::getInstance().cancelFusion(FusionCmd->getQueue());
-    // Lock the read lock again.
-    GraphReadLock.lock();
-    // The fusion (placeholder) command should have been enqueued by
-    // cancelFusion.
-    if (FusionCmd->isSuccessfullyEnqueued()) {
-      return true;
-    }
-  }
-
-  // Exit early if the command is blocked and the enqueue type is non-blocking
-  if (Cmd->isEnqueueBlocked() && !Blocking) {
-    EnqueueResult = EnqueueResultT(EnqueueResultT::SyclEnqueueBlocked, Cmd);
-    return false;
-  }
 
-  // Recursively enqueue all the implicit + explicit backend level dependencies
-  // first and exit immediately if any of the commands cannot be enqueued.
-  for (const EventImplPtr &Event : Cmd->getPreparedDepsEvents()) {
-    if (Command *DepCmd = static_cast<Command *>(Event->getCommand()))
-      if (!enqueueCommand(DepCmd, GraphReadLock, EnqueueResult, ToCleanUp,
-                          RootCommand, Blocking))
-        return false;
-  }
+  enum class VisitResultT { Done, Failed, EnqueueDeps };
+  // Checks the command before its dependencies are enqueued.
+  auto Visit = [&](Command *Cmd) {
+    if (Cmd->isSuccessfullyEnqueued())
+      return handleBlockingCmd(Cmd, EnqueueResult, RootCommand, Blocking)
+                 ? VisitResultT::Done
+                 : VisitResultT::Failed;
+
+    if (KernelFusionCommand *FusionCmd = isPartOfActiveFusion(Cmd)) {
+      // The fusion is still in-flight, but some other event/command depending
+      // on one of the kernels in the fusion list has triggered it to be
+      // enqueued. To avoid circular dependencies and deadlocks, we will need
+      // to cancel fusion here and enqueue the kernels in the fusion list right
+      // away.
+      printFusionWarning("Aborting fusion because synchronization with one of "
+                         "the kernels in the fusion list was requested");
+      // We need to unlock the read lock, as cancelFusion in the scheduler will
+      // acquire a write lock to alter the graph.
+      GraphReadLock.unlock();
+      // Cancel fusion will take care of enqueueing all the kernels.
+      Scheduler::getInstance().cancelFusion(FusionCmd->getQueue());
+      // Lock the read lock again.
+      GraphReadLock.lock();
+      // The fusion (placeholder) command should have been enqueued by
+      // cancelFusion.
+      if (FusionCmd->isSuccessfullyEnqueued())
+        return VisitResultT::Done;
+    }
 
-  // Recursively enqueue all the implicit + explicit host dependencies and
-  // exit immediately if any of the commands cannot be enqueued.
+    // Exit early if the command is blocked and the enqueue type is
+    // non-blocking
+    if (Cmd->isEnqueueBlocked() && !Blocking) {
+      EnqueueResult = EnqueueResultT(EnqueueResultT::SyclEnqueueBlocked, Cmd);
+      return VisitResultT::Failed;
+    }
+    return VisitResultT::EnqueueDeps;
+  };
+
+  VisitResultT RootResult = Visit(Cmd);
+  if (RootResult != VisitResultT::EnqueueDeps)
+    return RootResult == VisitResultT::Done;
+
+  // All the implicit + explicit backend level dependencies, then all the
+  // implicit + explicit host dependencies of a command are enqueued before it,
+  // and the process exits immediately if any of the commands cannot be
+  // enqueued. The graph is walked depth-first with an explicit stack, as the
+  // dependency chains can be too long for the stack of the thread. Each
+  // command is visited once, a command that is already visited is a
+  // dependency shared with a command enqueued before, or the graph has a cycle
+  // and the command is still on the stack.
   // Host task execution is asynchronous. In current implementation enqueue for
   // this command will wait till host task completion by waitInternal call on
   // MHostDepsEvents. TO FIX: implement enqueue of blocked commands on host task
   // completion stage and eliminate this event waiting in enqueue.
-  for (const EventImplPtr &Event : Cmd->getPreparedHostDepsEvents()) {
-    if (Command *DepCmd = static_cast<Command *>(Event->getCommand()))
-      if (!enqueueCommand(DepCmd, GraphReadLock, EnqueueResult, ToCleanUp,
-                          RootCommand, Blocking))
+  struct StackEntryT {
+    Command *Cmd;
+    // Index of the next dependency to visit in the backend level dependencies
+    // followed by the host dependencies.
+    size_t NextDep;
+  };
+  std::vector<StackEntryT> Stack{{Cmd, 0}};
+  std::unordered_set<Command *> Visited{Cmd};
+
+  // Returns the next dependency of Entry not visited yet or nullptr.
+  auto GetNextDep = [&Visited](StackEntryT &Entry) -> Command * {
+    const std::vector<EventImplPtr> &Deps = Entry.Cmd->getPreparedDepsEvents();
+    const std::vector<EventImplPtr> &HostDeps =
+        Entry.Cmd->getPreparedHostDepsEvents();
+    while (Entry.NextDep < Deps.size() + HostDeps.size()) {
+      const EventImplPtr &Event =
+          Entry.NextDep < Deps.size() ? Deps[Entry.NextDep]
+                                      : HostDeps[Entry.NextDep - Deps.size()];
+      ++Entry.NextDep;
+      if (Command *DepCmd = static_cast<Command *>(Event->getCommand()))
+        if (Visited.insert(DepCmd).second)
+          return DepCmd;
+    }
+    return nullptr;
+  };
+
+  while (!Stack.empty()) {
+    if (Command *DepCmd = GetNextDep(Stack.back())) {
+      switch (Visit(DepCmd)) {
+      case VisitResultT::Done:
+        break;
+      case VisitResultT::Failed:
         return false;
-  }
+      case VisitResultT::EnqueueDeps:
+        Stack.push_back({DepCmd, 0});
+        break;
+      }
+      continue;
+    }
 
-  // Only graph read lock is to be held here.
-  // Enqueue process of a command may last quite a time. Having graph locked can
-  // introduce some thread starving (i.e. when the other thread attempts to
-  // acquire write lock and add a command to graph). Releasing read lock without
-  // other safety measures isn't an option here as the other thread could go
-  // into graph cleanup process (due to some event complete) and remove some
-  // dependencies from dependencies of the user of this command.
-  // An example: command A depends on commands B and C. This thread wants to
-  // enqueue A. Hence, it needs to enqueue B and C. So this thread gets into
-  // dependency list and starts enqueueing B right away. The other thread waits
-  // on completion of C and starts cleanup process. This thread is still in the
-  // middle of enqueue of B. The other thread modifies dependency list of A by
-  // removing C out of it. Iterators become invalid.
-  bool Result = Cmd->enqueue(EnqueueResult, Blocking, ToCleanUp);
-  if (Result)
-    Result = handleBlockingCmd(Cmd, EnqueueResult, RootCommand, Blocking);
-  return Result;
+    Command *ReadyCmd = Stack.back().Cmd;
+    Stack.pop_back();
+    // Only graph read lock is to be held here.
+    // Enqueue process of a command may last quite a time. Having graph locked
+    // can introduce some thread starving (i.e. when the other thread attempts
+    // to acquire write lock and add a command to graph). Releasing read lock
+    // without other safety measures isn't an option here as the other thread
+    // could go into graph cleanup process (due to some event complete) and
+    // remove some dependencies from dependencies of the user of this command.
+    // An example: command A depends on commands B and C. This thread wants to
+    // enqueue A. Hence, it needs to enqueue B and C. So this thread gets into
+    // dependency list and starts enqueueing B right away. The other thread
+    // waits on completion of C and starts cleanup process. This thread is
+    // still in the middle of enqueue of B. The other thread modifies
+    // dependency list of A by removing C out of it. Iterators become invalid.
+    if (!ReadyCmd->enqueue(EnqueueResult, Blocking, ToCleanUp) ||
+        !handleBlockingCmd(ReadyCmd, EnqueueResult, RootCommand, Blocking))
+      return false;
+  }
+  return true;
 }
 
 } // namespace detail
@@ -37,6 +37,11 @@ static inline bool isHostAccessorCmd(Command *Cmd) {
 
 size_t LeavesCollection::remove(value_type Cmd) {
   if (!isHostAccessorCmd(Cmd)) {
+    auto CountIt = MGenericCommandsCount.find(Cmd);
+    if (CountIt == MGenericCommandsCount.end())
+      return 0;
+    MGenericCommandsCount.erase(CountIt);
+
     auto NewEnd =
         std::remove(MGenericCommands.begin(), MGenericCommands.end(), Cmd);
     size_t RemovedCount = std::distance(NewEnd, MGenericCommands.end());
@@ -121,9 +126,15 @@ bool LeavesCollection::addGenericCommand(Command *Cmd,
       return false;
 
     MAllocateDependency(Cmd, OldLeaf, MRecord, ToEnqueue);
+
+    // The oldest leaf is pushed out of the buffer below.
+    auto CountIt = MGenericCommandsCount.find(OldLeaf);
+    if (CountIt != MGenericCommandsCount.end() && --CountIt->second == 0)
+      MGenericCommandsCount.erase(CountIt);
   }
 
   MGenericCommands.push_back(Cmd);
+  ++MGenericCommandsCount[Cmd];
 
   return true;
 }
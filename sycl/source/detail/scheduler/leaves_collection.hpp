@@ -121,6 +121,9 @@ private:
 
   MemObjRecord *MRecord;
   GenericCommandsT MGenericCommands;
+  // Number of occurrences of each command in MGenericCommands, which lets
+  // remove() return right away for commands that aren't leaves.
+  std::unordered_map<Command *, size_t> MGenericCommandsCount;
   HostAccessorCommandsT MHostAccessorCommands;
   HostAccessorCommandsXRefT MHostAccessorCommandsXRef;
 
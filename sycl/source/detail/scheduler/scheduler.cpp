@@ -7,15 +7,21 @@
 //===----------------------------------------------------------------------===//
 
 #include "detail/sycl_mem_obj_i.hpp"
+#include <detail/config.hpp>
 #include <detail/global_handler.hpp>
 #include <detail/graph_impl.hpp>
+#include <detail/metrics.hpp>
 #include <detail/queue_impl.hpp>
 #include <detail/scheduler/scheduler.hpp>
 #include <detail/stream_impl.hpp>
+#include <detail/thread_pool.hpp>
 #include <sycl/device_selector.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <exception>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -27,6 +33,8 @@ inline namespace _V1 {
 namespace detail {
 
 bool Scheduler::checkLeavesCompletion(MemObjRecord *Record) {
+  if (Record->MInOrderLastEvent && !Record->MInOrderLastEvent->isCompleted())
+    return false;
   for (Command *Cmd : Record->MReadLeaves) {
     if (!(Cmd->getType() == detail::Command::ALLOCA ||
           Cmd->getType() == detail::Command::ALLOCA_SUB_BUF) &&
@@ -49,6 +57,10 @@ void Scheduler::waitForRecordToFinish(MemObjRecord *Record,
   std::set<Command *> DepCommands;
 #endif
   std::vector<Command *> ToCleanUp;
+  // Commands submitted through the in-order fast path are already enqueued and
+  // are not represented in the graph.
+  if (Record->MInOrderLastEvent)
+    Record->MInOrderLastEvent->waitInternal();
   for (Command *Cmd : Record->MReadLeaves) {
     EnqueueResultT Res;
     bool Enqueued =
@@ -120,6 +132,7 @@ EventImplPtr Scheduler::addCG(
 
   bool ShouldEnqueue = true;
   {
+    ScopedMetricTimer GraphBuildTimer{MetricKind::GraphBuild};
     WriteLockT Lock = acquireWriteLock();
 
     Command *NewCmd = nullptr;
@@ -150,10 +163,12 @@ EventImplPtr Scheduler::addCG(
   }
 
   if (ShouldEnqueue) {
-    enqueueCommandForCG(NewEvent, AuxiliaryCmds);
-
-    for (const auto &StreamImplPtr : Streams) {
-      StreamImplPtr->flush(NewEvent);
+    if (MSubmissionBatch.MDepth != 0) {
+      MSubmissionBatch.MCmds.push_back(
+          {NewEvent, std::move(AuxiliaryCmds), std::move(Streams)});
+    } else {
+      enqueueCommandForCG(NewEvent, AuxiliaryCmds);
+      flushStreams(Streams, NewEvent);
     }
   }
 
@@ -163,69 +178,210 @@ EventImplPtr Scheduler::addCG(
   return NewEvent;
 }
 
+EventImplPtr Scheduler::addCGInOrderFastPath(
+    const QueueImplPtr &Queue, const std::vector<Requirement *> &Requirements,
+    const std::vector<EventImplPtr> &Events,
+    const InOrderFastPathEnqueueF &Enqueue) {
+  // Enqueueing right away would overtake the deferred command groups.
+  if (MSubmissionBatch.MDepth != 0)
+    return nullptr;
+
+  ReadLockT Lock = acquireReadLock();
+
+  auto AreLeavesEnqueued = [](MemObjRecord *Record) {
+    for (Command *Cmd : Record->MReadLeaves)
+      if (!Cmd->isSuccessfullyEnqueued())
+        return false;
+    for (Command *Cmd : Record->MWriteLeaves)
+      if (!Cmd->isSuccessfullyEnqueued())
+        return false;
+    return true;
+  };
+  for (const Requirement *Req : Requirements) {
+    MemObjRecord *Record = Req->MSYCLMemObj->MRecord.get();
+    if (!Record || Record->MInOrderOwner != Queue || Req->MIsSubBuffer ||
+        !Record->MInOrderOwnerAlloca->isSuccessfullyEnqueued() ||
+        !AreLeavesEnqueued(Record))
+      return nullptr;
+  }
+
+  const ContextImplPtr &Context = Queue->getContextImplPtr();
+  std::vector<sycl::detail::pi::PiEvent> RawEvents;
+  for (const EventImplPtr &Event : Events) {
+    if (!isEventSafeForSchedulerBypass(Event, Context))
+      return nullptr;
+    if (!Event->is_host() && Event->getHandleRef())
+      RawEvents.push_back(Event->getHandleRef());
+  }
+
+  auto NewEvent = makeSharedPooled<detail::event_impl>(Queue);
+  NewEvent->setWorkerQueue(Queue);
+  NewEvent->setContextImpl(Context);
+  NewEvent->setStateIncomplete();
+  NewEvent->setSubmissionTime();
+
+  auto GetMemAllocation = [](Requirement *Req) -> void * {
+    return Req->MSYCLMemObj->MRecord->MInOrderOwnerAlloca->getMemAllocation();
+  };
+  if (PI_SUCCESS != Enqueue(GetMemAllocation, RawEvents, NewEvent))
+    throw runtime_error("Enqueue process failed.", PI_ERROR_INVALID_OPERATION);
+
+  for (Requirement *Req : Requirements) {
+    MemObjRecord *Record = Req->MSYCLMemObj->MRecord.get();
+    Record->MInOrderLastEvent = NewEvent;
+    if (Req->MAccessMode != access::mode::read) {
+      Record->MInOrderWritten = true;
+      MGraphBuilder.markModifiedIfWrite(Record, Req);
+    }
+  }
+  return NewEvent;
+}
+
+EventImplPtr
+Scheduler::addHostTaskWithoutGraph(std::unique_ptr<detail::CG> &CommandGroup,
+                                   const QueueImplPtr &Queue) {
+  assert(CommandGroup->getType() == CG::CodeplayHostTask);
+  if (!SYCLConfig<SYCL_HOST_TASK_SCHEDULER_BYPASS>::get())
+    return nullptr;
+  // In-order queues and fusion rely on the graph to order the following
+  // commands after the host task.
+  if (Queue->is_host() || Queue->isInOrder() || Queue->getCommandGraph() ||
+      isInFusionMode(Queue->getQueueID()))
+    return nullptr;
+
+  auto *HostTask = static_cast<CGHostTask *>(CommandGroup.get());
+  if (HostTask->MHostTask->isInteropTask() ||
+      !HostTask->getRequirements().empty())
+    return nullptr;
+  const ContextImplPtr &Context = Queue->getContextImplPtr();
+  for (const EventImplPtr &Event : HostTask->getEvents())
+    if (!isEventSafeForSchedulerBypass(Event, Context))
+      return nullptr;
+
+  auto NewEvent = makeSharedPooled<detail::event_impl>(
+      std::optional<event_impl::HostEventState>(event_impl::HES_NotComplete));
+  NewEvent->setWorkerQueue(Queue);
+  NewEvent->setSubmittedQueue(Queue);
+  NewEvent->setSubmissionTime();
+
+  // The job owns the command group and the event until the host task has run.
+  std::shared_ptr<CGHostTask> Task{
+      static_cast<CGHostTask *>(CommandGroup.release())};
+  auto Job = [Task = std::move(Task), NewEvent]() {
+    try {
+      for (const EventImplPtr &Event : Task->getEvents())
+        Event->waitInternal();
+      Task->MHostTask->call(NewEvent->getHostProfilingInfo());
+    } catch (...) {
+      Task->MQueue->reportAsyncException(std::current_exception());
+    }
+    Task->MHostTask.reset();
+    NewEvent->setComplete();
+  };
+  // Pin the host tasks of a queue to a single worker for cache locality.
+  // Host tasks of high priority queues overtake the queued ones.
+  Queue->getThreadPool().submit(std::move(Job), Queue->getQueueID(),
+                                /*Urgent*/ Queue->getSchedulingPriority() > 0);
+  return NewEvent;
+}
+
 void Scheduler::enqueueCommandForCG(EventImplPtr NewEvent,
                                     std::vector<Command *> &AuxiliaryCmds,
                                     BlockingT Blocking) {
   std::vector<Command *> ToCleanUp;
   {
     ReadLockT Lock = acquireReadLock();
+    enqueueCommandForCG(std::move(NewEvent), AuxiliaryCmds, Lock, ToCleanUp,
+                        Blocking);
+  }
+  cleanupCommands(ToCleanUp);
+}
 
-    Command *NewCmd =
-        (NewEvent) ? static_cast<Command *>(NewEvent->getCommand()) : nullptr;
+void Scheduler::enqueueCommandForCG(EventImplPtr NewEvent,
+                                    std::vector<Command *> &AuxiliaryCmds,
+                                    ReadLockT &Lock,
+                                    std::vector<Command *> &ToCleanUp,
+                                    BlockingT Blocking) {
+  Command *NewCmd =
+      (NewEvent) ? static_cast<Command *>(NewEvent->getCommand()) : nullptr;
 
-    EnqueueResultT Res;
-    bool Enqueued;
+  EnqueueResultT Res;
+  bool Enqueued;
 
-    auto CleanUp = [&]() {
-      if (NewCmd && (NewCmd->MDeps.size() == 0 && NewCmd->MUsers.size() == 0)) {
-        if (NewEvent) {
-          NewEvent->setCommand(nullptr);
-        }
-        delete NewCmd;
+  auto CleanUp = [&]() {
+    if (NewCmd && (NewCmd->MDeps.size() == 0 && NewCmd->MUsers.size() == 0)) {
+      if (NewEvent) {
+        NewEvent->setCommand(nullptr);
       }
-    };
+      delete NewCmd;
+    }
+  };
 
-    for (Command *Cmd : AuxiliaryCmds) {
-      Enqueued = GraphProcessor::enqueueCommand(Cmd, Lock, Res, ToCleanUp, Cmd,
-                                                Blocking);
-      try {
-        if (!Enqueued && EnqueueResultT::SyclEnqueueFailed == Res.MResult)
-          throw runtime_error("Auxiliary enqueue process failed.",
-                              PI_ERROR_INVALID_OPERATION);
-      } catch (...) {
-        // enqueueCommand() func and if statement above may throw an exception,
-        // so destroy required resources to avoid memory leak
-        CleanUp();
-        std::rethrow_exception(std::current_exception());
-      }
+  for (Command *Cmd : AuxiliaryCmds) {
+    Enqueued = GraphProcessor::enqueueCommand(Cmd, Lock, Res, ToCleanUp, Cmd,
+                                              Blocking);
+    try {
+      if (!Enqueued && EnqueueResultT::SyclEnqueueFailed == Res.MResult)
+        throw runtime_error("Auxiliary enqueue process failed.",
+                            PI_ERROR_INVALID_OPERATION);
+    } catch (...) {
+      // enqueueCommand() func and if statement above may throw an exception,
+      // so destroy required resources to avoid memory leak
+      CleanUp();
+      std::rethrow_exception(std::current_exception());
     }
+  }
 
-    if (NewCmd) {
-      // TODO: Check if lazy mode.
-      EnqueueResultT Res;
-      try {
-        bool Enqueued = GraphProcessor::enqueueCommand(
-            NewCmd, Lock, Res, ToCleanUp, NewCmd, Blocking);
-        if (!Enqueued && EnqueueResultT::SyclEnqueueFailed == Res.MResult)
-          throw runtime_error("Enqueue process failed.",
-                              PI_ERROR_INVALID_OPERATION);
-      } catch (...) {
-        // enqueueCommand() func and if statement above may throw an exception,
-        // so destroy required resources to avoid memory leak
-        CleanUp();
-        std::rethrow_exception(std::current_exception());
-      }
+  if (NewCmd) {
+    // TODO: Check if lazy mode.
+    EnqueueResultT Res;
+    try {
+      bool Enqueued = GraphProcessor::enqueueCommand(NewCmd, Lock, Res,
+                                                     ToCleanUp, NewCmd, Blocking);
+      if (!Enqueued && EnqueueResultT::SyclEnqueueFailed == Res.MResult)
+        throw runtime_error("Enqueue process failed.",
+                            PI_ERROR_INVALID_OPERATION);
+    } catch (...) {
+      // enqueueCommand() func and if statement above may throw an exception,
+      // so destroy required resources to avoid memory leak
+      CleanUp();
+      std::rethrow_exception(std::current_exception());
     }
   }
+}
+
+thread_local Scheduler::SubmissionBatch Scheduler::MSubmissionBatch;
+
+void Scheduler::beginBatch() { ++MSubmissionBatch.MDepth; }
+
+void Scheduler::flushBatch() {
+  assert(MSubmissionBatch.MDepth != 0 && "No submission batch to flush");
+  if (--MSubmissionBatch.MDepth != 0)
+    return;
+
+  std::vector<DeferredEnqueue> Cmds = std::move(MSubmissionBatch.MCmds);
+  MSubmissionBatch.MCmds.clear();
+  if (Cmds.empty())
+    return;
+
+  std::vector<Command *> ToCleanUp;
+  {
+    ReadLockT Lock = acquireReadLock();
+    for (DeferredEnqueue &Cmd : Cmds)
+      enqueueCommandForCG(Cmd.MEvent, Cmd.MAuxiliaryCmds, Lock, ToCleanUp);
+  }
   cleanupCommands(ToCleanUp);
+
+  for (DeferredEnqueue &Cmd : Cmds)
+    flushStreams(Cmd.MStreams, Cmd.MEvent);
 }
 
-EventImplPtr Scheduler::addCopyBack(Requirement *Req) {
+EventImplPtr Scheduler::addCopyBack(Requirement *Req, bool OnlyModifiedBytes) {
   std::vector<Command *> AuxiliaryCmds;
   Command *NewCmd = nullptr;
   {
     WriteLockT Lock = acquireWriteLock();
-    NewCmd = MGraphBuilder.addCopyBack(Req, AuxiliaryCmds);
+    NewCmd = MGraphBuilder.addCopyBack(Req, AuxiliaryCmds, OnlyModifiedBytes);
     // Command was not creted because there were no operations with
     // buffer.
     if (!NewCmd)
@@ -381,17 +537,120 @@ void Scheduler::enqueueLeavesOfReqUnlocked(const Requirement *const Req,
 void Scheduler::enqueueUnblockedCommands(
     const std::vector<EventImplPtr> &ToEnqueue, ReadLockT &GraphReadLock,
     std::vector<Command *> &ToCleanUp) {
-  for (auto &Event : ToEnqueue) {
-    Command *Cmd = static_cast<Command *>(Event->getCommand());
-    if (!Cmd)
-      continue;
-    EnqueueResultT Res;
-    bool Enqueued =
-        GraphProcessor::enqueueCommand(Cmd, GraphReadLock, Res, ToCleanUp, Cmd);
-    if (!Enqueued && EnqueueResultT::SyclEnqueueFailed == Res.MResult)
-      throw runtime_error("Enqueue process failed.",
-                          PI_ERROR_INVALID_OPERATION);
+  // Release the commands of higher priority queues first, keeping the order
+  // of the ones with the same priority.
+  std::vector<std::pair<int, Command *>> Cmds;
+  Cmds.reserve(ToEnqueue.size());
+  for (auto &Event : ToEnqueue)
+    if (Command *Cmd = static_cast<Command *>(Event->getCommand()))
+      Cmds.emplace_back(Cmd->getQueue()->getSchedulingPriority(), Cmd);
+  std::stable_sort(Cmds.begin(), Cmds.end(),
+                   [](const std::pair<int, Command *> &LHS,
+                      const std::pair<int, Command *> &RHS) {
+                     return LHS.first > RHS.first;
+                   });
+
+  // The commands of a queue are enqueued in order by the same thread, the
+  // ones of different queues are independent.
+  std::vector<std::vector<EventImplPtr>> Groups;
+  if (SYCLConfig<SYCL_PARALLEL_UNBLOCKED_ENQUEUE>::get()) {
+    std::vector<const queue_impl *> GroupQueues;
+    for (const std::pair<int, Command *> &PriorityAndCmd : Cmds) {
+      Command *Cmd = PriorityAndCmd.second;
+      auto It = std::find(GroupQueues.begin(), GroupQueues.end(),
+                          Cmd->getQueue().get());
+      if (It == GroupQueues.end()) {
+        GroupQueues.push_back(Cmd->getQueue().get());
+        Groups.emplace_back();
+        It = GroupQueues.end() - 1;
+      }
+      Groups[It - GroupQueues.begin()].push_back(Cmd->getEvent());
+    }
+  }
+
+  if (Groups.size() < 2) {
+    for (const std::pair<int, Command *> &PriorityAndCmd : Cmds) {
+      Command *Cmd = PriorityAndCmd.second;
+      EnqueueResultT Res;
+      bool Enqueued = GraphProcessor::enqueueCommand(Cmd, GraphReadLock, Res,
+                                                     ToCleanUp, Cmd);
+      if (!Enqueued && EnqueueResultT::SyclEnqueueFailed == Res.MResult)
+        throw runtime_error("Enqueue process failed.",
+                            PI_ERROR_INVALID_OPERATION);
+    }
+    return;
+  }
+
+  // The groups are taken in order by the calling thread and by jobs of the
+  // thread pool, so that they are all enqueued by the calling thread if the
+  // workers are busy. The jobs hold the events, as the commands of the groups
+  // taken after the calling thread has released the graph lock can be cleaned
+  // up meanwhile. The groups are only taken by the jobs holding the graph
+  // lock, so that the calling thread can wait for all of them to be done and
+  // throw the first failure, as when it enqueues the commands alone.
+  struct UnblockedGroupsT {
+    std::vector<std::vector<EventImplPtr>> Groups;
+    std::atomic<size_t> Next{0};
+    std::mutex Mutex;
+    std::condition_variable AllDone;
+    size_t NumDone = 0;
+    std::exception_ptr Error;
+  };
+  auto Unblocked = std::make_shared<UnblockedGroupsT>();
+  Unblocked->Groups = std::move(Groups);
+  auto EnqueueGroups = [](UnblockedGroupsT &Unblocked, ReadLockT &Lock,
+                          std::vector<Command *> &ToCleanUp) {
+    for (size_t Group = Unblocked.Next++; Group < Unblocked.Groups.size();
+         Group = Unblocked.Next++) {
+      std::exception_ptr Error;
+      try {
+        for (const EventImplPtr &Event : Unblocked.Groups[Group]) {
+          // The command may have been enqueued and cleaned up by a wait on
+          // its event meanwhile.
+          Command *Cmd = static_cast<Command *>(Event->getCommand());
+          if (!Cmd)
+            continue;
+          EnqueueResultT Res;
+          bool Enqueued =
+              GraphProcessor::enqueueCommand(Cmd, Lock, Res, ToCleanUp, Cmd);
+          if (!Enqueued && EnqueueResultT::SyclEnqueueFailed == Res.MResult)
+            throw runtime_error("Enqueue process failed.",
+                                PI_ERROR_INVALID_OPERATION);
+        }
+      } catch (...) {
+        Error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> Guard(Unblocked.Mutex);
+      if (Error && !Unblocked.Error)
+        Unblocked.Error = Error;
+      if (++Unblocked.NumDone == Unblocked.Groups.size())
+        Unblocked.AllDone.notify_all();
+    }
+  };
+
+  ThreadPool &Pool = GlobalHandler::instance().getHostTaskThreadPool();
+  const size_t NumJobs =
+      std::min(Unblocked->Groups.size() - 1, Pool.getThreadCount());
+  for (size_t I = 0; I < NumJobs; ++I) {
+    Pool.submit(
+        [Unblocked, EnqueueGroups]() {
+          std::vector<Command *> ToCleanUp;
+          {
+            ReadLockT Lock = Scheduler::getInstance().acquireReadLock();
+            EnqueueGroups(*Unblocked, Lock, ToCleanUp);
+          }
+          Scheduler::getInstance().cleanupCommands(ToCleanUp);
+        },
+        /*AffinityKey=*/I, /*Urgent=*/true);
   }
+  EnqueueGroups(*Unblocked, GraphReadLock, ToCleanUp);
+
+  std::unique_lock<std::mutex> Guard(Unblocked->Mutex);
+  Unblocked->AllDone.wait(Guard, [&Unblocked]() {
+    return Unblocked->NumDone == Unblocked->Groups.size();
+  });
+  if (Unblocked->Error)
+    std::rethrow_exception(Unblocked->Error);
 }
 
 Scheduler::Scheduler() {
@@ -404,9 +663,14 @@ Scheduler::Scheduler() {
                      /*PropList=*/{sycl::property::queue::enable_profiling()}));
 }
 
-Scheduler::~Scheduler() { DefaultHostQueue.reset(); }
+Scheduler::~Scheduler() {
+  stopCleanupThread();
+  DefaultHostQueue.reset();
+}
 
 void Scheduler::releaseResources(BlockingT Blocking) {
+  if (Blocking == BlockingT::BLOCKING)
+    stopCleanupThread();
   //  There might be some commands scheduled for post enqueue cleanup that
   //  haven't been freed because of the graph mutex being locked at the time,
   //  clean them up now.
@@ -437,6 +701,8 @@ void Scheduler::cleanupCommands(const std::vector<Command *> &Cmds) {
     std::lock_guard<std::mutex> Lock{MDeferredCleanupMutex};
     if (MDeferredCleanupCommands.empty())
       return;
+  } else if (deferCleanupToBackgroundThread(Cmds)) {
+    return;
   }
 
   WriteLockT Lock(MGraphLock, std::try_to_lock);
@@ -469,6 +735,64 @@ void Scheduler::cleanupCommands(const std::vector<Command *> &Cmds) {
   }
 }
 
+bool Scheduler::deferCleanupToBackgroundThread(
+    const std::vector<Command *> &Cmds) {
+  if (!SYCLConfig<SYCL_BACKGROUND_COMMAND_CLEANUP>::get())
+    return false;
+  // Fusion commands must never be deferred, see cleanupCommands.
+  if (std::any_of(Cmds.begin(), Cmds.end(), [](const Command *Cmd) {
+        return Cmd->getType() == Command::CommandType::FUSION;
+      }))
+    return false;
+
+  {
+    std::lock_guard<std::mutex> Lock{MDeferredCleanupMutex};
+    if (MStopCleanupThread)
+      return false;
+    MDeferredCleanupCommands.insert(MDeferredCleanupCommands.end(),
+                                    Cmds.begin(), Cmds.end());
+    if (!MCleanupThread.joinable())
+      MCleanupThread = std::thread([this]() { cleanupThreadMain(); });
+  }
+  MCleanupThreadCV.notify_one();
+  return true;
+}
+
+void Scheduler::cleanupThreadMain() {
+  GlobalHandler::instance().registerSchedulerUsage(/*ModifyCounter*/ false);
+  std::unique_lock<std::mutex> Lock{MDeferredCleanupMutex};
+  while (true) {
+    MCleanupThreadCV.wait(Lock, [this]() {
+      return MStopCleanupThread || !MDeferredCleanupCommands.empty();
+    });
+    // The pending commands are cleaned up before the thread is stopped.
+    if (MDeferredCleanupCommands.empty())
+      break;
+
+    // Take all the commands that are pending now, the ones that are added
+    // while the graph lock is held are cleaned up as the next batch.
+    std::vector<Command *> Batch;
+    std::swap(Batch, MDeferredCleanupCommands);
+    Lock.unlock();
+    {
+      WriteLockT GraphLock = acquireWriteLock();
+      for (Command *Cmd : Batch)
+        MGraphBuilder.cleanupCommand(Cmd);
+    }
+    Lock.lock();
+  }
+}
+
+void Scheduler::stopCleanupThread() {
+  {
+    std::lock_guard<std::mutex> Lock{MDeferredCleanupMutex};
+    MStopCleanupThread = true;
+  }
+  MCleanupThreadCV.notify_one();
+  if (MCleanupThread.joinable())
+    MCleanupThread.join();
+}
+
 void Scheduler::NotifyHostTaskCompletion(Command *Cmd) {
   // Completing command's event along with unblocking enqueue readiness of
   // empty command may lead to quick deallocation of MThisCmd by some cleanup
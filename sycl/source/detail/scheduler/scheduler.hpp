@@ -13,11 +13,16 @@
 #include <detail/sycl_mem_obj_i.hpp>
 #include <sycl/detail/cg.hpp>
 
+#include <condition_variable>
 #include <cstddef>
+#include <functional>
+#include <map>
 #include <memory>
 #include <queue>
 #include <set>
 #include <shared_mutex>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -208,6 +213,14 @@ struct MemObjRecord {
   // Contains all allocation commands for the memory object.
   std::vector<AllocaCommandBase *> MAllocaCommands;
 
+  // The offset in bytes and the range of a sub-buffer.
+  using SubBufKeyT = std::tuple<size_t, size_t, size_t, size_t>;
+
+  // Contains the sub-buffer allocation commands of MAllocaCommands by
+  // sub-buffer, so that those of a sub-buffer are found without going through
+  // the allocations of all the sub-buffers of the memory object.
+  std::multimap<SubBufKeyT, AllocaCommandBase *> MSubBufAllocaCommands;
+
   // Contains latest read only commands working with memory object.
   LeavesCollection MReadLeaves;
 
@@ -224,6 +237,31 @@ struct MemObjRecord {
   // The flag indicates that the content of the memory object was/will be
   // modified. Used while deciding if copy back needed.
   bool MMemModified = false;
+
+  // The bytes [Begin, End) of the memory object which were/will be modified,
+  // sorted and disjoint. Used to copy back only these bytes to the host data
+  // the memory object was initialized from.
+  std::vector<std::pair<size_t, size_t>> MModifiedBytes;
+
+  // The in-order queue that exclusively owns the memory object, i.e. all the
+  // leaves of the record belong to it and the latest memory is in its context.
+  // Only this queue may submit kernels accessing the memory object through
+  // the in-order fast path (see Scheduler::addCGInOrderFastPath). Updated by
+  // the GraphBuilder under the graph write lock.
+  QueueImplPtr MInOrderOwner;
+
+  // The allocation used by the owner queue.
+  AllocaCommandBase *MInOrderOwnerAlloca = nullptr;
+
+  // The event of the latest command submitted through the in-order fast path,
+  // which is not represented in the leaves. Updated under the graph read lock
+  // by the owner queue only, the submissions of which are serialized by the
+  // queue itself.
+  EventImplPtr MInOrderLastEvent;
+
+  // The flag indicates that one of the commands submitted through the in-order
+  // fast path since the last fold into the graph writes the memory object.
+  bool MInOrderWritten = false;
 };
 
 /// DPC++ graph scheduler class.
@@ -387,8 +425,63 @@ public:
   ///
   /// \param Req is a requirement that points to the memory where data is
   /// needed.
+  /// \param OnlyModifiedBytes is true if the memory already holds the data the
+  /// memory object was initialized from, so that only the modified bytes of a
+  /// buffer are copied.
   /// \return an event object to wait on for copy finish.
-  EventImplPtr addCopyBack(Requirement *Req);
+  EventImplPtr addCopyBack(Requirement *Req, bool OnlyModifiedBytes = false);
+
+  /// Starts a submission batch for the calling thread.
+  ///
+  /// Command groups added by the thread with addCG are still added to the
+  /// graph right away, but enqueueing them is deferred until the batch is
+  /// flushed, so that they are enqueued and cleaned up under a single graph
+  /// read lock. Batches may be nested, the outermost one is flushed.
+  void beginBatch();
+
+  /// Enqueues the command groups added since the matching beginBatch() call,
+  /// in the order they were added.
+  void flushBatch();
+
+  using InOrderFastPathEnqueueF = std::function<pi_int32(
+      const std::function<void *(Requirement *Req)> &GetMemAllocation,
+      std::vector<sycl::detail::pi::PiEvent> &RawEvents,
+      const EventImplPtr &NewEvent)>;
+
+  /// Submits a kernel accessing memory objects exclusively owned by an
+  /// in-order queue without adding it to the dependency graph.
+  ///
+  /// Only the read side of the graph lock is taken. The submission is recorded
+  /// in the memory object records and folded into the graph as soon as another
+  /// queue or a host accessor requires one of the memory objects.
+  ///
+  /// \param Queue is an in-order queue the kernel is submitted to.
+  /// \param Requirements are the requirements of the command group.
+  /// \param Events are the event dependencies of the command group.
+  /// \param Enqueue is a function enqueueing the kernel to the backend.
+  /// \return an event object to wait on for kernel completion, or nullptr if
+  /// the fast path can't be used and the command group must be passed to
+  /// addCG.
+  EventImplPtr
+  addCGInOrderFastPath(const QueueImplPtr &Queue,
+                       const std::vector<Requirement *> &Requirements,
+                       const std::vector<EventImplPtr> &Events,
+                       const InOrderFastPathEnqueueF &Enqueue);
+
+  /// Runs a host task on the thread pool without adding it to the graph.
+  ///
+  /// Only host tasks that don't access memory objects, aren't interop tasks
+  /// and only depend on enqueued device events are run this way, and only if
+  /// SYCL_HOST_TASK_SCHEDULER_BYPASS is enabled.
+  ///
+  /// \param CommandGroup is a host task command group. It is left intact if
+  /// the host task has to be passed to addCG.
+  /// \param Queue is the queue the host task is submitted to.
+  /// \return an event that is completed once the host task has run, or
+  /// nullptr if the host task must be passed to addCG.
+  EventImplPtr
+  addHostTaskWithoutGraph(std::unique_ptr<detail::CG> &CommandGroup,
+                          const QueueImplPtr &Queue);
 
   /// Waits for the event.
   ///
@@ -538,12 +631,50 @@ protected:
   /// avoidance
   ReadLockT acquireReadLock() { return ReadLockT{MGraphLock}; }
 
+  /// Same as enqueueCommandForCG above, for the callers already holding the
+  /// graph read lock.
+  void enqueueCommandForCG(EventImplPtr NewEvent,
+                           std::vector<Command *> &AuxilaryCmds,
+                           ReadLockT &GraphReadLock,
+                           std::vector<Command *> &ToCleanUp,
+                           BlockingT Blocking = NON_BLOCKING);
+
+  /// A command group added to the graph, the enqueue of which is deferred
+  /// until the submission batch is flushed.
+  struct DeferredEnqueue {
+    EventImplPtr MEvent;
+    std::vector<Command *> MAuxiliaryCmds;
+    std::vector<StreamImplPtr> MStreams;
+  };
+
+  struct SubmissionBatch {
+    size_t MDepth = 0;
+    std::vector<DeferredEnqueue> MCmds;
+  };
+
+  // The submission batch of the current thread, see beginBatch().
+  static thread_local SubmissionBatch MSubmissionBatch;
+
   /// Provides shared access to std::shared_timed_mutex object with deadlock
   /// avoidance to the Fusion map
   ReadLockT acquireFusionReadLock() { return ReadLockT{MFusionMapLock}; }
 
   void cleanupCommands(const std::vector<Command *> &Cmds);
 
+  /// Hands the commands over to the background cleanup thread if
+  /// SYCL_BACKGROUND_COMMAND_CLEANUP is enabled.
+  ///
+  /// \return true if the commands will be cleaned up by the background thread.
+  bool deferCleanupToBackgroundThread(const std::vector<Command *> &Cmds);
+
+  /// Cleans up the commands handed over by deferCleanupToBackgroundThread
+  /// until stopCleanupThread is called.
+  void cleanupThreadMain();
+
+  /// Stops the background cleanup thread once it has processed the pending
+  /// commands. The following commands are cleaned up inline.
+  void stopCleanupThread();
+
   void NotifyHostTaskCompletion(Command *Cmd);
 
   static void enqueueLeavesOfReqUnlocked(const Requirement *const Req,
@@ -610,7 +741,10 @@ protected:
     /// Enqueues a command to update memory to the latest state.
     ///
     /// \param Req is a requirement, that describes memory object.
-    Command *addCopyBack(Requirement *Req, std::vector<Command *> &ToEnqueue);
+    /// \param OnlyModifiedBytes is true if only the modified bytes of a buffer
+    /// are to be copied.
+    Command *addCopyBack(Requirement *Req, std::vector<Command *> &ToEnqueue,
+                         bool OnlyModifiedBytes = false);
 
     /// Enqueues a command to create a host accessor.
     ///
@@ -645,6 +779,18 @@ protected:
                                           const Requirement *Req,
                                           std::vector<Command *> &ToEnqueue);
 
+    /// Adds the commands submitted through the in-order fast path for the
+    /// record to the graph and drops the ownership of the memory object.
+    void foldInOrderFastPath(MemObjRecord *Record,
+                             std::vector<Command *> &ToEnqueue);
+
+    /// Updates the in-order fast path ownership of the records used by the
+    /// command.
+    void
+    updateInOrderOwnership(const std::vector<Requirement *> &Reqs,
+                           const QueueImplPtr &Queue,
+                           sycl::detail::pi::PiExtCommandBuffer CommandBuffer);
+
     /// Decrements leaf counters for all leaves of the record.
     void decrementLeafCountersForRecord(MemObjRecord *Record);
 
@@ -708,8 +854,28 @@ protected:
         std::vector<detail::EventImplPtr> &Events,
         std::vector<Command *> &ToEnqueue);
 
+    /// Marks the memory object as modified, and the bytes it accesses as
+    /// modified, if the requirement writes it.
+    void markModifiedIfWrite(MemObjRecord *Record, const Requirement *Req);
+
     std::vector<SYCLMemObjI *> MMemObjs;
 
+    /// Numbers of the memory moves made and avoided by the graph builder.
+    /// Updated under the graph lock.
+    struct MemoryMoveCounters {
+      /// Copies inserted between allocations of memory objects.
+      size_t MCopiesInserted = 0;
+      /// Copies not needed because the access discards the contents.
+      size_t MCopiesSkipped = 0;
+      /// Host allocations not needed to initialize a memory object with user
+      /// data because the first access discards it.
+      size_t MHostAllocasSkipped = 0;
+    };
+
+    const MemoryMoveCounters &getMemoryMoveCounters() const {
+      return MMemoryMoveCounters;
+    }
+
   private:
     /// Inserts the command required to update the memory object state in the
     /// context.
@@ -735,6 +901,12 @@ protected:
                            const QueueImplPtr &Queue,
                            std::vector<Command *> &ToEnqueue);
 
+    /// Checks if the memory object can be copied directly from the device it
+    /// is currently on to the device of the queue, which is in another
+    /// context, instead of through the host.
+    bool isPeerMemoryMoveSupported(MemObjRecord *Record, const Requirement *Req,
+                                   const QueueImplPtr &Queue);
+
     /// Finds dependencies for the requirement.
     std::set<Command *> findDepsForReq(MemObjRecord *Record,
                                        const Requirement *Req,
@@ -776,8 +948,6 @@ protected:
                             const QueueImplPtr &Queue,
                             std::vector<Command *> &ToEnqueue);
 
-    void markModifiedIfWrite(MemObjRecord *Record, Requirement *Req);
-
     FusionMap::iterator findFusionList(QueueIdT Id) {
       return MFusionMap.find(Id);
     }
@@ -811,6 +981,8 @@ protected:
       Size
     };
     std::array<bool, PrintOptions::Size> MPrintOptionsArray{false};
+
+    MemoryMoveCounters MMemoryMoveCounters;
   };
 
   /// Graph Processor provides interfaces for enqueueing commands and their
@@ -951,6 +1123,11 @@ protected:
 
   std::vector<Command *> MDeferredCleanupCommands;
   std::mutex MDeferredCleanupMutex;
+  // Thread that cleans up MDeferredCleanupCommands if background cleanup is
+  // enabled. The fields below are protected by MDeferredCleanupMutex.
+  std::thread MCleanupThread;
+  std::condition_variable MCleanupThreadCV;
+  bool MStopCleanupThread = false;
 
   std::vector<std::shared_ptr<SYCLMemObjI>> MDeferredMemObjRelease;
   std::mutex MDeferredMemReleaseMutex;
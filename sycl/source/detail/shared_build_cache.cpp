@@ -0,0 +1,109 @@
+//==------ shared_build_cache.cpp - Builds shared between contexts ---------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/config.hpp>
+#include <detail/device_binary_image.hpp>
+#include <detail/device_impl.hpp>
+#include <detail/persistent_device_code_cache.hpp>
+#include <detail/shared_build_cache.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+
+SharedBuildCache::Build &
+SharedBuildCache::Build::operator=(Build &&Other) noexcept {
+  release();
+  MCache = std::exchange(Other.MCache, nullptr);
+  MKey = std::move(Other.MKey);
+  MBinary = std::move(Other.MBinary);
+  return *this;
+}
+
+void SharedBuildCache::Build::complete(const device &Device,
+                                       sycl::detail::pi::PiProgram Program) {
+  if (!MCache)
+    return;
+
+  std::vector<std::vector<char>> Binaries;
+  try {
+    Binaries =
+        PersistentDeviceCodeCache::getProgramBinaryData(Device, Program);
+  } catch (...) {
+  }
+  // The other contexts build the image themselves if no binary is found.
+  if (Binaries.size() != 1 || Binaries[0].empty()) {
+    release();
+    return;
+  }
+
+  auto Binary =
+      std::make_shared<const std::vector<char>>(std::move(Binaries[0]));
+  {
+    std::lock_guard<std::mutex> Lock(MCache->MMutex);
+    MCache->MBinaries[MKey] = std::move(Binary);
+    --MCache->MNumBuilding;
+  }
+  MCache->MBuildDone.notify_all();
+  MCache = nullptr;
+}
+
+void SharedBuildCache::Build::release() {
+  if (!MCache)
+    return;
+  // One of the contexts waiting for the build takes it over.
+  {
+    std::lock_guard<std::mutex> Lock(MCache->MMutex);
+    MCache->MBinaries.erase(MKey);
+    --MCache->MNumBuilding;
+  }
+  MCache->MBuildDone.notify_all();
+  MCache = nullptr;
+}
+
+SharedBuildCache::Build
+SharedBuildCache::acquire(const device &Device, const RTDeviceBinaryImage &Img,
+                          const SerializedObj &SpecConsts,
+                          const std::string &Options) {
+  Build Result;
+  // Only the images compiled by the backend are worth sharing.
+  if (!SYCLConfig<SYCL_SHARE_PROGRAM_BUILDS>::get() ||
+      Img.getFormat() != PI_DEVICE_BINARY_TYPE_SPIRV)
+    return Result;
+
+  static const size_t MaxBuilding =
+      std::max(1u, std::thread::hardware_concurrency());
+  KeyT Key{getSyclObjImpl(Device)->getHandleRef(), Img.getImageID(),
+           SpecConsts, Options};
+
+  std::unique_lock<std::mutex> Lock(MMutex);
+  while (true) {
+    auto It = MBinaries.find(Key);
+    if (It != MBinaries.end() && It->second) {
+      Result.MBinary = It->second;
+      return Result;
+    }
+    if (It == MBinaries.end() && MNumBuilding < MaxBuilding)
+      break;
+    MBuildDone.wait(Lock);
+  }
+
+  MBinaries.emplace(Key, nullptr);
+  ++MNumBuilding;
+  Result.MCache = this;
+  Result.MKey = std::move(Key);
+  return Result;
+}
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
@@ -0,0 +1,93 @@
+//==------ shared_build_cache.hpp - Builds shared between contexts ---------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sycl/detail/pi.hpp>
+#include <sycl/detail/util.hpp>
+#include <sycl/device.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+class RTDeviceBinaryImage;
+
+/// Shares the native binaries of the programs built from an image for a
+/// device between the contexts of the process, so that each image is only
+/// built once per device, specialization constants and options, and the
+/// other contexts create their programs from the binary. A context asking for
+/// a build which is in progress in another context waits for its binary. The
+/// number of builds running at once is bounded by the number of hardware
+/// threads, so that the contexts building different images do not
+/// oversubscribe the CPU.
+///
+/// The builds are only shared when SYCL_SHARE_PROGRAM_BUILDS is set. The
+/// binaries are kept for the lifetime of the program manager.
+class SharedBuildCache {
+public:
+  using KeyT = std::tuple<sycl::detail::pi::PiDevice, std::uintptr_t,
+                          SerializedObj, std::string>;
+
+  /// A build of a program for one device. Either it holds the binary built by
+  /// another context, or the program is built by its owner, which holds one
+  /// of the build slots until the binary is shared with complete() or the
+  /// build is dropped, e.g. because it failed.
+  class Build {
+  public:
+    Build() = default;
+    Build(const Build &) = delete;
+    Build &operator=(const Build &) = delete;
+    Build(Build &&Other) noexcept { *this = std::move(Other); }
+    Build &operator=(Build &&Other) noexcept;
+    ~Build() { release(); }
+
+    /// \return the binary built by another context, or nullptr.
+    const std::vector<char> *getBinary() const { return MBinary.get(); }
+
+    /// Shares the binary of the program built by the owner of the build.
+    void complete(const device &Device, sycl::detail::pi::PiProgram Program);
+
+  private:
+    friend class SharedBuildCache;
+
+    void release();
+
+    /// Set while the owner builds the program.
+    SharedBuildCache *MCache = nullptr;
+    KeyT MKey;
+    std::shared_ptr<const std::vector<char>> MBinary;
+  };
+
+  /// Returns the build of the image for the device with the given
+  /// specialization constants and options, waiting for it if another context
+  /// is building it, or for a build slot if this context has to build it. The
+  /// returned build is empty if the builds are not shared.
+  Build acquire(const device &Device, const RTDeviceBinaryImage &Img,
+                const SerializedObj &SpecConsts, const std::string &Options);
+
+private:
+  std::mutex MMutex;
+  std::condition_variable MBuildDone;
+  /// The shared binaries, null while their build is in progress.
+  std::map<KeyT, std::shared_ptr<const std::vector<char>>> MBinaries;
+  size_t MNumBuilding = 0;
+};
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
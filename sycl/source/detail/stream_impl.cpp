@@ -93,40 +93,56 @@ void stream_impl::initStreamHost(QueueImplPtr Queue) {
   });
 }
 
-void stream_impl::flush(const EventImplPtr &LeadEvent) {
+void flushStreams(const std::vector<StreamImplPtr> &Streams,
+                  const EventImplPtr &LeadEvent) {
+  if (Streams.empty())
+    return;
   // We don't want stream flushing to be blocking operation that is why submit a
   // host task to print stream buffer. It will fire up as soon as the kernel
-  // finishes execution.
+  // finishes execution. All the streams of a kernel are printed by the same
+  // host task so that the kernel is followed by a single scheduler command.
+  using HostAccT = accessor<char, 1, access::mode::read_write,
+                            access::target::host_buffer>;
   auto Q = detail::createSyclObjFromImpl<queue>(
       sycl::detail::Scheduler::getInstance().getDefaultHostQueue());
   event Event = Q.submit([&](handler &cgh) {
-    auto BufHostAcc =
-        Buf_.get_access<access::mode::read_write, access::target::host_buffer>(
-            cgh, range<1>(BufferSize_), id<1>(OffsetSize));
-    // Create accessor to the flush buffer even if not using it yet. Otherwise
-    // kernel will be a leaf for the flush buffer and scheduler will not be able
-    // to cleanup the kernel. TODO: get rid of finalize method by using host
-    // accessor to the flush buffer.
-    auto FlushBufHostAcc =
-        FlushBuf_
-            .get_access<access::mode::read_write, access::target::host_buffer>(
-                cgh);
-    cgh.host_task([=] {
-      if (!BufHostAcc.empty()) {
-        // SYCL 2020, 4.16:
-        // > If the totalBufferSize or workItemBufferSize limits are exceeded,
-        // > it is implementation-defined whether the streamed characters
-        // > exceeding the limit are output, or silently ignored/discarded, and
-        // > if output it is implementation-defined whether those extra
-        // > characters exceeding the workItemBufferSize limit count toward the
-        // > totalBufferSize limit. Regardless of this implementation defined
-        // > behavior of output exceeding the limits, no undefined or erroneous
-        // > behavior is permitted of an implementation when the limits are
-        // > exceeded.
-        //
-        // Defend against zero-sized buffers (although they'd have no practical
-        // use).
-        printf("%s", &(BufHostAcc[0]));
+    std::vector<HostAccT> BufHostAccs;
+    std::vector<HostAccT> FlushBufHostAccs;
+    BufHostAccs.reserve(Streams.size());
+    FlushBufHostAccs.reserve(Streams.size());
+    for (const StreamImplPtr &Stream : Streams) {
+      BufHostAccs.push_back(
+          Stream->Buf_.get_access<access::mode::read_write,
+                                  access::target::host_buffer>(
+              cgh, range<1>(Stream->BufferSize_),
+              id<1>(stream_impl::OffsetSize)));
+      // Create accessor to the flush buffer even if not using it yet.
+      // Otherwise kernel will be a leaf for the flush buffer and scheduler will
+      // not be able to cleanup the kernel. TODO: get rid of finalize method by
+      // using host accessor to the flush buffer.
+      FlushBufHostAccs.push_back(
+          Stream->FlushBuf_.get_access<access::mode::read_write,
+                                       access::target::host_buffer>(cgh));
+    }
+    cgh.host_task([BufHostAccs = std::move(BufHostAccs),
+                   FlushBufHostAccs = std::move(FlushBufHostAccs)] {
+      for (const HostAccT &BufHostAcc : BufHostAccs) {
+        if (!BufHostAcc.empty()) {
+          // SYCL 2020, 4.16:
+          // > If the totalBufferSize or workItemBufferSize limits are
+          // > exceeded, it is implementation-defined whether the streamed
+          // > characters exceeding the limit are output, or silently
+          // > ignored/discarded, and if output it is implementation-defined
+          // > whether those extra characters exceeding the workItemBufferSize
+          // > limit count toward the totalBufferSize limit. Regardless of this
+          // > implementation defined behavior of output exceeding the limits,
+          // > no undefined or erroneous behavior is permitted of an
+          // > implementation when the limits are exceeded.
+          //
+          // Defend against zero-sized buffers (although they'd have no
+          // practical use).
+          printf("%s", &(BufHostAcc[0]));
+        }
       }
       fflush(stdout);
     });
@@ -138,6 +154,11 @@ void stream_impl::flush(const EventImplPtr &LeadEvent) {
   }
 }
 
+void stream_impl::flush(const EventImplPtr &LeadEvent) {
+  // The stream is only used during the submission, it is not owned.
+  flushStreams({StreamImplPtr(StreamImplPtr{}, this)}, LeadEvent);
+}
+
 void stream_impl::flush() { flush(nullptr); }
 } // namespace detail
 } // namespace _V1
@@ -16,12 +16,23 @@
 #include <sycl/range.hpp>
 #include <sycl/stream.hpp>
 
+#include <memory>
 #include <vector>
 
 namespace sycl {
 inline namespace _V1 {
 namespace detail {
 
+class stream_impl;
+using StreamImplPtr = std::shared_ptr<stream_impl>;
+
+// Enqueue a single host task copying the buffers of all the Streams to the
+// host and printing their contents in order. The host task event is then
+// registered for post processing in the LeadEvent as well as in queue
+// LeadEvent associated with.
+void flushStreams(const std::vector<StreamImplPtr> &Streams,
+                  const EventImplPtr &LeadEvent);
+
 class __SYCL_EXPORT stream_impl {
 public:
   // TODO: This constructor is unused.
@@ -93,6 +104,9 @@ private:
   // Additinonal memory is allocated in the beginning of the stream buffer for
   // 2 variables: offset in the stream buffer and offset in the flush buffer.
   static const size_t OffsetSize = 2 * sizeof(unsigned);
+
+  friend void flushStreams(const std::vector<StreamImplPtr> &Streams,
+                           const EventImplPtr &LeadEvent);
 };
 
 } // namespace detail
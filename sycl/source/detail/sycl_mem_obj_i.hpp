@@ -69,6 +69,10 @@ public:
 
   virtual bool usesPinnedHostMemory() const = 0;
 
+  // Returns true if the devices sharing memory with the host are expected to
+  // use the host memory of the object instead of copying it.
+  virtual bool isZeroCopy() const = 0;
+
   // Returns the context which is passed if a memory object is created using
   // interoperability constructor, nullptr otherwise.
   virtual ContextImplPtr getInteropContext() const = 0;
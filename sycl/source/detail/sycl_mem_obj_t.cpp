@@ -6,6 +6,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <detail/config.hpp>
 #include <detail/context_impl.hpp>
 #include <detail/event_impl.hpp>
 #include <detail/memory_manager.hpp>
@@ -17,6 +18,11 @@ namespace sycl {
 inline namespace _V1 {
 namespace detail {
 
+void reportZeroCopyFallback(const char *Reason) {
+  if (SYCLConfig<SYCL_RT_WARNING_LEVEL>::get() > 0)
+    std::cerr << "WARNING: zero_copy memory object: " << Reason << "\n";
+}
+
 SYCLMemObjT::SYCLMemObjT(pi_native_handle MemObject, const context &SyclContext,
                          const size_t, event AvailableEvent,
                          std::unique_ptr<SYCLMemObjAllocator> Allocator)
@@ -140,8 +146,9 @@ void SYCLMemObjT::updateHostMemory(void *const Ptr) {
                   Dims, ElemSize, size_t(0));
   Req.MData = Ptr;
 
-  EventImplPtr Event = Scheduler::getInstance().addCopyBack(&Req);
-  if (Event)
+  EventImplPtr Event = Scheduler::getInstance().addCopyBack(
+      &Req, /*OnlyModifiedBytes=*/Ptr == MInitialHostData);
+  if (Event && !MAsyncCopyBack)
     Event->wait(Event);
 }
 
@@ -228,9 +235,21 @@ void SYCLMemObjT::detachMemoryObject(
       !MOwnNativeHandle ||
       (MInteropContext && !MInteropContext->isOwnedByRuntime());
 
-  if (MRecord && MRecord->MCurContext->isOwnedByRuntime() &&
-      !InteropObjectsUsed && (!MHostPtrProvided || MIsInternal))
+  if (!MRecord || !MRecord->MCurContext->isOwnedByRuntime() ||
+      InteropObjectsUsed)
+    return;
+  if (!MHostPtrProvided || MIsInternal) {
     Scheduler::getInstance().deferMemObjRelease(Self);
+  } else if (isAsyncRelease()) {
+    // The write back is enqueued while the memory object is still alive, and
+    // the deferred release waits for it along with the other commands.
+    if (Self->needsWriteBack()) {
+      Self->MAsyncCopyBack = true;
+      Self->MUploadDataFunctor();
+      Self->MUploadDataFunctor = nullptr;
+    }
+    Scheduler::getInstance().deferMemObjRelease(Self);
+  }
 }
 
 void SYCLMemObjT::handleWriteAccessorCreation() {
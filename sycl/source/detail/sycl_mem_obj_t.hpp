@@ -19,6 +19,7 @@
 #include <sycl/property_list.hpp>
 #include <sycl/range.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
 #include <memory>
@@ -36,6 +37,10 @@ class plugin;
 using ContextImplPtr = std::shared_ptr<context_impl>;
 using EventImplPtr = std::shared_ptr<event_impl>;
 
+/// Warns that the data of a memory object with the zero_copy property has to
+/// be copied, if enabled by SYCL_RT_WARNING_LEVEL.
+void reportZeroCopyFallback(const char *Reason);
+
 // The class serves as a base for all SYCL memory objects.
 class __SYCL_EXPORT SYCLMemObjT : public SYCLMemObjI {
 
@@ -189,6 +194,7 @@ public:
       set_final_data([HostPtr](const std::function<void(void *const Ptr)> &F) {
         F(HostPtr);
       });
+      MInitialHostData = HostPtr;
     }
 
     if (HostPtr) {
@@ -197,12 +203,18 @@ public:
       } else if (canReadHostPtr(HostPtr, RequiredAlign)) {
         MUserPtr = HostPtr;
         MCreateShadowCopy = [this, RequiredAlign, HostPtr]() -> void {
+          if (isZeroCopy())
+            reportZeroCopyFallback("the host pointer is read-only, its data "
+                                   "is copied for write access");
           setAlign(RequiredAlign);
           MShadowCopy = allocateHostMem();
           MUserPtr = MShadowCopy;
           std::memcpy(MUserPtr, HostPtr, MSizeInBytes);
         };
       } else {
+        if (isZeroCopy())
+          reportZeroCopyFallback("the host pointer is not aligned to a page, "
+                                 "its data is copied");
         setAlign(RequiredAlign);
         MShadowCopy = allocateHostMem();
         MUserPtr = MShadowCopy;
@@ -222,20 +234,28 @@ public:
     MSharedPtrStorage = HostPtr;
     MHostPtrReadOnly = IsConstPtr;
     if (HostPtr) {
-      if (!MHostPtrReadOnly)
+      if (!MHostPtrReadOnly) {
         set_final_data_from_storage();
+        MInitialHostData = HostPtr.get();
+      }
 
       if (canReuseHostPtr(HostPtr.get(), RequiredAlign)) {
         MUserPtr = HostPtr.get();
       } else if (canReadHostPtr(HostPtr.get(), RequiredAlign)) {
         MUserPtr = HostPtr.get();
         MCreateShadowCopy = [this, RequiredAlign, HostPtr]() -> void {
+          if (isZeroCopy())
+            reportZeroCopyFallback("the host pointer is read-only, its data "
+                                   "is copied for write access");
           setAlign(RequiredAlign);
           MShadowCopy = allocateHostMem();
           MUserPtr = MShadowCopy;
           std::memcpy(MUserPtr, HostPtr.get(), MSizeInBytes);
         };
       } else {
+        if (isZeroCopy())
+          reportZeroCopyFallback("the host pointer is not aligned to a page, "
+                                 "its data is copied");
         setAlign(RequiredAlign);
         MShadowCopy = allocateHostMem();
         MUserPtr = MShadowCopy;
@@ -265,6 +285,34 @@ public:
     MAllocator->setAlignment(RequiredAlign);
   }
 
+  /// Alignment of the host memory of the zero_copy memory objects, which
+  /// backends require to use it for the device allocations.
+  static constexpr size_t ZeroCopyAlignment = 4096;
+
+  bool isZeroCopy() const override {
+    return has_property<
+        ext::oneapi::experimental::property::buffer::zero_copy>();
+  }
+
+  /// \return the alignment the host memory of the object must have.
+  size_t getHostDataAlignment(size_t RequiredAlign) const {
+    return isZeroCopy() ? std::max(RequiredAlign, ZeroCopyAlignment)
+                        : RequiredAlign;
+  }
+
+  bool isAsyncRelease() const {
+    return has_property<
+        ext::oneapi::experimental::property::buffer::async_release>();
+  }
+
+  /// Allocates the host memory of a zero_copy object created without host
+  /// data, for the device allocations to use.
+  void handleZeroCopyHostMem() {
+    setAlign(ZeroCopyAlignment);
+    MShadowCopy = allocateHostMem();
+    MUserPtr = MShadowCopy;
+  }
+
   static size_t getBufSizeForContext(const ContextImplPtr &Context,
                                      pi_native_handle MemObject);
 
@@ -369,6 +417,12 @@ protected:
   // objects can be released in a deferred manner regardless of whether a host
   // pointer was provided or not.
   bool MIsInternal = false;
+  // Indicates that the write back to the host is not waited for, as it has
+  // been enqueued by the destruction of an async_release memory object.
+  bool MAsyncCopyBack = false;
+  // The writable host data the memory object was initialized from, which only
+  // the modified bytes of a buffer are written back to.
+  void *MInitialHostData = nullptr;
   // The number of graphs which are currently using this memory object.
   std::atomic<size_t> MGraphUseCount = 0;
   // Function which creates a shadow copy of the host pointer. This is used to
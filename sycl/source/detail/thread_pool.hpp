@@ -1,4 +1,4 @@
-//===-- thread_pool.hpp - Simple thread pool --------------------*- C++ -*-===//
+//===-- thread_pool.hpp - Work-stealing thread pool -------------*- C++ -*-===//
 //
 // Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
 // See https://llvm.org/LICENSE.txt for license information.
@@ -11,9 +11,14 @@
 #include <algorithm>
 #include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <new>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <sycl/detail/defines.hpp>
@@ -22,62 +27,244 @@ namespace sycl {
 inline namespace _V1 {
 namespace detail {
 
+/// Move-only type-erased job, which stores callables that fit into the inline
+/// buffer without allocating.
+class ThreadPoolJob {
+public:
+  static constexpr size_t InlineSize = 6 * sizeof(void *);
+
+  ThreadPoolJob() = default;
+
+  template <typename T, typename FuncT = std::decay_t<T>,
+            typename = std::enable_if_t<
+                !std::is_same_v<FuncT, ThreadPoolJob>>>
+  ThreadPoolJob(T &&Func) {
+    if constexpr (fitsInline<FuncT>()) {
+      new (&MStorage) FuncT(std::forward<T>(Func));
+      MOps = &InlineOps<FuncT>;
+    } else {
+      *reinterpret_cast<FuncT **>(&MStorage) =
+          new FuncT(std::forward<T>(Func));
+      MOps = &HeapOps<FuncT>;
+    }
+  }
+
+  ThreadPoolJob(ThreadPoolJob &&Other) noexcept : MOps(Other.MOps) {
+    if (MOps) {
+      MOps->Move(&MStorage, &Other.MStorage);
+      Other.MOps = nullptr;
+    }
+  }
+
+  ThreadPoolJob &operator=(ThreadPoolJob &&Other) noexcept {
+    if (this != &Other) {
+      reset();
+      MOps = Other.MOps;
+      if (MOps) {
+        MOps->Move(&MStorage, &Other.MStorage);
+        Other.MOps = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  ThreadPoolJob(const ThreadPoolJob &) = delete;
+  ThreadPoolJob &operator=(const ThreadPoolJob &) = delete;
+
+  ~ThreadPoolJob() { reset(); }
+
+  explicit operator bool() const { return MOps != nullptr; }
+
+  void operator()() { MOps->Invoke(&MStorage); }
+
+private:
+  struct OpsT {
+    void (*Invoke)(void *Storage);
+    // Move-constructs the job into Dst and destroys the one in Src.
+    void (*Move)(void *Dst, void *Src);
+    void (*Destroy)(void *Storage);
+  };
+
+  template <typename FuncT> static constexpr bool fitsInline() {
+    return sizeof(FuncT) <= InlineSize &&
+           alignof(FuncT) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible_v<FuncT>;
+  }
+
+  template <typename FuncT>
+  static constexpr OpsT InlineOps = {
+      [](void *Storage) { (*static_cast<FuncT *>(Storage))(); },
+      [](void *Dst, void *Src) {
+        new (Dst) FuncT(std::move(*static_cast<FuncT *>(Src)));
+        static_cast<FuncT *>(Src)->~FuncT();
+      },
+      [](void *Storage) { static_cast<FuncT *>(Storage)->~FuncT(); }};
+
+  template <typename FuncT>
+  static constexpr OpsT HeapOps = {
+      [](void *Storage) { (**static_cast<FuncT **>(Storage))(); },
+      [](void *Dst, void *Src) {
+        *static_cast<FuncT **>(Dst) = *static_cast<FuncT **>(Src);
+      },
+      [](void *Storage) { delete *static_cast<FuncT **>(Storage); }};
+
+  void reset() {
+    if (MOps) {
+      MOps->Destroy(&MStorage);
+      MOps = nullptr;
+    }
+  }
+
+  alignas(std::max_align_t) unsigned char MStorage[InlineSize];
+  const OpsT *MOps = nullptr;
+};
+
+/// Thread pool where each worker owns a job deque. Workers take jobs from the
+/// front of their own deque and steal from the back of the other ones when
+/// theirs is empty, so that submissions from different threads rarely contend
+/// on the same lock.
 class ThreadPool {
+  struct alignas(64) WorkerQueue {
+    std::mutex MMutex;
+    std::deque<ThreadPoolJob> MJobs;
+  };
+
   std::vector<std::thread> MLaunchedThreads;
 
   size_t MThreadCount;
-  std::queue<std::function<void()>> MJobQueue;
-  std::mutex MJobQueueMutex;
+  std::unique_ptr<WorkerQueue[]> MWorkerQueues;
+
+  // Used to put idle workers to sleep.
+  std::mutex MSleepMutex;
   std::condition_variable MDoSmthOrStop;
+  std::atomic_uint MSleepingWorkers;
+
+  // Used by drain() to wait for all the submitted jobs to complete.
+  std::mutex MDrainMutex;
+  std::condition_variable MDrained;
+
   std::atomic_bool MStop;
+  // Number of jobs waiting in the worker queues.
+  std::atomic_uint MJobsQueued;
+  // Number of jobs either queued or running.
   std::atomic_uint MJobsInPool;
+  std::atomic_size_t MNextWorker;
+
+  bool tryPopOwn(size_t Idx, ThreadPoolJob &Job) {
+    WorkerQueue &Queue = MWorkerQueues[Idx];
+    std::lock_guard<std::mutex> Lock(Queue.MMutex);
+    if (Queue.MJobs.empty())
+      return false;
+    Job = std::move(Queue.MJobs.front());
+    Queue.MJobs.pop_front();
+    return true;
+  }
+
+  bool trySteal(size_t Idx, ThreadPoolJob &Job) {
+    for (size_t Offset = 1; Offset < MThreadCount; ++Offset) {
+      WorkerQueue &Queue = MWorkerQueues[(Idx + Offset) % MThreadCount];
+      std::unique_lock<std::mutex> Lock(Queue.MMutex, std::try_to_lock);
+      if (!Lock.owns_lock() || Queue.MJobs.empty())
+        continue;
+      Job = std::move(Queue.MJobs.back());
+      Queue.MJobs.pop_back();
+      return true;
+    }
+    return false;
+  }
+
+  bool tryGetJob(size_t Idx, ThreadPoolJob &Job) {
+    if (MJobsQueued.load() == 0)
+      return false;
+    if (!tryPopOwn(Idx, Job) && !trySteal(Idx, Job))
+      return false;
+    MJobsQueued--;
+    return true;
+  }
 
-  void worker() {
+  void worker(size_t Idx) {
     GlobalHandler::instance().registerSchedulerUsage(/*ModifyCounter*/ false);
-    std::unique_lock<std::mutex> Lock(MJobQueueMutex);
     while (true) {
-      MDoSmthOrStop.wait(
-          Lock, [this]() { return !MJobQueue.empty() || MStop.load(); });
+      ThreadPoolJob Job;
+      if (!tryGetJob(Idx, Job)) {
+        std::unique_lock<std::mutex> Lock(MSleepMutex);
+        MSleepingWorkers++;
+        MDoSmthOrStop.wait(
+            Lock, [this]() { return MJobsQueued.load() != 0 || MStop.load(); });
+        MSleepingWorkers--;
+        if (MStop.load())
+          break;
+        continue;
+      }
 
       if (MStop.load())
         break;
 
-      std::function<void()> Job = std::move(MJobQueue.front());
-      MJobQueue.pop();
-      Lock.unlock();
-
       Job();
+      // Release the resources captured by the job before reporting it done.
+      Job = ThreadPoolJob{};
 
-      Lock.lock();
-
-      MJobsInPool--;
+      if (--MJobsInPool == 0) {
+        std::lock_guard<std::mutex> Lock(MDrainMutex);
+        MDrained.notify_all();
+      }
     }
   }
 
   void start() {
     MLaunchedThreads.reserve(MThreadCount);
+    MWorkerQueues.reset(new WorkerQueue[MThreadCount]);
 
     MStop.store(false);
+    MSleepingWorkers.store(0);
+    MJobsQueued.store(0);
     MJobsInPool.store(0);
+    MNextWorker.store(0);
 
     for (size_t Idx = 0; Idx < MThreadCount; ++Idx)
-      MLaunchedThreads.emplace_back([this] { worker(); });
+      MLaunchedThreads.emplace_back([this, Idx] { worker(Idx); });
+  }
+
+  void push(ThreadPoolJob &&Job, size_t Idx, bool Urgent = false) {
+    MJobsInPool++;
+    {
+      WorkerQueue &Queue = MWorkerQueues[Idx];
+      std::lock_guard<std::mutex> Lock(Queue.MMutex);
+      // Workers take their own jobs from the front, so urgent jobs overtake
+      // the ones already queued.
+      if (Urgent)
+        Queue.MJobs.push_front(std::move(Job));
+      else
+        Queue.MJobs.push_back(std::move(Job));
+    }
+    MJobsQueued++;
+    // Idle workers check MJobsQueued under MSleepMutex before going to sleep,
+    // so the notification can only be skipped if none of them is sleeping.
+    if (MSleepingWorkers.load() != 0) {
+      std::lock_guard<std::mutex> Lock(MSleepMutex);
+      MDoSmthOrStop.notify_one();
+    }
   }
 
 public:
+  /// Blocks until all the submitted jobs are complete.
   void drain() {
-    while (MJobsInPool != 0)
-      std::this_thread::yield();
+    std::unique_lock<std::mutex> Lock(MDrainMutex);
+    MDrained.wait(Lock, [this]() { return MJobsInPool.load() == 0; });
   }
 
-  ThreadPool(unsigned int ThreadCount = 1) : MThreadCount(ThreadCount) {
+  ThreadPool(unsigned int ThreadCount = 1)
+      : MThreadCount(std::max(ThreadCount, 1u)) {
     start();
   }
 
   ~ThreadPool() { finishAndWait(); }
 
   void finishAndWait() {
-    MStop.store(true);
+    {
+      std::lock_guard<std::mutex> Lock(MSleepMutex);
+      MStop.store(true);
+    }
 
     MDoSmthOrStop.notify_all();
 
@@ -86,22 +273,22 @@ public:
         Thread.join();
   }
 
+  size_t getThreadCount() const { return MThreadCount; }
+
+  /// Submits a job to the workers in a round-robin manner.
   template <typename T> void submit(T &&Func) {
-    {
-      std::lock_guard<std::mutex> Lock(MJobQueueMutex);
-      MJobQueue.emplace([F = std::move(Func)]() { F(); });
-    }
-    MJobsInPool++;
-    MDoSmthOrStop.notify_one();
+    push(ThreadPoolJob{std::forward<T>(Func)},
+         MNextWorker.fetch_add(1, std::memory_order_relaxed) % MThreadCount);
   }
 
-  void submit(std::function<void()> &&Func) {
-    {
-      std::lock_guard<std::mutex> Lock(MJobQueueMutex);
-      MJobQueue.emplace(Func);
-    }
-    MJobsInPool++;
-    MDoSmthOrStop.notify_one();
+  /// Submits a job to the worker designated by the affinity key, so that jobs
+  /// sharing the key are run by the same worker unless it is stolen by an
+  /// idle one.
+  /// Urgent jobs are run before the ones already queued for the worker.
+  template <typename T>
+  void submit(T &&Func, size_t AffinityKey, bool Urgent = false) {
+    push(ThreadPoolJob{std::forward<T>(Func)}, AffinityKey % MThreadCount,
+         Urgent);
   }
 };
 
@@ -0,0 +1,338 @@
+//==------- memory_pool_impl.cpp - Stream-ordered USM memory pools ---------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/context_impl.hpp>
+#include <detail/event_impl.hpp>
+#include <detail/queue_impl.hpp>
+#include <detail/usm/memory_pool_impl.hpp>
+#include <detail/usm/usm_impl.hpp>
+
+#include <limits>
+
+namespace sycl {
+inline namespace _V1 {
+namespace ext::oneapi::experimental {
+namespace detail {
+
+namespace {
+// Sizes of the allocations are rounded up to it, so that the memory of freed
+// allocations can be reused by allocations of slightly different sizes.
+constexpr size_t BlockSizeGranularity = 256;
+} // namespace
+
+memory_pool_impl::memory_pool_impl(
+    sycl::detail::context_impl &Context,
+    std::shared_ptr<sycl::detail::device_impl> Device, sycl::usm::alloc Kind,
+    size_t ReleaseThreshold,
+    std::shared_ptr<sycl::detail::context_impl> ContextOwner)
+    : MContext(Context), MContextOwner(std::move(ContextOwner)),
+      MDevice(std::move(Device)), MKind(Kind),
+      MReleaseThreshold(ReleaseThreshold) {
+  if (Kind != sycl::usm::alloc::device && Kind != sycl::usm::alloc::shared) {
+    throw sycl::exception(
+        make_error_code(errc::feature_not_supported),
+        "Memory pools only support device and shared allocations.");
+  }
+}
+
+memory_pool_impl::~memory_pool_impl() {
+  const sycl::detail::PluginPtr &Plugin = MContext.getPlugin();
+  for (auto &[Size, Block] : MFreeBlocks) {
+    try {
+      if (Block.MFreeEvent) {
+        Plugin->call_nocheck<sycl::detail::PiApiKind::piEventsWait>(
+            1, &Block.MFreeEvent);
+      } else if (Block.MPendingEvent) {
+        Block.MPendingEvent->wait(Block.MPendingEvent);
+      } else if (auto Queue = Block.MFreeQueue.lock();
+                 Queue && Block.MIsUntracked) {
+        Queue->wait();
+      }
+    } catch (...) {
+      // Failures of the commands are reported through their own events.
+    }
+    releaseBlock(Block);
+  }
+  // Allocations which have not been freed are released with the pool.
+  for (auto &[Ptr, Size] : MUsedBlocks) {
+    sycl::detail::usm::freeInternal(Ptr, &MContext);
+  }
+}
+
+void *memory_pool_impl::allocate(sycl::detail::queue_impl &Queue,
+                                 size_t Size) {
+  if (Size == 0) {
+    return nullptr;
+  }
+  const size_t BlockSize = (Size + BlockSizeGranularity - 1) /
+                           BlockSizeGranularity * BlockSizeGranularity;
+
+  std::lock_guard<std::mutex> Lock(MMutex);
+  // Blocks up to twice as large as needed are reused. The ones freed on the
+  // same in-order queue can be used right away, the other ones once the
+  // commands using them have completed.
+  void *Ptr = nullptr;
+  size_t Found = 0;
+  for (auto It = MFreeBlocks.lower_bound(BlockSize);
+       It != MFreeBlocks.end() && It->first <= 2 * BlockSize; ++It) {
+    free_block &Block = It->second;
+    const bool IsSameQueue =
+        Queue.isInOrder() && Block.MFreeQueue.lock().get() == &Queue;
+    if (IsSameQueue || isComplete(Block)) {
+      Ptr = Block.MPtr;
+      Found = It->first;
+      if (Block.MFreeEvent) {
+        MContext.getPlugin()->call<sycl::detail::PiApiKind::piEventRelease>(
+            Block.MFreeEvent);
+      }
+      MFreeBlocks.erase(It);
+      break;
+    }
+  }
+
+  if (!Ptr) {
+    Ptr = sycl::detail::usm::alignedAllocInternal(0, BlockSize, &MContext,
+                                                  MDevice.get(), MKind);
+    if (!Ptr) {
+      // Return the memory which is not in use anymore and retry.
+      const size_t Threshold = MReleaseThreshold;
+      MReleaseThreshold = 0;
+      trim();
+      MReleaseThreshold = Threshold;
+      Ptr = sycl::detail::usm::alignedAllocInternal(0, BlockSize, &MContext,
+                                                    MDevice.get(), MKind);
+      if (!Ptr) {
+        throw sycl::exception(make_error_code(errc::memory_allocation),
+                              "Failed to allocate memory from a memory pool.");
+      }
+    }
+    Found = BlockSize;
+    MReservedSize += BlockSize;
+  }
+
+  MUsedBlocks.emplace(Ptr, Found);
+  MUsedSize += Found;
+  trim();
+  return Ptr;
+}
+
+void memory_pool_impl::deallocate(
+    const std::shared_ptr<sycl::detail::queue_impl> &Queue, void *Ptr,
+    const std::shared_ptr<sycl::detail::event_impl> &FreeEvent) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  auto It = MUsedBlocks.find(Ptr);
+  assert(It != MUsedBlocks.end() && "Memory not allocated from the pool");
+  const size_t Size = It->second;
+  MUsedBlocks.erase(It);
+  MUsedSize -= Size;
+
+  free_block Block{Ptr, Queue};
+  if (FreeEvent->isDiscarded()) {
+    Block.MIsUntracked = true;
+  } else if (!FreeEvent->isCompleted()) {
+    if (sycl::detail::pi::PiEvent Handle = FreeEvent->getHandleRef()) {
+      MContext.getPlugin()->call<sycl::detail::PiApiKind::piEventRetain>(
+          Handle);
+      Block.MFreeEvent = Handle;
+    } else {
+      Block.MPendingEvent = FreeEvent;
+    }
+  }
+  MFreeBlocks.emplace(Size, std::move(Block));
+  trim();
+}
+
+bool memory_pool_impl::isComplete(free_block &Block) {
+  if (Block.MIsUntracked) {
+    return false;
+  }
+  const sycl::detail::PluginPtr &Plugin = MContext.getPlugin();
+  if (Block.MPendingEvent) {
+    if (Block.MPendingEvent->isCompleted()) {
+      Block.MPendingEvent.reset();
+      return true;
+    }
+    sycl::detail::pi::PiEvent Handle = Block.MPendingEvent->getHandleRef();
+    if (!Handle) {
+      return false;
+    }
+    Plugin->call<sycl::detail::PiApiKind::piEventRetain>(Handle);
+    Block.MFreeEvent = Handle;
+    Block.MPendingEvent.reset();
+  }
+  if (!Block.MFreeEvent) {
+    return true;
+  }
+
+  pi_int32 Status = 0;
+  Plugin->call<sycl::detail::PiApiKind::piEventGetInfo>(
+      Block.MFreeEvent, PI_EVENT_INFO_COMMAND_EXECUTION_STATUS, sizeof(Status),
+      &Status, nullptr);
+  if (Status != PI_EVENT_COMPLETE) {
+    return false;
+  }
+  Plugin->call<sycl::detail::PiApiKind::piEventRelease>(Block.MFreeEvent);
+  Block.MFreeEvent = nullptr;
+  return true;
+}
+
+void memory_pool_impl::trim() {
+  // The largest blocks are returned first.
+  for (auto It = MFreeBlocks.rbegin();
+       It != MFreeBlocks.rend() && MReservedSize > MReleaseThreshold;) {
+    if (!isComplete(It->second)) {
+      ++It;
+      continue;
+    }
+    MReservedSize -= It->first;
+    releaseBlock(It->second);
+    It = std::make_reverse_iterator(MFreeBlocks.erase(std::next(It).base()));
+  }
+}
+
+void memory_pool_impl::releaseBlock(free_block &Block) {
+  if (Block.MFreeEvent) {
+    MContext.getPlugin()->call_nocheck<sycl::detail::PiApiKind::piEventRelease>(
+        Block.MFreeEvent);
+    Block.MFreeEvent = nullptr;
+  }
+  sycl::detail::usm::freeInternal(Block.MPtr, &MContext);
+}
+
+size_t memory_pool_impl::getReleaseThreshold() const {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  return MReleaseThreshold;
+}
+
+void memory_pool_impl::setReleaseThreshold(size_t Threshold) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  MReleaseThreshold = Threshold;
+  trim();
+}
+
+size_t memory_pool_impl::getReservedSize() const {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  return MReservedSize;
+}
+
+size_t memory_pool_impl::getUsedSize() const {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  return MUsedSize;
+}
+
+} // namespace detail
+
+memory_pool::memory_pool(const context &SyclContext, const device &SyclDevice,
+                         usm::alloc Kind, const property_list &PropList) {
+  size_t Threshold = std::numeric_limits<size_t>::max();
+  if (PropList.has_property<property::memory_pool::release_threshold>()) {
+    Threshold =
+        PropList.get_property<property::memory_pool::release_threshold>()
+            .get_threshold();
+  }
+  auto ContextImpl = sycl::detail::getSyclObjImpl(SyclContext);
+  impl = std::make_shared<detail::memory_pool_impl>(
+      *ContextImpl, sycl::detail::getSyclObjImpl(SyclDevice), Kind, Threshold,
+      ContextImpl);
+}
+
+memory_pool::memory_pool(const queue &SyclQueue, usm::alloc Kind,
+                         const property_list &PropList)
+    : memory_pool(SyclQueue.get_context(), SyclQueue.get_device(), Kind,
+                  PropList) {}
+
+context memory_pool::get_context() const {
+  return sycl::detail::createSyclObjFromImpl<context>(impl->getContextOwner());
+}
+
+device memory_pool::get_device() const {
+  return sycl::detail::createSyclObjFromImpl<device>(impl->getDeviceImpl());
+}
+
+usm::alloc memory_pool::get_alloc_kind() const { return impl->getKind(); }
+
+size_t memory_pool::get_release_threshold() const {
+  return impl->getReleaseThreshold();
+}
+
+void memory_pool::set_release_threshold(size_t Threshold) {
+  impl->setReleaseThreshold(Threshold);
+}
+
+size_t memory_pool::get_reserved_size_current() const {
+  return impl->getReservedSize();
+}
+
+size_t memory_pool::get_used_size_current() const {
+  return impl->getUsedSize();
+}
+
+namespace {
+void *asyncMalloc(const queue &SyclQueue, size_t Size,
+                  const std::shared_ptr<detail::memory_pool_impl> &Pool) {
+  auto QueueImpl = sycl::detail::getSyclObjImpl(SyclQueue);
+  if (QueueImpl->getCommandGraph()) {
+    throw sycl::exception(make_error_code(errc::invalid),
+                          "async_malloc cannot be called on a queue which is "
+                          "recording a command graph.");
+  }
+  void *Ptr = Pool->allocate(*QueueImpl, Size);
+  if (Ptr) {
+    QueueImpl->getContextImplPtr()->addAsyncAllocation(Ptr, Pool);
+  }
+  return Ptr;
+}
+} // namespace
+
+void *async_malloc(const queue &SyclQueue, usm::alloc Kind, size_t Size) {
+  auto QueueImpl = sycl::detail::getSyclObjImpl(SyclQueue);
+  return asyncMalloc(SyclQueue, Size,
+                     QueueImpl->getContextImplPtr()->getDefaultMemoryPool(
+                         QueueImpl->getDeviceImplPtr(), Kind));
+}
+
+void *async_malloc_from_pool(const queue &SyclQueue, size_t Size,
+                             const memory_pool &Pool) {
+  auto PoolImpl = sycl::detail::getSyclObjImpl(Pool);
+  auto QueueImpl = sycl::detail::getSyclObjImpl(SyclQueue);
+  if (&PoolImpl->getContextImpl() != QueueImpl->getContextImplPtr().get() ||
+      PoolImpl->getDeviceImpl() != QueueImpl->getDeviceImplPtr()) {
+    throw sycl::exception(make_error_code(errc::invalid),
+                          "The queue passed to async_malloc_from_pool must "
+                          "have the context and device of the pool.");
+  }
+  return asyncMalloc(SyclQueue, Size, PoolImpl);
+}
+
+void async_free(const queue &SyclQueue, void *Ptr) {
+  if (!Ptr) {
+    return;
+  }
+  auto QueueImpl = sycl::detail::getSyclObjImpl(SyclQueue);
+  if (QueueImpl->getCommandGraph()) {
+    throw sycl::exception(make_error_code(errc::invalid),
+                          "async_free cannot be called on a queue which is "
+                          "recording a command graph.");
+  }
+  std::shared_ptr<detail::memory_pool_impl> Pool =
+      QueueImpl->getContextImplPtr()->takeAsyncAllocation(Ptr);
+  if (!Pool) {
+    throw sycl::exception(make_error_code(errc::invalid),
+                          "Pointer passed to async_free was not allocated by "
+                          "async_malloc in the context of the queue.");
+  }
+  // For in-order queues, this is the event of the last command when there is
+  // one, so no command needs to be enqueued.
+  queue Queue = SyclQueue;
+  event FreeEvent = Queue.ext_oneapi_submit_barrier();
+  Pool->deallocate(QueueImpl, Ptr, sycl::detail::getSyclObjImpl(FreeEvent));
+}
+
+} // namespace ext::oneapi::experimental
+} // namespace _V1
+} // namespace sycl
@@ -0,0 +1,127 @@
+//==------- memory_pool_impl.hpp - Stream-ordered USM memory pools ---------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sycl/detail/pi.hpp>
+#include <sycl/ext/oneapi/experimental/async_alloc.hpp>
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+class context_impl;
+class device_impl;
+class event_impl;
+class queue_impl;
+} // namespace detail
+
+namespace ext::oneapi::experimental::detail {
+
+class memory_pool_impl {
+public:
+  /// Constructor.
+  /// @param Context Context of the allocations.
+  /// @param Device Device of the allocations.
+  /// @param Kind Kind of the allocations, device or shared.
+  /// @param ReleaseThreshold Amount of freed memory kept for reuse.
+  /// @param ContextOwner Keeps the context alive for the pools created by the
+  /// user. The default pools are owned by their context and leave it null.
+  memory_pool_impl(sycl::detail::context_impl &Context,
+                   std::shared_ptr<sycl::detail::device_impl> Device,
+                   sycl::usm::alloc Kind, size_t ReleaseThreshold,
+                   std::shared_ptr<sycl::detail::context_impl> ContextOwner);
+
+  /// Waits for the commands using the freed memory and frees all the memory
+  /// of the pool.
+  ~memory_pool_impl();
+
+  memory_pool_impl(const memory_pool_impl &) = delete;
+  memory_pool_impl &operator=(const memory_pool_impl &) = delete;
+
+  /// Allocates memory to be used by the commands submitted to \p Queue.
+  /// @param Queue Queue the allocation is ordered on.
+  /// @param Size Number of bytes to allocate.
+  /// @return Pointer to the allocated memory.
+  void *allocate(sycl::detail::queue_impl &Queue, size_t Size);
+
+  /// Returns memory to the pool.
+  /// @param Queue Queue the deallocation is ordered on.
+  /// @param Ptr Memory to free.
+  /// @param FreeEvent Event completed once the commands using the memory have
+  /// completed.
+  void deallocate(const std::shared_ptr<sycl::detail::queue_impl> &Queue,
+                  void *Ptr,
+                  const std::shared_ptr<sycl::detail::event_impl> &FreeEvent);
+
+  sycl::detail::context_impl &getContextImpl() const { return MContext; }
+  const std::shared_ptr<sycl::detail::context_impl> &getContextOwner() const {
+    return MContextOwner;
+  }
+  const std::shared_ptr<sycl::detail::device_impl> &getDeviceImpl() const {
+    return MDevice;
+  }
+  sycl::usm::alloc getKind() const { return MKind; }
+
+  size_t getReleaseThreshold() const;
+  void setReleaseThreshold(size_t Threshold);
+  size_t getReservedSize() const;
+  size_t getUsedSize() const;
+
+private:
+  /// Memory freed by async_free() which can be reused.
+  struct free_block {
+    void *MPtr;
+    /// Queue the memory was freed on, whose following commands can use it
+    /// right away if it is an in-order queue.
+    std::weak_ptr<sycl::detail::queue_impl> MFreeQueue;
+    /// Retained native event of the deallocation. Native events are kept
+    /// rather than the SYCL ones, which would keep their context, and so the
+    /// default pools, alive.
+    sycl::detail::pi::PiEvent MFreeEvent = nullptr;
+    /// Event of the deallocation while it has no native handle, e.g. while
+    /// its command is blocked by a host-task.
+    std::shared_ptr<sycl::detail::event_impl> MPendingEvent;
+    /// True if the completion of the deallocation cannot be tracked, i.e. it
+    /// was freed on a queue discarding its events.
+    bool MIsUntracked = false;
+  };
+
+  /// Checks whether the commands using the memory of a block have completed,
+  /// releasing its event if they have.
+  bool isComplete(free_block &Block);
+
+  /// Returns the freed memory exceeding the release threshold whose commands
+  /// have completed to the backend. MMutex must be held.
+  void trim();
+
+  void releaseBlock(free_block &Block);
+
+  sycl::detail::context_impl &MContext;
+  std::shared_ptr<sycl::detail::context_impl> MContextOwner;
+  std::shared_ptr<sycl::detail::device_impl> MDevice;
+  sycl::usm::alloc MKind;
+  size_t MReleaseThreshold;
+
+  /// Sizes of the blocks currently allocated from the pool.
+  std::unordered_map<void *, size_t> MUsedBlocks;
+  /// Freed blocks by size.
+  std::multimap<size_t, free_block> MFreeBlocks;
+  size_t MReservedSize = 0;
+  size_t MUsedSize = 0;
+  mutable std::mutex MMutex;
+};
+
+} // namespace ext::oneapi::experimental::detail
+} // namespace _V1
+} // namespace sycl
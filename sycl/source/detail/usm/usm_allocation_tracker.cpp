@@ -0,0 +1,46 @@
+//==------- usm_allocation_tracker.cpp - Live USM allocations --------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/device_impl.hpp>
+#include <detail/usm/usm_allocation_tracker.hpp>
+
+#include <mutex>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+
+void usm_allocation_tracker::insert(void *Ptr, size_t Size,
+                                    sycl::usm::alloc Kind,
+                                    std::shared_ptr<device_impl> Device) {
+  std::unique_lock<std::shared_mutex> Lock(MMutex);
+  MAllocations.insert_or_assign(reinterpret_cast<std::uintptr_t>(Ptr),
+                                allocation{Ptr, Size, Kind, std::move(Device)});
+}
+
+void usm_allocation_tracker::erase(const void *Ptr) {
+  std::unique_lock<std::shared_mutex> Lock(MMutex);
+  MAllocations.erase(reinterpret_cast<std::uintptr_t>(Ptr));
+}
+
+std::optional<usm_allocation_tracker::allocation>
+usm_allocation_tracker::find(const void *Ptr) const {
+  const std::uintptr_t Addr = reinterpret_cast<std::uintptr_t>(Ptr);
+  std::shared_lock<std::shared_mutex> Lock(MMutex);
+  auto It = MAllocations.upper_bound(Addr);
+  if (It == MAllocations.begin())
+    return std::nullopt;
+  --It;
+  if (Addr >= It->first + It->second.MSize)
+    return std::nullopt;
+  return It->second;
+}
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
@@ -0,0 +1,60 @@
+//==------- usm_allocation_tracker.hpp - Live USM allocations --------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sycl/usm/usm_enums.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+class device_impl;
+
+/// The live USM allocations made through the SYCL API in a context, so that
+/// the allocation containing a pointer is found without querying the backend.
+/// The allocations do not overlap, so they are kept ordered by base address
+/// and found in logarithmic time.
+class usm_allocation_tracker {
+public:
+  struct allocation {
+    void *MBase;
+    size_t MSize;
+    sycl::usm::alloc MKind;
+    /// Device of a device or shared allocation, nullptr for host ones.
+    std::shared_ptr<device_impl> MDevice;
+  };
+
+  usm_allocation_tracker() = default;
+  usm_allocation_tracker(const usm_allocation_tracker &) = delete;
+  usm_allocation_tracker &operator=(const usm_allocation_tracker &) = delete;
+
+  void insert(void *Ptr, size_t Size, sycl::usm::alloc Kind,
+              std::shared_ptr<device_impl> Device);
+
+  /// Removes the allocation starting at Ptr, if it is tracked.
+  void erase(const void *Ptr);
+
+  /// \return the allocation containing Ptr, or std::nullopt if Ptr does not
+  /// belong to an allocation made through the SYCL API.
+  std::optional<allocation> find(const void *Ptr) const;
+
+private:
+  std::map<std::uintptr_t, allocation> MAllocations;
+  mutable std::shared_mutex MMutex;
+};
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
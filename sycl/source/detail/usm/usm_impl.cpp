@@ -6,6 +6,7 @@
 //
 // ===--------------------------------------------------------------------=== //
 
+#include <detail/context_impl.hpp>
 #include <detail/queue_impl.hpp>
 #include <detail/usm/usm_impl.hpp>
 #include <sycl/context.hpp>
@@ -14,6 +15,7 @@
 #include <sycl/detail/pi.hpp>
 #include <sycl/device.hpp>
 #include <sycl/ext/intel/experimental/usm_properties.hpp>
+#include <sycl/ext/oneapi/experimental/device_heap.hpp>
 #include <sycl/ext/oneapi/memcpy2d.hpp>
 #include <sycl/usm.hpp>
 
@@ -21,6 +23,7 @@
 #include <cassert>
 #include <cstdlib>
 #include <memory>
+#include <optional>
 
 #ifdef XPTI_ENABLE_INSTRUMENTATION
 // Include the headers necessary for emitting
@@ -40,6 +43,19 @@ extern xpti::trace_event_data_t *GSYCLGraphEvent;
 #endif
 namespace usm {
 
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+// Reports the statistics of the pooling of small allocations with the
+// allocations and deallocations of the context.
+static void addSlabAllocatorMetadata(xpti::trace_event_data_t *TEvent,
+                                     const usm_slab_allocator &SlabAllocator) {
+  if (!TEvent || !SlabAllocator.isEnabled())
+    return;
+  xpti::addMetadata(TEvent, "usm_pool_reserved_size",
+                    SlabAllocator.getReservedSize());
+  xpti::addMetadata(TEvent, "usm_pool_used_size", SlabAllocator.getUsedSize());
+}
+#endif
+
 void *alignedAllocHost(size_t Alignment, size_t Size, const context &Ctxt,
                        alloc Kind, const property_list &PropList,
                        const detail::code_location &CodeLoc) {
@@ -128,6 +144,8 @@ void *alignedAllocHost(size_t Alignment, size_t Size, const context &Ctxt,
     // The spec wants a nullptr returned, not an exception.
     if (Error != PI_SUCCESS)
       return nullptr;
+    CtxImpl->getUSMAllocationTracker().insert(RetVal, Size, alloc::host,
+                                              nullptr);
   }
 #ifdef XPTI_ENABLE_INSTRUMENTATION
   xpti::addMetadata(PrepareNotify.traceEvent(), "memory_ptr",
@@ -172,6 +190,18 @@ void *alignedAllocInternal(size_t Alignment, size_t Size,
       }
     }
   } else {
+    // Allocations with properties are made by the backend, which is the one
+    // applying them.
+    usm_slab_allocator &SlabAllocator = CtxImpl->getUSMSlabAllocator();
+    if (SlabAllocator.isEnabled() &&
+        !PropList.has_property<sycl::ext::intel::experimental::property::usm::
+                                   buffer_location>() &&
+        !PropList.has_property<
+            sycl::ext::oneapi::property::usm::device_read_only>()) {
+      if (void *Chunk = SlabAllocator.allocate(DevImpl, Kind, Size, Alignment))
+        return Chunk;
+    }
+
     pi_context C = CtxImpl->getHandleRef();
     const PluginPtr &Plugin = CtxImpl->getPlugin();
     pi_result Error = PI_ERROR_INVALID_VALUE;
@@ -271,12 +301,18 @@ void *alignedAlloc(size_t Alignment, size_t Size, const context &Ctxt,
   PrepareNotify.scopedNotify(
       (uint16_t)xpti::trace_point_type_t::mem_alloc_begin);
 #endif
-  void *RetVal =
-      alignedAllocInternal(Alignment, Size, getSyclObjImpl(Ctxt).get(),
-                           getSyclObjImpl(Dev).get(), Kind, PropList);
+  std::shared_ptr<context_impl> CtxImpl = getSyclObjImpl(Ctxt);
+  void *RetVal = alignedAllocInternal(Alignment, Size, CtxImpl.get(),
+                                      getSyclObjImpl(Dev).get(), Kind,
+                                      PropList);
+  if (RetVal && !CtxImpl->is_host())
+    CtxImpl->getUSMAllocationTracker().insert(RetVal, Size, Kind,
+                                              getSyclObjImpl(Dev));
 #ifdef XPTI_ENABLE_INSTRUMENTATION
   xpti::addMetadata(PrepareNotify.traceEvent(), "memory_ptr",
                     reinterpret_cast<size_t>(RetVal));
+  addSlabAllocatorMetadata(PrepareNotify.traceEvent(),
+                           CtxImpl->getUSMSlabAllocator());
 #endif
   return RetVal;
 }
@@ -287,7 +323,11 @@ void freeInternal(void *Ptr, const context_impl *CtxImpl) {
   if (CtxImpl->is_host()) {
     // need to use alignedFree here for Windows
     detail::OSUtil::alignedFree(Ptr);
-  } else {
+    return;
+  }
+  CtxImpl->getUSMAllocationTracker().erase(Ptr);
+  CtxImpl->getUSMPrefetchAdvisor().forget(Ptr);
+  if (!CtxImpl->getUSMSlabAllocator().deallocate(Ptr)) {
     pi_context C = CtxImpl->getHandleRef();
     const PluginPtr &Plugin = CtxImpl->getPlugin();
     Plugin->call<PiApiKind::piextUSMFree>(C, Ptr);
@@ -312,6 +352,10 @@ void free(void *Ptr, const context &Ctxt,
       (uint16_t)xpti::trace_point_type_t::mem_release_begin);
 #endif
   freeInternal(Ptr, detail::getSyclObjImpl(Ctxt).get());
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+  addSlabAllocatorMetadata(PrepareNotify.traceEvent(),
+                           getSyclObjImpl(Ctxt)->getUSMSlabAllocator());
+#endif
 }
 
 } // namespace usm
@@ -582,6 +626,10 @@ alloc get_pointer_type(const void *Ptr, const context &Ctxt) {
   if (CtxImpl->is_host())
     return alloc::host;
 
+  if (std::optional<detail::usm_allocation_tracker::allocation> Alloc =
+          CtxImpl->getUSMAllocationTracker().find(Ptr))
+    return Alloc->MKind;
+
   pi_context PICtx = CtxImpl->getHandleRef();
   pi_usm_type AllocTy;
 
@@ -624,13 +672,22 @@ alloc get_pointer_type(const void *Ptr, const context &Ctxt) {
 /// \param Ptr is the USM pointer to query
 /// \param Ctxt is the sycl context the ptr was allocated in
 device get_pointer_device(const void *Ptr, const context &Ctxt) {
+  std::shared_ptr<detail::context_impl> CtxImpl = detail::getSyclObjImpl(Ctxt);
+  if (Ptr && !CtxImpl->is_host()) {
+    if (std::optional<detail::usm_allocation_tracker::allocation> Alloc =
+            CtxImpl->getUSMAllocationTracker().find(Ptr)) {
+      if (Alloc->MDevice)
+        return detail::createSyclObjFromImpl<device>(Alloc->MDevice);
+      // Just return the first device in the context for host allocations
+      return CtxImpl->getDevices()[0];
+    }
+  }
+
   // Check if ptr is a valid USM pointer
   if (get_pointer_type(Ptr, Ctxt) == alloc::unknown)
     throw runtime_error("Ptr not a valid USM allocation!",
                         PI_ERROR_INVALID_VALUE);
 
-  std::shared_ptr<detail::context_impl> CtxImpl = detail::getSyclObjImpl(Ctxt);
-
   // Just return the host device in the host context
   if (CtxImpl->is_host())
     return Ctxt.get_devices()[0];
@@ -701,6 +758,18 @@ void release_from_device_copy(const void *Ptr, const context &Ctxt) {
 void release_from_device_copy(const void *Ptr, const queue &Queue) {
   release_from_usm_device_copy(Ptr, Queue.get_context());
 }
+
+device_heap get_device_heap(const context &SyclContext,
+                            const device &SyclDevice) {
+  std::shared_ptr<sycl::detail::context_impl> CtxImpl =
+      sycl::detail::getSyclObjImpl(SyclContext);
+  auto [Arena, Size] = CtxImpl->getDeviceHeapArena(
+      sycl::detail::getSyclObjImpl(SyclDevice),
+      [&](void *Ptr, size_t NumBytes) {
+        queue(SyclContext, SyclDevice).memset(Ptr, 0, NumBytes).wait();
+      });
+  return device_heap(Arena, Size);
+}
 } // namespace ext::oneapi::experimental
 
 } // namespace _V1
@@ -0,0 +1,129 @@
+//==------- usm_prefetch_advisor.cpp - Prefetching of kernel USM args ------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/context_impl.hpp>
+#include <detail/queue_impl.hpp>
+#include <detail/scheduler/commands.hpp>
+#include <detail/usm/usm_prefetch_advisor.hpp>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+
+std::pair<const std::uintptr_t, usm_prefetch_advisor::allocation> *
+usm_prefetch_advisor::lookup(const void *Ptr) {
+  const std::uintptr_t Addr = reinterpret_cast<std::uintptr_t>(Ptr);
+  auto It = MAllocations.upper_bound(Addr);
+  if (It != MAllocations.begin()) {
+    --It;
+    if (Addr < It->first + It->second.MSize)
+      return &*It;
+  }
+
+  if (std::optional<usm_allocation_tracker::allocation> Tracked =
+          MContext->getUSMAllocationTracker().find(Ptr)) {
+    allocation Alloc{Tracked->MSize, Tracked->MKind == sycl::usm::alloc::shared,
+                     nullptr, false};
+    return &*MAllocations
+                 .insert_or_assign(
+                     reinterpret_cast<std::uintptr_t>(Tracked->MBase), Alloc)
+                 .first;
+  }
+
+  const PluginPtr &Plugin = MContext->getPlugin();
+  pi_context Context = MContext->getHandleRef();
+  pi_usm_type Type;
+  void *Base = nullptr;
+  size_t Size = 0;
+  if (Plugin->call_nocheck<PiApiKind::piextUSMGetMemAllocInfo>(
+          Context, Ptr, PI_MEM_ALLOC_TYPE, sizeof(Type), &Type, nullptr) !=
+          PI_SUCCESS ||
+      Plugin->call_nocheck<PiApiKind::piextUSMGetMemAllocInfo>(
+          Context, Ptr, PI_MEM_ALLOC_BASE_PTR, sizeof(Base), &Base,
+          nullptr) != PI_SUCCESS ||
+      Plugin->call_nocheck<PiApiKind::piextUSMGetMemAllocInfo>(
+          Context, Ptr, PI_MEM_ALLOC_SIZE, sizeof(Size), &Size, nullptr) !=
+          PI_SUCCESS)
+    return nullptr;
+  // Not a USM pointer, or a backend not reporting the allocation range.
+  if (Type == PI_MEM_TYPE_UNKNOWN || !Base || !Size)
+    return nullptr;
+
+  allocation Alloc{Size, Type == PI_MEM_TYPE_SHARED, nullptr, false};
+  return &*MAllocations
+               .insert_or_assign(reinterpret_cast<std::uintptr_t>(Base), Alloc)
+               .first;
+}
+
+std::vector<sycl::detail::pi::PiEvent> usm_prefetch_advisor::prefetchKernelArgs(
+    const std::shared_ptr<queue_impl> &Queue, std::vector<ArgDesc> &Args,
+    const KernelArgMask *EliminatedArgMask,
+    const std::vector<sycl::detail::pi::PiEvent> &DepEvents) {
+  std::vector<sycl::detail::pi::PiEvent> Events;
+  if (!MEnabled || Queue->is_host())
+    return Events;
+
+  const PluginPtr &Plugin = Queue->getPlugin();
+  const device_impl *Device = Queue->getDeviceImplPtr().get();
+  std::lock_guard<std::mutex> Lock(MMutex);
+  auto Prefetch = [&](ArgDesc &Arg, int) {
+    if (Arg.MType != kernel_param_kind_t::kind_pointer)
+      return;
+    const void *Ptr = *static_cast<void *const *>(Arg.MPtr);
+    auto *Entry = Ptr ? lookup(Ptr) : nullptr;
+    if (!Entry || !Entry->second.MShared)
+      return;
+    void *Base = reinterpret_cast<void *>(Entry->first);
+    allocation &Alloc = Entry->second;
+
+    // The allocation is best placed on the device of the kernels using it,
+    // until kernels of another device use it too. From then on the backend
+    // migrates it on demand again.
+    if (!Alloc.MSharedByDevices && Alloc.MDevice != Device) {
+      pi_mem_advice Advice = PI_MEM_ADVICE_CUDA_SET_PREFERRED_LOCATION;
+      if (Alloc.MDevice) {
+        Advice = PI_MEM_ADVICE_CUDA_UNSET_PREFERRED_LOCATION;
+        Alloc.MSharedByDevices = true;
+      }
+      Alloc.MDevice = Device;
+      sycl::detail::pi::PiEvent AdviceEvent = nullptr;
+      if (Plugin->call_nocheck<PiApiKind::piextUSMEnqueueMemAdvise>(
+              Queue->getHandleRef(), Base, Alloc.MSize, Advice,
+              &AdviceEvent) == PI_SUCCESS &&
+          AdviceEvent)
+        Plugin->call<PiApiKind::piEventRelease>(AdviceEvent);
+    }
+
+    sycl::detail::pi::PiEvent Event = nullptr;
+    if (Plugin->call_nocheck<PiApiKind::piextUSMEnqueuePrefetch>(
+            Queue->getHandleRef(), Base, Alloc.MSize,
+            _pi_usm_migration_flags(0), DepEvents.size(), DepEvents.data(),
+            &Event) == PI_SUCCESS &&
+        Event)
+      Events.push_back(Event);
+  };
+  applyFuncOnFilteredArgs(EliminatedArgMask, Args, Prefetch);
+  return Events;
+}
+
+void usm_prefetch_advisor::forget(const void *Ptr) {
+  if (!MEnabled)
+    return;
+  const std::uintptr_t Addr = reinterpret_cast<std::uintptr_t>(Ptr);
+  std::lock_guard<std::mutex> Lock(MMutex);
+  auto It = MAllocations.upper_bound(Addr);
+  if (It == MAllocations.begin())
+    return;
+  --It;
+  if (Addr < It->first + It->second.MSize)
+    MAllocations.erase(It);
+}
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
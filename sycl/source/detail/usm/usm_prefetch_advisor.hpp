@@ -0,0 +1,90 @@
+//==------- usm_prefetch_advisor.hpp - Prefetching of kernel USM args ------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <detail/kernel_arg_mask.hpp>
+#include <sycl/detail/cg_types.hpp>
+#include <sycl/detail/pi.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+class context_impl;
+class device_impl;
+class queue_impl;
+
+/// Migrates the shared USM allocations passed to the kernels of a context to
+/// the device running them ahead of the launch, and advises the backend about
+/// the device each allocation is best placed on, learnt from the kernels using
+/// it.
+class usm_prefetch_advisor {
+public:
+  usm_prefetch_advisor() = default;
+  usm_prefetch_advisor(const usm_prefetch_advisor &) = delete;
+  usm_prefetch_advisor &operator=(const usm_prefetch_advisor &) = delete;
+
+  /// \param Context is the context owning the advisor.
+  /// \param Enabled is true if the kernel arguments of the context are
+  /// prefetched.
+  void setContextPtr(const context_impl *Context, bool Enabled) {
+    MContext = Context;
+    MEnabled = Enabled;
+  }
+
+  bool isEnabled() const { return MEnabled; }
+
+  /// Enqueues the prefetches of the shared allocations passed as pointer
+  /// arguments to a kernel, skipping the arguments the kernel does not use.
+  ///
+  /// \param Queue is the queue the kernel is enqueued to.
+  /// \param DepEvents are the events the kernel waits for.
+  /// \return the events of the prefetches, which the kernel must wait for and
+  /// the caller must release.
+  std::vector<sycl::detail::pi::PiEvent>
+  prefetchKernelArgs(const std::shared_ptr<queue_impl> &Queue,
+                     std::vector<ArgDesc> &Args,
+                     const KernelArgMask *EliminatedArgMask,
+                     const std::vector<sycl::detail::pi::PiEvent> &DepEvents);
+
+  /// Forgets the allocation containing Ptr, which is being freed.
+  void forget(const void *Ptr);
+
+private:
+  struct allocation {
+    size_t MSize;
+    bool MShared;
+    /// Device of the last kernel using the allocation.
+    const device_impl *MDevice;
+    /// True once the allocation has been used by the kernels of several
+    /// devices.
+    bool MSharedByDevices;
+  };
+
+  /// \return the allocation containing Ptr, queried from the backend if it is
+  /// not known yet, or nullptr if Ptr is not a USM pointer.
+  std::pair<const std::uintptr_t, allocation> *lookup(const void *Ptr);
+
+  const context_impl *MContext = nullptr;
+  bool MEnabled = false;
+
+  /// Allocations by base address.
+  std::map<std::uintptr_t, allocation> MAllocations;
+  std::mutex MMutex;
+};
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
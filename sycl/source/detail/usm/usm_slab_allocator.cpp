@@ -0,0 +1,163 @@
+//==------- usm_slab_allocator.cpp - Pooling of small USM allocations ------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/context_impl.hpp>
+#include <detail/usm/usm_impl.hpp>
+#include <detail/usm/usm_slab_allocator.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+
+namespace {
+size_t getChunkSize(size_t Size) {
+  size_t ChunkSize = usm_slab_allocator::MinChunkSize;
+  while (ChunkSize < Size)
+    ChunkSize *= 2;
+  return ChunkSize;
+}
+
+// Slabs are at least as large as the largest pooled allocation, so that
+// allocating them is never pooled itself, and hold at least 16 chunks.
+size_t getSlabSize(size_t ChunkSize) {
+  return std::max(usm_slab_allocator::MaxPooledSize, 16 * ChunkSize);
+}
+} // namespace
+
+void *usm_slab_allocator::allocate(const device_impl *Device,
+                                   sycl::usm::alloc Kind, size_t Size,
+                                   size_t Alignment) {
+  if (!MEnabled || Size >= MaxPooledSize ||
+      (Kind != sycl::usm::alloc::device && Kind != sycl::usm::alloc::shared))
+    return nullptr;
+  const size_t ChunkSize = getChunkSize(Size);
+  if (Alignment > ChunkSize)
+    return nullptr;
+
+  std::lock_guard<std::mutex> Lock(MMutex);
+  bucket &Bucket = MBuckets[{Device, Kind, ChunkSize}];
+  slab *Slab = nullptr;
+  // The chunks are aligned to their size if the slab is.
+  for (auto It = Bucket.MAvailableSlabs.rbegin();
+       It != Bucket.MAvailableSlabs.rend() && !Slab; ++It) {
+    const std::uintptr_t Base = reinterpret_cast<std::uintptr_t>((*It)->MBase);
+    if (!Alignment || Base % Alignment == 0)
+      Slab = *It;
+  }
+  if (!Slab) {
+    Slab = createSlab(Bucket, Device, Kind, ChunkSize);
+    if (!Slab)
+      return nullptr;
+    if (Alignment &&
+        reinterpret_cast<std::uintptr_t>(Slab->MBase) % Alignment != 0)
+      return nullptr;
+  }
+
+  void *Ptr = Slab->MFreeChunks.back();
+  Slab->MFreeChunks.pop_back();
+  if (Slab->MFreeChunks.empty())
+    Bucket.MAvailableSlabs.erase(std::find(Bucket.MAvailableSlabs.begin(),
+                                           Bucket.MAvailableSlabs.end(), Slab));
+  MUsedSize += ChunkSize;
+  return Ptr;
+}
+
+bool usm_slab_allocator::deallocate(void *Ptr) {
+  if (!MEnabled)
+    return false;
+  const std::uintptr_t Addr = reinterpret_cast<std::uintptr_t>(Ptr);
+
+  std::lock_guard<std::mutex> Lock(MMutex);
+  auto It = MSlabs.upper_bound(Addr);
+  if (It == MSlabs.begin())
+    return false;
+  --It;
+  slab &Slab = *It->second;
+  if (Addr >= It->first + Slab.MSize)
+    return false;
+  assert((Addr - It->first) % Slab.MChunkSize == 0 &&
+         "Pointer is not the start of a chunk");
+
+  bucket &Bucket = *Slab.MBucket;
+  if (Slab.MFreeChunks.empty())
+    Bucket.MAvailableSlabs.push_back(&Slab);
+  Slab.MFreeChunks.push_back(Ptr);
+  MUsedSize -= Slab.MChunkSize;
+
+  // Keep a single free slab per bucket, so that allocating and freeing a
+  // chunk repeatedly does not go to the backend.
+  const bool IsEmpty = Slab.MFreeChunks.size() == Slab.MSize / Slab.MChunkSize;
+  if (IsEmpty && Bucket.MAvailableSlabs.size() > 1) {
+    Bucket.MAvailableSlabs.erase(std::find(Bucket.MAvailableSlabs.begin(),
+                                           Bucket.MAvailableSlabs.end(),
+                                           &Slab));
+    releaseSlab(Slab);
+    MSlabs.erase(It);
+  }
+  return true;
+}
+
+void usm_slab_allocator::release() {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  for (auto &[Base, Slab] : MSlabs)
+    releaseSlab(*Slab);
+  MSlabs.clear();
+  MBuckets.clear();
+  MUsedSize = 0;
+}
+
+size_t usm_slab_allocator::getReservedSize() const {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  return MReservedSize;
+}
+
+size_t usm_slab_allocator::getUsedSize() const {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  return MUsedSize;
+}
+
+usm_slab_allocator::slab *
+usm_slab_allocator::createSlab(bucket &Bucket, const device_impl *Device,
+                               sycl::usm::alloc Kind, size_t ChunkSize) {
+  const size_t SlabSize = getSlabSize(ChunkSize);
+  void *Base = usm::alignedAllocInternal(0, SlabSize, MContext, Device, Kind);
+  if (!Base)
+    return nullptr;
+
+  auto Slab = std::make_unique<slab>();
+  Slab->MBase = Base;
+  Slab->MChunkSize = ChunkSize;
+  Slab->MSize = SlabSize;
+  Slab->MBucket = &Bucket;
+  const size_t NumChunks = SlabSize / ChunkSize;
+  Slab->MFreeChunks.reserve(NumChunks);
+  // Chunks are handed out from the start of the slab.
+  for (size_t I = NumChunks; I > 0; --I)
+    Slab->MFreeChunks.push_back(static_cast<char *>(Base) +
+                                (I - 1) * ChunkSize);
+
+  slab *Result = Slab.get();
+  MSlabs.emplace(reinterpret_cast<std::uintptr_t>(Base), std::move(Slab));
+  Bucket.MAvailableSlabs.push_back(Result);
+  MReservedSize += SlabSize;
+  return Result;
+}
+
+void usm_slab_allocator::releaseSlab(slab &Slab) {
+  // The slab itself is not a chunk, so it is freed by the backend directly.
+  MContext->getPlugin()->call<PiApiKind::piextUSMFree>(
+      MContext->getHandleRef(), Slab.MBase);
+  MReservedSize -= Slab.MSize;
+}
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
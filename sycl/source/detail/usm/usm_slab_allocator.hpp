@@ -0,0 +1,107 @@
+//==------- usm_slab_allocator.hpp - Pooling of small USM allocations ------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sycl/usm/usm_enums.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+class context_impl;
+class device_impl;
+
+/// Sub-allocates the small device and shared USM allocations of a context
+/// from larger backend allocations, the slabs, so that each of them does not
+/// take a whole page of the backend. The allocations are rounded up to a
+/// power of two, and each slab holds the chunks of a single size for a device
+/// and allocation kind.
+class usm_slab_allocator {
+public:
+  /// Allocations of this size or larger are not pooled.
+  static constexpr size_t MaxPooledSize = 64 * 1024;
+  static constexpr size_t MinChunkSize = 64;
+
+  usm_slab_allocator() = default;
+  usm_slab_allocator(const usm_slab_allocator &) = delete;
+  usm_slab_allocator &operator=(const usm_slab_allocator &) = delete;
+
+  /// \param Context is the context owning the allocator.
+  /// \param Enabled is true if the allocations of the context are pooled.
+  void setContextPtr(const context_impl *Context, bool Enabled) {
+    MContext = Context;
+    MEnabled = Enabled;
+  }
+
+  bool isEnabled() const { return MEnabled; }
+
+  /// Allocates a chunk of a slab.
+  ///
+  /// \return the chunk, or nullptr if the allocation cannot be pooled, in
+  /// which case it must be made by the backend.
+  void *allocate(const device_impl *Device, sycl::usm::alloc Kind,
+                 size_t Size, size_t Alignment);
+
+  /// Returns a chunk to its slab.
+  ///
+  /// \return false if Ptr is not a chunk of the allocator.
+  bool deallocate(void *Ptr);
+
+  /// Returns all the slabs to the backend. Must be called before the native
+  /// context is released.
+  void release();
+
+  /// \return the size of the memory allocated from the backend for slabs.
+  size_t getReservedSize() const;
+  /// \return the size of the chunks currently in use.
+  size_t getUsedSize() const;
+
+private:
+  struct bucket;
+
+  struct slab {
+    void *MBase;
+    size_t MChunkSize;
+    size_t MSize;
+    bucket *MBucket;
+    std::vector<void *> MFreeChunks;
+  };
+
+  /// Slabs holding chunks of the same size for a device and allocation kind.
+  struct bucket {
+    /// Slabs which have a free chunk.
+    std::vector<slab *> MAvailableSlabs;
+  };
+
+  slab *createSlab(bucket &Bucket, const device_impl *Device,
+                   sycl::usm::alloc Kind, size_t ChunkSize);
+  void releaseSlab(slab &Slab);
+
+  const context_impl *MContext = nullptr;
+  bool MEnabled = false;
+
+  std::map<std::tuple<const device_impl *, sycl::usm::alloc, size_t>, bucket>
+      MBuckets;
+  /// Slabs by base address, used to find the slab of a chunk being freed.
+  std::map<std::uintptr_t, std::unique_ptr<slab>> MSlabs;
+  size_t MReservedSize = 0;
+  size_t MUsedSize = 0;
+  mutable std::mutex MMutex;
+};
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
@@ -0,0 +1,236 @@
+//==------- wg_size_autotuner.cpp - Autotuning of work-group sizes ---------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/device_impl.hpp>
+#include <detail/persistent_device_code_cache.hpp>
+#include <detail/wg_size_autotuner.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+
+namespace {
+/// Largest log2 of the power of two dividing a dimension which tells launches
+/// apart. The work-groups are never larger than that.
+constexpr size_t MaxDivisorLog2 = 10;
+
+size_t getPow2Divisor(size_t Size) { return Size & (~Size + 1); }
+
+/// Launches whose dimensions have the same bit widths and are divisible by
+/// the same powers of two share a tuning.
+std::string getTuningKey(const std::string &KernelName, size_t Dims,
+                         const size_t *GlobalSize) {
+  std::string Key;
+  for (size_t D = 0; D < Dims; ++D) {
+    size_t Width = 0;
+    for (size_t Size = GlobalSize[D]; Size; Size >>= 1)
+      ++Width;
+    size_t Log2 = 0;
+    for (size_t Divisor = getPow2Divisor(GlobalSize[D]);
+         Divisor > 1 && Log2 < MaxDivisorLog2; Divisor >>= 1)
+      ++Log2;
+    Key += std::to_string(Width) + ':' + std::to_string(Log2) + ' ';
+  }
+  return Key + KernelName;
+}
+} // namespace
+
+wg_size_autotuner::device_tunings &
+wg_size_autotuner::getDeviceTunings(const DeviceImplPtr &Device) {
+  auto [It, Inserted] = MDevices.try_emplace(Device.get());
+  device_tunings &Tunings = It->second;
+  if (!Inserted)
+    return Tunings;
+
+  Tunings.MPath = PersistentDeviceCodeCache::getDeviceDataPath(
+      createSyclObjFromImpl<device>(Device), "wg_autotune");
+  if (Tunings.MPath.empty())
+    return Tunings;
+
+  // Each line holds a chosen local size followed by the key of its tuning. A
+  // later line for the same key overrides an earlier one.
+  std::ifstream File{Tunings.MPath};
+  local_size LocalSize;
+  std::string Key;
+  while (File >> LocalSize[0] >> LocalSize[1] >> LocalSize[2] &&
+         File.get() == ' ' && std::getline(File, Key))
+    Tunings.MTunings[Key].MLocalSize = LocalSize;
+  return Tunings;
+}
+
+void wg_size_autotuner::buildCandidates(const DeviceImplPtr &Device,
+                                        const PluginPtr &Plugin,
+                                        sycl::detail::pi::PiKernel Kernel,
+                                        size_t Dims, const size_t *GlobalSize,
+                                        tuning &Tuning) {
+  Tuning.MCandidates.push_back(candidate{{0, 0, 0}});
+
+  size_t MaxWGSize = 0;
+  size_t MaxWISizes[3] = {0, 0, 0};
+  if (Plugin->call_nocheck<PiApiKind::piKernelGetGroupInfo>(
+          Kernel, Device->getHandleRef(), PI_KERNEL_GROUP_INFO_WORK_GROUP_SIZE,
+          sizeof(MaxWGSize), &MaxWGSize, nullptr) != PI_SUCCESS ||
+      Plugin->call_nocheck<PiApiKind::piDeviceGetInfo>(
+          Device->getHandleRef(), PI_DEVICE_INFO_MAX_WORK_ITEM_SIZES,
+          sizeof(MaxWISizes), MaxWISizes, nullptr) != PI_SUCCESS)
+    return;
+
+  // The candidates are the power of two work-group sizes, shaped by filling
+  // the x dimension first so that each dimension divides the global size.
+  for (size_t WGSize = MinCandidateSize; WGSize <= MaxWGSize; WGSize *= 2) {
+    local_size LocalSize{1, 1, 1};
+    size_t Remaining = WGSize;
+    for (size_t D = 0; D < Dims && Remaining > 1; ++D) {
+      size_t Limit = std::min(getPow2Divisor(GlobalSize[D]), MaxWISizes[D]);
+      while (LocalSize[D] * 2 <= Limit && Remaining > 1) {
+        LocalSize[D] *= 2;
+        Remaining /= 2;
+      }
+    }
+    if (Remaining == 1)
+      Tuning.MCandidates.push_back(candidate{LocalSize});
+  }
+}
+
+bool wg_size_autotuner::selectLocalSize(
+    const DeviceImplPtr &Device, const PluginPtr &Plugin,
+    sycl::detail::pi::PiKernel Kernel, const std::string &KernelName,
+    size_t Dims, const size_t *GlobalSize, bool CanSample,
+    size_t (&LocalSize)[3], std::optional<sample> &Sample) {
+  std::string Key = getTuningKey(KernelName, Dims, GlobalSize);
+  std::lock_guard<std::mutex> Lock(MMutex);
+  device_tunings &Tunings = getDeviceTunings(Device);
+  tuning &Tuning = Tunings.MTunings[Key];
+
+  if (!Tuning.MLocalSize) {
+    if (Tuning.MCandidates.empty()) {
+      buildCandidates(Device, Plugin, Kernel, Dims, GlobalSize, Tuning);
+      if (Tuning.MCandidates.size() == 1)
+        Tuning.MLocalSize = local_size{0, 0, 0};
+    }
+    collectSamples(Tunings, Key, Tuning);
+  }
+
+  if (Tuning.MLocalSize) {
+    const local_size &Chosen = *Tuning.MLocalSize;
+    // A local size stored by a run with other global sizes of the same shape
+    // may not divide this one.
+    for (size_t D = 0; D < Dims; ++D)
+      if (!Chosen[D] || GlobalSize[D] % Chosen[D])
+        return false;
+    std::copy(Chosen.begin(), Chosen.end(), LocalSize);
+    return true;
+  }
+  if (!CanSample)
+    return false;
+
+  // Time the candidate with the fewest launches so far. If they have all
+  // been launched, the backend chooses until their timings are read.
+  size_t Best = 0;
+  for (size_t I = 1; I < Tuning.MCandidates.size(); ++I)
+    if (Tuning.MCandidates[I].MNumStarted <
+        Tuning.MCandidates[Best].MNumStarted)
+      Best = I;
+  candidate &Candidate = Tuning.MCandidates[Best];
+  if (Candidate.MNumStarted >= SamplesPerCandidate)
+    return false;
+
+  ++Candidate.MNumStarted;
+  Sample = sample{Device.get(), std::move(Key), Best};
+  std::copy(Candidate.MLocalSize.begin(), Candidate.MLocalSize.end(),
+            LocalSize);
+  return Best != 0;
+}
+
+void wg_size_autotuner::startSample(sample &&Sample, const PluginPtr &Plugin,
+                                    sycl::detail::pi::PiEvent Event) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  tuning &Tuning = MDevices[Sample.MDevice].MTunings[Sample.MKey];
+  if (Tuning.MLocalSize)
+    return;
+  Plugin->call<PiApiKind::piEventRetain>(Event);
+  MPlugin = Plugin;
+  Tuning.MPending.emplace_back(Sample.MCandidate, Event);
+}
+
+void wg_size_autotuner::cancelSample(const sample &Sample) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  tuning &Tuning = MDevices[Sample.MDevice].MTunings[Sample.MKey];
+  if (Sample.MCandidate < Tuning.MCandidates.size())
+    --Tuning.MCandidates[Sample.MCandidate].MNumStarted;
+}
+
+void wg_size_autotuner::collectSamples(device_tunings &Tunings,
+                                       const std::string &Key,
+                                       tuning &Tuning) {
+  for (auto It = Tuning.MPending.begin(); It != Tuning.MPending.end();) {
+    auto [Index, Event] = *It;
+    pi_event_status Status = PI_EVENT_QUEUED;
+    pi_result Result = MPlugin->call_nocheck<PiApiKind::piEventGetInfo>(
+        Event, PI_EVENT_INFO_COMMAND_EXECUTION_STATUS, sizeof(pi_int32),
+        &Status, nullptr);
+    if (Result == PI_SUCCESS && Status != PI_EVENT_COMPLETE) {
+      ++It;
+      continue;
+    }
+
+    uint64_t Start = 0, End = 0;
+    if (Result == PI_SUCCESS)
+      Result = MPlugin->call_nocheck<PiApiKind::piEventGetProfilingInfo>(
+          Event, PI_PROFILING_INFO_COMMAND_START, sizeof(Start), &Start,
+          nullptr);
+    if (Result == PI_SUCCESS)
+      Result = MPlugin->call_nocheck<PiApiKind::piEventGetProfilingInfo>(
+          Event, PI_PROFILING_INFO_COMMAND_END, sizeof(End), &End, nullptr);
+    MPlugin->call_nocheck<PiApiKind::piEventRelease>(Event);
+    It = Tuning.MPending.erase(It);
+
+    // Without timings, the backend keeps choosing for the rest of the run.
+    if (Result != PI_SUCCESS || End < Start) {
+      Tuning.MLocalSize = local_size{0, 0, 0};
+      continue;
+    }
+    candidate &Candidate = Tuning.MCandidates[Index];
+    ++Candidate.MNumSamples;
+    Candidate.MBestTime = std::min(Candidate.MBestTime, End - Start);
+  }
+  if (Tuning.MLocalSize)
+    return;
+
+  size_t Best = 0;
+  for (size_t I = 0; I < Tuning.MCandidates.size(); ++I) {
+    const candidate &Candidate = Tuning.MCandidates[I];
+    if (Candidate.MNumSamples < SamplesPerCandidate)
+      return;
+    if (Candidate.MBestTime < Tuning.MCandidates[Best].MBestTime)
+      Best = I;
+  }
+
+  const local_size &Chosen = Tuning.MCandidates[Best].MLocalSize;
+  Tuning.MLocalSize = Chosen;
+  if (!Tunings.MPath.empty())
+    std::ofstream(Tunings.MPath, std::ios::app)
+        << Chosen[0] << ' ' << Chosen[1] << ' ' << Chosen[2] << ' ' << Key
+        << '\n';
+}
+
+void wg_size_autotuner::reset() {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  for (auto &[Device, Tunings] : MDevices)
+    for (auto &[Key, Tuning] : Tunings.MTunings)
+      for (auto &[Index, Event] : Tuning.MPending)
+        MPlugin->call_nocheck<PiApiKind::piEventRelease>(Event);
+  MDevices.clear();
+}
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
@@ -0,0 +1,132 @@
+//==------- wg_size_autotuner.hpp - Autotuning of work-group sizes ---------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <detail/plugin.hpp>
+#include <sycl/detail/pi.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+class device_impl;
+using DeviceImplPtr = std::shared_ptr<device_impl>;
+
+/// Picks the local size of the launches of a kernel over a sycl::range, for
+/// which the application does not give one, by timing a few legal local sizes
+/// on the first launches and keeping the fastest one. The launches are told
+/// apart by kernel and by the shape of their global size. The timings are
+/// read from the profiling information of the events of the launches without
+/// waiting for them, so only the launches on queues with profiling enabled
+/// are timed. When the persistent device code cache is enabled, the chosen
+/// local sizes are stored next to it, so that the following runs of the
+/// application do not explore them again.
+///
+/// There is one autotuner per context, owned by its KernelProgramCache.
+class wg_size_autotuner {
+public:
+  /// Number of launches timed with each candidate local size. The fastest of
+  /// them is kept, so that the first launch is not held against the size.
+  static constexpr size_t SamplesPerCandidate = 2;
+  /// Smallest number of work-items in the candidate work-groups.
+  static constexpr size_t MinCandidateSize = 16;
+
+  /// A launch timed with one of the candidate local sizes.
+  struct sample {
+    const device_impl *MDevice;
+    std::string MKey;
+    size_t MCandidate;
+  };
+
+  wg_size_autotuner() = default;
+  wg_size_autotuner(const wg_size_autotuner &) = delete;
+  wg_size_autotuner &operator=(const wg_size_autotuner &) = delete;
+  ~wg_size_autotuner() { reset(); }
+
+  /// \param Dims is the number of dimensions of the launch.
+  /// \param GlobalSize is the global size of the launch, in the order of the
+  /// plugin interface, i.e. x first.
+  /// \param CanSample is true if the launch can be timed.
+  /// \param LocalSize receives the local size to use, in the order of the
+  /// plugin interface.
+  /// \param Sample is set if the launch is timed, in which case it must be
+  /// passed to startSample() or cancelSample() once the launch is enqueued.
+  /// \return false if the backend should choose the local size.
+  bool selectLocalSize(const DeviceImplPtr &Device, const PluginPtr &Plugin,
+                       sycl::detail::pi::PiKernel Kernel,
+                       const std::string &KernelName, size_t Dims,
+                       const size_t *GlobalSize, bool CanSample,
+                       size_t (&LocalSize)[3], std::optional<sample> &Sample);
+
+  /// Starts the timing of a launch. The event is retained until its
+  /// profiling information is read by a following selectLocalSize().
+  void startSample(sample &&Sample, const PluginPtr &Plugin,
+                   sycl::detail::pi::PiEvent Event);
+
+  /// Drops the timing of a launch which has failed or has no event.
+  void cancelSample(const sample &Sample);
+
+  /// Forgets the tunings of the current run and releases the events of the
+  /// launches being timed.
+  void reset();
+
+private:
+  using local_size = std::array<size_t, 3>;
+
+  struct candidate {
+    local_size MLocalSize;
+    size_t MNumStarted = 0;
+    size_t MNumSamples = 0;
+    uint64_t MBestTime = UINT64_MAX;
+  };
+
+  struct tuning {
+    /// The chosen local size, where all zeros stands for the choice of the
+    /// backend, or nothing while the candidates are explored.
+    std::optional<local_size> MLocalSize;
+    /// The first candidate is the choice of the backend.
+    std::vector<candidate> MCandidates;
+    /// Candidate indices and events of the launches being timed.
+    std::vector<std::pair<size_t, sycl::detail::pi::PiEvent>> MPending;
+  };
+
+  struct device_tunings {
+    /// File storing the local sizes chosen for the device, or an empty
+    /// string if they are not persisted.
+    std::string MPath;
+    std::map<std::string, tuning> MTunings;
+  };
+
+  device_tunings &getDeviceTunings(const DeviceImplPtr &Device);
+  void buildCandidates(const DeviceImplPtr &Device, const PluginPtr &Plugin,
+                       sycl::detail::pi::PiKernel Kernel, size_t Dims,
+                       const size_t *GlobalSize, tuning &Tuning);
+  /// Reads the timings of the completed launches of Tuning, and chooses the
+  /// fastest candidate if they have all been timed.
+  void collectSamples(device_tunings &Tunings, const std::string &Key,
+                      tuning &Tuning);
+
+  std::map<const device_impl *, device_tunings> MDevices;
+  /// Plugin of the events of the launches being timed.
+  PluginPtr MPlugin;
+  std::mutex MMutex;
+};
+
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
@@ -41,6 +41,15 @@ extern uint8_t GImageStreamID;
 extern uint8_t GMemAllocStreamID;
 extern xpti::trace_event_data_t *GMemAllocEvent;
 extern xpti::trace_event_data_t *GSYCLGraphEvent;
+extern uint8_t GMetricsStreamID;
+extern xpti::trace_event_data_t *GMetricsEvent;
+
+/// @returns the ID of the "sycl" stream. The ID is looked up once, so that the
+/// submissions and waits do not hash the stream name again.
+inline uint8_t getSYCLStreamID() {
+  static uint8_t StreamID = xptiRegisterStream(SYCL_STREAM_NAME);
+  return StreamID;
+}
 
 // We will pick a global constant so that the pointer in TLS never goes stale
 inline constexpr auto XPTI_QUEUE_INSTANCE_ID_KEY = "queue_id";
@@ -63,6 +72,11 @@ inline constexpr const char *SYCL_BUFFER_STREAM_NAME =
 // Stream name being used to notify about image objects.
 inline constexpr const char *SYCL_IMAGE_STREAM_NAME = "sycl.experimental.image";
 
+// Stream name being used to report the metrics collected with
+// SYCL_METRICS_DUMP.
+inline constexpr const char *SYCL_METRICS_STREAM_NAME =
+    "sycl.experimental.metrics";
+
 class XPTIRegistry {
 public:
   void initializeFrameworkOnce() {
@@ -84,6 +98,15 @@ public:
       GMemAllocEvent = xptiMakeEvent("SYCL Memory Allocations", &MAPayload,
                                      xpti::trace_algorithm_event,
                                      xpti_at::active, &MAInstanceNo);
+
+      // Runtime metrics
+      GMetricsStreamID = xptiRegisterStream(SYCL_METRICS_STREAM_NAME);
+      this->initializeStream(SYCL_METRICS_STREAM_NAME, 0, 1, "0.1");
+      xpti::payload_t MetricsPayload("SYCL Runtime Metrics");
+      uint64_t MetricsInstanceNo = 0;
+      GMetricsEvent = xptiMakeEvent("SYCL Metrics", &MetricsPayload,
+                                    xpti::trace_algorithm_event,
+                                    xpti_at::active, &MetricsInstanceNo);
     });
 #endif
   }
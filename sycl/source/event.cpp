@@ -45,7 +45,16 @@ bool event::is_host() const {
 
 void event::wait() { impl->wait(impl); }
 
+static void waitNativeEvents(const std::vector<event> &EventList) {
+  std::vector<detail::EventImplPtr> Events;
+  Events.reserve(EventList.size());
+  for (const event &E : EventList)
+    Events.push_back(detail::getSyclObjImpl(E));
+  detail::event_impl::waitNativeEvents(Events);
+}
+
 void event::wait(const std::vector<event> &EventList) {
+  waitNativeEvents(EventList);
   for (auto E : EventList) {
     E.wait();
   }
@@ -54,6 +63,7 @@ void event::wait(const std::vector<event> &EventList) {
 void event::wait_and_throw() { impl->wait_and_throw(impl); }
 
 void event::wait_and_throw(const std::vector<event> &EventList) {
+  waitNativeEvents(EventList);
   for (auto E : EventList) {
     E.wait_and_throw();
   }
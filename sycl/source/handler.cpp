@@ -15,6 +15,7 @@
 #include <detail/image_impl.hpp>
 #include <detail/kernel_bundle_impl.hpp>
 #include <detail/kernel_impl.hpp>
+#include <detail/object_pool.hpp>
 #include <detail/queue_impl.hpp>
 #include <detail/scheduler/commands.hpp>
 #include <detail/scheduler/scheduler.hpp>
@@ -255,7 +256,7 @@ event handler::finalize() {
 
 #ifdef XPTI_ENABLE_INSTRUMENTATION
       // uint32_t StreamID, uint64_t InstanceID, xpti_td* TraceEvent,
-      int32_t StreamID = xptiRegisterStream(detail::SYCL_STREAM_NAME);
+      int32_t StreamID = detail::getSYCLStreamID();
       auto [CmdTraceEvent, InstanceID] = emitKernelInstrumentationData(
           StreamID, MKernel, MCodeLoc, MKernelName.c_str(), MQueue, MNDRDesc,
           KernelBundleImpPtr, MArgs);
@@ -308,7 +309,8 @@ event handler::finalize() {
             Result = enqueueImpKernel(
                 MQueue, MNDRDesc, MArgs, KernelBundleImpPtr, MKernel,
                 MKernelName.c_str(), RawEvents, NewEvent, nullptr,
-                MImpl->MKernelCacheConfig, MImpl->MKernelIsCooperative);
+                MImpl->MKernelCacheConfig, MImpl->MKernelIsCooperative,
+                MImpl->MKernelNameHash);
           }
         }
 #ifdef XPTI_ENABLE_INSTRUMENTATION
@@ -325,7 +327,7 @@ event handler::finalize() {
       };
 
       bool DiscardEvent = false;
-      if (MQueue->supportsDiscardingPiEvents()) {
+      if (MQueue->supportsDiscardingPiEvents() || !MImpl->MEventNeeded) {
         // Kernel only uses assert if it's non interop one
         bool KernelUsesAssert =
             !(MKernel && MKernel->isInterop()) &&
@@ -339,7 +341,7 @@ event handler::finalize() {
           throw runtime_error("Enqueue process failed.",
                               PI_ERROR_INVALID_OPERATION);
       } else {
-        NewEvent = std::make_shared<detail::event_impl>(MQueue);
+        NewEvent = detail::makeSharedPooled<detail::event_impl>(MQueue);
         NewEvent->setWorkerQueue(MQueue);
         NewEvent->setContextImpl(MQueue->getContextImplPtr());
         NewEvent->setStateIncomplete();
@@ -355,6 +357,55 @@ event handler::finalize() {
       }
       return MLastEvent;
     }
+
+    if (detail::SYCLConfig<detail::SYCL_IN_ORDER_QUEUE_FAST_PATH>::get() &&
+        MQueue && MQueue->isInOrder() && !MQueue->is_host() && !MGraph &&
+        !MSubgraphNode && !MQueue->getCommandGraph() &&
+        !MQueue->is_in_fusion_mode() && !CGData.MRequirements.empty() &&
+        MStreamStorage.empty() && MImpl->MAuxiliaryResources.empty() &&
+        MQueue->getDeviceImplPtr()->getBackend() !=
+            backend::ext_intel_esimd_emulator) {
+      // If all the memory objects accessed by the kernel are exclusively owned
+      // by this in-order queue, the scheduler can track the submission without
+      // adding it to the graph, so that the graph write lock is not taken.
+      // The kernel is only traced once the submission is accepted, as it is
+      // traced by the scheduler otherwise.
+      auto EnqueueKernel =
+          [&](const std::function<void *(detail::Requirement *)>
+                  &GetMemAllocation,
+              std::vector<sycl::detail::pi::PiEvent> &RawEvents,
+              const detail::EventImplPtr &NewEvent) {
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+        int32_t StreamID = detail::getSYCLStreamID();
+        auto [CmdTraceEvent, InstanceID] = emitKernelInstrumentationData(
+            StreamID, MKernel, MCodeLoc, MKernelName.c_str(), MQueue, MNDRDesc,
+            KernelBundleImpPtr, MArgs);
+        detail::emitInstrumentationGeneral(StreamID, InstanceID, CmdTraceEvent,
+                                           xpti::trace_task_begin, nullptr);
+#endif
+        pi_int32 Result = enqueueImpKernel(
+            MQueue, MNDRDesc, MArgs, KernelBundleImpPtr, MKernel,
+            MKernelName.c_str(), RawEvents, NewEvent, GetMemAllocation,
+            MImpl->MKernelCacheConfig, MImpl->MKernelIsCooperative,
+            MImpl->MKernelNameHash);
+#ifdef XPTI_ENABLE_INSTRUMENTATION
+        detail::emitInstrumentationGeneral(
+            StreamID, InstanceID, CmdTraceEvent, xpti::trace_signal,
+            static_cast<const void *>(NewEvent->getHandleRef()));
+        detail::emitInstrumentationGeneral(StreamID, InstanceID, CmdTraceEvent,
+                                           xpti::trace_task_end, nullptr);
+#endif
+        return Result;
+      };
+
+      detail::EventImplPtr NewEvent =
+          detail::Scheduler::getInstance().addCGInOrderFastPath(
+              MQueue, CGData.MRequirements, CGData.MEvents, EnqueueKernel);
+      if (NewEvent) {
+        MLastEvent = detail::createSyclObjFromImpl<event>(NewEvent);
+        return MLastEvent;
+      }
+    }
   }
 
   std::unique_ptr<detail::CG> CommandGroup;
@@ -368,7 +419,8 @@ event handler::finalize() {
         std::move(MImpl->MKernelBundle), std::move(CGData), std::move(MArgs),
         MKernelName.c_str(), std::move(MStreamStorage),
         std::move(MImpl->MAuxiliaryResources), MCGType,
-        MImpl->MKernelCacheConfig, MImpl->MKernelIsCooperative, MCodeLoc));
+        MImpl->MKernelCacheConfig, MImpl->MKernelIsCooperative, MCodeLoc,
+        MImpl->MKernelNameHash));
     break;
   }
   case detail::CG::CopyAccToPtr:
@@ -424,6 +476,14 @@ event handler::finalize() {
     CommandGroup.reset(new detail::CGHostTask(
         std::move(MHostTask), MQueue, context, std::move(MArgs),
         std::move(CGData), MCGType, MCodeLoc));
+    if (!MGraph) {
+      if (detail::EventImplPtr Event =
+              detail::Scheduler::getInstance().addHostTaskWithoutGraph(
+                  CommandGroup, MQueue)) {
+        MLastEvent = detail::createSyclObjFromImpl<event>(Event);
+        return MLastEvent;
+      }
+    }
     break;
   }
   case detail::CG::Barrier:
@@ -591,6 +651,11 @@ event handler::finalize() {
     GraphImpl->addEventForNode(GraphImpl, EventImpl, NodeImpl);
 
     NodeImpl->MNDRangeUsed = MImpl->MNDRangeUsed;
+    // Nodes recorded from a queue on another device of a multi-device graph
+    // execute on the device of the queue.
+    if (MQueue->get_device() != GraphImpl->getDevice()) {
+      NodeImpl->MDevice = MQueue->get_device();
+    }
 
     return detail::createSyclObjFromImpl<event>(EventImpl);
   }
@@ -665,6 +730,11 @@ static void addArgsForGlobalAccessor(detail::Requirement *AccImpl, size_t Index,
   // TODO ESIMD currently does not suport offset, memory and access ranges -
   // accessor::init for ESIMD-mode accessor has a single field, translated
   // to a single kernel argument set above.
+  // The number of kernel arguments of the other accessors is fixed by the
+  // device compiler, which lowers them through the four parameters of
+  // accessor::__init. The ones left unused by the kernel, e.g. the offset of
+  // accessors with the no_offset property, are dropped by the dead argument
+  // elimination and skipped through the eliminated argument mask.
   if (!isESIMD && !IsKernelCreatedFromSource) {
     // Dimensionality of the buffer is 1 when dimensionality of the
     // accessor is 0.
@@ -822,15 +892,33 @@ void handler::processArg(void *Ptr, const detail::kernel_param_kind_t &Kind,
   }
 }
 
-// The argument can take up more space to store additional information about
-// MAccessRange, MMemoryRange, and MOffset added with addArgsForGlobalAccessor.
-// We use the worst-case estimate because the lifetime of the vector is short.
-// In processArg the kind_stream case introduces the maximum number of
-// additional arguments. The case adds additional 12 arguments to the currently
-// processed argument, hence worst-case estimate is 12+1=13.
-// TODO: the constant can be removed if the size of MArgs will be calculated at
-// compile time.
-inline constexpr size_t MaxNumAdditionalArgs = 13;
+// Returns the number of arguments processArg adds for a kernel argument.
+// Accessors take up more space to store additional information about
+// MAccessRange, MMemoryRange, and MOffset, and streams contain several
+// accessors. Counting them upfront allows MArgs to be allocated once with the
+// exact size instead of using a worst-case estimate, which matters for kernels
+// with many arguments. AccTarget is only used for accessor arguments.
+static size_t getNumArgsForKernelArg(detail::kernel_param_kind_t Kind,
+                                     access::target AccTarget,
+                                     bool IsKernelCreatedFromSource,
+                                     bool IsESIMD) {
+  using detail::kernel_param_kind_t;
+  const size_t NumArgsForAccessor =
+      IsESIMD || IsKernelCreatedFromSource ? 1 : 4;
+  switch (Kind) {
+  case kernel_param_kind_t::kind_stream:
+    // Three global accessors and the flush buffer size.
+    return 3 * NumArgsForAccessor + 1;
+  case kernel_param_kind_t::kind_accessor:
+    if (AccTarget == access::target::device ||
+        AccTarget == access::target::constant_buffer ||
+        AccTarget == access::target::local)
+      return NumArgsForAccessor;
+    return 1;
+  default:
+    return 1;
+  }
+}
 
 void handler::extractArgsAndReqs() {
   assert(MKernel && "MKernel is not initialized");
@@ -844,7 +932,12 @@ void handler::extractArgsAndReqs() {
       });
 
   const bool IsKernelCreatedFromSource = MKernel->isCreatedFromSource();
-  MArgs.reserve(MaxNumAdditionalArgs * UnPreparedArgs.size());
+  size_t NumArgs = 0;
+  for (const detail::ArgDesc &Arg : UnPreparedArgs)
+    NumArgs += getNumArgsForKernelArg(
+        Arg.MType, static_cast<access::target>(Arg.MSize & AccessTargetMask),
+        IsKernelCreatedFromSource, false);
+  MArgs.reserve(NumArgs);
 
   size_t IndexShift = 0;
   for (size_t I = 0; I < UnPreparedArgs.size(); ++I) {
@@ -862,7 +955,13 @@ void handler::extractArgsAndReqsFromLambda(
     const detail::kernel_param_desc_t *KernelArgs, bool IsESIMD) {
   const bool IsKernelCreatedFromSource = false;
   size_t IndexShift = 0;
-  MArgs.reserve(MaxNumAdditionalArgs * KernelArgsNum);
+  size_t NumArgs = 0;
+  for (size_t I = 0; I < KernelArgsNum; ++I)
+    NumArgs += getNumArgsForKernelArg(
+        KernelArgs[I].kind,
+        static_cast<access::target>(KernelArgs[I].info & AccessTargetMask),
+        IsKernelCreatedFromSource, IsESIMD);
+  MArgs.reserve(MArgs.size() + NumArgs);
 
   for (size_t I = 0; I < KernelArgsNum; ++I) {
     void *Ptr = LambdaPtr + KernelArgs[I].offset;
@@ -941,6 +1040,44 @@ void handler::GetRangeRoundingSettings(size_t &MinFactor, size_t &GoodFactor,
       MinFactor, GoodFactor, MinRange);
 }
 
+void handler::GetRangeRoundingSettings(size_t RangeX, size_t &MinFactor,
+                                       size_t &GoodFactor, size_t &MinRange) {
+  if (SYCLConfig<SYCL_PARALLEL_FOR_RANGE_ROUNDING_PARAMS>::GetSettings(
+          MinFactor, GoodFactor, MinRange))
+    return;
+
+  auto Dev = detail::getSyclObjImpl(detail::getDeviceFromHandler(*this));
+  if (Dev->is_host())
+    return;
+  const device_impl::range_rounding_geometry &Geometry =
+      Dev->getRangeRoundingGeometry();
+  if (Geometry.MMaxSubGroupSize == 0 || Geometry.MComputeUnits == 0 ||
+      Geometry.MMaxSubGroupSize > Geometry.MMaxWorkGroupSize)
+    return;
+
+  // A range which is not a multiple of the sub-group size leaves the last
+  // sub-group partially filled.
+  MinFactor = Geometry.MMaxSubGroupSize;
+  if (RangeX < MinRange)
+    return;
+
+  // Larger factors allow the backend to use larger work-groups, but the
+  // work-items added by rounding and the compute units left idle in the last
+  // wave are wasted. Assuming a wave runs a work-group of the factor size on
+  // each compute unit, use the largest factor which wastes at most 1/32 of
+  // the work-item slots.
+  GoodFactor = MinFactor;
+  for (size_t Factor = MinFactor; Factor <= Geometry.MMaxWorkGroupSize;
+       Factor *= 2) {
+    size_t NWorkGroups = (RangeX + Factor - 1) / Factor;
+    size_t NWaves =
+        (NWorkGroups + Geometry.MComputeUnits - 1) / Geometry.MComputeUnits;
+    size_t NSlots = NWaves * Geometry.MComputeUnits * Factor;
+    if ((NSlots - RangeX) * 32 <= NSlots)
+      GoodFactor = Factor;
+  }
+}
+
 void handler::memcpy(void *Dest, const void *Src, size_t Count) {
   throwIfActionIsCreated();
   MSrcPtr = const_cast<void *>(Src);
@@ -1511,6 +1648,10 @@ void handler::setKernelIsCooperative(bool KernelIsCooperative) {
   MImpl->MKernelIsCooperative = KernelIsCooperative;
 }
 
+void handler::setKernelNameHash(uint64_t KernelNameHash) {
+  MImpl->MKernelNameHash = KernelNameHash;
+}
+
 void handler::ext_oneapi_graph(
     ext::oneapi::experimental::command_graph<
         ext::oneapi::experimental::graph_state::executable>
@@ -13,6 +13,7 @@
 #include <detail/program_manager/program_manager.hpp>
 
 #include <cstddef>
+#include <future>
 #include <set>
 #include <vector>
 
@@ -270,6 +271,25 @@ build_impl(const kernel_bundle<bundle_state::input> &InputBundle,
       InputBundle, Devs, PropList, bundle_state::executable);
 }
 
+std::future<kernel_bundle<bundle_state::executable>>
+build_async_impl(const kernel_bundle<bundle_state::input> &InputBundle,
+                 const std::vector<device> &Devs,
+                 const property_list &PropList) {
+  using ExecBundleT = kernel_bundle<bundle_state::executable>;
+  auto Promise = std::make_shared<std::promise<ExecBundleT>>();
+  std::future<ExecBundleT> Result = Promise->get_future();
+  ProgramManager::getInstance().startBackgroundBuild(
+      [Promise, InputBundle, Devs, PropList]() {
+        try {
+          Promise->set_value(createSyclObjFromImpl<ExecBundleT>(
+              build_impl(InputBundle, Devs, PropList)));
+        } catch (...) {
+          Promise->set_exception(std::current_exception());
+        }
+      });
+  return Result;
+}
+
 // This function finds intersection of associated devices in common for all
 // bundles
 std::vector<sycl::device> find_device_intersection(
@@ -197,11 +197,27 @@ event queue::submit_impl_and_postprocess(
   return impl->submit(CGH, impl, SecondQueue.impl, CodeLoc, &PostProcess);
 }
 
+std::vector<event> queue::submit_batch_impl(
+    const std::vector<std::function<void(handler &)>> &CGFs,
+    const detail::code_location &CodeLoc,
+    const SubmitPostProcessF *PostProcess) {
+  return impl->submitBatch(CGFs, impl, CodeLoc, PostProcess);
+}
+
+void queue::submit_without_event_impl(std::function<void(handler &)> CGH,
+                                      const detail::code_location &CodeLoc) {
+  impl->submit_without_event(CGH, impl, CodeLoc);
+}
+
 void queue::wait_proxy(const detail::code_location &CodeLoc) {
+  impl->completeAutoFusion(impl);
+  impl->syncAutoGraph(impl);
   impl->wait(CodeLoc);
 }
 
 void queue::wait_and_throw_proxy(const detail::code_location &CodeLoc) {
+  impl->completeAutoFusion(impl);
+  impl->syncAutoGraph(impl);
   impl->wait_and_throw(CodeLoc);
 }
 
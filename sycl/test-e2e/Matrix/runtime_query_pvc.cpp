@@ -51,5 +51,18 @@ int main() {
            "Some values in matrix runtime query for PVC are not expected.");
   }
 
+  // The largest shapes of the types are selected.
+  std::optional<combination> bf16_combination =
+      select_combination<sycl::ext::oneapi::bfloat16,
+                         sycl::ext::oneapi::bfloat16, float>(
+          actual_combinations);
+  assert(bf16_combination && bf16_combination->msize == 32 &&
+         bf16_combination->nsize == 64 && bf16_combination->ksize == 16);
+  std::optional<combination> int8_combination =
+      select_combination<int8_t, int8_t, int32_t>(actual_combinations);
+  assert(int8_combination && int8_combination->msize == 8 &&
+         int8_combination->nsize == 16 && int8_combination->ksize == 32);
+  assert(!select_combination<double, double, double>(actual_combinations));
+
   return 0;
 }
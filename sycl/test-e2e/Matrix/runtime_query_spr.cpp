@@ -49,6 +49,12 @@ int main() {
            "Some values in matrix runtime query for PVC are not expected.");
   }
 
+  // The maximum sizes are selected.
+  std::optional<combination> int8_combination =
+      select_combination<uint8_t, int8_t, int32_t>(actual_combinations);
+  assert(int8_combination && int8_combination->msize == 16 &&
+         int8_combination->nsize == 16 && int8_combination->ksize == 64);
+
   std::cout << "Passed." << std::endl;
 
   return 0;
@@ -0,0 +1,56 @@
+// RUN: %{build} -o %t.out
+// RUN: %{run} %t.out
+
+// Submission cost of kernels using many buffer accessors, which goes through
+// the dependency tracking of the scheduler for each of them.
+
+#include "overhead_common.hpp"
+
+#include <array>
+
+template <size_t N> class AccessorKernel;
+
+template <size_t N>
+void run(sycl::queue &Queue, const overhead::options &Opts) {
+  std::vector<sycl::buffer<int, 1>> Buffers;
+  for (size_t I = 0; I < N; ++I)
+    Buffers.emplace_back(sycl::range<1>{1});
+  auto Submit = [&] {
+    return Queue.submit([&](sycl::handler &CGH) {
+      std::array<sycl::accessor<int, 1, sycl::access::mode::read_write>, N>
+          Accessors;
+      for (size_t I = 0; I < N; ++I)
+        Accessors[I] = Buffers[I].get_access(CGH);
+      CGH.single_task<AccessorKernel<N>>([=] {
+        for (size_t I = 0; I < N; ++I)
+          Accessors[I][0] += 1;
+      });
+    });
+  };
+
+  overhead::record("submit_accessors")
+      .add(Queue)
+      .add("queue", overhead::queueKind(Queue))
+      .add("accessors", N)
+      .add("mode", "submit")
+      .add(overhead::measure(Opts, 16, Submit, [&] { Queue.wait(); }))
+      .print();
+
+  overhead::record("submit_accessors")
+      .add(Queue)
+      .add("queue", overhead::queueKind(Queue))
+      .add("accessors", N)
+      .add("mode", "latency")
+      .add(overhead::measure(Opts, [&] { Submit().wait(); }))
+      .print();
+}
+
+int main() {
+  overhead::options Opts = overhead::getOptions();
+  sycl::queue Queue;
+
+  run<1>(Queue, Opts);
+  run<4>(Queue, Opts);
+  run<16>(Queue, Opts);
+  return 0;
+}
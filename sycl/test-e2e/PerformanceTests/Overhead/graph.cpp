@@ -0,0 +1,73 @@
+// RUN: %{build} -o %t.out
+// RUN: %{run} %t.out
+
+// Replay cost of an executable graph of empty kernels, next to the eager
+// submission of the same kernels.
+
+#include "overhead_common.hpp"
+
+#include <sycl/ext/oneapi/experimental/graph.hpp>
+
+namespace exp_ext = sycl::ext::oneapi::experimental;
+
+class GraphKernel;
+
+void run(sycl::queue &Queue, size_t NumKernels, const overhead::options &Opts) {
+  auto SubmitAll = [&] {
+    for (size_t I = 0; I < NumKernels; ++I)
+      Queue.submit(
+          [&](sycl::handler &CGH) { CGH.single_task<GraphKernel>([] {}); });
+  };
+
+  exp_ext::command_graph Graph{Queue.get_context(), Queue.get_device()};
+  Graph.begin_recording(Queue);
+  SubmitAll();
+  Graph.end_recording();
+
+  auto Start = std::chrono::steady_clock::now();
+  auto Exec = Graph.finalize();
+  auto End = std::chrono::steady_clock::now();
+  overhead::record("graph_finalize")
+      .add(Queue)
+      .add("queue", overhead::queueKind(Queue))
+      .add("kernels", NumKernels)
+      .add(std::vector<double>{
+          std::chrono::duration<double, std::nano>(End - Start).count()})
+      .print();
+
+  overhead::record("graph_replay")
+      .add(Queue)
+      .add("queue", overhead::queueKind(Queue))
+      .add("kernels", NumKernels)
+      .add("mode", "graph")
+      .add(overhead::measure(Opts,
+                             [&] { Queue.ext_oneapi_graph(Exec).wait(); }))
+      .print();
+
+  overhead::record("graph_replay")
+      .add(Queue)
+      .add("queue", overhead::queueKind(Queue))
+      .add("kernels", NumKernels)
+      .add("mode", "eager")
+      .add(overhead::measure(Opts, [&] {
+        SubmitAll();
+        Queue.wait();
+      }))
+      .print();
+}
+
+int main() {
+  overhead::options Opts = overhead::getOptions();
+  sycl::queue OutOfOrder;
+  if (!OutOfOrder.get_device().has(sycl::aspect::ext_oneapi_limited_graph)) {
+    std::cout << "Graphs are not supported by the device, skipping\n";
+    return 0;
+  }
+  sycl::queue InOrder{OutOfOrder.get_context(), OutOfOrder.get_device(),
+                      sycl::property::queue::in_order{}};
+
+  for (sycl::queue *Queue : {&InOrder, &OutOfOrder})
+    for (size_t NumKernels : {1, 16, 128})
+      run(*Queue, NumKernels, Opts);
+  return 0;
+}
@@ -0,0 +1,52 @@
+// RUN: %{build} -o %t.out
+// RUN: %{run} %t.out
+
+// Round-trip latency of host tasks, alone and between two kernels.
+
+#include "overhead_common.hpp"
+
+class BeforeHostTask;
+class AfterHostTask;
+
+int main() {
+  overhead::options Opts = overhead::getOptions();
+  sycl::queue OutOfOrder;
+  sycl::queue InOrder{OutOfOrder.get_context(), OutOfOrder.get_device(),
+                      sycl::property::queue::in_order{}};
+
+  for (sycl::queue *Queue : {&InOrder, &OutOfOrder}) {
+    overhead::record("host_task_round_trip")
+        .add(*Queue)
+        .add("queue", overhead::queueKind(*Queue))
+        .add("chain", "host_task")
+        .add(overhead::measure(Opts,
+                               [&] {
+                                 Queue->submit([&](sycl::handler &CGH) {
+                                   CGH.host_task([] {});
+                                 }).wait();
+                               }))
+        .print();
+
+    overhead::record("host_task_round_trip")
+        .add(*Queue)
+        .add("queue", overhead::queueKind(*Queue))
+        .add("chain", "kernel_host_task_kernel")
+        .add(overhead::measure(Opts, [&] {
+          sycl::event Kernel = Queue->submit([&](sycl::handler &CGH) {
+            CGH.single_task<BeforeHostTask>([] {});
+          });
+          sycl::event HostTask = Queue->submit([&](sycl::handler &CGH) {
+            CGH.depends_on(Kernel);
+            CGH.host_task([] {});
+          });
+          Queue
+              ->submit([&](sycl::handler &CGH) {
+                CGH.depends_on(HostTask);
+                CGH.single_task<AfterHostTask>([] {});
+              })
+              .wait();
+        }))
+        .print();
+  }
+  return 0;
+}
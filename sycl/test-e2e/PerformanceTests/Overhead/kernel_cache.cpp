@@ -0,0 +1,79 @@
+// RUN: %{build} -o %t.out
+// RUN: %{run} %t.out
+
+// Cost of the first launch of kernels, which builds their program, next to
+// the submission of kernels found in the kernel cache, cycling through one or
+// many of them.
+
+#include "overhead_common.hpp"
+
+#include <array>
+#include <optional>
+#include <utility>
+
+template <size_t I> class CachedKernel;
+
+template <size_t I> sycl::event launch(sycl::queue &Queue) {
+  return Queue.single_task<CachedKernel<I>>([] {});
+}
+
+template <size_t... Is>
+constexpr auto makeLaunches(std::index_sequence<Is...>) {
+  return std::array<sycl::event (*)(sycl::queue &), sizeof...(Is)>{
+      &launch<Is>...};
+}
+
+int main() {
+  overhead::options Opts = overhead::getOptions();
+  sycl::queue Queue;
+  constexpr size_t NumKernels = 32;
+  constexpr auto Launches =
+      makeLaunches(std::make_index_sequence<NumKernels>{});
+
+  // The first launch builds the program, the next ones only create the
+  // kernels of the program already built.
+  std::vector<double> FirstLaunches;
+  for (auto *Launch : Launches) {
+    auto Start = std::chrono::steady_clock::now();
+    Launch(Queue).wait();
+    auto End = std::chrono::steady_clock::now();
+    FirstLaunches.push_back(
+        std::chrono::duration<double, std::nano>(End - Start).count());
+  }
+  overhead::record("kernel_first_launch")
+      .add(Queue)
+      .add("program", "not_built")
+      .add(std::vector<double>{FirstLaunches.front()})
+      .print();
+  overhead::record("kernel_first_launch")
+      .add(Queue)
+      .add("program", "built")
+      .add(std::vector<double>(FirstLaunches.begin() + 1, FirstLaunches.end()))
+      .print();
+
+  for (size_t Kernels : {size_t(1), NumKernels}) {
+    size_t Next = 0;
+    overhead::record("kernel_cached_launch")
+        .add(Queue)
+        .add("kernels", Kernels)
+        .add(overhead::measure(
+            Opts, NumKernels,
+            [&] {
+              Launches[Next](Queue);
+              Next = (Next + 1) % Kernels;
+            },
+            [&] { Queue.wait(); }))
+        .print();
+  }
+
+  std::optional<sycl::kernel_id> KernelID;
+  overhead::record("get_kernel_id")
+      .add(Queue)
+      .add(overhead::measure(Opts,
+                             [&] {
+                               KernelID = sycl::get_kernel_id<
+                                   CachedKernel<NumKernels - 1>>();
+                             }))
+      .print();
+  return 0;
+}
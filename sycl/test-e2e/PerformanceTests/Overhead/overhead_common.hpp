@@ -0,0 +1,154 @@
+//==------- overhead_common.hpp - Runtime overhead benchmark helpers -------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// The runtime overhead benchmarks time the host side of the runtime with
+// kernels doing no work. Each measurement is printed as one JSON object per
+// line, and is also appended to the file named by SYCL_BENCH_OUTPUT when it
+// is set. SYCL_BENCH_ITERATIONS overrides the number of timed samples.
+
+#pragma once
+
+#include <sycl/sycl.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace overhead {
+
+struct options {
+  size_t Iterations = 1000;
+  size_t Warmup = 100;
+};
+
+inline options getOptions() {
+  options Opts;
+  if (const char *Iterations = std::getenv("SYCL_BENCH_ITERATIONS")) {
+    Opts.Iterations =
+        std::max<size_t>(1, std::strtoul(Iterations, nullptr, 10));
+    Opts.Warmup = std::max<size_t>(1, Opts.Iterations / 10);
+  }
+  return Opts;
+}
+
+/// Calls Fn Batch times per sample, Warmup samples first, and returns the
+/// time per call of each of the Iterations timed samples. Sync is called
+/// after each sample, outside the timed region.
+template <typename F, typename S>
+std::vector<double> measure(const options &Opts, size_t Batch, F &&Fn,
+                            S &&Sync) {
+  std::vector<double> Samples;
+  Samples.reserve(Opts.Iterations);
+  for (size_t I = 0; I < Opts.Warmup + Opts.Iterations; ++I) {
+    auto Start = std::chrono::steady_clock::now();
+    for (size_t J = 0; J < Batch; ++J)
+      Fn();
+    auto End = std::chrono::steady_clock::now();
+    Sync();
+    if (I >= Opts.Warmup)
+      Samples.push_back(
+          std::chrono::duration<double, std::nano>(End - Start).count() /
+          Batch);
+  }
+  return Samples;
+}
+
+template <typename F>
+std::vector<double> measure(const options &Opts, F &&Fn) {
+  return measure(Opts, 1, std::forward<F>(Fn), [] {});
+}
+
+/// One line of the output.
+class record {
+public:
+  explicit record(const std::string &Benchmark) {
+    MOut << std::fixed << std::setprecision(1);
+    add("benchmark", Benchmark);
+  }
+
+  record &add(const char *Key, const std::string &Value) {
+    key(Key) << '"';
+    for (char C : Value) {
+      if (C == '"' || C == '\\')
+        MOut << '\\' << C;
+      else if (static_cast<unsigned char>(C) < 0x20)
+        MOut << ' ';
+      else
+        MOut << C;
+    }
+    MOut << '"';
+    return *this;
+  }
+  record &add(const char *Key, const char *Value) {
+    return add(Key, std::string(Value));
+  }
+  record &add(const char *Key, double Value) {
+    key(Key) << Value;
+    return *this;
+  }
+  record &add(const char *Key, size_t Value) {
+    key(Key) << Value;
+    return *this;
+  }
+
+  record &add(const sycl::queue &Queue) {
+    sycl::device Device = Queue.get_device();
+    std::ostringstream Backend;
+    Backend << Device.get_backend();
+    add("device", Device.get_info<sycl::info::device::name>());
+    return add("backend", Backend.str());
+  }
+
+  /// Adds the statistics of the samples, in nanoseconds.
+  record &add(std::vector<double> Samples) {
+    if (Samples.empty())
+      return add("samples", size_t(0));
+    std::sort(Samples.begin(), Samples.end());
+    auto Percentile = [&](size_t P) {
+      return Samples[std::min(Samples.size() - 1, Samples.size() * P / 100)];
+    };
+    add("samples", Samples.size());
+    add("min_ns", Samples.front());
+    add("median_ns", Percentile(50));
+    add("mean_ns", std::accumulate(Samples.begin(), Samples.end(), 0.0) /
+                       Samples.size());
+    add("p90_ns", Percentile(90));
+    add("p99_ns", Percentile(99));
+    return add("max_ns", Samples.back());
+  }
+
+  void print() {
+    std::string Line = "{" + MOut.str() + "}\n";
+    std::cout << Line << std::flush;
+    if (const char *Path = std::getenv("SYCL_BENCH_OUTPUT"))
+      std::ofstream(Path, std::ios::app) << Line;
+  }
+
+private:
+  std::ostream &key(const char *Key) {
+    if (MOut.tellp() > 0)
+      MOut << ',';
+    return MOut << '"' << Key << "\":";
+  }
+
+  std::ostringstream MOut;
+};
+
+inline const char *queueKind(const sycl::queue &Queue) {
+  return Queue.is_in_order() ? "in_order" : "out_of_order";
+}
+
+} // namespace overhead
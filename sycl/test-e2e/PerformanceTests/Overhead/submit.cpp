@@ -0,0 +1,53 @@
+// RUN: %{build} -o %t.out
+// RUN: %{run} %t.out
+
+// Submission cost and round-trip latency of empty kernels on in-order and
+// out-of-order queues.
+
+#include "overhead_common.hpp"
+
+class EmptySingleTask;
+class EmptyParallelFor;
+
+template <typename SubmitF>
+void run(sycl::queue &Queue, const char *Kernel, const overhead::options &Opts,
+         SubmitF &&Submit) {
+  // Submissions only, waiting for the batch outside the timed region.
+  overhead::record("submit_empty_kernel")
+      .add(Queue)
+      .add("queue", overhead::queueKind(Queue))
+      .add("kernel", Kernel)
+      .add("mode", "submit")
+      .add(overhead::measure(Opts, 64, Submit, [&] { Queue.wait(); }))
+      .print();
+
+  // Submission and wait for each kernel.
+  overhead::record("submit_empty_kernel")
+      .add(Queue)
+      .add("queue", overhead::queueKind(Queue))
+      .add("kernel", Kernel)
+      .add("mode", "latency")
+      .add(overhead::measure(Opts, [&] { Submit().wait(); }))
+      .print();
+}
+
+int main() {
+  overhead::options Opts = overhead::getOptions();
+  sycl::queue OutOfOrder;
+  sycl::queue InOrder{OutOfOrder.get_context(), OutOfOrder.get_device(),
+                      sycl::property::queue::in_order{}};
+
+  for (sycl::queue *Queue : {&InOrder, &OutOfOrder}) {
+    run(*Queue, "single_task", Opts, [&] {
+      return Queue->submit(
+          [&](sycl::handler &CGH) { CGH.single_task<EmptySingleTask>([] {}); });
+    });
+    run(*Queue, "parallel_for", Opts, [&] {
+      return Queue->submit([&](sycl::handler &CGH) {
+        CGH.parallel_for<EmptyParallelFor>(sycl::range<1>{1},
+                                           [](sycl::id<1>) {});
+      });
+    });
+  }
+  return 0;
+}
@@ -0,0 +1,71 @@
+// RUN: %{build} -o %t.out
+// RUN: %{run} %t.out
+
+// Scaling of the submission of empty kernels from several threads, to one
+// shared queue or to one queue per thread.
+
+#include "overhead_common.hpp"
+
+#include <atomic>
+#include <thread>
+
+class ThreadKernel;
+
+void run(sycl::queue &Shared, size_t NumThreads, bool SharedQueue,
+         const overhead::options &Opts) {
+  constexpr size_t PerThread = 256;
+  std::vector<sycl::queue> Queues;
+  for (size_t I = 0; I < NumThreads; ++I)
+    Queues.push_back(SharedQueue ? Shared
+                                 : sycl::queue{Shared.get_context(),
+                                               Shared.get_device()});
+
+  // Each sample is the wall time of all the threads submitting, per
+  // submission, the threads being started before the timed region.
+  std::vector<double> Samples;
+  size_t NumSamples = std::max<size_t>(5, Opts.Iterations / 100);
+  for (size_t Sample = 0; Sample <= NumSamples; ++Sample) {
+    std::atomic<bool> Go{false};
+    std::vector<std::thread> Threads;
+    for (size_t I = 0; I < NumThreads; ++I)
+      Threads.emplace_back([&, I] {
+        while (!Go.load(std::memory_order_acquire))
+          std::this_thread::yield();
+        for (size_t J = 0; J < PerThread; ++J)
+          Queues[I].submit([&](sycl::handler &CGH) {
+            CGH.single_task<ThreadKernel>([] {});
+          });
+      });
+    auto Start = std::chrono::steady_clock::now();
+    Go.store(true, std::memory_order_release);
+    for (std::thread &Thread : Threads)
+      Thread.join();
+    auto End = std::chrono::steady_clock::now();
+    for (sycl::queue &Queue : Queues)
+      Queue.wait();
+    // The first sample is a warm-up.
+    if (Sample > 0)
+      Samples.push_back(
+          std::chrono::duration<double, std::nano>(End - Start).count() /
+          (NumThreads * PerThread));
+  }
+
+  overhead::record("multi_thread_submit")
+      .add(Shared)
+      .add("queues", SharedQueue ? "shared" : "per_thread")
+      .add("threads", NumThreads)
+      .add(Samples)
+      .print();
+}
+
+int main() {
+  overhead::options Opts = overhead::getOptions();
+  sycl::queue Queue;
+  size_t MaxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (bool SharedQueue : {true, false})
+    for (size_t NumThreads : {1, 2, 4, 8, 16})
+      if (NumThreads <= MaxThreads)
+        run(Queue, NumThreads, SharedQueue, Opts);
+  return 0;
+}
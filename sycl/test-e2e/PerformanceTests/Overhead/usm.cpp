@@ -0,0 +1,61 @@
+// RUN: %{build} -o %t.out
+// RUN: %{run} %t.out
+
+// Cost of the USM allocation and free calls by kind and size.
+
+#include "overhead_common.hpp"
+
+int main() {
+  overhead::options Opts = overhead::getOptions();
+  sycl::queue Queue;
+
+  for (sycl::usm::alloc Kind :
+       {sycl::usm::alloc::device, sycl::usm::alloc::host,
+        sycl::usm::alloc::shared}) {
+    if (!Queue.get_device().has(Kind == sycl::usm::alloc::device
+                                    ? sycl::aspect::usm_device_allocations
+                                : Kind == sycl::usm::alloc::host
+                                    ? sycl::aspect::usm_host_allocations
+                                    : sycl::aspect::usm_shared_allocations))
+      continue;
+    const char *KindName = Kind == sycl::usm::alloc::device ? "device"
+                           : Kind == sycl::usm::alloc::host ? "host"
+                                                            : "shared";
+
+    for (size_t Size : {64, 4096, 1 << 20}) {
+      // The allocations of each sample are freed outside the timed region,
+      // and timed apart.
+      std::vector<void *> Pointers;
+      std::vector<double> FreeSamples;
+      std::vector<double> AllocSamples = overhead::measure(
+          Opts, 16,
+          [&] { Pointers.push_back(sycl::malloc(Size, Queue, Kind)); },
+          [&] {
+            auto Start = std::chrono::steady_clock::now();
+            for (void *Pointer : Pointers)
+              sycl::free(Pointer, Queue);
+            auto End = std::chrono::steady_clock::now();
+            FreeSamples.push_back(
+                std::chrono::duration<double, std::nano>(End - Start).count() /
+                Pointers.size());
+            Pointers.clear();
+          });
+      FreeSamples.erase(FreeSamples.begin(),
+                        FreeSamples.begin() + Opts.Warmup);
+
+      overhead::record("usm_alloc")
+          .add(Queue)
+          .add("kind", KindName)
+          .add("bytes", Size)
+          .add(AllocSamples)
+          .print();
+      overhead::record("usm_free")
+          .add(Queue)
+          .add("kind", KindName)
+          .add("bytes", Size)
+          .add(FreeSamples)
+          .print();
+    }
+  }
+  return 0;
+}
@@ -305,6 +305,54 @@ template <typename T> void test_local_mem_usage_q() {
   syclcompat::free(h_a);
 }
 
+void test_launch_without_event() {
+  std::cout << __PRETTY_FUNCTION__ << std::endl;
+  LaunchTest lt;
+
+  int my_int;
+
+  syclcompat::launch_without_event<empty_kernel>(lt.range_1_, lt.q_);
+  syclcompat::launch_without_event<empty_kernel>(lt.range_2_, lt.q_);
+  syclcompat::launch_without_event<empty_kernel>(lt.range_3_, lt.q_);
+  syclcompat::launch_without_event<empty_kernel>(lt.grid_, lt.thread_, lt.q_);
+
+  syclcompat::launch_without_event<int_kernel>(lt.range_1_, lt.q_, my_int);
+  syclcompat::launch_without_event<int_kernel>(lt.grid_, lt.thread_, lt.q_,
+                                               my_int);
+
+  syclcompat::launch_without_event<dynamic_local_mem_empty_kernel>(lt.range_1_,
+                                                                   1, lt.q_);
+  syclcompat::launch_without_event<dynamic_local_mem_empty_kernel>(
+      lt.grid_, lt.thread_, 1, lt.q_);
+  syclcompat::wait(lt.q_);
+}
+
+template <typename T> void test_local_mem_usage_without_event() {
+  std::cout << __PRETTY_FUNCTION__ << std::endl;
+
+  LaunchTestWithArgs<T> ltt;
+  if (ltt.skip_) // Unsupported aspect
+    return;
+
+  size_t num_elements = ltt.memsize_ / sizeof(T);
+  auto &q = ltt.in_order_q_;
+
+  T *h_a = (T *)syclcompat::malloc_host(ltt.memsize_);
+  T *d_a = (T *)syclcompat::malloc(ltt.memsize_, q);
+
+  syclcompat::launch_without_event<dynamic_local_mem_typed_kernel<T>>(
+      ltt.grid_, ltt.thread_, ltt.memsize_, q, d_a);
+
+  syclcompat::memcpy(h_a, d_a, ltt.memsize_, q);
+  syclcompat::free(d_a, q);
+
+  for (size_t i = 0; i < num_elements; i++) {
+    assert(h_a[i] == static_cast<T>(num_elements - i - 1));
+  }
+
+  syclcompat::free(h_a);
+}
+
 template <typename T> void test_memsize_no_arg_launch() {
   std::cout << __PRETTY_FUNCTION__ << std::endl;
 
@@ -344,5 +392,8 @@ int main() {
   INSTANTIATE_ALL_TYPES(memsize_type_list, test_memsize_no_arg_launch);
   INSTANTIATE_ALL_TYPES(memsize_type_list, test_memsize_no_arg_launch_q);
 
+  test_launch_without_event();
+  INSTANTIATE_ALL_TYPES(value_type_list, test_local_mem_usage_without_event);
+
   return 0;
 }
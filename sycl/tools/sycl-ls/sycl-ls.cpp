@@ -16,12 +16,19 @@
 // In verbose mode it also prints, which devices would be chosen by various SYCL
 // device selectors.
 //
+// With --bench or --bench-json it runs microbenchmarks on each device instead,
+// and prints their results as a table or as JSON.
+//
 #include <sycl/sycl.hpp>
 
+#include <chrono>
 #include <cstdlib>
+#include <iomanip>
 #include <iostream>
 #include <map>
 #include <stdlib.h>
+#include <string>
+#include <utility>
 #include <vector>
 
 #ifdef _WIN32
@@ -41,6 +48,10 @@ bool DiscardFilters;
 // To store various filter environment variables.
 std::vector<std::string> FilterEnvVars;
 
+enum class BenchOutput { None, Table, JSON };
+// Controls whether to run the microbenchmarks and how to print them.
+BenchOutput Bench = BenchOutput::None;
+
 // Trivial custom selector that selects a device of the given type.
 class custom_selector : public device_selector {
   info::device_type MType;
@@ -119,8 +130,8 @@ static void printSelectorChoice(const device_selector &Selector,
 }
 
 static int printUsageAndExit() {
-  std::cout << "Usage: sycl-ls [--verbose] [--ignore-device-selectors]"
-            << std::endl;
+  std::cout << "Usage: sycl-ls [--verbose] [--ignore-device-selectors] "
+            << "[--bench | --bench-json]" << std::endl;
   std::cout << "This program lists all devices and backends discovered by SYCL."
             << std::endl;
   std::cout << "\n Options:" << std::endl;
@@ -133,10 +144,143 @@ static int printUsageAndExit() {
       << "\t Lists all platforms available on the system irrespective "
       << "of DPCPP filter environment variables (like ONEAPI_DEVICE_SELECTOR)."
       << std::endl;
+  std::cout << "\t --bench " << "\t Runs microbenchmarks on each device and "
+            << "prints their results as a table." << std::endl;
+  std::cout << "\t --bench-json " << "\t Same as --bench, but prints the "
+            << "results as JSON." << std::endl;
 
   return EXIT_FAILURE;
 }
 
+// Results of the microbenchmarks of a device, as name and value pairs. The
+// name ends with the unit of the value.
+using BenchResults = std::vector<std::pair<std::string, double>>;
+
+// Mean time in microseconds of an iteration of Func, after a warm-up one.
+template <typename FuncT>
+static double timeIterations(int Iterations, FuncT &&Func) {
+  Func();
+  auto Start = std::chrono::steady_clock::now();
+  for (int I = 0; I < Iterations; ++I)
+    Func();
+  std::chrono::duration<double, std::micro> Time =
+      std::chrono::steady_clock::now() - Start;
+  return Time.count() / Iterations;
+}
+
+static std::string getSizeName(size_t Size) {
+  if (Size >= (1 << 20))
+    return std::to_string(Size >> 20) + "MiB";
+  return std::to_string(Size >> 10) + "KiB";
+}
+
+// sycl-ls is not compiled for devices, so the benchmarks are limited to the
+// commands which do not run device code.
+static BenchResults runBenchmarks(const device &Device) {
+  BenchResults Results;
+  context Context{Device};
+  queue InOrderQueue{Context, Device, property::queue::in_order()};
+  queue OutOfOrderQueue{Context, Device};
+
+  // Latency of a command with an empty payload.
+  constexpr int LatencyIterations = 100;
+  auto addLatency = [&](const char *Name, auto &&Func) {
+    Results.emplace_back(Name, timeIterations(LatencyIterations, Func));
+  };
+  addLatency("barrier_in_order_us",
+             [&]() { InOrderQueue.ext_oneapi_submit_barrier().wait(); });
+  addLatency("barrier_out_of_order_us",
+             [&]() { OutOfOrderQueue.ext_oneapi_submit_barrier().wait(); });
+  addLatency("host_task_round_trip_us", [&]() {
+    OutOfOrderQueue.submit([](handler &CGH) { CGH.host_task([]() {}); })
+        .wait();
+  });
+
+  if (!Device.has(aspect::usm_device_allocations) ||
+      !Device.has(aspect::usm_host_allocations))
+    return Results;
+
+  // Bandwidth of the USM copies, by size.
+  constexpr size_t MaxSize = 64 << 20;
+  void *Host = malloc_host(MaxSize, Context);
+  void *Dev = malloc_device(MaxSize, Device, Context);
+  void *Dev2 = malloc_device(MaxSize, Device, Context);
+  if (Host && Dev && Dev2) {
+    InOrderQueue.memset(Host, 0, MaxSize);
+    InOrderQueue.memset(Dev, 0, MaxSize).wait();
+    for (size_t Size : {size_t{4} << 10, size_t{1} << 20, MaxSize}) {
+      int Iterations = Size == MaxSize ? 10 : 100;
+      auto addBandwidth = [&](const char *Name, void *Dst, const void *Src) {
+        double Time = timeIterations(Iterations, [&]() {
+          InOrderQueue.memcpy(Dst, Src, Size).wait();
+        });
+        // Bytes per microsecond to GB/s.
+        Results.emplace_back(std::string(Name) + "_" + getSizeName(Size) +
+                                 "_GBps",
+                             Size / Time / 1e3);
+      };
+      addBandwidth("usm_h2d", Dev, Host);
+      addBandwidth("usm_d2h", Host, Dev);
+      addBandwidth("usm_d2d", Dev2, Dev);
+    }
+  }
+  free(Host, Context);
+  free(Dev, Context);
+  free(Dev2, Context);
+  return Results;
+}
+
+// Runs the benchmarks on all the devices and prints their results.
+static void printBenchmarks(const std::vector<platform> &Platforms,
+                            bool SuppressNumberPrinting) {
+  std::map<backend, size_t> DeviceNums;
+  bool JSON = Bench == BenchOutput::JSON;
+  if (JSON)
+    std::cout << "[";
+  const char *Separator = "";
+  for (const auto &Platform : Platforms) {
+    backend Backend = Platform.get_backend();
+    for (const auto &Device : Platform.get_devices()) {
+      std::string DeviceId =
+          std::string(detail::get_backend_name_no_vendor(Backend)) + ":" +
+          (SuppressNumberPrinting ? getDeviceTypeName(Device)
+                                  : std::to_string(DeviceNums[Backend]++));
+      auto DeviceName = Device.get_info<info::device::name>();
+      BenchResults Results;
+      std::string Error;
+      try {
+        Results = runBenchmarks(Device);
+      } catch (const sycl::exception &Exception) {
+        Error = Exception.what();
+      }
+
+      if (JSON) {
+        // Quotes the string, the names and messages need no other escaping
+        // in practice.
+        auto quote = [](const std::string &Str) { return '"' + Str + '"'; };
+        std::cout << Separator << "\n  {\"device\": " << quote(DeviceId)
+                  << ", \"name\": " << quote(DeviceName);
+        for (const auto &[Name, Value] : Results)
+          std::cout << ", " << quote(Name) << ": " << Value;
+        if (!Error.empty())
+          std::cout << ", \"error\": " << quote(Error);
+        std::cout << "}";
+        Separator = ",";
+        continue;
+      }
+
+      std::cout << "[" << DeviceId << "] " << DeviceName << std::endl;
+      for (const auto &[Name, Value] : Results)
+        std::cout << "    " << std::left << std::setw(32) << Name << ": "
+                  << std::fixed << std::setprecision(2) << Value << std::endl;
+      if (!Error.empty())
+        std::cout << "    Benchmarks failed: " << Error << std::endl;
+    }
+  }
+  if (JSON)
+    std::cout << "\n]" << std::endl;
+}
+
 // Print warning and suppress printing device ids if any of
 // the filter environment variable is set.
 static void printWarningIfFiltersUsed(bool &SuppressNumberPrinting) {
@@ -253,6 +397,10 @@ int main(int argc, char **argv) {
         verbose = true;
       else if (argv[i] == "--ignore-device-selectors"sv)
         DiscardFilters = true;
+      else if (argv[i] == "--bench"sv)
+        Bench = BenchOutput::Table;
+      else if (argv[i] == "--bench-json"sv)
+        Bench = BenchOutput::JSON;
       else
         return printUsageAndExit();
     }
@@ -279,6 +427,11 @@ int main(int argc, char **argv) {
 
     const auto &Platforms = platform::get_platforms();
 
+    if (Bench != BenchOutput::None) {
+      printBenchmarks(Platforms, SuppressNumberPrinting);
+      return EXIT_SUCCESS;
+    }
+
     // Keep track of the number of devices per backend
     std::map<backend, size_t> DeviceNums;
 
@@ -6,6 +6,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "kernel_metrics.hpp"
+#include "timeline.hpp"
 #include "writer.hpp"
 #include "xpti/xpti_data_types.h"
 
@@ -22,6 +24,8 @@
 namespace chrono = std::chrono;
 
 Writer *GWriter = nullptr;
+KernelTimeline *GTimeline = nullptr;
+KernelMetrics *GMetrics = nullptr;
 
 struct Measurements {
   size_t TID;
@@ -31,15 +35,17 @@ struct Measurements {
 
 unsigned long process_id() { return static_cast<unsigned long>(getpid()); }
 
+static size_t timeStamp() {
+  auto Now = chrono::high_resolution_clock::now();
+  return chrono::time_point_cast<chrono::nanoseconds>(Now)
+      .time_since_epoch()
+      .count();
+}
+
 static Measurements measure() {
   size_t TID = std::hash<std::thread::id>{}(std::this_thread::get_id());
   size_t PID = process_id();
-  auto Now = chrono::high_resolution_clock::now();
-  size_t TS = chrono::time_point_cast<chrono::nanoseconds>(Now)
-                  .time_since_epoch()
-                  .count();
-
-  return Measurements{TID, PID, TS};
+  return Measurements{TID, PID, timeStamp()};
 }
 
 XPTI_CALLBACK_API void apiBeginEndCallback(uint16_t TraceType,
@@ -57,6 +63,16 @@ XPTI_CALLBACK_API void waitBeginEndCallback(uint16_t TraceType,
                                             xpti::trace_event_data_t *,
                                             uint64_t /*Instance*/,
                                             const void *UserData);
+XPTI_CALLBACK_API void edgeCreateCallback(uint16_t TraceType,
+                                          xpti::trace_event_data_t *,
+                                          xpti::trace_event_data_t *,
+                                          uint64_t /*Instance*/,
+                                          const void *UserData);
+XPTI_CALLBACK_API void piArgsCallback(uint16_t TraceType,
+                                      xpti::trace_event_data_t *,
+                                      xpti::trace_event_data_t *,
+                                      uint64_t /*Instance*/,
+                                      const void *UserData);
 
 XPTI_CALLBACK_API void xptiTraceInit(unsigned int /*major_version*/,
                                      unsigned int /*minor_version*/,
@@ -67,8 +83,16 @@ XPTI_CALLBACK_API void xptiTraceInit(unsigned int /*major_version*/,
     if (!ProfOutFile)
       throw std::runtime_error(
           "SYCL_PROF_OUT_FILE environment variable is not specified");
-    GWriter = new JSONWriter(ProfOutFile);
+    const char *ProfOutFormat = std::getenv("SYCL_PROF_OUT_FORMAT");
+    if (ProfOutFormat && std::string_view{ProfOutFormat} == "binary")
+      GWriter = new BinaryWriter(ProfOutFile);
+    else
+      GWriter = new JSONWriter(ProfOutFile);
     GWriter->init();
+    if (std::getenv("SYCL_PROF_TIMELINE"))
+      GTimeline = new KernelTimeline(*GWriter, timeStamp);
+    if (std::getenv("SYCL_PROF_METRICS"))
+      GMetrics = new KernelMetrics();
   }
 
   std::string_view NameView{StreamName};
@@ -90,6 +114,17 @@ XPTI_CALLBACK_API void xptiTraceInit(unsigned int /*major_version*/,
                          waitBeginEndCallback);
     xptiRegisterCallback(StreamID, xpti::trace_barrier_end,
                          waitBeginEndCallback);
+    if (GTimeline)
+      xptiRegisterCallback(StreamID, xpti::trace_edge_create,
+                           edgeCreateCallback);
+  } else if (NameView == "sycl.pi.debug") {
+    if (!GTimeline && !GMetrics)
+      return;
+    uint8_t StreamID = xptiRegisterStream(StreamName);
+    xptiRegisterCallback(StreamID, xpti::trace_function_with_args_begin,
+                         piArgsCallback);
+    xptiRegisterCallback(StreamID, xpti::trace_function_with_args_end,
+                         piArgsCallback);
   } else if (NameView == "sycl.experimental.level_zero.call") {
     uint8_t StreamID = xptiRegisterStream(StreamName);
     xptiRegisterCallback(StreamID, xpti::trace_function_begin,
@@ -105,7 +140,13 @@ XPTI_CALLBACK_API void xptiTraceInit(unsigned int /*major_version*/,
   }
 }
 
-XPTI_CALLBACK_API void xptiTraceFinish(const char *) { GWriter->finalize(); }
+XPTI_CALLBACK_API void xptiTraceFinish(const char *) {
+  if (GTimeline)
+    GTimeline->finish();
+  if (GMetrics)
+    GMetrics->finish();
+  GWriter->finalize();
+}
 
 XPTI_CALLBACK_API void apiBeginEndCallback(uint16_t TraceType,
                                            xpti::trace_event_data_t *,
@@ -139,8 +180,16 @@ XPTI_CALLBACK_API void taskBeginEndCallback(uint16_t TraceType,
   auto [TID, PID, TS] = measure();
   if (TraceType == xpti::trace_task_begin) {
     GWriter->writeBegin(Name, "SYCL", PID, TID, TS);
+    if (GTimeline)
+      GTimeline->taskBegin(Event->unique_id, Name);
+    if (GMetrics)
+      GMetrics->taskBegin(Name);
   } else {
     GWriter->writeEnd(Name, "SYCL", PID, TID, TS);
+    if (GTimeline)
+      GTimeline->taskEnd();
+    if (GMetrics)
+      GMetrics->taskEnd();
   }
 }
 
@@ -159,3 +208,26 @@ XPTI_CALLBACK_API void waitBeginEndCallback(uint16_t TraceType,
                       TS);
   }
 }
+
+XPTI_CALLBACK_API void edgeCreateCallback(uint16_t,
+                                          xpti::trace_event_data_t *,
+                                          xpti::trace_event_data_t *Edge,
+                                          uint64_t /*Instance*/,
+                                          const void *) {
+  if (Edge)
+    GTimeline->edgeCreate(Edge->source_id, Edge->target_id);
+}
+
+XPTI_CALLBACK_API void piArgsCallback(uint16_t TraceType,
+                                      xpti::trace_event_data_t *,
+                                      xpti::trace_event_data_t *,
+                                      uint64_t /*Instance*/,
+                                      const void *UserData) {
+  const auto *Data = static_cast<const xpti::function_with_args_t *>(UserData);
+  if (GTimeline) {
+    Measurements Caller = measure();
+    GTimeline->functionWithArgs(TraceType, Data, Caller.PID, Caller.TID);
+  }
+  if (GMetrics)
+    GMetrics->functionWithArgs(TraceType, Data);
+}
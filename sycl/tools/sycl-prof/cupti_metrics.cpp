@@ -0,0 +1,224 @@
+//==----------------- cupti_metrics.cpp ------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+/// \file cupti_metrics.cpp
+/// Metric source of the CUDA devices, reading the CUPTI metrics with the
+/// event groups counting during the kernels. The events of the metrics may
+/// need several passes, each launch of a kernel counts the next pass, and the
+/// metrics of the kernel are computed once all the passes were counted.
+
+#include "metric_source.hpp"
+
+#include <cuda.h>
+#include <cupti.h>
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define COLLECTOR_EXPORT_API __attribute__((__visibility__("default")))
+
+namespace {
+enum class metric_kind { Bytes, Flops, Occupancy };
+
+const struct {
+  const char *MName;
+  metric_kind MKind;
+} Metrics[] = {
+    {"dram_read_bytes", metric_kind::Bytes},
+    {"dram_write_bytes", metric_kind::Bytes},
+    {"flop_count_hp", metric_kind::Flops},
+    {"flop_count_sp", metric_kind::Flops},
+    {"flop_count_dp", metric_kind::Flops},
+    {"achieved_occupancy", metric_kind::Occupancy},
+};
+
+class CuptiMetricSource final : public MetricSource {
+public:
+  CuptiMetricSource(CUcontext Context, CUdevice Device)
+      : MContext(Context), MDevice(Device) {}
+
+  ~CuptiMetricSource() override {
+    if (MPasses)
+      cuptiEventGroupSetsDestroy(MPasses);
+  }
+
+  bool init() {
+    for (const auto &Metric : Metrics) {
+      CUpti_MetricID ID;
+      if (cuptiMetricGetIdFromName(MDevice, Metric.MName, &ID) ==
+          CUPTI_SUCCESS) {
+        MIDs.push_back(ID);
+        MKinds.push_back(Metric.MKind);
+      }
+    }
+    CUptiResult Result = CUPTI_ERROR_UNKNOWN;
+    if (!MIDs.empty())
+      Result = cuptiSetEventCollectionMode(MContext,
+                                           CUPTI_EVENT_COLLECTION_MODE_KERNEL);
+    if (Result == CUPTI_SUCCESS)
+      Result = cuptiMetricCreateEventGroupSets(
+          MContext, MIDs.size() * sizeof(CUpti_MetricID), MIDs.data(),
+          &MPasses);
+    if (Result != CUPTI_SUCCESS) {
+      const char *Error = "no metric found";
+      if (!MIDs.empty())
+        cuptiGetResultString(Result, &Error);
+      std::cerr << "sycl-prof: cannot read the CUPTI metrics of the device: "
+                << Error << "\n";
+      return false;
+    }
+    return true;
+  }
+
+  bool start(const std::string &Kernel) override {
+    kernel_passes &Passes = MKernels[Kernel];
+    return cuptiEventGroupSetEnable(&MPasses->sets[Passes.MNext]) ==
+           CUPTI_SUCCESS;
+  }
+
+  bool stop(const std::string &Kernel, uint64_t DurationNs,
+            kernel_counters &Counters) override {
+    kernel_passes &Passes = MKernels[Kernel];
+    CUpti_EventGroupSet &Pass = MPasses->sets[Passes.MNext];
+    bool Read = DurationNs > 0;
+    for (uint32_t I = 0; Read && I < Pass.numEventGroups; ++I)
+      Read = readGroup(Pass.eventGroups[I], Passes.MEvents);
+    cuptiEventGroupSetDisable(&Pass);
+    if (!Read) {
+      // The passes are all counted again.
+      MKernels.erase(Kernel);
+      return false;
+    }
+    Passes.MDurationNs += DurationNs;
+    if (++Passes.MNext < MPasses->numSets)
+      return false;
+
+    // The metrics are computed for the average of the launches.
+    std::vector<CUpti_EventID> IDs;
+    std::vector<uint64_t> Values;
+    for (const auto &[ID, Value] : Passes.MEvents) {
+      IDs.push_back(ID);
+      Values.push_back(Value / MPasses->numSets);
+    }
+    Counters.MDurationNs = Passes.MDurationNs / MPasses->numSets;
+    for (size_t I = 0; I < MIDs.size(); ++I) {
+      double Value = 0;
+      if (!getValue(MIDs[I], IDs, Values, Counters.MDurationNs, Value))
+        continue;
+      double &Counter = MKinds[I] == metric_kind::Bytes   ? Counters.MBytes
+                        : MKinds[I] == metric_kind::Flops ? Counters.MFlops
+                                                          : Counters.MOccupancy;
+      Counter = (Counter < 0 ? 0 : Counter) + Value;
+    }
+    MKernels.erase(Kernel);
+    return true;
+  }
+
+private:
+  struct kernel_passes {
+    uint32_t MNext = 0;
+    uint64_t MDurationNs = 0;
+    /// Sums of the events over the passes, for all the instances of their
+    /// domains
+    std::map<CUpti_EventID, uint64_t> MEvents;
+  };
+
+  bool readGroup(CUpti_EventGroup Group,
+                 std::map<CUpti_EventID, uint64_t> &Events) {
+    CUpti_EventDomainID Domain;
+    uint32_t NumEvents = 0, Instances = 0, TotalInstances = 0;
+    size_t Size = sizeof(Domain);
+    if (cuptiEventGroupGetAttribute(Group,
+                                    CUPTI_EVENT_GROUP_ATTR_EVENT_DOMAIN_ID,
+                                    &Size, &Domain) != CUPTI_SUCCESS)
+      return false;
+    Size = sizeof(NumEvents);
+    if (cuptiEventGroupGetAttribute(Group, CUPTI_EVENT_GROUP_ATTR_NUM_EVENTS,
+                                    &Size, &NumEvents) != CUPTI_SUCCESS)
+      return false;
+    Size = sizeof(Instances);
+    if (cuptiEventGroupGetAttribute(Group,
+                                    CUPTI_EVENT_GROUP_ATTR_INSTANCE_COUNT,
+                                    &Size, &Instances) != CUPTI_SUCCESS ||
+        Instances == 0)
+      return false;
+    Size = sizeof(TotalInstances);
+    if (cuptiDeviceGetEventDomainAttribute(
+            MDevice, Domain, CUPTI_EVENT_DOMAIN_ATTR_TOTAL_INSTANCE_COUNT,
+            &Size, &TotalInstances) != CUPTI_SUCCESS)
+      return false;
+    std::vector<CUpti_EventID> IDs(NumEvents);
+    Size = NumEvents * sizeof(CUpti_EventID);
+    if (cuptiEventGroupGetAttribute(Group, CUPTI_EVENT_GROUP_ATTR_EVENTS,
+                                    &Size, IDs.data()) != CUPTI_SUCCESS)
+      return false;
+
+    // The events are counted by some of the instances of their domain.
+    std::vector<uint64_t> Values(Instances);
+    for (CUpti_EventID ID : IDs) {
+      Size = Instances * sizeof(uint64_t);
+      if (cuptiEventGroupReadEvent(Group, CUPTI_EVENT_READ_FLAG_NONE, ID,
+                                   &Size, Values.data()) != CUPTI_SUCCESS)
+        return false;
+      uint64_t Sum = 0;
+      for (uint64_t Value : Values)
+        Sum += Value;
+      Events[ID] += Sum * TotalInstances / Instances;
+    }
+    return true;
+  }
+
+  bool getValue(CUpti_MetricID ID, std::vector<CUpti_EventID> &IDs,
+                std::vector<uint64_t> &Values, uint64_t DurationNs,
+                double &Out) {
+    CUpti_MetricValueKind Kind;
+    size_t Size = sizeof(Kind);
+    CUpti_MetricValue Value;
+    if (cuptiMetricGetAttribute(ID, CUPTI_METRIC_ATTR_VALUE_KIND, &Size,
+                                &Kind) != CUPTI_SUCCESS ||
+        cuptiMetricGetValue(MDevice, ID, IDs.size() * sizeof(CUpti_EventID),
+                            IDs.data(), Values.size() * sizeof(uint64_t),
+                            Values.data(), DurationNs,
+                            &Value) != CUPTI_SUCCESS)
+      return false;
+    switch (Kind) {
+    case CUPTI_METRIC_VALUE_KIND_DOUBLE:
+      Out = Value.metricValueDouble;
+      return true;
+    case CUPTI_METRIC_VALUE_KIND_UINT64:
+      Out = static_cast<double>(Value.metricValueUint64);
+      return true;
+    case CUPTI_METRIC_VALUE_KIND_INT64:
+      Out = static_cast<double>(Value.metricValueInt64);
+      return true;
+    case CUPTI_METRIC_VALUE_KIND_PERCENT:
+      Out = Value.metricValuePercent / 100;
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  CUcontext MContext;
+  CUdevice MDevice;
+  std::vector<CUpti_MetricID> MIDs;
+  std::vector<metric_kind> MKinds;
+  CUpti_EventGroupSets *MPasses = nullptr;
+  std::map<std::string, kernel_passes> MKernels;
+};
+} // namespace
+
+extern "C" COLLECTOR_EXPORT_API MetricSource *
+createMetricSource(pi_native_handle Context, pi_native_handle Device) {
+  auto Source = std::make_unique<CuptiMetricSource>(
+      reinterpret_cast<CUcontext>(Context), static_cast<CUdevice>(Device));
+  return Source->init() ? Source.release() : nullptr;
+}
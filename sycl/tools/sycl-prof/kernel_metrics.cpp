@@ -0,0 +1,375 @@
+//==----------------- kernel_metrics.cpp -----------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "kernel_metrics.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <iostream>
+
+thread_local KernelMetrics::thread_state KernelMetrics::MThread;
+
+namespace {
+std::string getCurrentDSODir() {
+  auto CurrentFunc = reinterpret_cast<const void *>(&getCurrentDSODir);
+  Dl_info Info;
+  if (dladdr(CurrentFunc, &Info) == 0)
+    return "";
+  std::string Path = Info.dli_fname;
+  return Path.substr(0, Path.find_last_of('/'));
+}
+
+double getPeak(const char *Variable) {
+  const char *Value = std::getenv(Variable);
+  return Value ? std::max(0.0, std::strtod(Value, nullptr)) : 0;
+}
+
+/// Floating point operations per cycle of a compute unit used to estimate
+/// the peak FLOP rate: the FMA of the FP32 lanes of an EU of the Intel GPUs,
+/// or of an SM of the NVIDIA GPUs. Set SYCL_PROF_PEAK_GFLOPS for a precise
+/// roof.
+constexpr double IntelFlopsPerCycle = 16;
+constexpr double NVIDIAFlopsPerCycle = 128;
+} // namespace
+
+KernelMetrics::KernelMetrics() {
+  MArgHandler.set_piextQueueCreate([this](const pi_plugin &,
+                                          std::optional<pi_result> Result,
+                                          pi_context, pi_device,
+                                          pi_queue_properties *Properties,
+                                          pi_queue *Queue) {
+    if (!Result) {
+      // The device time of the kernels needs a profiling queue.
+      if (Properties && Properties[0] == PI_QUEUE_FLAGS)
+        Properties[1] |= PI_QUEUE_FLAG_PROFILING_ENABLE;
+      return;
+    }
+    // A new queue may reuse the handle of a released one.
+    std::lock_guard<std::mutex> Lock(MMutex);
+    MQueueDevices.erase(*Queue);
+  });
+  auto OnLaunch = [this](const pi_plugin &Plugin,
+                         std::optional<pi_result> Result, pi_queue Queue,
+                         pi_kernel Kernel, pi_uint32, const size_t *,
+                         const size_t *, const size_t *, pi_uint32,
+                         const pi_event *, pi_event *Event) {
+    if (!Result)
+      launchBegin(Plugin.PiFunctionTable, Queue, Kernel);
+    else
+      launchEnd(*Result, Event);
+  };
+  MArgHandler.set_piEnqueueKernelLaunch(OnLaunch);
+  MArgHandler.set_piextEnqueueCooperativeKernelLaunch(OnLaunch);
+  MArgHandler.set_piTearDown([this](const pi_plugin &Plugin,
+                                    std::optional<pi_result> Result, void *) {
+    if (!Result)
+      release(Plugin.PiFunctionTable);
+  });
+}
+
+void KernelMetrics::taskBegin(std::string_view Name) { MThread.MName = Name; }
+
+void KernelMetrics::taskEnd() { MThread.MName.clear(); }
+
+void KernelMetrics::functionWithArgs(uint16_t TraceType,
+                                     const xpti::function_with_args_t *Data) {
+  std::optional<pi_result> Result;
+  if (TraceType == xpti::trace_function_with_args_end)
+    Result = *static_cast<pi_result *>(Data->ret_data);
+  MArgHandler.handle(Data->function_id,
+                     *static_cast<const pi_plugin *>(Data->user_data), Result,
+                     Data->args_data);
+}
+
+KernelMetrics::device_info *
+KernelMetrics::getDevice(const plugin_functions_t &Plugin, pi_queue Queue) {
+  auto [QueueDevice, NewQueue] = MQueueDevices.try_emplace(Queue, nullptr);
+  if (NewQueue &&
+      Plugin.piQueueGetInfo(Queue, PI_QUEUE_INFO_DEVICE, sizeof(pi_device),
+                            &QueueDevice->second, nullptr) != PI_SUCCESS) {
+    MQueueDevices.erase(QueueDevice);
+    return nullptr;
+  }
+
+  pi_device Handle = QueueDevice->second;
+  std::unique_ptr<device_info> &Device = MDevices[Handle];
+  if (!Device) {
+    Device = std::make_unique<device_info>();
+    Device->MPlugin = Plugin;
+    char Name[256] = "";
+    Plugin.piDeviceGetInfo(Handle, PI_DEVICE_INFO_NAME, sizeof(Name) - 1,
+                           Name, nullptr);
+    Device->MName = Name;
+    MDeviceOrder.push_back(Device.get());
+    findPeaks(*Device, Handle);
+    loadSource(*Device, Queue);
+  }
+  return Device.get();
+}
+
+void KernelMetrics::loadSource(device_info &Device, pi_queue Queue) {
+  const plugin_functions_t &Plugin = Device.MPlugin;
+  pi_device Handle = nullptr;
+  pi_context Context = nullptr;
+  pi_platform Platform = nullptr;
+  pi_platform_backend Backend = PI_EXT_PLATFORM_BACKEND_UNKNOWN;
+  pi_native_handle NativeDevice = 0, NativeContext = 0;
+  if (Plugin.piQueueGetInfo(Queue, PI_QUEUE_INFO_DEVICE, sizeof(Handle),
+                            &Handle, nullptr) != PI_SUCCESS ||
+      Plugin.piQueueGetInfo(Queue, PI_QUEUE_INFO_CONTEXT, sizeof(Context),
+                            &Context, nullptr) != PI_SUCCESS ||
+      Plugin.piDeviceGetInfo(Handle, PI_DEVICE_INFO_PLATFORM,
+                             sizeof(Platform), &Platform,
+                             nullptr) != PI_SUCCESS ||
+      Plugin.piPlatformGetInfo(Platform, PI_EXT_PLATFORM_INFO_BACKEND,
+                               sizeof(Backend), &Backend,
+                               nullptr) != PI_SUCCESS ||
+      Plugin.piextDeviceGetNativeHandle(Handle, &NativeDevice) != PI_SUCCESS ||
+      Plugin.piextContextGetNativeHandle(Context, &NativeContext) !=
+          PI_SUCCESS) {
+    std::cerr << "sycl-prof: cannot read the metrics of " << Device.MName
+              << "\n";
+    return;
+  }
+
+  const char *Library = nullptr;
+  if (Backend == PI_EXT_PLATFORM_BACKEND_LEVEL_ZERO)
+    Library = "libsycl_prof_ze_metrics.so";
+  else if (Backend == PI_EXT_PLATFORM_BACKEND_CUDA)
+    Library = "libsycl_prof_cupti_metrics.so";
+  if (!Library) {
+    std::cerr << "sycl-prof: the metrics of " << Device.MName
+              << " are only read with the Level Zero and CUDA backends\n";
+    return;
+  }
+
+  std::string Path = getCurrentDSODir() + "/" + Library;
+  Device.MLibrary = dlopen(Path.c_str(), RTLD_LAZY | RTLD_LOCAL);
+  auto Create =
+      Device.MLibrary ? reinterpret_cast<create_metric_source_t>(
+                            dlsym(Device.MLibrary, CreateMetricSourceName))
+                      : nullptr;
+  if (!Create) {
+    std::cerr << "sycl-prof: cannot load the metric library: " << dlerror()
+              << "\n";
+    return;
+  }
+  Device.MSource.reset(Create(NativeContext, NativeDevice));
+}
+
+void KernelMetrics::findPeaks(device_info &Device, pi_device Handle) {
+  Device.MPeakGFlops = getPeak("SYCL_PROF_PEAK_GFLOPS");
+  Device.MPeakGBs = getPeak("SYCL_PROF_PEAK_GBS");
+  const plugin_functions_t &Plugin = Device.MPlugin;
+  auto Get = [&](pi_device_info Info) {
+    pi_uint32 Value = 0;
+    Plugin.piDeviceGetInfo(Handle, Info, sizeof(Value), &Value, nullptr);
+    return double(Value);
+  };
+
+  if (!Device.MPeakGFlops) {
+    pi_platform Platform = nullptr;
+    pi_platform_backend Backend = PI_EXT_PLATFORM_BACKEND_UNKNOWN;
+    Plugin.piDeviceGetInfo(Handle, PI_DEVICE_INFO_PLATFORM, sizeof(Platform),
+                           &Platform, nullptr);
+    Plugin.piPlatformGetInfo(Platform, PI_EXT_PLATFORM_INFO_BACKEND,
+                             sizeof(Backend), &Backend, nullptr);
+    double FlopsPerCycle = Backend == PI_EXT_PLATFORM_BACKEND_CUDA
+                               ? NVIDIAFlopsPerCycle
+                               : IntelFlopsPerCycle;
+    // The clock is in MHz.
+    Device.MPeakGFlops = Get(PI_DEVICE_INFO_MAX_COMPUTE_UNITS) *
+                         Get(PI_DEVICE_INFO_MAX_CLOCK_FREQUENCY) *
+                         FlopsPerCycle / 1e3;
+    Device.MEstimatedPeaks = true;
+  }
+  if (!Device.MPeakGBs) {
+    // The bus width is in bits and the memory clock in MHz, with two
+    // transfers per cycle.
+    Device.MPeakGBs = Get(PI_EXT_INTEL_DEVICE_INFO_MEMORY_BUS_WIDTH) / 8 *
+                      Get(PI_EXT_INTEL_DEVICE_INFO_MEMORY_CLOCK_RATE) * 2 /
+                      1e3;
+    Device.MEstimatedPeaks = true;
+  }
+}
+
+void KernelMetrics::launchBegin(const plugin_functions_t &Plugin,
+                                pi_queue Queue, pi_kernel Kernel) {
+  device_info *Device = nullptr;
+  {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    if (MFinished)
+      return;
+    Device = getDevice(Plugin, Queue);
+  }
+  if (!Device || !Device->MSource)
+    return;
+
+  std::string Name = MThread.MName;
+  if (Name.empty()) {
+    char FunctionName[1024] = "";
+    Plugin.piKernelGetInfo(Kernel, PI_KERNEL_INFO_FUNCTION_NAME,
+                           sizeof(FunctionName) - 1, FunctionName, nullptr);
+    Name = *FunctionName ? FunctionName : "kernel";
+  }
+
+  // The counters only see this kernel once the work submitted before is
+  // done and until the kernel completes.
+  MLaunchMutex.lock();
+  if (Plugin.piQueueFinish(Queue) != PI_SUCCESS ||
+      !Device->MSource->start(Name)) {
+    MLaunchMutex.unlock();
+    return;
+  }
+  MThread.MDevice = Device;
+  MThread.MQueue = Queue;
+  MThread.MKernel = std::move(Name);
+}
+
+void KernelMetrics::launchEnd(pi_result Result, pi_event *Event) {
+  device_info *Device = MThread.MDevice;
+  if (!Device)
+    return;
+  MThread.MDevice = nullptr;
+  const plugin_functions_t &Plugin = Device->MPlugin;
+
+  uint64_t Begin = 0, End = 0;
+  bool Timed = false;
+  if (Result == PI_SUCCESS && Event && *Event) {
+    Timed = Plugin.piEventsWait(1, Event) == PI_SUCCESS &&
+            Plugin.piEventGetProfilingInfo(*Event,
+                                           PI_PROFILING_INFO_COMMAND_START,
+                                           sizeof(Begin), &Begin,
+                                           nullptr) == PI_SUCCESS &&
+            Plugin.piEventGetProfilingInfo(*Event,
+                                           PI_PROFILING_INFO_COMMAND_END,
+                                           sizeof(End), &End,
+                                           nullptr) == PI_SUCCESS &&
+            Begin <= End;
+  } else {
+    Plugin.piQueueFinish(MThread.MQueue);
+  }
+  kernel_counters Counters;
+  bool Counted = Device->MSource->stop(MThread.MKernel,
+                                       Timed ? End - Begin : 0, Counters) &&
+                 Counters.MDurationNs;
+  MLaunchMutex.unlock();
+  if (Result != PI_SUCCESS)
+    return;
+
+  std::lock_guard<std::mutex> Lock(MMutex);
+  kernel_stats &Stats = Device->MKernels[MThread.MKernel];
+  ++Stats.MLaunches;
+  Stats.MTimeNs += End - Begin;
+  if (!Counted)
+    return;
+  if (Counters.MBytes >= 0) {
+    Stats.MBytes += Counters.MBytes;
+    Stats.MBytesNs += Counters.MDurationNs;
+  }
+  if (Counters.MFlops >= 0) {
+    Stats.MFlops += Counters.MFlops;
+    Stats.MFlopsNs += Counters.MDurationNs;
+  }
+  if (Counters.MOccupancy >= 0) {
+    Stats.MOccupancy += Counters.MOccupancy;
+    ++Stats.MOccupancyLaunches;
+  }
+}
+
+void KernelMetrics::release(const plugin_functions_t &Plugin) {
+  // The sources are destroyed while the backend is still there.
+  std::unique_lock<std::mutex> LaunchLock(MLaunchMutex);
+  std::lock_guard<std::mutex> Lock(MMutex);
+  for (auto &[Handle, Device] : MDevices) {
+    if (Device->MPlugin.piTearDown != Plugin.piTearDown)
+      continue;
+    Device->MSource.reset();
+    if (Device->MLibrary)
+      dlclose(Device->MLibrary);
+    Device->MLibrary = nullptr;
+  }
+  for (auto It = MQueueDevices.begin(); It != MQueueDevices.end();) {
+    auto Device = MDevices.find(It->second);
+    if (Device != MDevices.end() &&
+        Device->second->MPlugin.piTearDown == Plugin.piTearDown)
+      It = MQueueDevices.erase(It);
+    else
+      ++It;
+  }
+}
+
+void KernelMetrics::finish() {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  if (MFinished)
+    return;
+  MFinished = true;
+  for (const device_info *Device : MDeviceOrder)
+    if (!Device->MKernels.empty())
+      print(*Device);
+}
+
+void KernelMetrics::print(const device_info &Device) const {
+  char Line[512];
+  std::snprintf(Line, sizeof(Line),
+                "sycl-prof: kernel metrics of %s, roof of %.1f GFLOP/s and "
+                "%.1f GB/s%s\n",
+                Device.MName.c_str(), Device.MPeakGFlops, Device.MPeakGBs,
+                Device.MEstimatedPeaks ? " (estimated)" : "");
+  std::cerr << Line;
+  std::snprintf(Line, sizeof(Line), "%9s %11s %9s %9s %8s %6s %6s %-7s %s\n",
+                "Launches", "Avg us", "GB/s", "GFLOP/s", "FLOP/B", "Occ %",
+                "Roof %", "Bound", "Kernel");
+  std::cerr << Line;
+
+  auto Column = [](char *Out, double Value, bool Known, const char *Format) {
+    if (Known)
+      std::snprintf(Out, 16, Format, Value);
+    else
+      std::snprintf(Out, 16, "-");
+  };
+  // The bytes and FLOPs per ns are the GB/s and GFLOP/s.
+  double Ridge = Device.MPeakGBs > 0 ? Device.MPeakGFlops / Device.MPeakGBs : 0;
+  for (const auto &[Name, Stats] : Device.MKernels) {
+    bool HasBytes = Stats.MBytesNs > 0, HasFlops = Stats.MFlopsNs > 0;
+    double GBs = HasBytes ? Stats.MBytes / Stats.MBytesNs : 0;
+    double GFlops = HasFlops ? Stats.MFlops / Stats.MFlopsNs : 0;
+    bool HasIntensity = HasBytes && HasFlops && GBs > 0;
+    double Intensity = HasIntensity ? GFlops / GBs : 0;
+
+    // The kernel is placed under the roof at its arithmetic intensity: the
+    // memory roof left of the ridge point and the compute roof right of it.
+    const char *Bound = "-";
+    double Roof = 0;
+    if (HasIntensity && Ridge > 0 && Device.MPeakGFlops > 0) {
+      Bound = Intensity < Ridge ? "memory" : "compute";
+      Roof = std::min(Device.MPeakGFlops, Intensity * Device.MPeakGBs);
+      Roof = GFlops / Roof * 100;
+    } else if (HasBytes && Device.MPeakGBs > 0) {
+      Roof = GBs / Device.MPeakGBs * 100;
+    }
+
+    char Bandwidth[16], Rate[16], AI[16], Occupancy[16], RoofPercent[16];
+    Column(Bandwidth, GBs, HasBytes, "%.1f");
+    Column(Rate, GFlops, HasFlops, "%.1f");
+    Column(AI, Intensity, HasIntensity, "%.2f");
+    Column(Occupancy,
+           Stats.MOccupancyLaunches
+               ? Stats.MOccupancy / Stats.MOccupancyLaunches * 100
+               : 0,
+           Stats.MOccupancyLaunches, "%.0f");
+    Column(RoofPercent, Roof, Roof > 0, "%.0f");
+    std::snprintf(Line, sizeof(Line),
+                  "%9zu %11.2f %9s %9s %8s %6s %6s %-7s %s\n", Stats.MLaunches,
+                  Stats.MTimeNs / 1e3 / Stats.MLaunches, Bandwidth, Rate, AI,
+                  Occupancy, RoofPercent, Bound, Name.c_str());
+    std::cerr << Line;
+  }
+}
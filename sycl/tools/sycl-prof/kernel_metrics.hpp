@@ -0,0 +1,104 @@
+//==----------------- kernel_metrics.hpp -----------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "metric_source.hpp"
+#include "pi_arguments_handler.hpp"
+
+#include <sycl/detail/pi.h>
+#include <xpti/xpti_data_types.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/// Reads the hardware counters of the devices for each kernel launch, and
+/// prints the achieved memory bandwidth, FLOP rate and occupancy of each
+/// kernel with its place on the roofline of its device.
+///
+/// The counters are read through the Level Zero metric groups or CUPTI,
+/// by the metric library of the backend loaded for each device. The kernel
+/// launches are serialized: a launch waits for its queue to be idle, and for
+/// the kernel to complete before the next launch starts, so that the
+/// counters only see one kernel. The kernels are named after the command of
+/// the scheduler which launches them.
+class KernelMetrics {
+public:
+  KernelMetrics();
+  ~KernelMetrics() { finish(); }
+
+  /// Remembers the command being enqueued by the calling thread, so that the
+  /// kernel launch that follows is named after it.
+  void taskBegin(std::string_view Name);
+  void taskEnd();
+  void functionWithArgs(uint16_t TraceType,
+                        const xpti::function_with_args_t *Data);
+  /// Prints the metrics of the kernels to stderr, once.
+  void finish();
+
+private:
+  using plugin_functions_t = pi_plugin::FunctionPointers;
+
+  struct kernel_stats {
+    size_t MLaunches = 0;
+    uint64_t MTimeNs = 0;
+    /// Sums over the launches whose counters were read, with the device time
+    /// they cover
+    double MBytes = 0, MFlops = 0, MOccupancy = 0;
+    uint64_t MBytesNs = 0, MFlopsNs = 0;
+    size_t MOccupancyLaunches = 0;
+  };
+
+  struct device_info {
+    plugin_functions_t MPlugin;
+    std::string MName;
+    /// Library of the metric source, closed after the source is destroyed
+    void *MLibrary = nullptr;
+    std::unique_ptr<MetricSource> MSource;
+    /// Roof of the device, in GFLOP/s and GB/s, 0 if unknown
+    double MPeakGFlops = 0, MPeakGBs = 0;
+    bool MEstimatedPeaks = false;
+    std::map<std::string, kernel_stats> MKernels;
+  };
+
+  /// The command being enqueued by a thread, and its launch being measured
+  struct thread_state {
+    std::string MName;
+    device_info *MDevice = nullptr;
+    pi_queue MQueue = nullptr;
+    std::string MKernel;
+  };
+  static thread_local thread_state MThread;
+
+  device_info *getDevice(const plugin_functions_t &Plugin, pi_queue Queue);
+  void loadSource(device_info &Device, pi_queue Queue);
+  void findPeaks(device_info &Device, pi_device Handle);
+  void launchBegin(const plugin_functions_t &Plugin, pi_queue Queue,
+                   pi_kernel Kernel);
+  void launchEnd(pi_result Result, pi_event *Event);
+  void release(const plugin_functions_t &Plugin);
+  void print(const device_info &Device) const;
+
+  sycl::xpti_helpers::PiArgumentsHandler MArgHandler;
+  /// Held by the thread launching a kernel being measured, from the begin to
+  /// the end of the launch call
+  std::mutex MLaunchMutex;
+  /// Guards the members below
+  std::mutex MMutex;
+  bool MFinished = false;
+  std::unordered_map<pi_device, std::unique_ptr<device_info>> MDevices;
+  std::unordered_map<pi_queue, pi_device> MQueueDevices;
+  /// The devices in the order they were found
+  std::vector<device_info *> MDeviceOrder;
+};
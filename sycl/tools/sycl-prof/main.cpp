@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "launch.hpp"
+#include "writer.hpp"
 #include "llvm/Support/CommandLine.h"
 
 #include <iostream>
@@ -14,7 +15,7 @@
 
 using namespace llvm;
 
-enum OutputFormatKind { JSON };
+enum OutputFormatKind { JSON, Binary };
 
 int main(int argc, char **argv, char *env[]) {
   cl::opt<OutputFormatKind> OutputFormat(
@@ -22,16 +23,60 @@ int main(int argc, char **argv, char *env[]) {
       cl::values(
           // TODO performance summary
           clEnumValN(JSON, "json",
-                     "JSON file, compatible with chrome://tracing")));
+                     "JSON file, compatible with chrome://tracing"),
+          clEnumValN(Binary, "binary",
+                     "Binary file with a lower overhead, converted to JSON "
+                     "with -convert")));
+  cl::opt<std::string> ConvertFilename(
+      "convert", cl::desc("Convert a binary trace to the JSON output file"),
+      cl::value_desc("filename"));
+  cl::opt<bool> Timeline(
+      "timeline",
+      cl::desc("Add the device execution of the kernels, with one track per "
+               "queue, linked to their submissions and dependencies. The "
+               "queues are created with profiling enabled"));
+  cl::opt<bool> Metrics(
+      "metrics",
+      cl::desc("Read the hardware counters of each kernel launch, with Level "
+               "Zero or CUPTI, and print the memory bandwidth, FLOP rate and "
+               "occupancy of the kernels with their place on the roofline of "
+               "the device. The kernel launches are serialized"));
+  cl::opt<double> PeakGFlops(
+      "peak-gflops",
+      cl::desc("Peak FLOP rate of the device for the roofline, estimated from "
+               "the device info if not set"),
+      cl::value_desc("GFLOP/s"));
+  cl::opt<double> PeakGBs(
+      "peak-gbs",
+      cl::desc("Peak memory bandwidth of the device for the roofline, "
+               "estimated from the device info if not set"),
+      cl::value_desc("GB/s"));
   cl::opt<std::string> OutputFilename("o", cl::desc("Specify output filename"),
                                       cl::value_desc("filename"), cl::Required);
   cl::opt<std::string> TargetExecutable(
-      cl::Positional, cl::desc("<target executable>"), cl::Required);
+      cl::Positional, cl::desc("<target executable>"));
   cl::list<std::string> Argv(cl::ConsumeAfter,
                              cl::desc("<program arguments>..."));
 
   cl::ParseCommandLineOptions(argc, argv);
 
+  if (!ConvertFilename.empty()) {
+    JSONWriter Out(OutputFilename);
+    if (!convertBinaryTrace(ConvertFilename, Out)) {
+      std::cerr << "Failed to read binary trace " << ConvertFilename << "\n";
+      return 1;
+    }
+    return 0;
+  }
+  if (TargetExecutable.empty()) {
+    std::cerr << "No target executable specified\n";
+    return 1;
+  }
+  if (Timeline && OutputFormat == Binary) {
+    std::cerr << "-timeline is only supported with -format=json\n";
+    return 1;
+  }
+
   std::vector<std::string> NewEnv;
 
   {
@@ -42,6 +87,18 @@ int main(int argc, char **argv, char *env[]) {
 
   std::string ProfOutFile = "SYCL_PROF_OUT_FILE=" + OutputFilename;
   NewEnv.push_back(ProfOutFile);
+  if (OutputFormat == Binary)
+    NewEnv.push_back("SYCL_PROF_OUT_FORMAT=binary");
+  if (Timeline)
+    NewEnv.push_back("SYCL_PROF_TIMELINE=1");
+  if (Metrics) {
+    NewEnv.push_back("SYCL_PROF_METRICS=1");
+    NewEnv.push_back("ZET_ENABLE_METRICS=1");
+    if (PeakGFlops > 0)
+      NewEnv.push_back("SYCL_PROF_PEAK_GFLOPS=" + std::to_string(PeakGFlops));
+    if (PeakGBs > 0)
+      NewEnv.push_back("SYCL_PROF_PEAK_GBS=" + std::to_string(PeakGBs));
+  }
   NewEnv.push_back("XPTI_FRAMEWORK_DISPATCHER=libxptifw.so");
   NewEnv.push_back("XPTI_SUBSCRIBERS=libsycl_profiler_collector.so");
   NewEnv.push_back("XPTI_TRACE_ENABLE=1");
@@ -0,0 +1,52 @@
+//==----------------- metric_source.hpp ------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sycl/detail/pi.h>
+
+#include <cstdint>
+#include <string>
+
+/// What a metric source counted for one launch of a kernel. The counters it
+/// could not read are negative.
+struct kernel_counters {
+  /// Device time the counters cover
+  uint64_t MDurationNs = 0;
+  /// Bytes read from and written to the device memory
+  double MBytes = -1;
+  /// Floating point operations
+  double MFlops = -1;
+  /// Active hardware threads relative to the maximum, from 0 to 1
+  double MOccupancy = -1;
+};
+
+/// Reads the hardware counters of a device around the launches of kernels.
+/// The launches are serialized by the collector, so that the device is idle
+/// when start() is called and the kernel is complete when stop() is called.
+class MetricSource {
+public:
+  virtual ~MetricSource() = default;
+
+  /// Called right before a launch of Kernel.
+  virtual bool start(const std::string &Kernel) = 0;
+  /// Called once the launch is complete, DurationNs being its device time or
+  /// 0 if it is not known. The counters may need several launches of the
+  /// kernel to be read when they do not fit in one pass, in which case they
+  /// are averaged over these launches.
+  /// @returns true if Counters were filled.
+  virtual bool stop(const std::string &Kernel, uint64_t DurationNs,
+                    kernel_counters &Counters) = 0;
+};
+
+/// Exported with C linkage by the metric libraries of the backends. Creates
+/// the source of a device from the native handles of its context and of the
+/// device, or prints why it cannot and returns nullptr.
+using create_metric_source_t = MetricSource *(*)(pi_native_handle Context,
+                                                 pi_native_handle Device);
+inline constexpr const char *CreateMetricSourceName = "createMetricSource";
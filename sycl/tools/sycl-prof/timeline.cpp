@@ -0,0 +1,275 @@
+//==----------------- timeline.cpp -----------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "timeline.hpp"
+
+#include <chrono>
+#include <limits>
+
+namespace {
+/// The command being enqueued by this thread and the caller of the PI call
+/// being handled.
+struct thread_state {
+  uint64_t MNodeID = 0;
+  std::string MName;
+  size_t MPID = 0, MTID = 0;
+  size_t MTime = 0;
+};
+thread_local thread_state GThread;
+
+constexpr auto PollInterval = std::chrono::milliseconds(10);
+constexpr size_t CalibrationInterval = 1000000000;
+/// Time given to the kernels of a plugin being torn down to complete
+constexpr auto TearDownTimeout = std::chrono::seconds(5);
+} // namespace
+
+KernelTimeline::KernelTimeline(Writer &Out, clock_fn Now)
+    : MOut(Out), MNow(Now) {
+  MArgHandler.set_piextQueueCreate([this](const pi_plugin &,
+                                          std::optional<pi_result> Result,
+                                          pi_context, pi_device,
+                                          pi_queue_properties *Properties,
+                                          pi_queue *Queue) {
+    if (!Result) {
+      // The device time stamps of the events need a profiling queue.
+      if (Properties && Properties[0] == PI_QUEUE_FLAGS)
+        Properties[1] |= PI_QUEUE_FLAG_PROFILING_ENABLE;
+      return;
+    }
+    // A new queue may reuse the handle of a released one.
+    std::lock_guard<std::mutex> Lock(MMutex);
+    auto It = MQueueDevices.find(*Queue);
+    if (It == MQueueDevices.end())
+      return;
+    if (auto Device = MDevices.find(It->second); Device != MDevices.end())
+      Device->second->MQueues.erase(*Queue);
+    MQueueDevices.erase(It);
+  });
+  auto OnLaunch = [this](const pi_plugin &Plugin,
+                         std::optional<pi_result> Result, pi_queue Queue,
+                         pi_kernel, pi_uint32, const size_t *, const size_t *,
+                         const size_t *, pi_uint32, const pi_event *,
+                         pi_event *Event) {
+    if (Result == PI_SUCCESS && Event && *Event)
+      launched(Plugin.PiFunctionTable, Queue, *Event, GThread.MPID,
+               GThread.MTID);
+  };
+  MArgHandler.set_piEnqueueKernelLaunch(OnLaunch);
+  MArgHandler.set_piextEnqueueCooperativeKernelLaunch(OnLaunch);
+  MArgHandler.set_piTearDown([this](const pi_plugin &Plugin,
+                                    std::optional<pi_result> Result, void *) {
+    if (Result)
+      return;
+    std::lock_guard<std::mutex> Lock(MMutex);
+    collect(&Plugin.PiFunctionTable, /*Wait=*/true);
+  });
+  MThread = std::thread([this] { run(); });
+}
+
+void KernelTimeline::taskBegin(uint64_t NodeID, std::string_view Name) {
+  GThread.MNodeID = NodeID;
+  GThread.MName = Name;
+}
+
+void KernelTimeline::taskEnd() {
+  GThread.MNodeID = 0;
+  GThread.MName.clear();
+}
+
+void KernelTimeline::edgeCreate(uint64_t SourceID, uint64_t TargetID) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  MEdges[TargetID].push_back(SourceID);
+}
+
+void KernelTimeline::functionWithArgs(uint16_t TraceType,
+                                      const xpti::function_with_args_t *Data,
+                                      size_t PID, size_t TID) {
+  GThread.MPID = PID;
+  GThread.MTID = TID;
+  GThread.MTime = MNow();
+  std::optional<pi_result> Result;
+  if (TraceType == xpti::trace_function_with_args_end)
+    Result = *static_cast<pi_result *>(Data->ret_data);
+  MArgHandler.handle(Data->function_id,
+                      *static_cast<const pi_plugin *>(Data->user_data), Result,
+                      Data->args_data);
+}
+
+void KernelTimeline::finish() {
+  {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    if (MStop)
+      return;
+    MStop = true;
+  }
+  MCV.notify_all();
+  if (MThread.joinable())
+    MThread.join();
+  MPending.clear();
+}
+
+KernelTimeline::device_track *
+KernelTimeline::getDevice(const plugin_functions_t &Plugin, pi_queue Queue,
+                          size_t &TID) {
+  auto [QueueDevice, NewQueue] = MQueueDevices.try_emplace(Queue, nullptr);
+  if (NewQueue &&
+      Plugin.piQueueGetInfo(Queue, PI_QUEUE_INFO_DEVICE, sizeof(pi_device),
+                            &QueueDevice->second, nullptr) != PI_SUCCESS) {
+    MQueueDevices.erase(QueueDevice);
+    return nullptr;
+  }
+
+  pi_device Handle = QueueDevice->second;
+  std::unique_ptr<device_track> &Device = MDevices[Handle];
+  if (!Device) {
+    size_t Index = MDevices.size();
+    Device = std::make_unique<device_track>();
+    Device->MPlugin = Plugin;
+    Device->MHandle = Handle;
+    // The device tracks are shown as processes of their own, after the host.
+    Device->MPID = (GThread.MPID << 8) + Index;
+    char Name[256] = "";
+    Plugin.piDeviceGetInfo(Handle, PI_DEVICE_INFO_NAME, sizeof(Name) - 1,
+                           Name, nullptr);
+    MOut.writeProcessName(Device->MPID, "Device " + std::to_string(Index) +
+                                            ": " + Name);
+    MOut.writeProcessSortIndex(Device->MPID, Index);
+    calibrate(*Device);
+  }
+
+  auto [Track, NewTrack] = Device->MQueues.try_emplace(Queue, 0);
+  if (NewTrack) {
+    Track->second = Device->MQueues.size();
+    MOut.writeThreadName(Device->MPID, Track->second,
+                         "Queue " + std::to_string(Track->second));
+  }
+  TID = Track->second;
+  return Device.get();
+}
+
+void KernelTimeline::calibrate(device_track &Device) {
+  // The host time of the device time stamp is taken in the middle of the
+  // narrowest of a few readings. If the timer cannot be read, the offset
+  // measured last, if any, is kept.
+  size_t Narrowest = std::numeric_limits<size_t>::max();
+  for (int I = 0; I < 5; ++I) {
+    uint64_t DeviceTime = 0;
+    size_t Before = MNow();
+    if (Device.MPlugin.piGetDeviceAndHostTimer(Device.MHandle, &DeviceTime,
+                                               nullptr) != PI_SUCCESS)
+      break;
+    size_t After = MNow();
+    if (After - Before < Narrowest) {
+      Narrowest = After - Before;
+      Device.MOffset = static_cast<int64_t>(Before + (After - Before) / 2) -
+                       static_cast<int64_t>(DeviceTime);
+    }
+  }
+  Device.MLastCalibration = MNow();
+}
+
+void KernelTimeline::launched(const plugin_functions_t &Plugin,
+                              pi_queue Queue, pi_event Event, size_t PID,
+                              size_t TID) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  if (MStop)
+    return;
+  size_t Track = 0;
+  device_track *Device = getDevice(Plugin, Queue, Track);
+  if (!Device || Plugin.piEventRetain(Event) != PI_SUCCESS)
+    return;
+
+  // The flow from the submission starts within the host slice of the call.
+  MPending.push_back(kernel_launch{Device, Track, Event,
+                                   GThread.MName.empty() ? "kernel"
+                                                         : GThread.MName,
+                                   GThread.MNodeID, PID, TID, GThread.MTime});
+}
+
+void KernelTimeline::collect(const plugin_functions_t *Plugin, bool Wait) {
+  auto Deadline = std::chrono::steady_clock::now() + TearDownTimeout;
+  for (auto It = MPending.begin(); It != MPending.end();) {
+    const plugin_functions_t &Functions = It->MDevice->MPlugin;
+    if (Plugin && Functions.piEventRelease != Plugin->piEventRelease) {
+      ++It;
+      continue;
+    }
+
+    pi_int32 Status = PI_EVENT_QUEUED;
+    pi_result Result = PI_SUCCESS;
+    while ((Result = Functions.piEventGetInfo(
+                It->MEvent, PI_EVENT_INFO_COMMAND_EXECUTION_STATUS,
+                sizeof(Status), &Status, nullptr)) == PI_SUCCESS &&
+           Status != PI_EVENT_COMPLETE && Wait &&
+           std::chrono::steady_clock::now() < Deadline)
+      std::this_thread::sleep_for(PollInterval / 10);
+    if (Result == PI_SUCCESS && Status != PI_EVENT_COMPLETE && !Wait) {
+      ++It;
+      continue;
+    }
+
+    uint64_t Begin = 0, End = 0;
+    if (Result == PI_SUCCESS && Status == PI_EVENT_COMPLETE &&
+        Functions.piEventGetProfilingInfo(
+            It->MEvent, PI_PROFILING_INFO_COMMAND_START, sizeof(Begin), &Begin,
+            nullptr) == PI_SUCCESS &&
+        Functions.piEventGetProfilingInfo(It->MEvent,
+                                          PI_PROFILING_INFO_COMMAND_END,
+                                          sizeof(End), &End,
+                                          nullptr) == PI_SUCCESS &&
+        Begin <= End)
+      write(*It, Begin, End);
+    Functions.piEventRelease(It->MEvent);
+    It = MPending.erase(It);
+  }
+}
+
+void KernelTimeline::write(const kernel_launch &Launch, uint64_t Begin,
+                           uint64_t End) {
+  device_track &Device = *Launch.MDevice;
+  if (MNow() - Device.MLastCalibration > CalibrationInterval)
+    calibrate(Device);
+  if (!Device.MOffset)
+    return;
+  size_t HostBegin = Begin + *Device.MOffset;
+  size_t HostEnd = End + *Device.MOffset;
+  MOut.writeComplete(Launch.MName, "Device", Device.MPID, Launch.MTID,
+                     HostBegin, HostEnd);
+
+  size_t FlowID = MNextFlowID++;
+  MOut.writeFlow(FlowID, /*IsStart=*/true, "submission", Launch.MHostPID,
+                 Launch.MHostTID, Launch.MSubmitTime);
+  MOut.writeFlow(FlowID, /*IsStart=*/false, "submission", Device.MPID,
+                 Launch.MTID, HostBegin);
+  if (!Launch.MNodeID)
+    return;
+
+  MSlices[Launch.MNodeID] = device_slice{Device.MPID, Launch.MTID, HostBegin};
+  auto Sources = MEdges.find(Launch.MNodeID);
+  if (Sources == MEdges.end())
+    return;
+  for (uint64_t Source : Sources->second) {
+    auto Slice = MSlices.find(Source);
+    if (Slice == MSlices.end())
+      continue;
+    FlowID = MNextFlowID++;
+    MOut.writeFlow(FlowID, /*IsStart=*/true, "dependency", Slice->second.MPID,
+                   Slice->second.MTID, Slice->second.MBegin);
+    MOut.writeFlow(FlowID, /*IsStart=*/false, "dependency", Device.MPID,
+                   Launch.MTID, HostBegin);
+  }
+  MEdges.erase(Sources);
+}
+
+void KernelTimeline::run() {
+  std::unique_lock<std::mutex> Lock(MMutex);
+  while (!MStop) {
+    MCV.wait_for(Lock, PollInterval);
+    collect(nullptr, /*Wait=*/false);
+  }
+}
@@ -0,0 +1,112 @@
+//==----------------- timeline.hpp -----------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "pi_arguments_handler.hpp"
+#include "writer.hpp"
+
+#include <sycl/detail/pi.h>
+#include <xpti/xpti_data_types.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// Collects the device execution of the kernels and writes it as one track
+/// per queue, grouped by device, next to the host tracks.
+///
+/// The kernel launches are seen on the sycl.pi.debug stream. Their events are
+/// retained and a background thread reads their profiling information once
+/// they complete. The device time stamps are moved to the host clock with an
+/// offset measured through piGetDeviceAndHostTimer, which is measured again
+/// every second to follow the drift of the clocks. The queues are created
+/// with profiling enabled so that the time stamps are available.
+///
+/// Each device slice is linked by a flow to the host thread which submitted
+/// it, and, for the commands of the scheduler, to the device slices of the
+/// kernels it depends on as told by the edges of the sycl stream.
+class KernelTimeline {
+public:
+  using clock_fn = size_t (*)();
+
+  KernelTimeline(Writer &Out, clock_fn Now);
+  ~KernelTimeline() { finish(); }
+
+  /// Remembers the command being enqueued by the calling thread, so that the
+  /// kernel launch that follows is attributed to it.
+  void taskBegin(uint64_t NodeID, std::string_view Name);
+  void taskEnd();
+  void edgeCreate(uint64_t SourceID, uint64_t TargetID);
+  void functionWithArgs(uint16_t TraceType,
+                        const xpti::function_with_args_t *Data, size_t PID,
+                        size_t TID);
+  /// Stops the background thread and drops the kernels that have not been
+  /// read yet, as the plugins may be gone.
+  void finish();
+
+private:
+  using plugin_functions_t = pi_plugin::FunctionPointers;
+
+  struct device_track {
+    plugin_functions_t MPlugin;
+    pi_device MHandle;
+    size_t MPID;
+    /// Host time minus device time, if the device timer could be read
+    std::optional<int64_t> MOffset;
+    size_t MLastCalibration = 0;
+    std::unordered_map<pi_queue, size_t> MQueues;
+  };
+
+  struct kernel_launch {
+    device_track *MDevice;
+    size_t MTID;
+    pi_event MEvent;
+    std::string MName;
+    uint64_t MNodeID;
+    /// Host thread and time stamp of the submission
+    size_t MHostPID, MHostTID, MSubmitTime;
+  };
+
+  struct device_slice {
+    size_t MPID, MTID, MBegin;
+  };
+
+  device_track *getDevice(const plugin_functions_t &Plugin, pi_queue Queue,
+                          size_t &TID);
+  void calibrate(device_track &Device);
+  void launched(const plugin_functions_t &Plugin, pi_queue Queue,
+                pi_event Event, size_t PID, size_t TID);
+  /// Reads the launches which are complete, or all the launches of Plugin
+  /// if Wait is set. Called with MMutex held.
+  void collect(const plugin_functions_t *Plugin, bool Wait);
+  void write(const kernel_launch &Launch, uint64_t Begin, uint64_t End);
+  void run();
+
+  Writer &MOut;
+  clock_fn MNow;
+  sycl::xpti_helpers::PiArgumentsHandler MArgHandler;
+  std::mutex MMutex;
+  std::condition_variable MCV;
+  bool MStop = false;
+  std::thread MThread;
+  std::unordered_map<pi_device, std::unique_ptr<device_track>> MDevices;
+  std::unordered_map<pi_queue, pi_device> MQueueDevices;
+  std::vector<kernel_launch> MPending;
+  /// Dependencies of the commands, by target
+  std::unordered_map<uint64_t, std::vector<uint64_t>> MEdges;
+  /// Device slices of the commands which are complete
+  std::unordered_map<uint64_t, device_slice> MSlices;
+  size_t MNextFlowID = 1;
+};
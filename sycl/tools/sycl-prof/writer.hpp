@@ -8,9 +8,22 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
 #include <fstream>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <string>
 #include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 class Writer {
 public:
@@ -20,6 +33,22 @@ public:
                           size_t PID, size_t TID, size_t TimeStamp) = 0;
   virtual void writeEnd(std::string_view Name, std::string_view Category,
                         size_t PID, size_t TID, size_t TimeStamp) = 0;
+
+  // The records of the kernel timeline, which only the JSON output has.
+  virtual void writeProcessName(size_t /*PID*/, std::string_view /*Name*/) {}
+  virtual void writeProcessSortIndex(size_t /*PID*/, size_t /*Index*/) {}
+  virtual void writeThreadName(size_t /*PID*/, size_t /*TID*/,
+                               std::string_view /*Name*/) {}
+  virtual void writeComplete(std::string_view /*Name*/,
+                             std::string_view /*Category*/, size_t /*PID*/,
+                             size_t /*TID*/, size_t /*Begin*/,
+                             size_t /*End*/) {}
+  /// Writes the start or the end of the flow ID, which is drawn as an arrow
+  /// between the slices enclosing the two time stamps.
+  virtual void writeFlow(size_t /*ID*/, bool /*IsStart*/,
+                         std::string_view /*Category*/, size_t /*PID*/,
+                         size_t /*TID*/, size_t /*TimeStamp*/) {}
+
   virtual ~Writer() = default;
 };
 
@@ -47,7 +76,7 @@ public:
     MOutFile << "\"pid\": \"" << PID << "\", ";
     MOutFile << "\"tid\": \"" << TID << "\", ";
     MOutFile << "\"ts\": \"" << TimeStamp << "\"},";
-    MOutFile << std::endl;
+    MOutFile << "\n";
   }
 
   void writeEnd(std::string_view Name, std::string_view Category, size_t PID,
@@ -63,7 +92,62 @@ public:
     MOutFile << "\"pid\": \"" << PID << "\", ";
     MOutFile << "\"tid\": \"" << TID << "\", ";
     MOutFile << "\"ts\": \"" << TimeStamp << "\"},";
-    MOutFile << std::endl;
+    MOutFile << "\n";
+  }
+
+  void writeProcessName(size_t PID, std::string_view Name) override {
+    writeMetadata("process_name", PID, std::nullopt,
+                  "\"name\": \"" + std::string(Name) + "\"");
+  }
+
+  void writeProcessSortIndex(size_t PID, size_t Index) override {
+    writeMetadata("process_sort_index", PID, std::nullopt,
+                  "\"sort_index\": " + std::to_string(Index));
+  }
+
+  void writeThreadName(size_t PID, size_t TID,
+                       std::string_view Name) override {
+    writeMetadata("thread_name", PID, TID,
+                  "\"name\": \"" + std::string(Name) + "\"");
+  }
+
+  void writeComplete(std::string_view Name, std::string_view Category,
+                     size_t PID, size_t TID, size_t Begin,
+                     size_t End) override {
+    std::lock_guard<std::mutex> _{MWriteMutex};
+
+    if (!MOutFile.is_open())
+      return;
+
+    MOutFile << "{\"name\": \"" << Name << "\", ";
+    MOutFile << "\"cat\": \"" << Category << "\", ";
+    MOutFile << "\"ph\": \"X\", ";
+    MOutFile << "\"pid\": \"" << PID << "\", ";
+    MOutFile << "\"tid\": \"" << TID << "\", ";
+    MOutFile << "\"ts\": \"" << Begin << "\", ";
+    MOutFile << "\"dur\": \"" << End - Begin << "\"},";
+    MOutFile << "\n";
+  }
+
+  void writeFlow(size_t ID, bool IsStart, std::string_view Category,
+                 size_t PID, size_t TID, size_t TimeStamp) override {
+    std::lock_guard<std::mutex> _{MWriteMutex};
+
+    if (!MOutFile.is_open())
+      return;
+
+    MOutFile << "{\"name\": \"" << Category << "\", ";
+    MOutFile << "\"cat\": \"" << Category << "\", ";
+    // The end binds to the slice enclosing it rather than to the next one.
+    if (IsStart)
+      MOutFile << "\"ph\": \"s\", ";
+    else
+      MOutFile << "\"ph\": \"f\", \"bp\": \"e\", ";
+    MOutFile << "\"id\": \"" << ID << "\", ";
+    MOutFile << "\"pid\": \"" << PID << "\", ";
+    MOutFile << "\"tid\": \"" << TID << "\", ";
+    MOutFile << "\"ts\": \"" << TimeStamp << "\"},";
+    MOutFile << "\n";
   }
 
   void finalize() final {
@@ -84,6 +168,319 @@ public:
   ~JSONWriter() { finalize(); }
 
 private:
+  void writeMetadata(std::string_view Name, size_t PID,
+                     std::optional<size_t> TID, const std::string &Args) {
+    std::lock_guard<std::mutex> _{MWriteMutex};
+
+    if (!MOutFile.is_open())
+      return;
+
+    MOutFile << "{\"name\": \"" << Name << "\", ";
+    MOutFile << "\"ph\": \"M\", ";
+    MOutFile << "\"pid\": \"" << PID << "\", ";
+    if (TID)
+      MOutFile << "\"tid\": \"" << *TID << "\", ";
+    MOutFile << "\"args\": {" << Args << "}},";
+    MOutFile << "\n";
+  }
+
   std::mutex MWriteMutex;
   std::ofstream MOutFile;
 };
+
+/// Layout of the binary traces. A trace starts with a header made of Magic
+/// and Version, followed by chunks of records of one thread each. A chunk has
+/// the header below, followed by Size bytes of records. The records start
+/// with a RecordKind byte: string records hold a 32-bit id and size followed
+/// by the characters, begin and end records hold the 32-bit ids of their name
+/// and category followed by a 64-bit time stamp. The string ids are local to
+/// the buffer the chunk comes from. All the values are in the byte order of
+/// the traced machine.
+namespace binary_trace {
+constexpr char Magic[8] = {'S', 'Y', 'C', 'L', 'P', 'R', 'O', 'F'};
+constexpr uint32_t Version = 1;
+
+enum RecordKind : uint8_t { String = 0, Begin = 1, End = 2 };
+
+struct ChunkHeader {
+  uint64_t PID;
+  uint64_t TID;
+  uint32_t Buffer;
+  uint32_t Size;
+};
+} // namespace binary_trace
+
+/// Writes the events into per-thread ring buffers, which a background
+/// thread drains into a binary trace. Writing an event takes no lock: the
+/// buffer of a thread has a single producer, its thread, and a single
+/// consumer, the drain thread. The names are sent once per thread and then
+/// referred to by id. The traces are converted to JSON with
+/// sycl-prof -convert.
+class BinaryWriter : public Writer {
+public:
+  /// Size of the ring buffer of each thread, a power of two.
+  static constexpr size_t BufferSize = 1 << 20;
+  /// Longest string sent, so that any record fits in the buffers.
+  static constexpr size_t MaxStringSize = 4096;
+  /// Period at which the buffers are drained.
+  static constexpr std::chrono::milliseconds DrainPeriod{10};
+
+  explicit BinaryWriter(const std::string &OutPath)
+      : MOutFile(OutPath, std::ios::binary) {}
+
+  void init() final {
+    if (!MOutFile.is_open())
+      return;
+    MOutFile.write(binary_trace::Magic, sizeof(binary_trace::Magic));
+    MOutFile.write(reinterpret_cast<const char *>(&binary_trace::Version),
+                   sizeof(binary_trace::Version));
+    MRunning.store(true);
+    MDrainThread = std::thread([this] { drainLoop(); });
+  }
+
+  void writeBegin(std::string_view Name, std::string_view Category, size_t PID,
+                  size_t TID, size_t TimeStamp) override {
+    write(binary_trace::Begin, Name, Category, PID, TID, TimeStamp);
+  }
+
+  void writeEnd(std::string_view Name, std::string_view Category, size_t PID,
+                size_t TID, size_t TimeStamp) override {
+    write(binary_trace::End, Name, Category, PID, TID, TimeStamp);
+  }
+
+  void finalize() final {
+    if (!MRunning.exchange(false))
+      return;
+    MDrainCV.notify_one();
+    MDrainThread.join();
+    drain();
+    MOutFile.close();
+  }
+
+  ~BinaryWriter() { finalize(); }
+
+private:
+  struct ThreadBuffer {
+    uint64_t PID = 0;
+    uint64_t TID = 0;
+    uint32_t Index = 0;
+    std::unique_ptr<char[]> Data{new char[BufferSize]};
+    /// Bytes ever written by the thread and drained by the drain thread.
+    std::atomic<size_t> Head{0};
+    std::atomic<size_t> Tail{0};
+    /// Set when the thread exits, after which the buffer is dropped once
+    /// drained.
+    std::atomic<bool> Retired{false};
+    /// Ids of the strings sent by the thread, pointing into Strings.
+    std::unordered_map<std::string_view, uint32_t> StringIds;
+    std::deque<std::string> Strings;
+  };
+
+  /// Retires the buffer of a thread when it exits.
+  struct ThreadHandle {
+    const BinaryWriter *Writer = nullptr;
+    std::shared_ptr<ThreadBuffer> Buffer;
+    ~ThreadHandle() {
+      if (Buffer)
+        Buffer->Retired.store(true, std::memory_order_release);
+    }
+  };
+
+  ThreadBuffer &getThreadBuffer(size_t PID, size_t TID) {
+    static thread_local ThreadHandle Handle;
+    if (Handle.Writer != this) {
+      if (Handle.Buffer)
+        Handle.Buffer->Retired.store(true, std::memory_order_release);
+      auto Buffer = std::make_shared<ThreadBuffer>();
+      Buffer->PID = PID;
+      Buffer->TID = TID;
+      std::lock_guard<std::mutex> _{MBuffersMutex};
+      Buffer->Index = MNextBufferIndex++;
+      MBuffers.push_back(Buffer);
+      Handle.Writer = this;
+      Handle.Buffer = std::move(Buffer);
+    }
+    return *Handle.Buffer;
+  }
+
+  /// Copies a record into the ring buffer, waiting for the drain thread to
+  /// make room if it is full. The records are published whole, so that the
+  /// chunks never split them.
+  void push(ThreadBuffer &Buffer, const void *Src, size_t Size) {
+    size_t Head = Buffer.Head.load(std::memory_order_relaxed);
+    while (Head + Size - Buffer.Tail.load(std::memory_order_acquire) >
+           BufferSize) {
+      // The records written while the trace is finalized are dropped.
+      if (!MRunning.load(std::memory_order_relaxed))
+        return;
+      MDrainCV.notify_one();
+      std::this_thread::yield();
+    }
+    const char *Bytes = static_cast<const char *>(Src);
+    size_t Offset = Head & (BufferSize - 1);
+    size_t First = std::min(Size, BufferSize - Offset);
+    std::memcpy(Buffer.Data.get() + Offset, Bytes, First);
+    std::memcpy(Buffer.Data.get(), Bytes + First, Size - First);
+    Buffer.Head.store(Head + Size, std::memory_order_release);
+  }
+
+  uint32_t getStringId(ThreadBuffer &Buffer, std::string_view String) {
+    auto It = Buffer.StringIds.find(String);
+    if (It != Buffer.StringIds.end())
+      return It->second;
+
+    uint32_t Id = static_cast<uint32_t>(Buffer.Strings.size());
+    const std::string &Stored = Buffer.Strings.emplace_back(String);
+    Buffer.StringIds.emplace(Stored, Id);
+    uint32_t Size =
+        static_cast<uint32_t>(std::min(String.size(), MaxStringSize));
+    std::string Record(1 + 2 * sizeof(uint32_t), binary_trace::String);
+    std::memcpy(&Record[1], &Id, sizeof(Id));
+    std::memcpy(&Record[1 + sizeof(Id)], &Size, sizeof(Size));
+    Record.append(Stored.data(), Size);
+    push(Buffer, Record.data(), Record.size());
+    return Id;
+  }
+
+  void write(binary_trace::RecordKind Kind, std::string_view Name,
+             std::string_view Category, size_t PID, size_t TID,
+             size_t TimeStamp) {
+    if (!MRunning.load(std::memory_order_relaxed))
+      return;
+
+    ThreadBuffer &Buffer = getThreadBuffer(PID, TID);
+    uint32_t NameId = getStringId(Buffer, Name);
+    uint32_t CategoryId = getStringId(Buffer, Category);
+    uint64_t TS = TimeStamp;
+    char Record[1 + 2 * sizeof(uint32_t) + sizeof(uint64_t)];
+    Record[0] = Kind;
+    std::memcpy(Record + 1, &NameId, sizeof(NameId));
+    std::memcpy(Record + 1 + sizeof(NameId), &CategoryId, sizeof(CategoryId));
+    std::memcpy(Record + 1 + 2 * sizeof(uint32_t), &TS, sizeof(TS));
+    push(Buffer, Record, sizeof(Record));
+  }
+
+  /// Writes the pending records of all the buffers to the trace.
+  void drain() {
+    std::vector<std::shared_ptr<ThreadBuffer>> Buffers;
+    {
+      std::lock_guard<std::mutex> _{MBuffersMutex};
+      Buffers = MBuffers;
+    }
+
+    std::vector<const ThreadBuffer *> Drained;
+    for (const std::shared_ptr<ThreadBuffer> &Buffer : Buffers) {
+      // Read Retired first, so that no record is written after the last
+      // drain of a retired buffer.
+      bool Retired = Buffer->Retired.load(std::memory_order_acquire);
+      size_t Tail = Buffer->Tail.load(std::memory_order_relaxed);
+      size_t Head = Buffer->Head.load(std::memory_order_acquire);
+      if (Head != Tail) {
+        binary_trace::ChunkHeader Header{Buffer->PID, Buffer->TID,
+                                         Buffer->Index,
+                                         static_cast<uint32_t>(Head - Tail)};
+        MOutFile.write(reinterpret_cast<const char *>(&Header),
+                       sizeof(Header));
+        size_t Offset = Tail & (BufferSize - 1);
+        size_t First = std::min(Head - Tail, BufferSize - Offset);
+        MOutFile.write(Buffer->Data.get() + Offset, First);
+        MOutFile.write(Buffer->Data.get(), Head - Tail - First);
+        Buffer->Tail.store(Head, std::memory_order_release);
+      }
+      if (Retired)
+        Drained.push_back(Buffer.get());
+    }
+
+    if (Drained.empty())
+      return;
+    std::lock_guard<std::mutex> _{MBuffersMutex};
+    for (const ThreadBuffer *Buffer : Drained)
+      for (auto It = MBuffers.begin(); It != MBuffers.end(); ++It)
+        if (It->get() == Buffer) {
+          MBuffers.erase(It);
+          break;
+        }
+  }
+
+  void drainLoop() {
+    std::unique_lock<std::mutex> Lock{MDrainMutex};
+    while (MRunning.load()) {
+      MDrainCV.wait_for(Lock, DrainPeriod);
+      drain();
+    }
+  }
+
+  std::ofstream MOutFile;
+  std::atomic<bool> MRunning{false};
+  std::thread MDrainThread;
+  std::mutex MDrainMutex;
+  std::condition_variable MDrainCV;
+  std::mutex MBuffersMutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> MBuffers;
+  uint32_t MNextBufferIndex = 0;
+};
+
+/// Converts a binary trace written by BinaryWriter with Out.
+/// \return false if the trace cannot be read.
+inline bool convertBinaryTrace(const std::string &InPath, Writer &Out) {
+  std::ifstream InFile(InPath, std::ios::binary);
+  char Magic[sizeof(binary_trace::Magic)];
+  uint32_t Version = 0;
+  if (!InFile.read(Magic, sizeof(Magic)) ||
+      std::memcmp(Magic, binary_trace::Magic, sizeof(Magic)) != 0 ||
+      !InFile.read(reinterpret_cast<char *>(&Version), sizeof(Version)) ||
+      Version != binary_trace::Version)
+    return false;
+
+  Out.init();
+  std::unordered_map<uint32_t, std::vector<std::string>> Strings;
+  std::vector<char> Chunk;
+  binary_trace::ChunkHeader Header;
+  while (InFile.read(reinterpret_cast<char *>(&Header), sizeof(Header))) {
+    Chunk.resize(Header.Size);
+    if (!InFile.read(Chunk.data(), Header.Size))
+      return false;
+
+    std::vector<std::string> &BufferStrings = Strings[Header.Buffer];
+    auto GetString = [&](uint32_t Id) -> std::string_view {
+      return Id < BufferStrings.size() ? std::string_view{BufferStrings[Id]}
+                                       : std::string_view{"unknown"};
+    };
+    const char *Ptr = Chunk.data();
+    const char *End = Ptr + Chunk.size();
+    while (Ptr < End) {
+      uint8_t Kind = *Ptr++;
+      uint32_t Ids[2];
+      if (End - Ptr < static_cast<ptrdiff_t>(sizeof(Ids)))
+        return false;
+      std::memcpy(Ids, Ptr, sizeof(Ids));
+      Ptr += sizeof(Ids);
+
+      if (Kind == binary_trace::String) {
+        if (static_cast<size_t>(End - Ptr) < Ids[1])
+          return false;
+        if (BufferStrings.size() <= Ids[0])
+          BufferStrings.resize(Ids[0] + 1);
+        BufferStrings[Ids[0]].assign(Ptr, Ids[1]);
+        Ptr += Ids[1];
+        continue;
+      }
+
+      uint64_t TS = 0;
+      if (End - Ptr < static_cast<ptrdiff_t>(sizeof(TS)))
+        return false;
+      std::memcpy(&TS, Ptr, sizeof(TS));
+      Ptr += sizeof(TS);
+      if (Kind == binary_trace::Begin)
+        Out.writeBegin(GetString(Ids[0]), GetString(Ids[1]), Header.PID,
+                       Header.TID, TS);
+      else if (Kind == binary_trace::End)
+        Out.writeEnd(GetString(Ids[0]), GetString(Ids[1]), Header.PID,
+                     Header.TID, TS);
+      else
+        return false;
+    }
+  }
+  Out.finalize();
+  return true;
+}
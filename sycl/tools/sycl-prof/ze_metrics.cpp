@@ -0,0 +1,276 @@
+//==----------------- ze_metrics.cpp ---------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+/// \file ze_metrics.cpp
+/// Metric source of the Level Zero devices, sampling a metric group with a
+/// metric streamer. The metric API of the driver is only available when
+/// ZET_ENABLE_METRICS=1 is set, which sycl-prof does with -metrics.
+
+#include "metric_source.hpp"
+
+#include <zet_api.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define COLLECTOR_EXPORT_API __attribute__((__visibility__("default")))
+
+namespace {
+constexpr const char *DefaultGroup = "ComputeBasic";
+/// The metrics of the group which are summed for the bytes and the FLOPs,
+/// or averaged for the occupancy, when SYCL_PROF_ZE_METRICS does not name
+/// them. The names differ between the GPU generations, those found in the
+/// group are used.
+const char *const DefaultBytes[] = {"GPU_MEMORY_BYTE_READ",
+                                    "GPU_MEMORY_BYTE_WRITE",
+                                    "GpuMemoryBytesRead",
+                                    "GpuMemoryBytesWritten"};
+const char *const DefaultOccupancy[] = {"XVE_THREADS_OCCUPANCY_ALL",
+                                        "EuThreadOccupancy"};
+constexpr uint32_t DefaultSamplingPeriodNs = 10000;
+
+double toDouble(const zet_typed_value_t &Value) {
+  switch (Value.type) {
+  case ZET_VALUE_TYPE_UINT32:
+    return Value.value.ui32;
+  case ZET_VALUE_TYPE_UINT64:
+    return static_cast<double>(Value.value.ui64);
+  case ZET_VALUE_TYPE_FLOAT32:
+    return Value.value.fp32;
+  case ZET_VALUE_TYPE_FLOAT64:
+    return Value.value.fp64;
+  case ZET_VALUE_TYPE_BOOL8:
+    return Value.value.b8;
+  default:
+    return 0;
+  }
+}
+
+class ZeMetricSource final : public MetricSource {
+public:
+  ZeMetricSource(zet_context_handle_t Context, zet_device_handle_t Device)
+      : MContext(Context), MDevice(Device) {}
+
+  ~ZeMetricSource() override {
+    if (MStreamer)
+      zetMetricStreamerClose(MStreamer);
+    if (MActivated)
+      zetContextActivateMetricGroups(MContext, MDevice, 0, nullptr);
+  }
+
+  bool init() {
+    const char *GroupName = std::getenv("SYCL_PROF_ZE_METRIC_GROUP");
+    if (!GroupName)
+      GroupName = DefaultGroup;
+    if (!findGroup(GroupName)) {
+      std::cerr << "sycl-prof: no time based metric group " << GroupName
+                << ", is ZET_ENABLE_METRICS=1 set?\n";
+      return false;
+    }
+    if (!findMetrics())
+      return false;
+
+    MActivated = zetContextActivateMetricGroups(MContext, MDevice, 1,
+                                                &MGroup) == ZE_RESULT_SUCCESS;
+    zet_metric_streamer_desc_t Desc = {};
+    Desc.stype = ZET_STRUCTURE_TYPE_METRIC_STREAMER_DESC;
+    Desc.notifyEveryNReports = 32768;
+    Desc.samplingPeriod = MSamplingPeriodNs;
+    if (const char *Period = std::getenv("SYCL_PROF_ZE_SAMPLING_NS"))
+      Desc.samplingPeriod = MSamplingPeriodNs = static_cast<uint32_t>(
+          std::max<unsigned long>(1, std::strtoul(Period, nullptr, 10)));
+    if (!MActivated ||
+        zetMetricStreamerOpen(MContext, MDevice, MGroup, &Desc, nullptr,
+                              &MStreamer) != ZE_RESULT_SUCCESS) {
+      std::cerr << "sycl-prof: cannot open a metric streamer of the device\n";
+      return false;
+    }
+    return true;
+  }
+
+  bool start(const std::string &) override {
+    // The reports of the time before the launch are dropped.
+    std::vector<uint8_t> Data;
+    return read(Data);
+  }
+
+  bool stop(const std::string &, uint64_t DurationNs,
+            kernel_counters &Counters) override {
+    // The last report covering the kernel is written at the end of its
+    // sampling period.
+    std::this_thread::sleep_for(
+        std::chrono::nanoseconds(2 * MSamplingPeriodNs));
+    std::vector<uint8_t> Data;
+    uint32_t Count = 0;
+    if (!read(Data) || DurationNs == 0 ||
+        zetMetricGroupCalculateMetricValues(
+            MGroup, ZET_METRIC_GROUP_CALCULATION_TYPE_METRIC_VALUES,
+            Data.size(), Data.data(), &Count, nullptr) != ZE_RESULT_SUCCESS)
+      return false;
+    std::vector<zet_typed_value_t> Values(Count);
+    if (Count == 0 ||
+        zetMetricGroupCalculateMetricValues(
+            MGroup, ZET_METRIC_GROUP_CALCULATION_TYPE_METRIC_VALUES,
+            Data.size(), Data.data(), &Count,
+            Values.data()) != ZE_RESULT_SUCCESS)
+      return false;
+
+    // The counts of the reports add up, the occupancy is averaged over the
+    // reports in which the device was busy.
+    size_t Reports = Count / MNumMetrics;
+    auto Sum = [&](const std::vector<uint32_t> &Metrics) {
+      double Total = 0;
+      for (size_t Report = 0; Report < Reports; ++Report)
+        for (uint32_t Metric : Metrics)
+          Total += toDouble(Values[Report * MNumMetrics + Metric]);
+      return Total;
+    };
+    Counters.MDurationNs = DurationNs;
+    if (!MBytes.empty())
+      Counters.MBytes = Sum(MBytes);
+    if (!MFlops.empty())
+      Counters.MFlops = Sum(MFlops);
+    if (!MOccupancy.empty()) {
+      double Total = 0;
+      size_t Busy = 0;
+      for (size_t Report = 0; Report < Reports; ++Report) {
+        double Value = toDouble(Values[Report * MNumMetrics + MOccupancy[0]]);
+        if (Value > 0) {
+          Total += Value;
+          ++Busy;
+        }
+      }
+      if (Busy)
+        Counters.MOccupancy = Total / Busy / 100;
+    }
+    return true;
+  }
+
+private:
+  bool findGroup(const char *Name) {
+    uint32_t Count = 0;
+    if (zetMetricGroupGet(MDevice, &Count, nullptr) != ZE_RESULT_SUCCESS)
+      return false;
+    std::vector<zet_metric_group_handle_t> Groups(Count);
+    if (zetMetricGroupGet(MDevice, &Count, Groups.data()) != ZE_RESULT_SUCCESS)
+      return false;
+    for (zet_metric_group_handle_t Group : Groups) {
+      zet_metric_group_properties_t Properties = {};
+      Properties.stype = ZET_STRUCTURE_TYPE_METRIC_GROUP_PROPERTIES;
+      if (zetMetricGroupGetProperties(Group, &Properties) ==
+              ZE_RESULT_SUCCESS &&
+          std::strcmp(Properties.name, Name) == 0 &&
+          (Properties.samplingType &
+           ZET_METRIC_GROUP_SAMPLING_TYPE_FLAG_TIME_BASED)) {
+        MGroup = Group;
+        MNumMetrics = Properties.metricCount;
+        return MNumMetrics > 0;
+      }
+    }
+    return false;
+  }
+
+  /// Finds the metrics named by SYCL_PROF_ZE_METRICS, as in
+  /// "bytes=A+B,flops=C,occupancy=D", or the default ones.
+  bool findMetrics() {
+    uint32_t Count = MNumMetrics;
+    std::vector<zet_metric_handle_t> Metrics(Count);
+    if (zetMetricGet(MGroup, &Count, Metrics.data()) != ZE_RESULT_SUCCESS)
+      return false;
+    std::vector<std::string> Names;
+    for (zet_metric_handle_t Metric : Metrics) {
+      zet_metric_properties_t Properties = {};
+      Properties.stype = ZET_STRUCTURE_TYPE_METRIC_PROPERTIES;
+      zetMetricGetProperties(Metric, &Properties);
+      Names.emplace_back(Properties.name);
+    }
+    auto Find = [&](const std::string &Name, std::vector<uint32_t> &Out) {
+      for (uint32_t I = 0; I < Names.size(); ++I)
+        if (Names[I] == Name) {
+          Out.push_back(I);
+          return true;
+        }
+      std::cerr << "sycl-prof: no metric " << Name << " in the group\n";
+      return false;
+    };
+
+    if (const char *Spec = std::getenv("SYCL_PROF_ZE_METRICS")) {
+      std::stringstream Entries(Spec);
+      std::string Entry;
+      while (std::getline(Entries, Entry, ',')) {
+        size_t Equal = Entry.find('=');
+        std::string Kind = Entry.substr(0, Equal);
+        std::vector<uint32_t> *Out = Kind == "bytes"       ? &MBytes
+                                     : Kind == "flops"     ? &MFlops
+                                     : Kind == "occupancy" ? &MOccupancy
+                                                           : nullptr;
+        if (!Out || Equal == std::string::npos) {
+          std::cerr << "sycl-prof: bad SYCL_PROF_ZE_METRICS entry " << Entry
+                    << "\n";
+          return false;
+        }
+        std::stringstream Metrics(Entry.substr(Equal + 1));
+        std::string Metric;
+        while (std::getline(Metrics, Metric, '+'))
+          if (!Find(Metric, *Out))
+            return false;
+      }
+    } else {
+      for (uint32_t I = 0; I < Names.size(); ++I) {
+        for (const char *Name : DefaultBytes)
+          if (Names[I] == Name)
+            MBytes.push_back(I);
+        for (const char *Name : DefaultOccupancy)
+          if (Names[I] == Name && MOccupancy.empty())
+            MOccupancy.push_back(I);
+      }
+    }
+    return true;
+  }
+
+  bool read(std::vector<uint8_t> &Data) {
+    size_t Size = 0;
+    if (zetMetricStreamerReadData(MStreamer, UINT32_MAX, &Size, nullptr) !=
+        ZE_RESULT_SUCCESS)
+      return false;
+    Data.resize(Size);
+    if (Size && zetMetricStreamerReadData(MStreamer, UINT32_MAX, &Size,
+                                          Data.data()) != ZE_RESULT_SUCCESS)
+      return false;
+    Data.resize(Size);
+    return true;
+  }
+
+  zet_context_handle_t MContext;
+  zet_device_handle_t MDevice;
+  zet_metric_group_handle_t MGroup = nullptr;
+  zet_metric_streamer_handle_t MStreamer = nullptr;
+  bool MActivated = false;
+  uint32_t MNumMetrics = 0;
+  uint32_t MSamplingPeriodNs = DefaultSamplingPeriodNs;
+  /// Indices of the metrics in the reports
+  std::vector<uint32_t> MBytes, MFlops, MOccupancy;
+};
+} // namespace
+
+extern "C" COLLECTOR_EXPORT_API MetricSource *
+createMetricSource(pi_native_handle Context, pi_native_handle Device) {
+  auto Source = std::make_unique<ZeMetricSource>(
+      reinterpret_cast<zet_context_handle_t>(Context),
+      reinterpret_cast<zet_device_handle_t>(Device));
+  return Source->init() ? Source.release() : nullptr;
+}
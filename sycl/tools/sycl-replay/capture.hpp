@@ -0,0 +1,233 @@
+//==------------ capture.hpp - SYCL Replay Tool ----------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/// A kernel launch captured by the collector of sycl-replay: the program of
+/// the kernel, its arguments and launch configuration, and the contents of
+/// the memory it uses as they were right before the launch.
+namespace sycl_replay {
+inline constexpr char CaptureMagic[8] = {'S', 'Y', 'C', 'L',
+                                         'R', 'P', 'L', '\0'};
+inline constexpr uint32_t CaptureVersion = 1;
+
+struct spec_constant {
+  uint32_t MID = 0;
+  std::vector<char> MValue;
+};
+
+/// A program created from SPIR-V or from a device binary and built, or made
+/// by linking programs which were compiled.
+struct program {
+  enum kind : uint8_t { IL, Binary, Linked };
+  kind MKind = IL;
+  /// The SPIR-V or the device binary, empty for the linked programs
+  std::vector<char> MImage;
+  /// The build, compile or link options
+  std::string MOptions;
+  std::vector<spec_constant> MSpecConstants;
+  std::vector<program> MInputs;
+};
+
+/// An allocation or a buffer used by the kernel.
+struct memory {
+  enum kind : uint8_t { Host, Device, Shared, Buffer };
+  kind MKind = Device;
+  std::vector<char> MContents;
+};
+
+struct argument {
+  enum kind : uint8_t { Value, Local, Pointer, MemObj };
+  kind MKind = Value;
+  uint32_t MIndex = 0;
+  /// The bytes of the Value arguments
+  std::vector<char> MValue;
+  uint64_t MLocalSize = 0;
+  /// The memory pointed to and the offset of the pointer within it
+  uint32_t MMemory = 0;
+  uint64_t MOffset = 0;
+};
+
+struct capture {
+  /// The pi_platform_backend of the device
+  uint32_t MBackend = 0;
+  std::string MPlatformName;
+  std::string MDeviceName;
+  std::string MKernelName;
+  uint32_t MWorkDim = 1;
+  uint64_t MGlobalOffset[3] = {};
+  uint64_t MGlobalSize[3] = {};
+  /// All zeros if the local size was left to the backend
+  uint64_t MLocalSize[3] = {};
+  program MProgram;
+  std::vector<argument> MArguments;
+  std::vector<memory> MMemory;
+};
+
+namespace detail {
+class output {
+public:
+  explicit output(const std::string &Path)
+      : MOut(Path, std::ios::binary | std::ios::trunc) {}
+
+  template <typename T> void put(const T &Value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    MOut.write(reinterpret_cast<const char *>(&Value), sizeof(T));
+  }
+  void put(const std::vector<char> &Bytes) {
+    put(uint64_t(Bytes.size()));
+    MOut.write(Bytes.data(), Bytes.size());
+  }
+  void put(const std::string &String) {
+    put(uint64_t(String.size()));
+    MOut.write(String.data(), String.size());
+  }
+  void put(const program &Program) {
+    put(Program.MKind);
+    put(Program.MImage);
+    put(Program.MOptions);
+    put(uint32_t(Program.MSpecConstants.size()));
+    for (const spec_constant &Constant : Program.MSpecConstants) {
+      put(Constant.MID);
+      put(Constant.MValue);
+    }
+    put(uint32_t(Program.MInputs.size()));
+    for (const program &Input : Program.MInputs)
+      put(Input);
+  }
+
+  bool good() { return MOut.flush().good(); }
+
+private:
+  std::ofstream MOut;
+};
+
+class input {
+public:
+  explicit input(const std::string &Path) : MIn(Path, std::ios::binary) {}
+
+  template <typename T> bool get(T &Value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return bool(MIn.read(reinterpret_cast<char *>(&Value), sizeof(T)));
+  }
+  template <typename T> bool getSized(T &Bytes) {
+    uint64_t Size = 0;
+    if (!get(Size) || Size > Remaining())
+      return false;
+    Bytes.resize(Size);
+    return bool(MIn.read(Bytes.data(), Size));
+  }
+  bool get(std::vector<char> &Bytes) { return getSized(Bytes); }
+  bool get(std::string &String) { return getSized(String); }
+  bool get(program &Program, unsigned Depth = 0) {
+    uint32_t NumConstants = 0, NumInputs = 0;
+    if (Depth > 1 || !get(Program.MKind) || Program.MKind > program::Linked ||
+        !get(Program.MImage) || !get(Program.MOptions) ||
+        !get(NumConstants) || NumConstants > Remaining())
+      return false;
+    Program.MSpecConstants.resize(NumConstants);
+    for (spec_constant &Constant : Program.MSpecConstants)
+      if (!get(Constant.MID) || !get(Constant.MValue))
+        return false;
+    if (!get(NumInputs) || NumInputs > Remaining())
+      return false;
+    Program.MInputs.resize(NumInputs);
+    for (program &Input : Program.MInputs)
+      if (!get(Input, Depth + 1))
+        return false;
+    return true;
+  }
+
+private:
+  /// Bounds the sizes read from a damaged file.
+  uint64_t Remaining() {
+    std::streampos Position = MIn.tellg();
+    MIn.seekg(0, std::ios::end);
+    std::streampos End = MIn.tellg();
+    MIn.seekg(Position);
+    return Position < 0 || End < Position ? 0 : uint64_t(End - Position);
+  }
+
+  std::ifstream MIn;
+};
+} // namespace detail
+
+inline bool write(const capture &Capture, const std::string &Path) {
+  detail::output Out(Path);
+  Out.put(CaptureMagic);
+  Out.put(CaptureVersion);
+  Out.put(Capture.MBackend);
+  Out.put(Capture.MPlatformName);
+  Out.put(Capture.MDeviceName);
+  Out.put(Capture.MKernelName);
+  Out.put(Capture.MWorkDim);
+  Out.put(Capture.MGlobalOffset);
+  Out.put(Capture.MGlobalSize);
+  Out.put(Capture.MLocalSize);
+  Out.put(Capture.MProgram);
+  Out.put(uint32_t(Capture.MArguments.size()));
+  for (const argument &Arg : Capture.MArguments) {
+    Out.put(Arg.MKind);
+    Out.put(Arg.MIndex);
+    Out.put(Arg.MValue);
+    Out.put(Arg.MLocalSize);
+    Out.put(Arg.MMemory);
+    Out.put(Arg.MOffset);
+  }
+  Out.put(uint32_t(Capture.MMemory.size()));
+  for (const memory &Memory : Capture.MMemory) {
+    Out.put(Memory.MKind);
+    Out.put(Memory.MContents);
+  }
+  return Out.good();
+}
+
+/// @returns false if the file cannot be read or is not a valid capture.
+inline bool read(capture &Capture, const std::string &Path) {
+  detail::input In(Path);
+  char Magic[sizeof(CaptureMagic)];
+  uint32_t Version = 0, NumArguments = 0, NumMemory = 0;
+  if (!In.get(Magic) || std::memcmp(Magic, CaptureMagic, sizeof(Magic)) ||
+      !In.get(Version) || Version != CaptureVersion ||
+      !In.get(Capture.MBackend) || !In.get(Capture.MPlatformName) ||
+      !In.get(Capture.MDeviceName) || !In.get(Capture.MKernelName) ||
+      !In.get(Capture.MWorkDim) || Capture.MWorkDim < 1 ||
+      Capture.MWorkDim > 3 || !In.get(Capture.MGlobalOffset) ||
+      !In.get(Capture.MGlobalSize) || !In.get(Capture.MLocalSize) ||
+      !In.get(Capture.MProgram) || !In.get(NumArguments))
+    return false;
+  for (uint32_t I = 0; I < NumArguments; ++I) {
+    argument &Arg = Capture.MArguments.emplace_back();
+    if (!In.get(Arg.MKind) || Arg.MKind > argument::MemObj ||
+        !In.get(Arg.MIndex) || !In.get(Arg.MValue) ||
+        !In.get(Arg.MLocalSize) || !In.get(Arg.MMemory) ||
+        !In.get(Arg.MOffset))
+      return false;
+  }
+  if (!In.get(NumMemory))
+    return false;
+  for (uint32_t I = 0; I < NumMemory; ++I) {
+    memory &Memory = Capture.MMemory.emplace_back();
+    if (!In.get(Memory.MKind) || Memory.MKind > memory::Buffer ||
+        !In.get(Memory.MContents))
+      return false;
+  }
+  for (const argument &Arg : Capture.MArguments)
+    if ((Arg.MKind == argument::Pointer || Arg.MKind == argument::MemObj) &&
+        Arg.MMemory >= Capture.MMemory.size())
+      return false;
+  return true;
+}
+} // namespace sycl_replay
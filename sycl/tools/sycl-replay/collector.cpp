@@ -0,0 +1,573 @@
+//==-------------- collector.cpp - SYCL Replay Tool ------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+/// Captures a kernel launch of the application for sycl-replay.
+///
+/// The programs, kernels, kernel arguments and memory allocations are
+/// followed on the sycl.pi.debug stream. When the selected launch is about to
+/// be enqueued, the collector waits for the queue to be idle, reads the
+/// memory used by the kernel and writes the capture.
+
+#include "capture.hpp"
+#include "pi_arguments_handler.hpp"
+
+#include <sycl/detail/pi.h>
+#include <xpti/xpti_trace_framework.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace sycl_replay;
+
+namespace {
+struct argument_state {
+  argument::kind MKind = argument::Value;
+  std::vector<char> MValue;
+  size_t MLocalSize = 0;
+  const void *MPointer = nullptr;
+  pi_mem MMem = nullptr;
+  /// Set for the arguments which cannot be captured, such as the samplers
+  bool MUnsupported = false;
+};
+
+struct kernel_state {
+  std::shared_ptr<program> MProgram;
+  std::string MName;
+  std::map<uint32_t, argument_state> MArguments;
+};
+
+struct allocation {
+  size_t MSize;
+  memory::kind MKind;
+};
+
+class Capturer {
+public:
+  Capturer(std::string KernelName, size_t Launch, std::string OutFile)
+      : MKernelName(std::move(KernelName)), MLaunch(Launch),
+        MOutFile(std::move(OutFile)) {
+    registerHandlers();
+  }
+
+  void handle(uint16_t TraceType, const xpti::function_with_args_t *Data) {
+    std::optional<pi_result> Result;
+    if (TraceType == xpti::trace_function_with_args_end)
+      Result = *static_cast<pi_result *>(Data->ret_data);
+    std::unique_lock<std::mutex> Lock(MMutex);
+    if (MDone)
+      return;
+    MArgHandler.handle(Data->function_id,
+                       *static_cast<const pi_plugin *>(Data->user_data), Result,
+                       Data->args_data);
+    if (!MPending)
+      return;
+    // The state is no longer changed once MDone is set, and the other threads
+    // may be needed to complete the dependencies of the launch.
+    Lock.unlock();
+    finishCapture();
+  }
+
+private:
+  void registerHandlers();
+  void addProgram(pi_program Program, program Record) {
+    MPrograms[Program] = std::make_shared<program>(std::move(Record));
+  }
+  argument_state *getArgument(pi_kernel Kernel, uint32_t Index) {
+    auto It = MKernels.find(Kernel);
+    if (It == MKernels.end())
+      return nullptr;
+    argument_state &Arg = It->second.MArguments[Index];
+    Arg = argument_state{};
+    return &Arg;
+  }
+  void launched(const pi_plugin &Plugin, pi_queue Queue, pi_kernel Kernel,
+                pi_uint32 WorkDim, const size_t *GlobalOffset,
+                const size_t *GlobalSize, const size_t *LocalSize,
+                pi_uint32 NumEvents, const pi_event *WaitList);
+  void finishCapture();
+  bool readLaunch(const pi_plugin::FunctionPointers &Plugin, pi_queue Queue,
+                  const kernel_state &Kernel, sycl_replay::capture &Out);
+  /// @returns the index of the memory of the capture holding the USM
+  /// allocation Ptr points into, with the offset of Ptr within it.
+  std::optional<uint32_t> addAllocation(
+      const pi_plugin::FunctionPointers &Plugin, pi_queue Queue,
+      const void *Ptr, uint64_t &Offset, sycl_replay::capture &Out);
+  std::optional<uint32_t> addBuffer(const pi_plugin::FunctionPointers &Plugin,
+                                    pi_queue Queue, pi_mem Mem,
+                                    sycl_replay::capture &Out);
+
+  std::string MKernelName;
+  size_t MLaunch;
+  std::string MOutFile;
+  size_t MMatchingLaunches = 0;
+  bool MDone = false;
+  /// The selected launch, which is read once the lock is released
+  struct pending_launch {
+    const pi_plugin::FunctionPointers *MPlugin;
+    pi_queue MQueue;
+    const kernel_state *MKernel;
+    std::vector<pi_event> MWaitList;
+    sycl_replay::capture MCapture;
+  };
+  std::optional<pending_launch> MPending;
+  std::mutex MMutex;
+  sycl::xpti_helpers::PiArgumentsHandler MArgHandler;
+  std::unordered_map<pi_program, std::shared_ptr<program>> MPrograms;
+  std::unordered_map<pi_kernel, kernel_state> MKernels;
+  /// The USM allocations by address, to find the one a pointer points into
+  std::map<uintptr_t, allocation> MAllocations;
+  std::unordered_map<pi_mem, size_t> MBuffers;
+  /// The memory of the capture being made, by allocation or buffer
+  std::unordered_map<const void *, uint32_t> MCaptured;
+};
+
+void Capturer::registerHandlers() {
+  MArgHandler.set_piProgramCreate(
+      [this](const pi_plugin &, std::optional<pi_result> Result, pi_context,
+             const void *IL, size_t Length, pi_program *Program) {
+        if (Result != PI_SUCCESS)
+          return;
+        const char *Bytes = static_cast<const char *>(IL);
+        addProgram(*Program, program{program::IL,
+                                     std::vector<char>(Bytes, Bytes + Length)});
+      });
+  MArgHandler.set_piProgramCreateWithBinary(
+      [this](const pi_plugin &, std::optional<pi_result> Result, pi_context,
+             pi_uint32 NumDevices, const pi_device *, const size_t *Lengths,
+             const unsigned char **Binaries, size_t,
+             const pi_device_binary_property *, pi_int32 *,
+             pi_program *Program) {
+        if (Result != PI_SUCCESS || !NumDevices)
+          return;
+        const char *Bytes = reinterpret_cast<const char *>(Binaries[0]);
+        addProgram(*Program,
+                   program{program::Binary,
+                           std::vector<char>(Bytes, Bytes + Lengths[0])});
+      });
+  MArgHandler.set_piextProgramSetSpecializationConstant(
+      [this](const pi_plugin &, std::optional<pi_result> Result,
+             pi_program Program, pi_uint32 ID, size_t Size,
+             const void *Value) {
+        auto It = MPrograms.find(Program);
+        if (Result != PI_SUCCESS || It == MPrograms.end())
+          return;
+        const char *Bytes = static_cast<const char *>(Value);
+        It->second->MSpecConstants.push_back(
+            spec_constant{ID, std::vector<char>(Bytes, Bytes + Size)});
+      });
+  auto SetOptions = [this](pi_program Program, const char *Options) {
+    auto It = MPrograms.find(Program);
+    if (It != MPrograms.end())
+      It->second->MOptions = Options ? Options : "";
+  };
+  MArgHandler.set_piProgramBuild(
+      [SetOptions](const pi_plugin &, std::optional<pi_result> Result,
+                   pi_program Program, pi_uint32, const pi_device *,
+                   const char *Options, void (*)(pi_program, void *), void *) {
+        if (Result == PI_SUCCESS)
+          SetOptions(Program, Options);
+      });
+  MArgHandler.set_piProgramCompile(
+      [SetOptions](const pi_plugin &, std::optional<pi_result> Result,
+                   pi_program Program, pi_uint32, const pi_device *,
+                   const char *Options, pi_uint32, const pi_program *,
+                   const char **, void (*)(pi_program, void *), void *) {
+        if (Result == PI_SUCCESS)
+          SetOptions(Program, Options);
+      });
+  MArgHandler.set_piProgramLink(
+      [this](const pi_plugin &, std::optional<pi_result> Result, pi_context,
+             pi_uint32, const pi_device *, const char *Options,
+             pi_uint32 NumInputs, const pi_program *Inputs,
+             void (*)(pi_program, void *), void *, pi_program *Program) {
+        if (Result != PI_SUCCESS)
+          return;
+        program Linked{program::Linked, {}, Options ? Options : ""};
+        for (pi_uint32 I = 0; I < NumInputs; ++I) {
+          auto It = MPrograms.find(Inputs[I]);
+          if (It == MPrograms.end())
+            return;
+          Linked.MInputs.push_back(*It->second);
+        }
+        addProgram(*Program, std::move(Linked));
+      });
+  MArgHandler.set_piKernelCreate(
+      [this](const pi_plugin &, std::optional<pi_result> Result,
+             pi_program Program, const char *Name, pi_kernel *Kernel) {
+        if (Result != PI_SUCCESS)
+          return;
+        auto It = MPrograms.find(Program);
+        MKernels[*Kernel] = kernel_state{
+            It == MPrograms.end() ? nullptr : It->second, Name, {}};
+      });
+
+  auto SetArg = [this](std::optional<pi_result> Result, pi_kernel Kernel,
+                       pi_uint32 Index, size_t Size, const void *Value) {
+    argument_state *Arg = Result == PI_SUCCESS ? getArgument(Kernel, Index)
+                                               : nullptr;
+    if (!Arg)
+      return;
+    if (!Value) {
+      Arg->MKind = argument::Local;
+      Arg->MLocalSize = Size;
+      return;
+    }
+    // The OpenCL plugin takes the buffers as plain arguments.
+    if (Size == sizeof(pi_mem) &&
+        MBuffers.count(*static_cast<const pi_mem *>(Value))) {
+      Arg->MKind = argument::MemObj;
+      Arg->MMem = *static_cast<const pi_mem *>(Value);
+      return;
+    }
+    const char *Bytes = static_cast<const char *>(Value);
+    Arg->MValue.assign(Bytes, Bytes + Size);
+  };
+  auto SetArgPointer = [this](std::optional<pi_result> Result,
+                              pi_kernel Kernel, pi_uint32 Index, size_t Size,
+                              const void *Value) {
+    argument_state *Arg =
+        Result == PI_SUCCESS ? getArgument(Kernel, Index) : nullptr;
+    if (!Arg)
+      return;
+    const void *Ptr =
+        Value ? *static_cast<const void *const *>(Value) : nullptr;
+    if (Ptr) {
+      Arg->MKind = argument::Pointer;
+      Arg->MPointer = Ptr;
+    } else {
+      Arg->MValue.assign(Size, 0);
+    }
+  };
+  auto SetArgMemObj = [this](std::optional<pi_result> Result,
+                             pi_kernel Kernel, pi_uint32 Index,
+                             const pi_mem *Mem) {
+    argument_state *Arg =
+        Result == PI_SUCCESS ? getArgument(Kernel, Index) : nullptr;
+    if (!Arg)
+      return;
+    if (Mem && *Mem) {
+      Arg->MKind = argument::MemObj;
+      Arg->MMem = *Mem;
+    } else {
+      Arg->MValue.assign(sizeof(pi_mem), 0);
+    }
+  };
+  auto SetArgSampler = [this](std::optional<pi_result> Result,
+                              pi_kernel Kernel, pi_uint32 Index) {
+    if (argument_state *Arg =
+            Result == PI_SUCCESS ? getArgument(Kernel, Index) : nullptr)
+      Arg->MUnsupported = true;
+  };
+  MArgHandler.set_piKernelSetArg(
+      [SetArg](const pi_plugin &, std::optional<pi_result> Result,
+               pi_kernel Kernel, pi_uint32 Index, size_t Size,
+               const void *Value) {
+        SetArg(Result, Kernel, Index, Size, Value);
+      });
+  MArgHandler.set_piextKernelSetArgPointer(
+      [SetArgPointer](const pi_plugin &, std::optional<pi_result> Result,
+                      pi_kernel Kernel, pi_uint32 Index, size_t Size,
+                      const void *Value) {
+        SetArgPointer(Result, Kernel, Index, Size, Value);
+      });
+  MArgHandler.set_piextKernelSetArgMemObj(
+      [SetArgMemObj](const pi_plugin &, std::optional<pi_result> Result,
+                     pi_kernel Kernel, pi_uint32 Index,
+                     const pi_mem_obj_property *, const pi_mem *Mem) {
+        SetArgMemObj(Result, Kernel, Index, Mem);
+      });
+  MArgHandler.set_piextKernelSetArgSampler(
+      [SetArgSampler](const pi_plugin &, std::optional<pi_result> Result,
+                      pi_kernel Kernel, pi_uint32 Index, const pi_sampler *) {
+        SetArgSampler(Result, Kernel, Index);
+      });
+  // The runtime sets all the arguments of a launch with one call.
+  MArgHandler.set_piextKernelSetArgs(
+      [=](const pi_plugin &, std::optional<pi_result> Result, pi_kernel Kernel,
+          pi_uint32 NumArgs, const pi_kernel_arg *Args) {
+        for (pi_uint32 I = 0; I < NumArgs; ++I) {
+          const pi_kernel_arg &Arg = Args[I];
+          switch (Arg.kind) {
+          case PI_KERNEL_ARG_KIND_VALUE:
+            SetArg(Result, Kernel, Arg.index, Arg.size, Arg.value);
+            break;
+          case PI_KERNEL_ARG_KIND_POINTER:
+            SetArgPointer(Result, Kernel, Arg.index, Arg.size, Arg.value);
+            break;
+          case PI_KERNEL_ARG_KIND_MEM_OBJ:
+            SetArgMemObj(Result, Kernel, Arg.index,
+                         static_cast<const pi_mem *>(Arg.value));
+            break;
+          case PI_KERNEL_ARG_KIND_SAMPLER:
+            SetArgSampler(Result, Kernel, Arg.index);
+            break;
+          }
+        }
+      });
+
+  auto AddAllocation = [this](std::optional<pi_result> Result, void **Ptr,
+                              size_t Size, memory::kind Kind) {
+    if (Result == PI_SUCCESS && *Ptr)
+      MAllocations[reinterpret_cast<uintptr_t>(*Ptr)] = allocation{Size, Kind};
+  };
+  MArgHandler.set_piextUSMHostAlloc(
+      [AddAllocation](const pi_plugin &, std::optional<pi_result> Result,
+                      void **Ptr, pi_context, pi_usm_mem_properties *,
+                      size_t Size, pi_uint32) {
+        AddAllocation(Result, Ptr, Size, memory::Host);
+      });
+  MArgHandler.set_piextUSMDeviceAlloc(
+      [AddAllocation](const pi_plugin &, std::optional<pi_result> Result,
+                      void **Ptr, pi_context, pi_device,
+                      pi_usm_mem_properties *, size_t Size, pi_uint32) {
+        AddAllocation(Result, Ptr, Size, memory::Device);
+      });
+  MArgHandler.set_piextUSMSharedAlloc(
+      [AddAllocation](const pi_plugin &, std::optional<pi_result> Result,
+                      void **Ptr, pi_context, pi_device,
+                      pi_usm_mem_properties *, size_t Size, pi_uint32) {
+        AddAllocation(Result, Ptr, Size, memory::Shared);
+      });
+  MArgHandler.set_piextUSMFree([this](const pi_plugin &,
+                                      std::optional<pi_result> Result,
+                                      pi_context, void *Ptr) {
+    if (Result == PI_SUCCESS)
+      MAllocations.erase(reinterpret_cast<uintptr_t>(Ptr));
+  });
+  MArgHandler.set_piMemBufferCreate(
+      [this](const pi_plugin &, std::optional<pi_result> Result, pi_context,
+             pi_mem_flags, size_t Size, void *, pi_mem *Mem,
+             const pi_mem_properties *) {
+        if (Result == PI_SUCCESS)
+          MBuffers[*Mem] = Size;
+      });
+  // The sub-buffers are captured as buffers of their own.
+  MArgHandler.set_piMemBufferPartition(
+      [this](const pi_plugin &, std::optional<pi_result> Result, pi_mem,
+             pi_mem_flags, pi_buffer_create_type, void *Info, pi_mem *Mem) {
+        if (Result == PI_SUCCESS)
+          MBuffers[*Mem] = static_cast<pi_buffer_region>(Info)->size;
+      });
+
+  auto OnLaunch = [this](const pi_plugin &Plugin,
+                         std::optional<pi_result> Result, pi_queue Queue,
+                         pi_kernel Kernel, pi_uint32 WorkDim,
+                         const size_t *GlobalOffset, const size_t *GlobalSize,
+                         const size_t *LocalSize, pi_uint32 NumEvents,
+                         const pi_event *WaitList, pi_event *) {
+    // The memory is read before the kernel may change it.
+    if (!Result)
+      launched(Plugin, Queue, Kernel, WorkDim, GlobalOffset, GlobalSize,
+               LocalSize, NumEvents, WaitList);
+  };
+  MArgHandler.set_piEnqueueKernelLaunch(OnLaunch);
+  MArgHandler.set_piextEnqueueCooperativeKernelLaunch(OnLaunch);
+}
+
+void Capturer::launched(const pi_plugin &Plugin, pi_queue Queue,
+                        pi_kernel Kernel, pi_uint32 WorkDim,
+                        const size_t *GlobalOffset, const size_t *GlobalSize,
+                        const size_t *LocalSize, pi_uint32 NumEvents,
+                        const pi_event *WaitList) {
+  auto It = MKernels.find(Kernel);
+  if (It == MKernels.end() ||
+      It->second.MName.find(MKernelName) == std::string::npos ||
+      ++MMatchingLaunches != MLaunch)
+    return;
+  MDone = true;
+
+  pending_launch &Pending = MPending.emplace();
+  Pending.MPlugin = &Plugin.PiFunctionTable;
+  Pending.MQueue = Queue;
+  Pending.MKernel = &It->second;
+  Pending.MWaitList.assign(WaitList, WaitList + NumEvents);
+  sycl_replay::capture &Out = Pending.MCapture;
+  Out.MKernelName = It->second.MName;
+  Out.MWorkDim = WorkDim;
+  for (pi_uint32 I = 0; I < WorkDim && I < 3; ++I) {
+    Out.MGlobalOffset[I] = GlobalOffset ? GlobalOffset[I] : 0;
+    Out.MGlobalSize[I] = GlobalSize[I];
+    Out.MLocalSize[I] = LocalSize ? LocalSize[I] : 0;
+  }
+}
+
+void Capturer::finishCapture() {
+  const pi_plugin::FunctionPointers &Plugin = *MPending->MPlugin;
+  pi_queue Queue = MPending->MQueue;
+  const std::vector<pi_event> &WaitList = MPending->MWaitList;
+  sycl_replay::capture &Out = MPending->MCapture;
+  // The dependencies of the launch must be complete for the memory to hold
+  // the inputs of the kernel.
+  if ((!WaitList.empty() &&
+       Plugin.piEventsWait(WaitList.size(), WaitList.data()) != PI_SUCCESS) ||
+      Plugin.piQueueFinish(Queue) != PI_SUCCESS ||
+      !readLaunch(Plugin, Queue, *MPending->MKernel, Out))
+    return;
+  if (!write(Out, MOutFile)) {
+    std::cerr << "sycl-replay: failed to write " << MOutFile << "\n";
+    return;
+  }
+  std::cerr << "sycl-replay: captured " << Out.MKernelName << " to "
+            << MOutFile << "\n";
+}
+
+bool Capturer::readLaunch(const pi_plugin::FunctionPointers &Plugin,
+                          pi_queue Queue, const kernel_state &Kernel,
+                          sycl_replay::capture &Out) {
+  auto Fail = [&](const std::string &Reason) {
+    std::cerr << "sycl-replay: cannot capture " << Kernel.MName << ": "
+              << Reason << "\n";
+    return false;
+  };
+  if (!Kernel.MProgram)
+    return Fail("its program was not created from SPIR-V or a device binary");
+  Out.MProgram = *Kernel.MProgram;
+
+  pi_device Device = nullptr;
+  pi_platform Platform = nullptr;
+  char Name[256] = "";
+  if (Plugin.piQueueGetInfo(Queue, PI_QUEUE_INFO_DEVICE, sizeof(Device),
+                            &Device, nullptr) != PI_SUCCESS ||
+      Plugin.piDeviceGetInfo(Device, PI_DEVICE_INFO_PLATFORM,
+                             sizeof(Platform), &Platform,
+                             nullptr) != PI_SUCCESS)
+    return Fail("the device of the queue is unknown");
+  Plugin.piDeviceGetInfo(Device, PI_DEVICE_INFO_NAME, sizeof(Name) - 1, Name,
+                         nullptr);
+  Out.MDeviceName = Name;
+  Name[0] = '\0';
+  Plugin.piPlatformGetInfo(Platform, PI_PLATFORM_INFO_NAME, sizeof(Name) - 1,
+                           Name, nullptr);
+  Out.MPlatformName = Name;
+  pi_platform_backend Backend = PI_EXT_PLATFORM_BACKEND_UNKNOWN;
+  Plugin.piPlatformGetInfo(Platform, PI_EXT_PLATFORM_INFO_BACKEND,
+                           sizeof(Backend), &Backend, nullptr);
+  Out.MBackend = Backend;
+
+  MCaptured.clear();
+  for (const auto &[Index, State] : Kernel.MArguments) {
+    if (State.MUnsupported)
+      return Fail("argument " + std::to_string(Index) +
+                  " is of an unsupported kind");
+    argument &Arg = Out.MArguments.emplace_back();
+    Arg.MKind = State.MKind;
+    Arg.MIndex = Index;
+    Arg.MValue = State.MValue;
+    Arg.MLocalSize = State.MLocalSize;
+    if (State.MKind != argument::Pointer && State.MKind != argument::MemObj)
+      continue;
+
+    std::optional<uint32_t> Memory =
+        State.MKind == argument::Pointer
+            ? addAllocation(Plugin, Queue, State.MPointer, Arg.MOffset, Out)
+            : addBuffer(Plugin, Queue, State.MMem, Out);
+    if (!Memory)
+      return Fail("the memory of argument " + std::to_string(Index) +
+                  " cannot be read, it may not be a USM allocation");
+    Arg.MMemory = *Memory;
+  }
+  return true;
+}
+
+std::optional<uint32_t>
+Capturer::addAllocation(const pi_plugin::FunctionPointers &Plugin,
+                        pi_queue Queue, const void *Ptr, uint64_t &Offset,
+                        sycl_replay::capture &Out) {
+  uintptr_t Address = reinterpret_cast<uintptr_t>(Ptr);
+  auto It = MAllocations.upper_bound(Address);
+  if (It == MAllocations.begin())
+    return std::nullopt;
+  --It;
+  if (Address >= It->first + It->second.MSize)
+    return std::nullopt;
+  Offset = Address - It->first;
+
+  const void *Base = reinterpret_cast<const void *>(It->first);
+  auto [Captured, New] = MCaptured.try_emplace(Base, Out.MMemory.size());
+  if (!New)
+    return Captured->second;
+  memory &Contents = Out.MMemory.emplace_back();
+  Contents.MKind = It->second.MKind;
+  Contents.MContents.resize(It->second.MSize);
+  if (Plugin.piextUSMEnqueueMemcpy(Queue, /*blocking=*/true,
+                                   Contents.MContents.data(), Base,
+                                   It->second.MSize, 0, nullptr,
+                                   nullptr) != PI_SUCCESS)
+    return std::nullopt;
+  return Captured->second;
+}
+
+std::optional<uint32_t>
+Capturer::addBuffer(const pi_plugin::FunctionPointers &Plugin, pi_queue Queue,
+                    pi_mem Mem, sycl_replay::capture &Out) {
+  auto Buffer = MBuffers.find(Mem);
+  if (Buffer == MBuffers.end())
+    return std::nullopt;
+  auto [Captured, New] = MCaptured.try_emplace(Mem, Out.MMemory.size());
+  if (!New)
+    return Captured->second;
+  memory &Contents = Out.MMemory.emplace_back();
+  Contents.MKind = memory::Buffer;
+  Contents.MContents.resize(Buffer->second);
+  if (Plugin.piEnqueueMemBufferRead(Queue, Mem, /*blocking_read=*/true, 0,
+                                    Buffer->second, Contents.MContents.data(),
+                                    0, nullptr, nullptr) != PI_SUCCESS)
+    return std::nullopt;
+  return Captured->second;
+}
+
+Capturer *GCapturer = nullptr;
+} // namespace
+
+XPTI_CALLBACK_API void piArgsCallback(uint16_t TraceType,
+                                      xpti::trace_event_data_t *,
+                                      xpti::trace_event_data_t *, uint64_t,
+                                      const void *UserData);
+
+XPTI_CALLBACK_API void xptiTraceInit(unsigned int /*major_version*/,
+                                     unsigned int /*minor_version*/,
+                                     const char * /*version_str*/,
+                                     const char *StreamName) {
+  if (std::string_view{StreamName} != "sycl.pi.debug")
+    return;
+  const char *KernelName = std::getenv("SYCL_REPLAY_KERNEL");
+  const char *OutFile = std::getenv("SYCL_REPLAY_OUT_FILE");
+  const char *Launch = std::getenv("SYCL_REPLAY_LAUNCH");
+  if (!KernelName || !OutFile) {
+    std::cerr << "sycl-replay: SYCL_REPLAY_KERNEL and SYCL_REPLAY_OUT_FILE "
+                 "must be set\n";
+    return;
+  }
+  if (!GCapturer)
+    GCapturer = new Capturer(KernelName,
+                             Launch ? std::max(1l, std::atol(Launch)) : 1,
+                             OutFile);
+  uint8_t StreamID = xptiRegisterStream(StreamName);
+  xptiRegisterCallback(StreamID, xpti::trace_function_with_args_begin,
+                       piArgsCallback);
+  xptiRegisterCallback(StreamID, xpti::trace_function_with_args_end,
+                       piArgsCallback);
+}
+
+XPTI_CALLBACK_API void xptiTraceFinish(const char *) {}
+
+XPTI_CALLBACK_API void piArgsCallback(uint16_t TraceType,
+                                      xpti::trace_event_data_t *,
+                                      xpti::trace_event_data_t *, uint64_t,
+                                      const void *UserData) {
+  GCapturer->handle(TraceType,
+                    static_cast<const xpti::function_with_args_t *>(UserData));
+}
@@ -0,0 +1,142 @@
+//==------------ main.cpp - SYCL Replay Tool -------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "capture.hpp"
+#include "launch.hpp"
+#include "replay.hpp"
+#include "llvm/Support/CommandLine.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+void printTimes(const char *Title, std::vector<uint64_t> Times) {
+  if (Times.empty())
+    return;
+  std::sort(Times.begin(), Times.end());
+  double Mean =
+      std::accumulate(Times.begin(), Times.end(), 0.0) / Times.size() / 1e3;
+  char Line[256];
+  std::snprintf(Line, sizeof(Line),
+                "%-12s min %10.2f us  median %10.2f us  mean %10.2f us  max "
+                "%10.2f us",
+                Title, Times.front() / 1e3, Times[Times.size() / 2] / 1e3,
+                Mean, Times.back() / 1e3);
+  std::cout << Line << "\n";
+}
+
+int replay(const std::string &Path, const std::string &Plugin, unsigned Warmup,
+           unsigned Iterations, bool Reset) {
+  sycl_replay::capture Capture;
+  if (!sycl_replay::read(Capture, Path)) {
+    std::cerr << "Failed to read the capture " << Path << "\n";
+    return 1;
+  }
+
+  Replayer Replay(Capture);
+  if (!Replay.init(Plugin) || !Replay.run(Warmup, Iterations, Reset))
+    return 1;
+
+  std::cout << "Kernel:      " << Capture.MKernelName << "\n";
+  std::cout << "Device:      " << Replay.getDeviceName() << "\n";
+  std::cout << "ND-range:    global {";
+  for (uint32_t I = 0; I < Capture.MWorkDim; ++I)
+    std::cout << (I ? ", " : "") << Capture.MGlobalSize[I];
+  std::cout << "} local {";
+  for (uint32_t I = 0; I < Capture.MWorkDim; ++I)
+    std::cout << (I ? ", " : "") << Capture.MLocalSize[I];
+  std::cout << "}\n";
+  std::cout << "Iterations:  " << Iterations << " after " << Warmup
+            << " warm-up\n";
+  printTimes("Device time", Replay.getDeviceTimes());
+  printTimes("Host time", Replay.getHostTimes());
+  return 0;
+}
+} // namespace
+
+int main(int argc, char **argv, char *env[]) {
+  cl::opt<std::string> KernelName(
+      "kernel",
+      cl::desc("Capture the launch of the kernel whose name contains this "
+               "string, running the target executable"),
+      cl::value_desc("name"));
+  cl::opt<unsigned> Launch(
+      "launch", cl::desc("Capture the Nth matching launch, 1 by default"),
+      cl::value_desc("N"), cl::init(1));
+  cl::opt<std::string> OutputFilename(
+      "o", cl::desc("Specify the capture file to write"),
+      cl::value_desc("filename"));
+  cl::opt<unsigned> Iterations("iterations",
+                               cl::desc("Number of timed launches"),
+                               cl::init(10));
+  cl::opt<unsigned> Warmup("warmup",
+                           cl::desc("Number of launches before the timed ones"),
+                           cl::init(1));
+  cl::opt<bool> Reset(
+      "reset", cl::desc("Restore the captured memory before each launch"));
+  cl::opt<std::string> Plugin(
+      "plugin",
+      cl::desc("Plugin library to replay with, by default the one of the "
+               "captured backend"),
+      cl::value_desc("library"));
+  cl::opt<std::string> Target(
+      cl::Positional,
+      cl::desc("<capture file> | -kernel=<name> -o <capture file> <target "
+               "executable>"));
+  cl::list<std::string> Argv(cl::ConsumeAfter,
+                             cl::desc("<program arguments>..."));
+
+  cl::ParseCommandLineOptions(argc, argv);
+
+  if (Target.empty()) {
+    std::cerr << "No capture file or target executable specified\n";
+    return 1;
+  }
+  if (KernelName.empty())
+    return replay(Target, Plugin, Warmup, Iterations, Reset);
+  if (OutputFilename.empty()) {
+    std::cerr << "-kernel needs the capture file to write with -o\n";
+    return 1;
+  }
+
+  std::vector<std::string> NewEnv;
+
+  {
+    size_t I = 0;
+    while (env[I] != nullptr)
+      NewEnv.emplace_back(env[I++]);
+  }
+
+  NewEnv.push_back("SYCL_REPLAY_KERNEL=" + KernelName);
+  NewEnv.push_back("SYCL_REPLAY_LAUNCH=" + std::to_string(Launch));
+  NewEnv.push_back("SYCL_REPLAY_OUT_FILE=" + OutputFilename);
+  NewEnv.push_back("XPTI_FRAMEWORK_DISPATCHER=libxptifw.so");
+  NewEnv.push_back("XPTI_SUBSCRIBERS=libsycl_replay_collector.so");
+  NewEnv.push_back("XPTI_TRACE_ENABLE=1");
+
+  std::vector<std::string> Args;
+
+  Args.push_back(Target);
+  std::copy(Argv.begin(), Argv.end(), std::back_inserter(Args));
+
+  int Err = launch(Target, Args, NewEnv);
+
+  if (Err) {
+    std::cerr << "Failed to launch target application. Error code " << Err
+              << "\n";
+    return Err;
+  }
+
+  return 0;
+}
@@ -0,0 +1,357 @@
+//==------------ replay.cpp - SYCL Replay Tool -----------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "replay.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <dlfcn.h>
+
+using namespace sycl_replay;
+
+namespace {
+const char *getPluginName(uint32_t Backend) {
+  switch (Backend) {
+  case PI_EXT_PLATFORM_BACKEND_LEVEL_ZERO:
+    return "libpi_level_zero.so";
+  case PI_EXT_PLATFORM_BACKEND_OPENCL:
+    return "libpi_opencl.so";
+  case PI_EXT_PLATFORM_BACKEND_CUDA:
+    return "libpi_cuda.so";
+  case PI_EXT_PLATFORM_BACKEND_HIP:
+    return "libpi_hip.so";
+  case PI_EXT_PLATFORM_BACKEND_NATIVE_CPU:
+    return "libpi_native_cpu.so";
+  default:
+    return nullptr;
+  }
+}
+} // namespace
+
+Replayer::~Replayer() {
+  if (!MLibrary)
+    return;
+  for (void *Ptr : MPointers)
+    if (Ptr)
+      MPI.piextUSMFree(MContext, Ptr);
+  for (pi_mem Buffer : MBuffers)
+    if (Buffer)
+      MPI.piMemRelease(Buffer);
+  if (MKernel)
+    MPI.piKernelRelease(MKernel);
+  if (MProgram)
+    MPI.piProgramRelease(MProgram);
+  if (MQueue)
+    MPI.piQueueRelease(MQueue);
+  if (MContext)
+    MPI.piContextRelease(MContext);
+  MPI.piTearDown(nullptr);
+  dlclose(MLibrary);
+}
+
+bool Replayer::check(pi_result Result, const char *Call) {
+  if (Result == PI_SUCCESS)
+    return true;
+  std::cerr << Call << " failed with error " << Result << "\n";
+  return false;
+}
+
+bool Replayer::loadPlugin(const std::string &Name) {
+  MLibrary = dlopen(Name.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!MLibrary) {
+    std::cerr << "Failed to load " << Name << ": " << dlerror() << "\n";
+    return false;
+  }
+  auto *PluginInit = reinterpret_cast<decltype(&::piPluginInit)>(
+      dlsym(MLibrary, "piPluginInit"));
+  if (!PluginInit) {
+    std::cerr << Name << " is not a plugin\n";
+    dlclose(MLibrary);
+    MLibrary = nullptr;
+    return false;
+  }
+  std::strncpy(MPlugin.PiVersion, _PI_H_VERSION_STRING,
+               sizeof(MPlugin.PiVersion) - 1);
+  std::strncpy(MPlugin.PluginVersion, _PI_H_VERSION_STRING,
+               sizeof(MPlugin.PluginVersion) - 1);
+  if (!check(PluginInit(&MPlugin), "piPluginInit")) {
+    dlclose(MLibrary);
+    MLibrary = nullptr;
+    return false;
+  }
+  return true;
+}
+
+bool Replayer::selectDevice() {
+  pi_uint32 NumPlatforms = 0;
+  if (!check(MPI.piPlatformsGet(0, nullptr, &NumPlatforms), "piPlatformsGet"))
+    return false;
+  std::vector<pi_platform> Platforms(NumPlatforms);
+  if (!check(MPI.piPlatformsGet(NumPlatforms, Platforms.data(), nullptr),
+             "piPlatformsGet"))
+    return false;
+
+  // The device of the capture is looked for by name, and the first device is
+  // used if it is not there.
+  for (pi_platform Platform : Platforms) {
+    pi_uint32 NumDevices = 0;
+    if (MPI.piDevicesGet(Platform, PI_DEVICE_TYPE_ALL, 0, nullptr,
+                         &NumDevices) != PI_SUCCESS)
+      continue;
+    std::vector<pi_device> Devices(NumDevices);
+    if (MPI.piDevicesGet(Platform, PI_DEVICE_TYPE_ALL, NumDevices,
+                         Devices.data(), nullptr) != PI_SUCCESS)
+      continue;
+    for (pi_device Device : Devices) {
+      char Name[256] = "";
+      MPI.piDeviceGetInfo(Device, PI_DEVICE_INFO_NAME, sizeof(Name) - 1, Name,
+                          nullptr);
+      if (!MDevice || Name == MCapture.MDeviceName) {
+        MDevice = Device;
+        MDeviceName = Name;
+        MPI.piPlatformGetInfo(Platform, PI_EXT_PLATFORM_INFO_BACKEND,
+                              sizeof(MBackend), &MBackend, nullptr);
+      }
+      if (Name == MCapture.MDeviceName)
+        return true;
+    }
+  }
+  if (!MDevice) {
+    std::cerr << "No device found\n";
+    return false;
+  }
+  std::cerr << "Warning: " << MCapture.MDeviceName
+            << " not found, replaying on " << MDeviceName << "\n";
+  return true;
+}
+
+bool Replayer::buildProgram(const program &Program, bool Compile,
+                            pi_program &Out) {
+  pi_result Result = PI_SUCCESS;
+  const char *Options = Program.MOptions.c_str();
+  if (Program.MKind == program::Linked) {
+    std::vector<pi_program> Inputs;
+    bool Compiled = true;
+    for (const program &Input : Program.MInputs) {
+      pi_program Handle = nullptr;
+      if (!(Compiled = buildProgram(Input, /*Compile=*/true, Handle)))
+        break;
+      Inputs.push_back(Handle);
+    }
+    if (Compiled)
+      Result = MPI.piProgramLink(MContext, 1, &MDevice, Options, Inputs.size(),
+                                 Inputs.data(), nullptr, nullptr, &Out);
+    for (pi_program Input : Inputs)
+      MPI.piProgramRelease(Input);
+    return Compiled && check(Result, "piProgramLink");
+  }
+
+  if (Program.MKind == program::IL) {
+    Result = MPI.piProgramCreate(MContext, Program.MImage.data(),
+                                 Program.MImage.size(), &Out);
+  } else {
+    size_t Length = Program.MImage.size();
+    auto *Binary =
+        reinterpret_cast<const unsigned char *>(Program.MImage.data());
+    Result = MPI.piProgramCreateWithBinary(MContext, 1, &MDevice, &Length,
+                                           &Binary, 0, nullptr, nullptr, &Out);
+  }
+  if (!check(Result, "Program creation"))
+    return false;
+  for (const spec_constant &Constant : Program.MSpecConstants)
+    if (!check(MPI.piextProgramSetSpecializationConstant(
+                   Out, Constant.MID, Constant.MValue.size(),
+                   Constant.MValue.data()),
+               "piextProgramSetSpecializationConstant"))
+      return false;
+  if (Compile)
+    Result = MPI.piProgramCompile(Out, 1, &MDevice, Options, 0, nullptr,
+                                  nullptr, nullptr, nullptr);
+  else
+    Result = MPI.piProgramBuild(Out, 1, &MDevice, Options, nullptr, nullptr);
+  if (Result == PI_SUCCESS)
+    return true;
+
+  size_t LogSize = 0;
+  MPI.piProgramGetBuildInfo(Out, MDevice, PI_PROGRAM_BUILD_INFO_LOG, 0,
+                            nullptr, &LogSize);
+  std::string Log(LogSize, '\0');
+  MPI.piProgramGetBuildInfo(Out, MDevice, PI_PROGRAM_BUILD_INFO_LOG, LogSize,
+                            Log.data(), nullptr);
+  std::cerr << "The build of the program failed with error " << Result
+            << ":\n"
+            << Log.c_str() << "\n";
+  return false;
+}
+
+bool Replayer::uploadMemory() {
+  for (size_t I = 0; I < MCapture.MMemory.size(); ++I) {
+    const memory &Memory = MCapture.MMemory[I];
+    if (Memory.MContents.empty())
+      continue;
+    if (Memory.MKind == memory::Buffer) {
+      if (!check(MPI.piEnqueueMemBufferWrite(
+                     MQueue, MBuffers[I], /*blocking_write=*/true, 0,
+                     Memory.MContents.size(), Memory.MContents.data(), 0,
+                     nullptr, nullptr),
+                 "piEnqueueMemBufferWrite"))
+        return false;
+    } else if (!check(MPI.piextUSMEnqueueMemcpy(
+                          MQueue, /*blocking=*/true, MPointers[I],
+                          Memory.MContents.data(), Memory.MContents.size(), 0,
+                          nullptr, nullptr),
+                      "piextUSMEnqueueMemcpy"))
+      return false;
+  }
+  return true;
+}
+
+bool Replayer::setArguments() {
+  for (const argument &Arg : MCapture.MArguments) {
+    pi_result Result = PI_SUCCESS;
+    switch (Arg.MKind) {
+    case argument::Value:
+      Result = MPI.piKernelSetArg(MKernel, Arg.MIndex, Arg.MValue.size(),
+                                  Arg.MValue.data());
+      break;
+    case argument::Local:
+      Result =
+          MPI.piKernelSetArg(MKernel, Arg.MIndex, Arg.MLocalSize, nullptr);
+      break;
+    case argument::Pointer: {
+      void *Ptr = static_cast<char *>(MPointers[Arg.MMemory]) + Arg.MOffset;
+      Result = MPI.piextKernelSetArgPointer(MKernel, Arg.MIndex, sizeof(Ptr),
+                                            &Ptr);
+      break;
+    }
+    case argument::MemObj: {
+      pi_mem Buffer = MBuffers[Arg.MMemory];
+      // The OpenCL plugin takes the buffers as plain arguments.
+      if (MBackend == PI_EXT_PLATFORM_BACKEND_OPENCL) {
+        Result = MPI.piKernelSetArg(MKernel, Arg.MIndex, sizeof(Buffer),
+                                    &Buffer);
+        break;
+      }
+      pi_mem_obj_property Property{};
+      Property.type = PI_KERNEL_ARG_MEM_OBJ_ACCESS;
+      Property.mem_access = PI_ACCESS_READ_WRITE;
+      Result = MPI.piextKernelSetArgMemObj(MKernel, Arg.MIndex, &Property,
+                                           &Buffer);
+      break;
+    }
+    }
+    if (!check(Result, "Setting a kernel argument"))
+      return false;
+  }
+  return true;
+}
+
+bool Replayer::init(const std::string &Plugin) {
+  std::string Name = Plugin;
+  if (Name.empty()) {
+    const char *Default = getPluginName(MCapture.MBackend);
+    if (!Default) {
+      std::cerr << "The backend of the capture has no plugin, use -plugin\n";
+      return false;
+    }
+    Name = Default;
+  }
+  if (!loadPlugin(Name) || !selectDevice())
+    return false;
+
+  pi_queue_properties Properties[] = {
+      PI_QUEUE_FLAGS, PI_QUEUE_FLAG_PROFILING_ENABLE, 0};
+  if (!check(MPI.piContextCreate(nullptr, 1, &MDevice, nullptr, nullptr,
+                                 &MContext),
+             "piContextCreate") ||
+      !check(MPI.piextQueueCreate(MContext, MDevice, Properties, &MQueue),
+             "piextQueueCreate") ||
+      !buildProgram(MCapture.MProgram, /*Compile=*/false, MProgram) ||
+      !check(MPI.piKernelCreate(MProgram, MCapture.MKernelName.c_str(),
+                                &MKernel),
+             "piKernelCreate"))
+    return false;
+
+  MPointers.assign(MCapture.MMemory.size(), nullptr);
+  MBuffers.assign(MCapture.MMemory.size(), nullptr);
+  for (size_t I = 0; I < MCapture.MMemory.size(); ++I) {
+    const memory &Memory = MCapture.MMemory[I];
+    // The backends may reject empty allocations.
+    size_t Size = std::max<size_t>(Memory.MContents.size(), 1);
+    pi_result Result = PI_SUCCESS;
+    switch (Memory.MKind) {
+    case memory::Host:
+      Result =
+          MPI.piextUSMHostAlloc(&MPointers[I], MContext, nullptr, Size, 0);
+      break;
+    case memory::Device:
+      Result = MPI.piextUSMDeviceAlloc(&MPointers[I], MContext, MDevice,
+                                       nullptr, Size, 0);
+      break;
+    case memory::Shared:
+      Result = MPI.piextUSMSharedAlloc(&MPointers[I], MContext, MDevice,
+                                       nullptr, Size, 0);
+      break;
+    case memory::Buffer:
+      Result = MPI.piMemBufferCreate(MContext, PI_MEM_FLAGS_ACCESS_RW, Size,
+                                     nullptr, &MBuffers[I], nullptr);
+      break;
+    }
+    if (!check(Result, "Memory allocation"))
+      return false;
+  }
+  return uploadMemory() && setArguments();
+}
+
+bool Replayer::run(unsigned Warmup, unsigned Iterations, bool Reset) {
+  size_t GlobalOffset[3], GlobalSize[3], LocalSize[3];
+  bool HasLocalSize = false;
+  for (size_t I = 0; I < 3; ++I) {
+    GlobalOffset[I] = MCapture.MGlobalOffset[I];
+    GlobalSize[I] = MCapture.MGlobalSize[I];
+    LocalSize[I] = MCapture.MLocalSize[I];
+    HasLocalSize |= LocalSize[I] != 0;
+  }
+
+  for (unsigned I = 0; I < Warmup + Iterations; ++I) {
+    // The memory of the first launch was uploaded by init().
+    if (Reset && I && !uploadMemory())
+      return false;
+    pi_event Event = nullptr;
+    auto Start = std::chrono::steady_clock::now();
+    if (!check(MPI.piEnqueueKernelLaunch(MQueue, MKernel, MCapture.MWorkDim,
+                                         GlobalOffset, GlobalSize,
+                                         HasLocalSize ? LocalSize : nullptr, 0,
+                                         nullptr, &Event),
+               "piEnqueueKernelLaunch") ||
+        !check(MPI.piEventsWait(1, &Event), "piEventsWait"))
+      return false;
+    auto End = std::chrono::steady_clock::now();
+
+    uint64_t DeviceStart = 0, DeviceEnd = 0;
+    bool Profiled =
+        MPI.piEventGetProfilingInfo(Event, PI_PROFILING_INFO_COMMAND_START,
+                                    sizeof(DeviceStart), &DeviceStart,
+                                    nullptr) == PI_SUCCESS &&
+        MPI.piEventGetProfilingInfo(Event, PI_PROFILING_INFO_COMMAND_END,
+                                    sizeof(DeviceEnd), &DeviceEnd,
+                                    nullptr) == PI_SUCCESS;
+    MPI.piEventRelease(Event);
+    if (I < Warmup)
+      continue;
+    if (Profiled && DeviceStart <= DeviceEnd)
+      MDeviceNs.push_back(DeviceEnd - DeviceStart);
+    MHostNs.push_back(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(End - Start)
+            .count());
+  }
+  return true;
+}
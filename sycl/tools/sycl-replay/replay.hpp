@@ -0,0 +1,66 @@
+//==------------ replay.hpp - SYCL Replay Tool -----------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "capture.hpp"
+
+#include <sycl/detail/pi.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Re-runs a captured kernel launch through a plugin, without the SYCL
+/// runtime. The program is built again from the captured image with the same
+/// options and specialization constants, and the memory is allocated again
+/// with the captured contents, so the pointer arguments point to the same
+/// offsets of their allocations.
+class Replayer {
+public:
+  explicit Replayer(const sycl_replay::capture &Capture) : MCapture(Capture) {}
+  ~Replayer();
+
+  /// Loads the plugin, or the one of the backend of the capture if Plugin is
+  /// empty, and sets up the device, the kernel and its arguments.
+  bool init(const std::string &Plugin);
+  /// Launches the kernel Warmup + Iterations times, and keeps the device time
+  /// of the last Iterations launches. The memory is restored before each
+  /// launch if Reset is set.
+  bool run(unsigned Warmup, unsigned Iterations, bool Reset);
+
+  const std::vector<uint64_t> &getDeviceTimes() const { return MDeviceNs; }
+  const std::vector<uint64_t> &getHostTimes() const { return MHostNs; }
+  const std::string &getDeviceName() const { return MDeviceName; }
+
+private:
+  bool check(pi_result Result, const char *Call);
+  bool loadPlugin(const std::string &Name);
+  bool selectDevice();
+  bool buildProgram(const sycl_replay::program &Program, bool Compile,
+                    pi_program &Out);
+  bool uploadMemory();
+  bool setArguments();
+
+  const sycl_replay::capture &MCapture;
+  void *MLibrary = nullptr;
+  pi_plugin MPlugin{};
+  const pi_plugin::FunctionPointers &MPI = MPlugin.PiFunctionTable;
+  pi_platform_backend MBackend = PI_EXT_PLATFORM_BACKEND_UNKNOWN;
+  std::string MDeviceName;
+  pi_device MDevice = nullptr;
+  pi_context MContext = nullptr;
+  pi_queue MQueue = nullptr;
+  pi_program MProgram = nullptr;
+  pi_kernel MKernel = nullptr;
+  /// The allocation or the buffer of each captured memory
+  std::vector<void *> MPointers;
+  std::vector<pi_mem> MBuffers;
+  std::vector<uint64_t> MDeviceNs;
+  std::vector<uint64_t> MHostNs;
+};
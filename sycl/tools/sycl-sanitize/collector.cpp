@@ -8,15 +8,18 @@
 
 /// \file collector.cpp
 /// The SYCL sanitizer collector intercepts PI calls to find memory leaks in
-/// usages of USM pointers.
+/// usages of USM pointers. With SYCL_SANITIZE_MEMORY set, it also records
+/// the memory allocations and reports the memory usage of the application.
 
 #include "xpti/xpti_trace_framework.h"
 
+#include "memory_tracker.hpp"
 #include "pi_arguments_handler.hpp"
 #include "usm_analyzer.hpp"
 
 #include <detail/plugin_printers.hpp>
 
+#include <cstdlib>
 #include <iostream>
 #include <map>
 #include <mutex>
@@ -25,16 +28,25 @@
 #include <thread>
 
 std::mutex IOMutex;
+MemoryTracker *GMemory = nullptr;
 
 XPTI_CALLBACK_API void tpCallback(uint16_t trace_type,
                                   xpti::trace_event_data_t *parent,
                                   xpti::trace_event_data_t *event,
                                   uint64_t instance, const void *user_data);
+XPTI_CALLBACK_API void memAllocCallback(uint16_t TraceType,
+                                        xpti::trace_event_data_t *,
+                                        xpti::trace_event_data_t *,
+                                        uint64_t /*Instance*/,
+                                        const void *UserData);
 
 XPTI_CALLBACK_API void xptiTraceInit(unsigned int /*major_version*/,
                                      unsigned int /*minor_version*/,
                                      const char * /*version_str*/,
                                      const char *StreamName) {
+  if (!GMemory && std::getenv("SYCL_SANITIZE_MEMORY"))
+    GMemory = new MemoryTracker(std::getenv("SYCL_SANITIZE_MEMORY_TIMELINE"));
+
   if (std::string_view(StreamName) == "sycl.pi.debug") {
     uint8_t StreamID = xptiRegisterStream(StreamName);
     xptiRegisterCallback(StreamID, xpti::trace_function_with_args_begin,
@@ -45,11 +57,26 @@ XPTI_CALLBACK_API void xptiTraceInit(unsigned int /*major_version*/,
     GS.changeTerminationOnErrorState(true);
     GS.printToErrorStream();
     GS.setupUSMHandlers();
+  } else if (GMemory &&
+             std::string_view(StreamName) == "sycl.experimental.mem_alloc") {
+    uint8_t StreamID = xptiRegisterStream(StreamName);
+    xptiRegisterCallback(
+        StreamID,
+        static_cast<uint16_t>(xpti::trace_point_type_t::mem_alloc_end),
+        memAllocCallback);
+    xptiRegisterCallback(
+        StreamID,
+        static_cast<uint16_t>(xpti::trace_point_type_t::mem_release_begin),
+        memAllocCallback);
   }
 }
 
 XPTI_CALLBACK_API void xptiTraceFinish(const char *StreamName) {
   if (std::string_view(StreamName) == "sycl.pi.debug") {
+    if (GMemory) {
+      std::lock_guard<std::mutex> Lock(IOMutex);
+      GMemory->finish();
+    }
     bool hadLeak = false;
     auto &GS = USMAnalyzer::getInstance();
     if (GS.ActivePointers.size() > 0) {
@@ -89,4 +116,26 @@ XPTI_CALLBACK_API void tpCallback(uint16_t TraceType,
     GS.ArgHandlerPostCall.handle(Data->function_id, *Plugin, Result,
                                  Data->args_data);
   }
+  if (GMemory)
+    GMemory->functionWithArgs(TraceType, Data,
+                              call_site{GS.LastTracepoint.Source,
+                                        GS.LastTracepoint.Function,
+                                        GS.LastTracepoint.Line});
+}
+
+XPTI_CALLBACK_API void memAllocCallback(uint16_t TraceType,
+                                        xpti::trace_event_data_t *,
+                                        xpti::trace_event_data_t *,
+                                        uint64_t /*Instance*/,
+                                        const void *UserData) {
+  std::lock_guard<std::mutex> Lock(IOMutex);
+  // The events of the stream all have the same payload, the call site is the
+  // code location of the calling thread.
+  auto &GS = USMAnalyzer::getInstance();
+  GS.fillLastTracepointData(nullptr);
+  GMemory->memAlloc(TraceType,
+                    static_cast<const xpti::mem_alloc_data_t *>(UserData),
+                    call_site{GS.LastTracepoint.Source,
+                              GS.LastTracepoint.Function,
+                              GS.LastTracepoint.Line});
 }
@@ -19,6 +19,16 @@ int main(int argc, char **argv, char *env[]) {
       cl::Positional, cl::desc("<target executable>"), cl::Required);
   cl::list<std::string> Argv(cl::ConsumeAfter,
                              cl::desc("<program arguments>..."));
+  cl::opt<bool> Memory(
+      "memory",
+      cl::desc("Record the memory allocations and report the peak device "
+               "memory by call site, the fragmentation and the allocations "
+               "never freed"));
+  cl::opt<std::string> MemoryTimeline(
+      "memory-timeline",
+      cl::desc("Write every allocation and free to a CSV file, implies "
+               "-memory"),
+      cl::value_desc("filename"));
 
   cl::ParseCommandLineOptions(argc, argv);
 
@@ -30,6 +40,10 @@ int main(int argc, char **argv, char *env[]) {
       NewEnv.push_back(env[I++]);
   }
 
+  if (Memory || !MemoryTimeline.empty())
+    NewEnv.push_back("SYCL_SANITIZE_MEMORY=1");
+  if (!MemoryTimeline.empty())
+    NewEnv.push_back("SYCL_SANITIZE_MEMORY_TIMELINE=" + MemoryTimeline);
   NewEnv.push_back("XPTI_FRAMEWORK_DISPATCHER=libxptifw.so");
   NewEnv.push_back("XPTI_SUBSCRIBERS=libsycl_sanitizer_collector.so");
   NewEnv.push_back("XPTI_TRACE_ENABLE=1");
@@ -0,0 +1,341 @@
+//==----------------- memory_tracker.cpp -----------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "memory_tracker.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+constexpr char PrintPrefix[] = "[Memory] ";
+constexpr char PrintIndentation[] = "         | ";
+/// Number of call sites printed, the others are only counted
+constexpr size_t MaxSites = 20;
+
+std::string formatBytes(size_t Bytes) {
+  const char *Units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+  double Value = static_cast<double>(Bytes);
+  size_t Unit = 0;
+  while (Value >= 1024 && Unit + 1 < std::size(Units)) {
+    Value /= 1024;
+    ++Unit;
+  }
+  std::stringstream Out;
+  if (Unit == 0)
+    Out << Bytes << " B";
+  else
+    Out << std::fixed << std::setprecision(2) << Value << " " << Units[Unit];
+  return Out.str();
+}
+
+std::string formatSite(const call_site &Site) {
+  return "function " + Site.MFunction + " at " + Site.MSource + ":" +
+         std::to_string(Site.MLine);
+}
+
+unsigned sizeClass(size_t Size) {
+  unsigned Class = 0;
+  while (Class < 63 && (size_t{1} << (Class + 1)) <= Size)
+    ++Class;
+  return Class;
+}
+} // namespace
+
+MemoryTracker::MemoryTracker(const char *TimelinePath)
+    : MStart(std::chrono::steady_clock::now()) {
+  if (TimelinePath) {
+    MTimeline.open(TimelinePath);
+    if (!MTimeline)
+      std::cerr << PrintPrefix << "Cannot write the timeline to "
+                << TimelinePath << "\n";
+    else
+      MTimeline << "time_ns,event,kind,size,device_bytes,host_bytes,site\n";
+  }
+
+  MArgHandler.set_piextUSMHostAlloc(
+      [this](const pi_plugin &, std::optional<pi_result> Result,
+             void **ResultPtr, pi_context, pi_usm_mem_properties *,
+             size_t Size, pi_uint32) {
+        if (Result == PI_SUCCESS && *ResultPtr)
+          allocate(reinterpret_cast<uintptr_t>(*ResultPtr), Size,
+                   alloc_kind::host, nullptr, MCurrentSite);
+      });
+  MArgHandler.set_piextUSMDeviceAlloc(
+      [this](const pi_plugin &, std::optional<pi_result> Result,
+             void **ResultPtr, pi_context, pi_device Device,
+             pi_usm_mem_properties *, size_t Size, pi_uint32) {
+        if (Result == PI_SUCCESS && *ResultPtr)
+          allocate(reinterpret_cast<uintptr_t>(*ResultPtr), Size,
+                   alloc_kind::device, Device, MCurrentSite);
+      });
+  MArgHandler.set_piextUSMSharedAlloc(
+      [this](const pi_plugin &, std::optional<pi_result> Result,
+             void **ResultPtr, pi_context, pi_device, pi_usm_mem_properties *,
+             size_t Size, pi_uint32) {
+        if (Result == PI_SUCCESS && *ResultPtr)
+          allocate(reinterpret_cast<uintptr_t>(*ResultPtr), Size,
+                   alloc_kind::shared, nullptr, MCurrentSite);
+      });
+  MArgHandler.set_piextUSMFree(
+      [this](const pi_plugin &, std::optional<pi_result> Result, pi_context,
+             void *Ptr) {
+        if (Result == PI_SUCCESS && Ptr &&
+            !release(MUSM, reinterpret_cast<uintptr_t>(Ptr)))
+          ++MUnknownFrees;
+      });
+}
+
+void MemoryTracker::functionWithArgs(uint16_t TraceType,
+                                     const xpti::function_with_args_t *Data,
+                                     const call_site &Site) {
+  // The allocations are known once they succeeded.
+  if (TraceType != xpti::trace_function_with_args_end)
+    return;
+  const auto *Plugin = static_cast<pi_plugin *>(Data->user_data);
+  const pi_result Result = *static_cast<pi_result *>(Data->ret_data);
+  MCurrentSite = &Site;
+  MArgHandler.handle(Data->function_id, *Plugin, Result, Data->args_data);
+  MCurrentSite = nullptr;
+}
+
+void MemoryTracker::memAlloc(uint16_t TraceType,
+                             const xpti::mem_alloc_data_t *Data,
+                             const call_site &Site) {
+  const std::pair<uintptr_t, uintptr_t> Map{Data->mem_object_handle,
+                                            Data->alloc_pointer};
+  using xpti::trace_point_type_t;
+  if (TraceType == static_cast<uint16_t>(trace_point_type_t::mem_alloc_end)) {
+    if (Data->mem_object_handle == 0 || Data->alloc_size == 0)
+      return;
+    // The mappings of the buffers are reported as allocations of the buffer
+    // already allocated.
+    if (MBuffers.count(Data->mem_object_handle)) {
+      MMaps.insert(Map);
+      return;
+    }
+    allocate(Data->mem_object_handle, Data->alloc_size, alloc_kind::buffer,
+             nullptr, &Site);
+  } else if (TraceType ==
+             static_cast<uint16_t>(trace_point_type_t::mem_release_begin)) {
+    if (MMaps.erase(Map))
+      return;
+    release(MBuffers, Data->mem_object_handle);
+  }
+}
+
+size_t MemoryTracker::getSite(const call_site *Site) {
+  static const call_site Unknown{"<unknown>", "<unknown>", 0};
+  if (!Site)
+    Site = &Unknown;
+  auto [It, Inserted] = MSiteIDs.try_emplace(
+      std::make_tuple(Site->MSource, Site->MFunction, Site->MLine),
+      MSites.size());
+  if (Inserted)
+    MSites.emplace_back().MLocation = *Site;
+  return It->second;
+}
+
+void MemoryTracker::allocate(uintptr_t Key, size_t Size, alloc_kind Kind,
+                             pi_device Device, const call_site *Site) {
+  size_t SiteID = getSite(Site);
+  auto &Allocations = Kind == alloc_kind::buffer ? MBuffers : MUSM;
+  // A pointer freed out of the sight of the runtime may be given again.
+  release(Allocations, Key);
+  Allocations[Key] = allocation{Size, Kind, SiteID, Device};
+
+  ++MAllocs;
+  ++MSizeHistogram[sizeClass(Size)];
+  site_stats &Stats = MSites[SiteID];
+  ++Stats.MAllocs;
+  Stats.MLive += Size;
+  Stats.MPeak = std::max(Stats.MPeak, Stats.MLive);
+  Stats.MLargest = std::max(Stats.MLargest, Size);
+
+  if (isDevice(Kind)) {
+    MDeviceLive += Size;
+    if (MDeviceLive > MDevicePeak) {
+      MDevicePeak = MDeviceLive;
+      for (site_stats &Other : MSites)
+        Other.MAtPeak = Other.MLive;
+    }
+  } else {
+    MHostLive += Size;
+    MHostPeak = std::max(MHostPeak, MHostLive);
+  }
+  if (Kind == alloc_kind::device) {
+    device_ranges &Ranges = MRanges[Device];
+    Ranges.MLive[Key] = Size;
+    Ranges.MLiveBytes += Size;
+    updateRanges(Ranges);
+  }
+  writeTimeline("alloc", Kind, Size, SiteID);
+}
+
+bool MemoryTracker::release(
+    std::unordered_map<uintptr_t, allocation> &Allocations, uintptr_t Key) {
+  auto It = Allocations.find(Key);
+  if (It == Allocations.end())
+    return false;
+  const allocation Alloc = It->second;
+  Allocations.erase(It);
+
+  ++MFrees;
+  site_stats &Stats = MSites[Alloc.MSite];
+  ++Stats.MFrees;
+  Stats.MLive -= Alloc.MSize;
+  (isDevice(Alloc.MKind) ? MDeviceLive : MHostLive) -= Alloc.MSize;
+  if (Alloc.MKind == alloc_kind::device) {
+    device_ranges &Ranges = MRanges[Alloc.MDevice];
+    Ranges.MLive.erase(Key);
+    Ranges.MLiveBytes -= Alloc.MSize;
+    updateRanges(Ranges);
+  }
+  writeTimeline("free", Alloc.MKind, Alloc.MSize, Alloc.MSite);
+  return true;
+}
+
+void MemoryTracker::updateRanges(device_ranges &Ranges) {
+  if (Ranges.MLive.empty())
+    return;
+  // The span from the lowest to the highest live allocation, the part of it
+  // which is not in use is the fragmentation.
+  const auto &Last = *Ranges.MLive.rbegin();
+  size_t Span = Last.first + Last.second - Ranges.MLive.begin()->first;
+  if (Ranges.MLiveBytes > Ranges.MPeakBytes) {
+    Ranges.MPeakBytes = Ranges.MLiveBytes;
+    Ranges.MPeakSpan = Span;
+  }
+  double Fragmentation =
+      Span ? 1 - static_cast<double>(Ranges.MLiveBytes) / Span : 0;
+  if (Fragmentation > Ranges.MWorstFragmentation) {
+    Ranges.MWorstFragmentation = Fragmentation;
+    Ranges.MWorstBytes = Ranges.MLiveBytes;
+    Ranges.MWorstSpan = Span;
+  }
+}
+
+void MemoryTracker::writeTimeline(const char *Event, alloc_kind Kind,
+                                  size_t Size, size_t Site) {
+  if (!MTimeline)
+    return;
+  auto Time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - MStart)
+                  .count();
+  const call_site &Location = MSites[Site].MLocation;
+  MTimeline << Time << "," << Event << "," << kindName(Kind) << "," << Size
+            << "," << MDeviceLive << "," << MHostLive << ",\""
+            << Location.MSource << ":" << Location.MLine << " "
+            << Location.MFunction << "\"\n";
+}
+
+const char *MemoryTracker::kindName(alloc_kind Kind) {
+  switch (Kind) {
+  case alloc_kind::host:
+    return "host";
+  case alloc_kind::device:
+    return "device";
+  case alloc_kind::shared:
+    return "shared";
+  case alloc_kind::buffer:
+    return "buffer";
+  }
+  return "unknown";
+}
+
+void MemoryTracker::finish() {
+  if (MFinished)
+    return;
+  MFinished = true;
+  MTimeline.close();
+
+  auto &Out = std::cerr;
+  Out << std::endl;
+  Out << PrintPrefix << MAllocs << " allocations, " << MFrees << " frees";
+  if (MUnknownFrees)
+    Out << ", " << MUnknownFrees << " frees of unknown pointers";
+  Out << "\n";
+  Out << PrintPrefix << "Peak device memory: " << formatBytes(MDevicePeak)
+      << " (device and shared USM, buffers)\n";
+  Out << PrintPrefix << "Peak host USM memory: " << formatBytes(MHostPeak)
+      << "\n";
+
+  // The call sites holding the device memory at its peak, then the other
+  // call sites by their own peak.
+  std::vector<size_t> Order;
+  for (size_t I = 0; I < MSites.size(); ++I)
+    Order.push_back(I);
+  std::sort(Order.begin(), Order.end(), [&](size_t L, size_t R) {
+    return std::make_tuple(MSites[L].MAtPeak, MSites[L].MPeak) >
+           std::make_tuple(MSites[R].MAtPeak, MSites[R].MPeak);
+  });
+  if (!Order.empty()) {
+    Out << PrintPrefix << "Memory by call site:\n";
+    Out << PrintIndentation << std::setw(12) << "At peak" << std::setw(12)
+        << "Site peak" << std::setw(12) << "Largest" << std::setw(8)
+        << "Allocs" << std::setw(8) << "Frees"
+        << "  Call site\n";
+    for (size_t I = 0; I < std::min(Order.size(), MaxSites); ++I) {
+      const site_stats &Site = MSites[Order[I]];
+      Out << PrintIndentation << std::setw(12) << formatBytes(Site.MAtPeak)
+          << std::setw(12) << formatBytes(Site.MPeak) << std::setw(12)
+          << formatBytes(Site.MLargest) << std::setw(8) << Site.MAllocs
+          << std::setw(8) << Site.MFrees << "  " << formatSite(Site.MLocation)
+          << "\n";
+    }
+    if (Order.size() > MaxSites)
+      Out << PrintIndentation << "... " << Order.size() - MaxSites
+          << " more call sites\n";
+  }
+
+  if (!MSizeHistogram.empty()) {
+    Out << PrintPrefix << "Allocation sizes:\n";
+    for (const auto &[Class, Count] : MSizeHistogram)
+      Out << PrintIndentation << std::setw(12)
+          << formatBytes(size_t{1} << Class) << " or more: " << Count << "\n";
+  }
+
+  for (const auto &[Device, Ranges] : MRanges) {
+    if (Ranges.MPeakSpan == 0)
+      continue;
+    auto Percent = [](size_t Bytes, size_t Span) {
+      return static_cast<int>(100 * (1 - static_cast<double>(Bytes) / Span));
+    };
+    Out << PrintPrefix << "Device USM fragmentation of device " << Device
+        << ":\n";
+    Out << PrintIndentation << "at the peak " << formatBytes(Ranges.MPeakBytes)
+        << " in use in a range of " << formatBytes(Ranges.MPeakSpan) << " ("
+        << Percent(Ranges.MPeakBytes, Ranges.MPeakSpan) << "% unused)\n";
+    Out << PrintIndentation << "at worst " << formatBytes(Ranges.MWorstBytes)
+        << " in use in a range of " << formatBytes(Ranges.MWorstSpan) << " ("
+        << Percent(Ranges.MWorstBytes, Ranges.MWorstSpan) << "% unused)\n";
+  }
+
+  // The allocations never freed, by call site and kind.
+  std::map<std::pair<size_t, alloc_kind>, std::pair<size_t, size_t>> Leaks;
+  size_t LeakedBytes = 0, Leaked = 0;
+  for (const auto *Allocations : {&MUSM, &MBuffers})
+    for (const auto &[Key, Alloc] : *Allocations) {
+      auto &[Count, Bytes] = Leaks[{Alloc.MSite, Alloc.MKind}];
+      ++Count;
+      Bytes += Alloc.MSize;
+      LeakedBytes += Alloc.MSize;
+      ++Leaked;
+    }
+  if (Leaked) {
+    Out << PrintPrefix << Leaked << " allocations never freed, "
+        << formatBytes(LeakedBytes) << ":\n";
+    for (const auto &[Site, Leak] : Leaks)
+      Out << PrintIndentation << std::setw(12) << formatBytes(Leak.second)
+          << " in " << Leak.first << " " << kindName(Site.second)
+          << " allocations, " << formatSite(MSites[Site.first].MLocation)
+          << "\n";
+  }
+  Out << std::flush;
+}
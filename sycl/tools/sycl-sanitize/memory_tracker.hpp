@@ -0,0 +1,128 @@
+//==----------------- memory_tracker.hpp -----------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "pi_arguments_handler.hpp"
+
+#include <xpti/xpti_data_types.h>
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+/// Place in the application code where an allocation was made
+struct call_site {
+  std::string MSource;
+  std::string MFunction;
+  uint32_t MLine = 0;
+};
+
+/// Records every USM allocation and free, and every buffer allocation and
+/// release of the SYCL runtime, with their sizes and call sites, and reports
+/// at the end of the application:
+///  - the peak of the device memory in use, and the call sites holding it;
+///  - the fragmentation of the device USM address range of each device;
+///  - the allocations which were never freed, grouped by call site.
+///
+/// The USM allocations are found from the PI calls, the buffers from the
+/// memory allocation stream of the MemoryManager. The device memory is the
+/// device and shared USM and the buffers, the host USM is reported apart.
+/// When a timeline file is given, every allocation and free is written to it
+/// as a CSV line with the memory in use after it.
+class MemoryTracker {
+public:
+  explicit MemoryTracker(const char *TimelinePath);
+  ~MemoryTracker() { finish(); }
+
+  /// Handles a PI call of the sycl.pi.debug stream made from Site.
+  void functionWithArgs(uint16_t TraceType,
+                        const xpti::function_with_args_t *Data,
+                        const call_site &Site);
+  /// Handles an event of the sycl.experimental.mem_alloc stream made from
+  /// Site.
+  void memAlloc(uint16_t TraceType, const xpti::mem_alloc_data_t *Data,
+                const call_site &Site);
+  /// Prints the report to stderr, once.
+  void finish();
+
+private:
+  enum class alloc_kind { host, device, shared, buffer };
+
+  struct allocation {
+    size_t MSize;
+    alloc_kind MKind;
+    size_t MSite;
+    /// Device of the device USM allocations
+    pi_device MDevice;
+  };
+
+  struct site_stats {
+    call_site MLocation;
+    size_t MAllocs = 0, MFrees = 0;
+    /// Device or host bytes in use, depending on the kinds allocated here
+    size_t MLive = 0, MPeak = 0;
+    /// Bytes in use when the device memory of the application peaked
+    size_t MAtPeak = 0;
+    size_t MLargest = 0;
+  };
+
+  /// Device USM address range of a device
+  struct device_ranges {
+    /// Sizes of the live allocations, by address
+    std::map<uintptr_t, size_t> MLive;
+    size_t MLiveBytes = 0;
+    /// Bytes in use and address span at the peak of the bytes in use, and
+    /// the largest fragmentation seen
+    size_t MPeakBytes = 0, MPeakSpan = 0;
+    double MWorstFragmentation = 0;
+    size_t MWorstBytes = 0, MWorstSpan = 0;
+  };
+
+  size_t getSite(const call_site *Site);
+  void allocate(uintptr_t Key, size_t Size, alloc_kind Kind,
+                pi_device Device, const call_site *Site);
+  /// Releases the allocation Key of Allocations.
+  /// @returns false if it is not known.
+  bool release(std::unordered_map<uintptr_t, allocation> &Allocations,
+               uintptr_t Key);
+  void updateRanges(device_ranges &Ranges);
+  void writeTimeline(const char *Event, alloc_kind Kind, size_t Size,
+                     size_t Site);
+
+  static const char *kindName(alloc_kind Kind);
+  static bool isDevice(alloc_kind Kind) { return Kind != alloc_kind::host; }
+
+  sycl::xpti_helpers::PiArgumentsHandler MArgHandler;
+  /// Call site of the PI call being handled
+  const call_site *MCurrentSite = nullptr;
+  bool MFinished = false;
+  std::chrono::steady_clock::time_point MStart;
+  std::ofstream MTimeline;
+
+  std::vector<site_stats> MSites;
+  std::map<std::tuple<std::string, std::string, uint32_t>, size_t> MSiteIDs;
+  /// Live USM allocations by pointer, and buffers by memory object handle
+  std::unordered_map<uintptr_t, allocation> MUSM, MBuffers;
+  /// Mappings of the buffers, which are reported on the same stream as their
+  /// allocations
+  std::set<std::pair<uintptr_t, uintptr_t>> MMaps;
+  std::unordered_map<pi_device, device_ranges> MRanges;
+
+  size_t MDeviceLive = 0, MDevicePeak = 0;
+  size_t MHostLive = 0, MHostPeak = 0;
+  size_t MAllocs = 0, MFrees = 0, MUnknownFrees = 0;
+  /// Number of allocations by power of two of their size
+  std::map<unsigned, size_t> MSizeHistogram;
+};
@@ -0,0 +1,236 @@
+//==-------------- collector.cpp - SYCL Top Tool ---------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "shared_stats.hpp"
+
+#include "../sycl-prof/timeline.hpp"
+#include "../sycl-prof/writer.hpp"
+#include "pi_arguments_handler.hpp"
+
+#include <detail/metrics.hpp>
+#include <xpti/xpti_trace_framework.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace chrono = std::chrono;
+using namespace sycl_top;
+
+static_assert(NumMetrics == sycl::detail::NumMetricKinds,
+              "The shared statistics miss some of the runtime metrics");
+
+namespace {
+/// Adds up the device time of the kernels seen by the kernel timeline.
+class KernelTotals : public Writer {
+public:
+  void init() final {}
+  void finalize() final {}
+  void writeBegin(std::string_view, std::string_view, size_t, size_t,
+                  size_t) final {}
+  void writeEnd(std::string_view, std::string_view, size_t, size_t,
+                size_t) final {}
+  void writeComplete(std::string_view Name, std::string_view, size_t, size_t,
+                     size_t Begin, size_t End) final;
+
+private:
+  std::mutex MMutex;
+  std::unordered_map<std::string, kernel_stats *> MKernels;
+};
+
+shared_stats *GStats = nullptr;
+KernelTotals *GTotals = nullptr;
+KernelTimeline *GTimeline = nullptr;
+sycl::xpti_helpers::PiArgumentsHandler *GArgHandler = nullptr;
+/// Sizes of the live USM allocations
+std::mutex GUSMMutex;
+std::unordered_map<void *, size_t> GUSMAllocations;
+
+size_t timeStamp() {
+  return chrono::duration_cast<chrono::nanoseconds>(
+             chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void KernelTotals::writeComplete(std::string_view Name, std::string_view,
+                                 size_t, size_t, size_t Begin, size_t End) {
+  std::lock_guard<std::mutex> Lock(MMutex);
+  auto [It, New] = MKernels.try_emplace(std::string(Name), nullptr);
+  if (New) {
+    uint32_t Index = GStats->MNumKernels.load(std::memory_order_relaxed);
+    if (Index < MaxKernels) {
+      kernel_stats &Kernel = GStats->MKernels[Index];
+      size_t Length = std::min(Name.size(), MaxKernelName - 1);
+      std::memcpy(Kernel.MName, Name.data(), Length);
+      Kernel.MName[Length] = '\0';
+      GStats->MNumKernels.store(Index + 1, std::memory_order_release);
+      It->second = &Kernel;
+    } else {
+      It->second = &GStats->MKernels[MaxKernels - 1];
+      std::strcpy(It->second->MName, "(other kernels)");
+    }
+  }
+  It->second->MCount.fetch_add(1, std::memory_order_relaxed);
+  It->second->MDeviceNs.fetch_add(End - Begin, std::memory_order_relaxed);
+}
+
+void addUSMAllocation(std::optional<pi_result> Result, void **Ptr,
+                      size_t Size) {
+  if (Result != PI_SUCCESS || !Ptr || !*Ptr)
+    return;
+  std::lock_guard<std::mutex> Lock(GUSMMutex);
+  GUSMAllocations[*Ptr] = Size;
+  GStats->MUSMBytes.fetch_add(Size, std::memory_order_relaxed);
+  GStats->MUSMAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void initialize() {
+  GStats = mapSegment(getpid(), /*Create=*/true);
+  if (!GStats)
+    return;
+  GStats->MVersion = StatsVersion;
+  GStats->MPID = getpid();
+  // The reader ignores the segment until the magic is set.
+  std::atomic_thread_fence(std::memory_order_release);
+  GStats->MMagic = StatsMagic;
+
+  GArgHandler = new sycl::xpti_helpers::PiArgumentsHandler();
+  GArgHandler->set_piextUSMHostAlloc(
+      [](const pi_plugin &, std::optional<pi_result> Result, void **Ptr,
+         pi_context, pi_usm_mem_properties *, size_t Size,
+         pi_uint32) { addUSMAllocation(Result, Ptr, Size); });
+  auto OnDeviceAlloc = [](const pi_plugin &, std::optional<pi_result> Result,
+                          void **Ptr, pi_context, pi_device,
+                          pi_usm_mem_properties *, size_t Size, pi_uint32) {
+    addUSMAllocation(Result, Ptr, Size);
+  };
+  GArgHandler->set_piextUSMDeviceAlloc(OnDeviceAlloc);
+  GArgHandler->set_piextUSMSharedAlloc(OnDeviceAlloc);
+  GArgHandler->set_piextUSMFree([](const pi_plugin &,
+                                   std::optional<pi_result> Result, pi_context,
+                                   void *Ptr) {
+    if (Result != PI_SUCCESS)
+      return;
+    std::lock_guard<std::mutex> Lock(GUSMMutex);
+    auto It = GUSMAllocations.find(Ptr);
+    if (It == GUSMAllocations.end())
+      return;
+    GStats->MUSMBytes.fetch_sub(It->second, std::memory_order_relaxed);
+    GUSMAllocations.erase(It);
+  });
+
+  if (std::getenv("SYCL_TOP_DEVICE_TIME")) {
+    GTotals = new KernelTotals();
+    GTimeline = new KernelTimeline(*GTotals, timeStamp);
+    GStats->MDeviceTime.store(true, std::memory_order_relaxed);
+  }
+}
+} // namespace
+
+XPTI_CALLBACK_API void metricsCallback(uint16_t, xpti::trace_event_data_t *,
+                                       xpti::trace_event_data_t *, uint64_t,
+                                       const void *UserData);
+XPTI_CALLBACK_API void taskBeginEndCallback(uint16_t TraceType,
+                                            xpti::trace_event_data_t *,
+                                            xpti::trace_event_data_t *,
+                                            uint64_t, const void *);
+XPTI_CALLBACK_API void piArgsCallback(uint16_t TraceType,
+                                      xpti::trace_event_data_t *,
+                                      xpti::trace_event_data_t *, uint64_t,
+                                      const void *UserData);
+
+XPTI_CALLBACK_API void xptiTraceInit(unsigned int /*major_version*/,
+                                     unsigned int /*minor_version*/,
+                                     const char * /*version_str*/,
+                                     const char *StreamName) {
+  static std::once_flag Initialized;
+  std::call_once(Initialized, initialize);
+  if (!GStats)
+    return;
+
+  std::string_view NameView{StreamName};
+  if (NameView == "sycl.experimental.metrics") {
+    uint8_t StreamID = xptiRegisterStream(StreamName);
+    xptiRegisterCallback(
+        StreamID, static_cast<uint16_t>(xpti::trace_point_type_t::signal),
+        metricsCallback);
+  } else if (NameView == "sycl.pi.debug") {
+    uint8_t StreamID = xptiRegisterStream(StreamName);
+    xptiRegisterCallback(StreamID, xpti::trace_function_with_args_begin,
+                         piArgsCallback);
+    xptiRegisterCallback(StreamID, xpti::trace_function_with_args_end,
+                         piArgsCallback);
+  } else if (NameView == "sycl" && GTimeline) {
+    uint8_t StreamID = xptiRegisterStream(StreamName);
+    xptiRegisterCallback(StreamID, xpti::trace_task_begin,
+                         taskBeginEndCallback);
+    xptiRegisterCallback(StreamID, xpti::trace_task_end, taskBeginEndCallback);
+  }
+}
+
+XPTI_CALLBACK_API void xptiTraceFinish(const char *) {
+  if (GTimeline)
+    GTimeline->finish();
+  // The segment stays mapped, but a process which is gone is not listed.
+  if (GStats)
+    shm_unlink(getSegmentName(GStats->MPID).c_str());
+}
+
+XPTI_CALLBACK_API void metricsCallback(uint16_t, xpti::trace_event_data_t *,
+                                       xpti::trace_event_data_t *, uint64_t,
+                                       const void *UserData) {
+  if (!UserData)
+    return;
+  const auto &Snapshot =
+      *static_cast<const sycl::detail::MetricsSnapshot *>(UserData);
+  for (size_t I = 0; I < NumMetrics; ++I) {
+    const sycl::detail::MetricSummary &Summary = Snapshot.MSummaries[I];
+    metric_stats &Stats = GStats->MMetrics[I];
+    Stats.MCount.store(Summary.MCount, std::memory_order_relaxed);
+    Stats.MTotalNs.store(Summary.MTotalNs, std::memory_order_relaxed);
+    Stats.MP99Ns.store(Summary.MP99Ns, std::memory_order_relaxed);
+  }
+  GStats->MHostTaskPoolSize.store(Snapshot.MHostTaskPoolSize,
+                                  std::memory_order_relaxed);
+  GStats->MUpdateNs.store(timeStamp(), std::memory_order_release);
+}
+
+XPTI_CALLBACK_API void taskBeginEndCallback(uint16_t TraceType,
+                                            xpti::trace_event_data_t *,
+                                            xpti::trace_event_data_t *Event,
+                                            uint64_t, const void *) {
+  if (TraceType == xpti::trace_task_end) {
+    GTimeline->taskEnd();
+    return;
+  }
+  std::string_view Name = "unknown";
+  for (auto &Item : *xptiQueryMetadata(Event))
+    if (std::string_view{xptiLookupString(Item.first)} == "kernel_name")
+      Name = xptiLookupString(Item.second);
+  GTimeline->taskBegin(Event->unique_id, Name);
+}
+
+XPTI_CALLBACK_API void piArgsCallback(uint16_t TraceType,
+                                      xpti::trace_event_data_t *,
+                                      xpti::trace_event_data_t *, uint64_t,
+                                      const void *UserData) {
+  const auto *Data = static_cast<const xpti::function_with_args_t *>(UserData);
+  if (TraceType == xpti::trace_function_with_args_end)
+    GArgHandler->handle(Data->function_id,
+                        *static_cast<const pi_plugin *>(Data->user_data),
+                        *static_cast<pi_result *>(Data->ret_data),
+                        Data->args_data);
+  if (GTimeline)
+    GTimeline->functionWithArgs(TraceType, Data, getpid(), 0);
+}
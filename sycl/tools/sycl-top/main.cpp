@@ -0,0 +1,308 @@
+//==------------ main.cpp - SYCL Top Tool ----------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "launch.hpp"
+#include "shared_stats.hpp"
+#include "llvm/Support/CommandLine.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <signal.h>
+
+using namespace llvm;
+using namespace sycl_top;
+
+namespace {
+/// A copy of the counters of a process, taken at MTime.
+struct reading {
+  uint64_t MTime = 0;
+  uint64_t MUpdateNs = 0;
+  uint64_t MCount[NumMetrics] = {};
+  uint64_t MTotalNs[NumMetrics] = {};
+  uint64_t MP99Ns[NumMetrics] = {};
+  uint32_t MPoolSize = 0;
+  int64_t MUSMBytes = 0;
+  uint64_t MUSMAllocations = 0;
+  bool MDeviceTime = false;
+  std::vector<std::pair<std::string, uint64_t>> MKernelNs;
+};
+
+/// The rates derived from the metrics, kept until the next update of the
+/// metrics of the process.
+struct rates {
+  double MSubmissions = 0;
+  double MGraphBuildMs = 0;
+  double MProgramBuildMs = 0;
+  double MHitRate = -1;
+  double MOccupancy = -1;
+};
+
+struct process {
+  reading MLast;
+  rates MRates;
+  bool MSeen = false;
+};
+
+uint64_t now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+bool isAlive(unsigned PID) { return kill(PID, 0) == 0 || errno == EPERM; }
+
+std::vector<unsigned> findProcesses() {
+  std::vector<unsigned> PIDs;
+  DIR *Dir = opendir("/dev/shm");
+  if (!Dir)
+    return PIDs;
+  const std::string Prefix = SegmentPrefix;
+  while (dirent *Entry = readdir(Dir)) {
+    std::string Name = Entry->d_name;
+    if (Name.compare(0, Prefix.size(), Prefix) != 0)
+      continue;
+    char *End = nullptr;
+    unsigned long PID = std::strtoul(Name.c_str() + Prefix.size(), &End, 10);
+    if (*End != '\0' || !PID)
+      continue;
+    // The segments of the processes which were killed are left behind.
+    if (!isAlive(PID)) {
+      shm_unlink(getSegmentName(PID).c_str());
+      continue;
+    }
+    PIDs.push_back(PID);
+  }
+  closedir(Dir);
+  std::sort(PIDs.begin(), PIDs.end());
+  return PIDs;
+}
+
+bool read(unsigned PID, reading &Out) {
+  const shared_stats *Stats = mapSegment(PID, /*Create=*/false);
+  if (!Stats)
+    return false;
+  bool Valid = Stats->MMagic == StatsMagic && Stats->MVersion == StatsVersion;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (Valid) {
+    Out.MTime = now();
+    Out.MUpdateNs = Stats->MUpdateNs.load(std::memory_order_acquire);
+    for (size_t I = 0; I < NumMetrics; ++I) {
+      const metric_stats &Metric = Stats->MMetrics[I];
+      Out.MCount[I] = Metric.MCount.load(std::memory_order_relaxed);
+      Out.MTotalNs[I] = Metric.MTotalNs.load(std::memory_order_relaxed);
+      Out.MP99Ns[I] = Metric.MP99Ns.load(std::memory_order_relaxed);
+    }
+    Out.MPoolSize = Stats->MHostTaskPoolSize.load(std::memory_order_relaxed);
+    Out.MUSMBytes = Stats->MUSMBytes.load(std::memory_order_relaxed);
+    Out.MUSMAllocations =
+        Stats->MUSMAllocations.load(std::memory_order_relaxed);
+    Out.MDeviceTime = Stats->MDeviceTime.load(std::memory_order_relaxed);
+    uint32_t NumKernels = std::min<uint32_t>(
+        Stats->MNumKernels.load(std::memory_order_acquire), MaxKernels);
+    Out.MKernelNs.clear();
+    for (uint32_t I = 0; I < NumKernels; ++I) {
+      const kernel_stats &Kernel = Stats->MKernels[I];
+      Out.MKernelNs.emplace_back(
+          std::string(Kernel.MName, strnlen(Kernel.MName, MaxKernelName)),
+          Kernel.MDeviceNs.load(std::memory_order_relaxed));
+    }
+  }
+  unmapSegment(Stats);
+  return Valid;
+}
+
+void updateRates(const reading &Last, const reading &Current, rates &Out) {
+  if (Current.MUpdateNs <= Last.MUpdateNs || !Last.MUpdateNs)
+    return;
+  double Seconds = (Current.MUpdateNs - Last.MUpdateNs) / 1e9;
+  auto Count = [&](metric_index I) {
+    return double(Current.MCount[I] - Last.MCount[I]);
+  };
+  auto TotalNs = [&](metric_index I) {
+    return double(Current.MTotalNs[I] - Last.MTotalNs[I]);
+  };
+  Out.MSubmissions = Count(SubmitLatency) / Seconds;
+  Out.MGraphBuildMs = TotalNs(GraphBuild) / 1e6 / Seconds;
+  Out.MProgramBuildMs = TotalNs(ProgramBuild) / 1e6 / Seconds;
+  Out.MHitRate = Count(KernelCacheLookup)
+                     ? std::max(0.0, 1 - Count(ProgramBuild) /
+                                             Count(KernelCacheLookup))
+                     : -1;
+  Out.MOccupancy = Current.MPoolSize ? TotalNs(HostTask) / 1e9 / Seconds /
+                                           Current.MPoolSize
+                                     : -1;
+}
+
+void print(unsigned PID, const process &Process, const reading &Previous,
+           size_t TopKernels) {
+  const reading &Current = Process.MLast;
+  const rates &Rates = Process.MRates;
+  char Line[256];
+  std::snprintf(Line, sizeof(Line),
+                "PID %-8u submit %9.1f/s  p99 %8.1f us  graph build %7.2f "
+                "ms/s  JIT %7.2f ms/s",
+                PID, Rates.MSubmissions, Current.MP99Ns[SubmitLatency] / 1e3,
+                Rates.MGraphBuildMs, Rates.MProgramBuildMs);
+  std::cout << Line << "\n";
+
+  std::string HitRate = "-", Occupancy = "-";
+  if (Rates.MHitRate >= 0) {
+    std::snprintf(Line, sizeof(Line), "%.1f%%", Rates.MHitRate * 100);
+    HitRate = Line;
+  }
+  if (Rates.MOccupancy >= 0) {
+    std::snprintf(Line, sizeof(Line), "%.0f%% of %u threads",
+                  Rates.MOccupancy * 100, Current.MPoolSize);
+    Occupancy = Line;
+  }
+  std::snprintf(Line, sizeof(Line),
+                "             kernel cache hits %s  USM %.1f MiB (%llu "
+                "allocations)  host tasks %s",
+                HitRate.c_str(), Current.MUSMBytes / (1024.0 * 1024.0),
+                static_cast<unsigned long long>(Current.MUSMAllocations),
+                Occupancy.c_str());
+  std::cout << Line << "\n";
+
+  if (!Current.MDeviceTime || !TopKernels)
+    return;
+  // The device time is read on every refresh, as it does not depend on the
+  // updates of the metrics.
+  double Seconds = (Current.MTime - Previous.MTime) / 1e9;
+  std::vector<std::pair<double, const std::string *>> Kernels;
+  for (size_t I = 0; I < Current.MKernelNs.size(); ++I) {
+    uint64_t Before =
+        I < Previous.MKernelNs.size() ? Previous.MKernelNs[I].second : 0;
+    uint64_t DeviceNs = Current.MKernelNs[I].second - Before;
+    if (DeviceNs && Seconds > 0)
+      Kernels.emplace_back(DeviceNs / 1e6 / Seconds,
+                           &Current.MKernelNs[I].first);
+  }
+  std::sort(Kernels.begin(), Kernels.end(),
+            [](const auto &A, const auto &B) { return A.first > B.first; });
+  if (Kernels.size() > TopKernels)
+    Kernels.resize(TopKernels);
+  for (const auto &[Ms, Name] : Kernels) {
+    std::snprintf(Line, sizeof(Line), "             %9.2f ms/s  ", Ms);
+    std::cout << Line << *Name << "\n";
+  }
+}
+
+int monitor(unsigned OnlyPID, unsigned Interval, unsigned Iterations,
+            size_t TopKernels) {
+  std::map<unsigned, process> Processes;
+  bool Terminal = isatty(STDOUT_FILENO);
+  for (unsigned Iteration = 0; !Iterations || Iteration < Iterations;
+       ++Iteration) {
+    if (Iteration)
+      std::this_thread::sleep_for(std::chrono::seconds(Interval));
+    std::vector<unsigned> PIDs =
+        OnlyPID ? std::vector<unsigned>{OnlyPID} : findProcesses();
+
+    if (Terminal)
+      std::cout << "\033[H\033[2J";
+    std::cout << "sycl-top - " << PIDs.size() << " SYCL process"
+              << (PIDs.size() == 1 ? "" : "es") << "\n\n";
+    std::map<unsigned, process> Current;
+    for (unsigned PID : PIDs) {
+      process &Process = Current[PID];
+      auto Last = Processes.find(PID);
+      if (Last != Processes.end())
+        Process = Last->second;
+      reading Previous = Process.MLast;
+      if (!read(PID, Process.MLast)) {
+        Current.erase(PID);
+        continue;
+      }
+      if (Process.MSeen)
+        updateRates(Previous, Process.MLast, Process.MRates);
+      else
+        Previous = Process.MLast;
+      Process.MSeen = true;
+      print(PID, Process, Previous, TopKernels);
+      std::cout << "\n";
+    }
+    std::cout.flush();
+    Processes = std::move(Current);
+
+    if (OnlyPID && Processes.empty()) {
+      std::cerr << "No statistics for process " << OnlyPID << "\n";
+      return 1;
+    }
+  }
+  return 0;
+}
+} // namespace
+
+int main(int argc, char **argv, char *env[]) {
+  cl::opt<unsigned> PID(
+      "p", cl::desc("Only show the process with this PID"),
+      cl::value_desc("pid"), cl::init(0));
+  cl::opt<unsigned> Interval("d", cl::desc("Refresh interval in seconds"),
+                             cl::value_desc("seconds"), cl::init(1));
+  cl::opt<unsigned> Iterations(
+      "n", cl::desc("Stop after this many refreshes, 0 to run until killed"),
+      cl::init(0));
+  cl::opt<unsigned> TopKernels(
+      "kernels", cl::desc("Number of kernels shown by device time"),
+      cl::init(10));
+  cl::opt<bool> DeviceTime(
+      "device-time",
+      cl::desc("Collect the device time of the kernels of the launched "
+               "application. Its queues are created with profiling enabled"));
+  cl::opt<std::string> TargetExecutable(
+      cl::Positional, cl::desc("<target executable>"));
+  cl::list<std::string> Argv(cl::ConsumeAfter,
+                             cl::desc("<program arguments>..."));
+
+  cl::ParseCommandLineOptions(argc, argv);
+
+  // Without a target, the processes already started by sycl-top are shown.
+  if (TargetExecutable.empty())
+    return monitor(PID, std::max(1u, unsigned(Interval)), Iterations,
+                   TopKernels);
+
+  std::vector<std::string> NewEnv;
+
+  {
+    size_t I = 0;
+    while (env[I] != nullptr)
+      NewEnv.emplace_back(env[I++]);
+  }
+
+  if (DeviceTime)
+    NewEnv.push_back("SYCL_TOP_DEVICE_TIME=1");
+  NewEnv.push_back("XPTI_FRAMEWORK_DISPATCHER=libxptifw.so");
+  NewEnv.push_back("XPTI_SUBSCRIBERS=libsycl_top_collector.so");
+  NewEnv.push_back("XPTI_TRACE_ENABLE=1");
+
+  std::vector<std::string> Args;
+
+  Args.push_back(TargetExecutable);
+  std::copy(Argv.begin(), Argv.end(), std::back_inserter(Args));
+
+  int Err = launch(TargetExecutable, Args, NewEnv);
+
+  if (Err) {
+    std::cerr << "Failed to launch target application. Error code " << Err
+              << "\n";
+    return Err;
+  }
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+//==------------ shared_stats.hpp - SYCL Top Tool --------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace sycl_top {
+/// The counters of the runtime metrics, in the order of detail::MetricKind.
+enum metric_index : size_t {
+  SubmitLatency,
+  GraphBuild,
+  KernelCacheLookup,
+  PluginEnqueue,
+  ProgramBuild,
+  HostTask,
+  NumMetrics
+};
+
+inline constexpr uint64_t StatsMagic = 0x706f742d6c637973; // "sycl-top"
+inline constexpr uint32_t StatsVersion = 1;
+inline constexpr size_t MaxKernels = 128;
+inline constexpr size_t MaxKernelName = 120;
+
+struct metric_stats {
+  std::atomic<uint64_t> MCount;
+  std::atomic<uint64_t> MTotalNs;
+  std::atomic<uint64_t> MP99Ns;
+};
+
+/// The name is written once, before the entry is counted in MNumKernels.
+struct kernel_stats {
+  char MName[MaxKernelName];
+  std::atomic<uint64_t> MCount;
+  std::atomic<uint64_t> MDeviceNs;
+};
+
+/// The statistics of a SYCL process, which its collector keeps in a shared
+/// memory segment named after its PID. The counters are totals since the
+/// start of the process; the reader computes the rates from two readings.
+/// The fields are updated one by one, so a reading may mix two updates.
+struct shared_stats {
+  uint64_t MMagic;
+  uint32_t MVersion;
+  uint32_t MPID;
+  /// Time stamp of steady_clock of the last update of the metrics
+  std::atomic<uint64_t> MUpdateNs;
+  metric_stats MMetrics[NumMetrics];
+  std::atomic<uint32_t> MHostTaskPoolSize;
+  /// USM memory currently allocated through the plugins, which includes the
+  /// slabs of the pooled small allocations
+  std::atomic<int64_t> MUSMBytes;
+  std::atomic<uint64_t> MUSMAllocations;
+  /// Set if the device time of the kernels is collected
+  std::atomic<bool> MDeviceTime;
+  std::atomic<uint32_t> MNumKernels;
+  /// Kernels beyond MaxKernels are added to the last entry
+  kernel_stats MKernels[MaxKernels];
+};
+
+inline std::string getSegmentName(unsigned PID) {
+  return "/sycl-top." + std::to_string(PID);
+}
+
+/// Prefix of the names of the segments in /dev/shm
+inline constexpr const char *SegmentPrefix = "sycl-top.";
+
+/// @returns the segment of PID mapped in memory, created if Create is set, or
+/// nullptr if it cannot be opened.
+inline shared_stats *mapSegment(unsigned PID, bool Create) {
+  std::string Name = getSegmentName(PID);
+  int FD = shm_open(Name.c_str(), Create ? O_CREAT | O_RDWR : O_RDONLY, 0600);
+  if (FD < 0)
+    return nullptr;
+  if (Create && ftruncate(FD, sizeof(shared_stats)) != 0) {
+    close(FD);
+    shm_unlink(Name.c_str());
+    return nullptr;
+  }
+  void *Addr = mmap(nullptr, sizeof(shared_stats),
+                    Create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, FD,
+                    0);
+  close(FD);
+  if (Addr == MAP_FAILED)
+    return nullptr;
+  return static_cast<shared_stats *>(Addr);
+}
+
+inline void unmapSegment(const shared_stats *Stats) {
+  munmap(const_cast<shared_stats *>(Stats), sizeof(shared_stats));
+}
+} // namespace sycl_top
@@ -58,32 +58,27 @@ private:
       return;
     }
 
-    for (const auto &Alloc : GS.ActivePointers) {
-      const void *Begin = Alloc.first;
+    if (const auto *Alloc = GS.findAllocation(PtrToValidate)) {
       const void *End =
-          static_cast<const char *>(Alloc.first) + Alloc.second.Length;
-
-      if (PtrToValidate >= Begin && PtrToValidate <= End) {
-        PointerFound = true;
-        const void *CopyRegionEnd =
-            static_cast<const char *>(PtrToValidate) + size;
-        if (CopyRegionEnd > End) {
-          OutStream << std::endl;
-          OutStream << PrintPrefix << "Requested " << FunctionName
-                    << " range exceeds allocated USM memory size for "
-                    << ParameterDesc << ".\n";
-          OutStream << PrintIndentation << "Allocation location: ";
-          OutStream << " function " << Alloc.second.Location.Function << " at ";
-          OutStream << Alloc.second.Location.Source << ":"
-                    << Alloc.second.Location.Line << "\n";
-          OutStream << PrintIndentation << FunctionName << " location: ";
-          OutStream << " function " << GS.LastTracepoint.Function << " at ";
-          OutStream << GS.LastTracepoint.Source << ":" << GS.LastTracepoint.Line
-                    << std::endl;
-          if (GS.TerminateOnError)
-            std::terminate();
-        }
-        break;
+          static_cast<const char *>(Alloc->first) + Alloc->second.Length;
+      PointerFound = true;
+      const void *CopyRegionEnd =
+          static_cast<const char *>(PtrToValidate) + size;
+      if (CopyRegionEnd > End) {
+        OutStream << std::endl;
+        OutStream << PrintPrefix << "Requested " << FunctionName
+                  << " range exceeds allocated USM memory size for "
+                  << ParameterDesc << ".\n";
+        OutStream << PrintIndentation << "Allocation location: ";
+        OutStream << " function " << Alloc->second.Location.Function << " at ";
+        OutStream << Alloc->second.Location.Source << ":"
+                  << Alloc->second.Location.Line << "\n";
+        OutStream << PrintIndentation << FunctionName << " location: ";
+        OutStream << " function " << GS.LastTracepoint.Function << " at ";
+        OutStream << GS.LastTracepoint.Source << ":" << GS.LastTracepoint.Line
+                  << std::endl;
+        if (GS.TerminateOnError)
+          std::terminate();
       }
     }
 
@@ -136,32 +131,27 @@ private:
       return;
     }
 
-    for (const auto &Alloc : GS.ActivePointers) {
-      const void *Begin = Alloc.first;
+    if (const auto *Alloc = GS.findAllocation(PtrToValidate)) {
       const void *End =
-          static_cast<const char *>(Alloc.first) + Alloc.second.Length;
-      if (PtrToValidate >= Begin && PtrToValidate <= End) {
-        PointerFound = true;
-        const void *CopyRegionEnd =
-            static_cast<const char *>(PtrToValidate) + pitch * length;
-        if (CopyRegionEnd > End) {
-          OutStream << std::endl;
-          OutStream << PrintPrefix << "Requested " << FunctionName
-                    << " range exceeds allocated USM memory size for "
-                    << ParameterDesc << ".\n";
-          OutStream << PrintIndentation << "Allocation location: ";
-          OutStream << " function " << Alloc.second.Location.Function << " at ";
-          OutStream << Alloc.second.Location.Source << ":"
-                    << Alloc.second.Location.Line << "\n";
-          OutStream << PrintIndentation << FunctionName << " location: ";
-          OutStream << " function " << GS.LastTracepoint.Function << " at ";
-          OutStream << GS.LastTracepoint.Source << ":" << GS.LastTracepoint.Line
-                    << std::endl;
-          if (GS.TerminateOnError)
-            std::terminate();
-        }
-
-        break;
+          static_cast<const char *>(Alloc->first) + Alloc->second.Length;
+      PointerFound = true;
+      const void *CopyRegionEnd =
+          static_cast<const char *>(PtrToValidate) + pitch * length;
+      if (CopyRegionEnd > End) {
+        OutStream << std::endl;
+        OutStream << PrintPrefix << "Requested " << FunctionName
+                  << " range exceeds allocated USM memory size for "
+                  << ParameterDesc << ".\n";
+        OutStream << PrintIndentation << "Allocation location: ";
+        OutStream << " function " << Alloc->second.Location.Function << " at ";
+        OutStream << Alloc->second.Location.Source << ":"
+                  << Alloc->second.Location.Line << "\n";
+        OutStream << PrintIndentation << FunctionName << " location: ";
+        OutStream << " function " << GS.LastTracepoint.Function << " at ";
+        OutStream << GS.LastTracepoint.Source << ":" << GS.LastTracepoint.Line
+                  << std::endl;
+        if (GS.TerminateOnError)
+          std::terminate();
       }
     }
     if (!PointerFound) {
@@ -178,6 +168,18 @@ private:
     }
   }
 
+  // Finds the live allocation containing Ptr, or ending at Ptr, in
+  // logarithmic time since the allocations do not overlap.
+  const std::pair<void *const, AllocationInfo> *
+  findAllocation(const void *Ptr) const {
+    auto It = ActivePointers.upper_bound(const_cast<void *>(Ptr));
+    if (It == ActivePointers.begin())
+      return nullptr;
+    --It;
+    const void *End = static_cast<const char *>(It->first) + It->second.Length;
+    return Ptr <= End ? &*It : nullptr;
+  }
+
   static constexpr char PrintPrefix[] = "[USM] ";
   static constexpr char PrintIndentation[] = "      | ";
   bool PrintToError = false;
@@ -230,6 +232,7 @@ public:
         USMAnalyzer::handleUSMEnqueueMemcpy2D);
     ArgHandlerPreCall.set_piextKernelSetArgPointer(
         USMAnalyzer::handleKernelSetArgPointer);
+    ArgHandlerPreCall.set_piextKernelSetArgs(USMAnalyzer::handleKernelSetArgs);
   }
 
   void fillLastTracepointData(const xpti::trace_event_data_t *ObjectEvent) {
@@ -313,39 +316,35 @@ public:
                                     const pi_mem_properties *) {
     auto &GS = USMAnalyzer::getInstance();
     auto &OutStream = GS.getOutStream();
-    for (const auto &Alloc : GS.ActivePointers) {
-      const void *Begin = Alloc.first;
+    // Host pointer was allocated with USM APIs
+    if (const auto *Alloc = GS.findAllocation(HostPtr)) {
       const void *End =
-          static_cast<const char *>(Alloc.first) + Alloc.second.Length;
-      // Host pointer was allocated with USM APIs
-      if (HostPtr >= Begin && HostPtr <= End) {
-        bool NeedsTerminate = false;
-        if (Alloc.second.Kind != AllocKind::host) {
-          OutStream << PrintPrefix
-                    << "Attempt to construct a buffer with non-host pointer.\n";
-          NeedsTerminate = true;
-        }
-
-        const void *HostEnd = static_cast<char *>(HostPtr) + Size;
-        if (HostEnd > End) {
-          OutStream << PrintPrefix
-                    << "Buffer size exceeds allocated host memory size.\n";
-          NeedsTerminate = true;
-        }
-
-        if (NeedsTerminate) {
-          OutStream << PrintIndentation << "Allocation location: ";
-          OutStream << " function " << Alloc.second.Location.Function << " at ";
-          OutStream << Alloc.second.Location.Source << ":"
-                    << Alloc.second.Location.Line << "\n";
-          OutStream << PrintIndentation << "Buffer location: ";
-          OutStream << " function " << GS.LastTracepoint.Function << " at ";
-          OutStream << GS.LastTracepoint.Source << ":" << GS.LastTracepoint.Line
-                    << "\n";
-          if (GS.TerminateOnError)
-            std::terminate();
-        }
-        break;
+          static_cast<const char *>(Alloc->first) + Alloc->second.Length;
+      bool NeedsTerminate = false;
+      if (Alloc->second.Kind != AllocKind::host) {
+        OutStream << PrintPrefix
+                  << "Attempt to construct a buffer with non-host pointer.\n";
+        NeedsTerminate = true;
+      }
+
+      const void *HostEnd = static_cast<char *>(HostPtr) + Size;
+      if (HostEnd > End) {
+        OutStream << PrintPrefix
+                  << "Buffer size exceeds allocated host memory size.\n";
+        NeedsTerminate = true;
+      }
+
+      if (NeedsTerminate) {
+        OutStream << PrintIndentation << "Allocation location: ";
+        OutStream << " function " << Alloc->second.Location.Function << " at ";
+        OutStream << Alloc->second.Location.Source << ":"
+                  << Alloc->second.Location.Line << "\n";
+        OutStream << PrintIndentation << "Buffer location: ";
+        OutStream << " function " << GS.LastTracepoint.Function << " at ";
+        OutStream << GS.LastTracepoint.Source << ":" << GS.LastTracepoint.Line
+                  << "\n";
+        if (GS.TerminateOnError)
+          std::terminate();
       }
     }
   }
@@ -424,4 +423,14 @@ public:
           0 /*no data how it will be used in kernel*/, "kernel");
     }
   }
+
+  static void handleKernelSetArgs(const pi_plugin &Plugin,
+                                  std::optional<pi_result> Result,
+                                  pi_kernel Kernel, pi_uint32 num_args,
+                                  const pi_kernel_arg *args) {
+    for (pi_uint32 I = 0; I < num_args; ++I)
+      if (args[I].kind == PI_KERNEL_ARG_KIND_POINTER)
+        handleKernelSetArgPointer(Plugin, Result, Kernel, args[I].index,
+                                  args[I].size, args[I].value);
+  }
 };
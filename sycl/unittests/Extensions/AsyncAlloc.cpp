@@ -0,0 +1,139 @@
+//==------------------------- AsyncAlloc.cpp -------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+#include <helpers/PiMock.hpp>
+#include <sycl/sycl.hpp>
+
+using namespace sycl;
+namespace syclex = sycl::ext::oneapi::experimental;
+
+namespace {
+size_t NumDeviceAllocs = 0;
+size_t NumFrees = 0;
+bool EventsComplete = false;
+
+pi_result redefinedUSMDeviceAlloc(void **, pi_context, pi_device,
+                                  pi_usm_mem_properties *, size_t, pi_uint32) {
+  ++NumDeviceAllocs;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedUSMFree(pi_context, void *) {
+  ++NumFrees;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedEventGetInfo(pi_event, pi_event_info ParamName, size_t,
+                                void *ParamValue, size_t *) {
+  if (ParamName == PI_EVENT_INFO_COMMAND_EXECUTION_STATUS && ParamValue &&
+      EventsComplete)
+    *static_cast<pi_event_status *>(ParamValue) = PI_EVENT_COMPLETE;
+  return PI_SUCCESS;
+}
+
+class AsyncAllocTest : public ::testing::Test {
+public:
+  AsyncAllocTest() : Mock{}, Plat{Mock.getPlatform()} {}
+
+protected:
+  void SetUp() override {
+    NumDeviceAllocs = 0;
+    NumFrees = 0;
+    EventsComplete = false;
+    Mock.redefineBefore<detail::PiApiKind::piextUSMDeviceAlloc>(
+        redefinedUSMDeviceAlloc);
+    Mock.redefineBefore<detail::PiApiKind::piextUSMFree>(redefinedUSMFree);
+    Mock.redefineAfter<detail::PiApiKind::piEventGetInfo>(
+        redefinedEventGetInfo);
+  }
+
+  unittest::PiMock Mock;
+  platform Plat;
+};
+} // namespace
+
+TEST_F(AsyncAllocTest, SameInOrderQueueReusesMemory) {
+  device Dev = Plat.get_devices()[0];
+  context Ctx{Dev};
+  queue Q{Ctx, Dev, {property::queue::in_order{}}};
+
+  void *Ptr = syclex::async_malloc(Q, 1024);
+  ASSERT_NE(Ptr, nullptr);
+  syclex::async_free(Q, Ptr);
+  // The commands using the new allocation run after the ones using the freed
+  // memory, so it is reused without waiting.
+  void *NewPtr = syclex::async_malloc(Q, 1000);
+  EXPECT_EQ(NewPtr, Ptr);
+  EXPECT_EQ(NumDeviceAllocs, 1ul);
+  syclex::async_free(Q, NewPtr);
+}
+
+TEST_F(AsyncAllocTest, OtherQueueWaitsForFreeEvent) {
+  device Dev = Plat.get_devices()[0];
+  context Ctx{Dev};
+  queue Q1{Ctx, Dev};
+  queue Q2{Ctx, Dev};
+
+  void *Ptr = syclex::async_malloc(Q1, 1024);
+  syclex::async_free(Q1, Ptr);
+  void *OtherPtr = syclex::async_malloc(Q2, 1024);
+  EXPECT_NE(OtherPtr, Ptr);
+  EXPECT_EQ(NumDeviceAllocs, 2ul);
+
+  EventsComplete = true;
+  void *ReusedPtr = syclex::async_malloc(Q2, 1024);
+  EXPECT_EQ(ReusedPtr, Ptr);
+  EXPECT_EQ(NumDeviceAllocs, 2ul);
+
+  syclex::async_free(Q2, OtherPtr);
+  syclex::async_free(Q2, ReusedPtr);
+}
+
+TEST_F(AsyncAllocTest, PoolReleaseThreshold) {
+  device Dev = Plat.get_devices()[0];
+  context Ctx{Dev};
+  queue Q{Ctx, Dev};
+  syclex::memory_pool Pool{
+      Q,
+      usm::alloc::device,
+      {syclex::property::memory_pool::release_threshold{0}}};
+  EXPECT_EQ(Pool.get_release_threshold(), 0ul);
+  EXPECT_EQ(Pool.get_context(), Ctx);
+  EXPECT_EQ(Pool.get_alloc_kind(), usm::alloc::device);
+
+  void *Ptr = syclex::async_malloc_from_pool(Q, 100, Pool);
+  EXPECT_EQ(Pool.get_used_size_current(), 256ul);
+  EXPECT_EQ(Pool.get_reserved_size_current(), 256ul);
+
+  // The memory is returned once the commands using it have completed.
+  syclex::async_free(Q, Ptr);
+  EXPECT_EQ(Pool.get_used_size_current(), 0ul);
+  EXPECT_EQ(Pool.get_reserved_size_current(), 256ul);
+  EXPECT_EQ(NumFrees, 0ul);
+
+  EventsComplete = true;
+  Pool.set_release_threshold(0);
+  EXPECT_EQ(Pool.get_reserved_size_current(), 0ul);
+  EXPECT_EQ(NumFrees, 1ul);
+}
+
+TEST_F(AsyncAllocTest, InvalidFree) {
+  device Dev = Plat.get_devices()[0];
+  context Ctx{Dev};
+  queue Q{Ctx, Dev};
+
+  void *Ptr = malloc_device(16, Q);
+  EXPECT_THROW(syclex::async_free(Q, Ptr), sycl::exception);
+  free(Ptr, Q);
+
+  queue OtherQ{Dev};
+  syclex::memory_pool Pool{Q, usm::alloc::device};
+  EXPECT_THROW(syclex::async_malloc_from_pool(OtherQ, 16, Pool),
+               sycl::exception);
+}
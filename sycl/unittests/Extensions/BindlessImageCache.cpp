@@ -0,0 +1,177 @@
+//==------------------------- BindlessImageCache.cpp -----------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+#include <helpers/PiMock.hpp>
+#include <sycl/sycl.hpp>
+
+using namespace sycl;
+namespace syclex = sycl::ext::oneapi::experimental;
+
+namespace {
+size_t NumImageCreates = 0;
+size_t NumImageDestroys = 0;
+size_t NumSamplerCreates = 0;
+
+pi_result redefinedUnsampledImageCreate(pi_context, pi_device,
+                                        pi_image_mem_handle, pi_image_format *,
+                                        pi_image_desc *, pi_mem *,
+                                        pi_image_handle *ret_handle) {
+  *ret_handle = ++NumImageCreates;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedSampledImageCreate(pi_context, pi_device,
+                                      pi_image_mem_handle, pi_image_format *,
+                                      pi_image_desc *, pi_sampler, pi_mem *,
+                                      pi_image_handle *ret_handle) {
+  *ret_handle = ++NumImageCreates;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedImageHandleDestroy(pi_context, pi_device, pi_image_handle) {
+  ++NumImageDestroys;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedSamplerCreate(pi_context, const pi_sampler_properties *,
+                                 const float, const float, const float,
+                                 pi_sampler *) {
+  ++NumSamplerCreates;
+  return PI_SUCCESS;
+}
+
+class BindlessImageCacheTest : public ::testing::Test {
+public:
+  BindlessImageCacheTest()
+      : Mock{}, Plat{Mock.getPlatform()}, Dev{Plat.get_devices()[0]},
+        Ctx{Dev} {}
+
+protected:
+  void SetUp() override {
+    NumImageCreates = 0;
+    NumImageDestroys = 0;
+    NumSamplerCreates = 0;
+    Mock.redefineBefore<detail::PiApiKind::piextMemUnsampledImageCreate>(
+        redefinedUnsampledImageCreate);
+    Mock.redefineBefore<detail::PiApiKind::piextMemSampledImageCreate>(
+        redefinedSampledImageCreate);
+    Mock.redefineBefore<
+        detail::PiApiKind::piextMemUnsampledImageHandleDestroy>(
+        redefinedImageHandleDestroy);
+    Mock.redefineBefore<detail::PiApiKind::piextMemSampledImageHandleDestroy>(
+        redefinedImageHandleDestroy);
+    Mock.redefineBefore<detail::PiApiKind::piextBindlessImageSamplerCreate>(
+        redefinedSamplerCreate);
+  }
+
+  unittest::PiMock Mock;
+  platform Plat;
+  device Dev;
+  context Ctx;
+  int Memory[2] = {};
+};
+} // namespace
+
+TEST_F(BindlessImageCacheTest, IdenticalImagesShareHandle) {
+  syclex::image_descriptor Desc({64, 64}, image_channel_order::rgba,
+                                image_channel_type::fp32);
+  syclex::image_mem_handle Mem{&Memory[0]};
+
+  syclex::unsampled_image_handle Image1 =
+      syclex::create_image(Mem, Desc, Dev, Ctx);
+  syclex::unsampled_image_handle Image2 =
+      syclex::create_image(Mem, Desc, Dev, Ctx);
+  EXPECT_EQ(Image1.raw_handle, Image2.raw_handle);
+  EXPECT_EQ(NumImageCreates, 1ul);
+
+  // Another descriptor or memory makes another image.
+  syclex::image_descriptor OtherDesc({32, 64}, image_channel_order::rgba,
+                                     image_channel_type::fp32);
+  syclex::unsampled_image_handle Image3 =
+      syclex::create_image(Mem, OtherDesc, Dev, Ctx);
+  syclex::unsampled_image_handle Image4 =
+      syclex::create_image(syclex::image_mem_handle{&Memory[1]}, Desc, Dev,
+                           Ctx);
+  EXPECT_NE(Image3.raw_handle, Image1.raw_handle);
+  EXPECT_NE(Image4.raw_handle, Image1.raw_handle);
+  EXPECT_EQ(NumImageCreates, 3ul);
+
+  // The shared handle is destroyed with its last reference.
+  syclex::destroy_image_handle(Image1, Dev, Ctx);
+  EXPECT_EQ(NumImageDestroys, 0ul);
+  syclex::destroy_image_handle(Image2, Dev, Ctx);
+  EXPECT_EQ(NumImageDestroys, 1ul);
+  syclex::destroy_image_handle(Image3, Dev, Ctx);
+  syclex::destroy_image_handle(Image4, Dev, Ctx);
+  EXPECT_EQ(NumImageDestroys, 3ul);
+
+  // A destroyed image gets a new handle.
+  syclex::unsampled_image_handle Image5 =
+      syclex::create_image(Mem, Desc, Dev, Ctx);
+  EXPECT_EQ(NumImageCreates, 4ul);
+  syclex::destroy_image_handle(Image5, Dev, Ctx);
+}
+
+TEST_F(BindlessImageCacheTest, SampledImagesShareSampler) {
+  syclex::image_descriptor Desc({64, 64}, image_channel_order::rgba,
+                                image_channel_type::fp32);
+  syclex::image_mem_handle Mem{&Memory[0]};
+  syclex::bindless_image_sampler Linear(
+      addressing_mode::clamp, coordinate_normalization_mode::normalized,
+      filtering_mode::linear);
+  syclex::bindless_image_sampler Nearest(
+      addressing_mode::clamp, coordinate_normalization_mode::normalized,
+      filtering_mode::nearest);
+
+  syclex::sampled_image_handle Image1 =
+      syclex::create_image(Mem, Linear, Desc, Dev, Ctx);
+  syclex::sampled_image_handle Image2 =
+      syclex::create_image(Mem, Linear, Desc, Dev, Ctx);
+  syclex::sampled_image_handle Image3 =
+      syclex::create_image(Mem, Nearest, Desc, Dev, Ctx);
+  syclex::sampled_image_handle Image4 = syclex::create_image(
+      syclex::image_mem_handle{&Memory[1]}, Linear, Desc, Dev, Ctx);
+  EXPECT_EQ(Image1.raw_handle, Image2.raw_handle);
+  EXPECT_NE(Image3.raw_handle, Image1.raw_handle);
+  EXPECT_EQ(NumImageCreates, 3ul);
+  EXPECT_EQ(NumSamplerCreates, 2ul);
+
+  // The unsampled image of the same memory is another image.
+  syclex::unsampled_image_handle Unsampled =
+      syclex::create_image(Mem, Desc, Dev, Ctx);
+  EXPECT_EQ(NumImageCreates, 4ul);
+
+  syclex::destroy_image_handle(Image1, Dev, Ctx);
+  syclex::destroy_image_handle(Image2, Dev, Ctx);
+  syclex::destroy_image_handle(Image3, Dev, Ctx);
+  syclex::destroy_image_handle(Image4, Dev, Ctx);
+  syclex::destroy_image_handle(Unsampled, Dev, Ctx);
+  EXPECT_EQ(NumImageDestroys, 4ul);
+}
+
+TEST_F(BindlessImageCacheTest, FreedMemoryGetsNewHandle) {
+  syclex::image_descriptor Desc({64, 64}, image_channel_order::rgba,
+                                image_channel_type::fp32);
+  syclex::image_mem_handle Mem{&Memory[0]};
+
+  syclex::unsampled_image_handle Image1 =
+      syclex::create_image(Mem, Desc, Dev, Ctx);
+  syclex::free_image_mem(Mem, syclex::image_type::standard, Dev, Ctx);
+
+  // The memory may be allocated again at the same address.
+  syclex::unsampled_image_handle Image2 =
+      syclex::create_image(Mem, Desc, Dev, Ctx);
+  EXPECT_NE(Image1.raw_handle, Image2.raw_handle);
+  EXPECT_EQ(NumImageCreates, 2ul);
+
+  // The handle of the freed memory is still destroyed.
+  syclex::destroy_image_handle(Image1, Dev, Ctx);
+  syclex::destroy_image_handle(Image2, Dev, Ctx);
+  EXPECT_EQ(NumImageDestroys, 2ul);
+}
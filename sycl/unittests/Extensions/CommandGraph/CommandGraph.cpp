@@ -425,6 +425,105 @@ TEST_F(CommandGraphTest, GraphPartitionsMerging) {
   ASSERT_FALSE(PartitionsList[4]->isHostTask());
 }
 
+TEST_F(CommandGraphTest, GraphPartitionsIndependentHostTasks) {
+  // Tests that independent host-tasks get their own partitions, ordered
+  // between the partitions of the nodes they depend on and of their successors
+  auto NodeA = Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); });
+  auto NodeHT1 = Graph.add([&](sycl::handler &cgh) { cgh.host_task([=]() {}); },
+                           {experimental::property::node::depends_on(NodeA)});
+  auto NodeHT2 = Graph.add([&](sycl::handler &cgh) { cgh.host_task([=]() {}); },
+                           {experimental::property::node::depends_on(NodeA)});
+  auto NodeB = Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); },
+      {experimental::property::node::depends_on(NodeHT1, NodeHT2)});
+  // Independent of all the host-tasks
+  auto NodeC = Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); });
+
+  auto GraphExec = Graph.finalize();
+  auto GraphExecImpl = sycl::detail::getSyclObjImpl(GraphExec);
+  auto PartitionsList = GraphExecImpl->getPartitions();
+  ASSERT_EQ(PartitionsList.size(), 4ul);
+  ASSERT_FALSE(PartitionsList[0]->isHostTask());
+  ASSERT_TRUE(PartitionsList[1]->isHostTask());
+  ASSERT_TRUE(PartitionsList[2]->isHostTask());
+  ASSERT_FALSE(PartitionsList[3]->isHostTask());
+
+  ASSERT_EQ(PartitionsList[0]->MSchedule.size(), 2ul);
+  ASSERT_EQ(PartitionsList[3]->MSchedule.size(), 1ul);
+  ASSERT_EQ(PartitionsList[3]->MSchedule.front(),
+            GraphExecImpl->getSchedule().back());
+  ASSERT_EQ(PartitionsList[3]->MPredecessors.size(), 2ul);
+  ASSERT_TRUE(PartitionsList[0]->MPredecessors.empty());
+}
+
+TEST_F(CommandGraphTest, GraphPartitionsIndependentPipelines) {
+  // Tests that the nodes following different host-tasks are not merged into
+  // one partition, so that each one only waits for its own host-task
+  auto NodeA = Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); });
+  auto NodeHT1 = Graph.add([&](sycl::handler &cgh) { cgh.host_task([=]() {}); },
+                           {experimental::property::node::depends_on(NodeA)});
+  auto NodeB = Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); },
+      {experimental::property::node::depends_on(NodeHT1)});
+  auto NodeC = Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); });
+  auto NodeHT2 = Graph.add([&](sycl::handler &cgh) { cgh.host_task([=]() {}); },
+                           {experimental::property::node::depends_on(NodeC)});
+  auto NodeD = Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); },
+      {experimental::property::node::depends_on(NodeHT2)});
+
+  auto GraphExec = Graph.finalize();
+  auto GraphExecImpl = sycl::detail::getSyclObjImpl(GraphExec);
+  auto PartitionsList = GraphExecImpl->getPartitions();
+  ASSERT_EQ(PartitionsList.size(), 5ul);
+  ASSERT_FALSE(PartitionsList[0]->isHostTask());
+  ASSERT_TRUE(PartitionsList[1]->isHostTask());
+  ASSERT_TRUE(PartitionsList[2]->isHostTask());
+  ASSERT_FALSE(PartitionsList[3]->isHostTask());
+  ASSERT_FALSE(PartitionsList[4]->isHostTask());
+
+  // Nodes without dependencies are kept together
+  ASSERT_EQ(PartitionsList[0]->MSchedule.size(), 2ul);
+  for (size_t I : {3, 4}) {
+    ASSERT_EQ(PartitionsList[I]->MSchedule.size(), 1ul);
+    ASSERT_EQ(PartitionsList[I]->MPredecessors.size(), 1ul);
+  }
+  // Each one waits for a different host-task
+  ASSERT_NE(PartitionsList[3]->MPredecessors[0],
+            PartitionsList[4]->MPredecessors[0]);
+}
+
+TEST_F(CommandGraphTest, GraphPartitionsNonRootDependencies) {
+  // Tests that a partition also depends on the partitions its nodes which are
+  // not roots depend on
+  auto NodeHT1 =
+      Graph.add([&](sycl::handler &cgh) { cgh.host_task([=]() {}); });
+  auto NodeHT2 =
+      Graph.add([&](sycl::handler &cgh) { cgh.host_task([=]() {}); });
+  auto NodeA = Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); },
+      {experimental::property::node::depends_on(NodeHT1)});
+  auto NodeB = Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); },
+      {experimental::property::node::depends_on(NodeA, NodeHT2)});
+
+  auto GraphExec = Graph.finalize();
+  auto GraphExecImpl = sycl::detail::getSyclObjImpl(GraphExec);
+  auto PartitionsList = GraphExecImpl->getPartitions();
+  ASSERT_EQ(PartitionsList.size(), 3ul);
+  ASSERT_TRUE(PartitionsList[0]->isHostTask());
+  ASSERT_TRUE(PartitionsList[1]->isHostTask());
+  ASSERT_FALSE(PartitionsList[2]->isHostTask());
+
+  ASSERT_EQ(PartitionsList[2]->MSchedule.size(), 2ul);
+  ASSERT_EQ(PartitionsList[2]->MRoots.size(), 1ul);
+  ASSERT_EQ(PartitionsList[2]->MPredecessors.size(), 2ul);
+}
+
 TEST_F(CommandGraphTest, GetNodeFromEvent) {
   // Test getting a node from a recorded event and using that as a dependency
   // for an explicit node
@@ -628,3 +727,46 @@ TEST_F(CommandGraphTest, AccessorModeEdges) {
       Queue);
   testAccessorModeCombo<access_mode::atomic, access_mode::atomic, true>(Queue);
 }
+
+static std::vector<pi_event> CommandBufferWaitList;
+static size_t CommandBufferEnqueueCounter = 0;
+static pi_result redefinedEnqueueCommandBuffer(pi_ext_command_buffer,
+                                               pi_queue, pi_uint32 NumEvents,
+                                               const pi_event *Events,
+                                               pi_event *) {
+  ++CommandBufferEnqueueCounter;
+  CommandBufferWaitList.assign(Events, Events + NumEvents);
+  return PI_SUCCESS;
+}
+
+TEST_F(CommandGraphTest, EnqueueWithNativeDepsBypassesScheduler) {
+  CommandBufferWaitList.clear();
+  CommandBufferEnqueueCounter = 0;
+  Mock.redefineBefore<sycl::detail::PiApiKind::piextEnqueueCommandBuffer>(
+      &redefinedEnqueueCommandBuffer);
+
+  Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); });
+  auto ExecGraph = Graph.finalize();
+
+  auto KernelEvent = Queue.single_task<TestKernel<>>([]() {});
+  auto KernelEventImpl = sycl::detail::getSyclObjImpl(KernelEvent);
+  ASSERT_NE(KernelEventImpl->getHandleRef(), nullptr);
+
+  auto GraphEvent = Queue.submit([&](sycl::handler &CGH) {
+    CGH.depends_on(KernelEvent);
+    CGH.ext_oneapi_graph(ExecGraph);
+  });
+  auto GraphEventImpl = sycl::detail::getSyclObjImpl(GraphEvent);
+
+  // The command buffer is enqueued directly with the native event of the
+  // dependency, without a scheduler command.
+  ASSERT_EQ(CommandBufferEnqueueCounter, 1u);
+  ASSERT_EQ(CommandBufferWaitList.size(), 1u);
+  EXPECT_EQ(CommandBufferWaitList[0], KernelEventImpl->getHandleRef());
+  EXPECT_EQ(GraphEventImpl->getCommand(), nullptr);
+  auto WaitList = GraphEventImpl->getWaitList();
+  ASSERT_EQ(WaitList.size(), 1u);
+  EXPECT_EQ(WaitList[0], KernelEventImpl);
+  Queue.wait();
+}
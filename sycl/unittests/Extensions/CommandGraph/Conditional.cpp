@@ -0,0 +1,141 @@
+//==-------------------- Conditional.cpp -----------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "Common.hpp"
+
+using namespace sycl;
+using namespace sycl::ext::oneapi;
+
+namespace {
+// Values read for the condition by the successive executions of the
+// conditional nodes, the last one being repeated.
+std::vector<int> ConditionValues;
+size_t NumConditionReads = 0;
+size_t NumCommandBufferEnqueues = 0;
+
+pi_result redefinedUSMEnqueueMemcpy(pi_queue, pi_bool, void *DstPtr,
+                                    const void *, size_t Size, pi_uint32,
+                                    const pi_event *, pi_event *) {
+  if (Size == sizeof(int) && !ConditionValues.empty()) {
+    const size_t Index =
+        std::min(NumConditionReads, ConditionValues.size() - 1);
+    *static_cast<int *>(DstPtr) = ConditionValues[Index];
+    ++NumConditionReads;
+  }
+  return PI_SUCCESS;
+}
+
+pi_result redefinedEnqueueCommandBuffer(pi_ext_command_buffer, pi_queue,
+                                        pi_uint32, const pi_event *,
+                                        pi_event *) {
+  ++NumCommandBufferEnqueues;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedUSMGetMemAllocInfo(pi_context, const void *,
+                                      pi_mem_alloc_info ParamName,
+                                      size_t ParamValueSize, void *ParamValue,
+                                      size_t *ParamValueSizeRet) {
+  if (ParamName == PI_MEM_ALLOC_TYPE) {
+    if (ParamValue) {
+      assert(ParamValueSize == sizeof(pi_usm_type));
+      *static_cast<pi_usm_type *>(ParamValue) = PI_MEM_TYPE_DEVICE;
+    }
+    if (ParamValueSizeRet)
+      *ParamValueSizeRet = sizeof(pi_usm_type);
+  }
+  return PI_SUCCESS;
+}
+
+class ConditionalNodesTest : public CommandGraphTest {
+protected:
+  void SetUp() override {
+    ConditionValues.clear();
+    NumConditionReads = 0;
+    NumCommandBufferEnqueues = 0;
+    Mock.redefineAfter<detail::PiApiKind::piextUSMGetMemAllocInfo>(
+        redefinedUSMGetMemAllocInfo);
+    Mock.redefineBefore<detail::PiApiKind::piextUSMEnqueueMemcpy>(
+        redefinedUSMEnqueueMemcpy);
+    Mock.redefineBefore<detail::PiApiKind::piextEnqueueCommandBuffer>(
+        redefinedEnqueueCommandBuffer);
+  }
+
+  experimental::command_graph<experimental::graph_state::executable>
+  makeBody() {
+    experimental::command_graph Body{Queue.get_context(), Dev};
+    Body.add(
+        [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); });
+    return Body.finalize();
+  }
+};
+} // namespace
+
+TEST_F(ConditionalNodesTest, NodeTypesAndPartitions) {
+  int *Condition = malloc_device<int>(1, Queue);
+  auto Body = makeBody();
+
+  auto NodeA = Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); });
+  auto NodeIf = Graph.add_if(
+      Condition, Body, {experimental::property::node::depends_on(NodeA)});
+  auto NodeWhile = Graph.add_while(
+      Condition, Body, {experimental::property::node::depends_on(NodeIf)});
+  ASSERT_EQ(NodeIf.get_type(), experimental::node_type::ext_oneapi_if);
+  ASSERT_EQ(NodeWhile.get_type(), experimental::node_type::ext_oneapi_while);
+
+  // The conditions are evaluated on the host, so each conditional node has a
+  // partition of its own
+  auto GraphExec = Graph.finalize();
+  auto GraphExecImpl = sycl::detail::getSyclObjImpl(GraphExec);
+  auto PartitionsList = GraphExecImpl->getPartitions();
+  ASSERT_EQ(PartitionsList.size(), 3ul);
+  ASSERT_FALSE(PartitionsList[0]->isHostTask());
+  ASSERT_TRUE(PartitionsList[1]->isHostTask());
+  ASSERT_TRUE(PartitionsList[2]->isHostTask());
+
+  free(Condition, Queue);
+}
+
+TEST_F(ConditionalNodesTest, WhileExecutesBodyUntilConditionIsZero) {
+  int *Condition = malloc_device<int>(1, Queue);
+  Graph.add_while(Condition, makeBody());
+  auto GraphExec = Graph.finalize();
+
+  ConditionValues = {1, 1, 1, 0};
+  Queue.ext_oneapi_graph(GraphExec).wait();
+  EXPECT_EQ(NumConditionReads, 4ul);
+  EXPECT_EQ(NumCommandBufferEnqueues, 3ul);
+
+  free(Condition, Queue);
+}
+
+TEST_F(ConditionalNodesTest, IfExecutesBodyOnce) {
+  int *Condition = malloc_device<int>(1, Queue);
+  Graph.add_if(Condition, makeBody());
+  auto GraphExec = Graph.finalize();
+
+  ConditionValues = {1};
+  Queue.ext_oneapi_graph(GraphExec).wait();
+  EXPECT_EQ(NumConditionReads, 1ul);
+  EXPECT_EQ(NumCommandBufferEnqueues, 1ul);
+
+  ConditionValues = {0};
+  NumConditionReads = 0;
+  Queue.ext_oneapi_graph(GraphExec).wait();
+  EXPECT_EQ(NumConditionReads, 1ul);
+  EXPECT_EQ(NumCommandBufferEnqueues, 1ul);
+
+  free(Condition, Queue);
+}
+
+TEST_F(ConditionalNodesTest, InvalidCondition) {
+  auto Body = makeBody();
+  ASSERT_THROW(Graph.add_if(nullptr, Body), sycl::exception);
+  ASSERT_THROW(Graph.add_while(nullptr, Body), sycl::exception);
+}
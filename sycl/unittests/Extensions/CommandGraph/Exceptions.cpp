@@ -534,3 +534,22 @@ TEST_F(CommandGraphTest, ProfilingException) {
         std::string::npos);
   }
 }
+
+TEST_F(CommandGraphTest, FusionWithUpdatableException) {
+  // Fused nodes can't be matched with the nodes of the modifiable graph, so
+  // the two properties are mutually exclusive.
+  Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); });
+
+  ASSERT_THROW(
+      {
+        try {
+          Graph.finalize({experimental::property::graph::updatable{},
+                          experimental::property::graph::enable_fusion{}});
+        } catch (const sycl::exception &e) {
+          ASSERT_EQ(e.code(), make_error_code(sycl::errc::invalid));
+          throw;
+        }
+      },
+      sycl::exception);
+}
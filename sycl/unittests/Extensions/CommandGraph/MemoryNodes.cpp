@@ -0,0 +1,66 @@
+//==-------------------- MemoryNodes.cpp -----------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "Common.hpp"
+
+using namespace sycl;
+using namespace sycl::ext::oneapi;
+
+TEST_F(CommandGraphTest, MemoryNodesReuseFreedAllocations) {
+  void *Ptr1 = nullptr;
+  auto Malloc1 = Graph.add_malloc_device(Ptr1, 1024);
+  ASSERT_NE(Ptr1, nullptr);
+  ASSERT_EQ(Malloc1.get_type(),
+            experimental::node_type::ext_oneapi_malloc_device);
+
+  auto Kernel1 = Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); },
+      {experimental::property::node::depends_on(Malloc1)});
+  auto Free1 = Graph.add_free(
+      Ptr1, {experimental::property::node::depends_on(Kernel1)});
+  ASSERT_EQ(Free1.get_type(), experimental::node_type::ext_oneapi_free);
+
+  // Ordered after the free, so the memory can be reused
+  void *Ptr2 = nullptr;
+  auto Malloc2 = Graph.add_malloc_device(
+      Ptr2, 512, {experimental::property::node::depends_on(Free1)});
+  ASSERT_EQ(Ptr2, Ptr1);
+
+  // Not ordered after any free, so new memory is allocated
+  void *Ptr3 = nullptr;
+  Graph.add_malloc_device(Ptr3, 512);
+  ASSERT_NE(Ptr3, nullptr);
+  ASSERT_NE(Ptr3, Ptr1);
+
+  auto Free2 = Graph.add_free(
+      Ptr2, {experimental::property::node::depends_on(Malloc2)});
+  // Too large for the freed memory
+  void *Ptr4 = nullptr;
+  Graph.add_malloc_device(Ptr4, 2048,
+                          {experimental::property::node::depends_on(Free2)});
+  ASSERT_NE(Ptr4, Ptr1);
+  ASSERT_NE(Ptr4, Ptr3);
+
+  auto GraphExec = Graph.finalize();
+  Queue.submit([&](handler &CGH) { CGH.ext_oneapi_graph(GraphExec); });
+  Queue.wait();
+}
+
+TEST_F(CommandGraphTest, MemoryNodesInvalidFree) {
+  int Value = 0;
+  ASSERT_THROW(Graph.add_free(&Value), sycl::exception);
+
+  void *Ptr = nullptr;
+  auto Malloc = Graph.add_malloc_device(Ptr, 64);
+  Graph.add_free(Ptr, {experimental::property::node::depends_on(Malloc)});
+  // Already freed
+  ASSERT_THROW(Graph.add_free(Ptr), sycl::exception);
+
+  void *EmptyPtr = nullptr;
+  ASSERT_THROW(Graph.add_malloc_device(EmptyPtr, 0), sycl::exception);
+}
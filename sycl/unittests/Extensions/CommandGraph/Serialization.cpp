@@ -0,0 +1,102 @@
+//==------------------------ Serialization.cpp -----------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "Common.hpp"
+
+using namespace sycl;
+using namespace sycl::ext::oneapi;
+
+TEST_F(CommandGraphTest, SerializeRoundTrip) {
+  auto NodeA = Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); });
+  auto NodeB = Graph.add({experimental::property::node::depends_on(NodeA)});
+  auto NodeC = Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); },
+      {experimental::property::node::depends_on(NodeA)});
+  // The edge to an earlier node is only serialized after its source.
+  Graph.make_edge(NodeC, NodeB);
+
+  std::vector<std::byte> Data = Graph.serialize();
+
+  experimental::command_graph LoadedGraph{Queue.get_context(), Dev};
+  LoadedGraph.deserialize(Data);
+
+  auto Nodes = LoadedGraph.get_nodes();
+  ASSERT_EQ(Nodes.size(), 3u);
+  EXPECT_EQ(Nodes[0].get_type(), experimental::node_type::kernel);
+  EXPECT_EQ(Nodes[1].get_type(), experimental::node_type::kernel);
+  EXPECT_EQ(Nodes[2].get_type(), experimental::node_type::empty);
+  ASSERT_EQ(Nodes[0].get_successors().size(), 2u);
+  ASSERT_EQ(Nodes[1].get_successors().size(), 1u);
+  EXPECT_EQ(sycl::detail::getSyclObjImpl(Nodes[1].get_successors()[0]),
+            sycl::detail::getSyclObjImpl(Nodes[2]));
+  EXPECT_EQ(Nodes[2].get_predecessors().size(), 2u);
+  EXPECT_EQ(LoadedGraph.get_root_nodes().size(), 1u);
+
+  auto LoadedKernel = static_cast<sycl::detail::CGExecKernel *>(
+      sycl::detail::getSyclObjImpl(Nodes[0])->MCommandGroup.get());
+  auto OriginalKernel = static_cast<sycl::detail::CGExecKernel *>(
+      sycl::detail::getSyclObjImpl(NodeA)->MCommandGroup.get());
+  EXPECT_EQ(LoadedKernel->MKernelName, OriginalKernel->MKernelName);
+  EXPECT_EQ(LoadedKernel->MNDRDesc.Dims, OriginalKernel->MNDRDesc.Dims);
+
+  EXPECT_NO_THROW(LoadedGraph.finalize());
+}
+
+TEST_F(CommandGraphTest, SerializePointerPlaceholders) {
+  int Values[3];
+  void *Arg = &Values[0];
+  auto Node = Graph.add(
+      [&](sycl::handler &cgh) { cgh.single_task<TestKernel<>>([]() {}); });
+  // Mock kernels have no arguments, so add a pointer argument directly.
+  auto *KernelCG = static_cast<sycl::detail::CGExecKernel *>(
+      sycl::detail::getSyclObjImpl(Node)->MCommandGroup.get());
+  KernelCG->MArgs.emplace_back(sycl::detail::kernel_param_kind_t::kind_pointer,
+                               &Arg, sizeof(void *), 0);
+
+  // Pointers which are not passed to serialize() can't be stored.
+  ASSERT_THROW(
+      {
+        try {
+          Graph.serialize();
+        } catch (const sycl::exception &e) {
+          ASSERT_EQ(e.code(), make_error_code(sycl::errc::invalid));
+          throw;
+        }
+      },
+      sycl::exception);
+
+  std::vector<std::byte> Data = Graph.serialize({&Values[0]});
+
+  experimental::command_graph LoadedGraph{Queue.get_context(), Dev};
+  // Each placeholder needs a dynamic parameter.
+  EXPECT_ANY_THROW(LoadedGraph.deserialize(Data));
+
+  experimental::dynamic_parameter<void *> Pointer{LoadedGraph, &Values[1]};
+  LoadedGraph.deserialize(Data, {Pointer});
+
+  auto Nodes = LoadedGraph.get_nodes();
+  ASSERT_EQ(Nodes.size(), 1u);
+  auto &LoadedArgs = static_cast<sycl::detail::CGExecKernel *>(
+                         sycl::detail::getSyclObjImpl(Nodes[0])
+                             ->MCommandGroup.get())
+                         ->MArgs;
+  ASSERT_EQ(LoadedArgs.size(), 1u);
+  EXPECT_EQ(*static_cast<void **>(LoadedArgs[0].MPtr), &Values[1]);
+
+  Pointer.update(&Values[2]);
+  EXPECT_EQ(*static_cast<void **>(LoadedArgs[0].MPtr), &Values[2]);
+}
+
+TEST_F(CommandGraphTest, DeserializeInvalidData) {
+  std::vector<std::byte> Data = Graph.serialize();
+  Data.pop_back();
+  EXPECT_ANY_THROW(Graph.deserialize(Data));
+  EXPECT_ANY_THROW(Graph.deserialize({}));
+  EXPECT_EQ(Graph.get_nodes().size(), 0u);
+}
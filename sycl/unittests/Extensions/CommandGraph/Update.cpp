@@ -150,3 +150,129 @@ TEST_F(CommandGraphTest, UpdateRangeErrors) {
   // Can't update with a different number of dimensions
   EXPECT_ANY_THROW(NodeRange.update_range(range<2>{128, 128}));
 }
+
+static size_t UpdateKernelLaunchCounter = 0;
+static pi_result redefinedCommandBufferUpdateKernelLaunch(
+    pi_ext_command_buffer_command,
+    pi_ext_command_buffer_update_kernel_launch_desc *) {
+  ++UpdateKernelLaunchCounter;
+  return PI_SUCCESS;
+}
+
+TEST_F(CommandGraphTest, UpdateSkipsUpToDateNodes) {
+  // Tests that only the nodes which changed since they were last used to
+  // update the graph are updated in the backend
+  UpdateKernelLaunchCounter = 0;
+  Mock.redefineBefore<detail::PiApiKind::piextCommandBufferUpdateKernelLaunch>(
+      redefinedCommandBufferUpdateKernelLaunch);
+
+  auto NodeA = Graph.add([&](sycl::handler &cgh) {
+    cgh.parallel_for<TestKernel<>>(range<1>{16}, [](item<1>) {});
+  });
+  auto NodeB = Graph.add([&](sycl::handler &cgh) {
+    cgh.parallel_for<TestKernel<>>(range<1>{16}, [](item<1>) {});
+  });
+
+  std::vector<experimental::node> Nodes{NodeA, NodeB};
+  auto ExecGraph = Graph.finalize(experimental::property::graph::updatable{});
+  ExecGraph.update(Nodes);
+  EXPECT_EQ(UpdateKernelLaunchCounter, 0u);
+
+  NodeA.update_range(range<1>{32});
+  ExecGraph.update(Nodes);
+  EXPECT_EQ(UpdateKernelLaunchCounter, 1u);
+
+  // Already up to date
+  ExecGraph.update(Nodes);
+  EXPECT_EQ(UpdateKernelLaunchCounter, 1u);
+
+  // A graph finalized after the change doesn't need the update either
+  auto OtherExecGraph =
+      Graph.finalize(experimental::property::graph::updatable{});
+  OtherExecGraph.update(NodeA);
+  EXPECT_EQ(UpdateKernelLaunchCounter, 1u);
+}
+
+TEST_F(CommandGraphTest, UpdateWithGraph) {
+  // Tests that an executable graph can be updated with a graph with the same
+  // topology, but not with another one
+  auto NodeA = Graph.add([&](sycl::handler &cgh) {
+    cgh.parallel_for<TestKernel<>>(range<1>{16}, [](item<1>) {});
+  });
+  Graph.add(
+      [&](sycl::handler &cgh) {
+        cgh.parallel_for<TestKernel<>>(range<1>{16}, [](item<1>) {});
+      },
+      {experimental::property::node::depends_on(NodeA)});
+  auto ExecGraph = Graph.finalize(experimental::property::graph::updatable{});
+
+  auto SameGraph =
+      experimental::command_graph(Queue.get_context(), Queue.get_device());
+  auto SameNodeA = SameGraph.add([&](sycl::handler &cgh) {
+    cgh.parallel_for<TestKernel<>>(range<1>{32}, [](item<1>) {});
+  });
+  SameGraph.add(
+      [&](sycl::handler &cgh) {
+        cgh.parallel_for<TestKernel<>>(range<1>{32}, [](item<1>) {});
+      },
+      {experimental::property::node::depends_on(SameNodeA)});
+  EXPECT_NO_THROW(ExecGraph.update(SameGraph));
+  EXPECT_NO_THROW(ExecGraph.update(Graph));
+
+  auto OtherGraph =
+      experimental::command_graph(Queue.get_context(), Queue.get_device());
+  OtherGraph.add([&](sycl::handler &cgh) {
+    cgh.parallel_for<TestKernel<>>(range<1>{16}, [](item<1>) {});
+  });
+  OtherGraph.add([&](sycl::handler &cgh) {
+    cgh.parallel_for<TestKernel<>>(range<1>{16}, [](item<1>) {});
+  });
+  EXPECT_ANY_THROW(ExecGraph.update(OtherGraph));
+}
+
+static size_t EnqueueCommandBufferCounter = 0;
+static pi_result redefinedEnqueueCommandBuffer(pi_ext_command_buffer,
+                                               pi_queue, pi_uint32,
+                                               const pi_event *, pi_event *) {
+  ++EnqueueCommandBufferCounter;
+  return PI_SUCCESS;
+}
+
+TEST_F(CommandGraphTest, AutoGraphQueue) {
+  // Tests that the kernels of an auto_graph queue are run as a graph once the
+  // same sequence of kernels has been submitted min_repeats times
+  EnqueueCommandBufferCounter = 0;
+  Mock.redefineBefore<detail::PiApiKind::piextEnqueueCommandBuffer>(
+      redefinedEnqueueCommandBuffer);
+
+  sycl::queue AutoGraphQueue{
+      Dev,
+      {sycl::property::queue::in_order{},
+       experimental::property::queue::auto_graph{2}}};
+  auto SubmitSequence = [&]() {
+    AutoGraphQueue.parallel_for<TestKernel<>>(range<1>{16}, [](item<1>) {});
+    AutoGraphQueue.parallel_for<TestKernel<>>(range<1>{16}, [](item<1>) {});
+    AutoGraphQueue.wait();
+  };
+
+  SubmitSequence();
+  SubmitSequence();
+  EXPECT_EQ(EnqueueCommandBufferCounter, 0u);
+  SubmitSequence();
+  EXPECT_EQ(EnqueueCommandBufferCounter, 1u);
+  SubmitSequence();
+  EXPECT_EQ(EnqueueCommandBufferCounter, 2u);
+
+  // A command which is not a kernel breaks the sequence
+  AutoGraphQueue.parallel_for<TestKernel<>>(range<1>{16}, [](item<1>) {});
+  AutoGraphQueue.ext_oneapi_submit_barrier();
+  AutoGraphQueue.parallel_for<TestKernel<>>(range<1>{16}, [](item<1>) {});
+  AutoGraphQueue.wait();
+  EXPECT_EQ(EnqueueCommandBufferCounter, 3u);
+  SubmitSequence();
+  EXPECT_EQ(EnqueueCommandBufferCounter, 3u);
+
+  // Only in-order queues can record their kernels
+  EXPECT_ANY_THROW(
+      sycl::queue(Dev, {experimental::property::queue::auto_graph{}}));
+}
@@ -30,6 +30,12 @@ class DeviceGlobalImgScopeTestKernel;
 constexpr const char *DeviceGlobalImgScopeTestKernelName =
     "DeviceGlobalImgScopeTestKernel";
 constexpr const char *DeviceGlobalImgScopeName = "DeviceGlobalImgScopeName";
+class DeviceGlobalBatchTestKernel;
+constexpr const char *DeviceGlobalBatchTestKernelName =
+    "DeviceGlobalBatchTestKernel";
+constexpr const char *DeviceGlobalBatchIntName = "DeviceGlobalBatchIntName";
+constexpr const char *DeviceGlobalBatchDoubleName =
+    "DeviceGlobalBatchDoubleName";
 
 using DeviceGlobalElemType = int[2];
 sycl::ext::oneapi::experimental::device_global<DeviceGlobalElemType>
@@ -39,6 +45,9 @@ sycl::ext::oneapi::experimental::device_global<
     decltype(sycl::ext::oneapi::experimental::properties(
         sycl::ext::oneapi::experimental::device_image_scope))>
     DeviceGlobalImgScope;
+sycl::ext::oneapi::experimental::device_global<int> DeviceGlobalBatchInt;
+sycl::ext::oneapi::experimental::device_global<double[2]>
+    DeviceGlobalBatchDouble;
 
 namespace sycl {
 inline namespace _V1 {
@@ -55,6 +64,13 @@ struct KernelInfo<DeviceGlobalImgScopeTestKernel>
     return DeviceGlobalImgScopeTestKernelName;
   }
 };
+template <>
+struct KernelInfo<DeviceGlobalBatchTestKernel>
+    : public unittest::MockKernelInfoBase {
+  static constexpr const char *getName() {
+    return DeviceGlobalBatchTestKernelName;
+  }
+};
 } // namespace detail
 } // namespace _V1
 } // namespace sycl
@@ -120,10 +136,47 @@ static sycl::unittest::PiImage generateDeviceGlobalImgScopeImage() {
   return Img;
 }
 
+static sycl::unittest::PiImage generateDeviceGlobalBatchImage() {
+  using namespace sycl::unittest;
+
+  // Call device global map initializer explicitly to mimic the integration
+  // header.
+  sycl::detail::device_global_map::add(&DeviceGlobalBatchInt,
+                                       DeviceGlobalBatchIntName);
+  sycl::detail::device_global_map::add(&DeviceGlobalBatchDouble,
+                                       DeviceGlobalBatchDoubleName);
+
+  // Insert remaining device global info into the binary.
+  PiPropertySet PropSet;
+  PiProperty IntInfo =
+      makeDeviceGlobalInfo(DeviceGlobalBatchIntName, sizeof(int), 0);
+  PiProperty DoubleInfo =
+      makeDeviceGlobalInfo(DeviceGlobalBatchDoubleName, sizeof(double) * 2, 0);
+  PropSet.insert(
+      __SYCL_PI_PROPERTY_SET_SYCL_DEVICE_GLOBALS,
+      PiArray<PiProperty>{std::move(IntInfo), std::move(DoubleInfo)});
+
+  std::vector<unsigned char> Bin{10, 11, 12, 13, 14, 15}; // Random data
+
+  PiArray<PiOffloadEntry> Entries =
+      makeEmptyKernels({DeviceGlobalBatchTestKernelName});
+
+  PiImage Img{PI_DEVICE_BINARY_TYPE_SPIRV,            // Format
+              __SYCL_PI_DEVICE_BINARY_TARGET_SPIRV64, // DeviceTargetSpec
+              "",                                     // Compile options
+              "",                                     // Link options
+              std::move(Bin),
+              std::move(Entries),
+              std::move(PropSet)};
+
+  return Img;
+}
+
 namespace {
 sycl::unittest::PiImage Imgs[] = {generateDeviceGlobalImage(),
-                                  generateDeviceGlobalImgScopeImage()};
-sycl::unittest::PiImageArray<2> ImgArray{Imgs};
+                                  generateDeviceGlobalImgScopeImage(),
+                                  generateDeviceGlobalBatchImage()};
+sycl::unittest::PiImageArray<3> ImgArray{Imgs};
 
 // Trackers.
 thread_local DeviceGlobalElemType MockDeviceGlobalMem;
@@ -833,3 +886,118 @@ TEST(DeviceGlobalTest, DeviceGlobalImgScopeUseBeforeMemcpyFrom) {
   EXPECT_EQ(MockDeviceGlobalImgScopeMem[0], Vals[0]);
   EXPECT_EQ(MockDeviceGlobalImgScopeMem[1], Vals[1]);
 }
+
+namespace {
+thread_local unsigned DeviceGlobalBatchAllocCounter = 0;
+thread_local unsigned DeviceGlobalBatchMemcpyCounter = 0;
+thread_local size_t DeviceGlobalBatchMemcpySize = 0;
+thread_local void *DeviceGlobalBatchIntPtr = nullptr;
+thread_local void *DeviceGlobalBatchDoublePtr = nullptr;
+alignas(64) thread_local unsigned char MockDeviceGlobalBatchMem[64];
+
+pi_result after_DeviceGlobalBatchUSMDeviceAlloc(void **result_ptr, pi_context,
+                                                pi_device,
+                                                pi_usm_mem_properties *,
+                                                size_t, pi_uint32) {
+  ++DeviceGlobalBatchAllocCounter;
+  *result_ptr = MockDeviceGlobalBatchMem;
+  return PI_SUCCESS;
+}
+
+pi_result after_DeviceGlobalBatchUSMEnqueueMemcpy(pi_queue, pi_bool, void *,
+                                                  const void *, size_t size,
+                                                  pi_uint32, const pi_event *,
+                                                  pi_event *) {
+  ++DeviceGlobalBatchMemcpyCounter;
+  DeviceGlobalBatchMemcpySize = size;
+  return PI_SUCCESS;
+}
+
+pi_result after_DeviceGlobalBatchVariableWrite(pi_queue, pi_program,
+                                               const char *name, pi_bool,
+                                               size_t, size_t,
+                                               const void *src_ptr, pi_uint32,
+                                               const pi_event *, pi_event *) {
+  void *USMPtr = *static_cast<void *const *>(src_ptr);
+  if (std::string(name) == DeviceGlobalBatchIntName)
+    DeviceGlobalBatchIntPtr = USMPtr;
+  else if (std::string(name) == DeviceGlobalBatchDoubleName)
+    DeviceGlobalBatchDoublePtr = USMPtr;
+  return PI_SUCCESS;
+}
+} // namespace
+
+TEST(DeviceGlobalTest, DeviceGlobalsOfImageShareAllocation) {
+  auto [Mock, Q] = CommonSetup([](sycl::unittest::PiMock &MockRef) {
+    MockRef.redefineAfter<PiApiKind::piextUSMDeviceAlloc>(
+        after_DeviceGlobalBatchUSMDeviceAlloc);
+    MockRef.redefineAfter<PiApiKind::piextUSMEnqueueMemcpy>(
+        after_DeviceGlobalBatchUSMEnqueueMemcpy);
+    MockRef.redefineAfter<PiApiKind::piextEnqueueDeviceGlobalVariableWrite>(
+        after_DeviceGlobalBatchVariableWrite);
+  });
+  std::ignore = Mock;
+  DeviceGlobalBatchAllocCounter = 0;
+  DeviceGlobalBatchMemcpyCounter = 0;
+
+  Q.single_task<DeviceGlobalBatchTestKernel>([]() {}).wait();
+
+  // Both device_globals are allocated and initialized together.
+  EXPECT_EQ(DeviceGlobalBatchAllocCounter, 1u);
+  EXPECT_EQ(DeviceGlobalBatchMemcpyCounter, 1u);
+  EXPECT_EQ(DeviceGlobalBatchMemcpySize, sizeof(double) * 2 + sizeof(int));
+
+  // The most aligned device_global comes first.
+  EXPECT_EQ(DeviceGlobalBatchDoublePtr, MockDeviceGlobalBatchMem);
+  EXPECT_EQ(DeviceGlobalBatchIntPtr,
+            MockDeviceGlobalBatchMem + sizeof(double) * 2);
+
+  // The device_globals are not allocated again.
+  Q.single_task<DeviceGlobalBatchTestKernel>([]() {}).wait();
+  EXPECT_EQ(DeviceGlobalBatchAllocCounter, 1u);
+  EXPECT_EQ(DeviceGlobalBatchMemcpyCounter, 1u);
+}
+
+namespace {
+thread_local unsigned DeviceGlobalInitEventQueryCounter = 0;
+
+pi_result after_CountingInitEventGetInfo(pi_event event,
+                                         pi_event_info param_name, size_t Size,
+                                         void *param_value, size_t *RetSize) {
+  if (param_name == PI_EVENT_INFO_COMMAND_EXECUTION_STATUS &&
+      DeviceGlobalInitEvent.has_value() && event == *DeviceGlobalInitEvent)
+    ++DeviceGlobalInitEventQueryCounter;
+  return after_piEventGetInfo(event, param_name, Size, param_value, RetSize);
+}
+} // namespace
+
+TEST(DeviceGlobalTest, DeviceGlobalMemcpyAfterInitUsesCachedMemory) {
+  auto [Mock, Q] = CommonSetup([](sycl::unittest::PiMock &MockRef) {
+    MockRef.REDEFINE_AFTER(piextUSMDeviceAlloc);
+    MockRef.REDEFINE_AFTER(piextUSMEnqueueMemcpy);
+    MockRef.redefineAfter<PiApiKind::piEventGetInfo>(
+        after_CountingInitEventGetInfo);
+  });
+  std::ignore = Mock;
+  DeviceGlobalInitEventQueryCounter = 0;
+
+  int Vals[2] = {42, 1234};
+  Q.memcpy(DeviceGlobal, Vals).wait();
+  TreatDeviceGlobalInitEventAsCompleted = true;
+
+  // The memory is looked up once its initialization has completed, then the
+  // copies use it directly.
+  Vals[0] = 7;
+  Q.memcpy(DeviceGlobal, Vals).wait();
+  unsigned QueriesOnceInitialized = DeviceGlobalInitEventQueryCounter;
+  Vals[1] = 8;
+  Q.memcpy(DeviceGlobal, Vals).wait();
+  int ReadVals[2] = {0, 0};
+  Q.memcpy(ReadVals, DeviceGlobal).wait();
+  EXPECT_EQ(DeviceGlobalInitEventQueryCounter, QueriesOnceInitialized);
+
+  EXPECT_EQ(MockDeviceGlobalMem[0], 7);
+  EXPECT_EQ(MockDeviceGlobalMem[1], 8);
+  EXPECT_EQ(ReadVals[0], 7);
+  EXPECT_EQ(ReadVals[1], 8);
+}
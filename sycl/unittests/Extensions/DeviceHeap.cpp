@@ -0,0 +1,91 @@
+//==------------------------- DeviceHeap.cpp -------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+#include <helpers/PiMock.hpp>
+#include <sycl/sycl.hpp>
+
+#include <cstdint>
+
+using namespace sycl;
+namespace syclex = sycl::ext::oneapi::experimental;
+
+namespace {
+size_t NumDeviceAllocs = 0;
+size_t NumFrees = 0;
+
+pi_result redefinedUSMDeviceAlloc(void **, pi_context, pi_device,
+                                  pi_usm_mem_properties *, size_t, pi_uint32) {
+  ++NumDeviceAllocs;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedUSMFree(pi_context, void *) {
+  ++NumFrees;
+  return PI_SUCCESS;
+}
+} // namespace
+
+TEST(DeviceHeap, AllocateAndReuseBlocks) {
+  alignas(syclex::device_heap::alignment) static unsigned char Arena[1024];
+  syclex::device_heap Heap{Arena, sizeof(Arena)};
+  ASSERT_GT(Heap.capacity(), 0ul);
+  ASSERT_LT(Heap.capacity(), sizeof(Arena));
+
+  EXPECT_EQ(Heap.malloc(0), nullptr);
+  EXPECT_EQ(Heap.malloc(syclex::device_heap::max_alloc_size + 1), nullptr);
+
+  void *Small = Heap.malloc(1);
+  void *Large = Heap.malloc(100);
+  ASSERT_NE(Small, nullptr);
+  ASSERT_NE(Large, nullptr);
+  EXPECT_NE(Small, Large);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(Small) %
+                syclex::device_heap::alignment,
+            0ul);
+
+  // A freed block is reused by the allocations of the same size only.
+  Heap.free(Small);
+  void *Other = Heap.malloc(100);
+  EXPECT_NE(Other, Small);
+  EXPECT_EQ(Heap.malloc(16), Small);
+
+  Heap.free(Large);
+  Heap.free(Other);
+  EXPECT_EQ(Heap.malloc(128), Other);
+  EXPECT_EQ(Heap.malloc(128), Large);
+  Heap.free(nullptr);
+
+  // A block larger than the rest of the arena doesn't exhaust the heap.
+  EXPECT_EQ(Heap.malloc(1024), nullptr);
+  EXPECT_NE(Heap.malloc(1), nullptr);
+}
+
+TEST(DeviceHeap, ArenaPerContextAndDevice) {
+  unittest::PiMock Mock;
+  NumDeviceAllocs = 0;
+  NumFrees = 0;
+  Mock.redefineBefore<detail::PiApiKind::piextUSMDeviceAlloc>(
+      redefinedUSMDeviceAlloc);
+  Mock.redefineBefore<detail::PiApiKind::piextUSMFree>(redefinedUSMFree);
+
+  device Dev = Mock.getPlatform().get_devices()[0];
+  {
+    context Ctx{Dev};
+    syclex::device_heap Heap = syclex::get_device_heap(Ctx, Dev);
+    EXPECT_GT(Heap.capacity(), 0ul);
+    EXPECT_EQ(syclex::get_device_heap(Ctx, Dev).capacity(), Heap.capacity());
+    EXPECT_EQ(NumDeviceAllocs, 1ul);
+
+    context OtherCtx{Dev};
+    syclex::get_device_heap(OtherCtx, Dev);
+    EXPECT_EQ(NumDeviceAllocs, 2ul);
+  }
+  // The arenas are freed with their context.
+  EXPECT_EQ(NumFrees, 2ul);
+}
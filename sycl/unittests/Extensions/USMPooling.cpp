@@ -0,0 +1,95 @@
+//==------------------------- USMPooling.cpp -------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+#include <helpers/PiMock.hpp>
+#include <sycl/sycl.hpp>
+
+using namespace sycl;
+namespace syclex = sycl::ext::oneapi::experimental;
+
+namespace {
+size_t NumDeviceAllocs = 0;
+size_t NumFrees = 0;
+
+pi_result redefinedUSMDeviceAlloc(void **, pi_context, pi_device,
+                                  pi_usm_mem_properties *, size_t, pi_uint32) {
+  ++NumDeviceAllocs;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedUSMFree(pi_context, void *) {
+  ++NumFrees;
+  return PI_SUCCESS;
+}
+
+class USMPoolingTest : public ::testing::Test {
+public:
+  USMPoolingTest() : Mock{}, Plat{Mock.getPlatform()} {}
+
+protected:
+  void SetUp() override {
+    NumDeviceAllocs = 0;
+    NumFrees = 0;
+    Mock.redefineBefore<detail::PiApiKind::piextUSMDeviceAlloc>(
+        redefinedUSMDeviceAlloc);
+    Mock.redefineBefore<detail::PiApiKind::piextUSMFree>(redefinedUSMFree);
+  }
+
+  unittest::PiMock Mock;
+  platform Plat;
+};
+} // namespace
+
+TEST_F(USMPoolingTest, SmallAllocationsShareSlab) {
+  device Dev = Plat.get_devices()[0];
+  {
+    context Ctx{Dev, {syclex::property::context::usm_pooling{}}};
+
+    void *Ptr1 = malloc_device(100, Dev, Ctx);
+    void *Ptr2 = malloc_device(100, Dev, Ctx);
+    ASSERT_NE(Ptr1, nullptr);
+    ASSERT_NE(Ptr2, nullptr);
+    // Both are rounded up to 128 bytes and taken from the same slab.
+    EXPECT_EQ(static_cast<char *>(Ptr2) - static_cast<char *>(Ptr1), 128);
+    EXPECT_EQ(NumDeviceAllocs, 1ul);
+
+    free(Ptr1, Ctx);
+    free(Ptr2, Ctx);
+    EXPECT_EQ(NumFrees, 0ul);
+
+    // The freed chunk is reused.
+    void *Ptr3 = malloc_device(64, Dev, Ctx);
+    EXPECT_EQ(NumDeviceAllocs, 1ul);
+    free(Ptr3, Ctx);
+  }
+  // The slab is released with the context.
+  EXPECT_EQ(NumFrees, 1ul);
+}
+
+TEST_F(USMPoolingTest, LargeAllocationsAreNotPooled) {
+  device Dev = Plat.get_devices()[0];
+  context Ctx{Dev, {syclex::property::context::usm_pooling{}}};
+
+  void *Ptr = malloc_device(64 * 1024, Dev, Ctx);
+  EXPECT_EQ(NumDeviceAllocs, 1ul);
+  free(Ptr, Ctx);
+  EXPECT_EQ(NumFrees, 1ul);
+}
+
+TEST_F(USMPoolingTest, DisabledByDefault) {
+  device Dev = Plat.get_devices()[0];
+  context Ctx{Dev};
+
+  void *Ptr1 = malloc_device(100, Dev, Ctx);
+  void *Ptr2 = malloc_device(100, Dev, Ctx);
+  EXPECT_EQ(NumDeviceAllocs, 2ul);
+  free(Ptr1, Ctx);
+  free(Ptr2, Ctx);
+  EXPECT_EQ(NumFrees, 2ul);
+}
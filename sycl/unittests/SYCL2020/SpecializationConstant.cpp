@@ -66,6 +66,15 @@ static sycl::unittest::PiImage generateImageWithSpecConsts() {
 static sycl::unittest::PiImage Img = generateImageWithSpecConsts();
 static sycl::unittest::PiImageArray<1> ImgArray{&Img};
 
+static size_t MemBufferCreateCounter = 0;
+
+static pi_result redefinedMemBufferCreate(pi_context, pi_mem_flags, size_t,
+                                          void *, pi_mem *,
+                                          const pi_mem_properties *) {
+  ++MemBufferCreateCounter;
+  return PI_SUCCESS;
+}
+
 TEST(SpecializationConstant, DefaultValuesAreSet) {
   sycl::unittest::PiMock Mock;
   sycl::platform Plt = Mock.getPlatform();
@@ -275,3 +284,24 @@ TEST(SpecializationConstant, NoKernel) {
     EXPECT_EQ(CGH.get_specialization_constant<SpecConst1>(), ExpectedValue);
   });
 }
+
+TEST(SpecializationConstant, SameValuesShareBuffer) {
+  sycl::unittest::PiMock Mock;
+  Mock.redefineBefore<sycl::detail::PiApiKind::piMemBufferCreate>(
+      redefinedMemBufferCreate);
+  MemBufferCreateCounter = 0;
+
+  sycl::platform Plt = Mock.getPlatform();
+  const sycl::device Dev = Plt.get_devices()[0];
+  sycl::context Ctx{Dev};
+  auto CtxImpl = sycl::detail::getSyclObjImpl(Ctx);
+
+  std::vector<unsigned char> Values{42, 0, 0, 0, 8, 0, 0, 0};
+  std::vector<unsigned char> OtherValues{43, 0, 0, 0, 8, 0, 0, 0};
+  sycl::detail::pi::PiMem Buffer = CtxImpl->getSpecConstsBuffer(Values);
+  EXPECT_EQ(CtxImpl->getSpecConstsBuffer(Values), Buffer);
+  EXPECT_EQ(MemBufferCreateCounter, 1u);
+
+  EXPECT_NE(CtxImpl->getSpecConstsBuffer(OtherValues), Buffer);
+  EXPECT_EQ(MemBufferCreateCounter, 2u);
+}
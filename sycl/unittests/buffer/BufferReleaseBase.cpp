@@ -142,6 +142,26 @@ TEST_F(BufferDestructionCheck, BufferWithRawHostPtr) {
   ASSERT_EQ(MockSchedulerPtr->MDeferredMemObjRelease.size(), 0u);
 }
 
+TEST_F(BufferDestructionCheck, BufferWithRawHostPtrAsyncRelease) {
+  sycl::context Context{Plt};
+  sycl::queue Q = sycl::queue{Context, sycl::default_selector{}};
+
+  MockCmdWithReleaseTracking *MockCmd = NULL;
+  sycl::detail::buffer_impl *RawBufferImplPtr = NULL;
+  int InitialVal = 8;
+  {
+    sycl::buffer<int, 1> Buf(
+        &InitialVal, 1,
+        {sycl::ext::oneapi::experimental::property::buffer::async_release{}});
+    RawBufferImplPtr = sycl::detail::getSyclObjImpl(Buf).get();
+    MockCmd = addCommandToBuffer(Buf, Q);
+  }
+  ASSERT_EQ(MockSchedulerPtr->MDeferredMemObjRelease.size(), 1u);
+  EXPECT_EQ(MockSchedulerPtr->MDeferredMemObjRelease[0].get(),
+            RawBufferImplPtr);
+  EXPECT_CALL(*MockCmd, Release).Times(1);
+}
+
 TEST_F(BufferDestructionCheck, BufferWithRawHostPtrWithNonDefaultAllocator) {
   sycl::context Context{Plt};
   sycl::queue Q = sycl::queue{Context, sycl::default_selector{}};
@@ -0,0 +1,107 @@
+//==------- HostStaging.cpp --- check staging of host to buffer copies -----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <sycl/sycl.hpp>
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <vector>
+
+#include <helpers/PiMock.hpp>
+
+namespace {
+constexpr size_t StagingBufferSize = 4 * 1024 * 1024;
+
+std::vector<size_t> WriteSizes;
+size_t NumHostAllocs = 0;
+bool HostUnifiedMemory = false;
+
+pi_result redefinedEnqueueMemBufferWrite(pi_queue, pi_mem, pi_bool, size_t,
+                                         size_t Size, const void *, pi_uint32,
+                                         const pi_event *, pi_event *) {
+  WriteSizes.push_back(Size);
+  return PI_SUCCESS;
+}
+
+pi_result redefinedDeviceGetInfo(pi_device, pi_device_info ParamName, size_t,
+                                 void *ParamValue, size_t *) {
+  if (ParamName == PI_DEVICE_INFO_HOST_UNIFIED_MEMORY && ParamValue)
+    *static_cast<pi_bool *>(ParamValue) = HostUnifiedMemory;
+  return PI_SUCCESS;
+}
+
+// The staging buffers are written by the runtime, so they are real memory.
+pi_result redefinedUSMHostAlloc(void **ResultPtr, pi_context,
+                                pi_usm_mem_properties *, size_t Size,
+                                pi_uint32) {
+  ++NumHostAllocs;
+  *ResultPtr = std::malloc(Size);
+  return PI_SUCCESS;
+}
+
+pi_result redefinedUSMFree(pi_context, void *Ptr) {
+  std::free(Ptr);
+  return PI_SUCCESS;
+}
+
+class HostStagingTest : public ::testing::Test {
+public:
+  HostStagingTest() : Mock{}, Plt{Mock.getPlatform()} {}
+
+protected:
+  void SetUp() override {
+    WriteSizes.clear();
+    NumHostAllocs = 0;
+    HostUnifiedMemory = false;
+    Mock.redefineBefore<sycl::detail::PiApiKind::piEnqueueMemBufferWrite>(
+        redefinedEnqueueMemBufferWrite);
+    Mock.redefineAfter<sycl::detail::PiApiKind::piDeviceGetInfo>(
+        redefinedDeviceGetInfo);
+    Mock.redefine<sycl::detail::PiApiKind::piextUSMHostAlloc>(
+        redefinedUSMHostAlloc);
+    Mock.redefine<sycl::detail::PiApiKind::piextUSMFree>(redefinedUSMFree);
+  }
+
+  void copyToBuffer(size_t Size) {
+    sycl::queue Queue{Plt.get_devices()[0]};
+    std::vector<char> Data(Size, 1);
+    sycl::buffer<char, 1> Buf{sycl::range<1>{Size}};
+    Queue
+        .submit([&](sycl::handler &CGH) {
+          auto Acc = Buf.get_access<sycl::access::mode::discard_write>(CGH);
+          CGH.copy(Data.data(), Acc);
+        })
+        .wait();
+  }
+
+  sycl::unittest::PiMock Mock;
+  sycl::platform Plt;
+};
+} // namespace
+
+TEST_F(HostStagingTest, LargeCopyIsChunked) {
+  copyToBuffer(2 * StagingBufferSize + 16);
+  EXPECT_EQ(NumHostAllocs, 2ul);
+  ASSERT_EQ(WriteSizes.size(), 3ul);
+  EXPECT_EQ(WriteSizes[0], StagingBufferSize);
+  EXPECT_EQ(WriteSizes[1], StagingBufferSize);
+  EXPECT_EQ(WriteSizes[2], 16ul);
+}
+
+TEST_F(HostStagingTest, SmallCopyIsDirect) {
+  copyToBuffer(StagingBufferSize);
+  EXPECT_EQ(NumHostAllocs, 0ul);
+  ASSERT_EQ(WriteSizes.size(), 1ul);
+}
+
+TEST_F(HostStagingTest, UnifiedMemoryCopyIsDirect) {
+  HostUnifiedMemory = true;
+  copyToBuffer(2 * StagingBufferSize + 16);
+  EXPECT_EQ(NumHostAllocs, 0ul);
+  ASSERT_EQ(WriteSizes.size(), 1ul);
+}
@@ -0,0 +1,109 @@
+//==---------- ZeroCopy.cpp --- check buffers with the zero_copy property --==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <sycl/sycl.hpp>
+
+#include <detail/config.hpp>
+#include <helpers/PiMock.hpp>
+#include <helpers/ScopedEnvVar.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace syclex = sycl::ext::oneapi::experimental;
+
+namespace {
+void *CreatedHostPtr = nullptr;
+pi_mem_flags CreatedFlags = 0;
+
+pi_result redefinedMemBufferCreate(pi_context, pi_mem_flags Flags, size_t,
+                                   void *HostPtr, pi_mem *,
+                                   const pi_mem_properties *) {
+  CreatedHostPtr = HostPtr;
+  CreatedFlags = Flags;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedDeviceGetInfo(pi_device, pi_device_info ParamName, size_t,
+                                 void *ParamValue, size_t *) {
+  if (ParamName == PI_DEVICE_INFO_HOST_UNIFIED_MEMORY && ParamValue)
+    *static_cast<pi_bool *>(ParamValue) = PI_TRUE;
+  return PI_SUCCESS;
+}
+
+bool isPageAligned(const void *Ptr) {
+  return reinterpret_cast<std::uintptr_t>(Ptr) % 4096 == 0;
+}
+
+class ZeroCopyTest : public ::testing::Test {
+public:
+  ZeroCopyTest() : Mock{}, Plt{Mock.getPlatform()} {}
+
+protected:
+  void SetUp() override {
+    CreatedHostPtr = nullptr;
+    CreatedFlags = 0;
+    Mock.redefineBefore<sycl::detail::PiApiKind::piMemBufferCreate>(
+        redefinedMemBufferCreate);
+    Mock.redefineAfter<sycl::detail::PiApiKind::piDeviceGetInfo>(
+        redefinedDeviceGetInfo);
+  }
+
+  template <typename BufferT> void useOnDevice(BufferT &Buf) {
+    sycl::queue Queue{Plt.get_devices()[0]};
+    Queue.submit([&](sycl::handler &CGH) {
+      auto Acc = Buf.template get_access<sycl::access::mode::read_write>(CGH);
+      CGH.single_task<class ZeroCopyKernel>([=]() { (void)Acc; });
+    });
+    Queue.wait();
+  }
+
+  sycl::unittest::PiMock Mock;
+  sycl::platform Plt;
+};
+} // namespace
+
+TEST_F(ZeroCopyTest, SizedBufferUsesPageAlignedHostMemory) {
+  sycl::buffer<int, 1> Buf{sycl::range<1>{1024},
+                           {syclex::property::buffer::zero_copy{}}};
+  useOnDevice(Buf);
+  EXPECT_TRUE(isPageAligned(CreatedHostPtr));
+  EXPECT_TRUE(CreatedFlags & PI_MEM_FLAGS_HOST_PTR_USE);
+}
+
+TEST_F(ZeroCopyTest, MisalignedHostPointerIsCopied) {
+  sycl::unittest::ScopedEnvVar WarningLevel{
+      "SYCL_RT_WARNING_LEVEL", "1",
+      sycl::detail::SYCLConfig<sycl::detail::SYCL_RT_WARNING_LEVEL>::reset};
+  std::vector<char> Storage(4096 * 3);
+  char *Data = Storage.data();
+  while (isPageAligned(Data))
+    ++Data;
+
+  testing::internal::CaptureStderr();
+  {
+    sycl::buffer<char, 1> Buf{Data, sycl::range<1>{4096},
+                              {syclex::property::buffer::zero_copy{}}};
+    useOnDevice(Buf);
+    EXPECT_NE(CreatedHostPtr, Data);
+    EXPECT_TRUE(isPageAligned(CreatedHostPtr));
+  }
+  std::string Output = testing::internal::GetCapturedStderr();
+  EXPECT_NE(Output.find("WARNING: zero_copy memory object"),
+            std::string::npos);
+}
+
+TEST_F(ZeroCopyTest, PinnedHostMemoryIsRejected) {
+  EXPECT_ANY_THROW((sycl::buffer<int, 1>{
+      sycl::range<1>{16},
+      {syclex::property::buffer::zero_copy{},
+       sycl::ext::oneapi::property::buffer::use_pinned_host_memory{}}}));
+}
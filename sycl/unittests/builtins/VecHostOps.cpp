@@ -0,0 +1,60 @@
+//==------- VecHostOps.cpp --- check sycl::vec operations on host ----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+
+#include <sycl/sycl.hpp>
+
+TEST(VecHostOps, Arithmetic) {
+  sycl::float4 A{1.0f, 2.0f, 3.0f, 4.0f}, B{4.0f, 3.0f, 2.0f, 1.0f};
+  sycl::float4 Res = A * B + A / B;
+  EXPECT_FLOAT_EQ(Res.x(), 4.25f);
+  EXPECT_FLOAT_EQ(Res.w(), 8.0f);
+
+  sycl::vec<char, 16> C(3), D(5);
+  sycl::vec<char, 16> Prod = C * D - C;
+  EXPECT_EQ(Prod[15], 12);
+}
+
+TEST(VecHostOps, ThreeElements) {
+  sycl::int3 A{1, 2, 3}, B{3, 0, 1};
+  sycl::int3 Res = (A * B) ^ A;
+  EXPECT_EQ(Res.x(), 2);
+  EXPECT_EQ(Res.y(), 2);
+  EXPECT_EQ(Res.z(), 0);
+  // Integer division is element-wise and ignores the padding element.
+  sycl::int3 Quot = A / sycl::int3{1, 2, 3};
+  EXPECT_EQ(Quot.z(), 1);
+}
+
+TEST(VecHostOps, Relational) {
+  sycl::double2 A{1.5, -2.5}, B{1.5, 0.0};
+  sycl::long2 GE = A >= B;
+  EXPECT_EQ(GE.x(), -1);
+  EXPECT_EQ(GE.y(), 0);
+  sycl::int4 LT = sycl::float4{1, 2, 3, 4} < sycl::float4{4, 3, 2, 1};
+  EXPECT_EQ(LT.x(), -1);
+  EXPECT_EQ(LT.w(), 0);
+}
+
+TEST(VecHostOps, Convert) {
+  sycl::double2 A{1.5, -2.5};
+  sycl::int2 RTZ = A.convert<int, sycl::rounding_mode::rtz>();
+  EXPECT_EQ(RTZ.x(), 1);
+  EXPECT_EQ(RTZ.y(), -2);
+  // The default rounding of floating point to integer conversions is to
+  // nearest even.
+  sycl::int2 RTE = A.convert<int>();
+  EXPECT_EQ(RTE.x(), 2);
+  EXPECT_EQ(RTE.y(), -2);
+
+  sycl::float3 F = sycl::int3{1, -2, 3}.convert<float>();
+  EXPECT_FLOAT_EQ(F.y(), -2.0f);
+  sycl::uint4 U = sycl::int4{1, -1, 2, 3}.convert<unsigned>();
+  EXPECT_EQ(U.y(), 0xffffffffu);
+}
@@ -6,7 +6,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <detail/config.hpp>
+#include <detail/context_impl.hpp>
 #include <helpers/PiMock.hpp>
+#include <helpers/ScopedEnvVar.hpp>
 
 #include <gtest/gtest.h>
 
@@ -61,3 +64,43 @@ TEST_F(ContextTest, CopyAssignmentOperator) {
   ASSERT_EQ(hash, std::hash<context>()(WillContextCopy));
   ASSERT_EQ(Context, WillContextCopy);
 }
+
+static size_t ContextCreateCounter = 0;
+static size_t ContextReleaseCounter = 0;
+
+static pi_result redefinedContextCreate(const pi_context_properties *,
+                                        pi_uint32, const pi_device *,
+                                        void (*)(const char *, const void *,
+                                                 size_t, void *),
+                                        void *, pi_context *) {
+  ++ContextCreateCounter;
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedContextRelease(pi_context) {
+  ++ContextReleaseCounter;
+  return PI_SUCCESS;
+}
+
+TEST_F(ContextTest, SharedBackendContext) {
+  unittest::ScopedEnvVar ShareContexts{
+      "SYCL_SHARE_BACKEND_CONTEXTS", "1",
+      detail::SYCLConfig<detail::SYCL_SHARE_BACKEND_CONTEXTS>::reset};
+  mock.redefineBefore<detail::PiApiKind::piContextCreate>(
+      redefinedContextCreate);
+  mock.redefineBefore<detail::PiApiKind::piContextRelease>(
+      redefinedContextRelease);
+  ContextCreateCounter = 0;
+  ContextReleaseCounter = 0;
+  {
+    context Context1(deviceA);
+    context Context2(deviceA);
+    // The contexts are distinct but share their backend context.
+    EXPECT_NE(Context1, Context2);
+    EXPECT_EQ(detail::getSyclObjImpl(Context1)->getHandleRef(),
+              detail::getSyclObjImpl(Context2)->getHandleRef());
+    EXPECT_EQ(ContextCreateCounter, 1u);
+  }
+  // The backend context is released with the last context.
+  EXPECT_EQ(ContextReleaseCounter, 1u);
+}
@@ -0,0 +1,45 @@
+//==------- DeviceInfoCache.cpp --- Check caching of device info -----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <helpers/PiMock.hpp>
+
+#include <gtest/gtest.h>
+
+#include <sycl/sycl.hpp>
+
+#include <map>
+
+using namespace sycl;
+
+static std::map<pi_device_info, size_t> InfoQueries;
+static pi_result redefinedDeviceGetInfo(pi_device, pi_device_info ParamName,
+                                        size_t, void *, size_t *) {
+  ++InfoQueries[ParamName];
+  return PI_SUCCESS;
+}
+
+// Check that the immutable device info is only queried from the plugin once.
+TEST(DeviceInfoCache, ImmutableInfoIsQueriedOnce) {
+  unittest::PiMock Mock;
+  Mock.redefineBefore<detail::PiApiKind::piDeviceGetInfo>(
+      redefinedDeviceGetInfo);
+  device Dev = Mock.getPlatform().get_devices()[0];
+
+  InfoQueries.clear();
+  for (int I = 0; I < 3; ++I) {
+    Dev.get_info<info::device::max_work_group_size>();
+    Dev.get_info<info::device::max_compute_units>();
+    Dev.has(aspect::fp64);
+    Dev.has(aspect::usm_device_allocations);
+  }
+  EXPECT_EQ(InfoQueries[PI_DEVICE_INFO_MAX_WORK_GROUP_SIZE], 1u);
+  EXPECT_EQ(InfoQueries[PI_DEVICE_INFO_MAX_COMPUTE_UNITS], 1u);
+  // The extension string is queried for its size, then for its value.
+  EXPECT_EQ(InfoQueries[PI_DEVICE_INFO_EXTENSIONS], 2u);
+  EXPECT_EQ(InfoQueries[PI_DEVICE_INFO_USM_DEVICE_SUPPORT], 1u);
+}
@@ -0,0 +1,111 @@
+//==------- EventStatusCache.cpp --- Check caching of event status ---------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <helpers/PiMock.hpp>
+#include <helpers/TestKernel.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace sycl;
+
+static bool EventCompleted = false;
+static size_t StatusQueryCounter = 0;
+static pi_result redefinedEventGetInfo(pi_event, pi_event_info PName,
+                                       size_t PVSize, void *PV, size_t *) {
+  if (PName == PI_EVENT_INFO_COMMAND_EXECUTION_STATUS) {
+    ++StatusQueryCounter;
+    EXPECT_EQ(PVSize, 4u);
+    *(static_cast<pi_int32 *>(PV)) =
+        EventCompleted ? PI_EVENT_COMPLETE : PI_EVENT_SUBMITTED;
+  }
+  return PI_SUCCESS;
+}
+
+static size_t WaitCounter = 0;
+static pi_result redefinedEventsWait(pi_uint32, const pi_event *) {
+  ++WaitCounter;
+  return PI_SUCCESS;
+}
+
+// Check that the status of a native event isn't queried from the plugin
+// once the event is known to be complete.
+TEST(EventStatusCache, CompletedStatusIsCached) {
+  unittest::PiMock Mock;
+  Mock.redefine<detail::PiApiKind::piEventGetInfo>(redefinedEventGetInfo);
+  Mock.redefineBefore<detail::PiApiKind::piEventsWait>(redefinedEventsWait);
+  queue Q{Mock.getPlatform().get_devices()[0]};
+
+  EventCompleted = false;
+  event E = Q.single_task<TestKernel<>>([]() {});
+  StatusQueryCounter = 0;
+  EXPECT_EQ(E.get_info<info::event::command_execution_status>(),
+            info::event_command_status::submitted);
+  EXPECT_EQ(StatusQueryCounter, 1u);
+
+  EventCompleted = true;
+  EXPECT_EQ(E.get_info<info::event::command_execution_status>(),
+            info::event_command_status::complete);
+  EXPECT_EQ(E.get_info<info::event::command_execution_status>(),
+            info::event_command_status::complete);
+  EXPECT_EQ(StatusQueryCounter, 2u);
+
+  WaitCounter = 0;
+  E.wait();
+  EXPECT_EQ(WaitCounter, 0u);
+}
+
+// Check that waiting on a native event marks it as complete.
+TEST(EventStatusCache, WaitMarksEventComplete) {
+  unittest::PiMock Mock;
+  Mock.redefine<detail::PiApiKind::piEventGetInfo>(redefinedEventGetInfo);
+  Mock.redefineBefore<detail::PiApiKind::piEventsWait>(redefinedEventsWait);
+  queue Q{Mock.getPlatform().get_devices()[0]};
+
+  EventCompleted = false;
+  event E = Q.single_task<TestKernel<>>([]() {});
+  WaitCounter = 0;
+  E.wait();
+  E.wait();
+  EXPECT_EQ(WaitCounter, 1u);
+
+  StatusQueryCounter = 0;
+  EXPECT_EQ(E.get_info<info::event::command_execution_status>(),
+            info::event_command_status::complete);
+  EXPECT_EQ(StatusQueryCounter, 0u);
+}
+
+static size_t WaitedEventsCounter = 0;
+static pi_result redefinedEventsWaitCount(pi_uint32 NumEvents,
+                                          const pi_event *) {
+  ++WaitCounter;
+  WaitedEventsCounter += NumEvents;
+  return PI_SUCCESS;
+}
+
+// Check that the native events of a list of events are waited for at once.
+TEST(EventStatusCache, WaitListWaitsOnce) {
+  unittest::PiMock Mock;
+  Mock.redefine<detail::PiApiKind::piEventGetInfo>(redefinedEventGetInfo);
+  Mock.redefineBefore<detail::PiApiKind::piEventsWait>(
+      redefinedEventsWaitCount);
+  queue Q{Mock.getPlatform().get_devices()[0]};
+
+  EventCompleted = false;
+  std::vector<event> Events;
+  for (int I = 0; I < 4; ++I)
+    Events.push_back(Q.single_task<TestKernel<>>([]() {}));
+  WaitCounter = 0;
+  WaitedEventsCounter = 0;
+  event::wait(Events);
+  EXPECT_EQ(WaitCounter, 1u);
+  EXPECT_EQ(WaitedEventsCounter, 4u);
+
+  // The events are known to be complete afterwards.
+  event::wait_and_throw(Events);
+  EXPECT_EQ(WaitCounter, 1u);
+}
@@ -0,0 +1,198 @@
+//==---------- SetArgsBatched.cpp --- Handler unit tests -------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+#include <helpers/KernelInteropCommon.hpp>
+#include <helpers/MockKernelInfo.hpp>
+#include <helpers/PiImage.hpp>
+#include <helpers/PiMock.hpp>
+
+#include <sycl/sycl.hpp>
+
+#include <vector>
+
+// This test checks that all the arguments of a kernel are set with a single
+// piextKernelSetArgs call, which still reaches the per argument calls of the
+// mock plugin, and that the unchanged arguments of a cached kernel are not
+// set again.
+
+class TestKernelWithValueArgs;
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+template <>
+struct KernelInfo<TestKernelWithValueArgs>
+    : public unittest::MockKernelInfoBase {
+  static constexpr const char *getName() { return "TestKernelWithValueArgs"; }
+  static constexpr unsigned getNumParams() { return 2; }
+  static const detail::kernel_param_desc_t &getParamDesc(int Idx) {
+    static detail::kernel_param_desc_t Descs[] = {
+        {detail::kernel_param_kind_t::kind_std_layout, sizeof(int), 0},
+        {detail::kernel_param_kind_t::kind_std_layout, sizeof(int),
+         sizeof(int)}};
+    return Descs[Idx];
+  }
+  static constexpr int64_t getKernelSize() { return 2 * sizeof(int); }
+};
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
+
+static sycl::unittest::PiImage generateImage() {
+  using namespace sycl::unittest;
+
+  PiPropertySet PropSet;
+
+  std::vector<unsigned char> Bin{0, 1, 2, 3, 4, 5}; // Random data
+
+  PiArray<PiOffloadEntry> Entries =
+      makeEmptyKernels({"TestKernelWithValueArgs"});
+
+  PiImage Img{PI_DEVICE_BINARY_TYPE_SPIRV,            // Format
+              __SYCL_PI_DEVICE_BINARY_TARGET_SPIRV64, // DeviceTargetSpec
+              "",                                     // Compile options
+              "",                                     // Link options
+              std::move(Bin),
+              std::move(Entries),
+              std::move(PropSet)};
+
+  return Img;
+}
+
+static sycl::unittest::PiImage Img = generateImage();
+static sycl::unittest::PiImageArray<1> ImgArray{&Img};
+
+namespace {
+
+size_t SetArgsCalls = 0;
+std::vector<pi_kernel_arg_kind> ArgKinds;
+int ValueArg = 0;
+size_t PointerArgs = 0;
+
+pi_result after_piextKernelSetArgs(pi_kernel, pi_uint32 num_args,
+                                   const pi_kernel_arg *args) {
+  ++SetArgsCalls;
+  for (pi_uint32 I = 0; I < num_args; ++I)
+    ArgKinds.push_back(args[I].kind);
+  return PI_SUCCESS;
+}
+
+pi_result after_piKernelSetArg(pi_kernel, pi_uint32, size_t arg_size,
+                               const void *arg_value) {
+  if (arg_value && arg_size == sizeof(int))
+    ValueArg = *static_cast<const int *>(arg_value);
+  return PI_SUCCESS;
+}
+
+pi_result after_piextKernelSetArgPointer(pi_kernel, pi_uint32, size_t,
+                                         const void *) {
+  ++PointerArgs;
+  return PI_SUCCESS;
+}
+
+TEST(HandlerSetArg, BatchedArgs) {
+  sycl::unittest::PiMock Mock;
+  redefineMockForKernelInterop(Mock);
+  Mock.redefineAfter<sycl::detail::PiApiKind::piextKernelSetArgs>(
+      after_piextKernelSetArgs);
+  Mock.redefineAfter<sycl::detail::PiApiKind::piKernelSetArg>(
+      after_piKernelSetArg);
+  Mock.redefineAfter<sycl::detail::PiApiKind::piextKernelSetArgPointer>(
+      after_piextKernelSetArgPointer);
+
+  sycl::queue Q;
+
+  DummyHandleT handle;
+  auto KernelCL = reinterpret_cast<typename sycl::backend_traits<
+      sycl::backend::opencl>::template input_type<sycl::kernel>>(&handle);
+  auto Kernel =
+      sycl::make_kernel<sycl::backend::opencl>(KernelCL, Q.get_context());
+
+  int *Ptr = sycl::malloc_device<int>(1, Q);
+  Q.submit([&](sycl::handler &CGH) {
+     CGH.set_arg(0, 42);
+     CGH.set_arg(1, Ptr);
+     CGH.set_arg(2, sycl::local_accessor<float, 1>(16, CGH));
+     CGH.single_task(Kernel);
+   }).wait();
+  sycl::free(Ptr, Q);
+
+  ASSERT_EQ(SetArgsCalls, 1u);
+  ASSERT_EQ(ArgKinds.size(), 3u);
+  EXPECT_EQ(ArgKinds[0], PI_KERNEL_ARG_KIND_VALUE);
+  EXPECT_EQ(ArgKinds[1], PI_KERNEL_ARG_KIND_POINTER);
+  EXPECT_EQ(ArgKinds[2], PI_KERNEL_ARG_KIND_VALUE);
+  EXPECT_EQ(ValueArg, 42);
+  EXPECT_EQ(PointerArgs, 1u);
+}
+
+std::vector<pi_uint32> ArgIndices;
+
+pi_result after_piextKernelSetArgsIndices(pi_kernel, pi_uint32 num_args,
+                                          const pi_kernel_arg *args) {
+  for (pi_uint32 I = 0; I < num_args; ++I)
+    ArgIndices.push_back(args[I].index);
+  return PI_SUCCESS;
+}
+
+TEST(HandlerSetArg, UnchangedArgsOfCachedKernel) {
+  sycl::unittest::PiMock Mock;
+  Mock.redefineAfter<sycl::detail::PiApiKind::piextKernelSetArgs>(
+      after_piextKernelSetArgsIndices);
+  ArgIndices.clear();
+
+  sycl::queue Q;
+  auto Submit = [&](int A, int B) {
+    Q.single_task<TestKernelWithValueArgs>([=]() {
+       (void)A;
+       (void)B;
+     }).wait();
+  };
+
+  Submit(1, 2);
+  EXPECT_EQ(ArgIndices, (std::vector<pi_uint32>{0, 1}));
+  ArgIndices.clear();
+  Submit(1, 2);
+  EXPECT_TRUE(ArgIndices.empty()) << "Unchanged arguments were set again";
+  Submit(1, 3);
+  EXPECT_EQ(ArgIndices, (std::vector<pi_uint32>{1}));
+}
+
+TEST(HandlerSetArg, ArgsSetThroughKernelObjectAreForgotten) {
+  sycl::unittest::PiMock Mock;
+  Mock.redefineAfter<sycl::detail::PiApiKind::piextKernelSetArgs>(
+      after_piextKernelSetArgsIndices);
+  ArgIndices.clear();
+
+  sycl::queue Q;
+  auto Bundle = sycl::get_kernel_bundle<sycl::bundle_state::executable>(
+      Q.get_context(), {sycl::get_kernel_id<TestKernelWithValueArgs>()});
+  sycl::kernel Kernel = Bundle.get_kernel<TestKernelWithValueArgs>();
+  auto Submit = [&](int A, int B) {
+    Q.submit([&](sycl::handler &CGH) {
+       CGH.use_kernel_bundle(Bundle);
+       CGH.single_task<TestKernelWithValueArgs>([=]() {
+         (void)A;
+         (void)B;
+       });
+     }).wait();
+  };
+
+  Submit(1, 2);
+  Q.submit([&](sycl::handler &CGH) {
+     CGH.set_arg(0, 5);
+     CGH.set_arg(1, 6);
+     CGH.single_task(Kernel);
+   }).wait();
+  ArgIndices.clear();
+  // The kernel object shares the kernel, the arguments of which changed.
+  Submit(1, 2);
+  EXPECT_EQ(ArgIndices, (std::vector<pi_uint32>{0, 1}));
+}
+} // namespace
@@ -160,6 +160,51 @@ inline pi_plugin::FunctionPointers getProxyMockedFunctionPointers() {
 #undef PI_MOCK_PLUGIN_CONCAT
 #undef _PI_MOCK_PLUGIN_CONCAT
 
+} // namespace unittest
+} // namespace _V1
+} // namespace sycl
+
+inline pi_result mock_piextKernelSetArgs(pi_kernel kernel, pi_uint32 num_args,
+                                         const pi_kernel_arg *args) {
+  using namespace sycl::unittest;
+  for (pi_uint32 I = 0; I < num_args; ++I) {
+    const pi_kernel_arg &Arg = args[I];
+    pi_result Result = PI_SUCCESS;
+    switch (Arg.kind) {
+    case PI_KERNEL_ARG_KIND_VALUE:
+      Result = proxy_mock_piKernelSetArg<pi_result, pi_kernel, pi_uint32,
+                                         size_t, const void *>(
+          kernel, Arg.index, Arg.size, Arg.value);
+      break;
+    case PI_KERNEL_ARG_KIND_POINTER:
+      Result = proxy_mock_piextKernelSetArgPointer<pi_result, pi_kernel,
+                                                   pi_uint32, size_t,
+                                                   const void *>(
+          kernel, Arg.index, Arg.size, Arg.value);
+      break;
+    case PI_KERNEL_ARG_KIND_MEM_OBJ:
+      Result = proxy_mock_piextKernelSetArgMemObj<
+          pi_result, pi_kernel, pi_uint32, const pi_mem_obj_property *,
+          const pi_mem *>(kernel, Arg.index, Arg.mem_obj_properties,
+                          static_cast<const pi_mem *>(Arg.value));
+      break;
+    case PI_KERNEL_ARG_KIND_SAMPLER:
+      Result = proxy_mock_piextKernelSetArgSampler<pi_result, pi_kernel,
+                                                   pi_uint32,
+                                                   const pi_sampler *>(
+          kernel, Arg.index, static_cast<const pi_sampler *>(Arg.value));
+      break;
+    }
+    if (Result != PI_SUCCESS)
+      return Result;
+  }
+  return PI_SUCCESS;
+}
+
+namespace sycl {
+inline namespace _V1 {
+namespace unittest {
+
 /// The PiMock class manages the mock PI plugin and wraps an instance of a SYCL
 /// platform class created from this plugin. Additionally it allows for the
 /// redefinitions of functions in the PI API allowing tests to customize the
@@ -1158,6 +1158,11 @@ inline pi_result mock_piextKernelSetArgSampler(pi_kernel kernel,
   return PI_SUCCESS;
 }
 
+// Defined in PiMock.hpp, it sets the arguments one by one through the mocked
+// functions so that their redefinitions see every argument.
+inline pi_result mock_piextKernelSetArgs(pi_kernel kernel, pi_uint32 num_args,
+                                         const pi_kernel_arg *args);
+
 ///
 // USM
 ///
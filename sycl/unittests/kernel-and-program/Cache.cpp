@@ -531,3 +531,37 @@ TEST_F(KernelAndProgramFastCacheTest, DISABLED_KernelNegativeSource) {
       MockKernelProgramCache::getFastCache(CtxImpl->getKernelProgramCache());
   EXPECT_EQ(Cache.size(), 0U) << "Expect empty cache for kernels";
 }
+
+// Check that a kernel is not found through another kernel whose name has the
+// same hash.
+TEST_F(KernelAndProgramFastCacheTest, KernelNameHashCollision) {
+  using KPC = detail::KernelProgramCache;
+  context Ctx{Plt};
+  KPC &Cache = detail::getSyclObjImpl(Ctx)->getKernelProgramCache();
+
+  KPC::KernelFastCacheKeyT Key{nullptr, KPC::getStringId(""), 42};
+  KPC::KernelFastCacheValT Val{reinterpret_cast<pi_kernel>(1), nullptr,
+                               nullptr, reinterpret_cast<pi_program>(2)};
+  Cache.saveKernel(Key, "CacheTestKernelFoo", Val);
+  EXPECT_EQ(std::get<0>(Cache.tryToGetKernelFast(Key, "CacheTestKernelBar")),
+            nullptr);
+}
+
+// Check that the fast cache key components are interned consistently.
+TEST(KernelProgramCacheStringId, SameStringSameId) {
+  using KPC = detail::KernelProgramCache;
+  KPC::StringIdT FooId = KPC::getStringId("CacheTestKernelFoo");
+  KPC::StringIdT BarId = KPC::getStringId("CacheTestKernelBar");
+  EXPECT_NE(FooId, BarId);
+  EXPECT_EQ(KPC::getStringId(std::string("CacheTestKernel") + "Foo"), FooId);
+  EXPECT_EQ(KPC::getStringId("CacheTestKernelBar"), BarId);
+}
+
+// Check that the kernel name hash computed at compile time by the handler is
+// the one computed at run time for the kernels without it.
+TEST(KernelProgramCacheStringId, KernelNameHash) {
+  constexpr uint64_t FooHash = detail::getKernelNameHash("CacheTestKernelFoo");
+  std::string Foo = std::string("CacheTestKernel") + "Foo";
+  EXPECT_EQ(detail::getKernelNameHash(Foo.c_str()), FooHash);
+  EXPECT_NE(detail::getKernelNameHash("CacheTestKernelBar"), FooHash);
+}
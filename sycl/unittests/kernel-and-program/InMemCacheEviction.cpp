@@ -0,0 +1,127 @@
+//==------ InMemCacheEviction.cpp --- in-memory cache eviction unit test ---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/config.hpp>
+#include <detail/context_impl.hpp>
+#include <detail/kernel_program_cache.hpp>
+#include <helpers/PiMock.hpp>
+#include <helpers/ScopedEnvVar.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <mutex>
+
+using namespace sycl;
+using KPC = detail::KernelProgramCache;
+
+static KPC::ProgramCacheKeyT makeKey(std::uintptr_t ImgId,
+                                     detail::pi::PiDevice Dev) {
+  return std::make_pair(std::make_pair(detail::SerializedObj{}, ImgId), Dev);
+}
+
+static void insertBuiltProgram(KPC &Cache, const KPC::ProgramCacheKeyT &Key) {
+  auto [BuildResult, DidInsert] = Cache.getOrInsertProgram(Key);
+  ASSERT_TRUE(DidInsert);
+  BuildResult->State.store(KPC::BuildState::BS_Done);
+}
+
+class InMemCacheEvictionTest : public ::testing::Test {
+protected:
+  unittest::ScopedEnvVar MaxSizeVar{
+      detail::SYCLConfig<detail::SYCL_CACHE_IN_MEM_MAX_SIZE>::getName(), "10",
+      detail::SYCLConfig<detail::SYCL_CACHE_IN_MEM_MAX_SIZE>::reset};
+  unittest::PiMock Mock;
+};
+
+TEST_F(InMemCacheEvictionTest, LeastRecentlyUsedProgramIsEvicted) {
+  context Ctx{Mock.getPlatform()};
+  auto CtxImpl = detail::getSyclObjImpl(Ctx);
+  KPC &Cache = CtxImpl->getKernelProgramCache();
+  detail::pi::PiDevice Dev =
+      detail::getSyclObjImpl(Ctx.get_devices()[0])->getHandleRef();
+
+  KPC::ProgramCacheKeyT Key1 = makeKey(1, Dev);
+  KPC::ProgramCacheKeyT Key2 = makeKey(2, Dev);
+  KPC::ProgramCacheKeyT Key3 = makeKey(3, Dev);
+
+  insertBuiltProgram(Cache, Key1);
+  Cache.registerProgramFetch(Key1, 4, /*IsEvictable=*/true);
+  insertBuiltProgram(Cache, Key2);
+  Cache.registerProgramFetch(Key2, 4, /*IsEvictable=*/true);
+  // Key1 becomes the most recently used program.
+  Cache.registerProgramFetch(Key1, 4, /*IsEvictable=*/true);
+  insertBuiltProgram(Cache, Key3);
+  Cache.registerProgramFetch(Key3, 4, /*IsEvictable=*/true);
+
+  {
+    auto LockedCache = Cache.acquireCachedPrograms();
+    auto &ProgCache = LockedCache.get();
+    EXPECT_EQ(ProgCache.size(), 2u);
+    EXPECT_EQ(ProgCache.Cache.count(Key2), 0u);
+    EXPECT_EQ(ProgCache.KeyMap.count(std::make_pair(std::uintptr_t{2}, Dev)),
+              0u);
+  }
+
+  KPC::CacheStats Stats = Cache.getStats();
+  EXPECT_EQ(Stats.ProgramMisses, 3u);
+  EXPECT_EQ(Stats.ProgramEvictions, 1u);
+}
+
+TEST_F(InMemCacheEvictionTest, NonEvictableProgramIsKept) {
+  context Ctx{Mock.getPlatform()};
+  auto CtxImpl = detail::getSyclObjImpl(Ctx);
+  KPC &Cache = CtxImpl->getKernelProgramCache();
+  detail::pi::PiDevice Dev =
+      detail::getSyclObjImpl(Ctx.get_devices()[0])->getHandleRef();
+
+  KPC::ProgramCacheKeyT Key1 = makeKey(1, Dev);
+  KPC::ProgramCacheKeyT Key2 = makeKey(2, Dev);
+
+  insertBuiltProgram(Cache, Key1);
+  Cache.registerProgramFetch(Key1, 8, /*IsEvictable=*/false);
+  insertBuiltProgram(Cache, Key2);
+  Cache.registerProgramFetch(Key2, 8, /*IsEvictable=*/true);
+
+  EXPECT_EQ(Cache.acquireCachedPrograms().get().size(), 2u);
+  EXPECT_EQ(Cache.getStats().ProgramEvictions, 0u);
+}
+
+TEST_F(InMemCacheEvictionTest, KernelsOfEvictedProgramAreReleasedOnceUnused) {
+  context Ctx{Mock.getPlatform()};
+  auto CtxImpl = detail::getSyclObjImpl(Ctx);
+  KPC &Cache = CtxImpl->getKernelProgramCache();
+  detail::pi::PiDevice Dev =
+      detail::getSyclObjImpl(Ctx.get_devices()[0])->getHandleRef();
+
+  // The programs are not built, so their kernels are cached for a null
+  // program.
+  std::weak_ptr<KPC::KernelBuildResult> Kernel;
+  std::shared_ptr<std::mutex> KernelMutex;
+  {
+    auto [BuildResult, DidInsert] = Cache.getOrInsertKernel(nullptr, "K");
+    ASSERT_TRUE(DidInsert);
+    BuildResult->State.store(KPC::BuildState::BS_Done);
+    Kernel = BuildResult;
+    KernelMutex = std::shared_ptr<std::mutex>(BuildResult,
+                                              &BuildResult->MBuildResultMutex);
+  }
+
+  KPC::ProgramCacheKeyT Key1 = makeKey(1, Dev);
+  KPC::ProgramCacheKeyT Key2 = makeKey(2, Dev);
+  insertBuiltProgram(Cache, Key1);
+  Cache.registerProgramFetch(Key1, 8, /*IsEvictable=*/true);
+  insertBuiltProgram(Cache, Key2);
+  Cache.registerProgramFetch(Key2, 8, /*IsEvictable=*/true);
+  ASSERT_EQ(Cache.getStats().ProgramEvictions, 1u);
+
+  // The mutex of the kernel may still be used by the thread which got it.
+  EXPECT_FALSE(Kernel.expired());
+  KernelMutex.reset();
+  EXPECT_TRUE(Kernel.expired());
+}
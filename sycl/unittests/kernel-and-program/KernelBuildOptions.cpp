@@ -126,3 +126,24 @@ TEST(KernelBuildOptions, KernelBundleBasic) {
   auto LinkBundle = sycl::link(ObjBundle, ObjBundle.get_devices());
   EXPECT_EQ(BuildOpts, "-link-img");
 }
+
+TEST(KernelBuildOptions, KernelBundleBuildAsync) {
+  sycl::unittest::PiMock Mock;
+  sycl::platform Plt = Mock.getPlatform();
+  setupCommonMockAPIs(Mock);
+
+  const sycl::device Dev = Plt.get_devices()[0];
+  const sycl::context Ctx{Dev};
+  auto KernelID = sycl::get_kernel_id<BuildOptsTestKernel>();
+  sycl::kernel_bundle KernelBundle =
+      sycl::get_kernel_bundle<sycl::bundle_state::input>(Ctx, {Dev},
+                                                         {KernelID});
+  BuildOpts.clear();
+  std::future<sycl::kernel_bundle<sycl::bundle_state::executable>> Future =
+      sycl::ext::oneapi::experimental::build_async(KernelBundle);
+  sycl::kernel_bundle<sycl::bundle_state::executable> ExecBundle =
+      Future.get();
+  EXPECT_TRUE(ExecBundle.has_kernel(KernelID));
+  EXPECT_EQ(BuildOpts,
+            "-compile-img -vc-codegen -disable-finalizer-msg -link-img");
+}
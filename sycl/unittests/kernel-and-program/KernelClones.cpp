@@ -0,0 +1,111 @@
+//==------------ KernelClones.cpp --- kernel clone pool unit test ----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/config.hpp>
+#include <detail/context_impl.hpp>
+#include <detail/kernel_program_cache.hpp>
+#include <helpers/PiMock.hpp>
+#include <helpers/ScopedEnvVar.hpp>
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+
+using namespace sycl;
+using KPC = detail::KernelProgramCache;
+
+static int KernelCreateCalls = 0;
+static int KernelReleaseCalls = 0;
+
+static pi_result after_piKernelCreate(pi_program, const char *, pi_kernel *) {
+  ++KernelCreateCalls;
+  return PI_SUCCESS;
+}
+
+static pi_result after_piKernelRelease(pi_kernel) {
+  ++KernelReleaseCalls;
+  return PI_SUCCESS;
+}
+
+class KernelClonesTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    KernelCreateCalls = 0;
+    KernelReleaseCalls = 0;
+    Mock.redefineAfter<detail::PiApiKind::piKernelCreate>(
+        after_piKernelCreate);
+    Mock.redefineAfter<detail::PiApiKind::piKernelRelease>(
+        after_piKernelRelease);
+  }
+
+  unittest::ScopedEnvVar MaxClonesVar{
+      detail::SYCLConfig<detail::SYCL_CACHE_KERNEL_CLONES>::getName(), "1",
+      detail::SYCLConfig<detail::SYCL_CACHE_KERNEL_CLONES>::reset};
+  unittest::PiMock Mock;
+  // Not used by the mock plugin.
+  detail::pi::PiProgram Program = reinterpret_cast<detail::pi::PiProgram>(1);
+};
+
+TEST_F(KernelClonesTest, IdleCloneIsReused) {
+  context Ctx{Mock.getPlatform()};
+  KPC &Cache = detail::getSyclObjImpl(Ctx)->getKernelProgramCache();
+  auto KernelMutex = std::make_shared<std::mutex>();
+
+  KPC::KernelClone Clone = Cache.acquireKernelClone(KernelMutex, Program, "K");
+  ASSERT_NE(Clone.Kernel, nullptr);
+  EXPECT_EQ(KernelCreateCalls, 1);
+  Cache.releaseKernelClone(Clone);
+
+  KPC::KernelClone Reused =
+      Cache.acquireKernelClone(KernelMutex, Program, "K");
+  EXPECT_EQ(Reused.Kernel, Clone.Kernel);
+  EXPECT_EQ(KernelCreateCalls, 1);
+  Cache.releaseKernelClone(Reused);
+  EXPECT_EQ(KernelReleaseCalls, 0);
+}
+
+TEST_F(KernelClonesTest, LeastRecentlyUsedCloneIsReleased) {
+  context Ctx{Mock.getPlatform()};
+  KPC &Cache = detail::getSyclObjImpl(Ctx)->getKernelProgramCache();
+  auto KernelMutex1 = std::make_shared<std::mutex>();
+  auto KernelMutex2 = std::make_shared<std::mutex>();
+
+  KPC::KernelClone Clone1 =
+      Cache.acquireKernelClone(KernelMutex1, Program, "K1");
+  KPC::KernelClone Clone2 =
+      Cache.acquireKernelClone(KernelMutex2, Program, "K2");
+  EXPECT_EQ(KernelCreateCalls, 2);
+  Cache.releaseKernelClone(Clone1);
+  // Only one idle clone is kept.
+  Cache.releaseKernelClone(Clone2);
+  EXPECT_EQ(KernelReleaseCalls, 1);
+
+  KPC::KernelClone Reused =
+      Cache.acquireKernelClone(KernelMutex2, Program, "K2");
+  EXPECT_EQ(Reused.Kernel, Clone2.Kernel);
+  Cache.releaseKernelClone(Reused);
+  EXPECT_EQ(KernelCreateCalls, 2);
+}
+
+TEST_F(KernelClonesTest, ClonesAreReleasedOnReset) {
+  context Ctx{Mock.getPlatform()};
+  KPC &Cache = detail::getSyclObjImpl(Ctx)->getKernelProgramCache();
+  auto KernelMutex1 = std::make_shared<std::mutex>();
+  auto KernelMutex2 = std::make_shared<std::mutex>();
+
+  KPC::KernelClone Idle =
+      Cache.acquireKernelClone(KernelMutex1, Program, "K1");
+  KPC::KernelClone InUse =
+      Cache.acquireKernelClone(KernelMutex2, Program, "K2");
+  Cache.releaseKernelClone(Idle);
+  Cache.reset();
+  EXPECT_EQ(KernelReleaseCalls, 1);
+  // The clone of the previous generation is not kept.
+  Cache.releaseKernelClone(InUse);
+  EXPECT_EQ(KernelReleaseCalls, 2);
+}
@@ -8,6 +8,7 @@
 // This file contains tests covering persistena device code cache functionality.
 // Detailed description of the tests cases can be seen per test function.
 #include "../thread_safety/ThreadUtils.h"
+#include "detail/global_handler.hpp"
 #include "detail/persistent_device_code_cache.hpp"
 #include <detail/device_binary_image.hpp>
 #include <gtest/gtest.h>
@@ -16,8 +17,10 @@
 #include <sycl/detail/os_util.hpp>
 #include <sycl/sycl.hpp>
 
+#include <algorithm>
 #include <cstdio>
 #include <fstream>
+#include <map>
 #include <optional>
 #include <vector>
 
@@ -451,6 +454,246 @@ TEST_P(PersistentDeviceCodeCache, AccessDeniedForCacheDir) {
 }
 #endif //_WIN32
 
+/* Checks that an item written asynchronously can be read once the background
+ * writer has been flushed.
+ */
+TEST_P(PersistentDeviceCodeCache, AsyncWrite) {
+  DeviceCodeID = 1;
+  std::string BuildOptions{"--async-write"};
+  std::string ItemDir = detail::PersistentDeviceCodeCache::getCacheItemPath(
+      Dev, Img, {}, BuildOptions);
+  ASSERT_NO_ERROR(llvm::sys::fs::remove_directories(ItemDir));
+
+  detail::PersistentDeviceCodeCache::putItemToDiscAsync(Dev, Img, {},
+                                                        BuildOptions, NativeProg);
+  detail::GlobalHandler::instance().getPersistentCacheWriter().flush();
+
+  auto Res = detail::PersistentDeviceCodeCache::getItemFromDisc(Dev, Img, {},
+                                                                BuildOptions);
+  ASSERT_EQ(Res.size(), Progs[DeviceCodeID].size())
+      << "Failed to load cache item";
+  for (size_t i = 0; i < Res.size(); ++i) {
+    for (size_t j = 0; j < Res[i].size(); ++j) {
+      EXPECT_EQ(Res[i][j], static_cast<char>(i))
+          << "Corrupted image loaded from persistent cache";
+    }
+  }
+  ASSERT_NO_ERROR(llvm::sys::fs::remove_directories(ItemDir));
+}
+
+/* Checks that cache items are stored in and read from the index file and the
+ * blob store when the indexed layout is selected, and that items with other
+ * keys are not found.
+ */
+TEST_P(PersistentDeviceCodeCache, IndexedLayout) {
+  set_env("SYCL_CACHE_LAYOUT", "indexed");
+  detail::SYCLConfig<detail::SYCL_CACHE_LAYOUT>::reset();
+  std::string RootDir = detail::SYCLConfig<detail::SYCL_CACHE_DIR>::get();
+  ASSERT_NO_ERROR(llvm::sys::fs::remove_directories(RootDir));
+
+  DeviceCodeID = 2;
+  std::string BuildOptions{"--indexed"};
+  std::string ItemDir = detail::PersistentDeviceCodeCache::getCacheItemPath(
+      Dev, Img, {}, BuildOptions);
+  detail::PersistentDeviceCodeCache::putItemToDisc(Dev, Img, {}, BuildOptions,
+                                                   NativeProg);
+  EXPECT_TRUE(llvm::sys::fs::exists(RootDir + "/index.bin"))
+      << "No index file created";
+  EXPECT_FALSE(llvm::sys::fs::exists(ItemDir))
+      << "Cache item directory created for the indexed layout";
+
+  auto Res = detail::PersistentDeviceCodeCache::getItemFromDisc(Dev, Img, {},
+                                                                BuildOptions);
+  ASSERT_EQ(Res.size(), Progs[DeviceCodeID].size())
+      << "Failed to load cache item";
+  for (size_t i = 0; i < Res.size(); ++i) {
+    ASSERT_EQ(Res[i].size(), static_cast<size_t>(Progs[DeviceCodeID][i]));
+    for (size_t j = 0; j < Res[i].size(); ++j) {
+      EXPECT_EQ(Res[i][j], static_cast<char>(i))
+          << "Corrupted image loaded from persistent cache";
+    }
+  }
+
+  Res = detail::PersistentDeviceCodeCache::getItemFromDisc(Dev, Img, {},
+                                                           "--other-options");
+  EXPECT_EQ(Res.size(), static_cast<size_t>(0))
+      << "Item with different build options was read";
+
+  set_env("SYCL_CACHE_LAYOUT", nullptr);
+  detail::SYCLConfig<detail::SYCL_CACHE_LAYOUT>::reset();
+  ASSERT_NO_ERROR(llvm::sys::fs::remove_directories(RootDir));
+}
+
+/* Checks that adding an item when all its probed index slots are taken evicts
+ * a single item instead of the whole index.
+ */
+TEST_P(PersistentDeviceCodeCache, IndexedLayoutEvictsSingleItem) {
+  set_env("SYCL_CACHE_LAYOUT", "indexed");
+  detail::SYCLConfig<detail::SYCL_CACHE_LAYOUT>::reset();
+  std::string RootDir = detail::SYCLConfig<detail::SYCL_CACHE_DIR>::get();
+  ASSERT_NO_ERROR(llvm::sys::fs::remove_directories(RootDir));
+
+  DeviceCodeID = 2;
+  detail::PersistentDeviceCodeCache::putItemToDisc(Dev, Img, {}, "--first",
+                                                   NativeProg);
+
+  // Fill all the free slots of the index with newer items.
+  struct {
+    char Magic[8];
+    uint64_t Generation;
+    uint64_t NumSlots;
+  } Header;
+  struct Slot {
+    uint64_t Hash[2];
+    uint64_t Offset;
+    uint64_t Size;
+  };
+  std::string IndexPath = RootDir + "/index.bin";
+  std::fstream Index{IndexPath, std::ios::binary | std::ios::in |
+                                    std::ios::out};
+  Index.read((char *)&Header, sizeof(Header));
+  std::vector<Slot> Slots(Header.NumSlots);
+  Index.read((char *)Slots.data(), Slots.size() * sizeof(Slot));
+  for (size_t I = 0; I < Slots.size(); ++I)
+    if (Slots[I].Hash[0] == 0)
+      Slots[I] = Slot{{I + 1, I + 1}, uint64_t(1) << 40, 1};
+  Index.seekp(sizeof(Header));
+  Index.write((const char *)Slots.data(), Slots.size() * sizeof(Slot));
+  Index.close();
+  ASSERT_FALSE(Index.fail());
+
+  detail::PersistentDeviceCodeCache::putItemToDisc(Dev, Img, {}, "--second",
+                                                   NativeProg);
+  auto Res = detail::PersistentDeviceCodeCache::getItemFromDisc(Dev, Img, {},
+                                                                "--second");
+  EXPECT_EQ(Res.size(), Progs[DeviceCodeID].size())
+      << "Failed to load cache item";
+
+  std::ifstream NewIndex{IndexPath, std::ios::binary};
+  uint64_t Generation = Header.Generation;
+  NewIndex.read((char *)&Header, sizeof(Header));
+  NewIndex.read((char *)Slots.data(), Slots.size() * sizeof(Slot));
+  EXPECT_EQ(Header.Generation, Generation) << "Cache index was reset";
+  EXPECT_EQ(std::count_if(Slots.begin(), Slots.end(),
+                          [](const Slot &S) { return S.Hash[0] != 0; }),
+            static_cast<std::ptrdiff_t>(Slots.size()))
+      << "More than one cache item evicted";
+
+  set_env("SYCL_CACHE_LAYOUT", nullptr);
+  detail::SYCLConfig<detail::SYCL_CACHE_LAYOUT>::reset();
+  ASSERT_NO_ERROR(llvm::sys::fs::remove_directories(RootDir));
+}
+
+/* Checks that cache items are sent to the remote store, and that the items
+ * missing from the local cache are read from it and cached locally.
+ */
+TEST_P(PersistentDeviceCodeCache, RemoteBackend) {
+  struct TestBackend : detail::PersistentCacheBackend {
+    bool get(const std::string &Key, std::string &Data) override {
+      auto It = Items.find(Key);
+      if (It == Items.end())
+        return false;
+      Data = It->second;
+      return true;
+    }
+    void put(const std::string &Key, const std::string &Data) override {
+      Items[Key] = Data;
+    }
+    std::map<std::string, std::string> Items;
+  };
+  auto Backend = std::make_shared<TestBackend>();
+  detail::PersistentDeviceCodeCache::setRemoteBackend(Backend);
+  std::string RootDir = detail::SYCLConfig<detail::SYCL_CACHE_DIR>::get();
+  ASSERT_NO_ERROR(llvm::sys::fs::remove_directories(RootDir));
+
+  DeviceCodeID = 1;
+  std::string BuildOptions{"--remote"};
+  detail::PersistentDeviceCodeCache::putItemToDisc(Dev, Img, {}, BuildOptions,
+                                                   NativeProg);
+  EXPECT_EQ(Backend->Items.size(), static_cast<size_t>(1))
+      << "Cache item not sent to the remote store";
+
+  // Another node only has the item in the remote store.
+  ASSERT_NO_ERROR(llvm::sys::fs::remove_directories(RootDir));
+  auto Res = detail::PersistentDeviceCodeCache::getItemFromDisc(Dev, Img, {},
+                                                                BuildOptions);
+  ASSERT_EQ(Res.size(), Progs[DeviceCodeID].size())
+      << "Failed to load cache item from the remote store";
+  for (size_t i = 0; i < Res.size(); ++i) {
+    ASSERT_EQ(Res[i].size(), static_cast<size_t>(Progs[DeviceCodeID][i]));
+    for (size_t j = 0; j < Res[i].size(); ++j) {
+      EXPECT_EQ(Res[i][j], static_cast<char>(i))
+          << "Corrupted image loaded from the remote store";
+    }
+  }
+  EXPECT_TRUE(llvm::sys::fs::exists(
+      detail::PersistentDeviceCodeCache::getCacheItemPath(Dev, Img, {},
+                                                          BuildOptions)))
+      << "Remote cache item not cached locally";
+
+  EXPECT_TRUE(detail::PersistentDeviceCodeCache::getItemFromDisc(
+                  Dev, Img, {}, "--other-options")
+                  .empty())
+      << "Item with different build options was read";
+
+  detail::PersistentDeviceCodeCache::setRemoteBackend(nullptr);
+  ASSERT_NO_ERROR(llvm::sys::fs::remove_directories(RootDir));
+}
+
+/* Checks that fused kernels are read back only with the same key sources.
+ */
+TEST_P(PersistentDeviceCodeCache, FusedKernels) {
+  std::string RootDir = detail::SYCLConfig<detail::SYCL_CACHE_DIR>::get();
+  ASSERT_NO_ERROR(llvm::sys::fs::remove_directories(RootDir));
+
+  std::string KeySources{"fused\0kernel", 12};
+  std::vector<char> Data{'b', 'i', 'n', '\0', 'a', 'r', 'y'};
+  EXPECT_TRUE(detail::PersistentDeviceCodeCache::getFusedKernelFromDisc(
+                  Dev, KeySources)
+                  .empty());
+
+  detail::PersistentDeviceCodeCache::putFusedKernelToDisc(Dev, KeySources,
+                                                          Data);
+  auto Res = detail::PersistentDeviceCodeCache::getFusedKernelFromDisc(
+      Dev, KeySources);
+  EXPECT_EQ(Res, Data) << "Corrupted fused kernel loaded from persistent cache";
+  EXPECT_TRUE(detail::PersistentDeviceCodeCache::getFusedKernelFromDisc(
+                  Dev, KeySources + '1')
+                  .empty())
+      << "Fused kernel with different key sources was read";
+
+  ASSERT_NO_ERROR(llvm::sys::fs::remove_directories(RootDir));
+}
+
+/* Checks that the native objects of the device libraries are read back only
+ * with the same key sources.
+ */
+TEST_P(PersistentDeviceCodeCache, DeviceLibs) {
+  std::string RootDir = detail::SYCLConfig<detail::SYCL_CACHE_DIR>::get();
+  ASSERT_NO_ERROR(llvm::sys::fs::remove_directories(RootDir));
+
+  DeviceCodeID = 0;
+  std::string KeySources{"libsycl-fallback-cmath.spv:128:1"};
+  EXPECT_TRUE(
+      detail::PersistentDeviceCodeCache::getDeviceLibFromDisc(Dev, KeySources)
+          .empty());
+
+  detail::PersistentDeviceCodeCache::putDeviceLibToDisc(Dev, KeySources,
+                                                        NativeProg);
+  auto Res =
+      detail::PersistentDeviceCodeCache::getDeviceLibFromDisc(Dev, KeySources);
+  ASSERT_EQ(Res.size(), static_cast<size_t>(Progs[DeviceCodeID][0]))
+      << "Failed to load device library";
+  for (char Byte : Res)
+    EXPECT_EQ(Byte, 0) << "Corrupted device library loaded from cache";
+  EXPECT_TRUE(detail::PersistentDeviceCodeCache::getDeviceLibFromDisc(
+                  Dev, KeySources + '1')
+                  .empty())
+      << "Device library with different key sources was read";
+
+  ASSERT_NO_ERROR(llvm::sys::fs::remove_directories(RootDir));
+}
+
 INSTANTIATE_TEST_SUITE_P(PersistentDeviceCodeCacheImpl,
                          PersistentDeviceCodeCache,
                          ::testing::Values(PI_DEVICE_BINARY_TYPE_SPIRV,
@@ -0,0 +1,152 @@
+//==------- WGSizeAutotune.cpp --- check work-group size autotuning -------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/context_impl.hpp>
+#include <detail/kernel_program_cache.hpp>
+#include <detail/wg_size_autotuner.hpp>
+#include <helpers/PiMock.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <map>
+
+using namespace sycl;
+
+namespace {
+// Completion times of the fake events of the timed launches.
+std::map<pi_event, uint64_t> EventTimes;
+bool EventsComplete = true;
+
+pi_result redefinedKernelGetGroupInfo(pi_kernel, pi_device,
+                                      pi_kernel_group_info ParamName, size_t,
+                                      void *ParamValue, size_t *) {
+  if (ParamName == PI_KERNEL_GROUP_INFO_WORK_GROUP_SIZE && ParamValue)
+    *static_cast<size_t *>(ParamValue) = 256;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedDeviceGetInfo(pi_device, pi_device_info ParamName, size_t,
+                                 void *ParamValue, size_t *) {
+  if (ParamName == PI_DEVICE_INFO_MAX_WORK_ITEM_SIZES && ParamValue) {
+    size_t *Sizes = static_cast<size_t *>(ParamValue);
+    Sizes[0] = Sizes[1] = Sizes[2] = 256;
+  }
+  return PI_SUCCESS;
+}
+
+pi_result redefinedEventGetInfo(pi_event, pi_event_info ParamName, size_t,
+                                void *ParamValue, size_t *) {
+  if (ParamName == PI_EVENT_INFO_COMMAND_EXECUTION_STATUS && ParamValue)
+    *static_cast<pi_event_status *>(ParamValue) =
+        EventsComplete ? PI_EVENT_COMPLETE : PI_EVENT_RUNNING;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedEventGetProfilingInfo(pi_event Event,
+                                         pi_profiling_info ParamName, size_t,
+                                         void *ParamValue, size_t *) {
+  *static_cast<uint64_t *>(ParamValue) =
+      ParamName == PI_PROFILING_INFO_COMMAND_END ? EventTimes[Event] : 0;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedEventRetainRelease(pi_event) { return PI_SUCCESS; }
+
+class WGSizeAutotuneTest : public ::testing::Test {
+public:
+  WGSizeAutotuneTest()
+      : Mock{}, Ctx{Mock.getPlatform()}, CtxImpl{detail::getSyclObjImpl(Ctx)},
+        DevImpl{detail::getSyclObjImpl(Ctx.get_devices()[0])} {}
+
+protected:
+  void SetUp() override {
+    EventTimes.clear();
+    EventsComplete = true;
+    Mock.redefine<detail::PiApiKind::piKernelGetGroupInfo>(
+        redefinedKernelGetGroupInfo);
+    Mock.redefineAfter<detail::PiApiKind::piDeviceGetInfo>(
+        redefinedDeviceGetInfo);
+    Mock.redefine<detail::PiApiKind::piEventGetInfo>(redefinedEventGetInfo);
+    Mock.redefine<detail::PiApiKind::piEventGetProfilingInfo>(
+        redefinedEventGetProfilingInfo);
+    Mock.redefine<detail::PiApiKind::piEventRetain>(
+        redefinedEventRetainRelease);
+    Mock.redefine<detail::PiApiKind::piEventRelease>(
+        redefinedEventRetainRelease);
+  }
+
+  // Selects the local size of a launch over GlobalSize work-items and times
+  // it as taking longer the further its work-groups are from 64 work-items.
+  // Returns the local size, or 0 if the backend chooses it.
+  size_t launch(size_t GlobalSize, bool CanSample = true) {
+    detail::wg_size_autotuner &Autotuner =
+        CtxImpl->getKernelProgramCache().getWGSizeAutotuner();
+    size_t LocalSize[3] = {0, 0, 0};
+    std::optional<detail::wg_size_autotuner::sample> Sample;
+    bool HasLocalSize = Autotuner.selectLocalSize(
+        DevImpl, CtxImpl->getPlugin(), nullptr, "Kernel", 1, &GlobalSize,
+        CanSample, LocalSize, Sample);
+    if (Sample) {
+      pi_event Event = reinterpret_cast<pi_event>(++NextEvent);
+      size_t Size = HasLocalSize ? LocalSize[0] : 1024;
+      EventTimes[Event] = 1 + (Size > 64 ? Size - 64 : 64 - Size);
+      Autotuner.startSample(std::move(*Sample), CtxImpl->getPlugin(), Event);
+    }
+    return HasLocalSize ? LocalSize[0] : 0;
+  }
+
+  unittest::PiMock Mock;
+  context Ctx;
+  std::shared_ptr<detail::context_impl> CtxImpl;
+  std::shared_ptr<detail::device_impl> DevImpl;
+  std::uintptr_t NextEvent = 0;
+};
+} // namespace
+
+TEST_F(WGSizeAutotuneTest, FastestLocalSizeIsKept) {
+  // The backend and the sizes from 16 to 256 are each timed twice.
+  std::map<size_t, int> NumLaunches;
+  for (int I = 0; I < 12; ++I)
+    ++NumLaunches[launch(1024)];
+  EXPECT_EQ(NumLaunches.size(), 6u);
+  for (auto &[LocalSize, Count] : NumLaunches)
+    EXPECT_EQ(Count, 2) << LocalSize;
+
+  for (int I = 0; I < 4; ++I)
+    EXPECT_EQ(launch(1024), 64u);
+  // Launches which cannot be timed use the chosen size too.
+  EXPECT_EQ(launch(1024, /*CanSample=*/false), 64u);
+}
+
+TEST_F(WGSizeAutotuneTest, PendingLaunchesAreNotCounted) {
+  EventsComplete = false;
+  for (int I = 0; I < 12; ++I)
+    launch(1024);
+  // All the candidates are launched, so the backend chooses until their
+  // timings are read.
+  EXPECT_EQ(launch(1024), 0u);
+  EventsComplete = true;
+  EXPECT_EQ(launch(1024), 64u);
+}
+
+TEST_F(WGSizeAutotuneTest, LocalSizesDivideGlobalSize) {
+  // Only 16 and 32 divide 96, so with the backend three candidates are timed.
+  std::map<size_t, int> NumLaunches;
+  for (int I = 0; I < 6; ++I)
+    ++NumLaunches[launch(96)];
+  EXPECT_EQ(NumLaunches.size(), 3u);
+  EXPECT_EQ(NumLaunches.count(16), 1u);
+  EXPECT_EQ(NumLaunches.count(32), 1u);
+  EXPECT_EQ(launch(96), 32u);
+}
+
+TEST_F(WGSizeAutotuneTest, UntimedLaunchesUseBackendChoice) {
+  EXPECT_EQ(launch(1024, /*CanSample=*/false), 0u);
+  EXPECT_EQ(launch(1 << 20, /*CanSample=*/false), 0u);
+}
@@ -0,0 +1,65 @@
+//==---- ObjectPool.cpp ----------------------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+
+#include <detail/object_pool.hpp>
+#include <sycl/accessor.hpp>
+
+#include <memory>
+#include <thread>
+
+using namespace sycl::detail;
+
+TEST(ObjectPoolTest, BlocksAreReused) {
+  void *First = allocatePooled(100);
+  deallocatePooled(First, 100);
+
+  ObjectPoolStats Before = getObjectPoolStats();
+  // Any size of the same size class reuses the freed block.
+  void *Second = allocatePooled(97);
+  EXPECT_EQ(First, Second);
+  ObjectPoolStats After = getObjectPoolStats();
+  EXPECT_EQ(After.MHits, Before.MHits + 1);
+  EXPECT_EQ(After.MMisses, Before.MMisses);
+  deallocatePooled(Second, 97);
+
+  // Large blocks are not pooled.
+  void *Large = allocatePooled(1 << 20);
+  deallocatePooled(Large, 1 << 20);
+}
+
+TEST(ObjectPoolTest, SharedObjects) {
+  struct Object {
+    int MValue;
+    Object(int Value) : MValue(Value) {}
+  };
+  std::weak_ptr<Object> Weak;
+  {
+    std::shared_ptr<Object> Ptr = makeSharedPooled<Object>(42);
+    EXPECT_EQ(Ptr->MValue, 42);
+    Weak = Ptr;
+  }
+  EXPECT_TRUE(Weak.expired());
+
+  // Objects may be released by a different thread.
+  std::shared_ptr<Object> Ptr = makeSharedPooled<Object>(1);
+  std::thread([P = std::move(Ptr)]() mutable { P.reset(); }).join();
+}
+
+TEST(ObjectPoolTest, AccessorImpls) {
+  auto MakeAccessor = []() {
+    return AccessorBaseHost({0, 0, 0}, {1, 1, 1}, {1, 1, 1},
+                            sycl::access::mode::read, nullptr, 1, 4, size_t(0));
+  };
+  { AccessorBaseHost Accessor = MakeAccessor(); }
+  // The impl of the next accessor reuses the block of the previous one.
+  ObjectPoolStats Before = getObjectPoolStats();
+  { AccessorBaseHost Accessor = MakeAccessor(); }
+  EXPECT_EQ(getObjectPoolStats().MHits, Before.MHits + 1);
+}
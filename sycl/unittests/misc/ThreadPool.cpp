@@ -0,0 +1,75 @@
+//==---- ThreadPool.cpp ----------------------------------------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+
+#include <detail/global_handler.hpp>
+#include <detail/thread_pool.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using sycl::detail::ThreadPool;
+using sycl::detail::ThreadPoolJob;
+
+TEST(ThreadPoolTest, JobStorage) {
+  int Counter = 0;
+  ThreadPoolJob Small{[&Counter]() { ++Counter; }};
+  ThreadPoolJob Moved{std::move(Small)};
+  EXPECT_FALSE(Small);
+  ASSERT_TRUE(Moved);
+  Moved();
+  EXPECT_EQ(Counter, 1);
+
+  // Callables larger than the inline buffer are stored on the heap.
+  std::array<int, 2 * ThreadPoolJob::InlineSize> Big{};
+  Big[0] = 2;
+  ThreadPoolJob Large{[&Counter, Big]() { Counter += Big[0]; }};
+  ThreadPoolJob MovedLarge;
+  MovedLarge = std::move(Large);
+  MovedLarge();
+  EXPECT_EQ(Counter, 3);
+
+  // Captured state is destroyed together with the job.
+  auto Shared = std::make_shared<int>(0);
+  {
+    ThreadPoolJob Job{[Shared]() {}};
+    EXPECT_EQ(Shared.use_count(), 2);
+  }
+  EXPECT_EQ(Shared.use_count(), 1);
+}
+
+TEST(ThreadPoolTest, DrainWaitsForAllJobs) {
+  constexpr size_t NumThreads = 4;
+  constexpr size_t NumSubmitters = 4;
+  constexpr size_t JobsPerSubmitter = 1000;
+  ThreadPool Pool{NumThreads};
+  std::atomic_size_t Done{0};
+
+  std::vector<std::thread> Submitters;
+  for (size_t I = 0; I < NumSubmitters; ++I)
+    Submitters.emplace_back([&, I]() {
+      for (size_t J = 0; J < JobsPerSubmitter; ++J) {
+        // Pin all the jobs of a submitter to a single worker, the other ones
+        // must steal them.
+        Pool.submit([&Done]() { Done++; }, I);
+      }
+    });
+  for (std::thread &Submitter : Submitters)
+    Submitter.join();
+
+  Pool.drain();
+  EXPECT_EQ(Done.load(), NumSubmitters * JobsPerSubmitter);
+
+  Pool.submit([&Done]() { Done++; });
+  Pool.drain();
+  EXPECT_EQ(Done.load(), NumSubmitters * JobsPerSubmitter + 1);
+}
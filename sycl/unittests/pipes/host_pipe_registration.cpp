@@ -206,3 +206,57 @@ TEST_F(PipeTest, NonBlockingOperationFail) {
   Pipe::write(q, 0, Success);
   ASSERT_FALSE(Success);
 }
+
+static size_t NumHostPipeTransfers = 0;
+static size_t HostPipeTransferSize = 0;
+
+pi_result redefinedEnqueueReadHostPipeBulk(pi_queue, pi_program, const char *,
+                                           pi_bool, void *ptr, size_t size,
+                                           pi_uint32, const pi_event *,
+                                           pi_event *event) {
+  *event = createDummyHandle<pi_event>();
+  ++NumHostPipeTransfers;
+  HostPipeTransferSize = size;
+  for (size_t I = 0; I < size / sizeof(int); ++I)
+    static_cast<int *>(ptr)[I] = PipeReadVal + I;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedEnqueueWriteHostPipeBulk(pi_queue, pi_program, const char *,
+                                            pi_bool, void *, size_t size,
+                                            pi_uint32, const pi_event *,
+                                            pi_event *event) {
+  *event = createDummyHandle<pi_event>();
+  ++NumHostPipeTransfers;
+  HostPipeTransferSize = size;
+  return PI_SUCCESS;
+}
+
+TEST_F(PipeTest, BulkTransfers) {
+  Mock.redefineAfter<sycl::detail::PiApiKind::piDeviceGetInfo>(
+      after_piDeviceGetInfo);
+  Mock.redefine<detail::PiApiKind::piextEnqueueReadHostPipe>(
+      redefinedEnqueueReadHostPipeBulk);
+  Mock.redefine<detail::PiApiKind::piextEnqueueWriteHostPipe>(
+      redefinedEnqueueWriteHostPipeBulk);
+  NumHostPipeTransfers = 0;
+
+  // The elements are moved through one transfer.
+  std::vector<int> Data(16);
+  Pipe::read(q, sycl::span<int>{Data});
+  EXPECT_EQ(NumHostPipeTransfers, 1u);
+  EXPECT_EQ(HostPipeTransferSize, Data.size() * sizeof(int));
+  for (size_t I = 0; I < Data.size(); ++I)
+    EXPECT_EQ(Data[I], static_cast<int>(PipeReadVal + I));
+
+  Pipe::write(q, sycl::span<const int>{Data});
+  EXPECT_EQ(NumHostPipeTransfers, 2u);
+  EXPECT_EQ(HostPipeTransferSize, Data.size() * sizeof(int));
+
+  bool Success = false;
+  Pipe::read(q, sycl::span<int>{Data}, Success);
+  EXPECT_TRUE(Success);
+  Pipe::write(q, sycl::span<const int>{Data}, Success);
+  EXPECT_TRUE(Success);
+  EXPECT_EQ(NumHostPipeTransfers, 4u);
+}
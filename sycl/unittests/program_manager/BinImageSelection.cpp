@@ -0,0 +1,83 @@
+//==------------- BinImageSelection.cpp --- Device image selection tests ---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/program_manager/program_manager.hpp>
+#include <helpers/MockKernelInfo.hpp>
+#include <helpers/PiImage.hpp>
+#include <helpers/PiMock.hpp>
+#include <sycl/sycl.hpp>
+
+#include <gtest/gtest.h>
+
+class SelectionKernelA;
+class SelectionKernelB;
+
+namespace sycl {
+inline namespace _V1 {
+namespace detail {
+template <>
+struct KernelInfo<SelectionKernelA> : public unittest::MockKernelInfoBase {
+  static constexpr const char *getName() { return "SelectionKernelA"; }
+};
+template <>
+struct KernelInfo<SelectionKernelB> : public unittest::MockKernelInfoBase {
+  static constexpr const char *getName() { return "SelectionKernelB"; }
+};
+} // namespace detail
+} // namespace _V1
+} // namespace sycl
+
+static sycl::unittest::PiImage generateImage(pi_device_binary_type Format,
+                                            const char *Target) {
+  using namespace sycl::unittest;
+  std::vector<unsigned char> Bin{0, 1, 2, 3, 4, 5}; // Random data
+  return PiImage{Format,
+                 Target,
+                 "",
+                 "",
+                 std::move(Bin),
+                 makeEmptyKernels({"SelectionKernelA", "SelectionKernelB"}),
+                 PiPropertySet{}};
+}
+
+// Both kernels are in a SPIR-V image and in an AOT one.
+static sycl::unittest::PiImage Imgs[] = {
+    generateImage(PI_DEVICE_BINARY_TYPE_SPIRV,
+                  __SYCL_PI_DEVICE_BINARY_TARGET_SPIRV64),
+    generateImage(PI_DEVICE_BINARY_TYPE_NATIVE,
+                  __SYCL_PI_DEVICE_BINARY_TARGET_SPIRV64_GEN)};
+static sycl::unittest::PiImageArray<2> ImgArray{Imgs};
+
+static size_t SelectBinaryCounter = 0;
+
+static pi_result redefinedDeviceSelectBinary(pi_device, pi_device_binary *,
+                                             pi_uint32, pi_uint32 *) {
+  ++SelectBinaryCounter;
+  return PI_SUCCESS;
+}
+
+TEST(BinImageSelection, KernelsWithSameImagesShareSelection) {
+  using namespace sycl::detail;
+  sycl::unittest::PiMock Mock;
+  Mock.redefineBefore<PiApiKind::piextDeviceSelectBinary>(
+      redefinedDeviceSelectBinary);
+  SelectBinaryCounter = 0;
+
+  sycl::device Dev = Mock.getPlatform().get_devices()[0];
+  ProgramManager &PM = ProgramManager::getInstance();
+  for (int I = 0; I < 2; ++I) {
+    sycl::context Ctx{Dev};
+    RTDeviceBinaryImage &ImgA =
+        PM.getDeviceImage("SelectionKernelA", Ctx, Dev);
+    RTDeviceBinaryImage &ImgB =
+        PM.getDeviceImage("SelectionKernelB", Ctx, Dev);
+    EXPECT_EQ(&ImgA, &ImgB);
+    // The image is selected once by each context.
+    EXPECT_EQ(SelectBinaryCounter, I + 1u);
+  }
+}
@@ -0,0 +1,56 @@
+//==------------ CompressedImages.cpp --- Compressed device image tests ----==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/device_binary_image.hpp>
+#include <helpers/PiImage.hpp>
+
+#include <llvm/Support/Compression.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+TEST(CompressedImages, DecompressedFormatAndData) {
+  using namespace sycl::unittest;
+  if (!llvm::compression::zstd::isAvailable())
+    GTEST_SKIP() << "zstd is not available";
+
+  // SPIR-V magic number followed by random data.
+  std::vector<uint8_t> Bin{0x03, 0x02, 0x23, 0x07};
+  for (int I = 0; I < 1024; ++I)
+    Bin.push_back(static_cast<uint8_t>(I * 7));
+  llvm::SmallVector<uint8_t, 0> Compressed;
+  llvm::compression::zstd::compress(Bin, Compressed);
+
+  PiImage Img{PI_DEVICE_BINARY_TYPE_COMPRESSED_NONE,
+              __SYCL_PI_DEVICE_BINARY_TARGET_SPIRV64,
+              "",
+              "",
+              std::vector<unsigned char>(Compressed.begin(), Compressed.end()),
+              makeEmptyKernels({"CompressedKernel"}),
+              PiPropertySet{}};
+  pi_device_binary_struct NativeImg = Img.convertToNativeType();
+  sycl::detail::CompressedRTDeviceBinaryImage CompressedImg{&NativeImg};
+  EXPECT_EQ(CompressedImg.getFormat(), PI_DEVICE_BINARY_TYPE_COMPRESSED_NONE);
+
+  // The image is decompressed once while other threads query its format.
+  std::vector<std::thread> Threads;
+  for (int I = 0; I < 4; ++I)
+    Threads.emplace_back([&] {
+      CompressedImg.decompress();
+      EXPECT_EQ(CompressedImg.getFormat(), PI_DEVICE_BINARY_TYPE_SPIRV);
+    });
+  for (std::thread &Thread : Threads)
+    Thread.join();
+
+  const pi_device_binary_struct &RawData = CompressedImg.getRawData();
+  ASSERT_EQ(CompressedImg.getSize(), Bin.size());
+  EXPECT_TRUE(std::equal(Bin.begin(), Bin.end(), RawData.BinaryStart));
+}
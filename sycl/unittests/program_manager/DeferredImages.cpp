@@ -0,0 +1,45 @@
+//==------------- DeferredImages.cpp --- Deferred image registration tests -==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/program_manager/program_manager.hpp>
+#include <helpers/PiImage.hpp>
+#include <helpers/PiMock.hpp>
+#include <sycl/sycl.hpp>
+
+#include <gtest/gtest.h>
+
+static sycl::unittest::PiImage generateImage(const char *KernelName) {
+  using namespace sycl::unittest;
+  std::vector<unsigned char> Bin{0, 1, 2, 3, 4, 5}; // Random data
+  return PiImage{PI_DEVICE_BINARY_TYPE_SPIRV,
+                 __SYCL_PI_DEVICE_BINARY_TARGET_SPIRV64,
+                 "",
+                 "",
+                 std::move(Bin),
+                 makeEmptyKernels({KernelName}),
+                 PiPropertySet{}};
+}
+
+TEST(DeferredImages, RegisteredOnFirstQuery) {
+  using namespace sycl::detail;
+  sycl::unittest::PiImage Img = generateImage("DeferredKernel");
+  // The images of a library are recorded when it is loaded...
+  sycl::unittest::PiImageArray<1> ImgArray{&Img};
+  // ... and registered by the first query.
+  EXPECT_NO_THROW(ProgramManager::getInstance().getSYCLKernelID(
+      "DeferredKernel"));
+}
+
+TEST(DeferredImages, UnloadedBeforeFirstQuery) {
+  using namespace sycl::detail;
+  sycl::unittest::PiImage Img = generateImage("UnloadedKernel");
+  { sycl::unittest::PiImageArray<1> ImgArray{&Img}; }
+  // The images of a library unloaded before being used are never registered.
+  EXPECT_THROW(ProgramManager::getInstance().getSYCLKernelID("UnloadedKernel"),
+               sycl::exception);
+}
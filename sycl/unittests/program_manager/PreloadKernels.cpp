@@ -0,0 +1,83 @@
+//==------------- PreloadKernels.cpp --- Kernel preloading tests -----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/config.hpp>
+#include <detail/program_manager/program_manager.hpp>
+#include <helpers/PiMock.hpp>
+#include <helpers/ScopedEnvVar.hpp>
+#include <helpers/TestKernel.hpp>
+#include <sycl/sycl.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+static std::atomic<size_t> ProgramBuildCounter{0};
+
+static pi_result redefinedProgramBuild(pi_program, pi_uint32, const pi_device *,
+                                       const char *,
+                                       void (*)(pi_program, void *), void *) {
+  ++ProgramBuildCounter;
+  return PI_SUCCESS;
+}
+
+TEST(PreloadKernels, BuildsImagesOnContextCreation) {
+  using namespace sycl::detail;
+  sycl::unittest::ScopedEnvVar Var(SYCLConfig<SYCL_PRELOAD_KERNELS>::getName(),
+                                   "1",
+                                   SYCLConfig<SYCL_PRELOAD_KERNELS>::reset);
+
+  sycl::unittest::PiMock Mock;
+  Mock.redefineBefore<PiApiKind::piProgramBuild>(redefinedProgramBuild);
+  ProgramBuildCounter = 0;
+
+  sycl::context Ctx{Mock.getPlatform().get_devices()[0]};
+  ProgramManager::getInstance().waitForPreloadedDeviceImages();
+  EXPECT_GT(ProgramBuildCounter.load(), 0u);
+}
+
+static pi_result redefinedProgramBuildFailed(pi_program, pi_uint32,
+                                             const pi_device *, const char *,
+                                             void (*)(pi_program, void *),
+                                             void *) {
+  return PI_ERROR_BUILD_PROGRAM_FAILURE;
+}
+
+TEST(PreloadKernels, BuildErrorIsReportedToAsyncHandler) {
+  using namespace sycl::detail;
+  sycl::unittest::ScopedEnvVar Var(SYCLConfig<SYCL_PRELOAD_KERNELS>::getName(),
+                                   "1",
+                                   SYCLConfig<SYCL_PRELOAD_KERNELS>::reset);
+
+  sycl::unittest::PiMock Mock;
+  Mock.redefineBefore<PiApiKind::piProgramBuild>(redefinedProgramBuildFailed);
+
+  std::atomic<size_t> NumReported{0};
+  sycl::context Ctx{Mock.getPlatform().get_devices()[0],
+                    [&NumReported](sycl::exception_list Exceptions) {
+                      NumReported += Exceptions.size();
+                    }};
+  ProgramManager::getInstance().waitForPreloadedDeviceImages();
+  // Only the first error is reported.
+  EXPECT_EQ(NumReported.load(), 1u);
+}
+
+TEST(PreloadKernels, DisabledByDefault) {
+  using namespace sycl::detail;
+  sycl::unittest::ScopedEnvVar Var(SYCLConfig<SYCL_PRELOAD_KERNELS>::getName(),
+                                   nullptr,
+                                   SYCLConfig<SYCL_PRELOAD_KERNELS>::reset);
+
+  sycl::unittest::PiMock Mock;
+  Mock.redefineBefore<PiApiKind::piProgramBuild>(redefinedProgramBuild);
+  ProgramBuildCounter = 0;
+
+  sycl::context Ctx{Mock.getPlatform().get_devices()[0]};
+  ProgramManager::getInstance().waitForPreloadedDeviceImages();
+  EXPECT_EQ(ProgramBuildCounter.load(), 0u);
+}
@@ -0,0 +1,73 @@
+//==------------- SharedBuilds.cpp --- Shared program build tests ----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/config.hpp>
+#include <helpers/PiMock.hpp>
+#include <helpers/ScopedEnvVar.hpp>
+#include <helpers/TestKernel.hpp>
+#include <sycl/sycl.hpp>
+
+#include <gtest/gtest.h>
+
+static size_t ProgramCreateCounter = 0;
+static size_t ProgramCreateWithBinaryCounter = 0;
+
+static pi_result redefinedProgramCreate(pi_context, const void *, size_t,
+                                        pi_program *) {
+  ++ProgramCreateCounter;
+  return PI_SUCCESS;
+}
+
+static pi_result redefinedProgramCreateWithBinary(
+    pi_context, pi_uint32, const pi_device *, const size_t *,
+    const unsigned char **, size_t, const pi_device_binary_property *,
+    pi_int32 *, pi_program *) {
+  ++ProgramCreateWithBinaryCounter;
+  return PI_SUCCESS;
+}
+
+static void runInTwoContexts(sycl::unittest::PiMock &Mock) {
+  using namespace sycl::detail;
+  Mock.redefineBefore<PiApiKind::piProgramCreate>(redefinedProgramCreate);
+  Mock.redefineBefore<PiApiKind::piProgramCreateWithBinary>(
+      redefinedProgramCreateWithBinary);
+  ProgramCreateCounter = 0;
+  ProgramCreateWithBinaryCounter = 0;
+
+  sycl::device Dev = Mock.getPlatform().get_devices()[0];
+  for (int I = 0; I < 2; ++I) {
+    sycl::context Ctx{Dev};
+    sycl::queue Q{Ctx, Dev};
+    Q.single_task<TestKernel<>>([] {}).wait();
+  }
+}
+
+TEST(SharedBuilds, ImageIsBuiltOnceForAllContexts) {
+  using namespace sycl::detail;
+  sycl::unittest::ScopedEnvVar Var(
+      SYCLConfig<SYCL_SHARE_PROGRAM_BUILDS>::getName(), "1",
+      SYCLConfig<SYCL_SHARE_PROGRAM_BUILDS>::reset);
+
+  sycl::unittest::PiMock Mock;
+  runInTwoContexts(Mock);
+  // The second context creates its program from the binary of the first one.
+  EXPECT_EQ(ProgramCreateCounter, 1u);
+  EXPECT_EQ(ProgramCreateWithBinaryCounter, 1u);
+}
+
+TEST(SharedBuilds, DisabledByDefault) {
+  using namespace sycl::detail;
+  sycl::unittest::ScopedEnvVar Var(
+      SYCLConfig<SYCL_SHARE_PROGRAM_BUILDS>::getName(), nullptr,
+      SYCLConfig<SYCL_SHARE_PROGRAM_BUILDS>::reset);
+
+  sycl::unittest::PiMock Mock;
+  runInTwoContexts(Mock);
+  EXPECT_EQ(ProgramCreateCounter, 2u);
+  EXPECT_EQ(ProgramCreateWithBinaryCounter, 0u);
+}
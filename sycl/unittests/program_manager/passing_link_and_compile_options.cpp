@@ -10,9 +10,12 @@
 
 #include <sycl/detail/defines_elementary.hpp>
 
+#include <detail/config.hpp>
+#include <detail/context_impl.hpp>
 #include <helpers/MockKernelInfo.hpp>
 #include <helpers/PiImage.hpp>
 #include <helpers/PiMock.hpp>
+#include <helpers/ScopedEnvVar.hpp>
 
 #include <gtest/gtest.h>
 
@@ -30,6 +33,10 @@ class EAMTestKernel3;
 const char EAMTestKernelName3[] = "LinkCompileTestKernel3";
 constexpr unsigned EAMTestKernelNumArgs3 = 4;
 
+class EAMTestKernel4;
+const char EAMTestKernelName4[] = "LinkCompileTestKernel4";
+constexpr unsigned EAMTestKernelNumArgs4 = 4;
+
 namespace sycl {
 inline namespace _V1 {
 namespace detail {
@@ -51,6 +58,12 @@ struct KernelInfo<EAMTestKernel3> : public unittest::MockKernelInfoBase {
   static constexpr const char *getName() { return EAMTestKernelName3; }
 };
 
+template <>
+struct KernelInfo<EAMTestKernel4> : public unittest::MockKernelInfoBase {
+  static constexpr unsigned getNumParams() { return EAMTestKernelNumArgs4; }
+  static constexpr const char *getName() { return EAMTestKernelName4; }
+};
+
 } // namespace detail
 } // namespace _V1
 } // namespace sycl
@@ -213,3 +226,38 @@ TEST(Link_Compile_Options, check_sycl_build) {
   EXPECT_EQ(expected_compile_options + " " + expected_link_options,
             current_build_opts);
 }
+
+TEST(Link_Compile_Options, fast_cache_follows_config_reset) {
+  sycl::unittest::PiMock Mock;
+  sycl::platform Plt = Mock.getPlatform();
+  const sycl::device Dev = Plt.get_devices()[0];
+  static sycl::unittest::PiImage DevImage =
+      generateEAMTestKernelImage<EAMTestKernel4>("", "");
+  static sycl::unittest::PiImageArray<1> DevImageArray{&DevImage};
+  sycl::context Ctx{Dev};
+  sycl::queue Queue{Ctx, Dev};
+  auto &Cache = sycl::detail::getSyclObjImpl(Ctx)->getKernelProgramCache();
+  using OptionsConfig = sycl::detail::SYCLConfig<
+      sycl::detail::SYCL_PROGRAM_APPEND_COMPILE_OPTIONS>;
+  using sycl::unittest::ScopedEnvVar;
+
+  auto Submit = [&] { Queue.single_task<EAMTestKernel4>([] {}).wait(); };
+  {
+    ScopedEnvVar Options("SYCL_PROGRAM_APPEND_COMPILE_OPTIONS", "-g",
+                         OptionsConfig::reset);
+    Submit();
+    Submit();
+  }
+  EXPECT_EQ(Cache.getStats().KernelFastCacheMisses, 1u);
+  EXPECT_EQ(Cache.getStats().KernelFastCacheHits, 1u);
+
+  // Kernels cached with the previous options must not be reused once the
+  // config is reset to other options.
+  {
+    ScopedEnvVar Options("SYCL_PROGRAM_APPEND_COMPILE_OPTIONS", "-O0",
+                         OptionsConfig::reset);
+    Submit();
+  }
+  EXPECT_EQ(Cache.getStats().KernelFastCacheMisses, 2u);
+  EXPECT_EQ(Cache.getStats().KernelFastCacheHits, 1u);
+}
@@ -0,0 +1,106 @@
+//==------------ CopySplit.cpp --- check splitting of large copies ---------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <sycl/sycl.hpp>
+
+#include <detail/config.hpp>
+#include <helpers/PiMock.hpp>
+#include <helpers/ScopedEnvVar.hpp>
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <vector>
+
+namespace {
+using namespace sycl;
+namespace syclex = sycl::ext::oneapi::experimental;
+
+constexpr size_t CopySize = 1024 * 1024 + 16;
+
+struct copy_chunk {
+  pi_queue Queue;
+  size_t Size;
+  pi_uint32 NumEvents;
+};
+std::vector<copy_chunk> Chunks;
+
+pi_result redefinedUSMEnqueueMemcpy(pi_queue Queue, pi_bool, void *,
+                                    const void *, size_t Size,
+                                    pi_uint32 NumEvents, const pi_event *,
+                                    pi_event *) {
+  Chunks.push_back({Queue, Size, NumEvents});
+  return PI_SUCCESS;
+}
+
+class CopySplitTest : public ::testing::Test {
+public:
+  CopySplitTest() : Mock{}, Plt{Mock.getPlatform()} {}
+
+protected:
+  void SetUp() override {
+    Chunks.clear();
+    Mock.redefineBefore<detail::PiApiKind::piextUSMEnqueueMemcpy>(
+        redefinedUSMEnqueueMemcpy);
+  }
+
+  void copy(queue &Queue) {
+    std::vector<char> Src(CopySize), Dst(CopySize);
+    Queue.memcpy(Dst.data(), Src.data(), CopySize).wait();
+  }
+
+  unittest::PiMock Mock;
+  platform Plt;
+};
+} // namespace
+
+TEST_F(CopySplitTest, LargeCopyIsSplit) {
+  unittest::ScopedEnvVar Threshold(
+      "SYCL_COPY_SPLIT_THRESHOLD", "1048576",
+      detail::SYCLConfig<detail::SYCL_COPY_SPLIT_THRESHOLD>::reset);
+  queue Queue{Plt.get_devices()[0]};
+  copy(Queue);
+
+  ASSERT_EQ(Chunks.size(), 4ul);
+  std::set<pi_queue> Queues;
+  size_t Size = 0;
+  for (size_t I = 0; I < Chunks.size(); ++I) {
+    Queues.insert(Chunks[I].Queue);
+    Size += Chunks[I].Size;
+    // Only the last chunk may end at an unaligned offset.
+    if (I + 1 < Chunks.size())
+      EXPECT_EQ(Chunks[I].Size % 4096, 0ul);
+    // The chunks of out-of-order queues without dependencies start at once.
+    EXPECT_EQ(Chunks[I].NumEvents, 0u);
+  }
+  EXPECT_EQ(Size, CopySize);
+  EXPECT_EQ(Queues.size(), 4ul);
+  EXPECT_EQ(Queues.count(detail::getSyclObjImpl(Queue)->getHandleRef()), 0ul);
+}
+
+TEST_F(CopySplitTest, InOrderChunksWaitForPreviousCommands) {
+  unittest::ScopedEnvVar Threshold(
+      "SYCL_COPY_SPLIT_THRESHOLD", "1048576",
+      detail::SYCLConfig<detail::SYCL_COPY_SPLIT_THRESHOLD>::reset);
+  queue Queue{Plt.get_devices()[0], property::queue::in_order{}};
+  copy(Queue);
+
+  ASSERT_EQ(Chunks.size(), 4ul);
+  for (const copy_chunk &Chunk : Chunks)
+    EXPECT_EQ(Chunk.NumEvents, 1u);
+}
+
+TEST_F(CopySplitTest, CopyBelowDefaultThresholdIsNotSplit) {
+  queue Queue{Plt.get_devices()[0],
+              {syclex::property::queue::split_large_copies{}}};
+  copy(Queue);
+
+  ASSERT_EQ(Chunks.size(), 1ul);
+  EXPECT_EQ(Chunks[0].Queue, detail::getSyclObjImpl(Queue)->getHandleRef());
+  EXPECT_EQ(Chunks[0].Size, CopySize);
+}
@@ -29,3 +29,58 @@ TEST(InOrderQueue, CheckFlagIsPassed) {
   queue q2{property::queue::in_order{}};
   EXPECT_TRUE(InOrderFlagSeen);
 }
+
+static size_t EventStatusQueries = 0;
+static pi_event_status LastEventStatus = PI_EVENT_SUBMITTED;
+pi_result redefinedEventGetInfoAfter(pi_event, pi_event_info ParamName, size_t,
+                                     void *ParamValue, size_t *) {
+  if (ParamName == PI_EVENT_INFO_COMMAND_EXECUTION_STATUS) {
+    ++EventStatusQueries;
+    if (ParamValue)
+      *static_cast<pi_event_status *>(ParamValue) = LastEventStatus;
+  }
+  return PI_SUCCESS;
+}
+
+static size_t QueueFinishCalls = 0;
+pi_result redefinedQueueFinishBefore(pi_queue) {
+  ++QueueFinishCalls;
+  return PI_SUCCESS;
+}
+
+TEST(InOrderQueue, EmptyAndWaitUseSubmissionCounter) {
+  unittest::PiMock Mock;
+  Mock.redefineAfter<detail::PiApiKind::piEventGetInfo>(
+      redefinedEventGetInfoAfter);
+  Mock.redefineBefore<detail::PiApiKind::piQueueFinish>(
+      redefinedQueueFinishBefore);
+  EventStatusQueries = 0;
+  QueueFinishCalls = 0;
+  LastEventStatus = PI_EVENT_SUBMITTED;
+
+  queue Q{Mock.getPlatform().get_devices()[0], property::queue::in_order{}};
+  EXPECT_TRUE(Q.ext_oneapi_empty());
+  EXPECT_EQ(EventStatusQueries, 0u);
+
+  int Value = 0;
+  Q.memset(&Value, 0, sizeof(Value));
+  EXPECT_FALSE(Q.ext_oneapi_empty());
+  EXPECT_EQ(EventStatusQueries, 1u);
+
+  // Once the last submission is seen complete, the queue is known to be empty
+  // until the next submission.
+  LastEventStatus = PI_EVENT_COMPLETE;
+  EXPECT_TRUE(Q.ext_oneapi_empty());
+  EXPECT_EQ(EventStatusQueries, 2u);
+  EXPECT_TRUE(Q.ext_oneapi_empty());
+  EXPECT_EQ(EventStatusQueries, 2u);
+  Q.wait();
+  EXPECT_EQ(QueueFinishCalls, 0u);
+
+  LastEventStatus = PI_EVENT_SUBMITTED;
+  Q.memset(&Value, 0, sizeof(Value));
+  Q.wait();
+  EXPECT_EQ(QueueFinishCalls, 1u);
+  EXPECT_TRUE(Q.ext_oneapi_empty());
+  EXPECT_EQ(EventStatusQueries, 2u);
+}
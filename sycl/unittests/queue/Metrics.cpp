@@ -0,0 +1,81 @@
+//==---------------- Metrics.cpp --- queue unit tests ----------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/metrics.hpp>
+#include <gtest/gtest.h>
+#include <helpers/PiMock.hpp>
+#include <helpers/ScopedEnvVar.hpp>
+#include <helpers/TestKernel.hpp>
+#include <sycl/queue.hpp>
+
+using namespace sycl;
+
+TEST(Metrics, SubmissionIsRecorded) {
+  unittest::ScopedEnvVar EnableMetrics(
+      "SYCL_METRICS_DUMP", "1",
+      detail::SYCLConfig<detail::SYCL_METRICS_DUMP>::reset);
+  detail::resetMetrics();
+
+  unittest::PiMock Mock;
+  queue Q{Mock.getPlatform().get_devices()[0]};
+  Q.single_task<TestKernel<>>([]() {});
+  Q.single_task<TestKernel<>>([]() {});
+  Q.wait();
+
+  detail::MetricSummary Submit =
+      detail::getMetricSummary(detail::MetricKind::SubmitLatency);
+  EXPECT_EQ(Submit.MCount, 2u);
+  EXPECT_LE(Submit.MP50Ns, Submit.MP99Ns);
+  EXPECT_LE(Submit.MP99Ns, Submit.MMaxNs);
+  EXPECT_GE(Submit.MTotalNs, Submit.MMaxNs);
+  EXPECT_GE(
+      detail::getMetricSummary(detail::MetricKind::PluginEnqueue).MCount, 2u);
+  EXPECT_GE(
+      detail::getMetricSummary(detail::MetricKind::KernelCacheLookup).MCount,
+      2u);
+
+  detail::resetMetrics();
+  EXPECT_EQ(detail::getMetricSummary(detail::MetricKind::SubmitLatency).MCount,
+            0u);
+}
+
+TEST(Metrics, CacheMissesAndHostTasksAreRecorded) {
+  unittest::ScopedEnvVar EnableMetrics(
+      "SYCL_METRICS_DUMP", "1",
+      detail::SYCLConfig<detail::SYCL_METRICS_DUMP>::reset);
+  detail::resetMetrics();
+
+  unittest::PiMock Mock;
+  queue Q{Mock.getPlatform().get_devices()[0]};
+  Q.single_task<TestKernel<>>([]() {});
+  Q.single_task<TestKernel<>>([]() {});
+  Q.submit([](handler &CGH) { CGH.host_task([]() {}); });
+  Q.wait();
+
+  // The program is built on the first lookup only.
+  uint64_t Builds =
+      detail::getMetricSummary(detail::MetricKind::ProgramBuild).MCount;
+  EXPECT_GE(Builds, 1u);
+  EXPECT_LT(Builds, detail::getMetricSummary(
+                        detail::MetricKind::KernelCacheLookup)
+                        .MCount);
+  EXPECT_EQ(detail::getMetricSummary(detail::MetricKind::HostTask).MCount, 1u);
+}
+
+TEST(Metrics, DisabledByDefault) {
+  detail::SYCLConfig<detail::SYCL_METRICS_DUMP>::reset();
+  detail::resetMetrics();
+
+  unittest::PiMock Mock;
+  queue Q{Mock.getPlatform().get_devices()[0]};
+  Q.single_task<TestKernel<>>([]() {});
+  Q.wait();
+
+  EXPECT_EQ(detail::getMetricSummary(detail::MetricKind::SubmitLatency).MCount,
+            0u);
+}
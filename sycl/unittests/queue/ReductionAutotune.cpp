@@ -0,0 +1,65 @@
+//==------- ReductionAutotune.cpp --- check reduction strategy autotuning --==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <sycl/sycl.hpp>
+
+#include <gtest/gtest.h>
+#include <map>
+
+#include <helpers/PiMock.hpp>
+
+using namespace sycl;
+using strategy = detail::reduction::strategy;
+
+namespace {
+constexpr uint32_t Candidates = 1u << static_cast<int>(strategy::range_basic) |
+                                1u << static_cast<int>(strategy::basic);
+
+class ReductionAutotuneTest : public ::testing::Test {
+public:
+  ReductionAutotuneTest()
+      : Mock{}, Q{Mock.getPlatform().get_devices()[0]},
+        QImpl{detail::getSyclObjImpl(Q)} {}
+
+protected:
+  // Selects the strategy of a launch and submits a command standing for it.
+  int launch(const char *Key, size_t NWorkItems) {
+    int Strategy =
+        detail::reduGetAutotunedStrategy(QImpl, Key, NWorkItems, Candidates);
+    Q.ext_oneapi_submit_barrier();
+    return Strategy;
+  }
+
+  unittest::PiMock Mock;
+  queue Q;
+  std::shared_ptr<detail::queue_impl> QImpl;
+};
+} // namespace
+
+TEST_F(ReductionAutotuneTest, FastestCandidateIsKept) {
+  std::map<int, int> NumLaunches;
+  for (int I = 0; I < 4; ++I)
+    ++NumLaunches[launch("FastestCandidateIsKept", 1000)];
+  // Each candidate is timed twice.
+  EXPECT_EQ(NumLaunches[static_cast<int>(strategy::range_basic)], 2);
+  EXPECT_EQ(NumLaunches[static_cast<int>(strategy::basic)], 2);
+
+  int Chosen = launch("FastestCandidateIsKept", 1000);
+  EXPECT_TRUE(Candidates >> Chosen & 1);
+  for (int I = 0; I < 4; ++I)
+    EXPECT_EQ(launch("FastestCandidateIsKept", 1000), Chosen);
+}
+
+TEST_F(ReductionAutotuneTest, RangeSizesAreTunedSeparately) {
+  for (int I = 0; I < 4; ++I)
+    launch("RangeSizesAreTunedSeparately", 1000);
+  // A range of another order of magnitude is explored again, starting with the
+  // first candidate.
+  EXPECT_EQ(launch("RangeSizesAreTunedSeparately", 1 << 20),
+            static_cast<int>(strategy::range_basic));
+}
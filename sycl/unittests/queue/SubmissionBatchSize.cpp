@@ -0,0 +1,64 @@
+//==---------- SubmissionBatchSize.cpp --- queue unit tests ----------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <gtest/gtest.h>
+#include <helpers/PiMock.hpp>
+#include <helpers/TestKernel.hpp>
+#include <sycl/properties/queue_properties.hpp>
+#include <sycl/queue.hpp>
+
+using namespace sycl;
+namespace intel_queue = sycl::ext::intel::property::queue;
+
+static pi_queue_properties QueueFlags = 0;
+static pi_result redefinedQueueCreate(pi_context, pi_device,
+                                      pi_queue_properties *Properties,
+                                      pi_queue *) {
+  QueueFlags = Properties[1];
+  return PI_SUCCESS;
+}
+
+static size_t FlushCounter = 0;
+static pi_result redefinedQueueFlush(pi_queue) {
+  ++FlushCounter;
+  return PI_SUCCESS;
+}
+
+class SubmissionBatchSize : public ::testing::Test {
+protected:
+  void SetUp() override {
+    QueueFlags = 0;
+    FlushCounter = 0;
+    Mock.redefineBefore<detail::PiApiKind::piextQueueCreate>(
+        redefinedQueueCreate);
+    Mock.redefineBefore<detail::PiApiKind::piQueueFlush>(redefinedQueueFlush);
+  }
+
+  unittest::PiMock Mock;
+};
+
+TEST_F(SubmissionBatchSize, QueueIsFlushedAfterBatch) {
+  queue Q{Mock.getPlatform().get_devices()[0],
+          {property::queue::in_order(),
+           intel_queue::submission_batch_size(3)}};
+  EXPECT_TRUE(QueueFlags & PI_EXT_QUEUE_FLAG_SUBMISSION_NO_IMMEDIATE);
+
+  for (int I = 0; I < 7; ++I)
+    Q.single_task<TestKernel<>>([]() {});
+  EXPECT_EQ(FlushCounter, 2u);
+  Q.wait();
+}
+
+TEST_F(SubmissionBatchSize, ConflictsWithImmediateCommandList) {
+  device Dev = Mock.getPlatform().get_devices()[0];
+  EXPECT_THROW(queue(Dev, {intel_queue::immediate_command_list(),
+                           intel_queue::submission_batch_size(4)}),
+               sycl::exception);
+  EXPECT_THROW(queue(Dev, {intel_queue::submission_batch_size(0)}),
+               sycl::exception);
+}
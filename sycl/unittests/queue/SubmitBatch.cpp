@@ -0,0 +1,54 @@
+//==------------- SubmitBatch.cpp --- queue unit tests ---------------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/event_impl.hpp>
+#include <gtest/gtest.h>
+#include <helpers/PiMock.hpp>
+#include <helpers/TestKernel.hpp>
+#include <sycl/queue.hpp>
+
+using namespace sycl;
+
+static size_t KernelLaunchCounter = 0;
+static pi_result redefinedEnqueueKernelLaunch(pi_queue, pi_kernel, pi_uint32,
+                                              const size_t *, const size_t *,
+                                              const size_t *, pi_uint32,
+                                              const pi_event *, pi_event *) {
+  ++KernelLaunchCounter;
+  return PI_SUCCESS;
+}
+
+TEST(SubmitBatch, AllCommandGroupsAreEnqueued) {
+  unittest::PiMock Mock;
+  Mock.redefineBefore<detail::PiApiKind::piEnqueueKernelLaunch>(
+      redefinedEnqueueKernelLaunch);
+  KernelLaunchCounter = 0;
+
+  queue Q{Mock.getPlatform().get_devices()[0]};
+  buffer<int, 1> Buf{range<1>(1)};
+
+  constexpr size_t NumCGs = 4;
+  std::vector<std::function<void(handler &)>> CGFs;
+  for (size_t I = 0; I < NumCGs; ++I)
+    CGFs.push_back([&](handler &CGH) {
+      Buf.get_access<access::mode::read_write>(CGH);
+      CGH.single_task<TestKernel<>>([]() {});
+    });
+
+  std::vector<event> Events = Q.ext_oneapi_submit_batch(CGFs);
+  ASSERT_EQ(Events.size(), NumCGs);
+  EXPECT_EQ(KernelLaunchCounter, NumCGs);
+  for (event &E : Events)
+    EXPECT_NE(detail::getSyclObjImpl(E)->getHandleRef(), nullptr);
+}
+
+TEST(SubmitBatch, EmptyBatch) {
+  unittest::PiMock Mock;
+  queue Q{Mock.getPlatform().get_devices()[0]};
+  EXPECT_TRUE(Q.ext_oneapi_submit_batch({}).empty());
+}
@@ -0,0 +1,85 @@
+//==---------- SubmitWithoutEvent.cpp --- queue unit tests -----------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/event_impl.hpp>
+#include <gtest/gtest.h>
+#include <helpers/PiMock.hpp>
+#include <helpers/TestKernel.hpp>
+#include <sycl/ext/oneapi/experimental/enqueue_functions.hpp>
+#include <sycl/queue.hpp>
+
+using namespace sycl;
+namespace syclex = sycl::ext::oneapi::experimental;
+
+static std::vector<bool> KernelLaunchHasEvent;
+static pi_result redefinedEnqueueKernelLaunch(pi_queue, pi_kernel, pi_uint32,
+                                              const size_t *, const size_t *,
+                                              const size_t *, pi_uint32,
+                                              const pi_event *,
+                                              pi_event *Event) {
+  KernelLaunchHasEvent.push_back(Event != nullptr);
+  return PI_SUCCESS;
+}
+
+static size_t BarrierCounter = 0;
+static pi_result redefinedEnqueueEventsWaitWithBarrier(pi_queue, pi_uint32,
+                                                       const pi_event *,
+                                                       pi_event *) {
+  ++BarrierCounter;
+  return PI_SUCCESS;
+}
+
+class SubmitWithoutEvent : public ::testing::Test {
+protected:
+  void SetUp() override {
+    KernelLaunchHasEvent.clear();
+    BarrierCounter = 0;
+    Mock.redefineBefore<detail::PiApiKind::piEnqueueKernelLaunch>(
+        redefinedEnqueueKernelLaunch);
+    Mock.redefineBefore<detail::PiApiKind::piEnqueueEventsWaitWithBarrier>(
+        redefinedEnqueueEventsWaitWithBarrier);
+  }
+
+  unittest::PiMock Mock;
+};
+
+TEST_F(SubmitWithoutEvent, InOrderQueueEnqueuesWithoutPiEvent) {
+  queue Q{Mock.getPlatform().get_devices()[0], property::queue::in_order()};
+
+  Q.single_task<TestKernel<>>([]() {});
+  syclex::single_task<TestKernel<>>(Q, []() {});
+  syclex::submit(Q,
+                 [](handler &CGH) { CGH.single_task<TestKernel<>>([]() {}); });
+
+  ASSERT_EQ(KernelLaunchHasEvent.size(), 3u);
+  EXPECT_TRUE(KernelLaunchHasEvent[0]);
+  EXPECT_FALSE(KernelLaunchHasEvent[1]);
+  EXPECT_FALSE(KernelLaunchHasEvent[2]);
+
+  // The last event has to cover the commands submitted without an event.
+  event LastEvent = Q.ext_oneapi_get_last_event();
+  EXPECT_EQ(BarrierCounter, 1u);
+  EXPECT_NE(detail::getSyclObjImpl(LastEvent)->getHandleRef(), nullptr);
+
+  // A command with an event makes the marker unnecessary.
+  syclex::single_task<TestKernel<>>(Q, []() {});
+  Q.single_task<TestKernel<>>([]() {});
+  Q.ext_oneapi_get_last_event();
+  EXPECT_EQ(BarrierCounter, 1u);
+  Q.wait();
+}
+
+TEST_F(SubmitWithoutEvent, OutOfOrderQueueKeepsEvents) {
+  queue Q{Mock.getPlatform().get_devices()[0]};
+
+  syclex::single_task<TestKernel<>>(Q, []() {});
+
+  ASSERT_EQ(KernelLaunchHasEvent.size(), 1u);
+  EXPECT_TRUE(KernelLaunchHasEvent[0]);
+  Q.wait();
+}
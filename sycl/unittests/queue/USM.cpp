@@ -6,10 +6,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <detail/config.hpp>
 #include <detail/event_impl.hpp>
+#include <sycl/properties/queue_properties.hpp>
 #include <sycl/usm.hpp>
 
 #include <helpers/PiMock.hpp>
+#include <helpers/ScopedEnvVar.hpp>
 
 #include <gtest/gtest.h>
 
@@ -92,4 +95,59 @@ TEST(USM, NoOpPreservesDependencyChain) {
   free(Dst, Q);
   TestContext.Deps.clear();
 }
+
+size_t NumUSMEnqueues = 0;
+
+pi_result redefinedUSMEnqueueMemcpyCount(pi_queue, pi_bool, void *,
+                                         const void *, size_t, pi_uint32,
+                                         const pi_event *, pi_event *) {
+  ++NumUSMEnqueues;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedUSMEnqueueMemsetCount(pi_queue, void *, pi_int32, size_t,
+                                         pi_uint32, const pi_event *,
+                                         pi_event *) {
+  ++NumUSMEnqueues;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedUSMGetMemAllocInfoUnknown(pi_context, const void *,
+                                             pi_mem_alloc_info, size_t, void *,
+                                             size_t *) {
+  return PI_ERROR_INVALID_VALUE;
+}
+
+// Check that small operations on host memory are done on the host under
+// SYCL_HOST_MEMOP_THRESHOLD.
+TEST(USM, SmallHostMemOpsBypassBackend) {
+  using namespace sycl::detail;
+  sycl::unittest::ScopedEnvVar Var(
+      SYCLConfig<SYCL_HOST_MEMOP_THRESHOLD>::getName(), "8",
+      SYCLConfig<SYCL_HOST_MEMOP_THRESHOLD>::reset);
+
+  sycl::unittest::PiMock Mock;
+  sycl::platform Plt = Mock.getPlatform();
+  Mock.redefineBefore<PiApiKind::piextUSMEnqueueMemcpy>(
+      redefinedUSMEnqueueMemcpyCount);
+  Mock.redefineBefore<PiApiKind::piextUSMEnqueueMemset>(
+      redefinedUSMEnqueueMemsetCount);
+  Mock.redefine<PiApiKind::piextUSMGetMemAllocInfo>(
+      redefinedUSMGetMemAllocInfoUnknown);
+  NumUSMEnqueues = 0;
+
+  queue Q{Plt.get_devices()[0], property::queue::in_order()};
+  uint8_t Src[16] = {};
+  uint8_t Dst[16] = {};
+
+  Q.memset(Src, 1, 8).wait();
+  Q.memcpy(Dst, Src, 8).wait();
+  EXPECT_EQ(NumUSMEnqueues, 0u);
+  EXPECT_EQ(Src[7], 1);
+  EXPECT_EQ(Dst[7], 1);
+
+  // Larger operations are enqueued.
+  Q.memcpy(Dst, Src, 16).wait();
+  EXPECT_EQ(NumUSMEnqueues, 1u);
+}
 } // namespace
@@ -0,0 +1,133 @@
+//==------- USMAutoPrefetch.cpp --- check prefetching of kernel USM args ---==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <detail/config.hpp>
+#include <gtest/gtest.h>
+#include <helpers/KernelInteropCommon.hpp>
+#include <helpers/PiMock.hpp>
+#include <helpers/ScopedEnvVar.hpp>
+
+#include <sycl/sycl.hpp>
+
+#include <vector>
+
+namespace {
+constexpr size_t AllocSize = 1024;
+alignas(64) char SharedAlloc[AllocSize];
+alignas(64) char DeviceAlloc[AllocSize];
+
+struct prefetch {
+  const void *MPtr;
+  size_t MSize;
+};
+std::vector<prefetch> Prefetches;
+std::vector<pi_mem_advice> Advices;
+
+pi_result redefinedUSMGetMemAllocInfo(pi_context, const void *Ptr,
+                                      pi_mem_alloc_info ParamName, size_t,
+                                      void *ParamValue, size_t *) {
+  char *Base = Ptr >= SharedAlloc && Ptr < SharedAlloc + AllocSize
+                   ? SharedAlloc
+                   : DeviceAlloc;
+  switch (ParamName) {
+  case PI_MEM_ALLOC_TYPE:
+    *static_cast<pi_usm_type *>(ParamValue) =
+        Base == SharedAlloc ? PI_MEM_TYPE_SHARED : PI_MEM_TYPE_DEVICE;
+    break;
+  case PI_MEM_ALLOC_BASE_PTR:
+    *static_cast<void **>(ParamValue) = Base;
+    break;
+  case PI_MEM_ALLOC_SIZE:
+    *static_cast<size_t *>(ParamValue) = AllocSize;
+    break;
+  default:
+    break;
+  }
+  return PI_SUCCESS;
+}
+
+pi_result redefinedUSMEnqueuePrefetch(pi_queue, const void *Ptr, size_t Size,
+                                      pi_usm_migration_flags, pi_uint32,
+                                      const pi_event *, pi_event *) {
+  Prefetches.push_back({Ptr, Size});
+  return PI_SUCCESS;
+}
+
+pi_result redefinedUSMEnqueueMemAdvise(pi_queue, const void *, size_t,
+                                       pi_mem_advice Advice, pi_event *) {
+  Advices.push_back(Advice);
+  return PI_SUCCESS;
+}
+
+class USMAutoPrefetchTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    Prefetches.clear();
+    Advices.clear();
+    redefineMockForKernelInterop(Mock);
+    Mock.redefine<sycl::detail::PiApiKind::piextUSMGetMemAllocInfo>(
+        redefinedUSMGetMemAllocInfo);
+    Mock.redefineBefore<sycl::detail::PiApiKind::piextUSMEnqueuePrefetch>(
+        redefinedUSMEnqueuePrefetch);
+    Mock.redefineBefore<sycl::detail::PiApiKind::piextUSMEnqueueMemAdvise>(
+        redefinedUSMEnqueueMemAdvise);
+  }
+
+  void launchWithArg(sycl::queue &Q, void *Ptr) {
+    DummyHandleT Handle;
+    auto KernelCL = reinterpret_cast<typename sycl::backend_traits<
+        sycl::backend::opencl>::template input_type<sycl::kernel>>(&Handle);
+    auto Kernel =
+        sycl::make_kernel<sycl::backend::opencl>(KernelCL, Q.get_context());
+    Q.submit([&](sycl::handler &CGH) {
+       CGH.set_arg(0, Ptr);
+       CGH.single_task(Kernel);
+     }).wait();
+  }
+
+  sycl::unittest::PiMock Mock;
+};
+
+using AutoPrefetchConfig =
+    sycl::detail::SYCLConfig<sycl::detail::SYCL_USM_AUTO_PREFETCH>;
+} // namespace
+
+TEST_F(USMAutoPrefetchTest, SharedArgIsPrefetched) {
+  sycl::unittest::ScopedEnvVar AutoPrefetch{"SYCL_USM_AUTO_PREFETCH", "1",
+                                            AutoPrefetchConfig::reset};
+  sycl::queue Q{Mock.getPlatform().get_devices()[0]};
+
+  // The whole allocation is prefetched, whatever the pointer into it.
+  launchWithArg(Q, SharedAlloc + 16);
+  launchWithArg(Q, SharedAlloc);
+  ASSERT_EQ(Prefetches.size(), 2ul);
+  EXPECT_EQ(Prefetches[0].MPtr, SharedAlloc);
+  EXPECT_EQ(Prefetches[0].MSize, AllocSize);
+
+  // The preferred location is only advised for the first kernel.
+  ASSERT_EQ(Advices.size(), 1ul);
+  EXPECT_EQ(Advices[0], PI_MEM_ADVICE_CUDA_SET_PREFERRED_LOCATION);
+}
+
+TEST_F(USMAutoPrefetchTest, DeviceArgIsNotPrefetched) {
+  sycl::unittest::ScopedEnvVar AutoPrefetch{"SYCL_USM_AUTO_PREFETCH", "1",
+                                            AutoPrefetchConfig::reset};
+  sycl::queue Q{Mock.getPlatform().get_devices()[0]};
+
+  launchWithArg(Q, DeviceAlloc);
+  EXPECT_TRUE(Prefetches.empty());
+  EXPECT_TRUE(Advices.empty());
+}
+
+TEST_F(USMAutoPrefetchTest, DisabledByDefault) {
+  sycl::queue Q{Mock.getPlatform().get_devices()[0]};
+
+  launchWithArg(Q, SharedAlloc);
+  EXPECT_TRUE(Prefetches.empty());
+  EXPECT_TRUE(Advices.empty());
+}
@@ -0,0 +1,74 @@
+//==------- USMPointerQueries.cpp --- check USM allocation tracking --------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include <sycl/sycl.hpp>
+
+#include <helpers/PiMock.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace sycl;
+
+namespace {
+size_t NumAllocInfoQueries = 0;
+
+pi_result redefinedUSMGetMemAllocInfo(pi_context, const void *,
+                                      pi_mem_alloc_info, size_t, void *,
+                                      size_t *) {
+  ++NumAllocInfoQueries;
+  return PI_ERROR_INVALID_VALUE;
+}
+
+class USMPointerQueriesTest : public ::testing::Test {
+public:
+  USMPointerQueriesTest() : Mock{}, Plt{Mock.getPlatform()} {}
+
+protected:
+  void SetUp() override {
+    NumAllocInfoQueries = 0;
+    Mock.redefine<detail::PiApiKind::piextUSMGetMemAllocInfo>(
+        redefinedUSMGetMemAllocInfo);
+  }
+
+  unittest::PiMock Mock;
+  platform Plt;
+};
+} // namespace
+
+TEST_F(USMPointerQueriesTest, TrackedAllocationsAreNotQueried) {
+  device Dev = Plt.get_devices()[0];
+  context Ctx{Dev};
+
+  char *Shared = static_cast<char *>(malloc_shared(256, Dev, Ctx));
+  char *Host = static_cast<char *>(malloc_host(256, Ctx));
+  ASSERT_NE(Shared, nullptr);
+  ASSERT_NE(Host, nullptr);
+
+  EXPECT_EQ(get_pointer_type(Shared, Ctx), usm::alloc::shared);
+  EXPECT_EQ(get_pointer_type(Shared + 255, Ctx), usm::alloc::shared);
+  EXPECT_EQ(get_pointer_type(Host + 16, Ctx), usm::alloc::host);
+  EXPECT_EQ(get_pointer_device(Shared + 16, Ctx), Dev);
+  EXPECT_EQ(NumAllocInfoQueries, 0ul);
+
+  free(Shared, Ctx);
+  free(Host, Ctx);
+}
+
+TEST_F(USMPointerQueriesTest, FreedAllocationsAreForgotten) {
+  device Dev = Plt.get_devices()[0];
+  context Ctx{Dev};
+
+  void *Ptr = malloc_device(256, Dev, Ctx);
+  ASSERT_NE(Ptr, nullptr);
+  EXPECT_EQ(get_pointer_type(Ptr, Ctx), usm::alloc::device);
+  free(Ptr, Ctx);
+
+  // The backend does not know about the pointer anymore either.
+  EXPECT_EQ(get_pointer_type(Ptr, Ctx), usm::alloc::unknown);
+  EXPECT_EQ(NumAllocInfoQueries, 1ul);
+}
@@ -191,3 +191,32 @@ TEST_F(SchedulerTest, EnqueueHostDependency) {
   ASSERT_EQ(detail::EnqueueResultT::SyclEnqueueSuccess, Res.MResult)
       << "Enqueue operation should return successfully.\n";
 }
+
+TEST_F(SchedulerTest, EnqueueDeepDependencyChain) {
+  sycl::unittest::PiMock Mock;
+  sycl::queue Q{Mock.getPlatform().get_devices()[0], MAsyncHandler};
+
+  // A chain of commands, each of them depending on the previous one and on
+  // the first one, too long to be enqueued recursively on a small stack.
+  constexpr size_t ChainLength = 20000;
+  std::vector<std::unique_ptr<MockCommand>> Cmds;
+  for (size_t I = 0; I < ChainLength; ++I) {
+    Cmds.emplace_back(new MockCommand(detail::getSyclObjImpl(Q)));
+    Cmds.back()->MEnqueueStatus = detail::EnqueueResultT::SyclEnqueueReady;
+    if (I > 0)
+      addEdge(Cmds[I].get(), Cmds[I - 1].get(), nullptr);
+    if (I > 1)
+      addEdge(Cmds[I].get(), Cmds[0].get(), nullptr);
+  }
+  // The shared dependency is visited once.
+  EXPECT_CALL(*Cmds[0], enqueue).Times(1);
+
+  MockScheduler MS;
+  auto Lock = MS.acquireGraphReadLock();
+  detail::EnqueueResultT Res;
+  bool Enqueued = MockScheduler::enqueueCommand(Cmds.back().get(), Res,
+                                                detail::NON_BLOCKING);
+  ASSERT_TRUE(Enqueued) << "The command should be enqueued\n";
+  for (const std::unique_ptr<MockCommand> &Cmd : Cmds)
+    EXPECT_TRUE(Cmd->isSuccessfullyEnqueued());
+}
@@ -84,3 +84,20 @@ TEST_F(SchedulerTest, WaitEmptyEventWithBarrier) {
     MS.Scheduler::addCG(std::move(CommandGroup), QueueImpl);
   }
 }
+
+TEST_F(SchedulerTest, SharedDependencyIsPreparedOnce) {
+  sycl::unittest::PiMock Mock;
+  queue Queue{Mock.getPlatform().get_devices()[0]};
+  detail::QueueImplPtr QueueImpl = detail::getSyclObjImpl(Queue);
+
+  MockCommand Dep(QueueImpl);
+  MockCommand User(QueueImpl);
+  // The user depends on the same command through two requirements.
+  addEdge(&User, &Dep, nullptr);
+  addEdge(&User, &Dep, nullptr);
+
+  EXPECT_EQ(User.MDeps.size(), 2u);
+  EXPECT_EQ(User.getPreparedDepsEvents().size() +
+                User.getPreparedHostDepsEvents().size(),
+            1u);
+}
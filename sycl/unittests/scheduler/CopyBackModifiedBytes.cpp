@@ -0,0 +1,83 @@
+//==---------- CopyBackModifiedBytes.cpp --- Scheduler unit tests ----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "SchedulerTest.hpp"
+
+#include <helpers/PiMock.hpp>
+#include <helpers/TestKernel.hpp>
+#include <sycl/sycl.hpp>
+
+#include <utility>
+#include <vector>
+
+using namespace sycl;
+
+namespace {
+// The offset and the size of the bytes read from the buffers.
+std::vector<std::pair<size_t, size_t>> BufferReads;
+
+pi_result redefinedEnqueueMemBufferRead(pi_queue, pi_mem, pi_bool,
+                                        size_t Offset, size_t Size, void *,
+                                        pi_uint32, const pi_event *,
+                                        pi_event *) {
+  BufferReads.emplace_back(Offset, Size);
+  return PI_SUCCESS;
+}
+} // namespace
+
+class CopyBackModifiedBytesTest : public SchedulerTest {
+protected:
+  void SetUp() override {
+    BufferReads.clear();
+    Mock.redefineBefore<detail::PiApiKind::piEnqueueMemBufferRead>(
+        redefinedEnqueueMemBufferRead);
+  }
+
+  // Writes the ranges of a buffer of Data, which is destroyed on return.
+  void writeRanges(std::vector<int> &Data,
+                   const std::vector<std::pair<size_t, size_t>> &Ranges,
+                   int *FinalData = nullptr) {
+    queue Q{Mock.getPlatform().get_devices()[0], MAsyncHandler};
+    buffer<int, 1> Buf{Data.data(), range<1>{Data.size()}};
+    if (FinalData)
+      Buf.set_final_data(FinalData);
+    for (auto [Offset, Size] : Ranges)
+      Q.submit([&](handler &CGH) {
+        accessor Acc{Buf, CGH, range<1>{Size}, id<1>{Offset}, write_only};
+        CGH.single_task<TestKernel<>>([=] { Acc[0] = 1; });
+      });
+  }
+
+  unittest::PiMock Mock;
+};
+
+TEST_F(CopyBackModifiedBytesTest, OnlyWrittenRangesAreCopiedBack) {
+  std::vector<int> Data(64);
+  writeRanges(Data, {{16, 8}, {48, 8}});
+
+  using RangesT = std::vector<std::pair<size_t, size_t>>;
+  EXPECT_EQ(BufferReads, (RangesT{{64, 32}, {192, 32}}));
+}
+
+TEST_F(CopyBackModifiedBytesTest, AdjacentRangesAreCopiedBackTogether) {
+  std::vector<int> Data(64);
+  writeRanges(Data, {{24, 8}, {16, 8}, {20, 8}});
+
+  using RangesT = std::vector<std::pair<size_t, size_t>>;
+  EXPECT_EQ(BufferReads, (RangesT{{64, 64}}));
+}
+
+TEST_F(CopyBackModifiedBytesTest, AllBytesAreCopiedBackToOtherFinalData) {
+  // The bytes which were not written are not in the final data yet.
+  std::vector<int> Data(64);
+  std::vector<int> FinalData(64);
+  writeRanges(Data, {{16, 8}}, FinalData.data());
+
+  using RangesT = std::vector<std::pair<size_t, size_t>>;
+  EXPECT_EQ(BufferReads, (RangesT{{0, 256}}));
+}
@@ -433,4 +433,45 @@ TEST_F(SchedulerTest, AuxiliaryResourcesDeallocation) {
   MSPtr->cleanupCommands({});
   ASSERT_EQ(MSPtr->MDeferredMemObjRelease.size(), 0u);
 }
+
+// Check that commands are cleaned up by the background thread if it's enabled
+// and that the pending ones are processed when the thread is stopped.
+TEST_F(SchedulerTest, BackgroundCommandCleanup) {
+  unittest::ScopedEnvVar BackgroundCleanupVar{
+      "SYCL_BACKGROUND_COMMAND_CLEANUP", "1",
+      detail::SYCLConfig<detail::SYCL_BACKGROUND_COMMAND_CLEANUP>::reset};
+  unittest::PiMock Mock;
+  platform Plt = Mock.getPlatform();
+  context Ctx{Plt};
+  queue Queue{Ctx, default_selector_v};
+  detail::QueueImplPtr QueueImpl = detail::getSyclObjImpl(Queue);
+  MockScheduler MS;
+
+  buffer<int, 1> Buf{range<1>(1)};
+  detail::Requirement MockReq = getMockRequirement(Buf);
+  size_t NumDeleted = 0;
+  std::function<void()> Callback = [&NumDeleted]() { ++NumDeleted; };
+  auto createEnqueuedCmd = [&]() -> detail::Command * {
+    MockCommand *Cmd =
+        new MockCommandWithCallback(QueueImpl, MockReq, Callback);
+    Cmd->MEnqueueStatus = detail::EnqueueResultT::SyclEnqueueSuccess;
+    return Cmd;
+  };
+
+  {
+    // The background thread can't clean up the commands while the graph lock
+    // is held.
+    auto Lock = MS.acquireGraphReadLock();
+    MS.cleanupCommands({createEnqueuedCmd(), createEnqueuedCmd()});
+    MS.cleanupCommands({createEnqueuedCmd()});
+    EXPECT_EQ(NumDeleted, 0u);
+  }
+
+  MS.releaseResources();
+  EXPECT_EQ(NumDeleted, 3u);
+
+  // Once the thread is stopped, the commands are cleaned up inline.
+  MS.cleanupCommands({createEnqueuedCmd()});
+  EXPECT_EQ(NumDeleted, 4u);
+}
 } // anonymous namespace
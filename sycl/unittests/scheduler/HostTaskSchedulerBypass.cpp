@@ -0,0 +1,66 @@
+//==------- HostTaskSchedulerBypass.cpp --- Scheduler unit tests -----------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "SchedulerTest.hpp"
+#include "SchedulerTestUtils.hpp"
+
+#include <helpers/PiMock.hpp>
+#include <helpers/ScopedEnvVar.hpp>
+#include <helpers/TestKernel.hpp>
+
+#include <detail/config.hpp>
+#include <detail/event_impl.hpp>
+
+#include <gtest/gtest.h>
+
+#include <sycl/sycl.hpp>
+
+#include <atomic>
+
+using namespace sycl;
+
+using BypassConfig =
+    detail::SYCLConfig<detail::SYCL_HOST_TASK_SCHEDULER_BYPASS>;
+
+TEST_F(SchedulerTest, HostTaskSchedulerBypass) {
+  unittest::ScopedEnvVar BypassVar{BypassConfig::getName(), "1",
+                                   BypassConfig::reset};
+  unittest::PiMock Mock;
+  context Ctx{Mock.getPlatform()};
+  queue Queue{Ctx, default_selector_v};
+
+  // A host task that only depends on device events isn't added to the graph.
+  std::atomic<bool> HostTaskRun = false;
+  event KernelEvent = Queue.single_task<TestKernel<>>([]() {});
+  event HostTaskEvent = Queue.submit([&](handler &CGH) {
+    CGH.depends_on(KernelEvent);
+    CGH.host_task([&]() { HostTaskRun = true; });
+  });
+  EXPECT_EQ(detail::getSyclObjImpl(HostTaskEvent)->getCommand(), nullptr);
+  HostTaskEvent.wait();
+  EXPECT_TRUE(HostTaskRun);
+  EXPECT_EQ(HostTaskEvent.get_info<info::event::command_execution_status>(),
+            info::event_command_status::complete);
+
+  // The queue waits for the host tasks it doesn't hold a command for.
+  HostTaskRun = false;
+  Queue.submit(
+      [&](handler &CGH) { CGH.host_task([&]() { HostTaskRun = true; }); });
+  Queue.wait();
+  EXPECT_TRUE(HostTaskRun);
+
+  // Host tasks accessing buffers still go through the graph.
+  buffer<int, 1> Buf{range<1>{1}};
+  event BufferHostTaskEvent = Queue.submit([&](handler &CGH) {
+    auto Acc = Buf.get_access<access::mode::read_write>(CGH);
+    CGH.host_task([=]() { (void)Acc; });
+  });
+  EXPECT_NE(detail::getSyclObjImpl(BufferHostTaskEvent)->getCommand(),
+            nullptr);
+  BufferHostTaskEvent.wait();
+}
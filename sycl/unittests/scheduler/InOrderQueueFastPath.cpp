@@ -0,0 +1,123 @@
+//==----------- InOrderQueueFastPath.cpp --- Scheduler unit tests ---------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "SchedulerTest.hpp"
+#include "SchedulerTestUtils.hpp"
+
+#include <detail/config.hpp>
+#include <detail/event_impl.hpp>
+#include <helpers/PiMock.hpp>
+#include <helpers/ScopedEnvVar.hpp>
+#include <helpers/TestKernel.hpp>
+
+namespace {
+using namespace sycl;
+
+size_t KernelLaunchCounter = 0;
+pi_result redefinedEnqueueKernelLaunch(pi_queue, pi_kernel, pi_uint32,
+                                       const size_t *, const size_t *,
+                                       const size_t *, pi_uint32,
+                                       const pi_event *, pi_event *) {
+  ++KernelLaunchCounter;
+  return PI_SUCCESS;
+}
+
+std::vector<pi_event> BarrierWaitList;
+pi_queue BarrierQueue = nullptr;
+pi_result redefinedEnqueueEventsWaitWithBarrier(
+    pi_queue command_queue, pi_uint32 num_events_in_wait_list,
+    const pi_event *event_wait_list, pi_event *) {
+  BarrierQueue = command_queue;
+  BarrierWaitList.assign(event_wait_list,
+                         event_wait_list + num_events_in_wait_list);
+  return PI_SUCCESS;
+}
+
+sycl::event submitAccessorKernel(sycl::queue &Q, buffer<int, 1> &Buf) {
+  return Q.submit([&](handler &CGH) {
+    Buf.get_access<access::mode::read_write>(CGH);
+    CGH.single_task<TestKernel<>>([]() {});
+  });
+}
+
+class InOrderQueueFastPathTest : public SchedulerTest {
+protected:
+  void SetUp() override {
+    KernelLaunchCounter = 0;
+    BarrierWaitList.clear();
+    BarrierQueue = nullptr;
+    Mock.redefineBefore<detail::PiApiKind::piEnqueueKernelLaunch>(
+        redefinedEnqueueKernelLaunch);
+    Mock.redefineBefore<detail::PiApiKind::piEnqueueEventsWaitWithBarrier>(
+        redefinedEnqueueEventsWaitWithBarrier);
+  }
+
+  unittest::ScopedEnvVar FastPathVar{
+      detail::SYCLConfig<detail::SYCL_IN_ORDER_QUEUE_FAST_PATH>::getName(),
+      "1", [] {
+        detail::SYCLConfig<detail::SYCL_IN_ORDER_QUEUE_FAST_PATH>::reset();
+      }};
+  unittest::PiMock Mock;
+};
+
+TEST_F(InOrderQueueFastPathTest, OwnedBufferBypassesGraph) {
+  context Ctx{Mock.getPlatform().get_devices()[0]};
+  queue Q{Ctx, default_selector_v, property::queue::in_order()};
+  buffer<int, 1> Buf{range<1>(1)};
+
+  // The first submission goes through the graph and makes the queue the owner
+  // of the buffer.
+  event E1 = submitAccessorKernel(Q, Buf);
+  EXPECT_NE(detail::getSyclObjImpl(E1)->getCommand(), nullptr);
+
+  event E2 = submitAccessorKernel(Q, Buf);
+  EXPECT_EQ(detail::getSyclObjImpl(E2)->getCommand(), nullptr);
+  EXPECT_NE(detail::getSyclObjImpl(E2)->getHandleRef(), nullptr);
+  EXPECT_EQ(KernelLaunchCounter, 2u);
+}
+
+TEST_F(InOrderQueueFastPathTest, SharedBufferFoldsIntoGraph) {
+  context Ctx{Mock.getPlatform().get_devices()[0]};
+  queue Q1{Ctx, default_selector_v, property::queue::in_order()};
+  queue Q2{Ctx, default_selector_v, property::queue::in_order()};
+  buffer<int, 1> Buf{range<1>(1)};
+
+  submitAccessorKernel(Q1, Buf);
+  event E2 = submitAccessorKernel(Q1, Buf);
+  detail::EventImplPtr E2Impl = detail::getSyclObjImpl(E2);
+  ASSERT_EQ(E2Impl->getCommand(), nullptr);
+
+  // Using the buffer from another queue must order the new kernel after the
+  // fast path one by the means of a barrier on the owner queue.
+  event E3 = submitAccessorKernel(Q2, Buf);
+  EXPECT_NE(detail::getSyclObjImpl(E3)->getCommand(), nullptr);
+  EXPECT_EQ(BarrierQueue, detail::getSyclObjImpl(Q1)->getHandleRef());
+  ASSERT_EQ(BarrierWaitList.size(), 1u);
+  EXPECT_EQ(BarrierWaitList[0], E2Impl->getHandleRef());
+
+  // The buffer is not exclusively owned by Q1 anymore.
+  event E4 = submitAccessorKernel(Q1, Buf);
+  EXPECT_NE(detail::getSyclObjImpl(E4)->getCommand(), nullptr);
+  EXPECT_EQ(KernelLaunchCounter, 4u);
+}
+
+TEST_F(InOrderQueueFastPathTest, DisabledByDefault) {
+  unittest::ScopedEnvVar DisableVar{
+      detail::SYCLConfig<detail::SYCL_IN_ORDER_QUEUE_FAST_PATH>::getName(),
+      nullptr, [] {
+        detail::SYCLConfig<detail::SYCL_IN_ORDER_QUEUE_FAST_PATH>::reset();
+      }};
+  context Ctx{Mock.getPlatform().get_devices()[0]};
+  queue Q{Ctx, default_selector_v, property::queue::in_order()};
+  buffer<int, 1> Buf{range<1>(1)};
+
+  submitAccessorKernel(Q, Buf);
+  event E2 = submitAccessorKernel(Q, Buf);
+  EXPECT_NE(detail::getSyclObjImpl(E2)->getCommand(), nullptr);
+}
+} // anonymous namespace
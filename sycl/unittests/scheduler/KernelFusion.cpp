@@ -148,3 +148,41 @@ TEST_F(SchedulerTest, CancelKernelFusion) {
   EXPECT_TRUE(dependsOnViaEvent(placeHolderCmd, fusionCmd4));
   EXPECT_TRUE(dependsOnViaEvent(placeHolderCmd, fusionCmd1));
 }
+
+TEST_F(SchedulerTest, AutoFusion) {
+  unittest::PiMock Mock;
+  platform Plt = Mock.getPlatform();
+  if (!CheckTestExecRequirements(Plt))
+    return;
+  device Dev = Plt.get_devices()[0];
+  namespace codeplay = ext::codeplay::experimental;
+  if (!Dev.get_info<codeplay::info::device::supports_fusion>())
+    return;
+
+  using codeplay::property::queue::auto_fusion;
+  EXPECT_THROW((queue{Dev, property_list{auto_fusion{0}}}), sycl::exception);
+
+  queue Queue{Dev, property_list{auto_fusion{4}}};
+  detail::QueueImplPtr QueueImpl = detail::getSyclObjImpl(Queue);
+  auto SubmitKernel = [&]() {
+    Queue.submit([](handler &CGH) { CGH.single_task<TestKernel<>>([] {}); });
+  };
+
+  // A kernel starts a fusion, which is completed by other commands.
+  SubmitKernel();
+  EXPECT_TRUE(QueueImpl->is_in_fusion_mode());
+  Queue.ext_oneapi_submit_barrier();
+  EXPECT_FALSE(QueueImpl->is_in_fusion_mode());
+
+  SubmitKernel();
+  EXPECT_TRUE(QueueImpl->is_in_fusion_mode());
+  Queue.wait();
+  EXPECT_FALSE(QueueImpl->is_in_fusion_mode());
+
+  // A fusion with a single kernel is completed without being fused.
+  queue SingleKernelQueue{Dev, property_list{auto_fusion{1}}};
+  SingleKernelQueue.submit(
+      [](handler &CGH) { CGH.single_task<TestKernel<>>([] {}); });
+  EXPECT_FALSE(detail::getSyclObjImpl(SingleKernelQueue)->is_in_fusion_mode());
+  SingleKernelQueue.wait();
+}
@@ -155,3 +155,36 @@ TEST_F(LeavesCollectionTest, Remove) {
     }
   }
 }
+
+TEST_F(LeavesCollectionTest, RemoveDuplicatedGenericCommand) {
+  sycl::unittest::PiMock Mock;
+  sycl::queue Q{Mock.getPlatform().get_devices()[0], MAsyncHandler};
+
+  static constexpr size_t GenericCmdsCapacity = 4;
+
+  std::vector<sycl::detail::Command *> ToEnqueue;
+
+  LeavesCollection::AllocateDependencyF AllocateDependency =
+      [](Command *, Command *, MemObjRecord *,
+         std::vector<sycl::detail::Command *> &) {};
+
+  LeavesCollection LE =
+      LeavesCollection(nullptr, GenericCmdsCapacity, AllocateDependency);
+  std::shared_ptr<Command> Dup = createGenericCommand(getSyclObjImpl(Q));
+  std::vector<std::shared_ptr<Command>> Cmds;
+
+  ASSERT_TRUE(LE.push_back(Dup.get(), ToEnqueue));
+  ASSERT_TRUE(LE.push_back(Dup.get(), ToEnqueue));
+  for (size_t Idx = 0; Idx < GenericCmdsCapacity - 1; ++Idx) {
+    Cmds.push_back(createGenericCommand(getSyclObjImpl(Q)));
+    ASSERT_TRUE(LE.push_back(Cmds.back().get(), ToEnqueue));
+  }
+
+  // The first occurrence has been pushed out of the buffer, the second one is
+  // still there.
+  EXPECT_EQ(LE.remove(Dup.get()), 1ul);
+  EXPECT_EQ(LE.remove(Dup.get()), 0ul);
+  for (const auto &Cmd : Cmds)
+    EXPECT_EQ(LE.remove(Cmd.get()), 1ul);
+  EXPECT_TRUE(LE.getGenericCommands().empty());
+}
@@ -38,6 +38,7 @@ public:
   bool hasUserDataPtr() const override { return false; }
   bool isHostPointerReadOnly() const override { return false; }
   bool usesPinnedHostMemory() const override { return false; }
+  bool isZeroCopy() const override { return false; }
 
   detail::ContextImplPtr getInteropContext() const override { return nullptr; }
 };
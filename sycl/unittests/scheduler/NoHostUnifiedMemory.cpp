@@ -229,3 +229,77 @@ TEST_F(SchedulerTest, NoHostUnifiedMemory) {
     EXPECT_EQ(InteropAlloca->MMemAllocation, MockInteropBuffer);
   }
 }
+
+TEST_F(SchedulerTest, NoHostUnifiedMemoryDiscardCounters) {
+  unittest::PiMock Mock;
+  queue Q{Mock.getPlatform().get_devices()[0]};
+  Mock.redefineAfter<detail::PiApiKind::piDeviceGetInfo>(
+      redefinedDeviceGetInfoAfter);
+  sycl::detail::QueueImplPtr QImpl = detail::getSyclObjImpl(Q);
+
+  MockScheduler MS;
+  int val;
+  buffer<int, 1> Buf(&val, range<1>(1));
+  detail::Requirement Req = getMockRequirement(Buf);
+  detail::Requirement DiscardReq = getMockRequirement(Buf);
+  DiscardReq.MAccessMode = access::mode::discard_write;
+
+  std::vector<detail::Command *> AuxCmds;
+  detail::MemObjRecord *Record =
+      MS.getOrInsertMemObjRecord(QImpl, &DiscardReq, AuxCmds);
+  MS.getOrCreateAllocaForReq(Record, &DiscardReq, QImpl, AuxCmds);
+  // The user data is never copied to the device.
+  EXPECT_EQ(Record->MAllocaCommands.size(), 1U);
+  EXPECT_EQ(MS.getMemoryMoveCounters().MHostAllocasSkipped, 1U);
+
+  device HostDevice = detail::createSyclObjFromImpl<device>(
+      detail::device_impl::getHostDeviceImpl());
+  std::shared_ptr<detail::queue_impl> DefaultHostQueue{
+      new detail::queue_impl(detail::getSyclObjImpl(HostDevice), {}, {})};
+  MS.getOrCreateAllocaForReq(Record, &Req, DefaultHostQueue, AuxCmds);
+  EXPECT_EQ(MS.insertMemoryMove(Record, &DiscardReq, DefaultHostQueue, AuxCmds),
+            nullptr);
+  EXPECT_EQ(MS.getMemoryMoveCounters().MCopiesSkipped, 1U);
+  EXPECT_EQ(MS.getMemoryMoveCounters().MCopiesInserted, 0U);
+
+  detail::Command *MemoryMove =
+      MS.insertMemoryMove(Record, &Req, QImpl, AuxCmds);
+  ASSERT_NE(MemoryMove, nullptr);
+  EXPECT_EQ(MemoryMove->getType(), detail::Command::COPY_MEMORY);
+  EXPECT_EQ(MS.getMemoryMoveCounters().MCopiesInserted, 1U);
+}
+
+static void *CreatedBufferHostPtr = nullptr;
+static pi_result redefinedMemBufferCreateHostPtr(pi_context, pi_mem_flags,
+                                                 size_t, void *HostPtr,
+                                                 pi_mem *,
+                                                 const pi_mem_properties *) {
+  CreatedBufferHostPtr = HostPtr;
+  return PI_SUCCESS;
+}
+
+TEST_F(SchedulerTest, DiscardOfReadOnlyUserData) {
+  unittest::PiMock Mock;
+  queue Q{Mock.getPlatform().get_devices()[0]};
+  Mock.redefineBefore<detail::PiApiKind::piMemBufferCreate>(
+      redefinedMemBufferCreateHostPtr);
+  sycl::detail::QueueImplPtr QImpl = detail::getSyclObjImpl(Q);
+
+  MockScheduler MS;
+  const int val = 0;
+  buffer<int, 1> Buf(&val, range<1>(1));
+  detail::Requirement DiscardReq = getMockRequirement(Buf);
+  DiscardReq.MAccessMode = access::mode::discard_write;
+
+  // The read-only user pointer cannot be used by the device allocation, and
+  // its contents are not needed.
+  CreatedBufferHostPtr = reinterpret_cast<void *>(1);
+  std::vector<detail::Command *> AuxCmds;
+  detail::MemObjRecord *Record =
+      MS.getOrInsertMemObjRecord(QImpl, &DiscardReq, AuxCmds);
+  detail::AllocaCommandBase *AllocaCmd =
+      MS.getOrCreateAllocaForReq(Record, &DiscardReq, QImpl, AuxCmds);
+  detail::EnqueueResultT Res;
+  MockScheduler::enqueueCommand(AllocaCmd, Res, detail::BLOCKING);
+  EXPECT_EQ(CreatedBufferHostPtr, nullptr);
+}
@@ -0,0 +1,103 @@
+//==------------ PeerMemoryMove.cpp --- Scheduler unit tests ---------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "SchedulerTest.hpp"
+
+#include <helpers/PiMock.hpp>
+#include <sycl/sycl.hpp>
+
+#include <vector>
+
+using namespace sycl;
+
+namespace {
+size_t NumBufferReads = 0;
+std::vector<pi_queue> BufferCopyQueues;
+pi_int32 PeerAccessSupported = 1;
+
+pi_result redefinedEnqueueMemBufferRead(pi_queue, pi_mem, pi_bool, size_t,
+                                        size_t, void *, pi_uint32,
+                                        const pi_event *, pi_event *) {
+  ++NumBufferReads;
+  return PI_SUCCESS;
+}
+
+pi_result redefinedEnqueueMemBufferCopy(pi_queue Queue, pi_mem, pi_mem, size_t,
+                                        size_t, size_t, pi_uint32,
+                                        const pi_event *, pi_event *) {
+  BufferCopyQueues.push_back(Queue);
+  return PI_SUCCESS;
+}
+
+pi_result redefinedPeerAccessGetInfo(pi_device, pi_device, pi_peer_attr,
+                                     size_t, void *ParamValue,
+                                     size_t *ParamValueSizeRet) {
+  if (ParamValue)
+    *static_cast<pi_int32 *>(ParamValue) = PeerAccessSupported;
+  if (ParamValueSizeRet)
+    *ParamValueSizeRet = sizeof(pi_int32);
+  return PI_SUCCESS;
+}
+
+// Writes a buffer on a queue of one context, then reads it on a queue of
+// another one.
+void moveBetweenContexts(const device &Dev, queue &DstQueue) {
+  context SrcContext{Dev};
+  queue SrcQueue{SrcContext, Dev};
+  buffer<int, 1> Buf{range<1>{16}};
+  SrcQueue.submit([&](handler &CGH) {
+    auto Acc = Buf.get_access<access::mode::write>(CGH);
+    CGH.fill(Acc, 1);
+  });
+  DstQueue
+      .submit([&](handler &CGH) {
+        auto Acc = Buf.get_access<access::mode::read_write>(CGH);
+        CGH.fill(Acc, 2);
+      })
+      .wait();
+}
+} // namespace
+
+class PeerMemoryMoveTest : public SchedulerTest {
+protected:
+  void SetUp() override {
+    NumBufferReads = 0;
+    BufferCopyQueues.clear();
+    PeerAccessSupported = 1;
+    Mock.redefineBefore<detail::PiApiKind::piEnqueueMemBufferRead>(
+        redefinedEnqueueMemBufferRead);
+    Mock.redefineBefore<detail::PiApiKind::piEnqueueMemBufferCopy>(
+        redefinedEnqueueMemBufferCopy);
+    Mock.redefine<detail::PiApiKind::piextPeerAccessGetInfo>(
+        redefinedPeerAccessGetInfo);
+  }
+
+  unittest::PiMock Mock;
+};
+
+TEST_F(PeerMemoryMoveTest, PeerCopyBetweenContexts) {
+  device Dev = Mock.getPlatform().get_devices()[0];
+  queue DstQueue{context{Dev}, Dev};
+  moveBetweenContexts(Dev, DstQueue);
+
+  // The buffer is copied directly, by the destination queue.
+  EXPECT_EQ(NumBufferReads, 0u);
+  ASSERT_EQ(BufferCopyQueues.size(), 1u);
+  EXPECT_EQ(BufferCopyQueues[0],
+            detail::getSyclObjImpl(DstQueue)->getHandleRef());
+}
+
+TEST_F(PeerMemoryMoveTest, HostFallbackWithoutPeerAccess) {
+  PeerAccessSupported = 0;
+  device Dev = Mock.getPlatform().get_devices()[0];
+  queue DstQueue{context{Dev}, Dev};
+  moveBetweenContexts(Dev, DstQueue);
+
+  EXPECT_EQ(NumBufferReads, 1u);
+  EXPECT_TRUE(BufferCopyQueues.empty());
+}
@@ -9,7 +9,9 @@
 #include "SchedulerTest.hpp"
 #include "SchedulerTestUtils.hpp"
 
+#include <detail/config.hpp>
 #include <helpers/PiMock.hpp>
+#include <helpers/ScopedEnvVar.hpp>
 
 using namespace sycl;
 
@@ -275,3 +277,47 @@ TEST_F(SchedulerTest, QueueFlushing) {
     EXPECT_FALSE(EventStatusQueried);
   }
 }
+
+TEST_F(SchedulerTest, QueueFlushingBatched) {
+  sycl::unittest::PiMock Mock;
+  sycl::platform Plt = Mock.getPlatform();
+  Mock.redefineBefore<detail::PiApiKind::piQueueFlush>(redefinedQueueFlush);
+  Mock.redefineAfter<detail::PiApiKind::piEventGetInfo>(
+      redefinedEventGetInfoAfter);
+  using BatchSizeConfig =
+      detail::SYCLConfig<detail::SYCL_CROSS_QUEUE_FLUSH_BATCH_SIZE>;
+  unittest::ScopedEnvVar BatchSizeVar{BatchSizeConfig::getName(), "3",
+                                      BatchSizeConfig::reset};
+
+  context Ctx{Plt};
+  queue QueueA{Ctx, default_selector_v};
+  detail::QueueImplPtr QueueImplA = detail::getSyclObjImpl(QueueA);
+  queue QueueB{Ctx, default_selector_v};
+  detail::QueueImplPtr QueueImplB = detail::getSyclObjImpl(QueueB);
+  ExpectedDepQueue = QueueImplB->getHandleRef();
+
+  int val;
+  buffer<int, 1> Buf(&val, range<1>(1));
+  detail::Requirement MockReq = getMockRequirement(Buf);
+
+  pi_mem PIBuf = nullptr;
+  pi_result Ret = mock_piMemBufferCreate(/*pi_context=*/0x0,
+                                         PI_MEM_FLAGS_ACCESS_RW, /*size=*/1,
+                                         /*host_ptr=*/nullptr, &PIBuf);
+  EXPECT_TRUE(Ret == PI_SUCCESS);
+
+  detail::AllocaCommand AllocaCmd = detail::AllocaCommand(QueueImplA, MockReq);
+  AllocaCmd.MMemAllocation = PIBuf;
+  void *MockHostPtr;
+
+  // The dependency queue is flushed once for every three dependencies.
+  for (bool ExpectedFlush : {false, false, true, false}) {
+    detail::MapMemObject Cmd{&AllocaCmd, MockReq, &MockHostPtr, QueueImplA,
+                             access::mode::read_write};
+    testCommandEnqueue(&Cmd, QueueImplB, MockReq, ExpectedFlush);
+  }
+
+  // The deferred flush is done before waiting for a device event.
+  detail::queue_impl::flushDeferredCrossQueueDeps();
+  EXPECT_TRUE(QueueFlushed);
+}
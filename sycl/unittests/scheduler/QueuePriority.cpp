@@ -0,0 +1,87 @@
+//==------------ QueuePriority.cpp --- Scheduler unit tests ----------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "SchedulerTest.hpp"
+#include "SchedulerTestUtils.hpp"
+
+#include <helpers/PiMock.hpp>
+#include <helpers/TestKernel.hpp>
+
+#include <detail/global_handler.hpp>
+#include <detail/queue_impl.hpp>
+
+#include <gtest/gtest.h>
+
+#include <sycl/sycl.hpp>
+
+#include <future>
+#include <mutex>
+#include <vector>
+
+using namespace sycl;
+
+static std::mutex LaunchedQueuesMutex;
+static std::vector<pi_queue> LaunchedQueues;
+static pi_result redefinedEnqueueKernelLaunch(pi_queue Queue, pi_kernel,
+                                              pi_uint32, const size_t *,
+                                              const size_t *, const size_t *,
+                                              pi_uint32, const pi_event *,
+                                              pi_event *) {
+  std::lock_guard<std::mutex> Lock(LaunchedQueuesMutex);
+  LaunchedQueues.push_back(Queue);
+  return PI_SUCCESS;
+}
+
+// Check that the commands blocked by a host task are released in the order of
+// their queue priorities.
+TEST_F(SchedulerTest, BlockedCommandsReleasedByQueuePriority) {
+  LaunchedQueues.clear();
+  unittest::PiMock Mock;
+  Mock.redefineBefore<detail::PiApiKind::piEnqueueKernelLaunch>(
+      redefinedEnqueueKernelLaunch);
+  context Ctx{Mock.getPlatform()};
+  queue HostTaskQueue{Ctx, default_selector_v};
+  queue LowPriorityQueue{Ctx, default_selector_v,
+                         ext::oneapi::property::queue::priority_low()};
+  queue HighPriorityQueue{Ctx, default_selector_v,
+                          ext::oneapi::property::queue::priority_high()};
+  EXPECT_EQ(detail::getSyclObjImpl(LowPriorityQueue)->getSchedulingPriority(),
+            -1);
+  EXPECT_EQ(detail::getSyclObjImpl(HostTaskQueue)->getSchedulingPriority(),
+            0);
+  EXPECT_EQ(detail::getSyclObjImpl(HighPriorityQueue)->getSchedulingPriority(),
+            1);
+
+  std::promise<void> Release;
+  std::shared_future<void> ReleaseFuture = Release.get_future().share();
+  event HostTaskEvent = HostTaskQueue.submit([&](handler &CGH) {
+    CGH.host_task([ReleaseFuture]() { ReleaseFuture.wait(); });
+  });
+  auto SubmitKernel = [&](queue &Q) {
+    return Q.submit([&](handler &CGH) {
+      CGH.depends_on(HostTaskEvent);
+      CGH.single_task<TestKernel<>>([]() {});
+    });
+  };
+  event LowPriorityEvent = SubmitKernel(LowPriorityQueue);
+  event HighPriorityEvent = SubmitKernel(HighPriorityQueue);
+  EXPECT_TRUE(LaunchedQueues.empty());
+
+  // Waiting for the kernel events could enqueue them directly, so wait for
+  // the host task job to release them instead.
+  Release.set_value();
+  detail::GlobalHandler::instance().drainThreadPool();
+
+  ASSERT_EQ(LaunchedQueues.size(), 2u);
+  EXPECT_EQ(LaunchedQueues[0],
+            detail::getSyclObjImpl(HighPriorityQueue)->getHandleRef());
+  EXPECT_EQ(LaunchedQueues[1],
+            detail::getSyclObjImpl(LowPriorityQueue)->getHandleRef());
+  LowPriorityEvent.wait();
+  HighPriorityEvent.wait();
+}
@@ -172,6 +172,10 @@ public:
     return MGraphBuilder.insertMemoryMove(Record, Req, Queue, ToEnqueue);
   }
 
+  const GraphBuilder::MemoryMoveCounters &getMemoryMoveCounters() const {
+    return MGraphBuilder.getMemoryMoveCounters();
+  }
+
   sycl::detail::Command *
   addCopyBack(sycl::detail::Requirement *Req,
               std::vector<sycl::detail::Command *> &ToEnqueue) {
@@ -0,0 +1,107 @@
+//==--------------- SubBufferDeps.cpp --- Scheduler unit tests -------------==//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "SchedulerTest.hpp"
+#include "SchedulerTestUtils.hpp"
+
+#include <detail/config.hpp>
+#include <detail/event_impl.hpp>
+#include <helpers/PiMock.hpp>
+#include <helpers/ScopedEnvVar.hpp>
+#include <helpers/TestKernel.hpp>
+
+#include <algorithm>
+
+using namespace sycl;
+
+inline constexpr auto DisableCleanupName =
+    "SYCL_DISABLE_EXECUTION_GRAPH_CLEANUP";
+
+static detail::Command *getCommand(const event &Event) {
+  return static_cast<detail::Command *>(
+      detail::getSyclObjImpl(Event)->getCommand());
+}
+
+static bool dependsOn(detail::Command *Cmd, detail::Command *DepCmd) {
+  return std::any_of(Cmd->MDeps.begin(), Cmd->MDeps.end(),
+                     [DepCmd](const detail::DepDesc &Dep) {
+                       return Dep.MDepCommand == DepCmd;
+                     });
+}
+
+// Checks that the kernels writing disjoint sub-buffers of a buffer do not
+// depend on each other.
+TEST_F(SchedulerTest, DisjointSubBuffersDoNotDepend) {
+  sycl::unittest::PiMock Mock;
+  // Keep the commands to check their dependencies.
+  unittest::ScopedEnvVar DisabledCleanup{
+      DisableCleanupName, "1",
+      detail::SYCLConfig<detail::SYCL_DISABLE_EXECUTION_GRAPH_CLEANUP>::reset};
+  queue Q{Mock.getPlatform().get_devices()[0], MAsyncHandler};
+
+  buffer<int, 1> Buf{range<1>{64}};
+  buffer<int, 1> FirstHalf{Buf, id<1>{0}, range<1>{32}};
+  buffer<int, 1> SecondHalf{Buf, id<1>{32}, range<1>{32}};
+  buffer<int, 1> Middle{Buf, id<1>{16}, range<1>{32}};
+
+  auto WriteKernel = [&](buffer<int, 1> &SubBuf) {
+    return Q.submit([&](handler &CGH) {
+      auto Acc = SubBuf.get_access<access::mode::write>(CGH);
+      CGH.single_task<TestKernel<>>([=] { Acc[0] = 1; });
+    });
+  };
+  event FirstHalfEvent = WriteKernel(FirstHalf);
+  event SecondHalfEvent = WriteKernel(SecondHalf);
+  event MiddleEvent = WriteKernel(Middle);
+
+  detail::Command *FirstHalfCmd = getCommand(FirstHalfEvent);
+  detail::Command *SecondHalfCmd = getCommand(SecondHalfEvent);
+  detail::Command *MiddleCmd = getCommand(MiddleEvent);
+  ASSERT_NE(FirstHalfCmd, nullptr);
+  ASSERT_NE(SecondHalfCmd, nullptr);
+  ASSERT_NE(MiddleCmd, nullptr);
+
+  EXPECT_FALSE(dependsOn(SecondHalfCmd, FirstHalfCmd));
+  EXPECT_TRUE(dependsOn(MiddleCmd, FirstHalfCmd));
+  EXPECT_TRUE(dependsOn(MiddleCmd, SecondHalfCmd));
+  Q.wait();
+}
+
+// Checks that the kernels writing disjoint ranges of a buffer do not depend on
+// each other, including the columns of a 2D buffer.
+TEST_F(SchedulerTest, DisjointRangedAccessorsDoNotDepend) {
+  sycl::unittest::PiMock Mock;
+  // Keep the commands to check their dependencies.
+  unittest::ScopedEnvVar DisabledCleanup{
+      DisableCleanupName, "1",
+      detail::SYCLConfig<detail::SYCL_DISABLE_EXECUTION_GRAPH_CLEANUP>::reset};
+  queue Q{Mock.getPlatform().get_devices()[0], MAsyncHandler};
+
+  buffer<int, 2> Buf{range<2>{16, 16}};
+  auto WriteKernel = [&](range<2> Range, id<2> Offset) {
+    return Q.submit([&](handler &CGH) {
+      accessor Acc{Buf, CGH, Range, Offset, write_only};
+      CGH.single_task<TestKernel<>>([=] { Acc[Offset] = 1; });
+    });
+  };
+  event LeftEvent = WriteKernel({16, 8}, {0, 0});
+  event RightEvent = WriteKernel({16, 8}, {0, 8});
+  event BottomEvent = WriteKernel({8, 16}, {8, 0});
+
+  detail::Command *LeftCmd = getCommand(LeftEvent);
+  detail::Command *RightCmd = getCommand(RightEvent);
+  detail::Command *BottomCmd = getCommand(BottomEvent);
+  ASSERT_NE(LeftCmd, nullptr);
+  ASSERT_NE(RightCmd, nullptr);
+  ASSERT_NE(BottomCmd, nullptr);
+
+  EXPECT_FALSE(dependsOn(RightCmd, LeftCmd));
+  EXPECT_TRUE(dependsOn(BottomCmd, LeftCmd));
+  EXPECT_TRUE(dependsOn(BottomCmd, RightCmd));
+  Q.wait();
+}
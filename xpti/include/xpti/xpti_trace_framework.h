@@ -503,6 +503,42 @@ XPTI_EXPORT_API bool xptiTraceEnabled();
 /// @return bool that indicates whether it is enabled or not
 XPTI_EXPORT_API bool xptiCheckTraceEnabled(uint16_t stream, uint16_t ttype = 0);
 
+/// @brief Samples the notifications of a stream or of a trace type
+/// @details One notification out of period is sent to the subscribers, and
+/// when max_per_second is not 0, the period is raised while more
+/// notifications than that are sent each second. The notifications are
+/// picked by their event object and instance number, so the begin and end
+/// notifications of a scope are sent or dropped together. The policies can
+/// also be given with the XPTI_SAMPLING environment variable, as a comma
+/// separated list of <stream>[#<trace type>]=<period>[:<max per second>]
+/// entries.
+/// @param stream_id The stream of the notifications
+/// @param trace_type The trace type of the notifications, or 0 for all the
+/// trace types of the stream which have no policy of their own
+/// @param period One in how many notifications are sent; 1 sends them all
+/// @param max_per_second Rough maximum number of notifications sent per
+/// second, or 0 for no limit
+XPTI_EXPORT_API void xptiSetSamplingPolicy(uint8_t stream_id,
+                                           uint16_t trace_type,
+                                           uint32_t period,
+                                           uint32_t max_per_second);
+
+/// @brief Checks if a notification would be sent to the subscribers
+/// @details Instrumentation can call this function before building the
+/// payload of a notification, to skip it when the notification is dropped by
+/// the sampling policy of its stream. The notifications with neither an
+/// object nor an instance number are sampled when they are made, so this
+/// function returns true for them.
+/// @param stream_id The stream of the notification
+/// @param trace_type The trace type of the notification
+/// @param object The event the notification is made for, which may be null
+/// @param instance The instance number of the notification
+/// @return bool that indicates whether the notification would be sent
+XPTI_EXPORT_API bool xptiCheckTraceSampled(uint8_t stream_id,
+                                           uint16_t trace_type,
+                                           xpti::trace_event_data_t *object,
+                                           uint64_t instance);
+
 /// @brief Resets internal state
 /// @details This method is currently ONLY used by the tests and is NOT
 /// recommended for use in the instrumentation of applications or runtimes.
@@ -565,6 +601,11 @@ typedef xpti::result_t (*xpti_add_metadata_t)(xpti::trace_event_data_t *,
 typedef xpti::metadata_t *(*xpti_query_metadata_t)(xpti::trace_event_data_t *);
 typedef bool (*xpti_trace_enabled_t)();
 typedef bool (*xpti_check_trace_enabled_t)(uint16_t stream, uint16_t ttype);
+typedef void (*xpti_set_sampling_policy_t)(uint8_t, uint16_t, uint32_t,
+                                           uint32_t);
+typedef bool (*xpti_check_trace_sampled_t)(uint8_t, uint16_t,
+                                           xpti::trace_event_data_t *,
+                                           uint64_t);
 typedef void (*xpti_force_set_trace_enabled_t)(bool);
 typedef void (*xpti_release_event_t)(xpti::trace_event_data_t *);
 }
@@ -46,6 +46,8 @@ enum functions_t {
   XPTI_STASH_TUPLE,
   XPTI_GET_STASHED_TUPLE,
   XPTI_UNSTASH_TUPLE,
+  XPTI_SET_SAMPLING_POLICY,
+  XPTI_CHECK_TRACE_SAMPLED,
   // All additional functions need to appear before
   // the XPTI_FW_API_COUNT enum
   XPTI_FW_API_COUNT ///< This enum must always be the last one in the list
@@ -85,7 +87,9 @@ class ProxyLoader {
       {XPTI_STASH_TUPLE, "xptiStashTuple"},
       {XPTI_GET_STASHED_TUPLE, "xptiGetStashedTuple"},
       {XPTI_UNSTASH_TUPLE, "xptiUnstashTuple"},
-      {XPTI_RELEASE_EVENT, "xptiReleaseEvent"}};
+      {XPTI_RELEASE_EVENT, "xptiReleaseEvent"},
+      {XPTI_SET_SAMPLING_POLICY, "xptiSetSamplingPolicy"},
+      {XPTI_CHECK_TRACE_SAMPLED, "xptiCheckTraceSampled"}};
 
 public:
   typedef std::vector<xpti_plugin_function_t> dispatch_table_t;
@@ -481,6 +485,35 @@ XPTI_EXPORT_API bool xptiCheckTraceEnabled(uint16_t stream, uint16_t ttype) {
   return false;
 }
 
+XPTI_EXPORT_API void xptiSetSamplingPolicy(uint8_t stream_id,
+                                           uint16_t trace_type,
+                                           uint32_t period,
+                                           uint32_t max_per_second) {
+  if (xpti::ProxyLoader::instance().noErrors()) {
+    auto f =
+        xpti::ProxyLoader::instance().functionByIndex(XPTI_SET_SAMPLING_POLICY);
+    if (f) {
+      (*(xpti_set_sampling_policy_t)f)(stream_id, trace_type, period,
+                                       max_per_second);
+    }
+  }
+}
+
+XPTI_EXPORT_API bool xptiCheckTraceSampled(uint8_t stream_id,
+                                           uint16_t trace_type,
+                                           xpti::trace_event_data_t *object,
+                                           uint64_t instance) {
+  if (xpti::ProxyLoader::instance().noErrors()) {
+    auto f =
+        xpti::ProxyLoader::instance().functionByIndex(XPTI_CHECK_TRACE_SAMPLED);
+    if (f) {
+      return (*(xpti_check_trace_sampled_t)f)(stream_id, trace_type, object,
+                                              instance);
+    }
+  }
+  return false;
+}
+
 XPTI_EXPORT_API void xptiTraceTryToEnable() {
   xpti::ProxyLoader::instance().tryToEnable();
 }
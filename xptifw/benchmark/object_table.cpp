@@ -47,6 +47,8 @@ BENCHMARK(ObjectTable_Insert)->Threads(8)->Iterations(NUM_ITERATIONS);
 BENCHMARK(ObjectTable_Insert)->Threads(16)->Iterations(NUM_ITERATIONS);
 BENCHMARK(ObjectTable_Insert)->Threads(24)->Iterations(NUM_ITERATIONS);
 BENCHMARK(ObjectTable_Insert)->Threads(32)->Iterations(NUM_ITERATIONS);
+BENCHMARK(ObjectTable_Insert)->Threads(48)->Iterations(NUM_ITERATIONS);
+BENCHMARK(ObjectTable_Insert)->Threads(64)->Iterations(NUM_ITERATIONS);
 
 static void ObjectTable_Lookup(benchmark::State &State) {
   if (State.thread_index == 0) {
@@ -86,3 +88,5 @@ BENCHMARK(ObjectTable_Lookup)->Threads(8)->Iterations(NUM_ITERATIONS);
 BENCHMARK(ObjectTable_Lookup)->Threads(16)->Iterations(NUM_ITERATIONS);
 BENCHMARK(ObjectTable_Lookup)->Threads(24)->Iterations(NUM_ITERATIONS);
 BENCHMARK(ObjectTable_Lookup)->Threads(32)->Iterations(NUM_ITERATIONS);
+BENCHMARK(ObjectTable_Lookup)->Threads(48)->Iterations(NUM_ITERATIONS);
+BENCHMARK(ObjectTable_Lookup)->Threads(64)->Iterations(NUM_ITERATIONS);
@@ -14,6 +14,7 @@
 constexpr uint64_t NUM_ITERATIONS = 100'000;
 
 static std::vector<xpti::string_id_t> *GIDs;
+static std::vector<std::string> *GStrings;
 static xpti::StringTable *GStringTable = nullptr;
 
 static void StringTable_Insert(benchmark::State &State) {
@@ -45,6 +46,8 @@ BENCHMARK(StringTable_Insert)->Threads(8)->Iterations(NUM_ITERATIONS);
 BENCHMARK(StringTable_Insert)->Threads(16)->Iterations(NUM_ITERATIONS);
 BENCHMARK(StringTable_Insert)->Threads(24)->Iterations(NUM_ITERATIONS);
 BENCHMARK(StringTable_Insert)->Threads(32)->Iterations(NUM_ITERATIONS);
+BENCHMARK(StringTable_Insert)->Threads(48)->Iterations(NUM_ITERATIONS);
+BENCHMARK(StringTable_Insert)->Threads(64)->Iterations(NUM_ITERATIONS);
 
 static void StringTable_Lookup(benchmark::State &State) {
   if (State.thread_index == 0) {
@@ -88,3 +91,42 @@ BENCHMARK(StringTable_Lookup)->Threads(8)->Iterations(NUM_ITERATIONS);
 BENCHMARK(StringTable_Lookup)->Threads(16)->Iterations(NUM_ITERATIONS);
 BENCHMARK(StringTable_Lookup)->Threads(24)->Iterations(NUM_ITERATIONS);
 BENCHMARK(StringTable_Lookup)->Threads(32)->Iterations(NUM_ITERATIONS);
+BENCHMARK(StringTable_Lookup)->Threads(48)->Iterations(NUM_ITERATIONS);
+BENCHMARK(StringTable_Lookup)->Threads(64)->Iterations(NUM_ITERATIONS);
+
+// Registers the strings of a small set again and again, as the payloads of
+// the same tracepoints do.
+static void StringTable_AddExisting(benchmark::State &State) {
+  if (State.thread_index == 0) {
+    GStringTable = new xpti::StringTable();
+    GStrings = new std::vector<std::string>();
+    for (int I = 0; I < 1'000; I++) {
+      GStrings->push_back(getRandomString());
+      GStringTable->add(GStrings->back().c_str());
+    }
+  }
+
+  size_t I = State.thread_index;
+  for (auto _ : State) {
+    const char *Ref = nullptr;
+    I = (I + 7) % GStrings->size();
+    benchmark::DoNotOptimize(GStringTable->add((*GStrings)[I].c_str(), &Ref));
+  }
+
+  if (State.thread_index == 0) {
+    delete GStringTable;
+    delete GStrings;
+    GStringTable = nullptr;
+    GStrings = nullptr;
+  }
+}
+
+BENCHMARK(StringTable_AddExisting)->Threads(1)->Iterations(NUM_ITERATIONS);
+BENCHMARK(StringTable_AddExisting)->Threads(2)->Iterations(NUM_ITERATIONS);
+BENCHMARK(StringTable_AddExisting)->Threads(4)->Iterations(NUM_ITERATIONS);
+BENCHMARK(StringTable_AddExisting)->Threads(8)->Iterations(NUM_ITERATIONS);
+BENCHMARK(StringTable_AddExisting)->Threads(16)->Iterations(NUM_ITERATIONS);
+BENCHMARK(StringTable_AddExisting)->Threads(24)->Iterations(NUM_ITERATIONS);
+BENCHMARK(StringTable_AddExisting)->Threads(32)->Iterations(NUM_ITERATIONS);
+BENCHMARK(StringTable_AddExisting)->Threads(48)->Iterations(NUM_ITERATIONS);
+BENCHMARK(StringTable_AddExisting)->Threads(64)->Iterations(NUM_ITERATIONS);
@@ -6,9 +6,13 @@
 #pragma once
 
 #include "spin_lock.hpp"
+#include "xpti_segmented_array.hpp"
 
 #include <array>
+#include <atomic>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <shared_mutex>
 #include <string_view>
@@ -24,6 +28,11 @@ namespace xpti {
 /// to allow passing them as metadata. If an object being added already exists,
 /// an existing ID will be returned.
 ///
+/// The objects are spread over shards by hash, each with its own reader-writer
+/// lock, so that the threads registering different objects do not contend.
+/// The objects never move once inserted, and the lookups read them from a
+/// segmented array without any lock.
+///
 /// @tparam KeyType is the data type of the returned key.
 /// @tparam SmallSize is the size of an object, that will fit within table
 /// without allocation of additional memory (i.e. small size optimization).
@@ -56,43 +65,36 @@ public:
   ObjectTable(size_t InitialSize = 4096,
               const HashFunction &HashFunc = DefaultHash)
       : MHashFunction(HashFunc) {
-    MValues.reserve(InitialSize);
+    for (Shard &S : MShards)
+      S.MCache.reserve(InitialSize / NumShards);
   }
 
   /// Inserts an object into a table or retrieves an existing object ID.
   KeyType insert(std::string_view Data, uint8_t Type) {
     uint64_t Hash = MHashFunction(Data);
+    Shard &S = MShards[(Hash * 0x9e3779b97f4a7c15ULL) >> 58];
 
-    SharedLock Lock(MMutex);
+    SharedLock Lock(S.MMutex);
     // Check if this data object already exists
-    if (MCache.count(Hash) > 0) {
-      for (KeyType Key : MCache[Hash]) {
-        // Avoid collisions
-        if (getValue(MValues[Key]).first == Data) {
-#ifdef XPTI_STATISTICS
-          MCacheHits++;
-#endif
-          return Key;
-        }
-      }
-    }
-
-    const Value &V = makeValue(Data, Hash, Type);
+    if (const KeyType *Key = find(S, Data, Hash))
+      return *Key;
 
     Lock.upgrade_to_writer();
+    // Another thread may have inserted it while the lock was upgraded
+    if (const KeyType *Key = find(S, Data, Hash))
+      return *Key;
 
-    MValues.push_back(std::move(V));
-    KeyType Key = MValues.size() - 1;
-    MCache[MValues.back().MHash].push_back(Key);
+    const Value &V = S.MValues.emplace_back(makeValue(Data, Hash, Type));
+    KeyType Key = MNextKey++;
+    MValuesByKey.set(Key, &V);
+    S.MCache[Hash].push_back(Key);
 
     return Key;
   }
 
   /// @returns a pair of raw data bytes and registered data type.
   std::pair<std::string_view, uint8_t> lookup(KeyType Key) {
-    SharedLock Lock(MMutex);
-
-    return getValue(MValues[Key]);
+    return getValue(*MValuesByKey.get(Key));
   }
 
 #ifdef XPTI_STATISTICS
@@ -138,6 +140,32 @@ private:
     return V;
   }
 
+  /// Number of shards, 2^6 to match the shard index computed in insert().
+  static constexpr size_t NumShards = 64;
+
+  struct Shard {
+    /// The values never move once inserted
+    std::deque<Value> MValues;
+    std::unordered_map<uint64_t, std::vector<KeyType>> MCache;
+    mutable xpti::SharedSpinLock MMutex;
+  };
+
+  const KeyType *find(const Shard &S, std::string_view Data, uint64_t Hash) {
+    auto It = S.MCache.find(Hash);
+    if (It == S.MCache.end())
+      return nullptr;
+    for (const KeyType &Key : It->second) {
+      // Avoid collisions
+      if (getValue(*MValuesByKey.get(Key)).first == Data) {
+#ifdef XPTI_STATISTICS
+        MCacheHits++;
+#endif
+        return &Key;
+      }
+    }
+    return nullptr;
+  }
+
   std::pair<std::string_view, uint8_t> getValue(const Value &V) {
     return std::visit(
         [&V](auto &&Data) {
@@ -148,14 +176,14 @@ private:
   }
 
   HashFunction MHashFunction;
-  std::vector<Value> MValues;
-  std::unordered_map<uint64_t, std::vector<KeyType>> MCache;
-  mutable xpti::SharedSpinLock MMutex;
+  std::array<Shard, NumShards> MShards;
+  SegmentedArray<Value> MValuesByKey;
+  std::atomic<KeyType> MNextKey{0};
 
 #ifdef XPTI_STATISTICS
-  size_t MCacheHits = 0;
-  size_t MSmallObjects = 0;
-  size_t MLargeObjects = 0;
+  std::atomic<size_t> MCacheHits{0};
+  std::atomic<size_t> MSmallObjects{0};
+  std::atomic<size_t> MLargeObjects{0};
 #endif
 };
 } // namespace xpti
@@ -0,0 +1,184 @@
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#pragma once
+
+#include "xpti/xpti_data_types.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace xpti {
+/// Sampling and rate limiting of the notifications of a stream or of a trace
+/// type of a stream.
+///
+/// One notification out of Period is kept. The choice is a hash of the event
+/// object and the instance number of the notification, so that the begin and
+/// end notifications of a scope, which share them, are kept or dropped
+/// together. The notifications with neither an object nor an instance
+/// number are picked by a counter.
+///
+/// When the policy has a maximum rate, the period doubles whenever more
+/// notifications than the rate are kept within a second, and halves back
+/// towards the requested one after each second in which less than half of
+/// the rate was kept. A scope that straddles a change of the period may lose
+/// one of its notifications.
+class SamplingPolicy {
+public:
+  void set(uint32_t Period, uint32_t MaxPerSecond) {
+    Period = std::max<uint32_t>(Period, 1);
+    MBasePeriod.store(Period, std::memory_order_relaxed);
+    MMaxPerSecond.store(MaxPerSecond, std::memory_order_relaxed);
+    MPeriod.store(Period, std::memory_order_relaxed);
+    MKept.store(0, std::memory_order_relaxed);
+  }
+
+  /// @param Count is true if the kept notification is delivered, in which
+  /// case it counts towards the maximum rate.
+  bool sample(const xpti::trace_event_data_t *Object, uint64_t Instance,
+              bool Count) {
+    uint64_t Period = MPeriod.load(std::memory_order_relaxed);
+    if (Period > 1) {
+      uint64_t Key;
+      if (Object || Instance)
+        Key = mix(Instance ^ mix(Object ? Object->unique_id : 0));
+      else
+        Key = MCounter.fetch_add(1, std::memory_order_relaxed);
+      if (Key % Period)
+        return false;
+    }
+    if (Count && MMaxPerSecond.load(std::memory_order_relaxed))
+      countKept();
+    return true;
+  }
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  /// Finalizer of SplitMix64, which spreads the sequential instance numbers.
+  static uint64_t mix(uint64_t Value) {
+    Value ^= Value >> 30;
+    Value *= 0xbf58476d1ce4e5b9ULL;
+    Value ^= Value >> 27;
+    Value *= 0x94d049bb133111ebULL;
+    return Value ^ (Value >> 31);
+  }
+
+  void countKept() {
+    uint64_t MaxPerSecond = MMaxPerSecond.load(std::memory_order_relaxed);
+    if (MKept.fetch_add(1, std::memory_order_relaxed) >= MaxPerSecond) {
+      MKept.store(0, std::memory_order_relaxed);
+      MPeriod.store(MPeriod.load(std::memory_order_relaxed) * 2,
+                    std::memory_order_relaxed);
+    }
+
+    int64_t Now = clock::now().time_since_epoch().count();
+    int64_t Start = MWindowStart.load(std::memory_order_relaxed);
+    if (Now - Start < std::chrono::duration_cast<clock::duration>(
+                          std::chrono::seconds(1))
+                          .count() ||
+        !MWindowStart.compare_exchange_strong(Start, Now,
+                                              std::memory_order_relaxed))
+      return;
+
+    // The first window starts with the first notification.
+    uint64_t Kept = MKept.exchange(0, std::memory_order_relaxed);
+    if (Start && Kept * 2 < MaxPerSecond) {
+      uint64_t BasePeriod = MBasePeriod.load(std::memory_order_relaxed);
+      uint64_t Period = MPeriod.load(std::memory_order_relaxed);
+      MPeriod.store(std::max(BasePeriod, Period / 2),
+                    std::memory_order_relaxed);
+    }
+  }
+
+  std::atomic<uint32_t> MBasePeriod{1};
+  std::atomic<uint32_t> MMaxPerSecond{0};
+  std::atomic<uint64_t> MPeriod{1};
+  std::atomic<uint64_t> MCounter{0};
+  /// Notifications kept since the start of the current window or the last
+  /// change of the period.
+  std::atomic<uint64_t> MKept{0};
+  std::atomic<int64_t> MWindowStart{0};
+};
+
+/// The sampling policies of the streams and trace types.
+///
+/// The notifications look the policies up in an immutable sorted table, with
+/// no lock. Setting a policy copies the table; the older tables and the
+/// policies are kept alive until the framework is destroyed, as the policies
+/// are rarely set.
+class SamplingPolicies {
+public:
+  /// Sets the policy of a trace type of a stream, or of all the trace types
+  /// of the stream which have no policy of their own if TraceType is 0.
+  void set(uint8_t StreamID, uint16_t TraceType, uint32_t Period,
+           uint32_t MaxPerSecond) {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    uint32_t Key = makeKey(StreamID, TraceType);
+    const table_t *Current = MTable.load(std::memory_order_relaxed);
+    if (Current)
+      if (SamplingPolicy *Policy = find(*Current, Key)) {
+        Policy->set(Period, MaxPerSecond);
+        return;
+      }
+
+    SamplingPolicy &Policy = MPolicies.emplace_back();
+    Policy.set(Period, MaxPerSecond);
+    auto Table = std::make_unique<table_t>(Current ? *Current : table_t{});
+    Table->insert(std::upper_bound(Table->begin(), Table->end(),
+                                   std::make_pair(Key, &Policy)),
+                  std::make_pair(Key, &Policy));
+    MTable.store(Table.get(), std::memory_order_release);
+    MTables.push_back(std::move(Table));
+  }
+
+  /// @param Count is true if the kept notification is delivered.
+  /// @return false if the notification is dropped by its policy.
+  bool sample(uint8_t StreamID, uint16_t TraceType,
+              const xpti::trace_event_data_t *Object, uint64_t Instance,
+              bool Count) {
+    const table_t *Table = MTable.load(std::memory_order_acquire);
+    if (!Table)
+      return true;
+    SamplingPolicy *Policy = find(*Table, makeKey(StreamID, TraceType));
+    if (!Policy)
+      Policy = find(*Table, makeKey(StreamID, 0));
+    return !Policy || Policy->sample(Object, Instance, Count);
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> Lock(MMutex);
+    MTable.store(nullptr, std::memory_order_release);
+  }
+
+private:
+  using table_t = std::vector<std::pair<uint32_t, SamplingPolicy *>>;
+
+  static uint32_t makeKey(uint8_t StreamID, uint16_t TraceType) {
+    return (uint32_t)StreamID << 16 | TraceType;
+  }
+
+  static SamplingPolicy *find(const table_t &Table, uint32_t Key) {
+    auto It = std::lower_bound(
+        Table.begin(), Table.end(), Key,
+        [](const table_t::value_type &Entry, uint32_t Key) {
+          return Entry.first < Key;
+        });
+    return It != Table.end() && It->first == Key ? It->second : nullptr;
+  }
+
+  std::atomic<const table_t *> MTable{nullptr};
+  std::vector<std::unique_ptr<table_t>> MTables;
+  std::deque<SamplingPolicy> MPolicies;
+  std::mutex MMutex;
+};
+} // namespace xpti
@@ -0,0 +1,84 @@
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace xpti {
+/// Array of pointers indexed by the sequential IDs of a table, which can be
+/// read without any lock while it grows.
+///
+/// The segment I holds 2^(FirstSegmentBits + I) pointers and is allocated
+/// when its first pointer is set, so that the array never moves and small
+/// tables stay small. The pointers are not owned by the array.
+template <typename T> class SegmentedArray {
+public:
+  SegmentedArray() = default;
+  SegmentedArray(const SegmentedArray &) = delete;
+  SegmentedArray &operator=(const SegmentedArray &) = delete;
+  ~SegmentedArray() { clear(); }
+
+  /// @returns the pointer at Index, or nullptr if it has not been set.
+  const T *get(uint64_t Index) const {
+    if (Index >= MaxSize)
+      return nullptr;
+    auto [Segment, Offset] = locate(Index);
+    std::atomic<const T *> *Pointers =
+        MSegments[Segment].load(std::memory_order_acquire);
+    return Pointers ? Pointers[Offset].load(std::memory_order_acquire)
+                    : nullptr;
+  }
+
+  /// Publishes Pointer at Index. The indices can be set concurrently.
+  void set(uint64_t Index, const T *Pointer) {
+    if (Index >= MaxSize)
+      return;
+    auto [Segment, Offset] = locate(Index);
+    std::atomic<const T *> *Pointers =
+        MSegments[Segment].load(std::memory_order_acquire);
+    if (!Pointers) {
+      size_t Size = size_t(1) << (FirstSegmentBits + Segment);
+      auto *New = new std::atomic<const T *>[Size];
+      for (size_t I = 0; I < Size; ++I)
+        New[I].store(nullptr, std::memory_order_relaxed);
+      if (MSegments[Segment].compare_exchange_strong(
+              Pointers, New, std::memory_order_acq_rel))
+        Pointers = New;
+      else
+        delete[] New;
+    }
+    Pointers[Offset].store(Pointer, std::memory_order_release);
+  }
+
+  /// Frees the segments. Must not race with get() or set().
+  void clear() {
+    for (auto &Segment : MSegments)
+      delete[] Segment.exchange(nullptr);
+  }
+
+private:
+  static constexpr unsigned FirstSegmentBits = 6;
+  /// Enough segments for the 32-bit indices.
+  static constexpr unsigned NumSegments = 32 - FirstSegmentBits;
+  static constexpr uint64_t MaxSize =
+      (uint64_t(1) << 32) - (uint64_t(1) << FirstSegmentBits);
+
+  static std::pair<unsigned, uint32_t> locate(uint64_t Index) {
+    uint32_t Biased = uint32_t(Index + (uint64_t(1) << FirstSegmentBits));
+    unsigned Bit = 0;
+    for (unsigned Shift = 16; Shift; Shift /= 2)
+      if (Biased >> (Bit + Shift))
+        Bit += Shift;
+    return {Bit - FirstSegmentBits, Biased - (uint32_t(1) << Bit)};
+  }
+
+  std::array<std::atomic<std::atomic<const T *> *>, NumSegments> MSegments{};
+};
+} // namespace xpti
@@ -5,10 +5,17 @@
 //
 #pragma once
 
+#include "spin_lock.hpp"
 #include "xpti/xpti_data_types.h"
+#include "xpti_segmented_array.hpp"
 
+#include <array>
 #include <atomic>
+#include <deque>
+#include <functional>
 #include <mutex>
+#include <string>
+#include <string_view>
 #include <unordered_map>
 
 #ifdef XPTI_STATISTICS
@@ -20,15 +27,22 @@ namespace xpti {
 /// \details With each payload, a kernel/function name and the source file name
 /// may be passed and we need to ensure that the incoming strings are copied and
 /// represented in a string table as the incoming strings are guaranteed to be
-/// valid only for the duration of the call that handles the payload. This
-/// implementation used STL containers protected with std::mutex.
+/// valid only for the duration of the call that handles the payload.
+///
+/// The strings are spread over shards by hash, each with its own reader-writer
+/// lock, so that the threads registering different strings do not contend.
+/// The lookups take a string_view and copy the incoming string only when it is
+/// inserted. The string IDs are handed out sequentially, and the reverse
+/// lookup reads them from a segmented array without any lock.
 class StringTable {
 public:
-  using st_forward_t = std::unordered_map<std::string, int32_t>;
   using st_reverse_t = std::unordered_map<int32_t, const char *>;
 
-  StringTable(int size = 4096) : MStringToID(size), MIDToString(size) {
+  StringTable(int size = 4096) {
+    for (Shard &S : MShards)
+      S.MStringToID.reserve(size / NumShards);
     MIds = 1;
+    MStrings = 0;
 #ifdef XPTI_STATISTICS
     MInsertions = 0;
     MRetrievals = 0;
@@ -37,9 +51,14 @@ public:
 
   //  Clear all the contents of this string table and get it ready for re-use
   void clear() {
-    MIds = 1;
+    for (Shard &S : MShards) {
+      std::lock_guard<SharedSpinLock> Lock(S.MMutex);
+      S.MStringToID.clear();
+      S.MStrings.clear();
+    }
     MIDToString.clear();
-    MStringToID.clear();
+    MIds = 1;
+    MStrings = 0;
 
 #ifdef XPTI_STATISTICS
     MInsertions = 0;
@@ -58,98 +77,70 @@ public:
     if (!str)
       return xpti::invalid_id;
 
-    std::string LocalStr = str;
-    return add(LocalStr, ref_str);
+    return add(std::string_view(str), ref_str);
   }
 
-  xpti::string_id_t add(std::string str, const char **ref_str = nullptr) {
+  xpti::string_id_t add(std::string_view str, const char **ref_str = nullptr) {
     if (str.empty())
       return xpti::invalid_id;
 
+    Shard &S = MShards[shardIndex(std::hash<std::string_view>{}(str))];
+    SharedLock Lock(S.MMutex);
     // Try to see if the string is already present in the string table
-    auto Loc = MStringToID.find(str);
-    if (Loc != MStringToID.end()) {
+    auto Loc = S.MStringToID.find(str);
+    if (Loc == S.MStringToID.end()) {
+      // Multiple threads could fall through here, so look again with the
+      // writer lock
+      Lock.upgrade_to_writer();
+      Loc = S.MStringToID.find(str);
+    }
+    if (Loc != S.MStringToID.end()) {
 #ifdef XPTI_STATISTICS
       MRetrievals++;
 #endif
       if (ref_str)
-        *ref_str = Loc->first.c_str();
-
-      // We found it, so we return the string ID
+        *ref_str = Loc->first.data();
       return Loc->second;
-    } else {
-      // String not in the table
-      // Multiple threads could fall through here
-      string_id_t StrID;
-      {
-        // Employ a double-check pattern here
-        std::lock_guard<std::mutex> lock(MMutex);
-        auto Loc = MStringToID.find(str);
-        // String not present in the table
-        if (Loc == MStringToID.end()) {
-          // Add it
-          StrID = MIds++;
-          auto Entry = MStringToID.insert(st_forward_t::value_type(str, StrID));
-          if (ref_str)
-            *ref_str = Entry.first->first.c_str();
-#ifdef XPTI_STATISTICS
-          MInsertions++;
-#endif
-          //  When we insert a new entry into the table, we also need to build
-          //  the reverse lookup;
-          {
-            auto IDLoc = MIDToString.find(StrID);
-            if (IDLoc == MIDToString.end()) {
-              //  An entry does not exist, so we will add it to the reverse
-              //  lookup.
-              MIDToString[StrID] = Entry.first->first.c_str();
-              // Cache the saved string address and send it to the caller
-              MStrings++;
-              return StrID;
-            } else {
-              // We cannot have a case where a string is not present in the
-              // forward lookup and present in the reverse lookup
-              MStringToID.erase(Loc);
-              if (ref_str)
-                *ref_str = nullptr;
-
-              return xpti::invalid_id;
-            }
-          }
-
-        } else {
-          // The string has already been added, so we return the stored ID
-          StrID = Loc->second;
+    }
+
+    // The strings of a shard are stored in a deque, so that their addresses
+    // never change
+    const std::string &Stored = S.MStrings.emplace_back(str);
+    string_id_t StrID = MIds++;
+    S.MStringToID.emplace(Stored, StrID);
+    MIDToString.set(StrID, Stored.c_str());
+    MStrings++;
 #ifdef XPTI_STATISTICS
-          MRetrievals++;
+    MInsertions++;
 #endif
-          if (ref_str)
-            *ref_str = Loc->first.c_str();
-          return StrID;
-        }
-        // The MMutex will be released here!
-      }
-    }
-    return xpti::invalid_id;
+    if (ref_str)
+      *ref_str = Stored.c_str();
+    return StrID;
   }
 
   //  The reverse query allows one to get the string from the string_id_t that
   //  may have been cached somewhere.
   const char *query(xpti::string_id_t id) {
-    std::lock_guard<std::mutex> lock(MMutex);
-    auto Loc = MIDToString.find(id);
-    if (Loc != MIDToString.end()) {
+    if (id <= 0)
+      return nullptr;
+    const char *Str = MIDToString.get(id);
 #ifdef XPTI_STATISTICS
+    if (Str)
       MRetrievals++;
 #endif
-      return Loc->second;
-    } else
-      return nullptr;
+    return Str;
   }
 
   int32_t count() { return (int32_t)MStrings; }
 
-  const st_reverse_t &table() { return MIDToString; }
+  /// @returns a snapshot of the reverse lookup table.
+  st_reverse_t table() {
+    st_reverse_t Table;
+    for (int32_t ID = 1; ID < MIds; ++ID)
+      if (const char *Str = query(ID))
+        Table[ID] = Str;
+    return Table;
+  }
 
   void printStatistics() {
 #ifdef XPTI_STATISTICS
@@ -175,12 +166,26 @@ public:
   }
 
 private:
-  safe_int32_t MIds;        ///< Thread-safe ID generator
-  st_forward_t MStringToID; ///< Forward lookup hash map
-  st_reverse_t MIDToString; ///< Reverse lookup hash map
-  std::mutex MMutex;        ///< Mutex required for double-check pattern
-                            ///< Replace with reader-writer lock in C++14
-  safe_int32_t MStrings;    ///< The count of strings in the table
+  /// Number of shards of the forward lookup, 2^6 to match shardIndex().
+  static constexpr size_t NumShards = 64;
+
+  struct Shard {
+    /// Keys point into MStrings
+    std::unordered_map<std::string_view, string_id_t> MStringToID;
+    std::deque<std::string> MStrings;
+    SharedSpinLock MMutex;
+  };
+
+  /// Uses the high bits of the hash, as the shards' hash maps use the low
+  /// ones.
+  static size_t shardIndex(size_t Hash) {
+    return (uint64_t(Hash) * 0x9e3779b97f4a7c15ULL) >> 58;
+  }
+
+  std::array<Shard, NumShards> MShards;
+  SegmentedArray<char> MIDToString; ///< Reverse lookup
+  safe_int32_t MIds;     ///< Thread-safe ID generator
+  safe_int32_t MStrings; ///< The count of strings in the table
 #ifdef XPTI_STATISTICS
   safe_uint64_t MInsertions, ///< Thread-safe tracking of insertions
       MRetrievals;           ///< Thread-safe tracking of lookups
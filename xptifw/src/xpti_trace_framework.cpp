@@ -6,6 +6,7 @@
 #include "xpti/xpti_trace_framework.hpp"
 #include "xpti_int64_hash_table.hpp"
 #include "xpti_object_table.hpp"
+#include "xpti_sampling_policies.hpp"
 #include "xpti_string_table.hpp"
 
 #include <algorithm>
@@ -13,6 +14,7 @@
 #include <atomic>
 #include <cassert>
 #include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <map>
 #include <mutex>
@@ -48,6 +50,7 @@ static thread_local uint64_t g_tls_uid = xpti::invalid_uid;
 
 namespace xpti {
 constexpr const char *env_subscribers = "XPTI_SUBSCRIBERS";
+constexpr const char *env_sampling = "XPTI_SAMPLING";
 xpti::utils::PlatformHelper g_helper;
 xpti::utils::SpinLock g_framework_mutex;
 // This class is a helper class to load all the listed subscribers provided by
@@ -267,8 +270,11 @@ public:
     // and -1 is invalid_id
     MUId = 1;
     MInsertions = MRetrievals = 0;
-    MPayloads.clear();
-    MEvents.clear();
+    for (EventShard &Shard : MEventShards) {
+      std::lock_guard<std::mutex> Lock(Shard.MMutex);
+      Shard.MPayloads.clear();
+      Shard.MEvents.clear();
+    }
   }
 
   inline uint64_t makeUniqueID() { return MUId++; }
@@ -304,12 +310,13 @@ public:
       return nullptr;
     // Scoped lock until the information is retrieved from the map
     {
-      std::lock_guard<std::mutex> Lock(MEventMutex);
+      EventShard &Shard = getShard(Event->unique_id);
+      std::lock_guard<std::mutex> Lock(Shard.MMutex);
       if (Event->reserved.payload)
         return Event->reserved.payload;
       else {
         // Cache it in case it is not already cached
-        Event->reserved.payload = &MPayloads[Event->unique_id];
+        Event->reserved.payload = &Shard.MPayloads[Event->unique_id];
         return Event->reserved.payload;
       }
     }
@@ -320,9 +327,10 @@ public:
       return nullptr;
     // Scoped lock until the information is retrieved from the map
     {
-      std::lock_guard<std::mutex> Lock(MEventMutex);
+      EventShard &Shard = getShard(uid);
+      std::lock_guard<std::mutex> Lock(Shard.MMutex);
       // Cache it in case it is not already cached
-      return &MPayloads[uid];
+      return &Shard.MPayloads[uid];
     }
   }
 
@@ -330,9 +338,10 @@ public:
     if (UId == xpti::invalid_uid)
       return nullptr;
 
-    std::lock_guard<std::mutex> Lock(MEventMutex);
-    auto EvLoc = MEvents.find(UId);
-    if (EvLoc != MEvents.end())
+    EventShard &Shard = getShard(UId);
+    std::lock_guard<std::mutex> Lock(Shard.MMutex);
+    auto EvLoc = Shard.MEvents.find(UId);
+    if (EvLoc != Shard.MEvents.end())
       return &(EvLoc->second);
     else
       return nullptr;
@@ -341,9 +350,10 @@ public:
   void releaseEvent(xpti::trace_event_data_t *Event) {
     if (!Event)
       return;
-    std::lock_guard<std::mutex> Lock(MEventMutex);
-    std::ignore = MEvents.erase(Event->unique_id);
-    std::ignore = MPayloads.erase(Event->unique_id);
+    EventShard &Shard = getShard(Event->unique_id);
+    std::lock_guard<std::mutex> Lock(Shard.MMutex);
+    std::ignore = Shard.MEvents.erase(Event->unique_id);
+    std::ignore = Shard.MPayloads.erase(Event->unique_id);
   }
 
   // Sometimes, the user may want to add key-value pairs as metadata associated
@@ -394,10 +404,11 @@ public:
     if (HashValue == xpti::invalid_uid)
       return xpti::invalid_uid;
 
-    std::lock_guard<std::mutex> Lock(MEventMutex);
+    EventShard &Shard = getShard(HashValue);
+    std::lock_guard<std::mutex> Lock(Shard.MMutex);
     // We also want to query the payload by universal ID that has been
     // generated
-    auto &CurrentPayload = MPayloads[HashValue];
+    auto &CurrentPayload = Shard.MPayloads[HashValue];
     Payload->flags |= (uint64_t)payload_flag_t::PayloadRegistered;
     CurrentPayload = *Payload; // when it uses tbb, should be thread-safe
 
@@ -488,9 +499,10 @@ private:
     if (HashValue == xpti::invalid_uid)
       return nullptr;
 
-    std::lock_guard<std::mutex> Lock(MEventMutex);
-    auto EvLoc = MEvents.find(HashValue);
-    if (EvLoc != MEvents.end()) {
+    EventShard &Shard = getShard(HashValue);
+    std::lock_guard<std::mutex> Lock(Shard.MMutex);
+    auto EvLoc = Shard.MEvents.find(HashValue);
+    if (EvLoc != Shard.MEvents.end()) {
 #ifdef XPTI_STATISTICS
       MRetrievals++;
 #endif
@@ -506,11 +518,11 @@ private:
 #endif
       // We also want to query the payload by universal ID that has been
       // generated
-      auto &CurrentPayload = MPayloads[HashValue];
+      auto &CurrentPayload = Shard.MPayloads[HashValue];
       CurrentPayload = TempPayload; // when it uses tbb, should be thread-safe
       CurrentPayload.flags |= (uint64_t)payload_flag_t::PayloadRegistered;
 
-      xpti::trace_event_data_t *Event = &MEvents[HashValue];
+      xpti::trace_event_data_t *Event = &Shard.MEvents[HashValue];
       // We are seeing this unique ID for the first time, so we will
       // initialize the event structure with defaults and set the unique_id to
       // the newly generated unique id (uid)
@@ -528,13 +540,24 @@ private:
     }
   }
 
+  /// The events and payloads are spread over shards by universal ID, so that
+  /// the threads registering different tracepoints do not contend.
+  struct EventShard {
+    uid_payload_lut MPayloads;
+    uid_event_lut MEvents;
+    std::mutex MMutex;
+  };
+  static constexpr size_t NumEventShards = 64;
+
+  EventShard &getShard(uint64_t UId) {
+    return MEventShards[(UId * 0x9e3779b97f4a7c15ULL) >> 58];
+  }
+
   xpti::safe_int64_t MUId;
   xpti::StringTable &MStringTableRef;
   xpti::safe_uint64_t MInsertions, MRetrievals;
-  uid_payload_lut MPayloads;
-  uid_event_lut MEvents;
+  std::array<EventShard, NumEventShards> MEventShards;
   std::mutex MMetadataMutex;
-  std::mutex MEventMutex;
 };
 
 /// \brief Helper class to manage subscriber callbacks for a given tracepoint
@@ -604,6 +627,7 @@ public:
     // If we come here, then we did not find the callback being registered
     // already in the framework. So, we insert it.
     Acc->second.push_back(std::make_pair(true, cbFunc));
+    markSubscribed(StreamID, TraceType);
     return xpti::result_t::XPTI_RESULT_SUCCESS;
   }
 
@@ -662,31 +686,38 @@ public:
     return xpti::result_t::XPTI_RESULT_SUCCESS;
   }
 
+  /// The streams and the trace types below NumSummaryTypes are looked up in
+  /// the subscription summary without any lock, as this is called by the
+  /// instrumentation points of the runtimes even when nobody listens.
   bool checkSubscribed(uint16_t StreamID, uint16_t TraceType) {
-    if (StreamID == 0)
+    if (StreamID == 0 || StreamID >= MSubscriptions.size())
+      return false;
+
+    const subscription_summary_t &Summary = MSubscriptions[StreamID];
+    if (!Summary.MStream.load(std::memory_order_acquire))
+      return false;
+    if (!TraceType)
+      return true;
+    if (TraceType < NumSummaryTypes)
+      return (Summary.MTypes[TraceType / 64].load(std::memory_order_acquire) >>
+              (TraceType % 64)) &
+             1;
+    if (!Summary.MOtherTypes.load(std::memory_order_acquire))
       return false;
 
     // If the notification framework moves to reader-writer locks, use reader
     // lock here
     std::lock_guard<std::mutex> Lock(MCBsLock);
-    auto &StreamCBs =
-        MCallbacksByStream[StreamID]; // thread-safe
-                                      // What we get is a concurrent_hash_map
-                                      // of vectors holding the callbacks we
-                                      // need access to;
-    bool StreamSubscribed = (StreamCBs.size() > 0);
-    if (TraceType) {
-      bool TraceTypeSubscribed = (StreamCBs.count(TraceType) > 0);
-      return (StreamSubscribed && TraceTypeSubscribed);
-    } else
-      return StreamSubscribed;
+    auto StreamCBs = MCallbacksByStream.find(StreamID);
+    return StreamCBs != MCallbacksByStream.end() &&
+           StreamCBs->second.count(TraceType) > 0;
   }
 
   xpti::result_t notifySubscribers(uint16_t StreamID, uint16_t TraceType,
                                    xpti::trace_event_data_t *Parent,
                                    xpti::trace_event_data_t *Object,
                                    uint64_t InstanceNo, const void *UserData) {
-    {
+    if (checkSubscribed(StreamID, TraceType)) {
       bool Success = false;
       xpti::Notifications::cb_t::iterator Acc;
       std::vector<xpti::tracepoint_callback_api_t> LocalCBs;
@@ -735,7 +766,15 @@ public:
 #endif
   }
 
-  void clear() { MCallbacksByStream.clear(); }
+  void clear() {
+    MCallbacksByStream.clear();
+    for (subscription_summary_t &Summary : MSubscriptions) {
+      Summary.MStream.store(false, std::memory_order_relaxed);
+      for (auto &Types : Summary.MTypes)
+        Types.store(0, std::memory_order_relaxed);
+      Summary.MOtherTypes.store(false, std::memory_order_relaxed);
+    }
+  }
 
 private:
 #ifdef XPTI_STATISTICS
@@ -793,7 +832,31 @@ private:
     }
   }
 #endif
+  /// Number of the trace types, from 0, which have a bit in the summary.
+  static constexpr uint16_t NumSummaryTypes = 256;
+
+  /// Records which trace types of a stream have had callbacks registered. As
+  /// the callback slots are never removed, the flags are only ever set.
+  struct subscription_summary_t {
+    std::atomic<bool> MStream{false};
+    std::array<std::atomic<uint64_t>, NumSummaryTypes / 64> MTypes{};
+    /// Set if a trace type not below NumSummaryTypes has a callback slot
+    std::atomic<bool> MOtherTypes{false};
+  };
+
+  /// Called with MCBsLock held.
+  void markSubscribed(uint8_t StreamID, uint16_t TraceType) {
+    subscription_summary_t &Summary = MSubscriptions[StreamID];
+    if (TraceType < NumSummaryTypes)
+      Summary.MTypes[TraceType / 64].fetch_or(uint64_t(1) << (TraceType % 64),
+                                              std::memory_order_release);
+    else
+      Summary.MOtherTypes.store(true, std::memory_order_release);
+    Summary.MStream.store(true, std::memory_order_release);
+  }
+
   stream_cb_t MCallbacksByStream;
+  std::array<subscription_summary_t, 256> MSubscriptions;
   std::mutex MCBsLock;
   std::mutex MStatsLock;
   statistics_t MStats;
@@ -807,6 +870,7 @@ public:
     MSubscribers.loadFromEnvironmentVariable();
     MTraceEnabled =
         (g_helper.checkTraceEnv() && MSubscribers.hasValidSubscribers());
+    loadSamplingPolicies();
   }
 
   void clear() {
@@ -814,6 +878,56 @@ public:
     MTracepoints.clear();
     MStringTableRef.clear();
     MNotifier.clear();
+    MSamplingPolicies.clear();
+  }
+
+  /// Sets the sampling policies given by XPTI_SAMPLING, a comma separated
+  /// list of <stream>[#<trace type>]=<period>[:<max per second>] entries.
+  /// For example, "sycl.pi=100,sycl#20=1:1000" keeps one in a hundred API
+  /// calls and at most about a thousand task_begin/task_end per second.
+  void loadSamplingPolicies() {
+    std::string Env = g_helper.getEnvironmentVariable(env_sampling);
+    std::stringstream Entries(Env);
+    std::string Entry;
+    while (std::getline(Entries, Entry, ',')) {
+      size_t Eq = Entry.find('=');
+      if (Eq == std::string::npos)
+        continue;
+      std::string Stream = Entry.substr(0, Eq);
+      uint16_t TraceType = 0;
+      size_t Hash = Stream.find('#');
+      if (Hash != std::string::npos) {
+        TraceType = (uint16_t)std::strtoul(Stream.c_str() + Hash + 1,
+                                           nullptr, 10);
+        Stream.resize(Hash);
+      }
+      char *End = nullptr;
+      uint32_t Period =
+          (uint32_t)std::strtoul(Entry.c_str() + Eq + 1, &End, 10);
+      uint32_t MaxPerSecond =
+          *End == ':' ? (uint32_t)std::strtoul(End + 1, nullptr, 10) : 0;
+      if (!Stream.empty())
+        MSamplingPolicies.set(registerStream(Stream.c_str()), TraceType, Period,
+                              MaxPerSecond);
+    }
+  }
+
+  void setSamplingPolicy(uint8_t StreamID, uint16_t TraceType,
+                         uint32_t Period, uint32_t MaxPerSecond) {
+    MSamplingPolicies.set(StreamID, TraceType, Period, MaxPerSecond);
+  }
+
+  bool checkTraceSampled(uint8_t StreamID, uint16_t TraceType,
+                         const xpti::trace_event_data_t *Object,
+                         uint64_t InstanceNo) {
+    if (!MTraceEnabled)
+      return false;
+    // The notifications with neither an object nor an instance number are
+    // picked by a counter when they are made.
+    if (!Object && !InstanceNo)
+      return true;
+    return MSamplingPolicies.sample(StreamID, TraceType, Object, InstanceNo,
+                                    /*Count=*/false);
   }
 
   inline void setTraceEnabled(bool yesOrNo = true) { MTraceEnabled = yesOrNo; }
@@ -989,6 +1103,11 @@ public:
                                    uint64_t InstanceNo, const void *UserData) {
     if (!MTraceEnabled)
       return xpti::result_t::XPTI_RESULT_FALSE;
+    // The sampling is decided before anything else, so that the dropped
+    // notifications cost as little as possible.
+    if (!MSamplingPolicies.sample(StreamID, TraceType, Object, InstanceNo,
+                                  /*Count=*/true))
+      return xpti::result_t::XPTI_RESULT_SUCCESS;
     if (!Object) {
       // We have relaxed the rules for notifications: Notifications can now
       // have 'nullptr' for both the Parent and Object only if UserData is
@@ -1092,6 +1211,8 @@ private:
   xpti::StringTable MVendorStringTable;
   /// Manages the tracepoints - framework caching
   xpti::Tracepoints MTracepoints;
+  /// Sampling policies of the notifications
+  xpti::SamplingPolicies MSamplingPolicies;
   /// Flag indicates whether tracing should be enabled
   bool MTraceEnabled;
 };
@@ -1249,6 +1370,20 @@ XPTI_EXPORT_API bool xptiTraceEnabled() {
   return xpti::Framework::instance().traceEnabled();
 }
 
+XPTI_EXPORT_API void xptiSetSamplingPolicy(uint8_t StreamID, uint16_t TraceType,
+                                           uint32_t Period,
+                                           uint32_t MaxPerSecond) {
+  xpti::Framework::instance().setSamplingPolicy(StreamID, TraceType, Period,
+                                                MaxPerSecond);
+}
+
+XPTI_EXPORT_API bool xptiCheckTraceSampled(uint8_t StreamID, uint16_t TraceType,
+                                           xpti::trace_event_data_t *Object,
+                                           uint64_t InstanceNo) {
+  return xpti::Framework::instance().checkTraceSampled(StreamID, TraceType,
+                                                       Object, InstanceNo);
+}
+
 XPTI_EXPORT_API bool xptiCheckTraceEnabled(uint16_t stream, uint16_t ttype) {
   return xpti::Framework::instance().checkTraceEnabled(stream, ttype);
 }
@@ -726,6 +726,39 @@ TEST_F(xptiApiTest, xptiNotifySubscribersGoodInput) {
   EXPECT_NE(tmp, func_callback_update);
 }
 
+TEST_F(xptiApiTest, xptiSetSamplingPolicy) {
+  uint8_t StreamID = xptiRegisterStream("sampled");
+  xptiForceSetTraceEnabled(true);
+  constexpr uint16_t Begin =
+      static_cast<uint16_t>(xpti::trace_point_type_t::function_begin);
+  constexpr uint16_t End =
+      static_cast<uint16_t>(xpti::trace_point_type_t::function_end);
+  xptiRegisterCallback(StreamID, Begin, fn_callback);
+  xptiRegisterCallback(StreamID, End, fn_callback);
+  xptiSetSamplingPolicy(StreamID, 0, 10, 0);
+
+  int Kept = 0;
+  for (uint64_t Instance = 1; Instance <= 1000; ++Instance) {
+    int Before = func_callback_update;
+    bool Sampled = xptiCheckTraceSampled(StreamID, Begin, nullptr, Instance);
+    xptiNotifySubscribers(StreamID, Begin, nullptr, nullptr, Instance, "foo");
+    EXPECT_EQ(func_callback_update - Before, Sampled ? 1 : 0);
+    // The end of a scope is sent if and only if its begin was.
+    xptiNotifySubscribers(StreamID, End, nullptr, nullptr, Instance, "foo");
+    EXPECT_EQ(func_callback_update - Before, Sampled ? 2 : 0);
+    Kept += Sampled;
+  }
+  EXPECT_GT(Kept, 50);
+  EXPECT_LT(Kept, 150);
+
+  // A policy of the trace type overrides the one of the stream.
+  xptiSetSamplingPolicy(StreamID, Begin, 1, 0);
+  int Before = func_callback_update;
+  for (uint64_t Instance = 1; Instance <= 100; ++Instance)
+    xptiNotifySubscribers(StreamID, Begin, nullptr, nullptr, Instance, "foo");
+  EXPECT_EQ(func_callback_update - Before, 100);
+}
+
 TEST_F(xptiApiTest, xptiAddMetadataBadInput) {
   uint64_t instance;
   xpti::payload_t Payload("foo", "foo.cpp", 1, 0, (void *)13);